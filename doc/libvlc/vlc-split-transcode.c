@@ -0,0 +1,353 @@
+/* Copyright © 2026 VLC authors and VideoLAN (licence WTFPL) */
+/* A file to file transcoder running one transcode per CPU */
+
+/* Works with : libvlc 4.0.0
+   gcc -pedantic -Wall -Werror -Wextra `pkg-config --cflags --libs libvlc` -lpthread
+
+   The input is split in as many time ranges as jobs, each one being
+   transcoded by its own media player into a MPEG-TS part. The parts keep the
+   input timestamps (keep-timestamps TS muxer option), so that they are joined
+   by concatenation. Any other output (e.g. .mp4) is then remuxed from the
+   joined stream, without transcoding again.
+
+   Every part starts with a new GOP: the transcoder seeks to the keyframe
+   preceding its start and decodes from there.
+
+  vlc-split-transcode -j 8 -t "vcodec=h264,vb=2000,acodec=mp4a,ab=128" \
+      in.mkv out.mp4
+ */
+
+#define _GNU_SOURCE /* asprintf */
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <locale.h>
+#include <pthread.h>
+#include <stdbool.h>
+
+#include <vlc/vlc.h>
+
+#define DEFAULT_TRANSCODE "vcodec=h264,acodec=mp4a"
+
+struct job
+{
+    libvlc_media_t *m;
+    libvlc_media_player_t *mp;
+    char *part;
+    bool done;
+    bool failed;
+};
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  wait = PTHREAD_COND_INITIALIZER;
+
+static void usage(const char *name, int ret)
+{
+    fprintf(stderr, "Usage: %s [-j jobs] [-t transcode options] "
+                    "<input> <output>\n", name);
+    exit(ret);
+}
+
+static libvlc_instance_t *create_libvlc(void)
+{
+    static const char* const args[] = {
+        "--intf", "dummy",                  /* no interface                   */
+        "--no-stats",                       /* no stats                       */
+        "--no-sub-autodetect-file",         /* we don't want subtitles        */
+        "--no-inhibit",                     /* we don't want interfaces       */
+        "--no-disable-screensaver",         /* we don't want interfaces       */
+#ifndef NDEBUG
+        "--verbose=2",                      /* full log                       */
+#endif
+    };
+
+    return libvlc_new(sizeof args / sizeof *args, args);
+}
+
+static void player_callback(const libvlc_event_t *ev, void *param)
+{
+    struct job *job = param;
+
+    pthread_mutex_lock(&lock);
+    switch (ev->type) {
+    case libvlc_MediaPlayerEncounteredError:
+        job->failed = true;
+        /* fall through */
+    case libvlc_MediaPlayerEndReached:
+    case libvlc_MediaPlayerStopped:
+        job->done = true;
+        pthread_cond_broadcast(&wait);
+        break;
+
+    default:
+        assert(0);
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+static void media_callback(const libvlc_event_t *ev, void *param)
+{
+    bool *parsed = param;
+
+    assert(ev->type == libvlc_MediaParsedChanged);
+    pthread_mutex_lock(&lock);
+    *parsed = true;
+    pthread_cond_broadcast(&wait);
+    pthread_mutex_unlock(&lock);
+}
+
+/* Returns the duration of the input in ms, or -1 */
+static libvlc_time_t get_duration(libvlc_media_t *m)
+{
+    libvlc_event_manager_t *em = libvlc_media_event_manager(m);
+    bool parsed = false;
+
+    libvlc_event_attach(em, libvlc_MediaParsedChanged, media_callback, &parsed);
+    if (libvlc_media_parse_with_options(m, libvlc_media_parse_local, -1)) {
+        libvlc_event_detach(em, libvlc_MediaParsedChanged, media_callback,
+                            &parsed);
+        return -1;
+    }
+
+    pthread_mutex_lock(&lock);
+    while (!parsed)
+        pthread_cond_wait(&wait, &lock);
+    pthread_mutex_unlock(&lock);
+    libvlc_event_detach(em, libvlc_MediaParsedChanged, media_callback, &parsed);
+
+    if (libvlc_media_get_parsed_status(m) != libvlc_media_parsed_status_done)
+        return -1;
+    return libvlc_media_get_duration(m);
+}
+
+/* Adds an option with a time in ms, independently from the locale */
+static void add_time_option(libvlc_media_t *m, const char *name,
+                            libvlc_time_t ms)
+{
+    char opt[64];
+
+    snprintf(opt, sizeof opt, ":%s=%lld.%03lld", name,
+             (long long)(ms / 1000), (long long)(ms % 1000));
+    libvlc_media_add_option(m, opt);
+}
+
+static int job_start(libvlc_instance_t *libvlc, struct job *job,
+                     const char *in, const char *sout,
+                     libvlc_time_t start, libvlc_time_t stop)
+{
+    char *opt;
+
+    job->m = libvlc_media_new_path(libvlc, in);
+    if (!job->m)
+        return -1;
+
+    if (start > 0)
+        add_time_option(job->m, "start-time", start);
+    if (stop > 0)
+        add_time_option(job->m, "stop-time", stop);
+
+    if (asprintf(&opt, ":sout=%s", sout) < 0)
+        abort();
+    libvlc_media_add_option(job->m, opt);
+    free(opt);
+
+    job->mp = libvlc_media_player_new_from_media(job->m);
+    if (!job->mp)
+        return -1;
+
+    libvlc_event_manager_t *em = libvlc_media_player_event_manager(job->mp);
+    libvlc_event_attach(em, libvlc_MediaPlayerEndReached, player_callback, job);
+    libvlc_event_attach(em, libvlc_MediaPlayerStopped, player_callback, job);
+    libvlc_event_attach(em, libvlc_MediaPlayerEncounteredError,
+                        player_callback, job);
+
+    return libvlc_media_player_play(job->mp);
+}
+
+static void job_clean(struct job *job)
+{
+    if (job->mp) {
+        libvlc_media_player_stop_async(job->mp);
+        libvlc_media_player_release(job->mp);
+    }
+    if (job->m)
+        libvlc_media_release(job->m);
+    if (job->part) {
+        unlink(job->part);
+        free(job->part);
+    }
+}
+
+/* Waits for all the jobs, returns false if any failed */
+static bool jobs_wait(struct job *jobs, unsigned count)
+{
+    bool ok = true;
+
+    pthread_mutex_lock(&lock);
+    for (unsigned i = 0; i < count; i++) {
+        while (!jobs[i].done)
+            pthread_cond_wait(&wait, &lock);
+        ok = ok && !jobs[i].failed;
+    }
+    pthread_mutex_unlock(&lock);
+    return ok;
+}
+
+/* Joins the parts, in order, into the file out */
+static int join(struct job *jobs, unsigned count, const char *out)
+{
+    FILE *dst = fopen(out, "wb");
+    if (!dst) {
+        perror(out);
+        return -1;
+    }
+
+    char buf[65536];
+    int ret = 0;
+
+    for (unsigned i = 0; i < count && !ret; i++) {
+        FILE *src = fopen(jobs[i].part, "rb");
+        if (!src) {
+            perror(jobs[i].part);
+            ret = -1;
+            break;
+        }
+
+        size_t len;
+        while ((len = fread(buf, 1, sizeof buf, src)) > 0)
+            if (fwrite(buf, 1, len, dst) != len) {
+                perror(out);
+                ret = -1;
+                break;
+            }
+        fclose(src);
+    }
+
+    if (fclose(dst) && !ret) {
+        perror(out);
+        ret = -1;
+    }
+    return ret;
+}
+
+static bool is_ts(const char *path)
+{
+    size_t len = strlen(path);
+    return len >= 3 && !strcmp(path + len - 3, ".ts");
+}
+
+int main(int argc, char **argv)
+{
+    const char *transcode = DEFAULT_TRANSCODE;
+    long jobs_count = sysconf(_SC_NPROCESSORS_ONLN);
+    int opt;
+
+    /* mandatory to support UTF-8 filenames (provided the locale is well set)*/
+    setlocale(LC_ALL, "");
+
+    while ((opt = getopt(argc, argv, "hj:t:")) != -1) {
+        switch (opt) {
+        case 'j':
+            jobs_count = atol(optarg);
+            break;
+        case 't':
+            transcode = optarg;
+            break;
+        default:
+            usage(argv[0], opt != 'h');
+        }
+    }
+    if (argc - optind != 2 || jobs_count < 1)
+        usage(argv[0], 1);
+
+    const char *in = argv[optind];
+    const char *out = argv[optind + 1];
+
+    /* starts vlc */
+    libvlc_instance_t *libvlc = create_libvlc();
+    assert(libvlc);
+
+    libvlc_media_t *m = libvlc_media_new_path(libvlc, in);
+    assert(m);
+    libvlc_time_t duration = get_duration(m);
+    libvlc_media_release(m);
+    if (duration <= 0) {
+        fprintf(stderr, "%s: unknown duration, cannot split it\n", in);
+        libvlc_release(libvlc);
+        return 1;
+    }
+
+    /* Parts shorter than a few seconds would mostly be GOP starts */
+    if (duration / jobs_count < 10000)
+        jobs_count = duration / 10000 + 1;
+
+    struct job *jobs = calloc(jobs_count, sizeof (*jobs));
+    if (!jobs)
+        abort();
+
+    /* transcodes the time ranges concurrently */
+    int ret = 0;
+    for (long i = 0; i < jobs_count && !ret; i++) {
+        char *sout;
+
+        if (asprintf(&jobs[i].part, "%s.part%ld.ts", out, i) < 0
+         || asprintf(&sout, "#transcode{%s}:std{access=file,"
+                     "mux=ts{keep-timestamps},dst='%s'}",
+                     transcode, jobs[i].part) < 0)
+            abort();
+
+        libvlc_time_t start = duration * i / jobs_count;
+        libvlc_time_t stop = i + 1 < jobs_count
+                           ? duration * (i + 1) / jobs_count : 0;
+        if (job_start(libvlc, &jobs[i], in, sout, start, stop)) {
+            fprintf(stderr, "%s: cannot start part %ld\n", in, i);
+            jobs[i].done = jobs[i].failed = true;
+            ret = 1;
+        }
+        free(sout);
+    }
+
+    if (!jobs_wait(jobs, jobs_count))
+        ret = 1;
+
+    /* joins the parts */
+    if (!ret) {
+        char *joined;
+
+        if (is_ts(out))
+            joined = strdup(out);
+        else if (asprintf(&joined, "%s.joined.ts", out) < 0)
+            joined = NULL;
+        if (!joined)
+            abort();
+
+        ret = join(jobs, jobs_count, joined) ? 1 : 0;
+
+        if (!ret && !is_ts(out)) {
+            /* remuxes, the muxer being picked from the extension */
+            struct job remux = { 0 };
+            char *sout;
+
+            if (asprintf(&sout, "#std{access=file,dst='%s'}", out) < 0)
+                abort();
+            if (job_start(libvlc, &remux, joined, sout, 0, 0))
+                remux.done = remux.failed = true;
+            free(sout);
+            if (!jobs_wait(&remux, 1))
+                ret = 1;
+            job_clean(&remux);
+            unlink(joined);
+        }
+        free(joined);
+    }
+
+    /* clean up */
+    for (long i = 0; i < jobs_count; i++)
+        job_clean(&jobs[i]);
+    free(jobs);
+    libvlc_release(libvlc);
+
+    return ret;
+}
@@ -559,6 +559,39 @@ static inline int64_t libvlc_delay(int64_t pts)
 
 /** @} */
 
+/** \defgroup libvlc_trace LibVLC pipeline tracing
+ * These functions record when data goes through each stage of the playback
+ * pipeline (access, demuxer, packetizer, decoder, filters, video and audio
+ * outputs), to diagnose latency.
+ * @{
+ */
+
+/**
+ * Start recording pipeline events.
+ *
+ * Only the events recorded since the last call are written by
+ * libvlc_trace_stop().
+ *
+ * \param p_instance the instance
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_trace_start(libvlc_instance_t *p_instance);
+
+/**
+ * Stop recording pipeline events, and write them to a file in the Chrome
+ * trace event format, which Perfetto or chrome://tracing can open.
+ *
+ * \param p_instance the instance
+ * \param psz_path file to write the events to, or NULL to discard them
+ * \return 0 on success, -1 if the file could not be written
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+int libvlc_trace_stop(libvlc_instance_t *p_instance, const char *psz_path);
+
+/** @} */
+
 # ifdef __cplusplus
 }
 # endif
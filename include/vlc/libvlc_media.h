@@ -786,6 +786,47 @@ libvlc_media_thumbnail_request_by_pos( libvlc_media_t *md,
                                        bool crop, libvlc_picture_type_t picture_type,
                                        libvlc_time_t timeout );
 
+/**
+ * \brief libvlc_media_thumbnail_request_by_times Start an asynchronous
+ * generation of several thumbnails
+ *
+ * All the thumbnails are generated by a single pass through the media, which
+ * is much faster than a request per time, typically for trick-play strips.
+ *
+ * If the request is successfuly queued, the libvlc_MediaThumbnailGenerated
+ * is guaranteed to be emited once per time, in the order of the times.
+ * The resulting thumbnails size is computed as for
+ * libvlc_media_thumbnail_request_by_time().
+ *
+ * \param md media descriptor object
+ * \param times The times at which the thumbnails should be generated, in
+ * increasing order
+ * \param count The number of times
+ * \param speed The seeking speed \sa{libvlc_thumbnailer_seek_speed_t}
+ * \param width The thumbnails width
+ * \param height the thumbnails height
+ * \param crop Should the pictures be cropped to preserve source aspect ratio
+ * \param picture_type The thumbnails picture type \sa{libvlc_picture_type_t}
+ * \param timeout A timeout value in ms for each thumbnail, or 0 to disable
+ * timeout
+ *
+ * \return A valid opaque request object, or NULL in case of failure.
+ * It may be cancelled by libvlc_media_thumbnail_request_cancel().
+ * It must be released by libvlc_media_thumbnail_request_destroy().
+ *
+ * \version libvlc 4.0 or later
+ *
+ * \see libvlc_media_thumbnail_request_by_time
+ */
+LIBVLC_API libvlc_media_thumbnail_request_t*
+libvlc_media_thumbnail_request_by_times( libvlc_media_t *md,
+                                         const libvlc_time_t *times,
+                                         size_t count,
+                                         libvlc_thumbnailer_seek_speed_t speed,
+                                         unsigned int width, unsigned int height,
+                                         bool crop, libvlc_picture_type_t picture_type,
+                                         libvlc_time_t timeout );
+
 /**
  * @brief libvlc_media_thumbnail_cancel cancels a thumbnailing request
  * @param p_req An opaque thumbnail request object.
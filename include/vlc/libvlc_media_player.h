@@ -293,6 +293,44 @@ LIBVLC_API int libvlc_media_player_stop_async ( libvlc_media_player_t *p_mi );
 LIBVLC_API int libvlc_media_player_set_renderer( libvlc_media_player_t *p_mi,
                                                  libvlc_renderer_item_t *p_item );
 
+/**
+ * Callback prototype to receive the packets of the elementary streams.
+ *
+ * The callback is invoked from the LibVLC threads, for every packet of the
+ * selected tracks, before decoding. The packet is only valid during the
+ * callback: to keep it longer, the application calls libvlc_packet_retain()
+ * and later libvlc_packet_release().
+ *
+ * The playback waits for the callback to return: a slow callback throttles
+ * the demuxer instead of having the packets queued without bound.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_media_player_set_packet_callback() [IN]
+ * \param packet the packet [IN]
+ */
+typedef void (*libvlc_media_player_packet_cb)(void *opaque,
+                                              libvlc_packet_t *packet);
+
+/**
+ * Set a callback to receive the packets of the elementary streams.
+ *
+ * Unless display is set, the tracks are not decoded at all: the packets
+ * are only passed to the application.
+ *
+ * \note must be called before libvlc_media_player_play() to take effect.
+ * This replaces the stream output chain of the media player, if any.
+ *
+ * \param p_mi the Media Player
+ * \param packet callback to receive the packets, or NULL to remove it
+ * \param opaque private pointer for the callback (as first parameter)
+ * \param display true to decode and render the tracks as well
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_media_player_set_packet_callback( libvlc_media_player_t *p_mi,
+                                              libvlc_media_player_packet_cb packet,
+                                              void *opaque, bool display );
+
 /**
  * Enumeration of the Video color primaries.
  */
@@ -500,6 +538,50 @@ void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
                                         libvlc_video_cleanup_cb cleanup );
 
 
+/**
+ * Callback prototype to receive a decoded picture.
+ *
+ * When the video frame needs to be shown, as determined by the media playback
+ * clock, the frame callback is invoked with the decoded picture itself,
+ * of type libvlc_picture_Raw. Its presentation time is returned by
+ * libvlc_picture_get_time().
+ *
+ * The picture is only valid during the callback. To keep it longer, e.g. to
+ * process it in another thread, the application calls
+ * libvlc_picture_retain() and later libvlc_picture_release().
+ *
+ * \note The decoder allocates a limited number of pictures: retaining too
+ * many of them, or for too long, stalls the decoding.
+ *
+ * \param opaque private pointer as passed to
+ *               libvlc_video_set_frame_callback() [IN]
+ * \param picture the decoded picture [IN]
+ */
+typedef void (*libvlc_video_frame_cb)(void *opaque, libvlc_picture_t *picture);
+
+/**
+ * Set a callback to receive the decoded video pictures.
+ *
+ * Unlike libvlc_video_set_callbacks(), the pixels are not copied into
+ * application buffers: the application reads the pictures of the decoder
+ * directly, in the chroma and dimensions output by the decoder and the
+ * video filters (if any).
+ *
+ * This is mutually exclusive with libvlc_video_set_callbacks() and
+ * libvlc_video_set_output_callbacks(). Hardware video decoding is disabled,
+ * so that the pictures are in main memory.
+ *
+ * \param mp the media player
+ * \param frame callback to receive the pictures (must not be NULL)
+ * \param opaque private pointer for the callback (as first parameter)
+ * \version LibVLC 4.0.0 or later
+ */
+LIBVLC_API
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb frame,
+                                      void *opaque );
+
+
 typedef struct libvlc_video_setup_device_cfg_t
 {
     bool hardware_decoding; /** set if D3D11_CREATE_DEVICE_VIDEO_SUPPORT is needed for D3D11 */
@@ -0,0 +1,131 @@
+/*****************************************************************************
+ * libvlc_packet.h:  libvlc external API
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_LIBVLC_PACKET_H
+#define VLC_LIBVLC_PACKET_H 1
+
+#include <vlc/libvlc_media_track.h>
+
+# ifdef __cplusplus
+extern "C" {
+# endif
+
+/**
+ * A packet of an elementary stream, as demuxed and packetized, before
+ * decoding.
+ *
+ * \see libvlc_media_player_set_packet_callback()
+ */
+typedef struct libvlc_packet_t libvlc_packet_t;
+
+typedef enum libvlc_packet_flag_t
+{
+    libvlc_packet_Keyframe      = 0x1, /**< intra coded frame */
+    libvlc_packet_Discontinuity = 0x2, /**< previous packets were lost */
+    libvlc_packet_Corrupted     = 0x4, /**< the packet may be damaged */
+} libvlc_packet_flag_t;
+
+/**
+ * Increment the reference count of this packet.
+ *
+ * \see libvlc_packet_release()
+ * \param pkt A packet object
+ */
+LIBVLC_API void
+libvlc_packet_retain( libvlc_packet_t* pkt );
+
+/**
+ * Decrement the reference count of this packet.
+ * When the reference count reaches 0, the packet will be released.
+ * The packet must not be accessed after calling this function.
+ *
+ * \see libvlc_packet_retain
+ * \param pkt A packet object
+ */
+LIBVLC_API void
+libvlc_packet_release( libvlc_packet_t* pkt );
+
+/**
+ * Returns the packet payload.
+ * The libvlc_packet_t owns the returned buffer, which must not be modified
+ * nor freed.
+ *
+ * \param pkt A packet object
+ * \param size A pointer to a size_t that will hold the size of the buffer [required]
+ * \return A pointer to the payload.
+ */
+LIBVLC_API const unsigned char*
+libvlc_packet_get_buffer( const libvlc_packet_t* pkt, size_t *size );
+
+/**
+ * Returns the presentation timestamp, in microseconds, or -1 if unknown
+ *
+ * \param pkt A packet object
+ */
+LIBVLC_API int64_t
+libvlc_packet_get_pts( const libvlc_packet_t* pkt );
+
+/**
+ * Returns the decoding timestamp, in microseconds, or -1 if unknown
+ *
+ * \param pkt A packet object
+ */
+LIBVLC_API int64_t
+libvlc_packet_get_dts( const libvlc_packet_t* pkt );
+
+/**
+ * Returns the packet flags, a combination of libvlc_packet_flag_t
+ *
+ * \param pkt A packet object
+ */
+LIBVLC_API unsigned int
+libvlc_packet_get_flags( const libvlc_packet_t* pkt );
+
+/**
+ * Returns the type of the track of this packet
+ *
+ * \param pkt A packet object
+ */
+LIBVLC_API libvlc_track_type_t
+libvlc_packet_get_track_type( const libvlc_packet_t* pkt );
+
+/**
+ * Returns the identifier of the track of this packet, as in
+ * libvlc_media_track_t::i_id
+ *
+ * \param pkt A packet object
+ */
+LIBVLC_API int
+libvlc_packet_get_track_id( const libvlc_packet_t* pkt );
+
+/**
+ * Returns the codec of the track of this packet, as in
+ * libvlc_media_track_t::i_codec
+ *
+ * \param pkt A packet object
+ */
+LIBVLC_API uint32_t
+libvlc_packet_get_codec( const libvlc_packet_t* pkt );
+
+# ifdef __cplusplus
+}
+# endif
+
+#endif // VLC_LIBVLC_PACKET_H
@@ -35,6 +35,7 @@ typedef enum libvlc_picture_type_t
     libvlc_picture_Argb,
     libvlc_picture_Png,
     libvlc_picture_Jpg,
+    libvlc_picture_Raw, /**< decoded picture, shared with LibVLC */
 } libvlc_picture_type_t;
 
 /**
@@ -70,6 +71,8 @@ libvlc_picture_save( const libvlc_picture_t* pic, const char* path );
 
 /**
  * Returns the image internal buffer, including potential padding.
+ * This cannot be called on images of type libvlc_picture_Raw, see
+ * libvlc_picture_get_plane() instead.
  * The libvlc_picture_t owns the returned buffer, which must not be modified nor
  * freed.
  *
@@ -92,6 +95,7 @@ libvlc_picture_type( const libvlc_picture_t* pic );
 /**
  * Returns the image stride, ie. the number of bytes per line.
  * This can only be called on images of type libvlc_picture_Argb
+ * or libvlc_picture_Raw (stride of the first plane)
  *
  * \param pic A picture object
  */
@@ -121,6 +125,46 @@ libvlc_picture_get_height( const libvlc_picture_t* pic );
 LIBVLC_API libvlc_time_t
 libvlc_picture_get_time( const libvlc_picture_t* pic );
 
+/**
+ * Returns the chroma of a decoded picture.
+ * This can only be called on images of type libvlc_picture_Raw
+ *
+ * \param pic A picture object
+ * \param chroma a buffer of 4 bytes for the four-characters string
+ *               identifying the chroma, as in libvlc_video_format_cb() [OUT]
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API void
+libvlc_picture_get_chroma( const libvlc_picture_t* pic, char *chroma );
+
+/**
+ * Returns the number of pixel planes of a decoded picture.
+ * This can only be called on images of type libvlc_picture_Raw
+ *
+ * \param pic A picture object
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API unsigned int
+libvlc_picture_get_plane_count( const libvlc_picture_t* pic );
+
+/**
+ * Returns a pixel plane of a decoded picture.
+ * This can only be called on images of type libvlc_picture_Raw
+ *
+ * The pixels belong to LibVLC and are valid until the picture is released.
+ * They must not be modified: the decoder may still use them as a reference.
+ *
+ * \param pic A picture object
+ * \param plane the plane index, lower than libvlc_picture_get_plane_count()
+ * \param pitch a pointer to the scanline pitch in bytes [OUT]
+ * \param lines a pointer to the number of scanlines [OUT]
+ * \return the start address of the plane
+ * \version LibVLC 4.0.0 and later.
+ */
+LIBVLC_API const unsigned char*
+libvlc_picture_get_plane( const libvlc_picture_t* pic, unsigned int plane,
+                          unsigned int *pitch, unsigned int *lines );
+
 /**
  * Returns the number of pictures in the list
  */
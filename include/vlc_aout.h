@@ -610,6 +610,7 @@ struct vlc_audio_meter
     const audio_sample_format_t *fmt;
 
     struct vlc_list plugins;
+    struct vlc_audio_meter_tap *tap;
 };
 
 /**
@@ -633,7 +634,9 @@ vlc_audio_meter_Destroy(struct vlc_audio_meter *meter);
 /**
  * Set or reset the audio format
  *
- * This will reload all plugins added with vlc_audio_meter_AddPlugin()
+ * This will reload all plugins added with vlc_audio_meter_AddPlugin(), and
+ * start the meter thread (or stop it if fmt is NULL). This must be called
+ * from the thread calling vlc_audio_meter_Process().
  *
  * @param meter audio meter structure
  * @param fmt NULL to unload all plugins or a valid pointer to an audio format,
@@ -675,7 +678,10 @@ vlc_audio_meter_RemovePlugin(struct vlc_audio_meter *meter, vlc_audio_meter_plug
 /**
  * Process an audio block
  *
- * vlc_audio_meter_events callbacks can be triggered from this function.
+ * The block is copied to a queue, and the plugins process it later on the
+ * meter thread, from which the vlc_audio_meter_events callbacks are
+ * triggered. This function never waits: if the meter thread lags behind,
+ * the block is not measured.
  *
  * @param meter audio meter structure
  * @param block pointer to a block, this block won't be released of modified
@@ -688,6 +694,7 @@ vlc_audio_meter_Process(struct vlc_audio_meter *meter, block_t *block, vlc_tick_
 /**
  * Flush all "audio meter" plugins
  *
+ * The blocks queued and not yet processed are discarded.
  * vlc_audio_meter_events callbacks can be triggered from this function.
  *
  * @param meter audio meter structure
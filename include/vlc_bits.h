@@ -120,6 +120,41 @@ static inline int bs_refill( bs_t *s )
     return s->i_left > 0 ? 0 : 1;
 }
 
+/*
+ * Fast path: with the plain byte callbacks, and while at least 8 bytes are
+ * left, the bits are extracted from a 64-bit big endian load instead of
+ * byte per byte. The state is the same as the slow path would leave.
+ */
+static inline bool bs_impl_fast( bs_t *s )
+{
+    if( s->cb.pf_byte_forward != bs_impl_bytes_forward )
+        return false;
+
+    if( s->i_left == 0 )
+    {   /* move to the next byte, as bs_refill() would */
+        if( s->p != NULL ? s->p_end - s->p < 9 : s->p_end - s->p_start < 8 )
+            return false;
+        s->p = (s->p != NULL) ? s->p + 1 : s->p_start;
+        s->i_left = 8;
+        return true;
+    }
+    return s->p_end - s->p >= 8;
+}
+
+/* Next bits, MSB first, in the fast path (at least 57 valid bits) */
+static inline uint64_t bs_impl_peek( const bs_t *s )
+{
+    return GetQWBE( s->p ) << (8 - s->i_left);
+}
+
+static inline void bs_impl_forward_bits( bs_t *s, unsigned i_count )
+{
+    unsigned i_pos = 8 - s->i_left + i_count;
+
+    s->p += i_pos / 8;
+    s->i_left = 8 - i_pos % 8;
+}
+
 static inline bool bs_error( const bs_t *s )
 {
     return s->b_error;
@@ -173,6 +208,13 @@ static inline uint32_t bs_read( bs_t *s, uint8_t i_count )
     uint8_t  i_shr, i_drop = 0;
     uint32_t i_result = 0;
 
+    if( i_count > 0 && i_count <= 32 && bs_impl_fast( s ) )
+    {
+        i_result = bs_impl_peek( s ) >> (64 - i_count);
+        bs_impl_forward_bits( s, i_count );
+        return i_result;
+    }
+
     if( i_count > 32 )
     {
         i_drop = i_count - 32;
@@ -281,6 +323,18 @@ static inline uint_fast32_t bs_read_ue( bs_t * bs )
 {
     unsigned i = 0;
 
+    if( bs_impl_fast( bs ) )
+    {
+        uint32_t i_word = bs_impl_peek( bs ) >> 32;
+
+        if( i_word & 0xFFFF0000 ) /* up to 15 leading zeroes */
+        {
+            i = vlc_clz( i_word );
+            bs_impl_forward_bits( bs, 2 * i + 1 );
+            return (i_word >> (31 - 2 * i)) - 1;
+        }
+    }
+
     while( !bs->b_error &&
            bs_read1( bs ) == 0 &&
            bs->p < bs->p_end && i < 31 )
@@ -202,6 +202,21 @@ VLC_API block_t *block_Realloc(block_t *, ssize_t pre, size_t body) VLC_USED;
  */
 VLC_API void block_Release(block_t *block);
 
+/**
+ * Reports block pool usage.
+ *
+ * If the VLC_BLOCK_POOL environment variable is set to a positive value,
+ * block_Alloc() serves small blocks from per-thread caches of recycled blocks.
+ * This returns how many allocations were served from a cache (hits) and how
+ * many needed a new heap allocation (misses) so far.
+ *
+ * @note The counters are updated in batches, so the values may lag slightly.
+ *
+ * @param hits storage for the number of cache hits [OUT]
+ * @param misses storage for the number of cache misses [OUT]
+ */
+VLC_API void block_PoolStats(uint64_t *hits, uint64_t *misses);
+
 static inline void block_CopyProperties( block_t *dst, const block_t *src )
 {
     dst->i_flags   = src->i_flags;
@@ -231,6 +246,46 @@ static inline block_t *block_Duplicate( const block_t *p_block )
     return p_dup;
 }
 
+/**
+ * Makes a block shareable.
+ *
+ * Converts a block into a view of its payload, which can be handed to several
+ * consumers with block_Share() instead of being copied with block_Duplicate().
+ * The payload is released along with the last view.
+ *
+ * The payload of a shared block is read-only: block_Realloc() and
+ * block_TryRealloc() copy it before growing it, and consumers modifying it in
+ * place must call block_MakeWritable() first. Trimming the payload is always
+ * allowed.
+ *
+ * @param block block to share (ownership is transferred)
+ * @return the shared block, or NULL on error (the block is released)
+ */
+VLC_API block_t *block_MakeShared(block_t *block) VLC_USED;
+
+/**
+ * Shares a block.
+ *
+ * Creates a new view of the payload of a shared block, with the same
+ * properties. The views are released independently.
+ *
+ * @param block block returned by block_MakeShared() or block_Share()
+ * @return the new view, or NULL on error
+ */
+VLC_API block_t *block_Share(block_t *block) VLC_USED;
+
+/**
+ * Makes the payload of a block writable.
+ *
+ * If the block shares its payload with other views, the payload is copied.
+ * Otherwise the block is returned as is.
+ *
+ * @param block block to write to (ownership is transferred)
+ * @return a block with a private payload, or NULL on error (the block is
+ * released)
+ */
+VLC_API block_t *block_MakeWritable(block_t *block) VLC_USED;
+
 /**
  * Wraps heap in a block.
  *
@@ -689,6 +744,88 @@ static inline size_t block_FifoCount (block_fifo_t *fifo)
 
 /** @} */
 
+/**
+ * \defgroup block_spsc Single producer single consumer block FIFO
+ *
+ * Bounded wait-free block queue, for strictly one producer thread and one
+ * consumer thread at a time. Threads only sleep when the queue is full
+ * (producer) or empty (consumer), and are only woken up if they do sleep.
+ * @{
+ */
+
+typedef struct block_spsc_t block_spsc_t;
+
+/**
+ * Creates a single producer single consumer FIFO of blocks.
+ *
+ * @param capacity maximum number of queued blocks (rounded up to a power of
+ *                 two)
+ * @return the FIFO or NULL on memory error
+ */
+VLC_API block_spsc_t *block_SpscNew(size_t capacity) VLC_USED VLC_MALLOC;
+
+/**
+ * Destroys a FIFO created by block_SpscNew().
+ *
+ * @note Any queued blocks are also destroyed.
+ * @warning No other threads may be using the FIFO when this function is
+ * called.
+ */
+VLC_API void block_SpscRelease(block_spsc_t *);
+
+/**
+ * Queues blocks at the end of the FIFO (producer side).
+ *
+ * If the FIFO is full, waits until the consumer makes room.
+ * If the FIFO is killed, the remaining blocks are released.
+ *
+ * @param block head of a block list to queue (may be NULL)
+ */
+VLC_API void block_SpscPut(block_spsc_t *, block_t *block);
+
+/**
+ * Dequeues the first block from the FIFO, if any (consumer side).
+ *
+ * @return the first block, or NULL if the FIFO is empty
+ */
+VLC_API block_t *block_SpscTryGet(block_spsc_t *) VLC_USED;
+
+/**
+ * Dequeues the first block from the FIFO (consumer side).
+ *
+ * If the FIFO is empty, waits until a block is queued or the FIFO is killed.
+ * This function is not a cancellation point.
+ *
+ * @return the first block, or NULL if the FIFO is empty and killed
+ */
+VLC_API block_t *block_SpscGet(block_spsc_t *) VLC_USED;
+
+/**
+ * Kills a FIFO.
+ *
+ * Wakes up both sides: block_SpscGet() returns NULL once the FIFO is empty,
+ * and block_SpscPut() no longer waits. This can be called from any thread.
+ */
+VLC_API void block_SpscKill(block_spsc_t *);
+
+/**
+ * Counts blocks in a FIFO.
+ *
+ * @note From threads other than the consumer, the value may be outdated by
+ * the time it is returned.
+ */
+VLC_API size_t block_SpscGetCount(const block_spsc_t *) VLC_USED;
+
+/**
+ * Counts bytes in a FIFO.
+ *
+ * @note From threads other than the producer and consumer, the value may be
+ * outdated by the time it is returned.
+ */
+VLC_API size_t block_SpscGetBytes(const block_spsc_t *) VLC_USED;
+
+/** @} */
+
 /** @} */
 
 #endif /* VLC_BLOCK_H */
@@ -66,6 +66,8 @@ struct decoder_owner_callbacks
             /* Display rate
              * cf. decoder_GetDisplayRate */
             float       (*get_display_rate)( decoder_t * );
+            /* cf. decoder_UpdateVideoMemory */
+            void        (*update_memory)( decoder_t *, ptrdiff_t );
         } video;
         struct
         {
@@ -114,6 +116,13 @@ struct decoder_t
     /* Tell the decoder if it is allowed to drop frames */
     bool                b_frame_drop_allowed;
 
+    /**
+     * Tell the decoder that only one picture will be used (thumbnail or
+     * seek preview): prerolled pictures can be decoded with a lower
+     * quality, and without preroll, the first keyframe can be waited for.
+     */
+    bool                b_thumbnailing;
+
     /**
      * Number of extra (ie in addition to the DPB) picture buffers
      * needed for decoding.
@@ -230,6 +239,23 @@ struct encoder_owner_callbacks
  */
 VLC_API vlc_decoder_device *vlc_encoder_GetDecoderDevice( encoder_t * );
 
+/**
+ * Reserves encoding threads from the process-wide budget.
+ *
+ * All the encoders share the budget set by sout-encoder-threads, so that
+ * many concurrent encodings do not oversubscribe the CPUs.
+ *
+ * \param count number of threads wanted, 0 for the number of CPUs
+ * \return the number of threads granted, at least 1 and at most count;
+ * they must be given back with vlc_encoder_ReleaseThreads()
+ */
+VLC_API unsigned vlc_encoder_AcquireThreads( encoder_t *, unsigned count );
+
+/**
+ * Gives back threads reserved by vlc_encoder_AcquireThreads().
+ */
+VLC_API void vlc_encoder_ReleaseThreads( encoder_t *, unsigned count );
+
 
 /**
  * \defgroup encoder Encoder
@@ -262,6 +288,7 @@ struct encoder_t
     int i_iframes;               /* One I frame per i_iframes */
     int i_bframes;               /* One B frame per i_bframes */
     int i_tolerance;             /* Bitrate tolerance */
+    vlc_tick_t i_latency;        /* Latency target, 0 if unconstrained */
 
     /* Encoder config */
     config_chain_t *p_cfg;
@@ -533,6 +560,22 @@ static inline float decoder_GetDisplayRate( decoder_t *dec )
     return dec->cbs->video.get_display_rate( dec );
 }
 
+/**
+ * This function accounts video surfaces allocated (positive size) or freed
+ * (negative size) by the decoder itself, such as hardware decoding surfaces,
+ * in the statistics.
+ *
+ * The surfaces still accounted when the decoder is closed are discounted by
+ * the owner.
+ */
+static inline void decoder_UpdateVideoMemory( decoder_t *dec, ptrdiff_t size )
+{
+    vlc_assert( dec->fmt_in.i_cat == VIDEO_ES && dec->cbs != NULL );
+
+    if( dec->cbs->video.update_memory != NULL )
+        dec->cbs->video.update_memory( dec, size );
+}
+
 /** @} */
 
 /**
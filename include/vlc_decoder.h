@@ -47,6 +47,27 @@ VLC_API void vlc_input_decoder_Drain( vlc_input_decoder_t * );
 VLC_API void vlc_input_decoder_Flush( vlc_input_decoder_t * );
 VLC_API int  vlc_input_decoder_SetSpuHighlight( vlc_input_decoder_t *, const vlc_spu_highlight_t * );
 
+/**
+ * Decoder sink.
+ *
+ * If the "decoder-sink" address variable of an input, or of one of its
+ * parents, points to this structure, the decoders pass their output to these
+ * callbacks instead of the video and audio outputs: no outputs are created,
+ * the subtitles are not decoded, and the input runs as fast as the decoders
+ * and the callbacks go, without clock pacing.
+ *
+ * The callbacks are invoked from the decoder threads. They do not own the
+ * picture nor the audio block: picture_Hold() keeps a picture for longer.
+ * Either callback may be NULL to discard that kind of frames.
+ */
+struct vlc_decoder_sink
+{
+    void (*on_picture)(void *opaque, picture_t *pic);
+    void (*on_audio)(void *opaque, const audio_format_t *fmt,
+                     const block_t *block);
+    void *opaque;
+};
+
 /**
  * It creates an empty input resource handler.
  *
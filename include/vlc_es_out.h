@@ -24,6 +24,7 @@
 #define VLC_ES_OUT_H 1
 
 #include <assert.h>
+#include <vlc_block.h>
 
 /**
  * \defgroup es_out ES output
@@ -137,6 +138,12 @@ struct es_out_callbacks
      * Private control callback, must be NULL for es_out created from modules.
      */
     int          (*priv_control)(es_out_t *, int query, va_list);
+    /**
+     * Send a chain of blocks, the Nth block to the Nth ES of the array.
+     *
+     * Optional, es_out_SendBatch() falls back to one send() per block.
+     */
+    int          (*send_batch)(es_out_t *, es_out_id_t *const *, block_t *);
 };
 
 struct es_out_t
@@ -161,6 +168,32 @@ static inline int es_out_Send( es_out_t *out, es_out_id_t *id,
     return out->cbs->send( out, id, p_block );
 }
 
+/**
+ * Send a burst of blocks under a single es_out call
+ *
+ * \param ids the ES of each block of the chain, in chain order
+ * \param chain the chain of blocks, linked through p_next
+ * \return VLC_SUCCESS, or an error if any block failed to be sent
+ */
+static inline int es_out_SendBatch( es_out_t *out, es_out_id_t *const *ids,
+                                    block_t *chain )
+{
+    if( out->cbs->send_batch != NULL )
+        return out->cbs->send_batch( out, ids, chain );
+
+    int ret = VLC_SUCCESS;
+    for( size_t i = 0; chain != NULL; i++ )
+    {
+        block_t *block = chain;
+
+        chain = block->p_next;
+        block->p_next = NULL;
+        if( out->cbs->send( out, ids[i], block ) != VLC_SUCCESS )
+            ret = VLC_EGENERIC;
+    }
+    return ret;
+}
+
 static inline int es_out_vaControl( es_out_t *out, int i_query, va_list args )
 {
     return out->cbs->control( out, NULL, i_query, args );
@@ -31,6 +31,8 @@ extern "C" {
 /** Executor type (opaque) */
 typedef struct vlc_executor vlc_executor_t;
 
+struct vlc_executor_thread;
+
 /**
  * A Runnable encapsulates a task to be run from an executor thread.
  */
@@ -60,6 +62,29 @@ struct vlc_runnable {
 
     /* Private data used by the vlc_executor_t (do not touch) */
     struct vlc_list node;
+    struct vlc_executor_thread *owner;
+    vlc_tick_t date;
+    bool urgent;
+};
+
+/**
+ * Executor statistics, see vlc_executor_GetStats().
+ */
+struct vlc_executor_stats {
+    /** Number of threads spawned */
+    unsigned threads;
+    /** Number of runnables queued, not started yet */
+    size_t queued;
+    /** Number of runnables being executed */
+    size_t running;
+    /** Number of runnables executed so far */
+    uint64_t executed;
+    /** Number of runnables taken from the queue of another thread */
+    uint64_t steals;
+    /** Average delay between submission and start of execution */
+    vlc_tick_t latency_avg;
+    /** Maximum delay between submission and start of execution */
+    vlc_tick_t latency_max;
 };
 
 /**
@@ -145,6 +170,20 @@ vlc_executor_Delete(vlc_executor_t *executor);
 VLC_API void
 vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable);
 
+/**
+ * Submit a runnable for execution, before non-urgent ones.
+ *
+ * This is the same as vlc_executor_Submit(), except that the runnable will be
+ * started before any runnable submitted with vlc_executor_Submit() that is
+ * still queued.
+ *
+ * \param executor the executor
+ * \param runnable the task to run
+ */
+VLC_API void
+vlc_executor_SubmitUrgent(vlc_executor_t *executor,
+                          struct vlc_runnable *runnable);
+
 /**
  * Cancel a runnable previously submitted.
  *
@@ -168,6 +207,22 @@ vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable);
 VLC_API bool
 vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable);
 
+/**
+ * Move a queued runnable before the non-urgent ones.
+ *
+ * If this runnable is still queued, it is handled as if it had been submitted
+ * with vlc_executor_SubmitUrgent() in the first place. This is typically used
+ * when the result of a background task becomes needed right away.
+ *
+ * \param executor the executor
+ * \param runnable the task to prioritize
+ * \retval true if the runnable is still queued
+ * \retval false if the runnable has already been taken by a thread
+ */
+VLC_API bool
+vlc_executor_Prioritize(vlc_executor_t *executor,
+                        struct vlc_runnable *runnable);
+
 /**
  * Wait until all submitted tasks are completed or canceled.
  *
@@ -176,6 +231,19 @@ vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable);
 VLC_API void
 vlc_executor_WaitIdle(vlc_executor_t *executor);
 
+/**
+ * Get the executor statistics.
+ *
+ * The values are gathered without stopping the executor, so they may be
+ * slightly inconsistent with each other.
+ *
+ * \param executor the executor
+ * \param stats the statistics to fill [OUT]
+ */
+VLC_API void
+vlc_executor_GetStats(vlc_executor_t *executor,
+                      struct vlc_executor_stats *stats);
+
 # ifdef __cplusplus
 }
 # endif
@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * vlc_fft.h: real fast Fourier transform
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_FFT_H
+#define VLC_FFT_H 1
+
+/**
+ * \defgroup fft Fast Fourier transform
+ * \ingroup cext
+ *
+ * Transforms of real signals, for audio analysis and filtering.
+ *
+ * A plan holds the tables for one transform size. Plans are immutable,
+ * shared by size between all the users, and can be used from several
+ * threads at the same time.
+ *
+ * A spectrum of N samples is stored as N / 2 + 1 interleaved complex bins,
+ * i.e. N + 2 floats: the real and imaginary parts of bin 0 (DC), then bin 1,
+ * up to bin N / 2 (Nyquist). The imaginary parts of the first and last bins
+ * are always zero.
+ * @{
+ * \file
+ */
+
+typedef struct vlc_rdft vlc_rdft_t;
+
+/**
+ * Gets the plan of a real transform.
+ *
+ * @param size number of real samples, a power of two, at least 4
+ * @return the plan (release with vlc_rdft_Release()), or NULL on error
+ */
+VLC_API vlc_rdft_t *vlc_rdft_Hold(size_t size) VLC_USED;
+
+/**
+ * Releases a plan obtained with vlc_rdft_Hold().
+ */
+VLC_API void vlc_rdft_Release(vlc_rdft_t *plan);
+
+/**
+ * Gets the number of real samples of a plan.
+ */
+VLC_API size_t vlc_rdft_GetSize(const vlc_rdft_t *plan) VLC_USED;
+
+/**
+ * Computes the spectrum of real samples.
+ *
+ * The transform is not scaled.
+ *
+ * @param in N samples
+ * @param spectrum N + 2 floats (output), must not overlap the input
+ */
+VLC_API void vlc_rdft_Forward(const vlc_rdft_t *plan, const float *in,
+                              float *spectrum);
+
+/**
+ * Computes real samples from their spectrum.
+ *
+ * The transform is scaled by 1 / N, so that it is the exact inverse of
+ * vlc_rdft_Forward().
+ *
+ * @param spectrum N + 2 floats (not modified)
+ * @param out N samples (output), must not overlap the spectrum
+ */
+VLC_API void vlc_rdft_Inverse(const vlc_rdft_t *plan, const float *spectrum,
+                              float *out);
+
+/**
+ * Computes the cross-correlation of two signals from their spectra.
+ *
+ * The result, once transformed back with vlc_rdft_Inverse(), is the
+ * circular cross-correlation: out[lag] = sum of a[i] * b[i + lag].
+ * Zero-pad the signals to avoid the wrap-around for the lags of interest.
+ *
+ * @param a spectrum of the first signal
+ * @param b spectrum of the second signal
+ * @param out N + 2 floats (output), may be a or b
+ */
+VLC_API void vlc_rdft_Correlate(const vlc_rdft_t *plan, const float *a,
+                                const float *b, float *out);
+
+/** @} */
+
+#endif
@@ -41,10 +41,23 @@ struct vlc_audio_loudness;
  * Filter modules interface
  */
 
+/**
+ * Rows processing function of a video filter.
+ *
+ * \param opaque data passed to filter_ProcessRows()
+ * \param y0 first row to process
+ * \param y1 row after the last row to process
+ * \see filter_ProcessRows()
+ */
+typedef void (*filter_rows_cb)(filter_t *, void *opaque,
+                               unsigned y0, unsigned y1);
+
 struct filter_video_callbacks
 {
     picture_t *(*buffer_new)(filter_t *);
     vlc_decoder_device * (*hold_device)(vlc_object_t *, void *sys);
+    void (*process_rows)(filter_t *, unsigned rows, unsigned align,
+                         filter_rows_cb, void *opaque);
 };
 
 struct filter_audio_callbacks
@@ -227,6 +240,9 @@ struct filter_t
     es_format_t         fmt_out;
     vlc_video_context   *vctx_out; // video filter, handled by the filter
     bool                b_allow_fmt_out_change;
+    /* Set by video filters whose filter_ProcessRows() callback can process
+     * distinct rows concurrently */
+    bool                b_parallel_rows;
 
     /* Name of the "video filter" shortcut that is requested, can be NULL */
     const char *        psz_name;
@@ -288,6 +304,37 @@ static inline void filter_ChangeViewpoint( filter_t *p_filter,
         p_filter->ops->change_viewpoint( p_filter, vp );
 }
 
+/**
+ * Process the rows of a video picture, possibly in parallel.
+ *
+ * The rows [0, rows) are split in slices starting on multiples of align
+ * rows, and the callback is called once for each slice. If the filter set
+ * b_parallel_rows and its owner supports it, the slices are processed
+ * concurrently by several threads, otherwise the callback is called once
+ * for all the rows, from the calling thread.
+ *
+ * Rows are usually the lines of the first plane of the picture, the
+ * callback must then process the matching lines of the other planes.
+ *
+ * This function returns once all the rows have been processed.
+ *
+ * \param p_filter video filter
+ * \param rows number of rows
+ * \param align row alignment of the slices, e.g. 2 for 4:2:0 pictures
+ * \param cb rows processing callback
+ * \param opaque data passed to the callback
+ */
+static inline void filter_ProcessRows( filter_t *p_filter, unsigned rows,
+                                       unsigned align, filter_rows_cb cb,
+                                       void *opaque )
+{
+    if ( p_filter->b_parallel_rows && p_filter->owner.video != NULL &&
+         p_filter->owner.video->process_rows != NULL )
+        p_filter->owner.video->process_rows( p_filter, rows, align, cb, opaque );
+    else
+        cb( p_filter, opaque, 0, rows );
+}
+
 static inline vlc_decoder_device * filter_HoldDecoderDevice( filter_t *p_filter )
 {
     if ( !p_filter->owner.video || !p_filter->owner.video->hold_device )
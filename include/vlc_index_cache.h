@@ -0,0 +1,73 @@
+/*****************************************************************************
+ * vlc_index_cache.h: Demuxer index cache
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_INDEX_CACHE_H
+#define VLC_INDEX_CACHE_H 1
+
+/**
+ * \defgroup index_cache Demuxer index cache
+ * \ingroup demux
+ *
+ * Demuxers building a costly index (scanning the whole file, reading a large
+ * index table...) can save it in the user cache directory, and read it back
+ * the next time the same file is opened.
+ *
+ * The cached data is opaque: each demuxer defines its own format, and should
+ * change the name it uses whenever that format changes. An entry is keyed by
+ * the local file path, its size and its modification time, so that it is
+ * ignored as soon as the file is modified.
+ *
+ * The cache is only used for local files, and if the "index-cache" option is
+ * enabled.
+ * @{
+ */
+
+/**
+ * Loads a cached index.
+ *
+ * \param demux the demuxer
+ * \param name name of the index, specific to the demuxer and its format
+ * \param size storage space for the size of the index [OUT]
+ *
+ * \return the index data (to be released with free()), or NULL if the file
+ * has no valid entry in the cache
+ */
+VLC_API VLC_USED
+void *vlc_index_cache_Load(stream_t *demux, const char *name, size_t *size);
+
+/**
+ * Saves an index in the cache.
+ *
+ * It replaces any previous entry of the same name for the file.
+ *
+ * \param demux the demuxer
+ * \param name name of the index, specific to the demuxer and its format
+ * \param data index data
+ * \param size size of the index data in bytes
+ *
+ * \return VLC_SUCCESS, or an error code if the index was not saved
+ */
+VLC_API
+int vlc_index_cache_Store(stream_t *demux, const char *name,
+                          const void *data, size_t size);
+
+/** @} */
+
+#endif
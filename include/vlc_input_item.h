@@ -329,6 +329,18 @@ INPUT_META(DiscTotal)
 #define input_item_SetArtURL   input_item_SetArtworkURL
 #define input_item_GetArtURL   input_item_GetArtworkURL
 
+/**
+ * Returns the URL of the art of an item, downscaled for a given size.
+ *
+ * When "fetch-art-variants" is enabled, the art fetcher stores copies of the
+ * local art fitting in 64, 256 and 1024 pixels. This returns the smallest of
+ * them at least as large as the requested size, or the original art.
+ *
+ * @param size size of the displayed art, in pixels
+ * @return the art URL (to be freed), or NULL if the item has no art
+ */
+VLC_API char *input_item_GetArtURLForSize( input_item_t *, unsigned size ) VLC_USED;
+
 VLC_API char * input_item_GetInfo( input_item_t *p_i, const char *psz_cat,const char *psz_name ) VLC_USED;
 VLC_API int input_item_AddInfo( input_item_t *p_i, const char *psz_cat, const char *psz_name, const char *psz_format, ... ) VLC_FORMAT( 4, 5 );
 VLC_API int input_item_DelInfo( input_item_t *p_i, const char *psz_cat, const char *psz_name );
@@ -411,6 +423,9 @@ typedef struct input_item_parser_cbs_t
     /**
      * Event received when a new subtree is added
      *
+     * Large playlists may be posted in several batches: the callback is then
+     * called once per batch, each subtree holding the following children.
+     *
      * @note This callback is optional.
      *
      * @param item the parsed item
@@ -469,6 +484,7 @@ typedef enum input_item_meta_request_option_t
     META_REQUEST_OPTION_FETCH_NETWORK = 0x08,
     META_REQUEST_OPTION_FETCH_ANY     = 0x0C,
     META_REQUEST_OPTION_DO_INTERACT   = 0x10,
+    META_REQUEST_OPTION_PRIORITY      = 0x20, /* before the other requests */
 } input_item_meta_request_option_t;
 
 /* status of the on_preparse_ended() callback */
@@ -499,6 +515,7 @@ VLC_API int libvlc_ArtRequest(libvlc_int_t *, input_item_t *,
                               const input_fetcher_callbacks_t *cbs,
                               void *cbs_userdata );
 VLC_API void libvlc_MetadataCancel( libvlc_int_t *, void * );
+VLC_API void libvlc_MetadataPrioritize( libvlc_int_t *, void * );
 
 /******************
  * Input stats
@@ -520,6 +537,7 @@ struct input_stats_t
     /* Decoders */
     int64_t i_decoded_audio;
     int64_t i_decoded_video;
+    int64_t i_video_memory; /**< Bytes of surfaces held by the decoders */
 
     /* Vout */
     int64_t i_displayed_pictures;
@@ -529,6 +547,9 @@ struct input_stats_t
     /* Aout */
     int64_t i_played_abuffers;
     int64_t i_lost_abuffers;
+
+    /* Clock */
+    vlc_tick_t i_latency; /**< Buffered duration of a live input, or 0 */
 };
 
 /**
@@ -169,6 +169,10 @@ extern "C" {
 
 /* Portable networking layer communication */
 int net_Socket (vlc_object_t *obj, int family, int socktype, int proto);
+int net_ConnectRace(vlc_object_t *obj, const struct addrinfo *res,
+                    vlc_tick_t timeout, const struct addrinfo **winner);
+int vlc_dns_GetPreferredFamily(const struct addrinfo *res);
+void vlc_dns_SetPreferredFamily(const struct addrinfo *res, int family);
 
 VLC_API int net_Connect(vlc_object_t *p_this, const char *psz_host, int i_port, int socktype, int protocol);
 #define net_Connect(a, b, c, d, e) net_Connect(VLC_OBJECT(a), b, c, d, e)
@@ -291,6 +295,10 @@ VLC_API int vlc_getaddrinfo (const char *, unsigned,
                              const struct addrinfo *, struct addrinfo **);
 VLC_API int vlc_getaddrinfo_i11e(const char *, unsigned,
                                  const struct addrinfo *, struct addrinfo **);
+VLC_API int vlc_getaddrinfo_cached(const char *, unsigned,
+                                   const struct addrinfo *,
+                                   const struct addrinfo **);
+VLC_API void vlc_freeaddrinfo_cached(const struct addrinfo *);
 
 static inline bool
 net_SockAddrIsMulticast (const struct sockaddr *addr, socklen_t len)
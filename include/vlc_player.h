@@ -219,6 +219,35 @@ vlc_player_SetStartPaused(vlc_player_t *player, bool start_paused);
 VLC_API void
 vlc_player_SetPauseOnCork(vlc_player_t *player, bool enabled);
 
+/**
+ * Enable or disable gapless transitions
+ *
+ * If enabled, the next media is opened and started as soon as the current
+ * one reaches its end, while the current input is still closing, instead of
+ * once it is fully stopped. This only applies to media ending by themselves,
+ * with the VLC_PLAYER_MEDIA_STOPPED_CONTINUE or
+ * VLC_PLAYER_MEDIA_STOPPED_EXIT action.
+ *
+ * @param player locked player instance
+ * @param enabled true to enable
+ */
+VLC_API void
+vlc_player_SetGapless(vlc_player_t *player, bool enabled);
+
+/**
+ * Enable or disable fast zapping
+ *
+ * If enabled, vlc_player_SetCurrentMedia() opens and starts the new media
+ * right away when the player is started, while the previous input is still
+ * closing, instead of once it is fully stopped. The audio and video outputs
+ * are handed over to the new input by the input resource.
+ *
+ * @param player locked player instance
+ * @param enabled true to enable
+ */
+VLC_API void
+vlc_player_SetFastZapping(vlc_player_t *player, bool enabled);
+
 /** @} vlc_player__instance */
 
 /**
@@ -3292,6 +3321,27 @@ struct vlc_player_timer_smpte_timecode
     bool drop_frame;
 };
 
+/**
+ * Player status, a merged snapshot of the playback state
+ *
+ * @see vlc_player_status_cbs
+ * @see vlc_player_GetStatus
+ */
+struct vlc_player_status
+{
+    /** State of the player */
+    enum vlc_player_state state;
+    /** Last time point of the best source, its system_date is
+     * VLC_TICK_INVALID if no time was updated yet */
+    struct vlc_player_timer_point point;
+    /** Buffering progress in the range [0.0f;1.0f] */
+    float buffering;
+    /** True if stats is valid */
+    bool has_stats;
+    /** Last statistics of the current media */
+    struct input_stats_t stats;
+};
+
 /**
  * Player timer callbacks
  *
@@ -3353,6 +3403,29 @@ struct vlc_player_timer_smpte_cbs
                       void *data);
 };
 
+/**
+ * Player status timer callbacks
+ *
+ * @see vlc_player_AddStatusTimer
+ */
+struct vlc_player_status_cbs
+{
+    /**
+     * Called when the status changed, at most once per period
+     *
+     * Position, buffering and statistics updates are merged into the status
+     * and coalesced according to the period of the timer. State changes are
+     * always notified.
+     *
+     * @warning The player is not locked from this callback. It is forbidden
+     * to call any player functions from here.
+     *
+     * @param status always valid, the current status of the player
+     * @param data opaque pointer set by vlc_player_AddStatusTimer()
+     */
+    void (*on_update)(const struct vlc_player_status *status, void *data);
+};
+
 /**
  * Add a timer in order to get times updates
  *
@@ -3385,6 +3458,38 @@ vlc_player_AddSmpteTimer(vlc_player_t *player,
                          const struct vlc_player_timer_smpte_cbs *cbs,
                          void *data);
 
+/**
+ * Add a timer in order to get throttled status updates
+ *
+ * This can be used instead of a player listener by clients that only need to
+ * refresh a view of the playback at a given rate.
+ *
+ * @param player player instance (locked or not)
+ * @param min_period minimum period between each updates, use
+ * VLC_TICK_INVALID to get all updates
+ * @param cbs pointer to a vlc_player_status_cbs structure, the structure must
+ * be valid during the lifetime of the player
+ * @param cbs_data opaque pointer used by the callbacks
+ * @return a valid vlc_player_timer_id or NULL in case of memory allocation
+ * error
+ */
+VLC_API vlc_player_timer_id *
+vlc_player_AddStatusTimer(vlc_player_t *player, vlc_tick_t min_period,
+                          const struct vlc_player_status_cbs *cbs,
+                          void *data);
+
+/**
+ * Get the current status of the player
+ *
+ * @note This function doesn't take the player lock and can be called from
+ * any thread.
+ *
+ * @param player player instance (locked or not)
+ * @param status pointer where to copy the status
+ */
+VLC_API void
+vlc_player_GetStatus(vlc_player_t *player, struct vlc_player_status *status);
+
 /**
  * Remove a player timer
  *
@@ -867,6 +867,21 @@ vlc_playlist_PlayAt(vlc_playlist_t *playlist, size_t index)
 VLC_API void
 vlc_playlist_Preparse(vlc_playlist_t *playlist, input_item_t *media);
 
+/**
+ * Preparse the items in a range, if auto-preparse is enabled.
+ *
+ * Insertions of many items (typically a large playlist file) are not
+ * preparsed automatically: the views call this function for the items they
+ * actually display. Items already preparsed or requested are skipped.
+ *
+ * \param playlist the playlist, locked
+ * \param index    the index of the first item
+ * \param count    the number of items
+ */
+VLC_API void
+vlc_playlist_PreparseItems(vlc_playlist_t *playlist, size_t index,
+                           size_t count);
+
 /**
  * Export the playlist to a file.
  *
@@ -316,6 +316,23 @@ VLC_API char *vlc_stream_ReadLine(stream_t *);
  */
 VLC_API int vlc_stream_ReadDir(stream_t *s, input_item_node_t *node);
 
+/**
+ * Posts the items read so far from a directory.
+ *
+ * Directory and playlist readers may call this function from their readdir
+ * callback, to hand the items over in batches instead of keeping the whole
+ * tree in memory until the end. On success, the children are moved out of
+ * the node, and the reader keeps appending the next items to it.
+ *
+ * This fails if the stream is not read by an input: the children are then
+ * left in the node, and posted by the caller of vlc_stream_ReadDir().
+ *
+ * \param s directory object being read
+ * \param node node passed to the readdir callback
+ * eturn VLC_SUCCESS if the children were posted
+ */
+VLC_API int vlc_stream_PostSubItems(stream_t *s, input_item_node_t *node);
+
 /**
  * Closes a byte stream.
  * \param s byte stream to close
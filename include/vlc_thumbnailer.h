@@ -112,12 +112,46 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
                               input_item_t *input_item, vlc_tick_t timeout,
                               vlc_thumbnailer_cb cb, void* user_data );
 
+/**
+ * \brief vlc_thumbnailer_RequestByTimes Requests thumbnails at several times
+ * \param thumbnailer A thumbnailer object
+ * \param times The times at which the thumbnails should be taken, in
+ * increasing order
+ * \param count The number of times, must not be 0
+ * \param speed The seeking speed \sa{enum vlc_thumbnailer_seek_speed}
+ * \param input_item The input item to generate the thumbnails for
+ * \param timeout A timeout value for each thumbnail, or VLC_TICK_INVALID to
+ * disable timeout
+ * \param cb A user callback to be called on completion (success & error)
+ * \param user_data An opaque value, provided as pf_cb's first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * All the thumbnails are taken from a single input, which is opened and
+ * probed only once then seeked from one time to the next.
+ *
+ * If this function returns a valid request object, the callback is guaranteed
+ * to be called once per time, in the order of the times, even in case of
+ * later failure.
+ * The returned request object must not be used after the last callback has
+ * been invoked. That request object is owned by the thumbnailer, and must not
+ * be released.
+ * The provided input_item will be held by the thumbnailer and can safely be
+ * released after calling this function.
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestByTimes( vlc_thumbnailer_t *thumbnailer,
+                                const vlc_tick_t *times, size_t count,
+                                enum vlc_thumbnailer_seek_speed speed,
+                                input_item_t *input_item, vlc_tick_t timeout,
+                                vlc_thumbnailer_cb cb, void* user_data );
+
 /**
  * \brief vlc_thumbnailer_Cancel Cancel a thumbnail request
  * \param thumbnailer A thumbnailer object
  * \param request An opaque thumbnail request object
  *
- * Cancelling a request will *not* invoke the completion callback.
+ * Cancelling a request will *not* invoke the completion callback, for none of
+ * the remaining times of a batch request.
  * The behavior is undefined if the request is cancelled after its completion.
  */
 VLC_API void
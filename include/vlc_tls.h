@@ -120,6 +120,12 @@ struct vlc_tls_operations
      * if there is one. See also \ref vlc_tls_SessionDelete().
      */
     void (*close)(struct vlc_tls *);
+
+    /** Callback for raw file descriptor access (optional).
+     *
+     * See \ref vlc_tls_GetRawFD().
+     */
+    int (*get_raw_fd)(struct vlc_tls *, bool write);
 };
 
 /**
@@ -328,6 +334,26 @@ static inline int vlc_tls_GetFD(vlc_tls_t *tls)
     return vlc_tls_GetPollFD(tls, &events);
 }
 
+/**
+ * Returns the file descriptor carrying the plain stream, if any.
+ *
+ * This function returns a file descriptor that the plain stream data can be
+ * written to (or read from) directly, bypassing the stream object, e.g.
+ * with sendfile() or splice(). That is the case of a plain socket, and of a
+ * TLS session whose encryption is offloaded to the kernel (kTLS).
+ *
+ * This function is reentrant and is not a cancellation point.
+ *
+ * @param write true for the sending direction, false for the receiving one
+ * @return a file descriptor, or -1 if the data must go through the stream
+ */
+static inline int vlc_tls_GetRawFD(vlc_tls_t *tls, bool write)
+{
+    if (tls->ops->get_raw_fd == NULL)
+        return -1;
+    return tls->ops->get_raw_fd(tls, write);
+}
+
 /**
  * Receives data through a socket.
  *
@@ -461,14 +487,33 @@ VLC_API vlc_tls_t *vlc_tls_SocketOpenAddrInfo(const struct addrinfo *ai,
  * @param hostname remote host name or IP address literal to connect to
  * @param port remote TCP port number to connect to
  *
- * @note The function currently iterates through the addrinfo linked list.
- * Future versions may implement different behaviour (e.g. RFC6555).
+ * @note The addresses are tried in parallel with staggered starts
+ * (RFC 8305), and a connection pre-opened by vlc_tls_SocketPreconnect() is
+ * used first if there is one.
  *
  * @return a transport layer socket on success or NULL on error
  */
 VLC_API vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj,
                                          const char *hostname, unsigned port);
 
+/**
+ * Opens a TCP connection ahead of time.
+ *
+ * This function connects to the specified host and port number, and keeps
+ * the connection aside for a few seconds: the next vlc_tls_SocketOpenTCP()
+ * call to the same host and port then uses it instead of connecting. This
+ * lets demuxers hide the connection latency of the next segment host while
+ * the current segment is still being downloaded.
+ *
+ * This function blocks until the connection is established, and is
+ * interruptible.
+ *
+ * @param obj optional object to log errors (may be NULL)
+ * @return 0 on success, -1 on error
+ */
+VLC_API int vlc_tls_SocketPreconnect(vlc_object_t *obj, const char *hostname,
+                                     unsigned port);
+
 /**
  * Initiates a TLS session over TCP.
  *
@@ -0,0 +1,97 @@
+/*****************************************************************************
+ * vlc_tracer.h: Pipeline tracer
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_TRACER_H
+#define VLC_TRACER_H 1
+
+/**
+ * \defgroup tracer Pipeline tracer
+ * \ingroup os
+ *
+ * The tracer records a timestamped event whenever a block or a picture goes
+ * through a stage of the playback pipeline. While the tracer is stopped,
+ * recording an event costs a single relaxed atomic load.
+ *
+ * Events are kept in per-thread ring buffers, without locking, and are
+ * written in the Chrome trace event format, as loaded by Perfetto or
+ * chrome://tracing.
+ *
+ * The tracer starts with the instance if the "trace-file" option is set, in
+ * which case the trace is written to that file when the instance is
+ * destroyed.
+ * @{
+ */
+
+/** Pipeline stages */
+enum vlc_tracer_stage
+{
+    VLC_TRACER_ACCESS_READ, /**< Data read from an access */
+    VLC_TRACER_DEMUX_OUT, /**< Block sent by a demuxer */
+    VLC_TRACER_PACKETIZER_OUT, /**< Block output by a packetizer */
+    VLC_TRACER_DECODER_IN, /**< Block passed to a decoder */
+    VLC_TRACER_DECODER_OUT, /**< Picture or audio buffer output by a decoder */
+    VLC_TRACER_FILTER_OUT, /**< Picture output by a video filter chain */
+    VLC_TRACER_VOUT_PREPARE, /**< Picture prepared by a video display */
+    VLC_TRACER_VOUT_DISPLAY, /**< Picture displayed by a video display */
+    VLC_TRACER_AOUT_PLAY, /**< Audio buffer played by an audio output */
+};
+
+struct vlc_tracer;
+
+/**
+ * Gets the tracer of the instance of an object.
+ */
+VLC_API VLC_USED
+struct vlc_tracer *vlc_object_get_tracer(vlc_object_t *obj);
+#define vlc_object_get_tracer(o) vlc_object_get_tracer(VLC_OBJECT(o))
+
+/**
+ * Records an event.
+ *
+ * \param tracer the tracer (can be NULL)
+ * \param stage pipeline stage
+ * \param id identifier of the instance of the stage (e.g. the ES or the
+ * decoder)
+ * \param ts timestamp of the data, or VLC_TICK_INVALID
+ * \param size size of the data in bytes, or 0
+ */
+VLC_API
+void vlc_tracer_Trace(struct vlc_tracer *tracer, enum vlc_tracer_stage stage,
+                      const void *id, vlc_tick_t ts, size_t size);
+
+/**
+ * Starts recording events.
+ *
+ * Only the events recorded after the last call are written by
+ * vlc_tracer_Stop().
+ */
+VLC_API void vlc_tracer_Start(struct vlc_tracer *tracer);
+
+/**
+ * Stops recording events.
+ *
+ * \param path file to write the recorded events to, or NULL
+ * \return VLC_SUCCESS, or an error code if the file could not be written
+ */
+VLC_API int vlc_tracer_Stop(struct vlc_tracer *tracer, const char *path);
+
+/** @} */
+
+#endif
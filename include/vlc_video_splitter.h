@@ -120,6 +120,59 @@ static inline void video_splitter_DeletePicture( video_splitter_t *p_splitter,
         picture_Release(pp_picture[i]);
 }
 
+static inline void video_splitter_ReleaseCrop(picture_t *pic)
+{
+    picture_Release((picture_t *)pic->p_sys);
+}
+
+/**
+ * It will create an output picture showing a part of the source picture.
+ *
+ * The pixels are not copied: the planes of the output picture point inside
+ * the source planes, and the source picture is held until the output
+ * picture is released. The source must be a software picture, and the
+ * position must be aligned on the chroma subsampling.
+ *
+ * The picture can be returned through pf_filter like the ones created by
+ * video_splitter_NewPicture.
+ *
+ * \param index index of the output, giving the picture format
+ * \param src source picture (not released)
+ * \param x horizontal position of the output in the source, in pixels
+ * \param y vertical position of the output in the source, in pixels
+ * eturn the picture or NULL on error
+ */
+static inline picture_t *video_splitter_CropPicture(video_splitter_t *splitter,
+                                                    int index, picture_t *src,
+                                                    unsigned x, unsigned y)
+{
+    const plane_t *p0 = &src->p[0];
+    picture_resource_t res = {
+        .p_sys = src,
+        .pf_destroy = video_splitter_ReleaseCrop,
+    };
+
+    for (int i = 0; i < src->i_planes; i++) {
+        const plane_t *p = &src->p[i];
+        unsigned offset = x * p0->i_pixel_pitch
+                          * p->i_visible_pitch / p0->i_visible_pitch;
+        unsigned line = y * p->i_visible_lines / p0->i_visible_lines;
+
+        offset -= offset % p->i_pixel_pitch;
+        res.p[i].p_pixels = p->p_pixels + line * p->i_pitch + offset;
+        res.p[i].i_lines = p->i_lines - line;
+        res.p[i].i_pitch = p->i_pitch;
+    }
+
+    picture_t *pic = picture_NewFromResource(&splitter->p_output[index].fmt,
+                                             &res);
+    if (pic == NULL)
+        return NULL;
+    picture_Hold(src);
+    picture_CopyProperties(pic, src);
+    return pic;
+}
+
 /* */
 video_splitter_t * video_splitter_New( vlc_object_t *, const char *psz_name, const video_format_t * );
 void video_splitter_Delete( video_splitter_t * );
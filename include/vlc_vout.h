@@ -118,6 +118,21 @@ VLC_API int vout_GetSnapshot( vout_thread_t *p_vout,
                               video_format_t *p_fmt,
                               const char *psz_format, vlc_tick_t i_timeout );
 
+/**
+ * This function will grab a picture from several video outputs at once.
+ *
+ * The snapshots are requested from all the video outputs before waiting for
+ * any of them. The pictures are returned in their rendering format, without
+ * the encoding done by vout_GetSnapshot().
+ *
+ * pp_pictures[i] is set to the picture of pp_vouts[i], or NULL if none was
+ * available within i_timeout.
+ *
+ * \return the number of pictures grabbed
+ */
+VLC_API size_t vout_GetSnapshots( vout_thread_t *const *pp_vouts, size_t i_count,
+                                  picture_t **pp_pictures, vlc_tick_t i_timeout );
+
 /* */
 VLC_API picture_t * vout_GetPicture( vout_thread_t * );
 VLC_API void vout_PutPicture( vout_thread_t *, picture_t * );
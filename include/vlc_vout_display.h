@@ -204,6 +204,7 @@ struct vout_display_owner_t {
      * from multiple threads.
      */
     void (*viewpoint_moved)(void *sys, const vlc_viewpoint_t *vp);
+    void (*vblank)(void *sys, vlc_tick_t date, vlc_tick_t period);
 };
 
 /**
@@ -444,6 +445,25 @@ static inline void vout_display_SendEventViewpointMoved(vout_display_t *vd,
         vd->owner.viewpoint_moved(vd->owner.sys, vp);
 }
 
+
+/**
+ * Reports a vertical blanking of the display.
+ *
+ * The video output then paces the pictures on the refresh cycles. This can
+ * be called from any thread.
+ *
+ * \param vd vout_display_t.
+ * \param date date of the vertical blanking (vlc_tick_now() time base).
+ * \param period refresh period of the display.
+ */
+static inline void vout_display_SendEventVblank(vout_display_t *vd,
+                                                vlc_tick_t date,
+                                                vlc_tick_t period)
+{
+    if (vd->owner.vblank)
+        vd->owner.vblank(vd->owner.sys, date, period);
+}
+
 /**
  * Helper function that applies the necessary transforms to the mouse position
  * and then calls vout_display_SendEventMouseMoved.
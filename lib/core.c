@@ -29,6 +29,7 @@
 #include <vlc/vlc.h>
 
 #include <vlc_interface.h>
+#include <vlc_tracer.h>
 
 #include <stdarg.h>
 #include <limits.h>
@@ -121,6 +122,18 @@ void libvlc_set_app_id(libvlc_instance_t *p_i, const char *id,
     var_SetString(p_libvlc, "app-icon-name", icon ? icon : "");
 }
 
+void libvlc_trace_start(libvlc_instance_t *p_i)
+{
+    vlc_tracer_Start(vlc_object_get_tracer(p_i->p_libvlc_int));
+}
+
+int libvlc_trace_stop(libvlc_instance_t *p_i, const char *path)
+{
+    struct vlc_tracer *tracer = vlc_object_get_tracer(p_i->p_libvlc_int);
+
+    return vlc_tracer_Stop(tracer, path) == VLC_SUCCESS ? 0 : -1;
+}
+
 const char * libvlc_get_version(void)
 {
     return VERSION_MESSAGE;
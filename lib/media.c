@@ -1113,6 +1113,25 @@ static void media_on_thumbnail_ready( void* data, picture_t* thumbnail )
         libvlc_picture_release( pic );
 }
 
+/* The thumbnailer is only created when first needed */
+static vlc_thumbnailer_t *libvlc_media_get_thumbnailer( libvlc_media_t *md )
+{
+    libvlc_int_t *p_libvlc = md->p_libvlc_instance->p_libvlc_int;
+    libvlc_priv_t *p_priv = libvlc_priv( p_libvlc );
+    vlc_thumbnailer_t *thumbnailer;
+
+    vlc_mutex_lock( &p_priv->lock );
+    if( p_priv->p_thumbnailer == NULL )
+    {
+        p_priv->p_thumbnailer = vlc_thumbnailer_Create( VLC_OBJECT( p_libvlc ) );
+        if( p_priv->p_thumbnailer == NULL )
+            msg_Warn( p_libvlc, "Failed to instantiate thumbnailer" );
+    }
+    thumbnailer = p_priv->p_thumbnailer;
+    vlc_mutex_unlock( &p_priv->lock );
+    return thumbnailer;
+}
+
 // Start an asynchronous thumbnail generation
 libvlc_media_thumbnail_request_t*
 libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
@@ -1122,8 +1141,8 @@ libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
                                         libvlc_time_t timeout )
 {
     assert( md );
-    libvlc_priv_t *p_priv = libvlc_priv(md->p_libvlc_instance->p_libvlc_int);
-    if( unlikely( p_priv->p_thumbnailer == NULL ) )
+    vlc_thumbnailer_t *thumbnailer = libvlc_media_get_thumbnailer( md );
+    if( unlikely( thumbnailer == NULL ) )
         return NULL;
     libvlc_media_thumbnail_request_t *req = malloc( sizeof( *req ) );
     if ( unlikely( req == NULL ) )
@@ -1135,7 +1154,7 @@ libvlc_media_thumbnail_request_by_time( libvlc_media_t *md, libvlc_time_t time,
     req->type = picture_type;
     req->crop = crop;
     libvlc_media_retain( md );
-    req->req = vlc_thumbnailer_RequestByTime( p_priv->p_thumbnailer,
+    req->req = vlc_thumbnailer_RequestByTime( thumbnailer,
         VLC_TICK_FROM_MS( time ),
         speed == libvlc_media_thumbnail_seek_fast ?
             VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
@@ -1160,8 +1179,8 @@ libvlc_media_thumbnail_request_by_pos( libvlc_media_t *md, float pos,
                                        libvlc_time_t timeout )
 {
     assert( md );
-    libvlc_priv_t *priv = libvlc_priv(md->p_libvlc_instance->p_libvlc_int);
-    if( unlikely( priv->p_thumbnailer == NULL ) )
+    vlc_thumbnailer_t *thumbnailer = libvlc_media_get_thumbnailer( md );
+    if( unlikely( thumbnailer == NULL ) )
         return NULL;
     libvlc_media_thumbnail_request_t *req = malloc( sizeof( *req ) );
     if ( unlikely( req == NULL ) )
@@ -1173,12 +1192,64 @@ libvlc_media_thumbnail_request_by_pos( libvlc_media_t *md, float pos,
     req->crop = crop;
     req->type = picture_type;
     libvlc_media_retain( md );
-    req->req = vlc_thumbnailer_RequestByPos( priv->p_thumbnailer, pos,
+    req->req = vlc_thumbnailer_RequestByPos( thumbnailer, pos,
+        speed == libvlc_media_thumbnail_seek_fast ?
+            VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
+        md->p_input_item,
+        timeout > 0 ? VLC_TICK_FROM_MS( timeout ) : VLC_TICK_INVALID,
+        media_on_thumbnail_ready, req );
+    if ( req->req == NULL )
+    {
+        free( req );
+        libvlc_media_release( md );
+        return NULL;
+    }
+    return req;
+}
+
+// Start an asynchronous generation of several thumbnails
+libvlc_media_thumbnail_request_t*
+libvlc_media_thumbnail_request_by_times( libvlc_media_t *md,
+                                         const libvlc_time_t *times,
+                                         size_t count,
+                                         libvlc_thumbnailer_seek_speed_t speed,
+                                         unsigned int width, unsigned int height,
+                                         bool crop, libvlc_picture_type_t picture_type,
+                                         libvlc_time_t timeout )
+{
+    assert( md );
+    if( count == 0 )
+        return NULL;
+    vlc_thumbnailer_t *thumbnailer = libvlc_media_get_thumbnailer( md );
+    if( unlikely( thumbnailer == NULL ) )
+        return NULL;
+    vlc_tick_t *ticks = vlc_alloc( count, sizeof( *ticks ) );
+    if ( unlikely( ticks == NULL ) )
+        return NULL;
+    for( size_t i = 0; i < count; ++i )
+        ticks[i] = VLC_TICK_FROM_MS( times[i] );
+
+    libvlc_media_thumbnail_request_t *req = malloc( sizeof( *req ) );
+    if ( unlikely( req == NULL ) )
+    {
+        free( ticks );
+        return NULL;
+    }
+
+    req->md = md;
+    req->width = width;
+    req->height = height;
+    req->crop = crop;
+    req->type = picture_type;
+    libvlc_media_retain( md );
+    req->req = vlc_thumbnailer_RequestByTimes( thumbnailer,
+        ticks, count,
         speed == libvlc_media_thumbnail_seek_fast ?
             VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
         md->p_input_item,
         timeout > 0 ? VLC_TICK_FROM_MS( timeout ) : VLC_TICK_INVALID,
         media_on_thumbnail_ready, req );
+    free( ticks );
     if ( req->req == NULL )
     {
         free( req );
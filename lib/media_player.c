@@ -40,6 +40,8 @@
 #include "libvlc_internal.h"
 #include "media_internal.h" // libvlc_media_set_state()
 #include "media_player_internal.h"
+#include "packet_internal.h"
+#include "picture_internal.h"
 #include "renderer_discoverer_internal.h"
 
 #define ES_INIT (-2) /* -1 is reserved for ES deselect */
@@ -608,6 +610,10 @@ libvlc_media_player_new( libvlc_instance_t *instance )
     var_Create (mp, "vmem-width", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-height", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
     var_Create (mp, "vmem-pitch", VLC_VAR_INTEGER | VLC_VAR_DOINHERIT);
+    var_Create (mp, "vmem-frame", VLC_VAR_ADDRESS);
+    var_Create (mp, "vmem-frame-data", VLC_VAR_ADDRESS);
+    var_Create (mp, "smem-packet", VLC_VAR_ADDRESS);
+    var_Create (mp, "smem-packet-data", VLC_VAR_ADDRESS);
 
     var_Create (mp, "vout-cb-type", VLC_VAR_INTEGER );
     var_Create( mp, "vout-cb-opaque", VLC_VAR_ADDRESS );
@@ -990,6 +996,36 @@ int libvlc_media_player_set_renderer( libvlc_media_player_t *p_mi,
     return 0;
 }
 
+static void libvlc_packet_forward( void *opaque, const es_format_t *fmt,
+                                   block_t *block )
+{
+    libvlc_media_player_t *mp = opaque;
+    libvlc_packet_t *pkt = libvlc_packet_new( block, fmt );
+
+    if( unlikely(pkt == NULL) )
+        return;
+    mp->packet.cb( mp->packet.opaque, pkt );
+    libvlc_packet_release( pkt );
+}
+
+void libvlc_media_player_set_packet_callback( libvlc_media_player_t *mp,
+                                              libvlc_media_player_packet_cb cb,
+                                              void *opaque, bool display )
+{
+    mp->packet.cb = cb;
+    mp->packet.opaque = opaque;
+    if( cb == NULL )
+    {
+        var_SetAddress( mp, "smem-packet", NULL );
+        var_SetString( mp, "sout", "" );
+        return;
+    }
+    var_SetAddress( mp, "smem-packet", libvlc_packet_forward );
+    var_SetAddress( mp, "smem-packet-data", mp );
+    var_SetString( mp, "sout", display ? "#duplicate{dst=display,dst=smem}"
+                                       : "#smem" );
+}
+
 void libvlc_video_set_callbacks( libvlc_media_player_t *mp,
     void *(*lock_cb) (void *, void **),
     void (*unlock_cb) (void *, void *, void *const *),
@@ -1005,6 +1041,31 @@ void libvlc_video_set_callbacks( libvlc_media_player_t *mp,
     var_SetString( mp, "window", "dummy" );
 }
 
+static void libvlc_video_frame_forward( void *opaque, picture_t *pic )
+{
+    libvlc_media_player_t *mp = opaque;
+    libvlc_picture_t *lpic = libvlc_picture_from_raw( pic );
+
+    if( unlikely(lpic == NULL) )
+        return;
+    mp->video_frame.cb( mp->video_frame.opaque, lpic );
+    libvlc_picture_release( lpic );
+}
+
+void libvlc_video_set_frame_callback( libvlc_media_player_t *mp,
+                                      libvlc_video_frame_cb frame_cb,
+                                      void *opaque )
+{
+    assert( frame_cb != NULL );
+    mp->video_frame.cb = frame_cb;
+    mp->video_frame.opaque = opaque;
+    var_SetAddress( mp, "vmem-frame", libvlc_video_frame_forward );
+    var_SetAddress( mp, "vmem-frame-data", mp );
+    var_SetString( mp, "dec-dev", "none" );
+    var_SetString( mp, "vout", "vmem" );
+    var_SetString( mp, "window", "dummy" );
+}
+
 void libvlc_video_set_format_callbacks( libvlc_media_player_t *mp,
                                         libvlc_video_format_cb setup,
                                         libvlc_video_cleanup_cb cleanup )
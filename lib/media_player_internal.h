@@ -49,6 +49,16 @@ struct libvlc_media_player_t
     struct libvlc_instance_t * p_libvlc_instance; /* Parent instance */
     libvlc_media_t * p_md; /* current media descriptor */
     libvlc_event_manager_t event_manager;
+
+    struct {
+        libvlc_video_frame_cb cb;
+        void *opaque;
+    } video_frame;
+
+    struct {
+        libvlc_media_player_packet_cb cb;
+        void *opaque;
+    } packet;
 };
 
 libvlc_track_description_t * libvlc_get_track_description(
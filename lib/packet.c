@@ -0,0 +1,134 @@
+/*****************************************************************************
+ * packet.c:  libvlc API elementary stream packets
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/libvlc.h>
+#include <vlc/libvlc_packet.h>
+
+#include <vlc_common.h>
+#include <vlc_atomic.h>
+
+#include "packet_internal.h"
+
+struct libvlc_packet_t
+{
+    vlc_atomic_rc_t rc;
+    block_t* block;
+    libvlc_track_type_t track_type;
+    int track_id;
+    vlc_fourcc_t codec;
+};
+
+libvlc_packet_t* libvlc_packet_new( block_t* block, const es_format_t* fmt )
+{
+    libvlc_packet_t *pkt = malloc( sizeof( *pkt ) );
+    if ( unlikely( pkt == NULL ) )
+    {
+        block_Release( block );
+        return NULL;
+    }
+    vlc_atomic_rc_init( &pkt->rc );
+    pkt->block = block;
+    pkt->track_id = fmt->i_id;
+    pkt->codec = fmt->i_codec;
+    switch ( fmt->i_cat )
+    {
+        case VIDEO_ES:
+            pkt->track_type = libvlc_track_video;
+            break;
+        case AUDIO_ES:
+            pkt->track_type = libvlc_track_audio;
+            break;
+        case SPU_ES:
+            pkt->track_type = libvlc_track_text;
+            break;
+        default:
+            pkt->track_type = libvlc_track_unknown;
+            break;
+    }
+    return pkt;
+}
+
+void libvlc_packet_retain( libvlc_packet_t* pkt )
+{
+    vlc_atomic_rc_inc( &pkt->rc );
+}
+
+void libvlc_packet_release( libvlc_packet_t* pkt )
+{
+    if ( vlc_atomic_rc_dec( &pkt->rc ) == false )
+        return;
+    block_Release( pkt->block );
+    free( pkt );
+}
+
+const unsigned char* libvlc_packet_get_buffer( const libvlc_packet_t* pkt,
+                                               size_t *size )
+{
+    assert( size != NULL );
+    *size = pkt->block->i_buffer;
+    return pkt->block->p_buffer;
+}
+
+int64_t libvlc_packet_get_pts( const libvlc_packet_t* pkt )
+{
+    if ( pkt->block->i_pts == VLC_TICK_INVALID )
+        return -1;
+    return US_FROM_VLC_TICK( pkt->block->i_pts );
+}
+
+int64_t libvlc_packet_get_dts( const libvlc_packet_t* pkt )
+{
+    if ( pkt->block->i_dts == VLC_TICK_INVALID )
+        return -1;
+    return US_FROM_VLC_TICK( pkt->block->i_dts );
+}
+
+unsigned int libvlc_packet_get_flags( const libvlc_packet_t* pkt )
+{
+    const uint32_t flags = pkt->block->i_flags;
+    unsigned int ret = 0;
+
+    if ( flags & BLOCK_FLAG_TYPE_I )
+        ret |= libvlc_packet_Keyframe;
+    if ( flags & BLOCK_FLAG_DISCONTINUITY )
+        ret |= libvlc_packet_Discontinuity;
+    if ( flags & BLOCK_FLAG_CORRUPTED )
+        ret |= libvlc_packet_Corrupted;
+    return ret;
+}
+
+libvlc_track_type_t libvlc_packet_get_track_type( const libvlc_packet_t* pkt )
+{
+    return pkt->track_type;
+}
+
+int libvlc_packet_get_track_id( const libvlc_packet_t* pkt )
+{
+    return pkt->track_id;
+}
+
+uint32_t libvlc_packet_get_codec( const libvlc_packet_t* pkt )
+{
+    return pkt->codec;
+}
@@ -0,0 +1,38 @@
+/*****************************************************************************
+ * packet_internal.h:  libvlc API internal packet management
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef PACKET_INTERNAL_H
+#define PACKET_INTERNAL_H
+
+#include <vlc_es.h>
+#include <vlc_block.h>
+
+/**
+ * \brief libvlc_packet_new Wraps a libvlccore's block_t to a libvlc_packet_t
+ * \param p_block Input block, whose ownership is transferred
+ * \param p_fmt Format of the elementary stream of the block
+ * \return An opaque libvlc_packet_t, or NULL on error (the block is then
+ * released)
+ *
+ * The returned packet must be released through libvlc_packet_release
+ */
+libvlc_packet_t* libvlc_packet_new( block_t* p_block, const es_format_t* p_fmt );
+
+#endif /* PACKET_INTERNAL_H */
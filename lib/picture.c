@@ -44,6 +44,7 @@ struct libvlc_picture_t
     video_format_t fmt;
     libvlc_time_t time;
     input_attachment_t* attachment;
+    picture_t* raw;
 };
 
 struct libvlc_picture_list_t
@@ -64,6 +65,7 @@ libvlc_picture_t* libvlc_picture_new( vlc_object_t* p_obj, picture_t* input,
     pic->type = type;
     pic->time = MS_FROM_VLC_TICK( input->date );
     pic->attachment = NULL;
+    pic->raw = NULL;
     vlc_fourcc_t format;
     switch ( type )
     {
@@ -76,6 +78,7 @@ libvlc_picture_t* libvlc_picture_new( vlc_object_t* p_obj, picture_t* input,
         case libvlc_picture_Png:
             format = VLC_CODEC_PNG;
             break;
+        case libvlc_picture_Raw:
         default:
             vlc_assert_unreachable();
     }
@@ -89,6 +92,21 @@ libvlc_picture_t* libvlc_picture_new( vlc_object_t* p_obj, picture_t* input,
     return pic;
 }
 
+libvlc_picture_t* libvlc_picture_from_raw( picture_t* input )
+{
+    libvlc_picture_t *pic = malloc( sizeof( *pic ) );
+    if ( unlikely( pic == NULL ) )
+        return NULL;
+    vlc_atomic_rc_init( &pic->rc );
+    pic->type = libvlc_picture_Raw;
+    pic->converted = NULL;
+    pic->time = MS_FROM_VLC_TICK( input->date );
+    pic->attachment = NULL;
+    pic->raw = picture_Hold( input );
+    video_format_Copy( &pic->fmt, &input->format );
+    return pic;
+}
+
 static void libvlc_picture_block_release( block_t* block )
 {
     free( block );
@@ -115,6 +133,7 @@ static libvlc_picture_t* libvlc_picture_from_attachment( input_attachment_t* att
     }
     vlc_atomic_rc_init( &pic->rc );
     pic->attachment = vlc_input_attachment_Hold( attachment );
+    pic->raw = NULL;
     pic->time = VLC_TICK_INVALID;
     block_Init( pic->converted, &block_cbs, attachment->p_data,
                 attachment->i_data);
@@ -148,11 +167,15 @@ void libvlc_picture_release( libvlc_picture_t* pic )
         block_Release( pic->converted );
     if ( pic->attachment )
         vlc_input_attachment_Release( pic->attachment );
+    if ( pic->raw )
+        picture_Release( pic->raw );
     free( pic );
 }
 
 int libvlc_picture_save( const libvlc_picture_t* pic, const char* path )
 {
+    if ( pic->converted == NULL )
+        return -1;
     FILE* file = vlc_fopen( path, "wb" );
     if ( !file )
         return -1;
@@ -166,6 +189,7 @@ const unsigned char* libvlc_picture_get_buffer( const libvlc_picture_t* pic,
                                                 size_t *size )
 {
     assert( size != NULL );
+    assert( pic->type != libvlc_picture_Raw );
     *size = pic->converted->i_buffer;
     return pic->converted->p_buffer;
 }
@@ -177,6 +201,8 @@ libvlc_picture_type_t libvlc_picture_type( const libvlc_picture_t* pic )
 
 unsigned int libvlc_picture_get_stride( const libvlc_picture_t *pic )
 {
+    if ( pic->type == libvlc_picture_Raw )
+        return pic->raw->p[0].i_pitch;
     assert( pic->type == libvlc_picture_Argb );
     return pic->fmt.i_width * pic->fmt.i_bits_per_pixel / 8;
 }
@@ -196,6 +222,31 @@ libvlc_time_t libvlc_picture_get_time( const libvlc_picture_t* pic )
     return pic->time;
 }
 
+void libvlc_picture_get_chroma( const libvlc_picture_t* pic, char *chroma )
+{
+    assert( pic->type == libvlc_picture_Raw );
+    memcpy( chroma, &pic->fmt.i_chroma, 4 );
+}
+
+unsigned int libvlc_picture_get_plane_count( const libvlc_picture_t* pic )
+{
+    assert( pic->type == libvlc_picture_Raw );
+    return pic->raw->i_planes;
+}
+
+const unsigned char* libvlc_picture_get_plane( const libvlc_picture_t* pic,
+                                               unsigned int plane,
+                                               unsigned int *pitch,
+                                               unsigned int *lines )
+{
+    assert( pic->type == libvlc_picture_Raw );
+    assert( plane < (unsigned)pic->raw->i_planes );
+    const plane_t *p = &pic->raw->p[plane];
+    *pitch = p->i_pitch;
+    *lines = p->i_lines;
+    return p->p_pixels;
+}
+
 libvlc_picture_list_t* libvlc_picture_list_from_attachments( input_attachment_t** attachments,
                                                              size_t nb_attachments )
 {
@@ -44,6 +44,16 @@ libvlc_picture_t* libvlc_picture_new( vlc_object_t* p_obj, picture_t* p_pic,
                                       unsigned int i_width, unsigned int i_height,
                                       bool b_crop );
 
+/**
+ * \brief libvlc_picture_from_raw Wraps a decoded picture without conversion
+ * \param p_pic A picture with its pixels in main memory
+ * \return An opaque libvlc_picture_t of type libvlc_picture_Raw
+ *
+ * The picture is held until the returned picture is released through
+ * libvlc_picture_release
+ */
+libvlc_picture_t* libvlc_picture_from_raw( picture_t* p_pic );
+
 libvlc_picture_list_t* libvlc_picture_list_from_attachments( input_attachment_t** attachments,
                                                              size_t nb_attachments );
 
@@ -28,6 +28,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>
+#include <vlc_interrupt.h>
 
 struct access_entry
 {
@@ -46,9 +47,76 @@ typedef struct
     bool can_control_pace;
     uint64_t size;
     vlc_tick_t caching;
+
+    /* Next input, opened while the current one is read */
+    struct
+    {
+        struct access_entry *entry; /* NULL if not opening */
+        stream_t *access;
+        vlc_thread_t thread;
+        vlc_interrupt_t *interrupt;
+    } ahead;
 } access_sys_t;
 
-static stream_t *GetAccess(stream_t *access)
+static void *OpenAheadThread(void *data)
+{
+    stream_t *access = data;
+    access_sys_t *sys = access->p_sys;
+
+    vlc_interrupt_set(sys->ahead.interrupt);
+    sys->ahead.access = vlc_access_NewMRL(VLC_OBJECT(access),
+                                          sys->ahead.entry->mrl);
+    return NULL;
+}
+
+static void OpenAhead(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->next == NULL || sys->ahead.entry != NULL)
+        return;
+
+    sys->ahead.interrupt = vlc_interrupt_create();
+    if (unlikely(sys->ahead.interrupt == NULL))
+        return;
+
+    sys->ahead.entry = sys->next;
+    sys->ahead.access = NULL;
+
+    if (vlc_clone(&sys->ahead.thread, OpenAheadThread, access,
+                  VLC_THREAD_PRIORITY_LOW))
+    {
+        vlc_interrupt_destroy(sys->ahead.interrupt);
+        sys->ahead.entry = NULL;
+    }
+}
+
+/* Waits for the input opened ahead, returns it if it is the entry e */
+static stream_t *TakeAhead(stream_t *access, const struct access_entry *e,
+                           bool abort)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->ahead.entry == NULL)
+        return NULL;
+
+    if (abort)
+        vlc_interrupt_kill(sys->ahead.interrupt);
+    vlc_join(sys->ahead.thread, NULL);
+    vlc_interrupt_destroy(sys->ahead.interrupt);
+
+    stream_t *a = sys->ahead.access;
+    if (a != NULL && sys->ahead.entry != e)
+    {
+        vlc_stream_Delete(a);
+        a = NULL;
+    }
+    sys->ahead.entry = NULL;
+    sys->ahead.access = NULL;
+    return a;
+}
+
+static stream_t *GetAccess(stream_t *access, bool ahead)
 {
     access_sys_t *sys = access->p_sys;
     stream_t *a = sys->access;
@@ -65,18 +133,25 @@ static stream_t *GetAccess(stream_t *access)
     if (sys->next == NULL)
         return NULL;
 
-    a = vlc_access_NewMRL(VLC_OBJECT(access), sys->next->mrl);
+    a = TakeAhead(access, sys->next, false);
+    if (a == NULL)
+        a = vlc_access_NewMRL(VLC_OBJECT(access), sys->next->mrl);
     if (a == NULL)
         return NULL;
 
     sys->access = a;
     sys->next = sys->next->next;
+
+    /* Open the next input while this one is read, so that the switch does
+     * not stall the playback */
+    if (ahead)
+        OpenAhead(access);
     return a;
 }
 
 static ssize_t Read(stream_t *access, void *buf, size_t len)
 {
-    stream_t *a = GetAccess(access);
+    stream_t *a = GetAccess(access, true);
     if (a == NULL)
         return 0;
 
@@ -91,7 +166,7 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
 
 static block_t *Block(stream_t *access, bool *restrict eof)
 {
-    stream_t *a = GetAccess(access);
+    stream_t *a = GetAccess(access, true);
     if (a == NULL)
     {
         *eof = true;
@@ -111,11 +186,12 @@ static int Seek(stream_t *access, uint64_t position)
         sys->access = NULL;
     }
 
+    TakeAhead(access, NULL, true);
     sys->next = sys->first;
 
     for (uint64_t offset = 0;;)
     {
-        stream_t *a = GetAccess(access);
+        stream_t *a = GetAccess(access, false);
         if (a == NULL)
             break;
 
@@ -132,6 +208,7 @@ static int Seek(stream_t *access, uint64_t position)
         {
             if (vlc_stream_Seek(a, position - offset))
                 break;
+            OpenAhead(access);
             return VLC_SUCCESS;
         }
 
@@ -200,6 +277,7 @@ static int Open(vlc_object_t *obj)
     bool read_cb = true;
 
     sys->access = NULL;
+    sys->ahead.entry = NULL;
     sys->can_seek = true;
     sys->can_seek_fast = true;
     sys->can_pause = true;
@@ -288,6 +366,7 @@ static void Close(vlc_object_t *obj)
     stream_t *access = (stream_t *)obj;
     access_sys_t *sys = access->p_sys;
 
+    TakeAhead(access, NULL, true);
     if (sys->access != NULL)
         vlc_stream_Delete(sys->access);
 
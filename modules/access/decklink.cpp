@@ -45,6 +45,7 @@
 #include "sdi.h"
 
 #include <atomic>
+#include <new>
 
 static int  Open (vlc_object_t *);
 static void Close(vlc_object_t *);
@@ -136,6 +137,23 @@ namespace {
 
 class DeckLinkCaptureDelegate;
 
+/* The captured frames are lent to the pipeline instead of being copied.
+ * The driver only has a few buffers, so past the limit they are copied
+ * and handed back to the driver at once. */
+#define DECKLINK_LENT_MAX 4
+
+struct decklink_lend_pool
+{
+    std::atomic_uint refs; /* the demux and the lent frames */
+};
+
+struct decklink_block
+{
+    block_t self;
+    IUnknown *frame;
+    decklink_lend_pool *pool;
+};
+
 struct demux_sys_t
 {
     IDeckLink *card;
@@ -162,10 +180,57 @@ struct demux_sys_t
     int audio_streams;
 
     bool tenbits;
+
+    decklink_lend_pool *lend_pool;
 };
 
 } // namespace
 
+static void LendPoolRelease(decklink_lend_pool *pool)
+{
+    if (pool->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        delete pool;
+}
+
+static void LentBlockRelease(block_t *block)
+{
+    decklink_block *b = reinterpret_cast<decklink_block *>(block);
+
+    b->frame->Release();
+    LendPoolRelease(b->pool);
+    free(b);
+}
+
+static const struct vlc_block_callbacks LentBlockCallbacks = {
+    LentBlockRelease,
+};
+
+/**
+ * Wraps a driver buffer in a block holding a reference to its frame.
+ * @return NULL if too many frames are lent already
+ */
+static block_t *LendBlock(demux_sys_t *sys, IUnknown *frame,
+                          void *buf, size_t size)
+{
+    decklink_lend_pool *pool = sys->lend_pool;
+
+    if (pool->refs.fetch_add(1, std::memory_order_relaxed) > DECKLINK_LENT_MAX) {
+        LendPoolRelease(pool);
+        return NULL;
+    }
+
+    decklink_block *b = (decklink_block *)malloc(sizeof(*b));
+    if (unlikely(b == NULL)) {
+        LendPoolRelease(pool);
+        return NULL;
+    }
+
+    frame->AddRef();
+    b->frame = frame;
+    b->pool = pool;
+    return block_Init(&b->self, &LentBlockCallbacks, buf, size);
+}
+
 static const char *GetFieldDominance(BMDFieldDominance dom, uint32_t *flags)
 {
     switch(dom)
@@ -340,13 +405,20 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                 bpp = 2;
                 break;
         };
-        block_t *video_frame = block_Alloc(width * height * bpp);
-        if (!video_frame)
-            return S_OK;
-
         const uint32_t *frame_bytes;
         videoFrame->GetBytes((void**)&frame_bytes);
 
+        block_t *video_frame = NULL;
+        if (sys->video_fmt.i_codec != VLC_CODEC_I422_10L
+         && stride == width * bpp)
+            video_frame = LendBlock(sys, videoFrame, (void *)frame_bytes,
+                                    stride * height);
+        const bool lent = video_frame != NULL;
+        if (!lent)
+            video_frame = block_Alloc(width * height * bpp);
+        if (!video_frame)
+            return S_OK;
+
         BMDTimeValue stream_time, frame_duration;
         videoFrame->GetStreamTime(&stream_time, &frame_duration, CLOCK_FREQ);
         video_frame->i_flags = BLOCK_FLAG_TYPE_I | sys->dominance_flags;
@@ -385,6 +457,8 @@ HRESULT DeckLinkCaptureDelegate::VideoInputFrameArrived(IDeckLinkVideoInputFrame
                 }
                 vanc->Release();
             }
+        } else if (lent) {
+            /* the block points to the driver buffer */
         } else if (sys->video_fmt.i_codec == VLC_CODEC_UYVY) {
             for (int y = 0; y < height; ++y) {
                 const uint8_t *src = (const uint8_t *)frame_bytes + stride * y;
@@ -540,6 +614,13 @@ static int Open(vlc_object_t *p_this)
     if (!sys)
         return VLC_ENOMEM;
 
+    sys->lend_pool = new (std::nothrow) decklink_lend_pool;
+    if (!sys->lend_pool) {
+        free(sys);
+        return VLC_ENOMEM;
+    }
+    sys->lend_pool->refs = 1;
+
     vlc_mutex_init(&sys->pts_lock);
 
     sys->tenbits = var_InheritBool(p_this, "decklink-tenbits");
@@ -782,6 +863,8 @@ static void Close(vlc_object_t *p_this)
     if (sys->delegate)
         sys->delegate->Release();
 
+    /* the frames still in the pipeline release the pool */
+    LendPoolRelease(sys->lend_pool);
     free(sys);
 }
 
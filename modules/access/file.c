@@ -52,6 +52,14 @@
 #   include <unistd.h>
 #endif
 #include <dirent.h>
+#ifdef HAVE_MMAP
+#   include <sys/mman.h>
+#endif
+#ifdef HAVE_LIBURING
+#   include <poll.h>
+#   include <sys/eventfd.h>
+#   include <liburing.h>
+#endif
 
 #include <vlc_common.h>
 #include "fs.h"
@@ -63,13 +71,49 @@
 #include <vlc_url.h>
 #include <vlc_interrupt.h>
 
+#ifdef HAVE_LIBURING
+/* Number of reads queued ahead */
+#define URING_DEPTH 4
+/* Size of each read */
+#define URING_SIZE (1 << 18)
+
+struct file_uring_buf
+{
+    uint64_t offset;
+    int length; /* bytes read, or negated error code */
+    bool done;
+};
+
+struct file_uring
+{
+    struct io_uring ring;
+    int efd; /* completion notifications */
+    char *data; /* registered buffers */
+    struct file_uring_buf bufs[URING_DEPTH];
+    unsigned head; /* first queued buffer */
+    unsigned queued; /* queued buffers */
+    unsigned in_flight; /* buffers not completed yet */
+    uint64_t pos; /* offset of the next byte to return */
+};
+#endif
+
 typedef struct
 {
     int fd;
 
     bool b_pace_control;
+#ifdef HAVE_MMAP
+    uint64_t offset; /* position in the file (memory-mapped mode) */
+    size_t page_size;
+#endif
+#ifdef HAVE_LIBURING
+    struct file_uring *uring;
+#endif
 } access_sys_t;
 
+/* Size of a memory-mapped block */
+#define MMAP_SIZE (1 << 20)
+
 #if !defined (_WIN32) && !defined (__OS2__)
 static bool IsRemote (int fd)
 {
@@ -129,6 +173,16 @@ static bool IsRemote (const char *path)
 static ssize_t Read (stream_t *, void *, size_t);
 static int FileSeek (stream_t *, uint64_t);
 static int FileControl (stream_t *, int, va_list);
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *, bool *);
+static int MmapSeek (stream_t *, uint64_t);
+#endif
+#ifdef HAVE_LIBURING
+static struct file_uring *UringCreate (int);
+static void UringDestroy (struct file_uring *);
+static ssize_t UringRead (stream_t *, void *, size_t);
+static int UringSeek (stream_t *, uint64_t);
+#endif
 
 /*****************************************************************************
  * FileOpen: open the file
@@ -213,6 +267,9 @@ int FileOpen( vlc_object_t *p_this )
     p_access->pf_control = FileControl;
     p_access->p_sys = p_sys;
     p_sys->fd = fd;
+#ifdef HAVE_LIBURING
+    p_sys->uring = NULL;
+#endif
 
     if (S_ISREG (st.st_mode) || S_ISBLK (st.st_mode))
     {
@@ -231,6 +288,36 @@ int FileOpen( vlc_object_t *p_this )
             fcntl (fd, F_RDAHEAD, 0);
         else
             fcntl (fd, F_RDAHEAD, 1);
+#endif
+#ifdef HAVE_MMAP
+        /* Return blocks mapping the file, instead of copying it */
+        if (S_ISREG (st.st_mode) && var_InheritBool (p_access, "file-mmap")
+         && !IsRemote(fd, p_access->psz_filepath))
+        {
+            p_sys->offset = 0;
+            p_sys->page_size = sysconf (_SC_PAGESIZE);
+            p_access->pf_read = NULL;
+            p_access->pf_block = MmapBlock;
+            p_access->pf_seek = MmapSeek;
+            msg_Dbg (p_access, "using memory-mapped file");
+        }
+#endif
+#ifdef HAVE_LIBURING
+        /* Queue the reads ahead asynchronously */
+        if (p_access->pf_read != NULL
+         && var_InheritBool (p_access, "file-io-uring"))
+        {
+            p_sys->uring = UringCreate (fd);
+            if (p_sys->uring != NULL)
+            {
+                p_access->pf_read = UringRead;
+                p_access->pf_seek = UringSeek;
+                msg_Dbg (p_access, "using io_uring");
+            }
+            else
+                msg_Warn (p_access, "cannot use io_uring: %s",
+                          vlc_strerror_c(errno));
+        }
 #endif
     }
     else
@@ -253,7 +340,7 @@ void FileClose (vlc_object_t * p_this)
 {
     stream_t     *p_access = (stream_t*)p_this;
 
-    if (p_access->pf_read == NULL)
+    if (p_access->pf_readdir != NULL)
     {
         DirClose (p_this);
         return;
@@ -261,6 +348,10 @@ void FileClose (vlc_object_t * p_this)
 
     access_sys_t *p_sys = p_access->p_sys;
 
+#ifdef HAVE_LIBURING
+    if (p_sys->uring != NULL)
+        UringDestroy (p_sys->uring);
+#endif
     vlc_close (p_sys->fd);
 }
 
@@ -287,6 +378,298 @@ static ssize_t Read (stream_t *p_access, void *p_buffer, size_t i_len)
     return val;
 }
 
+#ifdef HAVE_MMAP
+static block_t *MmapBlock (stream_t *p_access, bool *restrict eof)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    struct stat st;
+
+    /* The file may be growing */
+    if (fstat (p_sys->fd, &st))
+    {
+        msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+    if (p_sys->offset >= (uint64_t)st.st_size)
+    {
+        *eof = true;
+        return NULL;
+    }
+
+    /* The mapping must start on a page boundary */
+    uint64_t start = p_sys->offset & ~(uint64_t)(p_sys->page_size - 1);
+    size_t skip = p_sys->offset - start;
+    size_t length = __MIN((uint64_t)st.st_size - p_sys->offset,
+                          MMAP_SIZE - skip);
+
+    void *addr = mmap (NULL, skip + length, PROT_READ, MAP_SHARED,
+                       p_sys->fd, start);
+    if (addr == MAP_FAILED)
+    {
+        msg_Err (p_access, "memory mapping error: %s", vlc_strerror_c(errno));
+        *eof = true;
+        return NULL;
+    }
+#ifdef HAVE_POSIX_MADVISE
+    posix_madvise (addr, skip + length, POSIX_MADV_SEQUENTIAL);
+#endif
+
+    block_t *block = block_mmap_Alloc ((char *)addr + skip, length);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    p_sys->offset += length;
+    /* Read the next block ahead */
+    posix_fadvise (p_sys->fd, p_sys->offset, MMAP_SIZE, POSIX_FADV_WILLNEED);
+    return block;
+}
+
+static int MmapSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    p_sys->offset = i_pos;
+    posix_fadvise (p_sys->fd, i_pos, MMAP_SIZE, POSIX_FADV_WILLNEED);
+    return VLC_SUCCESS;
+}
+#endif
+
+#ifdef HAVE_LIBURING
+static struct file_uring *UringCreate (int fd)
+{
+    struct file_uring *u = malloc (sizeof (*u));
+    if (unlikely(u == NULL))
+        return NULL;
+
+    u->data = aligned_alloc (4096, URING_DEPTH * URING_SIZE);
+    if (unlikely(u->data == NULL))
+        goto error;
+
+    u->efd = eventfd (0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (u->efd == -1)
+        goto error;
+
+    int val = io_uring_queue_init (URING_DEPTH, &u->ring, 0);
+    if (val < 0)
+    {
+        errno = -val;
+        vlc_close (u->efd);
+        goto error;
+    }
+
+    struct iovec iov[URING_DEPTH];
+    for (unsigned i = 0; i < URING_DEPTH; i++)
+    {
+        iov[i].iov_base = u->data + i * URING_SIZE;
+        iov[i].iov_len = URING_SIZE;
+    }
+
+    /* The file descriptor and buffers are registered once, rather than
+     * looked up and mapped by the kernel on each read. */
+    val = io_uring_register_buffers (&u->ring, iov, URING_DEPTH);
+    if (val == 0)
+        val = io_uring_register_files (&u->ring, &fd, 1);
+    if (val == 0)
+        val = io_uring_register_eventfd (&u->ring, u->efd);
+    if (val < 0)
+    {
+        errno = -val;
+        io_uring_queue_exit (&u->ring);
+        vlc_close (u->efd);
+        goto error;
+    }
+
+    u->head = 0;
+    u->queued = 0;
+    u->in_flight = 0;
+    u->pos = 0;
+    return u;
+
+error:
+    free (u->data);
+    free (u);
+    return NULL;
+}
+
+static void UringComplete (struct file_uring *u, struct io_uring_cqe *cqe)
+{
+    struct file_uring_buf *b = &u->bufs[(uintptr_t)io_uring_cqe_get_data (cqe)];
+
+    b->length = cqe->res;
+    b->done = true;
+    assert (u->in_flight > 0);
+    u->in_flight--;
+    io_uring_cqe_seen (&u->ring, cqe);
+}
+
+/* Waits for a buffer to be completed, or for an interruption */
+static int UringWait (struct file_uring *u, const struct file_uring_buf *b)
+{
+    while (!b->done)
+    {
+        struct io_uring_cqe *cqe;
+
+        if (io_uring_peek_cqe (&u->ring, &cqe) == 0)
+        {
+            UringComplete (u, cqe);
+            continue;
+        }
+
+        struct pollfd ufd = { .fd = u->efd, .events = POLLIN };
+        uint64_t count;
+
+        if (vlc_poll_i11e (&ufd, 1, -1) < 0)
+            return -1;
+        if (read (u->efd, &count, sizeof (count)) < 0 && errno != EAGAIN)
+            return -1;
+    }
+    return 0;
+}
+
+static int UringSubmit (struct file_uring *u, uint64_t offset)
+{
+    unsigned idx = (u->head + u->queued) % URING_DEPTH;
+    struct file_uring_buf *b = &u->bufs[idx];
+    struct io_uring_sqe *sqe = io_uring_get_sqe (&u->ring);
+
+    if (unlikely(sqe == NULL))
+        return -1;
+
+    io_uring_prep_read_fixed (sqe, 0, u->data + idx * URING_SIZE, URING_SIZE,
+                              offset, idx);
+    io_uring_sqe_set_flags (sqe, IOSQE_FIXED_FILE);
+    io_uring_sqe_set_data (sqe, (void *)(uintptr_t)idx);
+    b->offset = offset;
+    b->done = false;
+    u->queued++;
+    u->in_flight++;
+    return 0;
+}
+
+/* Waits for all the submitted reads */
+static int UringDrain (struct file_uring *u)
+{
+    while (u->in_flight > 0)
+    {
+        struct io_uring_cqe *cqe;
+        int val = io_uring_wait_cqe (&u->ring, &cqe);
+
+        if (val < 0)
+        {
+            if (val == -EINTR)
+                continue;
+            errno = -val;
+            return -1;
+        }
+        UringComplete (u, cqe);
+    }
+    return 0;
+}
+
+/* Discards the queued reads, and queues new ones from the current offset */
+static int UringReset (struct file_uring *u)
+{
+    if (UringDrain (u))
+        return -1;
+
+    u->head = 0;
+    u->queued = 0;
+    for (unsigned i = 0; i < URING_DEPTH; i++)
+        if (UringSubmit (u, u->pos + i * URING_SIZE))
+            break;
+    io_uring_submit (&u->ring);
+    return 0;
+}
+
+static ssize_t UringRead (stream_t *p_access, void *p_buffer, size_t i_len)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    struct file_uring *u = p_sys->uring;
+
+    for (;;)
+    {
+        struct file_uring_buf *b = &u->bufs[u->head];
+
+        if (u->queued == 0 || u->pos < b->offset
+         || u->pos - b->offset >= URING_SIZE)
+        {   /* Not read ahead (after a seek) */
+            if (UringReset (u))
+                goto error;
+            continue;
+        }
+
+        if (UringWait (u, b))
+        {
+            if (errno == EINTR)
+                return -1;
+            goto error;
+        }
+
+        if (b->length < 0)
+        {
+            errno = -b->length;
+            u->queued = 0; /* retry on the next read */
+            goto error;
+        }
+
+        size_t skip = u->pos - b->offset;
+
+        if (skip >= (size_t)b->length)
+        {
+            if (b->length == 0)
+                return 0; /* end of file */
+            /* Short read, read again from the current offset */
+            u->queued = 0;
+            continue;
+        }
+
+        size_t copy = b->length - skip;
+        if (copy > i_len)
+            copy = i_len;
+
+        memcpy (p_buffer, u->data + u->head * URING_SIZE + skip, copy);
+        u->pos += copy;
+
+        if (skip + copy == URING_SIZE)
+        {   /* Reuse the buffer to read after the last queued one */
+            const struct file_uring_buf *last =
+                &u->bufs[(u->head + u->queued - 1) % URING_DEPTH];
+            uint64_t offset = last->offset + URING_SIZE;
+
+            u->head = (u->head + 1) % URING_DEPTH;
+            u->queued--;
+            if (UringSubmit (u, offset) == 0)
+                io_uring_submit (&u->ring);
+        }
+        return copy;
+    }
+
+error:
+    msg_Err (p_access, "read error: %s", vlc_strerror_c(errno));
+    return 0;
+}
+
+static int UringSeek (stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+
+    /* The queued reads are discarded by the next read, if need be */
+    p_sys->uring->pos = i_pos;
+    return VLC_SUCCESS;
+}
+
+static void UringDestroy (struct file_uring *u)
+{
+    /* The kernel must be done with the buffers before they are freed */
+    UringDrain (u);
+    io_uring_queue_exit (&u->ring);
+    vlc_close (u->efd);
+    free (u->data);
+    free (u);
+}
+#endif
+
 /*****************************************************************************
  * Seek: seek to a specific location in a file
  *****************************************************************************/
@@ -39,6 +39,14 @@ vlc_module_begin ()
     set_capability( "access", 50 )
     add_shortcut( "file", "fd", "stream" )
     set_callbacks( FileOpen, FileClose )
+    add_bool( "file-mmap", false, N_("Memory-mapped file"),
+              N_("Read local files through memory mappings instead of "
+                 "copying them. The file must not be truncated while it "
+                 "is played."), true )
+#ifdef HAVE_LIBURING
+    add_bool( "file-io-uring", false, N_("Asynchronous file reads"),
+              N_("Queue the reads of local files ahead with io_uring."), true )
+#endif
 
     add_submodule()
     set_section( N_("Directory" ), NULL )
@@ -251,6 +251,12 @@ static int Open(vlc_object_t *obj)
     }
     else
     {
+        unsigned parallel = var_InheritInteger(obj, "http-parallel");
+
+        if (parallel > 1
+         && vlc_http_file_set_parallel(sys->resource, parallel) == 0)
+            msg_Dbg(access, "using up to %u parallel requests", parallel);
+
         access->pf_block = FileRead;
         access->pf_seek = FileSeek;
         access->pf_control = FileControl;
@@ -275,7 +281,10 @@ static void Close(vlc_object_t *obj)
     stream_t *access = (stream_t *)obj;
     access_sys_t *sys = access->p_sys;
 
-    vlc_http_res_destroy(sys->resource);
+    if (access->pf_seek != NULL)
+        vlc_http_file_destroy(sys->resource);
+    else
+        vlc_http_res_destroy(sys->resource);
     vlc_http_mgr_destroy(sys->manager);
     free(sys);
 }
@@ -306,4 +315,17 @@ vlc_module_begin()
                   "e.g. \"FooBar/1.2.3\"."), true)
         change_safe()
         change_private()
+    add_integer_with_range("http-max-connections", 4, 1, 64,
+                           N_("Maximum connections"),
+                           N_("Maximum number of server connections kept "
+                              "open for reuse."), true)
+    add_integer_with_range("http-idle-timeout", 30, 1, 3600,
+                           N_("Idle connection timeout (s)"),
+                           N_("Time after which an unused server connection "
+                              "is closed."), true)
+    add_integer_with_range("http-parallel", 1, 1, 16,
+                           N_("Parallel requests"),
+                           N_("Maximum number of concurrent range requests "
+                              "to fetch a file. Servers may limit the "
+                              "bandwidth of each connection."), true)
 vlc_module_end()
@@ -23,6 +23,8 @@
 #endif
 
 #include <assert.h>
+#include <stdlib.h>
+#include <strings.h>
 #include <vlc_common.h>
 #include <vlc_network.h>
 #include <vlc_tls.h>
@@ -96,50 +98,146 @@ static char *vlc_http_proxy_find(const char *hostname, unsigned port,
 }
 
 
+/** Default maximum number of pooled connections */
+#define VLC_HTTP_MGR_CONNS 4
+/** Default idle time (in seconds) before a pooled connection is closed */
+#define VLC_HTTP_MGR_IDLE 30
+
+/**
+ * Pooled connection
+ *
+ * Connections are keyed by scheme, server host name and port. The proxy (if
+ * any) is determined from the same parameters, so it is part of the key too.
+ */
+struct vlc_http_mgr_conn
+{
+    struct vlc_http_conn *conn;
+    char *host;
+    unsigned port;
+    bool https;
+    vlc_tick_t last_used;
+};
+
 struct vlc_http_mgr
 {
     struct vlc_logger *logger;
     vlc_object_t *obj;
     vlc_tls_client_t *creds;
     struct vlc_http_cookie_jar_t *jar;
-    struct vlc_http_conn *conn;
+    vlc_mutex_t lock; /**< Serializes requests from different threads */
+    struct vlc_http_mgr_conn *conns;
+    size_t count;
+    size_t max_conns;
+    vlc_tick_t idle_timeout;
 };
 
-static struct vlc_http_conn *vlc_http_mgr_find(struct vlc_http_mgr *mgr,
-                                               const char *host, unsigned port)
+static void vlc_http_mgr_remove(struct vlc_http_mgr *mgr, size_t i)
+{
+    assert(i < mgr->count);
+
+    vlc_http_conn_release(mgr->conns[i].conn);
+    free(mgr->conns[i].host);
+    mgr->conns[i] = mgr->conns[--mgr->count];
+}
+
+/**
+ * Closes connections left unused for too long.
+ */
+static void vlc_http_mgr_expire(struct vlc_http_mgr *mgr, vlc_tick_t now)
 {
-    (void) host; (void) port;
-    return mgr->conn;
+    for (size_t i = 0; i < mgr->count;)
+    {
+        if (now - mgr->conns[i].last_used > mgr->idle_timeout)
+            vlc_http_mgr_remove(mgr, i);
+        else
+            i++;
+    }
 }
 
-static void vlc_http_mgr_release(struct vlc_http_mgr *mgr,
-                                 struct vlc_http_conn *conn)
+/**
+ * Finds the most recently used pooled connection for a given origin.
+ *
+ * @return an index in the pool, or -1 if none
+ */
+static ssize_t vlc_http_mgr_find(struct vlc_http_mgr *mgr, bool https,
+                                 const char *host, unsigned port)
 {
-    assert(mgr->conn == conn);
-    mgr->conn = NULL;
+    ssize_t found = -1;
+
+    for (size_t i = 0; i < mgr->count; i++)
+    {
+        const struct vlc_http_mgr_conn *c = &mgr->conns[i];
 
-    vlc_http_conn_release(conn);
+        if (c->https == https && c->port == port && !strcasecmp(c->host, host)
+         && (found < 0 || c->last_used > mgr->conns[found].last_used))
+            found = i;
+    }
+    return found;
+}
+
+/**
+ * Adds a connection to the pool, evicting the least recently used one if
+ * the pool is full.
+ */
+static int vlc_http_mgr_add(struct vlc_http_mgr *mgr, bool https,
+                            const char *host, unsigned port,
+                            struct vlc_http_conn *conn)
+{
+    char *name = strdup(host);
+    if (unlikely(name == NULL))
+        return -1;
+
+    if (mgr->count >= mgr->max_conns)
+    {
+        size_t lru = 0;
+
+        for (size_t i = 1; i < mgr->count; i++)
+            if (mgr->conns[i].last_used < mgr->conns[lru].last_used)
+                lru = i;
+        vlc_http_mgr_remove(mgr, lru);
+    }
+
+    assert(mgr->count < mgr->max_conns);
+    mgr->conns[mgr->count++] = (struct vlc_http_mgr_conn) {
+        .conn = conn,
+        .host = name,
+        .port = port,
+        .https = https,
+        .last_used = vlc_tick_now(),
+    };
+    return 0;
 }
 
 static
-struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr,
+struct vlc_http_msg *vlc_http_mgr_reuse(struct vlc_http_mgr *mgr, bool https,
                                         const char *host, unsigned port,
                                         const struct vlc_http_msg *req,
                                         bool payload)
 {
-    struct vlc_http_conn *conn = vlc_http_mgr_find(mgr, host, port);
-    if (conn == NULL)
-        return NULL;
+    vlc_tick_t now = vlc_tick_now();
+    ssize_t i;
+
+    vlc_http_mgr_expire(mgr, now);
 
-    struct vlc_http_stream *stream = vlc_http_stream_open(conn, req, payload);
-    if (stream != NULL)
+    /* HTTP/2 connections multiplex any number of streams. HTTP/1 ones only
+     * carry one at a time, and refuse new streams while busy. */
+    while ((i = vlc_http_mgr_find(mgr, https, host, port)) >= 0)
     {
-        struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
-        if (m != NULL)
-            return m;
+        struct vlc_http_conn *conn = mgr->conns[i].conn;
+        struct vlc_http_stream *stream = vlc_http_stream_open(conn, req,
+                                                              payload);
+        if (stream != NULL)
+        {
+            struct vlc_http_msg *m = vlc_http_msg_get_initial(stream);
+            if (m != NULL)
+            {
+                mgr->conns[i].last_used = now;
+                return m;
+            }
+        }
+        /* Get rid of busy, closing or reset connection */
+        vlc_http_mgr_remove(mgr, i);
     }
-    /* Get rid of closing or reset connection */
-    vlc_http_mgr_release(mgr, conn);
     return NULL;
 }
 
@@ -151,9 +249,6 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
     vlc_tls_t *tls;
     bool http2 = true;
 
-    if (mgr->creds == NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTP to HTTPS not implemented */
-
     if (mgr->creds == NULL)
     {   /* First TLS connection: load x509 credentials */
         mgr->creds = vlc_tls_ClientCreate(mgr->obj);
@@ -167,8 +262,8 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
          * the nonidempotent request was processed if the connection fails
          * before the response is received.
          */
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
+        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, true, host, port,
+                                                       req, payload);
         if (resp != NULL)
             return resp; /* existing connection reused */
     }
@@ -206,11 +301,13 @@ static struct vlc_http_msg *vlc_https_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    if (vlc_http_mgr_add(mgr, true, host, port, conn))
+    {
+        vlc_http_conn_release(conn);
+        return NULL;
+    }
 
-    mgr->conn = conn;
-    return vlc_http_mgr_reuse(mgr, host, port, req, payload);
+    return vlc_http_mgr_reuse(mgr, true, host, port, req, payload);
 }
 
 static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
@@ -218,13 +315,10 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
                                              const struct vlc_http_msg *req,
                                              bool idempotent, bool payload)
 {
-    if (mgr->creds != NULL && mgr->conn != NULL)
-        return NULL; /* switch from HTTPS to HTTP not implemented */
-
     if (idempotent)
     {
-        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, host, port, req,
-                                                       payload);
+        struct vlc_http_msg *resp = vlc_http_mgr_reuse(mgr, false, host, port,
+                                                       req, payload);
         if (resp != NULL)
             return resp;
     }
@@ -263,10 +357,10 @@ static struct vlc_http_msg *vlc_http_request(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
-
-    mgr->conn = conn;
+    if (vlc_http_mgr_add(mgr, false, host, port, conn))
+    {   /* Not pooled: the connection goes along with the response */
+        vlc_http_conn_release(conn);
+    }
     return resp;
 }
 
@@ -278,8 +372,12 @@ struct vlc_http_msg *vlc_http_mgr_request(struct vlc_http_mgr *mgr, bool https,
     if (port && vlc_http_port_blocked(port))
         return NULL;
 
-    return (https ? vlc_https_request : vlc_http_request)(mgr, host, port, m,
-                                                          idempotent, payload);
+    vlc_mutex_lock(&mgr->lock);
+    struct vlc_http_msg *resp =
+        (https ? vlc_https_request : vlc_http_request)(mgr, host, port, m,
+                                                       idempotent, payload);
+    vlc_mutex_unlock(&mgr->lock);
+    return resp;
 }
 
 struct vlc_http_cookie_jar_t *vlc_http_mgr_get_jar(struct vlc_http_mgr *mgr)
@@ -294,18 +392,33 @@ struct vlc_http_mgr *vlc_http_mgr_create(vlc_object_t *obj,
     if (unlikely(mgr == NULL))
         return NULL;
 
+    int64_t conns = var_InheritInteger(obj, "http-max-connections");
+    int64_t idle = var_InheritInteger(obj, "http-idle-timeout");
+
+    mgr->max_conns = (conns > 0) ? conns : VLC_HTTP_MGR_CONNS;
+    mgr->idle_timeout = VLC_TICK_FROM_SEC((idle > 0) ? idle
+                                                     : VLC_HTTP_MGR_IDLE);
+    mgr->conns = vlc_alloc(mgr->max_conns, sizeof (*mgr->conns));
+    if (unlikely(mgr->conns == NULL))
+    {
+        free(mgr);
+        return NULL;
+    }
+
     mgr->logger = obj->logger;
     mgr->obj = obj;
     mgr->creds = NULL;
     mgr->jar = jar;
-    mgr->conn = NULL;
+    vlc_mutex_init(&mgr->lock);
+    mgr->count = 0;
     return mgr;
 }
 
 void vlc_http_mgr_destroy(struct vlc_http_mgr *mgr)
 {
-    if (mgr->conn != NULL)
-        vlc_http_mgr_release(mgr, mgr->conn);
+    while (mgr->count > 0)
+        vlc_http_mgr_remove(mgr, mgr->count - 1);
+    free(mgr->conns);
     if (mgr->creds != NULL)
         vlc_tls_ClientDelete(mgr->creds);
     free(mgr);
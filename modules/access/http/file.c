@@ -32,6 +32,7 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_interrupt.h>
 #include <vlc_strings.h>
 #include "message.h"
 #include "resource.h"
@@ -39,17 +40,27 @@
 
 #pragma GCC visibility push(default)
 
+/** Requested byte range (the last byte is UINTMAX_MAX if open-ended) */
+struct vlc_http_range
+{
+    uintmax_t offset;
+    uintmax_t last;
+};
+
+struct vlc_http_file_parallel;
+
 struct vlc_http_file
 {
     struct vlc_http_resource resource;
-    uintmax_t offset;
+    struct vlc_http_range range; /* must follow the resource */
+    struct vlc_http_file_parallel *parallel;
 };
 
 static int vlc_http_file_req(const struct vlc_http_resource *res,
                              struct vlc_http_msg *req, void *opaque)
 {
     struct vlc_http_file *file = (struct vlc_http_file *)res;
-    const uintmax_t *offset = opaque;
+    const struct vlc_http_range *range = opaque;
 
     if (file->resource.response != NULL)
     {
@@ -69,8 +80,14 @@ static int vlc_http_file_req(const struct vlc_http_resource *res,
         }
     }
 
-    if (vlc_http_msg_add_header(req, "Range", "bytes=%" PRIuMAX "-", *offset)
-     && *offset != 0)
+    if (range->last != UINTMAX_MAX)
+        return vlc_http_msg_add_header(req, "Range",
+                                       "bytes=%" PRIuMAX "-%" PRIuMAX,
+                                       range->offset, range->last);
+
+    if (vlc_http_msg_add_header(req, "Range", "bytes=%" PRIuMAX "-",
+                                range->offset)
+     && range->offset != 0)
         return -1;
     return 0;
 }
@@ -78,7 +95,7 @@ static int vlc_http_file_req(const struct vlc_http_resource *res,
 static int vlc_http_file_resp(const struct vlc_http_resource *res,
                               const struct vlc_http_msg *resp, void *opaque)
 {
-    const uintmax_t *offset = opaque;
+    const struct vlc_http_range *range = opaque;
 
     if (vlc_http_msg_get_status(resp) == 206)
     {
@@ -90,7 +107,7 @@ static int vlc_http_file_resp(const struct vlc_http_resource *res,
 
         uintmax_t start, end;
         if (sscanf(str, "bytes %" SCNuMAX "-%" SCNuMAX, &start, &end) != 2
-         || start != *offset || start > end)
+         || start != range->offset || start > end || end > range->last)
             /* A single range response is what we asked for, but not at that
              * start offset. */
             goto fail;
@@ -125,7 +142,9 @@ struct vlc_http_resource *vlc_http_file_create(struct vlc_http_mgr *mgr,
         return NULL;
     }
 
-    file->offset = 0;
+    file->range.offset = 0;
+    file->range.last = UINTMAX_MAX;
+    file->parallel = NULL;
     return &file->resource;
 }
 
@@ -201,14 +220,21 @@ bool vlc_http_file_can_seek(struct vlc_http_resource *res)
     return vlc_http_msg_can_seek(res->response);
 }
 
+static int vlc_http_file_parallel_seek(struct vlc_http_file *, uintmax_t);
+static block_t *vlc_http_file_parallel_read(struct vlc_http_file *);
+
 int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
 {
-    struct vlc_http_msg *resp = vlc_http_res_open(res, &offset);
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    if (file->parallel != NULL)
+        return vlc_http_file_parallel_seek(file, offset);
+
+    struct vlc_http_range range = { offset, UINTMAX_MAX };
+    struct vlc_http_msg *resp = vlc_http_res_open(res, &range);
     if (resp == NULL)
         return -1;
 
-    struct vlc_http_file *file = (struct vlc_http_file *)res;
-
     int status = vlc_http_msg_get_status(resp);
     if (res->response != NULL)
     {   /* Accept the new and ditch the old one if:
@@ -225,21 +251,30 @@ int vlc_http_file_seek(struct vlc_http_resource *res, uintmax_t offset)
     }
 
     res->response = resp;
-    file->offset = offset;
+    file->range.offset = offset;
     return 0;
 }
 
 block_t *vlc_http_file_read(struct vlc_http_resource *res)
 {
     struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    if (file->parallel != NULL)
+    {
+        block_t *block = vlc_http_file_parallel_read(file);
+        if (block != vlc_http_error)
+            return block;
+        /* Range requests failed: fall back to a single request */
+    }
+
     block_t *block = vlc_http_res_read(res);
 
     if (block == vlc_http_error)
     {   /* Automatically reconnect on error if server supports seek */
         if (res->response != NULL
          && vlc_http_msg_can_seek(res->response)
-         && file->offset < vlc_http_msg_get_file_size(res->response)
-         && vlc_http_file_seek(res, file->offset) == 0)
+         && file->range.offset < vlc_http_msg_get_file_size(res->response)
+         && vlc_http_file_seek(res, file->range.offset) == 0)
             block = vlc_http_res_read(res);
 
         if (block == vlc_http_error)
@@ -249,6 +284,355 @@ block_t *vlc_http_file_read(struct vlc_http_resource *res)
     if (block == NULL)
         return NULL; /* End of stream */
 
-    file->offset += block->i_buffer;
+    file->range.offset += block->i_buffer;
     return block;
 }
+
+/*** Parallel range requests ***/
+
+/** Size of each range request */
+#define VLC_HTTP_FILE_CHUNK (1 << 20)
+
+struct vlc_http_file_chunk
+{
+    struct vlc_http_file_chunk *next;
+    uintmax_t offset;
+    uintmax_t length;
+    uintmax_t received;
+    block_t *data;
+    block_t **tailp;
+    bool busy; /**< Being received by a worker */
+    bool failed;
+    bool abandoned; /**< Not needed anymore (after a seek) */
+};
+
+struct vlc_http_file_worker
+{
+    struct vlc_http_file_parallel *parallel;
+    vlc_thread_t thread;
+    vlc_interrupt_t *interrupt;
+};
+
+struct vlc_http_file_parallel
+{
+    struct vlc_http_file *file;
+    vlc_mutex_t lock;
+    vlc_cond_t wait_data;
+    vlc_cond_t wait_work;
+    struct vlc_http_file_chunk *chunks; /**< Queued chunks, in file order */
+    unsigned queued;
+    unsigned width; /**< Current number of chunks to queue */
+    uintmax_t next; /**< Offset of the next chunk to request */
+    uintmax_t size;
+    bool closing;
+    bool interrupted;
+    unsigned count;
+    struct vlc_http_file_worker workers[];
+};
+
+static void vlc_http_file_chunk_free(struct vlc_http_file_chunk *chunk)
+{
+    block_ChainRelease(chunk->data);
+    free(chunk);
+}
+
+static struct vlc_http_msg *
+vlc_http_file_open_range(struct vlc_http_file *file,
+                         const struct vlc_http_range *range)
+{
+    struct vlc_http_msg *resp = vlc_http_res_open(&file->resource,
+                                                  (void *)range);
+    if (resp != NULL && vlc_http_msg_get_status(resp) != 206)
+    {   /* The whole entity, or an error */
+        vlc_http_msg_destroy(resp);
+        resp = NULL;
+    }
+    return resp;
+}
+
+static void *vlc_http_file_worker_thread(void *data)
+{
+    struct vlc_http_file_worker *worker = data;
+    struct vlc_http_file_parallel *p = worker->parallel;
+
+    vlc_interrupt_set(worker->interrupt);
+    vlc_mutex_lock(&p->lock);
+
+    while (!p->closing)
+    {
+        if (p->queued >= p->width || p->next >= p->size)
+        {
+            vlc_cond_wait(&p->wait_work, &p->lock);
+            continue;
+        }
+
+        struct vlc_http_file_chunk *chunk = malloc(sizeof (*chunk));
+        if (unlikely(chunk == NULL))
+            break;
+
+        chunk->offset = p->next;
+        chunk->length = p->size - p->next;
+        if (chunk->length > VLC_HTTP_FILE_CHUNK)
+            chunk->length = VLC_HTTP_FILE_CHUNK;
+        chunk->received = 0;
+        chunk->data = NULL;
+        chunk->tailp = &chunk->data;
+        chunk->busy = true;
+        chunk->failed = false;
+        chunk->abandoned = false;
+        chunk->next = NULL;
+
+        struct vlc_http_file_chunk **pp = &p->chunks;
+        while (*pp != NULL)
+            pp = &(*pp)->next;
+        *pp = chunk;
+        p->queued++;
+        p->next += chunk->length;
+        vlc_mutex_unlock(&p->lock);
+
+        struct vlc_http_range range = {
+            chunk->offset, chunk->offset + chunk->length - 1
+        };
+        struct vlc_http_msg *resp = vlc_http_file_open_range(p->file, &range);
+
+        for (;;)
+        {
+            block_t *block = (resp != NULL) ? vlc_http_msg_read(resp)
+                                            : vlc_http_error;
+
+            vlc_mutex_lock(&p->lock);
+            if (block == vlc_http_error || block == NULL)
+                break;
+
+            if (!chunk->abandoned)
+            {
+                chunk->received += block->i_buffer;
+                block_ChainLastAppend(&chunk->tailp, block);
+                vlc_cond_signal(&p->wait_data);
+            }
+            else
+                block_Release(block);
+
+            if (chunk->abandoned || chunk->received >= chunk->length)
+                break;
+            vlc_mutex_unlock(&p->lock);
+        }
+
+        if (resp != NULL)
+        {
+            vlc_mutex_unlock(&p->lock);
+            vlc_http_msg_destroy(resp);
+            vlc_mutex_lock(&p->lock);
+        }
+
+        chunk->busy = false;
+        if (chunk->abandoned)
+            vlc_http_file_chunk_free(chunk);
+        else
+        {
+            chunk->failed = chunk->received < chunk->length;
+            vlc_cond_signal(&p->wait_data);
+        }
+    }
+
+    vlc_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+static void vlc_http_file_parallel_stop(struct vlc_http_file *file)
+{
+    struct vlc_http_file_parallel *p = file->parallel;
+
+    vlc_mutex_lock(&p->lock);
+    p->closing = true;
+    vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+
+    for (unsigned i = 0; i < p->count; i++)
+        vlc_interrupt_kill(p->workers[i].interrupt);
+    for (unsigned i = 0; i < p->count; i++)
+    {
+        vlc_join(p->workers[i].thread, NULL);
+        vlc_interrupt_destroy(p->workers[i].interrupt);
+    }
+
+    while (p->chunks != NULL)
+    {
+        struct vlc_http_file_chunk *chunk = p->chunks;
+
+        p->chunks = chunk->next;
+        vlc_http_file_chunk_free(chunk);
+    }
+    free(p);
+    file->parallel = NULL;
+}
+
+/* Must be called with the lock held */
+static void vlc_http_file_parallel_pop(struct vlc_http_file_parallel *p)
+{
+    struct vlc_http_file_chunk *chunk = p->chunks;
+
+    p->chunks = chunk->next;
+    p->queued--;
+    if (chunk->busy)
+        chunk->abandoned = true; /* freed by the worker */
+    else
+        vlc_http_file_chunk_free(chunk);
+    vlc_cond_signal(&p->wait_work);
+}
+
+static int vlc_http_file_parallel_seek(struct vlc_http_file *file,
+                                       uintmax_t offset)
+{
+    struct vlc_http_file_parallel *p = file->parallel;
+
+    vlc_mutex_lock(&p->lock);
+    while (p->chunks != NULL)
+        vlc_http_file_parallel_pop(p);
+    p->next = offset;
+    p->width = 1;
+    vlc_cond_broadcast(&p->wait_work);
+    vlc_mutex_unlock(&p->lock);
+
+    file->range.offset = offset;
+    return 0;
+}
+
+static void vlc_http_file_parallel_wake_up(void *data)
+{
+    struct vlc_http_file_parallel *p = data;
+
+    vlc_mutex_lock(&p->lock);
+    p->interrupted = true;
+    vlc_cond_signal(&p->wait_data);
+    vlc_mutex_unlock(&p->lock);
+}
+
+static block_t *vlc_http_file_parallel_read(struct vlc_http_file *file)
+{
+    struct vlc_http_file_parallel *p = file->parallel;
+    block_t *block = NULL;
+
+    p->interrupted = false;
+    vlc_interrupt_register(vlc_http_file_parallel_wake_up, p);
+    vlc_mutex_lock(&p->lock);
+    for (;;)
+    {
+        struct vlc_http_file_chunk *chunk = p->chunks;
+
+        if (chunk == NULL)
+        {
+            if (file->range.offset >= p->size)
+                break; /* end of file */
+            vlc_cond_signal(&p->wait_work);
+        }
+        else if (chunk->data != NULL)
+        {
+            block = chunk->data;
+            chunk->data = block->p_next;
+            if (chunk->data == NULL)
+                chunk->tailp = &chunk->data;
+            block->p_next = NULL;
+            file->range.offset += block->i_buffer;
+
+            if (!chunk->busy && chunk->data == NULL && !chunk->failed)
+                vlc_http_file_parallel_pop(p);
+            break;
+        }
+        else if (chunk->failed)
+        {
+            block = vlc_http_error;
+            break;
+        }
+        else if (!chunk->busy)
+        {
+            vlc_http_file_parallel_pop(p);
+            continue;
+        }
+        else if (p->width < p->count)
+        {   /* Data is not flowing fast enough: request more ranges in
+             * parallel. */
+            p->width++;
+            vlc_cond_signal(&p->wait_work);
+        }
+
+        if (p->interrupted)
+            break;
+        vlc_cond_wait(&p->wait_data, &p->lock);
+    }
+    vlc_mutex_unlock(&p->lock);
+    vlc_interrupt_unregister();
+
+    if (block == vlc_http_error)
+    {   /* Resume with a single request from the current offset */
+        vlc_http_file_parallel_stop(file);
+        if (vlc_http_file_seek(&file->resource, file->range.offset))
+            return NULL;
+    }
+    return block;
+}
+
+int vlc_http_file_set_parallel(struct vlc_http_resource *res, unsigned count)
+{
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    assert(file->parallel == NULL);
+    assert(count > 0);
+
+    if (!vlc_http_file_can_seek(res))
+        return -1;
+
+    uintmax_t size = vlc_http_file_get_size(res);
+    if (size == (uintmax_t)-1)
+        return -1;
+
+    struct vlc_http_file_parallel *p = malloc(sizeof (*p)
+                                              + count * sizeof (p->workers[0]));
+    if (unlikely(p == NULL))
+        return -1;
+
+    p->file = file;
+    vlc_mutex_init(&p->lock);
+    vlc_cond_init(&p->wait_data);
+    vlc_cond_init(&p->wait_work);
+    p->chunks = NULL;
+    p->queued = 0;
+    p->width = 1;
+    p->next = file->range.offset;
+    p->size = size;
+    p->closing = false;
+    p->count = 0;
+    file->parallel = p;
+
+    for (unsigned i = 0; i < count; i++)
+    {
+        struct vlc_http_file_worker *worker = &p->workers[i];
+
+        worker->parallel = p;
+        worker->interrupt = vlc_interrupt_create();
+        if (unlikely(worker->interrupt == NULL))
+            break;
+        if (vlc_clone(&worker->thread, vlc_http_file_worker_thread, worker,
+                      VLC_THREAD_PRIORITY_INPUT))
+        {
+            vlc_interrupt_destroy(worker->interrupt);
+            break;
+        }
+        p->count++;
+    }
+
+    if (p->count > 0)
+        return 0;
+
+    vlc_http_file_parallel_stop(file);
+    return -1;
+}
+
+void vlc_http_file_destroy(struct vlc_http_resource *res)
+{
+    struct vlc_http_file *file = (struct vlc_http_file *)res;
+
+    if (file->parallel != NULL)
+        vlc_http_file_parallel_stop(file);
+    vlc_http_res_destroy(res);
+}
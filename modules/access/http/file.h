@@ -79,9 +79,30 @@ int vlc_http_file_seek(struct vlc_http_resource *, uintmax_t offset);
  */
 struct block_t *vlc_http_file_read(struct vlc_http_resource *);
 
+/**
+ * Enables parallel reads.
+ *
+ * Fetches the file with up to the given number of concurrent range requests
+ * ahead of the read offset, on separate connections or streams, and
+ * reassembles them in order. The number of concurrent requests grows when
+ * the data is read faster than a single request can deliver.
+ *
+ * If a range request fails, reading falls back to a single request.
+ *
+ * @param count maximum number of concurrent requests
+ * @retval 0 on success
+ * @retval -1 if the file does not support range requests or its size is
+ *            unknown
+ */
+int vlc_http_file_set_parallel(struct vlc_http_resource *, unsigned count);
+
+/**
+ * Destroys an HTTP file.
+ */
+void vlc_http_file_destroy(struct vlc_http_resource *);
+
 #define vlc_http_file_get_status vlc_http_res_get_status
 #define vlc_http_file_get_redirect vlc_http_res_get_redirect
 #define vlc_http_file_get_type vlc_http_res_get_type
-#define vlc_http_file_destroy vlc_http_res_destroy
 
 /** @} */
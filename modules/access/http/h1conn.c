@@ -25,11 +25,13 @@
 #include <assert.h>
 #include <errno.h>
 #include <inttypes.h>
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_tls.h>
 #include <vlc_block.h>
 
@@ -113,8 +115,8 @@ struct vlc_h1_conn
     struct vlc_http_stream stream;
     uintmax_t content_length;
     bool connection_close;
-    bool active;
-    bool released;
+    atomic_bool active;
+    vlc_atomic_rc_t rc; /**< held by the owner and by the active stream */
     bool proxy;
     void *opaque;
 };
@@ -147,7 +149,10 @@ static struct vlc_http_stream *vlc_h1_stream_open(struct vlc_http_conn *c,
     size_t len;
     ssize_t val;
 
-    if (conn->active || conn->conn.tls == NULL)
+    /* The owner may try to reuse the connection while another thread is
+     * closing the active stream. */
+    if (atomic_load_explicit(&conn->active, memory_order_acquire)
+     || conn->conn.tls == NULL)
         return NULL;
 
     char *payload = vlc_http_msg_format(req, &len, conn->proxy, has_data);
@@ -161,7 +166,8 @@ static struct vlc_http_stream *vlc_h1_stream_open(struct vlc_http_conn *c,
     if (val < (ssize_t)len)
         return vlc_h1_stream_fatal(conn);
 
-    conn->active = true;
+    vlc_atomic_rc_inc(&conn->rc);
+    atomic_store_explicit(&conn->active, true, memory_order_relaxed);
     conn->content_length = 0;
     conn->connection_close = false;
     return &conn->stream;
@@ -293,9 +299,9 @@ static void vlc_h1_stream_close(struct vlc_http_stream *stream, bool abort)
     if (abort)
         vlc_h1_stream_fatal(conn);
 
-    conn->active = false;
+    atomic_store_explicit(&conn->active, false, memory_order_release);
 
-    if (conn->released)
+    if (vlc_atomic_rc_dec(&conn->rc))
         vlc_h1_conn_destroy(conn);
 }
 
@@ -309,8 +315,7 @@ static const struct vlc_http_stream_cbs vlc_h1_stream_callbacks =
 
 static void vlc_h1_conn_destroy(struct vlc_h1_conn *conn)
 {
-    assert(!conn->active);
-    assert(conn->released);
+    assert(!atomic_load_explicit(&conn->active, memory_order_relaxed));
 
     if (conn->conn.tls != NULL)
     {
@@ -324,10 +329,7 @@ static void vlc_h1_conn_release(struct vlc_http_conn *c)
 {
     struct vlc_h1_conn *conn = container_of(c, struct vlc_h1_conn, conn);
 
-    assert(!conn->released);
-    conn->released = true;
-
-    if (!conn->active)
+    if (vlc_atomic_rc_dec(&conn->rc))
         vlc_h1_conn_destroy(conn);
 }
 
@@ -346,8 +348,8 @@ struct vlc_http_conn *vlc_h1_conn_create(void *ctx, vlc_tls_t *tls, bool proxy)
     conn->conn.cbs = &vlc_h1_conn_callbacks;
     conn->conn.tls = tls;
     conn->stream.cbs = &vlc_h1_stream_callbacks;
-    conn->active = false;
-    conn->released = false;
+    atomic_init(&conn->active, false);
+    vlc_atomic_rc_init(&conn->rc);
     conn->proxy = proxy;
     conn->opaque = ctx;
 
@@ -364,11 +366,12 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
     {
         .ai_socktype = SOCK_STREAM,
         .ai_protocol = IPPROTO_TCP,
-    }, *res;
+    };
+    const struct addrinfo *res;
 
     vlc_http_dbg(ctx, "resolving %s ...", hostname);
 
-    int val = vlc_getaddrinfo_i11e(hostname, port, &hints, &res);
+    int val = vlc_getaddrinfo_cached(hostname, port, &hints, &res);
     if (val != 0)
     {   /* TODO: C locale for gai_strerror() */
         vlc_http_err(ctx, "cannot resolve %s: %s", hostname,
@@ -403,7 +406,7 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
             else
                 vlc_http_conn_release(conn);
 
-            freeaddrinfo(res);
+            vlc_freeaddrinfo_cached(res);
             return stream;
         }
 
@@ -414,6 +417,6 @@ struct vlc_http_stream *vlc_h1_request(void *ctx, const char *hostname,
     }
 
     /* All address info failed. */
-    freeaddrinfo(res);
+    vlc_freeaddrinfo_cached(res);
     return NULL;
 }
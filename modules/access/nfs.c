@@ -59,11 +59,26 @@ vlc_module_begin()
     set_category(CAT_INPUT)
     set_subcategory(SUBCAT_INPUT_ACCESS)
     add_bool("nfs-auto-guid", true, AUTO_GUID_TEXT, AUTO_GUID_LONGTEXT, true)
+    add_integer("nfs-read-ahead", 8, N_("Read-ahead depth"),
+                N_("Maximum number of reads in flight. Queuing reads ahead "
+                   "hides the network latency."), true)
+        change_integer_range(1, 32)
     set_capability("access", 0)
     add_shortcut("nfs")
     set_callbacks(Open, Close)
 vlc_module_end()
 
+#define NFS_READ_SIZE (1 << 17)
+
+struct vlc_nfs_read
+{
+    stream_t *              p_access;
+    uint8_t *               p_buf;
+    uint64_t                i_offset;
+    size_t                  i_len;
+    bool                    b_pending;
+};
+
 typedef struct
 {
     struct rpc_context *    p_mount; /* used to to get exports mount point */
@@ -75,25 +90,25 @@ typedef struct
     vlc_url_t               encoded_url;
     char *                  psz_url_decoded;
     char *                  psz_url_decoded_slash;
-    bool                    b_eof;
     bool                    b_error;
     bool                    b_auto_guid;
 
+    /* Reads queued ahead, completed in any order but consumed in order */
+    struct vlc_nfs_read *   p_reads;
+    unsigned                i_read_depth;
+    unsigned                i_read_window; /* reads to queue */
+    unsigned                i_read_head;
+    unsigned                i_read_count;
+    unsigned                i_read_pending;
+    uint64_t                i_offset;
+    bool                    b_read_done;
+
     union {
         struct
         {
             char **         ppsz_names;
             int             i_count;
         } exports;
-        struct
-        {
-            uint8_t *p_buf;
-            size_t i_len;
-        } read;
-        struct
-        {
-            bool b_done;
-        } seek;
     } res;
 } access_sys_t;
 
@@ -174,95 +189,189 @@ vlc_mount_mainloop(stream_t *p_access, bool (*pf_until_cb)(stream_t *))
 }
 
 static void
-nfs_read_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
-            void *p_private_data)
+nfs_pread_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
+             void *p_private_data)
 {
     VLC_UNUSED(p_nfs);
-    stream_t *p_access = p_private_data;
+    struct vlc_nfs_read *p_read = p_private_data;
+    stream_t *p_access = p_read->p_access;
     access_sys_t *p_sys = p_access->p_sys;
     assert(p_sys->p_nfs == p_nfs);
+    assert(p_sys->i_read_pending > 0);
+
+    p_read->b_pending = false;
+    p_sys->i_read_pending--;
+    p_sys->b_read_done = true;
     if (NFS_CHECK_STATUS(p_access, i_status, p_data))
         return;
 
-    if (i_status == 0)
-        p_sys->b_eof = true;
-    else
-    {
-        p_sys->res.read.i_len = i_status;
-        memcpy(p_sys->res.read.p_buf, p_data, i_status);
-    }
+    p_read->i_len = i_status;
+    memcpy(p_read->p_buf, p_data, i_status);
 }
 
 static bool
 nfs_read_finished_cb(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
-    return p_sys->res.read.i_len > 0 || p_sys->b_eof;
+    return p_sys->b_read_done;
 }
 
-static ssize_t
-FileRead(stream_t *p_access, void *p_buf, size_t i_len)
+static bool
+nfs_reads_finished_cb(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
+    return p_sys->i_read_pending == 0;
+}
 
-    if (p_sys->b_eof)
-        return 0;
-
-    p_sys->res.read.i_len = 0;
-    p_sys->res.read.p_buf = p_buf;
-    if (nfs_read_async(p_sys->p_nfs, p_sys->p_nfsfh, i_len, nfs_read_cb,
-                       p_access) < 0)
+static int
+NfsQueueRead(stream_t *p_access, uint64_t i_offset)
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    struct vlc_nfs_read *p_read =
+        &p_sys->p_reads[(p_sys->i_read_head + p_sys->i_read_count)
+                        % p_sys->i_read_depth];
+
+    assert(!p_read->b_pending);
+    p_read->i_offset = i_offset;
+    p_read->i_len = 0;
+    if (nfs_pread_async(p_sys->p_nfs, p_sys->p_nfsfh, i_offset, NFS_READ_SIZE,
+                        nfs_pread_cb, p_read) < 0)
     {
-        msg_Err(p_access, "nfs_read_async failed");
+        msg_Err(p_access, "nfs_pread_async failed");
         return -1;
     }
-
-    if (vlc_nfs_mainloop(p_access, nfs_read_finished_cb) < 0)
-        return -1;
-
-    return p_sys->res.read.i_len;
+    p_read->b_pending = true;
+    p_sys->i_read_pending++;
+    p_sys->i_read_count++;
+    return 0;
 }
 
-static void
-nfs_seek_cb(int i_status, struct nfs_context *p_nfs, void *p_data,
-            void *p_private_data)
+/* Waits for the reads in flight, whose data is not needed anymore */
+static int
+NfsDrainReads(stream_t *p_access)
 {
-    VLC_UNUSED(p_nfs);
-    stream_t *p_access = p_private_data;
     access_sys_t *p_sys = p_access->p_sys;
-    assert(p_sys->p_nfs == p_nfs);
-    (void) p_data;
-    if (NFS_CHECK_STATUS(p_access, i_status, p_data))
-        return;
 
-    p_sys->res.seek.b_done = true;
+    if (vlc_nfs_mainloop(p_access, nfs_reads_finished_cb) < 0)
+        return -1;
+    p_sys->i_read_head = 0;
+    p_sys->i_read_count = 0;
+    return 0;
 }
 
-static bool
-nfs_seek_finished_cb(stream_t *p_access)
+static int
+NfsInitReads(stream_t *p_access)
 {
     access_sys_t *p_sys = p_access->p_sys;
-    return p_sys->res.seek.b_done;
+
+    p_sys->i_read_depth = var_InheritInteger(p_access, "nfs-read-ahead");
+    p_sys->p_reads = vlc_obj_malloc(VLC_OBJECT(p_access),
+                                    p_sys->i_read_depth
+                                    * sizeof (*p_sys->p_reads));
+    if (unlikely(p_sys->p_reads == NULL))
+        return -1;
+
+    for (unsigned i = 0; i < p_sys->i_read_depth; i++)
+    {
+        struct vlc_nfs_read *p_read = &p_sys->p_reads[i];
+
+        p_read->p_buf = vlc_obj_malloc(VLC_OBJECT(p_access), NFS_READ_SIZE);
+        if (unlikely(p_read->p_buf == NULL))
+            return -1;
+        p_read->p_access = p_access;
+        p_read->b_pending = false;
+    }
+    p_sys->i_read_window = 1;
+    return 0;
 }
 
-static int
-FileSeek(stream_t *p_access, uint64_t i_pos)
+static ssize_t
+FileRead(stream_t *p_access, void *p_buf, size_t i_len)
 {
     access_sys_t *p_sys = p_access->p_sys;
 
-    p_sys->res.seek.b_done = false;
-    if (nfs_lseek_async(p_sys->p_nfs, p_sys->p_nfsfh, i_pos, SEEK_SET,
-                        nfs_seek_cb, p_access) < 0)
+    for (;;)
     {
-        msg_Err(p_access, "nfs_seek_async failed");
-        return VLC_EGENERIC;
-    }
+        if (p_sys->b_error)
+            return -1;
+
+        struct vlc_nfs_read *p_read = &p_sys->p_reads[p_sys->i_read_head];
+
+        if (p_sys->i_read_count == 0 || p_sys->i_offset < p_read->i_offset
+         || p_sys->i_offset - p_read->i_offset >= NFS_READ_SIZE)
+        {   /* Not read ahead (after a seek): start again with one read */
+            if (NfsDrainReads(p_access) < 0)
+                return -1;
+            if (p_sys->i_offset >= p_sys->stat.nfs_size)
+                return 0;
+            p_sys->i_read_window = 1;
+            if (NfsQueueRead(p_access, p_sys->i_offset) < 0)
+                return -1;
+            continue;
+        }
+
+        if (p_read->b_pending)
+        {   /* The data is consumed faster than it is read: queue more reads
+             * to cover the bandwidth-delay product of the link. */
+            p_sys->i_read_window *= 2;
+            if (p_sys->i_read_window > p_sys->i_read_depth)
+                p_sys->i_read_window = p_sys->i_read_depth;
+
+            p_sys->b_read_done = false;
+            if (vlc_nfs_mainloop(p_access, nfs_read_finished_cb) < 0)
+                return -1;
+            continue;
+        }
 
-    if (vlc_nfs_mainloop(p_access, nfs_seek_finished_cb) < 0)
-        return VLC_EGENERIC;
+        size_t i_skip = p_sys->i_offset - p_read->i_offset;
+        if (i_skip >= p_read->i_len)
+        {
+            if (p_read->i_len == 0)
+                return 0; /* end of file */
+            /* Short read, read again from the current offset */
+            p_sys->i_read_count = 0;
+            continue;
+        }
+
+        size_t i_copy = p_read->i_len - i_skip;
+        if (i_copy > i_len)
+            i_copy = i_len;
+        memcpy(p_buf, p_read->p_buf + i_skip, i_copy);
+        p_sys->i_offset += i_copy;
+
+        if (i_skip + i_copy == NFS_READ_SIZE)
+        {
+            p_sys->i_read_head = (p_sys->i_read_head + 1) % p_sys->i_read_depth;
+            p_sys->i_read_count--;
+        }
+
+        /* Keep the window of reads in flight full */
+        while (p_sys->i_read_count < p_sys->i_read_window)
+        {
+            unsigned i_last = (p_sys->i_read_head + p_sys->i_read_count
+                               + p_sys->i_read_depth - 1) % p_sys->i_read_depth;
+            uint64_t i_offset = p_sys->i_read_count > 0
+                ? p_sys->p_reads[i_last].i_offset + NFS_READ_SIZE
+                : p_sys->i_offset;
+
+            if (i_offset >= p_sys->stat.nfs_size
+             || p_sys->p_reads[(p_sys->i_read_head + p_sys->i_read_count)
+                               % p_sys->i_read_depth].b_pending
+             || NfsQueueRead(p_access, i_offset) < 0)
+                break;
+        }
+        return i_copy;
+    }
+}
 
-    p_sys->b_eof = false;
+static int
+FileSeek(stream_t *p_access, uint64_t i_pos)
+{
+    access_sys_t *p_sys = p_access->p_sys;
 
+    /* Reads are positioned: the reads queued ahead are discarded on the next
+     * read, if need be, and there is no file offset to seek on the server */
+    p_sys->i_offset = i_pos;
     return VLC_SUCCESS;
 }
 
@@ -692,6 +801,8 @@ Open(vlc_object_t *p_obj)
 
         if (p_sys->p_nfsfh != NULL)
         {
+            if (NfsInitReads(p_access) != 0)
+                goto error;
             p_access->pf_read = FileRead;
             p_access->pf_seek = FileSeek;
             p_access->pf_control = FileControl;
@@ -750,7 +861,11 @@ Close(vlc_object_t *p_obj)
     access_sys_t *p_sys = p_access->p_sys;
 
     if (p_sys->p_nfsfh != NULL)
+    {
+        if (!p_sys->b_error)
+            NfsDrainReads(p_access);
         nfs_close(p_sys->p_nfs, p_sys->p_nfsfh);
+    }
 
     if (p_sys->p_nfsdir != NULL)
         nfs_closedir(p_sys->p_nfs, p_sys->p_nfsdir);
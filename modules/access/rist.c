@@ -61,6 +61,11 @@
 #define NACK_INTERVAL 5 /*ms*/
 /* Calculate and print stats once per second */
 #define STATS_INTERVAL 1000 /*ms*/
+/* The most sequence numbers requested per nack interval, they are coalesced
+ * into much fewer records */
+#define NACK_MAX_PER_INTERVAL (MAX_NACKS * 16)
+/* The most datagrams read at once */
+#define RIST_BATCH_SIZE 32
 
 static const int nack_type[] = {
     0, 1,
@@ -107,6 +112,11 @@ typedef struct
     uint32_t         i_recovered_packets;
     uint32_t         i_reordered_packets;
     uint32_t         i_total_packets;
+    uint8_t         *buf;
+#ifdef HAVE_RECVMMSG
+    struct mmsghdr   msgs[RIST_BATCH_SIZE];
+    struct iovec     iovs[RIST_BATCH_SIZE];
+#endif
 } stream_sys_t;
 
 static int Control(stream_t *p_access, int i_query, va_list args)
@@ -229,6 +239,16 @@ static int is_index_in_range(struct rist_flow *flow, uint16_t idx)
     }
 }
 
+static inline void rist_set_missing(struct rist_flow *flow, uint16_t idx)
+{
+    flow->missing[idx / 64] |= UINT64_C(1) << (idx % 64);
+}
+
+static inline void rist_clear_missing(struct rist_flow *flow, uint16_t idx)
+{
+    flow->missing[idx / 64] &= ~(UINT64_C(1) << (idx % 64));
+}
+
 static void send_rtcp_feedback(stream_t *p_access, struct rist_flow *flow)
 {
     stream_sys_t *p_sys = p_access->p_sys;
@@ -272,7 +292,9 @@ static void send_bbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uin
 {
     stream_sys_t *p_sys = p_access->p_sys;
     struct rist_flow *flow = p_sys->flow;
+    const uint16_t *nacks = (const uint16_t *)pkt_nacks->p_buffer;
     int len = 0;
+    uint16_t records = 0;
 
     int bbnack_bufsize = RTCP_FB_HEADER_SIZE +
         RTCP_FB_FCI_GENERIC_NACK_SIZE * nack_count;
@@ -285,19 +307,27 @@ static void send_bbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uin
     rtp_set_hdr(nack);
     rtcp_fb_set_fmt(nack, NACK_FMT_BITMASK);
     rtcp_set_pt(nack, RTCP_PT_RTPFB);
-    rtcp_set_length(nack, 2 + nack_count);
     /*uint8_t name[4] = "RIST";*/
     /*rtcp_fb_set_ssrc_media_src(nack, name);*/
     len += RTCP_FB_HEADER_SIZE;
-    /* TODO : group together */
-    uint16_t nacks[MAX_NACKS];
-    memcpy(nacks, pkt_nacks->p_buffer, pkt_nacks->i_buffer);
+    /* Each record covers a packet and the 16 following ones */
     for (int i = 0; i < nack_count; i++) {
-        uint8_t *nack_record = buf + len + RTCP_FB_FCI_GENERIC_NACK_SIZE*i;
-        rtcp_fb_nack_set_packet_id(nack_record, nacks[i]);
-        rtcp_fb_nack_set_bitmask_lost(nack_record, 0);
+        uint16_t pid = nacks[i];
+        uint16_t mask = 0;
+        while (i + 1 < nack_count) {
+            uint16_t delta = nacks[i + 1] - pid;
+            if (delta < 1 || delta > 16)
+                break;
+            mask |= 1 << (delta - 1);
+            i++;
+        }
+        uint8_t *nack_record = buf + len + RTCP_FB_FCI_GENERIC_NACK_SIZE*records;
+        rtcp_fb_nack_set_packet_id(nack_record, pid);
+        rtcp_fb_nack_set_bitmask_lost(nack_record, mask);
+        records++;
     }
-    len += RTCP_FB_FCI_GENERIC_NACK_SIZE * nack_count;
+    rtcp_set_length(nack, 2 + records);
+    len += RTCP_FB_FCI_GENERIC_NACK_SIZE * records;
 
     /* Write to Socket */
     if (p_sys->b_sendnacks && p_sys->b_disablenacks == false)
@@ -311,7 +341,9 @@ static void send_rbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uin
 {
     stream_sys_t *p_sys = p_access->p_sys;
     struct rist_flow *flow = p_sys->flow;
+    const uint16_t *nacks = (const uint16_t *)pkt_nacks->p_buffer;
     int len = 0;
+    uint16_t records = 0;
 
     int rbnack_bufsize = RTCP_FB_HEADER_SIZE +
         RTCP_FB_FCI_GENERIC_NACK_SIZE * nack_count;
@@ -324,20 +356,27 @@ static void send_rbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uin
     rtp_set_hdr(nack);
     rtcp_fb_set_fmt(nack, NACK_FMT_RANGE);
     rtcp_set_pt(nack, RTCP_PT_RTPFR);
-    rtcp_set_length(nack, 2 + nack_count);
     uint8_t name[4] = "RIST";
     rtcp_fb_set_ssrc_media_src(nack, name);
     len += RTCP_FB_HEADER_SIZE;
-    /* TODO : group together */
-    uint16_t nacks[MAX_NACKS];
-    memcpy(nacks, pkt_nacks->p_buffer, pkt_nacks->i_buffer);
+    /* Each record covers a run of consecutive packets */
     for (int i = 0; i < nack_count; i++)
     {
-        uint8_t *nack_record = buf + len + RTCP_FB_FCI_GENERIC_NACK_SIZE*i;
-        rtcp_fb_nack_set_range_start(nack_record, nacks[i]);
-        rtcp_fb_nack_set_range_extra(nack_record, 0);
+        uint16_t start = nacks[i];
+        uint16_t extra = 0;
+        while (i + 1 < nack_count && nacks[i + 1] == (uint16_t)(start + extra + 1)
+            && extra < UINT16_MAX)
+        {
+            extra++;
+            i++;
+        }
+        uint8_t *nack_record = buf + len + RTCP_FB_FCI_GENERIC_NACK_SIZE*records;
+        rtcp_fb_nack_set_range_start(nack_record, start);
+        rtcp_fb_nack_set_range_extra(nack_record, extra);
+        records++;
     }
-    len += RTCP_FB_FCI_GENERIC_NACK_SIZE * nack_count;
+    rtcp_set_length(nack, 2 + records);
+    len += RTCP_FB_FCI_GENERIC_NACK_SIZE * records;
 
     /* Write to Socket */
     if (p_sys->b_sendnacks && p_sys->b_disablenacks == false)
@@ -350,52 +389,47 @@ static void send_rbnack(stream_t *p_access, int fd_nack, block_t *pkt_nacks, uin
 static void send_nacks(stream_t *p_access, struct rist_flow *flow)
 {
     stream_sys_t *p_sys = p_access->p_sys;
-    struct rtp_pkt *pkt;
-    uint16_t idx;
     uint64_t last_ts = 0;
-    uint16_t null_count = 0;
     int nacks_len = 0;
-    uint16_t nacks[MAX_NACKS];
+    uint16_t nacks[NACK_MAX_PER_INTERVAL];
+    const uint16_t window = flow->wi - flow->ri;
 
-    idx = flow->ri;
-    while(idx++ != flow->wi)
+    /* Only visit the missing packets of the window, a word of the bitmap
+     * at a time */
+    for (uint16_t n = 0; n < window && nacks_len < NACK_MAX_PER_INTERVAL; )
     {
-        pkt = &(flow->buffer[idx]);
-        if (pkt->buffer == NULL)
+        uint16_t idx = flow->ri + 1 + n;
+        uint64_t word = flow->missing[idx / 64] >> (idx % 64);
+        if (word == 0)
         {
-            if (nacks_len + 1 >= MAX_NACKS)
-            {
-                break;
-            }
-            else
-            {
-                null_count++;
-                /* TODO: after adding average spacing calculation, change this formula
-                   to extrapolated_ts = last_ts + null_count * avg_delta_ts; */
-                uint64_t extrapolated_ts = last_ts;
-                /* Find out the age and add it only if necessary */
-                int retry_count = flow->nacks_retries[idx];
-                uint64_t age = flow->hi_timestamp - extrapolated_ts;
-                uint64_t expiration;
-                if (retry_count == 0){
-                    expiration = flow->reorder_buffer;
-                } else {
-                    expiration = (uint64_t)flow->nacks_retries[idx] * (uint64_t)flow->retry_interval;
-                }
-                if (age > expiration && retry_count <= flow->max_retries)
-                {
-                    flow->nacks_retries[idx]++;
-                    nacks[nacks_len++] = idx;
-                    msg_Dbg(p_access, "Sending NACK for seq %d, age %"PRId64" ms, retry %u, " \
-                        "expiration %"PRId64" ms", idx, ts_get_from_rtp(age)/1000,
-                        flow->nacks_retries[idx], ts_get_from_rtp(expiration)/1000);
-                }
-            }
+            n += 64 - idx % 64;
+            continue;
         }
-        else
+        n += ctz(word);
+        if (n >= window)
+            break;
+        idx = flow->ri + 1 + n;
+        n++;
+
+        /* TODO: after adding average spacing calculation, change this formula
+           to extrapolated_ts = last_ts + null_count * avg_delta_ts; */
+        struct rtp_pkt *prev = &flow->buffer[(uint16_t)(idx - 1)];
+        if (prev->buffer != NULL)
+            last_ts = prev->rtp_ts;
+        uint64_t extrapolated_ts = last_ts;
+        /* Find out the age and add it only if necessary */
+        int retry_count = flow->nacks_retries[idx];
+        uint64_t age = flow->hi_timestamp - extrapolated_ts;
+        uint64_t expiration;
+        if (retry_count == 0){
+            expiration = flow->reorder_buffer;
+        } else {
+            expiration = (uint64_t)flow->nacks_retries[idx] * (uint64_t)flow->retry_interval;
+        }
+        if (age > expiration && retry_count <= flow->max_retries)
         {
-            last_ts = pkt->rtp_ts;
-            null_count = 0;
+            flow->nacks_retries[idx]++;
+            nacks[nacks_len++] = idx;
         }
     }
     if (nacks_len > 0)
@@ -625,6 +659,7 @@ static bool rist_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf,
         flow->wi = idx;
         flow->ri = idx;
         flow->reset = 0;
+        memset(flow->missing, 0, sizeof (flow->missing));
         p_sys->b_flag_discontinuity = true;
     }
 
@@ -641,22 +676,22 @@ static bool rist_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf,
         /* Reset counter to 0 on incoming holes */
         /* Regular packets only as retransmits are expected to come in out of order */
         uint16_t idxnext = (uint16_t)(flow->wi + 1);
-        if (idx != idxnext)
+        uint16_t gap = idx - idxnext;
+        if (gap != 0)
         {
-            if (idx > idxnext) {
+            if (gap < RIST_QUEUE_SIZE / 2) {
                 msg_Dbg(p_access, "Gap, got %d, expected %d, %d packet gap, Window: [%d:%d-->%d]",
-                    idx, idxnext, idx - idxnext, flow->ri, flow->wi, (uint16_t)(flow->wi-flow->ri));
+                    idx, idxnext, gap, flow->ri, flow->wi, (uint16_t)(flow->wi-flow->ri));
+                /* Only the packets of the gap are new holes */
+                for (uint16_t hole = idxnext; hole != idx; hole++) {
+                    flow->nacks_retries[hole] = 0;
+                    rist_set_missing(flow, hole);
+                }
             } else {
                 p_sys->i_reordered_packets++;
                 msg_Dbg(p_access, "Out of order, got %d, expected %d, Window: [%d:%d-->%d]", idx,
                     idxnext, flow->ri, flow->wi, (uint16_t)(flow->wi-flow->ri));
             }
-            uint16_t zero_counter = (uint16_t)(flow->wi + 1);
-            while(zero_counter++ != idx) {
-                flow->nacks_retries[zero_counter] = 0;
-            }
-            /*msg_Dbg(p_access, "Gap, reseting %d packets as zero nacks %d to %d",
-                idx - flow->wi - 1, (uint16_t)(flow->wi + 1), idx);*/
         }
     }
 
@@ -678,6 +713,7 @@ static bool rist_input(stream_t *p_access, struct rist_flow *flow, uint8_t *buf,
     p_sys->last_data_rx = vlc_tick_now();
     /* Reset the try counter regardless of wether it was a retransmit or not */
     flow->nacks_retries[idx] = 0;
+    rist_clear_missing(flow, idx);
 
     if (retrasnmitted)
         return success;
@@ -757,7 +793,9 @@ static block_t *rist_dequeue(stream_t *p_access, struct rist_flow *flow)
             pkt->buffer = NULL;
             break;
         }
-
+        /* The packets leave in sequence order, the next ones are not due
+         * either */
+        break;
     }
 
     if (loss_amount > 0 && found_data == true)
@@ -767,6 +805,8 @@ static block_t *rist_dequeue(stream_t *p_access, struct rist_flow *flow)
             flow->ri, flow->wi);
         p_sys->i_lost_packets += loss_amount;
         p_sys->b_flag_discontinuity = true;
+        for (uint16_t hole = idx - loss_amount; hole != idx; hole++)
+            rist_clear_missing(flow, hole);
     }
 
     return pktout;
@@ -859,9 +899,7 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
     else
     {
 
-        uint8_t *buf = malloc(p_sys->i_max_packet_size);
-        if ( unlikely( buf == NULL ) )
-            return NULL;
+        uint8_t *buf = p_sys->buf;
 
         /* Process rctp incoming data */
         if (pfd[1].revents & POLLIN)
@@ -891,6 +929,22 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
         /* Process regular incoming data */
         if (pfd[0].revents & POLLIN)
         {
+            bool queued = false;
+#ifdef HAVE_RECVMMSG
+            /* Take every datagram already received, in one call */
+            int count = recvmmsg(flow->fd_in, p_sys->msgs, RIST_BATCH_SIZE,
+                                 MSG_DONTWAIT, NULL);
+            if (unlikely(count < 0)) {
+                msg_Err(p_access, "socket %d error: %s\n", flow->fd_in, gai_strerror(errno));
+            }
+            for (int i = 0; i < count; i++)
+            {
+                /* rist_input will process and queue the pkt */
+                if (rist_input(p_access, flow, p_sys->msgs[i].msg_hdr.msg_iov->iov_base,
+                               p_sys->msgs[i].msg_len))
+                    queued = true;
+            }
+#else
             r = rist_Read_i11e(flow->fd_in, buf, p_sys->i_max_packet_size);
             if (unlikely(r == -1)) {
                 msg_Err(p_access, "socket %d error: %s\n", flow->fd_in, gai_strerror(errno));
@@ -898,23 +952,22 @@ static block_t *BlockRIST(stream_t *p_access, bool *restrict eof)
             else
             {
                 /* rist_input will process and queue the pkt */
-                if (rist_input(p_access, flow, buf, r))
-                {
-                    /* Check the queue for the next packet that needs to be delivered */
-                    pktout = rist_dequeue(p_access, flow);
-                    if (pktout) {
-                        p_sys->i_poll_timeout_current = 0;
-                        p_sys->i_poll_timeout_zero_count++;
-                    } else {
-                        p_sys->i_poll_timeout_current = p_sys->i_poll_timeout;
-                        p_sys->i_poll_timeout_nonzero_count++;
-                    }
+                queued = rist_input(p_access, flow, buf, r);
+            }
+#endif
+            if (queued)
+            {
+                /* Check the queue for the next packet that needs to be delivered */
+                pktout = rist_dequeue(p_access, flow);
+                if (pktout) {
+                    p_sys->i_poll_timeout_current = 0;
+                    p_sys->i_poll_timeout_zero_count++;
+                } else {
+                    p_sys->i_poll_timeout_current = p_sys->i_poll_timeout;
+                    p_sys->i_poll_timeout_nonzero_count++;
                 }
             }
         }
-
-        free(buf);
-        buf = NULL;
     }
 
     now = vlc_tick_now();
@@ -1030,6 +1083,7 @@ static void Clean( stream_t *p_access )
         free(p_sys->flow->buffer);
         free(p_sys->flow);
     }
+    free(p_sys->buf);
 }
 
 static void Close(vlc_object_t *p_this)
@@ -1085,6 +1139,25 @@ static int Open(vlc_object_t *p_this)
     p_sys->nack_type = var_InheritInteger( p_access, "nack-type" );
     p_sys->i_max_packet_size = var_InheritInteger( p_access, "packet-size" );
     p_sys->i_poll_timeout = var_InheritInteger( p_access, "maximum-jitter" );
+
+#ifdef HAVE_RECVMMSG
+    p_sys->buf = malloc((size_t)p_sys->i_max_packet_size * RIST_BATCH_SIZE);
+#else
+    p_sys->buf = malloc(p_sys->i_max_packet_size);
+#endif
+    if ( unlikely( p_sys->buf == NULL ) )
+        goto failed;
+#ifdef HAVE_RECVMMSG
+    for (int i = 0; i < RIST_BATCH_SIZE; i++)
+    {
+        p_sys->iovs[i].iov_base = p_sys->buf + (size_t)i * p_sys->i_max_packet_size;
+        p_sys->iovs[i].iov_len = p_sys->i_max_packet_size;
+        p_sys->msgs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = &p_sys->iovs[i],
+            .msg_iovlen = 1,
+        };
+    }
+#endif
     p_sys->flow->retry_interval = var_InheritInteger( p_access, "retry-interval" );
     p_sys->flow->max_retries = var_InheritInteger( p_access, "max-retries" );
     p_sys->flow->latency = var_InheritInteger( p_access, "latency" );
@@ -99,6 +99,8 @@ struct rist_flow {
     int fd_rtcp_m;
     int fd_nack;
     uint8_t nacks_retries[RIST_QUEUE_SIZE];
+    /* One bit per sequence number still missing in the window */
+    uint64_t missing[RIST_QUEUE_SIZE / 64];
     uint32_t hi_timestamp;
     uint64_t feedback_time;
     uint32_t latency;
@@ -77,6 +77,38 @@ static ssize_t vlc_datagram_Recv(struct vlc_dtls *dgs, struct iovec *iov,
     return ret;
 }
 
+#ifdef HAVE_RECVMMSG
+#define VLC_DATAGRAM_BATCH 32
+
+static int vlc_datagram_RecvBatch(struct vlc_dtls *dgs, struct iovec *iov,
+                                  size_t *lens, bool *truncated,
+                                  unsigned count)
+{
+    struct mmsghdr msgs[VLC_DATAGRAM_BATCH];
+    int fd = container_of(dgs, struct vlc_dgram_sock, s)->fd;
+
+    if (count > VLC_DATAGRAM_BATCH)
+        count = VLC_DATAGRAM_BATCH;
+
+    for (unsigned i = 0; i < count; i++)
+        msgs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = &iov[i],
+            .msg_iovlen = 1,
+        };
+
+    /* Wait for the first datagram only */
+    int ret = recvmmsg(fd, msgs, count, MSG_WAITFORONE, NULL);
+
+    for (int i = 0; i < ret; i++) {
+        lens[i] = msgs[i].msg_len;
+        truncated[i] = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+    }
+    return ret;
+}
+#else
+# define vlc_datagram_RecvBatch NULL
+#endif
+
 static ssize_t vlc_datagram_Send(struct vlc_dtls *dgs,
                                  const struct iovec *iov, unsigned iovlen)
 {
@@ -94,6 +126,7 @@ static const struct vlc_dtls_operations vlc_datagram_ops = {
     vlc_datagram_GetPollFD,
     vlc_datagram_Recv,
     vlc_datagram_Send,
+    vlc_datagram_RecvBatch,
 };
 
 struct vlc_dtls *vlc_datagram_CreateFD(int fd)
@@ -145,6 +178,7 @@ static const struct vlc_dtls_operations vlc_dccp_ops = {
     vlc_datagram_GetPollFD,
     vlc_dccp_Recv,
     vlc_datagram_Send,
+    NULL,
 };
 
 struct vlc_dtls *vlc_dccp_CreateFD(int fd)
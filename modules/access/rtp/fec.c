@@ -0,0 +1,331 @@
+/**
+ * @file fec.c
+ * @brief SMPTE 2022-1 (Pro-MPEG COP3) forward error correction receiver
+ */
+/*****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ ****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_block.h>
+
+#include "rtp.h"
+
+/*
+ * The column FEC stream comes on the media port + 2, the row one on the
+ * media port + 4. Each FEC packet is the XOR of the NA media packets
+ * SNBase + j * Offset, j in [0, NA[, headers included: a single missing
+ * packet of the group is rebuilt from the others.
+ *
+ * The received media packets are copied in a history ring, since the
+ * jitter buffer hands them over to the decoders long before a column FEC
+ * packet (sent after the whole L x D matrix) may come. The FEC packets that
+ * cannot be used yet (two packets missing or more) are kept, as a recovery
+ * through the other dimension can make them usable.
+ */
+
+/** Size of the media history, a power of two above two L x D matrices
+ * (at most 100 packets each) */
+#define FEC_HISTORY 256
+/** Maximum number of pending FEC packets */
+#define FEC_PENDING 64
+#define FEC_MTU 1500
+
+#define RTP_HEADER_SIZE 12
+#define FEC_HEADER_SIZE 16
+
+struct rtp_fec_media
+{
+    uint16_t seq;
+    bool     valid;
+    uint16_t len; /**< RTP packet length, header included */
+    uint8_t  data[FEC_MTU];
+};
+
+struct rtp_fec_packet
+{
+    uint16_t snbase;
+    uint16_t length_recovery;
+    uint8_t  pt_recovery;
+    uint32_t ts_recovery;
+    uint8_t  offset;
+    uint8_t  na;
+    uint16_t len; /**< recovery payload length */
+    uint8_t  payload[FEC_MTU];
+};
+
+struct rtp_fec
+{
+    struct rtp_fec_media   history[FEC_HISTORY];
+    struct rtp_fec_packet *pending[FEC_PENDING];
+    unsigned               pending_count;
+    uint16_t               last_seq; /**< highest media sequence seen */
+    bool                   started;
+    uint32_t               ssrc;
+
+    unsigned long          recovered;
+    unsigned long          unrecoverable;
+};
+
+struct rtp_fec *rtp_fec_create(void)
+{
+    struct rtp_fec *fec = malloc(sizeof (*fec));
+    if (unlikely(fec == NULL))
+        return NULL;
+
+    for (unsigned i = 0; i < FEC_HISTORY; i++)
+        fec->history[i].valid = false;
+    fec->pending_count = 0;
+    fec->started = false;
+    fec->recovered = 0;
+    fec->unrecoverable = 0;
+    return fec;
+}
+
+void rtp_fec_destroy(demux_t *demux, struct rtp_fec *fec)
+{
+    msg_Dbg(demux, "FEC: %lu packet(s) recovered, %lu unrecoverable",
+            fec->recovered, fec->unrecoverable);
+
+    for (unsigned i = 0; i < fec->pending_count; i++)
+        free(fec->pending[i]);
+    free(fec);
+}
+
+/**
+ * XORs src into dst. Done a machine word at a time, which the compilers
+ * turn into vector operations.
+ */
+static void fec_xor(uint8_t *restrict dst, const uint8_t *restrict src,
+                    size_t len)
+{
+    for (; len >= 8; len -= 8, dst += 8, src += 8)
+    {
+        uint64_t a, b;
+
+        memcpy(&a, dst, 8);
+        memcpy(&b, src, 8);
+        a ^= b;
+        memcpy(dst, &a, 8);
+    }
+    while (len-- > 0)
+        *(dst++) ^= *(src++);
+}
+
+static struct rtp_fec_media *fec_lookup(struct rtp_fec *fec, uint16_t seq)
+{
+    struct rtp_fec_media *m = &fec->history[seq & (FEC_HISTORY - 1)];
+
+    return (m->valid && m->seq == seq) ? m : NULL;
+}
+
+static void fec_store(struct rtp_fec *fec, const uint8_t *buf, size_t len)
+{
+    const uint16_t seq = GetWBE(buf + 2);
+    struct rtp_fec_media *m = &fec->history[seq & (FEC_HISTORY - 1)];
+
+    /* Headers with CSRC or extensions are not protected as such */
+    if (len > FEC_MTU || (buf[0] & 0x1F) != 0)
+        return;
+
+    m->seq = seq;
+    m->len = len;
+    memcpy(m->data, buf, len);
+    m->valid = true;
+
+    if (!fec->started || (int16_t)(seq - fec->last_seq) > 0)
+        fec->last_seq = seq;
+    fec->started = true;
+    fec->ssrc = GetDWBE(buf + 8);
+}
+
+void rtp_fec_media(struct rtp_fec *fec, const block_t *block)
+{
+    if (block->i_buffer >= RTP_HEADER_SIZE
+     && !(block->i_flags & BLOCK_FLAG_CORRUPTED))
+        fec_store(fec, block->p_buffer, block->i_buffer);
+}
+
+/** Whether a group is still within the history */
+static bool fec_is_current(const struct rtp_fec *fec,
+                           const struct rtp_fec_packet *f)
+{
+    uint16_t last = f->snbase + (f->na - 1) * f->offset;
+
+    return (uint16_t)(fec->last_seq - last) < FEC_HISTORY / 2
+        || (int16_t)(last - fec->last_seq) > 0;
+}
+
+/**
+ * Tries to rebuild the missing packet of a group.
+ * @return the rebuilt RTP packet, or NULL if none
+ * @param done set if the FEC packet is of no further use
+ */
+static block_t *fec_recover(struct rtp_fec *fec,
+                            const struct rtp_fec_packet *f, bool *done)
+{
+    uint16_t missing = 0;
+    unsigned missing_count = 0;
+
+    for (unsigned j = 0; j < f->na; j++)
+    {
+        uint16_t seq = f->snbase + j * f->offset;
+        if (fec_lookup(fec, seq) == NULL && ++missing_count == 1)
+            missing = seq;
+    }
+
+    *done = missing_count <= 1;
+    if (missing_count != 1)
+        return NULL;
+
+    block_t *block = block_Alloc(RTP_HEADER_SIZE + f->len);
+    if (unlikely(block == NULL))
+        return NULL;
+
+    uint8_t *payload = block->p_buffer + RTP_HEADER_SIZE;
+    uint16_t len = f->length_recovery;
+    uint8_t pt = f->pt_recovery;
+    uint32_t ts = f->ts_recovery;
+
+    memcpy(payload, f->payload, f->len);
+    for (unsigned j = 0; j < f->na; j++)
+    {
+        uint16_t seq = f->snbase + j * f->offset;
+        if (seq == missing)
+            continue;
+
+        const struct rtp_fec_media *m = fec_lookup(fec, seq);
+        size_t plen = m->len - RTP_HEADER_SIZE;
+
+        len ^= plen;
+        pt ^= m->data[1] & 0x7F;
+        ts ^= GetDWBE(m->data + 4);
+        fec_xor(payload, m->data + RTP_HEADER_SIZE, __MIN(plen, f->len));
+    }
+
+    if (len > f->len)
+    {   /* inconsistent group */
+        block_Release(block);
+        return NULL;
+    }
+
+    block->p_buffer[0] = 0x80;
+    block->p_buffer[1] = pt;
+    SetWBE(block->p_buffer + 2, missing);
+    SetDWBE(block->p_buffer + 4, ts);
+    SetDWBE(block->p_buffer + 8, fec->ssrc);
+    block->i_buffer = RTP_HEADER_SIZE + len;
+    return block;
+}
+
+/**
+ * Runs the pending FEC packets until no more packets can be rebuilt.
+ */
+static block_t *fec_run(struct rtp_fec *fec)
+{
+    block_t *chain = NULL, **pp = &chain;
+    bool progress;
+
+    do
+    {
+        progress = false;
+        for (unsigned i = 0; i < fec->pending_count;)
+        {
+            struct rtp_fec_packet *f = fec->pending[i];
+            bool done;
+            block_t *block = fec_recover(fec, f, &done);
+
+            if (block != NULL)
+            {
+                fec_store(fec, block->p_buffer, block->i_buffer);
+                fec->recovered++;
+                *pp = block;
+                pp = &block->p_next;
+                progress = true;
+            }
+
+            if (!done && fec_is_current(fec, f))
+            {
+                i++;
+                continue;
+            }
+            if (!done)
+                fec->unrecoverable++;
+            free(f);
+            fec->pending[i] = fec->pending[--fec->pending_count];
+        }
+    }
+    while (progress);
+
+    return chain;
+}
+
+block_t *rtp_fec_recv(demux_t *demux, struct rtp_fec *fec,
+                      const uint8_t *buf, size_t len)
+{
+    if (len < RTP_HEADER_SIZE + FEC_HEADER_SIZE || (buf[0] >> 6) != 2
+     || !fec->started)
+        return NULL;
+
+    size_t skip = RTP_HEADER_SIZE + (buf[0] & 0x0F) * 4;
+    if (len < skip + FEC_HEADER_SIZE)
+        return NULL;
+
+    const uint8_t *h = buf + skip;
+    const uint8_t na = h[14], offset = h[13];
+
+    /* E must be set, X (2022-5 extension) and the type must be zero */
+    if (!(h[4] & 0x80) || (h[12] & 0x80) || (h[12] & 0x38) != 0
+     || na == 0 || offset == 0)
+    {
+        msg_Dbg(demux, "unsupported FEC packet");
+        return NULL;
+    }
+
+    struct rtp_fec_packet *f;
+    if (fec->pending_count < FEC_PENDING)
+        f = malloc(sizeof (*f));
+    else
+    {   /* give up on the oldest group */
+        f = fec->pending[0];
+        fec->pending[0] = fec->pending[--fec->pending_count];
+        fec->unrecoverable++;
+    }
+    if (unlikely(f == NULL))
+        return NULL;
+
+    f->snbase = GetWBE(h);
+    f->length_recovery = GetWBE(h + 2);
+    f->pt_recovery = h[4] & 0x7F;
+    f->ts_recovery = GetDWBE(h + 8);
+    f->offset = offset;
+    f->na = na;
+    f->len = __MIN(len - skip - FEC_HEADER_SIZE, sizeof (f->payload));
+    memcpy(f->payload, h + FEC_HEADER_SIZE, f->len);
+    fec->pending[fec->pending_count++] = f;
+
+    return fec_run(fec);
+}
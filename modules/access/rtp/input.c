@@ -47,6 +47,8 @@
 #endif
 
 #define DEFAULT_MRU (1500u - (20 + 8))
+/* Datagrams received at once */
+#define RTP_BATCH 32
 
 /**
  * Processes a packet received from the RTP socket.
@@ -74,6 +76,9 @@ static void rtp_process (demux_t *demux, block_t *block)
     }
 #endif
 
+    if (sys->fec != NULL)
+        rtp_fec_media (sys->fec, block);
+
     /* TODO: use SDP and get rid of this hack */
     if (unlikely(sys->autodetect))
     {   /* Autodetect payload type, _before_ rtp_queue() */
@@ -87,6 +92,31 @@ drop:
     block_Release (block);
 }
 
+/**
+ * Receives a packet from one of the FEC sockets, and queues the media
+ * packets that it allowed to rebuild.
+ */
+static void rtp_process_fec (demux_t *demux, struct vlc_dtls *sock)
+{
+    demux_sys_t *sys = demux->p_sys;
+    uint8_t buf[DEFAULT_MRU];
+    bool truncated;
+
+    ssize_t len = vlc_dtls_Recv (sock, buf, sizeof (buf), &truncated);
+    if (len < 0 || truncated)
+        return;
+
+    block_t *block = rtp_fec_recv (demux, sys->fec, buf, len);
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        block->p_next = NULL;
+        rtp_queue (demux, sys->session, block);
+        block = next;
+    }
+}
+
 static int rtp_timeout (vlc_tick_t deadline)
 {
     if (deadline == VLC_TICK_INVALID)
@@ -102,6 +132,15 @@ static int rtp_timeout (vlc_tick_t deadline)
     return t;
 }
 
+static void rtp_slab_release (void *data)
+{
+    block_t **slab = data;
+
+    for (unsigned i = 0; i < RTP_BATCH; i++)
+        if (slab[i] != NULL)
+            block_Release(slab[i]);
+}
+
 /**
  * RTP/RTCP session thread for datagram sockets
  */
@@ -111,15 +150,31 @@ void *rtp_dgram_thread (void *opaque)
     demux_sys_t *sys = demux->p_sys;
     vlc_tick_t deadline = VLC_TICK_INVALID;
     struct vlc_dtls *rtp_sock = sys->rtp_sock;
-
+    /* Blocks allocated ahead, so that a batch is received straight into
+     * them */
+    block_t *slab[RTP_BATCH] = { NULL };
+    struct iovec iov[RTP_BATCH];
+    size_t lens[RTP_BATCH];
+    bool truncated[RTP_BATCH];
+
+    vlc_cleanup_push (rtp_slab_release, slab);
     for (;;)
     {
-        struct pollfd ufd[1];
+        struct pollfd ufd[3];
+        unsigned nfd = 1;
 
         ufd[0].events = POLLIN;
         ufd[0].fd = vlc_dtls_GetPollFD(rtp_sock, &ufd[0].events);
+        for (unsigned i = 0; i < ARRAY_SIZE(sys->fec_sock); i++)
+            if (sys->fec_sock[i] != NULL)
+            {
+                ufd[nfd].events = POLLIN;
+                ufd[nfd].fd = vlc_dtls_GetPollFD(sys->fec_sock[i],
+                                                 &ufd[nfd].events);
+                nfd++;
+            }
 
-        int n = poll (ufd, 1, rtp_timeout (deadline));
+        int n = poll (ufd, nfd, rtp_timeout (deadline));
         if (n == -1)
             continue;
 
@@ -129,40 +184,72 @@ void *rtp_dgram_thread (void *opaque)
 
         if (ufd[0].revents)
         {
-            block_t *block = block_Alloc(DEFAULT_MRU);
-            if (unlikely(block == NULL))
+            unsigned count = 0;
+
+            while (count < RTP_BATCH)
+            {
+                if (slab[count] == NULL)
+                {
+                    slab[count] = block_Alloc(DEFAULT_MRU);
+                    if (unlikely(slab[count] == NULL))
+                        break;
+                }
+                iov[count].iov_base = slab[count]->p_buffer;
+                iov[count].iov_len = slab[count]->i_buffer;
+                count++;
+            }
+            if (unlikely(count == 0))
                 break; /* we are totallly screwed */
 
-            bool truncated;
-            ssize_t len = vlc_dtls_Recv(rtp_sock, block->p_buffer,
-                                       block->i_buffer, &truncated);
-            if (len >= 0) {
-                if (truncated) {
+            int val = vlc_dtls_RecvBatch(rtp_sock, iov, lens, truncated,
+                                         count);
+            if (val < 0)
+            {
+                if (errno == EPIPE)
+                    break; /* connection terminated */
+                msg_Warn (demux, "RTP network error: %s",
+                          vlc_strerror_c(errno));
+            }
+
+            for (int i = 0; i < val; i++)
+            {
+                block_t *block = slab[i];
+
+                slab[i] = NULL;
+                if (truncated[i]) {
                     msg_Err(demux, "packet truncated (MRU was %zu)",
                             block->i_buffer);
                     block->i_flags |= BLOCK_FLAG_CORRUPTED;
                 }
                 else
-                    block->i_buffer = len;
+                    block->i_buffer = lens[i];
 
                 rtp_process (demux, block);
             }
-            else
-            {
-                if (errno == EPIPE)
-                    break; /* connection terminated */
-                msg_Warn (demux, "RTP network error: %s",
-                          vlc_strerror_c(errno));
-                block_Release (block);
-            }
+
+            /* Move the unused blocks first, for the next batch */
+            for (unsigned i = 0, j = 0; i < count; i++)
+                if (slab[i] != NULL)
+                {
+                    block_t *block = slab[i];
+                    slab[i] = NULL;
+                    slab[j++] = block;
+                }
 
             n--;
         }
 
+        for (unsigned i = 0, fd = 1; i < ARRAY_SIZE(sys->fec_sock); i++)
+            if (sys->fec_sock[i] != NULL && ufd[fd++].revents)
+                rtp_process_fec (demux, sys->fec_sock[i]);
+
     dequeue:
         if (!rtp_dequeue (demux, sys->session, &deadline))
             deadline = VLC_TICK_INVALID;
         vlc_restorecancel (canc);
     }
+    vlc_cleanup_pop ();
+
+    rtp_slab_release (slab);
     return NULL;
 }
@@ -148,11 +148,46 @@ static void Close (vlc_object_t *obj)
         srtp_destroy (p_sys->srtp);
 #endif
     rtp_session_destroy (demux, p_sys->session);
+    if (p_sys->fec != NULL)
+        rtp_fec_destroy (demux, p_sys->fec);
+    for (unsigned i = 0; i < ARRAY_SIZE(p_sys->fec_sock); i++)
+        if (p_sys->fec_sock[i] != NULL)
+            vlc_dtls_Close(p_sys->fec_sock[i]);
     if (p_sys->rtcp_sock != NULL)
         vlc_dtls_Close(p_sys->rtcp_sock);
     vlc_dtls_Close(p_sys->rtp_sock);
 }
 
+/**
+ * Joins the SMPTE 2022-1 FEC streams, on the media port + 2 (columns) and
+ * + 4 (rows). Either may be missing.
+ */
+static void OpenFEC (vlc_object_t *obj, demux_sys_t *sys, const char *dhost,
+                     int dport, const char *shost, int tp)
+{
+    if (!var_InheritBool (obj, "rtp-fec") || dport > 65535 - 4)
+        return;
+
+    for (unsigned i = 0; i < ARRAY_SIZE(sys->fec_sock); i++)
+    {
+        int fd = net_OpenDgram (obj, dhost, dport + 2 * (i + 1), shost, 0, tp);
+        if (fd == -1)
+            continue;
+
+        sys->fec_sock[i] = vlc_datagram_CreateFD (fd);
+        if (sys->fec_sock[i] == NULL)
+            net_Close (fd);
+    }
+
+    if (sys->fec_sock[0] == NULL && sys->fec_sock[1] == NULL)
+        return;
+
+    sys->fec = rtp_fec_create ();
+    if (sys->fec != NULL)
+        sys->fec_delay =
+            VLC_TICK_FROM_MS (var_InheritInteger (obj, "rtp-fec-delay"));
+}
+
 static int OpenSDP(vlc_object_t *obj)
 {
     demux_t *demux = (demux_t *)obj;
@@ -182,6 +217,9 @@ static int OpenSDP(vlc_object_t *obj)
 
     sys->rtp_sock = NULL;
     sys->rtcp_sock = NULL;
+    sys->fec_sock[0] = sys->fec_sock[1] = NULL;
+    sys->fec = NULL;
+    sys->fec_delay = 0;
     sys->session = NULL;
 #ifdef HAVE_SRTP
     sys->srtp = NULL;
@@ -355,6 +393,10 @@ static int OpenURL(vlc_object_t *obj)
     if (unlikely(p_sys == NULL))
         return VLC_ENOMEM;
 
+    p_sys->fec_sock[0] = p_sys->fec_sock[1] = NULL;
+    p_sys->fec = NULL;
+    p_sys->fec_delay = 0;
+
     char *tmp = strdup (demux->psz_location);
     if (tmp == NULL)
         return VLC_ENOMEM;
@@ -396,6 +438,7 @@ static int OpenURL(vlc_object_t *obj)
                 break;
             if (rtcp_dport > 0) /* XXX: source port is unknown */
                 rtcp_fd = net_OpenDgram (obj, dhost, rtcp_dport, shost, 0, tp);
+            OpenFEC (obj, p_sys, dhost, dport, shost, tp);
             break;
 
          case IPPROTO_DCCP:
@@ -417,9 +460,14 @@ static int OpenURL(vlc_object_t *obj)
 
     free (tmp);
     p_sys->rtp_sock = (co ? vlc_dccp_CreateFD : vlc_datagram_CreateFD)(fd);
-    if (p_sys->rtcp_sock == NULL) {
+    if (p_sys->rtp_sock == NULL) {
         if (rtcp_fd != -1)
             net_Close(rtcp_fd);
+        for (unsigned i = 0; i < ARRAY_SIZE(p_sys->fec_sock); i++)
+            if (p_sys->fec_sock[i] != NULL)
+                vlc_dtls_Close(p_sys->fec_sock[i]);
+        if (p_sys->fec != NULL)
+            rtp_fec_destroy(demux, p_sys->fec);
         return VLC_EGENERIC;
     }
     net_SetCSCov (fd, -1, 12);
@@ -488,6 +536,11 @@ error:
 #endif
     if (p_sys->session != NULL)
         rtp_session_destroy(demux, p_sys->session);
+    if (p_sys->fec != NULL)
+        rtp_fec_destroy(demux, p_sys->fec);
+    for (unsigned i = 0; i < ARRAY_SIZE(p_sys->fec_sock); i++)
+        if (p_sys->fec_sock[i] != NULL)
+            vlc_dtls_Close(p_sys->fec_sock[i]);
     if (p_sys->rtcp_sock != NULL)
         vlc_dtls_Close(p_sys->rtcp_sock);
     vlc_dtls_Close(p_sys->rtp_sock);
@@ -528,6 +581,16 @@ error:
     "RTP packets will be discarded if they are too far behind (i.e. in the " \
     "past) by this many packets from the last received packet." )
 
+#define RTP_FEC_TEXT N_("SMPTE 2022-1 FEC")
+#define RTP_FEC_LONGTEXT N_( \
+    "Receive the Pro-MPEG column and row FEC streams on the RTP port + 2 " \
+    "and + 4, and rebuild the lost packets from them.")
+
+#define RTP_FEC_DELAY_TEXT N_("FEC recovery delay (ms)")
+#define RTP_FEC_DELAY_LONGTEXT N_( \
+    "How long to wait for a missing packet to be rebuilt from the FEC " \
+    "packets. This should cover the duration of a FEC matrix.")
+
 #define RTP_DYNAMIC_PT_TEXT N_("RTP payload format assumed for dynamic " \
                                "payloads")
 #define RTP_DYNAMIC_PT_LONGTEXT N_( \
@@ -576,6 +639,10 @@ vlc_module_begin()
     add_integer("rtp-max-misorder", 100, RTP_MAX_MISORDER_TEXT,
                 RTP_MAX_MISORDER_LONGTEXT, true)
         change_integer_range (0, 32767)
+    add_bool("rtp-fec", false, RTP_FEC_TEXT, RTP_FEC_LONGTEXT, true)
+    add_integer("rtp-fec-delay", 200, RTP_FEC_DELAY_TEXT,
+                RTP_FEC_DELAY_LONGTEXT, true)
+        change_integer_range (0, 10000)
     add_string("rtp-dynamic-pt", NULL, RTP_DYNAMIC_PT_TEXT,
                RTP_DYNAMIC_PT_LONGTEXT, true)
         change_string_list(dynamic_pt_list, dynamic_pt_list_text)
@@ -59,6 +59,13 @@ int rtp_add_type (demux_t *demux, rtp_session_t *ses, const rtp_pt_t *pt);
 
 void *rtp_dgram_thread (void *data);
 
+/** @section SMPTE 2022-1 FEC */
+struct rtp_fec;
+struct rtp_fec *rtp_fec_create (void);
+void rtp_fec_destroy (demux_t *, struct rtp_fec *);
+void rtp_fec_media (struct rtp_fec *, const block_t *);
+block_t *rtp_fec_recv (demux_t *, struct rtp_fec *, const uint8_t *, size_t);
+
 /* Global data */
 typedef struct
 {
@@ -69,9 +76,12 @@ typedef struct
 #endif
     struct vlc_dtls *rtp_sock;
     struct vlc_dtls *rtcp_sock;
+    struct vlc_dtls *fec_sock[2]; /**< column and row FEC, or NULL */
+    struct rtp_fec *fec;
     vlc_thread_t  thread;
 
     vlc_tick_t    timeout;
+    vlc_tick_t    fec_delay; /**< Minimum wait for a missing packet */
     uint16_t      max_dropout; /**< Max packet forward misordering */
     uint16_t      max_misorder; /**< Max packet backward misordering */
     uint8_t       max_src; /**< Max simultaneous RTP sources */
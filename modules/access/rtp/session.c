@@ -49,7 +49,8 @@ rtp_source_create (demux_t *, const rtp_session_t *, uint32_t, uint16_t);
 static void
 rtp_source_destroy (demux_t *, const rtp_session_t *, rtp_source_t *);
 
-static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
+static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *,
+                        block_t *);
 
 /**
  * Creates a new RTP session.
@@ -134,6 +135,10 @@ int rtp_add_type (demux_t *demux, rtp_session_t *ses, const rtp_pt_t *pt)
     return 0;
 }
 
+/** Size of the re-ordering ring, must be a power of two.
+ * Packets further ahead than this force the oldest ones out. */
+#define RTP_RING_SIZE 8192
+
 /** State for an RTP source */
 struct rtp_source_t
 {
@@ -148,8 +153,9 @@ struct rtp_source_t
     uint16_t bad_seq; /* tentatively next expected sequence for resync */
     uint16_t max_seq; /* next expected sequence */
 
-    uint16_t last_seq; /* sequence of the next dequeued packet */
-    block_t *blocks; /* re-ordered blocks queue */
+    uint16_t last_seq; /* sequence of the last dequeued packet */
+    unsigned count; /* number of queued blocks */
+    block_t *ring[RTP_RING_SIZE]; /* re-ordered blocks, by sequence number */
     void    *opaque[]; /* Per-source private payload data */
 };
 
@@ -172,7 +178,8 @@ rtp_source_create (demux_t *demux, const rtp_session_t *session,
     source->ref_ntp = UINT64_C (1) << 62;
     source->max_seq = source->bad_seq = init_seq;
     source->last_seq = init_seq - 1;
-    source->blocks = NULL;
+    source->count = 0;
+    memset (source->ring, 0, sizeof (source->ring));
 
     /* Initializes all payload */
     for (unsigned i = 0; i < session->ptc; i++)
@@ -186,6 +193,17 @@ rtp_source_create (demux_t *demux, const rtp_session_t *session,
 /**
  * Destroys an RTP source and its associated streams.
  */
+static void rtp_source_flush (rtp_source_t *source)
+{
+    for (unsigned i = 0; source->count > 0 && i < RTP_RING_SIZE; i++)
+        if (source->ring[i] != NULL)
+        {
+            block_Release (source->ring[i]);
+            source->ring[i] = NULL;
+            source->count--;
+        }
+}
+
 static void
 rtp_source_destroy (demux_t *demux, const rtp_session_t *session,
                     rtp_source_t *source)
@@ -194,7 +212,7 @@ rtp_source_destroy (demux_t *demux, const rtp_session_t *session,
 
     for (unsigned i = 0; i < session->ptc; i++)
         session->ptv[i].destroy (demux, source->opaque[i]);
-    block_ChainRelease (source->blocks);
+    rtp_source_flush (source);
     free (source);
 }
 
@@ -210,6 +228,23 @@ static inline uint32_t rtp_timestamp (const block_t *block)
     return GetDWBE (block->p_buffer + 4);
 }
 
+/**
+ * Returns the queued block with the lowest sequence number, skipping over
+ * the missing packets.
+ */
+static block_t *rtp_source_first (const rtp_source_t *source)
+{
+    if (source->count == 0)
+        return NULL;
+
+    for (uint16_t seq = source->last_seq + 1;; seq++)
+    {
+        block_t *block = source->ring[seq & (RTP_RING_SIZE - 1)];
+        if (block != NULL)
+            return block;
+    }
+}
+
 static const struct rtp_pt_t *
 rtp_find_ptype (const rtp_session_t *session, rtp_source_t *source,
                 const block_t *block, void **pt_data)
@@ -335,10 +370,10 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
         if (seq == src->bad_seq)
         {
             src->max_seq = src->bad_seq = seq + 1;
-            src->last_seq = seq - 0x7fffe; /* hack for rtp_decode() */
+            src->last_seq = seq - 1;
             msg_Warn (demux, "sequence resynchronized");
-            block_ChainRelease (src->blocks);
-            src->blocks = NULL;
+            rtp_source_flush (src);
+            block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
         }
         else
         {
@@ -350,23 +385,35 @@ rtp_queue (demux_t *demux, rtp_session_t *session, block_t *block)
     if (delta_seq >= 0)
         src->max_seq = seq + 1;
 
-    /* Queues the block in sequence order,
+    /* Queues the block at its sequence number,
      * hence there is a single queue for all payload types. */
-    block_t **pp = &src->blocks;
-    for (block_t *prev = *pp; prev != NULL; prev = *pp)
+    uint16_t ahead = seq - (uint16_t)(src->last_seq + 1);
+    if (ahead >= 0x8000)
+    {   /* Trash too late packets (and PIM Assert duplicates) */
+        msg_Dbg (demux, "ignoring late packet (sequence: %"PRIu16")", seq);
+        goto drop;
+    }
+    /* Make room by giving up on the oldest missing packets */
+    while (ahead >= RTP_RING_SIZE)
     {
-        delta_seq = seq - rtp_seq (prev);
-        if (delta_seq < 0)
-            break;
-        if (delta_seq == 0)
+        block_t *first = rtp_source_first (src);
+        if (first == NULL || (uint16_t)(seq - rtp_seq (first)) < RTP_RING_SIZE)
         {
-            msg_Dbg (demux, "duplicate packet (sequence: %"PRIu16")", seq);
-            goto drop; /* duplicate */
+            src->last_seq = seq - RTP_RING_SIZE;
+            break;
         }
-        pp = &prev->p_next;
+        rtp_decode (demux, session, src, first);
+        ahead = seq - (uint16_t)(src->last_seq + 1);
     }
-    block->p_next = *pp;
-    *pp = block;
+
+    block_t **slot = &src->ring[seq & (RTP_RING_SIZE - 1)];
+    if (*slot != NULL)
+    {
+        msg_Dbg (demux, "duplicate packet (sequence: %"PRIu16")", seq);
+        goto drop; /* duplicate */
+    }
+    *slot = block;
+    src->count++;
 
     /*rtp_decode (demux, session, src);*/
     return;
@@ -376,7 +423,8 @@ drop:
 }
 
 
-static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
+static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *,
+                        block_t *);
 
 /**
  * Dequeues RTP packets and pass them to decoder. Not cancellation-safe(?).
@@ -393,6 +441,7 @@ static void rtp_decode (demux_t *, const rtp_session_t *, rtp_source_t *);
 bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
                   vlc_tick_t *restrict deadlinep)
 {
+    demux_sys_t *sys = demux->p_sys;
     vlc_tick_t now = vlc_tick_now ();
     bool pending = false;
 
@@ -419,11 +468,11 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
          * LibVLC E/S-out clock synchronization. Here, we need to bother about
          * re-ordering packets, as decoders can't cope with mis-ordered data.
          */
-        while (((block = src->blocks)) != NULL)
+        while (((block = rtp_source_first (src))) != NULL)
         {
-            if ((int16_t)(rtp_seq (block) - (src->last_seq + 1)) <= 0)
-            {   /* Next (or earlier) block ready, no need to wait */
-                rtp_decode (demux, session, src);
+            if (rtp_seq (block) == (uint16_t)(src->last_seq + 1))
+            {   /* Next block ready, no need to wait */
+                rtp_decode (demux, session, src, block);
                 continue;
             }
 
@@ -437,9 +486,12 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
             else
                 deadline = 0; /* no jitter estimate with no frequency :( */
 
-            /* Make sure we wait at least for 25 msec */
+            /* Make sure we wait at least for 25 msec, or long enough for
+             * the FEC packets to rebuild the missing ones */
             if (deadline < VLC_TICK_FROM_MS(25))
                 deadline = VLC_TICK_FROM_MS(25);
+            if (deadline < sys->fec_delay)
+                deadline = sys->fec_delay;
 
             /* Additionnaly, we implicitly wait for the packetization time
              * multiplied by the number of missing packets. block is the first
@@ -449,7 +501,7 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
             deadline += block->i_pts;
             if (now >= deadline)
             {
-                rtp_decode (demux, session, src);
+                rtp_decode (demux, session, src, block);
                 continue;
             }
             if (*deadlinep > deadline)
@@ -462,27 +514,20 @@ bool rtp_dequeue (demux_t *demux, const rtp_session_t *session,
 }
 
 /**
- * Decodes one RTP packet.
+ * Decodes one RTP packet, the first queued one.
  */
 static void
-rtp_decode (demux_t *demux, const rtp_session_t *session, rtp_source_t *src)
+rtp_decode (demux_t *demux, const rtp_session_t *session, rtp_source_t *src,
+            block_t *block)
 {
-    block_t *block = src->blocks;
+    assert (block != NULL && block == rtp_source_first (src));
+    src->ring[rtp_seq (block) & (RTP_RING_SIZE - 1)] = NULL;
+    src->count--;
 
-    assert (block);
-    src->blocks = block->p_next;
-    block->p_next = NULL;
-
-    /* Discontinuity detection */
+    /* Discontinuity detection, the queue only holds later packets */
     uint16_t delta_seq = rtp_seq (block) - (src->last_seq + 1);
     if (delta_seq != 0)
     {
-        if (delta_seq >= 0x8000)
-        {   /* Trash too late packets (and PIM Assert duplicates) */
-            msg_Dbg (demux, "ignoring late packet (sequence: %"PRIu16")",
-                      rtp_seq (block));
-            goto drop;
-        }
         msg_Warn (demux, "%"PRIu16" packet(s) lost", delta_seq);
         block->i_flags |= BLOCK_FLAG_DISCONTINUITY;
     }
@@ -37,6 +37,9 @@ struct vlc_dtls_operations {
     ssize_t (*readv)(struct vlc_dtls *, struct iovec *iov, unsigned len,
                      bool *restrict truncated);
     ssize_t (*writev)(struct vlc_dtls *, const struct iovec *iov, unsigned len);
+    /* Optional, receives several datagrams, one per I/O vector */
+    int (*recv_batch)(struct vlc_dtls *, struct iovec *iov, size_t *lens,
+                      bool *truncated, unsigned count);
 };
 
 static inline void vlc_dtls_Close(struct vlc_dtls *dgs)
@@ -57,6 +60,27 @@ static inline ssize_t vlc_dtls_Recv(struct vlc_dtls *dgs, void *buf, size_t len,
     return dgs->ops->readv(dgs, &iov, 1, truncated);
 }
 
+/**
+ * Receives at least one datagram, and then as many as are already pending,
+ * up to the count. The lengths and truncation flags are returned per
+ * datagram.
+ *
+ * @return the number of datagrams received, or -1 on error
+ */
+static inline int vlc_dtls_RecvBatch(struct vlc_dtls *dgs, struct iovec *iov,
+                                     size_t *lens, bool *truncated,
+                                     unsigned count)
+{
+    if (dgs->ops->recv_batch != NULL)
+        return dgs->ops->recv_batch(dgs, iov, lens, truncated, count);
+
+    ssize_t ret = dgs->ops->readv(dgs, iov, 1, truncated);
+    if (ret < 0)
+        return -1;
+    lens[0] = ret;
+    return 1;
+}
+
 static inline ssize_t vlc_dtls_Send(struct vlc_dtls *dgs, const void *buf,
                                    size_t len)
 {
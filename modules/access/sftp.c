@@ -32,8 +32,12 @@
 #include <vlc_plugin.h>
 
 #include <assert.h>
+#ifdef HAVE_POLL_H
+# include <poll.h>
+#endif
 
 #include <vlc_access.h>
+#include <vlc_interrupt.h>
 #include <vlc_input_item.h>
 #include <vlc_network.h>
 #include <vlc_url.h>
@@ -57,6 +61,10 @@ static void Close( vlc_object_t* );
 #define PASS_TEXT N_("Password")
 #define PASS_LONGTEXT N_("Password that will be used for the connection, " \
         "if no username or password are set in URL.")
+#define READ_AHEAD_TEXT N_("Read-ahead size (kB)")
+#define READ_AHEAD_LONGTEXT N_("Maximum amount of data requested from the " \
+        "server ahead of the reading position. Larger values keep more read " \
+        "requests in flight, which helps on high-latency links.")
 
 vlc_module_begin ()
     set_shortname( "SFTP" )
@@ -67,6 +75,9 @@ vlc_module_begin ()
     add_integer( "sftp-port", 22, PORT_TEXT, PORT_LONGTEXT, true )
     add_string( "sftp-user", NULL, USER_TEXT, USER_LONGTEXT, false )
     add_password("sftp-pwd", NULL, PASS_TEXT, PASS_LONGTEXT)
+    add_integer( "sftp-read-ahead", 4096, READ_AHEAD_TEXT,
+                 READ_AHEAD_LONGTEXT, true )
+        change_integer_range( 128, 65536 )
     add_shortcut( "sftp" )
     set_callbacks( Open, Close )
 vlc_module_end ()
@@ -89,8 +100,18 @@ typedef struct
     LIBSSH2_SFTP_HANDLE* file;
     uint64_t filesize;
     char *psz_base_url;
+
+    /* libssh2 keeps requests for up to the size of the read buffer in
+     * flight, so the read-ahead window is the size passed to it */
+    uint8_t *buf;
+    size_t buf_pos;
+    size_t buf_len;
+    size_t window;
+    size_t window_max;
 } access_sys_t;
 
+#define SFTP_MIN_WINDOW (128 << 10)
+
 static int AuthKeyAgent( stream_t *p_access, const char *psz_username )
 {
     access_sys_t* p_sys = p_access->p_sys;
@@ -211,7 +232,7 @@ static int SSHSessionInit( stream_t *p_access, const char *psz_host, int i_port
     if( i_ret != 0 )
         goto error;
 
-    /* Set the socket in non-blocking mode */
+    /* Set the session in blocking mode until the file is opened */
     libssh2_session_set_blocking( p_sys->ssh_session, 1 );
     return VLC_SUCCESS;
 
@@ -479,6 +500,12 @@ static int Open( vlc_object_t* p_this )
         p_sys->file = libssh2_sftp_open( p_sys->sftp_session, psz_path, LIBSSH2_FXF_READ, 0 );
         p_sys->filesize = attributes.filesize;
 
+        p_sys->window_max = var_InheritInteger( p_access, "sftp-read-ahead" ) << 10;
+        p_sys->window = SFTP_MIN_WINDOW;
+        p_sys->buf = vlc_obj_malloc( p_this, p_sys->window_max );
+        if( !p_sys->buf )
+            goto error;
+
         ACCESS_SET_CALLBACKS( Read, NULL, Control, Seek );
     }
     else
@@ -507,6 +534,10 @@ static int Open( vlc_object_t* p_this )
         goto error;
     }
 
+    /* Reads are waited for with vlc_poll_i11e(), so they can be
+     * interrupted */
+    if( p_sys->buf )
+        libssh2_session_set_blocking( p_sys->ssh_session, 0 );
     i_result = VLC_SUCCESS;
 
 error:
@@ -528,6 +559,8 @@ static void Close( vlc_object_t* p_this )
     stream_t*   p_access = (stream_t*)p_this;
     access_sys_t* p_sys = p_access->p_sys;
 
+    if( p_sys->ssh_session )
+        libssh2_session_set_blocking( p_sys->ssh_session, 1 );
     if( p_sys->file )
         libssh2_sftp_close_handle( p_sys->file );
     if( p_sys->sftp_session )
@@ -538,18 +571,62 @@ static void Close( vlc_object_t* p_this )
 }
 
 
+/* Waits until the session socket is ready in the direction libssh2 is
+ * blocked on */
+static int SSHWait( stream_t *p_access )
+{
+    access_sys_t *p_sys = p_access->p_sys;
+    int dir = libssh2_session_block_directions( p_sys->ssh_session );
+    struct pollfd ufd = { .fd = p_sys->i_socket, .events = 0 };
+
+    if( dir & LIBSSH2_SESSION_BLOCK_INBOUND )
+        ufd.events |= POLLIN;
+    if( dir & LIBSSH2_SESSION_BLOCK_OUTBOUND )
+        ufd.events |= POLLOUT;
+
+    return vlc_poll_i11e( &ufd, 1, -1 ) < 0 ? -1 : 0;
+}
+
 static ssize_t Read( stream_t *p_access, void *buf, size_t len )
 {
     access_sys_t *p_sys = p_access->p_sys;
 
-    ssize_t val = libssh2_sftp_read(  p_sys->file, buf, len );
+    if( p_sys->buf_pos < p_sys->buf_len )
+    {
+        size_t copy = __MIN( len, p_sys->buf_len - p_sys->buf_pos );
+
+        memcpy( buf, p_sys->buf + p_sys->buf_pos, copy );
+        p_sys->buf_pos += copy;
+        return copy;
+    }
+
+    /* Large reads go straight to the caller buffer */
+    bool direct = len >= p_sys->window;
+    uint8_t *dst = direct ? buf : p_sys->buf;
+    size_t size = direct ? len : p_sys->window;
+    ssize_t val;
+
+    while( ( val = libssh2_sftp_read( p_sys->file, (char *)dst, size ) )
+           == LIBSSH2_ERROR_EAGAIN )
+    {
+        /* The server did not keep up: ask for more data at once */
+        p_sys->window = __MIN( p_sys->window * 2, p_sys->window_max );
+        if( SSHWait( p_access ) )
+            return -1;
+    }
+
     if( val < 0 )
     {
         msg_Err( p_access, "read failed" );
         return 0;
     }
 
-    return val;
+    if( direct || val == 0 )
+        return val;
+
+    p_sys->buf_pos = 0;
+    p_sys->buf_len = val;
+    return Read( p_access, buf, len );
 }
 
 
@@ -557,7 +634,10 @@ static int Seek( stream_t* p_access, uint64_t i_pos )
 {
     access_sys_t *sys = p_access->p_sys;
 
-    libssh2_sftp_seek( sys->file, i_pos );
+    /* This discards the pending read requests */
+    libssh2_sftp_seek64( sys->file, i_pos );
+    sys->buf_pos = sys->buf_len = 0;
+    sys->window = SFTP_MIN_WINDOW;
     return VLC_SUCCESS;
 }
 
@@ -72,10 +72,28 @@ vlc_module_begin()
     add_string("smb-user", NULL, SMB_USER_TEXT, SMB_USER_LONGTEXT, false)
     add_password("smb-pwd", NULL, SMB_PASS_TEXT, SMB_PASS_LONGTEXT)
     add_string("smb-domain", NULL, SMB_DOMAIN_TEXT, SMB_DOMAIN_LONGTEXT, false)
+    add_integer("smb2-read-ahead", 8, N_("Read-ahead depth"),
+                N_("Maximum number of reads in flight. Queuing reads ahead "
+                   "hides the network latency."), true)
+        change_integer_range(1, 32)
     add_shortcut("smb", "smb2")
     set_callbacks(Open, Close)
 vlc_module_end()
 
+/* Limit the read size since smb2_pread_async() will complete only after
+ * reading the whole requested data and not when whatever data is available
+ * (high read size means a faster I/O but a higher latency). */
+#define SMB2_READ_SIZE 262144
+
+struct vlc_smb2_read
+{
+    stream_t *access;
+    uint8_t *buf;
+    uint64_t offset;
+    size_t len;
+    bool pending;
+};
+
 struct access_sys
 {
     struct smb2_context *   smb2;
@@ -84,17 +102,19 @@ struct access_sys
     struct srvsvc_netshareenumall_rep *share_enum;
     uint64_t                smb2_size;
     vlc_url_t               encoded_url;
-    bool                    eof;
     bool                    smb2_connected;
     int                     error_status;
 
+    /* Reads queued ahead, completed in any order but consumed in order */
+    struct vlc_smb2_read *  reads;
+    unsigned                read_depth;
+    unsigned                read_window; /* reads to queue */
+    unsigned                read_head;
+    unsigned                read_count;
+    unsigned                read_pending;
+    uint64_t                offset;
+
     bool res_done;
-    union {
-        struct
-        {
-            size_t len;
-        } read;
-    } res;
 };
 
 static int
@@ -219,47 +239,161 @@ smb2_generic_cb(struct smb2_context *smb2, int status, void *data,
 }
 
 static void
-smb2_read_cb(struct smb2_context *smb2, int status, void *data,
-             void *private_data)
+smb2_pread_cb(struct smb2_context *smb2, int status, void *data,
+              void *private_data)
 {
     VLC_UNUSED(data);
-    VLC_SMB2_GENERIC_CB();
+    struct vlc_smb2_read *read = private_data;
+    stream_t *access = read->access;
+    struct access_sys *sys = access->p_sys;
 
-    if (status == 0)
-        sys->eof = true;
-    else
-        sys->res.read.len = status;
+    assert(sys->smb2 == smb2);
+    assert(sys->read_pending > 0);
+    read->pending = false;
+    sys->read_pending--;
+
+    if (VLC_SMB2_CHECK_STATUS(access, status))
+        return;
+    read->len = status;
 }
 
-static ssize_t
-FileRead(stream_t *access, void *buf, size_t len)
+static int
+vlc_smb2_queue_read(stream_t *access, uint64_t offset)
 {
     struct access_sys *sys = access->p_sys;
-
-    if (sys->error_status != 0)
+    struct vlc_smb2_read *read =
+        &sys->reads[(sys->read_head + sys->read_count) % sys->read_depth];
+
+    assert(!read->pending);
+    read->offset = offset;
+    read->len = 0;
+    if (smb2_pread_async(sys->smb2, sys->smb2fh, read->buf, SMB2_READ_SIZE,
+                         offset, smb2_pread_cb, read) < 0)
+    {
+        VLC_SMB2_SET_ERROR(access, "smb2_pread_async", 1);
         return -1;
+    }
+    read->pending = true;
+    sys->read_pending++;
+    sys->read_count++;
+    return 0;
+}
 
-    if (sys->eof)
-        return 0;
+/* Waits for the reads in flight, whose data is not needed anymore */
+static int
+vlc_smb2_drain_reads(stream_t *access, bool teardown)
+{
+    struct access_sys *sys = access->p_sys;
 
-    /* Limit the read size since smb2_read_async() will complete only after
-     * reading the whole requested data and not when whatever data is available
-     * (high read size means a faster I/O but a higher latency). */
-    if (len > 262144)
-        len = 262144;
+    while (sys->read_pending > 0)
+        if (vlc_smb2_mainloop(access, teardown) < 0)
+            return -1;
+    sys->read_head = 0;
+    sys->read_count = 0;
+    return 0;
+}
 
-    sys->res.read.len = 0;
-    if (smb2_read_async(sys->smb2, sys->smb2fh, buf, len,
-                        smb2_read_cb, access) < 0)
-    {
-        VLC_SMB2_SET_ERROR(access, "smb2_read_async", 1);
+static int
+vlc_smb2_init_reads(stream_t *access)
+{
+    struct access_sys *sys = access->p_sys;
+
+    sys->read_depth = var_InheritInteger(access, "smb2-read-ahead");
+    sys->reads = vlc_obj_malloc(VLC_OBJECT(access),
+                                sys->read_depth * sizeof (*sys->reads));
+    if (unlikely(sys->reads == NULL))
         return -1;
+
+    for (unsigned i = 0; i < sys->read_depth; i++)
+    {
+        /* Released with the access, after the SMB2 context: the reads in
+         * flight are cancelled by smb2_destroy_context() */
+        sys->reads[i].buf = vlc_obj_malloc(VLC_OBJECT(access), SMB2_READ_SIZE);
+        if (unlikely(sys->reads[i].buf == NULL))
+            return -1;
+        sys->reads[i].access = access;
+        sys->reads[i].pending = false;
     }
+    sys->read_window = 1;
+    return 0;
+}
 
-    if (vlc_smb2_mainloop(access, false) < 0)
-        return -1;
+static ssize_t
+FileRead(stream_t *access, void *buf, size_t len)
+{
+    struct access_sys *sys = access->p_sys;
+
+    for (;;)
+    {
+        if (sys->error_status != 0)
+            return -1;
+
+        struct vlc_smb2_read *read = &sys->reads[sys->read_head];
+
+        if (sys->read_count == 0 || sys->offset < read->offset
+         || sys->offset - read->offset >= SMB2_READ_SIZE)
+        {   /* Not read ahead (after a seek): start again with one read */
+            if (vlc_smb2_drain_reads(access, false) < 0)
+                return -1;
+            if (sys->offset >= sys->smb2_size)
+                return 0;
+            sys->read_window = 1;
+            if (vlc_smb2_queue_read(access, sys->offset) < 0)
+                return -1;
+            continue;
+        }
+
+        if (read->pending)
+        {   /* The data is consumed faster than it is read: queue more reads
+             * to cover the bandwidth-delay product of the link. */
+            if (sys->read_window < sys->read_depth)
+                sys->read_window *= 2;
+            if (sys->read_window > sys->read_depth)
+                sys->read_window = sys->read_depth;
+
+            if (vlc_smb2_mainloop(access, false) < 0)
+                return -1;
+            continue;
+        }
+
+        size_t skip = sys->offset - read->offset;
+        if (skip >= read->len)
+        {
+            if (read->len == 0)
+                return 0; /* end of file */
+            /* Short read, read again from the current offset */
+            sys->read_count = 0;
+            continue;
+        }
 
-    return sys->res.read.len;
+        size_t copy = read->len - skip;
+        if (copy > len)
+            copy = len;
+        memcpy(buf, read->buf + skip, copy);
+        sys->offset += copy;
+
+        if (skip + copy == SMB2_READ_SIZE)
+        {
+            sys->read_head = (sys->read_head + 1) % sys->read_depth;
+            sys->read_count--;
+        }
+
+        /* Keep the window of reads in flight full */
+        while (sys->read_count < sys->read_window)
+        {
+            unsigned last = (sys->read_head + sys->read_count + sys->read_depth
+                             - 1) % sys->read_depth;
+            uint64_t offset = sys->read_count > 0
+                ? sys->reads[last].offset + SMB2_READ_SIZE : sys->offset;
+
+            if (offset >= sys->smb2_size
+             || sys->reads[(sys->read_head + sys->read_count)
+                           % sys->read_depth].pending
+             || vlc_smb2_queue_read(access, offset) < 0)
+                break;
+        }
+        return copy;
+    }
 }
 
 static int
@@ -270,13 +404,8 @@ FileSeek(stream_t *access, uint64_t i_pos)
     if (sys->error_status != 0)
         return VLC_EGENERIC;
 
-    if (smb2_lseek(sys->smb2, sys->smb2fh, i_pos, SEEK_SET, NULL) < 0)
-    {
-        VLC_SMB2_SET_ERROR(access, "smb2_seek_async", 1);
-        return VLC_EGENERIC;
-    }
-    sys->eof = false;
-
+    /* The reads queued ahead are discarded on the next read, if need be */
+    sys->offset = i_pos;
     return VLC_SUCCESS;
 }
 
@@ -733,6 +862,12 @@ Open(vlc_object_t *p_obj)
 
     if (sys->smb2fh != NULL)
     {
+        if (vlc_smb2_init_reads(access) != 0)
+        {
+            Close(p_obj);
+            free(var_domain);
+            return VLC_ENOMEM;
+        }
         access->pf_read = FileRead;
         access->pf_seek = FileSeek;
         access->pf_control = FileControl;
@@ -775,7 +910,10 @@ Close(vlc_object_t *p_obj)
     struct access_sys *sys = access->p_sys;
 
     if (sys->smb2fh != NULL)
+    {
+        vlc_smb2_drain_reads(access, true);
         vlc_smb2_close_fh(access);
+    }
     else if (sys->smb2dir != NULL)
         smb2_closedir(sys->smb2, sys->smb2dir);
     else if (sys->share_enum != NULL)
@@ -42,6 +42,9 @@ typedef struct
     char       *psz_host;
     int         i_port;
     int         i_chunks; /* Number of chunks to allocate in the next read */
+    size_t      i_chunk_size;
+    int         i_poll_timeout;
+    bool        b_pending; /* The last read left messages in the library */
 } stream_sys_t;
 
 
@@ -213,6 +216,7 @@ static bool srt_schedule_reconnect(stream_t *p_stream)
      * the stream may have changed.
      */
     p_sys->i_chunks = SRT_MIN_CHUNKS_TRYREAD;
+    p_sys->b_pending = false;
 
 out:
     if (failed && p_sys->sock != SRT_INVALID_SOCK)
@@ -232,11 +236,28 @@ out:
     return !failed;
 }
 
+/* Drains the messages ready in the library, up to the size of the block */
+static bool srt_read_messages(stream_t *p_stream, block_t *pkt, size_t bufsize)
+{
+    stream_sys_t *p_sys = p_stream->p_sys;
+
+    pkt->i_buffer = 0;
+    while ( ( bufsize - pkt->i_buffer ) >= p_sys->i_chunk_size )
+    {
+        int stat = srt_recvmsg( p_sys->sock,
+            (char *)( pkt->p_buffer + pkt->i_buffer ),
+            bufsize - pkt->i_buffer );
+        if ( stat <= 0 )
+            return false;
+        pkt->i_buffer += (size_t)stat;
+    }
+    /* The block is full, some messages may be left */
+    return true;
+}
+
 static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
 {
     stream_sys_t *p_sys = p_stream->p_sys;
-    int i_chunk_size = var_InheritInteger( p_stream, SRT_PARAM_CHUNK_SIZE );
-    int i_poll_timeout = var_InheritInteger( p_stream, SRT_PARAM_POLL_TIMEOUT );
     /* SRT doesn't have a concept of EOF for live streams. */
     VLC_UNUSED(eof);
 
@@ -249,22 +270,29 @@ static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
     if ( p_sys->i_chunks == 0 )
         p_sys->i_chunks = SRT_MIN_CHUNKS_TRYREAD;
 
-    size_t i_chunk_size_actual = ( i_chunk_size > 0 )
-        ? i_chunk_size : SRT_DEFAULT_CHUNK_SIZE;
-    size_t bufsize = i_chunk_size_actual * p_sys->i_chunks;
+    size_t bufsize = p_sys->i_chunk_size * p_sys->i_chunks;
     block_t *pkt = block_Alloc( bufsize );
     if ( unlikely( pkt == NULL ) )
     {
         return NULL;
     }
 
+    /* The last read stopped on a full block: read the rest without
+     * waiting on the poll again */
+    if ( p_sys->b_pending )
+    {
+        p_sys->b_pending = srt_read_messages( p_stream, pkt, bufsize );
+        if ( pkt->i_buffer > 0 )
+            return pkt;
+    }
+
     vlc_interrupt_register( srt_wait_interrupted, p_stream);
 
     SRTSOCKET ready[1];
     int readycnt = 1;
     while ( srt_epoll_wait( p_sys->i_poll_id,
         ready, &readycnt, 0, 0,
-        i_poll_timeout, NULL, 0, NULL, 0 ) >= 0)
+        p_sys->i_poll_timeout, NULL, 0, NULL, 0 ) >= 0)
     {
         if ( readycnt < 0  || ready[0] != p_sys->sock )
         {
@@ -296,36 +324,18 @@ static block_t *BlockSRT(stream_t *p_stream, bool *restrict eof)
          * grow until it reads fast enough to keep the library empty after
          * each iteration.
          */
-        pkt->i_buffer = 0;
-        while ( ( bufsize - pkt->i_buffer ) >= i_chunk_size_actual )
-        {
-            int stat = srt_recvmsg( p_sys->sock,
-                (char *)( pkt->p_buffer + pkt->i_buffer ),
-                bufsize - pkt->i_buffer );
-            if ( stat <= 0 )
-            {
-                break;
-            }
-            pkt->i_buffer += (size_t)stat;
-        }
+        p_sys->b_pending = srt_read_messages( p_stream, pkt, bufsize );
 
-        msg_Dbg ( p_stream, "Read %zu bytes out of a max of %zu"
-            " (%d chunks of %zu bytes)", pkt->i_buffer,
-            p_sys->i_chunks * i_chunk_size_actual, p_sys->i_chunks,
-                 i_chunk_size_actual );
-
-
-        /* Gradually adjust number of chunks we read at a time
+        /* Quickly adjust the number of chunks we read at a time
         * up to a predefined maximum. The actual number we might
         * settle on depends on stream's bit rate.
         */
-        size_t rem = bufsize - pkt->i_buffer;
-        if ( rem < i_chunk_size_actual )
+        if ( p_sys->b_pending && p_sys->i_chunks < SRT_MAX_CHUNKS_TRYREAD )
         {
-            if ( p_sys->i_chunks < SRT_MAX_CHUNKS_TRYREAD )
-            {
-                p_sys->i_chunks++;
-            }
+            p_sys->i_chunks = __MIN( p_sys->i_chunks * 2,
+                                     SRT_MAX_CHUNKS_TRYREAD );
+            msg_Dbg( p_stream, "Reading up to %d chunks of %zu bytes",
+                     p_sys->i_chunks, p_sys->i_chunk_size );
         }
 
         goto out;
@@ -383,6 +393,13 @@ static int Open(vlc_object_t *p_this)
     p_sys->psz_host = vlc_obj_strdup( p_this, parsed_url.psz_host );
     p_sys->i_port = parsed_url.i_port;
 
+    /* The default chunk size holds 7 TS packets, as most senders do */
+    int i_chunk_size = var_InheritInteger( p_stream, SRT_PARAM_CHUNK_SIZE );
+    p_sys->i_chunk_size = ( i_chunk_size > 0 )
+        ? (size_t)i_chunk_size : SRT_DEFAULT_CHUNK_SIZE;
+    p_sys->i_poll_timeout = var_InheritInteger( p_stream,
+                                                SRT_PARAM_POLL_TIMEOUT );
+
     vlc_UrlClean( &parsed_url );
 
     p_sys->i_poll_id = srt_epoll_create();
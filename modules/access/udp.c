@@ -35,6 +35,8 @@
 # include "config.h"
 #endif
 
+#include <errno.h>
+
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_access.h>
@@ -47,6 +49,9 @@
 #ifdef HAVE_SYS_UIO_H
 # include <sys/uio.h>
 #endif
+#ifdef __linux__
+# include <netinet/udp.h>
+#endif
 
 /* Buffer can be max theoretical datagram content minus anticipated MTU.
  * IPv6 headers are larger than IPv4, ignore IPv6 jumbograms.
@@ -59,6 +64,14 @@ typedef struct {
 
     size_t length;
     char *offset;
+#ifdef HAVE_RECVMMSG
+    /* Ring of datagrams received by a single recvmmsg() call */
+    unsigned batch;
+    unsigned head;
+    unsigned count;
+    struct mmsghdr *msgs;
+    char *ring;
+#endif
     char buf[MRU];
 } access_sys_t;
 
@@ -83,6 +96,75 @@ static int Control(stream_t *access, int query, va_list args)
     return VLC_SUCCESS;
 }
 
+static int Wait(stream_t *access)
+{
+    access_sys_t *sys = access->p_sys;
+    struct pollfd ufd[1];
+
+    ufd[0].fd = sys->fd;
+    ufd[0].events = POLLIN;
+
+    switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
+        case 0:
+            msg_Err(access, "receive time-out");
+            return 0;
+        case -1:
+            return -1;
+    }
+    return 1;
+}
+
+#ifdef HAVE_RECVMMSG
+static ssize_t ReadBatch(stream_t *access, void *buf, size_t len)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (sys->count == 0) {
+        int val = Wait(access);
+        if (val <= 0)
+            return val;
+
+        val = recvmmsg(sys->fd, sys->msgs, sys->batch, MSG_DONTWAIT, NULL);
+        if (val <= 0) {
+            if (val < 0 && errno == ENOSYS) {
+                msg_Dbg(access, "batched receive not supported");
+                sys->batch = 0;
+            }
+            return -1;
+        }
+
+        sys->head = 0;
+        sys->count = val;
+    }
+
+    /* Serve as many pending datagrams as fit, keep the remainder of the
+     * first one that does not fit for the next call. */
+    char *p = buf;
+
+    while (sys->count > 0 && len > 0) {
+        const char *data = sys->ring + (size_t)sys->head * MRU;
+        size_t size = sys->msgs[sys->head].msg_len;
+
+        sys->head++;
+        sys->count--;
+
+        if (size > len) {
+            memcpy(p, data, len);
+            sys->offset = (char *)data + len;
+            sys->length = size - len;
+            p += len;
+            break;
+        }
+
+        memcpy(p, data, size);
+        p += size;
+        len -= size;
+    }
+
+    return p - (char *)buf;
+}
+#endif
+
 static ssize_t Read(stream_t *access, void *buf, size_t len)
 {
     access_sys_t *sys = access->p_sys;
@@ -97,18 +179,14 @@ static ssize_t Read(stream_t *access, void *buf, size_t len)
         return len;
     }
 
-    struct pollfd ufd[1];
-
-    ufd[0].fd = sys->fd;
-    ufd[0].events = POLLIN;
+#ifdef HAVE_RECVMMSG
+    if (sys->batch > 1)
+        return ReadBatch(access, buf, len);
+#endif
 
-    switch (vlc_poll_i11e(ufd, 1, sys->timeout)) {
-        case 0:
-            msg_Err(access, "receive time-out");
-            return 0;
-        case -1:
-            return -1;
-    }
+    int ready = Wait(access);
+    if (ready <= 0)
+        return ready;
 
     struct iovec iov[] = {
         { .iov_base = buf,      .iov_len = len, },
@@ -217,6 +295,40 @@ static int Open( vlc_object_t *p_this )
     if( sys->timeout > 0)
         sys->timeout *= 1000;
 
+#ifdef UDP_GRO
+    /* Coalesced datagrams are plain concatenations of the segments, which is
+     * exactly what this byte stream access returns: no splitting needed. */
+    if( var_InheritBool( p_access, "udp-gro" )
+     && setsockopt( sys->fd, SOL_UDP, UDP_GRO, &(int){ 1 }, sizeof (int) ) )
+        msg_Warn( p_access, "cannot enable receive offload: %s",
+                  vlc_strerror_c(errno) );
+#endif
+
+#ifdef HAVE_RECVMMSG
+    sys->batch = var_InheritInteger( p_access, "udp-batch" );
+    sys->head = sys->count = 0;
+    if( sys->batch > 1 )
+    {
+        sys->msgs = vlc_obj_calloc( p_this, sys->batch, sizeof( *sys->msgs ) );
+        struct iovec *iov = vlc_obj_calloc( p_this, sys->batch, sizeof( *iov ) );
+        sys->ring = vlc_obj_malloc( p_this, (size_t)sys->batch * MRU );
+
+        if( unlikely(sys->msgs == NULL || iov == NULL || sys->ring == NULL) )
+        {
+            net_Close( sys->fd );
+            return VLC_ENOMEM;
+        }
+
+        for( unsigned i = 0; i < sys->batch; i++ )
+        {
+            iov[i].iov_base = sys->ring + (size_t)i * MRU;
+            iov[i].iov_len = MRU;
+            sys->msgs[i].msg_hdr.msg_iov = &iov[i];
+            sys->msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+#endif
+
     return VLC_SUCCESS;
 }
 
@@ -232,6 +344,12 @@ static void Close( vlc_object_t *p_this )
 }
 
 #define TIMEOUT_TEXT N_("UDP Source timeout (sec)")
+#define BATCH_TEXT N_("Receive batch size")
+#define BATCH_LONGTEXT N_("Maximum number of datagrams received per " \
+    "system call, where supported. Set to 1 to disable batching.")
+#define GRO_TEXT N_("Receive offload")
+#define GRO_LONGTEXT N_("Let the kernel coalesce consecutive datagrams " \
+    "from the same flow before they are read (Linux only).")
 
 vlc_module_begin()
     set_shortname(N_("UDP"))
@@ -242,6 +360,9 @@ vlc_module_begin()
     add_obsolete_integer("server-port") /* since 2.0.0 */
     add_obsolete_integer("udp-buffer") /* since 3.0.0 */
     add_integer("udp-timeout", -1, TIMEOUT_TEXT, NULL, true)
+    add_integer_with_range("udp-batch", 16, 1, 1024, BATCH_TEXT,
+                           BATCH_LONGTEXT, true)
+    add_bool("udp-gro", false, GRO_TEXT, GRO_LONGTEXT, true)
 
     set_capability("access", 0)
     add_shortcut("udp", "udpstream", "udp4", "udp6")
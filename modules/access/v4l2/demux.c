@@ -47,7 +47,7 @@ typedef struct
     int fd;
     vlc_thread_t thread;
 
-    struct buffer_t *bufv;
+    vlc_v4l2_pool_t *pool;
     union
     {
         uint32_t bufc;
@@ -99,7 +99,8 @@ int DemuxOpen( vlc_object_t *obj )
 
     if (InitVideo (demux, fd, caps))
     {
-        v4l2_close (fd);
+        if (sys->fd != -1)
+            v4l2_close (fd);
         goto error;
     }
 
@@ -562,16 +563,17 @@ static int InitVideo (demux_t *demux, int fd, uint32_t caps)
             const long pagemask = sysconf (_SC_PAGE_SIZE) - 1;
 
             sys->blocksize = (fmt.fmt.pix.sizeimage + pagemask) & ~pagemask;
-            sys->bufv = NULL;
+            sys->pool = NULL;
             entry = UserPtrThread;
             msg_Dbg (demux, "streaming with %"PRIu32"-bytes user buffers",
                      sys->blocksize);
         }
         else /* fall back to memory map */
         {
-            sys->bufc = 4;
-            sys->bufv = StartMmap (VLC_OBJECT(demux), fd, &sys->bufc);
-            if (sys->bufv == NULL)
+            /* Frames are sent in the buffers, leave some for the driver */
+            sys->bufc = 6;
+            sys->pool = StartMmapPool (VLC_OBJECT(demux), fd, &sys->bufc);
+            if (sys->pool == NULL)
                 return -1;
             entry = MmapThread;
             msg_Dbg (demux, "streaming with %"PRIu32" memory-mapped buffers",
@@ -581,7 +583,7 @@ static int InitVideo (demux_t *demux, int fd, uint32_t caps)
     else if (caps & V4L2_CAP_READWRITE)
     {
         sys->blocksize = fmt.fmt.pix.sizeimage;
-        sys->bufv = NULL;
+        sys->pool = NULL;
         entry = ReadThread;
         msg_Dbg (demux, "reading %"PRIu32" bytes at a time", sys->blocksize);
     }
@@ -607,8 +609,11 @@ static int InitVideo (demux_t *demux, int fd, uint32_t caps)
         if (sys->vbi != NULL)
             CloseVBI (sys->vbi);
 #endif
-        if (sys->bufv != NULL)
-            StopMmap (sys->fd, sys->bufv, sys->bufc);
+        if (sys->pool != NULL)
+        {
+            StopMmapPool (sys->pool);
+            sys->fd = -1; /* closed with the pool */
+        }
         return -1;
     }
     return 0;
@@ -621,10 +626,11 @@ void DemuxClose( vlc_object_t *obj )
 
     vlc_cancel (sys->thread);
     vlc_join (sys->thread, NULL);
-    if (sys->bufv != NULL)
-        StopMmap (sys->fd, sys->bufv, sys->bufc);
     ControlsDeinit(vlc_object_parent(obj), sys->controls);
-    v4l2_close (sys->fd);
+    if (sys->pool != NULL)
+        StopMmapPool (sys->pool); /* closes the device */
+    else
+        v4l2_close (sys->fd);
 
 #ifdef ZVBI_COMPILED
     if (sys->vbi != NULL)
@@ -754,7 +760,7 @@ static void *MmapThread (void *data)
         if( ufd[0].revents )
         {
             int canc = vlc_savecancel ();
-            block_t *block = GrabVideo (VLC_OBJECT(demux), fd, sys->bufv);
+            block_t *block = GrabVideoPool (VLC_OBJECT(demux), sys->pool);
             if (block != NULL)
             {
                 block->i_flags |= sys->block_flags;
@@ -30,6 +30,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <stdatomic.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 
@@ -734,3 +735,182 @@ void StopMmap (int fd, struct buffer_t *bufv, uint32_t bufc)
         v4l2_munmap (bufv[i].start, bufv[i].length);
     free (bufv);
 }
+
+/**
+ * Memory-mapped buffers shared with the blocks they are sent in.
+ *
+ * Frames are sent without copying, in blocks that queue their buffer back
+ * to the driver when released. The mappings and the device are released
+ * with the last block.
+ */
+struct vlc_v4l2_pool
+{
+    atomic_uint refs;
+    vlc_mutex_t lock;
+    int fd;
+    bool streaming;
+    uint32_t queued; /**< Buffers owned by the driver */
+    uint32_t bufc;
+    struct buffer_t bufv[];
+};
+
+struct vlc_v4l2_block
+{
+    block_t self;
+    vlc_v4l2_pool_t *pool;
+    uint32_t index;
+};
+
+/* Frames are copied rather than held, if fewer buffers would be left to the
+ * driver, so that capture goes on while the pipeline is late. */
+#define POOL_MIN_QUEUED 2
+
+static void PoolRelease (vlc_v4l2_pool_t *pool)
+{
+    if (atomic_fetch_sub_explicit (&pool->refs, 1, memory_order_acq_rel) != 1)
+        return;
+
+    for (uint32_t i = 0; i < pool->bufc; i++)
+        v4l2_munmap (pool->bufv[i].start, pool->bufv[i].length);
+    v4l2_close (pool->fd);
+    free (pool);
+}
+
+static void PoolQueue (vlc_v4l2_pool_t *pool, uint32_t index)
+{
+    struct v4l2_buffer buf = {
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .memory = V4L2_MEMORY_MMAP,
+        .index = index,
+    };
+
+    vlc_mutex_lock (&pool->lock);
+    if (pool->streaming && v4l2_ioctl (pool->fd, VIDIOC_QBUF, &buf) == 0)
+        pool->queued++;
+    vlc_mutex_unlock (&pool->lock);
+}
+
+static void PoolBlockRelease (block_t *block)
+{
+    struct vlc_v4l2_block *vb = container_of (block, struct vlc_v4l2_block,
+                                              self);
+    vlc_v4l2_pool_t *pool = vb->pool;
+
+    PoolQueue (pool, vb->index);
+    free (vb);
+    PoolRelease (pool);
+}
+
+static const struct vlc_block_callbacks PoolBlockCallbacks = {
+    PoolBlockRelease,
+};
+
+/**
+ * Allocates memory-mapped buffers, queues them and start streaming, like
+ * StartMmap(). The device is closed by StopMmapPool().
+ * @param n requested buffers count [IN], allocated buffers count [OUT]
+ */
+vlc_v4l2_pool_t *StartMmapPool (vlc_object_t *obj, int fd,
+                                uint32_t *restrict n)
+{
+    struct buffer_t *bufv = StartMmap (obj, fd, n);
+    if (bufv == NULL)
+        return NULL;
+
+    vlc_v4l2_pool_t *pool = malloc (sizeof (*pool) + *n * sizeof (*bufv));
+    if (unlikely(pool == NULL))
+    {
+        StopMmap (fd, bufv, *n);
+        return NULL;
+    }
+
+    atomic_init (&pool->refs, 1);
+    vlc_mutex_init (&pool->lock);
+    pool->fd = fd;
+    pool->streaming = true;
+    pool->queued = *n;
+    pool->bufc = *n;
+    memcpy (pool->bufv, bufv, *n * sizeof (*bufv));
+    free (bufv);
+    return pool;
+}
+
+/**
+ * Stops streaming. Buffers still held by blocks are not queued anymore, and
+ * the device is closed once they are all released.
+ */
+void StopMmapPool (vlc_v4l2_pool_t *pool)
+{
+    enum v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+
+    vlc_mutex_lock (&pool->lock);
+    pool->streaming = false;
+    /* STREAMOFF implicitly dequeues all buffers */
+    v4l2_ioctl (pool->fd, VIDIOC_STREAMOFF, &type);
+    vlc_mutex_unlock (&pool->lock);
+    PoolRelease (pool);
+}
+
+/**
+ * Grabs a video frame, without copying it unless the pipeline already holds
+ * too many buffers.
+ */
+block_t *GrabVideoPool (vlc_object_t *demux, vlc_v4l2_pool_t *pool)
+{
+    struct v4l2_buffer buf = {
+        .type = V4L2_BUF_TYPE_VIDEO_CAPTURE,
+        .memory = V4L2_MEMORY_MMAP,
+    };
+
+    /* Wait for next frame */
+    if (v4l2_ioctl (pool->fd, VIDIOC_DQBUF, &buf) < 0)
+    {
+        switch (errno)
+        {
+            case EAGAIN:
+                return NULL;
+            case EIO:
+                /* Could ignore EIO, see spec. */
+                /* fall through */
+            default:
+                msg_Err (demux, "dequeue error: %s", vlc_strerror_c(errno));
+                return NULL;
+        }
+    }
+
+    vlc_mutex_lock (&pool->lock);
+    bool copy = --pool->queued < POOL_MIN_QUEUED;
+    vlc_mutex_unlock (&pool->lock);
+
+    const struct buffer_t *restrict bufp = &pool->bufv[buf.index];
+    block_t *block;
+
+    if (!copy)
+    {
+        struct vlc_v4l2_block *vb = malloc (sizeof (*vb));
+        if (likely(vb != NULL))
+        {
+            vb->pool = pool;
+            vb->index = buf.index;
+            atomic_fetch_add_explicit (&pool->refs, 1, memory_order_relaxed);
+
+            block = block_Init (&vb->self, &PoolBlockCallbacks, bufp->start,
+                                bufp->length);
+            block->i_buffer = buf.bytesused;
+            block->i_pts = block->i_dts = GetBufferPTS (&buf);
+            return block;
+        }
+    }
+
+    /* Copy frame */
+    block = block_Alloc (buf.bytesused);
+    if (likely(block != NULL))
+    {
+        block->i_pts = block->i_dts = GetBufferPTS (&buf);
+        memcpy (block->p_buffer, bufp->start, buf.bytesused);
+    }
+
+    /* Unlock */
+    PoolQueue (pool, buf.index);
+    return block;
+}
@@ -35,6 +35,10 @@
 #include <errno.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <limits.h>
+#ifdef HAVE_SYS_UIO_H
+# include <sys/uio.h>
+#endif
 #ifdef __OS2__
 #   include <io.h>      /* setmode() */
 #endif
@@ -54,6 +58,11 @@
 #ifndef _POSIX_REALTIME_SIGNALS
 # define _POSIX_REALTIME_SIGNALS (-1)
 #endif
+#if defined(IOV_MAX) && (IOV_MAX < 64)
+# define FILE_IOV_MAX IOV_MAX
+#else
+# define FILE_IOV_MAX 64
+#endif
 
 #define SOUT_CFG_PREFIX "sout-file-"
 
@@ -71,6 +80,47 @@ static ssize_t Read( sout_access_out_t *p_access, block_t *p_buffer )
     return val;
 }
 
+/*****************************************************************************
+ * ChainIovec: maps the leading non-empty blocks of a chain to an I/O vector
+ *****************************************************************************/
+static int ChainIovec( const block_t *p_buffer, struct iovec *iov )
+{
+    int i_count = 0;
+
+    for( ; p_buffer != NULL && i_count < FILE_IOV_MAX; p_buffer = p_buffer->p_next )
+    {
+        if( p_buffer->i_buffer == 0 )
+            continue;
+        iov[i_count].iov_base = p_buffer->p_buffer;
+        iov[i_count].iov_len = p_buffer->i_buffer;
+        i_count++;
+    }
+    return i_count;
+}
+
+/*****************************************************************************
+ * ChainConsume: releases written blocks, trims the partially written one
+ *****************************************************************************/
+static block_t *ChainConsume( block_t *p_buffer, size_t i_written )
+{
+    while( p_buffer != NULL && i_written >= p_buffer->i_buffer )
+    {
+        block_t *p_next = p_buffer->p_next;
+        i_written -= p_buffer->i_buffer;
+        block_Release( p_buffer );
+        p_buffer = p_next;
+    }
+
+    if( p_buffer != NULL )
+    {
+        p_buffer->p_buffer += i_written;
+        p_buffer->i_buffer -= i_written;
+    }
+    else
+        assert( i_written == 0 );
+    return p_buffer;
+}
+
 /*****************************************************************************
  * Write: standard write on a file descriptor.
  *****************************************************************************/
@@ -81,7 +131,15 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 
     while( p_buffer )
     {
-        ssize_t val = write(fd, p_buffer->p_buffer, p_buffer->i_buffer);
+        struct iovec iov[FILE_IOV_MAX];
+        int i_count = ChainIovec( p_buffer, iov );
+        if( i_count == 0 )
+        {
+            block_ChainRelease( p_buffer );
+            break;
+        }
+
+        ssize_t val = vlc_writev(fd, iov, i_count);
         if (val <= 0)
         {
             if (errno == EINTR)
@@ -91,17 +149,7 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
             return -1;
         }
 
-        if ((size_t)val >= p_buffer->i_buffer)
-        {
-            block_t *p_next = p_buffer->p_next;
-            block_Release (p_buffer);
-            p_buffer = p_next;
-        }
-        else
-        {
-            p_buffer->p_buffer += val;
-            p_buffer->i_buffer -= val;
-        }
+        p_buffer = ChainConsume( p_buffer, val );
         i_write += val;
     }
     return i_write;
@@ -114,16 +162,15 @@ static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
 
     while (block != NULL)
     {
-        if (block->i_buffer == 0)
+        struct iovec iov[FILE_IOV_MAX];
+        int count = ChainIovec(block, iov);
+        if (count == 0)
         {
-            block_t *next = block->p_next;
-            block_Release(block);
-            block = next;
-            continue;
+            block_ChainRelease(block);
+            break;
         }
 
-        /* TODO: vectorized I/O with writev() */
-        ssize_t val = vlc_write(fd, block->p_buffer, block->i_buffer);
+        ssize_t val = vlc_writev(fd, iov, count);
         if (val < 0)
         {
             if (errno == EINTR)
@@ -136,10 +183,7 @@ static ssize_t WritePipe(sout_access_out_t *access, block_t *block)
         }
 
         total += val;
-
-        assert((size_t)val <= block->i_buffer);
-        block->p_buffer += val;
-        block->i_buffer -= val;
+        block = ChainConsume(block, val);
     }
 
     return total;
@@ -153,16 +197,18 @@ static ssize_t Send(sout_access_out_t *access, block_t *block)
 
     while (block != NULL)
     {
-        if (block->i_buffer == 0)
+        struct iovec iov[FILE_IOV_MAX];
+        struct msghdr msg = {
+            .msg_iov = iov,
+            .msg_iovlen = ChainIovec(block, iov),
+        };
+        if (msg.msg_iovlen == 0)
         {
-            block_t *next = block->p_next;
-            block_Release(block);
-            block = next;
-            continue;
+            block_ChainRelease(block);
+            break;
         }
 
-        /* TODO: vectorized I/O with sendmsg() */
-        ssize_t val = vlc_send(fd, block->p_buffer, block->i_buffer, 0);
+        ssize_t val = vlc_sendmsg(fd, &msg, 0);
         if (val <= 0)
         {   /* FIXME: errno is meaningless if val is zero */
             if (errno == EINTR)
@@ -173,10 +219,7 @@ static ssize_t Send(sout_access_out_t *access, block_t *block)
         }
 
         total += val;
-
-        assert((size_t)val <= block->i_buffer);
-        block->p_buffer += val;
-        block->i_buffer -= val;
+        block = ChainConsume(block, val);
     }
     return total;
 }
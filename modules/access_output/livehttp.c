@@ -43,6 +43,7 @@
 #include <vlc_fs.h>
 #include <vlc_strings.h>
 #include <vlc_charset.h>
+#include <vlc_queue.h>
 
 #include <gcrypt.h>
 #include <vlc_gcrypt.h>
@@ -173,6 +174,14 @@ typedef struct output_segment
     uint8_t aes_ivs[16];
 } output_segment_t;
 
+/* A complete segment, waiting for the writer thread */
+typedef struct segment_job
+{
+    struct segment_job *next;
+    block_t *blocks;
+    bool b_isend;
+} segment_job_t;
+
 typedef struct
 {
     char *psz_cursegPath;
@@ -187,6 +196,13 @@ typedef struct
     block_t **full_segments_end;
     block_t *ongoing_segment;
     block_t **ongoing_segment_end;
+    vlc_tick_t full_segments_length;
+    vlc_tick_t ongoing_segment_length;
+    /* The segments are encrypted and written by a separate thread, not to
+     * block the stream output on the disk */
+    vlc_thread_t thread;
+    vlc_queue_t queue;
+    bool b_dead;
     int i_handle;
     unsigned i_numsegs;
     unsigned i_initial_segment;
@@ -206,8 +222,10 @@ typedef struct
 
 static int LoadCryptFile( sout_access_out_t *p_access);
 static int CryptSetup( sout_access_out_t *p_access, char *keyfile );
-static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer );
-static ssize_t writeSegment( sout_access_out_t *p_access );
+static ssize_t CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer );
+static ssize_t QueueSegment( sout_access_out_t *p_access, bool b_isend );
+static ssize_t writeSegment( sout_access_out_t *p_access, block_t *output );
+static void *SegmentThread( void * );
 static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t *p_sys );
 /*****************************************************************************
  * Open: open the file
@@ -238,6 +256,8 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->ongoing_segment = NULL;
     p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
+    p_sys->full_segments_length = 0;
+    p_sys->ongoing_segment_length = 0;
 
     p_sys->i_numsegs = var_GetInteger( p_access, SOUT_CFG_PREFIX "numsegs" );
     p_sys->i_initial_segment = var_GetInteger( p_access, SOUT_CFG_PREFIX "initial-segment-number" );
@@ -296,6 +316,22 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_segment = p_sys->i_initial_segment-1;
     p_sys->psz_cursegPath = NULL;
 
+    vlc_queue_Init( &p_sys->queue, offsetof( segment_job_t, next ) );
+    p_sys->b_dead = false;
+    if( vlc_clone( &p_sys->thread, SegmentThread, p_access,
+                   VLC_THREAD_PRIORITY_LOW ) )
+    {
+        if( p_sys->key_uri )
+        {
+            gcry_cipher_close( p_sys->aes_ctx );
+            free( p_sys->key_uri );
+        }
+        free( p_sys->psz_indexUrl );
+        free( p_sys->psz_indexPath );
+        free( p_sys );
+        return VLC_ENOMEM;
+    }
+
     p_access->pf_write = Write;
     p_access->pf_control = Control;
 
@@ -766,6 +802,9 @@ static void Close( vlc_object_t * p_this )
     p_sys->full_segments = NULL;
     p_sys->full_segments_end = &p_sys->full_segments;
 
+    p_sys->full_segments_length = 0;
+    p_sys->ongoing_segment_length = 0;
+
     while( output_block )
     {
         block_t *p_next = output_block->p_next;
@@ -781,17 +820,11 @@ static void Close( vlc_object_t * p_this )
         p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
     }
 
-    ssize_t writevalue = writeSegment( p_access );
-    msg_Dbg( p_access, "Writing.. %zd", writevalue );
-    if( unlikely( writevalue < 0 ) )
-    {
-        if( p_sys->full_segments )
-            block_ChainRelease( p_sys->full_segments );
-        if( p_sys->ongoing_segment )
-            block_ChainRelease( p_sys->ongoing_segment );
-    }
+    QueueSegment( p_access, true );
 
-    closeCurrentSegment( p_access, p_sys, true );
+    /* Wait for the pending segments to be written */
+    vlc_queue_Kill( &p_sys->queue, &p_sys->b_dead );
+    vlc_join( p_sys->thread, NULL );
 
     if( p_sys->key_uri )
     {
@@ -898,48 +931,79 @@ static ssize_t openNextFile( sout_access_out_t *p_access, sout_access_out_sys_t
     return fd;
 }
 /*****************************************************************************
- * CheckSegmentChange: Check if segment needs to be closed and new opened
+ * SegmentThread: encrypt and write the complete segments
  *****************************************************************************/
-static int CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
+static void *SegmentThread( void *data )
 {
+    sout_access_out_t *p_access = data;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
-    ssize_t writevalue = 0;
-
-    vlc_tick_t current_length = 0;
-    vlc_tick_t ongoing_length = 0;
+    segment_job_t *job;
 
-    block_ChainProperties( p_sys->full_segments, NULL, NULL, &current_length );
-    block_ChainProperties( p_sys->ongoing_segment, NULL, NULL, &ongoing_length );
-
-    if( p_sys->i_handle > 0 &&
-       (( p_buffer->i_length + current_length + ongoing_length ) >= p_sys->segment_max_length ) )
+    while( ( job = vlc_queue_DequeueKillable( &p_sys->queue,
+                                              &p_sys->b_dead ) ) != NULL )
     {
-        writevalue = writeSegment( p_access );
-        if( unlikely( writevalue < 0 ) )
+        if( openNextFile( p_access, p_sys ) < 0 )
+            block_ChainRelease( job->blocks );
+        else
         {
-            block_ChainRelease ( p_buffer );
-            return -1;
+            ssize_t writevalue = writeSegment( p_access, job->blocks );
+            msg_Dbg( p_access, "Writing.. %zd", writevalue );
+            closeCurrentSegment( p_access, p_sys, job->b_isend );
         }
-        closeCurrentSegment( p_access, p_sys, false );
-        return writevalue;
+        free( job );
     }
+    return NULL;
+}
+
+/*****************************************************************************
+ * QueueSegment: hand the full segments over to the writer thread
+ *****************************************************************************/
+static ssize_t QueueSegment( sout_access_out_t *p_access, bool b_isend )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    block_t *output = p_sys->full_segments;
+    size_t i_size;
 
-    if ( unlikely( p_sys->i_handle < 0 ) )
+    if( output == NULL )
+        return 0;
+
+    p_sys->full_segments = NULL;
+    p_sys->full_segments_end = &p_sys->full_segments;
+    p_sys->full_segments_length = 0;
+
+    segment_job_t *job = malloc( sizeof( *job ) );
+    if( unlikely( job == NULL ) )
     {
-        if ( openNextFile( p_access, p_sys ) < 0 )
-           return -1;
+        block_ChainRelease( output );
+        return -1;
     }
-    return writevalue;
+
+    block_ChainProperties( output, NULL, &i_size, NULL );
+    job->blocks = output;
+    job->b_isend = b_isend;
+    vlc_queue_Enqueue( &p_sys->queue, job );
+    return i_size;
 }
 
-static ssize_t writeSegment( sout_access_out_t *p_access )
+/*****************************************************************************
+ * CheckSegmentChange: Check if segment needs to be closed and new opened
+ *****************************************************************************/
+static ssize_t CheckSegmentChange( sout_access_out_t *p_access, block_t *p_buffer )
 {
     sout_access_out_sys_t *p_sys = p_access->p_sys;
-    msg_Dbg( p_access, "Writing all full segments" );
 
-    block_t *output = p_sys->full_segments;
-    p_sys->full_segments = NULL;
-    p_sys->full_segments_end = &p_sys->full_segments;
+    if( p_sys->full_segments != NULL &&
+       (( p_buffer->i_length + p_sys->full_segments_length
+          + p_sys->ongoing_segment_length ) >= p_sys->segment_max_length ) )
+        return QueueSegment( p_access, false );
+
+    return 0;
+}
+
+static ssize_t writeSegment( sout_access_out_t *p_access, block_t *output )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    msg_Dbg( p_access, "Writing all full segments" );
 
     vlc_tick_t current_length = 0;
     block_ChainProperties( output, NULL, NULL, &current_length );
@@ -974,6 +1038,7 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
             if( err )
             {
                 msg_Err( p_access, "Encryption failure: %s ", gpg_strerror(err) );
+                block_ChainRelease( output );
                 return -1;
             }
             crypted=true;
@@ -985,6 +1050,7 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
         {
            if ( errno == EINTR )
               continue;
+           block_ChainRelease( output );
            return -1;
         }
 
@@ -1007,7 +1073,7 @@ static ssize_t writeSegment( sout_access_out_t *p_access )
 }
 
 /*****************************************************************************
- * Write: standard write on a file descriptor.
+ * Write: gather the blocks into segments.
  *****************************************************************************/
 static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
 {
@@ -1024,6 +1090,8 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
             block_ChainLastAppend( &p_sys->full_segments_end, p_sys->ongoing_segment );
             p_sys->ongoing_segment = NULL;
             p_sys->ongoing_segment_end = &p_sys->ongoing_segment;
+            p_sys->full_segments_length += p_sys->ongoing_segment_length;
+            p_sys->ongoing_segment_length = 0;
             p_sys->b_segment_has_data = true;
         }
 
@@ -1031,12 +1099,14 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
         if( ret < 0 )
         {
             msg_Err( p_access, "Error in write loop");
+            block_ChainRelease( p_buffer );
             return ret;
         }
         i_write += ret;
 
         block_t *p_temp = p_buffer->p_next;
         p_buffer->p_next = NULL;
+        p_sys->ongoing_segment_length += p_buffer->i_length;
         block_ChainLastAppend( &p_sys->ongoing_segment_end, p_buffer );
         p_buffer = p_temp;
     }
@@ -36,7 +36,6 @@
 #include <assert.h>
 #include <errno.h>
 
-#include <vlc_queue.h>
 #include <vlc_sout.h>
 #include <vlc_block.h>
 
@@ -46,11 +45,38 @@
 #elif defined (HAVE_SYS_SOCKET_H)
 #   include <sys/socket.h>
 #endif
+#ifdef __linux__
+#   include <netinet/udp.h>
+#   include <linux/net_tstamp.h>
+#endif
+#include <time.h>
 
 #include <vlc_network.h>
+#include <vlc_list.h>
 
 #define MAX_EMPTY_BLOCKS 200
 
+/* Packets in flight between Write() and the sending thread */
+#define UDP_QUEUE_SIZE 32768
+
+#ifdef UDP_SEGMENT
+/* Kernel limits for one generic segmentation offload super-buffer */
+# define GSO_MAX_SEGMENTS 64
+# define GSO_MAX_SIZE     65507
+#endif
+
+#ifdef HAVE_SENDMMSG
+/* Shared scheduler timer wheel resolution and span (about 2 seconds) */
+# define SCHED_TICK        VLC_TICK_FROM_MS(1)
+# define SCHED_WHEEL_SLOTS 2048
+/* Packets sent by one sendmmsg() call */
+# define SCHED_BATCH_SIZE  64
+# ifdef SO_TXTIME
+/* Packets are given to the kernel that long before their transmit time */
+#  define TXTIME_AHEAD     VLC_TICK_FROM_MS(4)
+# endif
+#endif
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -71,6 +97,25 @@ static void Close( vlc_object_t * );
                           "helps reducing the scheduling load on " \
                           "heavily-loaded systems." )
 
+#define GSO_TEXT N_("Segmentation offload")
+#define GSO_LONGTEXT N_("Coalesce packets sent within a group into a " \
+                        "single system call and let the kernel or the " \
+                        "network interface split them (Linux only).")
+
+#define SHARED_TEXT N_("Shared sending thread")
+#define SHARED_LONGTEXT N_("Send the packets of all the UDP outputs " \
+                           "using this option from a single thread, in " \
+                           "batches of due packets. This reduces the " \
+                           "wake-ups and system calls with many outputs " \
+                           "(Linux only).")
+
+#define TXTIME_TEXT N_("Transmit time")
+#define TXTIME_LONGTEXT N_("With the shared sending thread, give the " \
+                           "packets to the kernel a few milliseconds in " \
+                           "advance together with their transmit time, " \
+                           "for the ETF queuing discipline or the network " \
+                           "interface to pace them (Linux only).")
+
 vlc_module_begin ()
     set_description( N_("UDP stream output") )
     set_shortname( "UDP" )
@@ -79,6 +124,11 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "caching", DEFAULT_PTS_DELAY / 1000, CACHING_TEXT, CACHING_LONGTEXT, true )
     add_integer( SOUT_CFG_PREFIX "group", 1, GROUP_TEXT, GROUP_LONGTEXT,
                                  true )
+    add_bool( SOUT_CFG_PREFIX "gso", false, GSO_TEXT, GSO_LONGTEXT, true )
+    add_bool( SOUT_CFG_PREFIX "shared", false, SHARED_TEXT, SHARED_LONGTEXT,
+              true )
+    add_bool( SOUT_CFG_PREFIX "txtime", false, TXTIME_TEXT, TXTIME_LONGTEXT,
+              true )
 
     set_capability( "sout access", 0 )
     add_shortcut( "udp" )
@@ -92,6 +142,9 @@ vlc_module_end ()
 static const char *const ppsz_sout_options[] = {
     "caching",
     "group",
+    "gso",
+    "shared",
+    "txtime",
     NULL
 };
 
@@ -108,20 +161,360 @@ static int Control( sout_access_out_t *, int, va_list );
 
 static void* ThreadWrite( void * );
 
+#ifdef HAVE_SENDMMSG
+/* Output served by the shared scheduler */
+typedef struct
+{
+    sout_access_out_t *p_access;
+    struct vlc_list    node; /* wheel slot of the first packet, or idle */
+    block_t           *p_pending; /* first packet, out of the queue */
+    vlc_tick_t         i_ahead;
+    vlc_tick_t         i_date_last;
+    unsigned           i_dropped;
+    bool               b_closing;
+    bool               b_done;
+
+    /* Sending time jitter, against the due time */
+    uint64_t           i_sent;
+    vlc_tick_t         i_jitter_sum;
+    vlc_tick_t         i_jitter_max;
+} sched_output_t;
+#endif
+
 typedef struct
 {
     vlc_tick_t    i_caching;
     int           i_handle;
     bool          b_mtu_warning;
-    bool          dead;
+    bool          b_gso;
     size_t        i_mtu;
 
-    vlc_queue_t   queue;
+    block_spsc_t *queue;
     block_t      *p_buffer;
 
     vlc_thread_t  thread;
+#ifdef HAVE_SENDMMSG
+    bool           b_shared;
+    sched_output_t out;
+#endif
 } sout_access_out_sys_t;
 
+#ifdef HAVE_SENDMMSG
+/*****************************************************************************
+ * Shared scheduler: a single thread sends the packets of all the outputs.
+ *
+ * Each output sits in the timer wheel slot of its first packet due time.
+ * Every tick, the outputs of the elapsed slots send all their due packets
+ * with one sendmmsg() call each, then move to the slot of their next
+ * packet. Outputs without queued packets are polled every tick.
+ *****************************************************************************/
+typedef struct
+{
+    vlc_thread_t    thread;
+    vlc_cond_t      wait; /* outputs done */
+    unsigned        i_refs;
+    bool            b_exit;
+
+    uint64_t        i_tick; /* next tick to run */
+    struct vlc_list idle;
+    struct vlc_list wheel[SCHED_WHEEL_SLOTS];
+} sched_t;
+
+static vlc_mutex_t sched_lock = VLC_STATIC_MUTEX;
+static sched_t *sched = NULL;
+
+static vlc_tick_t SchedDate( const sched_output_t *out, const block_t *p_pk )
+{
+    const sout_access_out_sys_t *p_sys = out->p_access->p_sys;
+    return p_pk->i_dts + p_sys->i_caching - out->i_ahead;
+}
+
+/* Puts the output in the slot of its first packet, not before i_min */
+static void SchedQueue( sched_t *s, sched_output_t *out, uint64_t i_min )
+{
+    vlc_tick_t i_date = SchedDate( out, out->p_pending );
+    uint64_t i_tick = i_date > 0 ? i_date / SCHED_TICK : 0;
+
+    if( i_tick < i_min )
+        i_tick = i_min;
+    /* Outputs further than the wheel span wait in the last slot */
+    if( i_tick >= s->i_tick + SCHED_WHEEL_SLOTS )
+        i_tick = s->i_tick + SCHED_WHEEL_SLOTS - 1;
+    vlc_list_append( &out->node, &s->wheel[i_tick % SCHED_WHEEL_SLOTS] );
+}
+
+static void SchedFlush( sout_access_out_t *p_access, struct mmsghdr *msgs,
+                        block_t **pp_blocks, unsigned i_count )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    for( unsigned i = 0; i < i_count; )
+    {
+        int val = sendmmsg( p_sys->i_handle, msgs + i, i_count - i, 0 );
+        if( val <= 0 )
+        {
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+            val = 1; /* skip the failing packet */
+        }
+        i += val;
+    }
+
+    for( unsigned i = 0; i < i_count; i++ )
+        block_Release( pp_blocks[i] );
+}
+
+/* Sends all the packets of the output that are due at date now */
+static void SchedSend( sched_output_t *out, vlc_tick_t now )
+{
+    sout_access_out_t *p_access = out->p_access;
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    struct mmsghdr msgs[SCHED_BATCH_SIZE];
+    struct iovec iov[SCHED_BATCH_SIZE];
+    block_t *pp_blocks[SCHED_BATCH_SIZE];
+    unsigned i_count = 0;
+#ifdef SO_TXTIME
+    union {
+        char buf[CMSG_SPACE(sizeof (uint64_t))];
+        struct cmsghdr align;
+    } control[SCHED_BATCH_SIZE];
+    int64_t i_tai_offset = 0;
+
+    if( out->i_ahead > 0 )
+    {
+        /* Transmit times are on the TAI clock */
+        struct timespec ts;
+        clock_gettime( CLOCK_TAI, &ts );
+        i_tai_offset = ts.tv_sec * INT64_C(1000000000) + ts.tv_nsec
+                     - NS_FROM_VLC_TICK( vlc_tick_now() );
+    }
+#endif
+
+    while( out->p_pending != NULL && SchedDate( out, out->p_pending ) <= now )
+    {
+        block_t *p_pk = out->p_pending;
+        vlc_tick_t i_date = p_pk->i_dts + p_sys->i_caching;
+
+        out->p_pending = block_SpscTryGet( p_sys->queue );
+
+        if( out->i_date_last > 0 )
+        {
+            if( i_date - out->i_date_last > VLC_TICK_FROM_SEC(2) )
+            {
+                if( !out->i_dropped )
+                    msg_Dbg( p_access, "mmh, hole (%"PRId64" > 2s) -> drop",
+                             i_date - out->i_date_last );
+
+                block_Release( p_pk );
+
+                out->i_date_last = i_date;
+                out->i_dropped++;
+                continue;
+            }
+            else if( i_date - out->i_date_last < VLC_TICK_FROM_MS(-1) )
+            {
+                if( !out->i_dropped )
+                    msg_Dbg( p_access, "mmh, packets in the past (%"PRId64")",
+                             out->i_date_last - i_date );
+            }
+        }
+        if( out->i_dropped )
+        {
+            msg_Dbg( p_access, "dropped %i packets", out->i_dropped );
+            out->i_dropped = 0;
+        }
+        out->i_date_last = i_date;
+
+        vlc_tick_t i_jitter = now - ( i_date - out->i_ahead );
+        out->i_sent++;
+        out->i_jitter_sum += i_jitter;
+        if( i_jitter > out->i_jitter_max )
+            out->i_jitter_max = i_jitter;
+
+        if( i_count == SCHED_BATCH_SIZE )
+        {
+            SchedFlush( p_access, msgs, pp_blocks, i_count );
+            i_count = 0;
+        }
+
+        pp_blocks[i_count] = p_pk;
+        iov[i_count].iov_base = p_pk->p_buffer;
+        iov[i_count].iov_len = p_pk->i_buffer;
+        msgs[i_count].msg_hdr = (struct msghdr) {
+            .msg_iov = &iov[i_count],
+            .msg_iovlen = 1,
+        };
+#ifdef SO_TXTIME
+        if( out->i_ahead > 0 )
+        {
+            struct msghdr *msg = &msgs[i_count].msg_hdr;
+            msg->msg_control = control[i_count].buf;
+            msg->msg_controllen = sizeof (control[i_count].buf);
+
+            struct cmsghdr *cmsg = CMSG_FIRSTHDR( msg );
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_TXTIME;
+            cmsg->cmsg_len = CMSG_LEN(sizeof (uint64_t));
+            memcpy( CMSG_DATA(cmsg),
+                    &(uint64_t){ NS_FROM_VLC_TICK( i_date ) + i_tai_offset },
+                    sizeof (uint64_t) );
+        }
+#endif
+        i_count++;
+    }
+
+    if( i_count > 0 )
+        SchedFlush( p_access, msgs, pp_blocks, i_count );
+}
+
+static void *SchedThread( void *data )
+{
+    sched_t *s = data;
+    sched_output_t *out;
+
+    vlc_mutex_lock( &sched_lock );
+    while( !s->b_exit )
+    {
+        vlc_tick_t now = vlc_tick_now();
+        const uint64_t i_now_tick = now / SCHED_TICK;
+
+        /* Outputs that had no packets */
+        vlc_list_foreach( out, &s->idle, node )
+        {
+            sout_access_out_sys_t *p_sys = out->p_access->p_sys;
+
+            if( out->p_pending == NULL )
+                out->p_pending = block_SpscTryGet( p_sys->queue );
+
+            if( out->p_pending != NULL )
+            {
+                vlc_list_remove( &out->node );
+                SchedQueue( s, out, s->i_tick );
+            }
+            else if( out->b_closing )
+            {
+                vlc_list_remove( &out->node );
+                out->b_done = true;
+                vlc_cond_broadcast( &s->wait );
+            }
+        }
+
+        /* Elapsed slots */
+        for( ; s->i_tick <= i_now_tick; s->i_tick++ )
+        {
+            struct vlc_list *slot = &s->wheel[s->i_tick % SCHED_WHEEL_SLOTS];
+
+            vlc_list_foreach( out, slot, node )
+            {
+                vlc_list_remove( &out->node );
+                SchedSend( out, now );
+                if( out->p_pending != NULL )
+                    SchedQueue( s, out, s->i_tick + 1 );
+                else
+                    vlc_list_append( &out->node, &s->idle );
+            }
+        }
+
+        vlc_mutex_unlock( &sched_lock );
+        vlc_tick_wait( s->i_tick * SCHED_TICK );
+        vlc_mutex_lock( &sched_lock );
+    }
+    vlc_mutex_unlock( &sched_lock );
+    return NULL;
+}
+
+static int SchedAdd( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    sched_output_t *out = &p_sys->out;
+
+    *out = (sched_output_t) {
+        .p_access = p_access,
+        .i_date_last = -1,
+    };
+
+#ifdef SO_TXTIME
+    if( var_GetBool( p_access, SOUT_CFG_PREFIX "txtime" ) )
+    {
+        const struct sock_txtime txtime = { .clockid = CLOCK_TAI };
+
+        if( setsockopt( p_sys->i_handle, SOL_SOCKET, SO_TXTIME,
+                        &txtime, sizeof (txtime) ) == 0 )
+            out->i_ahead = TXTIME_AHEAD;
+        else
+            msg_Warn( p_access, "transmit time unavailable: %s",
+                      vlc_strerror_c(errno) );
+    }
+#endif
+
+    vlc_mutex_lock( &sched_lock );
+    if( sched == NULL )
+    {
+        sched_t *s = malloc( sizeof (*s) );
+        if( unlikely(s == NULL) )
+        {
+            vlc_mutex_unlock( &sched_lock );
+            return VLC_ENOMEM;
+        }
+
+        vlc_cond_init( &s->wait );
+        s->i_refs = 0;
+        s->b_exit = false;
+        s->i_tick = vlc_tick_now() / SCHED_TICK;
+        vlc_list_init( &s->idle );
+        for( size_t i = 0; i < SCHED_WHEEL_SLOTS; i++ )
+            vlc_list_init( &s->wheel[i] );
+
+        if( vlc_clone( &s->thread, SchedThread, s,
+                       VLC_THREAD_PRIORITY_HIGHEST ) )
+        {
+            vlc_mutex_unlock( &sched_lock );
+            free( s );
+            return VLC_EGENERIC;
+        }
+        sched = s;
+    }
+    sched->i_refs++;
+    vlc_list_append( &out->node, &sched->idle );
+    vlc_mutex_unlock( &sched_lock );
+    return VLC_SUCCESS;
+}
+
+/* Waits for the queued packets to be sent */
+static void SchedRemove( sout_access_out_t *p_access )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+    sched_output_t *out = &p_sys->out;
+    sched_t *s;
+
+    vlc_mutex_lock( &sched_lock );
+    s = sched;
+    out->b_closing = true;
+    while( !out->b_done )
+        vlc_cond_wait( &s->wait, &sched_lock );
+
+    if( --s->i_refs == 0 )
+    {
+        s->b_exit = true;
+        sched = NULL;
+    }
+    else
+        s = NULL;
+    vlc_mutex_unlock( &sched_lock );
+
+    if( out->i_sent > 0 )
+        msg_Dbg( p_access, "sent %"PRIu64" packets, jitter average %"PRId64
+                 " us, max %"PRId64" us", out->i_sent,
+                 US_FROM_VLC_TICK( out->i_jitter_sum / out->i_sent ),
+                 US_FROM_VLC_TICK( out->i_jitter_max ) );
+
+    if( s != NULL )
+    {
+        vlc_join( s->thread, NULL );
+        free( s );
+    }
+}
+#endif
+
 #define DEFAULT_PORT 1234
 
 /*****************************************************************************
@@ -208,14 +601,41 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_handle = i_handle;
     p_sys->i_mtu = var_CreateGetInteger( p_this, "mtu" );
     p_sys->b_mtu_warning = false;
-    p_sys->dead = false;
-    vlc_queue_Init(&p_sys->queue, offsetof (block_t, p_next));
+#ifdef UDP_SEGMENT
+    p_sys->b_gso = var_GetBool( p_access, SOUT_CFG_PREFIX "gso" );
+#else
+    p_sys->b_gso = false;
+#endif
+    p_sys->queue = block_SpscNew( UDP_QUEUE_SIZE );
     p_sys->p_buffer = NULL;
 
+    if( unlikely(p_sys->queue == NULL) )
+    {
+        net_Close (i_handle);
+        free (p_sys);
+        return VLC_ENOMEM;
+    }
+
+#ifdef HAVE_SENDMMSG
+    p_sys->b_shared = var_GetBool( p_access, SOUT_CFG_PREFIX "shared" );
+    if( p_sys->b_shared )
+    {
+        if( SchedAdd( p_access ) )
+        {
+            msg_Err( p_access, "cannot join the shared sending thread" );
+            block_SpscRelease( p_sys->queue );
+            net_Close (i_handle);
+            free (p_sys);
+            return VLC_EGENERIC;
+        }
+    }
+    else
+#endif
     if( vlc_clone( &p_sys->thread, ThreadWrite, p_access,
                            VLC_THREAD_PRIORITY_HIGHEST ) )
     {
         msg_Err( p_access, "cannot spawn sout access thread" );
+        block_SpscRelease( p_sys->queue );
         net_Close (i_handle);
         free (p_sys);
         return VLC_EGENERIC;
@@ -235,8 +655,16 @@ static void Close( vlc_object_t * p_this )
     sout_access_out_t     *p_access = (sout_access_out_t*)p_this;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
 
-    vlc_queue_Kill(&p_sys->queue, &p_sys->dead);
-    vlc_join( p_sys->thread, NULL );
+#ifdef HAVE_SENDMMSG
+    if( p_sys->b_shared )
+        SchedRemove( p_access );
+    else
+#endif
+    {
+        block_SpscKill( p_sys->queue );
+        vlc_join( p_sys->thread, NULL );
+    }
+    block_SpscRelease( p_sys->queue );
 
     if( p_sys->p_buffer ) block_Release( p_sys->p_buffer );
 
@@ -291,7 +719,7 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
                          now - p_sys->p_buffer->i_dts
                           - p_sys->i_caching );
             }
-            vlc_queue_Enqueue(&p_sys->queue, p_sys->p_buffer);
+            block_SpscPut(p_sys->queue, p_sys->p_buffer);
             p_sys->p_buffer = NULL;
         }
 
@@ -333,7 +761,7 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
                              vlc_tick_now() - p_sys->p_buffer->i_dts
                               - p_sys->i_caching );
                 }
-                vlc_queue_Enqueue(&p_sys->queue, p_sys->p_buffer);
+                block_SpscPut(p_sys->queue, p_sys->p_buffer);
                 p_sys->p_buffer = NULL;
             }
         }
@@ -346,6 +774,101 @@ static ssize_t Write( sout_access_out_t *p_access, block_t *p_buffer )
     return i_len;
 }
 
+#ifdef UDP_SEGMENT
+/*****************************************************************************
+ * GSO batch: packets of equal size sent with a single sendmsg() call.
+ *****************************************************************************/
+typedef struct
+{
+    block_t      *pp_blocks[GSO_MAX_SEGMENTS];
+    struct iovec  iov[GSO_MAX_SEGMENTS];
+    unsigned      i_count;
+    size_t        i_size;
+    size_t        i_segment;
+} gso_batch_t;
+
+static void GSOFlush( sout_access_out_t *p_access, gso_batch_t *p_batch )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if( p_batch->i_count == 0 )
+        return;
+
+    union {
+        char buf[CMSG_SPACE(sizeof (uint16_t))];
+        struct cmsghdr align;
+    } control;
+    struct msghdr msg = {
+        .msg_iov = p_batch->iov,
+        .msg_iovlen = p_batch->i_count,
+    };
+
+    if( p_batch->i_count > 1 )
+    {
+        msg.msg_control = control.buf;
+        msg.msg_controllen = sizeof (control.buf);
+
+        struct cmsghdr *cmsg = CMSG_FIRSTHDR( &msg );
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof (uint16_t));
+        memcpy( CMSG_DATA(cmsg), &(uint16_t){ p_batch->i_segment },
+                sizeof (uint16_t) );
+    }
+
+    if( sendmsg( p_sys->i_handle, &msg, 0 ) == -1 )
+    {
+        if( p_batch->i_count > 1 && (errno == EIO || errno == EINVAL) )
+        {
+            /* No segmentation offload on this path: send one by one */
+            msg_Warn( p_access, "segmentation offload unavailable: %s",
+                      vlc_strerror_c(errno) );
+            p_sys->b_gso = false;
+            for( unsigned i = 0; i < p_batch->i_count; i++ )
+                if( send( p_sys->i_handle, p_batch->iov[i].iov_base,
+                          p_batch->iov[i].iov_len, 0 ) == -1 )
+                    msg_Warn( p_access, "send error: %s",
+                              vlc_strerror_c(errno) );
+        }
+        else
+            msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
+    }
+
+    for( unsigned i = 0; i < p_batch->i_count; i++ )
+        block_Release( p_batch->pp_blocks[i] );
+    p_batch->i_count = 0;
+    p_batch->i_size = 0;
+}
+
+/* Takes ownership of the block, which may be sent right away */
+static void GSOQueue( sout_access_out_t *p_access, gso_batch_t *p_batch,
+                      block_t *p_pk )
+{
+    sout_access_out_sys_t *p_sys = p_access->p_sys;
+
+    if( p_batch->i_count > 0
+     && ( p_pk->i_buffer > p_batch->i_segment
+       || p_batch->i_count == GSO_MAX_SEGMENTS
+       || p_batch->i_size + p_pk->i_buffer > GSO_MAX_SIZE ) )
+        GSOFlush( p_access, p_batch );
+
+    if( p_batch->i_count == 0 )
+        p_batch->i_segment = p_pk->i_buffer;
+
+    p_batch->pp_blocks[p_batch->i_count] = p_pk;
+    p_batch->iov[p_batch->i_count].iov_base = p_pk->p_buffer;
+    p_batch->iov[p_batch->i_count].iov_len = p_pk->i_buffer;
+    p_batch->i_count++;
+    p_batch->i_size += p_pk->i_buffer;
+
+    /* Only the last segment may be shorter. Never hold packets back while
+     * waiting for more data to come. */
+    if( p_pk->i_buffer < p_batch->i_segment
+     || block_SpscGetCount( p_sys->queue ) == 0 )
+        GSOFlush( p_access, p_batch );
+}
+#endif
+
 /*****************************************************************************
  * ThreadWrite: Write a packet on the network at the good time.
  *****************************************************************************/
@@ -353,6 +876,9 @@ static void* ThreadWrite( void *data )
 {
     sout_access_out_t *p_access = data;
     sout_access_out_sys_t *p_sys = p_access->p_sys;
+#ifdef UDP_SEGMENT
+    gso_batch_t batch = { .i_count = 0, .i_size = 0 };
+#endif
     vlc_tick_t i_date_last = -1;
     const unsigned i_group = var_GetInteger( p_access,
                                              SOUT_CFG_PREFIX "group" );
@@ -360,8 +886,7 @@ static void* ThreadWrite( void *data )
     unsigned i_dropped_packets = 0;
     block_t *p_pk;
 
-    while ((p_pk = vlc_queue_DequeueKillable(&p_sys->queue,
-                                             &p_sys->dead)) != NULL)
+    while ((p_pk = block_SpscGet(p_sys->queue)) != NULL)
     {
         vlc_tick_t    i_date;
 
@@ -391,9 +916,20 @@ static void* ThreadWrite( void *data )
         i_to_send--;
         if( !i_to_send || (p_pk->i_flags & BLOCK_FLAG_CLOCK) )
         {
+#ifdef UDP_SEGMENT
+            GSOFlush( p_access, &batch );
+#endif
             vlc_tick_wait( i_date );
             i_to_send = i_group;
         }
+#ifdef UDP_SEGMENT
+        if( p_sys->b_gso )
+        {
+            GSOQueue( p_access, &batch, p_pk );
+            p_pk = NULL;
+        }
+        else
+#endif
         if ( send( p_sys->i_handle, p_pk->p_buffer, p_pk->i_buffer, 0 ) == -1 )
             msg_Warn( p_access, "send error: %s", vlc_strerror_c(errno) );
 
@@ -414,8 +950,11 @@ static void* ThreadWrite( void *data )
         }
 #endif
 
-        block_Release( p_pk );
-
+        if( p_pk != NULL )
+            block_Release( p_pk );
     }
+#ifdef UDP_SEGMENT
+    GSOFlush( p_access, &batch );
+#endif
     return NULL;
 }
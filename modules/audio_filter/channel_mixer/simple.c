@@ -367,6 +367,18 @@ static block_t *Filter( filter_t *p_filter, block_t *p_block )
         return NULL;
     }
 
+    int i_input_nb = aout_FormatNbChannels( &p_filter->fmt_in.audio );
+    int i_output_nb = aout_FormatNbChannels( &p_filter->fmt_out.audio );
+
+#if !defined (CAN_COMPILE_NEON)
+    /* Every mix has fewer output channels, and the kernels only overwrite
+     * samples they already read: downmix in place */
+    assert( i_output_nb < i_input_nb );
+    work( p_filter, p_block, p_block );
+    p_block->i_buffer = p_block->i_buffer * i_output_nb / i_input_nb;
+
+    return p_block;
+#else
     size_t i_out_size = p_block->i_nb_samples *
       p_filter->fmt_out.audio.i_bitspersample *
         p_filter->fmt_out.audio.i_channels / 8;
@@ -384,8 +396,6 @@ static block_t *Filter( filter_t *p_filter, block_t *p_block )
     p_out->i_pts = p_block->i_pts;
     p_out->i_length = p_block->i_length;
 
-    int i_input_nb = aout_FormatNbChannels( &p_filter->fmt_in.audio );
-    int i_output_nb = aout_FormatNbChannels( &p_filter->fmt_out.audio );
     p_out->i_nb_samples = p_block->i_nb_samples;
     p_out->i_buffer = p_block->i_buffer * i_output_nb / i_input_nb;
 
@@ -394,4 +404,5 @@ static block_t *Filter( filter_t *p_filter, block_t *p_block )
     block_Release( p_block );
 
     return p_out;
+#endif
 }
@@ -36,6 +36,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
+#include <vlc_cpu.h>
 #include <vlc_block.h>
 #include <vlc_filter.h>
 
@@ -84,73 +85,509 @@ static int Open(vlc_object_t *object)
 }
 
 
+/*****************************************************************************
+ * Output buffers
+ *****************************************************************************
+ * Conversions to a smaller or equal sample size are done in place.
+ * Larger outputs also reuse the input buffer when it is big enough, the
+ * samples then being converted from the end of the buffer.
+ *****************************************************************************/
+static block_t *AllocOutput(block_t *in, size_t size)
+{
+    if ((size_t)(in->p_start + in->i_size - in->p_buffer) >= size)
+        return in;
+
+    block_t *out = block_Alloc(size);
+    if (unlikely(out == NULL))
+    {
+        block_Release(in);
+        return NULL;
+    }
+    block_CopyProperties(out, in);
+    return out;
+}
+
+static block_t *ReleaseInput(block_t *in, block_t *out, size_t size)
+{
+    if (out != in)
+        block_Release(in);
+    out->i_buffer = size;
+    return out;
+}
+
+/*****************************************************************************
+ * Conversion kernels
+ *****************************************************************************
+ * Kernels to a larger sample size iterate backward, and load each vector
+ * before storing anything overlapping it, so that they work in place.
+ *****************************************************************************/
+static inline float S16toFl32_Sample(int16_t s)
+{   /* This is Walken's trick based on IEEE float format. On my PIII
+     * this takes 16 seconds to perform one billion conversions, instead
+     * of 19 seconds for the division. */
+    union { float f; int32_t i; } u;
+    u.i = s + 0x43c00000;
+    return u.f - 384.f;
+}
+
+static inline int16_t Fl32toS16_Sample(float s)
+{   /* This is Walken's trick based on IEEE float format. */
+    union { float f; int32_t i; } u;
+    u.f = s + 384.f;
+    if (u.i > 0x43c07fff)
+        return 32767;
+    if (u.i < 0x43bf8000)
+        return -32768;
+    return u.i - 0x43c00000;
+}
+
+static inline int32_t Fl32toS32_Sample(float s)
+{
+    s *= 2147483648.f;
+    if (s >= 2147483647.f)
+        return 2147483647;
+    if (s <= -2147483648.f)
+        return -2147483648;
+    return lroundf(s);
+}
+
+static void U8toFl32_C(float *dst, const uint8_t *src, size_t n)
+{
+    while (n--)
+        dst[n] = ((float)(src[n] - 128)) / 128.f;
+}
+
+static void S16toFl32_C(float *dst, const int16_t *src, size_t n)
+{
+    while (n--)
+        dst[n] = S16toFl32_Sample(src[n]);
+}
+
+static void S16toS32_C(int32_t *dst, const int16_t *src, size_t n)
+{
+    while (n--)
+        dst[n] = (int32_t)src[n] << 16;
+}
+
+static void S32toFl32_C(float *dst, const int32_t *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        dst[i] = (float)src[i] / 2147483648.f;
+}
+
+static void Fl32toS16_C(int16_t *dst, const float *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        dst[i] = Fl32toS16_Sample(src[i]);
+}
+
+static void Fl32toS32_C(int32_t *dst, const float *src, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        dst[i] = Fl32toS32_Sample(src[i]);
+}
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+
+__attribute__ ((__target__ ("sse2")))
+static void U8toFl32_SSE2(float *dst, const uint8_t *src, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128 scale = _mm_set1_ps(1.f / 128.f);
+    size_t i = n & ~(size_t)15;
+
+    U8toFl32_C(dst + i, src + i, n - i);
+    while (i > 0)
+    {
+        i -= 16;
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i lo = _mm_sub_epi16(_mm_unpacklo_epi8(v, zero), bias);
+        __m128i hi = _mm_sub_epi16(_mm_unpackhi_epi8(v, zero), bias);
+        /* Sign extension to 32 bits */
+        __m128i v3 = _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16);
+        __m128i v2 = _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16);
+        __m128i v1 = _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16);
+        __m128i v0 = _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16);
+        _mm_storeu_ps(dst + i + 12, _mm_mul_ps(_mm_cvtepi32_ps(v3), scale));
+        _mm_storeu_ps(dst + i + 8, _mm_mul_ps(_mm_cvtepi32_ps(v2), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(v1), scale));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v0), scale));
+    }
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void S16toFl32_SSE2(float *dst, const int16_t *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(1.f / 32768.f);
+    size_t i = n & ~(size_t)7;
+
+    S16toFl32_C(dst + i, src + i, n - i);
+    while (i > 0)
+    {
+        i -= 8;
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+    }
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void S16toS32_SSE2(int32_t *dst, const int16_t *src, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = n & ~(size_t)7;
+
+    S16toS32_C(dst + i, src + i, n - i);
+    while (i > 0)
+    {
+        i -= 8;
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i hi = _mm_unpackhi_epi16(zero, v);
+        __m128i lo = _mm_unpacklo_epi16(zero, v);
+        _mm_storeu_si128((__m128i *)(dst + i + 4), hi);
+        _mm_storeu_si128((__m128i *)(dst + i), lo);
+    }
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void S32toFl32_SSE2(float *dst, const int32_t *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(1.f / 2147483648.f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+    }
+    S32toFl32_C(dst + i, src + i, n - i);
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void Fl32toS16_SSE2(int16_t *dst, const float *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(32768.f);
+    const __m128 max = _mm_set1_ps(32767.f);
+    const __m128 min = _mm_set1_ps(-32768.f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(src + i + 4), scale);
+        /* Clip before the conversion, which does not saturate */
+        a = _mm_max_ps(_mm_min_ps(a, max), min);
+        b = _mm_max_ps(_mm_min_ps(b, max), min);
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+    Fl32toS16_C(dst + i, src + i, n - i);
+}
+
+__attribute__ ((__target__ ("sse2")))
+static void Fl32toS32_SSE2(int32_t *dst, const float *src, size_t n)
+{
+    const __m128 scale = _mm_set1_ps(2147483648.f);
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 s = _mm_mul_ps(_mm_loadu_ps(src + i), scale);
+        /* Out of range values convert to INT32_MIN: flip the positive
+         * ones to INT32_MAX */
+        __m128i v = _mm_cvtps_epi32(s);
+        v = _mm_xor_si128(v, _mm_castps_si128(_mm_cmpge_ps(s, scale)));
+        _mm_storeu_si128((__m128i *)(dst + i), v);
+    }
+    Fl32toS32_C(dst + i, src + i, n - i);
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+# include <immintrin.h>
+
+__attribute__ ((__target__ ("avx2")))
+static void U8toFl32_AVX2(float *dst, const uint8_t *src, size_t n)
+{
+    const __m256i bias = _mm256_set1_epi32(128);
+    const __m256 scale = _mm256_set1_ps(1.f / 128.f);
+    size_t i = n & ~(size_t)15;
+
+    U8toFl32_C(dst + i, src + i, n - i);
+    while (i > 0)
+    {
+        i -= 16;
+        __m128i v = _mm_loadu_si128((const __m128i *)(src + i));
+        __m256i hi = _mm256_sub_epi32(_mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)), bias);
+        __m256i lo = _mm256_sub_epi32(_mm256_cvtepu8_epi32(v), bias);
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+    }
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void S16toFl32_AVX2(float *dst, const int16_t *src, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(1.f / 32768.f);
+    size_t i = n & ~(size_t)15;
+
+    S16toFl32_C(dst + i, src + i, n - i);
+    while (i > 0)
+    {
+        i -= 16;
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1));
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v));
+        _mm256_storeu_ps(dst + i + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(hi), scale));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(lo), scale));
+    }
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void S16toS32_AVX2(int32_t *dst, const int16_t *src, size_t n)
+{
+    size_t i = n & ~(size_t)15;
+
+    S16toS32_C(dst + i, src + i, n - i);
+    while (i > 0)
+    {
+        i -= 16;
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1));
+        __m256i lo = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(v));
+        _mm256_storeu_si256((__m256i *)(dst + i + 8), _mm256_slli_epi32(hi, 16));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_slli_epi32(lo, 16));
+    }
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void S32toFl32_AVX2(float *dst, const int32_t *src, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(1.f / 2147483648.f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+    }
+    S32toFl32_C(dst + i, src + i, n - i);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void Fl32toS16_AVX2(int16_t *dst, const float *src, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(32768.f);
+    const __m256 max = _mm256_set1_ps(32767.f);
+    const __m256 min = _mm256_set1_ps(-32768.f);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(src + i + 8), scale);
+        a = _mm256_max_ps(_mm256_min_ps(a, max), min);
+        b = _mm256_max_ps(_mm256_min_ps(b, max), min);
+        /* Packing works within 128-bits lanes: reorder the quadwords */
+        __m256i v = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        _mm256_storeu_si256((__m256i *)(dst + i), _mm256_permute4x64_epi64(v, 0xD8));
+    }
+    Fl32toS16_C(dst + i, src + i, n - i);
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void Fl32toS32_AVX2(int32_t *dst, const float *src, size_t n)
+{
+    const __m256 scale = _mm256_set1_ps(2147483648.f);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 s = _mm256_mul_ps(_mm256_loadu_ps(src + i), scale);
+        __m256i v = _mm256_cvtps_epi32(s);
+        v = _mm256_xor_si256(v, _mm256_castps_si256(_mm256_cmp_ps(s, scale, _CMP_GE_OQ)));
+        _mm256_storeu_si256((__m256i *)(dst + i), v);
+    }
+    Fl32toS32_C(dst + i, src + i, n - i);
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_NEON_KERNELS
+
+static void U8toFl32_NEON(float *dst, const uint8_t *src, size_t n)
+{
+    const uint8x16_t bias = vdupq_n_u8(128);
+    size_t i = n & ~(size_t)15;
+
+    U8toFl32_C(dst + i, src + i, n - i);
+    while (i > 0)
+    {
+        i -= 16;
+        uint8x16_t v = vld1q_u8(src + i);
+        int16x8_t lo = vreinterpretq_s16_u16(vsubl_u8(vget_low_u8(v), vget_low_u8(bias)));
+        int16x8_t hi = vreinterpretq_s16_u16(vsubl_high_u8(v, bias));
+        float32x4_t f3 = vcvtq_n_f32_s32(vmovl_high_s16(hi), 7);
+        float32x4_t f2 = vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(hi)), 7);
+        float32x4_t f1 = vcvtq_n_f32_s32(vmovl_high_s16(lo), 7);
+        float32x4_t f0 = vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(lo)), 7);
+        vst1q_f32(dst + i + 12, f3);
+        vst1q_f32(dst + i + 8, f2);
+        vst1q_f32(dst + i + 4, f1);
+        vst1q_f32(dst + i, f0);
+    }
+}
+
+static void S16toFl32_NEON(float *dst, const int16_t *src, size_t n)
+{
+    size_t i = n & ~(size_t)7;
+
+    S16toFl32_C(dst + i, src + i, n - i);
+    while (i > 0)
+    {
+        i -= 8;
+        int16x8_t v = vld1q_s16(src + i);
+        float32x4_t hi = vcvtq_n_f32_s32(vmovl_high_s16(v), 15);
+        float32x4_t lo = vcvtq_n_f32_s32(vmovl_s16(vget_low_s16(v)), 15);
+        vst1q_f32(dst + i + 4, hi);
+        vst1q_f32(dst + i, lo);
+    }
+}
+
+static void S16toS32_NEON(int32_t *dst, const int16_t *src, size_t n)
+{
+    size_t i = n & ~(size_t)7;
+
+    S16toS32_C(dst + i, src + i, n - i);
+    while (i > 0)
+    {
+        i -= 8;
+        int16x8_t v = vld1q_s16(src + i);
+        int32x4_t hi = vshll_high_n_s16(v, 16);
+        int32x4_t lo = vshll_n_s16(vget_low_s16(v), 16);
+        vst1q_s32(dst + i + 4, hi);
+        vst1q_s32(dst + i, lo);
+    }
+}
+
+static void S32toFl32_NEON(float *dst, const int32_t *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        vst1q_f32(dst + i, vcvtq_n_f32_s32(vld1q_s32(src + i), 31));
+    S32toFl32_C(dst + i, src + i, n - i);
+}
+
+static void Fl32toS16_NEON(int16_t *dst, const float *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        /* Both the conversion and the narrowing saturate */
+        int32x4_t a = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), 32768.f));
+        int32x4_t b = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i + 4), 32768.f));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+    }
+    Fl32toS16_C(dst + i, src + i, n - i);
+}
+
+static void Fl32toS32_NEON(int32_t *dst, const float *src, size_t n)
+{
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4)
+        vst1q_s32(dst + i,
+                  vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(src + i), 2147483648.f)));
+    Fl32toS32_C(dst + i, src + i, n - i);
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+# define TRY_AVX2(f, ...) if (vlc_CPU_AVX2()) f##_AVX2(__VA_ARGS__); else
+#else
+# define TRY_AVX2(f, ...)
+#endif
+#ifdef CAN_COMPILE_SSE2
+# define TRY_SSE2(f, ...) if (vlc_CPU_SSE2()) f##_SSE2(__VA_ARGS__); else
+#else
+# define TRY_SSE2(f, ...)
+#endif
+#ifdef CAN_COMPILE_NEON_KERNELS
+# define TRY_NEON(f, ...) if (vlc_CPU_ARM_NEON()) f##_NEON(__VA_ARGS__); else
+#else
+# define TRY_NEON(f, ...)
+#endif
+
+/* Runs the fastest kernel available on this CPU */
+#define CONVERT(f, ...) \
+    TRY_AVX2(f, __VA_ARGS__) TRY_SSE2(f, __VA_ARGS__) TRY_NEON(f, __VA_ARGS__) \
+    f##_C(__VA_ARGS__)
+
+
 /*** from U8 ***/
 static block_t *U8toS16(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t n = bsrc->i_buffer;
+    block_t *bdst = AllocOutput(bsrc, n * 2);
     if (unlikely(bdst == NULL))
-        goto out;
+        return NULL;
 
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
+    const uint8_t *src = (const uint8_t *)bsrc->p_buffer;
     int16_t *dst = (int16_t *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((*src++) << 8) - 0x8000;
-out:
-    block_Release(bsrc);
+    for (size_t i = n; i--;)
+        dst[i] = (src[i] << 8) - 0x8000;
     VLC_UNUSED(filter);
-    return bdst;
+    return ReleaseInput(bsrc, bdst, n * 2);
 }
 
 static block_t *U8toFl32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
+    const size_t n = bsrc->i_buffer;
+    block_t *bdst = AllocOutput(bsrc, n * 4);
     if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((float)((*src++) - 128)) / 128.f;
-out:
-    block_Release(bsrc);
+        return NULL;
+
+    CONVERT(U8toFl32, (float *)bdst->p_buffer,
+            (const uint8_t *)bsrc->p_buffer, n);
     VLC_UNUSED(filter);
-    return bdst;
+    return ReleaseInput(bsrc, bdst, n * 4);
 }
 
 static block_t *U8toS32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
+    const size_t n = bsrc->i_buffer;
+    block_t *bdst = AllocOutput(bsrc, n * 4);
     if (unlikely(bdst == NULL))
-        goto out;
+        return NULL;
 
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
+    const uint8_t *src = (const uint8_t *)bsrc->p_buffer;
     int32_t *dst = (int32_t *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((*src++) << 24) - 0x80000000;
-out:
-    block_Release(bsrc);
+    for (size_t i = n; i--;)
+        dst[i] = ((uint32_t)src[i] << 24) - 0x80000000;
     VLC_UNUSED(filter);
-    return bdst;
+    return ReleaseInput(bsrc, bdst, n * 4);
 }
 
 static block_t *U8toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 8);
+    const size_t n = bsrc->i_buffer;
+    block_t *bdst = AllocOutput(bsrc, n * 8);
     if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    uint8_t *src = (uint8_t *)bsrc->p_buffer;
-    double  *dst = (double *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer; i--;)
-        *dst++ = ((double)((*src++) - 128)) / 128.;
-out:
-    block_Release(bsrc);
+        return NULL;
+
+    const uint8_t *src = (const uint8_t *)bsrc->p_buffer;
+    double *dst = (double *)bdst->p_buffer;
+    for (size_t i = n; i--;)
+        dst[i] = ((double)(src[i] - 128)) / 128.;
     VLC_UNUSED(filter);
-    return bdst;
+    return ReleaseInput(bsrc, bdst, n * 8);
 }
 
 
@@ -169,64 +606,43 @@ static block_t *S16toU8(filter_t *filter, block_t *b)
 
 static block_t *S16toFl32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t n = bsrc->i_buffer / 2;
+    block_t *bdst = AllocOutput(bsrc, n * 4);
     if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 2; i--;)
-#if 0
-        /* Slow version */
-        *dst++ = (float)*src++ / 32768.f;
-#else
-    {   /* This is Walken's trick based on IEEE float format. On my PIII
-         * this takes 16 seconds to perform one billion conversions, instead
-         * of 19 seconds for the above division. */
-        union { float f; int32_t i; } u;
-        u.i = *src++ + 0x43c00000;
-        *dst++ = u.f - 384.f;
-    }
-#endif
-out:
-    block_Release(bsrc);
+        return NULL;
+
+    CONVERT(S16toFl32, (float *)bdst->p_buffer,
+            (const int16_t *)bsrc->p_buffer, n);
     VLC_UNUSED(filter);
-    return bdst;
+    return ReleaseInput(bsrc, bdst, n * 4);
 }
 
 static block_t *S16toS32(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t n = bsrc->i_buffer / 2;
+    block_t *bdst = AllocOutput(bsrc, n * 4);
     if (unlikely(bdst == NULL))
-        goto out;
+        return NULL;
 
-    block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    int32_t *dst = (int32_t *)bdst->p_buffer;
-    for (int i = bsrc->i_buffer / 2; i--;)
-        *dst++ = *src++ << 16;
-out:
-    block_Release(bsrc);
+    CONVERT(S16toS32, (int32_t *)bdst->p_buffer,
+            (const int16_t *)bsrc->p_buffer, n);
     VLC_UNUSED(filter);
-    return bdst;
+    return ReleaseInput(bsrc, bdst, n * 4);
 }
 
 static block_t *S16toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 4);
+    const size_t n = bsrc->i_buffer / 2;
+    block_t *bdst = AllocOutput(bsrc, n * 8);
     if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    int16_t *src = (int16_t *)bsrc->p_buffer;
-    float   *dst = (float *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 2; i--;)
-        *dst++ = (double)*src++ / 32768.;
-out:
-    block_Release(bsrc);
+        return NULL;
+
+    const int16_t *src = (const int16_t *)bsrc->p_buffer;
+    double *dst = (double *)bdst->p_buffer;
+    for (size_t i = n; i--;)
+        dst[i] = (double)src[i] / 32768.;
     VLC_UNUSED(filter);
-    return bdst;
+    return ReleaseInput(bsrc, bdst, n * 8);
 }
 
 
@@ -254,65 +670,33 @@ static block_t *Fl32toU8(filter_t *filter, block_t *b)
 static block_t *Fl32toS16(filter_t *filter, block_t *b)
 {
     VLC_UNUSED(filter);
-    float   *src = (float *)b->p_buffer;
-    int16_t *dst = (int16_t *)src;
-    for (int i = b->i_buffer / 4; i--;) {
-#if 0
-        /* Slow version. */
-        if (*src >= 1.0) *dst = 32767;
-        else if (*src < -1.0) *dst = -32768;
-        else *dst = lroundf(*src * 32768.f);
-        src++; dst++;
-#else
-        /* This is Walken's trick based on IEEE float format. */
-        union { float f; int32_t i; } u;
-        u.f = *src++ + 384.f;
-        if (u.i > 0x43c07fff)
-            *dst++ = 32767;
-        else if (u.i < 0x43bf8000)
-            *dst++ = -32768;
-        else
-            *dst++ = u.i - 0x43c00000;
-#endif
-    }
+    CONVERT(Fl32toS16, (int16_t *)b->p_buffer,
+            (const float *)b->p_buffer, b->i_buffer / 4);
     b->i_buffer /= 2;
     return b;
 }
 
 static block_t *Fl32toS32(filter_t *filter, block_t *b)
 {
-    float   *src = (float *)b->p_buffer;
-    int32_t *dst = (int32_t *)src;
-    for (size_t i = b->i_buffer / 4; i--;)
-    {
-        float s = *(src++) * 2147483648.f;
-        if (s >= 2147483647.f)
-            *(dst++) = 2147483647;
-        else
-        if (s <= -2147483648.f)
-            *(dst++) = -2147483648;
-        else
-            *(dst++) = lroundf(s);
-    }
     VLC_UNUSED(filter);
+    CONVERT(Fl32toS32, (int32_t *)b->p_buffer,
+            (const float *)b->p_buffer, b->i_buffer / 4);
     return b;
 }
 
 static block_t *Fl32toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t n = bsrc->i_buffer / 4;
+    block_t *bdst = AllocOutput(bsrc, n * 8);
     if (unlikely(bdst == NULL))
-        goto out;
+        return NULL;
 
-    block_CopyProperties(bdst, bsrc);
-    float  *src = (float *)bsrc->p_buffer;
+    const float *src = (const float *)bsrc->p_buffer;
     double *dst = (double *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 4; i--;)
-        *(dst++) = *(src++);
-out:
-    block_Release(bsrc);
+    for (size_t i = n; i--;)
+        dst[i] = src[i];
     VLC_UNUSED(filter);
-    return bdst;
+    return ReleaseInput(bsrc, bdst, n * 8);
 }
 
 
@@ -344,28 +728,24 @@ static block_t *S32toS16(filter_t *filter, block_t *b)
 static block_t *S32toFl32(filter_t *filter, block_t *b)
 {
     VLC_UNUSED(filter);
-    int32_t *src = (int32_t*)b->p_buffer;
-    float   *dst = (float *)src;
-    for (int i = b->i_buffer / 4; i--;)
-        *dst++ = (float)(*src++) / 2147483648.f;
+    CONVERT(S32toFl32, (float *)b->p_buffer,
+            (const int32_t *)b->p_buffer, b->i_buffer / 4);
     return b;
 }
 
 static block_t *S32toFl64(filter_t *filter, block_t *bsrc)
 {
-    block_t *bdst = block_Alloc(bsrc->i_buffer * 2);
+    const size_t n = bsrc->i_buffer / 4;
+    block_t *bdst = AllocOutput(bsrc, n * 8);
     if (unlikely(bdst == NULL))
-        goto out;
-
-    block_CopyProperties(bdst, bsrc);
-    int32_t *src = (int32_t*)bsrc->p_buffer;
-    double  *dst = (double *)bdst->p_buffer;
-    for (size_t i = bsrc->i_buffer / 4; i--;)
-        *dst++ = (double)(*src++) / 2147483648.;
-out:
+        return NULL;
+
+    const int32_t *src = (const int32_t *)bsrc->p_buffer;
+    double *dst = (double *)bdst->p_buffer;
+    for (size_t i = n; i--;)
+        dst[i] = (double)src[i] / 2147483648.;
     VLC_UNUSED(filter);
-    block_Release(bsrc);
-    return bdst;
+    return ReleaseInput(bsrc, bdst, n * 8);
 }
 
 
@@ -416,6 +796,7 @@ static block_t *Fl64toFl32(filter_t *filter, block_t *b)
     for (size_t i = b->i_buffer / 8; i--;)
         *(dst++) = *(src++);
 
+    b->i_buffer /= 2;
     VLC_UNUSED(filter);
     return b;
 }
@@ -426,15 +807,16 @@ static block_t *Fl64toS32(filter_t *filter, block_t *b)
     int32_t *dst = (int32_t *)src;
     for (size_t i = b->i_buffer / 8; i--;)
     {
-        float s = *(src++) * 2147483648.;
-        if (s >= 2147483647.f)
+        double s = *(src++) * 2147483648.;
+        if (s >= 2147483647.)
             *(dst++) = 2147483647;
         else
-        if (s <= -2147483648.f)
+        if (s <= -2147483648.)
             *(dst++) = -2147483648;
         else
             *(dst++) = lround(s);
     }
+    b->i_buffer /= 2;
     VLC_UNUSED(filter);
     return b;
 }
@@ -28,6 +28,7 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
 #include <math.h>
 
 #include <vlc_common.h>
@@ -35,6 +36,8 @@
 #include <vlc_charset.h>
 
 #include <vlc_aout.h>
+#include <vlc_cpu.h>
+#include <vlc_executor.h>
 #include <vlc_filter.h>
 
 #include "equalizer_presets.h"
@@ -122,15 +125,26 @@ typedef struct
     float y2[32][128][2];
 
     vlc_mutex_t lock;
+
+    /* Channel groups filtered in parallel, 1 if not threaded */
+    unsigned i_groups;
+    vlc_executor_t *executor;
 } filter_sys_t;
 
 static block_t *DoWork( filter_t *, block_t * );
 
 #define EQZ_IN_FACTOR (0.25f)
+/* Channels are only split in groups of at least that many: below, the
+ * hand-off costs more than it saves */
+#define EQZ_GROUP_CHANNELS 4
+#define EQZ_MAX_GROUPS 4
 static int  EqzInit( filter_t *, int );
-static void EqzFilter( filter_t *, float *, float *, int, int );
+static void EqzFilter( filter_t *, float *, int, int );
 static void EqzClean( filter_t * );
 
+static vlc_executor_t *HoldGroupExecutor( void );
+static void ReleaseGroupExecutor( vlc_executor_t * );
+
 static int PresetCallback ( vlc_object_t *, char const *, vlc_value_t,
                             vlc_value_t, void * );
 static int PreampCallback ( vlc_object_t *, char const *, vlc_value_t,
@@ -163,6 +177,14 @@ static int Open( vlc_object_t *p_this )
 
     p_filter->fmt_in.audio.i_format = VLC_CODEC_FL32;
     aout_FormatPrepare(&p_filter->fmt_in.audio);
+
+    /* Many channels (surround, ambisonics) are filtered on a thread pool */
+    unsigned i_groups = p_filter->fmt_in.audio.i_channels / EQZ_GROUP_CHANNELS;
+    i_groups = __MIN( i_groups, __MIN( vlc_GetCPUCount(), EQZ_MAX_GROUPS ) );
+    p_sys->executor = NULL;
+    if( i_groups > 1 )
+        p_sys->executor = HoldGroupExecutor();
+    p_sys->i_groups = p_sys->executor != NULL ? i_groups : 1;
     p_filter->fmt_out.audio = p_filter->fmt_in.audio;
     static const struct vlc_filter_operations filter_ops =
     {
@@ -181,6 +203,8 @@ static void Close( filter_t *p_filter )
     filter_sys_t *p_sys = p_filter->p_sys;
 
     EqzClean( p_filter );
+    if( p_sys->executor != NULL )
+        ReleaseGroupExecutor( p_sys->executor );
     free( p_sys );
 }
 
@@ -191,8 +215,7 @@ static void Close( filter_t *p_filter )
  *****************************************************************************/
 static block_t * DoWork( filter_t * p_filter, block_t * p_in_buf )
 {
-    EqzFilter( p_filter, (float*)p_in_buf->p_buffer,
-               (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples,
+    EqzFilter( p_filter, (float*)p_in_buf->p_buffer, p_in_buf->i_nb_samples,
                aout_FormatNbChannels( &p_filter->fmt_in.audio ) );
     return p_in_buf;
 }
@@ -386,21 +409,21 @@ error:
     return i_ret;
 }
 
-static void EqzFilter( filter_t *p_filter, float *out, float *in,
-                       int i_samples, int i_channels )
+/* Filters the channels [i_first, i_last[ in place. The channels do not
+ * share any state, so that groups of channels can be filtered in parallel. */
+static void EqzFilterChannels( filter_sys_t *p_sys, float *buf, int i_samples,
+                               int i_channels, int i_first, int i_last )
 {
-    filter_sys_t *p_sys = p_filter->p_sys;
-    int i, ch, j;
-
-    vlc_mutex_lock( &p_sys->lock );
-    for( i = 0; i < i_samples; i++ )
+    for( int ch = i_first; ch < i_last; ch++ )
     {
-        for( ch = 0; ch < i_channels; ch++ )
+        float *p = &buf[ch];
+
+        for( int i = 0; i < i_samples; i++, p += i_channels )
         {
-            const float x = in[ch];
+            const float x = *p;
             float o = 0.0f;
 
-            for( j = 0; j < p_sys->i_band; j++ )
+            for( int j = 0; j < p_sys->i_band; j++ )
             {
                 float y = p_sys->f_alpha[j] * ( x - p_sys->x[ch][1] ) +
                           p_sys->f_gamma[j] * p_sys->y[ch][j][0] -
@@ -419,7 +442,7 @@ static void EqzFilter( filter_t *p_filter, float *out, float *in,
             {
                 const float x2 = EQZ_IN_FACTOR * x + o;
                 o = 0.0f;
-                for( j = 0; j < p_sys->i_band; j++ )
+                for( int j = 0; j < p_sys->i_band; j++ )
                 {
                     float y = p_sys->f_alpha[j] * ( x2 - p_sys->x2[ch][1] ) +
                               p_sys->f_gamma[j] * p_sys->y2[ch][j][0] -
@@ -434,18 +457,127 @@ static void EqzFilter( filter_t *p_filter, float *out, float *in,
                 p_sys->x2[ch][0] = x2;
 
                 /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp * p_sys->f_gamp *( EQZ_IN_FACTOR * x2 + o );
+                *p = p_sys->f_gamp * p_sys->f_gamp *( EQZ_IN_FACTOR * x2 + o );
             }
             else
             {
                 /* We add source PCM + filtered PCM */
-                out[ch] = p_sys->f_gamp *( EQZ_IN_FACTOR * x + o );
+                *p = p_sys->f_gamp *( EQZ_IN_FACTOR * x + o );
             }
         }
+    }
+}
+
+/*****************************************************************************
+ * Channel group threading
+ *****************************************************************************/
+
+static vlc_mutex_t group_executor_lock = VLC_STATIC_MUTEX;
+static vlc_executor_t *group_executor = NULL;
+static unsigned group_executor_refs = 0;
+
+/* The thread pool is shared by all the equalizer instances */
+static vlc_executor_t *HoldGroupExecutor( void )
+{
+    vlc_mutex_lock( &group_executor_lock );
+    if( group_executor == NULL )
+        group_executor = vlc_executor_New( EQZ_MAX_GROUPS - 1 );
+    if( group_executor != NULL )
+        group_executor_refs++;
+
+    vlc_executor_t *p_executor = group_executor;
+    vlc_mutex_unlock( &group_executor_lock );
+    return p_executor;
+}
+
+static void ReleaseGroupExecutor( vlc_executor_t *p_executor )
+{
+    vlc_mutex_lock( &group_executor_lock );
+    assert( p_executor == group_executor );
+    assert( group_executor_refs > 0 );
+    if( --group_executor_refs == 0 )
+    {
+        vlc_executor_Delete( group_executor );
+        group_executor = NULL;
+    }
+    vlc_mutex_unlock( &group_executor_lock );
+}
 
-        in  += i_channels;
-        out += i_channels;
+struct group_task
+{
+    struct vlc_runnable runnable;
+    filter_sys_t *p_sys;
+    float *buf;
+    int i_samples;
+    int i_channels;
+    int i_first;
+    int i_last;
+    vlc_sem_t *p_done;
+};
+
+static void RunGroup( void *data )
+{
+    struct group_task *p_task = data;
+
+    EqzFilterChannels( p_task->p_sys, p_task->buf, p_task->i_samples,
+                       p_task->i_channels, p_task->i_first, p_task->i_last );
+    vlc_sem_post( p_task->p_done );
+}
+
+static void EqzFilter( filter_t *p_filter, float *buf, int i_samples,
+                       int i_channels )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned i_groups = p_sys->i_groups;
+
+    vlc_mutex_lock( &p_sys->lock );
+    if( i_groups <= 1 )
+    {
+        EqzFilterChannels( p_sys, buf, i_samples, i_channels, 0, i_channels );
+        vlc_mutex_unlock( &p_sys->lock );
+        return;
     }
+
+    assert( p_sys->executor != NULL );
+    assert( i_groups <= EQZ_MAX_GROUPS );
+
+    struct group_task tasks[EQZ_MAX_GROUPS];
+    vlc_sem_t done;
+    vlc_sem_init( &done, 0 );
+
+    for( unsigned i = 1; i < i_groups; i++ )
+    {
+        tasks[i].runnable.run = RunGroup;
+        tasks[i].runnable.userdata = &tasks[i];
+        tasks[i].p_sys = p_sys;
+        tasks[i].buf = buf;
+        tasks[i].i_samples = i_samples;
+        tasks[i].i_channels = i_channels;
+        tasks[i].i_first = i_channels * i / i_groups;
+        tasks[i].i_last = i_channels * ( i + 1 ) / i_groups;
+        tasks[i].p_done = &done;
+        vlc_executor_Submit( p_sys->executor, &tasks[i].runnable );
+    }
+
+    /* Filter the first group ourselves rather than sleeping */
+    EqzFilterChannels( p_sys, buf, i_samples, i_channels,
+                       0, i_channels / i_groups );
+
+    /* Do not wait for the groups still queued behind other instances, so
+     * that the latency does not depend on the load of the pool: take them
+     * back and filter them here */
+    unsigned i_pending = 0;
+    for( unsigned i = 1; i < i_groups; i++ )
+    {
+        if( vlc_executor_Cancel( p_sys->executor, &tasks[i].runnable ) )
+            EqzFilterChannels( p_sys, buf, i_samples, i_channels,
+                               tasks[i].i_first, tasks[i].i_last );
+        else
+            i_pending++;
+    }
+    while( i_pending-- > 0 )
+        vlc_sem_wait( &done );
+
     vlc_mutex_unlock( &p_sys->lock );
 }
 
@@ -0,0 +1,580 @@
+/*****************************************************************************
+ * polyphase.c : polyphase FIR resampler
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble:
+ *
+ * Kaiser-windowed sinc low-pass filter, evaluated from a bank of
+ * precomputed phases. When the input to output rate ratio reduces to a
+ * small enough fraction L/M, the bank holds the L exact phases. Otherwise,
+ * and whenever the input rate is changed on the fly (drift compensation,
+ * playback speed), the taps are interpolated from a finer generic bank.
+ *
+ * Frames are kept interleaved, padded to a multiple of the vector width,
+ * so the filter runs on all the channels of a frame at once.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_cpu.h>
+#include <vlc_filter.h>
+
+static int  Open( vlc_object_t * );
+static int  OpenResampler( vlc_object_t * );
+static void Close( filter_t * );
+
+vlc_module_begin ()
+    set_shortname( N_("Polyphase resampler") )
+    set_description( N_("Polyphase FIR audio resampler") )
+    set_category( CAT_AUDIO )
+    set_subcategory( SUBCAT_AUDIO_RESAMPLER )
+    set_capability( "audio converter", 30 )
+    set_callback( Open )
+
+    add_submodule()
+    set_capability( "audio resampler", 30 )
+    set_callback( OpenResampler )
+    add_shortcut( "polyphase" )
+vlc_module_end ()
+
+#define MIN_TAPS     64   /* per phase, when not decimating */
+#define MAX_TAPS     256
+#define MAX_PHASES   1024 /* of an exact bank */
+#define DYN_BITS     8
+#define DYN_PHASES   (1 << DYN_BITS)
+#define CUTOFF       0.91 /* of the lowest Nyquist frequency */
+#define KAISER_BETA  8.0
+#define FRAME_ALIGN  8    /* floats */
+
+typedef void (*convolve_t)( float *, const float *, const float *,
+                            unsigned, size_t, unsigned );
+
+typedef struct
+{
+    unsigned channels;
+    size_t   stride;     /* floats per frame in the history */
+    unsigned taps;
+
+    /* Nominal rates and exact bank */
+    unsigned in_rate;
+    unsigned out_rate;
+    unsigned phases;     /* L, 0 without an exact bank */
+    unsigned step;       /* M */
+    float   *bank;       /* L phases, NULL if the rates are equal */
+
+    /* Generic bank: DYN_PHASES + 1 phases, for the interpolation */
+    float   *dyn_bank;
+    float   *coefs;
+
+    float   *hist;
+    size_t   hist_size;  /* in frames */
+    size_t   frames;
+    size_t   pos;        /* first frame of the next output */
+    unsigned phase;      /* in 1/L frame, with the exact bank */
+    uint32_t frac;       /* in 2^-32 frame, with the generic bank */
+    bool     dynamic;
+
+    convolve_t convolve;
+} filter_sys_t;
+
+/*****************************************************************************
+ * Filter design
+ *****************************************************************************/
+static double BesselI0( double x )
+{
+    double sum = 1., term = 1.;
+
+    for( unsigned k = 1; term > 1e-12 * sum; k++ )
+    {
+        const double t = x / (2 * k);
+        term *= t * t;
+        sum += term;
+    }
+    return sum;
+}
+
+/**
+ * Computes the taps for an output located frac frame after the center
+ * tap (taps / 2 - 1), normalized to a unity gain.
+ */
+static void ComputeTaps( float *h, unsigned taps, double cutoff, double frac )
+{
+    const double half = taps / 2;
+    const double norm = BesselI0( KAISER_BETA );
+    double sum = 0.;
+
+    for( unsigned k = 0; k < taps; k++ )
+    {
+        const double x = (double)k - (half - 1.) - frac;
+        const double r = x / half;
+        const double w = (r * r < 1.)
+                       ? BesselI0( KAISER_BETA * sqrt( 1. - r * r ) ) / norm : 0.;
+        const double s = (x != 0.) ? sin( M_PI * cutoff * x ) / (M_PI * x)
+                                   : cutoff;
+        h[k] = s * w;
+        sum += h[k];
+    }
+    for( unsigned k = 0; k < taps; k++ )
+        h[k] /= sum;
+}
+
+/*****************************************************************************
+ * Convolution kernels
+ *****************************************************************************
+ * Compute one output frame from taps input frames. Whole vectors are
+ * stored: the output buffer must have room for FRAME_ALIGN more floats.
+ *****************************************************************************/
+static void Convolve_C( float *restrict out, const float *restrict in,
+                        const float *restrict h, unsigned taps,
+                        size_t stride, unsigned channels )
+{
+    for( unsigned c = 0; c < channels; c++ )
+    {
+        const float *x = in + c;
+        float acc = 0.f;
+
+        for( unsigned k = 0; k < taps; k++, x += stride )
+            acc += h[k] * *x;
+        out[c] = acc;
+    }
+}
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+
+__attribute__ ((__target__ ("sse2")))
+static void Convolve_SSE2( float *restrict out, const float *restrict in,
+                           const float *restrict h, unsigned taps,
+                           size_t stride, unsigned channels )
+{
+    for( unsigned c = 0; c < channels; c += 4 )
+    {
+        const float *x = in + c;
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+
+        /* Two accumulators to hide the addition latency */
+        for( unsigned k = 0; k < taps; k += 2, x += 2 * stride )
+        {
+            acc0 = _mm_add_ps( acc0, _mm_mul_ps( _mm_set1_ps( h[k] ),
+                                                 _mm_loadu_ps( x ) ) );
+            acc1 = _mm_add_ps( acc1, _mm_mul_ps( _mm_set1_ps( h[k + 1] ),
+                                                 _mm_loadu_ps( x + stride ) ) );
+        }
+        _mm_storeu_ps( out + c, _mm_add_ps( acc0, acc1 ) );
+    }
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX
+# include <immintrin.h>
+
+__attribute__ ((__target__ ("avx")))
+static void Convolve_AVX( float *restrict out, const float *restrict in,
+                          const float *restrict h, unsigned taps,
+                          size_t stride, unsigned channels )
+{
+    for( unsigned c = 0; c < channels; c += 8 )
+    {
+        const float *x = in + c;
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+
+        for( unsigned k = 0; k < taps; k += 2, x += 2 * stride )
+        {
+            acc0 = _mm256_add_ps( acc0, _mm256_mul_ps( _mm256_set1_ps( h[k] ),
+                                                       _mm256_loadu_ps( x ) ) );
+            acc1 = _mm256_add_ps( acc1, _mm256_mul_ps( _mm256_set1_ps( h[k + 1] ),
+                                                       _mm256_loadu_ps( x + stride ) ) );
+        }
+        _mm256_storeu_ps( out + c, _mm256_add_ps( acc0, acc1 ) );
+    }
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_NEON_KERNELS
+
+static void Convolve_NEON( float *restrict out, const float *restrict in,
+                           const float *restrict h, unsigned taps,
+                           size_t stride, unsigned channels )
+{
+    for( unsigned c = 0; c < channels; c += 4 )
+    {
+        const float *x = in + c;
+        float32x4_t acc0 = vdupq_n_f32( 0.f );
+        float32x4_t acc1 = vdupq_n_f32( 0.f );
+
+        for( unsigned k = 0; k < taps; k += 2, x += 2 * stride )
+        {
+            acc0 = vfmaq_n_f32( acc0, vld1q_f32( x ), h[k] );
+            acc1 = vfmaq_n_f32( acc1, vld1q_f32( x + stride ), h[k + 1] );
+        }
+        vst1q_f32( out + c, vaddq_f32( acc0, acc1 ) );
+    }
+}
+#endif
+
+/*****************************************************************************
+ * History
+ *****************************************************************************/
+static void Reset( filter_sys_t *p_sys )
+{
+    /* Start with half a filter of silence, so that the first output is
+     * aligned with the first input frame */
+    p_sys->frames = p_sys->taps / 2 - 1;
+    memset( p_sys->hist, 0, p_sys->frames * p_sys->stride * sizeof(float) );
+    p_sys->pos = 0;
+    p_sys->phase = 0;
+    p_sys->frac = 0;
+}
+
+static int Append( filter_sys_t *p_sys, const float *in, size_t count )
+{
+    const size_t size = p_sys->frames + count;
+
+    if( size > p_sys->hist_size )
+    {
+        float *hist = realloc( p_sys->hist,
+                               size * p_sys->stride * sizeof(float) );
+        if( unlikely(hist == NULL) )
+            return VLC_ENOMEM;
+        p_sys->hist = hist;
+        p_sys->hist_size = size;
+    }
+
+    float *dst = p_sys->hist + p_sys->frames * p_sys->stride;
+    const size_t padding = p_sys->stride - p_sys->channels;
+    for( size_t i = 0; i < count; i++ )
+    {
+        if( in != NULL )
+        {
+            memcpy( dst, in, p_sys->channels * sizeof(float) );
+            in += p_sys->channels;
+        }
+        else
+            memset( dst, 0, p_sys->channels * sizeof(float) );
+        memset( dst + p_sys->channels, 0, padding * sizeof(float) );
+        dst += p_sys->stride;
+    }
+    p_sys->frames = size;
+    return VLC_SUCCESS;
+}
+
+/**
+ * Switches between the exact and the interpolated positions.
+ */
+static void SetDynamic( filter_sys_t *p_sys, bool dynamic )
+{
+    if( dynamic == p_sys->dynamic )
+        return;
+
+    if( dynamic )
+        p_sys->frac = ((uint64_t)p_sys->phase << 32) / p_sys->phases;
+    else
+    {
+        uint64_t phase = ((uint64_t)p_sys->frac * p_sys->phases
+                          + (UINT64_C(1) << 31)) >> 32;
+        if( phase == p_sys->phases )
+        {
+            phase = 0;
+            p_sys->pos++;
+        }
+        p_sys->phase = phase;
+    }
+    p_sys->dynamic = dynamic;
+}
+
+static block_t *Output( filter_t *p_filter, vlc_tick_t pts )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned in_rate = p_filter->fmt_in.audio.i_rate;
+    const unsigned out_rate = p_filter->fmt_out.audio.i_rate;
+    const unsigned channels = p_sys->channels;
+    const unsigned taps = p_sys->taps;
+    const size_t stride = p_sys->stride;
+
+    SetDynamic( p_sys, p_sys->phases == 0 || in_rate != p_sys->in_rate
+                                          || out_rate != p_sys->out_rate );
+
+    block_t *p_out = NULL;
+    size_t count = 0;
+
+    if( p_sys->pos + taps > p_sys->frames )
+        goto out;
+
+    const size_t max = (p_sys->frames - p_sys->pos - taps + 1)
+                     * (uint64_t)out_rate / in_rate + 2;
+    p_out = block_Alloc( (max * channels + FRAME_ALIGN) * sizeof(float) );
+    if( unlikely(p_out == NULL) )
+        goto out;
+
+    float *dst = (float *)p_out->p_buffer;
+
+    if( p_sys->dynamic )
+    {
+        const uint64_t step = ((uint64_t)in_rate << 32) / out_rate;
+
+        while( p_sys->pos + taps <= p_sys->frames && count < max )
+        {
+            const float *b0 = p_sys->dyn_bank
+                            + (p_sys->frac >> (32 - DYN_BITS)) * taps;
+            const float *b1 = b0 + taps;
+            const float a = (p_sys->frac & ((1 << (32 - DYN_BITS)) - 1))
+                          * (1.f / (1 << (32 - DYN_BITS)));
+
+            for( unsigned k = 0; k < taps; k++ )
+                p_sys->coefs[k] = b0[k] + a * (b1[k] - b0[k]);
+            p_sys->convolve( dst, p_sys->hist + p_sys->pos * stride,
+                             p_sys->coefs, taps, stride, channels );
+            dst += channels;
+            count++;
+
+            const uint64_t t = p_sys->frac + step;
+            p_sys->pos += t >> 32;
+            p_sys->frac = t;
+        }
+    }
+    else if( p_sys->bank == NULL )
+    {   /* Same rates: plain delay */
+        const float *src = p_sys->hist + (taps / 2 - 1) * stride;
+
+        while( p_sys->pos + taps <= p_sys->frames && count < max )
+        {
+            memcpy( dst, src + p_sys->pos * stride, channels * sizeof(float) );
+            dst += channels;
+            count++;
+            p_sys->pos++;
+        }
+    }
+    else
+    {
+        while( p_sys->pos + taps <= p_sys->frames && count < max )
+        {
+            p_sys->convolve( dst, p_sys->hist + p_sys->pos * stride,
+                             p_sys->bank + p_sys->phase * taps, taps,
+                             stride, channels );
+            dst += channels;
+            count++;
+
+            p_sys->phase += p_sys->step;
+            p_sys->pos += p_sys->phase / p_sys->phases;
+            p_sys->phase %= p_sys->phases;
+        }
+    }
+
+    p_out->i_buffer = count * channels * sizeof(float);
+    p_out->i_nb_samples = count;
+    p_out->i_pts = pts;
+    p_out->i_length = vlc_tick_from_samples( count, out_rate );
+
+out:
+    /* Drop the frames no longer needed */
+    {
+        const size_t drop = __MIN( p_sys->pos, p_sys->frames );
+
+        memmove( p_sys->hist, p_sys->hist + drop * stride,
+                 (p_sys->frames - drop) * stride * sizeof(float) );
+        p_sys->frames -= drop;
+        p_sys->pos -= drop;
+    }
+
+    if( p_out != NULL && count == 0 )
+    {
+        block_Release( p_out );
+        p_out = NULL;
+    }
+    return p_out;
+}
+
+/*****************************************************************************
+ * Filter callbacks
+ *****************************************************************************/
+static block_t *Resample( filter_t *p_filter, block_t *p_in )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    if( p_in->i_flags & BLOCK_FLAG_DISCONTINUITY )
+        Reset( p_sys );
+
+    const vlc_tick_t pts = p_in->i_pts;
+    int ret = Append( p_sys, (const float *)p_in->p_buffer,
+                      p_in->i_nb_samples );
+    block_Release( p_in );
+    if( ret != VLC_SUCCESS )
+        return NULL;
+
+    return Output( p_filter, pts );
+}
+
+static block_t *Drain( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    /* Push silence until the last input frame reaches the filter center */
+    if( Append( p_sys, NULL, p_sys->taps / 2 ) != VLC_SUCCESS )
+        return NULL;
+
+    block_t *p_out = Output( p_filter, VLC_TICK_INVALID );
+    Reset( p_sys );
+    return p_out;
+}
+
+static void Flush( filter_t *p_filter )
+{
+    Reset( p_filter->p_sys );
+}
+
+static int OpenResampler( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t *)p_this;
+    const audio_format_t *fmt_in = &p_filter->fmt_in.audio;
+    const audio_format_t *fmt_out = &p_filter->fmt_out.audio;
+
+    if( fmt_in->i_format != VLC_CODEC_FL32
+     || fmt_out->i_format != VLC_CODEC_FL32
+    /* Cannot remix */
+     || fmt_in->i_channels != fmt_out->i_channels
+     || fmt_in->i_channels == 0
+     || fmt_in->i_rate == 0 || fmt_out->i_rate == 0 )
+        return VLC_EGENERIC;
+
+    filter_sys_t *p_sys = calloc( 1, sizeof(*p_sys) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    const unsigned in_rate = fmt_in->i_rate;
+    const unsigned out_rate = fmt_out->i_rate;
+    const double ratio = (double)out_rate / in_rate;
+
+    /* Longer filters when decimating, to keep the same transition band */
+    unsigned taps = MIN_TAPS;
+    if( ratio < 1. )
+        taps = __MIN( ceil( MIN_TAPS / ratio / 4. ) * 4, MAX_TAPS );
+    const double cutoff = CUTOFF * __MIN( ratio, 1. );
+
+    p_sys->channels = fmt_in->i_channels;
+    p_sys->stride = (p_sys->channels + FRAME_ALIGN - 1) & ~(FRAME_ALIGN - 1);
+    p_sys->taps = taps;
+    p_sys->in_rate = in_rate;
+    p_sys->out_rate = out_rate;
+
+    unsigned a = in_rate, b = out_rate;
+    while( b != 0 )
+    {
+        unsigned r = a % b;
+        a = b;
+        b = r;
+    }
+    if( in_rate == out_rate )
+        p_sys->phases = p_sys->step = 1;
+    else if( out_rate / a <= MAX_PHASES )
+    {
+        p_sys->phases = out_rate / a;
+        p_sys->step = in_rate / a;
+        p_sys->bank = vlc_alloc( p_sys->phases * taps, sizeof(float) );
+        if( unlikely(p_sys->bank == NULL) )
+            goto error;
+        for( unsigned i = 0; i < p_sys->phases; i++ )
+            ComputeTaps( p_sys->bank + i * taps, taps, cutoff,
+                         (double)i / p_sys->phases );
+    }
+    p_sys->dynamic = p_sys->phases == 0;
+
+    p_sys->dyn_bank = vlc_alloc( (DYN_PHASES + 1) * taps, sizeof(float) );
+    p_sys->coefs = vlc_alloc( taps, sizeof(float) );
+    p_sys->hist_size = taps;
+    p_sys->hist = vlc_alloc( p_sys->hist_size * p_sys->stride, sizeof(float) );
+    if( unlikely(p_sys->dyn_bank == NULL || p_sys->coefs == NULL
+              || p_sys->hist == NULL) )
+        goto error;
+    for( unsigned i = 0; i <= DYN_PHASES; i++ )
+        ComputeTaps( p_sys->dyn_bank + i * taps, taps, cutoff,
+                     (double)i / DYN_PHASES );
+
+    p_sys->convolve = Convolve_C;
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
+        p_sys->convolve = Convolve_SSE2;
+#endif
+#ifdef CAN_COMPILE_AVX
+    if( vlc_CPU_AVX() )
+        p_sys->convolve = Convolve_AVX;
+#endif
+#ifdef CAN_COMPILE_NEON_KERNELS
+    if( vlc_CPU_ARM_NEON() )
+        p_sys->convolve = Convolve_NEON;
+#endif
+
+    Reset( p_sys );
+
+    msg_Dbg( p_filter, "%u Hz -> %u Hz, %u taps, %u phases", in_rate,
+             out_rate, taps, p_sys->bank ? p_sys->phases : DYN_PHASES );
+
+    static const struct vlc_filter_operations filter_ops =
+    {
+        .filter_audio = Resample,
+        .drain_audio = Drain,
+        .flush = Flush,
+        .close = Close,
+    };
+    p_filter->ops = &filter_ops;
+    p_filter->p_sys = p_sys;
+    return VLC_SUCCESS;
+
+error:
+    free( p_sys->hist );
+    free( p_sys->coefs );
+    free( p_sys->dyn_bank );
+    free( p_sys->bank );
+    free( p_sys );
+    return VLC_ENOMEM;
+}
+
+static int Open( vlc_object_t *p_this )
+{
+    filter_t *p_filter = (filter_t *)p_this;
+
+    if( p_filter->fmt_in.audio.i_rate == p_filter->fmt_out.audio.i_rate )
+        return VLC_EGENERIC;
+    return OpenResampler( p_this );
+}
+
+static void Close( filter_t *p_filter )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+
+    free( p_sys->hist );
+    free( p_sys->coefs );
+    free( p_sys->dyn_bank );
+    free( p_sys->bank );
+    free( p_sys );
+}
@@ -30,6 +30,7 @@
 #include <vlc_common.h>
 #include <vlc_plugin.h>
 #include <vlc_aout.h>
+#include <vlc_fft.h>
 #include <vlc_filter.h>
 #include <vlc_modules.h>
 
@@ -68,6 +69,11 @@ vlc_module_begin ()
         N_("Overlap Length"), N_("Percentage of stride to overlap"), true )
     add_integer_with_range( "scaletempo-search", 14, 0, 200,
         N_("Search Length"), N_("Length in milliseconds to search for best overlap position"), true )
+    add_bool( "scaletempo-multires", false,
+        N_("Multi-resolution search"),
+        N_("Search the best overlap position on a decimated signal first, "
+           "then refine it at full resolution. The search length grows with "
+           "the playback rate, up to 4 times, for about the same cost."), true )
 #ifdef PITCH_SHIFTER
     add_float_with_range( "pitch-shift", 0, -12, 12,
         N_("Pitch Shift"), N_("Pitch shift in semitones."), false )
@@ -129,6 +135,13 @@ typedef struct
     void     *buf_pre_corr;
     void     *table_window;
     unsigned(*best_overlap_offset)( filter_t *p_filter );
+    /* best overlap through FFT, when cheaper than the direct search */
+    vlc_rdft_t *fft;
+    float    *buf_fft;
+    /* multi-resolution best overlap */
+    bool      multires;
+    unsigned  frames_search_base;
+    float    *buf_multires;
 #ifdef PITCH_SHIFTER
     /* pitch */
     filter_t * resampler;
@@ -173,6 +186,202 @@ static unsigned best_overlap_offset_float( filter_t *p_filter )
     return best_off * p->bytes_per_frame;
 }
 
+/* Same search as best_overlap_offset_float(), with all the correlations
+ * computed at once in the frequency domain */
+static unsigned best_overlap_offset_fft( filter_t *p_filter )
+{
+    filter_sys_t *p = p_filter->p_sys;
+    const size_t n = vlc_rdft_GetSize( p->fft );
+    const unsigned samples_corr = p->samples_overlap - p->samples_per_frame;
+    const unsigned samples_queue = samples_corr
+                                 + ( p->frames_search - 1 ) * p->samples_per_frame;
+    float *pc = p->buf_fft;
+    float *pq = pc + n;
+    float *spc = pq + n;
+    float *spq = spc + n + 2;
+    const float *pw = p->table_window;
+    const float *po = (const float *)p->buf_overlap + p->samples_per_frame;
+    float best_corr = INT_MIN;
+    unsigned best_off = 0;
+    unsigned i, off;
+
+    /* Zero-padded, so that the correlations do not wrap around */
+    for( i = 0; i < samples_corr; i++ )
+        pc[i] = pw[i] * po[i];
+    memset( pc + samples_corr, 0, ( n - samples_corr ) * sizeof (*pc) );
+    memcpy( pq, (float *)p->buf_queue + p->samples_per_frame,
+            samples_queue * sizeof (*pq) );
+    memset( pq + samples_queue, 0, ( n - samples_queue ) * sizeof (*pq) );
+
+    vlc_rdft_Forward( p->fft, pc, spc );
+    vlc_rdft_Forward( p->fft, pq, spq );
+    vlc_rdft_Correlate( p->fft, spc, spq, spc );
+    vlc_rdft_Inverse( p->fft, spc, pc );
+
+    for( off = 0; off < p->frames_search; off++ ) {
+      float corr = pc[off * p->samples_per_frame];
+      if( corr > best_corr ) {
+        best_corr = corr;
+        best_off  = off;
+      }
+    }
+
+    return best_off * p->bytes_per_frame;
+}
+
+/* Multi-resolution search: candidates within a large search window are
+ * first compared on a mono signal decimated by a power of 4, then the best
+ * one is refined at each finer resolution in turn, the last time on all the
+ * channels. The cost depends little on the length of the search window. */
+#define MULTIRES_FACTOR     4
+#define MULTIRES_CANDIDATES 64  /* upper bound at the coarsest resolution */
+#define MULTIRES_MIN_CORR   8   /* frames correlated at the coarsest resolution */
+#define MULTIRES_MAX_LEVELS 8
+#define MULTIRES_MAX_SCALE  4
+
+static float dot_product( const float *restrict a, const float *restrict b,
+                          unsigned count )
+{
+    float sum = 0.f;
+    for( unsigned i = 0; i < count; i++ )
+        sum += a[i] * b[i];
+    return sum;
+}
+
+/* Sums each group of MULTIRES_FACTOR values, as a crude low-pass filter */
+static void decimate( const float *restrict in, float *restrict out,
+                      unsigned count )
+{
+    for( unsigned i = 0; i < count; i++ )
+    {
+        float sum = 0.f;
+        for( unsigned j = 0; j < MULTIRES_FACTOR; j++ )
+            sum += in[i * MULTIRES_FACTOR + j];
+        out[i] = sum;
+    }
+}
+
+static unsigned best_overlap_offset_multires( filter_t *p_filter )
+{
+    filter_sys_t *p = p_filter->p_sys;
+    const unsigned channels = p->samples_per_frame;
+    const unsigned samples_corr = p->samples_overlap - channels;
+    const unsigned frames_corr = samples_corr / channels;
+    const float *pw = p->table_window;
+    const float *po = (const float *)p->buf_overlap + channels;
+    const float *pq = (const float *)p->buf_queue + channels;
+    float *ppc = p->buf_pre_corr;
+    unsigned decim = 1, levels = 1;
+    unsigned i, c;
+
+    while( levels < MULTIRES_MAX_LEVELS
+        && frames_corr / ( decim * MULTIRES_FACTOR ) >= MULTIRES_MIN_CORR
+        && p->frames_search / decim > MULTIRES_CANDIDATES )
+    {
+        decim *= MULTIRES_FACTOR;
+        levels++;
+    }
+
+    if( levels == 1 )
+        return best_overlap_offset_float( p_filter );
+
+    for( i = 0; i < samples_corr; i++ )
+        ppc[i] = pw[i] * po[i];
+
+    /* Mono pyramids of the windowed overlap and of the search window, from
+     * the full resolution to the coarsest one */
+    float *lo[MULTIRES_MAX_LEVELS], *lq[MULTIRES_MAX_LEVELS];
+    unsigned len_o[MULTIRES_MAX_LEVELS], len_q[MULTIRES_MAX_LEVELS];
+
+    len_o[0] = frames_corr;
+    len_q[0] = p->frames_search - 1 + frames_corr;
+    lo[0] = p->buf_multires;
+    lq[0] = lo[0] + len_o[0];
+    for( i = 0; i < len_o[0]; i++ )
+    {
+        float sum = 0.f;
+        for( c = 0; c < channels; c++ )
+            sum += ppc[i * channels + c];
+        lo[0][i] = sum;
+    }
+    for( i = 0; i < len_q[0]; i++ )
+    {
+        float sum = 0.f;
+        for( c = 0; c < channels; c++ )
+            sum += pq[i * channels + c];
+        lq[0][i] = sum;
+    }
+
+    for( unsigned l = 1; l < levels; l++ )
+    {
+        len_o[l] = len_o[l - 1] / MULTIRES_FACTOR;
+        len_q[l] = len_q[l - 1] / MULTIRES_FACTOR;
+        lo[l] = lq[l - 1] + len_q[l - 1];
+        lq[l] = lo[l] + len_o[l];
+        decimate( lo[l - 1], lo[l], len_o[l] );
+        decimate( lq[l - 1], lq[l], len_q[l] );
+    }
+
+    /* Whole window at the coarsest resolution */
+    unsigned l = levels - 1;
+    float best_corr = INT_MIN;
+    unsigned best_off = 0;
+    for( unsigned off = 0; off < p->frames_search; off += decim )
+    {
+        float corr = dot_product( lo[l], &lq[l][off / decim], len_o[l] );
+        if( corr > best_corr )
+        {
+            best_corr = corr;
+            best_off  = off;
+        }
+    }
+
+    /* Neighbourhood of the best offset at each finer resolution */
+    while( l-- > 0 )
+    {
+        const unsigned prev = best_off;
+        const int span = MULTIRES_FACTOR - 1;
+
+        decim /= MULTIRES_FACTOR;
+        best_corr = INT_MIN;
+        for( int m = -span; m <= span; m++ )
+        {
+            int off = (int)prev + m * (int)decim;
+            if( off < 0 || (unsigned)off >= p->frames_search )
+                continue;
+
+            float corr = l > 0
+                ? dot_product( lo[l], &lq[l][off / decim], len_o[l] )
+                : dot_product( ppc, &pq[off * channels], samples_corr );
+            if( corr > best_corr )
+            {
+                best_corr = corr;
+                best_off  = off;
+            }
+        }
+    }
+
+    return best_off * p->bytes_per_frame;
+}
+
+/* Grows the search window with the playback rate, within the queue
+ * allocated for the largest one */
+static void multires_set_scale( filter_sys_t *p )
+{
+    double scale = VLC_CLIP( p->scale, 1., MULTIRES_MAX_SCALE );
+
+    p->frames_search   = p->frames_search_base * scale;
+    p->bytes_queue_max = p->frames_search * p->bytes_per_frame
+                       + p->bytes_stride + p->bytes_overlap;
+    if( p->bytes_queued > p->bytes_queue_max )
+    {
+        memmove( p->buf_queue,
+                 p->buf_queue + p->bytes_queued - p->bytes_queue_max,
+                 p->bytes_queue_max );
+        p->bytes_queued = p->bytes_queue_max;
+    }
+}
+
 /*****************************************************************************
  * output_overlap: blend end of previous stride with beginning of current stride
  *****************************************************************************/
@@ -333,6 +542,8 @@ static int reinit_buffers( filter_t *p_filter )
 
     /* best overlap */
     p->frames_search = ( frames_overlap <= 1 ) ? 0 : p->ms_search * p->sample_rate / 1000.0;
+    p->frames_search_base = p->frames_search;
+    unsigned frames_search_max = p->frames_search;
     if( p->frames_search < 1 )
     { /* if no search */
         p->best_overlap_offset = NULL;
@@ -352,9 +563,38 @@ static int reinit_buffers( filter_t *p_filter )
                 *pw++ = v;
         }
         p->best_overlap_offset = best_overlap_offset_float;
+
+        if( p->multires )
+        {
+            frames_search_max = p->frames_search * MULTIRES_MAX_SCALE;
+            p->buf_multires = vlc_alloc( 2 * ( frames_search_max + 2 * frames_overlap ),
+                                         sizeof (float) );
+            if( !p->buf_multires )
+                return VLC_ENOMEM;
+            p->best_overlap_offset = best_overlap_offset_multires;
+        }
+
+        /* The direct search costs a product per sample and per frame
+         * searched, the FFT about 3 transforms of the whole window */
+        unsigned samples_corr = p->samples_overlap - p->samples_per_frame;
+        size_t n = 4, log2n = 2;
+        while( n < samples_corr + ( p->frames_search - 1 ) * p->samples_per_frame )
+        {
+            n <<= 1;
+            log2n++;
+        }
+        if( !p->multires
+         && (size_t)p->frames_search * samples_corr > 4 * n * log2n )
+        {
+            p->fft = vlc_rdft_Hold( n );
+            p->buf_fft = vlc_alloc( 4 * n + 4, sizeof (float) );
+            if( !p->fft || !p->buf_fft )
+                return VLC_ENOMEM;
+            p->best_overlap_offset = best_overlap_offset_fft;
+        }
     }
 
-    unsigned new_size = ( p->frames_search + frames_stride + frames_overlap ) * p->bytes_per_frame;
+    unsigned new_size = ( frames_search_max + frames_stride + frames_overlap ) * p->bytes_per_frame;
     if( p->bytes_queued > new_size )
     {
         if( p->bytes_to_slide > p->bytes_queued )
@@ -377,6 +617,9 @@ static int reinit_buffers( filter_t *p_filter )
     if( ! p->buf_queue )
         return VLC_ENOMEM;
 
+    if( p->best_overlap_offset == best_overlap_offset_multires )
+        multires_set_scale( p );
+
     p->bytes_stride_scaled  = p->bytes_stride * p->scale;
     p->frames_stride_scaled = p->bytes_stride_scaled / p->bytes_per_frame;
 
@@ -421,6 +664,7 @@ static int Open( vlc_object_t *p_this )
     p_sys->ms_stride       = var_InheritInteger( p_this, "scaletempo-stride" );
     p_sys->percent_overlap = var_InheritFloat( p_this, "scaletempo-overlap" );
     p_sys->ms_search       = var_InheritInteger( p_this, "scaletempo-search" );
+    p_sys->multires        = var_InheritBool( p_this, "scaletempo-multires" );
 
     msg_Dbg( p_this, "params: %i stride, %.3f overlap, %i search",
              p_sys->ms_stride, p_sys->percent_overlap, p_sys->ms_search );
@@ -430,6 +674,9 @@ static int Open( vlc_object_t *p_this )
     p_sys->table_blend    = NULL;
     p_sys->buf_pre_corr   = NULL;
     p_sys->table_window   = NULL;
+    p_sys->fft            = NULL;
+    p_sys->buf_fft        = NULL;
+    p_sys->buf_multires   = NULL;
     p_sys->bytes_overlap  = 0;
     p_sys->bytes_queued   = 0;
     p_sys->bytes_to_slide = 0;
@@ -533,6 +780,10 @@ static void Close( filter_t *p_filter )
     free( p_sys->table_blend );
     free( p_sys->buf_pre_corr );
     free( p_sys->table_window );
+    if( p_sys->fft )
+        vlc_rdft_Release( p_sys->fft );
+    free( p_sys->buf_fft );
+    free( p_sys->buf_multires );
     free( p_sys );
 }
 
@@ -566,6 +817,8 @@ static block_t *DoWork( filter_t * p_filter, block_t * p_in_buf )
         p->bytes_stride_scaled  = p->bytes_stride * p->scale;
         p->frames_stride_scaled = p->bytes_stride_scaled / p->bytes_per_frame;
         p->bytes_to_slide = 0;
+        if( p->best_overlap_offset == best_overlap_offset_multires )
+            multires_set_scale( p );
         msg_Dbg( p_filter, "%.3f scale, %.3f stride_in, %i stride_out rate: %u",
                  p->scale, p->frames_stride_scaled,
                  (int)( p->bytes_stride / p->bytes_per_frame ), p->sample_rate );
@@ -29,8 +29,11 @@
 #endif
 
 #include <stddef.h>
+#include <float.h>
+#include <math.h>
 #include <vlc_common.h>
 #include <vlc_plugin.h>
+#include <vlc_cpu.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
 
@@ -50,6 +53,91 @@ vlc_module_begin ()
     set_callback( Create )
 vlc_module_end ()
 
+/* Samples whose magnitude falls below FLT_MIN after scaling are flushed to
+ * zero: denormals would slow down every following filter */
+static void AmplifyFL32_C( float *p, size_t n, float f_multiplier )
+{
+    for( size_t i = 0; i < n; i++ )
+    {
+        float s = p[i] * f_multiplier;
+        p[i] = fabsf( s ) >= FLT_MIN ? s : 0.f;
+    }
+}
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+
+__attribute__ ((__target__ ("sse2")))
+static void AmplifyFL32_SSE2( float *p, size_t n, float f_multiplier )
+{
+    const __m128 mult = _mm_set1_ps( f_multiplier );
+    const __m128 abs = _mm_castsi128_ps( _mm_set1_epi32( 0x7fffffff ) );
+    const __m128 min = _mm_set1_ps( FLT_MIN );
+    size_t i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        __m128 a = _mm_mul_ps( _mm_loadu_ps( p + i ), mult );
+        __m128 b = _mm_mul_ps( _mm_loadu_ps( p + i + 4 ), mult );
+        a = _mm_and_ps( a, _mm_cmpge_ps( _mm_and_ps( a, abs ), min ) );
+        b = _mm_and_ps( b, _mm_cmpge_ps( _mm_and_ps( b, abs ), min ) );
+        _mm_storeu_ps( p + i, a );
+        _mm_storeu_ps( p + i + 4, b );
+    }
+    AmplifyFL32_C( p + i, n - i, f_multiplier );
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+# include <immintrin.h>
+
+__attribute__ ((__target__ ("avx2")))
+static void AmplifyFL32_AVX2( float *p, size_t n, float f_multiplier )
+{
+    const __m256 mult = _mm256_set1_ps( f_multiplier );
+    const __m256 abs = _mm256_castsi256_ps( _mm256_set1_epi32( 0x7fffffff ) );
+    const __m256 min = _mm256_set1_ps( FLT_MIN );
+    size_t i = 0;
+
+    for( ; i + 16 <= n; i += 16 )
+    {
+        __m256 a = _mm256_mul_ps( _mm256_loadu_ps( p + i ), mult );
+        __m256 b = _mm256_mul_ps( _mm256_loadu_ps( p + i + 8 ), mult );
+        a = _mm256_and_ps( a, _mm256_cmp_ps( _mm256_and_ps( a, abs ), min,
+                                             _CMP_GE_OQ ) );
+        b = _mm256_and_ps( b, _mm256_cmp_ps( _mm256_and_ps( b, abs ), min,
+                                             _CMP_GE_OQ ) );
+        _mm256_storeu_ps( p + i, a );
+        _mm256_storeu_ps( p + i + 8, b );
+    }
+    AmplifyFL32_C( p + i, n - i, f_multiplier );
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_NEON_KERNELS
+
+static void AmplifyFL32_NEON( float *p, size_t n, float f_multiplier )
+{
+    const float32x4_t min = vdupq_n_f32( FLT_MIN );
+    size_t i = 0;
+
+    for( ; i + 8 <= n; i += 8 )
+    {
+        float32x4_t a = vmulq_n_f32( vld1q_f32( p + i ), f_multiplier );
+        float32x4_t b = vmulq_n_f32( vld1q_f32( p + i + 4 ), f_multiplier );
+        a = vreinterpretq_f32_u32( vandq_u32( vreinterpretq_u32_f32( a ),
+                                              vcageq_f32( a, min ) ) );
+        b = vreinterpretq_f32_u32( vandq_u32( vreinterpretq_u32_f32( b ),
+                                              vcageq_f32( b, min ) ) );
+        vst1q_f32( p + i, a );
+        vst1q_f32( p + i + 4, b );
+    }
+    AmplifyFL32_C( p + i, n - i, f_multiplier );
+}
+#endif
+
 /**
  * Mixes a new output buffer
  */
@@ -60,8 +148,24 @@ static void FilterFL32( audio_volume_t *p_volume, block_t *p_buffer,
         return; /* nothing to do */
 
     float *p = (float *)p_buffer->p_buffer;
-    for( size_t i = p_buffer->i_buffer / sizeof(*p); i > 0; i-- )
-        *(p++) *= f_multiplier;
+    size_t n = p_buffer->i_buffer / sizeof(*p);
+
+#ifdef CAN_COMPILE_AVX2
+    if( vlc_CPU_AVX2() )
+        AmplifyFL32_AVX2( p, n, f_multiplier );
+    else
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
+        AmplifyFL32_SSE2( p, n, f_multiplier );
+    else
+#endif
+#ifdef CAN_COMPILE_NEON_KERNELS
+    if( vlc_CPU_ARM_NEON() )
+        AmplifyFL32_NEON( p, n, f_multiplier );
+    else
+#endif
+        AmplifyFL32_C( p, n, f_multiplier );
 
     (void) p_volume;
 }
@@ -27,6 +27,7 @@
 
 #include <vlc_common.h>
 #include <vlc_plugin.h>
+#include <vlc_cpu.h>
 #include <vlc_aout.h>
 #include <vlc_aout_volume.h>
 
@@ -61,24 +62,117 @@ static void FilterS32N (audio_volume_t *vol, block_t *block, float volume)
     (void) vol;
 }
 
-static void FilterS16N (audio_volume_t *vol, block_t *block, float volume)
+static void AmplifyS16N_C (int16_t *p, size_t n, int_fast16_t mult)
 {
-    int16_t *p = (int16_t *)block->p_buffer;
-
-    int_fast16_t mult = lroundf (volume * 0x1.p8f);
-    if (mult == (1 << 8))
-        return;
-
-    for (size_t n = block->i_buffer / sizeof (*p); n > 0; n--)
+    for (size_t i = 0; i < n; i++)
     {
-        int_fast32_t s = (*p * (int_fast32_t)mult) >> 8;
+        int_fast32_t s = (p[i] * (int_fast32_t)mult) >> 8;
         if (s > INT16_MAX)
             s = INT16_MAX;
         else
         if (s < INT16_MIN)
             s = INT16_MIN;
-        *(p++) = s;
+        p[i] = s;
+    }
+}
+
+#ifdef CAN_COMPILE_SSE2
+# include <emmintrin.h>
+
+__attribute__ ((__target__ ("sse2")))
+static void AmplifyS16N_SSE2 (int16_t *p, size_t n, int_fast16_t mult)
+{
+    const __m128i m = _mm_set1_epi16 (mult);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        __m128i v = _mm_loadu_si128 ((const __m128i *)(p + i));
+        __m128i lo = _mm_mullo_epi16 (v, m);
+        __m128i hi = _mm_mulhi_epi16 (v, m);
+        /* 32-bits products, packed back with saturation */
+        __m128i a = _mm_srai_epi32 (_mm_unpacklo_epi16 (lo, hi), 8);
+        __m128i b = _mm_srai_epi32 (_mm_unpackhi_epi16 (lo, hi), 8);
+        _mm_storeu_si128 ((__m128i *)(p + i), _mm_packs_epi32 (a, b));
+    }
+    AmplifyS16N_C (p + i, n - i, mult);
+}
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+# include <immintrin.h>
+
+__attribute__ ((__target__ ("avx2")))
+static void AmplifyS16N_AVX2 (int16_t *p, size_t n, int_fast16_t mult)
+{
+    const __m256i m = _mm256_set1_epi16 (mult);
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m256i v = _mm256_loadu_si256 ((const __m256i *)(p + i));
+        __m256i lo = _mm256_mullo_epi16 (v, m);
+        __m256i hi = _mm256_mulhi_epi16 (v, m);
+        /* Unpacking and packing both work within 128-bits lanes, so the
+         * samples end up in order */
+        __m256i a = _mm256_srai_epi32 (_mm256_unpacklo_epi16 (lo, hi), 8);
+        __m256i b = _mm256_srai_epi32 (_mm256_unpackhi_epi16 (lo, hi), 8);
+        _mm256_storeu_si256 ((__m256i *)(p + i), _mm256_packs_epi32 (a, b));
+    }
+    AmplifyS16N_C (p + i, n - i, mult);
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+# include <arm_neon.h>
+# define CAN_COMPILE_NEON_KERNELS
+
+static void AmplifyS16N_NEON (int16_t *p, size_t n, int_fast16_t mult)
+{
+    const int16x4_t m = vdup_n_s16 (mult);
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        int16x8_t v = vld1q_s16 (p + i);
+        int32x4_t a = vmull_s16 (vget_low_s16 (v), m);
+        int32x4_t b = vmull_high_s16 (v, vcombine_s16 (m, m));
+        vst1q_s16 (p + i, vcombine_s16 (vqshrn_n_s32 (a, 8),
+                                        vqshrn_n_s32 (b, 8)));
     }
+    AmplifyS16N_C (p + i, n - i, mult);
+}
+#endif
+
+static void FilterS16N (audio_volume_t *vol, block_t *block, float volume)
+{
+    int16_t *p = (int16_t *)block->p_buffer;
+    size_t n = block->i_buffer / sizeof (*p);
+
+    int_fast16_t mult = lroundf (volume * 0x1.p8f);
+    if (mult == (1 << 8))
+        return;
+
+    /* The vector kernels need the multiplier to fit in a sample */
+    if (mult > INT16_MAX)
+        AmplifyS16N_C (p, n, mult);
+    else
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2 ())
+        AmplifyS16N_AVX2 (p, n, mult);
+    else
+#endif
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2 ())
+        AmplifyS16N_SSE2 (p, n, mult);
+    else
+#endif
+#ifdef CAN_COMPILE_NEON_KERNELS
+    if (vlc_CPU_ARM_NEON ())
+        AmplifyS16N_NEON (p, n, mult);
+    else
+#endif
+        AmplifyS16N_C (p, n, mult);
     (void) vol;
 }
 
@@ -522,8 +522,13 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
     sys->rate = fmt->i_rate;
 
+    /* In low delay mode, keep only a few short periods in the device, so that
+     * Play() blocks until the device needs more samples */
+    const bool low_delay = passthrough == PASSTHROUGH_NONE
+                        && var_InheritBool(aout, "low-delay");
+
 #if 1 /* work-around for period-long latency outputs (e.g. PulseAudio): */
-    param = AOUT_MIN_PREPARE_TIME;
+    param = low_delay ? AOUT_MIN_PREPARE_TIME / 4 : AOUT_MIN_PREPARE_TIME;
     val = snd_pcm_hw_params_set_period_time_near (pcm, hw, &param, NULL);
     if (val)
     {
@@ -532,7 +537,7 @@ static int Start (audio_output_t *aout, audio_sample_format_t *restrict fmt)
     }
 #endif
     /* Set buffer size */
-    param = AOUT_MAX_ADVANCE_TIME;
+    param = low_delay ? AOUT_MIN_PREPARE_TIME : AOUT_MAX_ADVANCE_TIME;
     val = snd_pcm_hw_params_set_buffer_time_near (pcm, hw, &param, NULL);
     if (val)
     {
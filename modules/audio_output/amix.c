@@ -0,0 +1,535 @@
+/*****************************************************************************
+ * amix.c : shared software mixer audio output
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <stdatomic.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_aout.h>
+#include <vlc_list.h>
+#include <vlc_modules.h>
+
+static int Open (vlc_object_t *);
+static void Close (vlc_object_t *);
+
+#define OUTPUT_TEXT N_("Mixed audio output module")
+#define OUTPUT_LONGTEXT N_("Audio output module that plays the mixed " \
+    "streams.")
+#define RATE_TEXT N_("Mixing sample rate")
+#define RATE_LONGTEXT N_("Sample rate of the mixed stream. Each input is " \
+    "resampled to this rate.")
+
+vlc_module_begin ()
+    set_shortname (N_("Audio mixer"))
+    set_description (N_("Shared software mixer audio output"))
+    set_capability ("audio output", 0)
+    set_category (CAT_AUDIO)
+    set_subcategory (SUBCAT_AUDIO_AOUT)
+    add_module ("amix-output", "audio output", "any",
+                OUTPUT_TEXT, OUTPUT_LONGTEXT)
+    add_integer_with_range ("amix-rate", 48000, 8000, 192000,
+                            RATE_TEXT, RATE_LONGTEXT, true)
+    set_callbacks (Open, Close)
+vlc_module_end ()
+
+/*
+ * All the audio outputs of a LibVLC instance using this module feed a single
+ * mixer, which plays on a single stream of the real audio output.
+ *
+ * Each input is converted and resampled by its own audio output core to the
+ * format of the mixed stream. The mixer thread then sums a period of every
+ * input at a time, with the gain of the input, and queues it to the real
+ * output a few periods before it is due.
+ */
+#define AMIX_PERIOD  VLC_TICK_FROM_MS(10)
+#define AMIX_LEAD    (3 * AMIX_PERIOD) /* mixed samples queued ahead */
+#define AMIX_MAX_QUEUE AOUT_MAX_ADVANCE_TIME /* per input */
+
+struct amix
+{
+    struct vlc_list node;
+    libvlc_int_t *libvlc;
+    unsigned refs;
+
+    audio_output_t *sink;
+    module_t *module;
+    audio_sample_format_t fmt;
+    unsigned period; /* frames */
+
+    vlc_mutex_t lock;
+    vlc_cond_t wait;
+    struct vlc_list inputs;
+    vlc_tick_t sink_delay; /* delay of the sink... */
+    vlc_tick_t sink_date;  /* ...when it was measured */
+    bool stop;
+    vlc_thread_t thread;
+};
+
+typedef struct
+{
+    struct vlc_list node;
+    struct amix *mixer;
+
+    block_t *queue; /* protected by the mixer lock */
+    block_t **queue_last;
+    size_t queued; /* frames */
+    bool paused;
+
+    _Atomic float gain;
+    float volume;
+    bool mute;
+} aout_sys_t;
+
+static vlc_mutex_t amix_lock = VLC_STATIC_MUTEX;
+static struct vlc_list amix_list = VLC_LIST_INITIALIZER(&amix_list);
+
+/* Adds up to frames frames of the input to out, and consumes them */
+static size_t MixInput(aout_sys_t *in, float *restrict out, size_t frames,
+                       unsigned channels)
+{
+    const float gain = atomic_load_explicit(&in->gain, memory_order_relaxed);
+    size_t done = 0;
+
+    while (done < frames && in->queue != NULL)
+    {
+        block_t *block = in->queue;
+        size_t count = __MIN(frames - done, block->i_nb_samples);
+        const float *restrict src = (const float *)block->p_buffer;
+        float *restrict dst = out + done * channels;
+
+        for (size_t i = 0; i < count * channels; i++)
+            dst[i] += gain * src[i];
+
+        block->p_buffer += count * channels * sizeof (float);
+        block->i_buffer -= count * channels * sizeof (float);
+        block->i_nb_samples -= count;
+        if (block->i_nb_samples == 0)
+        {
+            in->queue = block->p_next;
+            if (in->queue == NULL)
+                in->queue_last = &in->queue;
+            block_Release(block);
+        }
+        done += count;
+    }
+    in->queued -= done;
+    return done;
+}
+
+static void *Thread(void *data)
+{
+    struct amix *mixer = data;
+    audio_output_t *sink = mixer->sink;
+    const unsigned channels = mixer->fmt.i_channels;
+    const vlc_tick_t period = vlc_tick_from_samples(mixer->period,
+                                                    mixer->fmt.i_rate);
+    vlc_tick_t deadline = vlc_tick_now();
+
+    vlc_mutex_lock(&mixer->lock);
+    while (!mixer->stop)
+    {
+        if (vlc_cond_timedwait(&mixer->wait, &mixer->lock, deadline) == 0)
+            continue;
+
+        /* The period is mixed even without any data, so that the real
+         * output plays silence rather than underruns */
+        block_t *block = block_Alloc(mixer->period * channels * sizeof (float));
+        if (unlikely(block == NULL))
+        {
+            deadline += period;
+            continue;
+        }
+        memset(block->p_buffer, 0, block->i_buffer);
+        block->i_nb_samples = mixer->period;
+
+        aout_sys_t *in;
+        vlc_list_foreach(in, &mixer->inputs, node)
+            if (!in->paused)
+                MixInput(in, (float *)block->p_buffer, mixer->period,
+                         channels);
+        vlc_cond_broadcast(&mixer->wait);
+        vlc_mutex_unlock(&mixer->lock);
+
+        vlc_tick_t now = vlc_tick_now();
+        block->i_pts = block->i_dts = now;
+        block->i_length = period;
+        sink->play(sink, block, now + AMIX_LEAD);
+
+        /* Follow the clock of the real output when it can tell its delay */
+        vlc_tick_t delay;
+        now = vlc_tick_now();
+        if (sink->time_get(sink, &delay) == 0)
+            deadline = now + delay - AMIX_LEAD;
+        else
+        {
+            deadline += period;
+            delay = __MAX(deadline + AMIX_LEAD - now, 0);
+        }
+
+        vlc_mutex_lock(&mixer->lock);
+        mixer->sink_delay = delay;
+        mixer->sink_date = now;
+    }
+    vlc_mutex_unlock(&mixer->lock);
+    return NULL;
+}
+
+/*** Real output ***/
+static void SinkTimingReport(audio_output_t *sink, vlc_tick_t system_now,
+                             vlc_tick_t pts)
+{
+    (void) sink; (void) system_now; (void) pts;
+}
+
+static void SinkVolumeReport(audio_output_t *sink, float volume)
+{
+    (void) sink; (void) volume;
+}
+
+static void SinkMuteReport(audio_output_t *sink, bool mute)
+{
+    (void) sink; (void) mute;
+}
+
+static void SinkPolicyReport(audio_output_t *sink, bool cork)
+{
+    (void) sink; (void) cork;
+}
+
+static void SinkDeviceReport(audio_output_t *sink, const char *id)
+{
+    (void) sink; (void) id;
+}
+
+static void SinkHotplugReport(audio_output_t *sink, const char *id,
+                              const char *name)
+{
+    (void) sink; (void) id; (void) name;
+}
+
+static void SinkRestartRequest(audio_output_t *sink, unsigned mode)
+{
+    msg_Warn(sink, "restart request ignored (%u)", mode);
+}
+
+static int SinkGainRequest(audio_output_t *sink, float gain)
+{
+    /* The gain of each input is applied while mixing */
+    (void) sink; (void) gain;
+    return 0;
+}
+
+static const struct vlc_audio_output_events sink_events = {
+    SinkTimingReport,
+    SinkVolumeReport,
+    SinkMuteReport,
+    SinkPolicyReport,
+    SinkDeviceReport,
+    SinkHotplugReport,
+    SinkRestartRequest,
+    SinkGainRequest,
+};
+
+static void MixerDelete(struct amix *mixer)
+{
+    audio_output_t *sink = mixer->sink;
+
+    vlc_mutex_lock(&mixer->lock);
+    mixer->stop = true;
+    vlc_cond_broadcast(&mixer->wait);
+    vlc_mutex_unlock(&mixer->lock);
+    vlc_join(mixer->thread, NULL);
+
+    sink->stop(sink);
+    module_unneed(sink, mixer->module);
+    vlc_object_delete(sink);
+    free(mixer);
+}
+
+static struct amix *MixerNew(vlc_object_t *obj)
+{
+    struct amix *mixer = malloc(sizeof (*mixer));
+    if (unlikely(mixer == NULL))
+        return NULL;
+
+    /* The real output belongs to the instance, not to the first input */
+    mixer->libvlc = vlc_object_instance(obj);
+    audio_output_t *sink = vlc_object_create(mixer->libvlc, sizeof (*sink));
+    if (unlikely(sink == NULL))
+    {
+        free(mixer);
+        return NULL;
+    }
+    sink->events = &sink_events;
+    mixer->module = module_need_var(sink, "audio output", "amix-output");
+    if (mixer->module == NULL)
+    {
+        msg_Err(obj, "cannot open the mixed audio output");
+        goto error;
+    }
+
+    audio_sample_format_t *fmt = &mixer->fmt;
+    memset(fmt, 0, sizeof (*fmt));
+    fmt->i_format = VLC_CODEC_FL32;
+    fmt->i_rate = var_InheritInteger(obj, "amix-rate");
+    fmt->i_physical_channels = AOUT_CHANS_STEREO;
+    fmt->channel_type = AUDIO_CHANNEL_TYPE_BITMAP;
+    aout_FormatPrepare(fmt);
+
+    if (sink->start(sink, fmt))
+    {
+        msg_Err(obj, "cannot start the mixed audio output");
+        module_unneed(sink, mixer->module);
+        goto error;
+    }
+    aout_FormatPrepare(fmt);
+    if (fmt->i_format != VLC_CODEC_FL32
+     || fmt->channel_type != AUDIO_CHANNEL_TYPE_BITMAP
+     || fmt->i_channels == 0)
+    {
+        msg_Err(obj, "unsupported mixed audio format %4.4s",
+                (const char *)&fmt->i_format);
+        sink->stop(sink);
+        module_unneed(sink, mixer->module);
+        goto error;
+    }
+
+    mixer->sink = sink;
+    mixer->refs = 0;
+    mixer->period = samples_from_vlc_tick(AMIX_PERIOD, fmt->i_rate);
+    vlc_mutex_init(&mixer->lock);
+    vlc_cond_init(&mixer->wait);
+    vlc_list_init(&mixer->inputs);
+    mixer->sink_delay = 0;
+    mixer->sink_date = vlc_tick_now();
+    mixer->stop = false;
+
+    if (vlc_clone(&mixer->thread, Thread, mixer, VLC_THREAD_PRIORITY_AUDIO))
+    {
+        sink->stop(sink);
+        module_unneed(sink, mixer->module);
+        goto error;
+    }
+
+    msg_Dbg(obj, "mixing at %u Hz, %u channels", fmt->i_rate,
+            fmt->i_channels);
+    return mixer;
+
+error:
+    vlc_object_delete(sink);
+    free(mixer);
+    return NULL;
+}
+
+/*** Inputs ***/
+static int Start(audio_output_t *aout, audio_sample_format_t *restrict fmt)
+{
+    aout_sys_t *sys = aout->sys;
+
+    if (!AOUT_FMT_LINEAR(fmt))
+        return VLC_EGENERIC; /* pass-through cannot be mixed */
+
+    libvlc_int_t *libvlc = vlc_object_instance(aout);
+    struct amix *mixer = NULL, *m;
+
+    vlc_mutex_lock(&amix_lock);
+    vlc_list_foreach(m, &amix_list, node)
+        if (m->libvlc == libvlc)
+        {
+            mixer = m;
+            break;
+        }
+    if (mixer == NULL)
+    {
+        mixer = MixerNew(VLC_OBJECT(aout));
+        if (mixer == NULL)
+        {
+            vlc_mutex_unlock(&amix_lock);
+            return VLC_EGENERIC;
+        }
+        vlc_list_append(&mixer->node, &amix_list);
+    }
+    mixer->refs++;
+    vlc_mutex_unlock(&amix_lock);
+
+    sys->mixer = mixer;
+    sys->queue = NULL;
+    sys->queue_last = &sys->queue;
+    sys->queued = 0;
+    sys->paused = false;
+
+    vlc_mutex_lock(&mixer->lock);
+    vlc_list_append(&sys->node, &mixer->inputs);
+    vlc_mutex_unlock(&mixer->lock);
+
+    fmt->i_format = VLC_CODEC_FL32;
+    fmt->i_rate = mixer->fmt.i_rate;
+    fmt->i_physical_channels = mixer->fmt.i_physical_channels;
+    fmt->channel_type = AUDIO_CHANNEL_TYPE_BITMAP;
+    aout_FormatPrepare(fmt);
+    return VLC_SUCCESS;
+}
+
+static void Stop(audio_output_t *aout)
+{
+    aout_sys_t *sys = aout->sys;
+    struct amix *mixer = sys->mixer;
+
+    vlc_mutex_lock(&mixer->lock);
+    vlc_list_remove(&sys->node);
+    vlc_mutex_unlock(&mixer->lock);
+    block_ChainRelease(sys->queue);
+
+    vlc_mutex_lock(&amix_lock);
+    if (--mixer->refs == 0)
+    {
+        vlc_list_remove(&mixer->node);
+        MixerDelete(mixer);
+    }
+    vlc_mutex_unlock(&amix_lock);
+}
+
+static int TimeGet(audio_output_t *aout, vlc_tick_t *restrict delay)
+{
+    aout_sys_t *sys = aout->sys;
+    struct amix *mixer = sys->mixer;
+
+    vlc_mutex_lock(&mixer->lock);
+    vlc_tick_t sink_delay = mixer->sink_delay
+                          - (vlc_tick_now() - mixer->sink_date);
+    *delay = __MAX(sink_delay, 0)
+           + vlc_tick_from_samples(sys->queued, mixer->fmt.i_rate);
+    vlc_mutex_unlock(&mixer->lock);
+    return 0;
+}
+
+static void Play(audio_output_t *aout, block_t *block, vlc_tick_t date)
+{
+    aout_sys_t *sys = aout->sys;
+    struct amix *mixer = sys->mixer;
+    const size_t max = samples_from_vlc_tick(AMIX_MAX_QUEUE,
+                                             mixer->fmt.i_rate);
+
+    vlc_mutex_lock(&mixer->lock);
+    /* Wait for the mixer, like a real output with a full buffer */
+    while (sys->queued > max && !sys->paused)
+        vlc_cond_wait(&mixer->wait, &mixer->lock);
+
+    block->p_next = NULL;
+    *sys->queue_last = block;
+    sys->queue_last = &block->p_next;
+    sys->queued += block->i_nb_samples;
+    vlc_mutex_unlock(&mixer->lock);
+    (void) date;
+}
+
+static void Pause(audio_output_t *aout, bool paused, vlc_tick_t date)
+{
+    aout_sys_t *sys = aout->sys;
+    struct amix *mixer = sys->mixer;
+
+    vlc_mutex_lock(&mixer->lock);
+    sys->paused = paused;
+    vlc_mutex_unlock(&mixer->lock);
+    (void) date;
+}
+
+static void Flush(audio_output_t *aout)
+{
+    aout_sys_t *sys = aout->sys;
+    struct amix *mixer = sys->mixer;
+
+    vlc_mutex_lock(&mixer->lock);
+    block_ChainRelease(sys->queue);
+    sys->queue = NULL;
+    sys->queue_last = &sys->queue;
+    sys->queued = 0;
+    vlc_mutex_unlock(&mixer->lock);
+}
+
+static void UpdateGain(aout_sys_t *sys)
+{
+    /* Same cubic law as the software volume */
+    float gain = sys->mute ? 0.f : sys->volume * sys->volume * sys->volume;
+
+    atomic_store_explicit(&sys->gain, gain, memory_order_relaxed);
+}
+
+static int VolumeSet(audio_output_t *aout, float volume)
+{
+    aout_sys_t *sys = aout->sys;
+
+    sys->volume = volume;
+    UpdateGain(sys);
+    aout_VolumeReport(aout, volume);
+    return 0;
+}
+
+static int MuteSet(audio_output_t *aout, bool mute)
+{
+    aout_sys_t *sys = aout->sys;
+
+    sys->mute = mute;
+    UpdateGain(sys);
+    aout_MuteReport(aout, mute);
+    return 0;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    audio_output_t *aout = (audio_output_t *)obj;
+    aout_sys_t *sys = malloc(sizeof (*sys));
+
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->mixer = NULL;
+    sys->volume = 1.f;
+    sys->mute = false;
+    atomic_init(&sys->gain, 1.f);
+
+    aout->sys = sys;
+    aout->start = Start;
+    aout->stop = Stop;
+    aout->time_get = TimeGet;
+    aout->play = Play;
+    aout->pause = Pause;
+    aout->flush = Flush;
+    aout->drain = NULL;
+    aout->volume_set = VolumeSet;
+    aout->mute_set = MuteSet;
+    aout->device_select = NULL;
+
+    aout_VolumeReport(aout, sys->volume);
+    aout_MuteReport(aout, sys->mute);
+    return VLC_SUCCESS;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    audio_output_t *aout = (audio_output_t *)obj;
+
+    free(aout->sys);
+}
@@ -849,6 +849,19 @@ static int Start(audio_output_t *aout, audio_sample_format_t *restrict fmt)
         attr.tlength = pa_usec_to_bytes(3 * AOUT_MIN_PREPARE_TIME, &ss);
     }
 
+    /* Likewise, do not let the server buffer more than the target length
+     * for the sink, which would have to be compensated with input delay.
+     * The server then requests data by short periods. */
+    if (var_InheritBool(aout, "low-delay"))
+    {
+        flags |= PA_STREAM_ADJUST_LATENCY;
+        if (encoding == PA_ENCODING_PCM)
+        {
+            attr.tlength = pa_usec_to_bytes(AOUT_MIN_PREPARE_TIME, &ss);
+            attr.minreq = pa_usec_to_bytes(AOUT_MIN_PREPARE_TIME / 4, &ss);
+        }
+    }
+
     if (encoding != PA_ENCODING_PCM)
     {
         pa_format_info_set_channels(formatv, ss.channels);
@@ -47,6 +47,12 @@
 #include "avcodec.h"
 #include "avcommon.h"
 
+#ifdef HAVE_AVCODEC_VAAPI
+# include <libavutil/hwcontext.h>
+# include <libavutil/hwcontext_vaapi.h>
+# include "../../hw/vaapi/vlc_vaapi.h"
+#endif
+
 #include <libavutil/channel_layout.h>
 
 #define HURRY_UP_GUARD1 VLC_TICK_FROM_MS(450)
@@ -143,6 +149,10 @@ typedef struct
     int        i_aac_profile; /* AAC profile to use.*/
 
     AVFrame    *frame;
+
+    /* Hardware surfaces input */
+    AVBufferRef *hw_frames;
+    vlc_decoder_device *dec_device;
 } encoder_sys_t;
 
 
@@ -292,6 +302,79 @@ static void add_av_option_float( encoder_t *p_enc, AVDictionary** pp_dict, const
         msg_Warn( p_enc, "Failed to set encoder option %s", psz_name );
 }
 
+#ifdef HAVE_AVCODEC_VAAPI
+/* Lets hardware encoders read the decoded VAAPI surfaces directly, instead
+ * of reading them back to the CPU and uploading them again */
+static int InitVaapiFrames( encoder_t *p_enc, encoder_sys_t *p_sys,
+                            AVCodecContext *p_context )
+{
+    const enum AVPixelFormat *p = p_sys->p_codec->pix_fmts;
+    if( p_enc->vctx_in == NULL || p == NULL ||
+        vlc_video_context_GetType( p_enc->vctx_in ) != VLC_VIDEO_CONTEXT_VAAPI ||
+        !vlc_vaapi_IsChromaOpaque( p_enc->fmt_in.video.i_chroma ) )
+        return VLC_EGENERIC;
+    while( *p != AV_PIX_FMT_NONE && *p != AV_PIX_FMT_VAAPI )
+        p++;
+    if( *p != AV_PIX_FMT_VAAPI )
+        return VLC_EGENERIC;
+
+    p_sys->dec_device = vlc_video_context_HoldDevice( p_enc->vctx_in );
+    if( p_sys->dec_device == NULL )
+        return VLC_EGENERIC;
+
+    /* The display stays owned by the decoder device */
+    AVBufferRef *device = av_hwdevice_ctx_alloc( AV_HWDEVICE_TYPE_VAAPI );
+    if( device == NULL )
+        goto error;
+    AVHWDeviceContext *device_ctx = (AVHWDeviceContext *)device->data;
+    AVVAAPIDeviceContext *va_ctx = device_ctx->hwctx;
+    va_ctx->display = p_sys->dec_device->opaque;
+    if( av_hwdevice_ctx_init( device ) < 0 )
+    {
+        av_buffer_unref( &device );
+        goto error;
+    }
+
+    p_sys->hw_frames = av_hwframe_ctx_alloc( device );
+    av_buffer_unref( &device );
+    if( p_sys->hw_frames == NULL )
+        goto error;
+
+    AVHWFramesContext *frames_ctx = (AVHWFramesContext *)p_sys->hw_frames->data;
+    frames_ctx->format = AV_PIX_FMT_VAAPI;
+    frames_ctx->sw_format =
+        p_enc->fmt_in.video.i_chroma == VLC_CODEC_VAAPI_420_10BPP ?
+        AV_PIX_FMT_P010 : AV_PIX_FMT_NV12;
+    frames_ctx->width = p_context->width;
+    frames_ctx->height = p_context->height;
+    /* The surfaces come from the decoder pool */
+    frames_ctx->initial_pool_size = 0;
+    if( av_hwframe_ctx_init( p_sys->hw_frames ) < 0 )
+        goto error;
+
+    p_context->hw_frames_ctx = av_buffer_ref( p_sys->hw_frames );
+    if( p_context->hw_frames_ctx == NULL )
+        goto error;
+    p_context->pix_fmt = AV_PIX_FMT_VAAPI;
+    p_enc->fmt_in.i_codec = p_enc->fmt_in.video.i_chroma;
+
+    msg_Dbg( p_enc, "encoding VAAPI surfaces" );
+    return VLC_SUCCESS;
+
+error:
+    av_buffer_unref( &p_sys->hw_frames );
+    vlc_decoder_device_Release( p_sys->dec_device );
+    p_sys->dec_device = NULL;
+    return VLC_EGENERIC;
+}
+
+static void ReleaseFramePicture( void *opaque, uint8_t *data )
+{
+    VLC_UNUSED( data );
+    picture_Release( opaque );
+}
+#endif
+
 int InitVideoEnc( vlc_object_t *p_this )
 {
     encoder_t *p_enc = (encoder_t *)p_this;
@@ -541,39 +624,46 @@ int InitVideoEnc( vlc_object_t *p_this )
                    p_enc->fmt_in.video.i_sar_den, 1 << 30 );
 
 
-        p_enc->fmt_in.i_codec = VLC_CODEC_I420;
+        bool b_hw_frames = false;
+#ifdef HAVE_AVCODEC_VAAPI
+        b_hw_frames = InitVaapiFrames( p_enc, p_sys, p_context ) == VLC_SUCCESS;
+#endif
+        if( !b_hw_frames )
+        {
+            p_enc->fmt_in.i_codec = VLC_CODEC_I420;
 
-        /* Very few application support YUV in TIFF, not even VLC */
-        if( p_enc->fmt_out.i_codec == VLC_CODEC_TIFF )
-            p_enc->fmt_in.i_codec = VLC_CODEC_RGB24;
+            /* Very few application support YUV in TIFF, not even VLC */
+            if( p_enc->fmt_out.i_codec == VLC_CODEC_TIFF )
+                p_enc->fmt_in.i_codec = VLC_CODEC_RGB24;
 
-        p_enc->fmt_in.video.i_chroma = p_enc->fmt_in.i_codec;
-        GetFfmpegChroma( &p_context->pix_fmt, &p_enc->fmt_in.video );
+            p_enc->fmt_in.video.i_chroma = p_enc->fmt_in.i_codec;
+            GetFfmpegChroma( &p_context->pix_fmt, &p_enc->fmt_in.video );
 
-        if( p_codec->pix_fmts )
-        {
-            static const enum AVPixelFormat vlc_pix_fmts[] = {
-                AV_PIX_FMT_YUV420P,
-                AV_PIX_FMT_NV12,
-                AV_PIX_FMT_RGB24,
-            };
-            bool found = false;
-            const enum PixelFormat *p = p_codec->pix_fmts;
-            for( ; !found && *p != -1; p++ )
+            if( p_codec->pix_fmts )
             {
-                for( size_t i = 0; i < ARRAY_SIZE(vlc_pix_fmts); ++i )
+                static const enum AVPixelFormat vlc_pix_fmts[] = {
+                    AV_PIX_FMT_YUV420P,
+                    AV_PIX_FMT_NV12,
+                    AV_PIX_FMT_RGB24,
+                };
+                bool found = false;
+                const enum PixelFormat *p = p_codec->pix_fmts;
+                for( ; !found && *p != -1; p++ )
                 {
-                    if( *p == vlc_pix_fmts[i] )
+                    for( size_t i = 0; i < ARRAY_SIZE(vlc_pix_fmts); ++i )
                     {
-                        found = true;
-                        p_context->pix_fmt = *p;
-                        break;
+                        if( *p == vlc_pix_fmts[i] )
+                        {
+                            found = true;
+                            p_context->pix_fmt = *p;
+                            break;
+                        }
                     }
                 }
+                if (!found) p_context->pix_fmt = p_codec->pix_fmts[0];
+                GetVlcChroma( &p_enc->fmt_in.video, p_context->pix_fmt );
+                p_enc->fmt_in.i_codec = p_enc->fmt_in.video.i_chroma;
             }
-            if (!found) p_context->pix_fmt = p_codec->pix_fmts[0];
-            GetVlcChroma( &p_enc->fmt_in.video, p_context->pix_fmt );
-            p_enc->fmt_in.i_codec = p_enc->fmt_in.video.i_chroma;
         }
 
 
@@ -1061,6 +1151,9 @@ error:
     av_free( p_sys->p_buffer );
     av_free( p_sys->p_interleave_buf );
     avcodec_free_context( &p_context );
+    av_buffer_unref( &p_sys->hw_frames );
+    if( p_sys->dec_device )
+        vlc_decoder_device_Release( p_sys->dec_device );
     free( p_sys );
     return VLC_ENOMEM;
 }
@@ -1189,6 +1282,35 @@ static block_t *EncodeVideo( encoder_t *p_enc, picture_t *p_pict )
         frame = p_sys->frame;
         av_frame_unref( frame );
 
+#ifdef HAVE_AVCODEC_VAAPI
+        if( p_sys->hw_frames )
+        {
+            /* Same as vlc_vaapi_PicGetSurface(), not part of this plugin */
+            const struct vaapi_pic_context *pic_ctx =
+                (const struct vaapi_pic_context *)p_pict->context;
+            if( unlikely( pic_ctx == NULL ) )
+            {
+                msg_Err( p_enc, "picture without VAAPI surface" );
+                return NULL;
+            }
+
+            /* The encoder may keep the surface after returning */
+            frame->buf[0] = av_buffer_create( (uint8_t *)p_pict, sizeof( *p_pict ),
+                                              ReleaseFramePicture, p_pict,
+                                              AV_BUFFER_FLAG_READONLY );
+            frame->hw_frames_ctx = av_buffer_ref( p_sys->hw_frames );
+            if( unlikely( frame->buf[0] == NULL || frame->hw_frames_ctx == NULL ) )
+            {
+                if( frame->buf[0] == NULL )
+                    picture_Release( p_pict );
+                av_frame_unref( frame );
+                return NULL;
+            }
+            picture_Hold( p_pict );
+            frame->data[3] = (uint8_t *)(uintptr_t)pic_ctx->surface;
+        }
+        else
+#endif
         for( i_plane = 0; i_plane < p_pict->i_planes; i_plane++ )
         {
             p_sys->frame->data[i_plane] = p_pict->p[i_plane].p_pixels;
@@ -1478,5 +1600,8 @@ void EndVideoEnc( vlc_object_t *p_this )
     av_free( p_sys->p_interleave_buf );
     av_free( p_sys->p_buffer );
 
+    av_buffer_unref( &p_sys->hw_frames );
+    if( p_sys->dec_device )
+        vlc_decoder_device_Release( p_sys->dec_device );
     free( p_sys );
 }
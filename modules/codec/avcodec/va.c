@@ -99,20 +99,21 @@ bool vlc_va_MightDecode(enum PixelFormat hwfmt, enum PixelFormat swfmt)
     }
 }
 
-vlc_va_t *vlc_va_New(vlc_object_t *obj, AVCodecContext *avctx,
+vlc_va_t *vlc_va_New(decoder_t *dec, AVCodecContext *avctx,
                      enum PixelFormat hwfmt, const AVPixFmtDescriptor *src_desc,
                      const es_format_t *fmt_in, vlc_decoder_device *device,
                      video_format_t *fmt_out, vlc_video_context **vtcx_out)
 {
-    struct vlc_va_t *va = vlc_object_create(obj, sizeof (*va));
+    struct vlc_va_t *va = vlc_object_create(dec, sizeof (*va));
     if (unlikely(va == NULL))
         return NULL;
+    va->decoder = dec;
 
     module_t **mods;
     ssize_t total = vlc_module_match("hw decoder", NULL, false, &mods, NULL);
 
     for (ssize_t i = 0; i < total; i++) {
-        vlc_va_open open = vlc_module_map(obj->logger, mods[i]);
+        vlc_va_open open = vlc_module_map(dec->obj.logger, mods[i]);
 
         if (open != NULL && open(va, avctx, hwfmt, src_desc, fmt_in, device,
                                  fmt_out, vtcx_out) == VLC_SUCCESS) {
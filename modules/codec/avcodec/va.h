@@ -39,6 +39,8 @@ struct vlc_va_operations {
 struct vlc_va_t {
     struct vlc_object_t obj;
 
+    decoder_t *decoder; /**< decoder using the back-end */
+
     vlc_va_sys_t *sys;
     const struct vlc_va_operations *ops;
 };
@@ -67,11 +69,11 @@ bool vlc_va_MightDecode(enum PixelFormat hwfmt, enum PixelFormat swfmt);
 
 /**
  * Creates an accelerated video decoding back-end for libavcodec.
- * @param obj parent VLC object
+ * @param dec parent decoder
  * @param fmt VLC format of the content to decode
  * @return a new VLC object on success, NULL on error.
  */
-vlc_va_t *vlc_va_New(vlc_object_t *obj, AVCodecContext *,
+vlc_va_t *vlc_va_New(decoder_t *dec, AVCodecContext *,
                      enum PixelFormat hwfmt, const AVPixFmtDescriptor *,
                      const es_format_t *fmt, vlc_decoder_device *device,
                      video_format_t *, vlc_video_context **vtcx_out);
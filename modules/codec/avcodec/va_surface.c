@@ -47,10 +47,14 @@ struct vlc_va_surface_t {
 struct va_pool_t
 {
     /* */
-    size_t       surface_count;
+    atomic_size_t surface_count;
+    size_t       max_count;
     unsigned     surface_width;
     unsigned     surface_height;
 
+    vlc_va_t     *va; /* to grow the pool, valid until va_pool_Close() */
+    vlc_mutex_t  grow_lock;
+
     vlc_va_surface_t surface[MAX_SURFACE_COUNT];
 
     struct va_pool_cfg callbacks;
@@ -78,7 +82,7 @@ static void va_pool_Release(va_pool_t *va_pool)
 int va_pool_SetupDecoder(vlc_va_t *va, va_pool_t *va_pool, AVCodecContext *avctx,
                          const video_format_t *fmt, size_t count)
 {
-    if ( va_pool->surface_count >= count &&
+    if ( va_pool->max_count >= count &&
          va_pool->surface_width  == fmt->i_width &&
          va_pool->surface_height == fmt->i_height )
     {
@@ -95,17 +99,24 @@ int va_pool_SetupDecoder(vlc_va_t *va, va_pool_t *va_pool, AVCodecContext *avctx
         return VLC_EGENERIC;
     }
 
-    int err = va_pool->callbacks.pf_create_decoder_surfaces(va, avctx->codec_id, fmt, count);
+    /* start small when the pool can grow on demand */
+    size_t initial_count = count;
+    if (va_pool->callbacks.pf_grow_decoder_surfaces != NULL)
+        initial_count = __MIN(count, VA_POOL_INITIAL_COUNT);
+
+    int err = va_pool->callbacks.pf_create_decoder_surfaces(va, avctx->codec_id, fmt, initial_count);
     if (err != VLC_SUCCESS)
         return err;
 
     va_pool->surface_width  = fmt->i_width;
     va_pool->surface_height = fmt->i_height;
-    va_pool->surface_count = count;
+    va_pool->max_count = count;
+    atomic_store_explicit(&va_pool->surface_count, initial_count,
+                          memory_order_relaxed);
 
-    vlc_sem_init(&va_pool->available_surfaces, count);
+    vlc_sem_init(&va_pool->available_surfaces, initial_count);
 
-    for (size_t i = 0; i < va_pool->surface_count; i++) {
+    for (size_t i = 0; i < initial_count; i++) {
         vlc_va_surface_t *surface = &va_pool->surface[i];
         atomic_init(&surface->refcount, 1);
         va_pool_AddRef(va_pool);
@@ -118,9 +129,50 @@ done:
     return VLC_SUCCESS;
 }
 
+/* Adds a surface to the pool if all of them are in use */
+static void GrowSurfaces(va_pool_t *va_pool)
+{
+    vlc_mutex_lock(&va_pool->grow_lock);
+    size_t count = atomic_load_explicit(&va_pool->surface_count,
+                                        memory_order_relaxed);
+    if (count >= va_pool->max_count)
+        goto done;
+
+    /* another thread may have grown the pool or released a surface */
+    if (vlc_sem_trywait(&va_pool->available_surfaces) == 0)
+    {
+        vlc_sem_post(&va_pool->available_surfaces);
+        goto done;
+    }
+
+    if (va_pool->callbacks.pf_grow_decoder_surfaces(va_pool->va, count,
+                                                    count + 1) != VLC_SUCCESS)
+    {
+        msg_Warn(va_pool->va, "cannot grow the surface pool beyond %zu",
+                 count);
+        va_pool->max_count = count;
+        goto done;
+    }
+
+    vlc_va_surface_t *surface = &va_pool->surface[count];
+    atomic_init(&surface->refcount, 1);
+    va_pool_AddRef(va_pool);
+    surface->index = count;
+    surface->va_pool = va_pool;
+
+    /* publish the surface before it can be looked up */
+    atomic_store_explicit(&va_pool->surface_count, count + 1,
+                          memory_order_release);
+    vlc_sem_post(&va_pool->available_surfaces);
+done:
+    vlc_mutex_unlock(&va_pool->grow_lock);
+}
+
 static vlc_va_surface_t *GetSurface(va_pool_t *va_pool)
 {
-    for (unsigned i = 0; i < va_pool->surface_count; i++) {
+    size_t count = atomic_load_explicit(&va_pool->surface_count,
+                                        memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
         vlc_va_surface_t *surface = &va_pool->surface[i];
         uintptr_t expected = 1;
 
@@ -139,10 +191,15 @@ vlc_va_surface_t *va_pool_Get(va_pool_t *va_pool)
 {
     vlc_va_surface_t *surface;
 
-    if (va_pool->surface_count == 0)
+    if (atomic_load_explicit(&va_pool->surface_count, memory_order_relaxed) == 0)
         return NULL;
 
-    vlc_sem_wait(&va_pool->available_surfaces);
+    if (vlc_sem_trywait(&va_pool->available_surfaces) != 0)
+    {
+        if (va_pool->callbacks.pf_grow_decoder_surfaces != NULL)
+            GrowSurfaces(va_pool);
+        vlc_sem_wait(&va_pool->available_surfaces);
+    }
     surface = GetSurface(va_pool);
     assert(surface != NULL);
     return surface;
@@ -168,6 +225,11 @@ void va_surface_Release(vlc_va_surface_t *surface)
     }
 }
 
+size_t va_pool_GetCount(va_pool_t *va_pool)
+{
+    return atomic_load_explicit(&va_pool->surface_count, memory_order_acquire);
+}
+
 size_t va_surface_GetIndex(const vlc_va_surface_t *surface)
 {
     return surface->index;
@@ -175,9 +237,11 @@ size_t va_surface_GetIndex(const vlc_va_surface_t *surface)
 
 void va_pool_Close(va_pool_t *va_pool)
 {
-    for (unsigned i = 0; i < va_pool->surface_count; i++)
+    size_t count = atomic_load_explicit(&va_pool->surface_count,
+                                        memory_order_relaxed);
+    atomic_store_explicit(&va_pool->surface_count, 0, memory_order_relaxed);
+    for (size_t i = 0; i < count; i++)
         va_surface_Release(&va_pool->surface[i]);
-    va_pool->surface_count = 0;
 
     va_pool_Release(va_pool);
 }
@@ -197,7 +261,10 @@ va_pool_t * va_pool_Create(vlc_va_t *va, const struct va_pool_cfg *cbs)
     }
     msg_Dbg(va, "CreateDevice succeed");
 
-    va_pool->surface_count = 0;
+    atomic_init(&va_pool->surface_count, 0);
+    va_pool->max_count = 0;
+    va_pool->va = va;
+    vlc_mutex_init(&va_pool->grow_lock);
     atomic_init(&va_pool->poolrefs, 1);
 
     return va_pool;
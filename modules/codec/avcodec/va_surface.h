@@ -55,8 +55,21 @@ struct va_pool_cfg {
     void (*pf_setup_avcodec_ctx)(void *opaque, AVCodecContext *avctx);
 
     void *opaque;
+
+    /**
+     * Create more surfaces for the decoder, from old_count to new_count
+     *
+     * If NULL, all the surfaces are created upfront by
+     * pf_create_decoder_surfaces, otherwise the pool starts with
+     * VA_POOL_INITIAL_COUNT surfaces and grows when they are all in use.
+     */
+    int (*pf_grow_decoder_surfaces)(vlc_va_t *, size_t old_count,
+                                    size_t new_count);
 };
 
+/* Surfaces created upfront by the pools that can grow */
+#define VA_POOL_INITIAL_COUNT (4)
+
 /**
  * Create a VA pool for the given va module.
  *
@@ -80,11 +93,22 @@ void va_pool_Close(va_pool_t *);
  *
  * The pf_create_decoder_surfaces callback of the pool configuration is called.
  * If it succeeds, the pf_setup_avcodec_ctx callback will be called afterwards.
+ *
+ * If the pool can grow, count is the maximum amount of surfaces and fewer
+ * surfaces are created upfront, cf. va_pool_GetCount().
  */
 int va_pool_SetupDecoder(vlc_va_t *, va_pool_t *, AVCodecContext *, const video_format_t *, size_t count);
 
+/**
+ * Get the amount of surfaces created so far.
+ */
+size_t va_pool_GetCount(va_pool_t *);
+
 /**
  * Get a reference to an available surface or NULL on timeout
+ *
+ * If all the surfaces are in use, the pool grows if it can, otherwise this
+ * function waits for a surface to be released.
  */
 vlc_va_surface_t *va_pool_Get(va_pool_t *);
 
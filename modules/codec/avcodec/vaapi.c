@@ -55,6 +55,14 @@ struct vlc_va_sys_t
     vlc_video_context *vctx;
     va_pool_t *va_pool;
     VASurfaceID render_targets[MAX_SURFACE_COUNT];
+
+    /* decoder device holding the surfaces once the decoder is closed */
+    vlc_decoder_device *dec_device;
+    int i_chroma;
+    unsigned width;
+    unsigned height;
+    size_t surface_count;
+    size_t surface_size; /* estimated, for the statistics */
 };
 
 static int GetVaProfile(const AVCodecContext *ctx, const es_format_t *fmt_in,
@@ -179,6 +187,8 @@ static void Delete(vlc_va_t *va)
 {
     vlc_va_sys_t *sys = va->sys;
 
+    decoder_UpdateVideoMemory(va->decoder,
+                              -(ptrdiff_t)(sys->surface_count * sys->surface_size));
     vlc_video_context_Release(sys->vctx);
     va_pool_Close(sys->va_pool);
 }
@@ -198,19 +208,37 @@ static void VAAPIDestroyDevice(void *opaque)
         vlc_vaapi_DestroyContext(NULL, sys->hw_ctx.display, sys->hw_ctx.context_id);
     if (sys->hw_ctx.config_id != VA_INVALID_ID)
         vlc_vaapi_DestroyConfig(NULL, sys->hw_ctx.display, sys->hw_ctx.config_id);
+    if (sys->surface_count > 0)
+    {
+        /* let the next decoder of the same format use the surfaces */
+        vlc_vaapi_SurfaceCachePut(vlc_vaapi_GetSurfaceCache(sys->dec_device),
+                                  sys->hw_ctx.display, sys->i_chroma,
+                                  sys->width, sys->height,
+                                  sys->render_targets, sys->surface_count);
+    }
+    vlc_decoder_device_Release(sys->dec_device);
     free(sys);
 }
 
-static int VAAPICreateDecoderSurfaces(vlc_va_t *va, int codec_id,
-                                      const video_format_t *fmt,
-                                      size_t count)
+/* Creates the surfaces from old_count to new_count, reusing the surfaces left
+ * by previous decoders on the same device first */
+static int VAAPICreateSurfaces(vlc_va_t *va, size_t old_count, size_t new_count)
 {
-    VLC_UNUSED(codec_id);
     vlc_va_sys_t *sys = va->sys;
+    VASurfaceID *surfaces = &sys->render_targets[old_count];
+    unsigned count = new_count - old_count;
+
+    unsigned cached =
+        vlc_vaapi_SurfaceCacheTake(vlc_vaapi_GetSurfaceCache(sys->dec_device),
+                                   sys->i_chroma, sys->width, sys->height,
+                                   surfaces, count);
+    sys->surface_count = old_count + cached;
+    if (cached == count)
+        return VLC_SUCCESS;
 
     unsigned va_rt_format;
     int va_fourcc;
-    vlc_chroma_to_vaapi(fmt->i_chroma, &va_rt_format, &va_fourcc);
+    vlc_chroma_to_vaapi(sys->i_chroma, &va_rt_format, &va_fourcc);
 
     VASurfaceAttrib fourcc_attribs[1] = {
         {
@@ -222,15 +250,46 @@ static int VAAPICreateDecoderSurfaces(vlc_va_t *va, int codec_id,
     };
 
     VA_CALL(VLC_OBJECT(va), vaCreateSurfaces, sys->hw_ctx.display, va_rt_format,
-            fmt->i_visible_width, fmt->i_visible_height,
-            sys->render_targets, count,
+            sys->width, sys->height,
+            &surfaces[cached], count - cached,
             fourcc_attribs, 1);
 
+    sys->surface_count = new_count;
     return VLC_SUCCESS;
 error:
     return VLC_EGENERIC;
 }
 
+static int VAAPICreateDecoderSurfaces(vlc_va_t *va, int codec_id,
+                                      const video_format_t *fmt,
+                                      size_t count)
+{
+    VLC_UNUSED(codec_id);
+    vlc_va_sys_t *sys = va->sys;
+
+    sys->i_chroma = fmt->i_chroma;
+    sys->width = fmt->i_visible_width;
+    sys->height = fmt->i_visible_height;
+    sys->surface_size = sys->width * sys->height * 3 / 2;
+    if (fmt->i_chroma == VLC_CODEC_VAAPI_420_10BPP)
+        sys->surface_size *= 2;
+
+    return VAAPICreateSurfaces(va, 0, count);
+}
+
+static int VAAPIGrowDecoderSurfaces(vlc_va_t *va, size_t old_count,
+                                    size_t new_count)
+{
+    vlc_va_sys_t *sys = va->sys;
+
+    int ret = VAAPICreateSurfaces(va, old_count, new_count);
+    /* account the surfaces reused from the cache even on error, they are
+     * released with the others */
+    decoder_UpdateVideoMemory(va->decoder,
+                              (sys->surface_count - old_count) * sys->surface_size);
+    return ret;
+}
+
 static void VAAPISetupAVCodecContext(void *opaque, AVCodecContext *avctx)
 {
     vlc_va_sys_t *sys = opaque;
@@ -250,6 +309,7 @@ static int Create(vlc_va_t *va, AVCodecContext *ctx, enum PixelFormat hwfmt, con
     if (unlikely(sys == NULL))
         return VLC_ENOMEM;
     memset(sys, 0, sizeof (*sys));
+    sys->dec_device = vlc_decoder_device_Hold(dec_device);
 
     vlc_object_t *o = VLC_OBJECT(va);
 
@@ -275,6 +335,7 @@ static int Create(vlc_va_t *va, AVCodecContext *ctx, enum PixelFormat hwfmt, con
         VAAPICreateDecoderSurfaces,
         VAAPISetupAVCodecContext,
         sys,
+        VAAPIGrowDecoderSurfaces,
     };
     sys->va_pool = va_pool_Create(va, &pool_cfg);
     if (sys->va_pool == NULL)
@@ -285,19 +346,18 @@ static int Create(vlc_va_t *va, AVCodecContext *ctx, enum PixelFormat hwfmt, con
     if (err != VLC_SUCCESS)
         goto error;
 
-    VASurfaceID *render_targets = sys->render_targets;
-
     sys->hw_ctx.config_id =
         vlc_vaapi_CreateConfigChecked(o, sys->hw_ctx.display, i_profile,
                                       VAEntrypointVLD, i_vlc_chroma);
     if (sys->hw_ctx.config_id == VA_INVALID_ID)
         goto error;
 
-    /* Create a context */
+    /* Create a context, the render targets are only a hint for the driver:
+     * the surfaces added when the pool grows can be decoded to as well */
     sys->hw_ctx.context_id =
         vlc_vaapi_CreateContext(o, sys->hw_ctx.display, sys->hw_ctx.config_id,
                                 ctx->coded_width, ctx->coded_height, VA_PROGRESSIVE,
-                                render_targets, count);
+                                sys->render_targets, sys->surface_count);
     if (sys->hw_ctx.context_id == VA_INVALID_ID)
         goto error;
 
@@ -307,6 +367,9 @@ static int Create(vlc_va_t *va, AVCodecContext *ctx, enum PixelFormat hwfmt, con
     if (sys->vctx == NULL)
         goto error;
 
+    decoder_UpdateVideoMemory(va->decoder,
+                              sys->surface_count * sys->surface_size);
+
     va->ops = &ops;
     *vtcx_out = sys->vctx;
     return VLC_SUCCESS;
@@ -315,7 +378,10 @@ error:
     if (sys->va_pool != NULL)
         va_pool_Close(sys->va_pool);
     else
+    {
+        vlc_decoder_device_Release(sys->dec_device);
         free(sys);
+    }
     return ret;
 }
 
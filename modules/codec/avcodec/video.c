@@ -50,6 +50,9 @@
 
 #include "../cc.h"
 #define FRAME_INFO_DEPTH 64
+/* Blocks skipped while waiting for a keyframe to thumbnail, in case the
+ * stream has none the decoder can tell */
+#define THUMBNAIL_MAX_NONKEY 250
 
 struct frame_info_s
 {
@@ -76,6 +79,11 @@ typedef struct
     bool b_show_corrupted;
     bool b_from_preroll;
     enum AVDiscard i_skip_frame;
+    enum AVDiscard i_skip_loop_filter;
+
+    /* for thumbnailing */
+    bool b_thumbnail_preroll;
+    unsigned i_thumbnail_nonkey;
 
     struct frame_info_s frame_info[FRAME_INFO_DEPTH];
 
@@ -112,6 +120,9 @@ typedef struct
     unsigned decoder_width;
     unsigned decoder_height;
 
+    /* threads taken from the shared budget */
+    unsigned i_budget_threads;
+
     /* Protect dec->fmt_out, decoder_Update*() and decoder_NewPicture()
      * functions */
     vlc_mutex_t lock;
@@ -137,6 +148,52 @@ static uint32_t ffmpeg_CodecTag( vlc_fourcc_t fcc )
  * Local Functions
  *****************************************************************************/
 
+/* Automatic thread counts are taken from a budget shared by all the video
+ * decoders of the process, so that many decoders running at once (mosaic,
+ * multiview) do not oversubscribe the CPU. */
+static vlc_mutex_t thread_budget_lock = VLC_STATIC_MUTEX;
+static unsigned thread_budget_used = 0;
+
+static unsigned ffmpeg_ReserveThreads( const decoder_t *p_dec,
+                                       const AVCodec *p_codec,
+                                       unsigned i_max )
+{
+    const unsigned i_cpus = vlc_GetCPUCount();
+    const unsigned i_budget = 2 * i_cpus;
+    const uint64_t i_pixels = (uint64_t) p_dec->fmt_in.video.i_width *
+                                         p_dec->fmt_in.video.i_height;
+
+    /* Wanted count from the picture size, unknown sizes get the maximum */
+    unsigned i_wanted = i_max;
+    if( i_pixels > 0 )
+    {
+        if( i_pixels <= 720 * 576 )
+            i_wanted = 2;
+        else if( i_pixels <= 1920 * 1088 )
+            i_wanted = 4;
+        else
+            i_wanted = p_codec->id == AV_CODEC_ID_HEVC ? 10 : 8;
+        i_wanted = __MIN( i_wanted, i_max );
+    }
+
+    vlc_mutex_lock( &thread_budget_lock );
+    unsigned i_left = i_budget > thread_budget_used ?
+                      i_budget - thread_budget_used : 0;
+    unsigned i_count = __MAX( __MIN( i_wanted, i_left ), 1 );
+    thread_budget_used += i_count;
+    vlc_mutex_unlock( &thread_budget_lock );
+
+    return i_count;
+}
+
+static void ffmpeg_ReleaseThreads( unsigned i_count )
+{
+    vlc_mutex_lock( &thread_budget_lock );
+    assert( thread_budget_used >= i_count );
+    thread_budget_used -= i_count;
+    vlc_mutex_unlock( &thread_budget_lock );
+}
+
 /**
  * Sets the decoder output format.
  */
@@ -392,10 +449,7 @@ static int OpenVideoCodec( decoder_t *p_dec )
     }
 
     if( var_InheritBool(p_dec, "low-delay") )
-    {
         ctx->flags |= AV_CODEC_FLAG_LOW_DELAY;
-        ctx->active_thread_type = FF_THREAD_SLICE;
-    }
 
     ret = ffmpeg_OpenCodec( p_dec, ctx, codec );
     if( ret < 0 )
@@ -475,6 +529,7 @@ int InitVideoDec( vlc_object_t *obj )
     else if( i_val == 2 ) p_context->skip_loop_filter = AVDISCARD_BIDIR;
     else if( i_val == 1 ) p_context->skip_loop_filter = AVDISCARD_NONREF;
     else p_context->skip_loop_filter = AVDISCARD_DEFAULT;
+    p_sys->i_skip_loop_filter = p_context->skip_loop_filter;
 
     /* ***** libavcodec frame skipping ***** */
     p_sys->b_hurry_up = var_CreateGetBool( p_dec, "avcodec-hurry-up" );
@@ -532,6 +587,8 @@ int InitVideoDec( vlc_object_t *obj )
 #else
         i_thread_count = __MIN( i_thread_count, p_codec->id == AV_CODEC_ID_HEVC ? 10 : 6 );
 #endif
+        i_thread_count = ffmpeg_ReserveThreads( p_dec, p_codec, i_thread_count );
+        p_sys->i_budget_threads = i_thread_count;
     }
     i_thread_count = __MIN( i_thread_count, p_codec->id == AV_CODEC_ID_HEVC ? 32 : 16 );
     msg_Dbg( p_dec, "allowing %d thread(s) for decoding", i_thread_count );
@@ -558,6 +615,10 @@ int InitVideoDec( vlc_object_t *obj )
             break;
     }
 
+    /* Frame threading delays the output by one frame per thread */
+    if( var_InheritBool( p_dec, "low-delay" ) )
+        p_context->thread_type &= ~FF_THREAD_FRAME;
+
     if( p_context->thread_type & FF_THREAD_FRAME )
         p_dec->i_extra_picture_buffers = 2 * p_context->thread_count;
 
@@ -568,6 +629,8 @@ int InitVideoDec( vlc_object_t *obj )
     p_sys->b_from_preroll = false;
     p_sys->i_last_output_frame = -1;
     p_sys->framedrop = FRAMEDROP_NONE;
+    p_sys->b_thumbnail_preroll = false;
+    p_sys->i_thumbnail_nonkey = 0;
 
     /* Set output properties */
     if( GetVlcChroma( &p_dec->fmt_out.video, p_context->pix_fmt ) != VLC_SUCCESS )
@@ -593,6 +656,7 @@ int InitVideoDec( vlc_object_t *obj )
     /* ***** Open the codec ***** */
     if( OpenVideoCodec( p_dec ) < 0 )
     {
+        ffmpeg_ReleaseThreads( p_sys->i_budget_threads );
         free( p_sys );
         avcodec_free_context( &p_context );
         return VLC_EGENERIC;
@@ -619,6 +683,8 @@ static void Flush( decoder_t *p_dec )
 
     p_sys->i_late_frames = 0;
     p_sys->framedrop = FRAMEDROP_NONE;
+    p_sys->b_thumbnail_preroll = false;
+    p_sys->i_thumbnail_nonkey = 0;
     cc_Flush( &p_sys->cc );
 
     /* do not flush buffers if codec hasn't been opened (theora/vorbis/VC1) */
@@ -940,6 +1006,30 @@ static int DecodeBlock( decoder_t *p_dec, block_t **pp_block )
             p_block = filter_earlydropped_blocks( p_dec, p_block );
     }
 
+    /* Only the picture at the seek target will be used: decode the
+     * prerolled frames as fast as possible, and without preroll (fast
+     * seek), skip up to the first keyframe */
+    if( p_dec->b_thumbnailing && p_block )
+    {
+        p_context->skip_frame = p_sys->i_skip_frame;
+        if( !b_need_output_picture )
+        {
+            p_sys->b_thumbnail_preroll = true;
+            p_context->skip_loop_filter = AVDISCARD_ALL;
+        }
+        else
+        {
+            p_context->skip_loop_filter = p_sys->i_skip_loop_filter;
+            if( !p_sys->b_thumbnail_preroll && p_sys->b_first_frame &&
+                p_sys->i_thumbnail_nonkey < THUMBNAIL_MAX_NONKEY )
+            {
+                p_sys->i_thumbnail_nonkey++;
+                p_context->skip_frame = __MAX( p_context->skip_frame,
+                                               AVDISCARD_NONKEY );
+            }
+        }
+    }
+
     if( !b_need_output_picture || p_sys->framedrop == FRAMEDROP_NONREF )
     {
         p_context->skip_frame = __MAX( p_context->skip_frame, AVDISCARD_NONREF );
@@ -1302,6 +1392,7 @@ void EndVideoDec( vlc_object_t *obj )
         p_sys->vctx_out = NULL;
     }
 
+    ffmpeg_ReleaseThreads( p_sys->i_budget_threads );
     free( p_sys );
 }
 
@@ -1663,7 +1754,7 @@ no_reuse:
 
         p_dec->fmt_out.video.i_chroma = 0; // make sure the va sets its output chroma
         vlc_video_context *vctx_out;
-        vlc_va_t *va = vlc_va_New(VLC_OBJECT(p_dec), p_context, hwfmt, src_desc,
+        vlc_va_t *va = vlc_va_New(p_dec, p_context, hwfmt, src_desc,
                                   &p_dec->fmt_in, init_device,
                                   &p_dec->fmt_out.video, &vctx_out);
         if (init_device)
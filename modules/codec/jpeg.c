@@ -63,8 +63,14 @@ struct jpeg_sys_t
 
 typedef struct jpeg_sys_t jpeg_sys_t;
 
+#define DEC_THREADS_TEXT N_("Threads")
+#define DEC_THREADS_LONGTEXT N_("Number of pictures decoded at once " \
+    "(0 = auto), 1 disables threading.")
+
+#define DEC_MAX_THREADS 16
+
 /*
- * jpeg decoder descriptor
+ * jpeg decompression context
  */
 typedef struct
 {
@@ -72,12 +78,50 @@ typedef struct
 
     JSAMPARRAY p_row_pointers;
     struct jpeg_decompress_struct p_jpeg;
+} jpeg_dec_t;
+
+/*
+ * picture decoded by a worker thread
+ */
+typedef struct
+{
+    jpeg_dec_t dec;
+    decoder_t *p_dec;
+    block_t *p_block;
+    picture_t *p_pic;
+    enum
+    {
+        JOB_IDLE,
+        JOB_PENDING,
+        JOB_DONE,
+    } state;
+    bool b_success;
+    vlc_thread_t thread;
+} jpeg_job_t;
+
+/*
+ * jpeg decoder descriptor
+ */
+typedef struct
+{
+    jpeg_dec_t dec;
+
+    /* Frame threads, consecutive pictures are decoded in parallel and
+     * output in decoding order */
+    unsigned i_threads;
+    unsigned i_next; /* next job to start */
+    unsigned i_output; /* next job to output */
+    bool b_abort;
+    vlc_mutex_t lock;
+    vlc_cond_t wait; /* jobs state change */
+    jpeg_job_t *p_jobs; /* started on the 2nd picture */
 } decoder_sys_t;
 
 static int  OpenDecoder(vlc_object_t *);
 static void CloseDecoder(vlc_object_t *);
 
 static int DecodeBlock(decoder_t *, block_t *);
+static void Flush(decoder_t *);
 
 /*
  * jpeg encoder descriptor
@@ -113,6 +157,8 @@ vlc_module_begin()
     set_capability("video decoder", 1000)
     set_callbacks(OpenDecoder, CloseDecoder)
     add_shortcut("jpeg")
+    add_integer_with_range("jpeg-threads", 0, 0, DEC_MAX_THREADS,
+                           DEC_THREADS_TEXT, DEC_THREADS_LONGTEXT, true)
 
     /* encoder submodule */
     add_submodule()
@@ -148,6 +194,15 @@ static void user_error_message(j_common_ptr p_jpeg)
     msg_Err(p_sys->p_obj, "%s", error_msg);
 }
 
+static void InitDecompress(jpeg_dec_t *p_ctx, vlc_object_t *p_obj)
+{
+    p_ctx->p_obj = p_obj;
+    p_ctx->p_row_pointers = NULL;
+    p_ctx->p_jpeg.err = jpeg_std_error(&p_ctx->err);
+    p_ctx->err.error_exit = user_error_exit;
+    p_ctx->err.output_message = user_error_message;
+}
+
 /*
  * Probe the decoder and return score
  */
@@ -169,14 +224,23 @@ static int OpenDecoder(vlc_object_t *p_this)
 
     p_dec->p_sys = p_sys;
 
-    p_sys->p_obj = p_this;
+    InitDecompress(&p_sys->dec, p_this);
 
-    p_sys->p_jpeg.err = jpeg_std_error(&p_sys->err);
-    p_sys->err.error_exit = user_error_exit;
-    p_sys->err.output_message = user_error_message;
+    p_sys->i_threads = var_InheritInteger(p_dec, "jpeg-threads");
+    if (p_sys->i_threads == 0)
+        p_sys->i_threads = __MIN(vlc_GetCPUCount(), DEC_MAX_THREADS);
+    p_sys->i_next = 0;
+    p_sys->i_output = 0;
+    p_sys->b_abort = false;
+    p_sys->p_jobs = NULL;
+    vlc_mutex_init(&p_sys->lock);
+    vlc_cond_init(&p_sys->wait);
+    if (p_sys->i_threads > 1)
+        p_dec->i_extra_picture_buffers = p_sys->i_threads;
 
     /* Set callbacks */
     p_dec->pf_decode = DecodeBlock;
+    p_dec->pf_flush  = Flush;
 
     p_dec->fmt_out.video.i_chroma =
     p_dec->fmt_out.i_codec = VLC_CODEC_RGB24;
@@ -496,101 +560,277 @@ jpeg_GetOrientation( j_decompress_ptr cinfo )
 }
 
 /*
- * This function must be fed with a complete compressed frame.
+ * Reads the headers and gets the output picture.
+ * The decompression is left running on success.
  */
-static int DecodeBlock(decoder_t *p_dec, block_t *p_block)
+static picture_t *DecodeHeader(decoder_t *p_dec, jpeg_dec_t *p_ctx,
+                               const block_t *p_block)
 {
-    decoder_sys_t *p_sys = p_dec->p_sys;
-    picture_t *p_pic = 0;
-
-    p_sys->p_row_pointers = NULL;
-
-    if (!p_block) /* No Drain */
-        return VLCDEC_SUCCESS;
-
-    if (p_block->i_flags & BLOCK_FLAG_CORRUPTED )
-    {
-        block_Release(p_block);
-        return VLCDEC_SUCCESS;
-    }
+    picture_t *p_pic;
 
     /* libjpeg longjmp's there in case of error */
-    if (setjmp(p_sys->setjmp_buffer))
+    if (setjmp(p_ctx->setjmp_buffer))
     {
-        goto error;
+        jpeg_destroy_decompress(&p_ctx->p_jpeg);
+        return NULL;
     }
 
-    jpeg_create_decompress(&p_sys->p_jpeg);
-    jpeg_mem_src(&p_sys->p_jpeg, p_block->p_buffer, p_block->i_buffer);
-    jpeg_save_markers( &p_sys->p_jpeg, EXIF_JPEG_MARKER, 0xffff );
-    jpeg_read_header(&p_sys->p_jpeg, TRUE);
+    jpeg_create_decompress(&p_ctx->p_jpeg);
+    jpeg_mem_src(&p_ctx->p_jpeg, p_block->p_buffer, p_block->i_buffer);
+    jpeg_save_markers( &p_ctx->p_jpeg, EXIF_JPEG_MARKER, 0xffff );
+    jpeg_read_header(&p_ctx->p_jpeg, TRUE);
 
-    p_sys->p_jpeg.out_color_space = JCS_RGB;
+    p_ctx->p_jpeg.out_color_space = JCS_RGB;
 
-    jpeg_start_decompress(&p_sys->p_jpeg);
+    jpeg_calc_output_dimensions(&p_ctx->p_jpeg);
 
     /* Set output properties */
-    p_dec->fmt_out.video.i_visible_width  = p_dec->fmt_out.video.i_width  = p_sys->p_jpeg.output_width;
-    p_dec->fmt_out.video.i_visible_height = p_dec->fmt_out.video.i_height = p_sys->p_jpeg.output_height;
+    p_dec->fmt_out.video.i_visible_width  = p_dec->fmt_out.video.i_width  = p_ctx->p_jpeg.output_width;
+    p_dec->fmt_out.video.i_visible_height = p_dec->fmt_out.video.i_height = p_ctx->p_jpeg.output_height;
     p_dec->fmt_out.video.i_sar_num = 1;
     p_dec->fmt_out.video.i_sar_den = 1;
 
     int i_otag; /* Orientation tag has valid range of 1-8. 1 is normal orientation, 0 = unspecified = normal */
-    i_otag = jpeg_GetOrientation( &p_sys->p_jpeg );
+    i_otag = jpeg_GetOrientation( &p_ctx->p_jpeg );
     if ( i_otag > 1 )
     {
         msg_Dbg( p_dec, "Jpeg orientation is %d", i_otag );
         p_dec->fmt_out.video.orientation = ORIENT_FROM_EXIF( i_otag );
     }
-    jpeg_GetProjection(&p_sys->p_jpeg, &p_dec->fmt_out.video);
+    jpeg_GetProjection(&p_ctx->p_jpeg, &p_dec->fmt_out.video);
 
     /* Get a new picture */
-    if (decoder_UpdateVideoFormat(p_dec))
+    if (decoder_UpdateVideoFormat(p_dec) ||
+        (p_pic = decoder_NewPicture(p_dec)) == NULL)
     {
-        goto error;
+        jpeg_destroy_decompress(&p_ctx->p_jpeg);
+        return NULL;
     }
-    p_pic = decoder_NewPicture(p_dec);
-    if (!p_pic)
+
+    p_pic->date = p_block->i_pts != VLC_TICK_INVALID ? p_block->i_pts : p_block->i_dts;
+    return p_pic;
+}
+
+/*
+ * Decompresses the picture, after DecodeHeader()
+ */
+static bool DecodePicture(jpeg_dec_t *p_ctx, picture_t *p_pic)
+{
+    p_ctx->p_row_pointers = NULL;
+
+    /* libjpeg longjmp's there in case of error */
+    if (setjmp(p_ctx->setjmp_buffer))
     {
-        goto error;
+        jpeg_destroy_decompress(&p_ctx->p_jpeg);
+        free(p_ctx->p_row_pointers);
+        return false;
     }
 
+    jpeg_start_decompress(&p_ctx->p_jpeg);
+
     /* Decode picture */
-    p_sys->p_row_pointers = vlc_alloc(p_sys->p_jpeg.output_height, sizeof(JSAMPROW));
-    if (!p_sys->p_row_pointers)
+    p_ctx->p_row_pointers = vlc_alloc(p_ctx->p_jpeg.output_height, sizeof(JSAMPROW));
+    if (!p_ctx->p_row_pointers)
     {
-        goto error;
+        jpeg_destroy_decompress(&p_ctx->p_jpeg);
+        return false;
     }
-    for (unsigned i = 0; i < p_sys->p_jpeg.output_height; i++) {
-        p_sys->p_row_pointers[i] = p_pic->p->p_pixels + p_pic->p->i_pitch * i;
+    for (unsigned i = 0; i < p_ctx->p_jpeg.output_height; i++) {
+        p_ctx->p_row_pointers[i] = p_pic->p->p_pixels + p_pic->p->i_pitch * i;
     }
 
-    while (p_sys->p_jpeg.output_scanline < p_sys->p_jpeg.output_height)
+    while (p_ctx->p_jpeg.output_scanline < p_ctx->p_jpeg.output_height)
     {
-        jpeg_read_scanlines(&p_sys->p_jpeg,
-                p_sys->p_row_pointers + p_sys->p_jpeg.output_scanline,
-                p_sys->p_jpeg.output_height - p_sys->p_jpeg.output_scanline);
+        jpeg_read_scanlines(&p_ctx->p_jpeg,
+                p_ctx->p_row_pointers + p_ctx->p_jpeg.output_scanline,
+                p_ctx->p_jpeg.output_height - p_ctx->p_jpeg.output_scanline);
     }
 
-    jpeg_finish_decompress(&p_sys->p_jpeg);
-    jpeg_destroy_decompress(&p_sys->p_jpeg);
-    free(p_sys->p_row_pointers);
+    jpeg_finish_decompress(&p_ctx->p_jpeg);
+    jpeg_destroy_decompress(&p_ctx->p_jpeg);
+    free(p_ctx->p_row_pointers);
+    return true;
+}
 
-    p_pic->date = p_block->i_pts != VLC_TICK_INVALID ? p_block->i_pts : p_block->i_dts;
+/*
+ * Outputs the decoded pictures in decoding order, lock held
+ */
+static void OutputJobs(decoder_t *p_dec)
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
 
-    block_Release(p_block);
-    decoder_QueueVideo( p_dec, p_pic );
-    return VLCDEC_SUCCESS;
+    for (;;)
+    {
+        jpeg_job_t *p_job = &p_sys->p_jobs[p_sys->i_output];
+        if (p_job->state != JOB_DONE)
+            break;
 
-error:
+        if (p_job->b_success)
+            decoder_QueueVideo(p_dec, p_job->p_pic);
+        else
+            picture_Release(p_job->p_pic);
+        p_job->p_pic = NULL;
+        p_job->state = JOB_IDLE;
+        p_sys->i_output = (p_sys->i_output + 1) % p_sys->i_threads;
+    }
+}
 
-    jpeg_destroy_decompress(&p_sys->p_jpeg);
-    free(p_sys->p_row_pointers);
+static void *DecoderThread(void *data)
+{
+    jpeg_job_t *p_job = data;
+    decoder_t *p_dec = p_job->p_dec;
+    decoder_sys_t *p_sys = p_dec->p_sys;
+
+    vlc_mutex_lock(&p_sys->lock);
+    for (;;)
+    {
+        while (p_job->state != JOB_PENDING && !p_sys->b_abort)
+            vlc_cond_wait(&p_sys->wait, &p_sys->lock);
+        if (p_job->state != JOB_PENDING)
+            break;
+        vlc_mutex_unlock(&p_sys->lock);
+
+        bool b_success = DecodePicture(&p_job->dec, p_job->p_pic);
+        block_Release(p_job->p_block);
+        p_job->p_block = NULL;
+
+        vlc_mutex_lock(&p_sys->lock);
+        p_job->b_success = b_success;
+        p_job->state = JOB_DONE;
+        OutputJobs(p_dec);
+        vlc_cond_broadcast(&p_sys->wait);
+    }
+    vlc_mutex_unlock(&p_sys->lock);
+    return NULL;
+}
+
+static void StopThreads(decoder_t *p_dec, unsigned i_count)
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+
+    vlc_mutex_lock(&p_sys->lock);
+    p_sys->b_abort = true;
+    vlc_cond_broadcast(&p_sys->wait);
+    vlc_mutex_unlock(&p_sys->lock);
+
+    for (unsigned i = 0; i < i_count; i++)
+        vlc_join(p_sys->p_jobs[i].thread, NULL);
+
+    free(p_sys->p_jobs);
+    p_sys->p_jobs = NULL;
+}
+
+static int StartThreads(decoder_t *p_dec)
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+
+    p_sys->p_jobs = vlc_alloc(p_sys->i_threads, sizeof(*p_sys->p_jobs));
+    if (p_sys->p_jobs == NULL)
+        return VLC_ENOMEM;
+
+    for (unsigned i = 0; i < p_sys->i_threads; i++)
+    {
+        jpeg_job_t *p_job = &p_sys->p_jobs[i];
+        InitDecompress(&p_job->dec, VLC_OBJECT(p_dec));
+        p_job->p_dec = p_dec;
+        p_job->p_block = NULL;
+        p_job->p_pic = NULL;
+        p_job->state = JOB_IDLE;
+        if (vlc_clone(&p_job->thread, DecoderThread, p_job,
+                      VLC_THREAD_PRIORITY_VIDEO))
+        {
+            StopThreads(p_dec, i);
+            p_sys->b_abort = false;
+            return VLC_EGENERIC;
+        }
+    }
+    msg_Dbg(p_dec, "using %u decoding threads", p_sys->i_threads);
+    return VLC_SUCCESS;
+}
+
+static void WaitJobs(decoder_sys_t *p_sys)
+{
+    vlc_mutex_lock(&p_sys->lock);
+    for (unsigned i = 0; i < p_sys->i_threads; i++)
+    {
+        while (p_sys->p_jobs[i].state != JOB_IDLE)
+            vlc_cond_wait(&p_sys->wait, &p_sys->lock);
+    }
+    vlc_mutex_unlock(&p_sys->lock);
+}
+
+/*
+ * This function must be fed with a complete compressed frame.
+ */
+static int DecodeBlock(decoder_t *p_dec, block_t *p_block)
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+
+    if (!p_block) /* Drain */
+    {
+        if (p_sys->p_jobs != NULL)
+            WaitJobs(p_sys);
+        return VLCDEC_SUCCESS;
+    }
+
+    if (p_block->i_flags & BLOCK_FLAG_CORRUPTED )
+    {
+        block_Release(p_block);
+        return VLCDEC_SUCCESS;
+    }
+
+    if (p_sys->p_jobs == NULL)
+    {
+        picture_t *p_pic = DecodeHeader(p_dec, &p_sys->dec, p_block);
+        if (p_pic != NULL)
+        {
+            if (DecodePicture(&p_sys->dec, p_pic))
+                decoder_QueueVideo(p_dec, p_pic);
+            else
+                picture_Release(p_pic);
+        }
+        block_Release(p_block);
+
+        /* Use threads for streams, not for single images */
+        if (p_sys->i_threads > 1 && StartThreads(p_dec) != VLC_SUCCESS)
+            p_sys->i_threads = 1;
+        return VLCDEC_SUCCESS;
+    }
+
+    jpeg_job_t *p_job = &p_sys->p_jobs[p_sys->i_next];
+
+    vlc_mutex_lock(&p_sys->lock);
+    while (p_job->state != JOB_IDLE)
+        vlc_cond_wait(&p_sys->wait, &p_sys->lock);
+    vlc_mutex_unlock(&p_sys->lock);
+
+    /* Format changes and picture allocations stay serialized here */
+    picture_t *p_pic = DecodeHeader(p_dec, &p_job->dec, p_block);
+    if (p_pic == NULL)
+    {
+        block_Release(p_block);
+        return VLCDEC_SUCCESS;
+    }
+
+    vlc_mutex_lock(&p_sys->lock);
+    p_job->p_block = p_block;
+    p_job->p_pic = p_pic;
+    p_job->state = JOB_PENDING;
+    p_sys->i_next = (p_sys->i_next + 1) % p_sys->i_threads;
+    vlc_cond_broadcast(&p_sys->wait);
+    vlc_mutex_unlock(&p_sys->lock);
 
-    block_Release(p_block);
     return VLCDEC_SUCCESS;
 }
 
+static void Flush(decoder_t *p_dec)
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+
+    if (p_sys->p_jobs != NULL)
+        WaitJobs(p_sys);
+}
+
 /*
  * jpeg decoder destruction
  */
@@ -599,6 +839,11 @@ static void CloseDecoder(vlc_object_t *p_this)
     decoder_t *p_dec = (decoder_t *)p_this;
     decoder_sys_t *p_sys = p_dec->p_sys;
 
+    if (p_sys->p_jobs != NULL)
+    {
+        WaitJobs(p_sys);
+        StopThreads(p_dec, p_sys->i_threads);
+    }
     free(p_sys);
 }
 
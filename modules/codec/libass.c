@@ -714,14 +714,22 @@ static void RegionDraw( subpicture_region_t *p_region, ASS_Image *p_img )
 
         for( y = 0; y < p_img->h; y++ )
         {
+            const uint8_t *p_bitmap = &p_img->bitmap[y*p_img->stride];
+            uint8_t *p_line = &p->p_pixels[(y+p_img->dst_y-i_y) * p->i_pitch + 4 * (p_img->dst_x-i_x)];
+
             for( x = 0; x < p_img->w; x++ )
             {
-                const unsigned alpha = p_img->bitmap[y*p_img->stride+x];
+                const unsigned alpha = p_bitmap[x];
                 const unsigned an = (255 - a) * alpha / 255;
 
-                uint8_t *p_rgba = &p->p_pixels[(y+p_img->dst_y-i_y) * p->i_pitch + 4 * (x+p_img->dst_x-i_x)];
+                uint8_t *p_rgba = &p_line[4 * x];
                 const unsigned ao = p_rgba[3];
 
+                /* Most of the glyph bitmaps is transparent: blending a
+                 * transparent pixel over an opaque one leaves it unchanged */
+                if( an == 0 && ao != 0 )
+                    continue;
+
                 /* Native endianness, but RGBA ordering */
                 if( ao == 0 )
                 {
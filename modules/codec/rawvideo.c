@@ -31,6 +31,12 @@
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
 
+#ifdef HAVE_LINUX_DMA_HEAP_H
+# include "../hw/dmabuf/vlc_dmabuf.h"
+/* Pictures held by the video output and the decoder */
+# define DMABUF_POOL_SIZE 10
+#endif
+
 /*****************************************************************************
  * decoder_sys_t : raw video decoder descriptor
  *****************************************************************************/
@@ -47,14 +53,27 @@ typedef struct
      * Common properties
      */
     date_t pts;
+
+#ifdef HAVE_LINUX_DMA_HEAP_H
+    /* DMA-BUF pictures, for the displays which can import them */
+    vlc_video_context *vctx;
+    picture_pool_t *pool;
+#endif
 } decoder_sys_t;
 
 /****************************************************************************
  * Local prototypes
  ****************************************************************************/
 static int  OpenDecoder   ( vlc_object_t * );
+static void CloseDecoder  ( vlc_object_t * );
 static int  OpenPacketizer( vlc_object_t * );
 
+#define DMA_HEAP_TEXT N_("DMA-BUF heap")
+#define DMA_HEAP_LONGTEXT N_( \
+    "Decode into DMA-BUF buffers allocated from this heap of /dev/dma_heap " \
+    "(such as \"system\" or \"linux,cma\"), which the OpenGL display can " \
+    "import without uploading textures.")
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -63,7 +82,10 @@ vlc_module_begin ()
     set_capability( "video decoder", 50 )
     set_category( CAT_INPUT )
     set_subcategory( SUBCAT_INPUT_VCODEC )
-    set_callback( OpenDecoder )
+    set_callbacks( OpenDecoder, CloseDecoder )
+#ifdef HAVE_LINUX_DMA_HEAP_H
+    add_string( "rawvideo-dma-heap", NULL, DMA_HEAP_TEXT, DMA_HEAP_LONGTEXT, true )
+#endif
 
     add_submodule ()
     set_description( N_("Pseudo raw video packetizer") )
@@ -243,6 +265,16 @@ static int DecodeFrame( decoder_t *p_dec, block_t *p_block )
 
     /* Get a new picture */
     picture_t *p_pic = NULL;
+#ifdef HAVE_LINUX_DMA_HEAP_H
+    if( p_sys->pool != NULL )
+    {
+        if( !decoder_UpdateVideoOutput( p_dec, p_sys->vctx ) )
+            p_pic = picture_pool_Get( p_sys->pool );
+        if( p_pic != NULL )
+            vlc_dmabuf_PicAttachContext( p_pic );
+    }
+    else
+#endif
     if( !decoder_UpdateVideoFormat( p_dec ) )
         p_pic = decoder_NewPicture( p_dec );
     if( p_pic == NULL )
@@ -251,6 +283,15 @@ static int DecodeFrame( decoder_t *p_dec, block_t *p_block )
         return VLCDEC_SUCCESS;
     }
 
+#ifdef HAVE_LINUX_DMA_HEAP_H
+    if( p_sys->pool != NULL )
+    {
+        vlc_dmabuf_PicBeginWrite( p_pic );
+        FillPicture( p_dec, p_block, p_pic );
+        vlc_dmabuf_PicEndWrite( p_pic );
+    }
+    else
+#endif
     FillPicture( p_dec, p_block, p_pic );
 
     /* Date management: 1 frame per packet */
@@ -274,6 +315,38 @@ static int DecodeFrame( decoder_t *p_dec, block_t *p_block )
     return VLCDEC_SUCCESS;
 }
 
+#ifdef HAVE_LINUX_DMA_HEAP_H
+static void OpenDmabuf( decoder_t *p_dec )
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+    char *heap = var_InheritString( p_dec, "rawvideo-dma-heap" );
+    if( heap == NULL )
+        return;
+
+    if( vlc_dmabuf_IsChromaSupported( p_dec->fmt_out.video.i_chroma ) )
+    {
+        p_sys->vctx = vlc_video_context_Create( NULL, VLC_VIDEO_CONTEXT_DMABUF,
+                                                0, NULL );
+        if( p_sys->vctx != NULL )
+        {
+            p_sys->pool = vlc_dmabuf_PoolNew( VLC_OBJECT(p_dec), p_sys->vctx,
+                                              heap, DMABUF_POOL_SIZE,
+                                              &p_dec->fmt_out.video );
+            if( p_sys->pool == NULL )
+            {
+                vlc_video_context_Release( p_sys->vctx );
+                p_sys->vctx = NULL;
+            }
+        }
+    }
+
+    if( p_sys->pool == NULL )
+        msg_Warn( p_dec, "cannot decode %4.4s into DMA-BUF pictures",
+                  (const char *)&p_dec->fmt_out.video.i_chroma );
+    free( heap );
+}
+#endif
+
 static int OpenDecoder( vlc_object_t *p_this )
 {
     decoder_t *p_dec = (decoder_t *)p_this;
@@ -281,12 +354,31 @@ static int OpenDecoder( vlc_object_t *p_this )
     int ret = OpenCommon( p_dec );
     if( ret == VLC_SUCCESS )
     {
+#ifdef HAVE_LINUX_DMA_HEAP_H
+        OpenDmabuf( p_dec );
+#endif
         p_dec->pf_decode = DecodeFrame;
         p_dec->pf_flush  = Flush;
     }
     return ret;
 }
 
+static void CloseDecoder( vlc_object_t *p_this )
+{
+#ifdef HAVE_LINUX_DMA_HEAP_H
+    decoder_t *p_dec = (decoder_t *)p_this;
+    decoder_sys_t *p_sys = p_dec->p_sys;
+
+    if( p_sys->pool != NULL )
+    {
+        picture_pool_Release( p_sys->pool );
+        vlc_video_context_Release( p_sys->vctx );
+    }
+#else
+    VLC_UNUSED(p_this);
+#endif
+}
+
 /*****************************************************************************
  * SendFrame: send a video frame to the stream output.
  *****************************************************************************/
@@ -45,6 +45,7 @@
 #endif
 
 #include <ctype.h>
+#include <stddef.h>
 
 //#define SUBSVTT_DEBUG
 
@@ -55,11 +56,13 @@
 typedef struct webvtt_region_t webvtt_region_t;
 typedef struct webvtt_dom_node_t webvtt_dom_node_t;
 typedef struct webvtt_dom_cue_t webvtt_dom_cue_t;
+typedef struct webvtt_arena_t webvtt_arena_t;
 
 #define WEBVTT_REGION_LINES_COUNT          18
 #define WEBVTT_DEFAULT_LINE_HEIGHT_VH    5.33
 #define WEBVTT_LINE_TO_HEIGHT_RATIO      1.06
 #define WEBVTT_MAX_DEPTH                 20 /* recursion prevention for now */
+#define WEBVTT_ARENA_CHUNK             1024
 
 enum webvtt_align_e
 {
@@ -118,6 +121,16 @@ struct webvtt_region_t
     webvtt_dom_node_t *p_child;
 };
 
+/* The text and tag nodes of a cue are allocated from its arena, and freed
+ * all at once with it */
+struct webvtt_arena_t
+{
+    webvtt_arena_t *p_next;
+    size_t i_used;
+    size_t i_size;
+    max_align_t data[];
+};
+
 struct webvtt_dom_cue_t
 {
     WEBVTT_NODE_BASE_MEMBERS
@@ -126,8 +139,10 @@ struct webvtt_dom_cue_t
     vlc_tick_t i_stop;
     webvtt_cue_settings_t settings;
     unsigned i_lines;
+    uint64_t i_hash; /* of the cue boxes, to spot the repeated cues */
     text_style_t *p_cssstyle;
     webvtt_dom_node_t *p_child;
+    webvtt_arena_t *p_arena;
 };
 
 typedef struct
@@ -154,9 +169,11 @@ struct webvtt_dom_node_t
 typedef struct
 {
     webvtt_dom_tag_t *p_root;
+    bool b_tree_changed; /* cues were added or removed since the last styling */
 #ifdef HAVE_CSS
     /* CSS */
     vlc_css_rule_t *p_css_rules;
+    bool b_css_timed; /* rules with :past or :future */
 #endif
 } decoder_sys_t;
 
@@ -447,12 +464,6 @@ static void webvtt_domnode_ChainDelete( webvtt_dom_node_t *p_node );
 static void webvtt_dom_cue_Delete( webvtt_dom_cue_t *p_cue );
 static void webvtt_region_Delete( webvtt_region_t *p_region );
 
-static void webvtt_dom_text_Delete( webvtt_dom_text_t *p_node )
-{
-    free( p_node->psz_text );
-    free( p_node );
-}
-
 static void webvtt_dom_tag_Delete( webvtt_dom_tag_t *p_node )
 {
     text_style_Delete( p_node->p_cssstyle );
@@ -473,6 +484,8 @@ static void webvtt_domnode_AppendLast( webvtt_dom_node_t **pp_append,
 #define webvtt_domnode_AppendLast( a, b ) \
     webvtt_domnode_AppendLast( (webvtt_dom_node_t **) a, (webvtt_dom_node_t *) b )
 
+/* The text and tags of the cues are freed with their arena, only the root
+ * tag is deleted here */
 static void webvtt_domnode_ChainDelete( webvtt_dom_node_t *p_node )
 {
     while( p_node )
@@ -481,8 +494,6 @@ static void webvtt_domnode_ChainDelete( webvtt_dom_node_t *p_node )
 
         if( p_node->type == NODE_TAG )
             webvtt_dom_tag_Delete( (webvtt_dom_tag_t *) p_node );
-        else if( p_node->type == NODE_TEXT )
-            webvtt_dom_text_Delete( (webvtt_dom_text_t *) p_node );
         else if( p_node->type == NODE_CUE )
             webvtt_dom_cue_Delete( (webvtt_dom_cue_t *) p_node );
         else if( p_node->type == NODE_REGION )
@@ -492,9 +503,52 @@ static void webvtt_domnode_ChainDelete( webvtt_dom_node_t *p_node )
     }
 }
 
-static webvtt_dom_text_t * webvtt_dom_text_New( webvtt_dom_node_t *p_parent )
+static void *webvtt_arena_Alloc( webvtt_arena_t **pp_arena, size_t i_size )
+{
+    webvtt_arena_t *p_arena = *pp_arena;
+
+    i_size = ( i_size + sizeof(max_align_t) - 1 ) & ~( sizeof(max_align_t) - 1 );
+    if( p_arena == NULL || p_arena->i_size - p_arena->i_used < i_size )
+    {
+        size_t i_chunk = __MAX( i_size, WEBVTT_ARENA_CHUNK );
+        p_arena = malloc( sizeof(*p_arena) + i_chunk );
+        if( unlikely(p_arena == NULL) )
+            return NULL;
+        p_arena->i_used = 0;
+        p_arena->i_size = i_chunk;
+        p_arena->p_next = *pp_arena;
+        *pp_arena = p_arena;
+    }
+
+    void *p = (uint8_t *) p_arena->data + p_arena->i_used;
+    p_arena->i_used += i_size;
+    return memset( p, 0, i_size );
+}
+
+static char *webvtt_arena_strndup( webvtt_arena_t **pp_arena,
+                                   const char *psz, size_t i_len )
 {
-    webvtt_dom_text_t *p_node = calloc( 1, sizeof(*p_node) );
+    i_len = strnlen( psz, i_len );
+    char *psz_dup = webvtt_arena_Alloc( pp_arena, i_len + 1 );
+    if( psz_dup )
+        memcpy( psz_dup, psz, i_len );
+    return psz_dup;
+}
+
+static void webvtt_arena_Delete( webvtt_arena_t *p_arena )
+{
+    while( p_arena )
+    {
+        webvtt_arena_t *p_next = p_arena->p_next;
+        free( p_arena );
+        p_arena = p_next;
+    }
+}
+
+static webvtt_dom_text_t * webvtt_dom_text_New( webvtt_arena_t **pp_arena,
+                                                webvtt_dom_node_t *p_parent )
+{
+    webvtt_dom_text_t *p_node = webvtt_arena_Alloc( pp_arena, sizeof(*p_node) );
     if( p_node )
     {
         p_node->type = NODE_TEXT;
@@ -503,9 +557,12 @@ static webvtt_dom_text_t * webvtt_dom_text_New( webvtt_dom_node_t *p_parent )
     return p_node;
 }
 
-static webvtt_dom_tag_t * webvtt_dom_tag_New( webvtt_dom_node_t *p_parent )
+/* pp_arena is NULL for a tag outside any cue */
+static webvtt_dom_tag_t * webvtt_dom_tag_New( webvtt_arena_t **pp_arena,
+                                              webvtt_dom_node_t *p_parent )
 {
-    webvtt_dom_tag_t *p_node = calloc( 1, sizeof(*p_node) );
+    webvtt_dom_tag_t *p_node = pp_arena ? webvtt_arena_Alloc( pp_arena, sizeof(*p_node) )
+                                        : calloc( 1, sizeof(*p_node) );
     if( p_node )
     {
         p_node->i_start = -1;
@@ -945,9 +1002,24 @@ static webvtt_dom_cue_t * webvtt_dom_cue_New( vlc_tick_t i_start, vlc_tick_t i_e
     return p_cue;
 }
 
+/* Releases what the nodes of a cue hold outside of its arena */
+static void webvtt_domnode_ChainClean( webvtt_dom_node_t *p_node )
+{
+    for( ; p_node; p_node = p_node->p_next )
+    {
+        if( p_node->type != NODE_TAG )
+            continue;
+        webvtt_dom_tag_t *p_tag = (webvtt_dom_tag_t *) p_node;
+        text_style_Delete( p_tag->p_cssstyle );
+        webvtt_domnode_ChainClean( p_tag->p_child );
+    }
+}
+
 static void webvtt_dom_cue_ClearText( webvtt_dom_cue_t *p_cue )
 {
-    webvtt_domnode_ChainDelete( p_cue->p_child );
+    webvtt_domnode_ChainClean( p_cue->p_child );
+    webvtt_arena_Delete( p_cue->p_arena );
+    p_cue->p_arena = NULL;
     p_cue->p_child = NULL;
     p_cue->i_lines = 0;
 }
@@ -973,19 +1045,17 @@ static unsigned webvtt_dom_cue_Reduced( webvtt_dom_cue_t *p_cue )
         if( p_node->type != NODE_TEXT )
             continue;
         webvtt_dom_text_t *p_textnode = (webvtt_dom_text_t *) p_node;
-        const char *nl = strchr( p_textnode->psz_text, '\n' );
+        if( p_textnode->psz_text == NULL )
+            continue;
+        char *nl = strchr( p_textnode->psz_text, '\n' );
         if( nl )
         {
-            size_t i_len = strlen( p_textnode->psz_text );
-            size_t i_remain = i_len - (nl - p_textnode->psz_text);
-            char *psz_new = strndup( nl + 1, i_remain );
-            free( p_textnode->psz_text );
-            p_textnode->psz_text = psz_new;
+            /* the text belongs to the cue arena */
+            p_textnode->psz_text = nl + 1;
             return --p_cue->i_lines;
         }
         else
         {
-            free( p_textnode->psz_text );
             p_textnode->psz_text = NULL;
             /* FIXME: probably can do a local nodes cleanup */
         }
@@ -1077,8 +1147,9 @@ static void webvtt_region_ClearCues( webvtt_region_t *p_region )
     p_region->p_child = NULL;
 }
 
-static void ClearCuesByTime( webvtt_dom_node_t **pp_next, vlc_tick_t i_time )
+static bool ClearCuesByTime( webvtt_dom_node_t **pp_next, vlc_tick_t i_time )
 {
+    bool b_cleared = false;
     while( *pp_next )
     {
         webvtt_dom_node_t *p_node = *pp_next;
@@ -1092,17 +1163,46 @@ static void ClearCuesByTime( webvtt_dom_node_t **pp_next, vlc_tick_t i_time )
                     *pp_next = p_node->p_next;
                     p_node->p_next = NULL;
                     webvtt_dom_cue_Delete( p_cue );
+                    b_cleared = true;
                     continue;
                 }
             }
             else if( p_node->type == NODE_REGION )
             {
                 webvtt_region_t *p_region = (webvtt_region_t *) p_node;
-                ClearCuesByTime( &p_region->p_child, i_time );
+                b_cleared |= ClearCuesByTime( &p_region->p_child, i_time );
             }
             pp_next = &p_node->p_next;
         }
     }
+    return b_cleared;
+}
+
+/* Finds the cue of the previous sample that a sample repeats */
+static webvtt_dom_cue_t * FindRepeatedCue( webvtt_dom_node_t *p_node,
+                                           const char *psz_id, uint64_t i_hash,
+                                           vlc_tick_t i_start )
+{
+    for( ; p_node; p_node = p_node->p_next )
+    {
+        if( p_node->type == NODE_CUE )
+        {
+            webvtt_dom_cue_t *p_cue = (webvtt_dom_cue_t *)p_node;
+            if( p_cue->i_stop == i_start && p_cue->i_hash == i_hash &&
+                ( p_cue->psz_id == psz_id ||
+                  ( p_cue->psz_id && psz_id && !strcmp( p_cue->psz_id, psz_id ) ) ) )
+                return p_cue;
+        }
+        else if( p_node->type == NODE_REGION )
+        {
+            webvtt_region_t *p_region = (webvtt_region_t *) p_node;
+            webvtt_dom_cue_t *p_cue = FindRepeatedCue( p_region->p_child, psz_id,
+                                                       i_hash, i_start );
+            if( p_cue )
+                return p_cue;
+        }
+    }
+    return NULL;
 }
 
 /* Remove top most line/cue for bottom insert */
@@ -1205,7 +1305,8 @@ static unsigned CountNewLines( const char *psz )
     return i;
 }
 
-static webvtt_dom_node_t * CreateDomNodes( const char *psz_text, unsigned *pi_lines )
+static webvtt_dom_node_t * CreateDomNodes( webvtt_arena_t **pp_arena,
+                                           const char *psz_text, unsigned *pi_lines )
 {
     webvtt_dom_node_t *p_head = NULL;
     webvtt_dom_node_t **pp_append = &p_head;
@@ -1220,10 +1321,11 @@ static webvtt_dom_node_t * CreateDomNodes( const char *psz_text, unsigned *pi_li
         {
             if( psz_tag - psz_text > 0 )
             {
-                webvtt_dom_text_t *p_node = webvtt_dom_text_New( p_parent );
+                webvtt_dom_text_t *p_node = webvtt_dom_text_New( pp_arena, p_parent );
                 if( p_node )
                 {
-                    p_node->psz_text = strndup( psz_text, psz_tag - psz_text );
+                    p_node->psz_text = webvtt_arena_strndup( pp_arena, psz_text,
+                                                             psz_tag - psz_text );
                     *pi_lines += ((*pi_lines == 0) ? 1 : 0) + CountNewLines( p_node->psz_text );
                     *pp_append = (webvtt_dom_node_t *) p_node;
                     pp_append = &p_node->p_next;
@@ -1232,15 +1334,16 @@ static webvtt_dom_node_t * CreateDomNodes( const char *psz_text, unsigned *pi_li
 
             if( ! IsEndTag( psz_tag ) )
             {
-                webvtt_dom_tag_t *p_node = webvtt_dom_tag_New( p_parent );
+                webvtt_dom_tag_t *p_node = webvtt_dom_tag_New( pp_arena, p_parent );
                 if( p_node )
                 {
                     const char *psz_attrs = NULL;
                     size_t i_name;
                     const char *psz_name = SplitTag( psz_tag, &i_name, &psz_attrs );
-                    p_node->psz_tag = strndup( psz_name, i_name );
+                    p_node->psz_tag = webvtt_arena_strndup( pp_arena, psz_name, i_name );
                     if( psz_attrs != psz_taglast )
-                        p_node->psz_attrs = strndup( psz_attrs, psz_taglast - psz_attrs );
+                        p_node->psz_attrs = webvtt_arena_strndup( pp_arena, psz_attrs,
+                                                                  psz_taglast - psz_attrs );
                     /* <hh:mm::ss:fff> time tags */
                     if( p_node->psz_attrs && isdigit(p_node->psz_attrs[0]) )
                         (void) webvtt_scan_time( p_node->psz_attrs, &p_node->i_start );
@@ -1256,7 +1359,7 @@ static webvtt_dom_node_t * CreateDomNodes( const char *psz_text, unsigned *pi_li
                     const char *psz_attrs = NULL;
                     size_t i_name;
                     const char *psz_name = SplitTag( psz_tag, &i_name, &psz_attrs );
-                    char *psz_tagname = strndup( psz_name, i_name );
+                    char *psz_tagname = webvtt_arena_strndup( pp_arena, psz_name, i_name );
 
                     /* Close at matched parent node level due to unclosed tags
                      * like <b><v stuff>foo</b> */
@@ -1270,8 +1373,6 @@ static webvtt_dom_node_t * CreateDomNodes( const char *psz_text, unsigned *pi_li
                         pp_append = &p_head->p_next;
                     while( *pp_append )
                         pp_append = &((*pp_append)->p_next);
-
-                    free( psz_tagname );
                 }
                 else break; /* End tag for non open tag */
             }
@@ -1279,10 +1380,10 @@ static webvtt_dom_node_t * CreateDomNodes( const char *psz_text, unsigned *pi_li
         }
         else /* Special case: end */
         {
-            webvtt_dom_text_t *p_node = webvtt_dom_text_New( p_parent );
+            webvtt_dom_text_t *p_node = webvtt_dom_text_New( pp_arena, p_parent );
             if( p_node )
             {
-                p_node->psz_text = strdup( psz_text );
+                p_node->psz_text = webvtt_arena_strndup( pp_arena, psz_text, SIZE_MAX );
                 *pi_lines += ((*pi_lines == 0) ? 1 : 0) + CountNewLines( p_node->psz_text );
                 *pp_append = (webvtt_dom_node_t *) p_node;
             }
@@ -1299,7 +1400,7 @@ static void ProcessCue( decoder_t *p_dec, const char *psz, webvtt_dom_cue_t *p_c
 
     if( p_cue->p_child )
         return;
-    p_cue->p_child = CreateDomNodes( psz, &p_cue->i_lines );
+    p_cue->p_child = CreateDomNodes( &p_cue->p_arena, psz, &p_cue->i_lines );
     for( webvtt_dom_node_t *p_child = p_cue->p_child; p_child; p_child = p_child->p_next )
         p_child->p_parent = (webvtt_dom_node_t *)p_cue;
 #ifdef SUBSVTT_DEBUG
@@ -1398,15 +1499,21 @@ static text_style_t * ComputeStyle( decoder_t *p_dec, const webvtt_dom_node_t *p
                         { "blue",   0x0000FF },
                         { "black",  0x000000 },
                     };
-                    char *saveptr = NULL;
-                    char *psz_tok = strtok_r( p_tagnode->psz_attrs, ".", &saveptr );
-                    for( ; psz_tok; psz_tok = strtok_r( NULL, ".", &saveptr ) )
+                    /* The tree is rendered again while the cue lasts: the
+                     * attributes must be left untouched */
+                    for( const char *psz_tok = p_tagnode->psz_attrs; *psz_tok; )
                     {
-                        bool bg = !strncmp( psz_tok, "bg_", 3 );
+                        size_t i_tok = strcspn( psz_tok, "." );
+                        bool bg = i_tok >= 3 && !strncmp( psz_tok, "bg_", 3 );
                         const char *psz_class = (bg) ? psz_tok + 3 : psz_tok;
+                        size_t i_class = (bg) ? i_tok - 3 : i_tok;
+                        psz_tok += i_tok;
+                        if( *psz_tok == '.' )
+                            psz_tok++;
                         for( size_t i=0; i<ARRAY_SIZE(CEAcolors); i++ )
                         {
-                            if( strcmp( psz_class, CEAcolors[i].psz ) )
+                            if( strlen( CEAcolors[i].psz ) != i_class ||
+                                strncmp( psz_class, CEAcolors[i].psz, i_class ) )
                                 continue;
                             if( p_dfltstyle ||
                                (p_dfltstyle = text_style_Create( STYLE_NO_DEFAULTS )) )
@@ -1728,8 +1835,12 @@ static void RenderRegions( decoder_t *p_dec, vlc_tick_t i_start, vlc_tick_t i_st
     decoder_sys_t *p_sys = p_dec->p_sys;
 
 #ifdef HAVE_CSS
-    ApplyCSSRules( p_dec, p_sys->p_css_rules, i_start );
+    /* The styles stay valid until the tree changes, unless they depend on
+     * the playback time */
+    if( p_sys->b_tree_changed || p_sys->b_css_timed )
+        ApplyCSSRules( p_dec, p_sys->p_css_rules, i_start );
 #endif
+    p_sys->b_tree_changed = false;
 
     const webvtt_dom_cue_t *p_rlcue = NULL;
     for( const webvtt_dom_node_t *p_node = p_sys->p_root->p_child;
@@ -1873,7 +1984,10 @@ static void Render( decoder_t *p_dec, vlc_tick_t i_start, vlc_tick_t i_stop )
          if( p_tag->i_start != i_substart ) /* might be duplicates */
          {
              if( i > 0 )
+             {
                  ClearCSSStyles( (webvtt_dom_node_t *)p_sys->p_root );
+                 p_sys->b_tree_changed = true;
+             }
              RenderRegions( p_dec, i_substart, p_tag->i_start );
              i_substart = p_tag->i_start;
          }
@@ -1881,27 +1995,80 @@ static void Render( decoder_t *p_dec, vlc_tick_t i_start, vlc_tick_t i_stop )
     if( i_substart != i_stop )
     {
         if( i_substart != i_start )
+        {
             ClearCSSStyles( (webvtt_dom_node_t *)p_sys->p_root );
+            p_sys->b_tree_changed = true;
+        }
         RenderRegions( p_dec, i_substart, i_stop );
     }
 
     vlc_array_clear( &timedtags );
 }
 
-static int ProcessISOBMFF( decoder_t *p_dec,
-                           const uint8_t *p_buffer, size_t i_buffer,
-                           vlc_tick_t i_start, vlc_tick_t i_stop )
+static uint64_t HashCueBoxes( const uint8_t *p_buffer, size_t i_buffer )
+{
+    /* FNV-1a over the identifier, settings and payload boxes */
+    uint64_t i_hash = UINT64_C(0xcbf29ce484222325);
+    mp4_box_iterator_t it;
+    mp4_box_iterator_Init( &it, p_buffer, i_buffer );
+    while( mp4_box_iterator_Next( &it ) )
+    {
+        if( it.i_type != ATOM_iden && it.i_type != ATOM_sttg &&
+            it.i_type != ATOM_payl )
+            continue;
+        i_hash = ( i_hash ^ it.i_type ) * UINT64_C(0x100000001b3);
+        for( size_t i = 0; i < it.i_payload; i++ )
+            i_hash = ( i_hash ^ it.p_payload[i] ) * UINT64_C(0x100000001b3);
+    }
+    return i_hash;
+}
+
+static char * GetCueId( const uint8_t *p_buffer, size_t i_buffer )
+{
+    mp4_box_iterator_t it;
+    mp4_box_iterator_Init( &it, p_buffer, i_buffer );
+    while( mp4_box_iterator_Next( &it ) )
+    {
+        if( it.i_type == ATOM_iden )
+            return strndup( (char *) it.p_payload, it.i_payload );
+    }
+    return NULL;
+}
+
+/* Returns the new cues, the cues repeated from the previous sample are
+ * extended instead */
+static webvtt_dom_cue_t * ProcessISOBMFF( decoder_t *p_dec,
+                                          const uint8_t *p_buffer, size_t i_buffer,
+                                          vlc_tick_t i_start, vlc_tick_t i_stop )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
+    webvtt_dom_cue_t *p_new = NULL;
+    webvtt_dom_cue_t **pp_append = &p_new;
     mp4_box_iterator_t it;
     mp4_box_iterator_Init( &it, p_buffer, i_buffer );
     while( mp4_box_iterator_Next( &it ) )
     {
         if( it.i_type == ATOM_vttc || it.i_type == ATOM_vttx )
         {
-            webvtt_dom_cue_t *p_cue = webvtt_dom_cue_New( i_start, i_stop );
+            const uint64_t i_hash = HashCueBoxes( it.p_payload, it.i_payload );
+            char *psz_id = GetCueId( it.p_payload, it.i_payload );
+            webvtt_dom_cue_t *p_cue = FindRepeatedCue( p_sys->p_root->p_child,
+                                                       psz_id, i_hash, i_start );
+            if( p_cue )
+            {
+                p_cue->i_stop = i_stop;
+                free( psz_id );
+                continue;
+            }
+
+            p_cue = webvtt_dom_cue_New( i_start, i_stop );
             if( !p_cue )
+            {
+                free( psz_id );
                 continue;
+            }
+            p_cue->psz_id = psz_id;
+            p_cue->i_hash = i_hash;
 
             mp4_box_iterator_t vtcc;
             mp4_box_iterator_Init( &vtcc, it.p_payload, it.i_payload );
@@ -1910,10 +2077,6 @@ static int ProcessISOBMFF( decoder_t *p_dec,
                 char *psz = NULL;
                 switch( vtcc.i_type )
                 {
-                    case ATOM_iden:
-                        free( p_cue->psz_id );
-                        p_cue->psz_id = strndup( (char *) vtcc.p_payload, vtcc.i_payload );
-                        break;
                     case ATOM_sttg:
                     {
                         psz = strndup( (char *) vtcc.p_payload, vtcc.i_payload );
@@ -1930,23 +2093,56 @@ static int ProcessISOBMFF( decoder_t *p_dec,
                 free( psz );
             }
 
-            webvtt_region_t *p_region = webvtt_region_GetByID( p_sys,
-                                                               p_cue->settings.psz_region );
-            if( p_region )
-            {
-                webvtt_region_AddCue( p_region, p_cue );
-                assert( p_region->p_child );
-            }
-            else
-            {
-                webvtt_domnode_AppendLast( &p_sys->p_root->p_child, p_cue );
-                p_cue->p_parent = (webvtt_dom_node_t *) p_sys->p_root;
-            }
+            *pp_append = p_cue;
+            pp_append = (webvtt_dom_cue_t **) &p_cue->p_next;
         }
     }
-    return 0;
+    return p_new;
 }
 
+static void AddCues( decoder_t *p_dec, webvtt_dom_cue_t *p_cue )
+{
+    decoder_sys_t *p_sys = p_dec->p_sys;
+
+    while( p_cue )
+    {
+        webvtt_dom_cue_t *p_next = (webvtt_dom_cue_t *) p_cue->p_next;
+        p_cue->p_next = NULL;
+
+        webvtt_region_t *p_region = webvtt_region_GetByID( p_sys,
+                                                           p_cue->settings.psz_region );
+        if( p_region )
+        {
+            webvtt_region_AddCue( p_region, p_cue );
+            assert( p_region->p_child );
+        }
+        else
+        {
+            webvtt_domnode_AppendLast( &p_sys->p_root->p_child, p_cue );
+            p_cue->p_parent = (webvtt_dom_node_t *) p_sys->p_root;
+        }
+        p_sys->b_tree_changed = true;
+        p_cue = p_next;
+    }
+}
+
+#ifdef HAVE_CSS
+static bool IsTimedSelector( const vlc_css_selector_t *p_sel )
+{
+    for( ; p_sel; p_sel = p_sel->p_next )
+    {
+        if( p_sel->type == SELECTOR_PSEUDOCLASS && p_sel->psz_name &&
+            ( !strcmp( p_sel->psz_name, "past" ) ||
+              !strcmp( p_sel->psz_name, "future" ) ) )
+            return true;
+        if( IsTimedSelector( p_sel->specifiers.p_first ) ||
+            IsTimedSelector( p_sel->p_matchsel ) )
+            return true;
+    }
+    return false;
+}
+#endif
+
 struct parser_ctx
 {
     webvtt_region_t *p_region;
@@ -1997,6 +2193,10 @@ static void ParserHeaderHandler( void *priv, enum webvtt_header_line_e s,
                 *pp_append = p.rules.p_first;
                 p.rules.p_first = NULL;
 
+                for( const vlc_css_rule_t *p_rule = *pp_append; p_rule;
+                                           p_rule = p_rule->p_next )
+                    p_sys->b_css_timed |= IsTimedSelector( p_rule->p_selectors );
+
                 vlc_css_parser_Clean(&p);
                 free( ctx->css.ptr );
             }
@@ -2065,7 +2265,8 @@ static void LoadExtradata( decoder_t *p_dec )
 static void Flush( decoder_t *p_dec )
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
-    ClearCuesByTime( &p_sys->p_root->p_child, INT64_MAX );
+    if( ClearCuesByTime( &p_sys->p_root->p_child, INT64_MAX ) )
+        p_sys->b_tree_changed = true;
 }
 
 /****************************************************************************
@@ -2083,11 +2284,13 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
 
     if( p_block->i_flags & BLOCK_FLAG_DISCONTINUITY )
         Flush( p_dec );
-    else
-        ClearCuesByTime( &p_sys->p_root->p_child, i_start );
 
-    ProcessISOBMFF( p_dec, p_block->p_buffer, p_block->i_buffer,
-                    i_start, i_stop );
+    /* Extend the cues that persist across samples before the others end */
+    webvtt_dom_cue_t *p_new = ProcessISOBMFF( p_dec, p_block->p_buffer,
+                                              p_block->i_buffer, i_start, i_stop );
+    if( ClearCuesByTime( &p_sys->p_root->p_child, i_start ) )
+        p_sys->b_tree_changed = true;
+    AddCues( p_dec, p_new );
 
     Render( p_dec, i_start, i_stop );
 
@@ -2128,7 +2331,7 @@ int webvtt_OpenDecoder( vlc_object_t *p_this )
     if( unlikely( p_sys == NULL ) )
         return VLC_ENOMEM;
 
-    p_sys->p_root = webvtt_dom_tag_New( NULL );
+    p_sys->p_root = webvtt_dom_tag_New( NULL, NULL );
     if( !p_sys->p_root )
     {
         free( p_sys );
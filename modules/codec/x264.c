@@ -762,6 +762,7 @@ typedef struct
     x264_param_t    param;
 
     char            *psz_stat_name;
+    unsigned        i_threads; /* granted from the encoder threads budget */
     int             i_sei_size;
     uint32_t         i_colorspace;
     uint8_t         *p_sei;
@@ -813,6 +814,7 @@ static int  Open ( vlc_object_t *p_this )
     p_enc->p_sys = p_sys = vlc_obj_malloc( p_this, sizeof( encoder_sys_t ) );
     if( !p_sys )
         return VLC_ENOMEM;
+    p_sys->i_threads = 0;
 
     fullrange = var_GetBool( p_enc, SOUT_CFG_PREFIX "fullrange" );
     fullrange |= p_enc->fmt_in.video.color_range == COLOR_RANGE_FULL;
@@ -1327,12 +1329,9 @@ static int  Open ( vlc_object_t *p_this )
         p_sys->param.cpu &= ~X264_CPU_SSE2;
 #endif
 
-    /* BUILD 29 adds support for multi-threaded encoding while BUILD 49 (r543)
-       also adds support for threads = 0 for automatically selecting an optimal
-       value (cores * 1.5) based on detected CPUs. Default behavior for x264 is
-       threads = 1, however VLC usage differs and uses threads = 0 (auto) by
-       default unless ofcourse transcode threads is explicitly specified.. */
-    p_sys->param.i_threads = p_enc->i_threads;
+    /* The threads are granted below from the budget shared by all the
+       encoders of the process. Unless transcode threads is explicitly
+       specified, the whole remaining budget is asked for. */
 
     psz_val = var_GetString( p_enc, SOUT_CFG_PREFIX "stats" );
     if( psz_val )
@@ -1377,6 +1376,36 @@ static int  Open ( vlc_object_t *p_this )
        p_sys->param.rc.i_lookahead = var_GetInteger( p_enc, SOUT_CFG_PREFIX "lookahead" );
     }
 
+    p_sys->i_threads = vlc_encoder_AcquireThreads( p_enc, p_enc->i_threads );
+    p_sys->param.i_threads = p_sys->i_threads;
+
+    if( p_enc->i_latency > 0 )
+    {
+        /* Each frame thread, look-ahead frame and B-frame delays the output
+         * by one frame: fit them in the latency target, slice threads
+         * cost none */
+        const unsigned i_num = p_enc->fmt_in.video.i_frame_rate ?
+                               p_enc->fmt_in.video.i_frame_rate : 25;
+        const unsigned i_den = p_enc->fmt_in.video.i_frame_rate_base ?
+                               p_enc->fmt_in.video.i_frame_rate_base : 1;
+        const int i_frames = p_enc->i_latency * i_num / i_den / CLOCK_FREQ;
+
+        p_sys->param.i_bframe = __MIN( p_sys->param.i_bframe, i_frames / 2 );
+        p_sys->param.rc.i_lookahead = __MIN( p_sys->param.rc.i_lookahead,
+                                       i_frames - p_sys->param.i_bframe );
+        if( i_frames < p_sys->param.i_bframe + p_sys->param.rc.i_lookahead
+                     + (int)p_sys->i_threads )
+        {
+            p_sys->param.b_sliced_threads = 1;
+            p_sys->param.i_sync_lookahead = 0;
+        }
+        msg_Dbg( p_enc, "latency target %"PRId64" ms: %d B-frames, "
+                 "%d look-ahead frames, %s threads",
+                 MS_FROM_VLC_TICK(p_enc->i_latency),
+                 p_sys->param.i_bframe, p_sys->param.rc.i_lookahead,
+                 p_sys->param.b_sliced_threads ? "slice" : "frame" );
+    }
+
     /* We don't want repeated headers, we repeat p_extra ourself if needed */
     p_sys->param.b_repeat_headers = 0;
 
@@ -1574,6 +1603,9 @@ static void Close( vlc_object_t *p_this )
         x264_encoder_close( p_sys->h );
     }
 
+    if( p_sys->i_threads > 0 )
+        vlc_encoder_ReleaseThreads( p_enc, p_sys->i_threads );
+
 #ifdef PTW32_STATIC_LIB
     vlc_mutex_lock( &pthread_win32_mutex );
     pthread_win32_count--;
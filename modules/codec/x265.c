@@ -57,6 +57,10 @@ typedef struct
 
     unsigned        frame_count;
     vlc_tick_t      initial_date;
+    unsigned        threads; /* granted from the encoder threads budget */
+#if X265_BUILD >= 60
+    char            pools[12];
+#endif
 #ifndef NDEBUG
     vlc_tick_t      start;
 #endif
@@ -153,7 +157,6 @@ static int  Open (vlc_object_t *p_this)
     x265_param *param = &p_sys->param;
     x265_param_default(param);
 
-    param->frameNumThreads = vlc_GetCPUCount();
     param->bEnableWavefront = 0; // buggy in x265, use frame threading for now
     param->maxCUSize = 16; /* use smaller macroblock */
 
@@ -192,9 +195,40 @@ static int  Open (vlc_object_t *p_this)
         param->rc.rateControlMode = X265_RC_ABR;
     }
 
+    /* Both the frame threads and the worker pool fit in the threads granted
+     * by the budget shared by all the encoders of the process */
+    p_sys->threads = vlc_encoder_AcquireThreads(p_enc, p_enc->i_threads);
+    param->frameNumThreads = p_sys->threads;
+#if X265_BUILD >= 60
+    snprintf(p_sys->pools, sizeof (p_sys->pools), "%u", p_sys->threads);
+    param->numaPools = p_sys->pools;
+#endif
+
+    if (p_enc->i_latency > 0) {
+        /* Each frame thread, look-ahead frame and B-frame delays the output
+         * by one frame */
+        unsigned num = p_enc->fmt_in.video.i_frame_rate ?
+                       p_enc->fmt_in.video.i_frame_rate : 25;
+        unsigned den = p_enc->fmt_in.video.i_frame_rate_base ?
+                       p_enc->fmt_in.video.i_frame_rate_base : 1;
+        int frames = p_enc->i_latency * num / den / CLOCK_FREQ;
+
+        param->bframes = __MIN(param->bframes, frames / 2);
+        param->lookaheadDepth = __MIN(param->lookaheadDepth,
+                                      frames - param->bframes);
+        param->frameNumThreads = VLC_CLIP(frames - param->bframes
+                                          - param->lookaheadDepth,
+                                          1, (int)p_sys->threads);
+        msg_Dbg(p_enc, "latency target %"PRId64" ms: %d B-frames, "
+                "%d look-ahead frames, %d frame threads",
+                MS_FROM_VLC_TICK(p_enc->i_latency), param->bframes,
+                param->lookaheadDepth, param->frameNumThreads);
+    }
+
     p_sys->h = x265_encoder_open(param);
     if (p_sys->h == NULL) {
         msg_Err(p_enc, "cannot open x265 encoder");
+        vlc_encoder_ReleaseThreads(p_enc, p_sys->threads);
         free(p_sys);
         return VLC_EGENERIC;
     }
@@ -239,6 +273,7 @@ static void Close(vlc_object_t *p_this)
     encoder_sys_t *p_sys = p_enc->p_sys;
 
     x265_encoder_close(p_sys->h);
+    vlc_encoder_ReleaseThreads(p_enc, p_sys->threads);
 
     free(p_sys);
 }
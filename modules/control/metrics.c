@@ -0,0 +1,269 @@
+/*****************************************************************************
+ * metrics.c: OpenMetrics statistics endpoint
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_interface.h>
+#include <vlc_playlist.h>
+#include <vlc_player.h>
+#include <vlc_httpd.h>
+#include <vlc_memstream.h>
+
+#define METRICS_MIME "application/openmetrics-text; version=1.0.0; charset=utf-8"
+
+struct intf_sys_t
+{
+    vlc_playlist_t *playlist;
+    vlc_player_listener_id *player_listener;
+    httpd_host_t *host;
+    httpd_file_t *file;
+
+    /* Protected by the player lock */
+    float buffering;
+    uint64_t buffering_events;
+    uint64_t inputs;
+};
+
+static void player_on_buffering_changed(vlc_player_t *player,
+                                        float buffering, void *data)
+{
+    intf_sys_t *sys = data;
+    VLC_UNUSED(player);
+
+    if (buffering < 1.f && sys->buffering >= 1.f)
+        sys->buffering_events++;
+    sys->buffering = buffering;
+}
+
+static void player_on_current_media_changed(vlc_player_t *player,
+                                            input_item_t *media, void *data)
+{
+    intf_sys_t *sys = data;
+    VLC_UNUSED(player);
+
+    if (media != NULL)
+        sys->inputs++;
+    sys->buffering = 0.f;
+}
+
+static void Metric(struct vlc_memstream *ms, const char *name,
+                   const char *type, const char *help)
+{
+    vlc_memstream_printf(ms, "# TYPE vlc_%s %s\n# HELP vlc_%s %s\n",
+                         name, type, name, help);
+}
+
+static void Counter(struct vlc_memstream *ms, const char *name,
+                    const char *help, int64_t value)
+{
+    Metric(ms, name, "counter", help);
+    vlc_memstream_printf(ms, "vlc_%s_total %"PRId64"\n", name, value);
+}
+
+static void Gauge(struct vlc_memstream *ms, const char *name,
+                  const char *help, double value)
+{
+    Metric(ms, name, "gauge", help);
+    /* The C locale is not guaranteed, so do not rely on %f */
+    vlc_memstream_printf(ms, "vlc_%s %"PRId64".%03u\n", name,
+                         (int64_t)value,
+                         (unsigned)((value - (int64_t)value) * 1000.));
+}
+
+static int Fill(httpd_file_sys_t *data, httpd_file_t *file,
+                uint8_t *request, uint8_t **pp_data, int *pi_data)
+{
+    intf_sys_t *sys = (intf_sys_t *)data;
+    vlc_player_t *player = vlc_playlist_GetPlayer(sys->playlist);
+    struct vlc_memstream ms;
+    struct input_stats_t stats;
+    bool has_stats;
+    VLC_UNUSED(file); VLC_UNUSED(request);
+
+    if (vlc_memstream_open(&ms))
+        return VLC_ENOMEM;
+
+    vlc_player_Lock(player);
+    const struct input_stats_t *st = vlc_player_GetStatistics(player);
+    has_stats = st != NULL;
+    if (has_stats)
+        stats = *st;
+    bool started = vlc_player_IsStarted(player);
+    bool paused = vlc_player_IsPaused(player);
+    float rate = vlc_player_GetRate(player);
+    vlc_tick_t time = vlc_player_GetTime(player);
+    float buffering = sys->buffering;
+    uint64_t buffering_events = sys->buffering_events;
+    uint64_t inputs = sys->inputs;
+    vlc_player_Unlock(player);
+
+    Gauge(&ms, "playing", "Whether an input is playing",
+          started && !paused);
+    Gauge(&ms, "rate", "Playback rate", rate);
+    Gauge(&ms, "position_seconds", "Playback time of the current input",
+          time != VLC_TICK_INVALID ? secf_from_vlc_tick(time) : 0.);
+    Gauge(&ms, "buffering_ratio", "Input buffer fill level", buffering);
+    Counter(&ms, "buffering_events", "Rebuffering events", buffering_events);
+    Counter(&ms, "inputs", "Inputs started", inputs);
+
+    if (has_stats)
+    {
+        Counter(&ms, "input_read_bytes", "Bytes read by the access",
+                stats.i_read_bytes);
+        Counter(&ms, "input_read_packets", "Blocks read by the access",
+                stats.i_read_packets);
+        Gauge(&ms, "input_bitrate_bytes", "Access read rate in bytes/s",
+              stats.f_input_bitrate * CLOCK_FREQ);
+        Counter(&ms, "demux_read_bytes", "Bytes demuxed",
+                stats.i_demux_read_bytes);
+        Counter(&ms, "demux_read_packets", "Blocks demuxed",
+                stats.i_demux_read_packets);
+        Gauge(&ms, "demux_bitrate_bytes", "Demux rate in bytes/s",
+              stats.f_demux_bitrate * CLOCK_FREQ);
+        Counter(&ms, "demux_corrupted", "Corrupted demuxed blocks",
+                stats.i_demux_corrupted);
+        Counter(&ms, "demux_discontinuities", "Demux discontinuities",
+                stats.i_demux_discontinuity);
+        Counter(&ms, "decoded_video_frames", "Decoded video frames",
+                stats.i_decoded_video);
+        Gauge(&ms, "video_memory_bytes", "Video surfaces held by the decoders",
+              stats.i_video_memory);
+        Counter(&ms, "decoded_audio_frames", "Decoded audio blocks",
+                stats.i_decoded_audio);
+        Counter(&ms, "displayed_pictures", "Displayed pictures",
+                stats.i_displayed_pictures);
+        Counter(&ms, "late_pictures", "Pictures displayed late",
+                stats.i_late_pictures);
+        Counter(&ms, "lost_pictures", "Dropped pictures",
+                stats.i_lost_pictures);
+        Counter(&ms, "played_audio_buffers", "Played audio buffers",
+                stats.i_played_abuffers);
+        Counter(&ms, "lost_audio_buffers", "Dropped audio buffers",
+                stats.i_lost_abuffers);
+        Gauge(&ms, "latency_seconds", "Buffered duration of the live input",
+              secf_from_vlc_tick(stats.i_latency));
+    }
+    vlc_memstream_puts(&ms, "# EOF\n");
+
+    if (vlc_memstream_close(&ms))
+        return VLC_ENOMEM;
+
+    free(*pp_data);
+    *pp_data = (uint8_t *)ms.ptr;
+    *pi_data = ms.length;
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    intf_thread_t *intf = (intf_thread_t *)obj;
+    intf_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->playlist = vlc_intf_GetMainPlaylist(intf);
+    sys->buffering = 0.f;
+    sys->buffering_events = 0;
+    sys->inputs = 0;
+
+    static const struct vlc_player_cbs player_cbs =
+    {
+        .on_current_media_changed = player_on_current_media_changed,
+        .on_buffering_changed = player_on_buffering_changed,
+    };
+    vlc_player_t *player = vlc_playlist_GetPlayer(sys->playlist);
+    vlc_player_Lock(player);
+    sys->player_listener = vlc_player_AddListener(player, &player_cbs, sys);
+    vlc_player_Unlock(player);
+    if (sys->player_listener == NULL)
+        goto error;
+
+    sys->host = vlc_http_HostNew(obj);
+    if (sys->host == NULL)
+        goto error_listener;
+
+    char *url = var_InheritString(obj, "metrics-url");
+    if (url == NULL || url[0] != '/')
+    {
+        msg_Err(obj, "invalid metrics URL %s", url ? url : "(null)");
+        free(url);
+        goto error_host;
+    }
+
+    sys->file = httpd_FileNew(sys->host, url, METRICS_MIME, NULL, NULL,
+                              Fill, (httpd_file_sys_t *)sys);
+    if (sys->file == NULL)
+    {
+        msg_Err(obj, "cannot serve metrics on %s", url);
+        free(url);
+        goto error_host;
+    }
+    msg_Dbg(obj, "serving metrics on %s", url);
+    free(url);
+
+    intf->p_sys = sys;
+    return VLC_SUCCESS;
+
+error_host:
+    httpd_HostDelete(sys->host);
+error_listener:
+    vlc_player_Lock(player);
+    vlc_player_RemoveListener(player, sys->player_listener);
+    vlc_player_Unlock(player);
+error:
+    free(sys);
+    return VLC_EGENERIC;
+}
+
+static void Close(vlc_object_t *obj)
+{
+    intf_thread_t *intf = (intf_thread_t *)obj;
+    intf_sys_t *sys = intf->p_sys;
+    vlc_player_t *player = vlc_playlist_GetPlayer(sys->playlist);
+
+    httpd_FileDelete(sys->file);
+    httpd_HostDelete(sys->host);
+
+    vlc_player_Lock(player);
+    vlc_player_RemoveListener(player, sys->player_listener);
+    vlc_player_Unlock(player);
+    free(sys);
+}
+
+#define URL_TEXT N_("Metrics URL")
+#define URL_LONGTEXT N_("Path where the OpenMetrics (Prometheus) " \
+    "statistics are served. The HTTP host and port are set with the " \
+    "http-host and http-port options.")
+
+vlc_module_begin()
+    set_shortname(N_("Metrics"))
+    set_description(N_("OpenMetrics statistics endpoint"))
+    set_capability("interface", 0)
+    set_callbacks(Open, Close)
+    set_category(CAT_INTERFACE)
+    set_subcategory(SUBCAT_INTERFACE_CONTROL)
+    add_string("metrics-url", "/metrics", URL_TEXT, URL_LONGTEXT, true)
+vlc_module_end()
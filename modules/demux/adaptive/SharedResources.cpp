@@ -25,6 +25,7 @@
 #include "http/AuthStorage.hpp"
 #include "http/HTTPConnectionManager.h"
 #include "http/HTTPConnection.hpp"
+#include "http/SegmentCache.hpp"
 #include "encryption/Keyring.hpp"
 
 using namespace adaptive;
@@ -66,10 +67,14 @@ SharedResources * SharedResources::createDefault(vlc_object_t *obj,
     Keyring *keyring = new Keyring(obj);
     HTTPConnectionManager *m = new HTTPConnectionManager(obj);
     if(!var_InheritBool(obj, "adaptive-use-access")) /* only use http from access */
+    {
+        m->addFactory(new LibVLCHTTPConnectionFactory(obj, auth));
         m->addFactory(new NativeConnectionFactory(auth));
+    }
     m->addFactory(new StreamUrlConnectionFactory());
     ConnectionParams params(playlisturl);
     if(params.isLocal())
         m->setLocalConnectionsAllowed();
+    m->setSegmentCache(SegmentCache::hold(obj));
     return new SharedResources(auth, keyring, m);
 }
@@ -710,6 +710,17 @@ void AbstractStream::trackerEvent(const TrackerEvent &ev)
             resetForNewPosition(segmentTracker->getPlaybackTime(true));
             break;
 
+        case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &event =
+                    static_cast<const BufferingLevelChangedEvent &>(ev);
+            /* Lets the downloader serve the least buffered stream first */
+            if(connManager && event.id)
+                connManager->updateBufferingLevel(*event.id, event.current,
+                                                  event.target);
+        }
+            break;
+
         default:
             break;
     }
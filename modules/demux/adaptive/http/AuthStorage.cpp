@@ -39,6 +39,11 @@ AuthStorage::~AuthStorage()
 {
 }
 
+vlc_http_cookie_jar_t *AuthStorage::getJar() const
+{
+    return p_cookies_jar;
+}
+
 void AuthStorage::addCookie( const std::string &cookie, const ConnectionParams &params )
 {
     if( !p_cookies_jar )
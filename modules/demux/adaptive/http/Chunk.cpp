@@ -29,6 +29,7 @@
 #include "HTTPConnection.hpp"
 #include "HTTPConnectionManager.h"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -210,6 +211,7 @@ block_t * HTTPChunkSource::read(size_t readsize)
         return nullptr;
     }
 
+    const vlc_tick_t readStartTime = vlc_tick_now();
     ssize_t ret = connection->read(p_block->p_buffer, readsize);
     if(ret < 0)
     {
@@ -222,6 +224,9 @@ block_t * HTTPChunkSource::read(size_t readsize)
     {
         p_block->i_buffer = (size_t) ret;
         consumed += p_block->i_buffer;
+        if(ret && type == ChunkType::Segment)
+            connManager->updateDownloadProgress(sourceid, p_block->i_buffer,
+                                                vlc_tick_now() - readStartTime);
         if((size_t)ret < readsize)
         {
             eof = true;
@@ -275,13 +280,10 @@ bool HTTPChunkSource::prepare()
         {
             if(requeststatus == RequestStatus::Redirection)
             {
-                HTTPConnection *httpconn = dynamic_cast<HTTPConnection *>(connection);
-                if(httpconn)
-                    connparams = httpconn->getRedirection();
+                connparams = connection->getRedirection();
                 connection->setUsed(false);
                 connection = nullptr;
-                if(httpconn)
-                    continue;
+                continue;
             }
             break;
         }
@@ -306,10 +308,18 @@ HTTPChunkBufferedSource::HTTPChunkBufferedSource(const std::string& url, Abstrac
                                                  const adaptive::ID &sourceid,
                                                  ChunkType type, bool access) :
     HTTPChunkSource(url, manager, sourceid, type, access),
+    atomState  ((type == ChunkType::Segment) ? AtomState::Header : AtomState::None),
+    atomRemaining(0),
+    atomFirst  (true),
+    p_cached   (nullptr),
+    pp_cachedtail(&p_cached),
     p_head     (nullptr),
     pp_tail    (&p_head),
     buffered     (0)
 {
+    b_cache = manager->getSegmentCache() != nullptr &&
+              (type == ChunkType::Segment || type == ChunkType::Init ||
+               type == ChunkType::Index);
     done = false;
     eof = false;
     held = false;
@@ -331,6 +341,8 @@ HTTPChunkBufferedSource::~HTTPChunkBufferedSource()
         p_head = nullptr;
         pp_tail = &p_head;
     }
+    if(p_cached)
+        block_ChainRelease(p_cached);
     buffered = 0;
 }
 
@@ -357,6 +369,13 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
 {
     {
         mutex_locker locker {lock};
+        if(!prepared && readFromCache())
+        {
+            done = true;
+            avail.signal();
+            return;
+        }
+
         if(!prepare())
         {
             done = true;
@@ -370,6 +389,8 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
 
         if(contentLength && readsize > contentLength - buffered)
             readsize = contentLength - buffered;
+
+        readsize = getAtomReadSize(readsize);
     }
 
     block_t *p_block = block_Alloc(readsize);
@@ -386,13 +407,18 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
         vlc_tick_t latency;
     } rate = {0,0,0};
 
+    const vlc_tick_t readStartTime = vlc_tick_now();
     ssize_t ret = connection->read(p_block->p_buffer, readsize);
+    if(ret > 0 && type == ChunkType::Segment)
+        connManager->updateDownloadProgress(sourceid, ret,
+                                            vlc_tick_now() - readStartTime);
     if(ret <= 0)
     {
         block_Release(p_block);
         p_block = nullptr;
         mutex_locker locker {lock};
         done = true;
+        storeToCache(ret == 0 && !contentLength);
         downloadEndTime = vlc_tick_now();
         rate.size = buffered + consumed;
         rate.time = downloadEndTime - requestStartTime;
@@ -402,11 +428,23 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
     {
         p_block->i_buffer = (size_t) ret;
         mutex_locker locker {lock};
+        updateAtomState(p_block->p_buffer, p_block->i_buffer);
         buffered += p_block->i_buffer;
+        if(b_cache)
+        {
+            block_t *p_copy = block_Duplicate(p_block);
+            if(p_copy)
+                block_ChainLastAppend(&pp_cachedtail, p_copy);
+            else
+                storeToCache(false);
+        }
         block_ChainLastAppend(&pp_tail, p_block);
+        if(contentLength && buffered + consumed >= contentLength)
+            storeToCache(true);
         if((size_t) ret < readsize)
         {
             done = true;
+            storeToCache(!contentLength);
             downloadEndTime = vlc_tick_now();
             rate.size = buffered + consumed;
             rate.time = downloadEndTime - requestStartTime;
@@ -423,6 +461,122 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
     avail.signal();
 }
 
+bool HTTPChunkBufferedSource::readFromCache()
+{
+    if(!b_cache)
+        return false;
+    block_t *p_block = connManager->getSegmentCache()->get(params.getUrl(),
+                                                           bytesRange);
+    if(!p_block)
+        return false;
+    b_cache = false;
+    prepared = true;
+    requeststatus = RequestStatus::Success;
+    contentLength = p_block->i_buffer;
+    buffered = p_block->i_buffer;
+    block_ChainLastAppend(&pp_tail, p_block);
+    return true;
+}
+
+void HTTPChunkBufferedSource::storeToCache(bool b_complete)
+{
+    if(!b_cache)
+        return;
+    b_cache = false;
+    if(!p_cached)
+        return;
+    block_t *p_data = block_ChainGather(p_cached);
+    p_cached = nullptr;
+    pp_cachedtail = &p_cached;
+    if(!p_data)
+        return;
+    if(b_complete && connection)
+        connManager->getSegmentCache()->put(params.getUrl(), bytesRange,
+                                            p_data, connection->getCacheControl());
+    else
+        block_Release(p_data);
+}
+
+size_t HTTPChunkBufferedSource::getAtomReadSize(size_t readsize) const
+{
+    switch(atomState)
+    {
+        case AtomState::Header:
+        case AtomState::LargeSize:
+            return std::min(readsize, (size_t) 8);
+        case AtomState::Payload:
+            return std::min<uint64_t>(readsize, atomRemaining);
+        default:
+            return readsize;
+    }
+}
+
+void HTTPChunkBufferedSource::updateAtomState(const uint8_t *p, size_t size)
+{
+    switch(atomState)
+    {
+        case AtomState::Header:
+        {
+            if(size < 8)
+            {
+                atomState = AtomState::None;
+                break;
+            }
+            /* Only follow what looks like fragmented MP4 */
+            const vlc_fourcc_t type = VLC_FOURCC(p[4], p[5], p[6], p[7]);
+            if(atomFirst && type != VLC_FOURCC('s','t','y','p') &&
+                            type != VLC_FOURCC('f','t','y','p') &&
+                            type != VLC_FOURCC('s','i','d','x') &&
+                            type != VLC_FOURCC('p','r','f','t') &&
+                            type != VLC_FOURCC('e','m','s','g') &&
+                            type != VLC_FOURCC('m','o','o','f') &&
+                            type != VLC_FOURCC('m','o','o','v') &&
+                            type != VLC_FOURCC('f','r','e','e'))
+            {
+                atomState = AtomState::None;
+                break;
+            }
+            atomFirst = false;
+            const uint32_t atomsize = GetDWBE(p);
+            if(atomsize == 1)
+            {
+                atomState = AtomState::LargeSize;
+            }
+            else if(atomsize < 8) /* 0 is up to the end */
+            {
+                atomState = AtomState::None;
+            }
+            else
+            {
+                atomRemaining = atomsize - 8;
+                atomState = atomRemaining ? AtomState::Payload : AtomState::Header;
+            }
+            break;
+        }
+        case AtomState::LargeSize:
+        {
+            const uint64_t atomsize = (size < 8) ? 0 : GetQWBE(p);
+            if(atomsize < 16)
+            {
+                atomState = AtomState::None;
+            }
+            else
+            {
+                atomRemaining = atomsize - 16;
+                atomState = atomRemaining ? AtomState::Payload : AtomState::Header;
+            }
+            break;
+        }
+        case AtomState::Payload:
+            atomRemaining -= size;
+            if(atomRemaining == 0)
+                atomState = AtomState::Header;
+            break;
+        default:
+            break;
+    }
+}
+
 bool HTTPChunkBufferedSource::prepare()
 {
     if(!prepared)
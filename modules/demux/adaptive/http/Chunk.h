@@ -123,10 +123,10 @@ namespace adaptive
                 vlc_tick_t          requestStartTime;
                 vlc_tick_t          responseTime;
                 vlc_tick_t          downloadEndTime;
+                ConnectionParams    params;
 
             private:
                 bool init(const std::string &);
-                ConnectionParams    params;
         };
 
         class HTTPChunkBufferedSource : public HTTPChunkSource
@@ -149,6 +149,25 @@ namespace adaptive
                 bool               isDone() const;
 
             private:
+                /* ISOBMFF boxes boundaries of the data being read, so
+                 * reads can end with fragments of live CMAF segments */
+                enum class AtomState
+                {
+                    None,
+                    Header,
+                    LargeSize,
+                    Payload,
+                };
+                size_t             getAtomReadSize(size_t) const;
+                void               updateAtomState(const uint8_t *, size_t);
+                bool               readFromCache();
+                void               storeToCache(bool);
+                AtomState           atomState;
+                uint64_t            atomRemaining;
+                bool                atomFirst;
+                block_t            *p_cached; /* copy of the data for the cache */
+                block_t           **pp_cachedtail;
+                bool                b_cache;
                 block_t            *p_head; /* read cache buffer */
                 block_t           **pp_tail;
                 size_t              buffered; /* read cache size */
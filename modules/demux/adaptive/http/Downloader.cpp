@@ -25,42 +25,42 @@
 
 #include <vlc_threads.h>
 
-#include <atomic>
+#include <algorithm>
 
 using namespace adaptive::http;
 
-Downloader::Downloader()
+Downloader::Downloader(unsigned count)
 {
     killed = false;
-    thread_handle_valid = false;
-    current = nullptr;
+    workers = std::max(1U, std::min(count, MAX_WORKERS));
 }
 
 bool Downloader::start()
 {
-    if(!thread_handle_valid &&
-       vlc_clone(&thread_handle, downloaderThread,
-                 static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+    while(thread_handles.size() < workers)
     {
-        return false;
+        vlc_thread_t th;
+        if(vlc_clone(&th, downloaderThread,
+                     static_cast<void *>(this), VLC_THREAD_PRIORITY_INPUT))
+            break;
+        thread_handles.push_back(th);
     }
-    thread_handle_valid = true;
-    return true;
+    return !thread_handles.empty();
 }
 
 Downloader::~Downloader()
 {
     kill();
 
-    if(thread_handle_valid)
-        vlc_join(thread_handle, nullptr);
+    for(vlc_thread_t th : thread_handles)
+        vlc_join(th, nullptr);
 }
 
 void Downloader::kill()
 {
     vlc::threads::mutex_locker locker {lock};
     killed = true;
-    wait_cond.signal();
+    wait_cond.broadcast();
 }
 
 void Downloader::schedule(HTTPChunkBufferedSource *source)
@@ -74,7 +74,7 @@ void Downloader::schedule(HTTPChunkBufferedSource *source)
 void Downloader::cancel(HTTPChunkBufferedSource *source)
 {
     vlc::threads::mutex_locker locker {lock};
-    while (current == source)
+    while (isActive(source))
         updated_cond.wait(lock);
 
     if(!source->isDone())
@@ -84,6 +84,58 @@ void Downloader::cancel(HTTPChunkBufferedSource *source)
     }
 }
 
+void Downloader::updateBufferingLevel(const ID &id, vlc_tick_t current,
+                                      vlc_tick_t target)
+{
+    vlc::threads::mutex_locker locker {lock};
+    levels[id] = (target > 0) ? (float) current / target : 0.0f;
+}
+
+bool Downloader::isActive(const HTTPChunkBufferedSource *source) const
+{
+    return std::find(current.cbegin(), current.cend(), source) != current.cend();
+}
+
+bool Downloader::isActive(const ID &id) const
+{
+    return std::find_if(current.cbegin(), current.cend(),
+                        [&id](const HTTPChunkBufferedSource *s)
+                        { return s->sourceid == id; }) != current.cend();
+}
+
+float Downloader::getPriority(const ID &id) const
+{
+    /* Lowest buffering ratio first, unknown streams (playlists...) first */
+    auto it = levels.find(id);
+    return (it != levels.end()) ? (*it).second : 0.0f;
+}
+
+std::list<HTTPChunkBufferedSource *>::iterator Downloader::getNext()
+{
+    auto best = chunks.end();
+    float bestprio = 0.0f;
+    std::vector<const ID *> seen;
+
+    /* Only the oldest source of each stream is a candidate */
+    for(auto it = chunks.begin(); it != chunks.end(); ++it)
+    {
+        const ID &id = (*it)->sourceid;
+        if(std::find_if(seen.cbegin(), seen.cend(),
+                        [&id](const ID *s) { return *s == id; }) != seen.cend())
+            continue;
+        seen.push_back(&id);
+        if(isActive(id))
+            continue;
+        float prio = getPriority(id);
+        if(best == chunks.end() || prio < bestprio)
+        {
+            best = it;
+            bestprio = prio;
+        }
+    }
+    return best;
+}
+
 void * Downloader::downloaderThread(void *opaque)
 {
     Downloader *instance = static_cast<Downloader *>(opaque);
@@ -93,30 +145,31 @@ void * Downloader::downloaderThread(void *opaque)
 
 void Downloader::Run()
 {
+    vlc::threads::mutex_locker locker {lock};
+
     while(1)
     {
-        lock.lock();
-
-        while(chunks.empty() && !killed)
+        auto it = chunks.end();
+        while(!killed && (it = getNext()) == chunks.end())
             wait_cond.wait(lock);
 
         if(killed)
-        {
-            lock.unlock();
             break;
-        }
 
-        current = chunks.front();
+        HTTPChunkBufferedSource *source = *it;
+        current.push_back(source);
         lock.unlock();
-        current->bufferize(HTTPChunkSource::CHUNK_SIZE);
+        source->bufferize(HTTPChunkSource::CHUNK_SIZE);
         lock.lock();
-        if(current->isDone())
+        current.remove(source);
+        /* cancel() waits for inactivity, so the iterator is still valid */
+        if(source->isDone())
         {
-            chunks.pop_front();
-            current->release();
+            chunks.erase(it);
+            source->release();
         }
-        current = nullptr;
-        updated_cond.signal();
-        lock.unlock();
+        updated_cond.broadcast();
+        /* The stream can be picked up by another worker */
+        wait_cond.signal();
     }
 }
@@ -21,10 +21,13 @@
 #define DOWNLOADER_HPP
 
 #include "Chunk.h"
+#include "../ID.hpp"
 
 #include <vlc_common.h>
 #include <vlc_cxx_helpers.hpp>
 #include <list>
+#include <map>
+#include <vector>
 
 namespace adaptive
 {
@@ -32,27 +35,38 @@ namespace adaptive
     namespace http
     {
 
+        /* Pool of download threads. Sources from the same stream are
+         * fetched in order, one at a time, while distinct streams are
+         * fetched concurrently. The least buffered stream goes first. */
         class Downloader
         {
             public:
-                Downloader();
+                Downloader(unsigned = 1);
                 ~Downloader();
                 bool start();
                 void schedule(HTTPChunkBufferedSource *);
                 void cancel(HTTPChunkBufferedSource *);
+                void updateBufferingLevel(const ID &, vlc_tick_t, vlc_tick_t);
+
+                static const unsigned MAX_WORKERS = 8;
 
             private:
                 static void * downloaderThread(void *);
                 void Run();
                 void kill();
-                vlc_thread_t thread_handle;
+                bool isActive(const HTTPChunkBufferedSource *) const;
+                bool isActive(const ID &) const;
+                float getPriority(const ID &) const;
+                std::list<HTTPChunkBufferedSource *>::iterator getNext();
+                std::vector<vlc_thread_t> thread_handles;
+                unsigned     workers;
                 vlc::threads::mutex lock;
                 vlc::threads::condition_variable wait_cond;
                 vlc::threads::condition_variable updated_cond;
-                bool         thread_handle_valid;
                 bool         killed;
                 std::list<HTTPChunkBufferedSource *> chunks;
-                HTTPChunkBufferedSource *current;
+                std::list<HTTPChunkBufferedSource *> current;
+                std::map<ID, float> levels;
         };
 
     }
@@ -31,6 +31,15 @@
 #include <sstream>
 #include <algorithm>
 #include <vlc_stream.h>
+#include <vlc_block.h>
+
+extern "C"
+{
+    #include "connmgr.h"
+    #include "resource.h"
+    #include "file.h"
+    #include "message.h"
+}
 
 using namespace adaptive::http;
 
@@ -66,6 +75,16 @@ const std::string & AbstractConnection::getContentType() const
     return contentType;
 }
 
+const std::string & AbstractConnection::getCacheControl() const
+{
+    return cacheControl;
+}
+
+const ConnectionParams & AbstractConnection::getRedirection() const
+{
+    return locationparams;
+}
+
 HTTPConnection::HTTPConnection(vlc_object_t *p_object_, AuthStorage *auth,
                                Transport *socket_, const ConnectionParams &proxy, bool persistent)
     : AbstractConnection( p_object_ )
@@ -137,6 +156,7 @@ void HTTPConnection::disconnect()
     chunkLength = 0;
     bytesRange = BytesRange();
     contentType = std::string();
+    cacheControl = std::string();
     transport->disconnect();
 }
 
@@ -147,6 +167,7 @@ RequestStatus HTTPConnection::request(const std::string &path,
     chunked = false;
     chunked_eof = false;
     chunkLength = 0;
+    cacheControl = std::string();
 
     /* Set new path for this query */
     params.setPath(path);
@@ -406,6 +427,10 @@ void HTTPConnection::onHeader(const std::string &key,
     {
         contentType = value;
     }
+    else if(Helper::icaseEquals(key, "Cache-Control"))
+    {
+        cacheControl = value;
+    }
     else if(Helper::icaseEquals(key, "Location"))
     {
         locationparams = ConnectionParams();
@@ -468,11 +493,6 @@ std::string HTTPConnection::extraRequestHeaders() const
     return ss.str();
 }
 
-const ConnectionParams & HTTPConnection::getRedirection() const
-{
-    return locationparams;
-}
-
 StreamUrlConnection::StreamUrlConnection(vlc_object_t *p_object)
     : AbstractConnection(p_object)
 {
@@ -494,6 +514,7 @@ void StreamUrlConnection::reset()
     bytesRead = 0;
     contentLength = 0;
     contentType = std::string();
+    cacheControl = std::string();
     bytesRange = BytesRange();
 }
 
@@ -588,6 +609,207 @@ void StreamUrlConnection::setUsed( bool b )
        reset();
 }
 
+LibVLCHTTPConnection::LibVLCHTTPConnection(vlc_object_t *p_object_,
+                                           struct vlc_http_mgr *mgr)
+    : AbstractConnection(p_object_)
+{
+    http_mgr = mgr;
+    resource = nullptr;
+    p_block = nullptr;
+    char *psz_useragent = var_InheritString(p_object_, "http-user-agent");
+    useragent = psz_useragent ? std::string(psz_useragent) : std::string("");
+    free(psz_useragent);
+    char *psz_referer = var_InheritString(p_object_, "http-referrer");
+    referer = psz_referer ? std::string(psz_referer) : std::string("");
+    free(psz_referer);
+}
+
+LibVLCHTTPConnection::~LibVLCHTTPConnection()
+{
+    reset();
+}
+
+void LibVLCHTTPConnection::reset()
+{
+    if(p_block)
+        block_Release(p_block);
+    p_block = nullptr;
+    if(resource)
+        vlc_http_file_destroy(resource);
+    resource = nullptr;
+    bytesRead = 0;
+    contentLength = 0;
+    contentType = std::string();
+    cacheControl = std::string();
+    bytesRange = BytesRange();
+}
+
+bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
+{
+    /* Origins are managed by the shared connection manager */
+    return available && !params_.usesAccess() && params_.getScheme() == "https";
+}
+
+RequestStatus LibVLCHTTPConnection::request(const std::string &path,
+                                            const BytesRange &range)
+{
+    reset();
+
+    /* Set new path for this query */
+    params.setPath(path);
+    locationparams = ConnectionParams();
+
+    msg_Dbg(p_object, "Retrieving %s @%zu", params.getUrl().c_str(),
+                      range.isValid() ? range.getStartByte() : 0);
+
+    resource = vlc_http_file_create(http_mgr, params.getUrl().c_str(),
+                                    useragent.empty() ? nullptr : useragent.c_str(),
+                                    referer.empty() ? nullptr : referer.c_str());
+    if(!resource)
+        return RequestStatus::GenericError;
+
+    const uintmax_t start = range.isValid() ? range.getStartByte() : 0;
+    if(start > 0 && vlc_http_file_seek(resource, start) != 0)
+    {
+        reset();
+        return RequestStatus::GenericError;
+    }
+
+    int status = vlc_http_file_get_status(resource);
+    if(status < 0)
+    {
+        reset();
+        return RequestStatus::GenericError;
+    }
+
+    if(status >= 300 && status < 400)
+    {
+        char *psz_location = vlc_http_file_get_redirect(resource);
+        reset();
+        if(!psz_location)
+            return RequestStatus::NotFound;
+        locationparams = ConnectionParams(psz_location);
+        free(psz_location);
+        msg_Info(p_object, "%d redirection to %s", status,
+                 locationparams.getUrl().c_str());
+        if(locationparams.isLocal() && !params.isLocal())
+        {
+            msg_Err(p_object, "redirection to local rejected");
+            return RequestStatus::GenericError;
+        }
+        return RequestStatus::Redirection;
+    }
+    else if((status != 200 && status != 206) || (start > 0 && status != 206))
+    {
+        msg_Err(p_object, "Failed reading %s: %d", params.getUrl().c_str(), status);
+        reset();
+        return RequestStatus::NotFound;
+    }
+
+    char *psz_type = vlc_http_file_get_type(resource);
+    if(psz_type)
+    {
+        contentType = std::string(psz_type);
+        free(psz_type);
+    }
+
+    const char *psz_cache = vlc_http_msg_get_header(resource->response, "Cache-Control");
+    if(psz_cache)
+        cacheControl = std::string(psz_cache);
+
+    bytesRange = range;
+    if(range.isValid() && range.getEndByte() > 0)
+        contentLength = range.getEndByte() - range.getStartByte() + 1;
+
+    uintmax_t size = vlc_http_file_get_size(resource);
+    if(size != UINTMAX_MAX && size > start)
+    {
+        if(!contentLength || contentLength > size - start)
+            contentLength = size - start;
+    }
+
+    return RequestStatus::Success;
+}
+
+ssize_t LibVLCHTTPConnection::read(void *p_buffer, size_t len)
+{
+    if( !resource )
+        return VLC_EGENERIC;
+
+    if(len == 0)
+        return VLC_SUCCESS;
+
+    const size_t toRead = (contentLength) ? contentLength - bytesRead : len;
+    if (toRead == 0)
+        return VLC_SUCCESS;
+
+    if(len > toRead)
+        len = toRead;
+
+    /* Short reads are end of stream for the callers */
+    size_t copied = 0;
+    while(copied < len)
+    {
+        if(!p_block)
+        {
+            p_block = vlc_http_file_read(resource);
+            if(!p_block)
+                break;
+        }
+
+        size_t size = std::min(len - copied, p_block->i_buffer);
+        memcpy(static_cast<uint8_t *>(p_buffer) + copied, p_block->p_buffer, size);
+        p_block->p_buffer += size;
+        p_block->i_buffer -= size;
+        copied += size;
+
+        if(p_block->i_buffer == 0)
+        {
+            block_Release(p_block);
+            p_block = nullptr;
+        }
+    }
+
+    bytesRead += copied;
+
+    if(copied < len || contentLength == bytesRead) /* set EOF */
+        reset();
+
+    return copied;
+}
+
+void LibVLCHTTPConnection::setUsed( bool b )
+{
+    available = !b;
+    /* Closing the resource cancels any pending transfer */
+    if(available)
+        reset();
+}
+
+LibVLCHTTPConnectionFactory::LibVLCHTTPConnectionFactory( vlc_object_t *p_object,
+                                                          AuthStorage *auth )
+    : AbstractConnectionFactory()
+{
+    http_mgr = vlc_http_mgr_create(p_object, auth ? auth->getJar() : nullptr);
+}
+
+LibVLCHTTPConnectionFactory::~LibVLCHTTPConnectionFactory()
+{
+    if(http_mgr)
+        vlc_http_mgr_destroy(http_mgr);
+}
+
+AbstractConnection * LibVLCHTTPConnectionFactory::createConnection(vlc_object_t *p_object,
+                                                                   const ConnectionParams &params)
+{
+    /* Plain HTTP is left to the native connections and their pipelining */
+    if(!http_mgr || params.usesAccess() || params.getScheme() != "https" ||
+       params.getHostname().empty())
+        return nullptr;
+
+    return new (std::nothrow) LibVLCHTTPConnection(p_object, http_mgr);
+}
+
 NativeConnectionFactory::NativeConnectionFactory( AuthStorage *auth )
     : AbstractConnectionFactory()
 {
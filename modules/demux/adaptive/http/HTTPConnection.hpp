@@ -30,6 +30,9 @@
 #include <vlc_common.h>
 #include <string>
 
+struct vlc_http_mgr;
+struct vlc_http_resource;
+
 namespace adaptive
 {
     namespace http
@@ -52,14 +55,18 @@ namespace adaptive
 
                 virtual size_t  getContentLength() const;
                 virtual const std::string & getContentType() const;
+                virtual const std::string & getCacheControl() const;
+                virtual const ConnectionParams & getRedirection() const;
                 virtual void    setUsed( bool ) = 0;
 
             protected:
                 vlc_object_t      *p_object;
                 ConnectionParams   params;
+                ConnectionParams   locationparams;
                 bool               available;
                 size_t             contentLength;
                 std::string        contentType;
+                std::string        cacheControl;
                 BytesRange         bytesRange;
                 size_t             bytesRead;
         };
@@ -77,7 +84,6 @@ namespace adaptive
                 virtual ssize_t read        (void *p_buffer, size_t len) override;
 
                 void setUsed( bool ) override;
-                const ConnectionParams &getRedirection() const;
                 static const unsigned MAX_REDIRECTS = 3;
 
             protected:
@@ -99,7 +105,6 @@ namespace adaptive
                 std::string referer;
 
                 AuthStorage        *authStorage;
-                ConnectionParams    locationparams;
                 ConnectionParams    proxyparams;
                 bool                connectionClose;
                 bool                chunked;
@@ -132,6 +137,32 @@ namespace adaptive
                 stream_t *p_streamurl;
        };
 
+       /* Requests through the libvlc HTTP stack. All connections from a
+        * factory share its connection manager, hence HTTP/2 connections are
+        * multiplexed across requests. */
+       class LibVLCHTTPConnection : public AbstractConnection
+       {
+            public:
+                LibVLCHTTPConnection(vlc_object_t *, struct vlc_http_mgr *);
+                virtual ~LibVLCHTTPConnection();
+
+                virtual bool    canReuse     (const ConnectionParams &) const override;
+
+                virtual RequestStatus request(const std::string& path,
+                                              const BytesRange & = BytesRange()) override;
+                virtual ssize_t read        (void *p_buffer, size_t len) override;
+
+                virtual void    setUsed( bool ) override;
+
+            protected:
+                void reset();
+                struct vlc_http_mgr *http_mgr; /* not owned */
+                struct vlc_http_resource *resource;
+                block_t *p_block; /* partially read data */
+                std::string useragent;
+                std::string referer;
+       };
+
        class AbstractConnectionFactory
        {
            public:
@@ -150,6 +181,16 @@ namespace adaptive
                AuthStorage *authStorage;
        };
 
+       class LibVLCHTTPConnectionFactory : public AbstractConnectionFactory
+       {
+           public:
+               LibVLCHTTPConnectionFactory( vlc_object_t *, AuthStorage * );
+               virtual ~LibVLCHTTPConnectionFactory();
+               virtual AbstractConnection * createConnection(vlc_object_t *, const ConnectionParams &) override;
+           private:
+               struct vlc_http_mgr *http_mgr;
+       };
+
        class StreamUrlConnectionFactory : public AbstractConnectionFactory
        {
            public:
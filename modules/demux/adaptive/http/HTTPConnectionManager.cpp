@@ -30,6 +30,7 @@
 #include "ConnectionParams.hpp"
 #include "Transport.hpp"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 #include "tools/Debug.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
@@ -41,16 +42,19 @@ AbstractConnectionManager::AbstractConnectionManager(vlc_object_t *p_object_)
 {
     p_object = p_object_;
     rateObserver = nullptr;
+    segmentCache = nullptr;
 }
 
 AbstractConnectionManager::~AbstractConnectionManager()
 {
-
+    SegmentCache::release(p_object, segmentCache);
 }
 
 void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid, size_t size,
                                                    vlc_tick_t time, vlc_tick_t latency)
 {
+    /* Can be reported by several download threads at once */
+    vlc::threads::mutex_locker locker {rateLock};
     if(rateObserver)
     {
         BwDebug(msg_Dbg(p_object,
@@ -61,19 +65,46 @@ void AbstractConnectionManager::updateDownloadRate(const adaptive::ID &sourceid,
     }
 }
 
+void AbstractConnectionManager::updateDownloadProgress(const adaptive::ID &sourceid,
+                                                       size_t size, vlc_tick_t time)
+{
+    vlc::threads::mutex_locker locker {rateLock};
+    if(rateObserver)
+        rateObserver->updateDownloadProgress(sourceid, size, time);
+}
+
+void AbstractConnectionManager::updateBufferingLevel(const adaptive::ID &,
+                                                     vlc_tick_t, vlc_tick_t)
+{
+
+}
+
 void AbstractConnectionManager::setDownloadRateObserver(IDownloadRateObserver *obs)
 {
     rateObserver = obs;
 }
 
+void AbstractConnectionManager::setSegmentCache(SegmentCache *cache)
+{
+    SegmentCache::release(p_object, segmentCache);
+    segmentCache = cache;
+}
+
+SegmentCache * AbstractConnectionManager::getSegmentCache() const
+{
+    return segmentCache;
+}
+
 
 HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
     : AbstractConnectionManager( p_object_ ),
       localAllowed(false)
 {
     vlc_mutex_init(&lock);
-    downloader = new (std::nothrow) Downloader();
-    downloader->start();
+    int64_t workers = var_InheritInteger(p_object, "adaptive-maxdownloads");
+    downloader = new (std::nothrow) Downloader(workers > 0 ? workers : 1);
+    if(downloader)
+        downloader->start();
 }
 
 HTTPConnectionManager::~HTTPConnectionManager   ()
@@ -166,6 +197,14 @@ void HTTPConnectionManager::cancel(AbstractChunkSource *source)
         downloader->cancel(src);
 }
 
+void HTTPConnectionManager::updateBufferingLevel(const adaptive::ID &id,
+                                                 vlc_tick_t current,
+                                                 vlc_tick_t target)
+{
+    if(downloader)
+        downloader->updateBufferingLevel(id, current, target);
+}
+
 void HTTPConnectionManager::setLocalConnectionsAllowed()
 {
     localAllowed = true;
@@ -28,6 +28,7 @@
 #include "../logic/IDownloadRateObserver.h"
 
 #include <vlc_common.h>
+#include <vlc_cxx_helpers.hpp>
 
 #include <vector>
 #include <list>
@@ -42,6 +43,7 @@ namespace adaptive
         class AbstractConnection;
         class Downloader;
         class AbstractChunkSource;
+        class SegmentCache;
 
         class AbstractConnectionManager : public IDownloadRateObserver
         {
@@ -55,13 +57,21 @@ namespace adaptive
 
                 virtual void updateDownloadRate(const ID &, size_t,
                                                 vlc_tick_t, vlc_tick_t) override;
+                virtual void updateDownloadProgress(const ID &, size_t,
+                                                    vlc_tick_t) override;
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t,
+                                                  vlc_tick_t);
                 void setDownloadRateObserver(IDownloadRateObserver *);
+                void setSegmentCache(SegmentCache *); /* takes a reference */
+                SegmentCache * getSegmentCache() const;
 
             protected:
                 vlc_object_t                                       *p_object;
+                SegmentCache                                       *segmentCache;
 
             private:
                 IDownloadRateObserver                              *rateObserver;
+                vlc::threads::mutex                                 rateLock;
         };
 
         class HTTPConnectionManager : public AbstractConnectionManager
@@ -75,6 +85,8 @@ namespace adaptive
 
                 virtual void start(AbstractChunkSource *)  override;
                 virtual void cancel(AbstractChunkSource *)  override;
+                virtual void updateBufferingLevel(const ID &, vlc_tick_t,
+                                                  vlc_tick_t)  override;
                 void         setLocalConnectionsAllowed();
                 void         addFactory(AbstractConnectionFactory *);
 
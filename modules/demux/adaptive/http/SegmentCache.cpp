@@ -0,0 +1,192 @@
+/*
+ * SegmentCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2021 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SegmentCache.hpp"
+
+#include <vlc_block.h>
+#include <vlc_variables.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iterator>
+#include <sstream>
+
+using namespace adaptive::http;
+using vlc::threads::mutex_locker;
+
+#define CACHE_VAR "adaptive-segment-cache"
+
+/* Protects the instance cache creation/deletion */
+static vlc::threads::mutex holder_lock;
+
+SegmentCache::SegmentCache(size_t size)
+{
+    maxSize = size;
+    totalSize = 0;
+    users = 0;
+}
+
+SegmentCache::~SegmentCache()
+{
+    while(!entries.empty())
+        remove(entries.begin());
+}
+
+SegmentCache * SegmentCache::hold(vlc_object_t *obj)
+{
+    const int64_t size = var_InheritInteger(obj, "adaptive-cache-size");
+    if(size <= 0)
+        return nullptr;
+
+    vlc_object_t *libvlc = VLC_OBJECT(vlc_object_instance(obj));
+    mutex_locker locker {holder_lock};
+
+    SegmentCache *cache;
+    if(var_Type(libvlc, CACHE_VAR) == VLC_VAR_ADDRESS)
+    {
+        cache = static_cast<SegmentCache *>(var_GetAddress(libvlc, CACHE_VAR));
+    }
+    else
+    {
+        cache = new (std::nothrow) SegmentCache(size * 1024 * 1024);
+        if(!cache)
+            return nullptr;
+        var_Create(libvlc, CACHE_VAR, VLC_VAR_ADDRESS);
+        var_SetAddress(libvlc, CACHE_VAR, cache);
+    }
+    cache->users++;
+    return cache;
+}
+
+void SegmentCache::release(vlc_object_t *obj, SegmentCache *cache)
+{
+    if(!cache)
+        return;
+
+    vlc_object_t *libvlc = VLC_OBJECT(vlc_object_instance(obj));
+    mutex_locker locker {holder_lock};
+
+    if(--cache->users == 0)
+    {
+        var_Destroy(libvlc, CACHE_VAR);
+        delete cache;
+    }
+}
+
+std::string SegmentCache::getKey(const std::string &url, const BytesRange &range)
+{
+    if(!range.isValid())
+        return url;
+    std::ostringstream os;
+    os.imbue(std::locale("C"));
+    os << url << '@' << range.getStartByte() << '-' << range.getEndByte();
+    return os.str();
+}
+
+bool SegmentCache::isCacheable(const std::string &cachecontrol, vlc_tick_t *maxage)
+{
+    std::string value(cachecontrol);
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+
+    if(value.find("no-store") != std::string::npos ||
+       value.find("no-cache") != std::string::npos)
+        return false;
+
+    *maxage = VLC_TICK_INVALID;
+    std::string::size_type pos = value.find("max-age=");
+    if(pos != std::string::npos)
+    {
+        long age = std::strtol(value.c_str() + pos + 8, nullptr, 10);
+        if(age <= 0)
+            return false;
+        *maxage = vlc_tick_from_sec(age);
+    }
+    return true;
+}
+
+block_t * SegmentCache::get(const std::string &url, const BytesRange &range)
+{
+    mutex_locker locker {lock};
+
+    std::map<std::string, std::list<Entry>::iterator>::iterator it =
+            index.find(getKey(url, range));
+    if(it == index.end())
+        return nullptr;
+
+    std::list<Entry>::iterator entry = (*it).second;
+    if((*entry).expires != VLC_TICK_INVALID && (*entry).expires < vlc_tick_now())
+    {
+        remove(entry);
+        return nullptr;
+    }
+
+    /* move to front */
+    entries.splice(entries.begin(), entries, entry);
+    return block_Duplicate((*entry).data);
+}
+
+void SegmentCache::put(const std::string &url, const BytesRange &range,
+                       block_t *data, const std::string &cachecontrol)
+{
+    vlc_tick_t maxage;
+    if(!isCacheable(cachecontrol, &maxage) ||
+       data->i_buffer == 0 || data->i_buffer > maxSize / 4)
+    {
+        block_Release(data);
+        return;
+    }
+
+    const std::string key = getKey(url, range);
+
+    mutex_locker locker {lock};
+
+    std::map<std::string, std::list<Entry>::iterator>::iterator it = index.find(key);
+    if(it != index.end())
+        remove((*it).second);
+
+    evict(data->i_buffer);
+
+    Entry entry;
+    entry.key = key;
+    entry.data = data;
+    entry.expires = (maxage != VLC_TICK_INVALID) ? vlc_tick_now() + maxage
+                                                 : VLC_TICK_INVALID;
+    entries.push_front(entry);
+    index[key] = entries.begin();
+    totalSize += data->i_buffer;
+}
+
+void SegmentCache::evict(size_t size)
+{
+    while(!entries.empty() && totalSize + size > maxSize)
+        remove(std::prev(entries.end()));
+}
+
+void SegmentCache::remove(std::list<Entry>::iterator it)
+{
+    totalSize -= (*it).data->i_buffer;
+    block_Release((*it).data);
+    index.erase((*it).key);
+    entries.erase(it);
+}
@@ -0,0 +1,74 @@
+/*
+ * SegmentCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2021 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SEGMENTCACHE_HPP
+#define SEGMENTCACHE_HPP
+
+#include "BytesRange.hpp"
+
+#include <vlc_common.h>
+#include <vlc_cxx_helpers.hpp>
+#include <list>
+#include <map>
+#include <string>
+
+typedef struct block_t block_t;
+
+namespace adaptive
+{
+    namespace http
+    {
+        /* Size bounded LRU cache of downloaded segments, shared by all
+         * the adaptive demuxers of a libvlc instance */
+        class SegmentCache
+        {
+            public:
+                SegmentCache(size_t);
+                ~SegmentCache();
+
+                static SegmentCache * hold(vlc_object_t *);
+                static void release(vlc_object_t *, SegmentCache *);
+
+                block_t * get(const std::string &, const BytesRange &);
+                void put(const std::string &, const BytesRange &,
+                         block_t *, const std::string &);
+                static bool isCacheable(const std::string &, vlc_tick_t *);
+
+            private:
+                struct Entry
+                {
+                    std::string key;
+                    block_t *data;
+                    vlc_tick_t expires;
+                };
+                static std::string getKey(const std::string &, const BytesRange &);
+                void evict(size_t);
+                void remove(std::list<Entry>::iterator);
+
+                vlc::threads::mutex lock;
+                std::list<Entry> entries; /* most recently used first */
+                std::map<std::string, std::list<Entry>::iterator> index;
+                size_t maxSize;
+                size_t totalSize;
+                unsigned users;
+        };
+    }
+}
+
+#endif // SEGMENTCACHE_HPP
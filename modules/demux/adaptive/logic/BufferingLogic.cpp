@@ -118,8 +118,8 @@ vlc_tick_t DefaultBufferingLogic::getMaxBuffering(const BasePlaylist *p) const
 
 vlc_tick_t DefaultBufferingLogic::getLiveDelay(const BasePlaylist *p) const
 {
-    if(isLowLatency(p))
-        return getMinBuffering(p);
+    if(isLowLatency(p)) /* but not closer than the playlist allows */
+        return std::max(getMinBuffering(p), p->suggestedPresentationDelay.Get());
     vlc_tick_t delay = userLiveDelay ? userLiveDelay
                                      : DEFAULT_LIVE_BUFFERING;
     if(p->suggestedPresentationDelay.Get())
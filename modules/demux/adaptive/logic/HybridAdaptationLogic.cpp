@@ -0,0 +1,306 @@
+/*
+ * HybridAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2021 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "HybridAdaptationLogic.hpp"
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Buffer based selection (BOLA) while the buffer is healthy, throughput
+ * based selection when it is low, as in dash.js' DYNAMIC strategy.
+ * Throughput is estimated from the individual reads, so that segments
+ * delivered as they are produced (chunked CMAF, low latency) are not
+ * mistaken for a slow network.
+ */
+
+#define minimumBufferS VLC_TICK_FROM_SEC(6)  /* Qmin */
+#define bufferTargetS  VLC_TICK_FROM_SEC(30) /* Qmax */
+#define SAFETY_FACTOR  0.9
+
+HybridContext::HybridContext()
+    : buffering_level( 0 )
+    , buffering_target( bufferTargetS )
+    , latency( 0 )
+    , last_download_rate( 0 )
+{ }
+
+HybridAdaptationLogic::HybridAdaptationLogic(vlc_object_t *obj)
+    : AbstractAdaptationLogic(obj)
+    , currentBps( 0 )
+    , usedBps( 0 )
+{
+    vlc_mutex_init(&lock);
+}
+
+HybridAdaptationLogic::~HybridAdaptationLogic()
+{
+}
+
+BaseRepresentation *
+HybridAdaptationLogic::getBufferBasedRepresentation(BaseAdaptationSet *adaptSet,
+                                                    RepresentationSelector &selector,
+                                                    const HybridContext &ctx,
+                                                    vlc_tick_t minbuffer)
+{
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+    const float umin = getUtility(lowest);
+    const float umax = getUtility(highest);
+
+    /* Data received late does not count as buffer */
+    const float Q = secf_from_vlc_tick(std::max(ctx.buffering_level - ctx.latency,
+                                                (vlc_tick_t) 0));
+    const float gammaP = 1.0 + (umax - umin) / ((float)ctx.buffering_target / minbuffer - 1.0);
+    const float Vd = (secf_from_vlc_tick(minbuffer) - 1.0) / (umin + gammaP);
+
+    BaseRepresentation *ret = nullptr;
+    BaseRepresentation *prev = nullptr;
+    float argmax = 0;
+    for(BaseRepresentation *rep = lowest;
+                            rep && rep != prev; rep = selector.higher(adaptSet, rep))
+    {
+        float arg = ( Vd * (getUtility(rep) - umin + gammaP) - Q ) / rep->getBandwidth();
+        if(ret == nullptr || argmax <= arg)
+        {
+            ret = rep;
+            argmax = arg;
+        }
+        prev = rep;
+    }
+    return ret;
+}
+
+BaseRepresentation *HybridAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet,
+                                                                 BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    if(lowest == nullptr)
+        return nullptr;
+
+    vlc_mutex_lock(&lock);
+
+    std::map<ID, HybridContext>::iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end())
+    {
+        vlc_mutex_unlock(&lock);
+        return lowest;
+    }
+    const HybridContext &ctx = (*it).second;
+    const vlc_tick_t bufferinglevel = ctx.buffering_level;
+    const vlc_tick_t minbuffer = std::min(minimumBufferS, ctx.buffering_target / 2);
+    const unsigned bps = getAvailableBw(currentBps, prevRep) * SAFETY_FACTOR;
+
+    BaseRepresentation *m = selector.select(adaptSet, bps);
+    if(prevRep && minbuffer > 0 && bufferinglevel >= minbuffer)
+    {
+        BaseRepresentation *bufferRep =
+                getBufferBasedRepresentation(adaptSet, selector, ctx, minbuffer);
+        /* Do not go above the estimated throughput until the buffer
+         * can absorb a wrong decision */
+        if(bufferRep && (bufferRep->getBandwidth() <= m->getBandwidth() ||
+                         bufferinglevel >= ctx.buffering_target / 2))
+            m = bufferRep;
+    }
+
+    vlc_mutex_unlock(&lock);
+
+    BwDebug( msg_Info(p_obj, "buffering level %" PRId64 "ms rep %" PRIu64 " kBps %u kBps",
+             MS_FROM_VLC_TICK(bufferinglevel), m->getBandwidth()/8000, bps / 8000); );
+
+    return m;
+}
+
+float HybridAdaptationLogic::getUtility(const BaseRepresentation *rep)
+{
+    float ret;
+    std::map<uint64_t, float>::iterator it = utilities.find(rep->getBandwidth());
+    if(it == utilities.end())
+    {
+        ret = std::log((float)rep->getBandwidth());
+        utilities.insert(std::pair<uint64_t, float>(rep->getBandwidth(), ret));
+    }
+    else ret = (*it).second;
+    return ret;
+}
+
+unsigned HybridAdaptationLogic::getBurstRate(const std::vector<std::pair<size_t, vlc_tick_t>> &reads)
+{
+    /* Fastest reads carrying half of the data: reads waiting for the
+     * origin to produce the next chunk only come last */
+    std::vector<std::pair<size_t, vlc_tick_t>> sorted(reads);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const std::pair<size_t, vlc_tick_t> &a,
+                 const std::pair<size_t, vlc_tick_t> &b)
+              { return a.first * b.second > b.first * a.second; });
+
+    size_t total = 0;
+    for(const auto &read : sorted)
+        total += read.first;
+
+    size_t bytes = 0;
+    vlc_tick_t time = 0;
+    for(const auto &read : sorted)
+    {
+        bytes += read.first;
+        time += read.second;
+        if(bytes >= total / 2)
+            break;
+    }
+
+    return time ? CLOCK_FREQ * bytes * 8 / time : 0;
+}
+
+unsigned HybridAdaptationLogic::getAvailableBw(unsigned i_bw, const BaseRepresentation *curRep) const
+{
+    unsigned i_remain = i_bw;
+    if(i_remain > usedBps)
+        i_remain -= usedBps;
+    else
+        i_remain = 0;
+    if(curRep)
+        i_remain += curRep->getBandwidth();
+    return i_remain > i_bw ? i_remain : i_bw;
+}
+
+unsigned HybridAdaptationLogic::getMaxCurrentBw() const
+{
+    unsigned i_max_bitrate = 0;
+    for(std::map<ID, HybridContext>::const_iterator it = streams.begin();
+                                                    it != streams.end(); ++it)
+        i_max_bitrate = std::max(i_max_bitrate, ((*it).second).last_download_rate);
+    return i_max_bitrate;
+}
+
+void HybridAdaptationLogic::updateDownloadProgress(const ID &id, size_t size,
+                                                   vlc_tick_t time)
+{
+    if(!size || time <= 0)
+        return;
+    vlc_mutex_lock(&lock);
+    std::map<ID, HybridContext>::iterator it = streams.find(id);
+    if(it != streams.end())
+        (*it).second.reads.push_back(std::pair<size_t, vlc_tick_t>(size, time));
+    vlc_mutex_unlock(&lock);
+}
+
+void HybridAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
+                                               vlc_tick_t time, vlc_tick_t latency)
+{
+    vlc_mutex_lock(&lock);
+    std::map<ID, HybridContext>::iterator it = streams.find(id);
+    if(it != streams.end())
+    {
+        HybridContext &ctx = (*it).second;
+        ctx.latency = (ctx.latency) ? (ctx.latency * 4 + latency) / 5 : latency;
+
+        const vlc_tick_t transfer = (time > latency) ? time - latency : time;
+        unsigned rate = CLOCK_FREQ * dlsize * 8 / transfer;
+        /* Delivery paced by the origin: the whole segment rate is only
+         * the media bitrate, use the rate of the bursts instead */
+        if(ctx.reads.size() >= 4)
+        {
+            const unsigned burstrate = getBurstRate(ctx.reads);
+            if(rate < burstrate / 2)
+                rate = burstrate;
+        }
+        ctx.reads.clear();
+        ctx.last_download_rate = ctx.average.push(rate);
+    }
+    currentBps = getMaxCurrentBw();
+    vlc_mutex_unlock(&lock);
+}
+
+void HybridAdaptationLogic::trackerEvent(const TrackerEvent &ev)
+{
+    switch(ev.getType())
+    {
+    case TrackerEvent::Type::RepresentationSwitch:
+        {
+            const RepresentationSwitchEvent &event =
+                    static_cast<const RepresentationSwitchEvent &>(ev);
+            vlc_mutex_lock(&lock);
+            if(event.prev)
+                usedBps -= event.prev->getBandwidth();
+            if(event.next)
+                usedBps += event.next->getBandwidth();
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingStateUpdate:
+        {
+            const BufferingStateUpdatedEvent &event =
+                    static_cast<const BufferingStateUpdatedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            if(event.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                {
+                    HybridContext ctx;
+                    streams.insert(std::pair<ID, HybridContext>(id, ctx));
+                }
+            }
+            else
+            {
+                std::map<ID, HybridContext>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &event =
+                    static_cast<const BufferingLevelChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_lock(&lock);
+            std::map<ID, HybridContext>::iterator it = streams.find(id);
+            if(it != streams.end())
+            {
+                HybridContext &ctx = (*it).second;
+                ctx.buffering_level = event.current;
+                ctx.buffering_target = event.target;
+            }
+            vlc_mutex_unlock(&lock);
+        }
+        break;
+
+    default:
+            break;
+    }
+}
@@ -36,6 +36,9 @@ namespace adaptive
         public:
             virtual void updateDownloadRate(const ID &, size_t,
                                             vlc_tick_t, vlc_tick_t) = 0;
+            /* single read of a segment download in progress */
+            virtual void updateDownloadProgress(const ID &, size_t,
+                                                vlc_tick_t) {}
             virtual ~IDownloadRateObserver(){}
     };
 }
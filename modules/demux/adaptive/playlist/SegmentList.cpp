@@ -30,6 +30,7 @@
 #include "SegmentInformation.hpp"
 #include "SegmentTimeline.h"
 
+#include <algorithm>
 #include <limits>
 
 using namespace adaptive::playlist;
@@ -98,27 +99,41 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
     const Segment * prevSegment = lastSegment;
 
     uint64_t firstnumber = updated->segments.front()->getSequenceNumber();
+    /* Delta updates do not list the whole window */
+    const AbstractAttr *startAttr = updated->getAttribute(Type::StartNumber);
+    if(startAttr && startAttr->isValid())
+        firstnumber = std::min(firstnumber,
+                               (const uint64_t &) *(static_cast<const StartnumberAttr *>(startAttr)));
+
+    /* Only the tail can be new: find the first unknown segment from the end */
+    std::vector<Segment *>::iterator first = updated->segments.end();
+    if(lastSegment)
+    {
+        while(first != updated->segments.begin() &&
+              lastSegment->compare(*(first - 1)) < 0)
+            --first;
+    }
+    else first = updated->segments.begin();
 
     std::vector<Segment *>::iterator it;
-    for(it = updated->segments.begin(); it != updated->segments.end(); ++it)
+    for(it = updated->segments.begin(); it != first; ++it)
+        delete *it;
+
+    segments.reserve(segments.size() + (updated->segments.end() - first));
+    for(it = first; it != updated->segments.end(); ++it)
     {
         Segment *cur = *it;
-        if(!lastSegment || lastSegment->compare(cur) < 0)
+        if(b_restamp && prevSegment)
         {
-            if(b_restamp && prevSegment)
+            stime_t starttime = prevSegment->startTime.Get() + prevSegment->duration.Get();
+            if(starttime != cur->startTime.Get() && !cur->discontinuity)
             {
-                stime_t starttime = prevSegment->startTime.Get() + prevSegment->duration.Get();
-                if(starttime != cur->startTime.Get() && !cur->discontinuity)
-                {
-                    cur->startTime.Set(starttime);
-                }
-
-                prevSegment = cur;
+                cur->startTime.Set(starttime);
             }
-            addSegment(cur);
+
+            prevSegment = cur;
         }
-        else
-            delete cur;
+        addSegment(cur);
     }
     updated->segments.clear();
 
@@ -136,17 +151,12 @@ void SegmentList::pruneByPlaybackTime(vlc_tick_t time)
 void SegmentList::pruneBySegmentNumber(uint64_t tobelownum)
 {
     std::vector<Segment *>::iterator it = segments.begin();
-    while(it != segments.end())
+    for(; it != segments.end() && (*it)->getSequenceNumber() < tobelownum; ++it)
     {
-        Segment *seg = *it;
-
-        if(seg->getSequenceNumber() >= tobelownum)
-            break;
-
         totalLength -= (*it)->duration.Get();
         delete *it;
-        it = segments.erase(it);
     }
+    segments.erase(segments.begin(), it);
 }
 
 bool SegmentList::getPlaybackTimeDurationBySegmentNumber(uint64_t number,
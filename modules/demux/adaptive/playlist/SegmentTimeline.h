@@ -26,7 +26,7 @@
 #include "Inheritables.hpp"
 
 #include <vlc_common.h>
-#include <list>
+#include <vector>
 
 namespace adaptive
 {
@@ -56,10 +56,8 @@ namespace adaptive
                 void debug(vlc_object_t *, int = 0) const;
 
             private:
-                std::list<Element *> elements;
-                stime_t totalLength;
-                AbstractMultipleSegmentBaseType *parent;
-
+                /* Run length encoded (t, d, r), number being the running
+                 * count of segments: sorted by both number and time */
                 class Element
                 {
                     public:
@@ -71,6 +69,10 @@ namespace adaptive
                         uint64_t r;
                         uint64_t number;
                 };
+                std::vector<Element>::const_iterator findByNumber(uint64_t) const;
+                std::vector<Element> elements;
+                stime_t totalLength;
+                AbstractMultipleSegmentBaseType *parent;
         };
     }
 }
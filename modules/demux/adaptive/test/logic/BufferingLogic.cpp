@@ -144,6 +144,10 @@ int BufferingLogic_test()
         Expect(bufferinglogic.getMinBuffering(playlist) >= DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
         Expect(bufferinglogic.getLiveDelay(playlist) >= DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT);
 
+        playlist->suggestedPresentationDelay.Set(DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT * 3 / 2);
+        Expect(bufferinglogic.getLiveDelay(playlist) == DefaultBufferingLogic::BUFFERING_LOWEST_LIMIT * 3 / 2);
+        playlist->suggestedPresentationDelay.Set(0);
+
         playlist->b_lowlatency = false;
         Expect(bufferinglogic.getStartSegmentNumber(rep) == number);
 
@@ -345,6 +345,47 @@ int M3U8Playlist_test()
         return 1;
     }
 
+    /* Manifest 4: low latency */
+    const char manifest4[] =
+    "#EXTM3U\n"
+    "#EXT-X-TARGETDURATION:4\n"
+    "#EXT-X-SERVER-CONTROL:CAN-BLOCK-RELOAD=YES,PART-HOLD-BACK=3.0\n"
+    "#EXT-X-PART-INF:PART-TARGET=1.0\n"
+    "#EXT-X-MEDIA-SEQUENCE:10\n"
+    "#EXTINF:4,\n"
+    "foobar.ts\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"foobar2.0.ts\"\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"foobar2.1.ts\"\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"foobar2.2.ts\"\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"foobar2.3.ts\"\n"
+    "#EXTINF:4,\n"
+    "foobar2.ts\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"foobar3.0.ts\"\n"
+    "#EXT-X-PART:DURATION=1.0,URI=\"foobar3.1.ts\"\n"
+    "#EXT-X-PRELOAD-HINT:TYPE=PART,URI=\"foobar3.2.ts\"\n";
+
+    m3u = ParseM3U8(obj, manifest4, sizeof(manifest4));
+    try
+    {
+        Expect(m3u);
+        Expect(m3u->isLive());
+        Expect(m3u->isLowLatency());
+        Expect(m3u->suggestedPresentationDelay.Get() == vlc_tick_from_sec(3));
+        HLSRepresentation *rep = static_cast<HLSRepresentation *>(
+                    m3u->getFirstPeriod()->getAdaptationSets().front()->
+                    getRepresentations().front());
+        /* partial segments are not listed as segments */
+        Expect(rep->getMediaSegment(11));
+        Expect(!rep->getMediaSegment(12));
+        Expect(rep->getUpdateUrl().toString() == "stdin://?_HLS_msn=12&_HLS_part=2");
+
+        delete m3u;
+    }
+    catch (...)
+    {
+        delete m3u;
+        return 1;
+    }
 
     return 0;
 }
@@ -135,6 +135,23 @@ int SegmentList_test()
         Expect(segmentList->getStartSegmentNumber() == 123 + 10);
         Expect(segmentList->getTotalLength() == 100 * 10);
 
+        /* delta update, only listing the tail of the window */
+        delete segmentList2;
+        segmentList2 = new SegmentList(nullptr);
+        segmentList2->addAttribute(new StartnumberAttr(123 + 12));
+        for(int i=18; i<22; i++)
+        {
+            seg = new Segment(nullptr);
+            seg->setSequenceNumber(123 + i);
+            seg->startTime.Set(START + 100 * i);
+            seg->duration.Set(100);
+            segmentList2->addSegment(seg);
+        }
+        segmentList->updateWith(segmentList2);
+        Expect(segmentList->getStartSegmentNumber() == 123 + 12);
+        Expect(segmentList->getTotalLength() == 100 * 10);
+        Expect(segmentList->getSegments().back()->getSequenceNumber() == 123 + 21);
+
         delete segmentList;
         delete segmentList2;
         segmentList2 = nullptr;
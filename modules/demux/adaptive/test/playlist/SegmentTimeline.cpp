@@ -107,6 +107,9 @@ int Timeline_test()
         Expect(timeline->getTotalLength() == 175 + 100*2 + 20*10 + 66);
         Expect(timeline->getElementIndexBySequence(39) == std::numeric_limits<uint64_t>::max());
         Expect(timeline->getElementIndexBySequence(41) == 5);
+        Expect(timeline->getElementNumberByScaledPlaybackTime(START + 900) == 25);
+        Expect(timeline->getElementNumberByScaledPlaybackTime(START + 1000 + 40) == 41);
+        Expect(timeline->getElementNumberByScaledPlaybackTime(START + 5000) == 41);
 
         /* Pruning */
         Expect(timeline->pruneBySequenceNumber(24) == 5+8);
@@ -77,6 +77,14 @@ bool    DOMParser::parse                    (bool b)
     return true;
 }
 
+void DOMParser::setChildrenHandler(const std::string &name, ChildrenHandler *handler)
+{
+    if(handler)
+        handlers[name] = handler;
+    else
+        handlers.erase(name);
+}
+
 bool DOMParser::reset(stream_t *s)
 {
     stream = s;
@@ -95,6 +103,7 @@ Node* DOMParser::processNode(bool b_strict)
     const char *data;
     int type;
     std::stack<Node *> lifo;
+    unsigned skipdepth = 0; /* within children passed to a handler */
 
     while( (type = xml_ReaderNextNode(vlc_reader, &data)) > 0 )
     {
@@ -103,6 +112,26 @@ Node* DOMParser::processNode(bool b_strict)
             case XML_READER_STARTELEM:
             {
                 bool empty = xml_ReaderIsEmptyElement(vlc_reader);
+                if(skipdepth)
+                {
+                    if(!empty)
+                        skipdepth++;
+                    break;
+                }
+
+                if(!handlers.empty() && !lifo.empty())
+                {
+                    std::map<std::string, ChildrenHandler *>::const_iterator it =
+                            handlers.find(lifo.top()->getName());
+                    if(it != handlers.end())
+                    {
+                        (*it).second->addChild(lifo.top(), data, vlc_reader);
+                        if(!empty)
+                            skipdepth = 1;
+                        break;
+                    }
+                }
+
                 Node *node = new (std::nothrow) Node();
                 if(node)
                 {
@@ -121,13 +150,19 @@ Node* DOMParser::processNode(bool b_strict)
 
             case XML_READER_TEXT:
             {
-                if(!lifo.empty())
+                if(!skipdepth && !lifo.empty())
                     lifo.top()->setText(std::string(data));
                 break;
             }
 
             case XML_READER_ENDELEM:
             {
+                if(skipdepth)
+                {
+                    skipdepth--;
+                    break;
+                }
+
                 if(lifo.empty())
                     return nullptr;
 
@@ -30,6 +30,9 @@
 
 #include "Node.h"
 
+#include <map>
+#include <string>
+
 namespace adaptive
 {
     namespace xml
@@ -37,6 +40,15 @@ namespace adaptive
         class DOMParser
         {
             public:
+                /* Streams the children of an element instead of
+                 * building their nodes */
+                class ChildrenHandler
+                {
+                    public:
+                        virtual ~ChildrenHandler() {}
+                        virtual void addChild(Node *, const char *, xml_reader_t *) = 0;
+                };
+
                 DOMParser           ();
                 DOMParser           (stream_t *stream);
                 virtual ~DOMParser  ();
@@ -45,12 +57,14 @@ namespace adaptive
                 bool                reset       (stream_t *);
                 Node*               getRootNode ();
                 void                print       ();
+                void                setChildrenHandler(const std::string &, ChildrenHandler *);
 
             private:
                 Node                *root;
                 stream_t            *stream;
 
                 xml_reader_t        *vlc_reader;
+                std::map<std::string, ChildrenHandler *> handlers;
 
                 Node*   processNode             (bool);
                 void    addAttributesToNode     (Node *node);
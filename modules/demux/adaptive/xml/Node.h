@@ -33,6 +33,13 @@ namespace adaptive
 {
     namespace xml
     {
+        /* Content parsed at read time in place of child nodes */
+        class NodeData
+        {
+            public:
+                virtual ~NodeData() {}
+        };
+
         class Node
         {
             public:
@@ -52,6 +59,8 @@ namespace adaptive
                 const std::map<std::string, std::string>& getAttributes () const;
                 int                                 getType() const;
                 void                                setType( int type );
+                NodeData *                          getData             () const;
+                void                                setData             (NodeData *);
                 std::vector<std::string>            toString(int) const;
 
             private:
@@ -61,6 +70,7 @@ namespace adaptive
                 std::string                         name;
                 std::string                         text;
                 int                                 type;
+                NodeData                            *data;
 
         };
     }
@@ -41,6 +41,7 @@
 #include <vlc_meta.h>
 #include <vlc_codecs.h>
 #include <vlc_charset.h>
+#include <vlc_index_cache.h>
 
 #include "libavi.h"
 #include "../rawdv.h"
@@ -2303,6 +2304,126 @@ static void avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
     p_index->p_entry[p_index->i_size++] = *p_entry;
 }
 
+/* A cached index starts with this header, followed for each track by its
+ * entry count and its entries */
+typedef struct
+{
+    uint32_t i_track;
+    uint32_t i_entry_size;
+    uint64_t i_movi_lastchunk_pos;
+} avi_index_cache_t;
+
+static bool AVI_IndexCacheLoad( demux_t *p_demux, const char *psz_name )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    assert( p_sys->i_track <= 100 );
+    avi_index_t p_idx[p_sys->i_track];
+    size_t i_size;
+    uint8_t *p_data = vlc_index_cache_Load( p_demux, psz_name, &i_size );
+    if( !p_data )
+        return false;
+
+    const uint8_t *p = p_data;
+    const uint8_t *p_end = p_data + i_size;
+    avi_index_cache_t hdr;
+
+    if( i_size < sizeof(hdr) )
+        goto error;
+    memcpy( &hdr, p, sizeof(hdr) );
+    p += sizeof(hdr);
+    if( hdr.i_track != p_sys->i_track ||
+        hdr.i_entry_size != sizeof(avi_entry_t) )
+        goto error;
+
+    unsigned i;
+    for( i = 0; i < p_sys->i_track; i++ )
+    {
+        uint32_t i_count;
+
+        avi_index_Init( &p_idx[i] );
+        if( (size_t)(p_end - p) < sizeof(i_count) )
+            break;
+        memcpy( &i_count, p, sizeof(i_count) );
+        p += sizeof(i_count);
+        if( (size_t)(p_end - p) / sizeof(avi_entry_t) < i_count )
+            break;
+        if( i_count == 0 )
+            continue;
+
+        p_idx[i].p_entry = vlc_alloc( i_count, sizeof(avi_entry_t) );
+        if( !p_idx[i].p_entry )
+            break;
+        memcpy( p_idx[i].p_entry, p, i_count * sizeof(avi_entry_t) );
+        p += i_count * sizeof(avi_entry_t);
+        p_idx[i].i_size = p_idx[i].i_max = i_count;
+    }
+
+    if( i < p_sys->i_track )
+    {
+        while( i > 0 )
+            avi_index_Clean( &p_idx[--i] );
+        goto error;
+    }
+
+    for( i = 0; i < p_sys->i_track; i++ )
+    {
+        avi_index_Clean( &p_sys->track[i]->idx );
+        p_sys->track[i]->idx = p_idx[i];
+        msg_Dbg( p_demux, "stream[%u] loaded %u cached index entries",
+                 i, p_idx[i].i_size );
+    }
+    p_sys->i_movi_lastchunk_pos = hdr.i_movi_lastchunk_pos;
+    free( p_data );
+    return true;
+
+error:
+    msg_Warn( p_demux, "invalid cached index" );
+    free( p_data );
+    return false;
+}
+
+static void AVI_IndexCacheStore( demux_t *p_demux, const char *psz_name )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !var_InheritBool( p_demux, "index-cache" ) )
+        return;
+
+    size_t i_size = sizeof(avi_index_cache_t);
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+        i_size += sizeof(uint32_t) +
+                  p_sys->track[i]->idx.i_size * sizeof(avi_entry_t);
+
+    uint8_t *p_data = malloc( i_size );
+    if( !p_data )
+        return;
+
+    const avi_index_cache_t hdr = {
+        .i_track = p_sys->i_track,
+        .i_entry_size = sizeof(avi_entry_t),
+        .i_movi_lastchunk_pos = p_sys->i_movi_lastchunk_pos,
+    };
+    uint8_t *p = p_data;
+    memcpy( p, &hdr, sizeof(hdr) );
+    p += sizeof(hdr);
+
+    for( unsigned i = 0; i < p_sys->i_track; i++ )
+    {
+        const avi_index_t *p_index = &p_sys->track[i]->idx;
+        const uint32_t i_count = p_index->i_size;
+
+        memcpy( p, &i_count, sizeof(i_count) );
+        p += sizeof(i_count);
+        if( i_count )
+            memcpy( p, p_index->p_entry, i_count * sizeof(avi_entry_t) );
+        p += i_count * sizeof(avi_entry_t);
+    }
+
+    vlc_index_cache_Store( p_demux, psz_name, p_data, i_size );
+    free( p_data );
+}
+
 static int AVI_IndexFind_idx1( demux_t *p_demux,
                                avi_chunk_idx1_t **pp_idx1,
                                uint64_t *pi_offset )
@@ -2529,6 +2650,9 @@ static void AVI_IndexLoad( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    if( AVI_IndexCacheLoad( p_demux, "avi-index" ) )
+        return;
+
     /* Load indexes */
     assert( p_sys->i_track <= 100 );
     avi_index_t p_idx_indx[p_sys->i_track];
@@ -2584,6 +2708,8 @@ static void AVI_IndexLoad( demux_t *p_demux )
         msg_Dbg( p_demux, "stream[%d] created %d index entries",
                  i, p_index->i_size );
     }
+
+    AVI_IndexCacheStore( p_demux, "avi-index" );
 }
 
 static void AVI_IndexCreate( demux_t *p_demux )
@@ -2598,6 +2724,7 @@ static void AVI_IndexCreate( demux_t *p_demux )
 
     vlc_tick_t i_dialog_update;
     vlc_dialog_id *p_dialog_id = NULL;
+    bool b_cancelled = false;
 
     p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true );
     p_movi = AVI_ChunkFind( p_riff, AVIFOURCC_movi, 0, true );
@@ -2608,6 +2735,9 @@ static void AVI_IndexCreate( demux_t *p_demux )
         return;
     }
 
+    if( AVI_IndexCacheLoad( p_demux, "avi-scan" ) )
+        return;
+
     for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
         avi_index_Init( &p_sys->track[i_stream]->idx );
 
@@ -2636,7 +2766,10 @@ static void AVI_IndexCreate( demux_t *p_demux )
         if( p_dialog_id != NULL && vlc_tick_now() - i_dialog_update > VLC_TICK_FROM_MS(100) )
         {
             if( vlc_dialog_is_cancelled( p_demux, p_dialog_id ) )
+            {
+                b_cancelled = true;
                 break;
+            }
 
             double f_current = vlc_stream_Tell( p_demux->s );
             double f_size    = stream_Size( p_demux->s );
@@ -2715,6 +2848,10 @@ print_stat:
         msg_Dbg( p_demux, "stream[%d] creating %d index entries",
                 i_stream, p_sys->track[i_stream]->idx.i_size );
     }
+
+    /* A cancelled scan only gives the start of the index */
+    if( !b_cancelled )
+        AVI_IndexCacheStore( p_demux, "avi-scan" );
 }
 
 /* */
@@ -106,6 +106,7 @@ bool DASHManager::updatePlaylist()
         }
 
         xml::DOMParser parser(mpdstream);
+        IsoffMainParser::setupDOMParser(parser);
         if(!parser.parse(true))
         {
             vlc_stream_Delete(mpdstream);
@@ -40,11 +40,15 @@
 #include "ProgramInformation.h"
 #include "DASHSegment.h"
 #include "../../adaptive/xml/DOMHelper.h"
+#include "../../adaptive/xml/DOMParser.h"
 #include "../../adaptive/tools/Helper.h"
 #include "../../adaptive/tools/Debug.hpp"
 #include "../../adaptive/tools/Conversions.hpp"
 #include <vlc_stream.h>
+#include <vlc_xml.h>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <limits>
 
 using namespace dash::mpd;
@@ -64,6 +68,73 @@ IsoffMainParser::~IsoffMainParser   ()
 {
 }
 
+namespace
+{
+    /* SegmentTimeline S elements, read without building their nodes */
+    class TimelineData : public NodeData
+    {
+        public:
+            struct S
+            {
+                stime_t t;
+                stime_t d;
+                int64_t r;
+                bool has_t;
+            };
+            std::vector<S> elements;
+    };
+
+    class TimelineChildrenHandler : public DOMParser::ChildrenHandler
+    {
+        public:
+            virtual void addChild(Node *parent, const char *name,
+                                  xml_reader_t *reader) override
+            {
+                if(strcmp(name, "S"))
+                    return;
+
+                TimelineData::S s = { 0, 0, 0, false };
+                bool has_d = false;
+                const char *attrName, *attrValue;
+                while((attrName = xml_ReaderNextAttr(reader, &attrValue)) != nullptr)
+                {
+                    if(!strcmp(attrName, "t"))
+                    {
+                        s.t = strtoll(attrValue, nullptr, 10);
+                        s.has_t = true;
+                    }
+                    else if(!strcmp(attrName, "d"))
+                    {
+                        s.d = strtoll(attrValue, nullptr, 10);
+                        has_d = true;
+                    }
+                    else if(!strcmp(attrName, "r"))
+                    {
+                        s.r = strtoll(attrValue, nullptr, 10);
+                    }
+                }
+                if(!has_d) /* Mandatory */
+                    return;
+
+                TimelineData *data = dynamic_cast<TimelineData *>(parent->getData());
+                if(!data)
+                {
+                    data = new (std::nothrow) TimelineData();
+                    if(!data)
+                        return;
+                    parent->setData(data);
+                }
+                data->elements.push_back(s);
+            }
+    };
+}
+
+void IsoffMainParser::setupDOMParser(DOMParser &parser)
+{
+    static TimelineChildrenHandler timelineHandler;
+    parser.setChildrenHandler("SegmentTimeline", &timelineHandler);
+}
+
 template <class T>
 static void parseAvailability(MPD *mpd, Node *node, T *s)
 {
@@ -519,6 +590,22 @@ void IsoffMainParser::parseTimeline(Node *node, AbstractMultipleSegmentBaseType
     SegmentTimeline *timeline = new (std::nothrow) SegmentTimeline(base);
     if(timeline)
     {
+        const TimelineData *data = dynamic_cast<const TimelineData *>(node->getData());
+        if(data)
+        {
+            std::vector<TimelineData::S>::const_iterator it;
+            for(it = data->elements.begin(); it != data->elements.end(); ++it)
+            {
+                const int64_t r = ((*it).r < 0) ? std::numeric_limits<unsigned>::max() : (*it).r;
+                if((*it).has_t)
+                    timeline->addElement(number, (*it).d, r, (*it).t);
+                else
+                    timeline->addElement(number, (*it).d, r);
+                number += (1 + r);
+            }
+        }
+
+        /* S nodes, if the DOM was built without the children handler */
         std::vector<Node *> elements = DOMHelper::getElementByTagName(node, "S", false);
         std::vector<Node *>::const_iterator it;
         for(it = elements.begin(); it != elements.end(); ++it)
@@ -48,6 +48,7 @@ namespace adaptive
     namespace xml
     {
         class Node;
+        class DOMParser;
     }
 }
 
@@ -68,6 +69,7 @@ namespace dash
                                              stream_t *p_stream, const std::string &);
                 virtual ~IsoffMainParser    ();
                 MPD *   parse();
+                static void setupDOMParser  (xml::DOMParser &);
 
             private:
                 mpd::Profile getProfile     () const;
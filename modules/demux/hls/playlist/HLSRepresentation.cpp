@@ -35,6 +35,7 @@
 #include <ctime>
 #include <limits>
 #include <cassert>
+#include <sstream>
 
 using namespace hls;
 using namespace hls::playlist;
@@ -48,6 +49,12 @@ HLSRepresentation::HLSRepresentation  ( BaseAdaptationSet *set ) :
     lastUpdateTime = 0;
     targetDuration = 0;
     streamFormat = StreamFormat::UNKNOWN;
+    b_canBlockReload = false;
+    partTargetDuration = 0;
+    nextSequenceNumber = 0;
+    nextPartNumber = 0;
+    canSkipUntil = 0;
+    b_fullReload = false;
 }
 
 HLSRepresentation::~HLSRepresentation ()
@@ -64,6 +71,11 @@ bool HLSRepresentation::isLive() const
     return b_live;
 }
 
+bool HLSRepresentation::isLowLatency() const
+{
+    return partTargetDuration > 0;
+}
+
 bool HLSRepresentation::initialized() const
 {
     return b_loaded;
@@ -89,6 +101,38 @@ Url HLSRepresentation::getPlaylistUrl() const
     }
 }
 
+Url HLSRepresentation::getUpdateUrl() const
+{
+    Url url = getPlaylistUrl();
+    if(!b_loaded || !isLive())
+        return url;
+
+    /* Delta update: the server can replace the segments we already
+     * know with an EXT-X-SKIP tag, as long as our copy is recent enough */
+    const bool b_skip = canSkipUntil > 0 && !b_fullReload && lastUpdateTime &&
+                        vlc_tick_now() - lastUpdateTime < canSkipUntil / 2;
+    if(!b_canBlockReload && !b_skip)
+        return url;
+
+    std::string str = url.toString();
+    std::ostringstream os;
+    os.imbue(std::locale("C"));
+    os << str;
+    char sep = (str.find('?') == std::string::npos) ? '?' : '&';
+    /* Blocking playlist reload: the server holds the request until
+     * the next segment, or part, becomes available */
+    if(b_canBlockReload)
+    {
+        os << sep << "_HLS_msn=" << nextSequenceNumber;
+        if(isLowLatency())
+            os << "&_HLS_part=" << nextPartNumber;
+        sep = '&';
+    }
+    if(b_skip)
+        os << sep << "_HLS_skip=YES";
+    return Url(os.str());
+}
+
 void HLSRepresentation::debug(vlc_object_t *obj, int indent) const
 {
     BaseRepresentation::debug(obj, indent);
@@ -138,7 +182,13 @@ bool HLSRepresentation::needsUpdate(uint64_t number) const
         const vlc_tick_t duration = targetDuration
                                   ? vlc_tick_from_sec(targetDuration)
                                   : VLC_TICK_FROM_SEC(2);
-        if(elapsed < duration)
+        /* Blocking reloads return as soon as there is something new,
+         * which makes polling at the target duration unnecessary */
+        vlc_tick_t interval = duration;
+        if(b_canBlockReload)
+            interval = isLowLatency() ? partTargetDuration / 2
+                                      : VLC_TICK_FROM_MS(500);
+        if(elapsed < interval)
             return false;
 
         if(number != std::numeric_limits<uint64_t>::max())
@@ -45,7 +45,9 @@ namespace hls
 
                 void setPlaylistUrl(const std::string &);
                 Url getPlaylistUrl() const;
+                Url getUpdateUrl() const;
                 bool isLive() const;
+                bool isLowLatency() const;
                 bool initialized() const;
                 virtual void scheduleNextUpdate(uint64_t, bool) override;
                 virtual bool needsUpdate(uint64_t) const override;
@@ -62,6 +64,14 @@ namespace hls
                 vlc_tick_t lastUpdateTime;
                 time_t targetDuration;
                 Url playlistUrl;
+                /* Low latency (blocking reload and partial segments) */
+                bool b_canBlockReload;
+                vlc_tick_t partTargetDuration;
+                uint64_t nextSequenceNumber; /* of the segment in progress */
+                unsigned nextPartNumber; /* of the part in progress */
+                /* Playlist delta updates */
+                vlc_tick_t canSkipUntil;
+                bool b_fullReload; /* previous delta could not be merged */
         };
     }
 }
@@ -162,7 +162,7 @@ void M3U8Parser::createAndFillRepresentation(vlc_object_t *p_obj, BaseAdaptation
 
 bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresentation *rep)
 {
-    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getPlaylistUrl().toString());
+    block_t *p_block = Retrieve::HTTP(resources, ChunkType::Playlist, rep->getUpdateUrl().toString());
     if(p_block)
     {
         stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
@@ -233,6 +233,14 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     const SingleValueTag *ctx_byterange = nullptr;
     CommonEncryption encryption;
     const ValuesListTag *ctx_extinf = nullptr;
+    unsigned partsCount = 0;
+    vlc_tick_t partHoldBack = 0;
+    uint64_t mediaSequence = 0;
+    uint64_t skippedSegments = 0;
+
+    rep->b_canBlockReload = false;
+    rep->partTargetDuration = 0;
+    rep->canSkipUntil = 0;
 
     std::list<Tag *>::const_iterator it;
     for(it = tagslist.begin(); it != tagslist.end(); ++it)
@@ -244,6 +252,7 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
             case SingleValueTag::EXTXMEDIASEQUENCE:
             {
                 sequenceNumber = (static_cast<const SingleValueTag*>(tag))->getValue().decimal();
+                mediaSequence = sequenceNumber;
             }
             break;
 
@@ -267,6 +276,8 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                 if(!segment)
                     break;
 
+                partsCount = 0; /* parts preceding a segment are part of it */
+
                 segment->setSourceUrl(uritag->getValue().value);
 
                 /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
@@ -361,15 +372,81 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                 discontinuity  = true;
                 break;
 
+            case AttributesTag::EXTXSERVERCONTROL:
+            {
+                const AttributesTag *ctrltag = static_cast<const AttributesTag *>(tag);
+                const Attribute *attr = ctrltag->getAttributeByName("CAN-BLOCK-RELOAD");
+                if(attr && attr->value == "YES")
+                    rep->b_canBlockReload = true;
+                attr = ctrltag->getAttributeByName("PART-HOLD-BACK");
+                if(attr)
+                    partHoldBack = vlc_tick_from_sec(attr->floatingPoint());
+                attr = ctrltag->getAttributeByName("CAN-SKIP-UNTIL");
+                if(attr)
+                    rep->canSkipUntil = vlc_tick_from_sec(attr->floatingPoint());
+            }
+            break;
+
+            case AttributesTag::EXTXSKIP:
+            {
+                /* Delta update: those segments are the ones we already have */
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->
+                                            getAttributeByName("SKIPPED-SEGMENTS");
+                if(attr)
+                {
+                    skippedSegments = attr->decimal();
+                    sequenceNumber += skippedSegments;
+                }
+            }
+            break;
+
+            case AttributesTag::EXTXPARTINF:
+            {
+                const Attribute *attr = static_cast<const AttributesTag *>(tag)->
+                                            getAttributeByName("PART-TARGET");
+                if(attr)
+                    rep->partTargetDuration = vlc_tick_from_sec(attr->floatingPoint());
+            }
+            break;
+
+            case AttributesTag::EXTXPART:
+                /* Partial segments are not played, but they tell what is
+                 * available for the next blocking reload */
+                partsCount++;
+                break;
+
             case Tag::EXTXENDLIST:
                 rep->b_live = false;
                 break;
         }
     }
 
+    rep->nextSequenceNumber = sequenceNumber;
+    rep->nextPartNumber = partsCount;
+
+    if(skippedSegments)
+    {
+        /* Skipped segments can only be restored from our previous copy */
+        const SegmentList *current = rep->inheritSegmentList();
+        if(!current || current->getSegments().empty() ||
+           current->getSegments().back()->getSequenceNumber() + 1 < mediaSequence + skippedSegments)
+        {
+            delete segmentList;
+            rep->b_fullReload = true;
+            return;
+        }
+        /* Do not prune the window up to the first listed segment */
+        segmentList->addAttribute(new StartnumberAttr(mediaSequence));
+    }
+    rep->b_fullReload = false;
+
     if(rep->isLive())
     {
         rep->getPlaylist()->duration.Set(0);
+        /* Never play closer to the live edge than the server allows */
+        if(rep->isLowLatency() &&
+           partHoldBack > rep->getPlaylist()->suggestedPresentationDelay.Get())
+            rep->getPlaylist()->suggestedPresentationDelay.Set(partHoldBack);
     }
     else if(totalduration > rep->getPlaylist()->duration.Get())
     {
@@ -688,8 +688,25 @@ bool matroska_segment_c::Preload( )
     b_preloaded = true;
 
     if( cluster )
+    {
         EnsureDuration();
 
+        /* without cues, find the other clusters while playing */
+        if( !b_cues && sys.b_seekable &&
+            !var_InheritBool( &sys.demuxer, "mkv-preload-clusters" ) &&
+            var_InheritBool( &sys.demuxer, "mkv-index-clusters" ) )
+        {
+            vlc_stream_io_callback *io = dynamic_cast<vlc_stream_io_callback *>( &es.I_O() );
+            SegmentSeeker::fptr_t end = std::numeric_limits<SegmentSeeker::fptr_t>::max();
+            if( segment->IsFiniteSize() )
+                end = segment->GetEndPosition();
+
+            if( io != NULL )
+                _seeker.start_cluster_scan( &sys.demuxer, io->GetStream(),
+                                            cluster->GetElementPosition(), end, i_timescale );
+        }
+    }
+
     return true;
 }
 
@@ -838,6 +855,8 @@ bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date,
 
     // find appropriate seekpoints //
 
+    _seeker.merge_scanned_clusters();
+
     try {
         seekpoints = _seeker.get_seekpoints( *this, i_mk_date, priority, selected_tracks );
     }
@@ -28,6 +28,9 @@
 #include "util.hpp"
 #include "stream_io_callback.hpp"
 
+#include <vlc_access.h>
+#include <vlc_interrupt.h>
+
 #include <sstream>
 #include <limits>
 
@@ -76,6 +79,12 @@ SegmentSeeker::add_cluster( KaxCluster * const p_cluster )
 
     add_cluster_position( cinfo.fpos );
 
+    return add_cluster( cinfo );
+}
+
+SegmentSeeker::cluster_map_t::iterator
+SegmentSeeker::add_cluster( Cluster const& cinfo )
+{
     cluster_map_t::iterator it = _clusters.lower_bound( cinfo.pts );
 
     if( it != _clusters.end() && it->second.pts == cinfo.pts )
@@ -530,4 +539,224 @@ SegmentSeeker::mkv_jump_to( matroska_segment_c& ms, fptr_t fpos )
         ms.es.I_O().setFilePointer( fpos );
 }
 
+// -----------------------------------------------------------------------
+// Background cluster scan
+//
+// Without usable Cues, seeking has to walk the clusters from the closest
+// known one. The scan jumps from cluster to cluster on its own access,
+// reading only the element headers and the cluster timecodes, so that the
+// seeks can use its partial results while it goes on.
+// -----------------------------------------------------------------------
+
+struct SegmentSeeker::ClusterScan
+{
+    demux_t         *demuxer;
+    char            *psz_url;
+    fptr_t           start, end;
+    uint64_t         timescale;
+
+    vlc_thread_t     thread;
+    vlc_interrupt_t *interrupt;
+
+    vlc_mutex_t      lock;
+    std::vector<Cluster> found; /* not merged yet */
+
+    static void *Run( void * );
+};
+
+namespace {
+    enum {
+        EBML_ID_CLUSTER   = 0x1F43B675,
+        EBML_ID_TIMECODE  = 0xE7,
+        EBML_ID_CRC32     = 0xBF,
+        EBML_ID_VOID      = 0xEC,
+    };
+
+    /* Reads an EBML variable size integer, returns its length or 0 */
+    size_t ebml_read_vint( const uint8_t *p, size_t len, uint64_t *value,
+                           bool b_keep_marker, bool *pb_unknown = NULL )
+    {
+        if( len == 0 || p[0] == 0 )
+            return 0;
+
+        size_t length = 1;
+        uint8_t mask = 0x80;
+        while( !( p[0] & mask ) )
+        {
+            mask >>= 1;
+            length++;
+        }
+        if( length > len )
+            return 0;
+
+        uint64_t v = b_keep_marker ? p[0] : ( p[0] & ( mask - 1 ) );
+        for( size_t i = 1; i < length; i++ )
+            v = ( v << 8 ) | p[i];
+
+        if( pb_unknown )
+            *pb_unknown = v == ( UINT64_C(1) << ( 7 * length ) ) - 1;
+        *value = v;
+        return length;
+    }
+}
+
+void *
+SegmentSeeker::ClusterScan::Run( void *data )
+{
+    ClusterScan *scan = static_cast<ClusterScan *>( data );
+
+    vlc_interrupt_set( scan->interrupt );
+
+    stream_t *s = vlc_access_NewMRL( VLC_OBJECT( scan->demuxer ), scan->psz_url );
+    if( s == NULL )
+        return NULL;
+
+    fptr_t pos = scan->start;
+    size_t count = 0;
+
+    while( pos < scan->end && !vlc_killed() )
+    {
+        const uint8_t *p;
+        uint64_t id, size;
+        bool b_unknown;
+
+        if( vlc_stream_Seek( s, pos ) )
+            break;
+
+        ssize_t len = vlc_stream_Peek( s, &p, 48 );
+        if( len < 2 )
+            break;
+
+        size_t i_id = ebml_read_vint( p, len, &id, true );
+        if( i_id == 0 || i_id > 4 )
+            break;
+        size_t i_size = ebml_read_vint( p + i_id, len - i_id, &size, false, &b_unknown );
+        if( i_size == 0 || b_unknown )
+            break; /* cannot jump over it */
+
+        const size_t i_header = i_id + i_size;
+
+        if( id == EBML_ID_CLUSTER )
+        {
+            /* the timecode comes first, possibly after a CRC */
+            for( size_t off = i_header; off < (size_t)len; )
+            {
+                uint64_t child_id, child_size;
+                size_t i_cid = ebml_read_vint( p + off, len - off, &child_id, true );
+                if( i_cid == 0 )
+                    break;
+                size_t i_csize = ebml_read_vint( p + off + i_cid, len - off - i_cid,
+                                                 &child_size, false );
+                if( i_csize == 0 )
+                    break;
+                off += i_cid + i_csize;
+
+                if( child_id == EBML_ID_TIMECODE )
+                {
+                    if( child_size > 8 || off + child_size > (size_t)len )
+                        break;
+
+                    uint64_t timecode = 0;
+                    for( size_t i = 0; i < child_size; i++ )
+                        timecode = ( timecode << 8 ) | p[off + i];
+
+                    Cluster cinfo = {
+                        /* fpos     */ pos,
+                        /* pts      */ VLC_TICK_FROM_NS( timecode * scan->timescale ),
+                        /* duration */ vlc_tick_t( -1 ),
+                        /* size     */ i_header + size,
+                    };
+
+                    vlc_mutex_lock( &scan->lock );
+                    scan->found.push_back( cinfo );
+                    vlc_mutex_unlock( &scan->lock );
+                    count++;
+                    break;
+                }
+                if( child_id != EBML_ID_CRC32 && child_id != EBML_ID_VOID )
+                    break;
+                off += child_size;
+            }
+        }
+
+        pos += i_header + size;
+    }
+
+    msg_Dbg( scan->demuxer, "cluster scan %s after %zu clusters",
+             vlc_killed() ? "stopped" : "done", count );
+    vlc_stream_Delete( s );
+    return NULL;
+}
+
+void
+SegmentSeeker::start_cluster_scan( demux_t *demuxer, stream_t *s,
+                                   fptr_t start, fptr_t end, uint64_t timescale )
+{
+    if( _scan != NULL || s->psz_url == NULL )
+        return;
+
+    ClusterScan *scan = new (std::nothrow) ClusterScan;
+    if( unlikely( scan == NULL ) )
+        return;
+
+    scan->demuxer   = demuxer;
+    scan->psz_url   = strdup( s->psz_url );
+    scan->start     = start;
+    scan->end       = end;
+    scan->timescale = timescale;
+    scan->interrupt = vlc_interrupt_create();
+    vlc_mutex_init( &scan->lock );
+
+    if( scan->psz_url == NULL || scan->interrupt == NULL ||
+        vlc_clone( &scan->thread, ClusterScan::Run, scan, VLC_THREAD_PRIORITY_LOW ) )
+    {
+        if( scan->interrupt )
+            vlc_interrupt_destroy( scan->interrupt );
+        free( scan->psz_url );
+        delete scan;
+        return;
+    }
+
+    _scan = scan;
+}
+
+void
+SegmentSeeker::stop_cluster_scan()
+{
+    if( _scan == NULL )
+        return;
+
+    vlc_interrupt_kill( _scan->interrupt );
+    vlc_join( _scan->thread, NULL );
+    vlc_interrupt_destroy( _scan->interrupt );
+    free( _scan->psz_url );
+    delete _scan;
+    _scan = NULL;
+}
+
+void
+SegmentSeeker::merge_scanned_clusters()
+{
+    if( _scan == NULL )
+        return;
+
+    std::vector<Cluster> found;
+
+    vlc_mutex_lock( &_scan->lock );
+    found.swap( _scan->found );
+    vlc_mutex_unlock( &_scan->lock );
+
+    for( std::vector<Cluster>::const_iterator it = found.begin(); it != found.end(); ++it )
+    {
+        if( !std::binary_search( _cluster_positions.begin(), _cluster_positions.end(), it->fpos ) )
+            add_cluster_position( it->fpos );
+        add_cluster( *it );
+    }
+}
+
+SegmentSeeker::~SegmentSeeker()
+{
+    stop_cluster_scan();
+}
+
 } // namespace
@@ -87,7 +87,14 @@ class SegmentSeeker
             fptr_t  size;
         };
 
+        struct ClusterScan;
+
     public:
+        SegmentSeeker() : _scan( NULL ) { }
+        SegmentSeeker( SegmentSeeker const& ) = delete;
+        SegmentSeeker& operator=( SegmentSeeker const& ) = delete;
+        ~SegmentSeeker();
+
         typedef std::vector<track_id_t> track_ids_t;
         typedef std::vector<Range> ranges_t;
         typedef std::vector<Seekpoint> seekpoints_t;
@@ -110,6 +117,11 @@ class SegmentSeeker
 
         cluster_positions_t::iterator add_cluster_position( fptr_t pos );
         cluster_map_t      ::iterator add_cluster( KaxCluster * const );
+        cluster_map_t      ::iterator add_cluster( Cluster const& );
+
+        void start_cluster_scan( demux_t *, stream_t *, fptr_t start, fptr_t end, uint64_t timescale );
+        void stop_cluster_scan();
+        void merge_scanned_clusters();
 
         void mkv_jump_to( matroska_segment_c&, fptr_t );
 
@@ -124,6 +136,7 @@ class SegmentSeeker
         tracks_seekpoints_t _tracks_seekpoints;
         cluster_positions_t _cluster_positions;
         cluster_map_t       _clusters;
+        ClusterScan        *_scan;
 };
 
 } // namespace
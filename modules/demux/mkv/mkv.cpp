@@ -82,6 +82,10 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback"), true );
 
+    add_bool( "mkv-index-clusters", true,
+            N_("Index clusters in the background"),
+            N_("Find the cluster positions while playing files without cues, to seek faster"), true );
+
     add_shortcut( "mka", "mkv" )
     add_file_extension("mka")
     add_file_extension("mks")
@@ -821,7 +821,7 @@ int OpenHEIF( vlc_object_t * p_this )
             return VLC_EGENERIC;
     }
 
-    MP4_Box_t *p_root = MP4_BoxGetRoot( p_demux->s );
+    MP4_Box_t *p_root = MP4_BoxGetRoot( p_demux->s, true );
     if( !p_root )
         return VLC_EGENERIC;
 
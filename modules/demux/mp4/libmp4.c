@@ -368,6 +368,40 @@ static int MP4_PeekBoxHeader( stream_t *p_stream, MP4_Box_t *p_box )
  * if p_box == NULL, box is invalid or failed, position undefined
  * on success, position is past read box or EOF
  *****************************************************************************/
+/* Sample tables skipped by a root without BOX_FLAG_NO_SAMPLE_TABLES. The stts
+ * is kept, as it gives the number of samples and is usually small. */
+static bool MP4_BoxIsSkippedSampleTable( const MP4_Box_t *p_father,
+                                         uint32_t i_type )
+{
+    if( !p_father || p_father->i_type != ATOM_stbl )
+        return false;
+
+    const MP4_Box_t *p_root = p_father;
+    while( p_root->p_father )
+        p_root = p_root->p_father;
+    if( !(p_root->e_flags & BOX_FLAG_NO_SAMPLE_TABLES) )
+        return false;
+
+    switch( i_type )
+    {
+        case ATOM_stsz:
+        case ATOM_stz2:
+        case ATOM_stsc:
+        case ATOM_stco:
+        case ATOM_co64:
+        case ATOM_ctts:
+        case ATOM_stss:
+        case ATOM_stsh:
+        case ATOM_stdp:
+        case ATOM_sdtp:
+        case ATOM_sbgp:
+        case ATOM_sgpd:
+            return true;
+        default:
+            return false;
+    }
+}
+
 static MP4_Box_t *MP4_ReadBoxRestricted( stream_t *p_stream, MP4_Box_t *p_father,
                                          const uint32_t stopbefore[], bool *pb_restrictionhit )
 {
@@ -405,6 +439,12 @@ static MP4_Box_t *MP4_ReadBoxRestricted( stream_t *p_stream, MP4_Box_t *p_father
         }
     }
 
+    if( MP4_BoxIsSkippedSampleTable( p_father, peekbox.i_type ) )
+    {
+        MP4_Seek( p_stream, peekbox.i_pos + peekbox.i_size );
+        return NULL;
+    }
+
     /* Everything seems OK */
     MP4_Box_t *p_box = (MP4_Box_t *) malloc( sizeof(MP4_Box_t) );
     if( !p_box )
@@ -5304,7 +5344,7 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t *s )
  *  The first box is a virtual box "root" and is the father for all first
  *  level boxes for the file, a sort of virtual contener
  *****************************************************************************/
-MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream )
+MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream, bool b_sample_tables )
 {
     int i_result;
 
@@ -5313,6 +5353,8 @@ MP4_Box_t *MP4_BoxGetRoot( stream_t *p_stream )
         return NULL;
 
     p_vroot->i_shortsize = 1;
+    if( !b_sample_tables )
+        p_vroot->e_flags |= BOX_FLAG_NO_SAMPLE_TABLES;
     uint64_t i_size;
     if( vlc_stream_GetSize( p_stream, &i_size ) == 0 )
         p_vroot->i_size = i_size;
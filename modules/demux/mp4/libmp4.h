@@ -1845,7 +1845,8 @@ struct MP4_Box_s
     enum
     {
         BOX_FLAG_NONE = 0,
-        BOX_FLAG_INCOMPLETE,
+        BOX_FLAG_INCOMPLETE = 1 << 0,
+        BOX_FLAG_NO_SAMPLE_TABLES = 1 << 1, /* root only: skip the sample tables */
     }            e_flags;
 
     UUID_t       i_uuid;  /* Set if i_type == "uuid" */
@@ -1909,9 +1910,12 @@ MP4_Box_t *MP4_BoxGetNextChunk( stream_t * );
  * MP4_BoxGetRoot : Parse the entire file, and create all boxes in memory
  *****************************************************************************
  *  The first box is a virtual box "root" and is the father for all first
- *  level boxes
+ *  level boxes.
+ *  If b_sample_tables is false, the sample tables (sizes, chunks, sync
+ *  samples...) are skipped: only the stts of each track is read, which is
+ *  enough to get the formats, durations and metadata.
  *****************************************************************************/
-MP4_Box_t *MP4_BoxGetRoot( stream_t * );
+MP4_Box_t *MP4_BoxGetRoot( stream_t *, bool b_sample_tables );
 
 /*****************************************************************************
  * MP4_BoxNew : Allocates a new MP4 Box with its atom type
@@ -359,42 +359,54 @@ static const mp4_chunk_t * MP4_TrackChunkForSample( const mp4_track_t *p_track,
     return NULL;
 }
 
+static uint32_t MP4_ChunkXTTSCount( const mp4_chunk_xtts_t *p_xtts,
+                                    uint32_t i_index )
+{
+    if( i_index + 1 == p_xtts->i_entries )
+        return p_xtts->i_last_count;
+    if( i_index == 0 )
+        return p_xtts->i_first_count;
+    return p_xtts->p_count[i_index];
+}
+
 static stime_t MP4_ChunkGetSampleDTS( const mp4_chunk_t *p_chunk,
                                       uint32_t i_sample )
 {
+    const mp4_chunk_xtts_t *p_dts = &p_chunk->dts;
     uint32_t i_index = 0;
     stime_t sdts = p_chunk->i_first_dts;
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+    while( i_sample > 0 && i_index < p_dts->i_entries )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        uint32_t i_count = MP4_ChunkXTTSCount( p_dts, i_index );
+        if( i_sample > i_count )
         {
-            sdts += p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index++];
+            sdts += (stime_t) i_count * p_dts->p_value[i_index++];
+            i_sample -= i_count;
         }
         else
         {
-            sdts += i_sample * p_chunk->p_sample_delta_dts[i_index];
+            sdts += (stime_t) i_sample * p_dts->p_value[i_index];
             break;
         }
     }
     return sdts;
 }
 
-static bool MP4_ChunkGetSampleCTSDelta( const mp4_chunk_t *p_chunk,
+static bool MP4_ChunkGetSampleCTSDelta( const mp4_track_t *p_track,
+                                        const mp4_chunk_t *p_chunk,
                                         uint32_t i_sample, stime_t *pi_delta )
 {
-    if( p_chunk->p_sample_count_pts && p_chunk->p_sample_offset_pts )
+    const mp4_chunk_xtts_t *p_pts = &p_chunk->pts;
+    for( uint32_t i_index = 0; i_index < p_pts->i_entries ; i_index++ )
     {
-        for( uint32_t i_index = 0; i_index < p_chunk->i_entries_pts ; i_index++ )
+        uint32_t i_count = MP4_ChunkXTTSCount( p_pts, i_index );
+        if( i_sample < i_count )
         {
-            if( i_sample < p_chunk->p_sample_count_pts[i_index] )
-            {
-                *pi_delta = p_chunk->p_sample_offset_pts[i_index];
-                return true;
-            }
-            i_sample -= p_chunk->p_sample_count_pts[i_index];
+            stime_t i_ctsdelta = p_pts->p_value[i_index] + p_track->i_cts_shift;
+            *pi_delta = __MAX( i_ctsdelta, 0 ); /* should not be negative */
+            return true;
         }
+        i_sample -= i_count;
     }
     return false;
 }
@@ -453,14 +465,16 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     stime_t i_duration = 0;
 
     /* Forward to right index, and set remaining count in that index */
+    const mp4_chunk_xtts_t *p_dts = &p_chunk->dts;
     unsigned i_index = 0;
     unsigned i_remain = 0;
     for( unsigned i = p_chunk->i_sample_first;
-         i<p_track->i_sample && i_index < p_chunk->i_entries_dts; )
+         i<p_track->i_sample && i_index < p_dts->i_entries; )
     {
-        if( p_track->i_sample - i >= p_chunk->p_sample_count_dts[i_index] )
+        uint32_t i_count = MP4_ChunkXTTSCount( p_dts, i_index );
+        if( p_track->i_sample - i >= i_count )
         {
-            i += p_chunk->p_sample_count_dts[i_index];
+            i += i_count;
             i_index++;
         }
         else
@@ -471,19 +485,20 @@ static inline vlc_tick_t MP4_GetSamplesDuration( demux_t *p_demux, mp4_track_t *
     }
 
     /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
+    while( i_nb_samples > 0 && i_index < p_dts->i_entries )
     {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
+        uint32_t i_count = MP4_ChunkXTTSCount( p_dts, i_index );
+        if( i_nb_samples >= i_count - i_remain )
         {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
+            i_duration += (i_count - i_remain) *
+                          (int64_t) p_dts->p_value[i_index];
+            i_nb_samples -= (i_count - i_remain);
             i_index++;
             i_remain = 0;
         }
         else
         {
-            i_duration += i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
+            i_duration += i_nb_samples * (int64_t) p_dts->p_value[i_index];
             break;
         }
     }
@@ -503,7 +518,8 @@ static int LoadInitFrag( demux_t *p_demux )
     demux_sys_t *p_sys = p_demux->p_sys;
 
     /* Load all boxes ( except raw data ) */
-    MP4_Box_t *p_root = MP4_BoxGetRoot( p_demux->s );
+    /* The preparser only needs the formats and metadata */
+    MP4_Box_t *p_root = MP4_BoxGetRoot( p_demux->s, !p_demux->b_preparsing );
     if( p_root == NULL || !MP4_BoxGet( p_root, "/moov" ) )
     {
         MP4_BoxFree( p_root );
@@ -2343,7 +2359,7 @@ static void LoadChapter( demux_t  *p_demux )
         for( unsigned i = 0; i < p_sys->i_tracks; i++ )
         {
             mp4_track_t *tk = &p_sys->track[i];
-            if(tk->b_ok && (tk->i_use_flags & USEAS_CHAPTERS) &&
+            if(tk->b_ok && tk->i_chunk_count && (tk->i_use_flags & USEAS_CHAPTERS) &&
                tk->fmt.i_cat == SPU_ES && tk->fmt.i_codec == VLC_CODEC_TX3G)
             {
                 LoadChapterApple( p_demux, tk );
@@ -2398,12 +2414,8 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
 
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
+        ck->dts = (mp4_chunk_xtts_t) { 0 };
+        ck->pts = (mp4_chunk_xtts_t) { 0 };
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2465,52 +2477,45 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
+/* Maps the i_sample_count samples of a chunk to the entries of a stts or
+ * ctts table, starting i_skip samples into the entry i_index.
+ * Returns false if the table is too short for the chunk */
+static bool xTTS_MapChunk( mp4_chunk_xtts_t *p_xtts, uint32_t i_sample_count,
+                           uint32_t *pi_index, uint32_t *pi_skip,
+                           const uint32_t *pi_table_count,
+                           const int32_t *pi_table_value,
+                           uint32_t i_table_count )
 {
-    uint32_t i_array_offset;
+    *p_xtts = (mp4_chunk_xtts_t) { 0 };
+    if( *pi_index < i_table_count )
+    {
+        p_xtts->p_count = &pi_table_count[*pi_index];
+        p_xtts->p_value = &pi_table_value[*pi_index];
+    }
+
     while( i_sample_count > 0 )
     {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
+        if( *pi_index >= i_table_count )
+            return false;
 
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EBADVAR;
-        }
+        uint32_t i_left = pi_table_count[*pi_index] - *pi_skip;
+        uint32_t i_used = __MIN( i_left, i_sample_count );
+
+        if( p_xtts->i_entries++ == 0 )
+            p_xtts->i_first_count = i_used;
+        p_xtts->i_last_count = i_used;
+        i_sample_count -= i_used;
 
-        if ( i_index_samples_left )
+        if( i_used == i_left )
         {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
+            (*pi_index)++;
+            *pi_skip = 0;
         }
         else
-        {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
-        }
+            *pi_skip += i_used;
     }
 
-    return VLC_SUCCESS;
+    return true;
 }
 
 static int TrackCreateSamplesIndex( demux_t *p_demux,
@@ -2550,18 +2555,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, read from the box */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
-        if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+        p_demux_track->p_sample_size = stsz->i_entry_size;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2575,13 +2571,9 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
 
     /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+     * The tables are not expanded: each chunk only points to the part of
+     * the box data covering its samples, so that the index costs the same
+     * whatever the duration of the file. */
 
     int64_t i_next_dts = 0;
     /* Find stts
@@ -2597,99 +2589,31 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     {
         MP4_Box_data_stts_t *stts = p_box->data.p_stts;
 
-        msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
+        msg_Dbg( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
+        bool b_truncated = false;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
 
             /* save first dts */
             ck->i_first_dts = i_next_dts;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
+            if( !xTTS_MapChunk( &ck->dts, ck->i_sample_count, &i_index, &i_skip,
+                                stts->pi_sample_count, stts->pi_sample_delta,
+                                stts->i_entry_count ) )
+                b_truncated = true;
 
-            /* allocate them */
-            ck->p_sample_count_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            ck->p_sample_delta_dts = calloc( ck->i_entries_dts, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_dts || !ck->p_sample_delta_dts )
-            {
-                free( ck->p_sample_count_dts );
-                free( ck->p_sample_delta_dts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-            }
+            i_next_dts = MP4_ChunkGetSampleDTS( ck, ck->i_sample_count );
+            ck->i_duration = i_next_dts - ck->i_first_dts;
         }
+
+        if( b_truncated )
+            msg_Err( p_demux, "invalid index counting total samples %u",
+                     stts->i_entry_count );
     }
 
 
@@ -2701,7 +2625,7 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     {
         MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
 
-        msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
+        msg_Dbg( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
         int64_t i_cts_shift = 0;
         const MP4_Box_t *p_cslg = MP4_BoxGet( p_demux_track->p_stbl, "cslg" );
@@ -2717,98 +2641,25 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
                     i_cts_shift = -ctts->pi_sample_offset[i];
             }
         }
-        else if( ctts->i_entry_count ) /* Compute for Quicktime */
-        {
-            for( uint32_t i = 0; i < ctts->i_entry_count; i++ )
-            {
-                if( ctts->pi_sample_offset[i] < 0 && ctts->pi_sample_offset[i] < -i_cts_shift )
-                    i_cts_shift = -ctts->pi_sample_offset[i];
-            }
-        }
+        p_demux_track->i_cts_shift = i_cts_shift;
 
-        /* Create pts-dts table per chunk */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
+        bool b_truncated = false;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            ck->p_sample_count_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
-            ck->p_sample_offset_pts = calloc( ck->i_entries_pts, sizeof( uint32_t ) );
-            if( !ck->p_sample_count_pts || !ck->p_sample_offset_pts )
-            {
-                free( ck->p_sample_count_pts );
-                free( ck->p_sample_offset_pts );
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return VLC_ENOMEM;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                if( i_ctsdelta < 0 ) /* should not */
-                    i_ctsdelta = 0;
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
 
-            }
+            if( !xTTS_MapChunk( &ck->pts, ck->i_sample_count, &i_index, &i_skip,
+                                ctts->pi_sample_count, ctts->pi_sample_offset,
+                                ctts->i_entry_count ) )
+                b_truncated = true;
         }
+
+        if( b_truncated )
+            msg_Err( p_demux, "invalid index counting total samples %u",
+                     ctts->i_entry_count );
     }
 
     msg_Dbg( p_demux, "track[Id 0x%x] read %"PRIu32" samples length:%"PRId64"s",
@@ -2819,6 +2670,20 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
 }
 
 
+/* Only counts the samples, for the sample rate of the preparsed tracks */
+static void TrackCountSamples( mp4_track_t *p_track )
+{
+    const MP4_Box_t *p_stts = MP4_BoxGet( p_track->p_stbl, "stts" );
+    uint64_t i_count = 0;
+
+    if( p_stts && BOXDATA(p_stts) )
+    {
+        for( uint32_t i = 0; i < BOXDATA(p_stts)->i_entry_count; i++ )
+            i_count += BOXDATA(p_stts)->pi_sample_count[i];
+    }
+    p_track->i_sample_count = __MIN( i_count, UINT32_MAX );
+}
+
 /**
  * It computes the sample rate for a video track using the given sample
  * description index
@@ -3171,29 +3036,26 @@ static int TrackTimeToSampleChunk( demux_t *p_demux, mp4_track_t *p_track,
     i_sample = p_track->chunk[i_chunk].i_sample_first;
     i_dts    = p_track->chunk[i_chunk].i_first_dts;
 
+    const mp4_chunk_xtts_t *p_dts = &p_track->chunk[i_chunk].dts;
     for( uint_fast32_t i_index = 0;
-         i_index < p_track->chunk[i_chunk].i_entries_dts &&
+         i_index < p_dts->i_entries &&
          i_sample < p_track->chunk[i_chunk].i_sample_count;
          i_index++ )
     {
-        if( i_dts +
-            p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-            p_track->chunk[i_chunk].p_sample_delta_dts[i_index] < (uint64_t)i_start )
+        uint32_t i_count = MP4_ChunkXTTSCount( p_dts, i_index );
+        if( i_dts + (uint64_t) i_count * p_dts->p_value[i_index] < (uint64_t)i_start )
         {
-            i_dts    +=
-                p_track->chunk[i_chunk].p_sample_count_dts[i_index] *
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            i_dts    += (uint64_t) i_count * p_dts->p_value[i_index];
 
-            i_sample += p_track->chunk[i_chunk].p_sample_count_dts[i_index];
+            i_sample += i_count;
         }
         else
         {
-            if( p_track->chunk[i_chunk].p_sample_delta_dts[i_index] <= 0 )
+            if( p_dts->p_value[i_index] <= 0 )
             {
                 break;
             }
-            i_sample += ( i_start - i_dts ) /
-                p_track->chunk[i_chunk].p_sample_delta_dts[i_index];
+            i_sample += ( i_start - i_dts ) / p_dts->p_value[i_index];
             break;
         }
     }
@@ -3344,7 +3206,7 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
 
     /* Probe the 16 first B frames */
     const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    if( p_chunk->i_entries_pts )
+    if( p_chunk->pts.i_entries )
     {
         for( uint32_t i=1; i<16; i++ )
         {
@@ -3355,7 +3217,7 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
             stime_t pts;
             stime_t dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
             stime_t delta = UNKNOWN_DELTA;
-            if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
+            if( MP4_ChunkGetSampleCTSDelta( p_track, ck, i_nextsample - ck->i_sample_first, &delta ) )
                 pts += delta;
             stime_t lowest = p_track->i_start_dts;
             if( p_track->i_start_delta != UNKNOWN_DELTA )
@@ -3375,7 +3237,7 @@ static void TrackUpdateSampleAndTimes( mp4_track_t *p_track )
     uint32_t i_chunk_sample = p_track->i_sample - p_chunk->i_sample_first;
     p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_chunk, i_chunk_sample );
     stime_t i_next_delta;
-    if( !MP4_ChunkGetSampleCTSDelta( p_chunk, i_chunk_sample, &i_next_delta ) )
+    if( !MP4_ChunkGetSampleCTSDelta( p_track, p_chunk, i_chunk_sample, &i_next_delta ) )
         p_track->i_next_delta = UNKNOWN_DELTA;
     else
         p_track->i_next_delta = i_next_delta;
@@ -3564,8 +3426,13 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
     }
 
     /* Create chunk index table and sample index table */
-    if( TrackCreateChunksIndex( p_demux,p_track  ) ||
-        TrackCreateSamplesIndex( p_demux, p_track ) )
+    if( p_demux->b_preparsing )
+    {
+        /* The sample tables were not loaded, no sample can be read */
+        TrackCountSamples( p_track );
+    }
+    else if( TrackCreateChunksIndex( p_demux,p_track  ) ||
+             TrackCreateSamplesIndex( p_demux, p_track ) )
     {
         msg_Err( p_demux, "cannot create chunks index" );
         return; /* cannot create chunks index */
@@ -3651,15 +3518,6 @@ static void MP4_TrackSetup( demux_t *p_demux, mp4_track_t *p_track,
     p_track->b_ok = true;
 }
 
-static void DestroyChunk( mp4_chunk_t *ck )
-{
-    free( ck->p_sample_count_dts );
-    free( ck->p_sample_delta_dts );
-    free( ck->p_sample_count_pts );
-    free( ck->p_sample_offset_pts );
-    free( ck->p_sample_size );
-}
-
 /****************************************************************************
  * MP4_TrackClean:
  ****************************************************************************
@@ -3672,16 +3530,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            DestroyChunk( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     ASFPacketTrackReset( &p_track->asfinfo );
 
     free( p_track->context.runs.p_array );
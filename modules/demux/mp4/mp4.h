@@ -30,6 +30,18 @@
 #include "fragments.h"
 #include "../asf/asfpacket.h"
 
+/* Entries of a stts or ctts table covering the samples of a chunk. It points
+ * to the box data instead of copying it: the first and last entries can be
+ * shared with the neighbour chunks, so their counts are kept apart. */
+typedef struct
+{
+    uint32_t        i_entries;
+    uint32_t        i_first_count; /* samples of the chunk in the first entry */
+    uint32_t        i_last_count;  /* samples of the chunk in the last entry */
+    const uint32_t *p_count;
+    const int32_t  *p_value;       /* dts delta or pts-dts */
+} mp4_chunk_xtts_t;
+
 /* Contain all information about a chunk */
 typedef struct
 {
@@ -46,17 +58,8 @@ typedef struct
     uint64_t     i_first_dts;   /* DTS of the first sample */
     uint64_t     i_duration;    /* total duration of all samples */
 
-    uint32_t     i_entries_dts;
-    uint32_t     *p_sample_count_dts;
-    uint32_t     *p_sample_delta_dts;   /* dts delta */
-
-    uint32_t     i_entries_pts;
-    uint32_t     *p_sample_count_pts;
-    uint32_t     *p_sample_offset_pts;  /* pts-dts */
-
-    uint32_t     *p_sample_size;
-    /* TODO if needed add pts
-        but quickly *add* support for edts and seeking */
+    mp4_chunk_xtts_t dts;
+    mp4_chunk_xtts_t pts;
 
 } mp4_chunk_t;
 
@@ -145,8 +148,9 @@ typedef struct
     /* sample size, p_sample_size defined only if i_sample_size == 0
         else i_sample_size is size for all sample */
     uint32_t         i_sample_size;
-    uint32_t         *p_sample_size; /* XXX perhaps add file offset if take
-//                                    too much time to do sumations each time*/
+    const uint32_t   *p_sample_size; /* points to the stsz box data */
+
+    int64_t          i_cts_shift; /* added to the ctts offsets */
 
     uint32_t     i_sample_first; /* i_sample_first value
                                                    of the next chunk */
@@ -35,6 +35,7 @@
 #include <vlc_codec.h>
 #include <vlc_codecs.h>
 #include <vlc_input.h>
+#include <vlc_vector.h>
 
 #include "../../packetizer/a52.h"
 #include "../../packetizer/dts_header.h"
@@ -87,6 +88,7 @@ static int Control( demux_t *, int, va_list );
 #define WAV_PROBE_SIZE (512*1024)
 #define BASE_PROBE_SIZE (8000)
 #define WAV_EXTRA_PROBE_SIZE (44000/2*2*2)
+#define INDEX_INTERVAL VLC_TICK_FROM_MS(500)
 
 typedef struct
 {
@@ -128,6 +130,12 @@ typedef struct
     seekpoint_t *p_seekpoint;
 } chap_entry_t;
 
+typedef struct
+{
+    vlc_tick_t i_time;
+    uint64_t i_pos;
+} index_entry_t;
+
 typedef struct
 {
     codec_t codec;
@@ -177,6 +185,15 @@ typedef struct
         size_t i_current;
         chap_entry_t *p_entry;
     } chapters;
+
+    /* Frame positions found while playing */
+    struct
+    {
+        bool b_sync;      /* the output frames follow i_pos */
+        uint64_t i_pos;   /* position of the next output frame */
+        vlc_tick_t i_next_pts;
+        struct VLC_VECTOR(index_entry_t) entries;
+    } index;
 } demux_sys_t;
 
 static int MpgaProbe( demux_t *p_demux, uint64_t *pi_offset );
@@ -197,6 +214,7 @@ static int ThdProbe( demux_t *p_demux, uint64_t *pi_offset );
 static int MlpInit( demux_t *p_demux );
 
 static bool Parse( demux_t *p_demux, block_t **pp_output );
+static void IndexAdd( demux_t *p_demux, const block_t *p_block );
 static uint64_t SeekByMlltTable( demux_t *p_demux, vlc_tick_t *pi_time );
 
 static const codec_t p_codecs[] = {
@@ -240,6 +258,8 @@ static int OpenCommon( demux_t *p_demux,
     p_sys->p_packetized_data = NULL;
     p_sys->chapters.i_current = 0;
     TAB_INIT(p_sys->chapters.i_count, p_sys->chapters.p_entry);
+    p_sys->index.b_sync = true;
+    vlc_vector_init( &p_sys->index.entries );
 
     if( vlc_stream_Seek( p_demux->s, p_sys->i_stream_offset ) )
     {
@@ -379,6 +399,7 @@ static int Demux( demux_t *p_demux )
         else
         {
             p_sys->i_pts = p_block_out->i_pts - VLC_TICK_0;
+            IndexAdd( p_demux, p_block_out );
         }
 
         if( p_block_out->i_pts != VLC_TICK_INVALID )
@@ -418,6 +439,7 @@ static void Close( vlc_object_t * p_this )
     for( size_t i=0; i< p_sys->chapters.i_count; i++ )
         vlc_seekpoint_Delete( p_sys->chapters.p_entry[i].p_seekpoint );
     TAB_CLEAN( p_sys->chapters.i_count, p_sys->chapters.p_entry );
+    vlc_vector_destroy( &p_sys->index.entries );
     if( p_sys->mllt.p_bits )
         free( p_sys->mllt.p_bits );
     demux_PacketizerDestroy( p_sys->p_packetizer );
@@ -440,6 +462,71 @@ static int MovetoTimePos( demux_t *p_demux, vlc_tick_t i_time, uint64_t i_pos )
     p_sys->p_packetized_data = NULL;
     p_sys->chapters.i_current = 0;
     p_sys->i_demux_flags |= INPUT_UPDATE_SEEKPOINT;
+    p_sys->index.b_sync = false;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Playback index:
+ *****************************************************************************
+ * While the frames are output contiguously from a known position, their
+ * positions are recorded every INDEX_INTERVAL, so that seeking back within
+ * the part already played lands on a frame start, without bitrate guesses.
+ *****************************************************************************/
+static void IndexAdd( demux_t *p_demux, const block_t *p_block )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->index.b_sync )
+        return;
+
+    if( p_block->i_pts != VLC_TICK_INVALID )
+    {
+        const vlc_tick_t i_time = p_sys->i_pts + p_sys->i_time_offset;
+        const size_t i_count = p_sys->index.entries.size;
+
+        if( i_count == 0 ||
+            i_time >= p_sys->index.entries.data[i_count - 1].i_time + INDEX_INTERVAL )
+        {
+            const index_entry_t entry = { i_time, p_sys->index.i_pos };
+            if( !vlc_vector_push( &p_sys->index.entries, entry ) )
+                p_sys->index.b_sync = false;
+        }
+        p_sys->index.i_next_pts = p_sys->i_pts + p_block->i_length;
+    }
+    p_sys->index.i_pos += p_block->i_buffer;
+}
+
+static int SeekByIndex( demux_t *p_demux, vlc_tick_t i_time )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const size_t i_count = p_sys->index.entries.size;
+
+    if( i_count == 0 ||
+        i_time >= p_sys->index.entries.data[i_count - 1].i_time + INDEX_INTERVAL )
+        return VLC_EGENERIC;
+
+    /* last entry not after the target */
+    size_t i_lo = 0, i_hi = i_count;
+    while( i_hi - i_lo > 1 )
+    {
+        size_t i_mid = i_lo + (i_hi - i_lo) / 2;
+        if( p_sys->index.entries.data[i_mid].i_time <= i_time )
+            i_lo = i_mid;
+        else
+            i_hi = i_mid;
+    }
+    const index_entry_t entry = p_sys->index.entries.data[i_lo];
+
+    if( MovetoTimePos( p_demux, entry.i_time, entry.i_pos ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    /* the packetizer dates the next frame from the last one */
+    p_sys->i_time_offset = entry.i_time - p_sys->index.i_next_pts;
+    p_sys->index.b_sync = true;
+    p_sys->index.i_pos = entry.i_pos;
+
+    es_out_Control( p_demux->out, ES_OUT_SET_NEXT_DISPLAY_TIME, VLC_TICK_0 + i_time );
     return VLC_SUCCESS;
 }
 
@@ -494,15 +581,25 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
         }
 
         case DEMUX_SET_TIME:
+        {
+            va_list ap;
+
+            va_copy( ap, args );
+            vlc_tick_t i_time = va_arg( ap, vlc_tick_t );
+            va_end( ap );
+
+            if( SeekByIndex( p_demux, i_time ) == VLC_SUCCESS )
+                return VLC_SUCCESS;
+
             if( p_sys->mllt.p_bits )
             {
-                vlc_tick_t i_time = va_arg(args, vlc_tick_t);
                 uint64_t i_pos = SeekByMlltTable( p_demux, &i_time );
                 return MovetoTimePos( p_demux, i_time, i_pos );
             }
             /* FIXME TODO: implement a high precision seek (with mp3 parsing)
              * needed for multi-input */
             break;
+        }
 
         case DEMUX_GET_TITLE_INFO:
         {
@@ -601,6 +698,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
         /* Reset chapter if any */
         p_sys->chapters.i_current = 0;
         p_sys->i_demux_flags |= INPUT_UPDATE_SEEKPOINT;
+        p_sys->index.b_sync = false;
     }
 
     return VLC_SUCCESS;
@@ -34,6 +34,7 @@
 #include <vlc_access.h>    /* DVB-specific things */
 #include <vlc_demux.h>
 #include <vlc_input.h>
+#include <vlc_atomic.h>
 
 #include "ts_pid.h"
 #include "ts_streams.h"
@@ -46,6 +47,7 @@
 #include "ts_hotfixes.h"
 #include "ts_sl.h"
 #include "ts_metadata.h"
+#include "ts_workers.h"
 #include "sections.h"
 #include "pes.h"
 #include "timestamps.h"
@@ -128,6 +130,11 @@ static const char *const ts_standards_list[] =
 static const char *const ts_standards_list_text[] =
   { N_("Auto"), "MPEG", "DVB", "ARIB", "ATSC", "T-DMB" };
 
+#define WORKERS_TEXT N_("Program threads")
+#define WORKERS_LONGTEXT N_("Gather and parse elementary streams data using " \
+    "one thread per program, up to that number of threads. Useful when " \
+    "demuxing many programs at once. 0 disables.")
+
 #define STANDARD_TEXT N_("Digital TV Standard")
 #define STANDARD_LONGTEXT N_( "Selects mode for digital TV standard. " \
                               "This feature affects EPG information and subtitles." )
@@ -163,6 +170,8 @@ vlc_module_begin ()
     add_bool( "ts-pcr-offsetfix", true, TS_OFFSETFIX_TEXT, NULL, true )
     add_integer_with_range( "ts-generated-pcr-offset", 120, 0, 500,
                             TS_GENERATED_PCR_OFFSET_TEXT, NULL, true )
+    add_integer_with_range( "ts-program-threads", 0, 0, 256,
+                            WORKERS_TEXT, WORKERS_LONGTEXT, true )
 
     add_obsolete_bool( "ts-silent" );
 
@@ -193,9 +202,15 @@ static stime_t GetPCR( const block_t * );
 static block_t * ProcessTSPacket( demux_t *p_demux, ts_pid_t *pid, block_t *p_pkt, int * );
 static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
 static bool GatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
+static void WorkerGatherPESData( demux_t *p_demux, ts_pid_t *, block_t *, size_t );
+static bool OffloadTSPacket( demux_t *p_demux, ts_pid_t *, block_t *, int );
+static void DrainTSPacketWorkers( demux_t *p_demux, ts_pid_t *, block_t * );
 static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_prg, stime_t i_pcr );
 
 static block_t* ReadTSPacket( demux_t *p_demux );
+static void ReadTSPacketFlush( demux_sys_t * );
+static uint64_t ReadTSPacketTell( demux_sys_t * );
+static int ReadTSPacketSeek( demux_sys_t *, uint64_t );
 static int SeekToTime( demux_t *p_demux, const ts_pmt_t *, stime_t time );
 static void ReadyQueuesPostSeek( demux_t *p_demux );
 static void PCRHandle( demux_t *p_demux, ts_pid_t *, stime_t );
@@ -401,6 +416,8 @@ static int Open( vlc_object_t *p_this )
     p_sys->i_packet_size = i_packet_size;
     p_sys->i_packet_header_size = i_packet_header_size;
     p_sys->i_ts_read = 50;
+    p_sys->p_chunk = NULL;
+    p_sys->p_workers = NULL;
     p_sys->csa = NULL;
     p_sys->b_start_record = false;
 
@@ -507,6 +524,10 @@ static int Open( vlc_object_t *p_this )
     p_sys->b_ignore_time_for_positions = var_InheritBool( p_demux, "ts-seek-percent" );
     p_sys->b_cc_check = var_InheritBool( p_demux, "ts-cc-check" );
 
+    unsigned i_workers = var_InheritInteger( p_demux, "ts-program-threads" );
+    if( i_workers > 0 && !p_demux->b_preparsing )
+        p_sys->p_workers = ts_workers_New( p_demux, i_workers, WorkerGatherPESData );
+
     p_sys->standard = TS_STANDARD_AUTO;
     char *psz_standard = var_InheritString( p_demux, "ts-standard" );
     if( psz_standard )
@@ -564,6 +585,9 @@ static void Close( vlc_object_t *p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    if( p_sys->p_workers )
+        ts_workers_Delete( p_sys->p_workers );
+
     PIDRelease( p_demux, GetPID(p_sys, 0) );
 
     vlc_mutex_lock( &p_sys->csa_lock );
@@ -588,6 +612,8 @@ static void Close( vlc_object_t *p_this )
         p_sys->stream = p_demux->s;
     }
 
+    ReadTSPacketFlush( p_sys );
+
     /* Release all non default pids */
     ts_pid_list_Release( p_demux, &p_sys->pids );
 
@@ -644,6 +670,8 @@ static int Demux( demux_t *p_demux )
         block_t     *p_pkt;
         if( !(p_pkt = ReadTSPacket( p_demux )) )
         {
+            if( p_sys->p_workers )
+                ts_workers_DrainAll( p_sys->p_workers );
             return VLC_DEMUXER_EOF;
         }
 
@@ -675,6 +703,8 @@ static int Demux( demux_t *p_demux )
         ts_pid_t *p_pid = GetPID( p_sys, PIDGet( p_pkt ) );
         if( !SEEN(p_pid) )
         {
+            if( p_sys->p_workers )
+                ts_workers_DrainAll( p_sys->p_workers );
             if( p_pid->type == TYPE_FREE )
                 msg_Dbg( p_demux, "pid[%d] unknown", p_pid->i_pid );
             p_pid->i_flags |= FLAG_SEEN;
@@ -687,6 +717,15 @@ static int Demux( demux_t *p_demux )
         if( !p_pkt )
             continue;
 
+        if( p_sys->p_workers )
+        {
+            if( OffloadTSPacket( p_demux, p_pid, p_pkt, i_header ) )
+                continue;
+            /* Anything else is processed here, once workers are done
+             * with whatever that packet may depend on or change */
+            DrainTSPacketWorkers( p_demux, p_pid, p_pkt );
+        }
+
         if( !SCRAMBLED(*p_pid) != !(p_pkt->i_flags & BLOCK_FLAG_SCRAMBLED) )
         {
             UpdatePIDScrambledState( p_demux, p_pid, p_pkt->i_flags & BLOCK_FLAG_SCRAMBLED );
@@ -909,6 +948,29 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
     }
 
+    if( p_sys->p_workers )
+    {
+        /* Only queries altering the demuxer state need workers to be idle */
+        switch( i_query )
+        {
+            case DEMUX_SET_POSITION:
+            case DEMUX_SET_TIME:
+            case DEMUX_SET_GROUP_DEFAULT:
+            case DEMUX_SET_GROUP_ALL:
+            case DEMUX_SET_GROUP_LIST:
+            case DEMUX_SET_ES:
+            case DEMUX_SET_ES_LIST:
+            case DEMUX_SET_TITLE:
+            case DEMUX_SET_SEEKPOINT:
+            case DEMUX_SET_RECORD_STATE:
+            case DEMUX_SET_PAUSE_STATE:
+                ts_workers_DrainAll( p_sys->p_workers );
+                break;
+            default:
+                break;
+        }
+    }
+
     switch( i_query )
     {
     case DEMUX_CAN_SEEK:
@@ -956,7 +1018,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         if( (i64 = stream_Size( p_sys->stream) ) > 0 )
         {
-            uint64_t offset = vlc_stream_Tell( p_sys->stream );
+            uint64_t offset = ReadTSPacketTell( p_sys );
             *pf = (double)offset / (double)i64;
             return VLC_SUCCESS;
         }
@@ -1003,7 +1065,7 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         i64 = stream_Size( p_sys->stream );
         if( i64 > 0 &&
-            vlc_stream_Seek( p_sys->stream, (int64_t)(i64 * f) ) == VLC_SUCCESS )
+            ReadTSPacketSeek( p_sys, (int64_t)(i64 * f) ) == VLC_SUCCESS )
         {
             ReadyQueuesPostSeek( p_demux );
             return VLC_SUCCESS;
@@ -1154,9 +1216,11 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
     }
 
     case DEMUX_SET_TITLE:
+        ReadTSPacketFlush( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_TITLE, args );
 
     case DEMUX_SET_SEEKPOINT:
+        ReadTSPacketFlush( p_sys );
         return vlc_stream_vaControl( p_sys->stream, STREAM_SET_SEEKPOINT,
                                      args );
 
@@ -1767,79 +1831,242 @@ static void PESDataChainHandle( vlc_object_t *p_obj, void *priv, block_t *p_data
     ParsePESDataChain( (demux_t *)p_obj, (ts_pid_t *) priv, p_data );
 }
 
-static block_t* ReadTSPacket( demux_t *p_demux )
+/*****************************************************************************
+ * Packet reader: packets are read from the stream by chunks, and handed out
+ * as blocks pointing into the refcounted chunk. Rejected packets then cost
+ * no allocation; retained payloads keep their chunk alive until released.
+ *****************************************************************************/
+#define TS_CHUNK_PACKETS (7 * 8)
+#define TS_CHUNK_PADDING 32
+
+typedef struct
 {
-    demux_sys_t *p_sys = p_demux->p_sys;
+    block_t self;
+    ts_packet_chunk_t *p_chunk;
+} ts_packet_slice_t;
 
-    block_t     *p_pkt;
+struct ts_packet_chunk_t
+{
+    vlc_atomic_rc_t rc;
+    size_t   i_size;   /* capacity */
+    size_t   i_data;   /* bytes read into the chunk */
+    size_t   i_offset; /* start of the next packet to serve */
+    unsigned i_slices;
+    ts_packet_slice_t *p_slices;
+    uint8_t *p_data;
+};
+
+static void PacketChunkRelease( ts_packet_chunk_t *p_chunk )
+{
+    if( vlc_atomic_rc_dec( &p_chunk->rc ) )
+        free( p_chunk );
+}
 
-    /* Get a new TS packet */
-    if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
-    {
-        int64_t size = stream_Size( p_sys->stream );
-        if( size >= 0 && (uint64_t)size == vlc_stream_Tell( p_sys->stream ) )
-            msg_Dbg( p_demux, "EOF at %"PRIu64, vlc_stream_Tell( p_sys->stream ) );
-        else
-            msg_Dbg( p_demux, "Can't read TS packet at %"PRIu64, vlc_stream_Tell(p_sys->stream) );
+static void PacketSliceRelease( block_t *p_block )
+{
+    ts_packet_slice_t *p_slice = container_of( p_block, ts_packet_slice_t, self );
+    PacketChunkRelease( p_slice->p_chunk );
+}
+
+static const struct vlc_block_callbacks packet_slice_cbs =
+{
+    PacketSliceRelease,
+};
+
+static ts_packet_chunk_t * PacketChunkNew( const demux_sys_t *p_sys )
+{
+    const unsigned i_slices = TS_CHUNK_PACKETS;
+    const size_t i_size = TS_CHUNK_PACKETS * p_sys->i_packet_size;
+    ts_packet_chunk_t *p_chunk = malloc( sizeof(*p_chunk) +
+                                         i_slices * sizeof(ts_packet_slice_t) +
+                                         i_size + TS_CHUNK_PADDING );
+    if( unlikely(p_chunk == NULL) )
+        return NULL;
+    vlc_atomic_rc_init( &p_chunk->rc );
+    p_chunk->i_size = i_size;
+    p_chunk->i_data = 0;
+    p_chunk->i_offset = 0;
+    p_chunk->i_slices = 0;
+    p_chunk->p_slices = (ts_packet_slice_t *) &p_chunk[1];
+    p_chunk->p_data = (uint8_t *) &p_chunk->p_slices[i_slices];
+    memset( &p_chunk->p_data[i_size], 0, TS_CHUNK_PADDING );
+    return p_chunk;
+}
+
+/* Replaces the current chunk with a new one, carrying over unserved data */
+static ts_packet_chunk_t * PacketChunkRenew( demux_sys_t *p_sys )
+{
+    ts_packet_chunk_t *p_old = p_sys->p_chunk;
+    ts_packet_chunk_t *p_chunk = PacketChunkNew( p_sys );
+    if( unlikely(p_chunk == NULL) )
         return NULL;
+
+    if( p_old )
+    {
+        p_chunk->i_data = p_old->i_data - p_old->i_offset;
+        memcpy( p_chunk->p_data, &p_old->p_data[p_old->i_offset], p_chunk->i_data );
+        PacketChunkRelease( p_old );
     }
+    p_sys->p_chunk = p_chunk;
+    return p_chunk;
+}
+
+/* Completes the last packet, which is usually on its way */
+static void PacketChunkComplete( demux_sys_t *p_sys, ts_packet_chunk_t *p_chunk )
+{
+    size_t i_toread = (p_chunk->i_data - p_chunk->i_offset) % p_sys->i_packet_size;
+    if( i_toread == 0 )
+        return;
+
+    i_toread = p_sys->i_packet_size - i_toread;
+    assert( p_chunk->i_data + i_toread <= p_chunk->i_size );
+    ssize_t i_read = vlc_stream_Read( p_sys->stream,
+                                      &p_chunk->p_data[p_chunk->i_data], i_toread );
+    if( i_read > 0 )
+        p_chunk->i_data += i_read;
+}
+
+/* Reads whatever is available up to the chunk capacity */
+static ssize_t PacketChunkFill( demux_sys_t *p_sys, ts_packet_chunk_t *p_chunk )
+{
+    ssize_t i_read = vlc_stream_ReadPartial( p_sys->stream,
+                                             &p_chunk->p_data[p_chunk->i_data],
+                                             p_chunk->i_size - p_chunk->i_data );
+    if( i_read > 0 )
+        p_chunk->i_data += i_read;
+    return i_read;
+}
+
+static block_t * PacketChunkSlice( ts_packet_chunk_t *p_chunk, size_t i_size )
+{
+    assert( p_chunk->i_slices < TS_CHUNK_PACKETS );
+    ts_packet_slice_t *p_slice = &p_chunk->p_slices[p_chunk->i_slices++];
+    block_Init( &p_slice->self, &packet_slice_cbs,
+                &p_chunk->p_data[p_chunk->i_offset], i_size );
+    p_slice->p_chunk = p_chunk;
+    vlc_atomic_rc_inc( &p_chunk->rc );
+    p_chunk->i_offset += i_size;
+    return &p_slice->self;
+}
 
-    if( p_pkt->i_buffer < TS_HEADER_SIZE + p_sys->i_packet_header_size )
+static void ReadTSPacketFlush( demux_sys_t *p_sys )
+{
+    if( p_sys->p_chunk )
     {
-        block_Release( p_pkt );
-        return NULL;
+        PacketChunkRelease( p_sys->p_chunk );
+        p_sys->p_chunk = NULL;
     }
+}
 
-    /* Skip header (BluRay streams).
-     * re-sync logic would do this (by adjusting packet start), but this would result in losing first and last ts packets.
-     * First packet is usually PAT, and losing it means losing whole first GOP. This is fatal with still-image based menus.
-     */
-    p_pkt->p_buffer += p_sys->i_packet_header_size;
-    p_pkt->i_buffer -= p_sys->i_packet_header_size;
+/* Stream position of the next packet to be demuxed */
+static uint64_t ReadTSPacketTell( demux_sys_t *p_sys )
+{
+    uint64_t i_pos = vlc_stream_Tell( p_sys->stream );
+    if( p_sys->p_chunk )
+        i_pos -= p_sys->p_chunk->i_data - p_sys->p_chunk->i_offset;
+    return i_pos;
+}
 
-    /* Check sync byte and re-sync if needed */
-    if( p_pkt->p_buffer[0] != 0x47 )
+static int ReadTSPacketSeek( demux_sys_t *p_sys, uint64_t i_pos )
+{
+    ReadTSPacketFlush( p_sys );
+    return vlc_stream_Seek( p_sys->stream, i_pos );
+}
+
+static bool ReadTSPacketResync( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const size_t i_sync = p_sys->i_packet_header_size;
+    const size_t i_packet = p_sys->i_packet_size;
+
+    /* Data is moved around: continue in a chunk no packet refers to */
+    ts_packet_chunk_t *p_chunk = PacketChunkRenew( p_sys );
+    if( unlikely(p_chunk == NULL) )
+        return false;
+
+    for( bool b_found = false; !b_found; )
     {
-        msg_Warn( p_demux, "lost synchro" );
-        block_Release( p_pkt );
-        for( ;; )
+        if( p_chunk->i_data < i_sync + i_packet + 1 )
         {
-            const uint8_t *p_peek;
-            int i_peek = 0;
-            unsigned i_skip = 0;
-
-            i_peek = vlc_stream_Peek( p_sys->stream, &p_peek,
-                    p_sys->i_packet_size * 10 );
-            if( i_peek < 0 || (unsigned)i_peek < p_sys->i_packet_size + 1 )
+            if( PacketChunkFill( p_sys, p_chunk ) <= 0 )
             {
                 msg_Dbg( p_demux, "eof ?" );
-                return NULL;
-            }
-
-            while( i_skip < i_peek - p_sys->i_packet_size )
-            {
-                if( p_peek[i_skip + p_sys->i_packet_header_size] == 0x47 &&
-                        p_peek[i_skip + p_sys->i_packet_header_size + p_sys->i_packet_size] == 0x47 )
-                {
-                    break;
-                }
-                i_skip++;
+                return false;
             }
-            msg_Dbg( p_demux, "skipping %d bytes of garbage", i_skip );
-            if (vlc_stream_Read( p_sys->stream, NULL, i_skip ) != i_skip)
-                return NULL;
+            continue;
+        }
 
-            if( i_skip < i_peek - p_sys->i_packet_size )
+        size_t i_skip = 0;
+        while( i_skip + i_sync + i_packet < p_chunk->i_data )
+        {
+            if( p_chunk->p_data[i_skip + i_sync] == 0x47 &&
+                p_chunk->p_data[i_skip + i_sync + i_packet] == 0x47 )
             {
+                b_found = true;
                 break;
             }
+            i_skip++;
         }
-        if( !( p_pkt = vlc_stream_Block( p_sys->stream, p_sys->i_packet_size ) ) )
+
+        msg_Dbg( p_demux, "skipping %zu bytes of garbage", i_skip );
+        p_chunk->i_data -= i_skip;
+        memmove( p_chunk->p_data, &p_chunk->p_data[i_skip], p_chunk->i_data );
+    }
+
+    PacketChunkComplete( p_sys, p_chunk );
+    return true;
+}
+
+static block_t* ReadTSPacket( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    ts_packet_chunk_t *p_chunk = p_sys->p_chunk;
+
+    /* Get new TS packets */
+    if( p_chunk == NULL || p_chunk->i_data - p_chunk->i_offset < p_sys->i_packet_size )
+    {
+        p_chunk = PacketChunkRenew( p_sys );
+        if( unlikely(p_chunk == NULL) )
+            return NULL;
+        if( PacketChunkFill( p_sys, p_chunk ) > 0 )
+            PacketChunkComplete( p_sys, p_chunk );
+    }
+
+    size_t i_avail = p_chunk->i_data - p_chunk->i_offset;
+    if( i_avail < TS_HEADER_SIZE + p_sys->i_packet_header_size )
+    {
+        int64_t size = stream_Size( p_sys->stream );
+        if( size >= 0 && (uint64_t)size == vlc_stream_Tell( p_sys->stream ) )
+            msg_Dbg( p_demux, "EOF at %"PRIu64, vlc_stream_Tell( p_sys->stream ) );
+        else
+            msg_Dbg( p_demux, "Can't read TS packet at %"PRIu64, vlc_stream_Tell(p_sys->stream) );
+        ReadTSPacketFlush( p_sys );
+        return NULL;
+    }
+
+    /* Check sync byte and re-sync if needed */
+    if( p_chunk->p_data[p_chunk->i_offset + p_sys->i_packet_header_size] != 0x47 )
+    {
+        msg_Warn( p_demux, "lost synchro" );
+        if( !ReadTSPacketResync( p_demux ) )
         {
-            msg_Dbg( p_demux, "eof ?" );
+            ReadTSPacketFlush( p_sys );
             return NULL;
         }
+        p_chunk = p_sys->p_chunk;
+        i_avail = p_chunk->i_data - p_chunk->i_offset;
     }
+
+    /* A short last packet is still returned, to be rejected by the caller */
+    block_t *p_pkt = PacketChunkSlice( p_chunk, __MIN(i_avail, p_sys->i_packet_size) );
+
+    /* Skip header (BluRay streams).
+     * re-sync logic would do this (by adjusting packet start), but this would result in losing first and last ts packets.
+     * First packet is usually PAT, and losing it means losing whole first GOP. This is fatal with still-image based menus.
+     */
+    p_pkt->p_buffer += p_sys->i_packet_header_size;
+    p_pkt->i_buffer -= p_sys->i_packet_header_size;
+
     return p_pkt;
 }
 
@@ -1951,13 +2178,13 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
 
     /* Deal with common but worst binary search case */
     if( p_pmt->pcr.i_first == i_scaledtime && p_sys->b_canseek )
-        return vlc_stream_Seek( p_sys->stream, 0 );
+        return ReadTSPacketSeek( p_sys, 0 );
 
     const int64_t i_stream_size = stream_Size( p_sys->stream );
     if( !p_sys->b_canfastseek || i_stream_size < p_sys->i_packet_size )
         return VLC_EGENERIC;
 
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = ReadTSPacketTell( p_sys );
 
     /* Find the time position by using binary search algorithm. */
     uint64_t i_head_pos = 0;
@@ -1973,7 +2200,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
         uint64_t i_div = i_splitpos % p_sys->i_packet_size;
         i_splitpos -= i_div;
 
-        if ( vlc_stream_Seek( p_sys->stream, i_splitpos ) != VLC_SUCCESS )
+        if ( ReadTSPacketSeek( p_sys, i_splitpos ) != VLC_SUCCESS )
             break;
 
         uint64_t i_pos = i_splitpos;
@@ -1987,7 +2214,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
                 break;
             }
             else
-                i_pos = vlc_stream_Tell( p_sys->stream );
+                i_pos = ReadTSPacketTell( p_sys );
 
             int i_pid = PIDGet( p_pkt );
             ts_pid_t *p_pid = GetPID(p_sys, i_pid);
@@ -2044,7 +2271,7 @@ static int SeekToTime( demux_t *p_demux, const ts_pmt_t *p_pmt, stime_t i_scaled
     if( !b_found )
     {
         msg_Dbg( p_demux, "Seek():cannot find a time position." );
-        if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) != VLC_SUCCESS )
+        if( ReadTSPacketSeek( p_sys, i_initial_pos ) != VLC_SUCCESS )
             msg_Err( p_demux, "Can't seek back to %" PRIu64, i_initial_pos );
         return VLC_EGENERIC;
     }
@@ -2130,7 +2357,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, bool *pb_fou
                         if( b_end )
                         {
                             p_pmt->i_last_dts = i_pcr;
-                            p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                            p_pmt->i_last_dts_byte = ReadTSPacketTell( p_sys );
                         }
                         /* Start, only keep first */
                         else if( b_pcrresult && p_pmt->pcr.i_first == -1 )
@@ -2158,7 +2385,7 @@ static int ProbeChunk( demux_t *p_demux, int i_program, bool b_end, bool *pb_fou
 int ProbeStart( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = ReadTSPacketTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = 0;
@@ -2170,7 +2397,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
         i_pos = p_sys->i_packet_size * i_probe_count;
         i_pos = __MIN( i_pos, i_stream_size );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( ReadTSPacketSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         int i_count =  ProbeChunk( p_demux, i_program, false, &b_found );
@@ -2182,7 +2409,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
     } while( i_pos < i_stream_size && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( ReadTSPacketSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2191,7 +2418,7 @@ int ProbeStart( demux_t *p_demux, int i_program )
 int ProbeEnd( demux_t *p_demux, int i_program )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
-    const uint64_t i_initial_pos = vlc_stream_Tell( p_sys->stream );
+    const uint64_t i_initial_pos = ReadTSPacketTell( p_sys );
     int64_t i_stream_size = stream_Size( p_sys->stream );
 
     int i_probe_count = PROBE_CHUNK_COUNT;
@@ -2203,7 +2430,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
         i_pos = i_stream_size - (p_sys->i_packet_size * i_probe_count);
         i_pos = __MAX( i_pos, 0 );
 
-        if( vlc_stream_Seek( p_sys->stream, i_pos ) )
+        if( ReadTSPacketSeek( p_sys, i_pos ) )
             return VLC_EGENERIC;
 
         int i_count = ProbeChunk( p_demux, i_program, true, &b_found );
@@ -2215,7 +2442,7 @@ int ProbeEnd( demux_t *p_demux, int i_program )
     } while( i_pos > 0 && !b_found &&
              i_probe_count < PROBE_MAX );
 
-    if( vlc_stream_Seek( p_sys->stream, i_initial_pos ) )
+    if( ReadTSPacketSeek( p_sys, i_initial_pos ) )
         return VLC_EGENERIC;
 
     return (b_found) ? VLC_SUCCESS : VLC_EGENERIC;
@@ -2270,14 +2497,14 @@ static void ProgramSetPCR( demux_t *p_demux, ts_pmt_t *p_pmt, stime_t i_pcr )
         es_out_Control( p_demux->out, ES_OUT_SET_GROUP_PCR, p_pmt->i_number, FROM_SCALE(i_pcr) );
         /* growing files/named fifo handling */
         if( p_sys->b_access_control == false &&
-            vlc_stream_Tell( p_sys->stream ) > p_pmt->i_last_dts_byte )
+            ReadTSPacketTell( p_sys ) > p_pmt->i_last_dts_byte )
         {
             if( p_pmt->i_last_dts_byte == 0 ) /* first run */
                 p_pmt->i_last_dts_byte = stream_Size( p_sys->stream );
             else
             {
                 p_pmt->i_last_dts = i_pcr;
-                p_pmt->i_last_dts_byte = vlc_stream_Tell( p_sys->stream );
+                p_pmt->i_last_dts_byte = ReadTSPacketTell( p_sys );
             }
         }
     }
@@ -2666,6 +2893,91 @@ static bool GatherSectionsData( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pk
     return b_ret;
 }
 
+static void WorkerGatherPESData( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt, size_t i_skip )
+{
+    GatherPESData( p_demux, p_pid, p_pkt, i_skip );
+}
+
+/* Steady programs have their clock set up: parsing their PES only touches
+ * their own state, and never reaches out to other programs. */
+static bool ProgramIsSteady( const ts_pmt_t *p_pmt )
+{
+    return p_pmt->pcr.b_fix_done && !p_pmt->pcr.b_disable &&
+           p_pmt->pcr.i_current > -1;
+}
+
+static const ts_pmt_t * OffloadProgram( demux_sys_t *p_sys, const ts_pid_t *p_pid )
+{
+    if( p_pid->type != TYPE_STREAM ||
+        p_pid->u.p_stream->transport != TS_TRANSPORT_PES ||
+        p_sys->es_creation != CREATE_ES ||
+        !SEEN( GetPID( p_sys, 0 ) ) )
+        return NULL;
+
+    const ts_es_t *p_es = p_pid->u.p_stream->p_es;
+    if( p_es->id == NULL || p_es->p_program == NULL ||
+        !ProgramIsSteady( p_es->p_program ) )
+        return NULL;
+
+    return p_es->p_program;
+}
+
+static bool OffloadTSPacket( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt, int i_header )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    const ts_pmt_t *p_pmt = OffloadProgram( p_sys, p_pid );
+    if( p_pmt == NULL ||
+        !SCRAMBLED(*p_pid) != !(p_pkt->i_flags & BLOCK_FLAG_SCRAMBLED) ||
+        GetPCR( p_pkt ) >= 0 )
+        return false;
+
+    /* Emulate HW filter */
+    if( !p_sys->b_access_control && !(p_pid->i_flags & FLAG_FILTERED) )
+    {
+        block_Release( p_pkt );
+        return true;
+    }
+
+    p_sys->b_end_preparse = true;
+    return ts_workers_Push( p_sys->p_workers, p_pmt->i_number,
+                            p_pid, p_pkt, i_header );
+}
+
+static void DrainTSPacketWorkers( demux_t *p_demux, ts_pid_t *p_pid, block_t *p_pkt )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const ts_pmt_t *p_pmt = OffloadProgram( p_sys, p_pid );
+
+    /* A PCR only affects the programs using it, as long as they
+     * are all steady. Anything else may affect any program. */
+    if( p_pmt == NULL ||
+        !SCRAMBLED(*p_pid) != !(p_pkt->i_flags & BLOCK_FLAG_SCRAMBLED) ||
+        GetPCR( p_pkt ) < 0 )
+    {
+        ts_workers_DrainAll( p_sys->p_workers );
+        return;
+    }
+
+    ts_workers_Drain( p_sys->p_workers, p_pmt->i_number );
+
+    const ts_pat_t *p_pat = GetPID(p_sys, 0)->u.p_pat;
+    for( int i = 0; i < p_pat->programs.i_size; i++ )
+    {
+        p_pmt = p_pat->programs.p_elems[i]->u.p_pmt;
+        if( p_pmt->i_pid_pcr == p_pid->i_pid ||
+           ( p_pmt->i_pid_pcr == 0x1FFF && PIDReferencedByProgram( p_pmt, p_pid->i_pid ) ) )
+        {
+            if( !ProgramIsSteady( p_pmt ) )
+            {
+                ts_workers_DrainAll( p_sys->p_workers );
+                return;
+            }
+            ts_workers_Drain( p_sys->p_workers, p_pmt->i_number );
+        }
+    }
+}
+
 void TsChangeStandard( demux_sys_t *p_sys, ts_standards_e v )
 {
     if( p_sys->standard != TS_STANDARD_AUTO &&
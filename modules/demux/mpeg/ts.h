@@ -51,6 +51,9 @@ typedef struct
     int i_service;
 } vdr_info_t;
 
+typedef struct ts_packet_chunk_t ts_packet_chunk_t;
+typedef struct ts_workers_t ts_workers_t;
+
 struct demux_sys_t
 {
     stream_t   *stream;
@@ -71,6 +74,12 @@ struct demux_sys_t
     /* how many TS packet we read at once */
     unsigned    i_ts_read;
 
+    /* Packets read ahead from the stream, served as slices */
+    ts_packet_chunk_t *p_chunk;
+
+    /* Per program PES gathering threads, if enabled */
+    ts_workers_t *p_workers;
+
     bool        b_cc_check;
     bool        b_ignore_time_for_positions;
 
@@ -42,8 +42,8 @@ void ts_pid_list_Init( ts_pid_list_t *p_list )
     p_list->pp_all = NULL;
     p_list->i_all = 0;
     p_list->i_all_alloc = 0;
-    p_list->i_last_pid = 0;
-    p_list->p_last = NULL;
+    for( int i = 0; i < PID_INDEX_PAGES; i++ )
+        p_list->pp_index[i] = NULL;
 }
 
 void ts_pid_list_Release( demux_t *p_demux, ts_pid_list_t *p_list )
@@ -60,6 +60,8 @@ void ts_pid_list_Release( demux_t *p_demux, ts_pid_list_t *p_list )
         free( pid );
     }
     free( p_list->pp_all );
+    for( int i = 0; i < PID_INDEX_PAGES; i++ )
+        free( p_list->pp_index[i] );
 }
 
 struct searchkey
@@ -89,13 +91,17 @@ ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
         case 0x1FFF:
             return &p_list->dummy;
         default:
-            if( p_list->i_last_pid == i_pid )
-                return p_list->p_last;
         break;
     }
 
+    i_pid &= 0x1FFF;
+    ts_pid_t **pp_page = p_list->pp_index[i_pid >> PID_INDEX_PAGE_BITS];
+    if( likely(pp_page) && pp_page[i_pid & (PID_INDEX_PAGE_SIZE - 1)] )
+        return pp_page[i_pid & (PID_INDEX_PAGE_SIZE - 1)];
+
+    /* Not indexed: not allocated yet */
     size_t i_index = 0;
-    ts_pid_t *p_pid = NULL;
+    ts_pid_t *p_pid;
 
     if( p_list->pp_all )
     {
@@ -103,57 +109,62 @@ ts_pid_t * ts_pid_Get( ts_pid_list_t *p_list, uint16_t i_pid )
         pidkey.i_pid = i_pid;
         pidkey.pp_last = NULL;
 
+        /* lookup insertion point */
         ts_pid_t **pp_pidk = bsearch( &pidkey, p_list->pp_all, p_list->i_all,
                                       sizeof(ts_pid_t *), ts_bsearch_searchkey_Compare );
-        if ( pp_pidk )
-            p_pid = *pp_pidk;
-        else
-            i_index = (pidkey.pp_last - p_list->pp_all); /* Last visited index */
+        assert( pp_pidk == NULL ); VLC_UNUSED(pp_pidk);
+        i_index = (pidkey.pp_last - p_list->pp_all); /* Last visited index */
     }
 
-    if( p_pid == NULL )
+    if( pp_page == NULL )
     {
-        if( p_list->i_all >= p_list->i_all_alloc )
+        pp_page = calloc( PID_INDEX_PAGE_SIZE, sizeof(*pp_page) );
+        if( !pp_page )
         {
-            ts_pid_t **p_realloc = realloc( p_list->pp_all,
-                                            (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
-            if( !p_realloc )
-            {
-                abort();
-                //return NULL;
-            }
-            p_list->pp_all = p_realloc;
-            p_list->i_all_alloc += PID_ALLOC_CHUNK;
+            abort();
+            //return NULL;
         }
+        p_list->pp_index[i_pid >> PID_INDEX_PAGE_BITS] = pp_page;
+    }
 
-        p_pid = calloc( 1, sizeof(*p_pid) );
-        if( !p_pid )
+    if( p_list->i_all >= p_list->i_all_alloc )
+    {
+        ts_pid_t **p_realloc = realloc( p_list->pp_all,
+                                        (p_list->i_all_alloc + PID_ALLOC_CHUNK) * sizeof(ts_pid_t *) );
+        if( !p_realloc )
         {
             abort();
             //return NULL;
         }
+        p_list->pp_all = p_realloc;
+        p_list->i_all_alloc += PID_ALLOC_CHUNK;
+    }
 
-        p_pid->i_cc  = 0xff;
-        p_pid->i_pid = i_pid;
-
-        /* Do insertion based on last bsearch mid point */
-        if( p_list->i_all )
-        {
-            if( p_list->pp_all[i_index]->i_pid < i_pid )
-                i_index++;
+    p_pid = calloc( 1, sizeof(*p_pid) );
+    if( !p_pid )
+    {
+        abort();
+        //return NULL;
+    }
 
-            memmove( &p_list->pp_all[i_index + 1],
-                    &p_list->pp_all[i_index],
-                    (p_list->i_all - i_index) * sizeof(ts_pid_t *) );
-        }
+    p_pid->i_cc  = 0xff;
+    p_pid->i_pid = i_pid;
 
-        p_list->pp_all[i_index] = p_pid;
-        p_list->i_all++;
+    /* Do insertion based on last bsearch mid point */
+    if( p_list->i_all )
+    {
+        if( p_list->pp_all[i_index]->i_pid < i_pid )
+            i_index++;
 
+        memmove( &p_list->pp_all[i_index + 1],
+                &p_list->pp_all[i_index],
+                (p_list->i_all - i_index) * sizeof(ts_pid_t *) );
     }
 
-    p_list->p_last = p_pid;
-    p_list->i_last_pid = i_pid;
+    p_list->pp_all[i_index] = p_pid;
+    p_list->i_all++;
+
+    pp_page[i_pid & (PID_INDEX_PAGE_SIZE - 1)] = p_pid;
 
     return p_pid;
 }
@@ -85,19 +85,22 @@ struct ts_pid_t
 
 };
 
+/* Two level PID index, pages allocated on demand */
+#define PID_INDEX_PAGE_BITS 7
+#define PID_INDEX_PAGE_SIZE (1 << PID_INDEX_PAGE_BITS)
+#define PID_INDEX_PAGES     (8192 >> PID_INDEX_PAGE_BITS)
+
 struct ts_pid_list_t
 {
     ts_pid_t   pat;
     ts_pid_t   dummy;
     ts_pid_t   base_si;
-    /* all non commons ones, dynamically allocated */
+    /* all non commons ones, dynamically allocated, sorted by pid */
     ts_pid_t **pp_all;
     int        i_all;
     int        i_all_alloc;
-    /* last recently used */
-    uint16_t   i_last_pid;
-    ts_pid_t  *p_last;
-
+    /* direct lookup into pp_all entries */
+    ts_pid_t **pp_index[PID_INDEX_PAGES];
 };
 
 /* opacified pid list */
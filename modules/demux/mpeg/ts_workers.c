@@ -0,0 +1,235 @@
+/*****************************************************************************
+ * ts_workers.c: Transport Stream per program worker threads
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+
+#include "ts_pid.h"
+#include "ts_workers.h"
+
+#include <assert.h>
+
+/* Fixed size ring, so that queuing a packet never allocates */
+#define TS_WORKER_JOBS 512
+
+typedef struct
+{
+    ts_pid_t *p_pid;
+    block_t  *p_pkt;
+    size_t    i_skip;
+} ts_worker_job_t;
+
+typedef struct
+{
+    ts_workers_t   *p_owner;
+    vlc_thread_t    thread;
+    vlc_mutex_t     lock;
+    vlc_cond_t      wait;   /* signaled on new job or exit request */
+    vlc_cond_t      done;   /* signaled on free slot or idle */
+    bool            b_exit;
+    unsigned        i_head;
+    unsigned        i_count;
+    ts_worker_job_t jobs[TS_WORKER_JOBS];
+} ts_worker_t;
+
+typedef struct
+{
+    uint16_t     i_program;
+    ts_worker_t *p_worker;
+} ts_workers_program_t;
+
+struct ts_workers_t
+{
+    demux_t            *p_demux;
+    ts_workers_callback pf_callback;
+    unsigned            i_max;
+    DECL_ARRAY(ts_worker_t *) workers;
+    /* program number to worker assignment, sorted by program number */
+    DECL_ARRAY(ts_workers_program_t) programs;
+};
+
+static void *WorkerThread( void *data )
+{
+    ts_worker_t *p_worker = data;
+    ts_workers_t *p_owner = p_worker->p_owner;
+
+    vlc_mutex_lock( &p_worker->lock );
+    for( ;; )
+    {
+        while( p_worker->i_count == 0 && !p_worker->b_exit )
+            vlc_cond_wait( &p_worker->wait, &p_worker->lock );
+        if( p_worker->i_count == 0 )
+            break;
+
+        ts_worker_job_t job = p_worker->jobs[p_worker->i_head];
+        vlc_mutex_unlock( &p_worker->lock );
+
+        p_owner->pf_callback( p_owner->p_demux, job.p_pid, job.p_pkt, job.i_skip );
+
+        vlc_mutex_lock( &p_worker->lock );
+        p_worker->i_head = (p_worker->i_head + 1) % TS_WORKER_JOBS;
+        p_worker->i_count--;
+            vlc_cond_broadcast( &p_worker->done );
+    }
+    vlc_mutex_unlock( &p_worker->lock );
+
+    return NULL;
+}
+
+static void WorkerDrain( ts_worker_t *p_worker )
+{
+    vlc_mutex_lock( &p_worker->lock );
+    while( p_worker->i_count > 0 )
+        vlc_cond_wait( &p_worker->done, &p_worker->lock );
+    vlc_mutex_unlock( &p_worker->lock );
+}
+
+static ts_worker_t * WorkerNew( ts_workers_t *p_owner )
+{
+    ts_worker_t *p_worker = malloc( sizeof(*p_worker) );
+    if( unlikely(p_worker == NULL) )
+        return NULL;
+
+    p_worker->p_owner = p_owner;
+    vlc_mutex_init( &p_worker->lock );
+    vlc_cond_init( &p_worker->wait );
+    vlc_cond_init( &p_worker->done );
+    p_worker->b_exit = false;
+    p_worker->i_head = 0;
+    p_worker->i_count = 0;
+
+    if( vlc_clone( &p_worker->thread, WorkerThread, p_worker,
+                   VLC_THREAD_PRIORITY_INPUT ) )
+    {
+        free( p_worker );
+        return NULL;
+    }
+    return p_worker;
+}
+
+static void WorkerDelete( ts_worker_t *p_worker )
+{
+    vlc_mutex_lock( &p_worker->lock );
+    p_worker->b_exit = true;
+    vlc_cond_signal( &p_worker->wait );
+    vlc_mutex_unlock( &p_worker->lock );
+
+    vlc_join( p_worker->thread, NULL );
+    free( p_worker );
+}
+
+ts_workers_t * ts_workers_New( demux_t *p_demux, unsigned i_max,
+                               ts_workers_callback pf_callback )
+{
+    assert( i_max > 0 );
+    ts_workers_t *p_workers = malloc( sizeof(*p_workers) );
+    if( unlikely(p_workers == NULL) )
+        return NULL;
+
+    p_workers->p_demux = p_demux;
+    p_workers->pf_callback = pf_callback;
+    p_workers->i_max = i_max;
+    ARRAY_INIT( p_workers->workers );
+    ARRAY_INIT( p_workers->programs );
+    return p_workers;
+}
+
+void ts_workers_Delete( ts_workers_t *p_workers )
+{
+    /* Pending jobs are processed before the threads exit */
+    for( int i = 0; i < p_workers->workers.i_size; i++ )
+        WorkerDelete( p_workers->workers.p_elems[i] );
+    ARRAY_RESET( p_workers->workers );
+    ARRAY_RESET( p_workers->programs );
+    free( p_workers );
+}
+
+static ts_worker_t * GetWorker( ts_workers_t *p_workers, uint16_t i_program,
+                                bool b_create )
+{
+    const ts_workers_program_t *p_elems = p_workers->programs.p_elems;
+    int i_low = 0, i_high = p_workers->programs.i_size;
+    while( i_low < i_high )
+    {
+        int i_mid = (i_low + i_high) / 2;
+        if( p_elems[i_mid].i_program == i_program )
+            return p_elems[i_mid].p_worker;
+        if( p_elems[i_mid].i_program < i_program )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    if( !b_create )
+        return NULL;
+
+    /* One thread per program, then programs beyond the limit share them.
+     * The assignment never changes, so that ordering is kept. */
+    ts_workers_program_t entry = { .i_program = i_program };
+    if( (unsigned) p_workers->workers.i_size < p_workers->i_max &&
+        (entry.p_worker = WorkerNew( p_workers )) != NULL )
+        ARRAY_APPEND( p_workers->workers, entry.p_worker );
+    else if( p_workers->workers.i_size > 0 )
+        entry.p_worker = p_workers->workers.p_elems[p_workers->programs.i_size %
+                                                    p_workers->workers.i_size];
+    else
+        return NULL;
+
+    ARRAY_INSERT( p_workers->programs, entry, i_low );
+    return entry.p_worker;
+}
+
+bool ts_workers_Push( ts_workers_t *p_workers, uint16_t i_program,
+                      ts_pid_t *p_pid, block_t *p_pkt, size_t i_skip )
+{
+    ts_worker_t *p_worker = GetWorker( p_workers, i_program, true );
+    if( p_worker == NULL )
+        return false;
+
+    vlc_mutex_lock( &p_worker->lock );
+    while( p_worker->i_count == TS_WORKER_JOBS )
+        vlc_cond_wait( &p_worker->done, &p_worker->lock );
+
+    ts_worker_job_t *p_job =
+        &p_worker->jobs[(p_worker->i_head + p_worker->i_count) % TS_WORKER_JOBS];
+    p_job->p_pid = p_pid;
+    p_job->p_pkt = p_pkt;
+    p_job->i_skip = i_skip;
+    p_worker->i_count++;
+    vlc_cond_signal( &p_worker->wait );
+    vlc_mutex_unlock( &p_worker->lock );
+
+    return true;
+}
+
+void ts_workers_Drain( ts_workers_t *p_workers, uint16_t i_program )
+{
+    ts_worker_t *p_worker = GetWorker( p_workers, i_program, false );
+    if( p_worker )
+        WorkerDrain( p_worker );
+}
+
+void ts_workers_DrainAll( ts_workers_t *p_workers )
+{
+    for( int i = 0; i < p_workers->workers.i_size; i++ )
+        WorkerDrain( p_workers->workers.p_elems[i] );
+}
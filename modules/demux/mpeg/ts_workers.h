@@ -0,0 +1,42 @@
+/*****************************************************************************
+ * ts_workers.h: Transport Stream per program worker threads
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_TS_WORKERS_H
+#define VLC_TS_WORKERS_H
+
+typedef struct ts_workers_t ts_workers_t;
+
+/* Processes one packet payload, from a worker thread */
+typedef void (*ts_workers_callback)( demux_t *, ts_pid_t *, block_t *, size_t );
+
+ts_workers_t * ts_workers_New( demux_t *, unsigned i_max, ts_workers_callback );
+void ts_workers_Delete( ts_workers_t * );
+
+/* Queues a packet to the worker serving a program.
+ * Packets pushed for a same program are processed in order.
+ * Returns false if none can be started, the packet is then not consumed */
+bool ts_workers_Push( ts_workers_t *, uint16_t i_program,
+                      ts_pid_t *, block_t *, size_t i_skip );
+
+/* Waits until all packets queued for a program have been processed */
+void ts_workers_Drain( ts_workers_t *, uint16_t i_program );
+/* Waits until all queued packets have been processed */
+void ts_workers_DrainAll( ts_workers_t * );
+
+#endif
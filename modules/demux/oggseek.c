@@ -114,6 +114,8 @@ const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
     while ( idx != NULL )
     {
         if ( idx->i_pagepos > i_pagepos ) break;
+        if ( idx->i_pagepos == i_pagepos && idx->i_value == i_timestamp )
+            return idx; /* already known */
         last_idx = idx;
         idx = idx->p_next;
     }
@@ -225,6 +227,49 @@ static int64_t get_data( demux_t *p_demux, int64_t i_bytes_to_read )
 }
 
 
+/* find the next page start from the current input position, before i_pos2.
+   The garbage is skipped within the data already read, instead of reading it
+   again from the new position.
+   Returns false if no page was found */
+
+static bool sync_to_page( demux_t *p_demux, int64_t i_pos2, int64_t i_bytes_to_read )
+{
+    demux_sys_t *p_sys  = p_demux->p_sys;
+
+    while ( p_sys->i_input_position < i_pos2 )
+    {
+        /* read next chunk */
+        int64_t i_bytes_read = get_data( p_demux, i_bytes_to_read );
+        if ( i_bytes_read == 0 )
+        {
+            /* EOF */
+            return false;
+        }
+
+        i_bytes_to_read = OGGSEEK_BYTES_TO_READ;
+
+        int64_t i_skipped = 0;
+        long i_result;
+        while ( ( i_result = ogg_sync_pageseek( &p_sys->oy, &p_sys->current_page ) ) < 0 )
+            i_skipped -= i_result;
+
+        /* sync to page start */
+        p_sys->i_input_position += i_skipped;
+        if ( p_sys->i_input_position >= i_pos2 )
+            break;
+
+        if ( i_result > 0 || ( p_sys->oy.fill - p_sys->oy.returned > 3 &&
+             ! memcmp( p_sys->oy.data + p_sys->oy.returned, "OggS", 4 ) ) )
+            return true;
+
+        if ( i_skipped == 0 )
+            p_sys->i_input_position += i_bytes_read;
+    }
+
+    /* we reached the end and found no pages */
+    return false;
+}
+
 void Oggseek_ProbeEnd( demux_t *p_demux )
 {
     /* Temporary state */
@@ -327,7 +372,6 @@ static int64_t find_first_page_granule( demux_t *p_demux,
     int64_t i_result;
     *i_granulepos = -1;
     int64_t i_bytes_to_read = i_pos2 - i_pos1 + 1;
-    int64_t i_bytes_read;
     int64_t i_packets_checked;
 
     demux_sys_t *p_sys  = p_demux->p_sys;
@@ -341,44 +385,9 @@ static int64_t find_first_page_granule( demux_t *p_demux,
 
     if ( i_bytes_to_read > OGGSEEK_BYTES_TO_READ ) i_bytes_to_read = OGGSEEK_BYTES_TO_READ;
 
-    while ( 1 )
-    {
-
-        if ( p_sys->i_input_position >= i_pos2 )
-        {
-            /* we reached the end and found no pages */
-            return -1;
-        }
-
-        /* read next chunk */
-        if ( ! ( i_bytes_read = get_data( p_demux, i_bytes_to_read ) ) )
-        {
-            /* EOF */
-            return -1;
-        }
-
-        i_bytes_to_read = OGGSEEK_BYTES_TO_READ;
-
-        i_result = ogg_sync_pageseek( &p_sys->oy, &p_sys->current_page );
-
-        if ( i_result < 0 )
-        {
-            /* found a page, sync to page start */
-            p_sys->i_input_position -= i_result;
-            i_pos1 = p_sys->i_input_position;
-            continue;
-        }
-
-        if ( i_result > 0 || ( i_result == 0 && p_sys->oy.fill > 3 &&
-                               ! strncmp( (char *)p_sys->oy.data, "OggS" , 4 ) ) )
-        {
-            i_pos1 = p_sys->i_input_position;
-            break;
-        }
-
-        p_sys->i_input_position += i_bytes_read;
-
-    };
+    if ( !sync_to_page( p_demux, i_pos2, i_bytes_to_read ) )
+        return -1;
+    i_pos1 = p_sys->i_input_position;
 
     seek_byte( p_demux, p_sys->i_input_position );
     ogg_stream_reset( &p_stream->os );
@@ -508,7 +517,6 @@ static int64_t OggForwardSeekToFrame( demux_t *p_demux, int64_t i_pos1, int64_t
 {
     int64_t i_result;
     int64_t i_bytes_to_read;
-    int64_t i_bytes_read;
 
     demux_sys_t *p_sys  = p_demux->p_sys;
 
@@ -521,37 +529,8 @@ static int64_t OggForwardSeekToFrame( demux_t *p_demux, int64_t i_pos1, int64_t
         i_pos1, i_pos2, i_granulepos );
     );
 
-    while ( 1 )
-    {
-
-        if ( p_sys->i_input_position >= i_pos2 )
-            return SEGMENT_NOT_FOUND;
-
-        /* read next chunk */
-        if ( ! ( i_bytes_read = get_data( p_demux, i_bytes_to_read ) ) )
-            return SEGMENT_NOT_FOUND;
-
-        i_bytes_to_read = OGGSEEK_BYTES_TO_READ;
-
-        i_result = ogg_sync_pageseek( &p_sys->oy, &p_sys->current_page );
-
-        if ( i_result < 0 )
-        {
-            /* found a page, sync to page start */
-            p_sys->i_input_position -= i_result;
-            i_pos1 = p_sys->i_input_position;
-            continue;
-        }
-
-        if ( i_result > 0 || ( i_result == 0 && p_sys->oy.fill > 3 &&
-                               ! strncmp( (char *)p_sys->oy.data, "OggS" , 4 ) ) )
-        {
-            i_pos1 = p_sys->i_input_position;
-            break;
-        }
-
-        p_sys->i_input_position += i_bytes_read;
-    };
+    if ( !sync_to_page( p_demux, i_pos2, i_bytes_to_read ) )
+        return SEGMENT_NOT_FOUND;
 
     seek_byte( p_demux, p_sys->i_input_position );
     ogg_stream_reset( &p_stream->os );
@@ -695,6 +674,12 @@ static int64_t OggBisectSearchByTime( demux_t *p_demux, logical_stream_t *p_stre
         {
             /* found a page */
 
+            /* remember the pages from which decoding can start, so that the
+             * next seeks get closer bounds from the index */
+            if ( !p_stream->b_oggds &&
+                 Ogg_GetKeyframeGranule( p_stream, current.i_granule ) == current.i_granule )
+                OggSeek_IndexAdd( p_stream, current.i_timestamp, current.i_pos );
+
             if ( current.i_timestamp <= i_targettime )
             {
                 /* set our lower bound */
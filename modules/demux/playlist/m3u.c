@@ -36,6 +36,10 @@
 
 #include "playlist.h"
 
+/* IPTV channel lists may contain many thousands of entries: post them in
+ * batches rather than keeping all of them until the end of the file */
+#define M3U_BATCH_SIZE 512
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -328,6 +332,8 @@ static int ReadDir( stream_t *p_demux, input_item_node_t *p_subitems )
             free( psz_parse );
 
             CreateEntry( p_subitems, &meta );
+            if( p_subitems->i_children >= M3U_BATCH_SIZE )
+                vlc_stream_PostSubItems( p_demux, p_subitems );
 
             /* Cleanup state after entry */
             entry_meta_Clean( &meta );
@@ -39,6 +39,7 @@
 
 #include <vlc_demux.h>
 #include <vlc_charset.h>
+#include <vlc_atomic.h>
 
 /*****************************************************************************
  * Module descriptor
@@ -104,14 +105,19 @@ enum subtitle_type_e
     SUB_TYPE_SCC,      /* Scenarist Closed Caption */
 };
 
+/* Lines kept behind the current one: parsers may step back one line, and
+ * keep pointers to the previous lines */
+#define TEXT_BACKLOG 4
+
 typedef struct
 {
-    size_t  i_line_count;
-    size_t  i_line;
-    char    **line;
+    stream_t *s;
+    size_t  i_line_count; /* lines read from the stream */
+    size_t  i_line;       /* lines handed to the parser */
+    char    *line[TEXT_BACKLOG];
 } text_t;
 
-static int  TextLoad( text_t *, stream_t *s );
+static void TextLoad( text_t *, stream_t *s );
 static void TextUnload( text_t * );
 
 typedef struct
@@ -166,11 +172,27 @@ typedef struct
     {
         subtitle_t *p_array;
         size_t      i_count;
+        size_t      i_max;
         size_t      i_current;
     } subtitles;
 
     vlc_tick_t  i_length;
 
+    /* The subtitles past the first one are parsed by a background thread:
+     * the array, its count and the length are protected by the lock */
+    vlc_thread_t thread;
+    vlc_mutex_t  lock;
+    vlc_cond_t   wait; /* signaled on each new subtitle and at the end */
+    bool         b_thread;
+    bool         b_parsed;
+    bool         b_sort;
+    atomic_bool  b_abort;
+    text_t       txt;
+    int (*pf_read)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t*, size_t );
+
+    es_format_t  fmt;
+    size_t       i_header_len; /* header length given to the ES */
+
     /* */
     subs_properties_t props;
 
@@ -233,7 +255,10 @@ static const struct
 static int Demux( demux_t * );
 static int Control( demux_t *, int, va_list );
 
-static void Fix( demux_t * );
+static int ParseNext( demux_t * );
+static void ParseEnd( demux_t * );
+static void *ParserThread( void * );
+
 static char * get_language_from_filename( const char * );
 
 /*****************************************************************************
@@ -315,7 +340,16 @@ static int Open ( vlc_object_t *p_this )
 
     p_sys->subtitles.i_current= 0;
     p_sys->subtitles.i_count  = 0;
+    p_sys->subtitles.i_max    = 0;
     p_sys->subtitles.p_array  = NULL;
+    p_sys->i_length = 0;
+
+    vlc_mutex_init( &p_sys->lock );
+    vlc_cond_init( &p_sys->wait );
+    p_sys->b_thread = false;
+    p_sys->b_parsed = true;
+    atomic_init( &p_sys->b_abort, false );
+    es_format_Init( &p_sys->fmt, SPU_ES, 0 );
 
     p_sys->props.psz_header         = NULL;
     p_sys->props.i_microsecperframe = VLC_TICK_FROM_MS(40);
@@ -624,8 +658,6 @@ static int Open ( vlc_object_t *p_this )
         }
     }
 
-    msg_Dbg( p_demux, "loading all subtitles..." );
-
     if( e_bom == UTF8BOM && /* skip BOM */
         vlc_stream_Read( p_demux->s, NULL, 3 ) != 3 )
     {
@@ -633,46 +665,37 @@ static int Open ( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
-    /* Load the whole file */
-    text_t txtlines;
-    TextLoad( &txtlines, p_demux->s );
+    /* The SSA events may be out of order */
+    p_sys->b_sort = p_sys->props.i_type == SUB_TYPE_SSA1 ||
+                    p_sys->props.i_type == SUB_TYPE_SSA2_4 ||
+                    p_sys->props.i_type == SUB_TYPE_ASS;
+    p_sys->pf_read = pf_read;
 
-    /* Parse it */
-    for( size_t i_max = 0; i_max < SIZE_MAX - 500 * sizeof(subtitle_t); )
-    {
-        if( p_sys->subtitles.i_count >= i_max )
-        {
-            i_max += 500;
-            subtitle_t *p_realloc = realloc( p_sys->subtitles.p_array, sizeof(subtitle_t) * i_max );
-            if( p_realloc == NULL )
-            {
-                TextUnload( &txtlines );
-                Close( p_this );
-                return VLC_ENOMEM;
-            }
-            p_sys->subtitles.p_array = p_realloc;
-        }
+    /* Parse the first subtitle, hence the SSA header, and leave the rest of
+     * the file to the background thread */
+    TextLoad( &p_sys->txt, p_demux->s );
+    p_sys->b_parsed = false;
+    int i_ret = ParseNext( p_demux );
 
-        if( pf_read( VLC_OBJECT(p_demux), &p_sys->props, &txtlines,
-                     &p_sys->subtitles.p_array[p_sys->subtitles.i_count],
-                     p_sys->subtitles.i_count ) )
-            break;
+    /* The parser thread may extend the header */
+    char *psz_header = NULL;
+    if( p_sys->props.psz_header != NULL )
+        psz_header = strdup( p_sys->props.psz_header );
 
-        p_sys->subtitles.i_count++;
+    if( i_ret == VLC_SUCCESS )
+    {
+        if( vlc_clone( &p_sys->thread, ParserThread, p_demux,
+                       VLC_THREAD_PRIORITY_LOW ) == 0 )
+            p_sys->b_thread = true;
+        else
+            while( ParseNext( p_demux ) == VLC_SUCCESS );
     }
-    /* Unload */
-    TextUnload( &txtlines );
-
-    msg_Dbg(p_demux, "loaded %zu subtitles", p_sys->subtitles.i_count );
+    if( !p_sys->b_thread )
+        ParseEnd( p_demux );
 
     /* *** add subtitle ES *** */
-    if( p_sys->props.i_type == SUB_TYPE_SSA1 ||
-             p_sys->props.i_type == SUB_TYPE_SSA2_4 ||
-             p_sys->props.i_type == SUB_TYPE_ASS )
-    {
-        Fix( p_demux );
+    if( p_sys->b_sort )
         es_format_Init( &fmt, SPU_ES, VLC_CODEC_SSA );
-    }
     else if( p_sys->props.i_type == SUB_TYPE_SCC )
     {
         es_format_Init( &fmt, SPU_ES, VLC_CODEC_CEA608 );
@@ -681,11 +704,6 @@ static int Open ( vlc_object_t *p_this )
     else
         es_format_Init( &fmt, SPU_ES, VLC_CODEC_SUBT );
 
-    p_sys->subtitles.i_current = 0;
-    p_sys->i_length = 0;
-    if( p_sys->subtitles.i_count > 0 )
-        p_sys->i_length = p_sys->subtitles.p_array[p_sys->subtitles.i_count-1].i_stop;
-
     /* Stupid language detection in the filename */
     char * psz_language = get_language_from_filename( p_demux->psz_filepath );
 
@@ -701,14 +719,16 @@ static int Open ( vlc_object_t *p_this )
         fmt.psz_description = psz_description;
     else
         free( psz_description );
-    if( p_sys->props.psz_header != NULL &&
-       (fmt.p_extra = strdup( p_sys->props.psz_header )) )
+    if( psz_header != NULL )
     {
-        fmt.i_extra = strlen( p_sys->props.psz_header ) + 1;
+        fmt.p_extra = psz_header;
+        fmt.i_extra = strlen( psz_header ) + 1;
     }
+    p_sys->i_header_len = fmt.i_extra;
 
     fmt.i_id = 0;
     p_sys->es = es_out_Add( p_demux->out, &fmt );
+    es_format_Copy( &p_sys->fmt, &fmt );
     es_format_Clean( &fmt );
     if( p_sys->es == NULL )
     {
@@ -727,6 +747,13 @@ static void Close( vlc_object_t *p_this )
     demux_t *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    if( p_sys->b_thread )
+    {
+        atomic_store( &p_sys->b_abort, true );
+        vlc_join( p_sys->thread, NULL );
+    }
+    es_format_Clean( &p_sys->fmt );
+
     for( size_t i = 0; i < p_sys->subtitles.i_count; i++ )
         free( p_sys->subtitles.p_array[i].psz_text );
     free( p_sys->subtitles.p_array );
@@ -735,10 +762,24 @@ static void Close( vlc_object_t *p_this )
     free( p_sys );
 }
 
+/* Waits for the parser to index the subtitles up to a date */
+static void WaitIndexed( demux_sys_t *p_sys, vlc_tick_t i_date )
+{
+    while( !p_sys->b_parsed &&
+           ( p_sys->subtitles.i_count == 0 ||
+             p_sys->subtitles.p_array[p_sys->subtitles.i_count - 1].i_start *
+             p_sys->f_rate <= i_date ) )
+        vlc_cond_wait( &p_sys->wait, &p_sys->lock );
+}
+
 static void
 ResetCurrentIndex( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
+
+    vlc_mutex_lock( &p_sys->lock );
+    WaitIndexed( p_sys, p_sys->i_next_demux_date );
+
     for( size_t i = 0; i < p_sys->subtitles.i_count; i++ )
     {
         if( p_sys->subtitles.p_array[i].i_start * p_sys->f_rate >
@@ -746,6 +787,7 @@ ResetCurrentIndex( demux_t *p_demux )
             break;
         p_sys->subtitles.i_current = i;
     }
+    vlc_mutex_unlock( &p_sys->lock );
 }
 
 /*****************************************************************************
@@ -763,7 +805,9 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             return VLC_SUCCESS;
 
         case DEMUX_GET_LENGTH:
+            vlc_mutex_lock( &p_sys->lock );
             *va_arg( args, vlc_tick_t * ) = p_sys->i_length;
+            vlc_mutex_unlock( &p_sys->lock );
             return VLC_SUCCESS;
 
         case DEMUX_GET_TIME:
@@ -780,7 +824,9 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         case DEMUX_GET_POSITION:
             pf = va_arg( args, double * );
-            if( p_sys->subtitles.i_current >= p_sys->subtitles.i_count )
+            vlc_mutex_lock( &p_sys->lock );
+            if( p_sys->b_parsed &&
+                p_sys->subtitles.i_current >= p_sys->subtitles.i_count )
             {
                 *pf = 1.0;
             }
@@ -793,16 +839,25 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             {
                 *pf = 0.0;
             }
+            vlc_mutex_unlock( &p_sys->lock );
             return VLC_SUCCESS;
 
         case DEMUX_SET_POSITION:
+        {
             f = va_arg( args, double );
-            if( p_sys->subtitles.i_count && p_sys->i_length )
+            vlc_mutex_lock( &p_sys->lock );
+            /* The position is only known once the length is */
+            while( !p_sys->b_parsed )
+                vlc_cond_wait( &p_sys->wait, &p_sys->lock );
+            vlc_tick_t i_length = p_sys->subtitles.i_count ? p_sys->i_length : 0;
+            vlc_mutex_unlock( &p_sys->lock );
+            if( i_length )
             {
-                vlc_tick_t i64 = VLC_TICK_0 + f * p_sys->i_length;
+                vlc_tick_t i64 = VLC_TICK_0 + f * i_length;
                 return demux_Control( p_demux, DEMUX_SET_TIME, i64 );
             }
             break;
+        }
 
         case DEMUX_CAN_CONTROL_RATE:
             *va_arg( args, bool * ) = true;
@@ -816,10 +871,13 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             p_sys->i_next_demux_date = va_arg( args, vlc_tick_t ) - VLC_TICK_0;
             return VLC_SUCCESS;
 
+        /* The stream belongs to the parser thread */
         case DEMUX_CAN_PAUSE:
-        case DEMUX_SET_PAUSE_STATE:
         case DEMUX_CAN_CONTROL_PACE:
-            return demux_vaControlHelper( p_demux->s, 0, -1, 0, 1, i_query, args );
+            *va_arg( args, bool * ) = true;
+            return VLC_SUCCESS;
+        case DEMUX_SET_PAUSE_STATE:
+            return VLC_SUCCESS;
 
         case DEMUX_GET_PTS_DELAY:
         case DEMUX_GET_FPS:
@@ -844,11 +902,14 @@ static int Demux( demux_t *p_demux )
 
     vlc_tick_t i_barrier = p_sys->i_next_demux_date;
 
+    vlc_mutex_lock( &p_sys->lock );
+    WaitIndexed( p_sys, i_barrier );
     while( p_sys->subtitles.i_current < p_sys->subtitles.i_count &&
            ( p_sys->subtitles.p_array[p_sys->subtitles.i_current].i_start *
              p_sys->f_rate ) <= i_barrier )
     {
-        const subtitle_t *p_subtitle = &p_sys->subtitles.p_array[p_sys->subtitles.i_current];
+        /* Moved past before the lock is released for the parser */
+        const subtitle_t *p_subtitle = &p_sys->subtitles.p_array[p_sys->subtitles.i_current++];
 
         if ( !p_sys->b_slave && p_sys->b_first_time )
         {
@@ -866,11 +927,31 @@ static int Demux( demux_t *p_demux )
                 if( p_subtitle->i_stop >= 0 && p_subtitle->i_stop >= p_subtitle->i_start )
                     p_block->i_length = (p_subtitle->i_stop - p_subtitle->i_start) * p_sys->f_rate;
 
+                vlc_mutex_unlock( &p_sys->lock );
                 es_out_Send( p_demux->out, p_sys->es, p_block );
+                vlc_mutex_lock( &p_sys->lock );
             }
         }
+    }
+    const bool b_eof = p_sys->b_parsed &&
+                       p_sys->subtitles.i_current >= p_sys->subtitles.i_count;
+    const bool b_header = p_sys->b_parsed && p_sys->props.psz_header != NULL &&
+                          strlen( p_sys->props.psz_header ) + 1 > p_sys->i_header_len;
+    vlc_mutex_unlock( &p_sys->lock );
 
-        p_sys->subtitles.i_current++;
+    /* SSA sections after the first event reach the decoder late */
+    if( b_header )
+    {
+        char *psz_header = strdup( p_sys->props.psz_header );
+        if( psz_header != NULL )
+        {
+            free( p_sys->fmt.p_extra );
+            p_sys->fmt.p_extra = psz_header;
+            p_sys->fmt.i_extra = strlen( psz_header ) + 1;
+            es_out_Control( p_demux->out, ES_OUT_SET_ES_FMT, p_sys->es,
+                            &p_sys->fmt );
+        }
+        p_sys->i_header_len = SIZE_MAX;
     }
 
     if ( !p_sys->b_slave )
@@ -879,78 +960,103 @@ static int Demux( demux_t *p_demux )
         p_sys->i_next_demux_date += VLC_TICK_FROM_MS(125);
     }
 
-    if( p_sys->subtitles.i_current >= p_sys->subtitles.i_count )
+    if( b_eof )
         return VLC_DEMUXER_EOF;
 
     return VLC_DEMUXER_SUCCESS;
 }
 
 
-static int subtitle_cmp( const void *first, const void *second )
-{
-    vlc_tick_t result = ((subtitle_t *)(first))->i_start - ((subtitle_t *)(second))->i_start;
-    /* Return -1, 0 ,1, and not directly subtraction
-     * as result can be > INT_MAX */
-    return result == 0 ? 0 : result > 0 ? 1 : -1;
-}
 /*****************************************************************************
- * Fix: fix time stamp and order of subtitle
+ * ParseNext: parse the next subtitle into the time index
  *****************************************************************************/
-static void Fix( demux_t *p_demux )
+static int ParseNext( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
+    subtitle_t sub;
+
+    /* Only this thread changes the count */
+    if( p_sys->pf_read( VLC_OBJECT(p_demux), &p_sys->props, &p_sys->txt,
+                        &sub, p_sys->subtitles.i_count ) )
+        return VLC_EGENERIC;
 
-    /* *** fix order (to be sure...) *** */
-    qsort( p_sys->subtitles.p_array, p_sys->subtitles.i_count, sizeof( p_sys->subtitles.p_array[0] ), subtitle_cmp);
+    vlc_mutex_lock( &p_sys->lock );
+    if( p_sys->subtitles.i_count >= p_sys->subtitles.i_max )
+    {
+        subtitle_t *p_realloc =
+            vlc_reallocarray( p_sys->subtitles.p_array,
+                              p_sys->subtitles.i_max + 500, sizeof(sub) );
+        if( p_realloc == NULL )
+        {
+            vlc_mutex_unlock( &p_sys->lock );
+            free( sub.psz_text );
+            return VLC_ENOMEM;
+        }
+        p_sys->subtitles.p_array = p_realloc;
+        p_sys->subtitles.i_max += 500;
+    }
+
+    size_t i = p_sys->subtitles.i_count;
+    if( p_sys->b_sort )
+    {
+        /* Keep the index sorted, the events are seldom out of order. An
+         * event before the ones already sent is sent next. */
+        while( i > p_sys->subtitles.i_current &&
+               p_sys->subtitles.p_array[i - 1].i_start > sub.i_start )
+            i--;
+        memmove( &p_sys->subtitles.p_array[i + 1],
+                 &p_sys->subtitles.p_array[i],
+                 ( p_sys->subtitles.i_count - i ) * sizeof(sub) );
+    }
+    p_sys->subtitles.p_array[i] = sub;
+    p_sys->subtitles.i_count++;
+    if( sub.i_stop > p_sys->i_length )
+        p_sys->i_length = sub.i_stop;
+    vlc_cond_broadcast( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
+    return VLC_SUCCESS;
 }
 
-static int TextLoad( text_t *txt, stream_t *s )
+static void ParseEnd( demux_t *p_demux )
 {
-    size_t i_line_max;
-
-    /* init txt */
-    i_line_max          = 500;
-    txt->i_line_count   = 0;
-    txt->i_line         = 0;
-    txt->line           = calloc( i_line_max, sizeof( char * ) );
-    if( !txt->line )
-        return VLC_ENOMEM;
+    demux_sys_t *p_sys = p_demux->p_sys;
 
-    /* load the complete file */
-    for( ;; )
-    {
-        char *psz = vlc_stream_ReadLine( s );
+    TextUnload( &p_sys->txt );
 
-        if( psz == NULL )
-            break;
+    vlc_mutex_lock( &p_sys->lock );
+    p_sys->b_parsed = true;
+    vlc_cond_broadcast( &p_sys->wait );
+    vlc_mutex_unlock( &p_sys->lock );
 
-        txt->line[txt->i_line_count] = psz;
-        if( txt->i_line_count + 1 >= i_line_max )
-        {
-            i_line_max += 100;
-            char **p_realloc = realloc( txt->line, i_line_max * sizeof( char * ) );
-            if( p_realloc == NULL )
-                return VLC_ENOMEM;
-            txt->line = p_realloc;
-        }
-        txt->i_line_count++;
-    }
+    msg_Dbg( p_demux, "loaded %zu subtitles", p_sys->subtitles.i_count );
+}
 
-    if( txt->i_line_count == 0 )
-    {
-        free( txt->line );
-        return VLC_EGENERIC;
-    }
+static void *ParserThread( void *data )
+{
+    demux_t *p_demux = data;
+    demux_sys_t *p_sys = p_demux->p_sys;
 
-    return VLC_SUCCESS;
+    while( !atomic_load( &p_sys->b_abort ) &&
+           ParseNext( p_demux ) == VLC_SUCCESS );
+
+    ParseEnd( p_demux );
+    return NULL;
+}
+
+static void TextLoad( text_t *txt, stream_t *s )
+{
+    txt->s            = s;
+    txt->i_line_count = 0;
+    txt->i_line       = 0;
+    for( size_t i = 0; i < TEXT_BACKLOG; i++ )
+        txt->line[i] = NULL;
 }
 static void TextUnload( text_t *txt )
 {
-    if( txt->i_line_count )
+    for( size_t i = 0; i < TEXT_BACKLOG; i++ )
     {
-        for( size_t i = 0; i < txt->i_line_count; i++ )
-            free( txt->line[i] );
-        free( txt->line );
+        free( txt->line[i] );
+        txt->line[i] = NULL;
     }
     txt->i_line       = 0;
     txt->i_line_count = 0;
@@ -959,15 +1065,32 @@ static void TextUnload( text_t *txt )
 static char *TextGetLine( text_t *txt )
 {
     if( txt->i_line >= txt->i_line_count )
-        return( NULL );
+    {
+        /* Read the lines as they are parsed, only keeping the last ones */
+        char *psz = vlc_stream_ReadLine( txt->s );
+        if( psz == NULL )
+            return NULL;
 
-    return txt->line[txt->i_line++];
+        free( txt->line[txt->i_line_count % TEXT_BACKLOG] );
+        txt->line[txt->i_line_count % TEXT_BACKLOG] = psz;
+        txt->i_line_count++;
+    }
+    return txt->line[txt->i_line++ % TEXT_BACKLOG];
 }
 static void TextPreviousLine( text_t *txt )
 {
     if( txt->i_line > 0 )
         txt->i_line--;
 }
+static bool TextIsEOF( text_t *txt )
+{
+    if( txt->i_line < txt->i_line_count )
+        return false;
+    if( TextGetLine( txt ) == NULL )
+        return true;
+    TextPreviousLine( txt );
+    return false;
+}
 
 /*****************************************************************************
  * Specific Subtitle function
@@ -1621,7 +1744,7 @@ static int ParseAQT(vlc_object_t *p_obj, subs_properties_t *p_props, text_t *txt
                  return VLC_ENOMEM;
             strcat( psz_text, s );
             strcat( psz_text, "\n" );
-            if( txt->i_line == txt->i_line_count )
+            if( TextIsEOF( txt ) )
                 break;
         }
     }
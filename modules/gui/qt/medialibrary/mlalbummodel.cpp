@@ -103,10 +103,14 @@ void MLAlbumModel::onVlcMlEvent(const MLEvent &event)
     switch( event.i_type )
     {
         case VLC_ML_EVENT_ALBUM_ADDED:
-        case VLC_ML_EVENT_ALBUM_DELETED:
-        case VLC_ML_EVENT_ALBUM_UPDATED:
             m_need_reset = true;
             break;
+        case VLC_ML_EVENT_ALBUM_UPDATED:
+            updateItem( event.modification.i_entity_id );
+            break;
+        case VLC_ML_EVENT_ALBUM_DELETED:
+            removeItem( event.deletion.i_entity_id );
+            break;
         case VLC_ML_EVENT_ARTIST_DELETED:
             if ( m_parent.id != 0 && m_parent.type == VLC_ML_PARENT_ARTIST &&
                  event.deletion.i_entity_id == m_parent.id )
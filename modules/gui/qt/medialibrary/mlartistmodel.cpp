@@ -93,9 +93,13 @@ void MLArtistModel::onVlcMlEvent(const MLEvent &event)
     switch (event.i_type)
     {
         case VLC_ML_EVENT_ARTIST_ADDED:
+            m_need_reset = true;
+            break;
         case VLC_ML_EVENT_ARTIST_UPDATED:
+            updateItem(event.modification.i_entity_id);
+            break;
         case VLC_ML_EVENT_ARTIST_DELETED:
-            m_need_reset = true;
+            removeItem(event.deletion.i_entity_id);
             break;
         case VLC_ML_EVENT_GENRE_DELETED:
             if ( m_parent.id != 0 && m_parent.type == VLC_ML_PARENT_GENRE &&
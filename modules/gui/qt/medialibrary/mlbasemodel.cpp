@@ -99,34 +99,61 @@ void MLBaseModel::onVlcMlEvent(const MLEvent &event)
         case VLC_ML_EVENT_MEDIA_THUMBNAIL_GENERATED:
         {
             if (event.media_thumbnail_generated.b_success) {
-                if (!m_cache)
-                    break;
-
-                ssize_t stotal = m_cache->count();
-                if (stotal == COUNT_UNINITIALIZED)
-                    break;
-
-                size_t total = static_cast<size_t>(stotal);
-                for (size_t i = 0; i < total; ++i)
-                {
-                    const std::unique_ptr<MLItem> *item = m_cache->get(i);
-                    if (!item)
-                        /* Only consider items available locally in cache */
-                        break;
-
-                    MLItem *localItem = item->get();
-                    if (localItem->getId().id == event.media_thumbnail_generated.i_media_id)
-                    {
-                        thumbnailUpdated(i);
-                        break;
-                    }
-                }
+                /* Only consider items available locally in cache */
+                int idx = localIndexOf(event.media_thumbnail_generated.i_media_id);
+                if (idx >= 0)
+                    thumbnailUpdated(idx);
             }
             break;
         }
     }
 }
 
+int MLBaseModel::localIndexOf(int64_t id) const
+{
+    if (!m_cache || m_cache->count() == COUNT_UNINITIALIZED)
+        return -1;
+
+    return m_cache->findLocal([id](const std::unique_ptr<MLItem> &item) {
+        return item->getId().id == id;
+    });
+}
+
+void MLBaseModel::updateItem(int64_t id)
+{
+    /* the items out of the window are loaded up to date when needed */
+    if (m_need_reset || m_need_reload || localIndexOf(id) < 0)
+        return;
+
+    /* coalesce the events of a burst (e.g. during a scan) into one reload */
+    m_need_reload = true;
+    QMetaObject::invokeMethod(this, &MLBaseModel::onReloadRequested,
+                              Qt::QueuedConnection);
+}
+
+void MLBaseModel::removeItem(int64_t id)
+{
+    int idx = localIndexOf(id);
+    if (m_need_reset || idx < 0)
+    {
+        /* the position of the item is unknown */
+        m_need_reset = true;
+        return;
+    }
+
+    beginRemoveRows({}, idx, idx);
+    m_cache->removeLocal(idx);
+    endRemoveRows();
+    emit countChanged(static_cast<unsigned>(m_cache->count()));
+}
+
+void MLBaseModel::onReloadRequested()
+{
+    m_need_reload = false;
+    if (m_cache && !m_need_reset)
+        m_cache->reload();
+}
+
 QString MLBaseModel::getFirstSymbol(QString str)
 {
     QString ret("#");
@@ -77,6 +77,7 @@ protected slots:
     void onLocalSizeAboutToBeChanged(size_t size);
     void onLocalSizeChanged(size_t size);
     void onLocalDataChanged(size_t index, size_t count);
+    void onReloadRequested();
 
 private:
     static void onVlcMlEvent( void* data, const vlc_ml_event_t* event );
@@ -102,6 +103,12 @@ protected:
 
     virtual void thumbnailUpdated( int ) {}
 
+    int localIndexOf( int64_t id ) const;
+    /* reload the item in place if it is in the local window */
+    void updateItem( int64_t id );
+    /* remove the row if it is in the local window, else reset */
+    void removeItem( int64_t id );
+
     /* Data loader for the cache */
     struct BaseLoader : public ListCacheLoader<std::unique_ptr<MLItem>>
     {
@@ -151,6 +158,7 @@ protected:
     std::unique_ptr<vlc_ml_event_callback_t,
                     std::function<void(vlc_ml_event_callback_t*)>> m_ml_event_handle;
     bool m_need_reset = false;
+    bool m_need_reload = false;
 
     mutable std::unique_ptr<ListCache<std::unique_ptr<MLItem>>> m_cache;
 };
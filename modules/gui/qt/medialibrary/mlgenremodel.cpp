@@ -73,9 +73,13 @@ void MLGenreModel::onVlcMlEvent(const MLEvent &event)
     switch (event.i_type)
     {
         case VLC_ML_EVENT_GENRE_ADDED:
+            m_need_reset = true;
+            break;
         case VLC_ML_EVENT_GENRE_UPDATED:
+            updateItem(event.modification.i_entity_id);
+            break;
         case VLC_ML_EVENT_GENRE_DELETED:
-            m_need_reset = true;
+            removeItem(event.deletion.i_entity_id);
             break;
     }
     MLBaseModel::onVlcMlEvent(event);
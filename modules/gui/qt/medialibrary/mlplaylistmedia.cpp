@@ -114,7 +114,7 @@ QString MLPlaylistMedia::getTitle() const
 QString MLPlaylistMedia::getThumbnail()
 {
     // NOTE: We don't need to generate a cover for audio media(s).
-    if (m_type != VLC_ML_MEDIA_TYPE_AUDIO
+    if (m_type != VLC_ML_MEDIA_TYPE_AUDIO && !m_handle
         &&
         (m_thumbnailStatus == VLC_ML_THUMBNAIL_STATUS_MISSING
          ||
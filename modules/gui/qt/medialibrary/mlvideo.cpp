@@ -168,8 +168,11 @@ QString MLVideo::getTitle() const
 
 QString MLVideo::getThumbnail()
 {
-    if ( m_thumbnailStatus == VLC_ML_THUMBNAIL_STATUS_MISSING ||
-         m_thumbnailStatus == VLC_ML_THUMBNAIL_STATUS_FAILURE )
+    /* Request the generation once: the row asks again on each repaint. The
+     * request is dropped with the item when it leaves the cache window. */
+    if ( !m_ml_event_handle &&
+         ( m_thumbnailStatus == VLC_ML_THUMBNAIL_STATUS_MISSING ||
+           m_thumbnailStatus == VLC_ML_THUMBNAIL_STATUS_FAILURE ) )
     {
         m_ml_event_handle.reset( vlc_ml_event_register_callback( m_ml, onMlEvent, this ) );
         vlc_ml_media_generate_thumbnail( m_ml, getId().id, VLC_ML_THUMBNAIL_SMALL,
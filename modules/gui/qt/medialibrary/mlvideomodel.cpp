@@ -123,9 +123,13 @@ void MLVideoModel::onVlcMlEvent(const MLEvent &event)
     switch (event.i_type)
     {
         case VLC_ML_EVENT_MEDIA_ADDED:
+            m_need_reset = true;
+            break;
         case VLC_ML_EVENT_MEDIA_UPDATED:
+            updateItem( event.modification.i_entity_id );
+            break;
         case VLC_ML_EVENT_MEDIA_DELETED:
-            m_need_reset = true;
+            removeItem( event.deletion.i_entity_id );
             break;
         default:
             break;
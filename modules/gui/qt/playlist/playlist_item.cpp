@@ -42,21 +42,25 @@ void PlaylistItem::setSelected(bool selected)
 
 QString PlaylistItem::getTitle() const
 {
+    syncMeta();
     return d->title;
 }
 
 QString PlaylistItem::getArtist() const
 {
+    syncMeta();
     return d->artist;
 }
 
 QString PlaylistItem::getAlbum() const
 {
+    syncMeta();
     return d->album;
 }
 
 QUrl PlaylistItem::getArtwork() const
 {
+    syncMeta();
     return d->artwork;
 }
 
@@ -67,14 +71,33 @@ vlc_tick_t PlaylistItem::getDuration() const
 
 QUrl PlaylistItem::getUrl() const
 {
+    syncMeta();
     return d->url;
 }
 
+bool PlaylistItem::requestPreparse() const
+{
+    if (d->preparseRequested)
+        return false;
+    d->preparseRequested = true;
+    return true;
+}
+
 void PlaylistItem::sync() {
     input_item_t *media = vlc_playlist_item_GetMedia(d->item.get());
     vlc_mutex_lock(&media->lock);
-    d->title    = media->psz_name;
     d->duration = media->i_duration;
+    vlc_mutex_unlock(&media->lock);
+    d->metaSynced = false;
+}
+
+void PlaylistItem::syncMeta() const {
+    if (d->metaSynced || !d->item)
+        return;
+
+    input_item_t *media = vlc_playlist_item_GetMedia(d->item.get());
+    vlc_mutex_lock(&media->lock);
+    d->title    = media->psz_name;
     d->url      = media->psz_uri;
 
     if (media->p_meta) {
@@ -83,6 +106,7 @@ void PlaylistItem::sync() {
         d->artwork = vlc_meta_Get(media->p_meta, vlc_meta_ArtworkURL);
     }
     vlc_mutex_unlock(&media->lock);
+    d->metaSynced = true;
 }
 
 PlaylistItem::operator bool() const
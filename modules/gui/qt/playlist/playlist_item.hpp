@@ -41,9 +41,12 @@ using PlaylistItemPtr = vlc_shared_data_ptr_type(vlc_playlist_item_t,
 /**
  * Playlist item wrapper.
  *
- * It contains both the PlaylistItemPtr and cached data saved while the playlist
- * is locked, so that the fields may be read without synchronization or race
- * conditions.
+ * It contains both the PlaylistItemPtr and cached data, so that the fields may
+ * be read without synchronization or race conditions.
+ *
+ * Only the duration is read when the item is created or synced (the model sums
+ * it up); the other fields are copied from the media on first access, so that
+ * the rows never displayed of a large playlist cost no more than a pointer.
  */
 class PlaylistItem
 {
@@ -79,22 +82,29 @@ public:
 
     QUrl getUrl() const;
 
+    /* return true the first time, to request the preparsing only once */
+    bool requestPreparse() const;
 
+    /* read the duration, and refresh the other fields on next access */
     void sync();
 
 private:
+    void syncMeta() const;
+
     struct Data : public QSharedData {
         PlaylistItemPtr item;
 
         bool selected = false;
+        bool preparseRequested = false;
+        bool metaSynced = false;
 
-        /* cached values */
+        /* cached values, see syncMeta() */
         QString title;
         QString artist;
         QString album;
         QUrl artwork;
 
-        vlc_tick_t duration;
+        vlc_tick_t duration = 0;
 
         QUrl url;
     };
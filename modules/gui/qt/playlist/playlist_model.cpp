@@ -34,6 +34,7 @@ static QVector<PlaylistItem> toVec(vlc_playlist_item_t *const items[],
                                    size_t len)
 {
     QVector<PlaylistItem> vec;
+    vec.reserve(len);
     for (size_t i = 0; i < len; ++i)
         vec.push_back(items[i]);
     return vec;
@@ -111,14 +112,11 @@ on_playlist_items_updated(vlc_playlist_t *playlist, size_t index,
                           void *userdata)
 {
     PlaylistListModelPrivate *that = static_cast<PlaylistListModelPrivate *>(userdata);
-    QVector<PlaylistItem> updated = toVec(items, len);
+    (void) items;
     that->callAsync([=](){
         if (that->m_playlist != playlist)
             return;
-        int count = updated.size();
-        for (int i = 0; i < count; ++i)
-            that->m_items[index + i] = updated[i]; /* sync metadata */
-        that->notifyItemsChanged(index, count);
+        that->onItemsUpdated(index, len);
     });
 }
 
@@ -248,6 +246,19 @@ void PlaylistListModelPrivate::onItemsRemoved(size_t index, size_t count)
     emit q->selectedCountChanged();
 }
 
+void PlaylistListModelPrivate::onItemsUpdated(size_t index, size_t count)
+{
+    /* the rows are in sync with the core list, as the callbacks are applied
+     * in order: refresh the existing items, which keeps their selection */
+    for (size_t i = index; i < index + count; ++i)
+    {
+        PlaylistItem &item = m_items[i];
+        m_duration -= item.getDuration();
+        item.sync();
+        m_duration += item.getDuration();
+    }
+    notifyItemsChanged(index, count);
+}
 
 void
 PlaylistListModelPrivate::notifyItemsChanged(int idx, int count, const QVector<int> &roles)
@@ -465,6 +476,17 @@ PlaylistListModel::data(const QModelIndex &index, int role) const
     if (row < 0 || row >= d->m_items.size())
         return {};
 
+    /* large playlists are not preparsed on insertion, preparse the items
+     * once they are displayed */
+    if (d->m_items[row].requestPreparse())
+    {
+        PlaylistLocker locker(d->m_playlist);
+        ssize_t playlistIndex = vlc_playlist_IndexOf(d->m_playlist,
+                                                     d->m_items[row].raw());
+        if (playlistIndex != -1)
+            vlc_playlist_PreparseItems(d->m_playlist, playlistIndex, 1);
+    }
+
     switch (role)
     {
     case TitleRole:
@@ -53,6 +53,7 @@ public:
     void onItemsAdded(const QVector<PlaylistItem>& added, size_t index);
     void onItemsMoved(size_t index, size_t count, size_t target);
     void onItemsRemoved(size_t index, size_t count);
+    void onItemsUpdated(size_t index, size_t count);
 
     void notifyItemsChanged(int index, int count,
                             const QVector<int> &roles = {});
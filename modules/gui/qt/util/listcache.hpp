@@ -45,7 +45,10 @@
  * separate thread, not to block the UI thread.
  *
  * The precise cache strategy is unspecified (it may change in the future), but
- * the general principle is to keep locally only a part of the whole data.
+ * the general principle is to keep locally only a part of the whole data: a
+ * window of a few chunks around the last referred item. When the window
+ * slides, the chunks already available locally are kept, only the missing
+ * ones are loaded.
  *
  * The list of items it represents is assumed constant:
  *  1. the list size will never change once initialized,
@@ -146,8 +149,32 @@ public:
      */
     void refer(size_t index);
 
+    /**
+     * Return the index of the first local item matching the predicate, or -1
+     *
+     * Only the items available locally are considered.
+     */
+    template <typename Pred>
+    ssize_t findLocal(Pred pred) const;
+
+    /**
+     * Reload the local items in place
+     *
+     * The list size is unchanged, `localDataChanged()` is emitted once the
+     * items are retrieved.
+     */
+    void reload();
+
+    /**
+     * Remove a local item, the following items are shifted
+     *
+     * The list size is decremented, nothing is retrieved from the loader.
+     */
+    void removeLocal(size_t index);
+
 private:
-    void asyncLoad(size_t offset, size_t count);
+    MLRange windowAround(size_t index) const;
+    void asyncLoad(MLRange window, MLRange missing);
     void onLoadResult() override;
 
     void asyncCount();
@@ -193,6 +220,18 @@ void ListCache<T>::initCount()
     asyncCount();
 }
 
+template <typename T>
+MLRange ListCache<T>::windowAround(size_t index) const
+{
+    /* the chunk of the index, and one chunk on each side, so that scrolling
+     * in either direction finds its items already loaded */
+    size_t chunk = index - index % m_chunkSize;
+    size_t offset = chunk >= m_chunkSize ? chunk - m_chunkSize : 0;
+    size_t end = qMin(static_cast<size_t>(m_total_count),
+                      chunk + 2 * m_chunkSize);
+    return { offset, end - offset };
+}
+
 template <typename T>
 void ListCache<T>::refer(size_t index)
 {
@@ -207,15 +246,65 @@ void ListCache<T>::refer(size_t index)
         return;
     }
 
-    /* index outside the known portion of the list */
-    if (!m_lastRangeRequested.contains(index))
+    /* Slide the window only once the index leaves its middle chunk: the
+     * items close to either edge are then still available locally */
+    MLRange window = windowAround(index);
+    if (m_lastRangeRequested.contains(index)
+     && m_lastRangeRequested.contains(window.offset)
+     && m_lastRangeRequested.contains(window.offset + window.count - 1))
+        return;
+
+    /* Only load the part of the new window which is not local. The windows
+     * are contiguous, so it is a single range unless they do not overlap. */
+    size_t local_end = m_offset + m_list.size();
+    size_t window_end = window.offset + window.count;
+    MLRange missing = window;
+    if (m_list.size() && m_offset <= window.offset && local_end > window.offset)
+        missing = { local_end, window_end - qMin(local_end, window_end) };
+    else if (m_list.size() && m_offset < window_end && local_end >= window_end)
+        missing = { window.offset, m_offset - qMin(m_offset, window.offset) };
+
+    if (missing.isEmpty())
     {
-        /* FIXME bad heuristic if the interval of visible items crosses a cache
-         * page boundary */
-        size_t offset = index - index % m_chunkSize;
-        size_t count = qMin(m_total_count - offset, m_chunkSize);
-        asyncLoad(offset, count);
+        /* the window is already local, drop the pending load */
+        m_loadTask.reset();
+        m_lastRangeRequested = { m_offset, m_list.size() };
+        return;
     }
+    asyncLoad(window, missing);
+}
+
+template <typename T>
+template <typename Pred>
+ssize_t ListCache<T>::findLocal(Pred pred) const
+{
+    for (size_t i = 0; i < m_list.size(); ++i)
+        if (pred(m_list[i]))
+            return static_cast<ssize_t>(m_offset + i);
+    return -1;
+}
+
+template <typename T>
+void ListCache<T>::reload()
+{
+    if (m_total_count == -1 || m_list.empty())
+        return;
+
+    /* the local items are kept meanwhile, the loaded ones replace them */
+    MLRange window = { m_offset, m_list.size() };
+    asyncLoad(window, window);
+}
+
+template <typename T>
+void ListCache<T>::removeLocal(size_t index)
+{
+    assert(index >= m_offset && index < m_offset + m_list.size());
+
+    /* a pending load was requested with the previous indices */
+    m_loadTask.reset();
+    m_list.erase(m_list.begin() + (index - m_offset));
+    m_total_count--;
+    m_lastRangeRequested = { m_offset, m_list.size() };
 }
 
 template <typename T>
@@ -251,6 +340,9 @@ void ListCache<T>::onCountResult()
     CountTask<T> *task = static_cast<CountTask<T> *>(sender());
     assert(task == m_countTask.get());
 
+    /* a pending load would be merged into a list of another size */
+    m_loadTask.reset();
+    m_lastRangeRequested = {};
     m_offset = 0;
     m_list.clear();
     m_total_count = static_cast<ssize_t>(task->takeResult());
@@ -280,17 +372,22 @@ private:
     QSharedPointer<ListCacheLoader<T>> m_loader;
     size_t m_offset;
     size_t m_count;
+    /* the window the loaded items are merged into */
+    MLRange m_window;
 
     friend class ListCache<T>;
 };
 
 template <typename T>
-void ListCache<T>::asyncLoad(size_t offset, size_t count)
+void ListCache<T>::asyncLoad(MLRange window, MLRange missing)
 {
-    m_loadTask.reset(new LoadTask<T>(m_loader, offset, count));
+    /* Abandon the previous load, if any: the local list does not change
+     * until the result of this one is merged */
+    m_loadTask.reset(new LoadTask<T>(m_loader, missing.offset, missing.count));
+    m_loadTask->m_window = window;
     connect(m_loadTask.get(), &BaseAsyncTask::result,
             this, &ListCache<T>::onLoadResult);
-    m_lastRangeRequested = { offset, count };
+    m_lastRangeRequested = window;
     m_loadTask->start(m_threadPool);
 }
 
@@ -300,10 +397,28 @@ void ListCache<T>::onLoadResult()
     LoadTask<T> *task = static_cast<LoadTask<T> *>(sender());
     assert(task == m_loadTask.get());
 
-    m_offset = task->m_offset;
-    m_list = task->takeResult();
-    if (m_list.size())
-        emit localDataChanged(m_offset, m_list.size());
+    const MLRange window = task->m_window;
+    std::vector<T> loaded = task->takeResult();
+    std::vector<T> list;
+    list.reserve(window.count);
+
+    /* Merge the local items still in the window with the loaded ones */
+    size_t local_end = m_offset + m_list.size();
+    for (size_t i = window.offset; i < window.offset + window.count; ++i)
+    {
+        if (i >= task->m_offset && i - task->m_offset < loaded.size())
+            list.push_back(std::move(loaded[i - task->m_offset]));
+        else if (i >= m_offset && i < local_end)
+            list.push_back(std::move(m_list[i - m_offset]));
+        else
+            /* the source returned less items than expected */
+            break;
+    }
+
+    m_offset = window.offset;
+    m_list = std::move(list);
+    if (loaded.size())
+        emit localDataChanged(task->m_offset, loaded.size());
 
     m_loadTask.reset();
 }
@@ -0,0 +1,297 @@
+/*****************************************************************************
+ * dmabuf.c: DMA-BUF picture helpers for VLC
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <linux/dma-buf.h>
+#include <linux/dma-heap.h>
+
+#include <vlc_common.h>
+#include <vlc_fourcc.h>
+#include <vlc_fs.h>
+
+#include "vlc_dmabuf.h"
+
+/* Pitch alignment accepted by the GPU of every EGL implementation */
+#define DMABUF_PITCH_ALIGN 256
+
+static const struct
+{
+    vlc_fourcc_t chroma;
+    uint32_t drm_formats[PICTURE_PLANE_MAX];
+} dmabuf_chromas[] = {
+    { VLC_CODEC_NV12, { VLC_DRM_FORMAT_R8, VLC_DRM_FORMAT_GR88 } },
+    { VLC_CODEC_I420, { VLC_DRM_FORMAT_R8, VLC_DRM_FORMAT_R8,
+                        VLC_DRM_FORMAT_R8 } },
+    { VLC_CODEC_J420, { VLC_DRM_FORMAT_R8, VLC_DRM_FORMAT_R8,
+                        VLC_DRM_FORMAT_R8 } },
+    { VLC_CODEC_YV12, { VLC_DRM_FORMAT_R8, VLC_DRM_FORMAT_R8,
+                        VLC_DRM_FORMAT_R8 } },
+    { VLC_CODEC_RGBA, { VLC_DRM_FORMAT_ABGR8888 } },
+    { VLC_CODEC_BGRA, { VLC_DRM_FORMAT_ARGB8888 } },
+};
+
+static const uint32_t *GetDrmFormats(vlc_fourcc_t chroma)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(dmabuf_chromas); i++)
+        if (dmabuf_chromas[i].chroma == chroma)
+            return dmabuf_chromas[i].drm_formats;
+    return NULL;
+}
+
+bool vlc_dmabuf_IsChromaSupported(vlc_fourcc_t chroma)
+{
+    return GetDrmFormats(chroma) != NULL;
+}
+
+struct dmabuf_pic_ctx
+{
+    struct vlc_dmabuf_pic_context ctx;
+    picture_t *picref;
+};
+
+typedef struct
+{
+    struct dmabuf_pic_ctx ctx;
+    void *base;
+    size_t size;
+} picture_sys_t;
+
+static void
+pool_pic_destroy_cb(picture_t *pic)
+{
+    picture_sys_t *p_sys = pic->p_sys;
+
+    munmap(p_sys->base, p_sys->size);
+    vlc_close(p_sys->ctx.ctx.planes[0].fd);
+    free(p_sys);
+}
+
+static void
+pic_ctx_destroy_cb(struct picture_context_t *opaque)
+{
+    struct dmabuf_pic_ctx *ctx =
+        container_of(opaque, struct dmabuf_pic_ctx, ctx.s);
+    picture_Release(ctx->picref);
+    free(ctx);
+}
+
+static struct picture_context_t *
+pic_ctx_copy_cb(struct picture_context_t *opaque)
+{
+    struct dmabuf_pic_ctx *src_ctx =
+        container_of(opaque, struct dmabuf_pic_ctx, ctx.s);
+    struct dmabuf_pic_ctx *dst_ctx = malloc(sizeof (*dst_ctx));
+    if (dst_ctx == NULL)
+        return NULL;
+
+    *dst_ctx = *src_ctx;
+    vlc_video_context_Hold(dst_ctx->ctx.s.vctx);
+    dst_ctx->ctx.s.destroy = pic_ctx_destroy_cb;
+    picture_Hold(dst_ctx->picref);
+    return &dst_ctx->ctx.s;
+}
+
+static void
+pic_sys_ctx_destroy_cb(struct picture_context_t *opaque)
+{
+    (void) opaque;
+}
+
+static int
+dmabuf_Alloc(vlc_object_t *o, int heap_fd, size_t size)
+{
+    struct dma_heap_allocation_data data = {
+        .len = size,
+        .fd_flags = O_RDWR | O_CLOEXEC,
+    };
+
+    if (ioctl(heap_fd, DMA_HEAP_IOCTL_ALLOC, &data) < 0)
+    {
+        msg_Err(o, "cannot allocate %zu bytes DMA-BUF: %s", size,
+                vlc_strerror_c(errno));
+        return -1;
+    }
+    return data.fd;
+}
+
+picture_pool_t *
+vlc_dmabuf_PoolNew(vlc_object_t *o, vlc_video_context *vctx,
+                   const char *dma_heap, unsigned count,
+                   const video_format_t *restrict fmt)
+{
+    static atomic_uint_fast64_t next_id = 0;
+
+    const uint32_t *drm_formats = GetDrmFormats(fmt->i_chroma);
+    const vlc_chroma_description_t *dsc =
+        vlc_fourcc_GetChromaDescription(fmt->i_chroma);
+    if (drm_formats == NULL || dsc == NULL)
+        return NULL;
+
+    char *path;
+    if (asprintf(&path, "/dev/dma_heap/%s", dma_heap) < 0)
+        return NULL;
+    int heap_fd = vlc_open(path, O_RDWR);
+    if (heap_fd < 0)
+    {
+        msg_Err(o, "cannot open %s: %s", path, vlc_strerror_c(errno));
+        free(path);
+        return NULL;
+    }
+    free(path);
+
+    /* Same layout for every picture, with all planes in one buffer */
+    const unsigned width = (fmt->i_width + 1) & ~1;
+    const unsigned height = (fmt->i_height + 1) & ~1;
+    picture_resource_t rsc = {
+        .pf_destroy = pool_pic_destroy_cb,
+    };
+    struct vlc_dmabuf_plane planes[PICTURE_PLANE_MAX];
+    size_t size = 0;
+
+    for (unsigned i = 0; i < dsc->plane_count; i++)
+    {
+        const size_t pitch = width * dsc->p[i].w.num / dsc->p[i].w.den
+                           * dsc->pixel_size;
+
+        rsc.p[i].i_pitch = (pitch + DMABUF_PITCH_ALIGN - 1)
+                         & ~(DMABUF_PITCH_ALIGN - 1);
+        rsc.p[i].i_lines = height * dsc->p[i].h.num / dsc->p[i].h.den;
+        planes[i] = (struct vlc_dmabuf_plane) {
+            .drm_format = drm_formats[i],
+            .offset = size,
+            .pitch = rsc.p[i].i_pitch,
+        };
+        size += (size_t) rsc.p[i].i_pitch * rsc.p[i].i_lines;
+    }
+
+    picture_t *pics[count];
+    unsigned i;
+
+    for (i = 0; i < count; i++)
+    {
+        picture_sys_t *p_sys = malloc(sizeof (*p_sys));
+        if (p_sys == NULL)
+            break;
+
+        int fd = dmabuf_Alloc(o, heap_fd, size);
+        if (fd < 0)
+        {
+            free(p_sys);
+            break;
+        }
+
+        p_sys->base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                           fd, 0);
+        if (p_sys->base == MAP_FAILED)
+        {
+            msg_Err(o, "cannot map DMA-BUF: %s", vlc_strerror_c(errno));
+            vlc_close(fd);
+            free(p_sys);
+            break;
+        }
+        p_sys->size = size;
+
+        struct vlc_dmabuf_pic_context *ctx = &p_sys->ctx.ctx;
+        ctx->s = (picture_context_t) {
+            pic_sys_ctx_destroy_cb, pic_ctx_copy_cb,
+            vctx, // it will be held during PicAttachContext
+        };
+        ctx->id = atomic_fetch_add(&next_id, 1);
+        ctx->modifier = VLC_DRM_FORMAT_MOD_LINEAR;
+        ctx->plane_count = dsc->plane_count;
+        for (unsigned j = 0; j < dsc->plane_count; j++)
+        {
+            ctx->planes[j] = planes[j];
+            ctx->planes[j].fd = fd;
+            rsc.p[j].p_pixels = (uint8_t *) p_sys->base + planes[j].offset;
+        }
+        p_sys->ctx.picref = NULL;
+
+        rsc.p_sys = p_sys;
+        pics[i] = picture_NewFromResource(fmt, &rsc);
+        if (pics[i] == NULL)
+        {
+            munmap(p_sys->base, size);
+            vlc_close(fd);
+            free(p_sys);
+            break;
+        }
+    }
+    vlc_close(heap_fd);
+
+    if (i < count)
+        goto error;
+
+    picture_pool_t *pool = picture_pool_New(count, pics);
+    if (pool == NULL)
+        goto error;
+    return pool;
+
+error:
+    while (i > 0)
+        picture_Release(pics[--i]);
+    return NULL;
+}
+
+void
+vlc_dmabuf_PicAttachContext(picture_t *pic)
+{
+    assert(pic->p_sys != NULL);
+    assert(pic->context == NULL);
+
+    picture_sys_t *p_sys = pic->p_sys;
+    p_sys->ctx.picref = pic;
+    pic->context = &p_sys->ctx.ctx.s;
+    vlc_video_context_Hold(pic->context->vctx);
+}
+
+static void
+dmabuf_Sync(picture_t *pic, uint64_t flags)
+{
+    struct vlc_dmabuf_pic_context *ctx = vlc_dmabuf_PicGetContext(pic);
+    assert(ctx != NULL);
+
+    struct dma_buf_sync sync = { .flags = flags | DMA_BUF_SYNC_WRITE };
+    while (ioctl(ctx->planes[0].fd, DMA_BUF_IOCTL_SYNC, &sync) < 0
+        && (errno == EINTR || errno == EAGAIN));
+}
+
+void
+vlc_dmabuf_PicBeginWrite(picture_t *pic)
+{
+    dmabuf_Sync(pic, DMA_BUF_SYNC_START);
+}
+
+void
+vlc_dmabuf_PicEndWrite(picture_t *pic)
+{
+    dmabuf_Sync(pic, DMA_BUF_SYNC_END);
+}
@@ -0,0 +1,93 @@
+/*****************************************************************************
+ * vlc_dmabuf.h: DMA-BUF picture helpers for VLC
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_DMABUF_H
+# define VLC_DMABUF_H
+
+#include <vlc_common.h>
+#include <vlc_picture.h>
+#include <vlc_picture_pool.h>
+
+/* DRM formats, from drm_fourcc.h */
+#define VLC_DRM_FORMAT_R8       VLC_FOURCC('R', '8', ' ', ' ')
+#define VLC_DRM_FORMAT_GR88     VLC_FOURCC('G', 'R', '8', '8')
+#define VLC_DRM_FORMAT_ABGR8888 VLC_FOURCC('A', 'B', '2', '4') /* RGBA bytes */
+#define VLC_DRM_FORMAT_ARGB8888 VLC_FOURCC('A', 'R', '2', '4') /* BGRA bytes */
+
+#define VLC_DRM_FORMAT_MOD_LINEAR 0
+
+/**
+ * DMA-BUF pictures
+ *
+ * The pictures are in a software chroma and their planes are mapped in
+ * p_pixels, so that any consumer can read them. Consumers able to import
+ * DMA-BUF (EGL_EXT_image_dma_buf_import) use the context instead, which
+ * gives one DRM format and buffer per plane.
+ *
+ * The pictures use a VLC_VIDEO_CONTEXT_DMABUF video context, with no
+ * decoder device and no private data.
+ */
+struct vlc_dmabuf_plane
+{
+    int fd;
+    uint32_t drm_format; /* single plane DRM format, as sampled by the GPU */
+    uint32_t offset;
+    uint32_t pitch;
+};
+
+struct vlc_dmabuf_pic_context
+{
+    picture_context_t s;
+    uint64_t id; /* unique for each buffer, to cache the imports */
+    uint64_t modifier;
+    unsigned plane_count;
+    struct vlc_dmabuf_plane planes[PICTURE_PLANE_MAX];
+};
+
+/* Returns the DMA-BUF context of the picture, or NULL if it has none */
+static inline struct vlc_dmabuf_pic_context *
+vlc_dmabuf_PicGetContext(picture_t *pic)
+{
+    if (pic->context == NULL || pic->context->vctx == NULL
+     || vlc_video_context_GetType(pic->context->vctx) != VLC_VIDEO_CONTEXT_DMABUF)
+        return NULL;
+    return container_of(pic->context, struct vlc_dmabuf_pic_context, s);
+}
+
+/* Returns true if DMA-BUF pictures can be allocated in this chroma */
+bool vlc_dmabuf_IsChromaSupported(vlc_fourcc_t chroma);
+
+/* Creates a pool of count pictures
+ *
+ * The buffers are allocated from the heap dma_heap, in /dev/dma_heap.
+ * Pictures from the pool need vlc_dmabuf_PicAttachContext(). */
+picture_pool_t *
+vlc_dmabuf_PoolNew(vlc_object_t *o, vlc_video_context *vctx,
+                   const char *dma_heap, unsigned count,
+                   const video_format_t *restrict fmt);
+
+/* Attaches the DMA-BUF context to a picture got from the pool */
+void vlc_dmabuf_PicAttachContext(picture_t *pic);
+
+/* Brackets the CPU writes to the picture planes, for cached heaps */
+void vlc_dmabuf_PicBeginWrite(picture_t *pic);
+void vlc_dmabuf_PicEndWrite(picture_t *pic);
+
+#endif /* VLC_DMABUF_H */
@@ -75,7 +75,7 @@ vlc_module_end ()
 /* */
 #define MAX_HXXX_SURFACES (16 + 1)
 #define NVDEC_DISPLAY_SURFACES 1
-#define MAX_POOL_SIZE     4 // number of in-flight buffers, if more are needed the decoder waits
+#define MAX_POOL_SIZE     4 // max number of in-flight buffers, if more are needed the decoder waits
 
 #define OUTPUT_WIDTH_ALIGN   16
 
@@ -106,9 +106,14 @@ struct nvdec_ctx {
     size_t                      decoderHeight;
 
     unsigned int                outputPitch;
+    size_t                      outputSize;   ///< size of an output buffer
     nvdec_pool_t                *out_pool;
     nvdec_pool_owner_t          pool_owner;
 
+    /* accounted with decoder_UpdateVideoMemory() */
+    size_t                      decoderMemory;
+    size_t                      outputMemory;
+
     vlc_video_context           *vctx_out;
 };
 
@@ -123,11 +128,31 @@ static void PoolRelease(nvdec_pool_owner_t *owner, void *buffers[], size_t pics_
 {
     nvdec_ctx_t *p_sys = container_of(owner, nvdec_ctx_t, pool_owner);
     for (size_t i=0; i < pics_count; i++)
-        p_sys->devsys->cudaFunctions->cuMemFree( (CUdeviceptr)buffers[i] );
+        if (buffers[i] != NULL)
+            p_sys->devsys->cudaFunctions->cuMemFree( (CUdeviceptr)buffers[i] );
     cuvid_free_functions(&p_sys->cuvidFunctions);
     free(p_sys);
 }
 
+static void * PoolAllocBuffer(nvdec_pool_owner_t *owner)
+{
+    nvdec_ctx_t *p_sys = container_of(owner, nvdec_ctx_t, pool_owner);
+    decoder_t *p_dec = owner->sys;
+    CUdeviceptr outputDevicePtr = 0;
+
+    int ret = CALL_CUDA_DEC(cuCtxPushCurrent, p_sys->devsys->cuCtx);
+    if (ret != VLC_SUCCESS)
+        return NULL;
+    ret = CALL_CUDA_DEC(cuMemAlloc, &outputDevicePtr, p_sys->outputSize);
+    CALL_CUDA_DEC(cuCtxPopCurrent, NULL);
+    if (ret != VLC_SUCCESS)
+        return NULL;
+
+    p_sys->outputMemory += p_sys->outputSize;
+    decoder_UpdateVideoMemory(p_dec, p_sys->outputSize);
+    return (void*)(uintptr_t)outputDevicePtr;
+}
+
 static void nvdec_picture_CtxDestroy(struct picture_context_t *picctx)
 {
     pic_pool_context_nvdec_t *srcpic = NVDEC_PICPOOLCTX_FROM_PICCTX(picctx);
@@ -264,6 +289,8 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
         {
             nvdec_pool_Release(p_sys->out_pool);
             p_sys->out_pool = NULL;
+            decoder_UpdateVideoMemory(p_dec, -(ptrdiff_t)p_sys->outputMemory);
+            p_sys->outputMemory = 0;
         }
     }
 
@@ -284,8 +311,17 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
     {
         CALL_CUVID(cuvidDestroyDecoder, p_sys->cudecoder);
         p_sys->cudecoder = NULL;
+        decoder_UpdateVideoMemory(p_dec, -(ptrdiff_t)p_sys->decoderMemory);
+        p_sys->decoderMemory = 0;
     }
 
+    /* allocate the decoding surfaces the stream needs rather than the worst
+     * case of the codec, the parser is told with the returned value */
+    unsigned nb_surface = p_sys->i_nb_surface;
+    if (p_format->min_num_decode_surfaces > 0)
+        nb_surface = __MIN(nb_surface, p_format->min_num_decode_surfaces
+                                       + NVDEC_DISPLAY_SURFACES);
+
     CUVIDDECODECREATEINFO dparams = {
         .ulWidth             = p_format->coded_width,
         .ulHeight            = p_format->coded_height,
@@ -295,7 +331,7 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
         .OutputFormat        = MapSurfaceFmt(p_dec->fmt_out.video.i_chroma),
         .CodecType           = p_format->codec,
         .ChromaFormat        = p_format->chroma_format,
-        .ulNumDecodeSurfaces = p_sys->i_nb_surface,
+        .ulNumDecodeSurfaces = nb_surface,
         .ulNumOutputSurfaces = 1,
         .DeinterlaceMode     = p_sys->deintMode
     };
@@ -303,6 +339,16 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
     if (ret != VLC_SUCCESS)
         goto cuda_error;
 
+    size_t surfaceSize = (size_t)p_format->coded_width * p_format->coded_height;
+    if (p_format->bit_depth_luma_minus8 > 0)
+        surfaceSize *= 2;
+    if (p_format->chroma_format == cudaVideoChromaFormat_444)
+        surfaceSize *= 3;
+    else
+        surfaceSize += surfaceSize / 2;
+    p_sys->decoderMemory = nb_surface * surfaceSize;
+    decoder_UpdateVideoMemory(p_dec, p_sys->decoderMemory);
+
     // ensure the output surfaces have the same pitch so copies can work properly
     if ( is_nvdec_opaque(p_dec->fmt_out.video.i_chroma) )
     {
@@ -333,42 +379,14 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
                 vlc_assert_unreachable();
         }
 
-        ret = CALL_CUDA_DEC(cuCtxPushCurrent, p_sys->devsys->cuCtx);
-        if (ret != CUDA_SUCCESS)
-            goto cuda_error;
-
-        CUdeviceptr outputDevicePtr[MAX_POOL_SIZE];
-        for (size_t i=0; i < ARRAY_SIZE(outputDevicePtr); i++)
-        {
-            ret = CALL_CUDA_DEC(cuMemAlloc,
-                                &outputDevicePtr[i],
-                                ByteWidth * Height);
-            if (ret != CUDA_SUCCESS || outputDevicePtr[i] == 0)
-            {
-                while (i)
-                    CALL_CUDA_DEC(cuMemFree, outputDevicePtr[--i]);
-                outputDevicePtr[0] = 0;
-                break;
-            }
-        }
-
-        p_sys->out_pool = NULL;
-        if (outputDevicePtr[0])
-        {
-            p_sys->pool_owner = (nvdec_pool_owner_t) {
-                p_dec, PoolRelease, PoolAttachPicture,
-            };
-
-            void *bufferPtr[ARRAY_SIZE(outputDevicePtr)];
-            for (size_t i=0; i<ARRAY_SIZE(outputDevicePtr); i++)
-                bufferPtr[i] = (void*)(uintptr_t)outputDevicePtr[i];
-            p_sys->out_pool = nvdec_pool_Create(&p_sys->pool_owner,
-                                                &p_dec->fmt_out.video, p_sys->vctx_out,
-                                                bufferPtr, ARRAY_SIZE(outputDevicePtr));
-            if (p_sys->out_pool == NULL)
-                PoolRelease(&p_sys->pool_owner, bufferPtr, ARRAY_SIZE(outputDevicePtr));
-        }
-        CALL_CUDA_DEC(cuCtxPopCurrent, NULL);
+        // the output buffers are allocated when the pool needs them
+        p_sys->outputSize = (size_t)ByteWidth * Height;
+        p_sys->pool_owner = (nvdec_pool_owner_t) {
+            p_dec, PoolRelease, PoolAttachPicture, PoolAllocBuffer,
+        };
+        p_sys->out_pool = nvdec_pool_Create(&p_sys->pool_owner,
+                                            &p_dec->fmt_out.video, p_sys->vctx_out,
+                                            MAX_POOL_SIZE);
         if (p_sys->out_pool == NULL)
             goto cuda_error;
     }
@@ -378,7 +396,7 @@ static int CUDAAPI HandleVideoSequence(void *p_opaque, CUVIDEOFORMAT *p_format)
     CALL_CUDA_DEC(cuCtxPopCurrent, NULL);
 
     ret = decoder_UpdateVideoOutput(p_dec, p_sys->vctx_out);
-    return (ret == VLC_SUCCESS);
+    return ret == VLC_SUCCESS ? (int)nb_surface : 0;
 
 cuda_error:
     CALL_CUDA_DEC(cuCtxPopCurrent, NULL);
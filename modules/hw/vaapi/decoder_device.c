@@ -51,6 +51,7 @@ struct vaapi_instance;
 
 struct vaapi_instance
 {
+    struct vlc_vaapi_surface_cache cache; /* must be first */
     VADisplay dpy;
     VANativeDisplay native;
     vaapi_native_destroy_cb native_destroy_cb;
@@ -79,6 +80,7 @@ vaapi_InitializeInstance(vlc_object_t *o, VADisplay dpy,
     inst->dpy = dpy;
     inst->native = native;
     inst->native_destroy_cb = native_destroy_cb;
+    vlc_vaapi_SurfaceCacheInit(&inst->cache);
 
     return inst;
 error:
@@ -91,6 +93,7 @@ error:
 static void
 vaapi_DestroyInstance(struct vaapi_instance *inst)
 {
+    vlc_vaapi_SurfaceCacheClean(&inst->cache, inst->dpy);
     vaTerminate(inst->dpy);
     if (inst->native != NULL && inst->native_destroy_cb != NULL)
         inst->native_destroy_cb(inst->native);
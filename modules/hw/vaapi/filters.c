@@ -1122,6 +1122,173 @@ error:
     return VLC_EGENERIC;
 }
 
+/*******************
+ * Scale functions *
+ *******************/
+
+static picture_t *
+Scale(filter_t * filter, picture_t * src)
+{
+    filter_sys_t *const filter_sys = filter->p_sys;
+    VABufferID          pipeline_buf = VA_INVALID_ID;
+    picture_t *const    dest = picture_pool_Wait(filter_sys->dest_pics);
+    if (!dest)
+        goto ret;
+
+    vlc_vaapi_PicAttachContext(dest);
+    picture_CopyProperties(dest, src);
+
+    /* The source region follows the converter input format, which may be
+     * cropped */
+    const video_format_t *fmt_in = &filter->fmt_in.video;
+    const video_format_t *fmt_out = &filter->fmt_out.video;
+    VARectangle const   src_region = {
+        .x = fmt_in->i_x_offset, .y = fmt_in->i_y_offset,
+        .width = fmt_in->i_visible_width, .height = fmt_in->i_visible_height,
+    };
+    VARectangle const   dest_region = {
+        .x = fmt_out->i_x_offset, .y = fmt_out->i_y_offset,
+        .width = fmt_out->i_visible_width, .height = fmt_out->i_visible_height,
+    };
+
+    if (vlc_vaapi_BeginPicture(VLC_OBJECT(filter),
+                               filter_sys->va.dpy, filter_sys->va.ctx,
+                               vlc_vaapi_PicGetSurface(dest)))
+        goto error;
+
+    VAProcPipelineParameterBuffer *     pipeline_params;
+
+    pipeline_buf =
+        vlc_vaapi_CreateBuffer(VLC_OBJECT(filter),
+                               filter_sys->va.dpy, filter_sys->va.ctx,
+                               VAProcPipelineParameterBufferType,
+                               sizeof(*pipeline_params), 1, NULL);
+    if (pipeline_buf == VA_INVALID_ID)
+        goto error;
+
+    if (vlc_vaapi_MapBuffer(VLC_OBJECT(filter), filter_sys->va.dpy,
+                            pipeline_buf, (void **)&pipeline_params))
+        goto error;
+
+    *pipeline_params = (typeof(*pipeline_params)){0};
+    pipeline_params->surface = vlc_vaapi_PicGetSurface(src);
+    pipeline_params->surface_region = &src_region;
+    pipeline_params->output_region = &dest_region;
+    pipeline_params->filter_flags = VA_FILTER_SCALING_DEFAULT;
+
+    if (vlc_vaapi_UnmapBuffer(VLC_OBJECT(filter),
+                              filter_sys->va.dpy, pipeline_buf))
+        goto error;
+
+    if (vlc_vaapi_RenderPicture(VLC_OBJECT(filter),
+                                filter_sys->va.dpy, filter_sys->va.ctx,
+                                &pipeline_buf, 1))
+        goto error;
+
+    if (vlc_vaapi_EndPicture(VLC_OBJECT(filter),
+                             filter_sys->va.dpy, filter_sys->va.ctx))
+        goto error;
+
+ret:
+    picture_Release(src);
+    return dest;
+
+error:
+    if (pipeline_buf != VA_INVALID_ID)
+        vlc_vaapi_DestroyBuffer(VLC_OBJECT(filter),
+                                filter_sys->va.dpy, pipeline_buf);
+    picture_Release(dest);
+    picture_Release(src);
+    return NULL;
+}
+
+static void
+CloseScale(filter_t *filter)
+{
+    filter_sys_t *const filter_sys = filter->p_sys;
+    vlc_object_t * obj = VLC_OBJECT(filter);
+
+    picture_pool_Release(filter_sys->dest_pics);
+    vlc_vaapi_DestroyContext(obj, filter_sys->va.dpy, filter_sys->va.ctx);
+    vlc_vaapi_DestroyConfig(obj, filter_sys->va.dpy, filter_sys->va.conf);
+    vlc_decoder_device_Release(filter_sys->va.dec_device);
+    vlc_video_context_Release(filter->vctx_out);
+    free(filter_sys);
+}
+
+static const struct vlc_filter_operations Scale_ops = {
+    .filter_video = Scale, .close = CloseScale,
+};
+
+/* Resizes the surfaces with the video processor, so that only the small
+ * pictures need be read back (thumbnails, snapshots) */
+static int
+OpenScale(filter_t *filter)
+{
+    const video_format_t *fmt_in = &filter->fmt_in.video;
+    const video_format_t *fmt_out = &filter->fmt_out.video;
+
+    if (filter->vctx_in == NULL ||
+        vlc_video_context_GetType(filter->vctx_in) != VLC_VIDEO_CONTEXT_VAAPI)
+        return VLC_EGENERIC;
+    if (!vlc_vaapi_IsChromaOpaque(fmt_in->i_chroma)
+     || fmt_in->i_chroma != fmt_out->i_chroma
+     || fmt_in->orientation != fmt_out->orientation)
+        return VLC_EGENERIC;
+    if (fmt_in->i_visible_width == fmt_out->i_visible_width
+     && fmt_in->i_visible_height == fmt_out->i_visible_height)
+        return VLC_EGENERIC;
+
+    filter_sys_t *filter_sys = calloc(1, sizeof(*filter_sys));
+    if (!filter_sys)
+        return VLC_ENOMEM;
+
+    filter_sys->va.conf = VA_INVALID_ID;
+    filter_sys->va.ctx = VA_INVALID_ID;
+    filter_sys->va.buf = VA_INVALID_ID;
+    filter_sys->va.dec_device = vlc_video_context_HoldDevice(filter->vctx_in);
+    assert(filter_sys->va.dec_device);
+    filter_sys->va.dpy = filter_sys->va.dec_device->opaque;
+
+    filter_sys->dest_pics =
+        vlc_vaapi_PoolNew(VLC_OBJECT(filter), filter->vctx_in,
+                          filter_sys->va.dpy, DEST_PICS_POOL_SZ,
+                          &filter_sys->va.surface_ids, fmt_out);
+    if (!filter_sys->dest_pics)
+        goto error;
+
+    filter_sys->va.conf =
+        vlc_vaapi_CreateConfigChecked(VLC_OBJECT(filter), filter_sys->va.dpy,
+                                      VAProfileNone, VAEntrypointVideoProc,
+                                      fmt_out->i_chroma);
+    if (filter_sys->va.conf == VA_INVALID_ID)
+        goto error;
+
+    filter_sys->va.ctx =
+        vlc_vaapi_CreateContext(VLC_OBJECT(filter),
+                                filter_sys->va.dpy, filter_sys->va.conf,
+                                fmt_out->i_width, fmt_out->i_height,
+                                0, filter_sys->va.surface_ids,
+                                DEST_PICS_POOL_SZ);
+    if (filter_sys->va.ctx == VA_INVALID_ID)
+        goto error;
+
+    filter->p_sys = filter_sys;
+    filter->ops = &Scale_ops;
+    filter->vctx_out = vlc_video_context_Hold(filter->vctx_in);
+    return VLC_SUCCESS;
+
+error:
+    if (filter_sys->va.conf != VA_INVALID_ID)
+        vlc_vaapi_DestroyConfig(VLC_OBJECT(filter),
+                                filter_sys->va.dpy, filter_sys->va.conf);
+    if (filter_sys->dest_pics)
+        picture_pool_Release(filter_sys->dest_pics);
+    vlc_decoder_device_Release(filter_sys->va.dec_device);
+    free(filter_sys);
+    return VLC_EGENERIC;
+}
+
 /*********************
  * Module descriptor *
  *********************/
@@ -1154,4 +1321,7 @@ vlc_module_begin()
 
     add_submodule()
     set_callback_video_converter(vlc_vaapi_OpenChroma, 10)
+
+    add_submodule()
+    set_callback_video_converter(OpenScale, 10)
 vlc_module_end()
@@ -60,6 +60,73 @@ vlc_chroma_to_vaapi(int i_vlc_chroma, unsigned *va_rt_format, int *va_fourcc)
     }
 }
 
+/*****************
+ * Surface cache *
+ *****************/
+
+void
+vlc_vaapi_SurfaceCacheInit(struct vlc_vaapi_surface_cache *cache)
+{
+    vlc_mutex_init(&cache->lock);
+    cache->count = 0;
+}
+
+void
+vlc_vaapi_SurfaceCacheClean(struct vlc_vaapi_surface_cache *cache,
+                            VADisplay dpy)
+{
+    for (size_t i = 0; i < cache->count; i++)
+        vaDestroySurfaces(dpy, &cache->entries[i].surface, 1);
+    cache->count = 0;
+}
+
+unsigned
+vlc_vaapi_SurfaceCacheTake(struct vlc_vaapi_surface_cache *cache,
+                           int i_chroma, unsigned width, unsigned height,
+                           VASurfaceID *surfaces, unsigned count)
+{
+    unsigned taken = 0;
+
+    vlc_mutex_lock(&cache->lock);
+    for (size_t i = 0; i < cache->count && taken < count; )
+    {
+        if (cache->entries[i].i_chroma != i_chroma
+         || cache->entries[i].width != width
+         || cache->entries[i].height != height)
+        {
+            i++;
+            continue;
+        }
+        surfaces[taken++] = cache->entries[i].surface;
+        cache->entries[i] = cache->entries[--cache->count];
+    }
+    vlc_mutex_unlock(&cache->lock);
+    return taken;
+}
+
+void
+vlc_vaapi_SurfaceCachePut(struct vlc_vaapi_surface_cache *cache,
+                          VADisplay dpy, int i_chroma,
+                          unsigned width, unsigned height,
+                          const VASurfaceID *surfaces, unsigned count)
+{
+    unsigned kept = 0;
+
+    vlc_mutex_lock(&cache->lock);
+    for (; kept < count && cache->count < ARRAY_SIZE(cache->entries); kept++)
+    {
+        cache->entries[cache->count].surface = surfaces[kept];
+        cache->entries[cache->count].i_chroma = i_chroma;
+        cache->entries[cache->count].width = width;
+        cache->entries[cache->count].height = height;
+        cache->count++;
+    }
+    vlc_mutex_unlock(&cache->lock);
+
+    if (kept < count)
+        vaDestroySurfaces(dpy, (VASurfaceID *)&surfaces[kept], count - kept);
+}
+
 /**************************
  * VAAPI create & destroy *
  **************************/
@@ -199,6 +199,59 @@ vlc_vaapi_IsChromaOpaque(int i_vlc_chroma)
 
 void vlc_chroma_to_vaapi(int i_vlc_chroma, unsigned *va_rt_format, int *va_fourcc);
 
+/*****************
+ * Surface cache *
+ *****************/
+
+#define VLC_VAAPI_SURFACE_CACHE_SIZE 64
+
+/* Decoder surfaces kept by a VAAPI decoder device once their decoder is
+ * closed, so that the next decoder of the same format on the same device
+ * reuses them instead of allocating new ones. */
+struct vlc_vaapi_surface_cache
+{
+    vlc_mutex_t lock;
+    size_t count;
+    struct
+    {
+        VASurfaceID surface;
+        int i_chroma;
+        unsigned width;
+        unsigned height;
+    } entries[VLC_VAAPI_SURFACE_CACHE_SIZE];
+};
+
+/* Gets the surface cache of a VAAPI decoder device, the sys of such devices
+ * starts with it. */
+static inline struct vlc_vaapi_surface_cache *
+vlc_vaapi_GetSurfaceCache(vlc_decoder_device *device)
+{
+    return device->type == VLC_DECODER_DEVICE_VAAPI ? device->sys : NULL;
+}
+
+void
+vlc_vaapi_SurfaceCacheInit(struct vlc_vaapi_surface_cache *cache);
+
+/* Destroys the cached surfaces, before the display is terminated. */
+void
+vlc_vaapi_SurfaceCacheClean(struct vlc_vaapi_surface_cache *cache,
+                            VADisplay dpy);
+
+/* Takes up to 'count' cached surfaces of the given chroma and size, returns
+ * the amount of surfaces taken. */
+unsigned
+vlc_vaapi_SurfaceCacheTake(struct vlc_vaapi_surface_cache *cache,
+                           int i_chroma, unsigned width, unsigned height,
+                           VASurfaceID *surfaces, unsigned count);
+
+/* Gives surfaces not used anymore to the cache, the ones that do not fit are
+ * destroyed. */
+void
+vlc_vaapi_SurfaceCachePut(struct vlc_vaapi_surface_cache *cache,
+                          VADisplay dpy, int i_chroma,
+                          unsigned width, unsigned height,
+                          const VASurfaceID *surfaces, unsigned count);
+
 #if VA_CHECK_VERSION(1, 1, 0)
 int
 vlc_vaapi_ExportSurfaceHandle(vlc_object_t *o,
@@ -655,17 +655,141 @@ int vlclua_add_modules_path( lua_State *L, const char *psz_filename )
     return 0;
 }
 
+/*****************************************************************************
+ * Compiled chunks cache
+ *
+ * A probe (playlist, meta, art...) loads every script of its directory in a
+ * fresh state, for each input. The bytecode of the local scripts is kept, so
+ * that only the first load reads and parses the file. An entry is checked
+ * against the file size and modification time before use. The cache lives as
+ * long as the plugin: there is one entry per script at most.
+ *****************************************************************************/
+struct vlclua_chunk
+{
+    struct vlclua_chunk *next;
+    time_t mtime;
+    off_t size;
+    size_t len;
+    char *data;
+    char name[]; /* "@" and the path, as luaL_loadfile() names it */
+};
+
+static vlc_mutex_t chunks_lock = VLC_STATIC_MUTEX;
+static struct vlclua_chunk *chunks = NULL;
+
+struct vlclua_dump
+{
+    char *data;
+    size_t len;
+};
+
+static int vlclua_dump_write( lua_State *L, const void *p, size_t len,
+                              void *opaque )
+{
+    struct vlclua_dump *dump = opaque;
+    char *data = realloc( dump->data, dump->len + len );
+
+    (void) L;
+    if( unlikely(data == NULL) )
+        return 1;
+    memcpy( data + dump->len, p, len );
+    dump->data = data;
+    dump->len += len;
+    return 0;
+}
+
+static struct vlclua_chunk *vlclua_chunk_find( const char *path )
+{
+    for( struct vlclua_chunk *chunk = chunks; chunk; chunk = chunk->next )
+        if( !strcmp( chunk->name + 1, path ) )
+            return chunk;
+    return NULL;
+}
+
+/** Replacement for luaL_loadfile, through the compiled chunks cache */
+static int vlclua_loadfile( lua_State *L, const char *path )
+{
+    struct stat st;
+
+    /* the path is in the locale encoding, as luaL_loadfile() expects */
+    if( stat( path, &st ) )
+        return luaL_loadfile( L, path ); /* for the error message */
+
+    vlc_mutex_lock( &chunks_lock );
+    struct vlclua_chunk *chunk = vlclua_chunk_find( path );
+    if( chunk != NULL && chunk->mtime == st.st_mtime
+     && chunk->size == st.st_size )
+    {
+        int ret = luaL_loadbuffer( L, chunk->data, chunk->len, chunk->name );
+        vlc_mutex_unlock( &chunks_lock );
+        return ret;
+    }
+    vlc_mutex_unlock( &chunks_lock );
+
+    int ret = luaL_loadfile( L, path );
+    if( ret )
+        return ret;
+
+    /* Keep the debug information, for the error messages */
+    struct vlclua_dump dump = { NULL, 0 };
+#if LUA_VERSION_NUM >= 503
+    if( lua_dump( L, vlclua_dump_write, &dump, 0 ) )
+#else
+    if( lua_dump( L, vlclua_dump_write, &dump ) )
+#endif
+    {
+        free( dump.data );
+        return 0; /* not cached, but loaded anyway */
+    }
+
+    vlc_mutex_lock( &chunks_lock );
+    chunk = vlclua_chunk_find( path );
+    if( chunk == NULL )
+    {
+        size_t pathlen = strlen( path );
+
+        chunk = malloc( sizeof (*chunk) + pathlen + 2 );
+        if( unlikely(chunk == NULL) )
+        {
+            vlc_mutex_unlock( &chunks_lock );
+            free( dump.data );
+            return 0;
+        }
+        chunk->name[0] = '@';
+        memcpy( chunk->name + 1, path, pathlen + 1 );
+        chunk->data = NULL;
+        chunk->next = chunks;
+        chunks = chunk;
+    }
+    /* the entry is stale, or the script was loaded concurrently */
+    free( chunk->data );
+    chunk->data = dump.data;
+    chunk->len = dump.len;
+    chunk->mtime = st.st_mtime;
+    chunk->size = st.st_size;
+    vlc_mutex_unlock( &chunks_lock );
+    return 0;
+}
+
+static int vlclua_dolocalfile( lua_State *L, const char *path )
+{
+    int ret = vlclua_loadfile( L, path );
+    if( !ret )
+        ret = lua_pcall( L, 0, LUA_MULTRET, 0 );
+    return ret;
+}
+
 /** Replacement for luaL_dofile, using VLC's input capabilities */
 int vlclua_dofile( vlc_object_t *p_this, lua_State *L, const char *curi )
 {
     char *uri = ToLocaleDup( curi );
     if( !strstr( uri, "://" ) ) {
-        int ret = luaL_dofile( L, uri );
+        int ret = vlclua_dolocalfile( L, uri );
         free( uri );
         return ret;
     }
     if( !strncasecmp( uri, "file://", 7 ) ) {
-        int ret = luaL_dofile( L, uri + 7 );
+        int ret = vlclua_dolocalfile( L, uri + 7 );
         free( uri );
         return ret;
     }
@@ -42,11 +42,18 @@
 #include <gnutls/gnutls.h>
 #include <gnutls/x509.h>
 
+/* Kernel TLS offload, see gnutls_transport_is_ktls_enabled() */
+#if GNUTLS_VERSION_NUMBER >= 0x030703
+# include <gnutls/socket.h>
+# define HAVE_GNUTLS_KTLS 1
+#endif
+
 typedef struct vlc_tls_gnutls
 {
     vlc_tls_t tls;
     gnutls_session_t session;
     vlc_object_t *obj;
+    int fd; /**< socket given to GnuTLS, or -1 if none */
 } vlc_tls_gnutls_t;
 
 static void gnutls_Banner(vlc_object_t *obj)
@@ -130,11 +137,30 @@ static ssize_t vlc_gnutls_writev(gnutls_transport_ptr_t ptr,
 static int gnutls_GetFD(vlc_tls_t *tls, short *restrict events)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
+
+    if (priv->fd != -1)
+        return priv->fd;
+
     vlc_tls_t *sock = gnutls_transport_get_ptr(priv->session);
 
     return vlc_tls_GetPollFD(sock, events);
 }
 
+static int gnutls_GetRawFD(vlc_tls_t *tls, bool write)
+{
+#ifdef HAVE_GNUTLS_KTLS
+    vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
+
+    if (priv->fd != -1
+     && (gnutls_transport_is_ktls_enabled(priv->session)
+         & (write ? GNUTLS_KTLS_SEND : GNUTLS_KTLS_RECV)))
+        return priv->fd;
+#else
+    (void) tls; (void) write;
+#endif
+    return -1;
+}
+
 static ssize_t gnutls_Recv(vlc_tls_t *tls, struct iovec *iov, unsigned count)
 {
     vlc_tls_gnutls_t *priv = (vlc_tls_gnutls_t *)tls;
@@ -218,6 +244,7 @@ static const struct vlc_tls_operations gnutls_ops =
     gnutls_Send,
     gnutls_Shutdown,
     gnutls_Close,
+    gnutls_GetRawFD,
 };
 
 static vlc_tls_gnutls_t *gnutls_SessionOpen(vlc_object_t *obj, int type,
@@ -235,6 +262,15 @@ static vlc_tls_gnutls_t *gnutls_SessionOpen(vlc_object_t *obj, int type,
 
     type |= GNUTLS_NONBLOCK | GNUTLS_ENABLE_FALSE_START;
 
+    /* The kernel can only take over the records if GnuTLS owns the socket
+     * itself, not a callback to the underlying stream. Whether it does is
+     * then up to the GnuTLS system configuration. */
+    int fd = -1;
+#ifdef HAVE_GNUTLS_KTLS
+    if (var_InheritBool(obj, "gnutls-ktls"))
+        fd = vlc_tls_GetRawFD(sock, true);
+#endif
+
     val = gnutls_init(&session, type);
     if (val != 0)
     {
@@ -289,12 +325,18 @@ static vlc_tls_gnutls_t *gnutls_SessionOpen(vlc_object_t *obj, int type,
         free (protv);
     }
 
-    gnutls_transport_set_ptr(session, sock);
-    gnutls_transport_set_vec_push_function(session, vlc_gnutls_writev);
-    gnutls_transport_set_pull_function(session, vlc_gnutls_read);
+    if (fd != -1)
+        gnutls_transport_set_int(session, fd);
+    else
+    {
+        gnutls_transport_set_ptr(session, sock);
+        gnutls_transport_set_vec_push_function(session, vlc_gnutls_writev);
+        gnutls_transport_set_pull_function(session, vlc_gnutls_read);
+    }
 
     priv->session = session;
     priv->obj = obj;
+    priv->fd = fd;
 
     vlc_tls_t *tls = &priv->tls;
 
@@ -736,6 +778,12 @@ error:
 #define PRIORITIES_LONGTEXT N_("Ciphers, key exchange methods, " \
     "hash functions and compression methods can be selected. " \
     "Refer to GNU TLS documentation for detailed syntax.")
+#define KTLS_TEXT N_("Kernel TLS offload")
+#define KTLS_LONGTEXT N_( \
+    "Let the operating system kernel encrypt and decrypt the TLS records " \
+    "when it and the GnuTLS configuration allow it, so that files can be " \
+    "sent without copies.")
+
 static const char *const priorities_values[] = {
     "PERFORMANCE",
     "NORMAL",
@@ -763,6 +811,9 @@ vlc_module_begin ()
     add_string ("gnutls-priorities", "NORMAL", PRIORITIES_TEXT,
                 PRIORITIES_LONGTEXT, false)
         change_string_list (priorities_values, priorities_text)
+#ifdef HAVE_GNUTLS_KTLS
+    add_bool("gnutls-ktls", true, KTLS_TEXT, KTLS_LONGTEXT, true)
+#endif
 #ifdef ENABLE_SOUT
     add_submodule ()
         set_description( N_("GNU TLS server") )
@@ -24,10 +24,190 @@
 
 #include "medialibrary.h"
 
+#include <algorithm>
+#include <cctype>
+#include <vector>
+
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_meta.h>
+#include <vlc_modules.h>
+#include <vlc_stream.h>
+
 MetadataExtractor::MetadataExtractor( vlc_object_t* parent )
     : m_currentCtx( nullptr )
     , m_obj( parent )
 {
+    m_fastExtraction = var_InheritBool( parent, "ml-fast-extraction" );
+}
+
+namespace
+{
+
+/* Files whose tags and track are read from the headers only */
+bool isAudioFile( const std::string& mrl )
+{
+    static const char* const extensions[] = {
+        "aac", "aif", "aiff", "ape", "flac", "m4a", "mka", "mp2", "mp3",
+        "mpc", "oga", "ogg", "opus", "tta", "wav", "wma", "wv",
+    };
+
+    auto dot = mrl.rfind( '.' );
+    if ( dot == std::string::npos || mrl.find( '/', dot ) != std::string::npos )
+        return false;
+
+    std::string ext = mrl.substr( dot + 1 );
+    std::transform( ext.begin(), ext.end(), ext.begin(),
+                    []( unsigned char c ) { return std::tolower( c ); } );
+    return std::any_of( std::begin( extensions ), std::end( extensions ),
+                        [&ext]( const char* e ) { return ext == e; } );
+}
+
+/* Output recording the track formats, the data is dropped without being
+ * decoded */
+struct FormatsOut
+{
+    struct Wrapper
+    {
+        es_out_t out;
+        FormatsOut* owner;
+    } wrapper;
+    std::vector<es_format_t*> formats;
+
+    static es_out_id_t* add( es_out_t* out, input_source_t*,
+                             const es_format_t* fmt )
+    {
+        auto self = container_of( out, Wrapper, out )->owner;
+        auto copy = static_cast<es_format_t*>( malloc( sizeof( es_format_t ) ) );
+        if ( copy == nullptr )
+            return nullptr;
+        es_format_Copy( copy, fmt );
+        self->formats.push_back( copy );
+        return reinterpret_cast<es_out_id_t*>( copy );
+    }
+
+    static int send( es_out_t*, es_out_id_t*, block_t* block )
+    {
+        block_Release( block );
+        return VLC_SUCCESS;
+    }
+
+    static void del( es_out_t*, es_out_id_t* )
+    {
+    }
+
+    static int control( es_out_t*, input_source_t*, int, va_list )
+    {
+        return VLC_EGENERIC;
+    }
+
+    static void destroy( es_out_t* )
+    {
+    }
+
+    FormatsOut()
+    {
+        static const struct es_out_callbacks cbs = {
+            add, send, del, control, destroy, nullptr, nullptr,
+        };
+        wrapper.out.cbs = &cbs;
+        wrapper.owner = this;
+    }
+
+    ~FormatsOut()
+    {
+        for ( auto fmt : formats )
+        {
+            es_format_Clean( fmt );
+            free( fmt );
+        }
+    }
+};
+
+} /* anonymous namespace */
+
+/*
+ * Reads the tags, duration and tracks of a file without an input thread nor
+ * decoders: the demuxer is only opened, and the meta readers run from the
+ * calling thread.
+ */
+bool MetadataExtractor::extractFast( input_item_t* inputItem )
+{
+    auto stream = vlc::wrap_cptr( vlc_stream_NewURL( m_obj, inputItem->psz_uri ),
+                                  &vlc_stream_Delete );
+    if ( stream == nullptr )
+        return false;
+
+    FormatsOut out;
+    auto demux = vlc::wrap_cptr( demux_New( m_obj, "any", stream.get(),
+                                            &out.wrapper.out ),
+                                 &demux_Delete );
+    if ( demux == nullptr )
+        return false;
+
+    /* Some demuxers only declare their tracks with the first packets */
+    for ( int i = 0; i < 4 && out.formats.empty(); ++i )
+        if ( demux_Demux( demux.get() ) != VLC_DEMUXER_SUCCESS )
+            break;
+    if ( out.formats.empty() )
+        return false;
+
+    vlc_tick_t length;
+    if ( demux_Control( demux.get(), DEMUX_GET_LENGTH, &length ) != VLC_SUCCESS )
+        length = INPUT_DURATION_UNSET;
+
+    auto meta = vlc::wrap_cptr( vlc_meta_New(), &vlc_meta_Delete );
+    if ( meta == nullptr )
+        return false;
+
+    bool hasMeta = demux_Control( demux.get(), DEMUX_GET_META,
+                                  meta.get() ) == VLC_SUCCESS;
+    bool hasUnsupported;
+    if ( demux_Control( demux.get(), DEMUX_HAS_UNSUPPORTED_META,
+                        &hasUnsupported ) != VLC_SUCCESS )
+        hasUnsupported = true;
+    demux.reset();
+    stream.reset();
+
+    /* Same as the input: the meta readers complete the demuxer tags */
+    if ( !hasMeta || hasUnsupported )
+    {
+        auto demuxMeta = static_cast<demux_meta_t*>(
+            vlc_object_create( m_obj, sizeof( demux_meta_t ) ) );
+        if ( demuxMeta != nullptr )
+        {
+            demuxMeta->p_item = inputItem;
+            module_t* reader = module_need( demuxMeta, "meta reader",
+                                            nullptr, false );
+            if ( reader != nullptr )
+            {
+                if ( demuxMeta->p_meta != nullptr )
+                {
+                    vlc_meta_Merge( meta.get(), demuxMeta->p_meta );
+                    vlc_meta_Delete( demuxMeta->p_meta );
+                }
+                for ( int i = 0; i < demuxMeta->i_attachments; ++i )
+                    vlc_input_attachment_Release( demuxMeta->attachments[i] );
+                TAB_CLEAN( demuxMeta->i_attachments, demuxMeta->attachments );
+                module_unneed( demuxMeta, reader );
+            }
+            vlc_object_delete( demuxMeta );
+        }
+    }
+
+    vlc_mutex_locker lock( &inputItem->lock );
+    auto es = static_cast<es_format_t**>( realloc( inputItem->es,
+        ( inputItem->i_es + out.formats.size() ) * sizeof( es_format_t* ) ) );
+    if ( es == nullptr )
+        return false;
+    inputItem->es = es;
+    for ( auto fmt : out.formats )
+        inputItem->es[inputItem->i_es++] = fmt;
+    out.formats.clear();
+
+    vlc_meta_Merge( inputItem->p_meta, meta.get() );
+    inputItem->i_duration = length;
+    return true;
 }
 
 void MetadataExtractor::onParserEnded( ParseContext& ctx, int status )
@@ -132,7 +312,8 @@ void MetadataExtractor::addSubtree( ParseContext& ctx, input_item_node_t *root )
     {
         auto it = root->pp_children[i]->p_item;
         auto& subItem = ctx.item.createLinkedItem( it->psz_uri,
-                                                   medialibrary::IFile::Type::Main, i );
+                                                   medialibrary::IFile::Type::Main,
+                                                   ctx.nbSubItems++ );
         populateItem( subItem, it );
     }
 }
@@ -148,6 +329,14 @@ medialibrary::parser::Status MetadataExtractor::run( medialibrary::parser::IItem
     if ( ctx.inputItem == nullptr )
         return medialibrary::parser::Status::Fatal;
 
+    if ( m_fastExtraction &&
+         item.fileType() != medialibrary::IFile::Type::Playlist &&
+         isAudioFile( item.mrl() ) && extractFast( ctx.inputItem.get() ) )
+    {
+        populateItem( item, ctx.inputItem.get() );
+        return medialibrary::parser::Status::Success;
+    }
+
     const input_item_parser_cbs_t cbs = {
         &MetadataExtractor::onParserEnded,
         &MetadataExtractor::onParserSubtreeAdded,
@@ -28,12 +28,20 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <errno.h>
+#include <string.h>
 #include <vector>
 #include <system_error>
+#ifndef _WIN32
+# include <dirent.h>
+# include <sys/stat.h>
+#endif
 #include <vlc_common.h>
+#include <vlc_fs.h>
 #include <vlc_input_item.h>
 #include <vlc_input.h>
 #include <vlc_threads.h>
+#include <vlc_url.h>
 #include <vlc_cxx_helpers.hpp>
 #include <medialibrary/filesystem/Errors.h>
 
@@ -50,6 +58,22 @@ SDDirectory::SDDirectory(const std::string &mrl, SDFileSystemFactory &fs)
 {
     if ( *m_mrl.crbegin() != '/' )
         m_mrl += '/';
+
+    m_runnable.run = &SDDirectory::runPrefetch;
+    m_runnable.userdata = this;
+}
+
+SDDirectory::~SDDirectory()
+{
+    vlc::threads::mutex_locker lock( m_mutex );
+
+    if ( m_state == ReadState::Queued
+      && vlc_executor_Cancel( m_fs.executor(), &m_runnable ) )
+        return;
+
+    /* A worker is reading this directory */
+    while ( m_state == ReadState::Queued || m_state == ReadState::Reading )
+        m_cond.wait( m_mutex );
 }
 
 const std::string &
@@ -61,19 +85,109 @@ SDDirectory::mrl() const
 const std::vector<std::shared_ptr<IFile>> &
 SDDirectory::files() const
 {
-    if (!m_read_done)
-        read();
+    waitRead();
     return m_files;
 }
 
 const std::vector<std::shared_ptr<IDirectory>> &
 SDDirectory::dirs() const
 {
-    if (!m_read_done)
-        read();
+    waitRead();
+
+    /* The discoverer is about to walk the subdirectories: list them ahead,
+     * one level at a time, so that the memory stays bounded */
+    bool prefetch;
+    {
+        vlc::threads::mutex_locker lock( m_mutex );
+        prefetch = !m_children_prefetched;
+        m_children_prefetched = true;
+    }
+    if ( prefetch )
+        for ( const auto &dir : m_dirs )
+            static_cast<SDDirectory *>( dir.get() )->prefetch();
+
     return m_dirs;
 }
 
+void
+SDDirectory::prefetch()
+{
+    vlc_executor_t *executor = m_fs.executor();
+    if ( executor == nullptr )
+        return;
+
+    vlc::threads::mutex_locker lock( m_mutex );
+    if ( m_state != ReadState::Idle )
+        return;
+    m_state = ReadState::Queued;
+    vlc_executor_Submit( executor, &m_runnable );
+}
+
+void
+SDDirectory::runPrefetch( void *data )
+{
+    auto dir = static_cast<SDDirectory *>( data );
+
+    {
+        vlc::threads::mutex_locker lock( dir->m_mutex );
+        assert( dir->m_state == ReadState::Queued );
+        dir->m_state = ReadState::Reading;
+    }
+
+    bool success = true;
+    try
+    {
+        dir->read();
+    }
+    catch ( const std::exception& )
+    {
+        /* The discoverer will read it again, and get the error */
+        success = false;
+    }
+
+    vlc::threads::mutex_locker lock( dir->m_mutex );
+    dir->m_state = success ? ReadState::Done : ReadState::Idle;
+    dir->m_cond.broadcast();
+}
+
+void
+SDDirectory::waitRead() const
+{
+    m_mutex.lock();
+    while ( m_state != ReadState::Done )
+    {
+        if ( m_state == ReadState::Queued
+          && vlc_executor_Cancel( m_fs.executor(), &m_runnable ) )
+            m_state = ReadState::Idle;
+
+        if ( m_state != ReadState::Idle )
+        {
+            m_cond.wait( m_mutex );
+            continue;
+        }
+
+        /* Not read ahead, read it from the calling thread */
+        m_state = ReadState::Reading;
+        m_mutex.unlock();
+        try
+        {
+            read();
+        }
+        catch ( ... )
+        {
+            m_mutex.lock();
+            m_state = ReadState::Idle;
+            m_cond.broadcast();
+            m_mutex.unlock();
+            throw;
+        }
+        m_mutex.lock();
+        m_state = ReadState::Done;
+        m_cond.broadcast();
+    }
+    m_mutex.unlock();
+}
+
 std::shared_ptr<IDevice>
 SDDirectory::device() const
 {
@@ -178,6 +292,89 @@ static bool request_metadata_sync( libvlc_int_t *libvlc, input_item_t *media,
 
 void
 SDDirectory::read() const
+{
+    m_files.clear();
+    m_dirs.clear();
+
+#ifndef _WIN32
+    if ( !strncasecmp( m_mrl.c_str(), "file://", 7 ) )
+    {
+        auto path = vlc::wrap_cptr( vlc_uri2path( m_mrl.c_str() ) );
+        if ( path != nullptr )
+        {
+            readLocal( path.get() );
+            return;
+        }
+    }
+#endif
+    readInput();
+}
+
+void
+SDDirectory::readLocal( const char *path ) const
+{
+#ifndef _WIN32
+    /* List the entries directly rather than through the directory access:
+     * this does not spawn an input, and the entry types usually come with
+     * the directory records, without a stat per entry */
+    auto dir = vlc::wrap_cptr( vlc_opendir( path ), &closedir );
+    if ( dir == nullptr )
+        throw medialibrary::fs::errors::System( errno,
+            "Failed to open directory" );
+
+    struct dirent *ent;
+    while ( ( ent = readdir( dir.get() ) ) != nullptr )
+    {
+        const char *name = ent->d_name;
+        if ( !strcmp( name, "." ) || !strcmp( name, ".." ) )
+            continue;
+
+        bool isDir;
+#ifdef DT_DIR
+        if ( ent->d_type == DT_DIR )
+            isDir = true;
+        else if ( ent->d_type == DT_REG )
+            isDir = false;
+        else
+#endif
+        {
+            /* Unknown type or symbolic link, which are followed like the
+             * directory access does */
+            struct stat st;
+#ifdef HAVE_FSTATAT
+            if ( fstatat( dirfd( dir.get() ), name, &st, 0 ) != 0 )
+                continue;
+#else
+            std::string entryPath = std::string{ path } + DIR_SEP + name;
+            if ( vlc_stat( entryPath.c_str(), &st ) != 0 )
+                continue;
+#endif
+            if ( S_ISDIR( st.st_mode ) )
+                isDir = true;
+            else if ( S_ISREG( st.st_mode ) )
+                isDir = false;
+            else
+                continue;
+        }
+
+        auto encoded = vlc::wrap_cptr( vlc_uri_encode( name ) );
+        if ( encoded == nullptr )
+            throw std::bad_alloc();
+
+        std::string mrl = m_mrl + encoded.get();
+        if ( isDir )
+            m_dirs.push_back( std::make_shared<SDDirectory>( mrl, m_fs ) );
+        else
+            m_files.push_back( std::make_shared<SDFile>( mrl ) );
+    }
+#else
+    VLC_UNUSED( path );
+    vlc_assert_unreachable();
+#endif
+}
+
+void
+SDDirectory::readInput() const
 {
     auto media = vlc::wrap_cptr( input_item_New(m_mrl.c_str(), m_mrl.c_str()),
                                  &input_item_Release );
@@ -203,8 +400,6 @@ SDDirectory::read() const
         else if (type == ITEM_TYPE_FILE)
             m_files.push_back(std::make_shared<SDFile>(mrl));
     }
-
-    m_read_done = true;
 }
 
   } /* namespace medialibrary */
@@ -24,6 +24,8 @@
 #include <medialibrary/filesystem/IDirectory.h>
 #include <medialibrary/filesystem/IFile.h>
 
+#include <vlc_executor.h>
+
 #include "fs.h"
 
 namespace vlc {
@@ -35,19 +37,33 @@ class SDDirectory : public IDirectory
 {
 public:
     explicit SDDirectory(const std::string &mrl, SDFileSystemFactory &fs);
+    ~SDDirectory();
     const std::string &mrl() const override;
     const std::vector<std::shared_ptr<fs::IFile>> &files() const override;
     const std::vector<std::shared_ptr<fs::IDirectory>> &dirs() const override;
     std::shared_ptr<fs::IDevice> device() const override;
     std::shared_ptr<fs::IFile> file( const std::string& mrl ) const override;
 
+    /* Reads the directory from a worker of the file system factory */
+    void prefetch();
+
 private:
+    enum class ReadState { Idle, Queued, Reading, Done };
+
     void read() const;
+    void readLocal(const char *path) const;
+    void readInput() const;
+    void waitRead() const;
+    static void runPrefetch(void *data);
 
     std::string m_mrl;
     SDFileSystemFactory &m_fs;
 
-    mutable bool m_read_done = false;
+    mutable vlc::threads::mutex m_mutex;
+    mutable vlc::threads::condition_variable m_cond;
+    mutable ReadState m_state = ReadState::Idle;
+    mutable bool m_children_prefetched = false;
+    mutable vlc_runnable m_runnable;
     mutable std::vector<std::shared_ptr<fs::IFile>> m_files;
     mutable std::vector<std::shared_ptr<fs::IDirectory>> m_dirs;
     mutable std::shared_ptr<IDevice> m_device;
@@ -49,6 +49,15 @@ SDFileSystemFactory::SDFileSystemFactory(vlc_object_t *parent,
 {
     m_isNetwork = strncasecmp( m_scheme.c_str(), "file://",
                                m_scheme.length() ) != 0;
+
+    int threads = var_InheritInteger( parent, "ml-discovery-threads" );
+    m_executor = threads > 0 ? vlc_executor_New( threads ) : nullptr;
+}
+
+SDFileSystemFactory::~SDFileSystemFactory()
+{
+    if ( m_executor != nullptr )
+        vlc_executor_Delete( m_executor );
 }
 
 std::shared_ptr<fs::IDirectory>
@@ -130,6 +139,12 @@ SDFileSystemFactory::libvlc() const
     return vlc_object_instance(m_parent);
 }
 
+vlc_executor_t *
+SDFileSystemFactory::executor() const
+{
+    return m_executor;
+}
+
 void SDFileSystemFactory::onDeviceMounted(const std::string& uuid,
                                           const std::string& mountpoint,
                                           bool removable)
@@ -25,6 +25,7 @@
 #include <vector>
 #include <vlc_common.h>
 #include <vlc_threads.h>
+#include <vlc_executor.h>
 #include <vlc_cxx_helpers.hpp>
 #include <medialibrary/filesystem/IFileSystemFactory.h>
 #include <medialibrary/IDeviceLister.h>
@@ -47,6 +48,7 @@ public:
     SDFileSystemFactory(vlc_object_t *m_parent,
                         IMediaLibrary* ml,
                         const std::string &scheme);
+    ~SDFileSystemFactory();
 
     std::shared_ptr<IDirectory>
     createDirectory(const std::string &mrl) override;
@@ -81,6 +83,10 @@ public:
     libvlc_int_t *
     libvlc() const;
 
+    /* Workers reading the directories ahead of the discoverer, may be NULL */
+    vlc_executor_t *
+    executor() const;
+
     void
     onDeviceMounted(const std::string& uuid, const std::string& mountpoint, bool removable) override;
 
@@ -102,6 +108,7 @@ private:
     std::shared_ptr<IDeviceLister> m_deviceLister;
     IFileSystemFactoryCb *m_callbacks;
     bool m_isNetwork;
+    vlc_executor_t *m_executor;
 
     vlc::threads::mutex m_mutex;
     std::vector<std::shared_ptr<IDevice>> m_devices;
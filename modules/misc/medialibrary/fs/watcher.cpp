@@ -0,0 +1,391 @@
+/*****************************************************************************
+ * watcher.cpp: Media library file system change watcher
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors, VideoLAN and VideoLabs
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "watcher.h"
+
+#include <errno.h>
+#include <string.h>
+#include <stdexcept>
+#include <vector>
+#ifdef HAVE_SYS_INOTIFY_H
+# include <dirent.h>
+# include <fcntl.h>
+# include <poll.h>
+# include <unistd.h>
+# include <sys/inotify.h>
+# include <sys/stat.h>
+#endif
+#include <vlc_fs.h>
+#include <vlc_url.h>
+
+/* Changes are reported once the entry point is quiet for that long, so that
+ * a copy of a whole album triggers a single reload */
+#define WATCH_DELAY VLC_TICK_FROM_SEC(5)
+
+#ifdef HAVE_SYS_INOTIFY_H
+# define WATCH_EVENTS (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | \
+                       IN_CLOSE_WRITE | IN_ONLYDIR)
+#endif
+
+namespace vlc {
+  namespace medialibrary {
+
+FsWatcher::FsWatcher( vlc_object_t *obj, ChangeCb cb )
+    : m_obj( obj )
+    , m_cb( std::move( cb ) )
+{
+    m_rescanInterval =
+        VLC_TICK_FROM_SEC( var_InheritInteger( obj, "ml-rescan-interval" ) );
+
+#ifdef HAVE_SYS_INOTIFY_H
+    m_inotify = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if ( m_inotify == -1 )
+        msg_Warn( obj, "cannot watch the folders: %s",
+                  vlc_strerror_c( errno ) );
+    else if ( vlc_pipe( m_wakeup ) != 0 )
+    {
+        vlc_close( m_inotify );
+        m_inotify = -1;
+    }
+#endif
+
+    if ( vlc_clone( &m_thread, runThread, this,
+                    VLC_THREAD_PRIORITY_LOW ) != 0 )
+    {
+        if ( m_inotify != -1 )
+        {
+            vlc_close( m_inotify );
+            vlc_close( m_wakeup[0] );
+            vlc_close( m_wakeup[1] );
+        }
+        throw std::runtime_error( "Failed to start the folder watcher" );
+    }
+}
+
+FsWatcher::~FsWatcher()
+{
+    {
+        vlc::threads::mutex_locker lock( m_mutex );
+        m_stop = true;
+        wake();
+    }
+    vlc_join( m_thread, nullptr );
+
+    if ( m_inotify != -1 )
+    {
+        vlc_close( m_inotify );
+        vlc_close( m_wakeup[0] );
+        vlc_close( m_wakeup[1] );
+    }
+}
+
+void
+FsWatcher::watch( const std::string &entryPoint )
+{
+    vlc::threads::mutex_locker lock( m_mutex );
+
+    if ( m_entryPoints.find( entryPoint ) != m_entryPoints.end() )
+        return;
+
+    bool polled = true;
+#ifdef HAVE_SYS_INOTIFY_H
+    auto path = vlc::wrap_cptr( vlc_uri2path( entryPoint.c_str() ) );
+    if ( m_inotify != -1 && path != nullptr
+      && !strncasecmp( entryPoint.c_str(), "file://", 7 ) )
+    {
+        polled = !addWatches( path.get(), entryPoint );
+        if ( polled )
+        {
+            msg_Warn( m_obj, "cannot watch %s, it will be rescanned "
+                      "periodically", entryPoint.c_str() );
+            removeWatches( entryPoint );
+        }
+    }
+#endif
+
+    vlc_tick_t deadline = VLC_TICK_INVALID;
+    if ( polled && m_rescanInterval > 0 )
+        deadline = vlc_tick_now() + m_rescanInterval;
+    m_entryPoints[entryPoint] = EntryPoint{ polled, deadline };
+    wake();
+}
+
+void
+FsWatcher::unwatch( const std::string &entryPoint )
+{
+    vlc::threads::mutex_locker lock( m_mutex );
+
+#ifdef HAVE_SYS_INOTIFY_H
+    removeWatches( entryPoint );
+#endif
+    m_entryPoints.erase( entryPoint );
+}
+
+void *
+FsWatcher::runThread( void *data )
+{
+    static_cast<FsWatcher *>( data )->run();
+    return nullptr;
+}
+
+void
+FsWatcher::run()
+{
+    m_mutex.lock();
+    while ( !m_stop )
+    {
+        vlc_tick_t now = vlc_tick_now();
+        vlc_tick_t next = VLC_TICK_INVALID;
+        std::vector<std::string> changed;
+
+        for ( auto &it : m_entryPoints )
+        {
+            EntryPoint &ep = it.second;
+            if ( ep.deadline == VLC_TICK_INVALID )
+                continue;
+
+            if ( ep.deadline <= now )
+            {
+                changed.push_back( it.first );
+                ep.deadline = ep.polled && m_rescanInterval > 0
+                            ? now + m_rescanInterval : VLC_TICK_INVALID;
+            }
+            if ( ep.deadline != VLC_TICK_INVALID
+              && ( next == VLC_TICK_INVALID || ep.deadline < next ) )
+                next = ep.deadline;
+        }
+
+        if ( !changed.empty() )
+        {
+            /* The callback reloads the entry points, which may call back
+             * into this watcher */
+            m_mutex.unlock();
+            for ( const auto &entryPoint : changed )
+                m_cb( entryPoint );
+            m_mutex.lock();
+            continue;
+        }
+
+        wait( next );
+    }
+    m_mutex.unlock();
+}
+
+/* Called with the lock held */
+void
+FsWatcher::wait( vlc_tick_t deadline )
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    if ( m_inotify != -1 )
+    {
+        int timeout = -1;
+        if ( deadline != VLC_TICK_INVALID )
+        {
+            vlc_tick_t delay = deadline - vlc_tick_now();
+            timeout = delay > 0 ? MS_FROM_VLC_TICK( delay ) + 1 : 0;
+        }
+
+        struct pollfd ufd[2] = {
+            { m_inotify, POLLIN, 0 },
+            { m_wakeup[0], POLLIN, 0 },
+        };
+
+        m_mutex.unlock();
+        int ret = poll( ufd, 2, timeout );
+        m_mutex.lock();
+
+        if ( ret > 0 && ( ufd[1].revents & POLLIN ) )
+        {
+            char buf[64];
+            if ( read( m_wakeup[0], buf, sizeof (buf) ) < 0 )
+                msg_Dbg( m_obj, "wakeup pipe error: %s",
+                         vlc_strerror_c( errno ) );
+        }
+        if ( ret > 0 && ( ufd[0].revents & POLLIN ) )
+            readEvents();
+        return;
+    }
+#endif
+
+    if ( deadline == VLC_TICK_INVALID )
+        m_cond.wait( m_mutex );
+    else
+        m_cond.timedwait( m_mutex, deadline );
+}
+
+/* Called with the lock held */
+void
+FsWatcher::wake()
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    if ( m_inotify != -1 )
+    {
+        char c = 0;
+        if ( vlc_write( m_wakeup[1], &c, 1 ) < 0 && errno != EAGAIN )
+            msg_Dbg( m_obj, "wakeup pipe error: %s",
+                     vlc_strerror_c( errno ) );
+        return;
+    }
+#endif
+    m_cond.signal();
+}
+
+/* Called with the lock held */
+void
+FsWatcher::markChanged( const std::string &entryPoint )
+{
+    auto it = m_entryPoints.find( entryPoint );
+    if ( it == m_entryPoints.end() || it->second.polled )
+        return;
+
+    /* Postpone the report while the changes keep coming */
+    it->second.deadline = vlc_tick_now() + WATCH_DELAY;
+}
+
+#ifdef HAVE_SYS_INOTIFY_H
+
+/* Watches a directory and its subdirectories, called with the lock held */
+bool
+FsWatcher::addWatches( const std::string &path, const std::string &entryPoint )
+{
+    int wd = inotify_add_watch( m_inotify, path.c_str(), WATCH_EVENTS );
+    if ( wd == -1 )
+    {
+        /* ENOSPC: the limit of watches per user is reached */
+        if ( errno == ENOSPC || errno == ENOMEM )
+            return false;
+        /* The directory was removed or cannot be read, ignore it */
+        return true;
+    }
+
+    /* Already watched: the same directory is reachable through a symbolic
+     * link, do not walk it twice */
+    if ( !m_watches.emplace( wd, std::make_pair( path, entryPoint ) ).second )
+        return true;
+
+    auto dir = vlc::wrap_cptr( vlc_opendir( path.c_str() ), &closedir );
+    if ( dir == nullptr )
+        return true;
+
+    struct dirent *ent;
+    while ( ( ent = readdir( dir.get() ) ) != nullptr )
+    {
+        const char *name = ent->d_name;
+        if ( !strcmp( name, "." ) || !strcmp( name, ".." ) )
+            continue;
+
+#ifdef DT_DIR
+        if ( ent->d_type != DT_DIR && ent->d_type != DT_LNK
+          && ent->d_type != DT_UNKNOWN )
+            continue;
+#endif
+        std::string child = path + DIR_SEP + name;
+        struct stat st;
+        if ( vlc_stat( child.c_str(), &st ) != 0 || !S_ISDIR( st.st_mode ) )
+            continue;
+
+        if ( !addWatches( child, entryPoint ) )
+            return false;
+    }
+    return true;
+}
+
+/* Called with the lock held */
+void
+FsWatcher::removeWatches( const std::string &entryPoint )
+{
+    for ( auto it = m_watches.begin(); it != m_watches.end(); )
+    {
+        if ( it->second.second == entryPoint )
+        {
+            inotify_rm_watch( m_inotify, it->first );
+            it = m_watches.erase( it );
+        }
+        else
+            ++it;
+    }
+}
+
+/* Called with the lock held */
+void
+FsWatcher::readEvents()
+{
+    alignas(struct inotify_event) char buf[4096];
+
+    for ( ;; )
+    {
+        ssize_t len = read( m_inotify, buf, sizeof (buf) );
+        if ( len <= 0 )
+            break;
+
+        for ( char *p = buf; p < buf + len; )
+        {
+            const auto *ev = reinterpret_cast<const struct inotify_event *>( p );
+            p += sizeof (*ev) + ev->len;
+
+            if ( ev->mask & IN_Q_OVERFLOW )
+            {
+                /* Events were lost, report every watched entry point */
+                for ( const auto &it : m_entryPoints )
+                    markChanged( it.first );
+                continue;
+            }
+
+            auto it = m_watches.find( ev->wd );
+            if ( it == m_watches.end() )
+                continue;
+
+            if ( ev->mask & IN_IGNORED )
+            {
+                /* The directory was removed, its parent reported it */
+                m_watches.erase( it );
+                continue;
+            }
+
+            std::string path = it->second.first;
+            std::string entryPoint = it->second.second;
+
+            if ( ( ev->mask & IN_ISDIR ) && ( ev->mask & ( IN_CREATE | IN_MOVED_TO ) )
+              && ev->len > 0
+              && !addWatches( path + DIR_SEP + ev->name, entryPoint ) )
+            {
+                msg_Warn( m_obj, "cannot watch %s anymore, it will be "
+                          "rescanned periodically", entryPoint.c_str() );
+                removeWatches( entryPoint );
+
+                auto ep = m_entryPoints.find( entryPoint );
+                if ( ep != m_entryPoints.end() )
+                    ep->second = EntryPoint{ true, vlc_tick_now() };
+                continue;
+            }
+
+            markChanged( entryPoint );
+        }
+    }
+}
+
+#endif
+
+  } /* namespace medialibrary */
+} /* namespace vlc */
@@ -0,0 +1,91 @@
+/*****************************************************************************
+ * watcher.h: Media library file system change watcher
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors, VideoLAN and VideoLabs
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SD_WATCHER_H
+#define SD_WATCHER_H
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_cxx_helpers.hpp>
+
+namespace vlc {
+  namespace medialibrary {
+
+/*
+ * Reports the entry points whose content changed, so that they get reloaded.
+ *
+ * Local entry points are watched with inotify when available, and their
+ * changes are coalesced for a few seconds. The other ones (network shares,
+ * other systems, or too many directories to watch) are reported every
+ * "ml-rescan-interval" seconds instead.
+ */
+class FsWatcher
+{
+public:
+    using ChangeCb = std::function<void(const std::string &entryPoint)>;
+
+    FsWatcher( vlc_object_t *obj, ChangeCb cb );
+    ~FsWatcher();
+
+    void watch( const std::string &entryPoint );
+    void unwatch( const std::string &entryPoint );
+
+private:
+    struct EntryPoint
+    {
+        bool polled;
+        vlc_tick_t deadline; /* next report, VLC_TICK_INVALID if none */
+    };
+
+    static void *runThread( void *data );
+    void run();
+    void wait( vlc_tick_t deadline );
+    void wake();
+    void markChanged( const std::string &entryPoint );
+#ifdef HAVE_SYS_INOTIFY_H
+    bool addWatches( const std::string &path, const std::string &entryPoint );
+    void removeWatches( const std::string &entryPoint );
+    void readEvents();
+#endif
+
+    vlc_object_t *const m_obj;
+    const ChangeCb m_cb;
+    vlc_tick_t m_rescanInterval;
+
+    vlc::threads::mutex m_mutex;
+    vlc::threads::condition_variable m_cond;
+    std::map<std::string, EntryPoint> m_entryPoints;
+    bool m_stop = false;
+
+    int m_inotify = -1;
+    int m_wakeup[2] = { -1, -1 };
+    /* inotify watch descriptor -> (directory path, entry point) */
+    std::map<int, std::pair<std::string, std::string>> m_watches;
+
+    vlc_thread_t m_thread;
+};
+
+  } /* namespace medialibrary */
+} /* namespace vlc */
+
+#endif
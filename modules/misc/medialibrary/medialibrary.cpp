@@ -30,6 +30,7 @@
 #include "medialibrary.h"
 #include "fs/fs.h"
 #include "fs/devicelister.h"
+#include "fs/watcher.h"
 
 #include <medialibrary/IMedia.h>
 #include <medialibrary/IAlbumTrack.h>
@@ -260,6 +261,9 @@ void MediaLibrary::onDiscoveryCompleted( const std::string& entryPoint, bool suc
     ev.discovery_completed.psz_entry_point = entryPoint.c_str();
     ev.discovery_completed.b_success = success;
     m_vlc_ml->cbs->pf_send_event( m_vlc_ml, &ev );
+
+    if ( success && m_watcher != nullptr )
+        m_watcher->watch( entryPoint );
 }
 
 void MediaLibrary::onReloadStarted( const std::string& entryPoint )
@@ -295,6 +299,9 @@ void MediaLibrary::onEntryPointRemoved( const std::string& entryPoint, bool succ
     ev.entry_point_removed.psz_entry_point = entryPoint.c_str();
     ev.entry_point_removed.b_success = success;
     m_vlc_ml->cbs->pf_send_event( m_vlc_ml, &ev );
+
+    if ( success && m_watcher != nullptr )
+        m_watcher->unwatch( entryPoint );
 }
 
 void MediaLibrary::onEntryPointBanned( const std::string& entryPoint, bool success )
@@ -453,6 +460,21 @@ bool MediaLibrary::Init()
 
     m_ml->setDiscoverNetworkEnabled( true );
 
+    try
+    {
+        auto ml = m_ml.get();
+        m_watcher.reset( new vlc::medialibrary::FsWatcher(
+            VLC_OBJECT( m_vlc_ml ),
+            [ml]( const std::string& entryPoint ) {
+                ml->reload( entryPoint );
+            } ) );
+    }
+    catch ( const std::runtime_error& ex )
+    {
+        /* Not fatal, the folders are only reloaded on request */
+        msg_Warn( m_vlc_ml, "%s", ex.what() );
+    }
+
     m_initialized = true;
     return true;
 }
@@ -472,7 +494,25 @@ bool MediaLibrary::Start()
      */
     auto entryPoints = m_ml->entryPoints()->all();
     if ( entryPoints.empty() == false )
+    {
+        if ( m_watcher != nullptr )
+        {
+            for ( const auto& entryPoint : entryPoints )
+            {
+                try
+                {
+                    m_watcher->watch( entryPoint->mrl() );
+                }
+                catch ( const std::exception& ex )
+                {
+                    /* Removable device not present */
+                    msg_Dbg( m_vlc_ml, "cannot watch entry point: %s",
+                             ex.what() );
+                }
+            }
+        }
         return true;
+    }
 
     auto folders = vlc::wrap_cptr( var_InheritString( m_vlc_ml, "ml-folders" ) );
     if ( folders != nullptr && strlen( folders.get() ) > 0 )
@@ -1784,6 +1824,19 @@ static void Close( vlc_object_t* obj )
 
 #define ML_VERBOSE _( "Extra verbose media library logs" )
 
+#define ML_RESCAN_INTERVAL_TEXT _( "Rescan interval" )
+#define ML_RESCAN_INTERVAL_LONGTEXT _( "Interval between the rescans of the " \
+    "folders whose changes cannot be watched, such as network shares, " \
+    "in seconds (0 to disable)" )
+
+#define ML_FAST_EXTRACTION_TEXT _( "Fast audio metadata extraction" )
+#define ML_FAST_EXTRACTION_LONGTEXT _( "Read the tags and tracks of the " \
+    "audio files from their headers, without starting a playback input" )
+
+#define ML_DISCOVERY_THREADS_TEXT _( "Discovery threads" )
+#define ML_DISCOVERY_THREADS_LONGTEXT _( "Number of threads reading the " \
+    "directories ahead of the discoverer (0 to read them one at a time)" )
+
 vlc_module_begin()
     set_shortname(N_("media library"))
     set_description(N_( "Organize your media" ))
@@ -1793,4 +1846,10 @@ vlc_module_begin()
     set_callbacks(Open, Close)
     add_string( "ml-folders", nullptr, ML_FOLDER_TEXT, ML_FOLDER_LONGTEXT, false )
     add_bool( "ml-verbose", false, ML_VERBOSE, ML_VERBOSE, false )
+    add_integer( "ml-discovery-threads", 4, ML_DISCOVERY_THREADS_TEXT,
+                 ML_DISCOVERY_THREADS_LONGTEXT, true )
+    add_bool( "ml-fast-extraction", true, ML_FAST_EXTRACTION_TEXT,
+              ML_FAST_EXTRACTION_LONGTEXT, true )
+    add_integer( "ml-rescan-interval", 3600, ML_RESCAN_INTERVAL_TEXT,
+                 ML_RESCAN_INTERVAL_LONGTEXT, true )
 vlc_module_end()
@@ -44,6 +44,12 @@ struct vlc_thumbnailer_request_t;
 
 class Logger;
 
+namespace vlc {
+  namespace medialibrary {
+    class FsWatcher;
+  }
+}
+
 class MetadataExtractor : public medialibrary::parser::IParserService
 {
 private:
@@ -52,6 +58,7 @@ private:
         ParseContext( MetadataExtractor* mde, medialibrary::parser::IItem& item )
             : needsProbing( false )
             , success( false )
+            , nbSubItems( 0 )
             , mde( mde )
             , item( item )
             , inputItem( nullptr, &input_item_Release )
@@ -61,6 +68,8 @@ private:
 
         bool needsProbing;
         bool success;
+        // Large playlists post their subitems in several batches
+        unsigned int nbSubItems;
         MetadataExtractor* mde;
         medialibrary::parser::IItem& item;
         std::unique_ptr<input_item_t, decltype(&input_item_Release)> inputItem;
@@ -87,6 +96,7 @@ private:
     void onParserEnded( ParseContext& ctx, int status );
     void addSubtree( ParseContext& ctx, input_item_node_t *root );
     void populateItem( medialibrary::parser::IItem& item, input_item_t* inputItem );
+    bool extractFast( input_item_t* inputItem );
 
     static void onParserEnded( input_item_t *, int status, void *user_data );
     static void onParserSubtreeAdded( input_item_t *, input_item_node_t *subtree,
@@ -97,6 +107,7 @@ private:
     vlc::threads::mutex m_mutex;
     ParseContext* m_currentCtx;
     vlc_object_t* m_obj;
+    bool m_fastExtraction;
 };
 
 class Thumbnailer : public medialibrary::IThumbnailer
@@ -166,6 +177,8 @@ private:
     vlc_medialibrary_module_t* m_vlc_ml;
     std::unique_ptr<Logger> m_logger;
     std::unique_ptr<medialibrary::IMediaLibrary> m_ml;
+    /* Declared after m_ml, as it reloads the entry points until deleted */
+    std::unique_ptr<vlc::medialibrary::FsWatcher> m_watcher;
 
     vlc::threads::mutex m_mutex;
     bool m_initialized = false; /* protected by m_mutex */
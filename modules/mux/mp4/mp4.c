@@ -54,6 +54,12 @@
     "\"Fast Start\" files are optimized for downloads and allow the user " \
     "to start previewing the file while it is downloading.")
 
+#define MOOV_SPACE_TEXT N_("Space reserved for the index (kB)")
+#define MOOV_SPACE_LONGTEXT N_(\
+    "Space reserved for the index before the media data. If the index fits " \
+    "at the end, the file is written as a \"Fast Start\" file without " \
+    "moving the data. About 3000 kB per hour of 30 fps video with audio.")
+
 static int  Open   (vlc_object_t *);
 static void Close  (vlc_object_t *);
 static void CloseFrag  (vlc_object_t *);
@@ -69,6 +75,9 @@ vlc_module_begin ()
     add_bool(SOUT_CFG_PREFIX "faststart", false,
               FASTSTART_TEXT, FASTSTART_LONGTEXT,
               true)
+    add_integer(SOUT_CFG_PREFIX "moov-space", 0,
+                MOOV_SPACE_TEXT, MOOV_SPACE_LONGTEXT, true)
+        change_integer_range(0, 1 << 20)
     set_capability("sout mux", 5)
     add_shortcut("mp4", "mov", "3gp")
     set_callbacks(Open, Close)
@@ -88,7 +97,7 @@ vlc_module_end ()
  * Exported prototypes
  *****************************************************************************/
 static const char *const ppsz_sout_options[] = {
-    "faststart", NULL
+    "faststart", "moov-space", NULL
 };
 
 static int Control(sout_mux_t *, int, va_list);
@@ -164,6 +173,8 @@ typedef struct
 
     uint64_t i_mdat_pos;
     uint64_t i_pos;
+    uint64_t i_moov_space_pos;
+    uint32_t i_moov_space;
     vlc_tick_t  i_read_duration;
     vlc_tick_t  i_start_dts;
 
@@ -241,6 +252,23 @@ static int WriteSlowStartHeader(sout_mux_t *p_mux)
         box_send(p_mux, box);
     }
 
+    /* Reserve the space of the moov, as a free box */
+    if (p_sys->i_moov_space > 0)
+    {
+        block_t *p_free = block_Alloc(p_sys->i_moov_space);
+        if (!p_free)
+            return VLC_ENOMEM;
+
+        memset(p_free->p_buffer, 0, p_free->i_buffer);
+        SetDWBE(p_free->p_buffer, p_sys->i_moov_space);
+        memcpy(p_free->p_buffer + 4, "free", 4);
+        sout_AccessOutWrite(p_mux->p_access, p_free);
+
+        p_sys->i_moov_space_pos = p_sys->i_pos;
+        p_sys->i_pos += p_sys->i_moov_space;
+        p_sys->i_mdat_pos = p_sys->i_pos;
+    }
+
     /* Now add mdat header */
     box = box_new("mdat");
     if(!box)
@@ -287,6 +315,11 @@ static int Open(vlc_object_t *p_this)
     p_sys->pp_streams   = NULL;
     p_sys->i_mdat_pos   = 0;
     p_sys->b_header_sent = false;
+    p_sys->i_moov_space_pos = 0;
+    p_sys->i_moov_space = 0;
+    if (!(options & FRAGMENTED))
+        p_sys->i_moov_space = 1024 *
+            var_GetInteger(p_mux, SOUT_CFG_PREFIX "moov-space");
 
     p_sys->i_read_duration   = 0;
     p_sys->i_written_duration= 0;
@@ -351,6 +384,36 @@ static void Close(vlc_object_t *p_this)
 
     /* Check we need to create "fast start" files */
     p_sys->b_fast_start = var_GetBool(p_this, SOUT_CFG_PREFIX "faststart");
+
+    /* Write the moov in the reserved space if it fits, the remaining space
+     * being a smaller free box */
+    if (moov && moov->b && p_sys->i_moov_space > 0)
+    {
+        const size_t i_moov_size = bo_size(moov);
+
+        if (i_moov_size == p_sys->i_moov_space
+         || i_moov_size + 8 <= p_sys->i_moov_space)
+        {
+            const uint32_t i_left = p_sys->i_moov_space - i_moov_size;
+
+            i_moov_pos = p_sys->i_moov_space_pos;
+            p_sys->b_fast_start = false;
+            if (i_left > 0)
+            {
+                bo_t *p_free = box_new("free");
+                if (p_free)
+                {
+                    box_fix(p_free, i_left);
+                    sout_AccessOutSeek(p_mux->p_access,
+                                       i_moov_pos + i_moov_size);
+                    box_send(p_mux, p_free);
+                }
+            }
+        }
+        else
+            msg_Warn(p_this, "index too large (%zu bytes) for the reserved "
+                     "space", i_moov_size);
+    }
     while (p_sys->b_fast_start && moov && moov->b)
     {
         /* Move data to the end of the file so we can fit the moov header
@@ -616,11 +679,16 @@ static block_t * BlockDequeue(sout_input_t *p_input, mp4_stream_t *p_stream)
     switch(mp4mux_track_GetFmt(p_stream->tinfo)->i_codec)
     {
         case VLC_CODEC_AV1:
-            p_block = AV1_Pack_Sample(p_block);
+            /* Both rewrite the sample in place */
+            p_block = block_MakeWritable(p_block);
+            if(p_block)
+                p_block = AV1_Pack_Sample(p_block);
             break;
         case VLC_CODEC_H264:
         case VLC_CODEC_HEVC:
-            p_block = hxxx_AnnexB_to_xVC(p_block, 4);
+            p_block = block_MakeWritable(p_block);
+            if(p_block)
+                p_block = hxxx_AnnexB_to_xVC(p_block, 4);
             break;
         case VLC_CODEC_SUBT:
             p_block = ConvertSUBT(p_block);
@@ -153,6 +153,12 @@ static const char *const ts_standards_list_text[] =
   "PCRs (Program Clock Reference) will be sent (in milliseconds). " \
   "This value should be below 100ms. (default is 70ms).")
 
+#define MUXRATE_TEXT N_("Mux rate (bits/s)")
+#define MUXRATE_LONGTEXT N_("Output a constant bitrate stream at this rate, " \
+  "padded with null packets and with the PCRs set from the packets " \
+  "positions. The streams must fit within this rate. 0 outputs a " \
+  "variable bitrate stream.")
+
 #define BMIN_TEXT N_( "Minimum B (deprecated)")
 #define BMIN_LONGTEXT N_( "This setting is deprecated and not used anymore" )
 
@@ -165,6 +171,11 @@ static const char *const ts_standards_list_text[] =
   "stream, compared to the PCRs. This allows for some buffering inside " \
   "the client decoder.")
 
+#define KEEPTS_TEXT N_("Keep the input timestamps")
+#define KEEPTS_LONGTEXT N_("Write the timestamps of the input instead of " \
+  "starting them from zero. Streams muxed from consecutive parts of the " \
+  "same input can then be joined by concatenation.")
+
 #define ACRYPT_TEXT N_("Crypt audio")
 #define ACRYPT_LONGTEXT N_("Crypt audio using CSA")
 #define VCRYPT_TEXT N_("Crypt video")
@@ -226,9 +237,12 @@ vlc_module_begin ()
     add_bool(SOUT_CFG_PREFIX "use-key-frames", false, KEYF_TEXT, KEYF_LONGTEXT, true)
 
     add_integer( SOUT_CFG_PREFIX "pcr", 70, PCR_TEXT, PCR_LONGTEXT, true)
+    add_integer( SOUT_CFG_PREFIX "muxrate", 0, MUXRATE_TEXT, MUXRATE_LONGTEXT, true)
+        change_integer_range( 0, INT_MAX )
     add_integer( SOUT_CFG_PREFIX "bmin", 0, BMIN_TEXT, BMIN_LONGTEXT, true)
     add_integer( SOUT_CFG_PREFIX "bmax", 0, BMAX_TEXT, BMAX_LONGTEXT, true)
     add_integer( SOUT_CFG_PREFIX "dts-delay", 400, DTS_TEXT, DTS_LONGTEXT, true)
+    add_bool( SOUT_CFG_PREFIX "keep-timestamps", false, KEEPTS_TEXT, KEEPTS_LONGTEXT, true)
 
     add_bool( SOUT_CFG_PREFIX "crypt-audio", true, ACRYPT_TEXT, ACRYPT_LONGTEXT, true)
     add_bool( SOUT_CFG_PREFIX "crypt-video", true, VCRYPT_TEXT, VCRYPT_LONGTEXT, true)
@@ -249,7 +263,7 @@ static const char *const ppsz_sout_options[] = {
     "netid", "sdtdesc",
     "es-id-pid", "shaping", "pcr", "bmin", "bmax", "use-key-frames",
     "dts-delay", "csa-ck", "csa2-ck", "csa-use", "csa-pkt", "crypt-audio", "crypt-video",
-    "muxpmt", "program-pmt", "alignment",
+    "muxpmt", "program-pmt", "alignment", "keep-timestamps", "muxrate",
     NULL
 };
 
@@ -381,6 +395,13 @@ typedef struct
 
     vlc_tick_t      i_pcr;  /* last PCR emited */
 
+    /* Constant bitrate output, on the virtual clock of the packets */
+    int64_t         i_muxrate;
+    vlc_tick_t      cbr_origin; /* date of the first packet */
+    uint64_t        cbr_packets; /* packets since the first one */
+    bool            b_cbr_overflow;
+    block_t         *p_cbr_datagram; /* being filled */
+
     csa_t           *csa;
     int             i_csa_pkt_size;
     bool            b_crypt_audio;
@@ -475,6 +496,9 @@ static block_t *FixPES( sout_mux_t *p_mux, block_fifo_t *p_fifo );
 static block_t *Add_ADTS( block_t *, const es_format_t * );
 static void TSSchedule  ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
+static void TSDateCBR   ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+                          vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
+static void TSFlushCBR  ( sout_mux_t *p_mux );
 static void TSDate      ( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
                           vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts );
 static void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
@@ -482,6 +506,7 @@ static void GetPMT( sout_mux_t *p_mux, sout_buffer_chain_t *c );
 
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream, bool b_pcr );
 static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts );
+static void TSSetPCR27( block_t *p_ts, int64_t i_pcr );
 
 static csa_t *csaSetup( vlc_object_t *p_this )
 {
@@ -743,6 +768,16 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->b_use_key_frames = var_GetBool( p_mux, SOUT_CFG_PREFIX "use-key-frames" );
 
+    p_sys->i_muxrate = var_GetInteger( p_mux, SOUT_CFG_PREFIX "muxrate" );
+    p_sys->cbr_origin = VLC_TICK_INVALID;
+    if( p_sys->i_muxrate > 0 )
+        msg_Dbg( p_mux, "constant bitrate at %"PRId64" bits/s",
+                 p_sys->i_muxrate );
+
+    /* The timestamps are offset from the first DTS, picked in Mux() */
+    if( var_GetBool( p_mux, SOUT_CFG_PREFIX "keep-timestamps" ) )
+        p_sys->first_dts = VLC_TICK_0;
+
     p_mux->p_sys        = p_sys;
 
     p_sys->csa = csaSetup(p_this);
@@ -763,6 +798,9 @@ static void Close( vlc_object_t * p_this )
     sout_mux_t          *p_mux = (sout_mux_t*)p_this;
     sout_mux_sys_t      *p_sys = p_mux->p_sys;
 
+    if( p_sys->p_cbr_datagram )
+        TSFlushCBR( p_mux );
+
     if( p_sys->p_dvbpsi )
         dvbpsi_delete( p_sys->p_dvbpsi );
 
@@ -1573,7 +1611,10 @@ static bool MuxStreams(sout_mux_t *p_mux )
     }
 
     /* 4: date and send */
-    TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    if( p_sys->i_muxrate > 0 )
+        TSDateCBR( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
+    else
+        TSSchedule( p_mux, &chain_ts, i_pcr_length, i_pcr_dts );
     return false;
 }
 
@@ -1814,6 +1855,130 @@ static void TSDate( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
     }
 }
 
+/* TS packets output together, filling a 1316 bytes UDP/RTP payload */
+#define CBR_DATAGRAM_PACKETS 7
+
+/* Date of the n-th packet on the constant bitrate clock */
+static vlc_tick_t CBRDate( const sout_mux_sys_t *p_sys, uint64_t n )
+{
+    return p_sys->cbr_origin + vlc_tick_from_frac( n * 188 * 8,
+                                                   p_sys->i_muxrate );
+}
+
+static void TSFlushCBR( sout_mux_t *p_mux )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+
+    sout_AccessOutWrite( p_mux->p_access, p_sys->p_cbr_datagram );
+    p_sys->p_cbr_datagram = NULL;
+}
+
+/* Outputs a packet at the next position, or a null packet if p_ts is NULL */
+static void TSWriteCBR( sout_mux_t *p_mux, block_t *p_ts )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    block_t *p_dgram = p_sys->p_cbr_datagram;
+
+    if( p_dgram == NULL )
+    {
+        p_dgram = block_Alloc( CBR_DATAGRAM_PACKETS * 188 );
+        if( unlikely(p_dgram == NULL) )
+        {
+            if( p_ts )
+                block_Release( p_ts );
+            p_sys->cbr_packets++;
+            return;
+        }
+        p_dgram->i_buffer = 0;
+        /* latency */
+        p_dgram->i_dts = CBRDate( p_sys, p_sys->cbr_packets )
+                       + p_sys->i_shaping_delay * 3 / 2;
+        p_sys->p_cbr_datagram = p_dgram;
+    }
+
+    uint8_t *p = &p_dgram->p_buffer[p_dgram->i_buffer];
+    if( p_ts == NULL )
+    {
+        static const uint8_t null_header[4] = { 0x47, 0x1f, 0xff, 0x10 };
+        memcpy( p, null_header, 4 );
+        memset( p + 4, 0xff, 184 );
+    }
+    else
+    {
+        if( p_ts->i_flags & BLOCK_FLAG_CLOCK )
+        {
+            /* The PCR is exactly the time of the packet on the output */
+            lldiv_t d = lldiv( p_sys->cbr_packets * 188 * 8, p_sys->i_muxrate );
+            TSSetPCR27( p_ts, TO_SCALE_NZ( p_sys->cbr_origin - p_sys->first_dts ) * 300
+                            + d.quot * INT64_C(27000000)
+                            + d.rem * INT64_C(27000000) / p_sys->i_muxrate );
+            p_dgram->i_flags |= BLOCK_FLAG_CLOCK;
+        }
+        if( p_ts->i_flags & BLOCK_FLAG_SCRAMBLED )
+        {
+            vlc_mutex_lock( &p_sys->csa_lock );
+            csa_Encrypt( p_sys->csa, p_ts->p_buffer, p_sys->i_csa_pkt_size );
+            vlc_mutex_unlock( &p_sys->csa_lock );
+        }
+        memcpy( p, p_ts->p_buffer, 188 );
+        block_Release( p_ts );
+    }
+    p_dgram->i_buffer += 188;
+    p_sys->cbr_packets++;
+
+    if( p_dgram->i_buffer == CBR_DATAGRAM_PACKETS * 188 )
+    {
+        p_dgram->i_length = CBRDate( p_sys, p_sys->cbr_packets )
+                          + p_sys->i_shaping_delay * 3 / 2 - p_dgram->i_dts;
+        TSFlushCBR( p_mux );
+    }
+}
+
+/* Spreads the packets of the slice over its duration at the mux rate, and
+ * fills the gaps with null packets */
+static void TSDateCBR( sout_mux_t *p_mux, sout_buffer_chain_t *p_chain_ts,
+                       vlc_tick_t i_pcr_length, vlc_tick_t i_pcr_dts )
+{
+    sout_mux_sys_t *p_sys = p_mux->p_sys;
+    const int i_packet_count = p_chain_ts->i_depth;
+    const vlc_tick_t i_end = i_pcr_dts + i_pcr_length;
+
+    /* (Re)start the clock on the first slice and on discontinuities */
+    if( p_sys->cbr_origin == VLC_TICK_INVALID ||
+        CBRDate( p_sys, p_sys->cbr_packets ) < i_pcr_dts - VLC_TICK_FROM_SEC(1) ||
+        CBRDate( p_sys, p_sys->cbr_packets ) > i_end + VLC_TICK_FROM_SEC(1) )
+    {
+        if( p_sys->cbr_origin != VLC_TICK_INVALID )
+            msg_Warn( p_mux, "constant bitrate clock reset" );
+        if( p_sys->p_cbr_datagram )
+            TSFlushCBR( p_mux );
+        p_sys->cbr_origin = i_pcr_dts;
+        p_sys->cbr_packets = 0;
+    }
+
+    for( int i = 0; i < i_packet_count; i++ )
+    {
+        block_t *p_ts = BufferChainGet( p_chain_ts );
+        vlc_tick_t i_date = i_pcr_dts + i_pcr_length * i / i_packet_count;
+
+        /* Not before its share of the slice */
+        while( CBRDate( p_sys, p_sys->cbr_packets ) < i_date )
+            TSWriteCBR( p_mux, NULL );
+        TSWriteCBR( p_mux, p_ts );
+    }
+
+    while( CBRDate( p_sys, p_sys->cbr_packets ) < i_end )
+        TSWriteCBR( p_mux, NULL );
+
+    /* More packets than the rate allows: the output lags behind */
+    bool b_overflow = CBRDate( p_sys, p_sys->cbr_packets )
+                    > i_end + p_sys->i_shaping_delay;
+    if( b_overflow && !p_sys->b_cbr_overflow )
+        msg_Warn( p_mux, "mux rate exceeded (%d packets in %"PRId64" us)",
+                  i_packet_count, i_pcr_length );
+    p_sys->b_cbr_overflow = b_overflow;
+}
+
 static block_t *TSNew( sout_mux_t *p_mux, sout_input_sys_t *p_stream,
                        bool b_pcr )
 {
@@ -1930,6 +2095,20 @@ static void TSSetPCR( block_t *p_ts, vlc_tick_t i_dts )
     p_ts->p_buffer[11] = 0; /* we don't set PCR extension */
 }
 
+/* Sets the PCR with its extension, from a 27 MHz value */
+static void TSSetPCR27( block_t *p_ts, int64_t i_pcr )
+{
+    int64_t i_base = i_pcr / 300;
+    int i_ext = i_pcr % 300;
+
+    p_ts->p_buffer[6]  = ( i_base >> 25 )&0xff;
+    p_ts->p_buffer[7]  = ( i_base >> 17 )&0xff;
+    p_ts->p_buffer[8]  = ( i_base >> 9  )&0xff;
+    p_ts->p_buffer[9]  = ( i_base >> 1  )&0xff;
+    p_ts->p_buffer[10] = ( ( i_base << 7 )&0x80 ) | 0x7e | ( i_ext >> 8 );
+    p_ts->p_buffer[11] = i_ext&0xff;
+}
+
 void GetPAT( sout_mux_t *p_mux, sout_buffer_chain_t *c )
 {
     sout_mux_sys_t       *p_sys = p_mux->p_sys;
@@ -114,52 +114,77 @@ block_t *hxxx_AnnexB_to_xVC( block_t *p_block, uint8_t i_nal_length_size )
         return p_block;
     }
 
-    block_t *p_release = NULL;
-    const uint8_t *p_source = NULL;
-    const uint8_t *p_sourceend = NULL;
-    uint8_t *p_dest = NULL;
-    const size_t i_dest = p_block->i_buffer + p_list[i_nalcount - 1].move;
+    const size_t i_src = p_block->i_buffer;
+    const off_t i_totalmove = p_list[i_nalcount - 1].move;
+    const size_t i_dest = i_src + i_totalmove;
 
-    if( p_list[i_nalcount - 1].move != 0 || i_nal_length_size != 4 )  /* We'll need to grow or shrink */
+    /* Prefix sizes changes all have the same sign, so the payloads can be
+     * moved in place: from the end when growing, from the start otherwise */
+    if( i_totalmove == 0 && i_nal_length_size == 4 )
     {
-        block_t *p_newblock = block_Alloc( i_dest );
-        if( unlikely(!p_newblock) )
-            goto error;
-
-        p_release = p_block; /* Will be released after use */
-        p_source = p_release->p_buffer;
-        p_sourceend = &p_release->p_buffer[p_release->i_buffer];
+        /* 4 bytes startcodes only, only rewrite prefixes */
+        for( unsigned i=0; i<i_nalcount; i++ )
+        {
+            const uint8_t *p_next = (i + 1 < i_nalcount) ? p_list[i + 1].p : p_end;
+            hxxx_WritePrefix( 4, (uint8_t *) p_list[i].p, p_next - p_list[i].p - 4 );
+        }
+    }
+    else if( i_totalmove < 0 ||
+             (size_t)(p_block->p_buffer - p_block->p_start) >= (size_t) i_totalmove )
+    {
+        /* shrinking, or growing into the unused head of the buffer */
+        const size_t i_offset = (i_totalmove > 0) ? i_totalmove : 0;
+        uint8_t *p_dest = p_block->p_buffer - i_offset;
+        for( unsigned i=0; i<i_nalcount; i++ )
+        {
+            const uint8_t *p_next = (i + 1 < i_nalcount) ? p_list[i + 1].p : p_end;
+            const uint8_t *p_payload = &p_list[i].p[ p_list[i].prefix ];
+            const uint32_t i_payload = p_next - p_payload;
+            uint8_t *p_write = &p_dest[ p_payload - p_block->p_buffer + p_list[i].move ];
 
-        p_block = p_newblock;
-        p_dest = p_newblock->p_buffer;
+            memmove( p_write, p_payload, i_payload );
+            hxxx_WritePrefix( i_nal_length_size, p_write - i_nal_length_size, i_payload );
+        }
+        p_block->p_buffer = p_dest;
+        p_block->i_buffer = i_dest;
     }
     else
     {
-        p_source = p_dest = p_block->p_buffer;
-        p_sourceend = &p_block->p_buffer[p_block->i_buffer];
-    }
+        /* growing into the unused tail of the buffer, or into a new one */
+        block_t *p_release = NULL;
+        uint8_t *p_dest = p_block->p_buffer;
+        if( (size_t)(&p_block->p_start[p_block->i_size] - p_block->p_buffer) < i_dest )
+        {
+            block_t *p_newblock = block_Alloc( i_dest );
+            if( unlikely(!p_newblock) )
+                goto error;
+            block_CopyProperties( p_newblock, p_block );
+            p_release = p_block; /* Will be released after use */
+            p_dest = p_newblock->p_buffer;
+            p_block = p_newblock;
+        }
 
-    if(!p_dest)
-        goto error;
+        const uint8_t *p_source = p_release ? p_release->p_buffer : p_dest;
+        const uint8_t *p_sourceend = p_end;
+        for( unsigned i=i_nalcount; i!=0; i-- )
+        {
+            const uint8_t *p_readstart = p_list[i - 1].p;
+            uint32_t i_payload = p_sourceend - p_readstart - p_list[i - 1].prefix;
+            off_t offset = p_list[i - 1].p - p_source + p_list[i - 1].prefix + p_list[i - 1].move;
 
-    /* Do reverse order moves, so we never overlap when growing only */
-    for( unsigned i=i_nalcount; i!=0; i-- )
-    {
-        const uint8_t *p_readstart = p_list[i - 1].p;
-        uint32_t i_payload = p_sourceend - p_readstart - p_list[i - 1].prefix;
-        off_t offset = p_list[i - 1].p - p_source + p_list[i - 1].prefix + p_list[i - 1].move;
-//        printf(" move offset %ld, length = %ld  prefix %ld move %ld\n", p_readstart - p_source, i_payload, p_list[i - 1].prefix, p_list[i-1].move);
+            /* move in same / copy between buffers */
+            memmove( &p_dest[ offset ], &p_list[i - 1].p[ p_list[i - 1].prefix ], i_payload );
 
-        /* move in same / copy between buffers */
-        memmove( &p_dest[ offset ], &p_list[i - 1].p[ p_list[i - 1].prefix ], i_payload );
+            hxxx_WritePrefix( i_nal_length_size, &p_dest[ offset - i_nal_length_size ] , i_payload );
 
-        hxxx_WritePrefix( i_nal_length_size, &p_dest[ offset - i_nal_length_size ] , i_payload );
+            p_sourceend = p_readstart;
+        }
+        p_block->i_buffer = i_dest;
 
-        p_sourceend = p_readstart;
+        if( p_release )
+            block_Release( p_release );
     }
 
-    if( p_release )
-        block_Release( p_release );
     free( p_list );
     return p_block;
 
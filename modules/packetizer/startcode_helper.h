@@ -65,7 +65,7 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
             return p;
     }
 
-    if( p == end )
+    if( p > end )
         return NULL;
 
     alignedend = end - ((intptr_t) end & 15);
@@ -119,6 +119,92 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
 
 #endif
 
+#ifdef CAN_COMPILE_AVX2
+
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindAnnexB_AVX2( const uint8_t *p, const uint8_t *end )
+{
+    /* First align to 32 */
+    const uint8_t *alignedend = p + 32 - ((intptr_t)p & 31);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    if( p > end )
+        return NULL;
+
+    alignedend = end - ((intptr_t) end & 31);
+    for( ; p < alignedend; p += 32)
+    {
+        uint32_t match;
+        asm volatile(
+            "vmovdqa     0(%[v]),   %%ymm0\n"
+            "vpxor       %%ymm1,    %%ymm1, %%ymm1\n"
+            "vpcmpeqb    %%ymm1,    %%ymm0, %%ymm0\n"
+            "vpmovmskb   %%ymm0,    %[match]\n" /* mask will be in reversed match order */
+            "vzeroupper\n"
+            : [match]"=r"(match)
+            : [v]"r"(p)
+            : "xmm0", "xmm1"
+        );
+        /* most blocks have no zero at all */
+        for( unsigned i = 0; match; i += 4, match >>= 4 )
+        {
+            if( match & 0x0F )
+                TRY_MATCH(p, i);
+        }
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#  define CAN_COMPILE_NEON_STARTCODE
+
+static inline const uint8_t * startcode_FindAnnexB_NEON( const uint8_t *p, const uint8_t *end )
+{
+    const uint8_t *alignedend = p + 16 - ((intptr_t)p & 15);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    if( p > end )
+        return NULL;
+
+    alignedend = end - ((intptr_t) end & 15);
+    for( ; p < alignedend; p += 16)
+    {
+        /* 4 bits per byte of the mask */
+        const uint8x16_t zeros = vceqzq_u8(vld1q_u8(p));
+        uint64_t match = vget_lane_u64(vreinterpret_u64_u8(
+                            vshrn_n_u16(vreinterpretq_u16_u8(zeros), 4)), 0);
+        for( unsigned i = 0; match; i += 4, match >>= 16 )
+        {
+            if( match & 0xFFFF )
+                TRY_MATCH(p, i);
+        }
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
 /* That code is adapted from libav's ff_avc_find_startcode_internal
  * and i believe the trick originated from
  * https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
@@ -150,16 +236,21 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#ifdef CAN_COMPILE_SSE2
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        return startcode_FindAnnexB_AVX2(p, end);
+#endif
+#ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
-}
+#endif
+#ifdef CAN_COMPILE_NEON_STARTCODE
+    return startcode_FindAnnexB_NEON(p, end);
 #else
-    #define startcode_FindAnnexB startcode_FindAnnexB_Bits
+    return startcode_FindAnnexB_Bits(p, end);
 #endif
+}
 
 #endif
@@ -54,11 +54,24 @@ static int MosaicCallback   ( vlc_object_t *, char const *, vlc_value_t,
 /*****************************************************************************
  * filter_sys_t : filter descriptor
  *****************************************************************************/
+
+/* Converted picture of a substream, kept while its source is displayed */
+typedef struct
+{
+    const bridged_es_t *p_es;
+    picture_t *p_source;      /* held, so that its address is not reused */
+    picture_t *p_converted;
+    unsigned i_width, i_height;
+    bool b_used;              /* used by the current Filter() call */
+} mosaic_tile_t;
+
 typedef struct
 {
     vlc_mutex_t lock;         /* Internal filter lock */
 
     image_handler_t *p_image;
+    mosaic_tile_t *p_tiles;
+    int i_tiles;
 
     int i_position;           /* Mosaic positioning method */
     bool b_ar;          /* Do we keep the aspect ratio ? */
@@ -328,6 +341,9 @@ static int CreateFilter( filter_t *p_filter )
     var_AddCallback( p_filter, CFG_PREFIX "keep-aspect-ratio", MosaicCallback,
                      p_sys );
 
+    p_sys->p_tiles = NULL;
+    p_sys->i_tiles = 0;
+
     p_sys->b_keep = var_CreateGetBoolCommand( p_filter,
                                               CFG_PREFIX "keep-picture" );
     if ( !p_sys->b_keep )
@@ -407,6 +423,13 @@ static void DestroyFilter( filter_t *p_filter )
         image_HandlerDelete( p_sys->p_image );
     }
 
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+    {
+        picture_Release( p_sys->p_tiles[i].p_source );
+        picture_Release( p_sys->p_tiles[i].p_converted );
+    }
+    free( p_sys->p_tiles );
+
     if( p_sys->i_order_length )
     {
         for( int i_index = 0; i_index < p_sys->i_order_length; i_index++ )
@@ -425,6 +448,93 @@ static void DestroyFilter( filter_t *p_filter )
     free( p_sys );
 }
 
+/*****************************************************************************
+ * Tiles
+ *****************************************************************************/
+
+/* Returns a reference to the source picture converted to fmt_out: the
+ * substreams are displayed at a lower rate than the background or are already
+ * scaled by their bridge, so most of the time there is nothing to convert */
+static picture_t *GetTile( filter_t *p_filter, const bridged_es_t *p_es,
+                           picture_t *p_source, const video_format_t *fmt_in,
+                           video_format_t *fmt_out )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    mosaic_tile_t *p_tile = NULL;
+
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+    {
+        if( p_sys->p_tiles[i].p_es == p_es )
+        {
+            p_tile = &p_sys->p_tiles[i];
+            break;
+        }
+    }
+
+    if( p_tile != NULL && p_tile->p_source == p_source
+     && p_tile->i_width == fmt_out->i_width
+     && p_tile->i_height == fmt_out->i_height )
+    {
+        p_tile->b_used = true;
+        return picture_Hold( p_tile->p_converted );
+    }
+
+    picture_t *p_converted;
+    if( p_source->format.i_chroma == fmt_out->i_chroma
+     && p_source->format.i_x_offset == 0 && p_source->format.i_y_offset == 0
+     && p_source->format.i_visible_width == fmt_out->i_width
+     && p_source->format.i_visible_height == fmt_out->i_height )
+        p_converted = picture_Hold( p_source );
+    else
+        p_converted = image_Convert( p_sys->p_image, p_source,
+                                     fmt_in, fmt_out );
+    if( p_converted == NULL )
+        return NULL;
+
+    if( p_tile == NULL )
+    {
+        mosaic_tile_t *p_tiles = realloc( p_sys->p_tiles,
+                                   (p_sys->i_tiles + 1) * sizeof (*p_tiles) );
+        if( unlikely(p_tiles == NULL) )
+            return p_converted;
+        p_sys->p_tiles = p_tiles;
+        p_tile = &p_tiles[p_sys->i_tiles++];
+        p_tile->p_es = p_es;
+    }
+    else
+    {
+        picture_Release( p_tile->p_source );
+        picture_Release( p_tile->p_converted );
+    }
+
+    p_tile->p_source = picture_Hold( p_source );
+    p_tile->p_converted = picture_Hold( p_converted );
+    p_tile->i_width = fmt_out->i_width;
+    p_tile->i_height = fmt_out->i_height;
+    p_tile->b_used = true;
+    return p_converted;
+}
+
+/* Drops the tiles of the substreams that were not displayed */
+static void PurgeTiles( filter_sys_t *p_sys )
+{
+    int i_kept = 0;
+
+    for( int i = 0; i < p_sys->i_tiles; i++ )
+    {
+        mosaic_tile_t *p_tile = &p_sys->p_tiles[i];
+        if( !p_tile->b_used )
+        {
+            picture_Release( p_tile->p_source );
+            picture_Release( p_tile->p_converted );
+            continue;
+        }
+        p_tile->b_used = false;
+        p_sys->p_tiles[i_kept++] = *p_tile;
+    }
+    p_sys->i_tiles = i_kept;
+}
+
 /*****************************************************************************
  * Filter
  *****************************************************************************/
@@ -441,6 +551,18 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
     subpicture_region_t *p_region;
     subpicture_region_t *p_region_prev = NULL;
 
+    /* Displayed picture of each substream, taken under the global lock */
+    struct
+    {
+        const bridged_es_t *p_es;
+        picture_t *p_picture;
+        int i_real_index;
+        int i_alpha;
+        int i_x;
+        int i_y;
+    } *p_sources;
+    int i_sources = 0;
+
     /* Allocate the subpicture internal data. */
     subpicture_t *p_spu = filter_NewSubpicture( p_filter );
     if( !p_spu )
@@ -519,13 +641,22 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
     row_inner_height = ( ( p_sys->i_height - ( p_sys->i_rows - 1 )
                        * p_sys->i_borderh ) / p_sys->i_rows );
 
+    p_sources = vlc_alloc( p_bridge->i_es_num, sizeof (*p_sources) );
+    if( unlikely(p_sources == NULL && p_bridge->i_es_num > 0) )
+    {
+        vlc_global_unlock( VLC_MOSAIC_MUTEX );
+        vlc_mutex_unlock( &p_sys->lock );
+        subpicture_Delete( p_spu );
+        return NULL;
+    }
+
     i_real_index = 0;
 
+    /* Only pick the pictures while the bridges are locked: the substreams
+     * keep queuing pictures while the tiles are converted */
     for( int i_index = 0; i_index < p_bridge->i_es_num; i_index++ )
     {
         bridged_es_t *p_es = p_bridge->pp_es[i_index];
-        video_format_t fmt_in, fmt_out;
-        picture_t *p_converted;
 
         if ( p_es->b_empty )
             continue;
@@ -541,6 +672,7 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
                 // front picture is late and has more pictures chained, skip it
                 front = vlc_picture_chain_PopFront( &p_es->pictures );
                 picture_Release( front );
+                p_es->i_dropped++;
                 continue;
             }
 
@@ -550,6 +682,7 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
                 front = vlc_picture_chain_PopFront( &p_es->pictures );
                 // the picture chain is empty as the front didn't have chained pics
                 picture_Release( front );
+                p_es->i_dropped++;
                 break;
             }
             else
@@ -558,6 +691,7 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
                 msg_Dbg( p_filter, "too late picture for %s (%"PRId64 ")",
                          p_es->psz_id,
                          date - front->date - p_sys->i_delay );
+                p_es->i_late++;
                 break;
             }
         }
@@ -584,13 +718,33 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             if ( i == p_sys->i_order_length )
                 i_real_index = ++i_greatest_real_index_used;
         }
+
+        p_sources[i_sources].p_es = p_es;
+        p_sources[i_sources].p_picture =
+            picture_Hold( vlc_picture_chain_PeekFront( &p_es->pictures ) );
+        p_sources[i_sources].i_real_index = i_real_index;
+        p_sources[i_sources].i_alpha = p_es->i_alpha;
+        p_sources[i_sources].i_x = p_es->i_x;
+        p_sources[i_sources].i_y = p_es->i_y;
+        i_sources++;
+    }
+
+    vlc_global_unlock( VLC_MOSAIC_MUTEX );
+
+    for( int i_source = 0; i_source < i_sources; i_source++ )
+    {
+        const bridged_es_t *p_es = p_sources[i_source].p_es;
+        video_format_t fmt_in, fmt_out;
+        picture_t *p_converted;
+
+        i_real_index = p_sources[i_source].i_real_index;
         i_row = ( i_real_index / p_sys->i_cols ) % p_sys->i_rows;
         i_col = i_real_index % p_sys->i_cols ;
 
         video_format_Init( &fmt_in, 0 );
         video_format_Init( &fmt_out, 0 );
 
-        p_converted = vlc_picture_chain_PeekFront( &p_es->pictures );
+        p_converted = p_sources[i_source].p_picture;
         if ( !p_sys->b_keep )
         {
             /* Convert the images */
@@ -624,8 +778,9 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             fmt_out.i_visible_width = fmt_out.i_width;
             fmt_out.i_visible_height = fmt_out.i_height;
 
-            p_converted = image_Convert( p_sys->p_image, p_converted,
-                                         &fmt_in, &fmt_out );
+            p_converted = GetTile( p_filter, p_es, p_converted,
+                                   &fmt_in, &fmt_out );
+            picture_Release( p_sources[i_source].p_picture );
             if( !p_converted )
             {
                 msg_Warn( p_filter,
@@ -644,11 +799,14 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             fmt_out.i_visible_height = fmt_out.i_height;
         }
 
+        /* the region uses the picture as is, it is only read */
         p_region = subpicture_region_New( &fmt_out );
-        /* FIXME the copy is probably not needed anymore */
         if( p_region )
-            picture_Copy( p_region->p_picture, p_converted );
-        if( !p_sys->b_keep )
+        {
+            picture_Release( p_region->p_picture );
+            p_region->p_picture = p_converted;
+        }
+        else
             picture_Release( p_converted );
 
         if( !p_region )
@@ -657,15 +815,18 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             video_format_Clean( &fmt_out );
             msg_Err( p_filter, "cannot allocate SPU region" );
             subpicture_Delete( p_spu );
-            vlc_global_unlock( VLC_MOSAIC_MUTEX );
+            while( ++i_source < i_sources )
+                picture_Release( p_sources[i_source].p_picture );
+            free( p_sources );
+            PurgeTiles( p_sys );
             vlc_mutex_unlock( &p_sys->lock );
             return NULL;
         }
 
-        if( p_es->i_x >= 0 && p_es->i_y >= 0 )
+        if( p_sources[i_source].i_x >= 0 && p_sources[i_source].i_y >= 0 )
         {
-            p_region->i_x = p_es->i_x;
-            p_region->i_y = p_es->i_y;
+            p_region->i_x = p_sources[i_source].i_x;
+            p_region->i_y = p_sources[i_source].i_y;
         }
         else if( p_sys->i_position == position_offsets )
         {
@@ -711,7 +872,7 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
             }
         }
         p_region->i_align = p_sys->i_align;
-        p_region->i_alpha = p_es->i_alpha;
+        p_region->i_alpha = p_sources[i_source].i_alpha;
 
         if( p_region_prev == NULL )
         {
@@ -728,7 +889,8 @@ static subpicture_t *Filter( filter_t *p_filter, vlc_tick_t date )
         p_region_prev = p_region;
     }
 
-    vlc_global_unlock( VLC_MOSAIC_MUTEX );
+    free( p_sources );
+    PurgeTiles( p_sys );
     vlc_mutex_unlock( &p_sys->lock );
 
     return p_spu;
@@ -31,6 +31,10 @@ typedef struct bridged_es_t
     int i_alpha;
     int i_x;
     int i_y;
+
+    /* Statistics, updated by the mosaic filter */
+    unsigned i_dropped; /* skipped for a newer picture or too late */
+    unsigned i_late;    /* displayed late */
 } bridged_es_t;
 
 typedef struct bridge_t
@@ -34,6 +34,9 @@
 #include <assert.h>
 #include <archive.h>
 #include <archive_entry.h>
+#ifdef HAVE_ZLIB_H
+# include <zlib.h>
+#endif
 
 #if ARCHIVE_VERSION_NUMBER < 3002000
 typedef __LA_INT64_T la_int64_t;
@@ -63,6 +66,7 @@ vlc_module_end()
 typedef struct libarchive_callback_t libarchive_callback_t;
 typedef struct private_sys_t private_sys_t;
 typedef struct archive libarchive_t;
+struct zip_member;
 
 struct private_sys_t
 {
@@ -82,6 +86,8 @@ struct private_sys_t
 
     libarchive_callback_t** pp_callback_data;
     size_t i_callback_data;
+
+    struct zip_member* p_zip;
 };
 
 struct libarchive_callback_t {
@@ -405,6 +411,489 @@ static int archive_extractor_reset( stream_extractor_t* p_extractor )
 
 /* ------------------------------------------------------------------------- */
 
+/* ZIP members are accessed directly from the source stream, without going
+ * through libarchive: stored members are mapped onto the source, and the
+ * state of deflated members is checkpointed as they are decompressed, so
+ * that a seek resumes from the nearest checkpoint rather than from the
+ * start of the member. */
+
+#define ZIP_MAX_CD_SIZE (64 << 20)
+#define ZIP_MAX_CHECKPOINTS 64
+#define ZIP_CHECKPOINT_INTERVAL (UINT64_C(4) << 20)
+
+#ifdef HAVE_ZLIB_H
+struct zip_checkpoint
+{
+    uint64_t i_offset; /* decompressed offset */
+    uint64_t i_in; /* compressed offset */
+    z_stream z;
+};
+#endif
+
+struct zip_member
+{
+    uint64_t i_data; /* offset of the member data in the source */
+    uint64_t i_csize;
+    uint64_t i_size;
+    bool b_deflate;
+#ifdef HAVE_ZLIB_H
+    z_stream z;
+    uint64_t i_in;
+    uint64_t i_interval;
+    size_t i_checkpoints;
+    struct zip_checkpoint checkpoints[ ZIP_MAX_CHECKPOINTS ];
+    uint8_t in[ 65536 ];
+#endif
+};
+
+static int zip_read_at( stream_t* source, uint64_t i_pos, void* p_buf,
+  size_t i_len )
+{
+    if( vlc_stream_Seek( source, i_pos )
+     || vlc_stream_Read( source, p_buf, i_len ) != (ssize_t)i_len )
+        return VLC_EGENERIC;
+
+    return VLC_SUCCESS;
+}
+
+static int zip_parse_member( struct zip_member* p_zip, const uint8_t* p )
+{
+    uint16_t i_flags  = GetWLE( p + 8 );
+    uint16_t i_method = GetWLE( p + 10 );
+    uint64_t i_csize  = GetDWLE( p + 20 );
+    uint64_t i_size   = GetDWLE( p + 24 );
+    uint64_t i_local  = GetDWLE( p + 42 );
+
+    /* ZIP64 EXTENDED INFORMATION */
+
+    const uint8_t* p_extra = p + 46 + GetWLE( p + 28 );
+    const uint8_t* p_end   = p_extra + GetWLE( p + 30 );
+
+    while( p_end - p_extra >= 4 )
+    {
+        uint16_t i_id  = GetWLE( p_extra );
+        uint16_t i_len = GetWLE( p_extra + 2 );
+        const uint8_t* p_field = p_extra + 4;
+
+        if( p_end - p_field < i_len )
+            break;
+
+        if( i_id == 0x0001 )
+        {
+            const uint8_t* p_field_end = p_field + i_len;
+
+            if( i_size == 0xFFFFFFFF && p_field_end - p_field >= 8 )
+                i_size = GetQWLE( p_field ), p_field += 8;
+            if( i_csize == 0xFFFFFFFF && p_field_end - p_field >= 8 )
+                i_csize = GetQWLE( p_field ), p_field += 8;
+            if( i_local == 0xFFFFFFFF && p_field_end - p_field >= 8 )
+                i_local = GetQWLE( p_field );
+        }
+
+        p_extra += 4 + i_len;
+    }
+
+    if( i_flags & 0x1 ) /* encrypted */
+        return VLC_EGENERIC;
+
+    switch( i_method )
+    {
+        case 0:
+            if( i_csize != i_size )
+                return VLC_EGENERIC;
+            p_zip->b_deflate = false;
+            break;
+#ifdef HAVE_ZLIB_H
+        case 8:
+            p_zip->b_deflate = true;
+            break;
+#endif
+        default:
+            return VLC_EGENERIC;
+    }
+
+    p_zip->i_data  = i_local;
+    p_zip->i_csize = i_csize;
+    p_zip->i_size  = i_size;
+    return VLC_SUCCESS;
+}
+
+static int zip_lookup( stream_t* source, char const* psz_name,
+  struct zip_member* p_zip )
+{
+    uint64_t i_size;
+
+    if( vlc_stream_GetSize( source, &i_size ) || i_size < 22 )
+        return VLC_EGENERIC;
+
+    /* FIND THE END OF CENTRAL DIRECTORY RECORD */
+
+    size_t i_tail = __MIN( i_size, 22 + 0xFFFF );
+    uint8_t* p_tail = malloc( i_tail );
+    uint8_t* p_cd = NULL;
+    int i_ret = VLC_EGENERIC;
+
+    if( unlikely( !p_tail ) )
+        return VLC_ENOMEM;
+
+    if( zip_read_at( source, i_size - i_tail, p_tail, i_tail ) )
+        goto out;
+
+    const uint8_t* p_eocd = NULL;
+
+    for( size_t i = i_tail - 22 + 1; i-- > 0; )
+    {
+        if( GetDWLE( p_tail + i ) == 0x06054b50 )
+        {
+            p_eocd = p_tail + i;
+            break;
+        }
+    }
+
+    if( !p_eocd )
+        goto out;
+
+    uint64_t i_cd_size   = GetDWLE( p_eocd + 12 );
+    uint64_t i_cd_offset = GetDWLE( p_eocd + 16 );
+
+    if( i_cd_size == 0xFFFFFFFF || i_cd_offset == 0xFFFFFFFF )
+    {
+        uint64_t i_eocd = i_size - i_tail + ( p_eocd - p_tail );
+        uint8_t locator[ 20 ], record[ 56 ];
+
+        if( i_eocd < sizeof( locator )
+         || zip_read_at( source, i_eocd - sizeof( locator ), locator,
+                         sizeof( locator ) )
+         || GetDWLE( locator ) != 0x07064b50
+         || zip_read_at( source, GetQWLE( locator + 8 ), record,
+                         sizeof( record ) )
+         || GetDWLE( record ) != 0x06064b50 )
+            goto out;
+
+        i_cd_size   = GetQWLE( record + 40 );
+        i_cd_offset = GetQWLE( record + 48 );
+    }
+
+    if( i_cd_size > ZIP_MAX_CD_SIZE || i_cd_offset > i_size
+     || i_cd_size > i_size - i_cd_offset )
+        goto out;
+
+    /* FIND THE MEMBER IN THE CENTRAL DIRECTORY */
+
+    p_cd = malloc( i_cd_size );
+
+    if( unlikely( !p_cd ) )
+    {
+        i_ret = VLC_ENOMEM;
+        goto out;
+    }
+
+    if( zip_read_at( source, i_cd_offset, p_cd, i_cd_size ) )
+        goto out;
+
+    size_t i_name = strlen( psz_name );
+
+    for( size_t i = 0; i_cd_size - i >= 46; )
+    {
+        const uint8_t* p = p_cd + i;
+
+        if( GetDWLE( p ) != 0x02014b50 )
+            break;
+
+        size_t i_namelen = GetWLE( p + 28 );
+        size_t i_next = i + 46 + i_namelen + GetWLE( p + 30 )
+                      + GetWLE( p + 32 );
+
+        if( i_next > i_cd_size )
+            break;
+
+        if( i_namelen == i_name && !memcmp( p + 46, psz_name, i_name ) )
+        {
+            i_ret = zip_parse_member( p_zip, p );
+            break;
+        }
+
+        i = i_next;
+    }
+
+    if( i_ret )
+        goto out;
+
+    /* SKIP THE LOCAL FILE HEADER */
+
+    uint8_t local[ 30 ];
+
+    if( zip_read_at( source, p_zip->i_data, local, sizeof( local ) )
+     || GetDWLE( local ) != 0x04034b50 )
+    {
+        i_ret = VLC_EGENERIC;
+        goto out;
+    }
+
+    p_zip->i_data += sizeof( local ) + GetWLE( local + 26 )
+                   + GetWLE( local + 28 );
+
+    if( p_zip->i_data > i_size || p_zip->i_csize > i_size - p_zip->i_data )
+        i_ret = VLC_EGENERIC;
+
+out:
+    free( p_cd );
+    free( p_tail );
+    return i_ret;
+}
+
+#ifdef HAVE_ZLIB_H
+static void zip_checkpoint( struct zip_member* p_zip, uint64_t i_offset )
+{
+    uint64_t i_last = p_zip->i_checkpoints ?
+        p_zip->checkpoints[ p_zip->i_checkpoints - 1 ].i_offset : 0;
+
+    if( i_offset < i_last + p_zip->i_interval )
+        return;
+
+    if( p_zip->i_checkpoints == ZIP_MAX_CHECKPOINTS )
+    {   /* KEEP EVERY OTHER CHECKPOINT */
+        size_t j = 0;
+
+        for( size_t i = 0; i < p_zip->i_checkpoints; ++i )
+        {
+            if( i & 1 )
+                p_zip->checkpoints[ j++ ] = p_zip->checkpoints[ i ];
+            else
+                inflateEnd( &p_zip->checkpoints[ i ].z );
+        }
+
+        p_zip->i_checkpoints = j;
+        p_zip->i_interval *= 2;
+        return;
+    }
+
+    struct zip_checkpoint* p_cp = &p_zip->checkpoints[ p_zip->i_checkpoints ];
+
+    if( inflateCopy( &p_cp->z, &p_zip->z ) != Z_OK )
+        return;
+
+    p_cp->i_offset = i_offset;
+    p_cp->i_in = p_zip->i_in - p_zip->z.avail_in;
+    p_zip->i_checkpoints++;
+}
+#endif
+
+static ssize_t zip_read( stream_extractor_t* p_extractor, void* p_data,
+  size_t i_size )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+    struct zip_member* p_zip = p_sys->p_zip;
+
+    if( p_sys->b_dead || p_sys->i_offset >= p_zip->i_size )
+        return 0;
+
+    i_size = __MIN( i_size, p_zip->i_size - p_sys->i_offset );
+
+    if( !p_zip->b_deflate )
+    {
+        ssize_t i_read = vlc_stream_Read( p_extractor->source, p_data,
+                                          i_size );
+        if( i_read > 0 )
+            p_sys->i_offset += i_read;
+
+        return i_read;
+    }
+
+#ifdef HAVE_ZLIB_H
+    p_zip->z.next_out = p_data;
+    p_zip->z.avail_out = i_size;
+
+    while( p_zip->z.avail_out == i_size )
+    {
+        if( p_zip->z.avail_in == 0 )
+        {
+            size_t i_len = __MIN( sizeof( p_zip->in ),
+                                  p_zip->i_csize - p_zip->i_in );
+            ssize_t i_read = i_len ? vlc_stream_Read( p_extractor->source,
+                                                      p_zip->in, i_len ) : 0;
+            if( i_read <= 0 )
+            {
+                msg_Err( p_extractor, "unexpected end of member" );
+                goto fatal_error;
+            }
+
+            p_zip->z.next_in = p_zip->in;
+            p_zip->z.avail_in = i_read;
+            p_zip->i_in += i_read;
+        }
+
+        int i_ret = inflate( &p_zip->z, Z_NO_FLUSH );
+
+        if( i_ret == Z_STREAM_END )
+            break;
+
+        if( i_ret != Z_OK && i_ret != Z_BUF_ERROR )
+        {
+            msg_Err( p_extractor, "corrupt member (%d)", i_ret );
+            goto fatal_error;
+        }
+    }
+
+    size_t i_ret = i_size - p_zip->z.avail_out;
+
+    p_sys->i_offset += i_ret;
+    zip_checkpoint( p_zip, p_sys->i_offset );
+    return i_ret;
+
+fatal_error:
+    p_sys->b_dead = true;
+#endif
+    return 0;
+}
+
+static int zip_seek( stream_extractor_t* p_extractor, uint64_t i_req )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+    struct zip_member* p_zip = p_sys->p_zip;
+
+    if( i_req > p_zip->i_size )
+        i_req = p_zip->i_size;
+
+    if( !p_zip->b_deflate )
+    {
+        if( vlc_stream_Seek( p_extractor->source, p_zip->i_data + i_req ) )
+            return VLC_EGENERIC;
+
+        p_sys->i_offset = i_req;
+        return VLC_SUCCESS;
+    }
+
+#ifdef HAVE_ZLIB_H
+    /* RESUME FROM THE LAST CHECKPOINT BEFORE THE REQUEST, UNLESS THE CURRENT
+     * POSITION IS CLOSER */
+
+    struct zip_checkpoint* p_cp = NULL;
+
+    for( size_t i = 0; i < p_zip->i_checkpoints; ++i )
+        if( p_zip->checkpoints[ i ].i_offset <= i_req )
+            p_cp = &p_zip->checkpoints[ i ];
+
+    uint64_t i_from = p_cp ? p_cp->i_offset : 0;
+
+    if( p_sys->b_dead || i_req < p_sys->i_offset || i_from > p_sys->i_offset )
+    {
+        int i_ret;
+
+        if( p_cp )
+        {
+            inflateEnd( &p_zip->z );
+            i_ret = inflateCopy( &p_zip->z, &p_cp->z );
+            p_zip->i_in = p_cp->i_in;
+        }
+        else
+        {
+            i_ret = inflateReset( &p_zip->z );
+            p_zip->i_in = 0;
+        }
+
+        p_zip->z.avail_in = 0;
+        p_sys->i_offset = i_from;
+
+        if( i_ret != Z_OK
+         || vlc_stream_Seek( p_extractor->source,
+                             p_zip->i_data + p_zip->i_in ) )
+        {
+            p_sys->b_dead = true;
+            return VLC_EGENERIC;
+        }
+
+        p_sys->b_dead = false;
+        msg_Dbg( p_extractor, "resuming decompression from %"PRIu64,
+                 i_from );
+    }
+
+    uint8_t dummy_buffer[ 16384 ];
+
+    while( p_sys->i_offset < i_req )
+    {
+        if( zip_read( p_extractor, dummy_buffer, __MIN( sizeof( dummy_buffer ),
+                      i_req - p_sys->i_offset ) ) <= 0 )
+            return VLC_EGENERIC;
+    }
+
+    return VLC_SUCCESS;
+#else
+    vlc_assert_unreachable();
+#endif
+}
+
+static void zip_close( struct zip_member* p_zip )
+{
+#ifdef HAVE_ZLIB_H
+    if( p_zip->b_deflate )
+    {
+        for( size_t i = 0; i < p_zip->i_checkpoints; ++i )
+            inflateEnd( &p_zip->checkpoints[ i ].z );
+
+        inflateEnd( &p_zip->z );
+    }
+#endif
+    free( p_zip );
+}
+
+static int zip_open( stream_extractor_t* p_extractor )
+{
+    private_sys_t* p_sys = p_extractor->p_sys;
+
+    if( !p_sys->b_seekable_source || p_sys->i_callback_data != 1
+     || archive_filter_code( p_sys->p_archive, 0 ) != ARCHIVE_FILTER_NONE
+     || ( archive_format( p_sys->p_archive ) & ARCHIVE_FORMAT_BASE_MASK )
+        != ARCHIVE_FORMAT_ZIP )
+        return VLC_EGENERIC;
+
+    struct zip_member* p_zip = malloc( sizeof( *p_zip ) );
+
+    if( unlikely( !p_zip ) )
+        return VLC_ENOMEM;
+
+    if( zip_lookup( p_extractor->source, p_extractor->identifier, p_zip )
+     || ( archive_entry_size_is_set( p_sys->p_entry )
+       && (uint64_t)archive_entry_size( p_sys->p_entry ) != p_zip->i_size ) )
+        goto error;
+
+#ifdef HAVE_ZLIB_H
+    if( p_zip->b_deflate )
+    {
+        p_zip->z.next_in = p_zip->in;
+        p_zip->z.avail_in = 0;
+        p_zip->z.zalloc = Z_NULL;
+        p_zip->z.zfree = Z_NULL;
+        p_zip->z.opaque = Z_NULL;
+
+        if( inflateInit2( &p_zip->z, -MAX_WBITS ) != Z_OK )
+            goto error;
+
+        p_zip->i_in = 0;
+        p_zip->i_interval = ZIP_CHECKPOINT_INTERVAL;
+        p_zip->i_checkpoints = 0;
+    }
+#endif
+
+    if( vlc_stream_Seek( p_extractor->source, p_zip->i_data ) )
+    {
+        zip_close( p_zip );
+        return VLC_EGENERIC;
+    }
+
+    msg_Dbg( p_extractor, "accessing %s member directly",
+             p_zip->b_deflate ? "deflated" : "stored" );
+    p_sys->p_zip = p_zip;
+    p_sys->i_offset = 0;
+    return VLC_SUCCESS;
+
+error:
+    free( p_zip );
+    return VLC_EGENERIC;
+}
+
+/* ------------------------------------------------------------------------- */
+
 static private_sys_t* setup( vlc_object_t* obj, stream_t* source )
 {
     private_sys_t* p_sys  = calloc( 1, sizeof( *p_sys ) );
@@ -498,7 +987,7 @@ static int Control( stream_extractor_t* p_extractor, int i_query, va_list args )
     switch( i_query )
     {
         case STREAM_CAN_FASTSEEK:
-            *va_arg( args, bool* ) = false;
+            *va_arg( args, bool* ) = p_sys->p_zip && !p_sys->p_zip->b_deflate;
             break;
 
         case STREAM_CAN_SEEK:
@@ -571,6 +1060,9 @@ static ssize_t Read( stream_extractor_t *p_extractor, void* p_data, size_t i_siz
     libarchive_t* p_arc = p_sys->p_archive;
     ssize_t       i_ret;
 
+    if( p_sys->p_zip )
+        return zip_read( p_extractor, p_data, i_size );
+
     if( p_sys->b_dead || p_sys->p_entry == NULL )
         return 0;
 
@@ -627,6 +1119,9 @@ static int Seek( stream_extractor_t* p_extractor, uint64_t i_req )
 {
     private_sys_t* p_sys = p_extractor->p_sys;
 
+    if( p_sys->p_zip )
+        return zip_seek( p_extractor, i_req );
+
     if( !p_sys->p_entry || !p_sys->b_seekable_source )
         return VLC_EGENERIC;
 
@@ -675,6 +1170,9 @@ static void CommonClose( private_sys_t* p_sys )
     p_sys->b_dead = true;
     archive_clean( p_sys );
 
+    if( p_sys->p_zip )
+        zip_close( p_sys->p_zip );
+
     for( size_t i = 0; i < p_sys->i_callback_data; ++i )
     {
         free( p_sys->pp_callback_data[i]->psz_url );
@@ -745,6 +1243,7 @@ static int ExtractorOpen( vlc_object_t* p_obj )
     }
 
     p_extractor->p_sys = p_sys;
+    zip_open( p_extractor );
     p_extractor->pf_read = Read;
     p_extractor->pf_control = Control;
     p_extractor->pf_seek = Seek;
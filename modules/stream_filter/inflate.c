@@ -34,13 +34,12 @@ typedef struct
 {
     z_stream zstream;
     bool eof;
-    unsigned char buffer[16384];
+    unsigned char buffer[65536];
 } stream_sys_t;
 
 static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
 {
     stream_sys_t *sys = stream->p_sys;
-    ssize_t val;
 
     if (sys->eof || unlikely(buflen == 0))
         return 0;
@@ -48,50 +47,47 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
     sys->zstream.next_out = buf;
     sys->zstream.avail_out = buflen;
 
-    if (sys->zstream.avail_in == 0)
-        sys->zstream.next_in = sys->buffer;
-
-    val = (sys->buffer + sizeof (sys->buffer))
-        - (sys->zstream.next_in + sys->zstream.avail_in);
-
-    if (val > 0)
-    {   /* Fill input buffer if there is space left */
-        val = vlc_stream_Read(stream->s,
-                          sys->zstream.next_in + sys->zstream.avail_in, val);
-        if (val >= 0)
-            sys->zstream.avail_in += val;
-    }
-
-    if (sys->zstream.avail_in == 0)
+    /* Decompress until some output is produced. Input is refilled only once
+     * it is fully consumed, as much as available at once. */
+    while (sys->zstream.avail_out == buflen)
     {
-        msg_Err(stream, "unexpected end of stream");
-        return 0;
-    }
-
-    val = inflate(&sys->zstream, Z_SYNC_FLUSH);
-    switch (val)
-    {
-        case Z_STREAM_END:
-            msg_Dbg(stream, "end of stream");
-            sys->eof = true;
-            /* fall through */
-        case Z_OK:
-            return buflen - sys->zstream.avail_out;
-        case Z_DATA_ERROR:
-            msg_Err(stream, "corrupt stream");
-            sys->eof = true;
-            return -1;
-        case Z_BUF_ERROR:
-            if (sys->zstream.next_in == sys->buffer)
-                break;
-
-            memmove(sys->buffer, sys->zstream.next_in, sys->zstream.avail_in);
+        if (sys->zstream.avail_in == 0)
+        {
+            ssize_t val = vlc_stream_ReadPartial(stream->s, sys->buffer,
+                                                 sizeof (sys->buffer));
+            if (val <= 0)
+            {
+                msg_Err(stream, "unexpected end of stream");
+                return 0;
+            }
             sys->zstream.next_in = sys->buffer;
-            return Read(stream, buf, buflen);
+            sys->zstream.avail_in = val;
+        }
+
+        int val = inflate(&sys->zstream, Z_SYNC_FLUSH);
+        switch (val)
+        {
+            case Z_STREAM_END:
+                msg_Dbg(stream, "end of stream");
+                sys->eof = true;
+                /* fall through */
+            case Z_OK:
+            case Z_BUF_ERROR: /* input exhausted */
+                break;
+            case Z_DATA_ERROR:
+                msg_Err(stream, "corrupt stream");
+                sys->eof = true;
+                return -1;
+            default:
+                msg_Err(stream, "unhandled decompression error (%d)", val);
+                return -1;
+        }
+
+        if (sys->eof)
+            break;
     }
 
-    msg_Err(stream, "unhandled decompression error (%zd)", val);
-    return -1;
+    return buflen - sys->zstream.avail_out;
 }
 
 static int Seek(stream_t *stream, uint64_t offset)
@@ -49,6 +49,18 @@ struct stream_ctrl
     };
 };
 
+/* Data saved from the buffer when seeking away from it */
+struct stream_extent
+{
+    struct stream_extent *next; /* most recently used first */
+    uint64_t offset;
+    size_t length;
+    char data[];
+};
+
+/* Smallest read-ahead window with adaptive prefetching */
+#define PREFETCH_MIN_WINDOW (1 << 20)
+
 typedef struct
 {
     vlc_mutex_t  lock;
@@ -75,9 +87,120 @@ typedef struct
     char        *buffer;
     size_t       seek_threshold;
 
+    struct stream_extent *extents;
+    size_t       extents_size;
+    size_t       cache_size;
+
+    bool         adaptive;
+    uint64_t     rate; /* consumption rate (bytes per second) */
+    uint64_t     rate_bytes;
+    vlc_tick_t   rate_date;
+    vlc_tick_t   rtt; /* upstream seek latency */
+
     struct stream_ctrl *controls;
 } stream_sys_t;
 
+static struct stream_extent *ExtentFind(stream_sys_t *sys, uint64_t offset)
+{
+    for (struct stream_extent *ext = sys->extents; ext != NULL; ext = ext->next)
+        if (offset >= ext->offset && offset - ext->offset < ext->length)
+            return ext;
+    return NULL;
+}
+
+static void ExtentTouch(stream_sys_t *sys, struct stream_extent *ext)
+{
+    struct stream_extent **pp = &sys->extents;
+
+    while (*pp != ext)
+        pp = &(*pp)->next;
+    *pp = ext->next;
+    ext->next = sys->extents;
+    sys->extents = ext;
+}
+
+/**
+ * Saves the buffered data into a new extent, if it cannot be read back
+ * after the buffer is reset. The least recently used extents are dropped to
+ * stay within the cache size.
+ */
+static void ExtentSave(stream_sys_t *sys)
+{
+    uint64_t offset = sys->buffer_offset;
+    size_t length = sys->buffer_length;
+
+    if (length > sys->cache_size)
+    {   /* Keep the most recent data */
+        offset += length - sys->cache_size;
+        length = sys->cache_size;
+    }
+    if (length == 0)
+        return;
+
+    /* Drop the overlapping extents */
+    for (struct stream_extent **pp = &sys->extents, *ext; (ext = *pp) != NULL;)
+        if (ext->offset < offset + length
+         && offset < ext->offset + ext->length)
+        {
+            *pp = ext->next;
+            sys->extents_size -= ext->length;
+            free(ext);
+        }
+        else
+            pp = &ext->next;
+
+    /* Drop the least recently used extents */
+    while (sys->extents_size + length > sys->cache_size)
+    {
+        struct stream_extent **pp = &sys->extents;
+
+        assert(*pp != NULL);
+        while ((*pp)->next != NULL)
+            pp = &(*pp)->next;
+        sys->extents_size -= (*pp)->length;
+        free(*pp);
+        *pp = NULL;
+    }
+
+    struct stream_extent *ext = malloc(sizeof (*ext) + length);
+    if (unlikely(ext == NULL))
+        return;
+
+    size_t start = offset % sys->buffer_size;
+    size_t first = sys->buffer_size - start;
+    if (first > length)
+        first = length;
+
+    memcpy(ext->data, sys->buffer + start, first);
+    memcpy(ext->data + first, sys->buffer, length - first);
+    ext->offset = offset;
+    ext->length = length;
+    ext->next = sys->extents;
+    sys->extents = ext;
+    sys->extents_size += length;
+}
+
+/**
+ * Returns how much data to read ahead of the downstream offset.
+ *
+ * On seekable streams, reading far ahead is wasted if the demux seeks away.
+ * The window covers the network caching delay and the upstream latency at
+ * the measured consumption rate, with a safety margin.
+ */
+static size_t ReadAheadWindow(const stream_sys_t *sys)
+{
+    if (!sys->adaptive || sys->rate == 0)
+        return sys->buffer_size;
+
+    uint64_t window = 2 * sys->rate
+                    * (sys->pts_delay + 2 * sys->rtt) / CLOCK_FREQ;
+    if (window < PREFETCH_MIN_WINDOW)
+        window = PREFETCH_MIN_WINDOW;
+    if (window > sys->buffer_size)
+        window = sys->buffer_size;
+    return window;
+}
+
 static ssize_t ThreadRead(stream_t *stream, void *buf, size_t length)
 {
     stream_sys_t *sys = stream->p_sys;
@@ -97,11 +220,14 @@ static int ThreadSeek(stream_t *stream, uint64_t seek_offset)
 
     vlc_mutex_unlock(&sys->lock);
 
+    vlc_tick_t start = vlc_tick_now();
     int val = vlc_stream_Seek(stream->s, seek_offset);
     if (val != VLC_SUCCESS)
         msg_Err(stream, "cannot seek (to offset %"PRIu64")", seek_offset);
+    vlc_tick_t rtt = vlc_tick_now() - start;
 
     vlc_mutex_lock(&sys->lock);
+    sys->rtt = (sys->rtt * 3 + rtt) / 4;
 
     return (val == VLC_SUCCESS) ? 0 : -1;
 }
@@ -161,8 +287,17 @@ static void *Thread(void *data)
 
         uint_fast64_t stream_offset = sys->stream_offset;
 
+        if ((stream_offset < sys->buffer_offset
+          || stream_offset - sys->buffer_offset >= sys->buffer_length))
+        {   /* Data read from a saved extent: prefetch what follows it */
+            const struct stream_extent *ext = ExtentFind(sys, stream_offset);
+            if (ext != NULL)
+                stream_offset = ext->offset + ext->length;
+        }
+
         if (stream_offset < sys->buffer_offset)
         {   /* Need to seek backward */
+            ExtentSave(sys);
             if (ThreadSeek(stream, stream_offset) == 0)
             {
                 sys->buffer_offset = stream_offset;
@@ -199,6 +334,7 @@ static void *Thread(void *data)
         if (sys->can_seek
          && history >= (sys->buffer_length + sys->seek_threshold))
         {
+            ExtentSave(sys);
             if (ThreadSeek(stream, stream_offset) == 0)
             {
                 sys->buffer_offset = stream_offset;
@@ -220,6 +356,13 @@ static void *Thread(void *data)
 
         assert(sys->buffer_size >= sys->buffer_length);
 
+        if (history < sys->buffer_length
+         && sys->buffer_length - history >= ReadAheadWindow(sys))
+        {   /* Enough data read ahead */
+            vlc_cond_wait(&sys->wait_space, &sys->lock);
+            continue;
+        }
+
         size_t len = sys->buffer_size - sys->buffer_length;
         if (len == 0)
         {   /* Buffer is full */
@@ -311,7 +454,10 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         vlc_cond_signal(&sys->wait_space);
     }
 
-    while ((copy = BufferLevel(stream, &eof)) == 0 && !eof)
+    struct stream_extent *ext = NULL;
+
+    while ((copy = BufferLevel(stream, &eof)) == 0
+        && (ext = ExtentFind(sys, sys->stream_offset)) == NULL && !eof)
     {
         void *data[2];
 
@@ -326,15 +472,40 @@ static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
         vlc_interrupt_forward_stop(data);
     }
 
-    offset = sys->stream_offset % sys->buffer_size;
-    if (copy > buflen)
-        copy = buflen;
-    /* Do not step past the sharp edge of the circular buffer */
-    if (offset + copy > sys->buffer_size)
-        copy = sys->buffer_size - offset;
-
-    memcpy(buf, sys->buffer + offset, copy);
+    if (copy == 0 && ext != NULL)
+    {   /* Read from a saved extent */
+        offset = sys->stream_offset - ext->offset;
+        copy = ext->length - offset;
+        if (copy > buflen)
+            copy = buflen;
+        memcpy(buf, ext->data + offset, copy);
+        ExtentTouch(sys, ext);
+    }
+    else
+    {
+        offset = sys->stream_offset % sys->buffer_size;
+        if (copy > buflen)
+            copy = buflen;
+        /* Do not step past the sharp edge of the circular buffer */
+        if (offset + copy > sys->buffer_size)
+            copy = sys->buffer_size - offset;
+
+        memcpy(buf, sys->buffer + offset, copy);
+    }
     sys->stream_offset += copy;
+
+    /* Measure the consumption rate */
+    vlc_tick_t now = vlc_tick_now();
+
+    sys->rate_bytes += copy;
+    if (now - sys->rate_date >= VLC_TICK_FROM_SEC(1))
+    {
+        uint64_t rate = sys->rate_bytes * CLOCK_FREQ / (now - sys->rate_date);
+
+        sys->rate = sys->rate ? (sys->rate * 3 + rate) / 4 : rate;
+        sys->rate_bytes = 0;
+        sys->rate_date = now;
+    }
     vlc_cond_signal(&sys->wait_space);
     vlc_mutex_unlock(&sys->lock);
     return copy;
@@ -386,6 +557,9 @@ static int Control(stream_t *stream, int query, va_list args)
 
             vlc_mutex_lock(&sys->lock);
             sys->paused = paused;
+            /* Do not account the pause in the consumption rate */
+            sys->rate_bytes = 0;
+            sys->rate_date = vlc_tick_now();
             vlc_cond_signal(&sys->wait_space);
             vlc_mutex_unlock (&sys->lock);
             break;
@@ -465,6 +639,16 @@ static int Open(vlc_object_t *obj)
     sys->buffer_length = 0;
     sys->buffer_size = var_InheritInteger(obj, "prefetch-buffer-size") << 10u;
     sys->seek_threshold = var_InheritInteger(obj, "prefetch-seek-threshold");
+    sys->extents = NULL;
+    sys->extents_size = 0;
+    sys->cache_size = sys->can_seek
+        ? var_InheritInteger(obj, "prefetch-cache-size") << 10u : 0;
+    /* Streams that cannot be paced must be drained as fast as possible */
+    sys->adaptive = sys->can_seek && sys->can_pace;
+    sys->rate = 0;
+    sys->rate_bytes = 0;
+    sys->rate_date = vlc_tick_now();
+    sys->rtt = 0;
     sys->controls = NULL;
 
     uint64_t size = stream_Size(stream->s);
@@ -530,6 +714,12 @@ static void Close (vlc_object_t *obj)
         sys->controls = ctrl->next;
         free(ctrl);
     }
+    while (sys->extents != NULL)
+    {
+        struct stream_extent *ext = sys->extents;
+        sys->extents = ext->next;
+        free(ext);
+    }
     free(sys->buffer);
     free(sys->content_type);
     free(sys);
@@ -550,4 +740,8 @@ vlc_module_begin()
     add_integer("prefetch-seek-threshold", 1 << 14, N_("Seek threshold"),
                 N_("Prefetch forward seek threshold (bytes)"), true)
         change_integer_range(0, UINT64_C(1) << 60)
+    add_integer("prefetch-cache-size", 1 << 12, N_("Cache size"),
+                N_("Size of the data kept from previously read ranges "
+                   "of seekable streams (KiB)"), true)
+        change_integer_range(0, 1 << 20)
 vlc_module_end()
@@ -64,6 +64,7 @@ typedef struct
  * Local prototypes
  ****************************************************************************/
 static ssize_t Read( stream_t *, void *p_read, size_t i_read );
+static block_t *Block( stream_t *, bool *pb_eof );
 static int  Seek   ( stream_t *, uint64_t );
 static int  Control( stream_t *, int i_query, va_list );
 
@@ -86,8 +87,12 @@ static int Open ( vlc_object_t *p_this )
 
     p_sys->f = NULL;
 
-    /* */
-    s->pf_read = Read;
+    /* Forward the blocks of block-based sources as is, rather than copying
+     * them to the reader buffer */
+    if( s->s->pf_block != NULL )
+        s->pf_block = Block;
+    else
+        s->pf_read = Read;
     s->pf_seek = Seek;
     s->pf_control = Control;
 
@@ -127,6 +132,24 @@ static ssize_t Read( stream_t *s, void *p_read, size_t i_read )
     return i_record;
 }
 
+static block_t *Block( stream_t *s, bool *pb_eof )
+{
+    stream_sys_t *p_sys = s->p_sys;
+    block_t *p_block = vlc_stream_ReadBlock( s->s );
+
+    if( p_block == NULL )
+    {
+        *pb_eof = vlc_stream_Eof( s->s );
+        return NULL;
+    }
+
+    /* Dump read data */
+    if( p_sys->f )
+        Write( s, p_block->p_buffer, p_block->i_buffer );
+
+    return p_block;
+}
+
 static int Seek( stream_t *s, uint64_t offset )
 {
     return vlc_stream_Seek( s->s, offset );
@@ -0,0 +1,176 @@
+/*****************************************************************************
+ * zstd.c: Zstandard decompression module for VLC
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <zstd.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_stream.h>
+
+typedef struct
+{
+    ZSTD_DStream *dstream;
+    ZSTD_inBuffer in;
+    bool frame_end;
+    bool eof;
+    unsigned char buffer[131072];
+} stream_sys_t;
+
+static ssize_t Read(stream_t *stream, void *buf, size_t buflen)
+{
+    stream_sys_t *sys = stream->p_sys;
+    ZSTD_outBuffer out = { .dst = buf, .size = buflen, .pos = 0 };
+
+    if (sys->eof || unlikely(buflen == 0))
+        return 0;
+
+    /* Decompress until some output is produced. Input is refilled only once
+     * it is fully consumed, as much as available at once. */
+    while (out.pos == 0)
+    {
+        if (sys->in.pos == sys->in.size)
+        {
+            ssize_t val = vlc_stream_ReadPartial(stream->s, sys->buffer,
+                                                 sizeof (sys->buffer));
+            if (val <= 0)
+            {
+                /* A stream is a sequence of frames */
+                if (sys->frame_end)
+                    msg_Dbg(stream, "end of stream");
+                else
+                    msg_Err(stream, "unexpected end of stream");
+                sys->eof = true;
+                return 0;
+            }
+            sys->in.src = sys->buffer;
+            sys->in.size = val;
+            sys->in.pos = 0;
+        }
+
+        size_t ret = ZSTD_decompressStream(sys->dstream, &out, &sys->in);
+        if (ZSTD_isError(ret))
+        {
+            msg_Err(stream, "corrupt stream: %s", ZSTD_getErrorName(ret));
+            sys->eof = true;
+            return -1;
+        }
+        sys->frame_end = ret == 0;
+    }
+
+    return out.pos;
+}
+
+static int Seek(stream_t *stream, uint64_t offset)
+{
+    (void) stream; (void) offset;
+    return -1;
+}
+
+static int Control(stream_t *stream, int query, va_list args)
+{
+    switch (query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+            *va_arg(args, bool *) = false;
+            break;
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+        case STREAM_GET_PTS_DELAY:
+        case STREAM_GET_META:
+        case STREAM_GET_CONTENT_TYPE:
+        case STREAM_GET_SIGNAL:
+        case STREAM_SET_PAUSE_STATE:
+            return vlc_stream_vaControl(stream->s, query, args);
+        case STREAM_GET_SIZE:
+        case STREAM_GET_TITLE_INFO:
+        case STREAM_GET_TITLE:
+        case STREAM_GET_SEEKPOINT:
+        case STREAM_SET_TITLE:
+        case STREAM_SET_SEEKPOINT:
+        case STREAM_SET_PRIVATE_ID_STATE:
+        case STREAM_SET_PRIVATE_ID_CA:
+        case STREAM_GET_PRIVATE_ID_STATE:
+            return VLC_EGENERIC;
+        default:
+            msg_Err(stream, "unimplemented query (%d) in control", query);
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static int Open(vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    const uint8_t *peek;
+
+    if (vlc_stream_Peek(stream->s, &peek, 4) < 4
+     || GetDWLE(peek) != ZSTD_MAGICNUMBER)
+        return VLC_EGENERIC;
+
+    stream_sys_t *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return VLC_ENOMEM;
+
+    sys->dstream = ZSTD_createDStream();
+    if (sys->dstream == NULL)
+    {
+        free(sys);
+        return VLC_ENOMEM;
+    }
+    ZSTD_initDStream(sys->dstream);
+
+    sys->in.src = sys->buffer;
+    sys->in.size = 0;
+    sys->in.pos = 0;
+    sys->frame_end = false;
+    sys->eof = false;
+
+    msg_Dbg(stream, "detected Zstandard compressed stream");
+    stream->p_sys = sys;
+    stream->pf_read = Read;
+    stream->pf_seek = Seek;
+    stream->pf_control = Control;
+    return VLC_SUCCESS;
+}
+
+static void Close (vlc_object_t *obj)
+{
+    stream_t *stream = (stream_t *)obj;
+    stream_sys_t *sys = stream->p_sys;
+
+    ZSTD_freeDStream(sys->dstream);
+    free(sys);
+}
+
+vlc_module_begin()
+    set_category(CAT_INPUT)
+    set_subcategory(SUBCAT_INPUT_STREAM_FILTER)
+    set_capability("stream_filter", 330)
+
+    set_description(N_("Zstandard decompression filter"))
+    set_callbacks(Open, Close)
+vlc_module_end()
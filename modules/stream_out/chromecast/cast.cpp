@@ -39,6 +39,7 @@
 #include <vlc_modules.h>
 #include <vlc_httpd.h>
 
+#include <algorithm>
 #include <cassert>
 
 #define TRANSCODING_NONE 0x0
@@ -104,6 +105,10 @@ struct sout_stream_sys_t
         , out_force_reload( false )
         , perf_warning_shown( false )
         , transcoding_state( TRANSCODING_NONE )
+        , remuxed_video( 0 )
+        , remuxed_audio( 0 )
+        , out_mp4( false )
+        , mp4_rejected( false )
         , venc_opt_idx ( -1 )
         , out_streams_added( 0 )
     {
@@ -126,6 +131,8 @@ struct sout_stream_sys_t
     bool isFlushing( sout_stream_t* );
     void setNextTranscodingState();
     bool transcodingCanFallback() const;
+    bool isRejected( vlc_fourcc_t i_codec ) const;
+    void rejectRemuxedCodec();
 
     httpd_host_t      *httpd_host;
     sout_access_out_sys_t access_out_live;
@@ -150,6 +157,14 @@ struct sout_stream_sys_t
     bool                               out_force_reload;
     bool                               perf_warning_shown;
     int                                transcoding_state;
+    /* Codecs passed through the current chain, and the receiver capabilities
+     * learnt from its load failures: kept for the whole casting session, so
+     * that the next media starts from a configuration known to work */
+    vlc_fourcc_t                       remuxed_video;
+    vlc_fourcc_t                       remuxed_audio;
+    bool                               out_mp4;
+    bool                               mp4_rejected;
+    std::vector<vlc_fourcc_t>          rejected_codecs;
     int                                venc_opt_idx;
     std::vector<sout_stream_id_sys_t*> streams;
     std::vector<sout_stream_id_sys_t*> out_streams;
@@ -174,6 +189,9 @@ struct sout_stream_id_sys_t
 
 static const char DEFAULT_MUXER[] = "avformat{mux=matroska,options={live=1},reset-ts}";
 static const char DEFAULT_MUXER_WEBM[] = "avformat{mux=webm,options={live=1},reset-ts}";
+/* Native muxer, no libavformat round trip, for the H.264/HEVC and AAC/MP3
+ * streams that the receivers play as is */
+static const char DEFAULT_MUXER_MP4[] = "mp4frag";
 
 
 /*****************************************************************************
@@ -760,6 +778,8 @@ bool sout_stream_sys_t::canDecodeVideo( vlc_fourcc_t i_codec ) const
 {
     if( transcoding_state & TRANSCODING_VIDEO )
         return false;
+    if( isRejected( i_codec ) )
+        return false;
     return i_codec == VLC_CODEC_H264 || i_codec == VLC_CODEC_HEVC
         || i_codec == VLC_CODEC_VP8 || i_codec == VLC_CODEC_VP9;
 }
@@ -770,6 +790,8 @@ bool sout_stream_sys_t::canDecodeAudio( sout_stream_t *p_stream,
 {
     if( transcoding_state & TRANSCODING_AUDIO )
         return false;
+    if( isRejected( i_codec ) )
+        return false;
     if ( i_codec == VLC_CODEC_A52 || i_codec == VLC_CODEC_EAC3 )
     {
         return var_InheritBool( p_stream, SOUT_CFG_PREFIX "audio-passthrough" );
@@ -860,8 +882,8 @@ bool sout_stream_sys_t::startSoutChain(sout_stream_t *p_stream,
     }
 
     /* Ask to retry if we are not transcoding everything (because we can trust
-     * what we encode) */
-    p_intf->setRetryOnFail(transcodingCanFallback());
+     * what we encode), or if the MP4 muxer may be what the receiver refuses */
+    p_intf->setRetryOnFail(transcodingCanFallback() || out_mp4);
 
     return true;
 }
@@ -879,6 +901,27 @@ bool sout_stream_sys_t::transcodingCanFallback() const
     return transcoding_state != (TRANSCODING_VIDEO|TRANSCODING_AUDIO);
 }
 
+bool sout_stream_sys_t::isRejected( vlc_fourcc_t i_codec ) const
+{
+    return std::find( rejected_codecs.begin(), rejected_codecs.end(), i_codec )
+           != rejected_codecs.end();
+}
+
+/* Remembers the passed through codec that the next transcoding state will
+ * convert, so that it is converted right away for the next media */
+void sout_stream_sys_t::rejectRemuxedCodec()
+{
+    vlc_fourcc_t i_codec = 0;
+
+    if ( !(transcoding_state & TRANSCODING_VIDEO) )
+        i_codec = remuxed_video;
+    else if ( !(transcoding_state & TRANSCODING_AUDIO) )
+        i_codec = remuxed_audio;
+
+    if ( i_codec != 0 && !isRejected( i_codec ) )
+        rejected_codecs.push_back( i_codec );
+}
+
 std::string
 sout_stream_sys_t::GetAcodecOption( sout_stream_t *p_stream, vlc_fourcc_t *p_codec_audio,
                                     const audio_format_t *p_aud, int i_quality )
@@ -1017,6 +1060,10 @@ bool sout_stream_sys_t::UpdateOutput( sout_stream_t *p_stream )
 
     std::stringstream ssout;
     int new_transcoding_state = TRANSCODING_NONE;
+    /* Only the incompatible tracks are converted: the others are passed
+     * through as is */
+    remuxed_video = i_codec_video;
+    remuxed_audio = i_codec_audio;
     if ( !canRemux )
     {
         if ( !perf_warning_shown && i_codec_video == 0 && p_original_video
@@ -1083,8 +1130,17 @@ bool sout_stream_sys_t::UpdateOutput( sout_stream_t *p_stream )
             mime = "video/x-matroska";
     }
 
+    out_mp4 = !is_webm && !mp4_rejected && !p_original_spu
+           && ( i_codec_video == VLC_CODEC_H264 ||
+                i_codec_video == VLC_CODEC_HEVC || !p_original_video )
+           && ( i_codec_audio == VLC_CODEC_MP4A ||
+                i_codec_audio == VLC_CODEC_MP3 || !p_original_audio );
+    if ( out_mp4 )
+        mime = p_original_video ? "video/mp4" : "audio/mp4";
+
     ssout << "chromecast-proxy:"
-          << "std{mux=" << ( is_webm ? DEFAULT_MUXER_WEBM : DEFAULT_MUXER )
+          << "std{mux=" << ( out_mp4 ? DEFAULT_MUXER_MP4 :
+                             is_webm ? DEFAULT_MUXER_WEBM : DEFAULT_MUXER )
           << ",access=chromecast-http}";
 
     if ( !startSoutChain( p_stream, new_streams, ssout.str(),
@@ -1211,8 +1267,17 @@ static void on_input_event_cb(void *data, enum cc_input_event event, union cc_in
             break;
         case CC_INPUT_EVENT_RETRY:
             p_sys->stopSoutChain( p_stream );
-            if( p_sys->transcodingCanFallback() )
+            if( p_sys->out_mp4 && !p_sys->mp4_rejected )
+            {
+                /* Try the same tracks in Matroska first */
+                p_sys->mp4_rejected = true;
+                msg_Warn(p_stream, "Load failed detected. Switching to the "
+                         "Matroska muxer");
+                p_sys->out_force_reload = p_sys->es_changed = true;
+            }
+            else if( p_sys->transcodingCanFallback() )
             {
+                p_sys->rejectRemuxedCodec();
                 p_sys->setNextTranscodingState();
                 msg_Warn(p_stream, "Load failed detected. Switching to next "
                          "configuration. Transcoding video%s",
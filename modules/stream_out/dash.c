@@ -0,0 +1,850 @@
+/*****************************************************************************
+ * dash.c: live MPEG-DASH packager stream output
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Each audio or video ES becomes a representation of its own, packaged as
+ * fragmented MP4: one initialization segment, then one moof/mdat segment
+ * every seglen seconds (on a key frame for video). The manifest is a dynamic
+ * MPD with a SegmentTimeline over the last window segments.
+ *
+ * Every file is published through a sout access (file, http-put...), and the
+ * samples are handed over to it as they came, after the moof and mdat
+ * headers: the payloads are never copied.
+ */
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <time.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_sout.h>
+#include <vlc_block.h>
+#include <vlc_fs.h>
+#include <vlc_memstream.h>
+
+#include "../demux/mp4/libmp4.h"
+#include "../mux/mp4/libmp4mux.h"
+#include "../mux/extradata.h"
+#include "../packetizer/hxxx_nal.h"
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+#define ACCESS_TEXT N_("Output access method")
+#define ACCESS_LONGTEXT N_("Access module used to publish the manifest " \
+                           "and the segments (file, http-put...).")
+#define DST_TEXT N_("Output location")
+#define DST_LONGTEXT N_("Directory or base URL where the manifest and the " \
+                        "segments are published.")
+#define MPD_TEXT N_("Manifest name")
+#define MPD_LONGTEXT N_("Name of the MPD, relative to the output location.")
+#define SEGLEN_TEXT N_("Segment length")
+#define SEGLEN_LONGTEXT N_("Length of the segments in seconds. Video " \
+                           "segments start on a key frame, hence may be " \
+                           "longer.")
+#define WINDOW_TEXT N_("Timeline window")
+#define WINDOW_LONGTEXT N_("Number of segments listed in the manifest.")
+#define DELSEGS_TEXT N_("Delete segments")
+#define DELSEGS_LONGTEXT N_("Delete the segments that left the timeline " \
+                            "(file access only).")
+
+static int  Open ( vlc_object_t * );
+static void Close( vlc_object_t * );
+
+#define SOUT_CFG_PREFIX "sout-dash-"
+
+vlc_module_begin ()
+    set_shortname( N_("DASH") )
+    set_description( N_("Live MPEG-DASH packager") )
+    set_capability( "sout output", 0 )
+    add_shortcut( "dash" )
+    set_category( CAT_SOUT )
+    set_subcategory( SUBCAT_SOUT_STREAM )
+    add_string( SOUT_CFG_PREFIX "access", "file", ACCESS_TEXT,
+                ACCESS_LONGTEXT, false )
+    add_string( SOUT_CFG_PREFIX "dst", ".", DST_TEXT, DST_LONGTEXT, false )
+    add_string( SOUT_CFG_PREFIX "mpd", "live.mpd", MPD_TEXT, MPD_LONGTEXT,
+                false )
+    add_integer_with_range( SOUT_CFG_PREFIX "seglen", 4, 1, 60,
+                            SEGLEN_TEXT, SEGLEN_LONGTEXT, false )
+    add_integer_with_range( SOUT_CFG_PREFIX "window", 5, 2, 1000,
+                            WINDOW_TEXT, WINDOW_LONGTEXT, false )
+    add_bool( SOUT_CFG_PREFIX "delsegs", true, DELSEGS_TEXT,
+              DELSEGS_LONGTEXT, false )
+    set_callbacks( Open, Close )
+vlc_module_end ()
+
+/*****************************************************************************
+ * Local prototypes
+ *****************************************************************************/
+static const char *const ppsz_sout_options[] = {
+    "access", "dst", "mpd", "seglen", "window", "delsegs", NULL
+};
+
+typedef struct
+{
+    uint64_t i_time;     /* in track timescale */
+    uint64_t i_duration;
+} dash_segment_t;
+
+typedef struct
+{
+    char psz_id[16];
+    mp4mux_handle_t *muxh;
+    mp4mux_trackinfo_t *tinfo;
+    mux_extradata_builder_t *extrabuilder;
+    uint32_t i_timescale;
+    bool b_bframes;
+    bool b_init_written;
+
+    /* sample waiting for the next one, to know its duration */
+    block_t *p_held;
+
+    /* ongoing segment */
+    block_t *p_first;
+    block_t **pp_last;
+    unsigned i_samples;
+    size_t i_size;
+    vlc_tick_t i_length;
+
+    /* time of the next sample from the stream origin */
+    vlc_tick_t i_time;
+    uint32_t i_sequence;
+    unsigned i_bitrate;
+
+    /* ring of the segments listed in the manifest */
+    dash_segment_t *timeline;
+    unsigned i_timeline_first;
+    unsigned i_timeline_count;
+} dash_rep_t;
+
+typedef struct
+{
+    char *psz_access;
+    char *psz_dst;
+    char *psz_mpd;
+    vlc_tick_t i_seglen;
+    unsigned i_window;
+    bool b_delsegs;
+
+    vlc_tick_t i_origin;
+    time_t i_start_time;
+    unsigned i_video_count;
+    unsigned i_audio_count;
+
+    int i_reps;
+    dash_rep_t **pp_reps;
+} sout_stream_sys_t;
+
+static int Publish( sout_stream_t *p_stream, const char *psz_name,
+                    block_t *p_chain )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    char *psz_path;
+
+    if( asprintf( &psz_path, "%s/%s", p_sys->psz_dst, psz_name ) < 0 )
+    {
+        block_ChainRelease( p_chain );
+        return VLC_ENOMEM;
+    }
+
+    /* Local files are renamed once complete, not to be read half written */
+    const bool b_file = !strcmp( p_sys->psz_access, "file" );
+    char *psz_tmp = NULL;
+    if( b_file && asprintf( &psz_tmp, "%s.tmp", psz_path ) < 0 )
+    {
+        free( psz_path );
+        block_ChainRelease( p_chain );
+        return VLC_ENOMEM;
+    }
+
+    sout_access_out_t *p_access = sout_AccessOutNew( p_stream,
+                                                     p_sys->psz_access,
+                                                     b_file ? psz_tmp
+                                                            : psz_path );
+    if( p_access == NULL )
+    {
+        msg_Err( p_stream, "cannot publish %s", psz_path );
+        free( psz_tmp );
+        free( psz_path );
+        block_ChainRelease( p_chain );
+        return VLC_EGENERIC;
+    }
+
+    ssize_t i_ret = sout_AccessOutWrite( p_access, p_chain );
+    sout_AccessOutDelete( p_access );
+
+    if( b_file && i_ret >= 0 && vlc_rename( psz_tmp, psz_path ) )
+    {
+        msg_Err( p_stream, "cannot rename %s: %s", psz_tmp,
+                 vlc_strerror_c( errno ) );
+        i_ret = -1;
+    }
+    free( psz_tmp );
+    free( psz_path );
+    return i_ret < 0 ? VLC_EGENERIC : VLC_SUCCESS;
+}
+
+static void FormatTime( char *psz, size_t i_size, time_t t )
+{
+    struct tm tm;
+    gmtime_r( &t, &tm );
+    strftime( psz, i_size, "%Y-%m-%dT%H:%M:%SZ", &tm );
+}
+
+static void WriteCodecs( struct vlc_memstream *ms, const dash_rep_t *rep )
+{
+    const es_format_t *p_fmt = mp4mux_track_GetFmt( rep->tinfo );
+    const uint8_t *p_extra = p_fmt->p_extra;
+    size_t i_extra = p_fmt->i_extra;
+
+    if( rep->extrabuilder )
+    {
+        const uint8_t *p;
+        size_t i = mux_extradata_builder_Get( rep->extrabuilder, &p );
+        if( i )
+        {
+            p_extra = p;
+            i_extra = i;
+        }
+    }
+
+    switch( p_fmt->i_codec )
+    {
+        case VLC_CODEC_H264:
+            /* profile, constraints and level of the avcC */
+            if( i_extra >= 4 && p_extra[0] == 1 )
+                vlc_memstream_printf( ms, " codecs=\"avc1.%02X%02X%02X\"",
+                                      p_extra[1], p_extra[2], p_extra[3] );
+            else
+                vlc_memstream_puts( ms, " codecs=\"avc1\"" );
+            break;
+        case VLC_CODEC_HEVC:
+            vlc_memstream_puts( ms, " codecs=\"hvc1\"" );
+            break;
+        case VLC_CODEC_MP4A:
+            /* audio object type of the AudioSpecificConfig */
+            vlc_memstream_printf( ms, " codecs=\"mp4a.40.%u\"",
+                                  i_extra >= 1 ? p_extra[0] >> 3 : 2 );
+            break;
+        case VLC_CODEC_OPUS:
+            vlc_memstream_puts( ms, " codecs=\"opus\"" );
+            break;
+        case VLC_CODEC_A52:
+            vlc_memstream_puts( ms, " codecs=\"ac-3\"" );
+            break;
+        case VLC_CODEC_EAC3:
+            vlc_memstream_puts( ms, " codecs=\"ec-3\"" );
+            break;
+        default:
+            break;
+    }
+}
+
+static void WriteTimeline( struct vlc_memstream *ms, const dash_rep_t *rep,
+                           unsigned i_window )
+{
+    vlc_memstream_puts( ms, "        <SegmentTimeline>\n" );
+    for( unsigned i = 0; i < rep->i_timeline_count; )
+    {
+        const dash_segment_t *p_seg =
+            &rep->timeline[(rep->i_timeline_first + i) % i_window];
+        unsigned i_repeat = 0;
+
+        /* Contiguous segments of the same duration share an S element */
+        for( i++; i < rep->i_timeline_count; i++, i_repeat++ )
+        {
+            const dash_segment_t *p_next =
+                &rep->timeline[(rep->i_timeline_first + i) % i_window];
+            if( p_next->i_duration != p_seg->i_duration ||
+                p_next->i_time != p_seg->i_time +
+                                  (i_repeat + 1) * p_seg->i_duration )
+                break;
+        }
+
+        vlc_memstream_printf( ms, "          <S t=\"%"PRIu64"\" "
+                              "d=\"%"PRIu64"\"", p_seg->i_time,
+                              p_seg->i_duration );
+        if( i_repeat )
+            vlc_memstream_printf( ms, " r=\"%u\"", i_repeat );
+        vlc_memstream_puts( ms, "/>\n" );
+    }
+    vlc_memstream_puts( ms, "        </SegmentTimeline>\n" );
+}
+
+static int WriteManifest( sout_stream_t *p_stream )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    struct vlc_memstream ms;
+    char psz_start[32], psz_now[32];
+
+    FormatTime( psz_start, sizeof(psz_start), p_sys->i_start_time );
+    FormatTime( psz_now, sizeof(psz_now), time( NULL ) );
+
+    const double f_seglen = secf_from_vlc_tick( p_sys->i_seglen );
+
+    vlc_memstream_open( &ms );
+    vlc_memstream_printf( &ms,
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" "
+        "profiles=\"urn:mpeg:dash:profile:isoff-live:2011\" "
+        "type=\"dynamic\" availabilityStartTime=\"%s\" publishTime=\"%s\" "
+        "minimumUpdatePeriod=\"PT%.3fS\" minBufferTime=\"PT%.3fS\" "
+        "timeShiftBufferDepth=\"PT%.3fS\">\n"
+        "  <Period id=\"0\" start=\"PT0S\">\n",
+        psz_start, psz_now, f_seglen, 2. * f_seglen,
+        f_seglen * p_sys->i_window );
+
+    for( int i = 0; i < p_sys->i_reps; i++ )
+    {
+        const dash_rep_t *rep = p_sys->pp_reps[i];
+        if( rep->i_timeline_count == 0 )
+            continue;
+
+        const es_format_t *p_fmt = mp4mux_track_GetFmt( rep->tinfo );
+        const char *psz_type = p_fmt->i_cat == VIDEO_ES ? "video" : "audio";
+
+        vlc_memstream_printf( &ms,
+            "    <AdaptationSet contentType=\"%s\" mimeType=\"%s/mp4\" "
+            "segmentAlignment=\"true\" startWithSAP=\"1\">\n"
+            "      <Representation id=\"%s\" bandwidth=\"%u\"",
+            psz_type, psz_type, rep->psz_id, __MAX(rep->i_bitrate, 1u) );
+        WriteCodecs( &ms, rep );
+        if( p_fmt->i_cat == VIDEO_ES )
+            vlc_memstream_printf( &ms, " width=\"%u\" height=\"%u\"",
+                                  p_fmt->video.i_visible_width,
+                                  p_fmt->video.i_visible_height );
+        else
+            vlc_memstream_printf( &ms, " audioSamplingRate=\"%u\"",
+                                  p_fmt->audio.i_rate );
+        vlc_memstream_printf( &ms, ">\n"
+            "       <SegmentTemplate timescale=\"%"PRIu32"\" "
+            "initialization=\"$RepresentationID$-init.mp4\" "
+            "media=\"$RepresentationID$-$Time$.m4s\">\n",
+            rep->i_timescale );
+        WriteTimeline( &ms, rep, p_sys->i_window );
+        vlc_memstream_puts( &ms,
+            "       </SegmentTemplate>\n"
+            "      </Representation>\n"
+            "    </AdaptationSet>\n" );
+    }
+    vlc_memstream_puts( &ms, "  </Period>\n</MPD>\n" );
+
+    if( vlc_memstream_close( &ms ) )
+        return VLC_ENOMEM;
+
+    block_t *p_block = block_heap_Alloc( ms.ptr, ms.length );
+    if( p_block == NULL )
+        return VLC_ENOMEM;
+    return Publish( p_stream, p_sys->psz_mpd, p_block );
+}
+
+static int WriteInit( sout_stream_t *p_stream, dash_rep_t *rep )
+{
+    bo_t *ftyp = mp4mux_GetFtyp( rep->muxh );
+    if( ftyp == NULL )
+        return VLC_ENOMEM;
+
+    bo_t *moov = mp4mux_GetMoov( rep->muxh, VLC_OBJECT(p_stream), 0 );
+    if( moov == NULL )
+    {
+        bo_free( ftyp );
+        return VLC_ENOMEM;
+    }
+    box_gather( ftyp, moov );
+
+    block_t *p_block = ftyp->b;
+    free( ftyp );
+    if( p_block == NULL )
+        return VLC_ENOMEM;
+
+    char psz_name[32];
+    snprintf( psz_name, sizeof(psz_name), "%s-init.mp4", rep->psz_id );
+    return Publish( p_stream, psz_name, p_block );
+}
+
+/* Builds the moof of the ongoing segment. The data offset is relative to
+ * the moof itself, and the mdat follows right after it. */
+static bo_t *GetMoof( dash_rep_t *rep, uint64_t i_decode_time,
+                      uint64_t *pi_duration )
+{
+    const bool b_video = mp4mux_track_GetFmt( rep->tinfo )->i_cat == VIDEO_ES;
+
+    bo_t *moof = box_new( "moof" );
+    bo_t *mfhd = box_full_new( "mfhd", 0, 0 );
+    bo_t *traf = box_new( "traf" );
+    bo_t *tfhd = box_full_new( "tfhd", 0, MP4_TFHD_DEFAULT_BASE_IS_MOOF );
+    bo_t *tfdt = box_full_new( "tfdt", 1, 0 );
+
+    uint32_t i_trun_flags = MP4_TRUN_DATA_OFFSET | MP4_TRUN_SAMPLE_DURATION |
+                            MP4_TRUN_SAMPLE_SIZE;
+    if( b_video )
+        i_trun_flags |= MP4_TRUN_SAMPLE_FLAGS;
+    if( rep->b_bframes )
+        i_trun_flags |= MP4_TRUN_SAMPLE_TIME_OFFSET;
+    bo_t *trun = box_full_new( "trun", 0, i_trun_flags );
+
+    if( !moof || !mfhd || !traf || !tfhd || !tfdt || !trun )
+    {
+        if( moof ) bo_free( moof );
+        if( mfhd ) bo_free( mfhd );
+        if( traf ) bo_free( traf );
+        if( tfhd ) bo_free( tfhd );
+        if( tfdt ) bo_free( tfdt );
+        if( trun ) bo_free( trun );
+        return NULL;
+    }
+
+    bo_add_32be( mfhd, ++rep->i_sequence );
+    box_gather( moof, mfhd );
+
+    bo_add_32be( tfhd, mp4mux_track_GetID( rep->tinfo ) );
+    box_gather( traf, tfhd );
+
+    bo_add_64be( tfdt, i_decode_time );
+    box_gather( traf, tfdt );
+
+    bo_add_32be( trun, rep->i_samples );
+    const size_t i_fixup = bo_size( moof ) + bo_size( traf ) + bo_size( trun );
+    bo_add_32be( trun, 0 ); /* data offset */
+
+    /* The durations are rounded from the running time, so that they add up
+     * to the timeline without drifting */
+    vlc_tick_t i_time = rep->i_time;
+    uint64_t i_start = samples_from_vlc_tick( i_time, rep->i_timescale );
+    uint64_t i_end = i_start;
+
+    for( const block_t *p = rep->p_first; p != NULL; p = p->p_next )
+    {
+        i_time += p->i_length;
+        i_end = samples_from_vlc_tick( i_time, rep->i_timescale );
+
+        bo_add_32be( trun, i_end - i_start );
+        bo_add_32be( trun, p->i_buffer );
+        if( i_trun_flags & MP4_TRUN_SAMPLE_FLAGS )
+            /* sample_depends_on, sample_is_non_sync_sample */
+            bo_add_32be( trun, (p->i_flags & BLOCK_FLAG_TYPE_I)
+                               ? 0x02000000 : 0x01010000 );
+        if( i_trun_flags & MP4_TRUN_SAMPLE_TIME_OFFSET )
+        {
+            vlc_tick_t i_diff = 0;
+            if( p->i_dts != VLC_TICK_INVALID && p->i_pts > p->i_dts )
+                i_diff = p->i_pts - p->i_dts;
+            bo_add_32be( trun, samples_from_vlc_tick( i_diff,
+                                                      rep->i_timescale ) );
+        }
+        i_start = i_end;
+    }
+    box_gather( traf, trun );
+    box_gather( moof, traf );
+
+    if( moof->b == NULL )
+    {
+        bo_free( moof );
+        return NULL;
+    }
+    box_fix( moof, bo_size( moof ) );
+    bo_set_32be( moof, i_fixup, bo_size( moof ) + 8 );
+
+    *pi_duration = i_end - i_decode_time;
+    return moof;
+}
+
+static void ExpireSegment( sout_stream_t *p_stream, const dash_rep_t *rep,
+                           const dash_segment_t *p_seg )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    char *psz_path;
+
+    if( !p_sys->b_delsegs || strcmp( p_sys->psz_access, "file" ) )
+        return;
+
+    if( asprintf( &psz_path, "%s/%s-%"PRIu64".m4s", p_sys->psz_dst,
+                  rep->psz_id, p_seg->i_time ) < 0 )
+        return;
+    if( vlc_unlink( psz_path ) )
+        msg_Warn( p_stream, "cannot delete %s: %s", psz_path,
+                  vlc_strerror_c( errno ) );
+    free( psz_path );
+}
+
+static int WriteSegment( sout_stream_t *p_stream, dash_rep_t *rep )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    if( rep->i_samples == 0 )
+        return VLC_SUCCESS;
+
+    if( !rep->b_init_written )
+    {
+        if( WriteInit( p_stream, rep ) != VLC_SUCCESS )
+            msg_Warn( p_stream, "cannot write the initialization of %s",
+                      rep->psz_id );
+        rep->b_init_written = true;
+    }
+
+    const uint64_t i_decode_time = samples_from_vlc_tick( rep->i_time,
+                                                          rep->i_timescale );
+    uint64_t i_duration;
+    bo_t *moof = GetMoof( rep, i_decode_time, &i_duration );
+    bo_t *mdat = box_new( "mdat" );
+    if( moof == NULL || mdat == NULL || mdat->b == NULL )
+    {
+        if( moof ) bo_free( moof );
+        if( mdat ) bo_free( mdat );
+        return VLC_ENOMEM;
+    }
+    box_fix( mdat, bo_size( mdat ) + rep->i_size );
+
+    /* moof, mdat header, then the samples as they are */
+    block_t *p_chain = moof->b;
+    p_chain->p_next = mdat->b;
+    mdat->b->p_next = rep->p_first;
+    free( moof );
+    free( mdat );
+
+    if( rep->i_length > 0 )
+        rep->i_bitrate = __MAX( rep->i_bitrate,
+                                (uint64_t)rep->i_size * 8 * CLOCK_FREQ
+                                / rep->i_length );
+    rep->i_time += rep->i_length;
+    rep->p_first = NULL;
+    rep->pp_last = &rep->p_first;
+    rep->i_samples = 0;
+    rep->i_size = 0;
+    rep->i_length = 0;
+
+    char psz_name[48];
+    snprintf( psz_name, sizeof(psz_name), "%s-%"PRIu64".m4s", rep->psz_id,
+              i_decode_time );
+    int i_ret = Publish( p_stream, psz_name, p_chain );
+    if( i_ret != VLC_SUCCESS )
+        return i_ret;
+
+    if( rep->i_timeline_count == p_sys->i_window )
+    {
+        ExpireSegment( p_stream, rep, &rep->timeline[rep->i_timeline_first] );
+        rep->i_timeline_first = (rep->i_timeline_first + 1) % p_sys->i_window;
+        rep->i_timeline_count--;
+    }
+    dash_segment_t *p_seg = &rep->timeline[(rep->i_timeline_first +
+                                            rep->i_timeline_count++)
+                                           % p_sys->i_window];
+    p_seg->i_time = i_decode_time;
+    p_seg->i_duration = i_duration;
+
+    return WriteManifest( p_stream );
+}
+
+static void FixLength( const dash_rep_t *rep, block_t *p_block,
+                       const block_t *p_next )
+{
+    if( p_block->i_length > 0 )
+        return;
+
+    if( p_next != NULL && !(p_next->i_flags & BLOCK_FLAG_DISCONTINUITY) &&
+        p_next->i_dts != VLC_TICK_INVALID && p_block->i_dts != VLC_TICK_INVALID )
+        p_block->i_length = p_next->i_dts - p_block->i_dts;
+    if( p_block->i_length > 0 )
+        return;
+
+    const es_format_t *p_fmt = mp4mux_track_GetFmt( rep->tinfo );
+    if( p_fmt->i_cat == VIDEO_ES && p_fmt->video.i_frame_rate )
+        p_block->i_length = vlc_tick_from_samples( p_fmt->video.i_frame_rate_base,
+                                                   p_fmt->video.i_frame_rate );
+    else if( p_fmt->i_cat == AUDIO_ES && p_block->i_nb_samples &&
+             p_fmt->audio.i_rate )
+        p_block->i_length = vlc_tick_from_samples( p_block->i_nb_samples,
+                                                   p_fmt->audio.i_rate );
+    else
+        p_block->i_length = 1;
+}
+
+/* Appends the held sample to the segment, once the next one is known */
+static void Enqueue( sout_stream_t *p_stream, dash_rep_t *rep,
+                     const block_t *p_next )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    block_t *p_block = rep->p_held;
+
+    rep->p_held = NULL;
+    FixLength( rep, p_block, p_next );
+
+    /* Segments start on a random access point */
+    const bool b_sync = mp4mux_track_GetFmt( rep->tinfo )->i_cat != VIDEO_ES ||
+                        (p_block->i_flags & BLOCK_FLAG_TYPE_I);
+    if( b_sync && rep->i_length >= p_sys->i_seglen )
+        WriteSegment( p_stream, rep );
+
+    if( rep->i_samples == 0 && !b_sync && !rep->b_init_written )
+    {
+        /* Nothing decodable before the first key frame */
+        rep->i_time += p_block->i_length;
+        block_Release( p_block );
+        return;
+    }
+
+    p_block->p_next = NULL;
+    *rep->pp_last = p_block;
+    rep->pp_last = &p_block->p_next;
+    rep->i_samples++;
+    rep->i_size += p_block->i_buffer;
+    rep->i_length += p_block->i_length;
+}
+
+static void Push( sout_stream_t *p_stream, dash_rep_t *rep, block_t *p_block )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    const es_format_t *p_fmt = mp4mux_track_GetFmt( rep->tinfo );
+
+    /* Create on the fly extradata as packetizer is not in the loop */
+    if( rep->extrabuilder && !mp4mux_track_HasSamplePriv( rep->tinfo ) )
+    {
+        mux_extradata_builder_Feed( rep->extrabuilder,
+                                    p_block->p_buffer, p_block->i_buffer );
+        const uint8_t *p_extra;
+        size_t i_extra = mux_extradata_builder_Get( rep->extrabuilder,
+                                                    &p_extra );
+        if( i_extra )
+            mp4mux_track_SetSamplePriv( rep->tinfo, p_extra, i_extra );
+    }
+
+    switch( p_fmt->i_codec )
+    {
+        case VLC_CODEC_H264:
+        case VLC_CODEC_HEVC:
+            /* rewritten in place, unless the block is shared */
+            p_block = block_MakeWritable( p_block );
+            if( p_block )
+                p_block = hxxx_AnnexB_to_xVC( p_block, 4 );
+            if( p_block == NULL )
+                return;
+            break;
+        default:
+            break;
+    }
+
+    const vlc_tick_t i_dts = p_block->i_dts != VLC_TICK_INVALID
+                           ? p_block->i_dts : p_block->i_pts;
+    if( p_sys->i_origin == VLC_TICK_INVALID )
+    {
+        if( i_dts == VLC_TICK_INVALID )
+        {
+            block_Release( p_block );
+            return;
+        }
+        p_sys->i_origin = i_dts;
+        p_sys->i_start_time = time( NULL );
+    }
+
+    if( rep->p_held == NULL && rep->i_samples == 0 && !rep->b_init_written )
+    {
+        if( i_dts == VLC_TICK_INVALID )
+        {
+            block_Release( p_block );
+            return;
+        }
+        rep->i_time = __MAX( i_dts - p_sys->i_origin, 0 );
+    }
+
+    if( p_fmt->i_cat == VIDEO_ES && !rep->b_bframes &&
+        p_block->i_dts != VLC_TICK_INVALID && p_block->i_pts > p_block->i_dts )
+    {
+        /* from the ongoing segment on, the trun has composition offsets */
+        rep->b_bframes = true;
+        mp4mux_track_SetHasBFrames( rep->tinfo );
+    }
+
+    if( rep->p_held != NULL )
+        Enqueue( p_stream, rep, p_block );
+    rep->p_held = p_block;
+}
+
+static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    if( p_fmt->i_cat != VIDEO_ES && p_fmt->i_cat != AUDIO_ES )
+        return NULL;
+
+    if( !mp4mux_CanMux( VLC_OBJECT(p_stream), p_fmt, BRAND_isom, true ) )
+    {
+        msg_Err( p_stream, "unsupported codec %4.4s in DASH",
+                 (const char *)&p_fmt->i_codec );
+        return NULL;
+    }
+
+    dash_rep_t *rep = calloc( 1, sizeof(*rep) );
+    if( unlikely(rep == NULL) )
+        return NULL;
+
+    rep->timeline = vlc_alloc( p_sys->i_window, sizeof(*rep->timeline) );
+    rep->muxh = mp4mux_New( FRAGMENTED );
+    if( rep->timeline == NULL || rep->muxh == NULL )
+        goto error;
+    mp4mux_SetBrand( rep->muxh, BRAND_iso6, 0x0 );
+    mp4mux_AddExtraBrand( rep->muxh, BRAND_isom );
+    mp4mux_AddExtraBrand( rep->muxh, BRAND_dash );
+
+    es_format_t trackfmt;
+    es_format_Copy( &trackfmt, p_fmt );
+
+    if( p_fmt->i_cat == AUDIO_ES )
+    {
+        if( !trackfmt.audio.i_rate )
+        {
+            msg_Warn( p_stream, "no audio rate given, assuming 48KHz" );
+            trackfmt.audio.i_rate = 48000;
+        }
+        rep->i_timescale = trackfmt.audio.i_rate;
+        snprintf( rep->psz_id, sizeof(rep->psz_id), "audio%u",
+                  p_sys->i_audio_count++ );
+    }
+    else
+    {
+        rep->i_timescale = 90000;
+        snprintf( rep->psz_id, sizeof(rep->psz_id), "video%u",
+                  p_sys->i_video_count++ );
+    }
+
+    rep->tinfo = mp4mux_track_Add( rep->muxh, 1, &trackfmt, rep->i_timescale );
+    es_format_Clean( &trackfmt );
+    if( rep->tinfo == NULL )
+        goto error;
+
+    rep->extrabuilder = mux_extradata_builder_New( p_fmt->i_codec,
+                                                   EXTRADATA_ISOBMFF );
+    rep->pp_last = &rep->p_first;
+
+    TAB_APPEND( p_sys->i_reps, p_sys->pp_reps, rep );
+    msg_Dbg( p_stream, "adding representation %s", rep->psz_id );
+    return rep;
+
+error:
+    if( rep->muxh )
+        mp4mux_Delete( rep->muxh );
+    free( rep->timeline );
+    free( rep );
+    return NULL;
+}
+
+static void Del( sout_stream_t *p_stream, void *id )
+{
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+    dash_rep_t *rep = id;
+
+    if( rep->p_held != NULL )
+        Enqueue( p_stream, rep, NULL );
+    WriteSegment( p_stream, rep );
+    block_ChainRelease( rep->p_first );
+
+    TAB_REMOVE( p_sys->i_reps, p_sys->pp_reps, rep );
+    msg_Dbg( p_stream, "removing representation %s", rep->psz_id );
+
+    if( rep->extrabuilder )
+        mux_extradata_builder_Delete( rep->extrabuilder );
+    mp4mux_Delete( rep->muxh );
+    free( rep->timeline );
+    free( rep );
+}
+
+static int Send( sout_stream_t *p_stream, void *id, block_t *p_buffer )
+{
+    dash_rep_t *rep = id;
+
+    while( p_buffer != NULL )
+    {
+        block_t *p_next = p_buffer->p_next;
+        p_buffer->p_next = NULL;
+        Push( p_stream, rep, p_buffer );
+        p_buffer = p_next;
+    }
+    return VLC_SUCCESS;
+}
+
+static const struct sout_stream_operations ops = {
+    Add, Del, Send, NULL, NULL,
+};
+
+/*****************************************************************************
+ * Open:
+ *****************************************************************************/
+static int Open( vlc_object_t *p_this )
+{
+    sout_stream_t *p_stream = (sout_stream_t *)p_this;
+
+    if( p_stream->p_next != NULL )
+        return VLC_EGENERIC;
+
+    sout_stream_sys_t *p_sys = calloc( 1, sizeof(*p_sys) );
+    if( unlikely(p_sys == NULL) )
+        return VLC_ENOMEM;
+
+    config_ChainParse( p_stream, SOUT_CFG_PREFIX, ppsz_sout_options,
+                       p_stream->p_cfg );
+
+    p_sys->psz_access = var_GetNonEmptyString( p_stream,
+                                               SOUT_CFG_PREFIX "access" );
+    p_sys->psz_dst = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "dst" );
+    p_sys->psz_mpd = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "mpd" );
+    if( p_sys->psz_access == NULL || p_sys->psz_dst == NULL ||
+        p_sys->psz_mpd == NULL )
+    {
+        msg_Err( p_stream, "no output access, location or manifest name" );
+        free( p_sys->psz_access );
+        free( p_sys->psz_dst );
+        free( p_sys->psz_mpd );
+        free( p_sys );
+        return VLC_EGENERIC;
+    }
+
+    p_sys->i_seglen = vlc_tick_from_sec( var_GetInteger( p_stream,
+                                            SOUT_CFG_PREFIX "seglen" ) );
+    p_sys->i_window = var_GetInteger( p_stream, SOUT_CFG_PREFIX "window" );
+    p_sys->b_delsegs = var_GetBool( p_stream, SOUT_CFG_PREFIX "delsegs" );
+    p_sys->i_origin = VLC_TICK_INVALID;
+
+    p_stream->p_sys = p_sys;
+    p_stream->ops = &ops;
+    return VLC_SUCCESS;
+}
+
+/*****************************************************************************
+ * Close:
+ *****************************************************************************/
+static void Close( vlc_object_t *p_this )
+{
+    sout_stream_t *p_stream = (sout_stream_t *)p_this;
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
+
+    assert( p_sys->i_reps == 0 );
+    free( p_sys->pp_reps );
+    free( p_sys->psz_access );
+    free( p_sys->psz_dst );
+    free( p_sys->psz_mpd );
+    free( p_sys );
+}
@@ -441,6 +441,8 @@ static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
     p_es->psz_id = p_sys->psz_id;
     vlc_picture_chain_Init( &p_es->pictures );
     p_es->b_empty = false;
+    p_es->i_dropped = 0;
+    p_es->i_late = 0;
 
     vlc_global_unlock( VLC_MOSAIC_MUTEX );
 
@@ -481,6 +483,8 @@ static void Del( sout_stream_t *p_stream, void *id )
     p_bridge = GetBridge( p_stream );
     p_es = p_sys->p_es;
 
+    msg_Dbg( p_stream, "mosaic bridge id=%s: %u pictures dropped, %u late",
+             p_es->psz_id, p_es->i_dropped, p_es->i_late );
     p_es->b_empty = true;
     while ( !vlc_picture_chain_IsEmpty( &p_es->pictures ) )
     {
@@ -1327,76 +1327,164 @@ static int  HttpCallback( httpd_file_sys_t *p_args,
 /****************************************************************************
  * RTP send
  ****************************************************************************/
-static void* ThreadSend( void *data )
-{
 #ifdef _WIN32
 # define ENOBUFS      WSAENOBUFS
 # define EAGAIN       WSAEWOULDBLOCK
 # define EWOULDBLOCK  WSAEWOULDBLOCK
 #endif
-    sout_stream_id_sys_t *id = data;
-    vlc_tick_t i_caching = id->i_caching;
-    block_t *out;
 
-    while ((out = vlc_queue_DequeueKillable(&id->queue, &id->dead)) != NULL)
+/* Packets sent together to each sink */
+#define RTP_SEND_BATCH 32
+
+/* Handles a failed send, returns false if the sink is dead */
+static bool SendRetry( int fd, const block_t *out )
+{
+    if( net_errno == EAGAIN || net_errno == EWOULDBLOCK
+     || net_errno == ENOBUFS || net_errno == ENOMEM )
+        return true;
+
+    int type;
+    getsockopt( fd, SOL_SOCKET, SO_TYPE, &type,
+                &(socklen_t){ sizeof(type) });
+    if( type != SOCK_DGRAM )
+        return false; /* Broken connection */
+
+    /* ICMP soft error: ignore and retry */
+    send( fd, out->p_buffer, out->i_buffer, 0 );
+    return true;
+}
+
+/* Sends a batch of packets to one sink, returns false if it is dead */
+static bool SendSink( int fd, block_t *const *batch, unsigned count )
+{
+#ifdef HAVE_SENDMMSG
+    struct mmsghdr msgs[RTP_SEND_BATCH];
+    struct iovec iov[RTP_SEND_BATCH];
+
+    for( unsigned i = 0; i < count; i++ )
     {
-#ifdef HAVE_SRTP
-        if( id->srtp )
-        {   /* FIXME: this is awfully inefficient */
-            size_t len = out->i_buffer;
-            out = block_Realloc( out, 0, len + 10 );
-            out->i_buffer = len;
-
-            int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
-            if( val )
-            {
-                msg_Dbg( id->p_stream, "SRTP sending error: %s",
-                         vlc_strerror_c(val) );
-                block_Release( out );
-                continue;
-            }
-            out->i_buffer = len;
+        iov[i].iov_base = batch[i]->p_buffer;
+        iov[i].iov_len = batch[i]->i_buffer;
+        msgs[i].msg_hdr = (struct msghdr) {
+            .msg_iov = &iov[i],
+            .msg_iovlen = 1,
+        };
+    }
+
+    for( unsigned i = 0; i < count; )
+    {
+        int val = sendmmsg( fd, msgs + i, count - i, 0 );
+        if( val > 0 )
+        {
+            i += val;
+            continue;
         }
+        /* The first remaining packet failed */
+        if( !SendRetry( fd, batch[i] ) )
+            return false;
+        i++;
+    }
+#else
+    for( unsigned i = 0; i < count; i++ )
+        if( send( fd, batch[i]->p_buffer, batch[i]->i_buffer, 0 ) == -1
+         && !SendRetry( fd, batch[i] ) )
+            return false;
 #endif
-        vlc_tick_wait (out->i_dts + i_caching);
-
-        ssize_t len = out->i_buffer;
+    return true;
+}
 
-        vlc_mutex_lock( &id->lock_sink );
-        unsigned deadc = 0; /* How many dead sockets? */
-        int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
+static void SendBatch( sout_stream_id_sys_t *id, block_t **batch,
+                       unsigned count )
+{
+    vlc_mutex_lock( &id->lock_sink );
+    unsigned deadc = 0; /* How many dead sockets? */
+    int deadv[id->sinkc ? id->sinkc : 1]; /* Dead sockets list */
 
-        for( int i = 0; i < id->sinkc; i++ )
-        {
+    for( int i = 0; i < id->sinkc; i++ )
+    {
 #ifdef HAVE_SRTP
-            if( !id->srtp ) /* FIXME: SRTCP support */
+        if( !id->srtp ) /* FIXME: SRTCP support */
 #endif
-                SendRTCP( id->sinkv[i].rtcp, out );
+            for( unsigned j = 0; j < count; j++ )
+                SendRTCP( id->sinkv[i].rtcp, batch[j] );
 
-            if( send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 ) == -1
-             && net_errno != EAGAIN && net_errno != EWOULDBLOCK
-             && net_errno != ENOBUFS && net_errno != ENOMEM )
-            {
-                int type;
-                getsockopt( id->sinkv[i].rtp_fd, SOL_SOCKET, SO_TYPE,
-                            &type, &(socklen_t){ sizeof(type) });
-                if( type == SOCK_DGRAM )
-                    /* ICMP soft error: ignore and retry */
-                    send( id->sinkv[i].rtp_fd, out->p_buffer, len, 0 );
-                else
-                    /* Broken connection */
-                    deadv[deadc++] = id->sinkv[i].rtp_fd;
-            }
+        if( !SendSink( id->sinkv[i].rtp_fd, batch, count ) )
+            deadv[deadc++] = id->sinkv[i].rtp_fd;
+    }
+    id->i_seq_sent_next = ntohs(((uint16_t *) batch[count - 1]->p_buffer)[1]) + 1;
+    vlc_mutex_unlock( &id->lock_sink );
+
+    for( unsigned i = 0; i < count; i++ )
+        block_Release( batch[i] );
+
+    for( unsigned i = 0; i < deadc; i++ )
+    {
+        msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
+        rtp_del_sink( id, deadv[i] );
+    }
+}
+
+/* This thread sends the packets to all the sinks, in batches of the packets
+ * that are due at the same time */
+static void* ThreadSend( void *data )
+{
+    sout_stream_id_sys_t *id = data;
+    vlc_tick_t i_caching = id->i_caching;
+    block_t *pending = NULL, **pp_last = &pending;
+
+    for( ;; )
+    {
+        if( pending == NULL )
+        {
+            pending = vlc_queue_DequeueKillable( &id->queue, &id->dead );
+            if( pending == NULL )
+                break;
+            pp_last = &pending->p_next;
         }
-        id->i_seq_sent_next = ntohs(((uint16_t *) out->p_buffer)[1]) + 1;
-        vlc_mutex_unlock( &id->lock_sink );
-        block_Release( out );
 
-        for( unsigned i = 0; i < deadc; i++ )
+        /* Takes whatever was queued meanwhile, without waiting */
+        *pp_last = vlc_queue_DequeueAll( &id->queue );
+        while( *pp_last != NULL )
+            pp_last = &(*pp_last)->p_next;
+
+        vlc_tick_wait( pending->i_dts + i_caching );
+
+        block_t *batch[RTP_SEND_BATCH];
+        unsigned count = 0;
+        vlc_tick_t now = vlc_tick_now();
+
+        while( pending != NULL && count < RTP_SEND_BATCH
+            && ( count == 0 || pending->i_dts + i_caching <= now ) )
         {
-            msg_Dbg( id->p_stream, "removing socket %d", deadv[i] );
-            rtp_del_sink( id, deadv[i] );
+            block_t *out = pending;
+
+            pending = out->p_next;
+            if( pending == NULL )
+                pp_last = &pending;
+            out->p_next = NULL;
+#ifdef HAVE_SRTP
+            if( id->srtp )
+            {   /* The block allocation padding usually fits the tag */
+                size_t len = out->i_buffer;
+                out = block_Realloc( out, 0, len + 10 );
+                out->i_buffer = len;
+
+                int val = srtp_send( id->srtp, out->p_buffer, &len, len + 10 );
+                if( val )
+                {
+                    msg_Dbg( id->p_stream, "SRTP sending error: %s",
+                             vlc_strerror_c(val) );
+                    block_Release( out );
+                    continue;
+                }
+                out->i_buffer = len;
+            }
+#endif
+            batch[count++] = out;
         }
+
+        if( count > 0 )
+            SendBatch( id, batch, count );
     }
     return NULL;
 }
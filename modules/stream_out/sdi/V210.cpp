@@ -25,6 +25,11 @@
 #include "V210.hpp"
 
 #include <vlc_picture.h>
+#include <vlc_cpu.h>
+
+#ifdef CAN_COMPILE_SSSE3
+# include <tmmintrin.h>
+#endif
 
 using namespace sdi;
 
@@ -41,6 +46,59 @@ static inline void put_le32(uint8_t **p, uint32_t d)
     (*p) += 4;
 }
 
+#ifdef CAN_COMPILE_SSSE3
+/* Packs 6 pixels per iteration: the samples of each of the three 10-bit
+ * fields of the 4 output words are gathered with byte shuffles, then
+ * shifted in place. Reads 8 luma and chroma samples per group. */
+__attribute__ ((__target__ ("ssse3")))
+static void PackGroupsSSSE3(const uint16_t *&y, const uint16_t *&u,
+                            const uint16_t *&v, uint8_t *&dst,
+                            unsigned groups)
+{
+    /* words: (u0 y0 v0) (y1 u1 y2) (v1 y3 u2) (y4 v2 y5) */
+    const __m128i ya = _mm_setr_epi8(-1,-1,-1,-1,  2, 3,-1,-1, -1,-1,-1,-1,  8, 9,-1,-1);
+    const __m128i ua = _mm_setr_epi8( 0, 1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1);
+    const __m128i va = _mm_setr_epi8(-1,-1,-1,-1, -1,-1,-1,-1,  2, 3,-1,-1, -1,-1,-1,-1);
+    const __m128i yb = _mm_setr_epi8( 0, 1,-1,-1, -1,-1,-1,-1,  6, 7,-1,-1, -1,-1,-1,-1);
+    const __m128i ub = _mm_setr_epi8(-1,-1,-1,-1,  2, 3,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1);
+    const __m128i vb = _mm_setr_epi8(-1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1,  4, 5,-1,-1);
+    const __m128i yc = _mm_setr_epi8(-1,-1,-1,-1,  4, 5,-1,-1, -1,-1,-1,-1, 10,11,-1,-1);
+    const __m128i uc = _mm_setr_epi8(-1,-1,-1,-1, -1,-1,-1,-1,  4, 5,-1,-1, -1,-1,-1,-1);
+    const __m128i vc = _mm_setr_epi8( 0, 1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1, -1,-1,-1,-1);
+    const __m128i lo = _mm_set1_epi16(4), hi = _mm_set1_epi16(1019);
+
+    for (unsigned i = 0; i < groups; i++)
+    {
+        __m128i ys = _mm_loadu_si128((const __m128i *)y);
+        __m128i us = _mm_loadu_si128((const __m128i *)u);
+        __m128i vs = _mm_loadu_si128((const __m128i *)v);
+
+        ys = _mm_min_epi16(_mm_max_epi16(ys, lo), hi);
+        us = _mm_min_epi16(_mm_max_epi16(us, lo), hi);
+        vs = _mm_min_epi16(_mm_max_epi16(vs, lo), hi);
+
+        __m128i a = _mm_or_si128(_mm_shuffle_epi8(ys, ya),
+                    _mm_or_si128(_mm_shuffle_epi8(us, ua),
+                                 _mm_shuffle_epi8(vs, va)));
+        __m128i b = _mm_or_si128(_mm_shuffle_epi8(ys, yb),
+                    _mm_or_si128(_mm_shuffle_epi8(us, ub),
+                                 _mm_shuffle_epi8(vs, vb)));
+        __m128i c = _mm_or_si128(_mm_shuffle_epi8(ys, yc),
+                    _mm_or_si128(_mm_shuffle_epi8(us, uc),
+                                 _mm_shuffle_epi8(vs, vc)));
+
+        a = _mm_or_si128(a, _mm_or_si128(_mm_slli_epi32(b, 10),
+                                         _mm_slli_epi32(c, 20)));
+        _mm_storeu_si128((__m128i *)dst, a);
+
+        y += 6;
+        u += 3;
+        v += 3;
+        dst += 16;
+    }
+}
+#endif
+
 void V210::Convert(const picture_t *pic, unsigned dst_stride, void *frame_bytes)
 {
     unsigned width = pic->format.i_width;
@@ -62,9 +120,20 @@ void V210::Convert(const picture_t *pic, unsigned dst_stride, void *frame_bytes)
         put_le32(&dst, val);           \
     } while (0)
 
+#ifdef CAN_COMPILE_SSSE3
+    /* the last group must leave room for the 8-sample chroma loads */
+    const unsigned simd_groups = (vlc_CPU_SSSE3() && width >= 16)
+                               ? (width - 16) / 6 + 1 : 0;
+#endif
+
     for (h = 0; h < height; h++) {
         uint32_t val = 0;
-        for (w = 0; w + 5 < width; w += 6) {
+        w = 0;
+#ifdef CAN_COMPILE_SSSE3
+        PackGroupsSSSE3(y, u, v, dst, simd_groups);
+        w = simd_groups * 6;
+#endif
+        for (; w + 5 < width; w += 6) {
             WRITE_PIXELS(u, y, v);
             WRITE_PIXELS(y, u, y);
             WRITE_PIXELS(v, y, u);
@@ -147,6 +147,8 @@ typedef struct
     void ( *pf_audio_prerender_callback ) ( void* p_audio_data, uint8_t** pp_pcm_buffer, size_t size );
     void ( *pf_video_postrender_callback ) ( void* p_video_data, uint8_t* p_pixel_buffer, int width, int height, int pixel_pitch, size_t size, vlc_tick_t pts );
     void ( *pf_audio_postrender_callback ) ( void* p_audio_data, uint8_t* p_pcm_buffer, unsigned int channels, unsigned int rate, unsigned int nb_samples, unsigned int bits_per_sample, size_t size, vlc_tick_t pts );
+    void ( *pf_packet_callback ) ( void* p_packet_data, const es_format_t *p_fmt, block_t *p_block );
+    void *p_packet_data;
     bool time_sync;
 } sout_stream_sys_t;
 
@@ -229,6 +231,15 @@ static int Open( vlc_object_t *p_this )
 
     p_sys->time_sync = var_GetBool( p_stream, SOUT_CFG_PREFIX "time-sync" );
 
+    /* LibVLC packet callback: the blocks of every ES are passed as is */
+    p_sys->pf_packet_callback = var_InheritAddress( p_stream, "smem-packet" );
+    if( p_sys->pf_packet_callback != NULL )
+    {
+        p_sys->p_packet_data = var_InheritAddress( p_stream, "smem-packet-data" );
+        p_stream->ops = &ops;
+        return VLC_SUCCESS;
+    }
+
     psz_tmp = var_GetString( p_stream, SOUT_PREFIX_VIDEO "prerender-callback" );
     p_sys->pf_video_prerender_callback = (void (*) (void *, uint8_t**, size_t))(intptr_t)atoll( psz_tmp );
     free( psz_tmp );
@@ -269,9 +280,16 @@ static void Close( vlc_object_t * p_this )
 
 static void *Add( sout_stream_t *p_stream, const es_format_t *p_fmt )
 {
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
     sout_stream_id_sys_t *id = NULL;
 
-    if ( p_fmt->i_cat == VIDEO_ES )
+    if ( p_sys->pf_packet_callback != NULL )
+    {
+        id = calloc( 1, sizeof( sout_stream_id_sys_t ) );
+        if ( id != NULL )
+            es_format_Copy( &id->format, p_fmt );
+    }
+    else if ( p_fmt->i_cat == VIDEO_ES )
         id = AddVideo( p_stream, p_fmt );
     else if ( p_fmt->i_cat == AUDIO_ES )
         id = AddAudio( p_stream, p_fmt );
@@ -362,7 +380,23 @@ static void Del( sout_stream_t *p_stream, void *_id )
 
 static int Send( sout_stream_t *p_stream, void *_id, block_t *p_buffer )
 {
+    sout_stream_sys_t *p_sys = p_stream->p_sys;
     sout_stream_id_sys_t *id = (sout_stream_id_sys_t *)_id;
+
+    if ( p_sys->pf_packet_callback != NULL )
+    {
+        /* The callback blocks the stream output, hence the demuxer, for as
+         * long as the application needs to consume the packets */
+        while ( p_buffer != NULL )
+        {
+            block_t *p_next = p_buffer->p_next;
+            p_buffer->p_next = NULL;
+            p_sys->pf_packet_callback( p_sys->p_packet_data, &id->format,
+                                       p_buffer );
+            p_buffer = p_next;
+        }
+        return VLC_SUCCESS;
+    }
     if ( id->format.i_cat == VIDEO_ES )
         return SendVideo( p_stream, id, p_buffer );
     else if ( id->format.i_cat == AUDIO_ES )
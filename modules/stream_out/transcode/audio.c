@@ -200,6 +200,10 @@ int transcode_audio_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
 
 void transcode_audio_clean( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
 {
+    if( id->i_decoded > 0 )
+        msg_Dbg( p_stream, "audio decoding took %"PRId64" us per block",
+                 US_FROM_VLC_TICK( id->i_decode_time / id->i_decoded ) );
+
     /* Close encoder */
     transcode_encoder_close( id->encoder );
     transcode_encoder_delete( id->encoder );
@@ -225,7 +229,10 @@ int transcode_audio_process( sout_stream_t *p_stream,
 {
     *out = NULL;
 
+    vlc_tick_t i_start = vlc_tick_now();
     int ret = id->p_decoder->pf_decode( id->p_decoder, in );
+    id->i_decode_time += vlc_tick_now() - i_start;
+    id->i_decoded++;
     if( ret != VLCDEC_SUCCESS )
         return VLC_EGENERIC;
 
@@ -332,9 +339,9 @@ int transcode_audio_process( sout_stream_t *p_stream,
         {
             p_audio_buf->i_dts = p_audio_buf->i_pts;
 
+            /* The encoder takes the buffer, maybe to its own thread */
             block_t *p_block = transcode_encoder_encode( id->encoder, p_audio_buf );
             block_ChainAppend( out, p_block );
-            block_Release( p_audio_buf );
         }
         continue;
 error:
@@ -343,6 +350,12 @@ error:
         id->b_error = true;
     } while( p_audio_bufs );
 
+    if( id->p_enccfg->audio.threads.b_async && transcode_encoder_opened( id->encoder ) )
+    {
+        /* Pick up any return data the encoder thread wants to output. */
+        block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
+    }
+
     /* Drain encoder */
     if( unlikely( !id->b_error && in == NULL ) && transcode_encoder_opened( id->encoder ) )
     {
@@ -56,6 +56,83 @@ static const int pi_channels_maps[9] =
      | AOUT_CHAN_LFE,
 };
 
+static block_t *EncodeAudio( transcode_encoder_t *p_enc, block_t *p_block )
+{
+    if( !p_block )
+        return p_enc->p_encoder->pf_encode_audio( p_enc->p_encoder, NULL );
+
+    vlc_tick_t i_start = vlc_tick_now();
+    block_t *p_out = p_enc->p_encoder->pf_encode_audio( p_enc->p_encoder, p_block );
+    p_enc->i_encode_time += vlc_tick_now() - i_start;
+    p_enc->i_encoded++;
+    block_Release( p_block );
+    return p_out;
+}
+
+static void* EncoderThread( void *obj )
+{
+    transcode_encoder_t *p_enc = obj;
+    block_t *p_in, *p_block;
+    int canc = vlc_savecancel ();
+
+    vlc_mutex_lock( &p_enc->lock_out );
+
+    for( ;; )
+    {
+        while( !p_enc->b_abort && p_enc->p_audio_in == NULL )
+            vlc_cond_wait( &p_enc->cond, &p_enc->lock_out );
+
+        /* Encode what we have in the queue on closing */
+        p_in = p_enc->p_audio_in;
+        if( p_in == NULL )
+            break;
+        p_enc->p_audio_in = p_in->p_next;
+        if( p_enc->p_audio_in == NULL )
+            p_enc->pp_audio_in_last = &p_enc->p_audio_in;
+        p_in->p_next = NULL;
+        vlc_sem_post( &p_enc->picture_pool_has_room );
+
+        /* release lock while encoding */
+        vlc_mutex_unlock( &p_enc->lock_out );
+        p_block = EncodeAudio( p_enc, p_in );
+        vlc_mutex_lock( &p_enc->lock_out );
+
+        block_ChainAppend( &p_enc->p_buffers, p_block );
+    }
+
+    /*Now flush encoder*/
+    do {
+        p_block = EncodeAudio( p_enc, NULL );
+        block_ChainAppend( &p_enc->p_buffers, p_block );
+    } while( p_block );
+
+    vlc_mutex_unlock( &p_enc->lock_out );
+
+    vlc_restorecancel (canc);
+
+    return NULL;
+}
+
+static void StopThread( transcode_encoder_t *p_enc )
+{
+    if( p_enc->b_threaded && !p_enc->b_abort )
+    {
+        vlc_mutex_lock( &p_enc->lock_out );
+        p_enc->b_abort = true;
+        vlc_cond_signal( &p_enc->cond );
+        vlc_mutex_unlock( &p_enc->lock_out );
+        vlc_join( p_enc->thread, NULL );
+    }
+}
+
+void transcode_encoder_audio_close( transcode_encoder_t *p_enc )
+{
+    StopThread( p_enc );
+
+    module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
+    p_enc->p_encoder->p_module = NULL;
+}
+
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
                                   const transcode_encoder_config_t *p_cfg )
 {
@@ -65,13 +142,31 @@ int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
     p_enc->p_encoder->p_module = module_need( p_enc->p_encoder, "encoder",
                                               p_cfg->psz_name, true );
 
-    if( p_enc->p_encoder->p_module )
+    if( !p_enc->p_encoder->p_module )
+        return VLC_EGENERIC;
+
+    p_enc->p_encoder->fmt_out.i_codec =
+            vlc_fourcc_GetCodec( AUDIO_ES, p_enc->p_encoder->fmt_out.i_codec );
+
+    p_enc->b_threaded = false;
+    if( p_cfg->audio.threads.b_async )
     {
-        p_enc->p_encoder->fmt_out.i_codec =
-                vlc_fourcc_GetCodec( AUDIO_ES, p_enc->p_encoder->fmt_out.i_codec );
+        vlc_sem_init( &p_enc->picture_pool_has_room, p_cfg->audio.threads.pool_size );
+        vlc_cond_init( &p_enc->cond );
+        p_enc->p_buffers = NULL;
+        p_enc->b_abort = false;
+
+        if( vlc_clone( &p_enc->thread, EncoderThread, p_enc,
+                       VLC_THREAD_PRIORITY_AUDIO ) )
+        {
+            module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
+            p_enc->p_encoder->p_module = NULL;
+            return VLC_EGENERIC;
+        }
+        p_enc->b_threaded = true;
     }
 
-    return ( p_enc->p_encoder->p_module ) ? VLC_SUCCESS: VLC_EGENERIC;
+    return VLC_SUCCESS;
 }
 
 static int encoder_audio_configure( const transcode_encoder_config_t *p_cfg,
@@ -201,15 +296,31 @@ int transcode_encoder_audio_test( encoder_t *p_encoder,
 
 block_t * transcode_encoder_audio_encode( transcode_encoder_t *p_enc, block_t *p_block )
 {
-    return p_enc->p_encoder->pf_encode_audio( p_enc->p_encoder, p_block );
+    if( !p_enc->b_threaded || !p_block )
+        return EncodeAudio( p_enc, p_block );
+
+    vlc_sem_wait( &p_enc->picture_pool_has_room );
+    vlc_mutex_lock( &p_enc->lock_out );
+    block_ChainLastAppend( &p_enc->pp_audio_in_last, p_block );
+    vlc_cond_signal( &p_enc->cond );
+    vlc_mutex_unlock( &p_enc->lock_out );
+    return NULL;
 }
 
 int transcode_encoder_audio_drain( transcode_encoder_t *p_enc, block_t **out )
 {
-    block_t *p_block;
-    do {
-        p_block = transcode_encoder_audio_encode( p_enc, NULL );
-        block_ChainAppend( out, p_block );
-    } while( p_block );
+    if( !p_enc->b_threaded )
+    {
+        block_t *p_block;
+        do {
+            p_block = EncodeAudio( p_enc, NULL );
+            block_ChainAppend( out, p_block );
+        } while( p_block );
+    }
+    else
+    {
+        StopThread( p_enc );
+        block_ChainAppend( out, transcode_encoder_get_output_async( p_enc ) );
+    }
     return VLC_SUCCESS;
 }
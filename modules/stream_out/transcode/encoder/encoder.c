@@ -51,6 +51,11 @@ void transcode_encoder_delete( transcode_encoder_t *p_enc )
             block_ChainRelease( p_enc->p_buffers );
             picture_fifo_Delete( p_enc->pp_pics );
         }
+        else if( p_enc->p_encoder->fmt_in.i_cat == AUDIO_ES )
+        {
+            block_ChainRelease( p_enc->p_buffers );
+            block_ChainRelease( p_enc->p_audio_in );
+        }
         es_format_Clean( &p_enc->p_encoder->fmt_in );
         es_format_Clean( &p_enc->p_encoder->fmt_out );
         vlc_object_delete(p_enc->p_encoder);
@@ -107,6 +112,10 @@ transcode_encoder_t * transcode_encoder_new( encoder_t *p_encoder,
             }
             vlc_mutex_init( &p_enc->lock_out );
             break;
+        case AUDIO_ES:
+            p_enc->pp_audio_in_last = &p_enc->p_audio_in;
+            vlc_mutex_init( &p_enc->lock_out );
+            break;
         default:
             break;
     }
@@ -139,6 +148,12 @@ void transcode_encoder_update_format_in( transcode_encoder_t *p_enc, const es_fo
     }
 }
 
+void transcode_encoder_video_set_ctx_in( transcode_encoder_t *p_enc,
+                                         vlc_video_context *vctx_in )
+{
+    p_enc->p_encoder->vctx_in = vctx_in;
+}
+
 void transcode_encoder_update_format_out( transcode_encoder_t *p_enc, const es_format_t *fmt )
 {
     es_format_Clean( &p_enc->p_encoder->fmt_out );
@@ -185,11 +200,20 @@ void transcode_encoder_close( transcode_encoder_t *p_enc )
         case VIDEO_ES:
             transcode_encoder_video_close( p_enc );
             break;
+        case AUDIO_ES:
+            transcode_encoder_audio_close( p_enc );
+            break;
         default:
             module_unneed( p_enc->p_encoder, p_enc->p_encoder->p_module );
             break;
     }
 
+    if( p_enc->i_encoded > 0 )
+        msg_Dbg( p_enc->p_encoder, "encoding took %"PRId64" us per frame",
+                 US_FROM_VLC_TICK( p_enc->i_encode_time / p_enc->i_encoded ) );
+    p_enc->i_encode_time = 0;
+    p_enc->i_encoded = 0;
+
     p_enc->p_encoder->p_module = NULL;
 }
 
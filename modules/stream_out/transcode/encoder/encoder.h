@@ -39,11 +39,13 @@ typedef struct
             unsigned int    i_height, i_maxheight;
             bool            b_hurry_up;
             vlc_rational_t  fps;
+            vlc_tick_t      i_latency; /* encoder latency target, 0 if none */
             struct
             {
                 unsigned int i_count;
                 int          i_priority;
                 uint32_t     pool_size;
+                bool         b_async; /* encoder thread even if i_count is 0 */
             } threads;
         } video;
         struct
@@ -51,6 +53,11 @@ typedef struct
             unsigned int    i_bitrate;
             uint32_t        i_sample_rate;
             uint32_t        i_channels;
+            struct
+            {
+                bool         b_async;
+                uint32_t     pool_size;
+            } threads;
         } audio;
         struct
         {
@@ -68,6 +75,7 @@ const es_format_t *transcode_encoder_format_out( const transcode_encoder_t * );
 void transcode_encoder_update_format_in( transcode_encoder_t *, const es_format_t *,
                                          const transcode_encoder_config_t * );
 void transcode_encoder_update_format_out( transcode_encoder_t *, const es_format_t * );
+void transcode_encoder_video_set_ctx_in( transcode_encoder_t *, vlc_video_context * );
 
 block_t * transcode_encoder_encode( transcode_encoder_t *, void * );
 block_t * transcode_encoder_get_output_async( transcode_encoder_t * );
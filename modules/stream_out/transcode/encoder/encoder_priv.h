@@ -28,9 +28,17 @@ struct transcode_encoder_t
     vlc_sem_t       picture_pool_has_room;
     vlc_cond_t      cond;
 
+    /* audio input buffers */
+    block_t         *p_audio_in;
+    block_t         **pp_audio_in_last;
+
     /* output buffers */
     block_t         *p_buffers;
     bool b_threaded;
+
+    /* encoding time, only accessed by the encoding thread until closed */
+    vlc_tick_t      i_encode_time;
+    unsigned        i_encoded;
 };
 
 int transcode_encoder_audio_open( transcode_encoder_t *p_enc,
@@ -40,6 +48,7 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
 int transcode_encoder_spu_open( transcode_encoder_t *p_enc,
                                 const transcode_encoder_config_t *p_cfg );
 
+void transcode_encoder_audio_close( transcode_encoder_t *p_enc );
 void transcode_encoder_video_close( transcode_encoder_t *p_enc );
 
 block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t *p_pic );
@@ -302,6 +302,7 @@ int transcode_encoder_video_test( encoder_t *p_encoder,
                                   es_format_t *p_enc_wanted_in )
 {
     p_encoder->i_threads = p_cfg->video.threads.i_count;
+    p_encoder->i_latency = p_cfg->video.i_latency;
     p_encoder->p_cfg = p_cfg->p_config_chain;
 
     es_format_Init( &p_encoder->fmt_in, VIDEO_ES, i_codec_in );
@@ -355,6 +356,15 @@ int transcode_encoder_video_test( encoder_t *p_encoder,
     return p_module != NULL ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+static block_t *EncodeVideo( transcode_encoder_t *p_enc, picture_t *p_pic )
+{
+    vlc_tick_t i_start = vlc_tick_now();
+    block_t *p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+    p_enc->i_encode_time += vlc_tick_now() - i_start;
+    p_enc->i_encoded++;
+    return p_block;
+}
+
 static void* EncoderThread( void *obj )
 {
     transcode_encoder_t *p_enc = obj;
@@ -375,7 +385,7 @@ static void* EncoderThread( void *obj )
         {
             /* release lock while encoding */
             vlc_mutex_unlock( &p_enc->lock_out );
-            p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+            p_block = EncodeVideo( p_enc, p_pic );
             picture_Release( p_pic );
             vlc_mutex_lock( &p_enc->lock_out );
 
@@ -390,7 +400,7 @@ static void* EncoderThread( void *obj )
     while( (p_pic = picture_fifo_Pop( p_enc->pp_pics )) != NULL )
     {
         vlc_sem_post( &p_enc->picture_pool_has_room );
-        p_block = p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+        p_block = EncodeVideo( p_enc, p_pic );
         picture_Release( p_pic );
         block_ChainAppend( &p_enc->p_buffers, p_block );
     }
@@ -453,6 +463,7 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
                                    const transcode_encoder_config_t *p_cfg )
 {
     p_enc->p_encoder->i_threads = p_cfg->video.threads.i_count;
+    p_enc->p_encoder->i_latency = p_cfg->video.i_latency;
     p_enc->p_encoder->p_cfg = p_cfg->p_config_chain;
 
     p_enc->p_encoder->p_module =
@@ -471,7 +482,7 @@ int transcode_encoder_video_open( transcode_encoder_t *p_enc,
     p_enc->p_buffers = NULL;
     p_enc->b_abort = false;
 
-    if( p_cfg->video.threads.i_count > 0 )
+    if( p_cfg->video.threads.i_count > 0 || p_cfg->video.threads.b_async )
     {
         if( vlc_clone( &p_enc->thread, EncoderThread, p_enc, p_cfg->video.threads.i_priority ) )
         {
@@ -489,7 +500,9 @@ block_t * transcode_encoder_video_encode( transcode_encoder_t *p_enc, picture_t
 {
     if( !p_enc->b_threaded )
     {
-        return p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, p_pic );
+        if( !p_pic )
+            return p_enc->p_encoder->pf_encode_video( p_enc->p_encoder, NULL );
+        return EncodeVideo( p_enc, p_pic );
     }
 
     vlc_sem_wait( &p_enc->picture_pool_has_room );
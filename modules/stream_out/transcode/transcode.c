@@ -75,6 +75,13 @@
 #define MAXHEIGHT_TEXT N_("Maximum video height")
 #define MAXHEIGHT_LONGTEXT N_( \
     "Maximum output video height." )
+#define LADDER_TEXT N_("Video renditions")
+#define LADDER_LONGTEXT N_( \
+    "Additional video renditions to encode from the same decoded and " \
+    "filtered pictures, as a comma-separated list of " \
+    "WIDTHxHEIGHT:BITRATE (eg: 1280x720:3000,640x360:800). They use the " \
+    "same encoder and options, so that a fixed GOP gives aligned " \
+    "keyframes." )
 #define VFILTER_TEXT N_("Video filter")
 #define VFILTER_LONGTEXT N_( \
     "Video filters will be applied to the video streams (after overlays " \
@@ -122,10 +129,20 @@
 #define THREADS_TEXT N_("Number of threads")
 #define THREADS_LONGTEXT N_( \
     "Number of threads used for the transcoding." )
+#define LATENCY_TEXT N_("Encoder latency (ms)")
+#define LATENCY_LONGTEXT N_( \
+    "Latency target passed to the video encoder, which trades its " \
+    "look-ahead and frame threading for slice threading to meet it. " \
+    "0 leaves the encoder defaults." )
 #define HP_TEXT N_("High priority")
 #define HP_LONGTEXT N_( \
     "Runs the optional encoder thread at the OUTPUT priority instead of " \
     "VIDEO." )
+#define PIPELINE_TEXT N_("Pipelined transcoding")
+#define PIPELINE_LONGTEXT N_( \
+    "Runs the video filters and the audio and video encoders on their own " \
+    "threads, so that decoding, filtering and encoding overlap. The " \
+    "queues between them hold up to pool-size pictures or audio buffers." )
 #define POOL_TEXT N_("Picture pool size")
 #define POOL_LONGTEXT N_( "Defines how many pictures we allow to be in pool "\
     "between decoder/encoder threads when threads > 0" )
@@ -177,6 +194,8 @@ vlc_module_begin ()
                  MAXHEIGHT_LONGTEXT, true )
     add_module_list(SOUT_CFG_PREFIX "vfilter", "video filter", NULL,
                     VFILTER_TEXT, VFILTER_LONGTEXT)
+    add_string( SOUT_CFG_PREFIX "ladder", NULL, LADDER_TEXT,
+                LADDER_LONGTEXT, true )
 
     set_section( N_("Audio"), NULL )
     add_module(SOUT_CFG_PREFIX "aenc", "encoder", NULL,
@@ -211,10 +230,15 @@ vlc_module_begin ()
     add_integer( SOUT_CFG_PREFIX "threads", 0, THREADS_TEXT,
                  THREADS_LONGTEXT, true )
         change_integer_range( 0, 32 )
+    add_integer( SOUT_CFG_PREFIX "latency", 0, LATENCY_TEXT,
+                 LATENCY_LONGTEXT, true )
+        change_integer_range( 0, 60000 )
     add_integer( SOUT_CFG_PREFIX "pool-size", 10, POOL_TEXT, POOL_LONGTEXT, true )
         change_integer_range( 1, 1000 )
     add_bool( SOUT_CFG_PREFIX "high-priority", false, HP_TEXT, HP_LONGTEXT,
               true )
+    add_bool( SOUT_CFG_PREFIX "pipeline", false, PIPELINE_TEXT,
+              PIPELINE_LONGTEXT, true )
 
 vlc_module_end ()
 
@@ -224,7 +248,7 @@ static const char *const ppsz_sout_options[] = {
     "deinterlace-module", "threads", "aenc", "acodec", "ab", "alang",
     "afilter", "samplerate", "channels", "senc", "scodec", "soverlay",
     "sfilter", "high-priority", "maxwidth", "maxheight", "pool-size",
-    NULL
+    "ladder", "pipeline", "latency", NULL
 };
 
 /*****************************************************************************
@@ -264,6 +288,8 @@ static void SetAudioEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
 
     p_cfg->audio.i_sample_rate = var_GetInteger( p_stream, SOUT_CFG_PREFIX "samplerate" );
     p_cfg->audio.i_channels = var_GetInteger( p_stream, SOUT_CFG_PREFIX "channels" );
+    p_cfg->audio.threads.b_async = var_GetBool( p_stream, SOUT_CFG_PREFIX "pipeline" );
+    p_cfg->audio.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
 
     if( p_cfg->i_codec )
     {
@@ -323,8 +349,11 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
     p_cfg->video.i_maxwidth = var_GetInteger( p_stream, SOUT_CFG_PREFIX "maxwidth" );
     p_cfg->video.i_maxheight = var_GetInteger( p_stream, SOUT_CFG_PREFIX "maxheight" );
 
+    p_cfg->video.i_latency = VLC_TICK_FROM_MS(
+                var_GetInteger( p_stream, SOUT_CFG_PREFIX "latency" ) );
     p_cfg->video.threads.i_count = var_GetInteger( p_stream, SOUT_CFG_PREFIX "threads" );
     p_cfg->video.threads.pool_size = var_GetInteger( p_stream, SOUT_CFG_PREFIX "pool-size" );
+    p_cfg->video.threads.b_async = var_GetBool( p_stream, SOUT_CFG_PREFIX "pipeline" );
 
 #if VLC_THREAD_PRIORITY_OUTPUT != VLC_THREAD_PRIORITY_VIDEO
     if( var_GetBool( p_stream, SOUT_CFG_PREFIX "high-priority" ) )
@@ -334,6 +363,48 @@ static void SetVideoEncoderConfig( sout_stream_t *p_stream, transcode_encoder_co
         p_cfg->video.threads.i_priority = VLC_THREAD_PRIORITY_VIDEO;
 }
 
+static void SetVideoLadderConfig( sout_stream_t *p_stream, sout_stream_sys_t *p_sys )
+{
+    char *psz_string = var_GetNonEmptyString( p_stream, SOUT_CFG_PREFIX "ladder" );
+    if( !psz_string )
+        return;
+
+    char *psz_save;
+    for( char *psz_rung = strtok_r( psz_string, ",", &psz_save ); psz_rung;
+         psz_rung = strtok_r( NULL, ",", &psz_save ) )
+    {
+        unsigned i_width, i_height, i_bitrate = 0;
+        if( sscanf( psz_rung, "%ux%u:%u", &i_width, &i_height, &i_bitrate ) < 2 )
+        {
+            msg_Warn( p_stream, "invalid video rendition `%s'", psz_rung );
+            continue;
+        }
+
+        transcode_encoder_config_t *p_cfgs =
+            vlc_reallocarray( p_sys->p_vladder_cfg, p_sys->i_vladder + 1,
+                              sizeof( *p_cfgs ) );
+        if( !p_cfgs )
+            break;
+        p_sys->p_vladder_cfg = p_cfgs;
+
+        transcode_encoder_config_t *p_cfg = &p_cfgs[p_sys->i_vladder++];
+        *p_cfg = p_sys->venc_cfg;
+        p_cfg->video.f_scale = 0;
+        p_cfg->video.i_width = i_width;
+        p_cfg->video.i_height = i_height;
+        p_cfg->video.i_maxwidth = p_cfg->video.i_maxheight = 0;
+        if( i_bitrate )
+            p_cfg->video.i_bitrate = i_bitrate < 16000 ? i_bitrate * 1000
+                                                       : i_bitrate;
+        /* Each rendition encodes on its own thread */
+        p_cfg->video.threads.b_async = true;
+
+        msg_Dbg( p_stream, "video rendition %ux%u %ukb/s", i_width, i_height,
+                 p_cfg->video.i_bitrate / 1000 );
+    }
+    free( psz_string );
+}
+
 static void SetSPUEncoderConfig( sout_stream_t *p_stream, transcode_encoder_config_t *p_cfg )
 {
     char *psz_string = var_GetString( p_stream, SOUT_CFG_PREFIX "senc" );
@@ -412,6 +483,7 @@ static int Open( vlc_object_t *p_this )
     transcode_encoder_config_init( &p_sys->venc_cfg );
 
     SetVideoEncoderConfig( p_stream, &p_sys->venc_cfg );
+    p_sys->b_pipeline = var_GetBool( p_stream, SOUT_CFG_PREFIX "pipeline" );
     p_sys->b_master_sync = (p_sys->venc_cfg.video.fps.num > 0);
     if( p_sys->venc_cfg.i_codec )
     {
@@ -421,6 +493,7 @@ static int Open( vlc_object_t *p_this )
                  p_sys->venc_cfg.video.i_height,
                  p_sys->venc_cfg.video.f_scale,
                  p_sys->venc_cfg.video.i_bitrate / 1000 );
+        SetVideoLadderConfig( p_stream, p_sys );
     }
 
     /* Video Filter Parameters */
@@ -479,6 +552,8 @@ static void Close( vlc_object_t * p_this )
     sout_stream_t       *p_stream = (sout_stream_t*)p_this;
     sout_stream_sys_t   *p_sys = p_stream->p_sys;
 
+    /* The renditions only borrow the strings of venc_cfg */
+    free( p_sys->p_vladder_cfg );
     transcode_encoder_config_clean( &p_sys->venc_cfg );
     sout_filters_config_clean( &p_sys->vfilters_cfg );
 
@@ -692,7 +767,7 @@ static void Del( sout_stream_t *p_stream, void *_id )
             if( id == p_sys->id_video )
                 p_sys->id_video = NULL;
             vlc_mutex_unlock( &p_sys->lock );
-            transcode_video_clean( id );
+            transcode_video_clean( p_stream, id );
             break;
         case SPU_ES:
             decoder_Destroy( id->p_decoder );
@@ -52,6 +52,10 @@ typedef struct
     /* Video */
     transcode_encoder_config_t venc_cfg;
     sout_filters_config_t vfilters_cfg;
+    /* Other video renditions, borrowing the encoder name and options */
+    transcode_encoder_config_t *p_vladder_cfg;
+    size_t          i_vladder;
+    bool            b_pipeline; /* filter the video on its own thread */
 
     /* SPU */
     transcode_encoder_config_t senc_cfg;
@@ -68,6 +72,19 @@ typedef struct
 
 struct aout_filters;
 
+/* Video rendition sharing the decoder and the filters of the main one */
+struct transcode_rendition
+{
+    const transcode_encoder_config_t *p_enccfg;
+    transcode_encoder_t *encoder;
+    filter_chain_t  *p_conv; /**< scaler from the filtered pics to the encoder */
+    void            *downstream_id;
+    block_t         *p_out; /**< encoded by the filters thread, to be sent */
+    bool             b_error;
+};
+
+struct transcode_video_pipeline;
+
 struct sout_stream_id_sys_t
 {
     bool            b_transcode;
@@ -125,6 +142,9 @@ struct sout_stream_id_sys_t
              spu_t           *p_spu;
              vlc_decoder_device *dec_dev;
              vlc_video_context *enc_vctx_in;
+             struct transcode_rendition *p_renditions;
+             size_t          i_renditions;
+             struct transcode_video_pipeline *p_pipeline; /**< filters thread */
          };
          struct
          {
@@ -142,6 +162,12 @@ struct sout_stream_id_sys_t
     const transcode_encoder_config_t *p_enccfg;
     transcode_encoder_t *encoder;
 
+    /* Decoding and filtering times, for the statistics */
+    vlc_tick_t      i_decode_time;
+    unsigned        i_decoded;
+    vlc_tick_t      i_filter_time;
+    unsigned        i_filtered;
+
     /* Sync */
     date_t          next_input_pts; /**< Incoming calculated PTS */
     vlc_tick_t      i_drift; /** how much buffer is ahead of calculated PTS */
@@ -201,7 +227,7 @@ int  transcode_audio_init   ( sout_stream_t *, const es_format_t *,
 
 /* VIDEO */
 
-void transcode_video_clean  ( sout_stream_id_sys_t * );
+void transcode_video_clean  ( sout_stream_t *, sout_stream_id_sys_t * );
 int  transcode_video_process( sout_stream_t *, sout_stream_id_sys_t *,
                                      block_t *, block_t ** );
 int transcode_video_get_output_dimensions( sout_stream_id_sys_t *,
@@ -46,6 +46,25 @@ struct encoder_owner
     sout_stream_id_sys_t *id;
 };
 
+/* Runs the filters and feeds the encoders while the next pictures decode */
+struct transcode_video_pipeline
+{
+    sout_stream_t *p_stream;
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+    vlc_cond_t  wait; /**< pictures queued or abort, for the thread */
+    vlc_cond_t  idle; /**< picture dequeued or done, for the sout thread */
+    vlc_picture_chain_t pics;
+    unsigned    i_pics;
+    unsigned    i_max_pics;
+    bool        b_busy;
+    bool        b_abort;
+    block_t     *p_out; /**< from synchronous main encoders */
+};
+
+static void transcode_video_pipeline_start( sout_stream_t *, sout_stream_id_sys_t * );
+static void transcode_video_pipeline_stop( sout_stream_id_sys_t * );
+
 static vlc_decoder_device *TranscodeHoldDecoderDevice(vlc_object_t *o, sout_stream_id_sys_t *id)
 {
     if (id->dec_dev == NULL)
@@ -247,6 +266,32 @@ int transcode_video_init( sout_stream_t *p_stream, const es_format_t *p_fmt,
     p_enc_owner->id = id;
     p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
 
+    /* Other renditions, sharing the decoder and the filters */
+    const sout_stream_sys_t *p_sys = p_stream->p_sys;
+    if( id->p_enccfg == &p_sys->venc_cfg && p_sys->i_vladder > 0 )
+    {
+        id->p_renditions = calloc( p_sys->i_vladder, sizeof( *id->p_renditions ) );
+        for( size_t i = 0; id->p_renditions && i < p_sys->i_vladder; i++ )
+        {
+            struct transcode_rendition *r = &id->p_renditions[id->i_renditions];
+
+            p_enc_owner = (struct encoder_owner *)sout_EncoderCreate(p_stream, sizeof(struct encoder_owner));
+            if( unlikely(p_enc_owner == NULL) )
+                break;
+            p_enc_owner->id = id;
+            p_enc_owner->enc.cbs = &encoder_video_transcode_cbs;
+
+            r->encoder = transcode_encoder_new( &p_enc_owner->enc, &encoder_tested_fmt_in );
+            if( !r->encoder )
+                continue;
+            r->p_enccfg = &p_sys->p_vladder_cfg[i];
+            id->i_renditions++;
+        }
+    }
+
+    if( p_sys->b_pipeline )
+        transcode_video_pipeline_start( p_stream, id );
+
     es_format_Clean( &encoder_tested_fmt_in );
 
     return VLC_SUCCESS;
@@ -322,11 +367,14 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
         filter_chain_Reset( id->p_uf_chain, p_src, src_ctx, p_dst );
         filter_chain_AppendFromString( id->p_uf_chain, p_cfg->psz_filters );
         p_src = filter_chain_GetFmtOut( id->p_uf_chain );
+        src_ctx = filter_chain_GetVideoCtxOut( id->p_uf_chain );
         debug_format( p_stream, p_src );
     }
 
     /* Update encoder so it matches filters output */
     transcode_encoder_update_format_in( id->encoder, p_src, id->p_enccfg );
+    /* Hardware encoders can then use the surfaces that left the filters */
+    transcode_encoder_video_set_ctx_in( id->encoder, src_ctx );
 
     /* SPU Sources */
     if( p_cfg->video.psz_spu_sources )
@@ -338,12 +386,198 @@ static int transcode_video_filters_init( sout_stream_t *p_stream,
     return VLC_SUCCESS;
 }
 
-void transcode_video_clean( sout_stream_id_sys_t *id )
+static void tag_last_block_with_flag( block_t **out, int i_flag )
+{
+    block_t *p_last = *out;
+    if( p_last )
+    {
+        while( p_last->p_next )
+            p_last = p_last->p_next;
+        p_last->i_flags |= i_flag;
+    }
+}
+
+static void transcode_video_rendition_output( sout_stream_t *p_stream,
+                                              struct transcode_rendition *r,
+                                              block_t *p_out )
+{
+    if( !p_out )
+        return;
+    if( !r->downstream_id )
+        block_ChainRelease( p_out );
+    else if( sout_StreamIdSend( p_stream->p_next, r->downstream_id, p_out ) )
+        r->b_error = true;
+}
+
+static void transcode_video_rendition_send( sout_stream_t *p_stream,
+                                            sout_stream_id_sys_t *id,
+                                            struct transcode_rendition *r,
+                                            block_t *p_out )
+{
+    struct transcode_video_pipeline *pl = id->p_pipeline;
+    if( !pl )
+    {
+        transcode_video_rendition_output( p_stream, r, p_out );
+        return;
+    }
+    /* The next stream is only called from the sout thread */
+    vlc_mutex_lock( &pl->lock );
+    block_ChainAppend( &r->p_out, p_out );
+    vlc_mutex_unlock( &pl->lock );
+}
+
+static void transcode_video_renditions_flush( sout_stream_t *p_stream,
+                                              sout_stream_id_sys_t *id )
+{
+    struct transcode_video_pipeline *pl = id->p_pipeline;
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *r = &id->p_renditions[i];
+        if( pl )
+        {
+            vlc_mutex_lock( &pl->lock );
+            block_t *p_out = r->p_out;
+            r->p_out = NULL;
+            vlc_mutex_unlock( &pl->lock );
+            transcode_video_rendition_output( p_stream, r, p_out );
+        }
+        if( r->p_enccfg->video.threads.b_async && transcode_encoder_opened( r->encoder ) )
+            transcode_video_rendition_output( p_stream, r,
+                                 transcode_encoder_get_output_async( r->encoder ) );
+    }
+}
+
+static int transcode_video_rendition_configure( sout_stream_t *p_stream,
+                                                sout_stream_id_sys_t *id,
+                                                struct transcode_rendition *r,
+                                                picture_t *p_pic )
+{
+    const filter_chain_t *p_last = id->p_uf_chain ? id->p_uf_chain : id->p_f_chain;
+    const es_format_t *p_src = filter_chain_GetFmtOut( p_last );
+    vlc_video_context *src_ctx = filter_chain_GetVideoCtxOut( p_last );
+
+    transcode_remove_filters( &r->p_conv );
+
+    if( !transcode_encoder_opened( r->encoder ) )
+    {
+        transcode_encoder_video_configure( VLC_OBJECT(p_stream),
+                                           &id->p_decoder->fmt_out.video,
+                                           r->p_enccfg, &p_pic->format,
+                                           picture_GetVideoContext(p_pic),
+                                           r->encoder );
+        transcode_encoder_update_format_in( r->encoder, p_src, r->p_enccfg );
+        transcode_encoder_video_set_ctx_in( r->encoder, src_ctx );
+        if( transcode_encoder_open( r->encoder, r->p_enccfg ) != VLC_SUCCESS )
+        {
+            msg_Err( p_stream, "cannot open the %ux%u video rendition encoder",
+                     r->p_enccfg->video.i_width, r->p_enccfg->video.i_height );
+            return VLC_EGENERIC;
+        }
+    }
+
+    const es_format_t *encoder_fmt_in = transcode_encoder_format_in( r->encoder );
+    if( p_src->i_codec != encoder_fmt_in->i_codec ||
+        p_src->video.i_width  != encoder_fmt_in->video.i_width ||
+        p_src->video.i_height != encoder_fmt_in->video.i_height ||
+        p_src->video.i_visible_width  != encoder_fmt_in->video.i_visible_width ||
+        p_src->video.i_visible_height != encoder_fmt_in->video.i_visible_height )
+    {
+        r->p_conv = filter_chain_NewVideo( p_stream, false, NULL );
+        if( !r->p_conv )
+            return VLC_EGENERIC;
+        filter_chain_Reset( r->p_conv, p_src, src_ctx, encoder_fmt_in );
+        if( filter_chain_AppendConverter( r->p_conv, NULL ) != VLC_SUCCESS )
+            return VLC_EGENERIC;
+    }
+
+    if( !r->downstream_id )
+    {
+        /* Not the ES of the source: let the muxer pick a new id */
+        es_format_t fmt_orig = id->p_decoder->fmt_in;
+        fmt_orig.i_id = -1;
+        r->downstream_id =
+            id->pf_transcode_downstream_add( p_stream, &fmt_orig,
+                                             transcode_encoder_format_out( r->encoder ) );
+        if( !r->downstream_id )
+            return VLC_EGENERIC;
+    }
+    return VLC_SUCCESS;
+}
+
+static void transcode_video_renditions_encode( sout_stream_t *p_stream,
+                                               sout_stream_id_sys_t *id,
+                                               picture_t *p_pic )
 {
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *r = &id->p_renditions[i];
+        if( r->b_error || !transcode_encoder_opened( r->encoder ) )
+            continue;
+
+        /* Every rendition reads the same filtered picture */
+        picture_t *p_in = picture_Hold( p_pic );
+        if( r->p_conv )
+            p_in = filter_chain_VideoFilter( r->p_conv, p_in );
+        if( !p_in )
+            continue;
+
+        block_t *p_out = transcode_encoder_encode( r->encoder, p_in );
+        picture_Release( p_in );
+        transcode_video_rendition_send( p_stream, id, r, p_out );
+    }
+}
+
+static void transcode_video_renditions_drain( sout_stream_t *p_stream,
+                                              sout_stream_id_sys_t *id,
+                                              bool b_close )
+{
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *r = &id->p_renditions[i];
+        if( !transcode_encoder_opened( r->encoder ) )
+            continue;
+
+        block_t *p_out = NULL;
+        if( !r->b_error && transcode_encoder_drain( r->encoder, &p_out ) != VLC_SUCCESS )
+            msg_Warn( p_stream, "Flushing the %ux%u video rendition failed",
+                      r->p_enccfg->video.i_width, r->p_enccfg->video.i_height );
+        if( b_close )
+        {
+            tag_last_block_with_flag( &p_out, BLOCK_FLAG_END_OF_SEQUENCE );
+            transcode_encoder_close( r->encoder );
+            transcode_remove_filters( &r->p_conv );
+        }
+        transcode_video_rendition_output( p_stream, r, p_out );
+    }
+}
+
+void transcode_video_clean( sout_stream_t *p_stream, sout_stream_id_sys_t *id )
+{
+    if( id->p_pipeline )
+        transcode_video_pipeline_stop( id );
+
+    if( id->i_decoded > 0 && id->i_filtered > 0 )
+        msg_Dbg( p_stream, "video decoding took %"PRId64" us per block, "
+                 "filtering %"PRId64" us per picture",
+                 US_FROM_VLC_TICK( id->i_decode_time / id->i_decoded ),
+                 US_FROM_VLC_TICK( id->i_filter_time / id->i_filtered ) );
+
     /* Close encoder */
     transcode_encoder_close( id->encoder );
     transcode_encoder_delete( id->encoder );
 
+    for( size_t i = 0; i < id->i_renditions; i++ )
+    {
+        struct transcode_rendition *r = &id->p_renditions[i];
+        transcode_encoder_close( r->encoder );
+        transcode_encoder_delete( r->encoder );
+        transcode_remove_filters( &r->p_conv );
+        block_ChainRelease( r->p_out );
+        if( r->downstream_id )
+            sout_StreamIdDel( p_stream->p_next, r->downstream_id );
+    }
+    free( id->p_renditions );
+
     es_format_Clean( &id->decoder_out );
 
     /* Close filters */
@@ -402,10 +636,21 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
                                          &outfmt, vlc_tick_now(), p_pic->date,
                                          false, false );
 
+    /* Hardware surfaces can't be blended into */
+    const vlc_chroma_description_t *p_dsc =
+        vlc_fourcc_GetChromaDescription( fmt.i_chroma );
+    if( p_subpic && ( p_dsc == NULL || p_dsc->plane_count == 0 ) )
+    {
+        msg_Dbg( id->p_spu, "cannot blend subpicture into %4.4s pictures",
+                 (const char *)&fmt.i_chroma );
+        subpicture_Delete( p_subpic );
+        p_subpic = NULL;
+    }
+
     /* Overlay subpicture */
     if( p_subpic )
     {
-        if( filter_chain_IsEmpty( id->p_f_chain ) )
+        if( filter_chain_IsEmpty( id->p_f_chain ) || id->i_renditions > 0 )
         {
             /* We can't modify the picture, we need to duplicate it,
                  * in this point the picture is already p_encoder->fmt.in format*/
@@ -429,15 +674,160 @@ static picture_t * RenderSubpictures( sout_stream_id_sys_t *id, picture_t *p_pic
     return p_pic;
 }
 
-static void tag_last_block_with_flag( block_t **out, int i_flag )
+static void transcode_video_filter_encode( sout_stream_t *p_stream,
+                                           sout_stream_id_sys_t *id,
+                                           picture_t *p_pic, block_t **out )
 {
-    block_t *p_last = *out;
-    if( p_last )
+    vlc_tick_t i_start = vlc_tick_now();
+
+    /* Run the filter and output chains; first with the picture,
+     * and then with NULL as many times as we need until they
+     * stop outputting frames.
+     */
+    for ( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
     {
-        while( p_last->p_next )
-            p_last = p_last->p_next;
-        p_last->i_flags |= i_flag;
+        /* Run filter chain */
+        if( id->p_f_chain )
+            p_in = filter_chain_VideoFilter( id->p_f_chain, p_in );
+
+        if( !p_in )
+            break;
+
+        for ( ;; p_in = NULL /* drain second time */ )
+        {
+            /* Run user specified filter chain */
+            if( p_in && id->p_uf_chain )
+                p_in = filter_chain_VideoFilter( id->p_uf_chain, p_in );
+
+            if( !p_in )
+                break;
+
+            /* Fan out the filtered picture to the other renditions */
+            transcode_video_renditions_encode( p_stream, id, p_in );
+
+            if( id->p_final_conv_static )
+                p_in = filter_chain_VideoFilter( id->p_final_conv_static, p_in );
+
+            if( !p_in )
+                continue;
+
+            /* Blend subpictures */
+            p_in = RenderSubpictures( id, p_in );
+
+            if( p_in )
+            {
+                block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
+                if( p_encoded )
+                    block_ChainAppend( out, p_encoded );
+                picture_Release( p_in );
+            }
+        }
     }
+
+    id->i_filter_time += vlc_tick_now() - i_start;
+    id->i_filtered++;
+}
+
+static void *transcode_video_pipeline_thread( void *data )
+{
+    sout_stream_id_sys_t *id = data;
+    struct transcode_video_pipeline *pl = id->p_pipeline;
+    int canc = vlc_savecancel();
+
+    vlc_mutex_lock( &pl->lock );
+    for( ;; )
+    {
+        while( !pl->b_abort && vlc_picture_chain_IsEmpty( &pl->pics ) )
+            vlc_cond_wait( &pl->wait, &pl->lock );
+
+        /* Filter what we have in the queue on closing */
+        if( vlc_picture_chain_IsEmpty( &pl->pics ) )
+            break;
+        picture_t *p_pic = vlc_picture_chain_PopFront( &pl->pics );
+        pl->i_pics--;
+        pl->b_busy = true;
+        vlc_cond_signal( &pl->idle );
+        vlc_mutex_unlock( &pl->lock );
+
+        block_t *p_out = NULL;
+        transcode_video_filter_encode( pl->p_stream, id, p_pic, &p_out );
+
+        vlc_mutex_lock( &pl->lock );
+        block_ChainAppend( &pl->p_out, p_out );
+        pl->b_busy = false;
+        vlc_cond_signal( &pl->idle );
+    }
+    vlc_mutex_unlock( &pl->lock );
+
+    vlc_restorecancel( canc );
+    return NULL;
+}
+
+static void transcode_video_pipeline_push( struct transcode_video_pipeline *pl,
+                                           picture_t *p_pic )
+{
+    vlc_mutex_lock( &pl->lock );
+    while( pl->i_pics >= pl->i_max_pics )
+        vlc_cond_wait( &pl->idle, &pl->lock );
+    vlc_picture_chain_Append( &pl->pics, p_pic );
+    pl->i_pics++;
+    vlc_cond_signal( &pl->wait );
+    vlc_mutex_unlock( &pl->lock );
+}
+
+/* Gets the encoded blocks; with b_wait, once all the queued pictures are
+ * filtered, so that the filters and encoders can be used from the caller */
+static void transcode_video_pipeline_output( struct transcode_video_pipeline *pl,
+                                             bool b_wait, block_t **out )
+{
+    vlc_mutex_lock( &pl->lock );
+    while( b_wait && ( pl->b_busy || !vlc_picture_chain_IsEmpty( &pl->pics ) ) )
+        vlc_cond_wait( &pl->idle, &pl->lock );
+    block_ChainAppend( out, pl->p_out );
+    pl->p_out = NULL;
+    vlc_mutex_unlock( &pl->lock );
+}
+
+static void transcode_video_pipeline_start( sout_stream_t *p_stream,
+                                            sout_stream_id_sys_t *id )
+{
+    struct transcode_video_pipeline *pl = malloc( sizeof( *pl ) );
+    if( unlikely( !pl ) )
+        return;
+
+    pl->p_stream = p_stream;
+    vlc_mutex_init( &pl->lock );
+    vlc_cond_init( &pl->wait );
+    vlc_cond_init( &pl->idle );
+    vlc_picture_chain_Init( &pl->pics );
+    pl->i_pics = 0;
+    pl->i_max_pics = __MAX( id->p_enccfg->video.threads.pool_size, 1 );
+    pl->b_busy = pl->b_abort = false;
+    pl->p_out = NULL;
+
+    id->p_pipeline = pl;
+    if( vlc_clone( &pl->thread, transcode_video_pipeline_thread, id,
+                   id->p_enccfg->video.threads.i_priority ) )
+    {
+        msg_Warn( p_stream, "cannot start the video filters thread" );
+        id->p_pipeline = NULL;
+        free( pl );
+    }
+}
+
+static void transcode_video_pipeline_stop( sout_stream_id_sys_t *id )
+{
+    struct transcode_video_pipeline *pl = id->p_pipeline;
+
+    vlc_mutex_lock( &pl->lock );
+    pl->b_abort = true;
+    vlc_cond_signal( &pl->wait );
+    vlc_mutex_unlock( &pl->lock );
+    vlc_join( pl->thread, NULL );
+
+    block_ChainRelease( pl->p_out );
+    free( pl );
+    id->p_pipeline = NULL;
 }
 
 int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
@@ -447,7 +837,10 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
 
     bool b_eos = in && (in->i_flags & BLOCK_FLAG_END_OF_SEQUENCE);
 
+    vlc_tick_t i_start = vlc_tick_now();
     int ret = id->p_decoder->pf_decode( id->p_decoder, in );
+    id->i_decode_time += vlc_tick_now() - i_start;
+    id->i_decoded++;
     if( ret != VLCDEC_SUCCESS )
         return VLC_EGENERIC;
 
@@ -466,6 +859,10 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
         if( p_pic && ( unlikely(!transcode_encoder_opened(id->encoder)) ||
               !video_format_IsSimilar( &id->decoder_out.video, &p_pic->format ) ) )
         {
+            /* The filters thread must not use the chains being changed */
+            if( id->p_pipeline )
+                transcode_video_pipeline_output( id->p_pipeline, true, out );
+
             if( !transcode_encoder_opened(id->encoder) ) /* Configure Encoder input/output */
             {
                 assert( !id->p_f_chain && !id->p_uf_chain );
@@ -530,12 +927,18 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
             /* The fmt_in may have been overriden by the encoder. */
             const es_format_t *encoder_fmt_in = transcode_encoder_format_in( id->encoder );
 
+            /* The converter takes what left the filters, which may still be
+             * hardware surfaces: the chain then scales before reading back. */
+            const filter_chain_t *p_last = id->p_uf_chain ? id->p_uf_chain
+                                                          : id->p_f_chain;
+            const es_format_t *p_fmt_last = filter_chain_GetFmtOut( p_last );
+
             /* check if we need to add a converter between last user filter and encoder. */
             if( filter_fmt_out.i_codec != encoder_fmt_in->i_codec ||
-                id->decoder_out.video.i_width  != encoder_fmt_in->video.i_width ||
-                id->decoder_out.video.i_height != encoder_fmt_in->video.i_height ||
-                id->decoder_out.video.i_visible_width  != encoder_fmt_in->video.i_visible_width ||
-                id->decoder_out.video.i_visible_height != encoder_fmt_in->video.i_visible_height )
+                p_fmt_last->video.i_width  != encoder_fmt_in->video.i_width ||
+                p_fmt_last->video.i_height != encoder_fmt_in->video.i_height ||
+                p_fmt_last->video.i_visible_width  != encoder_fmt_in->video.i_visible_width ||
+                p_fmt_last->video.i_visible_height != encoder_fmt_in->video.i_visible_height )
             {
                 if ( !id->p_final_conv_static )
                     id->p_final_conv_static =
@@ -552,8 +955,8 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                 }
 
                 filter_chain_Reset( id->p_final_conv_static,
-                                    &id->decoder_out,
-                                    picture_GetVideoContext(p_pic),
+                                    p_fmt_last,
+                                    filter_chain_GetVideoCtxOut( p_last ),
                                     encoder_fmt_in );
                 filter_chain_AppendConverter( id->p_final_conv_static, NULL );
             }
@@ -574,54 +977,30 @@ int transcode_video_process( sout_stream_t *p_stream, sout_stream_id_sys_t *id,
                                    (char *) &id->p_enccfg->i_codec );
                 goto error;
             }
-        }
-
-        /* Run the filter and output chains; first with the picture,
-         * and then with NULL as many times as we need until they
-         * stop outputting frames.
-         */
-        for ( picture_t *p_in = p_pic; ; p_in = NULL /* drain second time */ )
-        {
-            /* Run filter chain */
-            if( id->p_f_chain )
-                p_in = filter_chain_VideoFilter( id->p_f_chain, p_in );
-
-            if( !p_in )
-                break;
-
-            for ( ;; p_in = NULL /* drain second time */ )
-            {
-                /* Run user specified filter chain */
-                filter_chain_t * secondary_chains[] = { id->p_uf_chain,
-                                                        id->p_final_conv_static };
-                for( size_t i=0; p_in && i<ARRAY_SIZE(secondary_chains); i++ )
-                {
-                    if( !secondary_chains[i] )
-                        continue;
-                    p_in = filter_chain_VideoFilter( secondary_chains[i], p_in );
-                }
-
-                if( !p_in )
-                    break;
-
-                /* Blend subpictures */
-                p_in = RenderSubpictures( id, p_in );
 
-                if( p_in )
-                {
-                    block_t *p_encoded = transcode_encoder_encode( id->encoder, p_in );
-                    if( p_encoded )
-                        block_ChainAppend( out, p_encoded );
-                    picture_Release( p_in );
-                }
-            }
+            for( size_t i = 0; i < id->i_renditions; i++ )
+                if( transcode_video_rendition_configure( p_stream, id,
+                                                         &id->p_renditions[i],
+                                                         p_pic ) != VLC_SUCCESS )
+                    id->p_renditions[i].b_error = true;
         }
 
+        if( id->p_pipeline )
+            transcode_video_pipeline_push( id->p_pipeline, p_pic );
+        else
+            transcode_video_filter_encode( p_stream, id, p_pic, out );
+
         if( b_eos )
         {
             msg_Info( p_stream, "Drain/restart on EOS" );
+            if( id->p_pipeline )
+            {
+                transcode_video_pipeline_output( id->p_pipeline, true, out );
+                transcode_video_renditions_flush( p_stream, id );
+            }
             if( transcode_encoder_drain( id->encoder, out ) != VLC_SUCCESS )
                 goto error;
+            transcode_video_renditions_drain( p_stream, id, true );
             transcode_encoder_close( id->encoder );
             /* Close filters */
             transcode_remove_filters( &id->p_f_chain );
@@ -638,12 +1017,19 @@ error:
         id->b_error = true;
     }
 
-    if( id->p_enccfg->video.threads.i_count >= 1 )
+    /* Wait for the queued pictures before draining */
+    if( id->p_pipeline )
+        transcode_video_pipeline_output( id->p_pipeline, in == NULL, out );
+
+    if( id->p_enccfg->video.threads.i_count >= 1 ||
+        id->p_enccfg->video.threads.b_async )
     {
         /* Pick up any return data the encoder thread wants to output. */
         block_ChainAppend( out, transcode_encoder_get_output_async( id->encoder ) );
     }
 
+    transcode_video_renditions_flush( p_stream, id );
+
     /* Drain encoder */
     if( unlikely( !id->b_error && in == NULL ) && transcode_encoder_opened( id->encoder ) )
     {
@@ -652,6 +1038,7 @@ error:
             msg_Dbg( p_stream, "Flushing done");
         else
             msg_Warn( p_stream, "Flushing failed");
+        transcode_video_renditions_drain( p_stream, id, false );
     }
 
     if( b_eos )
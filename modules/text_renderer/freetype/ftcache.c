@@ -45,6 +45,13 @@ struct vlc_ftcache_t
     FTC_CMapCache     charmap_cache;
     /* Derived glyph cache */
     vlc_lru *         glyphs_lrucache;
+    /* Shaped runs cache */
+    vlc_lru *         runs_lrucache;
+    /* Statistics */
+    unsigned          glyphs_hits;
+    unsigned          glyphs_misses;
+    unsigned          runs_hits;
+    unsigned          runs_misses;
     /* current face properties */
     FT_Long           style_flags;
 };
@@ -187,6 +194,12 @@ static void LRUGlyphRefRelease( void *priv, void *v )
     }
 }
 
+static void LRUShapedRunRelease( void *priv, void *v )
+{
+    VLC_UNUSED(priv);
+    vlc_ftcache_ShapedRun_Release( v );
+}
+
 static void FreeFaceID( void *p_faceid, void *p_obj )
 {
     VLC_UNUSED(p_obj);
@@ -197,8 +210,15 @@ static void FreeFaceID( void *p_faceid, void *p_obj )
 
 void vlc_ftcache_Delete( vlc_ftcache_t *ftcache )
 {
+    msg_Dbg( ftcache->obj, "outlined glyphs cache: %u hits, %u misses",
+             ftcache->glyphs_hits, ftcache->glyphs_misses );
+    msg_Dbg( ftcache->obj, "shaped runs cache: %u hits, %u misses",
+             ftcache->runs_hits, ftcache->runs_misses );
+
     if( ftcache->glyphs_lrucache )
         vlc_lru_Release( ftcache->glyphs_lrucache );
+    if( ftcache->runs_lrucache )
+        vlc_lru_Release( ftcache->runs_lrucache );
 
     if( ftcache->cachemanager )
         FTC_Manager_Done( ftcache->cachemanager );
@@ -221,8 +241,9 @@ vlc_ftcache_t * vlc_ftcache_New( vlc_object_t *obj, FT_Library p_library,
     vlc_dictionary_init( &ftcache->face_ids, 50 );
 
     ftcache->glyphs_lrucache = vlc_lru_New( 128, LRUGlyphRefRelease, ftcache );
+    ftcache->runs_lrucache = vlc_lru_New( 256, LRUShapedRunRelease, ftcache );
 
-    if(!ftcache->glyphs_lrucache ||
+    if(!ftcache->glyphs_lrucache || !ftcache->runs_lrucache ||
        FTC_Manager_New( p_library, 4, 8, maxkb << 10,
                         RequestFace, ftcache, &ftcache->cachemanager ) ||
        FTC_ImageCache_New( ftcache->cachemanager, &ftcache->image_cache ) ||
@@ -265,7 +286,12 @@ vlc_ftcache_GetCustomGlyph( vlc_ftcache_t *ftcache, const char *psz_key )
 {
     vlc_ftcache_custom_glyph_ref_t ref = vlc_lru_Get( ftcache->glyphs_lrucache, psz_key );
     if( ref )
+    {
         ref->refcount++;
+        ftcache->glyphs_hits++;
+    }
+    else
+        ftcache->glyphs_misses++;
     return ref;
 }
 
@@ -339,3 +365,40 @@ FT_Glyph vlc_ftcache_GetOutlinedGlyph( vlc_ftcache_t *ftcache, const vlc_face_id
     free( psz_key );
     return glyph;
 }
+
+vlc_ftcache_shaped_run_t * vlc_ftcache_GetShapedRun( vlc_ftcache_t *ftcache,
+                                                     const char *psz_key )
+{
+    vlc_ftcache_shaped_run_t *run = vlc_lru_Get( ftcache->runs_lrucache, psz_key );
+    if( run )
+    {
+        run->refcount++;
+        ftcache->runs_hits++;
+    }
+    else
+        ftcache->runs_misses++;
+    return run;
+}
+
+vlc_ftcache_shaped_run_t * vlc_ftcache_AddShapedRun( vlc_ftcache_t *ftcache,
+                                                     const char *psz_key,
+                                                     unsigned count )
+{
+    assert(!vlc_lru_Get( ftcache->runs_lrucache, psz_key ));
+    vlc_ftcache_shaped_run_t *run =
+        malloc( sizeof(*run) + count * sizeof(run->glyphs[0]) );
+    if( run )
+    {
+        run->refcount = 2;
+        run->count = count;
+        vlc_lru_Insert( ftcache->runs_lrucache, psz_key, run );
+    }
+    return run;
+}
+
+void vlc_ftcache_ShapedRun_Release( vlc_ftcache_shaped_run_t *run )
+{
+    assert(run->refcount);
+    if( --run->refcount == 0 )
+        free( run );
+}
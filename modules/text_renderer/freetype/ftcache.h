@@ -85,6 +85,32 @@ FT_Glyph vlc_ftcache_GetOutlinedGlyph( vlc_ftcache_t *ftcache, const vlc_face_id
 void vlc_ftcache_Custom_Glyph_Init( vlc_ftcache_custom_glyph_t * );
 void vlc_ftcache_Custom_Glyph_Release( vlc_ftcache_custom_glyph_t * );
 
+/* Shaped runs cache. Stores the result of the text shaping of a run,
+ * in visual order, as refcounted entries. */
+typedef struct
+{
+    FT_UInt index;
+    unsigned cluster;
+    int x_offset;
+    int y_offset;
+    int x_advance;
+    int y_advance;
+} vlc_ftcache_shaped_glyph_t;
+
+typedef struct
+{
+    unsigned refcount;
+    unsigned count;
+    vlc_ftcache_shaped_glyph_t glyphs[];
+} vlc_ftcache_shaped_run_t;
+
+/* Returns a reference to the run of the key or NULL */
+vlc_ftcache_shaped_run_t * vlc_ftcache_GetShapedRun( vlc_ftcache_t *, const char *psz_key );
+/* Returns a reference to a new run of count glyphs, to be filled */
+vlc_ftcache_shaped_run_t * vlc_ftcache_AddShapedRun( vlc_ftcache_t *, const char *psz_key,
+                                                     unsigned count );
+void vlc_ftcache_ShapedRun_Release( vlc_ftcache_shaped_run_t * );
+
 #ifdef __cplusplus
 }
 #endif
@@ -66,6 +66,7 @@
 #include "platform_fonts.h"
 
 #include <stdlib.h>
+#include <vlc_memstream.h>
 
 /* Win32 */
 #ifdef _WIN32
@@ -107,7 +108,7 @@ typedef struct run_desc_t
 #ifdef HAVE_HARFBUZZ
     hb_script_t                 script;
     hb_direction_t              direction;
-    hb_buffer_t                *p_buffer;
+    vlc_ftcache_shaped_run_t   *p_shaped;
 #endif
 
 } run_desc_t;
@@ -686,6 +687,107 @@ static int ItemizeParagraph( filter_t *p_filter, paragraph_t *p_paragraph )
  * Glyph substitutions of base glyphs and diacritics may take place,
  * so the paragraph size may change.
  */
+/**
+ * Shapes a run with HarfBuzz, or gets the glyphs of the same text
+ * previously shaped with the same face and size.
+ */
+static vlc_ftcache_shaped_run_t *ShapeRunHarfBuzz( filter_t *p_filter,
+                                                   const paragraph_t *p_paragraph,
+                                                   const run_desc_t *p_run,
+                                                   const vlc_ftcache_metrics_t *p_metrics )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const vlc_face_id_t *p_faceid = p_run->p_faceid;
+    const int i_length = p_run->i_end_offset - p_run->i_start_offset;
+
+    struct vlc_memstream key;
+    vlc_memstream_open( &key );
+    vlc_memstream_printf( &key, "%s#%d#%d,%d,%x,%x:",
+                          p_faceid->psz_filename, p_faceid->idx,
+                          p_metrics->width_px, p_metrics->height_px,
+                          (unsigned) p_run->script, (unsigned) p_run->direction );
+    for( int i = p_run->i_start_offset; i < p_run->i_end_offset; ++i )
+        vlc_memstream_printf( &key, "%x,",
+                              (unsigned) p_paragraph->p_code_points[ i ] );
+    if( vlc_memstream_close( &key ) )
+        return NULL;
+
+    vlc_ftcache_shaped_run_t *p_shaped =
+        vlc_ftcache_GetShapedRun( p_sys->ftcache, key.ptr );
+    if( p_shaped )
+        goto end;
+
+    FT_Face p_face = vlc_ftcache_LoadFaceByID( p_sys->ftcache, p_run->p_faceid,
+                                               p_metrics );
+    if( !p_face )
+        goto end;
+
+    hb_font_t *p_hb_font = hb_ft_font_create( p_face, 0 );
+    if( !p_hb_font )
+    {
+        msg_Err( p_filter,
+                 "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
+        goto end;
+    }
+
+    hb_buffer_t *p_buffer = hb_buffer_create();
+    if( !p_buffer )
+    {
+        msg_Err( p_filter,
+                 "ShapeParagraphHarfBuzz(): hb_buffer_create() error" );
+        hb_font_destroy( p_hb_font );
+        goto end;
+    }
+
+    hb_buffer_set_direction( p_buffer, p_run->direction );
+    hb_buffer_set_script( p_buffer, p_run->script );
+#ifdef __OS2__
+    hb_buffer_add_utf16( p_buffer,
+                         p_paragraph->p_code_points + p_run->i_start_offset,
+                         i_length, 0, i_length );
+#else
+    hb_buffer_add_utf32( p_buffer,
+                         p_paragraph->p_code_points + p_run->i_start_offset,
+                         i_length, 0, i_length );
+#endif
+    hb_shape( p_hb_font, p_buffer, 0, 0 );
+
+    hb_font_destroy( p_hb_font );
+
+    unsigned int i_glyph_count;
+    const hb_glyph_info_t *p_infos =
+            hb_buffer_get_glyph_infos( p_buffer, &i_glyph_count );
+    const hb_glyph_position_t *p_positions =
+            hb_buffer_get_glyph_positions( p_buffer, &i_glyph_count );
+
+    if( i_glyph_count == 0 )
+        msg_Err( p_filter,
+                 "ShapeParagraphHarfBuzz() invalid glyph count in shaped run" );
+    else
+        p_shaped = vlc_ftcache_AddShapedRun( p_sys->ftcache, key.ptr,
+                                             i_glyph_count );
+
+    if( p_shaped )
+    {
+        for( unsigned int i = 0; i < i_glyph_count; ++i )
+        {
+            p_shaped->glyphs[ i ] = (vlc_ftcache_shaped_glyph_t) {
+                .index = p_infos[ i ].codepoint,
+                .cluster = p_infos[ i ].cluster,
+                .x_offset = p_positions[ i ].x_offset,
+                .y_offset = p_positions[ i ].y_offset,
+                .x_advance = p_positions[ i ].x_advance,
+                .y_advance = p_positions[ i ].y_advance,
+            };
+        }
+    }
+    hb_buffer_destroy( p_buffer );
+
+end:
+    free( key.ptr );
+    return p_shaped;
+}
+
 static int ShapeParagraphHarfBuzz( filter_t *p_filter,
                                    paragraph_t **p_old_paragraph )
 {
@@ -737,54 +839,11 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
         metrics.height_px = ConvertToLiveSize( p_filter, p_style );
         metrics.width_px = GetFontWidthForStyle( p_style, metrics.height_px );
 
-        FT_Face p_face = vlc_ftcache_LoadFaceByID( p_sys->ftcache, p_faceid, &metrics );
-        if(!p_face)
+        p_run->p_shaped = ShapeRunHarfBuzz( p_filter, p_paragraph, p_run, &metrics );
+        if( !p_run->p_shaped )
             goto error;
 
-        hb_font_t *p_hb_font = hb_ft_font_create( p_face, 0 );
-        if( !p_hb_font )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_ft_font_create() error" );
-            goto error;
-        }
-
-        p_run->p_buffer = hb_buffer_create();
-        if( !p_run->p_buffer )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz(): hb_buffer_create() error" );
-            hb_font_destroy( p_hb_font );
-            goto error;
-        }
-
-        hb_buffer_set_direction( p_run->p_buffer, p_run->direction );
-        hb_buffer_set_script( p_run->p_buffer, p_run->script );
-#ifdef __OS2__
-        hb_buffer_add_utf16( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
-#else
-        hb_buffer_add_utf32( p_run->p_buffer,
-                             p_paragraph->p_code_points + p_run->i_start_offset,
-                             p_run->i_end_offset - p_run->i_start_offset, 0,
-                             p_run->i_end_offset - p_run->i_start_offset );
-#endif
-        hb_shape( p_hb_font, p_run->p_buffer, 0, 0 );
-
-        hb_font_destroy( p_hb_font );
-        p_hb_font = 0;
-
-        const unsigned length = hb_buffer_get_length( p_run->p_buffer );
-        if( length == 0 )
-        {
-            msg_Err( p_filter,
-                     "ShapeParagraphHarfBuzz() invalid glyph count in shaped run" );
-            goto error;
-        }
-
-        i_total_glyphs += length;
+        i_total_glyphs += p_run->p_shaped->count;
     }
 
     p_new_paragraph = NewParagraph( p_filter, i_total_glyphs,
@@ -807,11 +866,8 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
     for( int i = 0; i < p_paragraph->i_runs_count; ++i )
     {
         run_desc_t *p_run = p_paragraph->p_runs + i;
-        unsigned int i_glyph_count;
-        const hb_glyph_info_t *p_infos =
-                hb_buffer_get_glyph_infos( p_run->p_buffer, &i_glyph_count );;
-        const hb_glyph_position_t *p_positions =
-                hb_buffer_get_glyph_positions( p_run->p_buffer, &i_glyph_count );
+        const unsigned int i_glyph_count = p_run->p_shaped->count;
+        const vlc_ftcache_shaped_glyph_t *p_glyphs = p_run->p_shaped->glyphs;
         for( unsigned int j = 0; j < i_glyph_count; ++j )
         {
             /*
@@ -824,11 +880,11 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
             int i_run_index = p_run->direction == HB_DIRECTION_LTR ?
                     j : i_glyph_count - 1 - j;
             int i_source_index =
-                    p_infos[ i_run_index ].cluster + p_run->i_start_offset;
+                    p_glyphs[ i_run_index ].cluster + p_run->i_start_offset;
 
             p_new_paragraph->p_code_points[ i_index ] = 0;
             p_new_paragraph->pi_glyph_indices[ i_index ] =
-                p_infos[ i_run_index ].codepoint;
+                p_glyphs[ i_run_index ].index;
             p_new_paragraph->p_scripts[ i_index ] =
                 p_paragraph->p_scripts[ i_source_index ];
             p_new_paragraph->p_types[ i_index ] =
@@ -841,13 +897,13 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
                 p_new_paragraph->pp_ruby[ i_index ] =
                     p_paragraph->pp_ruby[ i_source_index ];
             p_new_paragraph->p_glyph_bitmaps[ i_index ].i_x_offset =
-                p_positions[ i_run_index ].x_offset;
+                p_glyphs[ i_run_index ].x_offset;
             p_new_paragraph->p_glyph_bitmaps[ i_index ].i_y_offset =
-                p_positions[ i_run_index ].y_offset;
+                p_glyphs[ i_run_index ].y_offset;
             p_new_paragraph->p_glyph_bitmaps[ i_index ].i_x_advance =
-                p_positions[ i_run_index ].x_advance;
+                p_glyphs[ i_run_index ].x_advance;
             p_new_paragraph->p_glyph_bitmaps[ i_index ].i_y_advance =
-                p_positions[ i_run_index ].y_advance;
+                p_glyphs[ i_run_index ].y_advance;
 
             ++i_index;
         }
@@ -858,7 +914,7 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
 
     for( int i = 0; i < p_paragraph->i_runs_count; ++i )
     {
-        hb_buffer_destroy( p_paragraph->p_runs[ i ].p_buffer );
+        vlc_ftcache_ShapedRun_Release( p_paragraph->p_runs[ i ].p_shaped );
     }
     FreeParagraph( *p_old_paragraph );
     *p_old_paragraph = p_new_paragraph;
@@ -868,8 +924,9 @@ static int ShapeParagraphHarfBuzz( filter_t *p_filter,
 error:
     for( int i = 0; i < p_paragraph->i_runs_count; ++i )
     {
-        if( p_paragraph->p_runs[ i ].p_buffer )
-            hb_buffer_destroy( p_paragraph->p_runs[ i ].p_buffer );
+        if( p_paragraph->p_runs[ i ].p_shaped )
+            vlc_ftcache_ShapedRun_Release( p_paragraph->p_runs[ i ].p_shaped );
+        p_paragraph->p_runs[ i ].p_shaped = NULL;
     }
 
     if( p_new_paragraph )
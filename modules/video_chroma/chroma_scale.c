@@ -0,0 +1,469 @@
+/*****************************************************************************
+ * chroma_scale.c: YUV 4:2:0 conversion and scaling in a single pass
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*****************************************************************************
+ * Preamble
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <limits.h>
+#include <math.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_filter.h>
+#include <vlc_picture.h>
+#include <vlc_cpu.h>
+#include "copy.h"
+
+/* Bilinear scaling, the source lines are interpolated vertically into
+ * 8.8 fixed point line buffers, which are then interpolated horizontally
+ * and converted while writing the destination line. No intermediate
+ * picture is ever written.
+ *
+ * P010 samples, with their 10 bits in the most significant bits, are
+ * already 8.8 fixed point values. */
+
+typedef struct
+{
+    unsigned i0, i1; /* source samples */
+    unsigned f;      /* weight of i1, out of 256 */
+} tap_t;
+
+/* Last source lines used for a plane, a line is often used twice */
+struct row_cache
+{
+    unsigned y[2];
+    uint8_t *buf[2];
+};
+
+enum { ROWS_Y, ROWS_U, ROWS_V, ROWS_COUNT };
+
+typedef struct
+{
+    tap_t *htaps, *hctaps; /* per destination luma/chroma column */
+    tap_t *vtaps, *vctaps; /* per destination luma/chroma line */
+    uint16_t *lines[ROWS_COUNT];
+
+    copy_cache_t cache;
+    bool use_cache;
+    struct row_cache rows[ROWS_COUNT];
+
+    /* YUV to RGB, Q12 coefficients on 8.8 samples */
+    int y_offset;
+    int coef_y, coef_rv, coef_gu, coef_gv, coef_bu;
+    unsigned r, g, b, a; /* byte offsets */
+} filter_sys_t;
+
+static tap_t *NewTaps( unsigned dst, unsigned src )
+{
+    tap_t *taps = vlc_alloc( dst, sizeof (*taps) );
+    if( unlikely(taps == NULL) )
+        return NULL;
+
+    for( unsigned d = 0; d < dst; d++ )
+    {
+        /* Center of the destination sample, in 16.16 source coordinates */
+        int64_t pos = ((int64_t)(2 * d + 1) * src << 16) / (2 * dst)
+                    - (1 << 15);
+        if( pos < 0 )
+            pos = 0;
+
+        unsigned i0 = pos >> 16;
+        unsigned f = (pos >> 8) & 0xff;
+        if( i0 >= src - 1 )
+        {
+            i0 = src - 1;
+            f = 0;
+        }
+        taps[d].i0 = i0;
+        taps[d].i1 = __MIN(i0 + 1, src - 1);
+        taps[d].f = f;
+    }
+    return taps;
+}
+
+/* Returns source line y, without evicting line keep from the cache */
+static const uint8_t *GetRow( filter_sys_t *sys, unsigned id,
+                              const plane_t *plane, unsigned y, unsigned keep,
+                              size_t offset, size_t width )
+{
+    const uint8_t *src = &plane->p_pixels[y * plane->i_pitch + offset];
+#ifdef CAN_COMPILE_SSE2
+    if( sys->use_cache )
+    {
+        struct row_cache *rows = &sys->rows[id];
+
+        for( unsigned i = 0; i < 2; i++ )
+            if( rows->y[i] == y )
+                return rows->buf[i];
+
+        const unsigned slot = rows->y[0] == keep;
+        CopyLineFromUswc( rows->buf[slot], src, width );
+        rows->y[slot] = y;
+        return rows->buf[slot];
+    }
+#else
+    VLC_UNUSED(sys); VLC_UNUSED(id); VLC_UNUSED(keep); VLC_UNUSED(width);
+#endif
+    return src;
+}
+
+static void ResetRows( filter_sys_t *sys )
+{
+    for( unsigned i = 0; i < ROWS_COUNT; i++ )
+        sys->rows[i].y[0] = sys->rows[i].y[1] = UINT_MAX;
+}
+
+static void VLerp8( uint16_t *restrict dst, const uint8_t *a,
+                    const uint8_t *b, unsigned f, unsigned count )
+{
+    for( unsigned i = 0; i < count; i++ )
+        dst[i] = a[i] * (256 - f) + b[i] * f;
+}
+
+static void VLerp16( uint16_t *restrict dst, const uint16_t *a,
+                     const uint16_t *b, unsigned f, unsigned count )
+{
+    for( unsigned i = 0; i < count; i++ )
+        dst[i] = (a[i] * (256 - f) + b[i] * f) >> 8;
+}
+
+static inline unsigned HLerp( const uint16_t *line, const tap_t *t,
+                              unsigned step )
+{
+    return (line[t->i0 * step] * (256 - t->f)
+          + line[t->i1 * step] * t->f) >> 8;
+}
+
+/* Interpolates a source line, input visible area relative */
+static void LerpLine( filter_sys_t *sys, unsigned id, const plane_t *plane,
+                      const tap_t *t, size_t offset, unsigned count,
+                      unsigned pixel_size, unsigned y_offset )
+{
+    const size_t width = count * pixel_size;
+    const uint8_t *a = GetRow( sys, id, plane, y_offset + t->i0, UINT_MAX,
+                               offset, width );
+    const uint8_t *b = GetRow( sys, id, plane, y_offset + t->i1,
+                               y_offset + t->i0, offset, width );
+
+    if( pixel_size == 1 )
+        VLerp8( sys->lines[id], a, b, t->f, count );
+    else
+        VLerp16( sys->lines[id], (const uint16_t *)a,
+                 (const uint16_t *)b, t->f, count );
+}
+
+/*****************************************************************************
+ * NV12/P010 to 32-bit RGB
+ *****************************************************************************/
+static void SemiPlanarToRGB( filter_t *filter, picture_t *src,
+                             picture_t *dst )
+{
+    filter_sys_t *sys = filter->p_sys;
+    const video_format_t *fmt_in = &filter->fmt_in.video;
+    const video_format_t *fmt_out = &filter->fmt_out.video;
+    const unsigned pixel_size = src->p[0].i_pixel_pitch;
+    const unsigned sw = fmt_in->i_visible_width;
+    const unsigned scw = (sw + 1) / 2;
+    const unsigned dw = fmt_out->i_visible_width;
+    const unsigned dh = fmt_out->i_visible_height;
+
+    ResetRows( sys );
+    for( unsigned y = 0; y < dh; y++ )
+    {
+        LerpLine( sys, ROWS_Y, &src->p[0], &sys->vtaps[y],
+                  fmt_in->i_x_offset * pixel_size, sw, pixel_size,
+                  fmt_in->i_y_offset );
+        LerpLine( sys, ROWS_U, &src->p[1], &sys->vctaps[y],
+                  fmt_in->i_x_offset * pixel_size, 2 * scw, pixel_size,
+                  fmt_in->i_y_offset / 2 );
+
+        const uint16_t *ly = sys->lines[ROWS_Y];
+        const uint16_t *luv = sys->lines[ROWS_U];
+        uint8_t *out = &dst->p[0].p_pixels[(fmt_out->i_y_offset + y)
+                                           * dst->p[0].i_pitch
+                                           + fmt_out->i_x_offset * 4];
+
+        for( unsigned x = 0; x < dw; x++, out += 4 )
+        {
+            const tap_t *tc = &sys->hctaps[x];
+            const int l = ((int)HLerp( ly, &sys->htaps[x], 1 )
+                           - sys->y_offset) * sys->coef_y
+                        + (1 << 19);
+            const int u = (int)HLerp( luv, tc, 2 ) - 32768;
+            const int v = (int)HLerp( luv + 1, tc, 2 ) - 32768;
+
+            out[sys->r] = clip_uint8_vlc( (l + sys->coef_rv * v) >> 20 );
+            out[sys->g] = clip_uint8_vlc( (l - sys->coef_gu * u
+                                             - sys->coef_gv * v) >> 20 );
+            out[sys->b] = clip_uint8_vlc( (l + sys->coef_bu * u) >> 20 );
+            out[sys->a] = 0xff;
+        }
+    }
+}
+
+/*****************************************************************************
+ * I420/YV12 to NV12
+ *****************************************************************************/
+static void PlanarToSemiPlanar( filter_t *filter, picture_t *src,
+                                picture_t *dst )
+{
+    filter_sys_t *sys = filter->p_sys;
+    const video_format_t *fmt_in = &filter->fmt_in.video;
+    const video_format_t *fmt_out = &filter->fmt_out.video;
+    const unsigned sw = fmt_in->i_visible_width;
+    const unsigned scw = (sw + 1) / 2;
+    const unsigned dw = fmt_out->i_visible_width;
+    const unsigned dh = fmt_out->i_visible_height;
+    const unsigned dcw = (dw + 1) / 2;
+    const unsigned dch = (dh + 1) / 2;
+    const int u_plane = src->format.i_chroma == VLC_CODEC_YV12 ? V_PLANE
+                                                                : U_PLANE;
+    const int v_plane = u_plane == U_PLANE ? V_PLANE : U_PLANE;
+
+    ResetRows( sys );
+    for( unsigned y = 0; y < dh; y++ )
+    {
+        LerpLine( sys, ROWS_Y, &src->p[Y_PLANE], &sys->vtaps[y],
+                  fmt_in->i_x_offset, sw, 1, fmt_in->i_y_offset );
+
+        const uint16_t *ly = sys->lines[ROWS_Y];
+        uint8_t *out = &dst->p[0].p_pixels[(fmt_out->i_y_offset + y)
+                                           * dst->p[0].i_pitch
+                                           + fmt_out->i_x_offset];
+        for( unsigned x = 0; x < dw; x++ )
+            out[x] = (HLerp( ly, &sys->htaps[x], 1 ) + 128) >> 8;
+    }
+
+    for( unsigned y = 0; y < dch; y++ )
+    {
+        LerpLine( sys, ROWS_U, &src->p[u_plane], &sys->vctaps[y],
+                  fmt_in->i_x_offset / 2, scw, 1, fmt_in->i_y_offset / 2 );
+        LerpLine( sys, ROWS_V, &src->p[v_plane], &sys->vctaps[y],
+                  fmt_in->i_x_offset / 2, scw, 1, fmt_in->i_y_offset / 2 );
+
+        const uint16_t *lu = sys->lines[ROWS_U];
+        const uint16_t *lv = sys->lines[ROWS_V];
+        uint8_t *out = &dst->p[1].p_pixels[(fmt_out->i_y_offset / 2 + y)
+                                           * dst->p[1].i_pitch
+                                           + fmt_out->i_x_offset];
+        for( unsigned x = 0; x < dcw; x++ )
+        {
+            const tap_t *tc = &sys->hctaps[x];
+            out[2 * x]     = (HLerp( lu, tc, 1 ) + 128) >> 8;
+            out[2 * x + 1] = (HLerp( lv, tc, 1 ) + 128) >> 8;
+        }
+    }
+}
+
+static void Close( filter_t *filter )
+{
+    filter_sys_t *sys = filter->p_sys;
+
+    if( sys->use_cache )
+        CopyCleanCache( &sys->cache );
+    for( unsigned i = 0; i < ROWS_COUNT; i++ )
+        free( sys->lines[i] );
+    free( sys->htaps );
+    free( sys->hctaps );
+    free( sys->vtaps );
+    free( sys->vctaps );
+    free( sys );
+}
+
+VIDEO_FILTER_WRAPPER_CLOSE( SemiPlanarToRGB, Close )
+VIDEO_FILTER_WRAPPER_CLOSE( PlanarToSemiPlanar, Close )
+
+/*****************************************************************************
+ * Open
+ *****************************************************************************/
+static void SetupRGB( filter_sys_t *sys, const video_format_t *fmt )
+{
+    float kr, kb;
+    video_color_space_t space = fmt->space;
+
+    if( space == COLOR_SPACE_UNDEF )
+        space = fmt->i_visible_height > 576 ? COLOR_SPACE_BT709
+                                            : COLOR_SPACE_BT601;
+    switch( space )
+    {
+        case COLOR_SPACE_BT709:
+            kr = 0.2126f; kb = 0.0722f;
+            break;
+        case COLOR_SPACE_BT2020:
+            kr = 0.2627f; kb = 0.0593f;
+            break;
+        default:
+            kr = 0.299f; kb = 0.114f;
+            break;
+    }
+    const float kg = 1.f - kr - kb;
+
+    float scale_y = 1.f, scale_c = 1.f;
+    sys->y_offset = 0;
+    if( fmt->color_range != COLOR_RANGE_FULL )
+    {
+        scale_y = 255.f / 219.f;
+        scale_c = 255.f / 224.f;
+        sys->y_offset = 16 << 8;
+    }
+
+    sys->coef_y  = lroundf( scale_y * 4096.f );
+    sys->coef_rv = lroundf( 2.f * (1.f - kr) * scale_c * 4096.f );
+    sys->coef_gu = lroundf( 2.f * kb * (1.f - kb) / kg * scale_c * 4096.f );
+    sys->coef_gv = lroundf( 2.f * kr * (1.f - kr) / kg * scale_c * 4096.f );
+    sys->coef_bu = lroundf( 2.f * (1.f - kb) * scale_c * 4096.f );
+}
+
+static int Open( filter_t *filter )
+{
+    const video_format_t *fmt_in = &filter->fmt_in.video;
+    const video_format_t *fmt_out = &filter->fmt_out.video;
+    const struct vlc_filter_operations *ops;
+    unsigned pixel_size = 1;
+    unsigned r = 0, g = 0, b = 0, a = 0;
+
+    if( fmt_in->orientation != fmt_out->orientation )
+        return VLC_EGENERIC;
+
+    const bool resize = fmt_in->i_visible_width != fmt_out->i_visible_width
+                     || fmt_in->i_visible_height != fmt_out->i_visible_height;
+
+    switch( fmt_in->i_chroma )
+    {
+        case VLC_CODEC_P010:
+            pixel_size = 2;
+            /* fall through */
+        case VLC_CODEC_NV12:
+            switch( fmt_out->i_chroma )
+            {
+                case VLC_CODEC_RGBA:
+                    r = 0; g = 1; b = 2; a = 3;
+                    break;
+                case VLC_CODEC_BGRA:
+                    b = 0; g = 1; r = 2; a = 3;
+                    break;
+                case VLC_CODEC_ARGB:
+                    a = 0; r = 1; g = 2; b = 3;
+                    break;
+                default:
+                    return VLC_EGENERIC;
+            }
+            ops = &SemiPlanarToRGB_ops;
+            break;
+
+        case VLC_CODEC_I420:
+        case VLC_CODEC_J420:
+        case VLC_CODEC_YV12:
+            /* Without resizing, i420_nv12 does a plain copy */
+            if( fmt_out->i_chroma != VLC_CODEC_NV12 || !resize )
+                return VLC_EGENERIC;
+            ops = &PlanarToSemiPlanar_ops;
+            break;
+
+        default:
+            return VLC_EGENERIC;
+    }
+
+    if( fmt_in->i_visible_width == 0 || fmt_in->i_visible_height == 0
+     || fmt_out->i_visible_width == 0 || fmt_out->i_visible_height == 0
+     || ((fmt_in->i_x_offset | fmt_in->i_y_offset) & 1)
+     || ((fmt_out->i_x_offset | fmt_out->i_y_offset) & 1) )
+        return VLC_EGENERIC;
+
+    filter_sys_t *sys = calloc( 1, sizeof (*sys) );
+    if( unlikely(sys == NULL) )
+        return VLC_ENOMEM;
+    filter->p_sys = sys;
+
+    const unsigned sw = fmt_in->i_visible_width;
+    const unsigned sh = fmt_in->i_visible_height;
+    const unsigned dw = fmt_out->i_visible_width;
+    const unsigned dh = fmt_out->i_visible_height;
+
+    sys->htaps = NewTaps( dw, sw );
+    sys->vtaps = NewTaps( dh, sh );
+    sys->hctaps = NewTaps( (dw + 1) / 2, (sw + 1) / 2 );
+    /* Chroma lines are needed for each luma line when converting to RGB */
+    if( ops == &SemiPlanarToRGB_ops )
+    {
+        /* Luma columns map to chroma columns at half the resolution */
+        free( sys->hctaps );
+        sys->hctaps = NewTaps( dw, (sw + 1) / 2 );
+        sys->vctaps = NewTaps( dh, (sh + 1) / 2 );
+    }
+    else
+        sys->vctaps = NewTaps( (dh + 1) / 2, (sh + 1) / 2 );
+
+    /* Interleaved chroma needs twice the chroma width */
+    const size_t line = ((sw + 1) & ~1) * sizeof (uint16_t);
+    for( unsigned i = 0; i < ROWS_COUNT; i++ )
+        sys->lines[i] = malloc( line );
+
+    if( sys->htaps == NULL || sys->vtaps == NULL || sys->hctaps == NULL
+     || sys->vctaps == NULL || sys->lines[ROWS_Y] == NULL
+     || sys->lines[ROWS_U] == NULL || sys->lines[ROWS_V] == NULL )
+        goto error;
+
+#ifdef CAN_COMPILE_SSE2
+    /* Source lines are fetched with streaming loads, into two slots per
+     * plane of the copy cache */
+    if( vlc_CPU_SSE4_1() )
+    {
+        const size_t slot = (((sw + 1) & ~1) * pixel_size + 0x3f) & ~0x3f;
+
+        if( CopyInitCache( &sys->cache, 2 * ROWS_COUNT * slot ) == VLC_SUCCESS )
+        {
+            sys->use_cache = true;
+            for( unsigned i = 0; i < ROWS_COUNT; i++ )
+                for( unsigned j = 0; j < 2; j++ )
+                    sys->rows[i].buf[j] = &sys->cache.buffer[(2 * i + j) * slot];
+        }
+    }
+#endif
+
+    SetupRGB( sys, fmt_in );
+    sys->r = r;
+    sys->g = g;
+    sys->b = b;
+    sys->a = a;
+
+    filter->ops = ops;
+    msg_Dbg( filter, "%4.4s %ux%u to %4.4s %ux%u in a single pass",
+             (const char *)&fmt_in->i_chroma, sw, sh,
+             (const char *)&fmt_out->i_chroma, dw, dh );
+    return VLC_SUCCESS;
+
+error:
+    Close( filter );
+    return VLC_ENOMEM;
+}
+
+/*****************************************************************************
+ * Module descriptor
+ *****************************************************************************/
+vlc_module_begin ()
+    set_description( N_("YUV conversion and scaling in a single pass") )
+    set_callback_video_converter( Open, 140 )
+vlc_module_end ()
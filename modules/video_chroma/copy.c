@@ -35,6 +35,10 @@
 #include <assert.h>
 
 #include "copy.h"
+
+#ifdef CAN_COMPILE_AVX2
+# include <immintrin.h>
+#endif
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
                       const uint8_t *src, size_t src_pitch,
                       unsigned height, int bitshift);
@@ -130,6 +134,54 @@ void CopyCleanCache(copy_cache_t *cache)
 # define vlc_CPU_SSSE3() (0)
 # undef vlc_CPU_SSE2
 # define vlc_CPU_SSE2() (0)
+# undef vlc_CPU_AVX2
+# define vlc_CPU_AVX2() (0)
+#endif
+
+#ifdef CAN_COMPILE_AVX2
+#define AVX2_SHIFT(v, bitshift, shift) \
+    ((bitshift) > 0 ? _mm256_srl_epi16(v, shift) : _mm256_sll_epi16(v, shift))
+
+/* 32-byte streaming loads: half as many loads to drain the USWC memory, for
+ * sources aligned on 32 bytes as the hardware surfaces usually are.
+ */
+__attribute__ ((__target__ ("avx2")))
+static void AVX2_CopyFromUswc(uint8_t *dst, size_t dst_pitch,
+                              const uint8_t *src, size_t src_pitch,
+                              unsigned width, unsigned height, int bitshift)
+{
+    const __m128i shift = _mm_cvtsi32_si128(abs(bitshift));
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        unsigned x = 0;
+
+        for (; x + 127 < width; x += 128)
+        {
+            __m256i a = _mm256_stream_load_si256((__m256i *) &src[x]);
+            __m256i b = _mm256_stream_load_si256((__m256i *) &src[x + 32]);
+            __m256i c = _mm256_stream_load_si256((__m256i *) &src[x + 64]);
+            __m256i d = _mm256_stream_load_si256((__m256i *) &src[x + 96]);
+
+            if (bitshift != 0)
+            {
+                a = AVX2_SHIFT(a, bitshift, shift);
+                b = AVX2_SHIFT(b, bitshift, shift);
+                c = AVX2_SHIFT(c, bitshift, shift);
+                d = AVX2_SHIFT(d, bitshift, shift);
+            }
+            _mm256_store_si256((__m256i *) &dst[x], a);
+            _mm256_store_si256((__m256i *) &dst[x + 32], b);
+            _mm256_store_si256((__m256i *) &dst[x + 64], c);
+            _mm256_store_si256((__m256i *) &dst[x + 96], d);
+        }
+        if (x < width)
+            CopyPlane(&dst[x], dst_pitch - x, &src[x], src_pitch - x, 1, bitshift);
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+#undef AVX2_SHIFT
 #endif
 
 /* Optimized copy from "Uncacheable Speculative Write Combining" memory
@@ -145,6 +197,17 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
 
     asm volatile ("mfence");
 
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2()
+     && (((uintptr_t)src | src_pitch | (uintptr_t)dst | dst_pitch) & 0x1f) == 0)
+    {
+        AVX2_CopyFromUswc(dst, dst_pitch, src, src_pitch, width, height,
+                          bitshift);
+        asm volatile ("mfence");
+        return;
+    }
+#endif
+
 #define SSE_USWC_COPY(shiftstr16, shiftstr64) \
     for (unsigned y = 0; y < height; y++) { \
         const unsigned unaligned = (-(uintptr_t)src) & 0x0f; \
@@ -196,7 +259,7 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
             SSE_USWC_COPY(COPY16_SHIFTR("$4"), COPY64_SHIFTR("$4"))
             break;
         case -4:
-            SSE_USWC_COPY(COPY16_SHIFTL("$2"), COPY64_SHIFTL("$2"))
+            SSE_USWC_COPY(COPY16_SHIFTL("$4"), COPY64_SHIFTL("$4"))
             break;
         default:
             vlc_assert_unreachable();
@@ -206,6 +269,17 @@ static void CopyFromUswc(uint8_t *dst, size_t dst_pitch,
     asm volatile ("mfence");
 }
 
+void CopyLineFromUswc(uint8_t *dst, const uint8_t *src, size_t width)
+{
+    assert(((intptr_t)dst & 0x0f) == 0);
+
+    if (width < 16) {
+        memcpy(dst, src, width);
+        return;
+    }
+    CopyFromUswc(dst, (width + 15) & ~15, src, width, width, 1, 0);
+}
+
 VLC_SSE
 static void Copy2d(uint8_t *dst, size_t dst_pitch,
                    const uint8_t *src, size_t src_pitch,
@@ -613,6 +687,123 @@ static void SSE_Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
 #undef COPY64
 #endif /* CAN_COMPILE_SSE2 */
 
+#ifdef CAN_COMPILE_AVX2
+/* Planar sources only come from software decoders, or are uploaded to
+ * hardware surfaces, so they are in system memory: plain loads are fine and
+ * avoid the cache bounce of the USWC copies. */
+__attribute__ ((__target__ ("avx2")))
+static void AVX2_CopyPlane16(uint8_t *dst, size_t dst_pitch,
+                             const uint8_t *src, size_t src_pitch,
+                             unsigned width, unsigned height, int bitshift)
+{
+    const __m128i shift = _mm_cvtsi32_si128(abs(bitshift));
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        uint16_t *dst16 = (uint16_t *) dst;
+        const uint16_t *src16 = (const uint16_t *) src;
+        unsigned x = 0;
+
+        for (; x + 16 <= width; x += 16)
+        {
+            __m256i v = _mm256_loadu_si256((const __m256i *) &src16[x]);
+            v = bitshift > 0 ? _mm256_srl_epi16(v, shift)
+                             : _mm256_sll_epi16(v, shift);
+            _mm256_storeu_si256((__m256i *) &dst16[x], v);
+        }
+        for (; x < width; x++)
+            dst16[x] = bitshift > 0 ? src16[x] >> bitshift
+                                    : src16[x] << -bitshift;
+        src += src_pitch;
+        dst += dst_pitch;
+    }
+}
+
+/* unpacklo/hi work within the 128-bit lanes, the lanes are put back in
+ * order before storing */
+#define AVX2_INTERLEAVE(unpack, u, v, dst) do { \
+    const __m256i lo = _mm256_unpacklo_##unpack(u, v); \
+    const __m256i hi = _mm256_unpackhi_##unpack(u, v); \
+    _mm256_storeu_si256((__m256i *) (dst), \
+                        _mm256_permute2x128_si256(lo, hi, 0x20)); \
+    _mm256_storeu_si256((__m256i *) (dst) + 1, \
+                        _mm256_permute2x128_si256(lo, hi, 0x31)); \
+} while(0)
+
+__attribute__ ((__target__ ("avx2")))
+static void AVX2_InterleavePlanes(uint8_t *dst, size_t dst_pitch,
+                                  const uint8_t *srcu, size_t srcu_pitch,
+                                  const uint8_t *srcv, size_t srcv_pitch,
+                                  unsigned width, unsigned height)
+{
+    for (unsigned y = 0; y < height; y++)
+    {
+        unsigned x = 0;
+
+        for (; x + 32 <= width; x += 32)
+        {
+            const __m256i u = _mm256_loadu_si256((const __m256i *) &srcu[x]);
+            const __m256i v = _mm256_loadu_si256((const __m256i *) &srcv[x]);
+            AVX2_INTERLEAVE(epi8, u, v, &dst[2 * x]);
+        }
+        for (; x < width; x++)
+        {
+            dst[2 * x]     = srcu[x];
+            dst[2 * x + 1] = srcv[x];
+        }
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst  += dst_pitch;
+    }
+}
+
+__attribute__ ((__target__ ("avx2")))
+static void AVX2_InterleavePlanes16(uint8_t *dst, size_t dst_pitch,
+                                    const uint8_t *srcu, size_t srcu_pitch,
+                                    const uint8_t *srcv, size_t srcv_pitch,
+                                    unsigned width, unsigned height,
+                                    int bitshift)
+{
+    const __m128i shift = _mm_cvtsi32_si128(abs(bitshift));
+
+    for (unsigned y = 0; y < height; y++)
+    {
+        uint16_t *dst16 = (uint16_t *) dst;
+        const uint16_t *srcu16 = (const uint16_t *) srcu;
+        const uint16_t *srcv16 = (const uint16_t *) srcv;
+        unsigned x = 0;
+
+        for (; x + 16 <= width; x += 16)
+        {
+            __m256i u = _mm256_loadu_si256((const __m256i *) &srcu16[x]);
+            __m256i v = _mm256_loadu_si256((const __m256i *) &srcv16[x]);
+            if (bitshift > 0)
+            {
+                u = _mm256_srl_epi16(u, shift);
+                v = _mm256_srl_epi16(v, shift);
+            }
+            else
+            {
+                u = _mm256_sll_epi16(u, shift);
+                v = _mm256_sll_epi16(v, shift);
+            }
+            AVX2_INTERLEAVE(epi16, u, v, &dst16[2 * x]);
+        }
+        for (; x < width; x++)
+        {
+            dst16[2 * x]     = bitshift > 0 ? srcu16[x] >> bitshift
+                                            : srcu16[x] << -bitshift;
+            dst16[2 * x + 1] = bitshift > 0 ? srcv16[x] >> bitshift
+                                            : srcv16[x] << -bitshift;
+        }
+        srcu += srcu_pitch;
+        srcv += srcv_pitch;
+        dst  += dst_pitch;
+    }
+}
+#undef AVX2_INTERLEAVE
+#endif /* CAN_COMPILE_AVX2 */
+
 static void CopyPlane(uint8_t *dst, size_t dst_pitch,
                       const uint8_t *src, size_t src_pitch,
                       unsigned height, int bitshift)
@@ -821,6 +1012,23 @@ void Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
                      const copy_cache_t *cache)
 {
     ASSERT_3PLANES;
+    const unsigned copy_lines = (height+1) / 2;
+    unsigned copy_pitch = src_pitch[1];
+    if (copy_pitch > (size_t)dst->p[1].i_pitch / 2)
+        copy_pitch = dst->p[1].i_pitch / 2;
+
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+    {
+        CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                  src[0], src_pitch[0], height, 0);
+        AVX2_InterleavePlanes(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                              src[U_PLANE], src_pitch[U_PLANE],
+                              src[V_PLANE], src_pitch[V_PLANE],
+                              copy_pitch, copy_lines);
+        return;
+    }
+#endif
 #ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE2())
         return SSE_Copy420_P_to_SP(dst, src, src_pitch, height, 1, 0, cache);
@@ -831,11 +1039,6 @@ void Copy420_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
     CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
               src[0], src_pitch[0], height, 0);
 
-    const unsigned copy_lines = (height+1) / 2;
-    unsigned copy_pitch = src_pitch[1];
-    if (copy_pitch > (size_t)dst->p[1].i_pitch / 2)
-        copy_pitch = dst->p[1].i_pitch / 2;
-
     const int i_extra_pitch_uv = dst->p[1].i_pitch - 2 * copy_pitch;
     const int i_extra_pitch_u  = src_pitch[U_PLANE] - copy_pitch;
     const int i_extra_pitch_v  = src_pitch[V_PLANE] - copy_pitch;
@@ -852,6 +1055,26 @@ void Copy420_16_P_to_SP(picture_t *dst, const uint8_t *src[static 3],
 {
     ASSERT_3PLANES;
     assert(bitshift >= -6 && bitshift <= 6 && (bitshift % 2 == 0));
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+    {
+        const size_t luma_pitch = __MIN(src_pitch[0], (size_t)dst->p[0].i_pitch);
+        const size_t chroma_pitch = __MIN(src_pitch[1], (size_t)dst->p[1].i_pitch / 2);
+
+        if (bitshift == 0)
+            CopyPlane(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                      src[0], src_pitch[0], height, 0);
+        else
+            AVX2_CopyPlane16(dst->p[0].p_pixels, dst->p[0].i_pitch,
+                             src[0], src_pitch[0], luma_pitch / 2, height,
+                             bitshift);
+        AVX2_InterleavePlanes16(dst->p[1].p_pixels, dst->p[1].i_pitch,
+                                src[U_PLANE], src_pitch[U_PLANE],
+                                src[V_PLANE], src_pitch[V_PLANE],
+                                chroma_pitch / 2, (height+1) / 2, bitshift);
+        return;
+    }
+#endif
 #ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSSE3())
         return SSE_Copy420_P_to_SP(dst, src, src_pitch, height, 2, bitshift, cache);
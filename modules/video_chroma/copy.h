@@ -74,6 +74,13 @@ void Copy420_16_SP_to_P(picture_t *dst, const uint8_t *src[static 2],
                         const size_t src_pitch[static 2], unsigned height,
                         int bitshift, const copy_cache_t *cache);
 
+#ifdef CAN_COMPILE_SSE2
+/* Copy a line of pixels to a 16 bytes aligned buffer, with the streaming
+ * loads of SSE4.1, for lines read several times from "Uncacheable
+ * Speculative Write Combining" memory. Only use if vlc_CPU_SSE4_1(). */
+void CopyLineFromUswc(uint8_t *dst, const uint8_t *src, size_t width);
+#endif
+
 /**
  * This functions sets the internal plane pointers/dimensions for the given
  * buffer.
@@ -46,6 +46,26 @@
  * Internal functions
  *****************************************************************************/
 
+/**
+ * Internal helper function: gets the lines of the given field in the
+ * given band of a plane, as a [start, end) range of pointers.
+ *
+ * Bands are aligned on pairs of lines, so that each line of the field
+ * belongs to exactly one band.
+ */
+static void GetFieldBand( plane_t *p_plane, int i_field,
+                          unsigned i_band, unsigned i_bands,
+                          uint8_t **pp_out, uint8_t **pp_out_end )
+{
+    int i_start, i_end;
+    GetBandLines( p_plane->i_visible_lines, i_band, i_bands, 2,
+                  &i_start, &i_end );
+
+    /* skip first line for bottom field */
+    *pp_out = p_plane->p_pixels + ( i_start + i_field ) * p_plane->i_pitch;
+    *pp_out_end = p_plane->p_pixels + i_end * p_plane->i_pitch;
+}
+
 /**
  * Internal helper function: dims (darkens) the given field
  * of the given picture.
@@ -65,12 +85,16 @@
  * @param p_dst Input/output picture. Will be modified in-place.
  * @param i_field Darken which field? 0 = top, 1 = bottom.
  * @param i_strength Strength of effect: 1, 2 or 3 (division by 2, 4 or 8).
+ * @param process_chroma Whether the chroma planes are darkened too.
+ * @param i_band Band to process, see RenderBands().
+ * @param i_bands Number of bands.
  * @see RenderPhosphor()
  * @see ComposeFrame()
  */
 static void DarkenField( picture_t *p_dst,
                          const int i_field, const int i_strength,
-                         bool process_chroma )
+                         bool process_chroma,
+                         unsigned i_band, unsigned i_bands )
 {
     assert( p_dst != NULL );
     assert( i_field == 0 || i_field == 1 );
@@ -92,13 +116,8 @@ static void DarkenField( picture_t *p_dst,
     int i_plane = Y_PLANE;
     uint8_t *p_out, *p_out_end;
     int w = p_dst->p[i_plane].i_visible_pitch;
-    p_out = p_dst->p[i_plane].p_pixels;
-    p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                      * p_dst->p[i_plane].i_visible_lines;
-
-    /* skip first line for bottom field */
-    if( i_field == 1 )
-        p_out += p_dst->p[i_plane].i_pitch;
+    GetFieldBand( &p_dst->p[i_plane], i_field, i_band, i_bands,
+                  &p_out, &p_out_end );
 
     int wm8 = w % 8;   /* remainder */
     int w8  = w - wm8; /* part of width that is divisible by 8 */
@@ -129,13 +148,8 @@ static void DarkenField( picture_t *p_dst,
              i_plane++ )
         {
             w = p_dst->p[i_plane].i_visible_pitch;
-            p_out = p_dst->p[i_plane].p_pixels;
-            p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                              * p_dst->p[i_plane].i_visible_lines;
-
-            /* skip first line for bottom field */
-            if( i_field == 1 )
-                p_out += p_dst->p[i_plane].i_pitch;
+            GetFieldBand( &p_dst->p[i_plane], i_field, i_band, i_bands,
+                          &p_out, &p_out_end );
 
             for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
             {
@@ -152,7 +166,8 @@ static void DarkenField( picture_t *p_dst,
 VLC_MMX
 static void DarkenFieldMMX( picture_t *p_dst,
                             const int i_field, const int i_strength,
-                            bool process_chroma )
+                            bool process_chroma,
+                            unsigned i_band, unsigned i_bands )
 {
     assert( p_dst != NULL );
     assert( i_field == 0 || i_field == 1 );
@@ -166,13 +181,8 @@ static void DarkenFieldMMX( picture_t *p_dst,
     int i_plane = Y_PLANE;
     uint8_t *p_out, *p_out_end;
     int w = p_dst->p[i_plane].i_visible_pitch;
-    p_out = p_dst->p[i_plane].p_pixels;
-    p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                      * p_dst->p[i_plane].i_visible_lines;
-
-    /* skip first line for bottom field */
-    if( i_field == 1 )
-        p_out += p_dst->p[i_plane].i_pitch;
+    GetFieldBand( &p_dst->p[i_plane], i_field, i_band, i_bands,
+                  &p_out, &p_out_end );
 
     int wm8 = w % 8;   /* remainder */
     int w8  = w - wm8; /* part of width that is divisible by 8 */
@@ -215,13 +225,8 @@ static void DarkenFieldMMX( picture_t *p_dst,
             wm8 = w % 8;   /* remainder */
             w8  = w - wm8; /* part of width that is divisible by 8 */
 
-            p_out = p_dst->p[i_plane].p_pixels;
-            p_out_end = p_out + p_dst->p[i_plane].i_pitch
-                              * p_dst->p[i_plane].i_visible_lines;
-
-            /* skip first line for bottom field */
-            if( i_field == 1 )
-                p_out += p_dst->p[i_plane].i_pitch;
+            GetFieldBand( &p_dst->p[i_plane], i_field, i_band, i_bands,
+                          &p_out, &p_out_end );
 
             for( ; p_out < p_out_end ; p_out += 2*p_dst->p[i_plane].i_pitch )
             {
@@ -260,7 +265,7 @@ static void DarkenFieldMMX( picture_t *p_dst,
                 }
 
                 /* C version - handle the width remainder */
-                uint8_t *po = p_out;
+                uint8_t *po = p_out + x;
                 for( ; x < w; ++x, ++po )
                     (*po) = 128 + ( ((*po) - 128) / (1 << i_strength) );
             } /* for p_out... */
@@ -271,6 +276,28 @@ static void DarkenFieldMMX( picture_t *p_dst,
 }
 #endif
 
+struct darken_bands
+{
+    picture_t *p_dst;
+    int i_field;
+    int i_strength;
+    bool process_chroma;
+};
+
+static void DarkenFieldBand( void *opaque, unsigned i_band, unsigned i_bands )
+{
+    const struct darken_bands *p_bands = opaque;
+
+#ifdef CAN_COMPILE_MMXEXT
+    if( vlc_CPU_MMXEXT() )
+        DarkenFieldMMX( p_bands->p_dst, p_bands->i_field, p_bands->i_strength,
+                        p_bands->process_chroma, i_band, i_bands );
+    else
+#endif
+        DarkenField( p_bands->p_dst, p_bands->i_field, p_bands->i_strength,
+                     p_bands->process_chroma, i_band, i_bands );
+}
+
 /*****************************************************************************
  * Public functions
  *****************************************************************************/
@@ -357,16 +384,15 @@ int RenderPhosphor( filter_t *p_filter,
     */
     if( p_sys->phosphor.i_dimmer_strength > 0 )
     {
-#ifdef CAN_COMPILE_MMXEXT
-        if( vlc_CPU_MMXEXT() )
-            DarkenFieldMMX( p_dst, !i_field, p_sys->phosphor.i_dimmer_strength,
-                p_sys->chroma->p[1].h.num == p_sys->chroma->p[1].h.den &&
-                p_sys->chroma->p[2].h.num == p_sys->chroma->p[2].h.den );
-        else
-#endif
-            DarkenField( p_dst, !i_field, p_sys->phosphor.i_dimmer_strength,
+        struct darken_bands bands = {
+            .p_dst = p_dst,
+            .i_field = !i_field,
+            .i_strength = p_sys->phosphor.i_dimmer_strength,
+            .process_chroma =
                 p_sys->chroma->p[1].h.num == p_sys->chroma->p[1].h.den &&
-                p_sys->chroma->p[2].h.num == p_sys->chroma->p[2].h.den );
+                p_sys->chroma->p[2].h.num == p_sys->chroma->p[2].h.den,
+        };
+        RenderBands( p_filter, DarkenFieldBand, &bands );
     }
     return VLC_SUCCESS;
 }
@@ -35,6 +35,7 @@
 #include <vlc_picture.h>
 
 #include "deinterlace.h" /* filter_sys_t */
+#include "helpers.h"     /* RenderBands() */
 
 #include "algo_x.h"
 
@@ -511,9 +512,17 @@ static inline void XDeintBand8x8MMXEXT( uint8_t *dst, int i_dst,
  * Public functions
  *****************************************************************************/
 
-int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+struct x_bands
+{
+    picture_t *p_outpic;
+    const picture_t *p_pic;
+};
+
+static void RenderXBand( void *opaque, unsigned i_band, unsigned i_bands )
 {
-    VLC_UNUSED(p_filter);
+    const struct x_bands *p_bands = opaque;
+    picture_t *p_outpic = p_bands->p_outpic;
+    const picture_t *p_pic = p_bands->p_pic;
     int i_plane;
 #if defined (CAN_COMPILE_MMXEXT)
     const bool mmxext = vlc_CPU_MMXEXT();
@@ -531,9 +540,14 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
         const int i_dst = p_outpic->p[i_plane].i_pitch;
         const int i_src = p_pic->p[i_plane].i_pitch;
 
+        /* Bands are made of whole rows of 8x8 blocks, the last one
+           includes the last line */
+        int y_start, y_end;
+        GetBandLines( i_mby + 1, i_band, i_bands, 1, &y_start, &y_end );
+
         int y, x;
 
-        for( y = 0; y < i_mby; y++ )
+        for( y = y_start; y < y_end && y < i_mby; y++ )
         {
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
             uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
@@ -547,7 +561,7 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
         }
 
         /* Last line (C only)*/
-        if( i_mody )
+        if( i_mody && y == i_mby && y < y_end )
         {
             uint8_t *dst = &p_outpic->p[i_plane].p_pixels[8*y*i_dst];
             uint8_t *src = &p_pic->p[i_plane].p_pixels[8*y*i_src];
@@ -569,5 +583,12 @@ int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
     if( mmxext )
         emms();
 #endif
+}
+
+int RenderX( filter_t *p_filter, picture_t *p_outpic, picture_t *p_pic )
+{
+    struct x_bands bands = { .p_outpic = p_outpic, .p_pic = p_pic };
+
+    RenderBands( p_filter, RenderXBand, &bands );
     return VLC_SUCCESS;
 }
@@ -34,6 +34,7 @@
 #include <vlc_filter.h>
 
 #include "deinterlace.h" /* filter_sys_t  */
+#include "helpers.h"     /* RenderBands() */
 #include "common.h"      /* FFMIN3 et al. */
 
 #include "algo_yadif.h"
@@ -46,6 +47,238 @@
    Necessary preprocessor macros are defined in common.h. */
 #include "yadif.h"
 
+typedef void (*yadif_filter_t)( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                                uint8_t *next, int w, int prefs, int mrefs,
+                                int parity, int mode );
+
+#if defined(CAN_COMPILE_AVX2)
+# include <immintrin.h>
+
+/* AVX2 versions of the FILTER macro of yadif.h: each lane computes exactly
+   the same thing as the C code for one pixel, the widths that are not
+   multiple of the vector size are finished by the C code. */
+
+/* Common part, on 16 pixels stored as 16-bit lanes (8-bit input) or
+   8 pixels stored as 32-bit lanes (16-bit input). */
+#define YADIF_AVX2_PIXELS( LOAD, ABS, ADD, SUB, SRA, CMPGT, MIN, MAX, \
+                           DEC ) \
+    const __m256i c = LOAD( cur + mrefs ); \
+    const __m256i e = LOAD( cur + prefs ); \
+    const __m256i p2 = LOAD( prev2 ), n2 = LOAD( next2 ); \
+    const __m256i d = SRA( ADD( p2, n2 ), 1 ); \
+    const __m256i temporal_diff0 = ABS( SUB( p2, n2 ) ); \
+    const __m256i temporal_diff1 = SRA( ADD( ABS( SUB( LOAD( prev + mrefs ), c ) ), \
+                                             ABS( SUB( LOAD( prev + prefs ), e ) ) ), 1 ); \
+    const __m256i temporal_diff2 = SRA( ADD( ABS( SUB( LOAD( next + mrefs ), c ) ), \
+                                             ABS( SUB( LOAD( next + prefs ), e ) ) ), 1 ); \
+    __m256i diff = MAX( MAX( SRA( temporal_diff0, 1 ), temporal_diff1 ), \
+                        temporal_diff2 ); \
+    __m256i spatial_pred = SRA( ADD( c, e ), 1 ); \
+    __m256i spatial_score = DEC( ADD( ADD( \
+            ABS( SUB( LOAD( cur + mrefs - 1 ), LOAD( cur + prefs - 1 ) ) ), \
+            ABS( SUB( c, e ) ) ), \
+            ABS( SUB( LOAD( cur + mrefs + 1 ), LOAD( cur + prefs + 1 ) ) ) ) ); \
+    __m256i improved = _mm256_setzero_si256(); \
+    for( int j = -1; j >= -2; j-- ) \
+    { \
+        const __m256i score = ADD( ADD( \
+            ABS( SUB( LOAD( cur + mrefs - 1 + j ), LOAD( cur + prefs - 1 - j ) ) ), \
+            ABS( SUB( LOAD( cur + mrefs     + j ), LOAD( cur + prefs     - j ) ) ) ), \
+            ABS( SUB( LOAD( cur + mrefs + 1 + j ), LOAD( cur + prefs + 1 - j ) ) ) ); \
+        __m256i better = CMPGT( spatial_score, score ); \
+        /* CHECK(-2) only applies where CHECK(-1) succeeded */ \
+        if( j == -2 ) \
+            better = _mm256_and_si256( better, improved ); \
+        improved = better; \
+        spatial_score = _mm256_blendv_epi8( spatial_score, score, better ); \
+        spatial_pred = _mm256_blendv_epi8( spatial_pred, \
+            SRA( ADD( LOAD( cur + mrefs + j ), LOAD( cur + prefs - j ) ), 1 ), \
+            better ); \
+    } \
+    for( int j = 1; j <= 2; j++ ) \
+    { \
+        const __m256i score = ADD( ADD( \
+            ABS( SUB( LOAD( cur + mrefs - 1 + j ), LOAD( cur + prefs - 1 - j ) ) ), \
+            ABS( SUB( LOAD( cur + mrefs     + j ), LOAD( cur + prefs     - j ) ) ) ), \
+            ABS( SUB( LOAD( cur + mrefs + 1 + j ), LOAD( cur + prefs + 1 - j ) ) ) ); \
+        __m256i better = CMPGT( spatial_score, score ); \
+        if( j == 2 ) \
+            better = _mm256_and_si256( better, improved ); \
+        improved = better; \
+        spatial_score = _mm256_blendv_epi8( spatial_score, score, better ); \
+        spatial_pred = _mm256_blendv_epi8( spatial_pred, \
+            SRA( ADD( LOAD( cur + mrefs + j ), LOAD( cur + prefs - j ) ), 1 ), \
+            better ); \
+    } \
+    if( mode < 2 ) \
+    { \
+        const __m256i b = SRA( ADD( LOAD( prev2 + 2*mrefs ), \
+                                    LOAD( next2 + 2*mrefs ) ), 1 ); \
+        const __m256i f = SRA( ADD( LOAD( prev2 + 2*prefs ), \
+                                    LOAD( next2 + 2*prefs ) ), 1 ); \
+        const __m256i de = SUB( d, e ), dc = SUB( d, c ); \
+        const __m256i max = MAX( MAX( de, dc ), MIN( SUB( b, c ), SUB( f, e ) ) ); \
+        const __m256i min = MIN( MIN( de, dc ), MAX( SUB( b, c ), SUB( f, e ) ) ); \
+        diff = MAX( MAX( diff, min ), SUB( _mm256_setzero_si256(), max ) ); \
+    } \
+    /* diff >= 0, so the two tests of the C code amount to a clamp */ \
+    spatial_pred = MAX( MIN( spatial_pred, ADD( d, diff ) ), SUB( d, diff ) );
+
+#define LOAD8( p ) \
+    _mm256_cvtepu8_epi16( _mm_loadu_si128( (const __m128i *)(p) ) )
+#define DEC16( v ) _mm256_sub_epi16( v, _mm256_set1_epi16( 1 ) )
+
+__attribute__ ((__target__ ("avx2")))
+static void yadif_filter_line_avx2( uint8_t *dst, uint8_t *prev, uint8_t *cur,
+                                    uint8_t *next, int w, int prefs, int mrefs,
+                                    int parity, int mode )
+{
+    uint8_t *prev2 = parity ? prev : cur ;
+    uint8_t *next2 = parity ? cur  : next;
+    int x = 0;
+
+    for( ; x + 16 <= w; x += 16 )
+    {
+        YADIF_AVX2_PIXELS( LOAD8, _mm256_abs_epi16,
+                           _mm256_add_epi16, _mm256_sub_epi16,
+                           _mm256_srai_epi16, _mm256_cmpgt_epi16,
+                           _mm256_min_epi16, _mm256_max_epi16, DEC16 )
+
+        _mm_storeu_si128( (__m128i *)dst,
+                          _mm_packus_epi16( _mm256_castsi256_si128( spatial_pred ),
+                                            _mm256_extracti128_si256( spatial_pred, 1 ) ) );
+        dst += 16;
+        prev += 16;
+        cur += 16;
+        next += 16;
+        prev2 += 16;
+        next2 += 16;
+    }
+
+    if( x < w )
+        yadif_filter_line_c( dst, prev, cur, next, w - x, prefs, mrefs,
+                             parity, mode );
+}
+
+#define LOAD16( p ) \
+    _mm256_cvtepu16_epi32( _mm_loadu_si128( (const __m128i *)(p) ) )
+#define DEC32( v ) _mm256_sub_epi32( v, _mm256_set1_epi32( 1 ) )
+
+__attribute__ ((__target__ ("avx2")))
+static void yadif_filter_line_avx2_16bit( uint8_t *dst8, uint8_t *prev8,
+                                          uint8_t *cur8, uint8_t *next8,
+                                          int w, int prefs, int mrefs,
+                                          int parity, int mode )
+{
+    uint16_t *dst = (uint16_t *)dst8;
+    uint16_t *prev = (uint16_t *)prev8;
+    uint16_t *cur = (uint16_t *)cur8;
+    uint16_t *next = (uint16_t *)next8;
+    uint16_t *prev2 = parity ? prev : cur ;
+    uint16_t *next2 = parity ? cur  : next;
+    const int prefs8 = prefs, mrefs8 = mrefs;
+    int x = 0;
+
+    mrefs /= 2;
+    prefs /= 2;
+    w /= 2;
+
+    for( ; x + 8 <= w; x += 8 )
+    {
+        YADIF_AVX2_PIXELS( LOAD16, _mm256_abs_epi32,
+                           _mm256_add_epi32, _mm256_sub_epi32,
+                           _mm256_srai_epi32, _mm256_cmpgt_epi32,
+                           _mm256_min_epi32, _mm256_max_epi32, DEC32 )
+
+        _mm_storeu_si128( (__m128i *)dst,
+                          _mm_packus_epi32( _mm256_castsi256_si128( spatial_pred ),
+                                            _mm256_extracti128_si256( spatial_pred, 1 ) ) );
+        dst += 8;
+        prev += 8;
+        cur += 8;
+        next += 8;
+        prev2 += 8;
+        next2 += 8;
+    }
+
+    if( x < w )
+        yadif_filter_line_c_16bit( (uint8_t *)dst, (uint8_t *)prev,
+                                   (uint8_t *)cur, (uint8_t *)next,
+                                   2 * (w - x), prefs8, mrefs8, parity, mode );
+}
+#endif
+
+struct yadif_bands
+{
+    picture_t *p_dst;
+    const picture_t *p_prev;
+    const picture_t *p_cur;
+    const picture_t *p_next;
+    yadif_filter_t filter;
+    int i_field;
+    int i_parity;
+};
+
+static void RenderYadifBand( void *opaque, unsigned i_band, unsigned i_bands )
+{
+    const struct yadif_bands *p_bands = opaque;
+    const yadif_filter_t filter = p_bands->filter;
+    const int i_field = p_bands->i_field;
+    const int yadif_parity = p_bands->i_parity;
+
+    for( int n = 0; n < p_bands->p_dst->i_planes; n++ )
+    {
+        const plane_t *prevp = &p_bands->p_prev->p[n];
+        const plane_t *curp  = &p_bands->p_cur->p[n];
+        const plane_t *nextp = &p_bands->p_next->p[n];
+        plane_t *dstp        = &p_bands->p_dst->p[n];
+
+        int y_start, y_end;
+        GetBandLines( dstp->i_visible_lines, i_band, i_bands, 1,
+                      &y_start, &y_end );
+        if( y_start < 1 )
+            y_start = 1;
+        if( y_end > dstp->i_visible_lines - 1 )
+            y_end = dstp->i_visible_lines - 1;
+
+        for( int y = y_start; y < y_end; y++ )
+        {
+            if( (y % 2) == i_field  ||  yadif_parity == 2 )
+            {
+                memcpy( &dstp->p_pixels[y * dstp->i_pitch],
+                            &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
+            }
+            else
+            {
+                int mode;
+                /* Spatial checks only when enough data */
+                mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
+
+                assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
+                filter( &dstp->p_pixels[y * dstp->i_pitch],
+                        &prevp->p_pixels[y * prevp->i_pitch],
+                        &curp->p_pixels[y * curp->i_pitch],
+                        &nextp->p_pixels[y * nextp->i_pitch],
+                        dstp->i_visible_pitch,
+                        y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
+                        y  - 1  ?  -curp->i_pitch : curp->i_pitch,
+                        yadif_parity,
+                        mode );
+            }
+
+            /* We duplicate the first and last lines */
+            if( y == 1 )
+                memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+            else if( y == dstp->i_visible_lines - 2 )
+                memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
+                           &dstp->p_pixels[ y    * dstp->i_pitch],
+                           dstp->i_pitch);
+        }
+    }
+}
+
 int RenderYadifSingle( filter_t *p_filter, picture_t *p_dst, picture_t *p_src )
 {
     return RenderYadif( p_filter, p_dst, p_src, 0, 0 );
@@ -109,9 +342,13 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
     if( p_prev && p_cur && p_next )
     {
         /* */
-        void (*filter)(uint8_t *dst, uint8_t *prev, uint8_t *cur, uint8_t *next,
-                       int w, int prefs, int mrefs, int parity, int mode);
+        yadif_filter_t filter;
 
+#if defined(CAN_COMPILE_AVX2)
+        if( vlc_CPU_AVX2() )
+            filter = yadif_filter_line_avx2;
+        else
+#endif
 #if defined(HAVE_X86ASM)
         if( vlc_CPU_SSSE3() )
             filter = vlcpriv_yadif_filter_line_ssse3;
@@ -128,52 +365,21 @@ int RenderYadif( filter_t *p_filter, picture_t *p_dst, picture_t *p_src,
             filter = yadif_filter_line_c;
 
         if( p_sys->chroma->pixel_size == 2 )
-            filter = yadif_filter_line_c_16bit;
-
-        for( int n = 0; n < p_dst->i_planes; n++ )
         {
-            const plane_t *prevp = &p_prev->p[n];
-            const plane_t *curp  = &p_cur->p[n];
-            const plane_t *nextp = &p_next->p[n];
-            plane_t *dstp        = &p_dst->p[n];
-
-            for( int y = 1; y < dstp->i_visible_lines - 1; y++ )
-            {
-                if( (y % 2) == i_field  ||  yadif_parity == 2 )
-                {
-                    memcpy( &dstp->p_pixels[y * dstp->i_pitch],
-                                &curp->p_pixels[y * curp->i_pitch], dstp->i_visible_pitch );
-                }
-                else
-                {
-                    int mode;
-                    /* Spatial checks only when enough data */
-                    mode = (y >= 2 && y < dstp->i_visible_lines - 2) ? 0 : 2;
-
-                    assert( prevp->i_pitch == curp->i_pitch && curp->i_pitch == nextp->i_pitch );
-                    filter( &dstp->p_pixels[y * dstp->i_pitch],
-                            &prevp->p_pixels[y * prevp->i_pitch],
-                            &curp->p_pixels[y * curp->i_pitch],
-                            &nextp->p_pixels[y * nextp->i_pitch],
-                            dstp->i_visible_pitch,
-                            y < dstp->i_visible_lines - 2  ? curp->i_pitch : -curp->i_pitch,
-                            y  - 1  ?  -curp->i_pitch : curp->i_pitch,
-                            yadif_parity,
-                            mode );
-                }
-
-                /* We duplicate the first and last lines */
-                if( y == 1 )
-                    memcpy(&dstp->p_pixels[(y-1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-                else if( y == dstp->i_visible_lines - 2 )
-                    memcpy(&dstp->p_pixels[(y+1) * dstp->i_pitch],
-                               &dstp->p_pixels[ y    * dstp->i_pitch],
-                               dstp->i_pitch);
-            }
+#if defined(CAN_COMPILE_AVX2)
+            if( vlc_CPU_AVX2() )
+                filter = yadif_filter_line_avx2_16bit;
+            else
+#endif
+                filter = yadif_filter_line_c_16bit;
         }
 
+        struct yadif_bands bands = {
+            .p_dst = p_dst, .p_prev = p_prev, .p_cur = p_cur, .p_next = p_next,
+            .filter = filter, .i_field = i_field, .i_parity = yadif_parity,
+        };
+        RenderBands( p_filter, RenderYadifBand, &bands );
+
         p_sys->context.i_frame_offset = 1; /* p_cur will be rendered at next frame, too */
 
         return VLC_SUCCESS;
@@ -287,6 +287,12 @@ static int Mouse( filter_t *p_filter,
                                     "in the Phosphor framerate doubler. "\
                                     "Default: Low.")
 
+#define THREADS_TEXT N_("Threads")
+#define THREADS_LONGTEXT N_("Number of horizontal bands rendered in "\
+                            "parallel by the X, Yadif and Phosphor "\
+                            "algorithms. 0 selects a value depending on the "\
+                            "number of CPUs, 1 disables threading.")
+
 vlc_module_begin ()
     set_description( N_("Deinterlacing video filter") )
     set_shortname( N_("Deinterlace" ))
@@ -305,6 +311,10 @@ vlc_module_begin ()
                 PHOSPHOR_DIMMER_LONGTEXT, true )
         change_integer_list( phosphor_dimmer_list, phosphor_dimmer_list_text )
         change_safe ()
+    add_integer_with_range( FILTER_CFG_PREFIX "threads", 0,
+                            0, DEINTERLACE_MAX_BANDS,
+                            THREADS_TEXT, THREADS_LONGTEXT, true )
+        change_safe ()
     set_deinterlace_callback( Open )
 vlc_module_end ()
 
@@ -319,7 +329,7 @@ vlc_module_end ()
  * and reading logic for them implemented in Open().
  */
 static const char *const ppsz_filter_options[] = {
-    "mode", "phosphor-chroma", "phosphor-dimmer",
+    "mode", "phosphor-chroma", "phosphor-dimmer", "threads",
     NULL
 };
 
@@ -480,8 +490,12 @@ int Mouse( filter_t *p_filter,
  */
 static void Close( filter_t *p_filter )
 {
+    filter_sys_t *p_sys = p_filter->p_sys;
+
     Flush( p_filter );
-    free( p_filter->p_sys );
+    if( p_sys->executor != NULL )
+        ReleaseBandExecutor( p_sys->executor );
+    free( p_sys );
 }
 
 static const struct vlc_filter_operations filter_ops = {
@@ -644,6 +658,29 @@ notsupp:
     }
     free( psz_mode );
 
+    /* Band threading: only worth it for pictures of a decent size */
+    unsigned i_bands = var_GetInteger( p_filter, FILTER_CFG_PREFIX "threads" );
+    if( i_bands == 0 )
+    {
+        i_bands = vlc_GetCPUCount();
+        if( i_bands > 4 )
+            i_bands = 4;
+        if( fmt.i_height < 480 )
+            i_bands = 1;
+    }
+    if( i_bands > DEINTERLACE_MAX_BANDS )
+        i_bands = DEINTERLACE_MAX_BANDS;
+
+    p_sys->executor = NULL;
+    p_sys->i_bands = 1;
+    if( i_bands > 1 )
+    {
+        p_sys->executor = HoldBandExecutor();
+        if( p_sys->executor != NULL )
+            p_sys->i_bands = i_bands;
+        msg_Dbg( p_filter, "rendering in %u bands", p_sys->i_bands );
+    }
+
     if( !p_filter->b_allow_fmt_out_change &&
         ( fmt.i_chroma != p_filter->fmt_in.video.i_chroma ||
           fmt.i_height != p_filter->fmt_in.video.i_height ) )
@@ -34,6 +34,7 @@ struct vlc_object_t;
 
 #include <vlc_common.h>
 #include <vlc_mouse.h>
+#include <vlc_executor.h>
 
 /* Local algorithm headers */
 #include "algo_basic.h"
@@ -57,6 +58,9 @@ static const char *const mode_list_text[] = {
     N_("Discard"), N_("Blend"), N_("Mean"), N_("Bob"), N_("Linear"), "X",
     "Yadif", "Yadif (2x)", N_("Phosphor"), N_("Film NTSC (IVTC)") };
 
+/** Maximum number of bands rendered in parallel. */
+#define DEINTERLACE_MAX_BANDS 8
+
 /*****************************************************************************
  * Data structures
  *****************************************************************************/
@@ -77,6 +81,10 @@ typedef struct
 
     struct deinterlace_ctx   context;
 
+    /** Shared thread pool for band rendering, NULL if single-threaded */
+    vlc_executor_t *executor;
+    unsigned i_bands; /**< Number of bands per picture, see RenderBands() */
+
     /* Algorithm-specific substructures */
     union {
         phosphor_sys_t phosphor; /**< Phosphor algorithm state. */
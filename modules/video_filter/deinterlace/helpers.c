@@ -679,3 +679,120 @@ int CalculateInterlaceScore( const picture_t* p_pic_top,
     return i_score;
 }
 #undef T
+
+/*****************************************************************************
+ * Band threading
+ *****************************************************************************/
+
+static vlc_mutex_t band_executor_lock = VLC_STATIC_MUTEX;
+static vlc_executor_t *band_executor = NULL;
+static unsigned band_executor_refs = 0;
+
+/* See header for function doc. */
+vlc_executor_t *HoldBandExecutor( void )
+{
+    vlc_mutex_lock( &band_executor_lock );
+    if( band_executor == NULL )
+    {
+        unsigned i_threads = vlc_GetCPUCount();
+        if( i_threads > DEINTERLACE_MAX_BANDS )
+            i_threads = DEINTERLACE_MAX_BANDS;
+        band_executor = vlc_executor_New( i_threads );
+    }
+    if( band_executor != NULL )
+        band_executor_refs++;
+
+    vlc_executor_t *p_executor = band_executor;
+    vlc_mutex_unlock( &band_executor_lock );
+    return p_executor;
+}
+
+/* See header for function doc. */
+void ReleaseBandExecutor( vlc_executor_t *p_executor )
+{
+    vlc_mutex_lock( &band_executor_lock );
+    assert( p_executor == band_executor );
+    assert( band_executor_refs > 0 );
+    if( --band_executor_refs == 0 )
+    {
+        vlc_executor_Delete( band_executor );
+        band_executor = NULL;
+    }
+    vlc_mutex_unlock( &band_executor_lock );
+}
+
+struct band_task
+{
+    struct vlc_runnable runnable;
+    void (*pf_band)( void *, unsigned, unsigned );
+    void *opaque;
+    unsigned i_band;
+    unsigned i_bands;
+    vlc_sem_t *p_done;
+};
+
+static void RunBand( void *data )
+{
+    struct band_task *p_task = data;
+
+    p_task->pf_band( p_task->opaque, p_task->i_band, p_task->i_bands );
+    vlc_sem_post( p_task->p_done );
+}
+
+/* See header for function doc. */
+void RenderBands( filter_t *p_filter,
+                  void (*pf_band)( void *opaque, unsigned i_band,
+                                   unsigned i_bands ),
+                  void *opaque )
+{
+    filter_sys_t *p_sys = p_filter->p_sys;
+    const unsigned i_bands = p_sys->i_bands;
+
+    if( i_bands <= 1 )
+    {
+        pf_band( opaque, 0, 1 );
+        return;
+    }
+
+    assert( p_sys->executor != NULL );
+    assert( i_bands <= DEINTERLACE_MAX_BANDS );
+
+    struct band_task tasks[DEINTERLACE_MAX_BANDS];
+    vlc_sem_t done;
+    vlc_sem_init( &done, 0 );
+
+    for( unsigned i = 1; i < i_bands; i++ )
+    {
+        tasks[i].runnable.run = RunBand;
+        tasks[i].runnable.userdata = &tasks[i];
+        tasks[i].pf_band = pf_band;
+        tasks[i].opaque = opaque;
+        tasks[i].i_band = i;
+        tasks[i].i_bands = i_bands;
+        tasks[i].p_done = &done;
+        vlc_executor_Submit( p_sys->executor, &tasks[i].runnable );
+    }
+
+    /* Render the first band ourselves rather than sleeping */
+    pf_band( opaque, 0, i_bands );
+
+    for( unsigned i = 1; i < i_bands; i++ )
+        vlc_sem_wait( &done );
+}
+
+/* See header for function doc. */
+void GetBandLines( int i_lines, unsigned i_band, unsigned i_bands,
+                   int i_align, int *pi_start, int *pi_end )
+{
+    assert( i_band < i_bands );
+    assert( i_align > 0 );
+
+    const int i_groups = ( i_lines + i_align - 1 ) / i_align;
+
+    *pi_start = i_groups * i_band / i_bands * i_align;
+    *pi_end   = i_groups * ( i_band + 1 ) / i_bands * i_align;
+    if( *pi_start > i_lines )
+        *pi_start = i_lines;
+    if( *pi_end > i_lines )
+        *pi_end = i_lines;
+}
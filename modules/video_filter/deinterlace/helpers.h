@@ -33,6 +33,7 @@
 struct filter_t;
 struct picture_t;
 struct plane_t;
+struct vlc_executor;
 
 /**
  * Chroma operation types for composing 4:2:0 frames.
@@ -165,4 +166,59 @@ int EstimateNumBlocksWithMotion( const picture_t* p_prev,
 int CalculateInterlaceScore( const picture_t* p_pic_top,
                              const picture_t* p_pic_bot );
 
+/**
+ * Gets a reference to the thread pool shared by all deinterlacer instances.
+ *
+ * @return The shared executor, or NULL on error.
+ * @see ReleaseBandExecutor()
+ */
+struct vlc_executor *HoldBandExecutor( void );
+
+/**
+ * Releases a reference obtained with HoldBandExecutor().
+ *
+ * The thread pool is destroyed when the last reference is released.
+ */
+void ReleaseBandExecutor( struct vlc_executor * );
+
+/**
+ * Renders a picture as horizontal bands in parallel.
+ *
+ * pf_band is invoked once for each band, with the band index and the total
+ * number of bands (filter_sys_t::i_bands). One band is rendered on the
+ * calling thread, the others on the shared thread pool. This function
+ * returns once all the bands have been rendered.
+ *
+ * Each invocation must only write the lines of its own band, as given by
+ * GetBandLines(), so that the output does not depend on the number of bands
+ * nor on the scheduling.
+ *
+ * @param p_filter The filter instance.
+ * @param pf_band Band rendering function.
+ * @param opaque Data passed to pf_band.
+ * @see GetBandLines()
+ */
+void RenderBands( filter_t *p_filter,
+                  void (*pf_band)( void *opaque, unsigned i_band,
+                                   unsigned i_bands ),
+                  void *opaque );
+
+/**
+ * Computes the lines belonging to a band.
+ *
+ * The lines are split in groups of i_align lines, and the groups are
+ * distributed as evenly as possible among the bands. The last band
+ * gets the remaining lines, if i_lines is not a multiple of i_align.
+ *
+ * @param i_lines Number of lines of the plane.
+ * @param i_band Band index, from 0 to i_bands-1.
+ * @param i_bands Number of bands.
+ * @param i_align Number of lines per group, e.g. 2 to keep field parity.
+ * @param[out] pi_start First line of the band.
+ * @param[out] pi_end Line after the last line of the band.
+ * @see RenderBands()
+ */
+void GetBandLines( int i_lines, unsigned i_band, unsigned i_bands,
+                   int i_align, int *pi_start, int *pi_end );
+
 #endif
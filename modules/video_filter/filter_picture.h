@@ -162,3 +162,30 @@ static inline picture_t *CopyInfoAndRelease( picture_t *p_outpic, picture_t *p_i
 
     return p_outpic;
 }
+
+/*****************************************************************************
+ * Rows of a picture, for filter_ProcessRows() callbacks
+ *****************************************************************************/
+static inline void GetPictureRows( picture_t *p_rows, const picture_t *p_pic,
+                                   unsigned y0, unsigned y1 )
+{
+    const unsigned i_rows = p_pic->p[0].i_visible_lines;
+
+    p_rows->format = p_pic->format;
+    p_rows->i_planes = p_pic->i_planes;
+    for( int i = 0; i < p_pic->i_planes; i++ )
+    {
+        plane_t *p = &p_rows->p[i];
+
+        *p = p_pic->p[i];
+        if( i_rows == 0 )
+            continue;
+
+        /* Matching lines of the subsampled planes */
+        const unsigned i_start = y0 * p->i_visible_lines / i_rows;
+        const unsigned i_end = y1 * p->i_visible_lines / i_rows;
+
+        p->p_pixels += i_start * p->i_pitch;
+        p->i_lines = p->i_visible_lines = i_end - i_start;
+    }
+}
@@ -94,6 +94,7 @@ struct vout_display_sys_t {
  */
     uint32_t        crtc;
     uint32_t        plane_id;
+    vlc_tick_t      refresh_period;
 
 /*
  * other generic stuff
@@ -274,6 +275,11 @@ static deviceRval SetupDevice(vout_display_t *vd, drmModeRes const *res,
     msg_Dbg(vd, "Mode resolution for connector %u is %ux%u",
             conn->connector_id, sys->width, sys->height);
 
+    const drmModeModeInfo *mode = &conn->modes[0];
+    if (mode->clock > 0)
+        sys->refresh_period = (vlc_tick_t)mode->htotal * mode->vtotal
+                              * CLOCK_FREQ / (mode->clock * INT64_C(1000));
+
     ret = FindCRTC(vd, res, conn);
     if (ret != drvSuccess) {
         msg_Dbg(vd , "No valid CRTC for connector %d", conn->connector_id);
@@ -637,6 +643,14 @@ static void Display(vout_display_t *vd, picture_t *picture)
                 sys->plane_id,
                 sys->fb[sys->front_buf]);
     } else {
+        uint64_t seq, ns;
+
+        /* The plane is flipped on the next vertical blanking */
+        if (sys->refresh_period > 0
+         && drmCrtcGetSequence(sys->drm_fd, sys->crtc, &seq, &ns) == 0)
+            vout_display_SendEventVblank(vd, VLC_TICK_FROM_NS(ns),
+                                         sys->refresh_period);
+
         sys->front_buf++;
         sys->front_buf %= MAXHWBUF;
 
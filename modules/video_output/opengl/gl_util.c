@@ -23,8 +23,21 @@
 # include "config.h"
 #endif
 
+#include <errno.h>
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_strings.h>
+
 #include "gl_util.h"
 
+/* Arbitrary limit to reject corrupted cache files */
+#define PROGRAM_BINARY_MAX_SIZE (16 << 20)
+
 static void
 LogShaderErrors(vlc_object_t *obj, const opengl_vtable_t *vt, GLuint id)
 {
@@ -86,6 +99,176 @@ CreateShader(vlc_object_t *obj, const opengl_vtable_t *vt, GLenum type,
     return shader;
 }
 
+static void
+DrainErrors(const opengl_vtable_t *vt)
+{
+    while (vt->GetError() != GL_NO_ERROR)
+        ;
+}
+
+/*
+ * Linked programs are cached in the user cache directory, so that the shaders
+ * are not compiled again by the next vout. Program binaries are specific to
+ * the driver, so the files are named after the hash of the driver identity
+ * and of the shader sources.
+ */
+static bool
+ProgramCacheSupported(const opengl_vtable_t *vt)
+{
+    if (vt->GetProgramBinary == NULL || vt->ProgramBinary == NULL)
+        return false;
+
+    GLint formats = 0;
+    vt->GetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    DrainErrors(vt);
+    return formats > 0;
+}
+
+static char *
+GetProgramCachePath(const opengl_vtable_t *vt,
+                    GLsizei vstring_count, const GLchar **vstrings,
+                    GLsizei fstring_count, const GLchar **fstrings)
+{
+    static const GLenum ids[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+    char hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+
+    vlc_hash_md5_Init(&md5);
+    for (size_t i = 0; i < ARRAY_SIZE(ids); i++)
+    {
+        const char *id = (const char *) vt->GetString(ids[i]);
+        if (id == NULL)
+            return NULL;
+        vlc_hash_md5_Update(&md5, id, strlen(id) + 1);
+    }
+    for (GLsizei i = 0; i < vstring_count; i++)
+        vlc_hash_md5_Update(&md5, vstrings[i], strlen(vstrings[i]));
+    vlc_hash_md5_Update(&md5, "", 1); /* separate the shaders */
+    for (GLsizei i = 0; i < fstring_count; i++)
+        vlc_hash_md5_Update(&md5, fstrings[i], strlen(fstrings[i]));
+    vlc_hash_FinishHex(&md5, hash);
+
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    if (dir == NULL)
+        return NULL;
+
+    char *path;
+    if (asprintf(&path, "%s" DIR_SEP "glprograms" DIR_SEP "%s.bin",
+                 dir, hash) < 0)
+        path = NULL;
+    free(dir);
+    return path;
+}
+
+static GLuint
+LoadProgramBinary(vlc_object_t *obj, const opengl_vtable_t *vt,
+                  const char *path)
+{
+    FILE *file = vlc_fopen(path, "rb");
+    if (file == NULL)
+        return 0;
+
+    GLuint program = 0;
+    GLenum format;
+    struct stat st;
+    void *binary = NULL;
+
+    if (fstat(fileno(file), &st) != 0
+     || st.st_size <= (off_t) sizeof (format)
+     || st.st_size > PROGRAM_BINARY_MAX_SIZE)
+        goto end;
+
+    size_t size = st.st_size - sizeof (format);
+    binary = malloc(size);
+    if (binary == NULL
+     || fread(&format, sizeof (format), 1, file) != 1
+     || fread(binary, size, 1, file) != 1)
+        goto end;
+
+    program = vt->CreateProgram();
+    if (!program)
+        goto end;
+
+    vt->ProgramBinary(program, format, binary, size);
+    /* The binary is refused if the driver changed, without reporting it by
+     * the identity hashed in the file name */
+    DrainErrors(vt);
+
+    GLint linked;
+    vt->GetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        msg_Dbg(obj, "discarding stale program binary %s", path);
+        vt->DeleteProgram(program);
+        program = 0;
+    }
+
+end:
+    free(binary);
+    fclose(file);
+    if (!program)
+        vlc_unlink(path);
+    return program;
+}
+
+static void
+StoreProgramBinary(vlc_object_t *obj, const opengl_vtable_t *vt,
+                   GLuint program, const char *path)
+{
+    GLint length = 0;
+    vt->GetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0 || length > PROGRAM_BINARY_MAX_SIZE)
+        return;
+
+    void *binary = malloc(length);
+    if (binary == NULL)
+        return;
+
+    GLsizei written = 0;
+    GLenum format;
+    vt->GetProgramBinary(program, length, &written, &format, binary);
+    DrainErrors(vt);
+    if (written <= 0)
+        goto end;
+
+    char *dir = config_GetUserDir(VLC_CACHE_DIR);
+    if (dir == NULL)
+        goto end;
+    vlc_mkdir(dir, 0700);
+
+    char *subdir, *tmp;
+    if (asprintf(&subdir, "%s" DIR_SEP "glprograms", dir) < 0)
+        subdir = NULL;
+    free(dir);
+    if (subdir == NULL)
+        goto end;
+    vlc_mkdir(subdir, 0700);
+    free(subdir);
+
+    /* Write a temporary file, so that other instances never read partial
+     * binaries */
+    if (asprintf(&tmp, "%s.tmp", path) < 0)
+        goto end;
+
+    FILE *file = vlc_fopen(tmp, "wb");
+    if (file == NULL)
+    {
+        msg_Dbg(obj, "cannot cache program binary: %s",
+                vlc_strerror_c(errno));
+        free(tmp);
+        goto end;
+    }
+
+    bool ok = fwrite(&format, sizeof (format), 1, file) == 1
+           && fwrite(binary, written, 1, file) == 1;
+    ok &= fclose(file) == 0;
+    if (!ok || vlc_rename(tmp, path) != 0)
+        vlc_unlink(tmp);
+    free(tmp);
+
+end:
+    free(binary);
+}
 
 GLuint
 vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
@@ -93,11 +276,30 @@ vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
                     GLsizei fstring_count, const GLchar **fstrings)
 {
     GLuint program = 0;
+    char *cache_path = NULL;
+
+    if (ProgramCacheSupported(vt))
+    {
+        cache_path = GetProgramCachePath(vt, vstring_count, vstrings,
+                                         fstring_count, fstrings);
+        if (cache_path != NULL)
+        {
+            program = LoadProgramBinary(obj, vt, cache_path);
+            if (program)
+            {
+                free(cache_path);
+                return program;
+            }
+        }
+    }
 
     GLuint vertex_shader = CreateShader(obj, vt, GL_VERTEX_SHADER,
                                         vstring_count, vstrings);
     if (!vertex_shader)
+    {
+        free(cache_path);
         return 0;
+    }
 
     GLuint fragment_shader = CreateShader(obj, vt, GL_FRAGMENT_SHADER,
                                           fstring_count, fstrings);
@@ -111,6 +313,10 @@ vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
     vt->AttachShader(program, vertex_shader);
     vt->AttachShader(program, fragment_shader);
 
+    if (cache_path != NULL && vt->ProgramParameteri != NULL)
+        vt->ProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                              GL_TRUE);
+
     vt->LinkProgram(program);
 
     LogProgramErrors(obj, vt, program);
@@ -123,11 +329,14 @@ vlc_gl_BuildProgram(vlc_object_t *obj, const opengl_vtable_t *vt,
         vt->DeleteProgram(program);
         program = 0;
     }
+    else if (cache_path != NULL)
+        StoreProgramBinary(obj, vt, program, cache_path);
 
 finally_2:
     vt->DeleteShader(fragment_shader);
 finally_1:
     vt->DeleteShader(vertex_shader);
+    free(cache_path);
 
     return program;
 }
@@ -66,6 +66,20 @@ vlc_gl_interop_New(struct vlc_gl_t *gl, const struct vlc_gl_api *api,
     }
     else
     {
+        /* DMA-BUF pictures are mapped too: import them if possible, else
+         * upload them as any software picture */
+        if (context != NULL
+         && vlc_video_context_GetType(context) == VLC_VIDEO_CONTEXT_DMABUF)
+        {
+            interop->vctx = context;
+            interop->module = module_need_var(interop, "glinterop", "glinterop");
+            if (interop->module != NULL)
+                return interop;
+            interop->vctx = NULL;
+            interop->fmt_out = interop->fmt_in = *fmt;
+            interop->fmt_out.p_palette = interop->fmt_in.p_palette = NULL;
+        }
+
         /* No opengl interop module found: use a generic interop. */
         int ret = opengl_interop_generic_init(interop, true);
         if (ret != VLC_SUCCESS)
@@ -0,0 +1,240 @@
+/*****************************************************************************
+ * interop_dmabuf.c: OpenGL DMA-BUF import
+ *****************************************************************************
+ * Copyright (C) 2024 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+
+#include "gl_api.h"
+#include "interop.h"
+#include "../../hw/dmabuf/vlc_dmabuf.h"
+
+/* From https://www.khronos.org/registry/OpenGL/extensions/OES/OES_EGL_image.txt
+ * The extension is an OpenGL ES extension but can (and usually is) available on
+ * OpenGL implementations. */
+#ifndef GL_OES_EGL_image
+#define GL_OES_EGL_image 1
+typedef void *GLeglImageOES;
+typedef void (*PFNGLEGLIMAGETARGETTEXTURE2DOESPROC)(GLenum target, GLeglImageOES image);
+#endif
+
+/* The pictures come from a small pool: the EGL images are kept for each
+ * buffer instead of being created for every frame */
+#define IMPORT_CACHE_SIZE 16
+
+struct import
+{
+    uint64_t id;
+    unsigned plane_count;
+    EGLImageKHR images[PICTURE_PLANE_MAX];
+};
+
+struct priv
+{
+    PFNGLEGLIMAGETARGETTEXTURE2DOESPROC glEGLImageTargetTexture2DOES;
+
+    struct import cache[IMPORT_CACHE_SIZE];
+    unsigned cache_count;
+
+    /* The GPU may still be reading the last picture */
+    picture_t *last_pic;
+};
+
+static EGLImageKHR
+dmabuf_image_create(const struct vlc_gl_interop *interop, EGLint w, EGLint h,
+                    const struct vlc_dmabuf_plane *plane, uint64_t modifier)
+{
+    EGLint attribs[] = {
+        EGL_WIDTH, w,
+        EGL_HEIGHT, h,
+        EGL_LINUX_DRM_FOURCC_EXT, plane->drm_format,
+        EGL_DMA_BUF_PLANE0_FD_EXT, plane->fd,
+        EGL_DMA_BUF_PLANE0_OFFSET_EXT, plane->offset,
+        EGL_DMA_BUF_PLANE0_PITCH_EXT, plane->pitch,
+        EGL_DMA_BUF_PLANE0_MODIFIER_LO_EXT, modifier & 0xffffffff,
+        EGL_DMA_BUF_PLANE0_MODIFIER_HI_EXT, modifier >> 32,
+        EGL_NONE
+    };
+
+    return interop->gl->egl.createImageKHR(interop->gl, EGL_LINUX_DMA_BUF_EXT,
+                                           NULL, attribs);
+}
+
+static void
+import_release(const struct vlc_gl_interop *interop, struct import *import)
+{
+    for (unsigned i = 0; i < import->plane_count; ++i)
+        interop->gl->egl.destroyImageKHR(interop->gl, import->images[i]);
+    import->plane_count = 0;
+}
+
+static void
+cache_flush(const struct vlc_gl_interop *interop, struct priv *priv)
+{
+    for (unsigned i = 0; i < priv->cache_count; ++i)
+        import_release(interop, &priv->cache[i]);
+    priv->cache_count = 0;
+}
+
+static const struct import *
+cache_get(const struct vlc_gl_interop *interop, struct priv *priv,
+          const struct vlc_dmabuf_pic_context *ctx,
+          const GLsizei *tex_width, const GLsizei *tex_height)
+{
+    for (unsigned i = 0; i < priv->cache_count; ++i)
+        if (priv->cache[i].id == ctx->id)
+            return &priv->cache[i];
+
+    /* A new pool replaced the previous one */
+    if (priv->cache_count == IMPORT_CACHE_SIZE)
+        cache_flush(interop, priv);
+
+    struct import *import = &priv->cache[priv->cache_count];
+    import->id = ctx->id;
+    import->plane_count = 0;
+
+    for (unsigned i = 0; i < ctx->plane_count; ++i)
+    {
+        import->images[i] = dmabuf_image_create(interop, tex_width[i],
+                                                tex_height[i],
+                                                &ctx->planes[i],
+                                                ctx->modifier);
+        if (import->images[i] == NULL)
+        {
+            import_release(interop, import);
+            return NULL;
+        }
+        import->plane_count++;
+    }
+
+    priv->cache_count++;
+    return import;
+}
+
+static int
+tc_dmabuf_update(const struct vlc_gl_interop *interop, GLuint *textures,
+                 const GLsizei *tex_width, const GLsizei *tex_height,
+                 picture_t *pic, const size_t *plane_offset)
+{
+    (void) plane_offset;
+    struct priv *priv = interop->priv;
+
+    struct vlc_dmabuf_pic_context *ctx = vlc_dmabuf_PicGetContext(pic);
+    if (ctx == NULL || ctx->plane_count != interop->tex_count)
+        return VLC_EGENERIC;
+
+    const struct import *import =
+        cache_get(interop, priv, ctx, tex_width, tex_height);
+    if (import == NULL)
+        return VLC_EGENERIC;
+
+    for (unsigned i = 0; i < import->plane_count; ++i)
+    {
+        interop->vt->BindTexture(interop->tex_target, textures[i]);
+        priv->glEGLImageTargetTexture2DOES(interop->tex_target,
+                                           import->images[i]);
+    }
+
+    if (pic != priv->last_pic)
+    {
+        if (priv->last_pic != NULL)
+            picture_Release(priv->last_pic);
+        priv->last_pic = picture_Hold(pic);
+    }
+    return VLC_SUCCESS;
+}
+
+static void
+Close(struct vlc_gl_interop *interop)
+{
+    struct priv *priv = interop->priv;
+
+    cache_flush(interop, priv);
+    if (priv->last_pic != NULL)
+        picture_Release(priv->last_pic);
+    free(priv);
+}
+
+static int
+Open(vlc_object_t *obj)
+{
+    struct vlc_gl_interop *interop = (void *) obj;
+
+    if (interop->vctx == NULL
+     || vlc_video_context_GetType(interop->vctx) != VLC_VIDEO_CONTEXT_DMABUF
+     || !vlc_dmabuf_IsChromaSupported(interop->fmt_in.i_chroma)
+     || interop->gl->ext != VLC_GL_EXT_EGL
+     || interop->gl->egl.createImageKHR == NULL
+     || interop->gl->egl.destroyImageKHR == NULL)
+        return VLC_EGENERIC;
+
+    if (!vlc_gl_StrHasToken(interop->api->extensions, "GL_OES_EGL_image"))
+        return VLC_EGENERIC;
+
+    const char *eglexts = interop->gl->egl.queryString(interop->gl, EGL_EXTENSIONS);
+    if (eglexts == NULL || !vlc_gl_StrHasToken(eglexts, "EGL_EXT_image_dma_buf_import"))
+        return VLC_EGENERIC;
+
+    struct priv *priv = interop->priv = calloc(1, sizeof(struct priv));
+    if (unlikely(priv == NULL))
+        return VLC_ENOMEM;
+
+    priv->glEGLImageTargetTexture2DOES =
+        vlc_gl_GetProcAddress(interop->gl, "glEGLImageTargetTexture2DOES");
+    if (priv->glEGLImageTargetTexture2DOES == NULL)
+        goto error;
+
+    /* The pictures are uploaded upside-down */
+    video_format_TransformBy(&interop->fmt_out, TRANSFORM_VFLIP);
+
+    int ret = opengl_interop_init(interop, GL_TEXTURE_2D,
+                                  interop->fmt_in.i_chroma,
+                                  interop->fmt_in.space);
+    if (ret != VLC_SUCCESS)
+        goto error;
+
+    static const struct vlc_gl_interop_ops ops = {
+        .update_textures = tc_dmabuf_update,
+        .close = Close,
+    };
+    interop->ops = &ops;
+
+    return VLC_SUCCESS;
+error:
+    free(priv);
+    return VLC_EGENERIC;
+}
+
+vlc_module_begin ()
+    set_description("DMA-BUF OpenGL surface converter")
+    set_capability("glinterop", 1)
+    set_callback(Open)
+    set_category(CAT_VIDEO)
+    set_subcategory(SUBCAT_VIDEO_VOUT)
+    add_shortcut("dmabuf")
+vlc_module_end ()
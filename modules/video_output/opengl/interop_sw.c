@@ -31,11 +31,18 @@
 #include "internal.h"
 
 #define PBO_DISPLAY_COUNT 2 /* Double buffering */
+#define PBO_PERSISTENT_COUNT 3 /* Triple buffering of mapped buffers */
+#define PBO_DISPLAY_COUNT_MAX PBO_PERSISTENT_COUNT
+
+/* Maximum wait for the GPU to release a mapped buffer */
+#define PBO_FENCE_TIMEOUT INT64_C(100000000) /* ns */
+
 typedef struct
 {
     PFNGLDELETEBUFFERSPROC DeleteBuffers;
     GLuint      buffers[PICTURE_PLANE_MAX];
     size_t      bytes[PICTURE_PLANE_MAX];
+    void       *mapped[PICTURE_PLANE_MAX]; /* persistent mappings */
 } picture_sys_t;
 
 struct priv
@@ -44,8 +51,11 @@ struct priv
     void * texture_temp_buf;
     size_t texture_temp_buf_size;
     struct {
-        picture_t *display_pics[PBO_DISPLAY_COUNT];
+        picture_t *display_pics[PBO_DISPLAY_COUNT_MAX];
+        GLsync fences[PBO_DISPLAY_COUNT_MAX];
         size_t display_idx;
+        size_t display_count;
+        bool persistent;
     } pbo;
 };
 
@@ -106,19 +116,33 @@ pbo_picture_create(const struct vlc_gl_interop *interop)
 }
 
 static int
-pbo_data_alloc(const struct vlc_gl_interop *interop, picture_t *pic)
+pbo_data_alloc(const struct vlc_gl_interop *interop, picture_t *pic,
+               bool persistent)
 {
     picture_sys_t *picsys = pic->p_sys;
+    const GLbitfield flags =
+        GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
 
     interop->vt->GetError();
 
     for (int i = 0; i < pic->i_planes; ++i)
     {
         interop->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, picsys->buffers[i]);
-        interop->vt->BufferData(GL_PIXEL_UNPACK_BUFFER, picsys->bytes[i], NULL,
-                                GL_DYNAMIC_DRAW);
+        if (persistent)
+        {
+            /* Immutable storage, mapped once for the buffer lifetime */
+            interop->vt->BufferStorage(GL_PIXEL_UNPACK_BUFFER, picsys->bytes[i],
+                                       NULL, flags);
+            picsys->mapped[i] =
+                interop->vt->MapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0,
+                                            picsys->bytes[i], flags);
+        }
+        else
+            interop->vt->BufferData(GL_PIXEL_UNPACK_BUFFER, picsys->bytes[i],
+                                    NULL, GL_DYNAMIC_DRAW);
 
-        if (interop->vt->GetError() != GL_NO_ERROR)
+        if (interop->vt->GetError() != GL_NO_ERROR
+         || (persistent && picsys->mapped[i] == NULL))
         {
             msg_Err(interop->gl, "could not alloc PBO buffers");
             interop->vt->DeleteBuffers(i, picsys->buffers);
@@ -128,31 +152,70 @@ pbo_data_alloc(const struct vlc_gl_interop *interop, picture_t *pic)
     return VLC_SUCCESS;
 }
 
+static void
+pbo_pics_release(const struct vlc_gl_interop *interop)
+{
+    struct priv *priv = interop->priv;
+
+    for (size_t i = 0; i < PBO_DISPLAY_COUNT_MAX; ++i)
+    {
+        if (priv->pbo.fences[i] != NULL)
+            interop->vt->DeleteSync(priv->pbo.fences[i]);
+        priv->pbo.fences[i] = NULL;
+        /* Deleting the buffers also unmaps them */
+        if (priv->pbo.display_pics[i] != NULL)
+            picture_Release(priv->pbo.display_pics[i]);
+        priv->pbo.display_pics[i] = NULL;
+    }
+}
+
 static int
-pbo_pics_alloc(const struct vlc_gl_interop *interop)
+pbo_pics_alloc(const struct vlc_gl_interop *interop, bool persistent)
 {
     struct priv *priv = interop->priv;
-    for (size_t i = 0; i < PBO_DISPLAY_COUNT; ++i)
+    const size_t count = persistent ? PBO_PERSISTENT_COUNT : PBO_DISPLAY_COUNT;
+
+    for (size_t i = 0; i < count; ++i)
     {
         picture_t *pic = priv->pbo.display_pics[i] =
             pbo_picture_create(interop);
         if (pic == NULL)
             goto error;
 
-        if (pbo_data_alloc(interop, pic) != VLC_SUCCESS)
+        if (pbo_data_alloc(interop, pic, persistent) != VLC_SUCCESS)
             goto error;
     }
 
     /* turn off pbo */
     interop->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
+    priv->pbo.display_count = count;
+    priv->pbo.persistent = persistent;
     return VLC_SUCCESS;
 error:
-    for (size_t i = 0; i < PBO_DISPLAY_COUNT && priv->pbo.display_pics[i]; ++i)
-        picture_Release(priv->pbo.display_pics[i]);
+    interop->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    pbo_pics_release(interop);
     return VLC_EGENERIC;
 }
 
+/* Waits until the GPU is done with the uploads from a mapped buffer */
+static void
+pbo_wait_fence(const struct vlc_gl_interop *interop, size_t idx)
+{
+    struct priv *priv = interop->priv;
+    GLsync fence = priv->pbo.fences[idx];
+
+    if (fence == NULL)
+        return;
+
+    GLenum ret = interop->vt->ClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                                             PBO_FENCE_TIMEOUT);
+    if (ret == GL_TIMEOUT_EXPIRED || ret == GL_WAIT_FAILED)
+        msg_Warn(interop->gl, "PBO still in use by the GPU");
+    interop->vt->DeleteSync(fence);
+    priv->pbo.fences[idx] = NULL;
+}
+
 static int
 tc_pbo_update(const struct vlc_gl_interop *interop, GLuint *textures,
               const GLsizei *tex_width, const GLsizei *tex_height,
@@ -161,17 +224,30 @@ tc_pbo_update(const struct vlc_gl_interop *interop, GLuint *textures,
     (void) plane_offset; assert(plane_offset == NULL);
     struct priv *priv = interop->priv;
 
-    picture_t *display_pic = priv->pbo.display_pics[priv->pbo.display_idx];
+    const size_t idx = priv->pbo.display_idx;
+    picture_t *display_pic = priv->pbo.display_pics[idx];
     picture_sys_t *p_sys = display_pic->p_sys;
-    priv->pbo.display_idx = (priv->pbo.display_idx + 1) % PBO_DISPLAY_COUNT;
+    priv->pbo.display_idx = (idx + 1) % priv->pbo.display_count;
+
+    if (priv->pbo.persistent)
+        pbo_wait_fence(interop, idx);
 
     for (int i = 0; i < pic->i_planes; i++)
     {
         GLsizeiptr size = pic->p[i].i_lines * pic->p[i].i_pitch;
         const GLvoid *data = pic->p[i].p_pixels;
+
+        if ((size_t) size > p_sys->bytes[i])
+            size = p_sys->bytes[i];
+
         interop->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER,
                            p_sys->buffers[i]);
-        interop->vt->BufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data);
+        if (priv->pbo.persistent)
+            /* No driver copy nor implicit synchronization: the fence
+             * guarantees the GPU is done with this buffer */
+            memcpy(p_sys->mapped[i], data, size);
+        else
+            interop->vt->BufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data);
 
         interop->vt->ActiveTexture(GL_TEXTURE0 + i);
         interop->vt->BindTexture(interop->tex_target, textures[i]);
@@ -187,6 +263,10 @@ tc_pbo_update(const struct vlc_gl_interop *interop, GLuint *textures,
     /* turn off pbo */
     interop->vt->BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
 
+    if (priv->pbo.persistent)
+        priv->pbo.fences[idx] =
+            interop->vt->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
     return VLC_SUCCESS;
 }
 
@@ -287,8 +367,7 @@ void
 opengl_interop_generic_deinit(struct vlc_gl_interop *interop)
 {
     struct priv *priv = interop->priv;
-    for (size_t i = 0; i < PBO_DISPLAY_COUNT && priv->pbo.display_pics[i]; ++i)
-        picture_Release(priv->pbo.display_pics[i]);
+    pbo_pics_release(interop);
     free(priv->texture_temp_buf);
     free(priv);
 }
@@ -377,7 +456,18 @@ opengl_interop_generic_init(struct vlc_gl_interop *interop, bool allow_dr)
 
         const bool supports_pbo = has_pbo && interop->vt->BufferData
             && interop->vt->BufferSubData;
-        if (supports_pbo && pbo_pics_alloc(interop) == VLC_SUCCESS)
+
+        /* Persistent mappings avoid the copy and the synchronization of
+         * glBufferSubData() */
+        const bool supports_persistent = supports_pbo
+            && (vlc_gl_StrHasToken(interop->api->extensions, "GL_ARB_buffer_storage") ||
+                vlc_gl_StrHasToken(interop->api->extensions, "GL_EXT_buffer_storage"))
+            && interop->vt->BufferStorage && interop->vt->MapBufferRange
+            && interop->vt->FenceSync && interop->vt->ClientWaitSync
+            && interop->vt->DeleteSync;
+
+        if ((supports_persistent && pbo_pics_alloc(interop, true) == VLC_SUCCESS)
+         || (supports_pbo && pbo_pics_alloc(interop, false) == VLC_SUCCESS))
         {
             static const struct vlc_gl_interop_ops pbo_ops = {
                 .allocate_textures = tc_common_allocate_textures,
@@ -385,7 +475,8 @@ opengl_interop_generic_init(struct vlc_gl_interop *interop, bool allow_dr)
                 .close = opengl_interop_generic_deinit,
             };
             interop->ops = &pbo_ops;
-            msg_Dbg(interop->gl, "PBO support enabled");
+            msg_Dbg(interop->gl, "%sPBO support enabled",
+                    priv->pbo.persistent ? "persistent " : "");
         }
     }
 
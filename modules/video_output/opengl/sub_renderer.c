@@ -41,10 +41,26 @@
 #include "interop.h"
 #include "vout_helper.h"
 
+/* Size of the texture shared by the small regions, may be reduced to the
+ * maximum texture size */
+#define ATLAS_SIZE 2048
+
+/* Transparent border around each region in the atlas, so that the linear
+ * filtering never samples the neighbours */
+#define ATLAS_BORDER 1
+
+/* Per vertex: vertex_pos (2), tex_coords_in (2), alpha_in (1) */
+#define VERTEX_FLOATS 5
+#define REGION_VERTICES 6
+
 typedef struct {
-    GLuint   texture;
+    GLuint   texture; /* the atlas texture or a texture of the region */
     GLsizei  width;
     GLsizei  height;
+    bool     in_atlas;
+    bool     atlas_dirty;
+    GLsizei  atlas_x;
+    GLsizei  atlas_y;
 
     float    alpha;
 
@@ -53,10 +69,30 @@ typedef struct {
     float    bottom;
     float    right;
 
-    float    tex_width;
-    float    tex_height;
+    float    tex_left;
+    float    tex_top;
+    float    tex_right;
+    float    tex_bottom;
 } gl_region_t;
 
+/* Horizontal band of the atlas, filled from the left */
+struct atlas_shelf {
+    GLsizei y;
+    GLsizei height;
+    GLsizei x;
+};
+
+/* Region picture already uploaded to the atlas */
+struct atlas_entry {
+    picture_t *picture;
+    unsigned x_offset;
+    unsigned y_offset;
+    unsigned width;
+    unsigned height;
+    GLsizei x;
+    GLsizei y;
+};
+
 struct vlc_gl_sub_renderer
 {
     vlc_gl_t *gl;
@@ -72,14 +108,27 @@ struct vlc_gl_sub_renderer
     struct {
         GLint vertex_pos;
         GLint tex_coords_in;
+        GLint alpha_in;
     } aloc;
     struct {
         GLint sampler;
-        GLint alpha;
     } uloc;
 
-    GLuint *buffer_objects;
-    unsigned buffer_object_count;
+    GLuint vertex_buffer;
+    GLfloat *vertices;
+    size_t vertices_size;
+
+    struct {
+        GLuint texture;
+        GLsizei size;
+        GLsizei next_y;
+        struct atlas_shelf *shelves;
+        unsigned shelf_count;
+        struct atlas_entry *entries;
+        unsigned entry_count;
+        uint8_t *staging;
+        size_t staging_size;
+    } atlas;
 };
 
 static int
@@ -100,9 +149,9 @@ FetchLocations(struct vlc_gl_sub_renderer *sr)
 #define GET_ULOC(x, str) GET_LOC(Uniform, x, str)
 #define GET_ALOC(x, str) GET_LOC(Attrib, x, str)
     GET_ULOC(sr->uloc.sampler, "sampler");
-    GET_ULOC(sr->uloc.alpha, "alpha");
     GET_ALOC(sr->aloc.vertex_pos, "vertex_pos");
     GET_ALOC(sr->aloc.tex_coords_in, "tex_coords_in");
+    GET_ALOC(sr->aloc.alpha_in, "alpha_in");
 
 #undef GET_LOC
 #undef GET_ULOC
@@ -111,6 +160,176 @@ FetchLocations(struct vlc_gl_sub_renderer *sr)
     return VLC_SUCCESS;
 }
 
+static void
+AtlasReleaseEntries(struct atlas_entry *entries, unsigned count)
+{
+    for (unsigned i = 0; i < count; ++i)
+        if (entries[i].picture != NULL)
+            picture_Release(entries[i].picture);
+}
+
+static void
+AtlasReset(struct vlc_gl_sub_renderer *sr)
+{
+    sr->atlas.shelf_count = 0;
+    sr->atlas.next_y = 0;
+}
+
+/* Finds the same region picture in the previous entries, to avoid sending it
+ * again. The entries hold the pictures, so a match cannot be a new picture
+ * at the same address. */
+static bool
+AtlasFind(struct atlas_entry *entries, unsigned count,
+          const subpicture_region_t *r, struct atlas_entry *entry)
+{
+    for (unsigned i = 0; i < count; ++i)
+    {
+        struct atlas_entry *e = &entries[i];
+        if (e->picture == r->p_picture
+         && e->x_offset == r->fmt.i_x_offset
+         && e->y_offset == r->fmt.i_y_offset
+         && e->width == r->fmt.i_visible_width
+         && e->height == r->fmt.i_visible_height)
+        {
+            *entry = *e;
+            e->picture = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool
+AtlasAlloc(struct vlc_gl_sub_renderer *sr, GLsizei width, GLsizei height,
+           GLsizei *x, GLsizei *y)
+{
+    const GLsizei size = sr->atlas.size;
+    struct atlas_shelf *best = NULL;
+
+    for (unsigned i = 0; i < sr->atlas.shelf_count; ++i)
+    {
+        struct atlas_shelf *shelf = &sr->atlas.shelves[i];
+        if (shelf->height >= height && shelf->x + width <= size
+         && (best == NULL || shelf->height < best->height))
+            best = shelf;
+    }
+
+    /* Do not waste a tall shelf for a small region while there is room */
+    const bool has_room = sr->atlas.next_y + height <= size;
+    if (best == NULL || (best->height > 2 * height && has_room))
+    {
+        if (!has_room)
+            return false;
+
+        struct atlas_shelf *shelves =
+            realloc(sr->atlas.shelves,
+                    (sr->atlas.shelf_count + 1) * sizeof(*shelves));
+        if (shelves == NULL)
+            return false;
+        sr->atlas.shelves = shelves;
+
+        best = &shelves[sr->atlas.shelf_count++];
+        best->y = sr->atlas.next_y;
+        best->height = height;
+        best->x = 0;
+        sr->atlas.next_y += height;
+    }
+
+    *x = best->x;
+    *y = best->y;
+    best->x += width;
+    return true;
+}
+
+/* Sends the visible part of the region with its border, in one call */
+static int
+AtlasUpload(struct vlc_gl_sub_renderer *sr, const gl_region_t *glr,
+            const subpicture_region_t *r)
+{
+    const struct vlc_gl_interop *interop = sr->interop;
+    const opengl_vtable_t *vt = sr->vt;
+    const plane_t *p = &r->p_picture->p[0];
+    const size_t pixel_pitch = p->i_pixel_pitch;
+    const GLsizei width = r->fmt.i_visible_width + 2 * ATLAS_BORDER;
+    const GLsizei height = r->fmt.i_visible_height + 2 * ATLAS_BORDER;
+    const size_t pitch = width * pixel_pitch;
+    const size_t border = ATLAS_BORDER * pixel_pitch;
+    const size_t visible_pitch = r->fmt.i_visible_width * pixel_pitch;
+
+    if (sr->atlas.staging_size < pitch * height)
+    {
+        sr->atlas.staging = realloc_or_free(sr->atlas.staging, pitch * height);
+        if (sr->atlas.staging == NULL)
+        {
+            sr->atlas.staging_size = 0;
+            return VLC_ENOMEM;
+        }
+        sr->atlas.staging_size = pitch * height;
+    }
+
+    const uint8_t *src = p->p_pixels + r->fmt.i_y_offset * p->i_pitch
+                       + r->fmt.i_x_offset * pixel_pitch;
+    uint8_t *dst = sr->atlas.staging;
+
+    memset(dst, 0, ATLAS_BORDER * pitch);
+    dst += ATLAS_BORDER * pitch;
+    for (unsigned y = 0; y < r->fmt.i_visible_height; ++y)
+    {
+        memset(dst, 0, border);
+        memcpy(dst + border, src, visible_pitch);
+        memset(dst + border + visible_pitch, 0, border);
+        src += p->i_pitch;
+        dst += pitch;
+    }
+    memset(dst, 0, ATLAS_BORDER * pitch);
+
+    vt->BindTexture(interop->tex_target, sr->atlas.texture);
+    vt->PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    vt->TexSubImage2D(interop->tex_target, 0,
+                      glr->atlas_x - ATLAS_BORDER, glr->atlas_y - ATLAS_BORDER,
+                      width, height, interop->texs[0].format,
+                      interop->texs[0].type, sr->atlas.staging);
+    vt->PixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    return VLC_SUCCESS;
+}
+
+static int
+BuildVertices(struct vlc_gl_sub_renderer *sr)
+{
+    const size_t size = sr->region_count * REGION_VERTICES * VERTEX_FLOATS
+                      * sizeof(GLfloat);
+    if (sr->vertices_size < size)
+    {
+        sr->vertices = realloc_or_free(sr->vertices, size);
+        if (sr->vertices == NULL)
+        {
+            sr->vertices_size = 0;
+            sr->region_count = 0;
+            return VLC_ENOMEM;
+        }
+        sr->vertices_size = size;
+    }
+
+    GLfloat *v = sr->vertices;
+    for (unsigned i = 0; i < sr->region_count; i++) {
+        const gl_region_t *glr = &sr->regions[i];
+        /* Two triangles: top-left, bottom-left, top-right, then top-right,
+         * bottom-left, bottom-right */
+        const GLfloat quad[REGION_VERTICES * VERTEX_FLOATS] = {
+            glr->left,  glr->top,    glr->tex_left,  glr->tex_top,    glr->alpha,
+            glr->left,  glr->bottom, glr->tex_left,  glr->tex_bottom, glr->alpha,
+            glr->right, glr->top,    glr->tex_right, glr->tex_top,    glr->alpha,
+            glr->right, glr->top,    glr->tex_right, glr->tex_top,    glr->alpha,
+            glr->left,  glr->bottom, glr->tex_left,  glr->tex_bottom, glr->alpha,
+            glr->right, glr->bottom, glr->tex_right, glr->tex_bottom, glr->alpha,
+        };
+        memcpy(v, quad, sizeof(quad));
+        v += ARRAY_SIZE(quad);
+    }
+    return VLC_SUCCESS;
+}
+
 struct vlc_gl_sub_renderer *
 vlc_gl_sub_renderer_New(vlc_gl_t *gl, const struct vlc_gl_api *api,
                         struct vlc_gl_interop *interop)
@@ -133,6 +352,9 @@ vlc_gl_sub_renderer_New(vlc_gl_t *gl, const struct vlc_gl_api *api,
     sr->vt = vt;
     sr->region_count = 0;
     sr->regions = NULL;
+    sr->vertices = NULL;
+    sr->vertices_size = 0;
+    memset(&sr->atlas, 0, sizeof(sr->atlas));
 
     static const char *const VERTEX_SHADER_SRC =
 #if defined(USE_OPENGL_ES2)
@@ -142,9 +364,12 @@ vlc_gl_sub_renderer_New(vlc_gl_t *gl, const struct vlc_gl_api *api,
 #endif
         "attribute vec2 vertex_pos;\n"
         "attribute vec2 tex_coords_in;\n"
+        "attribute float alpha_in;\n"
         "varying vec2 tex_coords;\n"
+        "varying float alpha;\n"
         "void main() {\n"
         "  tex_coords = tex_coords_in;\n"
+        "  alpha = alpha_in;\n"
         "  gl_Position = vec4(vertex_pos, 0.0, 1.0);\n"
         "}\n";
 
@@ -156,8 +381,8 @@ vlc_gl_sub_renderer_New(vlc_gl_t *gl, const struct vlc_gl_api *api,
         "#version 120\n"
 #endif
         "uniform sampler2D sampler;\n"
-        "uniform float alpha;\n"
         "varying vec2 tex_coords;\n"
+        "varying float alpha;\n"
         "void main() {\n"
         "  vec4 color = texture2D(sampler, tex_coords);\n"
         "  color.a *= alpha;\n"
@@ -175,15 +400,21 @@ vlc_gl_sub_renderer_New(vlc_gl_t *gl, const struct vlc_gl_api *api,
     if (ret != VLC_SUCCESS)
         goto error_2;
 
-    /* Initial number of allocated buffer objects for subpictures, will grow dynamically. */
-    static const unsigned INITIAL_BUFFER_OBJECT_COUNT = 8;
-    sr->buffer_objects = vlc_alloc(INITIAL_BUFFER_OBJECT_COUNT, sizeof(GLuint));
-    if (!sr->buffer_objects)
-        goto error_2;
-
-    sr->buffer_object_count = INITIAL_BUFFER_OBJECT_COUNT;
-
-    vt->GenBuffers(sr->buffer_object_count, sr->buffer_objects);
+    /* All regions are drawn from a single vertex buffer */
+    vt->GenBuffers(1, &sr->vertex_buffer);
+
+    /* The small regions share one texture, so that the regions of a
+     * subpicture are sent with as few uploads and draws as possible */
+    GLint max_tex_size;
+    vt->GetIntegerv(GL_MAX_TEXTURE_SIZE, &max_tex_size);
+    sr->atlas.size = __MIN(ATLAS_SIZE, max_tex_size);
+    if (vlc_gl_interop_GenerateTextures(interop, &sr->atlas.size,
+                                        &sr->atlas.size,
+                                        &sr->atlas.texture) != VLC_SUCCESS)
+    {
+        msg_Warn(gl, "cannot allocate the subpicture atlas");
+        sr->atlas.texture = 0;
+    }
 
     return sr;
 
@@ -198,17 +429,23 @@ error_1:
 void
 vlc_gl_sub_renderer_Delete(struct vlc_gl_sub_renderer *sr)
 {
-    if (sr->buffer_object_count)
-        sr->vt->DeleteBuffers(sr->buffer_object_count, sr->buffer_objects);
-    free(sr->buffer_objects);
+    sr->vt->DeleteBuffers(1, &sr->vertex_buffer);
+    free(sr->vertices);
 
     for (unsigned i = 0; i < sr->region_count; ++i)
     {
-        if (sr->regions[i].texture)
+        if (sr->regions[i].texture && !sr->regions[i].in_atlas)
             sr->vt->DeleteTextures(1, &sr->regions[i].texture);
     }
     free(sr->regions);
 
+    AtlasReleaseEntries(sr->atlas.entries, sr->atlas.entry_count);
+    free(sr->atlas.entries);
+    free(sr->atlas.shelves);
+    free(sr->atlas.staging);
+    if (sr->atlas.texture)
+        vlc_gl_interop_DeleteTextures(sr->interop, &sr->atlas.texture);
+
     free(sr);
 }
 
@@ -221,6 +458,8 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
 
     int last_count = sr->region_count;
     gl_region_t *last = sr->regions;
+    struct atlas_entry *last_entries = sr->atlas.entries;
+    unsigned last_entry_count = sr->atlas.entry_count;
 
     if (subpicture) {
         int count = 0;
@@ -231,36 +470,116 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
         if (!regions)
             return VLC_ENOMEM;
 
+        struct atlas_entry *entries = calloc(count, sizeof(*entries));
+        if (!entries)
+        {
+            free(regions);
+            return VLC_ENOMEM;
+        }
+
         sr->region_count = count;
         sr->regions = regions;
 
+        /* Place the regions in the atlas first: when it is full, it is
+         * emptied once and all the regions are placed again */
+        unsigned entry_count;
+        bool atlas_reset = false;
+place:
+        entry_count = 0;
         int i = 0;
         for (subpicture_region_t *r = subpicture->p_region;
              r; r = r->p_next, i++) {
             gl_region_t *glr = &sr->regions[i];
+            glr->in_atlas = false;
+
+            const GLsizei width = r->fmt.i_visible_width + 2 * ATLAS_BORDER;
+            const GLsizei height = r->fmt.i_visible_height + 2 * ATLAS_BORDER;
+            if (!sr->atlas.texture
+             || width > sr->atlas.size || height > sr->atlas.size)
+                continue; /* drawn from its own texture */
+
+            struct atlas_entry *entry = &entries[entry_count];
+            glr->atlas_dirty = !AtlasFind(last_entries, last_entry_count, r,
+                                          entry);
+            if (glr->atlas_dirty)
+            {
+                if (!AtlasAlloc(sr, width, height, &entry->x, &entry->y))
+                {
+                    if (atlas_reset)
+                        continue;
+
+                    AtlasReleaseEntries(entries, entry_count);
+                    AtlasReleaseEntries(last_entries, last_entry_count);
+                    last_entry_count = 0;
+                    AtlasReset(sr);
+                    atlas_reset = true;
+                    goto place;
+                }
+                *entry = (struct atlas_entry) {
+                    .picture = picture_Hold(r->p_picture),
+                    .x_offset = r->fmt.i_x_offset,
+                    .y_offset = r->fmt.i_y_offset,
+                    .width = r->fmt.i_visible_width,
+                    .height = r->fmt.i_visible_height,
+                    .x = entry->x,
+                    .y = entry->y,
+                };
+            }
+            glr->in_atlas = true;
+            glr->atlas_x = entry->x + ATLAS_BORDER;
+            glr->atlas_y = entry->y + ATLAS_BORDER;
+            entry_count++;
+        }
+
+        sr->atlas.entries = entries;
+        sr->atlas.entry_count = entry_count;
+
+        i = 0;
+        for (subpicture_region_t *r = subpicture->p_region;
+             r; r = r->p_next, i++) {
+            gl_region_t *glr = &sr->regions[i];
+
+            glr->alpha  = (float)subpicture->i_alpha * r->i_alpha / 255 / 255;
+            glr->left   =  2.0 * (r->i_x                          ) / subpicture->i_original_picture_width  - 1.0;
+            glr->top    = -2.0 * (r->i_y                          ) / subpicture->i_original_picture_height + 1.0;
+            glr->right  =  2.0 * (r->i_x + r->fmt.i_visible_width ) / subpicture->i_original_picture_width  - 1.0;
+            glr->bottom = -2.0 * (r->i_y + r->fmt.i_visible_height) / subpicture->i_original_picture_height + 1.0;
+
+            if (glr->in_atlas)
+            {
+                const float size = sr->atlas.size;
+
+                glr->texture    = sr->atlas.texture;
+                glr->tex_left   = glr->atlas_x / size;
+                glr->tex_top    = glr->atlas_y / size;
+                glr->tex_right  = (glr->atlas_x + r->fmt.i_visible_width) / size;
+                glr->tex_bottom = (glr->atlas_y + r->fmt.i_visible_height) / size;
+
+                /* Only the regions which were not in the atlas are sent */
+                if (glr->atlas_dirty && AtlasUpload(sr, glr, r) != VLC_SUCCESS)
+                    break;
+                continue;
+            }
 
             glr->width  = r->fmt.i_visible_width;
             glr->height = r->fmt.i_visible_height;
+            glr->tex_left = 0.0;
+            glr->tex_top  = 0.0;
             if (!sr->api->supports_npot) {
                 glr->width  = vlc_align_pot(glr->width);
                 glr->height = vlc_align_pot(glr->height);
-                glr->tex_width  = (float) r->fmt.i_visible_width  / glr->width;
-                glr->tex_height = (float) r->fmt.i_visible_height / glr->height;
+                glr->tex_right  = (float) r->fmt.i_visible_width  / glr->width;
+                glr->tex_bottom = (float) r->fmt.i_visible_height / glr->height;
             } else {
-                glr->tex_width  = 1.0;
-                glr->tex_height = 1.0;
+                glr->tex_right  = 1.0;
+                glr->tex_bottom = 1.0;
             }
-            glr->alpha  = (float)subpicture->i_alpha * r->i_alpha / 255 / 255;
-            glr->left   =  2.0 * (r->i_x                          ) / subpicture->i_original_picture_width  - 1.0;
-            glr->top    = -2.0 * (r->i_y                          ) / subpicture->i_original_picture_height + 1.0;
-            glr->right  =  2.0 * (r->i_x + r->fmt.i_visible_width ) / subpicture->i_original_picture_width  - 1.0;
-            glr->bottom = -2.0 * (r->i_y + r->fmt.i_visible_height) / subpicture->i_original_picture_height + 1.0;
 
             glr->texture = 0;
             /* Try to recycle the textures allocated by the previous
                call to this function. */
             for (int j = 0; j < last_count; j++) {
-                if (last[j].texture &&
+                if (last[j].texture && !last[j].in_atlas &&
                     last[j].width  == glr->width &&
                     last[j].height == glr->height) {
                     glr->texture = last[j].texture;
@@ -290,22 +609,34 @@ vlc_gl_sub_renderer_Prepare(struct vlc_gl_sub_renderer *sr, subpicture_t *subpic
             if (ret != VLC_SUCCESS)
                 break;
         }
+
+        /* Do not draw the regions which could not be prepared */
+        for (int j = i; j < count; j++)
+            if (sr->regions[j].in_atlas)
+                sr->regions[j].texture = 0;
     }
     else
     {
         sr->region_count = 0;
         sr->regions = NULL;
+        sr->atlas.entries = NULL;
+        sr->atlas.entry_count = 0;
     }
 
+    /* The atlas space of the pictures not displayed anymore is reclaimed on
+     * the next reset */
+    AtlasReleaseEntries(last_entries, last_entry_count);
+    free(last_entries);
+
     for (int i = 0; i < last_count; i++) {
-        if (last[i].texture)
+        if (last[i].texture && !last[i].in_atlas)
             vlc_gl_interop_DeleteTextures(interop, &last[i].texture);
     }
     free(last);
 
     GL_ASSERT_NOERROR(sr->vt);
 
-    return VLC_SUCCESS;
+    return BuildVertices(sr);
 }
 
 int
@@ -316,59 +647,47 @@ vlc_gl_sub_renderer_Draw(struct vlc_gl_sub_renderer *sr)
 
     GL_ASSERT_NOERROR(vt);
 
+    if (sr->region_count == 0)
+        return VLC_SUCCESS;
+
     assert(sr->program_id);
     vt->UseProgram(sr->program_id);
 
     vt->Enable(GL_BLEND);
     vt->BlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    /* We need two buffer objects for each region: for vertex and texture coordinates. */
-    if (2 * sr->region_count > sr->buffer_object_count) {
-        if (sr->buffer_object_count > 0)
-            vt->DeleteBuffers(sr->buffer_object_count, sr->buffer_objects);
-        sr->buffer_object_count = 0;
-
-        int new_count = 2 * sr->region_count;
-        sr->buffer_objects = realloc_or_free(sr->buffer_objects, new_count * sizeof(GLuint));
-        if (!sr->buffer_objects)
-            return VLC_ENOMEM;
-
-        sr->buffer_object_count = new_count;
-        vt->GenBuffers(sr->buffer_object_count, sr->buffer_objects);
-    }
+    const GLsizei stride = VERTEX_FLOATS * sizeof(GLfloat);
+    vt->BindBuffer(GL_ARRAY_BUFFER, sr->vertex_buffer);
+    vt->BufferData(GL_ARRAY_BUFFER,
+                   sr->region_count * REGION_VERTICES * stride,
+                   sr->vertices, GL_DYNAMIC_DRAW);
+    vt->EnableVertexAttribArray(sr->aloc.vertex_pos);
+    vt->VertexAttribPointer(sr->aloc.vertex_pos, 2, GL_FLOAT, 0, stride,
+                            (const void *) 0);
+    vt->EnableVertexAttribArray(sr->aloc.tex_coords_in);
+    vt->VertexAttribPointer(sr->aloc.tex_coords_in, 2, GL_FLOAT, 0, stride,
+                            (const void *) (2 * sizeof(GLfloat)));
+    vt->EnableVertexAttribArray(sr->aloc.alpha_in);
+    vt->VertexAttribPointer(sr->aloc.alpha_in, 1, GL_FLOAT, 0, stride,
+                            (const void *) (4 * sizeof(GLfloat)));
 
     vt->ActiveTexture(GL_TEXTURE0 + 0);
-    for (unsigned i = 0; i < sr->region_count; i++) {
-        gl_region_t *glr = &sr->regions[i];
-        const GLfloat vertexCoord[] = {
-            glr->left,  glr->top,
-            glr->left,  glr->bottom,
-            glr->right, glr->top,
-            glr->right, glr->bottom,
-        };
-        const GLfloat textureCoord[] = {
-            0.0, 0.0,
-            0.0, glr->tex_height,
-            glr->tex_width, 0.0,
-            glr->tex_width, glr->tex_height,
-        };
-
-        assert(glr->texture != 0);
-        vt->BindTexture(interop->tex_target, glr->texture);
-
-        vt->Uniform1f(sr->uloc.alpha, glr->alpha);
 
-        vt->BindBuffer(GL_ARRAY_BUFFER, sr->buffer_objects[2 * i]);
-        vt->BufferData(GL_ARRAY_BUFFER, sizeof(textureCoord), textureCoord, GL_STATIC_DRAW);
-        vt->EnableVertexAttribArray(sr->aloc.tex_coords_in);
-        vt->VertexAttribPointer(sr->aloc.tex_coords_in, 2, GL_FLOAT, 0, 0, 0);
-
-        vt->BindBuffer(GL_ARRAY_BUFFER, sr->buffer_objects[2 * i + 1]);
-        vt->BufferData(GL_ARRAY_BUFFER, sizeof(vertexCoord), vertexCoord, GL_STATIC_DRAW);
-        vt->EnableVertexAttribArray(sr->aloc.vertex_pos);
-        vt->VertexAttribPointer(sr->aloc.vertex_pos, 2, GL_FLOAT, 0, 0, 0);
-
-        vt->DrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    /* Consecutive regions from the same texture, usually the atlas, are
+     * drawn at once, which keeps the order of the regions for blending */
+    unsigned first = 0;
+    for (unsigned i = 1; i <= sr->region_count; i++) {
+        GLuint texture = sr->regions[first].texture;
+        if (i < sr->region_count && sr->regions[i].texture == texture)
+            continue;
+
+        if (texture != 0)
+        {
+            vt->BindTexture(interop->tex_target, texture);
+            vt->DrawArrays(GL_TRIANGLES, first * REGION_VERTICES,
+                           (i - first) * REGION_VERTICES);
+        }
+        first = i;
     }
     vt->Disable(GL_BLEND);
 
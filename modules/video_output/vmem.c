@@ -93,6 +93,8 @@ struct vout_display_sys_t {
     void (*unlock)(void *sys, void *id, void *const *plane);
     void (*display)(void *sys, void *id);
     void (*cleanup)(void *sys);
+    void (*frame)(void *sys, picture_t *pic);
+    void *frame_opaque;
 
     unsigned pitches[PICTURE_PLANE_MAX];
     unsigned lines[PICTURE_PLANE_MAX];
@@ -105,10 +107,16 @@ static void           Prepare(vout_display_t *, picture_t *, subpicture_t *, vlc
 static void           Display(vout_display_t *, picture_t *);
 static int            Control(vout_display_t *, int);
 
+static void           DisplayFrame(vout_display_t *, picture_t *);
+
 static const struct vlc_display_operations ops = {
     Close, Prepare, Display, Control, NULL, NULL,
 };
 
+static const struct vlc_display_operations frame_ops = {
+    Close, NULL, DisplayFrame, Control, NULL, NULL,
+};
+
 /*****************************************************************************
  * Open: allocates video thread
  *****************************************************************************
@@ -124,6 +132,26 @@ static int Open(vout_display_t *vd, const vout_display_cfg_t *cfg,
     /* Get the callbacks */
     vlc_format_cb setup = var_InheritAddress(vd, "vmem-setup");
 
+    sys->frame = var_InheritAddress(vd, "vmem-frame");
+    if (sys->frame != NULL) {
+        /* The decoded pictures are passed as is, without copy: keep the
+         * source format, but the pixels must be in main memory */
+        const vlc_chroma_description_t *desc =
+            vlc_fourcc_GetChromaDescription(fmtp->i_chroma);
+        if (desc == NULL || desc->plane_count == 0) {
+            msg_Err(vd, "cannot pass %4.4s pictures",
+                    (const char *)&fmtp->i_chroma);
+            free(sys);
+            return VLC_EGENERIC;
+        }
+        sys->frame_opaque = var_InheritAddress(vd, "vmem-frame-data");
+        sys->cleanup = NULL;
+        vd->sys = sys;
+        vd->ops = &frame_ops;
+        (void) cfg; (void) context;
+        return VLC_SUCCESS;
+    }
+
     sys->lock = var_InheritAddress(vd, "vmem-lock");
     if (sys->lock == NULL) {
         msg_Err(vd, "missing lock callback");
@@ -272,6 +300,13 @@ static void Display(vout_display_t *vd, picture_t *pic)
         sys->display(sys->opaque, sys->pic_opaque);
 }
 
+static void DisplayFrame(vout_display_t *vd, picture_t *pic)
+{
+    vout_display_sys_t *sys = vd->sys;
+
+    sys->frame(sys->frame_opaque, pic);
+}
+
 static int Control(vout_display_t *vd, int query)
 {
     (void) vd;
@@ -39,10 +39,17 @@
 #include <libplacebo/swapchain.h>
 #include <libplacebo/vulkan.h>
 
+// Number of sets of textures the pictures are uploaded to in turn
+#define PLANE_TEX_SETS 2
+
 struct vout_display_sys_t
 {
     vlc_vk_t *vk;
-    const struct pl_tex *plane_tex[4];
+    // Uploading a picture to the textures still sampled by the rendering of
+    // the previous one would wait for it. With a set per frame, the upload
+    // runs on the transfer queue while the previous frame is being rendered.
+    const struct pl_tex *plane_tex[PLANE_TEX_SETS][4];
+    unsigned plane_tex_set;
     struct pl_renderer *renderer;
 
     // Pool of textures for the subpictures
@@ -161,8 +168,9 @@ static void Close(vout_display_t *vd)
     vout_display_sys_t *sys = vd->sys;
     const struct pl_gpu *gpu = sys->vk->vulkan->gpu;
 
-    for (int i = 0; i < 4; i++)
-        pl_tex_destroy(gpu, &sys->plane_tex[i]);
+    for (int j = 0; j < PLANE_TEX_SETS; j++)
+        for (int i = 0; i < 4; i++)
+            pl_tex_destroy(gpu, &sys->plane_tex[j][i]);
     for (int i = 0; i < sys->num_overlays; i++)
         pl_tex_destroy(gpu, &sys->overlay_tex[i]);
 
@@ -210,9 +218,12 @@ static void PictureRender(vout_display_t *vd, picture_t *pic,
         assert(!"Failed processing the picture_t into pl_plane_data!?");
     }
 
+    const struct pl_tex **plane_tex = sys->plane_tex[sys->plane_tex_set];
+    sys->plane_tex_set = (sys->plane_tex_set + 1) % PLANE_TEX_SETS;
+
     for (int i = 0; i < pic->i_planes; i++) {
         struct pl_plane *plane = &img.planes[i];
-        if (!pl_upload_plane(gpu, plane, &sys->plane_tex[i], &data[i])) {
+        if (!pl_upload_plane(gpu, plane, &plane_tex[i], &data[i])) {
             msg_Err(vd, "Failed uploading image data!");
             failed = true;
             goto done;
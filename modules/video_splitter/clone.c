@@ -180,15 +180,20 @@ static void Close( vlc_object_t *p_this )
 static int Filter( video_splitter_t *p_splitter,
                    picture_t *pp_dst[], picture_t *p_src )
 {
-    if( video_splitter_NewPicture( p_splitter, pp_dst ) )
+    /* The outputs share the pixels of the source */
+    for( int i = 0; i < p_splitter->i_output; i++ )
     {
-        picture_Release( p_src );
-        return VLC_EGENERIC;
+        pp_dst[i] = picture_Clone( p_src );
+        if( pp_dst[i] == NULL )
+        {
+            for( int j = 0; j < i; j++ )
+                picture_Release( pp_dst[j] );
+            picture_Release( p_src );
+            return VLC_EGENERIC;
+        }
+        picture_CopyProperties( pp_dst[i], p_src );
     }
 
-    for( int i = 0; i < p_splitter->i_output; i++ )
-        picture_Copy( pp_dst[i], p_src );
-
     picture_Release( p_src );
     return VLC_SUCCESS;
 }
@@ -707,12 +707,6 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
 {
     video_splitter_sys_t *p_sys = p_splitter->p_sys;
 
-    if( video_splitter_NewPicture( p_splitter, pp_dst ) )
-    {
-        picture_Release( p_src );
-        return VLC_EGENERIC;
-    }
-
     for( int y = 0; y < p_sys->i_row; y++ )
     {
         for( int x = 0; x < p_sys->i_col; x++ )
@@ -721,8 +715,38 @@ static int Filter( video_splitter_t *p_splitter, picture_t *pp_dst[], picture_t
             if( !p_output->b_active )
                 continue;
 
+            /* Without borders to blend, the output is a part of the source */
+            const panoramix_filter_t *p_filter = &p_output->filter;
+            const bool b_crop =
+                p_filter->black.i_left == 0 && p_filter->black.i_right == 0 &&
+                p_filter->black.i_top == 0 && p_filter->black.i_bottom == 0 &&
+                p_filter->attenuate.i_left == 0 &&
+                p_filter->attenuate.i_right == 0 &&
+                p_filter->attenuate.i_top == 0 &&
+                p_filter->attenuate.i_bottom == 0;
+
             /* */
-            picture_t *p_dst = pp_dst[p_output->i_output];
+            picture_t *p_dst;
+            if( b_crop )
+                p_dst = video_splitter_CropPicture( p_splitter,
+                                                    p_output->i_output, p_src,
+                                                    p_output->i_src_x,
+                                                    p_output->i_src_y );
+            else
+                p_dst = picture_NewFromFormat(
+                            &p_splitter->p_output[p_output->i_output].fmt );
+            if( p_dst == NULL )
+            {
+                /* the outputs are numbered in that order */
+                for( int i = 0; i < p_output->i_output; i++ )
+                    picture_Release( pp_dst[i] );
+                msg_Warn( p_splitter, "can't get output pictures" );
+                picture_Release( p_src );
+                return VLC_EGENERIC;
+            }
+            pp_dst[p_output->i_output] = p_dst;
+            if( b_crop )
+                continue;
 
             /* */
             picture_CopyProperties( p_dst, p_src );
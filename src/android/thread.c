@@ -268,6 +268,11 @@ vlc_tick_t vlc_tick_now (void)
     return vlc_tick_from_timespec( &ts );
 }
 
+vlc_tick_t vlc_tick_to_monotonic(vlc_tick_t tick)
+{
+    return tick;
+}
+
 /* cpu */
 
 unsigned vlc_GetCPUCount(void)
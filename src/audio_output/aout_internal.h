@@ -49,6 +49,7 @@ typedef struct
     aout_filters_t *filters;
     aout_volume_t *volume;
     bool bitexact;
+    bool stuffing; /**< Correct drift by sample stuffing, not resampling */
 
     struct
     {
@@ -70,6 +71,7 @@ typedef struct
         float rate; /**< Play-out speed rate */
         vlc_tick_t resamp_start_drift; /**< Resampler drift absolute value */
         int resamp_type; /**< Resampler mode (FIXME: redundant / resampling) */
+        bool drop_burst; /**< Pass-through too late: drop the next burst */
         bool discontinuity;
         vlc_tick_t request_delay;
         vlc_tick_t delay;
@@ -33,11 +33,15 @@
 
 #include <vlc_common.h>
 #include <vlc_aout.h>
+#include <vlc_tracer.h>
 
 #include "aout_internal.h"
 #include "clock/clock.h"
 #include "libvlc.h"
 
+/* Blocks shorter than this are not stuffed, as one frame would be audible */
+#define AOUT_STUFF_MIN_FRAMES 64
+
 static void aout_Drain(audio_output_t *aout)
 {
     if (aout->drain)
@@ -127,6 +131,7 @@ error:
 
     owner->sync.rate = 1.f;
     owner->sync.resamp_type = AOUT_RESAMPLING_NONE;
+    owner->sync.drop_burst = false;
     owner->sync.discontinuity = true;
     owner->original_pts = VLC_TICK_INVALID;
     owner->sync.delay = owner->sync.request_delay = 0;
@@ -320,6 +325,32 @@ static void aout_DecSynchronize(audio_output_t *aout, vlc_tick_t system_now,
     aout_RequestRetiming(aout, system_now + delay, dec_pts);
 }
 
+/**
+ * Compressed pass-through data cannot be resampled, and cutting it in the
+ * middle of a burst would corrupt it. Drift is corrected by whole bursts
+ * instead: a late output skips the next burst, an early one gets a pause
+ * (IEC 61937 null data) of the drift length.
+ */
+static void aout_PaceBursts(audio_output_t *aout, vlc_tick_t drift,
+                            vlc_tick_t audio_ts)
+{
+    aout_owner_t *owner = aout_owner (aout);
+
+    if (drift > +AOUT_MAX_PTS_DELAY)
+    {
+        if (!owner->sync.drop_burst)
+            msg_Dbg (aout, "pass-through too late (%"PRId64"): "
+                     "dropping a burst", drift);
+        owner->sync.drop_burst = true;
+    }
+    else if (drift < -AOUT_MAX_PTS_ADVANCE)
+    {
+        msg_Dbg (aout, "pass-through too early (%"PRId64"): "
+                 "inserting a pause", drift);
+        aout_DecSilence (aout, -drift, audio_ts);
+    }
+}
+
 void aout_RequestRetiming(audio_output_t *aout, vlc_tick_t system_ts,
                           vlc_tick_t audio_ts)
 {
@@ -373,23 +404,29 @@ void aout_RequestRetiming(audio_output_t *aout, vlc_tick_t system_ts,
         drift = 0;
     }
 
-    if (!aout_FiltersCanResample(owner->filters))
+    const bool stuffing = owner->stuffing
+                       && AOUT_FMT_LINEAR(&owner->mixer_format);
+    if (!stuffing && !aout_FiltersCanResample(owner->filters))
+    {
+        if (!AOUT_FMT_LINEAR(&owner->mixer_format))
+            aout_PaceBursts(aout, drift, audio_ts);
         return;
+    }
 
     /* Resampling */
     if (drift > +AOUT_MAX_PTS_DELAY
      && owner->sync.resamp_type != AOUT_RESAMPLING_UP)
     {
-        msg_Warn (aout, "playback too late (%"PRId64"): up-sampling",
-                  drift);
+        msg_Warn (aout, "playback too late (%"PRId64"): %s", drift,
+                  stuffing ? "dropping samples" : "up-sampling");
         owner->sync.resamp_type = AOUT_RESAMPLING_UP;
         owner->sync.resamp_start_drift = +drift;
     }
     if (drift < -AOUT_MAX_PTS_ADVANCE
      && owner->sync.resamp_type != AOUT_RESAMPLING_DOWN)
     {
-        msg_Warn (aout, "playback too early (%"PRId64"): down-sampling",
-                  drift);
+        msg_Warn (aout, "playback too early (%"PRId64"): %s", drift,
+                  stuffing ? "inserting samples" : "down-sampling");
         owner->sync.resamp_type = AOUT_RESAMPLING_DOWN;
         owner->sync.resamp_start_drift = -drift;
     }
@@ -406,6 +443,17 @@ void aout_RequestRetiming(audio_output_t *aout, vlc_tick_t system_ts,
         return;
     }
 
+    if (stuffing)
+    {   /* aout_DecPlay() stuffs one frame per block until the drift has been
+         * reduced from more than half its initial value. */
+        if (2 * llabs (drift) <= owner->sync.resamp_start_drift)
+        {
+            owner->sync.resamp_type = AOUT_RESAMPLING_NONE;
+            msg_Dbg (aout, "stuffing stopped (drift: %"PRId64" us)", drift);
+        }
+        return;
+    }
+
     /* Resampling has been triggered earlier. This checks if it needs to be
      * increased or decreased. Resampling rate changes must be kept slow for
      * the comfort of listeners. */
@@ -423,6 +471,87 @@ void aout_RequestRetiming(audio_output_t *aout, vlc_tick_t system_ts,
     }
 }
 
+/* Returns the frame with the lowest level, closest to a zero crossing on
+ * all channels */
+static size_t aout_QuietestFrame(const audio_sample_format_t *fmt,
+                                 const void *buf, size_t frames)
+{
+    const unsigned channels = fmt->i_channels;
+    float min = INFINITY;
+    size_t best = frames / 2;
+
+#define QUIETEST(type, magnitude) \
+    { \
+        const type *p = buf; \
+        for (size_t i = 0; i < frames; i++) \
+        { \
+            float level = 0.f; \
+            for (unsigned c = 0; c < channels; c++, p++) \
+                level += magnitude; \
+            if (level < min) \
+            { \
+                min = level; \
+                best = i; \
+            } \
+        } \
+        break; \
+    }
+
+    switch (fmt->i_format)
+    {
+        case VLC_CODEC_FL32:
+            QUIETEST(float, fabsf(*p))
+        case VLC_CODEC_FL64:
+            QUIETEST(double, fabs(*p))
+        case VLC_CODEC_S32N:
+            QUIETEST(int32_t, fabsf((float)*p))
+        case VLC_CODEC_S16N:
+            QUIETEST(int16_t, abs(*p))
+        case VLC_CODEC_U8:
+            QUIETEST(uint8_t, abs(*p - 128))
+    }
+#undef QUIETEST
+    return best;
+}
+
+/**
+ * Drops (when late) or duplicates (when early) the quietest frame of the
+ * block, so that drift is corrected by one frame without resampling.
+ */
+static block_t *aout_DecStuff(audio_output_t *aout, block_t *block)
+{
+    aout_owner_t *owner = aout_owner (aout);
+    const audio_sample_format_t *fmt = &owner->mixer_format;
+    const size_t frame_size = fmt->i_bytes_per_frame;
+
+    if (block->i_nb_samples < AOUT_STUFF_MIN_FRAMES)
+        return block;
+
+    size_t pos = aout_QuietestFrame(fmt, block->p_buffer,
+                                    block->i_nb_samples) * frame_size;
+
+    if (owner->sync.resamp_type == AOUT_RESAMPLING_UP)
+    {
+        memmove(block->p_buffer + pos, block->p_buffer + pos + frame_size,
+                block->i_buffer - pos - frame_size);
+        block->i_buffer -= frame_size;
+        block->i_nb_samples--;
+    }
+    else
+    {
+        size_t size = block->i_buffer;
+
+        block = block_Realloc(block, 0, size + frame_size);
+        if (unlikely(block == NULL))
+            return NULL;
+        memmove(block->p_buffer + pos + frame_size, block->p_buffer + pos,
+                size - pos);
+        block->i_nb_samples++;
+    }
+    block->i_length = vlc_tick_from_samples(block->i_nb_samples, fmt->i_rate);
+    return block;
+}
+
 /*****************************************************************************
  * aout_DecPlay : filter & mix the decoded buffer
  *****************************************************************************/
@@ -472,8 +601,28 @@ int aout_DecPlay(audio_output_t *aout, block_t *block)
     const vlc_tick_t original_pts = owner->original_pts;
     owner->original_pts = VLC_TICK_INVALID;
 
+    /* Compressed bursts are played as they come out of the converter: there
+     * is nothing to amplify or to meter */
+    const bool passthrough = !AOUT_FMT_LINEAR(&owner->mixer_format);
+    if (passthrough && owner->sync.drop_burst)
+    {
+        owner->sync.drop_burst = false;
+        block_Release (block);
+        atomic_fetch_add_explicit(&owner->buffers_lost, 1, memory_order_relaxed);
+        return ret;
+    }
+
+    if (owner->stuffing && !passthrough
+     && owner->sync.resamp_type != AOUT_RESAMPLING_NONE)
+    {
+        block = aout_DecStuff(aout, block);
+        if (unlikely(block == NULL))
+            return ret;
+    }
+
     /* Software volume */
-    aout_volume_Amplify (owner->volume, block);
+    if (!passthrough)
+        aout_volume_Amplify (owner->volume, block);
 
     /* Update delay */
     if (owner->sync.request_delay != owner->sync.delay)
@@ -501,10 +650,13 @@ int aout_DecPlay(audio_output_t *aout, block_t *block)
 
     }
 
-    vlc_audio_meter_Process(&owner->meter, block, play_date);
+    if (!passthrough)
+        vlc_audio_meter_Process(&owner->meter, block, play_date);
 
     /* Output */
     owner->sync.discontinuity = false;
+    vlc_tracer_Trace(vlc_object_get_tracer(aout), VLC_TRACER_AOUT_PLAY, aout,
+                     block->i_pts, block->i_buffer);
     aout->play(aout, block, play_date);
 
     atomic_fetch_add_explicit(&owner->buffers_played, 1, memory_order_relaxed);
@@ -568,6 +720,7 @@ void aout_DecFlush(audio_output_t *aout)
 
         aout->flush(aout);
         vlc_clock_Reset(owner->sync.clock);
+        owner->sync.drop_burst = false;
         if (owner->filters)
             aout_FiltersResetClock(owner->filters);
 
@@ -23,12 +23,41 @@
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 
 #include <vlc_common.h>
 #include <vlc_modules.h>
 #include <vlc_aout.h>
+#include <vlc_block.h>
 #include "aout_internal.h"
 
+/* Blocks queued for the meter thread, a power of two. Beyond, the blocks are
+ * not measured rather than delaying the playback. */
+#define METER_QUEUE_SIZE 32
+
+/* Meter thread state, only exists while a format is set */
+struct vlc_audio_meter_tap
+{
+    block_spsc_t *queue;
+    vlc_thread_t thread;
+    struct vlc_audio_meter *meter;
+
+    /* Bumped by every flush, to discard the blocks queued before */
+    atomic_uint generation;
+    /* Number of plugins with a filter, nothing is queued if 0 */
+    atomic_uint active;
+    atomic_uint dropped;
+};
+
+/* Copy of a played block, with the data needed by the meter thread */
+struct vlc_audio_meter_block
+{
+    block_t self;
+    vlc_tick_t date;
+    unsigned generation;
+    max_align_t payload[];
+};
+
 struct vlc_audio_meter_plugin
 {
     char *name;
@@ -48,11 +77,152 @@ void
     meter->parent = obj;
     meter->fmt = NULL;
     vlc_list_init(&meter->plugins);
+    meter->tap = NULL;
+}
+
+static void
+vlc_audio_meter_BlockRelease(block_t *block)
+{
+    free(container_of(block, struct vlc_audio_meter_block, self));
+}
+
+static const struct vlc_block_callbacks vlc_audio_meter_block_cbs = {
+    vlc_audio_meter_BlockRelease,
+};
+
+static block_t *
+vlc_audio_meter_CopyBlock(const block_t *block, vlc_tick_t date,
+                          unsigned generation)
+{
+    struct vlc_audio_meter_block *copy =
+        malloc(sizeof (*copy) + block->i_buffer);
+    if (unlikely(copy == NULL))
+        return NULL;
+
+    block_t *b = block_Init(&copy->self, &vlc_audio_meter_block_cbs,
+                            copy->payload, block->i_buffer);
+    memcpy(b->p_buffer, block->p_buffer, block->i_buffer);
+    b->i_flags = block->i_flags;
+    b->i_nb_samples = block->i_nb_samples;
+    b->i_pts = block->i_pts;
+    b->i_dts = block->i_dts;
+    b->i_length = block->i_length;
+    copy->date = date;
+    copy->generation = generation;
+    return b;
+}
+
+static void *
+vlc_audio_meter_Thread(void *data)
+{
+    struct vlc_audio_meter_tap *tap = data;
+    struct vlc_audio_meter *meter = tap->meter;
+    block_t *block;
+
+    while ((block = block_SpscGet(tap->queue)) != NULL)
+    {
+        struct vlc_audio_meter_block *copy =
+            container_of(block, struct vlc_audio_meter_block, self);
+
+        vlc_mutex_lock(&meter->lock);
+        if (copy->generation == atomic_load(&tap->generation))
+        {
+            vlc_audio_meter_plugin *plugin;
+            vlc_list_foreach(plugin, &meter->plugins, node)
+            {
+                filter_t *filter = plugin->filter;
+
+                if (filter != NULL)
+                {
+                    plugin->last_date = copy->date + block->i_length;
+
+                    block_t *same_block = filter->ops->filter_audio(filter, block);
+                    assert(same_block == block); (void) same_block;
+                }
+            }
+        }
+        vlc_mutex_unlock(&meter->lock);
+        block_Release(block);
+    }
+    return NULL;
+}
+
+/* Called with the lock held */
+static void
+vlc_audio_meter_UpdateActive(struct vlc_audio_meter *meter)
+{
+    if (meter->tap == NULL)
+        return;
+
+    unsigned active = 0;
+    vlc_audio_meter_plugin *plugin;
+    vlc_list_foreach(plugin, &meter->plugins, node)
+        if (plugin->filter != NULL)
+            active++;
+    atomic_store(&meter->tap->active, active);
+}
+
+static void
+vlc_audio_meter_StartTap(struct vlc_audio_meter *meter)
+{
+    struct vlc_audio_meter_tap *tap = malloc(sizeof (*tap));
+    if (unlikely(tap == NULL))
+        return;
+
+    tap->queue = block_SpscNew(METER_QUEUE_SIZE);
+    if (unlikely(tap->queue == NULL))
+    {
+        free(tap);
+        return;
+    }
+    tap->meter = meter;
+    atomic_init(&tap->generation, 0);
+    atomic_init(&tap->active, 0);
+    atomic_init(&tap->dropped, 0);
+
+    if (vlc_clone(&tap->thread, vlc_audio_meter_Thread, tap,
+                  VLC_THREAD_PRIORITY_LOW) != 0)
+    {
+        block_SpscRelease(tap->queue);
+        free(tap);
+        return;
+    }
+
+    vlc_mutex_lock(&meter->lock);
+    meter->tap = tap;
+    vlc_audio_meter_UpdateActive(meter);
+    vlc_mutex_unlock(&meter->lock);
+}
+
+static void
+vlc_audio_meter_StopTap(struct vlc_audio_meter *meter)
+{
+    struct vlc_audio_meter_tap *tap = meter->tap;
+    if (tap == NULL)
+        return;
+
+    vlc_mutex_lock(&meter->lock);
+    meter->tap = NULL;
+    /* Discard the pending blocks, they are for the previous format */
+    atomic_fetch_add(&tap->generation, 1);
+    vlc_mutex_unlock(&meter->lock);
+
+    block_SpscKill(tap->queue);
+    vlc_join(tap->thread, NULL);
+
+    unsigned dropped = atomic_load(&tap->dropped);
+    if (dropped > 0)
+        msg_Dbg(meter->parent, "%u blocks were not measured", dropped);
+
+    block_SpscRelease(tap->queue);
+    free(tap);
 }
 
 void
 vlc_audio_meter_Destroy(struct vlc_audio_meter *meter)
 {
+    vlc_audio_meter_StopTap(meter);
+
     vlc_audio_meter_plugin *plugin;
     vlc_list_foreach(plugin, &meter->plugins, node)
         vlc_audio_meter_RemovePlugin(meter, plugin);
@@ -114,6 +284,7 @@ vlc_audio_meter_AddPlugin(struct vlc_audio_meter *meter, const char *chain,
 
     vlc_mutex_lock(&meter->lock);
     vlc_list_append(&plugin->node, &meter->plugins);
+    vlc_audio_meter_UpdateActive(meter);
     vlc_mutex_unlock(&meter->lock);
 
     return plugin;
@@ -144,6 +315,7 @@ vlc_audio_meter_RemovePlugin(struct vlc_audio_meter *meter, vlc_audio_meter_plug
 
     vlc_list_remove(&plugin->node);
     free(plugin);
+    vlc_audio_meter_UpdateActive(meter);
 
     vlc_mutex_unlock(&meter->lock);
 }
@@ -153,6 +325,8 @@ vlc_audio_meter_Reset(struct vlc_audio_meter *meter, const audio_sample_format_t
 {
     int ret = VLC_SUCCESS;
 
+    vlc_audio_meter_StopTap(meter);
+
     meter->fmt = fmt;
 
     vlc_mutex_lock(&meter->lock);
@@ -183,29 +357,33 @@ vlc_audio_meter_Reset(struct vlc_audio_meter *meter, const audio_sample_format_t
 
     vlc_mutex_unlock(&meter->lock);
 
+    if (meter->fmt != NULL)
+        vlc_audio_meter_StartTap(meter);
+
     return ret;
 }
 
 void
 vlc_audio_meter_Process(struct vlc_audio_meter *meter, block_t *block, vlc_tick_t date)
 {
-    vlc_mutex_lock(&meter->lock);
+    struct vlc_audio_meter_tap *tap = meter->tap;
 
-    vlc_audio_meter_plugin *plugin;
-    vlc_list_foreach(plugin, &meter->plugins, node)
-    {
-        filter_t *filter = plugin->filter;
-
-        if (filter != NULL)
-        {
-            plugin->last_date = date + block->i_length;
+    if (tap == NULL || atomic_load_explicit(&tap->active,
+                                            memory_order_relaxed) == 0)
+        return;
 
-            block_t *same_block = filter->ops->filter_audio(filter, block);
-            assert(same_block == block); (void) same_block;
-        }
+    /* Only this thread queues blocks, so that the count can only be lower
+     * than read, and block_SpscPut() cannot wait */
+    if (block_SpscGetCount(tap->queue) >= METER_QUEUE_SIZE)
+    {
+        atomic_fetch_add_explicit(&tap->dropped, 1, memory_order_relaxed);
+        return;
     }
 
-    vlc_mutex_unlock(&meter->lock);
+    block_t *copy = vlc_audio_meter_CopyBlock(block, date,
+                                              atomic_load(&tap->generation));
+    if (likely(copy != NULL))
+        block_SpscPut(tap->queue, copy);
 }
 
 void
@@ -213,6 +391,9 @@ vlc_audio_meter_Flush(struct vlc_audio_meter *meter)
 {
     vlc_mutex_lock(&meter->lock);
 
+    if (meter->tap != NULL)
+        atomic_fetch_add(&meter->tap->generation, 1);
+
     vlc_audio_meter_plugin *plugin;
     vlc_list_foreach(plugin, &meter->plugins, node)
     {
@@ -342,6 +342,10 @@ audio_output_t *aout_New (vlc_object_t *parent)
 
     owner->bitexact = var_InheritBool (aout, "audio-bitexact");
 
+    char *drift = var_InheritString (aout, "audio-drift-correction");
+    owner->stuffing = drift != NULL && !strcmp (drift, "stuffing");
+    free (drift);
+
     return aout;
 }
 
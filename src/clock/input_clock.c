@@ -121,6 +121,7 @@ struct input_clock_t
         vlc_tick_t  pi_value[INPUT_CLOCK_LATE_COUNT];
         unsigned i_index;
     } late;
+    vlc_tick_t i_margin;
 
     /* Reference point */
     clock_point_t ref;
@@ -165,6 +166,7 @@ input_clock_t *input_clock_New( float rate )
     cl->late.i_index = 0;
     for( int i = 0; i < INPUT_CLOCK_LATE_COUNT; i++ )
         cl->late.pi_value[i] = 0;
+    cl->i_margin = 0;
 
     cl->rate = rate;
     cl->i_pts_delay = 0;
@@ -264,7 +266,8 @@ vlc_tick_t input_clock_Update( input_clock_t *cl, vlc_object_t *p_log,
     /* It does not take the decoder latency into account but it is not really
      * the goal of the clock here */
     const vlc_tick_t i_system_expected = ClockStreamToSystem( cl, i_ck_stream + AvgGet( &cl->drift ) );
-    const vlc_tick_t i_late = __MAX(0, ( i_ck_system - cl->i_pts_delay ) - i_system_expected);
+    cl->i_margin = i_system_expected - ( i_ck_system - cl->i_pts_delay );
+    const vlc_tick_t i_late = __MAX(0, -cl->i_margin);
     if( i_late > 0 )
     {
         cl->late.pi_value[cl->late.i_index] = i_late;
@@ -442,6 +445,11 @@ vlc_tick_t input_clock_GetJitter( input_clock_t *cl )
     return i_pts_delay + i_late_median;
 }
 
+vlc_tick_t input_clock_GetMargin( input_clock_t *cl )
+{
+    return cl->i_margin;
+}
+
 /*****************************************************************************
  * ClockStreamToSystem: converts a movie clock to system date
  *****************************************************************************/
@@ -117,4 +117,11 @@ void input_clock_SetJitter( input_clock_t *,
  */
 vlc_tick_t input_clock_GetJitter( input_clock_t * );
 
+/**
+ * This function returns how early the last clock reference was received,
+ * with respect to the date it is due (including the pts_delay). It is
+ * negative if it was late.
+ */
+vlc_tick_t input_clock_GetMargin( input_clock_t * );
+
 #endif
@@ -32,6 +32,7 @@
 #include <vlc_url.h>
 #include <vlc_modules.h>
 #include <vlc_interrupt.h>
+#include <vlc_tracer.h>
 
 #include <libvlc.h>
 #include "stream.h"
@@ -237,6 +238,9 @@ static block_t *AStreamReadBlock(stream_t *s, bool *restrict eof)
             priv->input ? input_priv(priv->input)->stats : NULL;
         if (stats != NULL)
             input_rate_Add(&stats->input_bitrate, block->i_buffer);
+
+        vlc_tracer_Trace(vlc_object_get_tracer(s), VLC_TRACER_ACCESS_READ,
+                         access, block->i_pts, block->i_buffer);
     }
 
     return block;
@@ -261,6 +265,9 @@ static ssize_t AStreamReadStream(stream_t *s, void *buf, size_t len)
             priv->input ? input_priv(priv->input)->stats : NULL;
         if (stats != NULL)
             input_rate_Add(&stats->input_bitrate, val);
+
+        vlc_tracer_Trace(vlc_object_get_tracer(s), VLC_TRACER_ACCESS_READ,
+                         access, VLC_TICK_INVALID, val);
     }
 
     return val;
@@ -43,6 +43,7 @@
 #include <vlc_modules.h>
 #include <vlc_decoder.h>
 #include <vlc_picture_pool.h>
+#include <vlc_tracer.h>
 
 #include "audio_output/aout_internal.h"
 #include "stream_output/stream_output.h"
@@ -72,6 +73,10 @@ struct vlc_input_decoder_t
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_userdata;
 
+    bool b_thumbnailing;
+    /* Receiver of the decoded frames, instead of the outputs */
+    const struct vlc_decoder_sink *sink;
+
     ssize_t          i_spu_channel;
     int64_t          i_spu_order;
 
@@ -84,9 +89,26 @@ struct vlc_input_decoder_t
     decoder_t *p_packetizer;
     bool b_packetizer;
 
+    /* Optional decoding stage fed by the DecoderThread, cf.
+     * DecoderThread_Decode(). Only the DecoderThread packetizes, and the
+     * decoder module is only used by the decoding stage, or by the
+     * DecoderThread while the decoding stage is idle. */
+    struct
+    {
+        block_fifo_t *fifo; /* NULL if disabled */
+        vlc_thread_t thread;
+        vlc_cond_t   wait; /* dequeued or decoded */
+        es_format_t  fmt; /* packetizer output format the decoder uses */
+        bool busy;
+        bool flushing;
+        bool aborting;
+    } pipeline;
+
     /* Current format in use by the output */
     es_format_t    fmt;
     vlc_video_context *vctx;
+    /* Decoder device of the thumbnailer, which has no vout */
+    vlc_decoder_device *thumbnail_device;
 
     /* */
     atomic_bool    b_fmt_description;
@@ -104,6 +126,8 @@ struct vlc_input_decoder_t
 
     /* pool to use when the decoder doesn't use its own */
     struct picture_pool_t *out_pool;
+    /* surfaces allocated by the decoder itself, cf. decoder_UpdateVideoMemory() */
+    atomic_ptrdiff_t video_memory;
 
     /*
      * 3 threads can read/write these output variables, the DecoderThread, the
@@ -130,6 +154,8 @@ struct vlc_input_decoder_t
     vout_thread_t   *p_vout;
     bool             vout_started;
     enum vlc_vout_order vout_order;
+    /* No vout was found for the last subpicture (ModuleThread only) */
+    bool             spu_vout_missing;
 
     /* -- Theses variables need locking on read *and* write -- */
     /* Preroll */
@@ -146,6 +172,10 @@ struct vlc_input_decoder_t
     unsigned frames_countdown;
     bool paused;
 
+    /* Trick play */
+    atomic_bool keyframes_only;
+    bool keyframe_wait;
+
     bool error;
 
     /* Waiting */
@@ -177,12 +207,17 @@ struct vlc_input_decoder_t
     void           *mouse_opaque;
 };
 
+/* From this rate, only the video keyframes are decoded */
+#define DECODER_KEYFRAMES_RATE 4.f
+
 /* Pictures which are DECODER_BOGUS_VIDEO_DELAY or more in advance probably have
  * a bogus PTS and won't be displayed */
 #define DECODER_BOGUS_VIDEO_DELAY                ((vlc_tick_t)(DEFAULT_PTS_DELAY * 30))
 
 /* */
 #define DECODER_SPU_VOUT_WAIT_DURATION   VLC_TICK_FROM_MS(200)
+/* Packetized blocks queued to the decoding stage */
+#define DECODER_PIPELINE_SIZE 8
 #define BLOCK_FLAG_CORE_PRIVATE_RELOADED (1 << BLOCK_FLAG_CORE_PRIVATE_SHIFT)
 
 #define decoder_Notify(decoder_priv, event, ...) \
@@ -208,6 +243,8 @@ static int LoadDecoder( decoder_t *p_dec, bool b_packetizer,
     /* Find a suitable decoder/packetizer module */
     if( !b_packetizer )
     {
+        p_dec->b_thumbnailing = dec_get_owner( p_dec )->b_thumbnailing;
+
         static const char caps[ES_CATEGORY_COUNT][16] = {
             [VIDEO_ES] = "video decoder",
             [AUDIO_ES] = "audio decoder",
@@ -651,7 +688,11 @@ static subpicture_t *ModuleThread_NewSpuBuffer( decoder_t *p_dec,
     vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
     vout_thread_t *p_vout = NULL;
     subpicture_t *p_subpic;
-    int i_attempts = 30;
+    /* Only wait for a vout to show up for the first subpicture: when nothing
+     * displays the subtitles, the decoder must not be stalled for each of
+     * them, nor render them */
+    const bool b_wait = !p_owner->spu_vout_missing;
+    int i_attempts = b_wait ? 30 : 1;
 
     while( i_attempts-- )
     {
@@ -662,12 +703,15 @@ static subpicture_t *ModuleThread_NewSpuBuffer( decoder_t *p_dec,
         if( p_vout )
             break;
 
-        vlc_tick_sleep( DECODER_SPU_VOUT_WAIT_DURATION );
+        if( i_attempts > 0 )
+            vlc_tick_sleep( DECODER_SPU_VOUT_WAIT_DURATION );
     }
 
+    p_owner->spu_vout_missing = p_vout == NULL;
     if( !p_vout )
     {
-        msg_Warn( p_dec, "no vout found, dropping subpicture" );
+        if( b_wait )
+            msg_Warn( p_dec, "no vout found, dropping subpicture" );
         if( p_owner->p_vout )
         {
             assert(p_owner->i_spu_channel != VOUT_SPU_CHANNEL_INVALID);
@@ -782,6 +826,15 @@ static float ModuleThread_GetDisplayRate( decoder_t *p_dec )
     return rate;
 }
 
+static void ModuleThread_UpdateVideoMemory( decoder_t *p_dec, ptrdiff_t size )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    atomic_fetch_add_explicit( &p_owner->video_memory, size,
+                               memory_order_relaxed );
+    decoder_Notify(p_owner, on_new_video_memory, size);
+}
+
 /*****************************************************************************
  * Public functions
  *****************************************************************************/
@@ -1094,6 +1147,8 @@ static int ModuleThread_PlayVideo( vlc_input_decoder_t *p_owner, picture_t *p_pi
         /* Ensure no earlier higher pts breaks still state */
         vout_Flush( p_vout, p_picture->date );
     }
+    vlc_tracer_Trace( vlc_object_get_tracer( p_dec ), VLC_TRACER_DECODER_OUT,
+                      p_owner, p_picture->date, 0 );
     vout_PutPicture( p_vout, p_picture );
 
     return VLC_SUCCESS;
@@ -1126,11 +1181,33 @@ static void ModuleThread_QueueVideo( decoder_t *p_dec, picture_t *p_pic )
 
 static vlc_decoder_device * thumbnailer_get_device( decoder_t *p_dec )
 {
-    VLC_UNUSED(p_dec);
-    // no hardware decoder on purpose
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    // no hardware decoder by default
     // we don't want to load many DLLs and allocate many pictures
     // just to decode one picture
-    return NULL;
+    if( !var_InheritBool( p_dec, "hw-dec" ) ||
+        !var_InheritBool( p_dec, "thumbnail-hw-dec" ) )
+        return NULL;
+
+    if( p_owner->thumbnail_device == NULL )
+        p_owner->thumbnail_device =
+            vlc_decoder_device_Create( VLC_OBJECT(p_dec), NULL );
+    if( p_owner->thumbnail_device == NULL )
+        return NULL;
+    return vlc_decoder_device_Hold( p_owner->thumbnail_device );
+}
+
+static int thumbnailer_update_format( decoder_t *p_dec, vlc_video_context *vctx )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    /* Keep the video context of the hardware pictures alive, their
+     * conversion is left to the receiver of the thumbnail */
+    if( p_owner->vctx )
+        vlc_video_context_Release( p_owner->vctx );
+    p_owner->vctx = vctx ? vlc_video_context_Hold( vctx ) : NULL;
+    return 0;
 }
 
 static picture_t *thumbnailer_buffer_new( decoder_t *p_dec )
@@ -1164,6 +1241,98 @@ static void ModuleThread_QueueThumbnail( decoder_t *p_dec, picture_t *p_pic )
 
 }
 
+static vlc_decoder_device * sink_get_device( decoder_t *p_dec )
+{
+    /* The sink reads the pixels: decode in main memory */
+    (void) p_dec;
+    return NULL;
+}
+
+static int sink_update_video_format( decoder_t *p_dec, vlc_video_context *vctx )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    if( p_owner->vctx )
+        vlc_video_context_Release( p_owner->vctx );
+    p_owner->vctx = vctx ? vlc_video_context_Hold( vctx ) : NULL;
+
+    vlc_mutex_lock( &p_owner->lock );
+    DecoderUpdateFormatLocked( p_owner );
+    vlc_mutex_unlock( &p_owner->lock );
+    return 0;
+}
+
+static picture_t *sink_buffer_new( decoder_t *p_dec )
+{
+    return picture_NewFromFormat( &p_dec->fmt_out.video );
+}
+
+static int sink_update_audio_format( decoder_t *p_dec )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+
+    p_dec->fmt_out.audio.i_format = p_dec->fmt_out.i_codec;
+    aout_FormatPrepare( &p_dec->fmt_out.audio );
+
+    vlc_mutex_lock( &p_owner->lock );
+    DecoderUpdateFormatLocked( p_owner );
+    vlc_mutex_unlock( &p_owner->lock );
+    return 0;
+}
+
+/* Handles the preroll and the buffering of the input as the outputs would,
+ * returns false if the frame must be dropped */
+static bool ModuleThread_SinkAccept( vlc_input_decoder_t *p_owner,
+                                     vlc_tick_t date )
+{
+    if( date == VLC_TICK_INVALID )
+    {
+        msg_Warn( &p_owner->dec, "non-dated buffer received" );
+        return false;
+    }
+
+    vlc_mutex_lock( &p_owner->lock );
+    if( p_owner->i_preroll_end != PREROLL_NONE && p_owner->i_preroll_end > date )
+    {
+        vlc_mutex_unlock( &p_owner->lock );
+        return false;
+    }
+    p_owner->i_preroll_end = PREROLL_NONE;
+
+    if( p_owner->b_waiting )
+    {
+        p_owner->b_has_data = true;
+        vlc_cond_signal( &p_owner->wait_acknowledge );
+    }
+    DecoderWaitUnblock( p_owner );
+    p_owner->b_first = false;
+    vlc_mutex_unlock( &p_owner->lock );
+    return true;
+}
+
+static void ModuleThread_QueueSinkVideo( decoder_t *p_dec, picture_t *p_pic )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+    const bool accepted = ModuleThread_SinkAccept( p_owner, p_pic->date );
+
+    if( accepted && p_owner->sink->on_picture != NULL )
+        p_owner->sink->on_picture( p_owner->sink->opaque, p_pic );
+    picture_Release( p_pic );
+    decoder_Notify( p_owner, on_new_video_stats, 1, !accepted, accepted, 0 );
+}
+
+static void ModuleThread_QueueSinkAudio( decoder_t *p_dec, block_t *p_block )
+{
+    vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+    const bool accepted = ModuleThread_SinkAccept( p_owner, p_block->i_pts );
+
+    if( accepted && p_owner->sink->on_audio != NULL )
+        p_owner->sink->on_audio( p_owner->sink->opaque, &p_dec->fmt_out.audio,
+                                 p_block );
+    block_Release( p_block );
+    decoder_Notify( p_owner, on_new_audio_stats, 1, !accepted, accepted );
+}
+
 static int ModuleThread_PlayAudio( vlc_input_decoder_t *p_owner, block_t *p_audio )
 {
     decoder_t *p_dec = &p_owner->dec;
@@ -1219,6 +1388,8 @@ static int ModuleThread_PlayAudio( vlc_input_decoder_t *p_owner, block_t *p_audi
         return VLC_EGENERIC;
     }
 
+    vlc_tracer_Trace( vlc_object_get_tracer( p_dec ), VLC_TRACER_DECODER_OUT,
+                      p_owner, p_audio->i_pts, p_audio->i_buffer );
     int status = aout_DecPlay( p_aout, p_audio );
     if( status == AOUT_DEC_CHANGED )
     {
@@ -1317,10 +1488,43 @@ static void ModuleThread_QueueSpu( decoder_t *p_dec, subpicture_t *p_spu )
 }
 
 static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p_block );
+static void DecoderThread_DecodePacketized( vlc_input_decoder_t *p_owner, block_t *p_block );
+/* At high rates, most of the pictures would be dropped by the vout: only
+ * decode the keyframes, then wait for the next one when going back to a
+ * normal rate, since the references of the following frames are missing */
+static bool DecoderThread_SkipFrame( vlc_input_decoder_t *p_owner,
+                                     const block_t *p_block )
+{
+    if( p_owner->dec.fmt_in.i_cat != VIDEO_ES
+     || !( p_block->i_flags & BLOCK_FLAG_TYPE_MASK ) )
+        return false;
+
+    if( p_block->i_flags & BLOCK_FLAG_TYPE_I )
+    {
+        p_owner->keyframe_wait = false;
+        return false;
+    }
+
+    if( atomic_load_explicit( &p_owner->keyframes_only, memory_order_relaxed ) )
+        p_owner->keyframe_wait = true;
+    return p_owner->keyframe_wait;
+}
+
 static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, block_t *p_block )
 {
     decoder_t *p_dec = &p_owner->dec;
 
+    if( p_block != NULL && DecoderThread_SkipFrame( p_owner, p_block ) )
+    {
+        block_Release( p_block );
+        return;
+    }
+
+    if( p_block != NULL )
+        vlc_tracer_Trace( vlc_object_get_tracer( p_dec ),
+                          VLC_TRACER_DECODER_IN, p_owner, p_block->i_pts,
+                          p_block->i_buffer );
+
     int ret = p_dec->pf_decode( p_dec, p_block );
     switch( ret )
     {
@@ -1336,7 +1540,10 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, block_t *p_
             if( !( p_block->i_flags & BLOCK_FLAG_CORE_PRIVATE_RELOADED ) )
             {
                 p_block->i_flags |= BLOCK_FLAG_CORE_PRIVATE_RELOADED;
-                DecoderThread_ProcessInput( p_owner, p_block );
+                if( p_owner->pipeline.fifo != NULL )
+                    DecoderThread_DecodePacketized( p_owner, p_block );
+                else
+                    DecoderThread_ProcessInput( p_owner, p_block );
             }
             else /* We prefer loosing this block than an infinite recursion */
                 block_Release( p_block );
@@ -1346,18 +1553,12 @@ static void DecoderThread_DecodeBlock( vlc_input_decoder_t *p_owner, block_t *p_
     }
 }
 
-/**
- * Decode a block
- *
- * \param p_dec the decoder object
- * \param p_block the block to decode
- */
-static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p_block )
+static bool DecoderThread_CheckReload( vlc_input_decoder_t *p_owner )
 {
     decoder_t *p_dec = &p_owner->dec;
 
     if( p_owner->error )
-        goto error;
+        return false;
 
     /* Here, the atomic doesn't prevent to miss a reload request.
      * DecoderThread_ProcessInput() can still be called after the decoder module or the
@@ -1370,10 +1571,187 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p
                   reload == RELOAD_DECODER_AOUT ? " and the audio output" : "" );
 
         if( DecoderThread_Reload( p_owner, &p_dec->fmt_in, reload ) != VLC_SUCCESS )
-            goto error;
+            return false;
+    }
+    return true;
+}
+
+static void DecoderThread_DecodePacketized( vlc_input_decoder_t *p_owner, block_t *p_block )
+{
+    if( !DecoderThread_CheckReload( p_owner ) )
+    {
+        if( p_block )
+            block_Release( p_block );
+        return;
+    }
+    DecoderThread_DecodeBlock( p_owner, p_block );
+}
+
+/**
+ * The decoding stage loop
+ *
+ * Decodes the blocks packetized by the DecoderThread.
+ */
+static void *DecoderThread_Decode( void *p_data )
+{
+    vlc_input_decoder_t *p_owner = (vlc_input_decoder_t *)p_data;
+    block_fifo_t *p_fifo = p_owner->pipeline.fifo;
+
+    vlc_fifo_Lock( p_fifo );
+    for( ;; )
+    {
+        block_t *p_block = vlc_fifo_DequeueUnlocked( p_fifo );
+        if( p_block == NULL )
+        {
+            if( p_owner->pipeline.aborting )
+                break;
+            vlc_fifo_Wait( p_fifo );
+            continue;
+        }
+
+        if( p_owner->pipeline.flushing )
+        {
+            block_Release( p_block );
+            vlc_cond_signal( &p_owner->pipeline.wait );
+            continue;
+        }
+
+        p_owner->pipeline.busy = true;
+        vlc_cond_signal( &p_owner->pipeline.wait );
+        vlc_fifo_Unlock( p_fifo );
+
+        DecoderThread_DecodePacketized( p_owner, p_block );
+
+        vlc_fifo_Lock( p_fifo );
+        p_owner->pipeline.busy = false;
+        vlc_cond_signal( &p_owner->pipeline.wait );
+    }
+    vlc_fifo_Unlock( p_fifo );
+    return NULL;
+}
+
+static void DecoderThread_QueueDecode( vlc_input_decoder_t *p_owner, block_t *p_block )
+{
+    block_fifo_t *p_fifo = p_owner->pipeline.fifo;
+
+    vlc_fifo_Lock( p_fifo );
+    while( vlc_fifo_GetCount( p_fifo ) >= DECODER_PIPELINE_SIZE
+        && !p_owner->pipeline.flushing )
+        vlc_fifo_WaitCond( p_fifo, &p_owner->pipeline.wait );
+
+    if( p_owner->pipeline.flushing )
+        block_Release( p_block );
+    else
+        vlc_fifo_QueueUnlocked( p_fifo, p_block );
+    vlc_fifo_Unlock( p_fifo );
+}
+
+/* Waits for the decoding stage to be idle: the DecoderThread can then use
+ * the decoder module */
+static void DecoderThread_WaitDecode( vlc_input_decoder_t *p_owner, bool flush )
+{
+    block_fifo_t *p_fifo = p_owner->pipeline.fifo;
+
+    vlc_fifo_Lock( p_fifo );
+    if( flush )
+        block_ChainRelease( vlc_fifo_DequeueAllUnlocked( p_fifo ) );
+    while( !vlc_fifo_IsEmpty( p_fifo ) || p_owner->pipeline.busy )
+        vlc_fifo_WaitCond( p_fifo, &p_owner->pipeline.wait );
+    if( flush )
+        p_owner->pipeline.flushing = false;
+    vlc_fifo_Unlock( p_fifo );
+}
+
+static void DecoderThread_PacketizeInput( vlc_input_decoder_t *p_owner, block_t *p_block )
+{
+    decoder_t *p_dec = &p_owner->dec;
+    decoder_t *p_packetizer = p_owner->p_packetizer;
+    block_t **pp_block = p_block ? &p_block : NULL;
+    block_t *p_packetized_block;
+
+    if( p_block )
+    {
+        if( p_block->i_buffer <= 0 )
+        {
+            block_Release( p_block );
+            return;
+        }
+
+        vlc_mutex_lock( &p_owner->lock );
+        DecoderUpdatePreroll( &p_owner->i_preroll_end, p_block );
+        vlc_mutex_unlock( &p_owner->lock );
+    }
+
+    while( (p_packetized_block =
+            p_packetizer->pf_packetize( p_packetizer, pp_block ) ) )
+    {
+        if( !es_format_IsSimilar( &p_owner->pipeline.fmt, &p_packetizer->fmt_out ) )
+        {
+            msg_Dbg( p_dec, "restarting module due to input format change");
+
+            /* Drain the decoder module */
+            DecoderThread_WaitDecode( p_owner, false );
+            if( DecoderThread_CheckReload( p_owner ) )
+                DecoderThread_DecodeBlock( p_owner, NULL );
+
+            es_format_Clean( &p_owner->pipeline.fmt );
+            if( es_format_Copy( &p_owner->pipeline.fmt,
+                                &p_packetizer->fmt_out ) != VLC_SUCCESS ||
+                DecoderThread_Reload( p_owner, &p_packetizer->fmt_out,
+                                      RELOAD_DECODER ) != VLC_SUCCESS )
+            {
+                p_owner->error = true;
+                block_ChainRelease( p_packetized_block );
+                return;
+            }
+        }
+
+        if( p_packetizer->pf_get_cc )
+            PacketizerGetCc( p_owner, p_packetizer );
+
+        while( p_packetized_block )
+        {
+            block_t *p_next = p_packetized_block->p_next;
+            p_packetized_block->p_next = NULL;
+
+            vlc_tracer_Trace( vlc_object_get_tracer( p_dec ),
+                              VLC_TRACER_PACKETIZER_OUT, p_owner,
+                              p_packetized_block->i_pts,
+                              p_packetized_block->i_buffer );
+            DecoderThread_QueueDecode( p_owner, p_packetized_block );
+
+            p_packetized_block = p_next;
+        }
+    }
+
+    /* Drain the decoder after the packetizer is drained */
+    if( !pp_block )
+    {
+        DecoderThread_WaitDecode( p_owner, false );
+        DecoderThread_DecodePacketized( p_owner, NULL );
     }
+}
+
+/**
+ * Decode a block
+ *
+ * \param p_dec the decoder object
+ * \param p_block the block to decode
+ */
+static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p_block )
+{
+    decoder_t *p_dec = &p_owner->dec;
 
     bool packetize = p_owner->p_packetizer != NULL;
+    if( packetize && p_owner->pipeline.fifo != NULL )
+    {
+        DecoderThread_PacketizeInput( p_owner, p_block );
+        return;
+    }
+
+    if( !DecoderThread_CheckReload( p_owner ) )
+        goto error;
+
     if( p_block )
     {
         if( p_block->i_buffer <= 0 )
@@ -1428,6 +1806,10 @@ static void DecoderThread_ProcessInput( vlc_input_decoder_t *p_owner, block_t *p
                 block_t *p_next = p_packetized_block->p_next;
                 p_packetized_block->p_next = NULL;
 
+                vlc_tracer_Trace( vlc_object_get_tracer( p_dec ),
+                                  VLC_TRACER_PACKETIZER_OUT, p_owner,
+                                  p_packetized_block->i_pts,
+                                  p_packetized_block->i_buffer );
                 DecoderThread_DecodeBlock( p_owner, p_packetized_block );
                 if( p_owner->error )
                 {
@@ -1456,6 +1838,9 @@ static void DecoderThread_Flush( vlc_input_decoder_t *p_owner )
     decoder_t *p_dec = &p_owner->dec;
     decoder_t *p_packetizer = p_owner->p_packetizer;
 
+    if( p_owner->pipeline.fifo != NULL )
+        DecoderThread_WaitDecode( p_owner, true );
+
     if( p_owner->error )
         return;
 
@@ -1566,6 +1951,10 @@ static void DecoderThread_ChangeRate( vlc_input_decoder_t *p_owner, float rate )
     }
     p_owner->output_rate = rate;
     vlc_mutex_unlock( &p_owner->lock );
+
+    atomic_store_explicit( &p_owner->keyframes_only,
+                           rate >= DECODER_KEYFRAMES_RATE,
+                           memory_order_relaxed );
 }
 
 static void DecoderThread_ChangeDelay( vlc_input_decoder_t *p_owner, vlc_tick_t delay )
@@ -1747,6 +2136,7 @@ static const struct decoder_owner_callbacks dec_video_cbs =
         .queue_cc = ModuleThread_QueueCc,
         .get_display_date = ModuleThread_GetDisplayDate,
         .get_display_rate = ModuleThread_GetDisplayRate,
+        .update_memory = ModuleThread_UpdateVideoMemory,
     },
     .get_attachments = InputThread_GetInputAttachments,
 };
@@ -1754,11 +2144,30 @@ static const struct decoder_owner_callbacks dec_thumbnailer_cbs =
 {
     .video = {
         .get_device = thumbnailer_get_device,
+        .format_update = thumbnailer_update_format,
         .buffer_new = thumbnailer_buffer_new,
         .queue = ModuleThread_QueueThumbnail,
     },
     .get_attachments = InputThread_GetInputAttachments,
 };
+static const struct decoder_owner_callbacks dec_sink_video_cbs =
+{
+    .video = {
+        .get_device = sink_get_device,
+        .format_update = sink_update_video_format,
+        .buffer_new = sink_buffer_new,
+        .queue = ModuleThread_QueueSinkVideo,
+    },
+    .get_attachments = InputThread_GetInputAttachments,
+};
+static const struct decoder_owner_callbacks dec_sink_audio_cbs =
+{
+    .audio = {
+        .format_update = sink_update_audio_format,
+        .queue = ModuleThread_QueueSinkAudio,
+    },
+    .get_attachments = InputThread_GetInputAttachments,
+};
 static const struct decoder_owner_callbacks dec_audio_cbs =
 {
     .audio = {
@@ -1806,14 +2215,20 @@ CreateDecoder( vlc_object_t *p_parent,
     p_owner->p_resource = p_resource;
     p_owner->cbs = cbs;
     p_owner->cbs_userdata = cbs_userdata;
+    p_owner->b_thumbnailing = b_thumbnailing && fmt->i_cat == VIDEO_ES;
+    p_owner->sink = p_sout == NULL && !b_thumbnailing
+                  ? var_InheritAddress( p_dec, "decoder-sink" ) : NULL;
     p_owner->p_aout = NULL;
     p_owner->p_vout = NULL;
+    p_owner->thumbnail_device = NULL;
     p_owner->vout_started = false;
+    p_owner->spu_vout_missing = false;
     p_owner->i_spu_channel = VOUT_SPU_CHANNEL_INVALID;
     p_owner->i_spu_order = 0;
     p_owner->p_sout = p_sout;
     p_owner->p_sout_input = NULL;
     p_owner->p_packetizer = NULL;
+    p_owner->pipeline.fifo = NULL;
 
     atomic_init( &p_owner->b_fmt_description, false );
     p_owner->p_description = NULL;
@@ -1821,6 +2236,8 @@ CreateDecoder( vlc_object_t *p_parent,
     p_owner->reset_out_state = false;
     p_owner->delay = 0;
     p_owner->output_rate = p_owner->request_rate = 1.f;
+    atomic_init( &p_owner->keyframes_only, false );
+    p_owner->keyframe_wait = false;
     p_owner->paused = false;
     p_owner->pause_date = VLC_TICK_INVALID;
     p_owner->frames_countdown = 0;
@@ -1835,6 +2252,7 @@ CreateDecoder( vlc_object_t *p_parent,
     p_owner->b_draining = false;
     p_owner->drained = false;
     atomic_init( &p_owner->reload, RELOAD_NO_REQUEST );
+    atomic_init( &p_owner->video_memory, 0 );
     p_owner->b_idle = false;
 
     p_owner->mouse_event = NULL;
@@ -1879,13 +2297,18 @@ CreateDecoder( vlc_object_t *p_parent,
     switch( fmt->i_cat )
     {
         case VIDEO_ES:
-            if( !b_thumbnailing )
-                p_dec->cbs = &dec_video_cbs;
-            else
+            if( b_thumbnailing )
                 p_dec->cbs = &dec_thumbnailer_cbs;
+            else if( p_owner->sink != NULL )
+                p_dec->cbs = &dec_sink_video_cbs;
+            else
+                p_dec->cbs = &dec_video_cbs;
             break;
         case AUDIO_ES:
-            p_dec->cbs = &dec_audio_cbs;
+            if( p_owner->sink != NULL )
+                p_dec->cbs = &dec_sink_audio_cbs;
+            else
+                p_dec->cbs = &dec_audio_cbs;
             break;
         case SPU_ES:
             p_dec->cbs = &dec_spu_cbs;
@@ -1945,6 +2368,13 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
 
     const enum es_format_category_e i_cat =p_dec->fmt_in.i_cat;
     decoder_Clean( p_dec );
+
+    /* The decoder surfaces may outlive the module, do not account them
+     * anymore */
+    ptrdiff_t video_memory = atomic_load_explicit( &p_owner->video_memory,
+                                                   memory_order_relaxed );
+    if( video_memory != 0 )
+        decoder_Notify(p_owner, on_new_video_memory, -video_memory);
     if ( p_owner->out_pool )
     {
         picture_pool_Release( p_owner->out_pool );
@@ -1953,6 +2383,8 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
 
     if (p_owner->vctx)
         vlc_video_context_Release( p_owner->vctx );
+    if (p_owner->thumbnail_device)
+        vlc_decoder_device_Release( p_owner->thumbnail_device );
 
     /* Free all packets still in the decoder fifo. */
     block_FifoRelease( p_owner->p_fifo );
@@ -2024,6 +2456,55 @@ static void DeleteDecoder( vlc_input_decoder_t *p_owner )
     decoder_Destroy( &p_owner->dec );
 }
 
+static void DecoderPipeline_Start( vlc_input_decoder_t *p_owner, int i_priority )
+{
+    decoder_t *p_dec = &p_owner->dec;
+
+    block_fifo_t *p_fifo = block_FifoNew();
+    if( unlikely(p_fifo == NULL) )
+        return;
+
+    if( es_format_Copy( &p_owner->pipeline.fmt,
+                        &p_owner->p_packetizer->fmt_out ) != VLC_SUCCESS )
+    {
+        block_FifoRelease( p_fifo );
+        return;
+    }
+
+    vlc_cond_init( &p_owner->pipeline.wait );
+    p_owner->pipeline.busy = false;
+    p_owner->pipeline.flushing = false;
+    p_owner->pipeline.aborting = false;
+    p_owner->pipeline.fifo = p_fifo;
+
+    if( vlc_clone( &p_owner->pipeline.thread, DecoderThread_Decode, p_owner,
+                   i_priority ) )
+    {
+        msg_Warn( p_dec, "cannot spawn decoding thread, packetizing inline" );
+        p_owner->pipeline.fifo = NULL;
+        es_format_Clean( &p_owner->pipeline.fmt );
+        block_FifoRelease( p_fifo );
+    }
+}
+
+static void DecoderPipeline_Stop( vlc_input_decoder_t *p_owner )
+{
+    block_fifo_t *p_fifo = p_owner->pipeline.fifo;
+    if( p_fifo == NULL )
+        return;
+
+    vlc_fifo_Lock( p_fifo );
+    p_owner->pipeline.aborting = true;
+    vlc_fifo_Signal( p_fifo );
+    vlc_fifo_Unlock( p_fifo );
+
+    vlc_join( p_owner->pipeline.thread, NULL );
+
+    p_owner->pipeline.fifo = NULL;
+    es_format_Clean( &p_owner->pipeline.fmt );
+    block_FifoRelease( p_fifo );
+}
+
 /* */
 static void DecoderUnsupportedCodec( decoder_t *p_dec, const es_format_t *fmt, bool b_decoding )
 {
@@ -2097,10 +2578,17 @@ decoder_New( vlc_object_t *p_parent, const es_format_t *fmt,
     }
 #endif
 
+    /* Packetize and decode in two threads */
+    if( p_owner->p_packetizer != NULL && p_sout == NULL && !thumbnailing
+     && p_dec->fmt_in.i_cat == VIDEO_ES
+     && var_InheritBool( p_dec, "packetizer-thread" ) )
+        DecoderPipeline_Start( p_owner, i_priority );
+
     /* Spawn the decoder thread */
     if( vlc_clone( &p_owner->thread, DecoderThread, p_owner, i_priority ) )
     {
         msg_Err( p_dec, "cannot spawn decoder thread" );
+        DecoderPipeline_Stop( p_owner );
         DeleteDecoder( p_owner );
         return NULL;
     }
@@ -2156,6 +2644,14 @@ void vlc_input_decoder_Delete( vlc_input_decoder_t *p_owner )
     vlc_fifo_Signal( p_owner->p_fifo );
     vlc_fifo_Unlock( p_owner->p_fifo );
 
+    if( p_owner->pipeline.fifo != NULL )
+    {   /* Drop the packetized blocks and unblock the DecoderThread */
+        vlc_fifo_Lock( p_owner->pipeline.fifo );
+        p_owner->pipeline.flushing = true;
+        vlc_cond_signal( &p_owner->pipeline.wait );
+        vlc_fifo_Unlock( p_owner->pipeline.fifo );
+    }
+
     /* Make sure we aren't waiting/decoding anymore */
     vlc_mutex_lock( &p_owner->lock );
     p_owner->b_waiting = false;
@@ -2193,6 +2689,7 @@ void vlc_input_decoder_Delete( vlc_input_decoder_t *p_owner )
     vlc_mutex_unlock( &p_owner->lock );
 
     vlc_join( p_owner->thread, NULL );
+    DecoderPipeline_Stop( p_owner );
 
     /* */
     if( p_owner->cc.b_supported )
@@ -2254,6 +2751,16 @@ bool vlc_input_decoder_IsEmpty( vlc_input_decoder_t * p_owner )
     }
     vlc_fifo_Unlock( p_owner->p_fifo );
 
+    if( p_owner->pipeline.fifo != NULL )
+    {
+        vlc_fifo_Lock( p_owner->pipeline.fifo );
+        bool b_decoding = !vlc_fifo_IsEmpty( p_owner->pipeline.fifo )
+                       || p_owner->pipeline.busy;
+        vlc_fifo_Unlock( p_owner->pipeline.fifo );
+        if( b_decoding )
+            return false;
+    }
+
     bool b_empty;
 
     vlc_mutex_lock( &p_owner->lock );
@@ -2318,6 +2825,14 @@ void vlc_input_decoder_Flush( vlc_input_decoder_t *p_owner )
 
     vlc_fifo_Unlock( p_owner->p_fifo );
 
+    if( p_owner->pipeline.fifo != NULL )
+    {   /* Reset back from the DecoderThread once the decoder is flushed */
+        vlc_fifo_Lock( p_owner->pipeline.fifo );
+        p_owner->pipeline.flushing = true;
+        vlc_cond_signal( &p_owner->pipeline.wait );
+        vlc_fifo_Unlock( p_owner->pipeline.fifo );
+    }
+
     if ( cat == VIDEO_ES )
     {
         /* Set the pool cancel state. This will unblock the module if it is
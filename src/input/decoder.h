@@ -43,6 +43,8 @@ struct vlc_input_decoder_callbacks {
                                void *userdata);
     void (*on_new_audio_stats)(vlc_input_decoder_t *decoder, unsigned decoded,
                                unsigned lost, unsigned played, void *userdata);
+    void (*on_new_video_memory)(vlc_input_decoder_t *decoder, ptrdiff_t size,
+                                void *userdata);
 
     /* requests */
     int (*get_attachments)(vlc_input_decoder_t *decoder,
@@ -26,6 +26,8 @@
 # include "config.h"
 #endif
 
+#include <assert.h>
+
 #include <vlc_common.h>
 #include <vlc_codec.h>
 #include <vlc_atomic.h>
@@ -38,6 +40,7 @@ void decoder_Init( decoder_t *p_dec, const es_format_t *restrict p_fmt )
 {
     p_dec->i_extra_picture_buffers = 0;
     p_dec->b_frame_drop_allowed = false;
+    p_dec->b_thumbnailing = false;
 
     p_dec->pf_decode = NULL;
     p_dec->pf_get_cc = NULL;
@@ -301,3 +304,36 @@ vlc_decoder_device *vlc_encoder_GetDecoderDevice( encoder_t *enc )
 
     return enc->cbs->video.get_device( enc );
 }
+
+static vlc_mutex_t encoder_threads_lock = VLC_STATIC_MUTEX;
+static unsigned encoder_threads_used = 0;
+
+unsigned vlc_encoder_AcquireThreads( encoder_t *enc, unsigned count )
+{
+    unsigned budget = var_InheritInteger( enc, "sout-encoder-threads" );
+    if( budget == 0 )
+        budget = vlc_GetCPUCount();
+    if( count == 0 || count > budget )
+        count = budget;
+
+    vlc_mutex_lock( &encoder_threads_lock );
+    /* Never starve an encoder: over budget, it still gets one thread */
+    if( encoder_threads_used + count > budget )
+        count = budget > encoder_threads_used
+              ? budget - encoder_threads_used : 1;
+    encoder_threads_used += count;
+    vlc_mutex_unlock( &encoder_threads_lock );
+
+    msg_Dbg( enc, "%u encoding thread(s) granted, %u/%u in use", count,
+             encoder_threads_used, budget );
+    return count;
+}
+
+void vlc_encoder_ReleaseThreads( encoder_t *enc, unsigned count )
+{
+    vlc_mutex_lock( &encoder_threads_lock );
+    assert( encoder_threads_used >= count );
+    encoder_threads_used -= count;
+    vlc_mutex_unlock( &encoder_threads_lock );
+    (void) enc;
+}
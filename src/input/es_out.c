@@ -40,6 +40,7 @@
 #include <vlc_list.h>
 #include <vlc_decoder.h>
 #include <vlc_memstream.h>
+#include <vlc_tracer.h>
 
 #include "input_internal.h"
 #include "../clock/input_clock.h"
@@ -57,6 +58,12 @@
 /* FIXME we should find a better way than including that */
 #include "../text/iso-639_def.h"
 
+/* Adaptive caching: duration over which the jitter is measured, minimal
+ * headroom kept in the buffer, and deviation of the playback rate */
+#define ADAPTIVE_CACHING_WINDOW   VLC_TICK_FROM_SEC(10)
+#define ADAPTIVE_CACHING_HEADROOM VLC_TICK_FROM_MS(50)
+#define ADAPTIVE_CACHING_SLEW     0.03f
+
 /*****************************************************************************
  * Local prototypes
  *****************************************************************************/
@@ -195,6 +202,9 @@ typedef struct
 
     es_out_es_props_t video, audio, sub;
 
+    /* Closed captions: also create the CEA-708 channels */
+    bool        b_cc_708;
+
     /* es/group to select */
     int         i_group_id;
 
@@ -222,6 +232,22 @@ typedef struct
     vlc_tick_t  i_buffering_extra_stream;
     vlc_tick_t  i_buffering_extra_system;
 
+    /* Rate slewing, to change the buffered duration without stalling */
+    float       slew_rate;
+    vlc_tick_t  i_slew_start;
+    vlc_tick_t  i_slew_end; /* VLC_TICK_INVALID if not slewing */
+    vlc_tick_t  i_slew_offset; /* buffered duration gained by slewing */
+
+    /* Fast start: playback starts before the buffer is full, slowed down
+     * until it is */
+    float       fast_start_rate; /* 0 if disabled */
+
+    /* Adaptive caching: the buffered duration follows the measured jitter */
+    bool        b_adaptive_caching;
+    vlc_tick_t  i_adaptive_window_end;
+    vlc_tick_t  i_margin_min;
+    vlc_tick_t  i_margin_max;
+
     /* Record */
     sout_instance_t *p_sout_record;
 
@@ -397,6 +423,27 @@ decoder_on_new_audio_stats(vlc_input_decoder_t *decoder, unsigned decoded, unsig
                               memory_order_relaxed);
 }
 
+static void
+decoder_on_new_video_memory(vlc_input_decoder_t *decoder, ptrdiff_t size,
+                            void *userdata)
+{
+    (void) decoder;
+
+    es_out_id_t *id = userdata;
+    es_out_t *out = id->out;
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    if (!p_sys->p_input)
+        return;
+
+    struct input_stats *stats = input_priv(p_sys->p_input)->stats;
+    if (!stats)
+        return;
+
+    atomic_fetch_add_explicit(&stats->video_memory, size,
+                              memory_order_relaxed);
+}
+
 static int
 decoder_get_attachments(vlc_input_decoder_t *decoder,
                         input_attachment_t ***ppp_attachment,
@@ -420,6 +467,7 @@ static const struct vlc_input_decoder_callbacks decoder_cbs = {
     .on_thumbnail_ready = decoder_on_thumbnail_ready,
     .on_new_video_stats = decoder_on_new_video_stats,
     .on_new_audio_stats = decoder_on_new_audio_stats,
+    .on_new_video_memory = decoder_on_new_video_memory,
     .get_attachments = decoder_get_attachments,
 };
 
@@ -515,6 +563,7 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, input_source_t *main_source,
                     "sub-track-id", "sub-track", "sub-language", "sub" );
 
     p_sys->i_group_id = var_GetInteger( p_input, "program" );
+    p_sys->b_cc_708 = var_InheritInteger( p_input, "captions" ) == 708;
 
     enum vlc_clock_master_source master_source =
         var_InheritInteger( p_input, "clock-master" );
@@ -537,6 +586,19 @@ es_out_t *input_EsOutNew( input_thread_t *p_input, input_source_t *main_source,
     p_sys->i_preroll_end = -1;
     p_sys->i_prev_stream_level = -1;
 
+    p_sys->fast_start_rate = 0.f;
+    if( var_InheritBool( p_input, "fast-start" ) )
+    {
+        float fast_start_rate = var_InheritFloat( p_input, "fast-start-rate" );
+        if( fast_start_rate > 0.f && fast_start_rate < 1.f )
+            p_sys->fast_start_rate = fast_start_rate;
+    }
+    p_sys->i_slew_end = VLC_TICK_INVALID;
+    p_sys->i_slew_offset = 0;
+
+    p_sys->b_adaptive_caching = var_InheritBool( p_input, "adaptive-caching" );
+    p_sys->i_adaptive_window_end = VLC_TICK_INVALID;
+
     return &p_sys->out;
 }
 
@@ -891,11 +953,113 @@ static void EsOutChangeRate( es_out_t *out, float rate )
             vlc_input_decoder_ChangeRate( es->p_dec, rate );
 }
 
+/**
+ * Plays at a rate close to 1 until the buffered duration changed by delta.
+ *
+ * The stream keeps arriving in real time, so the buffered duration changes by
+ * (1 - rate) per second of playback.
+ */
+static void EsOutStartSlewing( es_out_t *out, float rate, vlc_tick_t delta )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    assert( p_sys->i_slew_end == VLC_TICK_INVALID );
+    assert( (rate < 1.f && delta > 0) || (rate > 1.f && delta < 0) );
+
+    p_sys->slew_rate = rate;
+    p_sys->i_slew_start = vlc_tick_now();
+    p_sys->i_slew_end = p_sys->i_slew_start + delta / (1.f - rate);
+
+    msg_Dbg( p_sys->p_input, "changing the buffered duration by %d ms, "
+             "playing at %.2fx", (int)MS_FROM_VLC_TICK(delta), rate );
+    EsOutChangeRate( out, rate );
+}
+
+static vlc_tick_t EsOutGetSlewOffset( es_out_t *out, vlc_tick_t now )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    if( p_sys->i_slew_end == VLC_TICK_INVALID )
+        return p_sys->i_slew_offset;
+
+    const vlc_tick_t elapsed = __MIN( now, p_sys->i_slew_end )
+                             - p_sys->i_slew_start;
+    return p_sys->i_slew_offset + elapsed * (1.f - p_sys->slew_rate);
+}
+
+static void EsOutStopSlewing( es_out_t *out, bool b_restore_rate )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    if( p_sys->i_slew_end == VLC_TICK_INVALID )
+        return;
+
+    p_sys->i_slew_offset = EsOutGetSlewOffset( out, vlc_tick_now() );
+    p_sys->i_slew_end = VLC_TICK_INVALID;
+    /* Measure the jitter again at the new buffered duration */
+    p_sys->i_adaptive_window_end = VLC_TICK_INVALID;
+
+    if( b_restore_rate )
+    {
+        msg_Dbg( p_sys->p_input, "resuming normal rate" );
+        EsOutChangeRate( out, 1.f );
+    }
+}
+
+/**
+ * Adaptive caching controller, run on every clock reference of the main
+ * program of a live input.
+ *
+ * It tracks how early the clock references arrive over a window. If they
+ * never came close to being late, the buffered duration is shrunk, keeping
+ * as much headroom as the observed jitter. If they did, it is grown back
+ * before they get late. Late references still trigger a rebuffering.
+ */
+static void EsOutAdaptCaching( es_out_t *out, input_clock_t *p_clock,
+                               vlc_tick_t now )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+    const vlc_tick_t i_margin = input_clock_GetMargin( p_clock );
+
+    if( p_sys->i_adaptive_window_end == VLC_TICK_INVALID )
+    {
+        p_sys->i_adaptive_window_end = now + ADAPTIVE_CACHING_WINDOW;
+        p_sys->i_margin_min = p_sys->i_margin_max = i_margin;
+        return;
+    }
+
+    p_sys->i_margin_min = __MIN( p_sys->i_margin_min, i_margin );
+    p_sys->i_margin_max = __MAX( p_sys->i_margin_max, i_margin );
+
+    if( now < p_sys->i_adaptive_window_end )
+        return;
+
+    const vlc_tick_t i_jitter = p_sys->i_margin_max - p_sys->i_margin_min;
+    const vlc_tick_t i_headroom = __MAX( i_jitter, ADAPTIVE_CACHING_HEADROOM );
+
+    if( p_sys->i_slew_end == VLC_TICK_INVALID )
+    {
+        if( p_sys->i_margin_min < i_headroom / 2 )
+            EsOutStartSlewing( out, 1.f - ADAPTIVE_CACHING_SLEW,
+                               i_headroom - p_sys->i_margin_min );
+        else if( p_sys->i_margin_min > 2 * i_headroom )
+            /* Shrink by half the excess at most, to converge smoothly */
+            EsOutStartSlewing( out, 1.f + ADAPTIVE_CACHING_SLEW,
+                               (i_headroom - p_sys->i_margin_min) / 2 );
+    }
+
+    p_sys->i_adaptive_window_end = now + ADAPTIVE_CACHING_WINDOW;
+    p_sys->i_margin_min = p_sys->i_margin_max = i_margin;
+}
+
 static void EsOutChangePosition( es_out_t *out, bool b_flush )
 {
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
     es_out_id_t *p_es;
 
+    EsOutStopSlewing( out, true );
+    p_sys->i_adaptive_window_end = VLC_TICK_INVALID;
+
     input_SendEventCache( p_sys->p_input, 0.0 );
 
     foreach_es_then_es_slaves(p_es)
@@ -963,7 +1127,19 @@ static void EsOutDecodersStopBuffering( es_out_t *out, bool b_forced )
                                          i_preroll_duration +
                                          p_sys->i_buffering_extra_stream - p_sys->i_buffering_extra_initial;
 
-    if( i_stream_duration <= i_buffering_duration && !b_forced )
+    /* With fast start, live streams start playing as soon as a quarter of
+     * the buffer is filled. The rest is filled by playing slower than the
+     * stream arrives. */
+    vlc_tick_t i_fast_start_deficit = 0;
+    if( i_stream_duration <= i_buffering_duration && !b_forced
+     && p_sys->fast_start_rate > 0.f && p_sys->rate == 1.f
+     && i_preroll_duration == 0
+     && !input_priv(p_sys->p_input)->b_can_pace_control
+     && i_stream_duration >= i_buffering_duration / 4 )
+        i_fast_start_deficit = i_buffering_duration - i_stream_duration;
+
+    if( i_stream_duration <= i_buffering_duration && !b_forced
+     && i_fast_start_deficit == 0 )
     {
         double f_level;
         if (i_buffering_duration == 0)
@@ -985,6 +1161,14 @@ static void EsOutDecodersStopBuffering( es_out_t *out, bool b_forced )
 
     msg_Dbg( p_sys->p_input, "Stream buffering done (%d ms in %d ms)",
               (int)MS_FROM_VLC_TICK(i_stream_duration), (int)MS_FROM_VLC_TICK(i_system_duration) );
+    if( input_priv(p_sys->p_input)->b_low_delay )
+        msg_Dbg( p_sys->p_input, "Low delay: buffering %d ms (caching %d ms, "
+                 "jitter %d ms, tracks delay %d ms, preroll %d ms)",
+                 (int)MS_FROM_VLC_TICK(i_buffering_duration),
+                 (int)MS_FROM_VLC_TICK(p_sys->i_pts_delay),
+                 (int)MS_FROM_VLC_TICK(p_sys->i_pts_jitter),
+                 (int)MS_FROM_VLC_TICK(p_sys->i_tracks_pts_delay),
+                 (int)MS_FROM_VLC_TICK(i_preroll_duration) );
     p_sys->b_buffering = false;
     p_sys->i_preroll_end = -1;
     p_sys->i_prev_stream_level = -1;
@@ -1033,6 +1217,10 @@ static void EsOutDecodersStopBuffering( es_out_t *out, bool b_forced )
         if( p_es->p_dec_record )
             vlc_input_decoder_StopWait( p_es->p_dec_record );
     }
+
+    p_sys->i_slew_offset = -i_fast_start_deficit;
+    if( i_fast_start_deficit > 0 )
+        EsOutStartSlewing( out, p_sys->fast_start_rate, i_fast_start_deficit );
 }
 static void EsOutDecodersChangePause( es_out_t *out, bool b_paused, vlc_tick_t i_date )
 {
@@ -1706,11 +1894,21 @@ static void EsOutProgramEpg( es_out_t *out, input_source_t *source,
     epg = *p_epg;
     epg.psz_name = EsOutProgramGetProgramName( p_pgrm );
 
-    input_item_SetEpg( p_item, &epg, p_sys->p_pgrm && (p_epg->i_source_id == p_sys->p_pgrm->i_id) );
-    input_SendEventMetaEpg( p_sys->p_input );
-
+    bool b_changed = input_item_SetEpg( p_item, &epg,
+                        p_sys->p_pgrm && (p_epg->i_source_id == p_sys->p_pgrm->i_id) );
     free( epg.psz_name );
 
+    if( b_changed )
+        input_SendEventMetaEpg( p_sys->p_input );
+
+    /* A repeated table changes nothing, and the schedule tables do not
+     * change the now playing: skip the lookup among all the tables */
+    if( !b_changed || !p_epg->b_present )
+    {
+        free( psz_cat );
+        return;
+    }
+
     /* Update now playing */
     if( p_epg->b_present && p_pgrm->p_meta &&
        ( p_epg->p_current || p_epg->i_event == 0 ) )
@@ -2251,6 +2449,7 @@ static void EsOutSelectEs( es_out_t *out, es_out_id_t *es, bool b_force )
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
     input_thread_t *p_input = p_sys->p_input;
     bool b_thumbnailing = input_priv(p_input)->b_thumbnailing;
+    bool b_decoder_sink = input_priv(p_input)->b_decoder_sink;
 
     if( EsIsSelected( es ) )
     {
@@ -2302,7 +2501,7 @@ static void EsOutSelectEs( es_out_t *out, es_out_id_t *es, bool b_force )
             }
             if( es->fmt.i_cat == SPU_ES )
             {
-                if( b_thumbnailing
+                if( b_thumbnailing || b_decoder_sink
                  || !var_GetBool( p_input, b_sout ? "sout-spu" : "spu" ) )
                 {
                     msg_Dbg( p_input, "spu is disabled, not selecting ES 0x%x",
@@ -2733,19 +2932,14 @@ static void EsOutCreateCCChannels( es_out_t *out, vlc_fourcc_t codec, uint64_t i
     }
 }
 
-/**
- * Send a block for the given es_out
- *
- * \param out the es_out to send from
- * \param es the es_out_id
- * \param p_block the data block to send
- */
-static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
+static void EsOutSendStats( es_out_t *out, es_out_id_t *es,
+                            const block_t *p_block )
 {
     es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
     input_thread_t *p_input = p_sys->p_input;
 
-    assert( p_block->p_next == NULL );
+    vlc_tracer_Trace( vlc_object_get_tracer( p_input ), VLC_TRACER_DEMUX_OUT,
+                      es, p_block->i_pts, p_block->i_buffer );
 
     struct input_stats *stats = input_priv(p_input)->stats;
     if( stats != NULL )
@@ -2762,8 +2956,41 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
             atomic_fetch_add_explicit(&stats->demux_discontinuity, 1,
                                       memory_order_relaxed);
     }
+}
 
-    vlc_mutex_lock( &p_sys->lock );
+static void EsOutUpdatePaceControl( es_out_t *out )
+{
+#ifdef ENABLE_SOUT
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+    input_thread_t *p_input = p_sys->p_input;
+
+    /* Check for sout mode */
+    if( input_priv(p_input)->p_sout )
+    {
+        bool pace = sout_instance_ControlsPace(input_priv(p_input)->p_sout);
+
+        if( input_priv(p_input)->b_out_pace_control != pace )
+        {
+            msg_Dbg( p_input, "switching to %ssync mode", pace ? "a" : "" );
+            input_priv(p_input)->b_out_pace_control = pace;
+        }
+    }
+#else
+    VLC_UNUSED(out);
+#endif
+}
+
+/**
+ * Mark and queue one block to the decoder(s) of the given ES
+ *
+ * \return true if the block was given to a decoder, false if it was dropped
+ */
+static bool EsOutSendLocked( es_out_t *out, es_out_id_t *es, block_t *p_block )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+    input_thread_t *p_input = p_sys->p_input;
+
+    vlc_mutex_assert( &p_sys->lock );
 
     /* Mark preroll blocks */
     if( p_sys->i_preroll_end >= 0 )
@@ -2795,23 +3022,8 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     if( !es->p_dec )
     {
         block_Release( p_block );
-        vlc_mutex_unlock( &p_sys->lock );
-        return VLC_SUCCESS;
-    }
-
-#ifdef ENABLE_SOUT
-    /* Check for sout mode */
-    if( input_priv(p_input)->p_sout )
-    {
-        bool pace = sout_instance_ControlsPace(input_priv(p_input)->p_sout);
-
-        if( input_priv(p_input)->b_out_pace_control != pace )
-        {
-            msg_Dbg( p_input, "switching to %ssync mode", pace ? "a" : "" );
-            input_priv(p_input)->b_out_pace_control = pace;
-        }
+        return false;
     }
-#endif
 
     /* Decode */
     if( es->p_dec_record )
@@ -2823,6 +3035,15 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     }
     vlc_input_decoder_Decode( es->p_dec, p_block,
                               input_priv(p_input)->b_out_pace_control );
+    return true;
+}
+
+/**
+ * Apply the format and closed captions changes reported by the decoder
+ */
+static void EsOutCheckDecoderLocked( es_out_t *out, es_out_id_t *es )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
 
     es_format_t fmt_dsc;
     vlc_meta_t  *p_meta_dsc;
@@ -2842,11 +3063,79 @@ static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
     decoder_cc_desc_t desc;
 
     vlc_input_decoder_GetCcDesc( es->p_dec, &desc );
-    if( var_InheritInteger( p_input, "captions" ) == 708 )
+    if( p_sys->b_cc_708 )
         EsOutCreateCCChannels( out, VLC_CODEC_CEA708, desc.i_708_channels,
                                _("DTVCC Closed captions %u"), es );
     EsOutCreateCCChannels( out, VLC_CODEC_CEA608, desc.i_608_channels,
                            _("Closed captions %u"), es );
+}
+
+/**
+ * Send a block for the given es_out
+ *
+ * \param out the es_out to send from
+ * \param es the es_out_id
+ * \param p_block the data block to send
+ */
+static int EsOutSend( es_out_t *out, es_out_id_t *es, block_t *p_block )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    assert( p_block->p_next == NULL );
+
+    EsOutSendStats( out, es, p_block );
+
+    vlc_mutex_lock( &p_sys->lock );
+
+    EsOutUpdatePaceControl( out );
+    if( EsOutSendLocked( out, es, p_block ) )
+        EsOutCheckDecoderLocked( out, es );
+
+    vlc_mutex_unlock( &p_sys->lock );
+
+    return VLC_SUCCESS;
+}
+
+/**
+ * Send a chain of blocks, each one to its own ES
+ *
+ * The statistics are accounted before taking the lock, and the decoder
+ * changes are only checked once per run of blocks sent to the same ES.
+ *
+ * \param out the es_out to send from
+ * \param pp_es the es_out_id of each block of the chain, in order
+ * \param p_chain the chain of data blocks to send
+ */
+static int EsOutSendBatch( es_out_t *out, es_out_id_t *const *pp_es,
+                           block_t *p_chain )
+{
+    es_out_sys_t *p_sys = container_of(out, es_out_sys_t, out);
+
+    size_t i = 0;
+    for( const block_t *p_block = p_chain; p_block != NULL;
+         p_block = p_block->p_next )
+        EsOutSendStats( out, pp_es[i++], p_block );
+
+    vlc_mutex_lock( &p_sys->lock );
+
+    EsOutUpdatePaceControl( out );
+
+    bool b_decoded = false;
+    for( i = 0; p_chain != NULL; i++ )
+    {
+        es_out_id_t *es = pp_es[i];
+        block_t *p_block = p_chain;
+
+        p_chain = p_block->p_next;
+        p_block->p_next = NULL;
+
+        b_decoded |= EsOutSendLocked( out, es, p_block );
+        if( b_decoded && ( p_chain == NULL || pp_es[i + 1] != es ) )
+        {
+            EsOutCheckDecoderLocked( out, es );
+            b_decoded = false;
+        }
+    }
 
     vlc_mutex_unlock( &p_sys->lock );
 
@@ -3216,6 +3505,23 @@ static int EsOutVaControlLocked( es_out_t *out, input_source_t *source,
         }
         else if( p_pgrm == p_sys->p_pgrm )
         {
+            const vlc_tick_t now = vlc_tick_now();
+
+            if( p_sys->i_slew_end != VLC_TICK_INVALID
+             && now >= p_sys->i_slew_end )
+                EsOutStopSlewing( out, true );
+
+            if( !priv->b_can_pace_control && p_sys->b_adaptive_caching
+             && (p_sys->rate == 1.f || p_sys->i_slew_end != VLC_TICK_INVALID) )
+                EsOutAdaptCaching( out, p_pgrm->p_input_clock, now );
+
+            if( !priv->b_can_pace_control && priv->stats != NULL )
+                atomic_store_explicit( &priv->stats->latency,
+                                       p_sys->i_pts_delay + p_sys->i_pts_jitter
+                                       + p_sys->i_tracks_pts_delay
+                                       + EsOutGetSlewOffset( out, now ),
+                                       memory_order_relaxed );
+
             /* Last pcr/clock update was late. We need to compensate by offsetting
                from the clock the rendering dates */
             if( i_late > 0 && ( !priv->p_sout ||
@@ -3670,6 +3976,8 @@ static int EsOutVaPrivControlLocked( es_out_t *out, int query, va_list args )
         const float rate = va_arg( args, double );
 
         assert( src_rate == rate );
+        /* The requested rate overrides the slewing one */
+        EsOutStopSlewing( out, false );
         EsOutChangeRate( out, rate );
 
         return VLC_SUCCESS;
@@ -3840,6 +4148,7 @@ static const struct es_out_callbacks es_out_cbs =
     .control = EsOutControl,
     .destroy = EsOutDelete,
     .priv_control = EsOutPrivControl,
+    .send_batch = EsOutSendBatch,
 };
 
 /****************************************************************************
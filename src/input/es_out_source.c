@@ -57,6 +57,13 @@ static int EsOutSourceSend(es_out_t *out, es_out_id_t *es, block_t *block)
     return es_out_Send(sys->parent_out, es, block);
 }
 
+static int EsOutSourceSendBatch(es_out_t *out, es_out_id_t *const *es,
+                                block_t *chain)
+{
+    es_out_sys_t *sys = container_of(out, es_out_sys_t, out);
+    return es_out_SendBatch(sys->parent_out, es, chain);
+}
+
 static void EsOutSourceDel(es_out_t *out, es_out_id_t *es)
 {
     es_out_sys_t *sys = container_of(out, es_out_sys_t, out);
@@ -88,6 +95,7 @@ es_out_t *input_EsOutSourceNew(es_out_t *parent_out, input_source_t *in)
         .del = EsOutSourceDel,
         .control = EsOutSourceControl,
         .destroy = EsOutSourceDestroy,
+        .send_batch = EsOutSourceSendBatch,
     };
 
     es_out_sys_t *sys = malloc(sizeof(*sys));
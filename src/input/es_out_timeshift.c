@@ -59,6 +59,9 @@
 #   define attribute_packed
 #endif
 
+/* Number of blocks forwarded at once by a batched send */
+#define TS_SEND_BATCH_MAX 64
+
 enum ts_storage_cmd_type_e
 {
     C_ADD = 0,
@@ -239,6 +242,7 @@ typedef struct
     /* */
     ts_storage_t   *p_storage_r;
     ts_storage_t   *p_storage_w;
+    ts_storage_t   *p_storage_spare; /* drained storage, kept for reuse */
 
     vlc_tick_t     i_cmd_delay;
 
@@ -295,6 +299,7 @@ static void         *TsRun( void * );
 
 static ts_storage_t *TsStorageNew( const char *psz_path, int64_t i_tmp_size_max );
 static void         TsStorageDelete( ts_storage_t * );
+static bool         TsStorageReset( ts_storage_t * );
 static void         TsStoragePack( ts_storage_t *p_storage );
 static bool         TsStorageIsFull( ts_storage_t *, const ts_cmd_t *p_cmd );
 static bool         TsStorageIsEmpty( ts_storage_t * );
@@ -489,6 +494,66 @@ static int Send( es_out_t *p_out, es_out_id_t *p_es, block_t *p_block )
 
     return i_ret;
 }
+static int SendBatch( es_out_t *p_out, es_out_id_t *const *pp_es,
+                      block_t *p_chain )
+{
+    es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
+    es_out_id_t *pp_next_es[TS_SEND_BATCH_MAX];
+    block_t *p_batch = NULL;
+    block_t **pp_last = &p_batch;
+    size_t i_batch = 0;
+    int i_ret = VLC_SUCCESS;
+
+    vlc_mutex_lock( &p_sys->lock );
+
+    TsAutoStop( p_out );
+
+    for( size_t i = 0; p_chain != NULL; i++ )
+    {
+        block_t *p_block = p_chain;
+
+        p_chain = p_block->p_next;
+        p_block->p_next = NULL;
+
+        if( p_sys->b_delayed )
+        {
+            ts_cmd_send_t cmd;
+
+            CmdInitSend( &cmd, pp_es[i], p_block );
+            TsPushCmd( p_sys->p_ts, (ts_cmd_t *)&cmd );
+            continue;
+        }
+
+        /* Forward to the next es_out, with its own ES ids */
+        if( !pp_es[i]->p_es )
+        {
+            block_Release( p_block );
+            i_ret = VLC_EGENERIC;
+            continue;
+        }
+        pp_next_es[i_batch++] = pp_es[i]->p_es;
+        *pp_last = p_block;
+        pp_last = &p_block->p_next;
+
+        if( i_batch == TS_SEND_BATCH_MAX || p_chain == NULL )
+        {
+            if( es_out_SendBatch( p_sys->p_out, pp_next_es, p_batch ) != VLC_SUCCESS )
+                i_ret = VLC_EGENERIC;
+            p_batch = NULL;
+            pp_last = &p_batch;
+            i_batch = 0;
+        }
+    }
+    if( p_batch != NULL )
+    {
+        if( es_out_SendBatch( p_sys->p_out, pp_next_es, p_batch ) != VLC_SUCCESS )
+            i_ret = VLC_EGENERIC;
+    }
+
+    vlc_mutex_unlock( &p_sys->lock );
+
+    return i_ret;
+}
 static void Del( es_out_t *p_out, es_out_id_t *p_es )
 {
     es_out_sys_t *p_sys = container_of(p_out, es_out_sys_t, out);
@@ -870,6 +935,7 @@ static const struct es_out_callbacks es_out_timeshift_cbs =
     .control = Control,
     .destroy = Destroy,
     .priv_control = PrivControl,
+    .send_batch = SendBatch,
 };
 
 /*****************************************************************************
@@ -908,6 +974,7 @@ static int TsStart( es_out_t *p_out )
     p_ts->i_cmd_delay = 0;
     p_ts->p_storage_r = NULL;
     p_ts->p_storage_w = NULL;
+    p_ts->p_storage_spare = NULL;
 
     p_sys->b_delayed = true;
     if( vlc_clone( &p_ts->thread, TsRun, p_ts, VLC_THREAD_PRIORITY_INPUT ) )
@@ -955,6 +1022,8 @@ static void TsStop( ts_thread_t *p_ts )
     assert( !p_ts->p_storage_r || !p_ts->p_storage_r->p_next );
     if( p_ts->p_storage_r )
         TsStorageDelete( p_ts->p_storage_r );
+    if( p_ts->p_storage_spare )
+        TsStorageDelete( p_ts->p_storage_spare );
     vlc_mutex_unlock( &p_ts->lock );
 
     TsDestroy( p_ts );
@@ -965,7 +1034,12 @@ static void TsPushCmd( ts_thread_t *p_ts, ts_cmd_t *p_cmd )
 
     if( !p_ts->p_storage_w || TsStorageIsFull( p_ts->p_storage_w, p_cmd ) )
     {
-        ts_storage_t *p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
+        ts_storage_t *p_storage = p_ts->p_storage_spare;
+
+        if( p_storage )
+            p_ts->p_storage_spare = NULL;
+        else
+            p_storage = TsStorageNew( p_ts->psz_tmp_path, p_ts->i_tmp_size_max );
 
         if( !p_storage )
         {
@@ -1009,7 +1083,12 @@ static int TsPopCmdLocked( ts_thread_t *p_ts, ts_cmd_t *p_cmd, bool b_flush )
         if( !p_next )
             break;
 
-        TsStorageDelete( p_ts->p_storage_r );
+        /* Keep one drained storage to avoid creating a temporary file at
+         * every segment boundary */
+        if( !p_ts->p_storage_spare && TsStorageReset( p_ts->p_storage_r ) )
+            p_ts->p_storage_spare = p_ts->p_storage_r;
+        else
+            TsStorageDelete( p_ts->p_storage_r );
         p_ts->p_storage_r = p_next;
     }
 
@@ -1291,6 +1370,35 @@ static void TsStorageDelete( ts_storage_t *p_storage )
     free( p_storage );
 }
 
+/* Makes a drained storage ready to be written again from the start */
+static bool TsStorageReset( ts_storage_t *p_storage )
+{
+    assert( TsStorageIsEmpty( p_storage ) );
+
+    /* Undo TsStoragePack() */
+    if( p_storage->i_cmd_buf < TS_STORAGE_COMMAND_PREALLOC * MAX_COMMAND_SIZE )
+    {
+        uint8_t *p_realloc = realloc( p_storage->p_cmd_buf,
+                                      TS_STORAGE_COMMAND_PREALLOC * MAX_COMMAND_SIZE );
+        if( !p_realloc )
+            return false;
+        p_storage->p_cmd_buf = p_realloc;
+        p_storage->i_cmd_buf = TS_STORAGE_COMMAND_PREALLOC * MAX_COMMAND_SIZE;
+    }
+    p_storage->p_cmd_r = p_storage->p_cmd_buf;
+    p_storage->p_cmd_w = p_storage->p_cmd_buf;
+
+    /* The previous data is overwritten: also discard the read buffer, as
+     * it would otherwise be stale */
+    if( fflush( p_storage->p_filer ) || fflush( p_storage->p_filew )
+     || fseek( p_storage->p_filer, 0, SEEK_SET )
+     || fseek( p_storage->p_filew, 0, SEEK_SET ) )
+        return false;
+    p_storage->i_file_size = 0;
+    p_storage->p_next = NULL;
+    return true;
+}
+
 static void TsStoragePack( ts_storage_t *p_storage )
 {
     /* Try to release a bit of memory */
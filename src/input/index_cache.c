@@ -0,0 +1,189 @@
+/*****************************************************************************
+ * index_cache.c: Demuxer index cache
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_stream.h>
+#include <vlc_strings.h>
+#include <vlc_index_cache.h>
+
+#define INDEX_CACHE_MAGIC "VLCINDX1"
+
+struct index_cache_header
+{
+    char     magic[8];
+    uint64_t file_size;
+    int64_t  file_mtime;
+    uint64_t data_size;
+};
+
+/* Returns the cache directory, and the (not yet existing) file path of the
+ * entry for the demuxed file in *pathp */
+static char *IndexCacheDir(stream_t *demux, const char *name,
+                           struct stat *st, char **pathp)
+{
+    if (demux->psz_filepath == NULL || !var_InheritBool(demux, "index-cache"))
+        return NULL;
+    if (vlc_stat(demux->psz_filepath, st) != 0 || !S_ISREG(st->st_mode))
+        return NULL;
+
+    char *cachedir = config_GetUserDir(VLC_CACHE_DIR);
+    if (cachedir == NULL)
+        return NULL;
+
+    char *dir;
+    if (asprintf(&dir, "%s" DIR_SEP "index", cachedir) == -1)
+        dir = NULL;
+    free(cachedir);
+    if (dir == NULL)
+        return NULL;
+
+    /* The size and date are checked from the header of the entry */
+    char hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+
+    vlc_hash_md5_Init(&md5);
+    vlc_hash_md5_Update(&md5, demux->psz_filepath,
+                        strlen(demux->psz_filepath) + 1);
+    vlc_hash_md5_Update(&md5, name, strlen(name));
+    vlc_hash_FinishHex(&md5, hash);
+
+    if (asprintf(pathp, "%s" DIR_SEP "%s", dir, hash) == -1)
+    {
+        free(dir);
+        return NULL;
+    }
+    return dir;
+}
+
+void *vlc_index_cache_Load(stream_t *demux, const char *name, size_t *size)
+{
+    struct stat st;
+    char *path;
+    char *dir = IndexCacheDir(demux, name, &st, &path);
+    if (dir == NULL)
+        return NULL;
+    free(dir);
+
+    FILE *stream = vlc_fopen(path, "rb");
+    free(path);
+    if (stream == NULL)
+        return NULL;
+
+    struct index_cache_header hdr;
+    void *data = NULL;
+
+    if (fread(&hdr, sizeof (hdr), 1, stream) != 1
+     || memcmp(hdr.magic, INDEX_CACHE_MAGIC, sizeof (hdr.magic))
+     || hdr.file_size != (uint64_t) st.st_size
+     || hdr.file_mtime != (int64_t) st.st_mtime
+     || hdr.data_size == 0 || hdr.data_size > SIZE_MAX)
+        goto out;
+
+    data = malloc(hdr.data_size);
+    if (unlikely(data == NULL))
+        goto out;
+
+    if (fread(data, 1, hdr.data_size, stream) != hdr.data_size)
+    {
+        free(data);
+        data = NULL;
+        goto out;
+    }
+
+    *size = hdr.data_size;
+    msg_Dbg(demux, "loaded %s index from cache (%zu bytes)", name, *size);
+out:
+    fclose(stream);
+    return data;
+}
+
+int vlc_index_cache_Store(stream_t *demux, const char *name,
+                          const void *data, size_t size)
+{
+    struct stat st;
+    char *path;
+    char *dir = IndexCacheDir(demux, name, &st, &path);
+    if (dir == NULL)
+        return VLC_EGENERIC;
+
+    char *cachedir = config_GetUserDir(VLC_CACHE_DIR);
+    if (cachedir != NULL)
+    {
+        vlc_mkdir(cachedir, 0700);
+        free(cachedir);
+    }
+    vlc_mkdir(dir, 0700);
+    free(dir);
+
+    /* Write a temporary file, so that a concurrent or interrupted writer
+     * never leaves a truncated entry */
+    char *tmppath;
+    if (asprintf(&tmppath, "%s.tmp", path) == -1)
+    {
+        free(path);
+        return VLC_ENOMEM;
+    }
+
+    int ret = VLC_EGENERIC;
+    FILE *stream = vlc_fopen(tmppath, "wb");
+    if (stream == NULL)
+    {
+        msg_Dbg(demux, "cannot create index cache %s: %s", tmppath,
+                vlc_strerror_c(errno));
+        goto out;
+    }
+
+    struct index_cache_header hdr = {
+        .file_size = st.st_size,
+        .file_mtime = st.st_mtime,
+        .data_size = size,
+    };
+    memcpy(hdr.magic, INDEX_CACHE_MAGIC, sizeof (hdr.magic));
+
+    bool ok = fwrite(&hdr, sizeof (hdr), 1, stream) == 1
+           && fwrite(data, 1, size, stream) == size;
+    if (fclose(stream) != 0)
+        ok = false;
+
+    if (ok && vlc_rename(tmppath, path) == 0)
+    {
+        msg_Dbg(demux, "saved %s index to cache (%zu bytes)", name, size);
+        ret = VLC_SUCCESS;
+    }
+    else
+        vlc_unlink(tmppath);
+out:
+    free(tmppath);
+    free(path);
+    return ret;
+}
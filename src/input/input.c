@@ -316,7 +316,10 @@ static input_thread_t *Create( vlc_object_t *p_parent,
     priv->normal_time = VLC_TICK_0;
     TAB_INIT( priv->i_attachment, priv->attachment );
     priv->p_sout   = NULL;
-    priv->b_out_pace_control = priv->b_thumbnailing;
+    priv->b_decoder_sink =
+        var_InheritAddress( p_input, "decoder-sink" ) != NULL;
+    /* Without outputs, nothing paces the decoders */
+    priv->b_out_pace_control = priv->b_thumbnailing || priv->b_decoder_sink;
     priv->p_renderer = p_renderer && priv->b_preparsing == false ?
                 vlc_renderer_item_hold( p_renderer ) : NULL;
 
@@ -464,6 +467,15 @@ static void *Run( void *data )
 
     vlc_interrupt_set(&priv->interrupt);
 
+    /* Before Init(): the decoder and output threads inherit the placement */
+    char *cpus = var_InheritString( p_input, "input-cpus" );
+    int node = var_InheritInteger( p_input, "input-numa-node" );
+    int err = vlc_CPU_SetAffinity( cpus, node );
+    if( err )
+        msg_Warn( p_input, "cannot set the CPU affinity: %s",
+                  vlc_strerror_c( err ) );
+    free( cpus );
+
     if( !Init( p_input ) )
     {
         if( priv->b_can_pace_control && priv->b_out_pace_control )
@@ -2493,6 +2505,15 @@ static demux_t *InputDemuxNew( input_thread_t *p_input, es_out_t *p_es_out,
     input_thread_private_t *priv = input_priv(p_input );
     vlc_object_t *obj = VLC_OBJECT(p_input);
 
+    /* share the live source with the other inputs opening it */
+    if( !priv->b_preparsing && var_InheritBool( p_input, "input-share" ) )
+    {
+        demux_t *demux = input_share_Attach( p_input, p_es_out, url,
+                                             psz_demux );
+        if( demux != NULL )
+            return demux;
+    }
+
     /* create the underlying access stream */
     stream_t *p_stream = stream_AccessNew( obj, p_input, p_es_out,
                                            priv->b_preparsing, url );
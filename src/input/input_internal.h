@@ -481,6 +481,7 @@ typedef struct input_thread_private_t
     bool        is_stopped;
     bool        b_recording;
     bool        b_thumbnailing;
+    bool        b_decoder_sink; /* no outputs, see vlc_decoder_sink */
     float       rate;
     vlc_tick_t  normal_time;
 
@@ -708,6 +709,18 @@ void input_ExtractAttachmentAndCacheArt( input_thread_t *, const char *name );
 
 void input_ConfigVarInit ( input_thread_t * );
 
+/* share.c */
+
+/**
+ * Attaches an input to the live source of the same MRL opened by another
+ * input of the instance, or opens it as a shared source.
+ *
+ * @return a combined access/demux feeding the ES output, or NULL if the
+ * MRL cannot be shared (the caller opens it as usual then)
+ */
+demux_t *input_share_Attach( input_thread_t *, es_out_t *, const char *url,
+                             const char *psz_demux );
+
 /* Subtitles */
 int subtitles_Detect( input_thread_t *, char *, const char *, input_item_slave_t ***, int * );
 int subtitles_Filter( const char *);
@@ -741,6 +754,8 @@ struct input_stats {
     atomic_uintmax_t displayed_pictures;
     atomic_uintmax_t late_pictures;
     atomic_uintmax_t lost_pictures;
+    atomic_ptrdiff_t video_memory;
+    _Atomic vlc_tick_t latency;
 };
 
 struct input_stats *input_stats_Create(void);
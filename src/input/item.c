@@ -251,6 +251,34 @@ char *input_item_GetMeta( input_item_t *p_i, vlc_meta_type_t meta_type )
     return psz;
 }
 
+char *input_item_GetArtURLForSize( input_item_t *p_i, unsigned size )
+{
+    static const unsigned sizes[] = { INPUT_ITEM_ART_VARIANT_SIZES };
+    char *psz = NULL;
+
+    vlc_mutex_lock( &p_i->lock );
+    for( size_t i = 0; i < ARRAY_SIZE( sizes ) && psz == NULL; i++ )
+    {
+        if( sizes[i] < size )
+            continue;
+
+        char name[sizeof( INPUT_ITEM_ART_VARIANT_META ) + 10];
+        snprintf( name, sizeof( name ), INPUT_ITEM_ART_VARIANT_META, sizes[i] );
+
+        const char *value = vlc_meta_GetExtra( p_i->p_meta, name );
+        if( value != NULL )
+            psz = strdup( value );
+    }
+    if( psz == NULL )
+    {
+        const char *value = vlc_meta_Get( p_i->p_meta, vlc_meta_ArtworkURL );
+        if( value != NULL )
+            psz = strdup( value );
+    }
+    vlc_mutex_unlock( &p_i->lock );
+    return psz;
+}
+
 /* Get the title of a given item or fallback to the name if the title is empty */
 char *input_item_GetTitleFbName( input_item_t *p_item )
 {
@@ -883,37 +911,146 @@ static int InputItemAddInfo( input_item_t *p_i,
 }
 #endif
 
-void input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_current_source )
+static bool EpgStrEqual( const char *a, const char *b )
 {
-    vlc_epg_t *p_epg = vlc_epg_Duplicate( p_update );
-    if( !p_epg )
-        return;
+    return a == b || ( a != NULL && b != NULL && !strcmp( a, b ) );
+}
 
-    vlc_mutex_lock( &p_item->lock );
+static bool EpgEventEqual( const vlc_epg_event_t *a, const vlc_epg_event_t *b )
+{
+    if( a->i_id != b->i_id || a->i_start != b->i_start ||
+        a->i_duration != b->i_duration || a->i_rating != b->i_rating ||
+        a->i_description_items != b->i_description_items ||
+        !EpgStrEqual( a->psz_name, b->psz_name ) ||
+        !EpgStrEqual( a->psz_short_description, b->psz_short_description ) ||
+        !EpgStrEqual( a->psz_description, b->psz_description ) )
+        return false;
 
-    /* */
-    vlc_epg_t **pp_epg = NULL;
-    for( int i = 0; i < p_item->i_epg; i++ )
+    for( int i = 0; i < a->i_description_items; i++ )
+        if( !EpgStrEqual( a->description_items[i].psz_key,
+                          b->description_items[i].psz_key ) ||
+            !EpgStrEqual( a->description_items[i].psz_value,
+                          b->description_items[i].psz_value ) )
+            return false;
+    return true;
+}
+
+/**
+ * Finds the table of a source in the EPG tables, sorted by source then
+ * table id. Returns its index, or the insertion index with *pb_found unset.
+ */
+static int EpgFind( const input_item_t *p_item, uint16_t i_source_id,
+                    uint32_t i_id, bool *pb_found )
+{
+    int i_lower = 0, i_upper = p_item->i_epg;
+
+    while( i_lower < i_upper )
     {
-        if( p_item->pp_epg[i]->i_source_id == p_update->i_source_id &&
-            p_item->pp_epg[i]->i_id == p_update->i_id )
+        int i_split = ( i_lower + i_upper ) / 2;
+        const vlc_epg_t *p_cur = p_item->pp_epg[i_split];
+
+        if( p_cur->i_source_id < i_source_id ||
+            ( p_cur->i_source_id == i_source_id && p_cur->i_id < i_id ) )
+            i_lower = i_split + 1;
+        else
+            i_upper = i_split;
+    }
+
+    *pb_found = i_lower < p_item->i_epg &&
+                p_item->pp_epg[i_lower]->i_source_id == i_source_id &&
+                p_item->pp_epg[i_lower]->i_id == i_id;
+    return i_lower;
+}
+
+/**
+ * Applies a new version of a table onto the previous one: the events found
+ * unchanged are moved over, only the others are duplicated. Both event lists
+ * are sorted by start time.
+ * Returns false if nothing changed.
+ */
+static bool EpgUpdate( vlc_epg_t *p_epg, const vlc_epg_t *p_update )
+{
+    bool b_changed = p_epg->i_event != p_update->i_event ||
+                     p_epg->b_present != p_update->b_present ||
+                     !EpgStrEqual( p_epg->psz_name, p_update->psz_name ) ||
+                     ( p_epg->p_current == NULL ) != ( p_update->p_current == NULL ) ||
+                     ( p_epg->p_current && p_epg->p_current->i_start !=
+                                           p_update->p_current->i_start );
+    size_t i_old = 0;
+
+    for( size_t i = 0; !b_changed && i < p_update->i_event; i++ )
+        b_changed = !EpgEventEqual( p_epg->pp_event[i], p_update->pp_event[i] );
+    if( !b_changed )
+        return false;
+
+    vlc_epg_event_t **pp_old = p_epg->pp_event;
+    size_t i_old_count = p_epg->i_event;
+
+    TAB_INIT( p_epg->i_event, p_epg->pp_event );
+    p_epg->p_current = NULL;
+    p_epg->b_present = p_update->b_present;
+    if( !EpgStrEqual( p_epg->psz_name, p_update->psz_name ) )
+    {
+        free( p_epg->psz_name );
+        p_epg->psz_name = p_update->psz_name ? strdup( p_update->psz_name ) : NULL;
+    }
+
+    for( size_t i = 0; i < p_update->i_event; i++ )
+    {
+        const vlc_epg_event_t *p_src = p_update->pp_event[i];
+        vlc_epg_event_t *p_evt = NULL;
+
+        while( i_old < i_old_count && pp_old[i_old]->i_start < p_src->i_start )
+            i_old++;
+        if( i_old < i_old_count && EpgEventEqual( pp_old[i_old], p_src ) )
         {
-            pp_epg = &p_item->pp_epg[i];
-            break;
+            p_evt = pp_old[i_old];
+            pp_old[i_old++] = NULL;
         }
+        else
+            p_evt = vlc_epg_event_Duplicate( p_src );
+        if( !p_evt )
+            continue;
+
+        if( p_update->p_current == p_src )
+            p_epg->p_current = p_evt;
+        TAB_APPEND( p_epg->i_event, p_epg->pp_event, p_evt );
     }
 
-    /* replace with new version */
-    if( pp_epg )
+    for( size_t i = 0; i < i_old_count; i++ )
+        if( pp_old[i] )
+            vlc_epg_event_Delete( pp_old[i] );
+    free( pp_old );
+    return true;
+}
+
+bool input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_current_source )
+{
+    vlc_epg_t *p_epg;
+    bool b_found, b_changed = true;
+
+    vlc_mutex_lock( &p_item->lock );
+
+    int i_pos = EpgFind( p_item, p_update->i_source_id, p_update->i_id,
+                         &b_found );
+    if( b_found )
     {
-        vlc_epg_Delete( *pp_epg );
-        if( *pp_epg == p_item->p_epg_table ) /* current table can have changed */
+        /* a full schedule sends many tables per service: only apply the
+         * events which changed in the new version */
+        p_epg = p_item->pp_epg[i_pos];
+        b_changed = EpgUpdate( p_epg, p_update );
+        if( p_epg == p_item->p_epg_table ) /* current table can have changed */
             p_item->p_epg_table = NULL;
-        *pp_epg = p_epg;
     }
     else
     {
-        TAB_APPEND( p_item->i_epg, p_item->pp_epg, p_epg );
+        p_epg = vlc_epg_Duplicate( p_update );
+        if( !p_epg )
+        {
+            vlc_mutex_unlock( &p_item->lock );
+            return false;
+        }
+        TAB_INSERT( p_item->i_epg, p_item->pp_epg, p_epg, i_pos );
     }
 
     if( b_current_source && p_epg->b_present )
@@ -921,6 +1058,9 @@ void input_item_SetEpg( input_item_t *p_item, const vlc_epg_t *p_update, bool b_
 
     vlc_mutex_unlock( &p_item->lock );
 
+    if( !b_changed )
+        return false;
+
 #ifdef EPG_DEBUG
     char *psz_epg;
     if( asprintf( &psz_epg, "EPG %s", p_epg->psz_name ? p_epg->psz_name : "unknown" ) < 0 )
@@ -958,6 +1098,7 @@ signal:
 #endif
     vlc_event_send( &p_item->event_manager,
                     &(vlc_event_t){ .type = vlc_InputItemInfoChanged, } );
+    return true;
 }
 
 void input_item_ChangeEPGSource( input_item_t *p_item, int i_source_id )
@@ -1275,7 +1416,21 @@ void input_item_node_AppendNode( input_item_node_t *p_parent,
 {
     assert(p_parent != NULL);
     assert(p_child != NULL);
-    TAB_APPEND(p_parent->i_children, p_parent->pp_children, p_child);
+
+    /* Grow geometrically, playlists may append many thousands of children.
+     * Removals never shrink the table, so it can always hold the next power
+     * of two of the number of children. */
+    int count = p_parent->i_children;
+    if( (count & (count - 1)) == 0 )
+    {
+        size_t alloc = count > 0 ? 2 * (size_t)count : 1;
+        input_item_node_t **pp_children =
+            realloc( p_parent->pp_children, alloc * sizeof(*pp_children) );
+        if( unlikely(pp_children == NULL) )
+            abort();
+        p_parent->pp_children = pp_children;
+    }
+    p_parent->pp_children[p_parent->i_children++] = p_child;
 }
 
 void input_item_node_RemoveNode( input_item_node_t *parent,
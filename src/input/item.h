@@ -30,6 +30,11 @@ void input_item_SetErrorWhenReading( input_item_t *p_i, bool b_error );
 void input_item_UpdateTracksInfo( input_item_t *item, const es_format_t *fmt );
 bool input_item_ShouldPreparseSubItems( input_item_t *p_i );
 
+/** Bounding box sizes of the downscaled art, in increasing order */
+#define INPUT_ITEM_ART_VARIANT_SIZES 64, 256, 1024
+/** Name of the extra meta holding the URL of the art variant of a size */
+#define INPUT_ITEM_ART_VARIANT_META "ArtworkURL:%u"
+
 typedef struct input_item_owner
 {
     input_item_t item;
@@ -45,6 +45,155 @@ struct vlc_meta_t
     int i_status;
 };
 
+/*
+ * The values shared by many items of a library (artist, album, genre...) are
+ * interned: the items of a same album point to a single reference-counted
+ * copy of each value instead of one heap string per item.
+ */
+struct vlc_meta_atom
+{
+    struct vlc_meta_atom *next;
+    unsigned refs;
+    char str[];
+};
+
+static struct
+{
+    vlc_mutex_t lock;
+    struct vlc_meta_atom **buckets;
+    size_t size;
+    size_t count;
+} atoms = { VLC_STATIC_MUTEX, NULL, 0, 0 };
+
+static bool vlc_meta_IsInterned( vlc_meta_type_t meta_type )
+{
+    switch( meta_type )
+    {
+        case vlc_meta_Artist:
+        case vlc_meta_Genre:
+        case vlc_meta_Album:
+        case vlc_meta_Date:
+        case vlc_meta_Publisher:
+        case vlc_meta_EncodedBy:
+        case vlc_meta_Language:
+        case vlc_meta_ArtworkURL:
+        case vlc_meta_ShowName:
+        case vlc_meta_Actors:
+        case vlc_meta_AlbumArtist:
+        case vlc_meta_DiscTotal:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/* Doubles the hash table, called with the lock held */
+static void vlc_meta_AtomsGrow( void )
+{
+    size_t size = atoms.size ? 2 * atoms.size : 256;
+    struct vlc_meta_atom **buckets = calloc( size, sizeof(*buckets) );
+    if( unlikely(buckets == NULL) )
+        return; /* keep the longer chains */
+
+    for( size_t i = 0; i < atoms.size; i++ )
+    {
+        struct vlc_meta_atom *atom = atoms.buckets[i];
+        while( atom != NULL )
+        {
+            struct vlc_meta_atom *next = atom->next;
+            size_t h = DictHash( atom->str, size );
+
+            atom->next = buckets[h];
+            buckets[h] = atom;
+            atom = next;
+        }
+    }
+    free( atoms.buckets );
+    atoms.buckets = buckets;
+    atoms.size = size;
+}
+
+static char *vlc_meta_Intern( const char *psz )
+{
+    vlc_mutex_lock( &atoms.lock );
+    if( atoms.count >= atoms.size )
+        vlc_meta_AtomsGrow();
+    if( unlikely(atoms.size == 0) )
+    {
+        vlc_mutex_unlock( &atoms.lock );
+        return NULL;
+    }
+
+    size_t h = DictHash( psz, atoms.size );
+    struct vlc_meta_atom *atom;
+
+    for( atom = atoms.buckets[h]; atom != NULL; atom = atom->next )
+        if( !strcmp( atom->str, psz ) )
+        {
+            atom->refs++;
+            goto out;
+        }
+
+    size_t len = strlen( psz ) + 1;
+    atom = malloc( sizeof(*atom) + len );
+    if( unlikely(atom == NULL) )
+        goto out;
+    atom->refs = 1;
+    memcpy( atom->str, psz, len );
+    atom->next = atoms.buckets[h];
+    atoms.buckets[h] = atom;
+    atoms.count++;
+out:
+    vlc_mutex_unlock( &atoms.lock );
+    return atom ? atom->str : NULL;
+}
+
+static char *vlc_meta_InternHold( char *psz )
+{
+    struct vlc_meta_atom *atom = container_of( psz, struct vlc_meta_atom, str );
+
+    vlc_mutex_lock( &atoms.lock );
+    atom->refs++;
+    vlc_mutex_unlock( &atoms.lock );
+    return psz;
+}
+
+static void vlc_meta_InternRelease( char *psz )
+{
+    if( psz == NULL )
+        return;
+
+    struct vlc_meta_atom *atom = container_of( psz, struct vlc_meta_atom, str );
+
+    vlc_mutex_lock( &atoms.lock );
+    if( --atom->refs == 0 )
+    {
+        struct vlc_meta_atom **pp = &atoms.buckets[DictHash( psz, atoms.size )];
+
+        while( *pp != atom )
+            pp = &(*pp)->next;
+        *pp = atom->next;
+        atoms.count--;
+        free( atom );
+
+        if( atoms.count == 0 )
+        {
+            free( atoms.buckets );
+            atoms.buckets = NULL;
+            atoms.size = 0;
+        }
+    }
+    vlc_mutex_unlock( &atoms.lock );
+}
+
+static void vlc_meta_FreeValue( vlc_meta_t *m, vlc_meta_type_t meta_type )
+{
+    if( vlc_meta_IsInterned( meta_type ) )
+        vlc_meta_InternRelease( m->ppsz_meta[meta_type] );
+    else
+        free( m->ppsz_meta[meta_type] );
+}
+
 /* FIXME bad name convention */
 const char * vlc_meta_TypeToLocalizedString( vlc_meta_type_t meta_type )
 {
@@ -108,7 +257,7 @@ static void vlc_meta_FreeExtraKey( void *p_data, void *p_obj )
 void vlc_meta_Delete( vlc_meta_t *m )
 {
     for( int i = 0; i < VLC_META_TYPE_COUNT ; i++ )
-        free( m->ppsz_meta[i] );
+        vlc_meta_FreeValue( m, i );
     vlc_dictionary_clear( &m->extra_tags, vlc_meta_FreeExtraKey, NULL );
     free( m );
 }
@@ -121,9 +270,15 @@ void vlc_meta_Delete( vlc_meta_t *m )
 
 void vlc_meta_Set( vlc_meta_t *p_meta, vlc_meta_type_t meta_type, const char *psz_val )
 {
-    free( p_meta->ppsz_meta[meta_type] );
+    char *psz_new = NULL;
+
     assert( psz_val == NULL || IsUTF8( psz_val ) );
-    p_meta->ppsz_meta[meta_type] = psz_val ? strdup( psz_val ) : NULL;
+    if( psz_val != NULL )
+        psz_new = vlc_meta_IsInterned( meta_type ) ? vlc_meta_Intern( psz_val )
+                                                   : strdup( psz_val );
+    /* the new value may be the same atom as the old one */
+    vlc_meta_FreeValue( p_meta, meta_type );
+    p_meta->ppsz_meta[meta_type] = psz_new;
 }
 
 const char *vlc_meta_Get( const vlc_meta_t *p_meta, vlc_meta_type_t meta_type )
@@ -181,8 +336,11 @@ void vlc_meta_Merge( vlc_meta_t *dst, const vlc_meta_t *src )
     {
         if( src->ppsz_meta[i] )
         {
-            free( dst->ppsz_meta[i] );
-            dst->ppsz_meta[i] = strdup( src->ppsz_meta[i] );
+            char *psz_new = vlc_meta_IsInterned( i )
+                          ? vlc_meta_InternHold( src->ppsz_meta[i] )
+                          : strdup( src->ppsz_meta[i] );
+            vlc_meta_FreeValue( dst, i );
+            dst->ppsz_meta[i] = psz_new;
         }
     }
 
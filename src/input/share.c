@@ -0,0 +1,541 @@
+/*****************************************************************************
+ * share.c: one live input source feeding several inputs
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_interrupt.h>
+#include <vlc_list.h>
+#include "demux.h"
+#include "input_internal.h"
+
+/*
+ * The inputs of one LibVLC instance opening the same live MRL share a single
+ * access and demux. The source runs in its own thread, and its ES output
+ * fans the elementary streams out to the ES output of each attached input,
+ * which keeps its own decoders or stream output. Each input sees a combined
+ * access/demux that pushes data by itself, like the network ones.
+ *
+ * Only the sources that do not control their pace are shared: a file read
+ * by two players at different positions cannot be.
+ */
+#define SHARE_MAX_CONSUMERS 16
+
+struct input_share_es
+{
+    es_format_t  fmt;
+    es_out_id_t *ids[SHARE_MAX_CONSUMERS];
+};
+
+struct input_share
+{
+    struct vlc_list node;
+    libvlc_int_t   *libvlc;
+    char           *url;
+    unsigned        refs;
+
+    demux_t        *demux;
+    es_out_t        out;
+    vlc_tick_t      pts_delay;
+    vlc_interrupt_t *interrupt;
+    vlc_thread_t    thread;
+    bool            has_thread;
+
+    vlc_mutex_t     lock;
+    es_out_t       *consumers[SHARE_MAX_CONSUMERS];
+    struct input_share_es **es;
+    int             es_count;
+};
+
+static vlc_mutex_t shares_lock = VLC_STATIC_MUTEX;
+static struct vlc_list shares = VLC_LIST_INITIALIZER(&shares);
+
+static es_out_id_t *ShareOutAdd(es_out_t *out, input_source_t *in,
+                                const es_format_t *fmt)
+{
+    struct input_share *share = container_of(out, struct input_share, out);
+    struct input_share_es *es = malloc(sizeof (*es));
+    (void) in;
+
+    if (unlikely(es == NULL))
+        return NULL;
+    if (es_format_Copy(&es->fmt, fmt))
+    {
+        free(es);
+        return NULL;
+    }
+
+    vlc_mutex_lock(&share->lock);
+    for (unsigned i = 0; i < SHARE_MAX_CONSUMERS; i++)
+        es->ids[i] = share->consumers[i] != NULL
+                   ? es_out_Add(share->consumers[i], fmt) : NULL;
+    TAB_APPEND(share->es_count, share->es, es);
+    vlc_mutex_unlock(&share->lock);
+    return (es_out_id_t *)es;
+}
+
+static int ShareOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct input_share *share = container_of(out, struct input_share, out);
+    struct input_share_es *es = (struct input_share_es *)id;
+    es_out_t *last_out = NULL;
+    es_out_id_t *last_id = NULL;
+
+    vlc_mutex_lock(&share->lock);
+    /* Every consumer but the last one gets a copy */
+    for (unsigned i = 0; i < SHARE_MAX_CONSUMERS; i++)
+    {
+        if (es->ids[i] == NULL)
+            continue;
+        if (last_out != NULL)
+        {
+            block_t *dup = block_Duplicate(block);
+            if (likely(dup != NULL))
+                es_out_Send(last_out, last_id, dup);
+        }
+        last_out = share->consumers[i];
+        last_id = es->ids[i];
+    }
+
+    if (last_out != NULL)
+        es_out_Send(last_out, last_id, block);
+    else
+        block_Release(block);
+    vlc_mutex_unlock(&share->lock);
+    return VLC_SUCCESS;
+}
+
+static void ShareOutDel(es_out_t *out, es_out_id_t *id)
+{
+    struct input_share *share = container_of(out, struct input_share, out);
+    struct input_share_es *es = (struct input_share_es *)id;
+
+    vlc_mutex_lock(&share->lock);
+    for (unsigned i = 0; i < SHARE_MAX_CONSUMERS; i++)
+        if (es->ids[i] != NULL)
+            es_out_Del(share->consumers[i], es->ids[i]);
+    TAB_REMOVE(share->es_count, share->es, es);
+    vlc_mutex_unlock(&share->lock);
+
+    es_format_Clean(&es->fmt);
+    free(es);
+}
+
+static int ShareOutControl(es_out_t *out, input_source_t *in, int query,
+                           va_list args)
+{
+    struct input_share *share = container_of(out, struct input_share, out);
+    int ret = VLC_SUCCESS;
+    (void) in;
+
+    vlc_mutex_lock(&share->lock);
+    switch (query)
+    {
+        /* the ES queries are translated to the ES of each consumer */
+        case ES_OUT_SET_ES:
+        case ES_OUT_UNSET_ES:
+        case ES_OUT_RESTART_ES:
+        case ES_OUT_SET_ES_DEFAULT:
+        {
+            struct input_share_es *es = va_arg(args, struct input_share_es *);
+
+            for (unsigned i = 0; i < SHARE_MAX_CONSUMERS; i++)
+                if (es->ids[i] != NULL)
+                    es_out_Control(share->consumers[i], query, es->ids[i]);
+            break;
+        }
+
+        case ES_OUT_SET_ES_STATE:
+        case ES_OUT_SET_ES_SCRAMBLED_STATE:
+        {
+            struct input_share_es *es = va_arg(args, struct input_share_es *);
+            bool state = va_arg(args, int);
+
+            for (unsigned i = 0; i < SHARE_MAX_CONSUMERS; i++)
+                if (es->ids[i] != NULL)
+                    es_out_Control(share->consumers[i], query, es->ids[i],
+                                   state);
+            break;
+        }
+
+        case ES_OUT_GET_ES_STATE:
+        {
+            /* selected if any consumer wants it */
+            struct input_share_es *es = va_arg(args, struct input_share_es *);
+            bool *state = va_arg(args, bool *);
+
+            *state = false;
+            for (unsigned i = 0; i < SHARE_MAX_CONSUMERS && !*state; i++)
+                if (es->ids[i] != NULL)
+                    es_out_Control(share->consumers[i], query, es->ids[i],
+                                   state);
+            break;
+        }
+
+        case ES_OUT_SET_ES_FMT:
+        {
+            struct input_share_es *es = va_arg(args, struct input_share_es *);
+            const es_format_t *fmt = va_arg(args, const es_format_t *);
+            es_format_t copy;
+
+            if (es_format_Copy(&copy, fmt) == VLC_SUCCESS)
+            {
+                es_format_Clean(&es->fmt);
+                es->fmt = copy;
+            }
+            for (unsigned i = 0; i < SHARE_MAX_CONSUMERS; i++)
+                if (es->ids[i] != NULL)
+                    es_out_Control(share->consumers[i], query, es->ids[i],
+                                   fmt);
+            break;
+        }
+
+        case ES_OUT_GET_EMPTY:
+        {
+            bool *empty = va_arg(args, bool *);
+
+            *empty = true;
+            for (unsigned i = 0; i < SHARE_MAX_CONSUMERS && *empty; i++)
+                if (share->consumers[i] != NULL)
+                    es_out_Control(share->consumers[i], query, empty);
+            break;
+        }
+
+        /* the others have no ES argument, and are forwarded as is */
+        case ES_OUT_SET_ES_CAT_POLICY:
+        case ES_OUT_SET_GROUP:
+        case ES_OUT_SET_PCR:
+        case ES_OUT_SET_GROUP_PCR:
+        case ES_OUT_RESET_PCR:
+        case ES_OUT_SET_NEXT_DISPLAY_TIME:
+        case ES_OUT_SET_GROUP_META:
+        case ES_OUT_SET_GROUP_EPG:
+        case ES_OUT_SET_GROUP_EPG_EVENT:
+        case ES_OUT_SET_EPG_TIME:
+        case ES_OUT_DEL_GROUP:
+        case ES_OUT_SET_META:
+            for (unsigned i = 0; i < SHARE_MAX_CONSUMERS; i++)
+                if (share->consumers[i] != NULL)
+                {
+                    va_list ap;
+
+                    va_copy(ap, args);
+                    share->consumers[i]->cbs->control(share->consumers[i],
+                                                      NULL, query, ap);
+                    va_end(ap);
+                }
+            break;
+
+        default:
+            /* clock manipulation, sub-items and vout controls belong to a
+             * single input */
+            ret = VLC_EGENERIC;
+            break;
+    }
+    vlc_mutex_unlock(&share->lock);
+    return ret;
+}
+
+static void ShareOutDestroy(es_out_t *out)
+{
+    (void) out;
+}
+
+static const struct es_out_callbacks share_out_cbs =
+{
+    .add = ShareOutAdd,
+    .send = ShareOutSend,
+    .del = ShareOutDel,
+    .control = ShareOutControl,
+    .destroy = ShareOutDestroy,
+};
+
+static void *ShareThread(void *data)
+{
+    struct input_share *share = data;
+
+    vlc_interrupt_set(share->interrupt);
+    while (demux_Demux(share->demux) > 0)
+        ;
+    msg_Dbg(share->demux, "shared input ended");
+    return NULL;
+}
+
+static struct input_share *ShareNew(vlc_object_t *parent, const char *url,
+                                    const char *psz_demux)
+{
+    struct input_share *share = malloc(sizeof (*share));
+    if (unlikely(share == NULL))
+        return NULL;
+
+    share->interrupt = NULL;
+    share->url = strdup(url);
+    if (unlikely(share->url == NULL))
+        goto error;
+
+    share->out.cbs = &share_out_cbs;
+    share->refs = 0;
+    share->has_thread = false;
+    share->es = NULL;
+    share->es_count = 0;
+    for (unsigned i = 0; i < SHARE_MAX_CONSUMERS; i++)
+        share->consumers[i] = NULL;
+    vlc_mutex_init(&share->lock);
+
+    share->interrupt = vlc_interrupt_create();
+    if (unlikely(share->interrupt == NULL))
+        goto error;
+
+    /* The source outlives the input that created it */
+    stream_t *stream = stream_AccessNew(parent, NULL, &share->out, false, url);
+    if (stream == NULL)
+        goto error;
+
+    if (stream->pf_read == NULL && stream->pf_block == NULL
+     && stream->pf_readdir == NULL)
+        share->demux = stream; /* combined access/demux */
+    else
+    {
+        stream = stream_FilterAutoNew(stream);
+        share->demux = demux_NewAdvanced(parent, NULL, psz_demux, url,
+                                         stream, &share->out, false);
+        if (share->demux == NULL)
+        {
+            vlc_stream_Delete(stream);
+            goto error;
+        }
+    }
+
+    bool can_pace;
+    if (demux_Control(share->demux, DEMUX_CAN_CONTROL_PACE, &can_pace))
+        can_pace = true;
+    if (can_pace || share->demux->pf_readdir != NULL)
+    {
+        msg_Dbg(parent, "%s cannot be shared", url);
+        demux_Delete(share->demux);
+        goto error;
+    }
+
+    if (demux_Control(share->demux, DEMUX_GET_PTS_DELAY, &share->pts_delay))
+        share->pts_delay = VLC_TICK_FROM_MS(var_InheritInteger(parent,
+                                                        "network-caching"));
+    /* let the ES output of each consumer sort the programs out */
+    demux_Control(share->demux, DEMUX_SET_GROUP_ALL);
+
+    if (share->demux->pf_demux != NULL)
+    {   /* the combined access/demux push their data by themselves */
+        if (vlc_clone(&share->thread, ShareThread, share,
+                      VLC_THREAD_PRIORITY_INPUT))
+        {
+            demux_Delete(share->demux);
+            goto error;
+        }
+        share->has_thread = true;
+    }
+    return share;
+
+error:
+    if (share->interrupt != NULL)
+        vlc_interrupt_destroy(share->interrupt);
+    free(share->url);
+    free(share);
+    return NULL;
+}
+
+static void ShareDelete(struct input_share *share)
+{
+    if (share->has_thread)
+    {
+        vlc_interrupt_kill(share->interrupt);
+        vlc_join(share->thread, NULL);
+    }
+    demux_Delete(share->demux);
+    assert(share->es_count == 0);
+    TAB_CLEAN(share->es_count, share->es);
+    vlc_interrupt_destroy(share->interrupt);
+    free(share->url);
+    free(share);
+}
+
+struct share_consumer
+{
+    struct input_share *share;
+    unsigned            slot;
+};
+
+static int ConsumerControl(demux_t *demux, int query, va_list args)
+{
+    struct share_consumer *sys = demux->p_sys;
+
+    switch (query)
+    {
+        case DEMUX_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = sys->share->pts_delay;
+            return VLC_SUCCESS;
+
+        case DEMUX_CAN_PAUSE:
+        case DEMUX_CAN_SEEK:
+        case DEMUX_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = false;
+            return VLC_SUCCESS;
+
+        case DEMUX_GET_POSITION:
+            *va_arg(args, double *) = 0.;
+            return VLC_SUCCESS;
+
+        case DEMUX_GET_LENGTH:
+        case DEMUX_GET_TIME:
+            *va_arg(args, vlc_tick_t *) = 0;
+            return VLC_SUCCESS;
+    }
+    return VLC_EGENERIC;
+}
+
+static void ConsumerDestroy(stream_t *demux)
+{
+    struct share_consumer *sys = demux->p_sys;
+    struct input_share *share = sys->share;
+    bool last;
+
+    vlc_mutex_lock(&share->lock);
+    for (int i = 0; i < share->es_count; i++)
+    {
+        struct input_share_es *es = share->es[i];
+
+        if (es->ids[sys->slot] != NULL)
+        {
+            es_out_Del(demux->out, es->ids[sys->slot]);
+            es->ids[sys->slot] = NULL;
+        }
+    }
+    share->consumers[sys->slot] = NULL;
+    vlc_mutex_unlock(&share->lock);
+
+    vlc_mutex_lock(&shares_lock);
+    last = --share->refs == 0;
+    if (last)
+        vlc_list_remove(&share->node);
+    vlc_mutex_unlock(&shares_lock);
+
+    if (last)
+        ShareDelete(share);
+    free(demux->psz_name);
+    free(sys);
+}
+
+demux_t *input_share_Attach(input_thread_t *input, es_out_t *out,
+                            const char *url, const char *psz_demux)
+{
+    vlc_object_t *obj = VLC_OBJECT(input);
+    libvlc_int_t *libvlc = vlc_object_instance(input);
+    struct input_share *share = NULL;
+
+    struct share_consumer *sys = malloc(sizeof (*sys));
+    if (unlikely(sys == NULL))
+        return NULL;
+
+    demux_t *demux = vlc_stream_CustomNew(obj, ConsumerDestroy, 0, "demux");
+    if (unlikely(demux == NULL))
+    {
+        free(sys);
+        return NULL;
+    }
+    demux->p_input_item = input_GetItem(input);
+    demux->psz_name = strdup("share");
+    demux->psz_url = strdup(url);
+    demux->psz_filepath = NULL;
+    demux->out = out;
+    demux->b_preparsing = false;
+    demux->pf_demux = NULL;
+    demux->pf_control = ConsumerControl;
+    demux->p_sys = sys;
+    if (unlikely(demux->psz_name == NULL || demux->psz_url == NULL))
+        goto error;
+    const char *p = strstr(demux->psz_url, "://");
+    demux->psz_location = (p != NULL) ? (p + 3) : "";
+
+    /* The registry lock is held while the first consumer opens the source,
+     * so that concurrent openings of the same MRL end up sharing it. */
+    vlc_mutex_lock(&shares_lock);
+    struct input_share *entry;
+    vlc_list_foreach(entry, &shares, node)
+        if (entry->libvlc == libvlc && !strcmp(entry->url, url))
+        {
+            share = entry;
+            break;
+        }
+
+    if (share == NULL)
+    {
+        share = ShareNew(VLC_OBJECT(libvlc), url, psz_demux);
+        if (share == NULL)
+        {
+            vlc_mutex_unlock(&shares_lock);
+            goto error;
+        }
+        share->libvlc = libvlc;
+        vlc_list_append(&share->node, &shares);
+        msg_Dbg(obj, "sharing %s", url);
+    }
+    else
+        msg_Dbg(obj, "attaching to the shared %s", url);
+
+    vlc_mutex_lock(&share->lock);
+    unsigned slot = 0;
+    while (slot < SHARE_MAX_CONSUMERS && share->consumers[slot] != NULL)
+        slot++;
+    if (slot == SHARE_MAX_CONSUMERS)
+    {
+        vlc_mutex_unlock(&share->lock);
+        if (share->refs == 0)
+        {
+            vlc_list_remove(&share->node);
+            ShareDelete(share);
+        }
+        vlc_mutex_unlock(&shares_lock);
+        goto error;
+    }
+
+    share->refs++;
+    sys->share = share;
+    sys->slot = slot;
+    share->consumers[slot] = out;
+    /* the ES that the source already has */
+    for (int i = 0; i < share->es_count; i++)
+        share->es[i]->ids[slot] = es_out_Add(out, &share->es[i]->fmt);
+    vlc_mutex_unlock(&share->lock);
+    vlc_mutex_unlock(&shares_lock);
+    return demux;
+
+error:
+    free(demux->psz_name);
+    free(sys);
+    stream_CommonDelete(demux);
+    return NULL;
+}
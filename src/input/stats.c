@@ -68,6 +68,8 @@ struct input_stats *input_stats_Create(void)
     atomic_init(&stats->displayed_pictures, 0);
     atomic_init(&stats->late_pictures, 0);
     atomic_init(&stats->lost_pictures, 0);
+    atomic_init(&stats->video_memory, 0);
+    atomic_init(&stats->latency, 0);
     return stats;
 }
 
@@ -111,6 +113,12 @@ void input_stats_Compute(struct input_stats *stats, input_stats_t *st)
                                                     memory_order_relaxed);
     st->i_lost_pictures = atomic_load_explicit(&stats->lost_pictures,
                                                memory_order_relaxed);
+    st->i_video_memory = atomic_load_explicit(&stats->video_memory,
+                                              memory_order_relaxed);
+
+    /* Clock */
+    st->i_latency = atomic_load_explicit(&stats->latency,
+                                         memory_order_relaxed);
 }
 
 /** Update a counter element with new values
@@ -36,6 +36,7 @@
 #include <vlc_block.h>
 #include <vlc_access.h>
 #include <vlc_charset.h>
+#include <vlc_es_out.h>
 #include <vlc_interrupt.h>
 #include <vlc_stream_extractor.h>
 
@@ -751,3 +752,31 @@ int vlc_stream_ReadDir( stream_t *s, input_item_node_t *p_node )
     assert(s->pf_readdir != NULL);
     return s->pf_readdir( s, p_node );
 }
+
+int vlc_stream_PostSubItems( stream_t *s, input_item_node_t *p_node )
+{
+    if( s->out == NULL )
+        return VLC_EGENERIC;
+    if( p_node->i_children == 0 )
+        return VLC_SUCCESS;
+
+    input_item_node_t *p_batch = input_item_node_Create( p_node->p_item );
+    if( unlikely(p_batch == NULL) )
+        return VLC_ENOMEM;
+
+    p_batch->i_children = p_node->i_children;
+    p_batch->pp_children = p_node->pp_children;
+
+    if( es_out_Control( s->out, ES_OUT_POST_SUBNODE, p_batch ) )
+    {
+        /* keep the children in the reader node */
+        p_batch->i_children = 0;
+        p_batch->pp_children = NULL;
+        input_item_node_Delete( p_batch );
+        return VLC_EGENERIC;
+    }
+
+    p_node->i_children = 0;
+    p_node->pp_children = NULL;
+    return VLC_SUCCESS;
+}
@@ -26,6 +26,7 @@
 
 #include <vlc_thumbnailer.h>
 #include <vlc_executor.h>
+#include <vlc_picture.h>
 #include "input_internal.h"
 
 struct vlc_thumbnailer_t
@@ -60,6 +61,12 @@ struct vlc_thumbnailer_request_t
     vlc_thumbnailer_t *thumbnailer;
 
     struct seek_target seek_target;
+    /**
+     * Times of the targets of a batch request, in increasing order
+     * (times[0] is also seek_target), NULL otherwise
+     */
+    vlc_tick_t *times;
+    size_t count;
     bool fast_seek;
     input_item_t *item;
     /**
@@ -73,6 +80,8 @@ struct vlc_thumbnailer_request_t
     vlc_mutex_t lock;
     vlc_cond_t cond_ended;
     bool ended;
+    bool input_ended;
+    picture_t *pic; /**< first picture received since the last seek */
 
     struct vlc_runnable runnable; /**< to be passed to the executor */
 
@@ -83,13 +92,28 @@ static void RunnableRun(void *);
 
 static task_t *
 TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
-        struct seek_target seek_target, bool fast_seek,
-        vlc_thumbnailer_cb cb, void *userdata, vlc_tick_t timeout)
+        struct seek_target seek_target, const vlc_tick_t *times, size_t count,
+        bool fast_seek, vlc_thumbnailer_cb cb, void *userdata,
+        vlc_tick_t timeout)
 {
     task_t *task = malloc(sizeof(*task));
     if (!task)
         return NULL;
 
+    task->times = NULL;
+    task->count = 1;
+    if (times != NULL)
+    {
+        task->times = vlc_alloc(count, sizeof(*times));
+        if (!task->times)
+        {
+            free(task);
+            return NULL;
+        }
+        memcpy(task->times, times, count * sizeof(*times));
+        task->count = count;
+    }
+
     task->thumbnailer = thumbnailer;
     task->item = item;
     task->seek_target = seek_target;
@@ -101,6 +125,8 @@ TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
     vlc_mutex_init(&task->lock);
     vlc_cond_init(&task->cond_ended);
     task->ended = false;
+    task->input_ended = false;
+    task->pic = NULL;
 
     task->runnable.run = RunnableRun;
     task->runnable.userdata = task;
@@ -114,6 +140,7 @@ static void
 TaskDelete(task_t *task)
 {
     input_item_Release(task->item);
+    free(task->times);
     free(task);
 }
 
@@ -152,41 +179,34 @@ on_thumbnailer_input_event( input_thread_t *input,
     task_t *task = userdata;
 
     vlc_mutex_lock(&task->lock);
-    if (task->ended)
+    if (event->type == INPUT_EVENT_THUMBNAIL_READY)
     {
         /* We may receive a THUMBNAIL_READY event followed by an
-         * INPUT_EVENT_STATE (end of stream), we must only consider the first
-         * one. */
-        vlc_mutex_unlock(&task->lock);
-        return;
+         * INPUT_EVENT_STATE (end of stream), the picture is what matters. */
+        if (task->pic == NULL)
+            task->pic = picture_Hold(event->thumbnail);
     }
-
-    task->ended = true;
+    else
+        task->input_ended = true;
     vlc_mutex_unlock(&task->lock);
 
-    picture_t *pic = NULL;
-    if (event->type == INPUT_EVENT_THUMBNAIL_READY)
-        pic = event->thumbnail;
-
-    NotifyThumbnail(task, pic);
     vlc_cond_signal(&task->cond_ended);
 }
 
-static void
-RunnableRun(void *userdata)
+static input_thread_t *
+TaskStartInput(task_t *task, size_t idx)
 {
-    task_t *task = userdata;
-    vlc_thumbnailer_t *thumbnailer = task->thumbnailer;
-
-    vlc_tick_t now = vlc_tick_now();
-
     input_thread_t* input =
-        input_CreateThumbnailer(thumbnailer->parent, on_thumbnailer_input_event,
-                                task, task->item);
+        input_CreateThumbnailer(task->thumbnailer->parent,
+                                on_thumbnailer_input_event, task, task->item);
     if (!input)
-        goto end;
+        return NULL;
 
-    if (task->seek_target.type == VLC_THUMBNAILER_SEEK_TIME)
+    task->input_ended = false;
+
+    if (idx > 0)
+        input_SetTime(input, task->times[idx], task->fast_seek);
+    else if (task->seek_target.type == VLC_THUMBNAILER_SEEK_TIME)
         input_SetTime(input, task->seek_target.time, task->fast_seek);
     else
     {
@@ -198,29 +218,100 @@ RunnableRun(void *userdata)
     if (ret != VLC_SUCCESS)
     {
         input_Close(input);
-        goto end;
+        return NULL;
     }
+    return input;
+}
 
-    vlc_mutex_lock(&task->lock);
-    if (task->timeout == VLC_TICK_INVALID)
+static void
+TaskStopInput(task_t *task, input_thread_t *input)
+{
+    input_Stop(input);
+    input_Close(input);
+
+    /* No more events can be received */
+    if (task->pic != NULL)
     {
-        while (!task->ended)
-            vlc_cond_wait(&task->cond_ended, &task->lock);
+        picture_Release(task->pic);
+        task->pic = NULL;
     }
-    else
+}
+
+static void
+RunnableRun(void *userdata)
+{
+    task_t *task = userdata;
+    vlc_thumbnailer_t *thumbnailer = task->thumbnailer;
+
+    /* All the targets of a batch are taken from the same input, seeking
+     * forward from one to the next. */
+    input_thread_t *input = NULL;
+    size_t idx = 0;
+    bool canceled = false;
+
+    while (idx < task->count)
     {
-        vlc_tick_t deadline = now + task->timeout;
+        bool started = input == NULL;
+        if (started)
+        {
+            input = TaskStartInput(task, idx);
+            if (!input)
+                break;
+        }
+        else
+            input_SetTime(input, task->times[idx], task->fast_seek);
+
+        vlc_tick_t deadline = task->timeout != VLC_TICK_INVALID ?
+                              vlc_tick_now() + task->timeout : VLC_TICK_INVALID;
         bool timeout = false;
-        while (!task->ended && !timeout)
-            timeout =
-                vlc_cond_timedwait(&task->cond_ended, &task->lock, deadline);
+
+        vlc_mutex_lock(&task->lock);
+        while (!task->ended && !task->input_ended && !task->pic && !timeout)
+        {
+            if (deadline == VLC_TICK_INVALID)
+                vlc_cond_wait(&task->cond_ended, &task->lock);
+            else
+                timeout = vlc_cond_timedwait(&task->cond_ended, &task->lock,
+                                             deadline);
+        }
+        picture_t *pic = task->pic;
+        task->pic = NULL;
+        canceled = task->ended;
+        bool input_ended = task->input_ended;
+        vlc_mutex_unlock(&task->lock);
+
+        if (canceled)
+        {
+            if (pic)
+                picture_Release(pic);
+            break;
+        }
+
+        if (pic == NULL && input_ended)
+        {
+            TaskStopInput(task, input);
+            input = NULL;
+            /* The input may have reached the end of the stream before the
+             * seek to this target: start again from it. Otherwise, this
+             * target and the following ones are past the end. */
+            if (!started)
+                continue;
+            break;
+        }
+
+        NotifyThumbnail(task, pic);
+        if (pic)
+            picture_Release(pic);
+        idx++;
     }
-    vlc_mutex_unlock(&task->lock);
 
-    input_Stop(input);
-    input_Close(input);
+    if (input)
+        TaskStopInput(task, input);
+
+    if (!canceled)
+        for (; idx < task->count; ++idx)
+            NotifyThumbnail(task, NULL);
 
-end:
     ThumbnailerRemoveTask(thumbnailer, task);
     TaskDelete(task);
 }
@@ -237,12 +328,13 @@ Interrupt(task_t *task)
 
 static task_t *
 RequestCommon(vlc_thumbnailer_t *thumbnailer, struct seek_target seek_target,
+              const vlc_tick_t *times, size_t count,
               enum vlc_thumbnailer_seek_speed speed, input_item_t *item,
               vlc_tick_t timeout, vlc_thumbnailer_cb cb, void *userdata)
 {
     bool fast_seek = speed == VLC_THUMBNAILER_SEEK_FAST;
-    task_t *task = TaskNew(thumbnailer, item, seek_target, fast_seek, cb,
-                           userdata, timeout);
+    task_t *task = TaskNew(thumbnailer, item, seek_target, times, count,
+                           fast_seek, cb, userdata, timeout);
     if (!task)
         return NULL;
 
@@ -268,8 +360,8 @@ vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
         .type = VLC_THUMBNAILER_SEEK_TIME,
         .time = time,
     };
-    return RequestCommon(thumbnailer, seek_target, speed, item, timeout, cb,
-                         userdata);
+    return RequestCommon(thumbnailer, seek_target, NULL, 1, speed, item,
+                         timeout, cb, userdata);
 }
 
 task_t *
@@ -282,8 +374,28 @@ vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
         .type = VLC_THUMBNAILER_SEEK_POS,
         .time = pos,
     };
-    return RequestCommon(thumbnailer, seek_target, speed, item, timeout, cb,
-                         userdata);
+    return RequestCommon(thumbnailer, seek_target, NULL, 1, speed, item,
+                         timeout, cb, userdata);
+}
+
+task_t *
+vlc_thumbnailer_RequestByTimes( vlc_thumbnailer_t *thumbnailer,
+                                const vlc_tick_t *times, size_t count,
+                                enum vlc_thumbnailer_seek_speed speed,
+                                input_item_t *item, vlc_tick_t timeout,
+                                vlc_thumbnailer_cb cb, void* userdata )
+{
+    if (count == 0)
+        return NULL;
+    for (size_t i = 1; i < count; ++i)
+        assert(times[i - 1] <= times[i]);
+
+    struct seek_target seek_target = {
+        .type = VLC_THUMBNAILER_SEEK_TIME,
+        .time = times[0],
+    };
+    return RequestCommon(thumbnailer, seek_target, times, count, speed, item,
+                         timeout, cb, userdata);
 }
 
 void vlc_thumbnailer_Cancel( vlc_thumbnailer_t* thumbnailer, task_t* task )
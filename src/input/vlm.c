@@ -62,17 +62,18 @@ static void player_on_state_changed(vlc_player_t *player,
     vlm_media_sys_t *p_media = data;
     vlm_t *p_vlm = libvlc_priv( vlc_object_instance(p_media) )->p_vlm;
     assert( p_vlm );
-    const char *psz_instance_name = NULL;
+    vlm_media_instance_sys_t *p_instance = NULL;
 
     for( int i = 0; i < p_media->i_instance; i++ )
     {
         if( p_media->instance[i]->player == player )
         {
-            psz_instance_name = p_media->instance[i]->psz_name;
+            p_instance = p_media->instance[i];
             break;
         }
     }
-    assert(psz_instance_name);
+    assert(p_instance);
+    const char *psz_instance_name = p_instance->psz_name;
     enum vlm_state_e vlm_state;
     switch (new_state)
     {
@@ -96,6 +97,10 @@ static void player_on_state_changed(vlc_player_t *player,
     }
     vlm_SendEventMediaInstanceState( p_vlm, p_media->cfg.id, p_media->cfg.psz_name, psz_instance_name, vlm_state );
 
+    if( new_state != VLC_PLAYER_STATE_STOPPED )
+        return;
+
+    atomic_store( &p_instance->stopped, true );
     vlc_mutex_lock( &p_vlm->lock_manage );
     p_vlm->input_state_changed = true;
     vlc_cond_signal( &p_vlm->wait_manage );
@@ -140,9 +145,11 @@ vlm_t *vlm_New( libvlc_int_t *libvlc, const char *psz_vlmconf )
     vlc_cond_init( &p_vlm->wait_manage );
     p_vlm->users = 1;
     p_vlm->input_state_changed = false;
+    p_vlm->schedule_changed = false;
     p_vlm->exiting = false;
     p_vlm->i_id = 1;
     TAB_INIT( p_vlm->i_media, p_vlm->media );
+    vlc_dictionary_init( &p_vlm->media_by_name, 0 );
     TAB_INIT( p_vlm->i_schedule, p_vlm->schedule );
     var_Create( p_vlm, "intf-event", VLC_VAR_ADDRESS );
 
@@ -202,6 +209,7 @@ void vlm_Delete( vlm_t *p_vlm )
     vlc_mutex_lock( &p_vlm->lock );
     vlm_ControlInternal( p_vlm, VLM_CLEAR_MEDIAS );
     TAB_CLEAN( p_vlm->i_media, p_vlm->media );
+    vlc_dictionary_clear( &p_vlm->media_by_name, NULL, NULL );
 
     vlm_ControlInternal( p_vlm, VLM_CLEAR_SCHEDULES );
     TAB_CLEAN( p_vlm->i_schedule, p_vlm->schedule );
@@ -240,8 +248,8 @@ int vlm_ExecuteCommand( vlm_t *p_vlm, const char *psz_command,
 static void* Manage( void* p_object )
 {
     vlm_t *vlm = (vlm_t*)p_object;
-    time_t lastcheck;
-    bool exiting;
+    time_t lastcheck, nextschedule = 0;
+    bool exiting, input_state_changed = false, schedule_changed = true;
 
     time(&lastcheck);
 
@@ -250,9 +258,11 @@ static void* Manage( void* p_object )
         char **ppsz_scheduled_commands = NULL;
         int    i_scheduled_commands = 0;
 
-        /* destroy the inputs that wants to die, and launch the next input */
+        /* destroy the inputs that wants to die, and launch the next input.
+         * Only the instances whose player stopped are looked at: the others
+         * are not locked, however many media there are. */
         vlc_mutex_lock( &vlm->lock );
-        for( int i = 0; i < vlm->i_media; i++ )
+        for( int i = 0; input_state_changed && i < vlm->i_media; i++ )
         {
             vlm_media_sys_t *p_media = vlm->media[i];
 
@@ -260,6 +270,12 @@ static void* Manage( void* p_object )
             {
                 vlm_media_instance_sys_t *p_instance = p_media->instance[j];
 
+                if( !atomic_exchange( &p_instance->stopped, false ) )
+                {
+                    j++;
+                    continue;
+                }
+
                 vlc_player_Lock(p_instance->player);
                 if (!vlc_player_IsStarted(p_instance->player))
                 {
@@ -286,11 +302,15 @@ static void* Manage( void* p_object )
             }
         }
 
-        /* scheduling */
-        time_t now, nextschedule = 0;
+        /* scheduling, when a schedule is due or was changed */
+        time_t now;
 
         time(&now);
 
+        if( !schedule_changed && (nextschedule == 0 || now < nextschedule) )
+            goto wait;
+        nextschedule = 0;
+
         for( int i = 0; i < vlm->i_schedule; i++ )
         {
             time_t real_date = vlm->schedule[i]->date;
@@ -353,11 +373,13 @@ static void* Manage( void* p_object )
         }
 
         lastcheck = now;
+    wait:
         vlc_mutex_unlock( &vlm->lock );
 
         vlc_mutex_lock( &vlm->lock_manage );
 
-        while( !vlm->input_state_changed && !(exiting = vlm->exiting) )
+        while( !vlm->input_state_changed && !vlm->schedule_changed
+            && !(exiting = vlm->exiting) )
         {
             if( nextschedule )
             {
@@ -369,7 +391,10 @@ static void* Manage( void* p_object )
             else
                 vlc_cond_wait( &vlm->wait_manage, &vlm->lock_manage );
         }
+        input_state_changed = vlm->input_state_changed;
+        schedule_changed = vlm->schedule_changed;
         vlm->input_state_changed = false;
+        vlm->schedule_changed = false;
         vlc_mutex_unlock( &vlm->lock_manage );
     }
     while( !exiting );
@@ -395,21 +420,29 @@ typedef struct
 /* */
 static vlm_media_sys_t *vlm_ControlMediaGetById( vlm_t *p_vlm, int64_t id )
 {
-    for( int i = 0; i < p_vlm->i_media; i++ )
+    /* the ids are allocated in increasing order, and the media appended */
+    int lo = 0, hi = p_vlm->i_media;
+
+    while( lo < hi )
     {
-        if( p_vlm->media[i]->cfg.id == id )
-            return p_vlm->media[i];
+        int mid = lo + (hi - lo) / 2;
+        int64_t mid_id = p_vlm->media[mid]->cfg.id;
+
+        if( mid_id == id )
+            return p_vlm->media[mid];
+        if( mid_id < id )
+            lo = mid + 1;
+        else
+            hi = mid;
     }
     return NULL;
 }
 static vlm_media_sys_t *vlm_ControlMediaGetByName( vlm_t *p_vlm, const char *psz_name )
 {
-    for( int i = 0; i < p_vlm->i_media; i++ )
-    {
-        if( !strcmp( p_vlm->media[i]->cfg.psz_name, psz_name ) )
-            return p_vlm->media[i];
-    }
-    return NULL;
+    vlm_media_sys_t *p_media =
+        vlc_dictionary_value_for_key( &p_vlm->media_by_name, psz_name );
+
+    return p_media != kVLCDictionaryNotFound ? p_media : NULL;
 }
 static int vlm_MediaDescriptionCheck( vlm_t *p_vlm, vlm_media_t *p_cfg )
 {
@@ -453,8 +486,12 @@ static int vlm_ControlMediaChange( vlm_t *p_vlm, vlm_media_t *p_cfg )
         /* TODO check what are the changes being done (stop instance if needed) */
     }
 
+    vlc_dictionary_remove_value_for_key( &p_vlm->media_by_name,
+                                         p_media->cfg.psz_name, NULL, NULL );
     vlm_media_Clean( &p_media->cfg );
     vlm_media_Copy( &p_media->cfg, p_cfg );
+    vlc_dictionary_insert( &p_vlm->media_by_name, p_media->cfg.psz_name,
+                           p_media );
 
     return vlm_OnMediaUpdate( p_vlm, p_media );
 }
@@ -498,6 +535,8 @@ static int vlm_ControlMediaAdd( vlm_t *p_vlm, vlm_media_t *p_cfg, int64_t *p_id
 
     /* */
     TAB_APPEND( p_vlm->i_media, p_vlm->media, p_media );
+    vlc_dictionary_insert( &p_vlm->media_by_name, p_media->cfg.psz_name,
+                           p_media );
 
     if( p_id )
         *p_id = p_media->cfg.id;
@@ -520,6 +559,8 @@ static int vlm_ControlMediaDel( vlm_t *p_vlm, int64_t id )
     /* */
     vlm_SendEventMediaRemoved( p_vlm, id, p_media->cfg.psz_name );
 
+    vlc_dictionary_remove_value_for_key( &p_vlm->media_by_name,
+                                         p_media->cfg.psz_name, NULL, NULL );
     vlm_media_Clean( &p_media->cfg );
 
     TAB_REMOVE( p_vlm->i_media, p_vlm->media, p_media );
@@ -599,6 +640,7 @@ static vlm_media_instance_sys_t *vlm_MediaInstanceNew( vlm_media_sys_t *p_media,
         goto error;
 
     p_instance->i_index = 0;
+    atomic_init( &p_instance->stopped, false );
     p_instance->p_parent = vlc_object_create( p_media, sizeof (vlc_object_t) );
     if (!p_instance->p_parent)
         goto error;
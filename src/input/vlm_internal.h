@@ -23,6 +23,9 @@
 #ifndef LIBVLC_VLM_INTERNAL_H
 #define LIBVLC_VLM_INTERNAL_H 1
 
+#include <stdatomic.h>
+
+#include <vlc_arrays.h>
 #include <vlc_vlm.h>
 #include <vlc_player.h>
 #include "input_interface.h"
@@ -41,6 +44,8 @@ typedef struct
     vlc_player_t *player;
     vlc_player_listener_id *listener;
 
+    /* the player stopped, the manage thread shall move to the next input */
+    atomic_bool stopped;
 } vlm_media_instance_sys_t;
 
 
@@ -86,13 +91,15 @@ struct vlm_t
 
     /* tell vlm thread there is work to do */
     bool         input_state_changed;
+    bool         schedule_changed;
     bool         exiting;
     /* */
     int64_t        i_id;
 
-    /* Media list */
+    /* Media list, sorted by id */
     int                i_media;
     vlm_media_sys_t    **media;
+    vlc_dictionary_t   media_by_name;
 
     /* Schedule list */
     int            i_schedule;
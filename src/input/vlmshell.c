@@ -632,7 +632,7 @@ static int ExecuteScheduleProperty( vlm_t *p_vlm, vlm_schedule_sys_t *p_schedule
     *pp_status = vlm_MessageSimpleNew( psz_cmd );
 
     vlc_mutex_lock( &p_vlm->lock_manage );
-    p_vlm->input_state_changed = true;
+    p_vlm->schedule_changed = true;
     vlc_cond_signal( &p_vlm->wait_manage );
     vlc_mutex_unlock( &p_vlm->lock_manage );
 
@@ -89,6 +89,23 @@ static const char *const ppsz_snap_formats[] =
     "This is the verbosity level (0=only errors and " \
     "standard messages, 1=warnings, 2=debug).")
 
+#define LOG_ASYNC_TEXT N_("Asynchronous logging")
+#define LOG_ASYNC_LONGTEXT N_( \
+    "Hand the log messages over to a dedicated thread, so that the " \
+    "emitting threads do not wait for the message log output.")
+
+#define LOG_FILTER_TEXT N_("Per-module verbosity")
+#define LOG_FILTER_LONGTEXT N_( \
+    "Comma-separated list of module=verbosity entries, such as " \
+    "\"avcodec=2,ts=0\". The \"*\" entry applies to the other modules. " \
+    "Filtered messages are discarded before they are formatted. " \
+    "This requires asynchronous logging.")
+
+#define LOG_RATE_TEXT N_("Message rate limit")
+#define LOG_RATE_LONGTEXT N_( \
+    "Maximum number of messages per second from a single source code " \
+    "location, 0 for unlimited. This requires asynchronous logging.")
+
 #define OPEN_TEXT N_("Default stream")
 #define OPEN_LONGTEXT N_( \
     "This stream will always be opened at VLC startup." )
@@ -238,6 +255,19 @@ static const char *const ppsz_replay_gain_mode[] = {
 static const char *const ppsz_replay_gain_mode_text[] = {
     N_("None"), N_("Track"), N_("Album") };
 
+#define AUDIO_DRIFT_TEXT N_( \
+    "Audio drift correction" )
+#define AUDIO_DRIFT_LONGTEXT N_( \
+    "How the audio output catches up when it drifts from the clock. " \
+    "Resampling adjusts the playback rate of the whole stream. " \
+    "Sample stuffing inserts or drops single frames at quiet points, " \
+    "which suits small and steady drifts." )
+
+static const char *const ppsz_audio_drift[] = {
+    "resampling", "stuffing" };
+static const char *const ppsz_audio_drift_text[] = {
+    N_("Resampling"), N_("Sample stuffing") };
+
 /*****************************************************************************
  * Video
  ****************************************************************************/
@@ -536,6 +566,21 @@ static const char *const screensaver_texts[] = {
     "This defines the maximum input delay jitter that the synchronization " \
     "algorithms should try to compensate (in milliseconds)." )
 
+#define FAST_START_TEXT N_("Fast start")
+#define FAST_START_LONGTEXT N_( \
+    "Start playing live streams once a quarter of the caching is buffered, " \
+    "and play them slightly slower until the buffer is full." )
+
+#define FAST_START_RATE_TEXT N_("Fast start playback speed")
+#define FAST_START_RATE_LONGTEXT N_( \
+    "Playback speed while the buffer is filling up in fast start mode. " \
+    "The lower, the faster the buffer fills up." )
+
+#define ADAPTIVE_CACHING_TEXT N_("Adaptive caching")
+#define ADAPTIVE_CACHING_LONGTEXT N_( \
+    "Adjust the buffered duration of live streams to the measured network " \
+    "jitter, by playing them slightly faster or slower." )
+
 #define CLOCK_MASTER_TEXT N_("Clock master source")
 
 static const int pi_clock_master_values[] = {
@@ -649,7 +694,9 @@ static const char *const ppsz_prefres[] = {
 
 #define INPUT_LOWDELAY_TEXT N_("Low delay mode")
 #define INPUT_LOWDELAY_LONGTEXT N_(\
-    "Try to minimize delay along decoding chain."\
+    "Try to minimize delay along decoding chain: no output clock " \
+    "dejitter, no extra input buffering, no frame-threaded or delayed " \
+    "video decoding, and minimal audio output buffering. " \
     "Might break with non compliant streams.")
 
 #define INPUT_REPEAT_TEXT N_("Input repetitions")
@@ -672,6 +719,11 @@ static const char *const ppsz_prefres[] = {
 #define INPUT_FAST_SEEK_LONGTEXT N_( \
     "Favor speed over precision while seeking" )
 
+#define INDEX_CACHE_TEXT N_("Cache the file indexes")
+#define INDEX_CACHE_LONGTEXT N_( \
+    "Save the indexes built by the demuxers for the local files, and load " \
+    "them the next time the same files are opened." )
+
 #define INPUT_RATE_TEXT N_("Playback speed")
 #define INPUT_RATE_LONGTEXT N_( \
     "This defines the playback speed (nominal speed is 1.0)." )
@@ -708,6 +760,21 @@ static const char *const ppsz_prefres[] = {
     "When possible, the input stream will be recorded instead of using " \
     "the stream output module" )
 
+#define INPUT_SHARE_TEXT N_("Share the live inputs")
+#define INPUT_SHARE_LONGTEXT N_( \
+    "The inputs opening the same live MRL (network streams, capture " \
+    "devices) share one access and demux, instead of opening it once each." )
+
+#define INPUT_CPUS_TEXT N_("Input CPUs")
+#define INPUT_CPUS_LONGTEXT N_( \
+    "List of the CPUs to run the input threads on, as \"0-3,8\". The " \
+    "decoder and output threads created by the input run on them too.")
+
+#define INPUT_NUMA_NODE_TEXT N_("Input NUMA node")
+#define INPUT_NUMA_NODE_LONGTEXT N_( \
+    "NUMA node to run the input threads on, so that their buffers are " \
+    "allocated in the memory of that node. -1 for any node.")
+
 #define INPUT_TIMESHIFT_PATH_TEXT N_("Timeshift directory")
 #define INPUT_TIMESHIFT_PATH_LONGTEXT N_( \
     "Directory used to store the timeshift temporary files." )
@@ -953,11 +1020,22 @@ static const char *const ppsz_prefres[] = {
     "before trying the other ones. Only advanced users should " \
     "alter this option as it can break playback of all your streams." )
 
+#define PACKETIZER_THREAD_TEXT N_("Packetize in a separate thread")
+#define PACKETIZER_THREAD_LONGTEXT N_( \
+    "Run the video packetizer and the decoder in two threads, so that they " \
+    "can overlap. This helps decoders without multi-threading support." )
+
 #define HW_DEC_TEXT N_("Enable hardware decoders")
 #define HW_DEC_LONGTEXT N_( \
     "VLC will fallback automatically to software decoders in case of " \
     "hardware decoder failure." )
 
+#define THUMBNAIL_HW_DEC_TEXT N_("Hardware decoders for thumbnails")
+#define THUMBNAIL_HW_DEC_LONGTEXT N_( \
+    "Decode thumbnails with the hardware decoders too, in which case the " \
+    "pictures are scaled by the hardware before being read back when " \
+    "possible. This trades CPU time for loading the hardware decoders." )
+
 #define DEC_DEV_TEXT N_("Preferred decoder hardware device")
 #define DEC_DEV_LONGTEXT N_("This allows hardware decoding when available.")
 
@@ -1009,6 +1087,12 @@ static const char *const ppsz_prefres[] = {
     "This allow you to configure the initial caching amount for stream output " \
     "muxer. This value should be set in milliseconds." )
 
+#define SOUT_ENC_THREADS_TEXT N_("Encoder threads budget")
+#define SOUT_ENC_THREADS_LONGTEXT N_( \
+    "Maximum number of threads shared by all the encoders of the process. " \
+    "Each encoder gets what it asks for within what the others left, and " \
+    "at least one thread. 0 means the number of CPUs." )
+
 #define PACKETIZER_TEXT N_("Preferred packetizer list")
 #define PACKETIZER_LONGTEXT N_( \
     "This allows you to select the order in which VLC will choose its " \
@@ -1083,6 +1167,11 @@ static const char *const ppsz_prefres[] = {
 #define STATS_LONGTEXT N_( \
      "Collect miscellaneous local statistics about the playing media.")
 
+#define TRACE_FILE_TEXT N_("Pipeline trace file")
+#define TRACE_FILE_LONGTEXT N_( \
+     "Record when data goes through each stage of the playback pipeline, " \
+     "and write it to this file on exit, in the Chrome trace event format.")
+
 #define ONEINSTANCE_TEXT N_("Allow only one running instance")
 #define ONEINSTANCE_LONGTEXT N_( \
     "Allowing only one running instance of VLC can sometimes be useful, " \
@@ -1158,10 +1247,30 @@ static const char *const clock_sources_text[] = {
 #define PREPARSE_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to preparse items" )
 
+#define PREPARSE_CACHE_TEXT N_( "Cache the preparsing results" )
+#define PREPARSE_CACHE_LONGTEXT N_( \
+    "Save the metadata, tracks and subitems found when preparsing local " \
+    "files, and reuse them as long as the files are not modified." )
+
+#define PREPARSE_CACHE_TTL_TEXT N_( "Preparsing cache lifetime" )
+#define PREPARSE_CACHE_TTL_LONGTEXT N_( \
+    "Maximum age of a cached preparsing result, in seconds " \
+    "(0 for no limit)" )
+
 #define FETCH_ART_THREADS_TEXT N_( "Fetch-art threads" )
 #define FETCH_ART_THREADS_LONGTEXT N_( \
     "Maximum number of threads used to fetch art" )
 
+#define FETCH_ART_HOST_LIMIT_TEXT N_( "Fetch-art downloads per host" )
+#define FETCH_ART_HOST_LIMIT_LONGTEXT N_( \
+    "Maximum number of simultaneous art downloads from the same host " \
+    "(0 for no limit)" )
+
+#define FETCH_ART_VARIANTS_TEXT N_( "Store downscaled art" )
+#define FETCH_ART_VARIANTS_LONGTEXT N_( \
+    "Store copies of the fetched art downscaled to 64, 256 and 1024 " \
+    "pixels, so that interfaces showing many covers load them faster." )
+
 #define METADATA_NETWORK_TEXT N_( "Allow metadata network access" )
 
 static const char *const psz_recursive_list[] = {
@@ -1570,6 +1679,9 @@ vlc_module_begin ()
 
     add_bool( "audio-time-stretch", true,
               AUDIO_TIME_STRETCH_TEXT, AUDIO_TIME_STRETCH_LONGTEXT, false )
+    add_string( "audio-drift-correction", "resampling",
+                AUDIO_DRIFT_TEXT, AUDIO_DRIFT_LONGTEXT, true )
+        change_string_list( ppsz_audio_drift, ppsz_audio_drift_text )
 
     set_subcategory( SUBCAT_AUDIO_AOUT )
     add_module("aout", "audio output", NULL, AOUT_TEXT, AOUT_LONGTEXT)
@@ -1828,6 +1940,8 @@ vlc_module_begin ()
     add_bool( "input-fast-seek", false,
               INPUT_FAST_SEEK_TEXT, INPUT_FAST_SEEK_LONGTEXT, false )
         change_safe ()
+    add_bool( "index-cache", false,
+              INDEX_CACHE_TEXT, INDEX_CACHE_LONGTEXT, true )
     add_float( "rate", 1.,
                INPUT_RATE_TEXT, INPUT_RATE_LONGTEXT, false )
 
@@ -1980,11 +2094,23 @@ vlc_module_begin ()
     add_integer( "clock-master", VLC_CLOCK_MASTER_DEFAULT,
                  CLOCK_MASTER_TEXT, NULL, true )
         change_integer_list( pi_clock_master_values, ppsz_clock_master_descriptions )
+    add_bool( "fast-start", false, FAST_START_TEXT, FAST_START_LONGTEXT, true )
+    add_float( "fast-start-rate", 0.9f, FAST_START_RATE_TEXT,
+               FAST_START_RATE_LONGTEXT, true )
+        change_float_range( 0.5f, 0.99f )
+    add_bool( "adaptive-caching", false, ADAPTIVE_CACHING_TEXT,
+              ADAPTIVE_CACHING_LONGTEXT, true )
 
     add_directory("input-record-path", NULL,
                   INPUT_RECORD_PATH_TEXT, INPUT_RECORD_PATH_LONGTEXT)
     add_bool( "input-record-native", true, INPUT_RECORD_NATIVE_TEXT,
               INPUT_RECORD_NATIVE_LONGTEXT, true )
+    add_bool( "input-share", false, INPUT_SHARE_TEXT,
+              INPUT_SHARE_LONGTEXT, true )
+    add_string( "input-cpus", NULL, INPUT_CPUS_TEXT,
+                INPUT_CPUS_LONGTEXT, true )
+    add_integer( "input-numa-node", -1, INPUT_NUMA_NODE_TEXT,
+                 INPUT_NUMA_NODE_LONGTEXT, true )
 
     add_directory("input-timeshift-path", NULL,
                   INPUT_TIMESHIFT_PATH_TEXT, INPUT_TIMESHIFT_PATH_LONGTEXT)
@@ -1999,6 +2125,10 @@ vlc_module_begin ()
     add_string( "codec", NULL, CODEC_TEXT,
                 CODEC_LONGTEXT, true )
     add_bool( "hw-dec", true, HW_DEC_TEXT, HW_DEC_LONGTEXT, true )
+    add_bool( "thumbnail-hw-dec", false, THUMBNAIL_HW_DEC_TEXT,
+              THUMBNAIL_HW_DEC_LONGTEXT, true )
+    add_bool( "packetizer-thread", false, PACKETIZER_THREAD_TEXT,
+              PACKETIZER_THREAD_LONGTEXT, true )
     add_obsolete_string( "encoder" ) /* since 4.0.0 */
     add_module("dec-dev", "decoder device", "any", DEC_DEV_TEXT, DEC_DEV_LONGTEXT)
 
@@ -2038,6 +2168,9 @@ vlc_module_begin ()
                                 SOUT_SPU_LONGTEXT, true )
     add_integer( "sout-mux-caching", 1500, SOUT_MUX_CACHING_TEXT,
                                 SOUT_MUX_CACHING_LONGTEXT, true )
+    add_integer( "sout-encoder-threads", 0, SOUT_ENC_THREADS_TEXT,
+                                SOUT_ENC_THREADS_LONGTEXT, true )
+        change_integer_range( 0, 1024 )
 
     set_section( N_("VLM"), NULL )
     add_loadfile("vlm-conf", NULL, VLM_CONF_TEXT, VLM_CONF_LONGTEXT)
@@ -2176,8 +2309,17 @@ vlc_module_begin ()
     add_integer( "preparse-threads", 1, PREPARSE_THREADS_TEXT,
                  PREPARSE_THREADS_LONGTEXT, false )
 
+    add_bool( "preparse-cache", false, PREPARSE_CACHE_TEXT,
+              PREPARSE_CACHE_LONGTEXT, true )
+    add_integer( "preparse-cache-ttl", 7 * 24 * 3600, PREPARSE_CACHE_TTL_TEXT,
+                 PREPARSE_CACHE_TTL_LONGTEXT, true )
+
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT, false )
+    add_integer( "fetch-art-host-limit", 2, FETCH_ART_HOST_LIMIT_TEXT,
+                 FETCH_ART_HOST_LIMIT_LONGTEXT, false )
+    add_bool( "fetch-art-variants", false, FETCH_ART_VARIANTS_TEXT,
+              FETCH_ART_VARIANTS_LONGTEXT, true )
 
     add_obsolete_integer( "album-art" )
     add_bool( "metadata-network-access", false, METADATA_NETWORK_TEXT,
@@ -2208,6 +2350,11 @@ vlc_module_begin ()
         change_short('v')
         change_volatile ()
     add_obsolete_string( "verbose-objects" ) /* since 2.1.0 */
+    add_bool( "log-async", false, LOG_ASYNC_TEXT, LOG_ASYNC_LONGTEXT, true )
+    add_string( "log-filter", NULL, LOG_FILTER_TEXT, LOG_FILTER_LONGTEXT,
+                true )
+    add_integer( "log-rate-limit", 0, LOG_RATE_TEXT, LOG_RATE_LONGTEXT, true )
+        change_integer_range( 0, INT_MAX )
 #if !defined(_WIN32) && !defined(__OS2__)
     add_obsolete_bool( "daemon" ) /* since 4.0.0 */
         change_short('d')
@@ -2225,6 +2372,7 @@ vlc_module_begin ()
               INTERACTION_LONGTEXT, false )
 
     add_bool ( "stats", true, STATS_TEXT, STATS_LONGTEXT, true )
+    add_savefile("trace-file", NULL, TRACE_FILE_TEXT, TRACE_FILE_LONGTEXT)
 
     set_subcategory( SUBCAT_INTERFACE_MAIN )
     add_module_cat("intf", SUBCAT_INTERFACE_MAIN, NULL,
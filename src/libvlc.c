@@ -95,6 +95,11 @@ libvlc_int_t * libvlc_InternalCreate( void )
     priv->main_playlist = NULL;
     priv->p_vlm = NULL;
     priv->media_source_provider = NULL;
+    priv->p_media_library = NULL;
+    priv->b_media_library_loaded = false;
+    priv->p_thumbnailer = NULL;
+    priv->tracer = NULL;
+    priv->image_handler_count = 0;
 
     vlc_ExitInit( &priv->exit );
 
@@ -118,6 +123,17 @@ static void libvlc_AddInterfaces(libvlc_int_t *libvlc, const char *varname)
     free(str);
 }
 
+/* Logs the time taken by each startup step, to find where it goes */
+static void libvlc_TraceStartup( libvlc_int_t *p_libvlc, const char *step,
+                                 vlc_tick_t *last )
+{
+    vlc_tick_t now = vlc_tick_now();
+
+    msg_Dbg( p_libvlc, "startup: %s took %"PRId64" us", step,
+             US_FROM_VLC_TICK(now - *last) );
+    *last = now;
+}
+
 /**
  * Initialize a libvlc instance
  * This function initializes a previously allocated libvlc instance:
@@ -132,6 +148,8 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     libvlc_priv_t *priv = libvlc_priv (p_libvlc);
     char        *psz_val;
     int          i_ret = VLC_EGENERIC;
+    const vlc_tick_t start = vlc_tick_now();
+    vlc_tick_t last = start;
 
     if (unlikely(vlc_LogPreinit(p_libvlc)))
         return VLC_ENOMEM;
@@ -144,6 +162,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
      * a short help if required by the user. (short help == core module
      * options) */
     module_InitBank ();
+    libvlc_TraceStartup( p_libvlc, "module bank", &last );
 
     /* Get command line options that affect module loading. */
     if( config_LoadCmdLine( p_libvlc, i_argc, ppsz_argv, NULL ) )
@@ -159,6 +178,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
      * list of configuration options exported by each module and loads their
      * default values. */
     module_LoadPlugins (p_libvlc);
+    libvlc_TraceStartup( p_libvlc, "plugins", &last );
 
     /*
      * Override default configuration with config file settings
@@ -179,6 +199,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
         goto error;
 
     vlc_LogInit(p_libvlc);
+    libvlc_TraceStartup( p_libvlc, "configuration", &last );
 
     /*
      * Support for gettext
@@ -200,27 +221,19 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
 
     if( libvlc_InternalDialogInit( p_libvlc ) != VLC_SUCCESS )
         goto error;
-    if( libvlc_InternalKeystoreInit( p_libvlc ) != VLC_SUCCESS )
-        msg_Warn( p_libvlc, "memory keystore init failed" );
+    libvlc_InternalKeystoreInit( p_libvlc );
 
     vlc_CPU_dump( VLC_OBJECT(p_libvlc) );
 
-    if( var_InheritBool( p_libvlc, "media-library") )
-    {
-        priv->p_media_library = libvlc_MlCreate( p_libvlc );
-        if ( priv->p_media_library == NULL )
-            msg_Warn( p_libvlc, "Media library initialization failed" );
-    }
-
-    priv->p_thumbnailer = vlc_thumbnailer_Create( VLC_OBJECT( p_libvlc ) );
-    if ( priv->p_thumbnailer == NULL )
-        msg_Warn( p_libvlc, "Failed to instantiate thumbnailer" );
+    priv->tracer = vlc_tracer_Create( VLC_OBJECT(p_libvlc) );
+    libvlc_TraceStartup( p_libvlc, "dialogs and tracer", &last );
 
     /*
      * Initialize hotkey handling
      */
     if( libvlc_InternalActionsInit( p_libvlc ) != VLC_SUCCESS )
         goto error;
+    libvlc_TraceStartup( p_libvlc, "hotkeys", &last );
 
     /*
      * Meta data handling
@@ -232,6 +245,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     priv->media_source_provider = vlc_media_source_provider_New( VLC_OBJECT( p_libvlc ) );
     if( !priv->media_source_provider )
         goto error;
+    libvlc_TraceStartup( p_libvlc, "preparser", &last );
 
     /* variables for signalling creation of new files */
     var_Create( p_libvlc, "snapshot-file", VLC_VAR_STRING );
@@ -278,6 +292,7 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
      */
     libvlc_AddInterfaces(p_libvlc, "extraintf");
     libvlc_AddInterfaces(p_libvlc, "control");
+    libvlc_TraceStartup( p_libvlc, "interfaces", &last );
 
 #ifdef __APPLE__
     var_Create( p_libvlc, "drawable-view-top", VLC_VAR_INTEGER );
@@ -322,6 +337,8 @@ int libvlc_InternalInit( libvlc_int_t *p_libvlc, int i_argc,
     /* Create a variable for showing the main interface */
     var_Create(p_libvlc, "intf-show", VLC_VAR_VOID);
 
+    msg_Dbg( p_libvlc, "startup: ready in %"PRId64" us",
+             US_FROM_VLC_TICK(vlc_tick_now() - start) );
     return VLC_SUCCESS;
 
 error:
@@ -349,6 +366,7 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
 
     libvlc_InternalDialogClean( p_libvlc );
     libvlc_InternalKeystoreClean( p_libvlc );
+    libvlc_ImageHandlersClean( p_libvlc );
 
 #ifdef ENABLE_VLM
     /* Destroy VLM if created in libvlc_InternalInit */
@@ -384,6 +402,9 @@ void libvlc_InternalCleanup( libvlc_int_t *p_libvlc )
 
     libvlc_InternalActionsClean( p_libvlc );
 
+    if( priv->tracer != NULL )
+        vlc_tracer_Destroy( priv->tracer );
+
     /* Save the configuration */
     if( !var_InheritBool( p_libvlc, "ignore-config" ) )
         config_AutoSaveConfigFile( VLC_OBJECT(p_libvlc) );
@@ -522,3 +543,19 @@ void libvlc_MetadataCancel(libvlc_int_t *libvlc, void *id)
 
     input_preparser_Cancel(priv->parser, id);
 }
+
+/**
+ * Moves the pending extraction requests of an id before the others.
+ *
+ * This is meant for items that become visible to the user. It does nothing
+ * if there is no pending request for this id.
+ */
+void libvlc_MetadataPrioritize(libvlc_int_t *libvlc, void *id)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+
+    if (unlikely(priv->parser == NULL))
+        return;
+
+    input_preparser_Prioritize(priv->parser, id);
+}
@@ -40,6 +40,16 @@ void system_End(void);
 #endif
 void vlc_CPU_dump(vlc_object_t *);
 
+/**
+ * Restricts the calling thread, and the threads it creates afterwards, to a
+ * set of CPUs.
+ *
+ * \param cpus list of CPU numbers and ranges, e.g. "0-3,8", or NULL for all
+ * \param node NUMA node whose CPUs to use, or -1 for any
+ * \return 0 on success, ENOTSUP if not supported, or an error number
+ */
+int vlc_CPU_SetAffinity(const char *cpus, int node);
+
 /*
  * Threads subsystem
  */
@@ -48,9 +58,40 @@ int vlc_set_priority( vlc_thread_t, int );
 
 void vlc_threads_setup (libvlc_int_t *);
 
+/**
+ * Converts a date of vlc_tick_now() to the system monotonic clock.
+ *
+ * Both only differ when the tests run with an accelerated clock, through the
+ * VLC_CLOCK_SCALE environment variable.
+ */
+vlc_tick_t vlc_tick_to_monotonic(vlc_tick_t);
+
 void vlc_trace (const char *fn, const char *file, unsigned line);
 #define vlc_backtrace() vlc_trace(__func__, __FILE__, __LINE__)
 
+/*
+ * Instrumentation (--enable-instrumentation)
+ */
+enum vlc_instrument_kind
+{
+    VLC_INSTRUMENT_BLOCK,
+    VLC_INSTRUMENT_PICTURE,
+    VLC_INSTRUMENT_ES_FORMAT,
+    VLC_INSTRUMENT_LOCK,
+    VLC_INSTRUMENT_MAX
+};
+
+#ifdef HAVE_INSTRUMENTATION
+void vlc_instrument_Add(enum vlc_instrument_kind, const void *caller,
+                        uint64_t value);
+/* Accounts an event (with a size or a duration) to the caller of the
+ * current function */
+# define vlc_instrument(kind, value) \
+    vlc_instrument_Add(kind, __builtin_return_address(0), value)
+#else
+# define vlc_instrument(kind, value) ((void)0)
+#endif
+
 /*
  * Logging
  */
@@ -71,6 +112,12 @@ typedef struct vlc_exit
 
 void vlc_ExitInit( vlc_exit_t * );
 
+/*
+ * Pipeline tracer
+ */
+struct vlc_tracer *vlc_tracer_Create(vlc_object_t *);
+void vlc_tracer_Destroy(struct vlc_tracer *);
+
 /*
  * LibVLC objects stuff
  */
@@ -180,7 +227,7 @@ typedef struct libvlc_priv_t
     libvlc_int_t       public_data;
 
     /* Singleton objects */
-    vlc_mutex_t lock; ///< protect playlist and interfaces
+    vlc_mutex_t lock; ///< protect playlist, interfaces and lazy singletons
     vlm_t             *p_vlm;  ///< the VLM singleton (or NULL)
     vlc_dialog_provider *p_dialog_provider; ///< dialog provider
     vlc_keystore      *p_memory_keystore; ///< memory keystore
@@ -189,8 +236,12 @@ typedef struct libvlc_priv_t
     struct input_preparser_t *parser; ///< Input item meta data handler
     vlc_media_source_provider_t *media_source_provider;
     vlc_actions_t *actions; ///< Hotkeys handler
-    struct vlc_medialibrary_t *p_media_library; ///< Media library instance
+    struct vlc_medialibrary_t *p_media_library; ///< Lazily loaded media library
+    bool b_media_library_loaded; ///< Media library load attempted
     struct vlc_thumbnailer_t *p_thumbnailer; ///< Lazily instantiated media thumbnailer
+    struct vlc_tracer *tracer; ///< Pipeline tracer (or NULL)
+    image_handler_t *image_handlers[4]; ///< Idle handlers of picture_Export()
+    unsigned image_handler_count;
 
     /* Exit callback */
     vlc_exit_t       exit;
@@ -205,6 +256,13 @@ int intf_InsertItem(libvlc_int_t *, const char *mrl, unsigned optc,
                     const char * const *optv, unsigned flags);
 void intf_DestroyAll( libvlc_int_t * );
 
+/*
+ * Image handlers
+ */
+image_handler_t *libvlc_ImageHandlerAcquire(libvlc_int_t *);
+void libvlc_ImageHandlerRelease(libvlc_int_t *, image_handler_t *);
+void libvlc_ImageHandlersClean(libvlc_int_t *);
+
 int vlc_MetadataRequest(libvlc_int_t *libvlc, input_item_t *item,
                         input_item_meta_request_option_t i_options,
                         const input_preparser_callbacks_t *cbs,
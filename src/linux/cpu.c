@@ -22,10 +22,14 @@
 # include "config.h"
 #endif
 
+#include <errno.h>
+#include <sched.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <vlc_common.h>
 #include <vlc_cpu.h>
+#include "libvlc.h"
 
 #undef CPU_FLAGS
 #if defined (__arm__) || defined (__aarch64__)
@@ -121,3 +125,93 @@ unsigned vlc_CPU_raw(void)
     return all_caps;
 }
 #endif
+
+/**
+ * Parses a CPU list, in the format of the sysfs cpulist files ("0-3,8").
+ */
+static int vlc_CPU_ParseList(const char *list, cpu_set_t *set)
+{
+    CPU_ZERO(set);
+
+    while (*list != '\0' && *list != '\n')
+    {
+        char *end;
+        unsigned long first = strtoul(list, &end, 10), last = first;
+
+        if (end == list)
+            return EINVAL;
+        if (*end == '-')
+        {
+            list = end + 1;
+            last = strtoul(list, &end, 10);
+            if (end == list || last < first)
+                return EINVAL;
+        }
+
+        for (unsigned long cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+            CPU_SET(cpu, set);
+
+        list = end;
+        if (*list == ',')
+            list++;
+        else if (*list != '\0' && *list != '\n')
+            return EINVAL;
+    }
+    return CPU_COUNT(set) > 0 ? 0 : EINVAL;
+}
+
+static int vlc_CPU_GetNode(int node, cpu_set_t *set)
+{
+    char path[64], buf[1024];
+
+    snprintf(path, sizeof (path), "/sys/devices/system/node/node%d/cpulist",
+             node);
+
+    FILE *stream = fopen(path, "rte");
+    if (stream == NULL)
+        return errno;
+
+    char *line = fgets(buf, sizeof (buf), stream);
+    fclose(stream);
+    return (line != NULL) ? vlc_CPU_ParseList(line, set) : EINVAL;
+}
+
+int vlc_CPU_SetAffinity(const char *cpus, int node)
+{
+    cpu_set_t set;
+    int ret;
+
+    if (cpus == NULL && node < 0)
+        return 0;
+
+    if (cpus != NULL)
+    {
+        ret = vlc_CPU_ParseList(cpus, &set);
+        if (ret)
+            return ret;
+    }
+
+    if (node >= 0)
+    {
+        cpu_set_t nodeset;
+
+        ret = vlc_CPU_GetNode(node, &nodeset);
+        if (ret)
+            return ret;
+        if (cpus != NULL)
+        {
+            CPU_AND(&set, &set, &nodeset);
+            if (CPU_COUNT(&set) == 0)
+                return EINVAL;
+        }
+        else
+            set = nodeset;
+    }
+
+    /* The threads created later inherit the affinity. With the default local
+     * allocation policy, the memory they touch first (pictures, blocks)
+     * then comes from the node of their CPUs. */
+    if (sched_setaffinity(0, sizeof (set), &set))
+        return errno;
+    return 0;
+}
@@ -38,6 +38,7 @@
 #endif
 
 #include <vlc_common.h>
+#include "libvlc.h"
 
 unsigned long vlc_thread_id(void)
 {
@@ -84,7 +85,7 @@ void vlc_atomic_wait(void *addr, unsigned val)
 
 int vlc_atomic_timedwait(void *addr, unsigned val, vlc_tick_t deadline)
 {
-    struct timespec ts = timespec_from_vlc_tick(deadline);
+    struct timespec ts = timespec_from_vlc_tick(vlc_tick_to_monotonic(deadline));
 
     if (vlc_futex_wait(addr, 0, val, &ts) == 0)
         return 0;
@@ -30,6 +30,7 @@
 #include <vlc_atomic.h>
 #include <vlc_input_item.h>
 #include <vlc_threads.h>
+#include <vlc_vector.h>
 #include "libvlc.h"
 
 struct vlc_media_tree_listener_id
@@ -44,6 +45,9 @@ typedef struct
     vlc_media_tree_t public_data;
 
     struct vlc_list listeners; /**< list of vlc_media_tree_listener_id.node */
+    /* media being preparsed which already posted subitems: large playlists
+     * post them in several batches */
+    struct VLC_VECTOR(input_item_t *) expanding;
     vlc_mutex_t lock;
     vlc_atomic_rc_t rc;
 } media_tree_private_t;
@@ -60,6 +64,7 @@ vlc_media_tree_New(void)
     vlc_mutex_init(&priv->lock);
     vlc_atomic_rc_init(&priv->rc);
     vlc_list_init(&priv->listeners);
+    vlc_vector_init(&priv->expanding);
 
     vlc_media_tree_t *tree = &priv->public_data;
     input_item_node_t *root = &tree->root;
@@ -162,6 +167,24 @@ media_subtree_changed(input_item_t *media, input_item_node_t *node,
         return;
     }
 
+    media_tree_private_t *priv = mt_priv(tree);
+    ssize_t index;
+    vlc_vector_index_of(&priv->expanding, media, &index);
+    if (index != -1)
+    {
+        /* next batch of subitems, keep the previous ones */
+        int count = subtree_root->i_children;
+        vlc_media_tree_AddSubtree(subtree_root, node);
+        vlc_media_tree_Notify(tree, on_children_added, subtree_root,
+                              &subtree_root->pp_children[count],
+                              subtree_root->i_children - count);
+        vlc_media_tree_Unlock(tree);
+        return;
+    }
+
+    if (vlc_vector_push(&priv->expanding, media))
+        input_item_Hold(media);
+
     vlc_media_tree_ClearChildren(subtree_root);
     vlc_media_tree_AddSubtree(subtree_root, node);
     vlc_media_tree_Notify(tree, on_children_reset, subtree_root);
@@ -174,8 +197,19 @@ media_subtree_preparse_ended(input_item_t *media,
                              void *user_data)
 {
     vlc_media_tree_t *tree = user_data;
+    media_tree_private_t *priv = mt_priv(tree);
 
     vlc_media_tree_Lock(tree);
+
+    /* no more subitems will be posted */
+    ssize_t index;
+    vlc_vector_index_of(&priv->expanding, media, &index);
+    if (index != -1)
+    {
+        vlc_vector_remove(&priv->expanding, index);
+        input_item_Release(media);
+    }
+
     input_item_node_t *subtree_root;
     /* TODO retrieve the node without traversing the tree */
     bool found = vlc_media_tree_FindNodeByMedia(&tree->root, media,
@@ -203,6 +237,10 @@ vlc_media_tree_Delete(vlc_media_tree_t *tree)
     vlc_list_foreach(listener, &priv->listeners, node)
         free(listener);
     vlc_list_init(&priv->listeners); /* reset */
+    input_item_t *media;
+    vlc_vector_foreach(media, &priv->expanding)
+        input_item_Release(media);
+    vlc_vector_destroy(&priv->expanding);
     vlc_media_tree_DestroyRootNode(tree);
     free(tree);
 }
@@ -32,8 +32,10 @@
 #include <fcntl.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_block.h>
 #include <vlc_fs.h>
+#include "libvlc.h"
 
 #ifndef NDEBUG
 static void block_Check (block_t *block)
@@ -105,6 +107,243 @@ static void BlockMetaCopy( block_t *restrict out, const block_t *in )
 /** Initial reserved header and footer size. */
 #define BLOCK_PADDING      32
 
+static block_t *block_Align (block_t *b, size_t size)
+{
+    static_assert ((BLOCK_PADDING % BLOCK_ALIGN) == 0,
+                   "BLOCK_PADDING must be a multiple of BLOCK_ALIGN");
+    b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
+    b->p_buffer = (void *)(((uintptr_t)b->p_buffer) & ~(BLOCK_ALIGN - 1));
+    b->i_buffer = size;
+    return b;
+}
+
+/*
+ * Pooled allocator (opt-in, set VLC_BLOCK_POOL=1 in the environment)
+ *
+ * Each thread owns a cache of free blocks per power-of-two size class.
+ * Blocks are always returned to the cache of the thread that allocated them:
+ * directly if released by the same thread, otherwise via a lock-free stack
+ * that the owner takes over as a whole once its local list runs dry.
+ * A cache lives as long as its thread or its outstanding blocks.
+ */
+#define BLOCK_POOL_MIN_SHIFT  8 /* 256 bytes */
+#define BLOCK_POOL_CLASSES   10 /* up to 128 KiB */
+#define BLOCK_POOL_DEPTH     64 /* free blocks kept per class */
+#define BLOCK_POOL_STATS    256 /* events between statistics updates */
+
+struct block_cache;
+
+struct block_pooled
+{
+    block_t self;
+    struct block_cache *cache;
+    struct block_pooled *next;
+    unsigned class;
+};
+
+struct block_cache
+{
+    vlc_atomic_rc_t rc; /* owner thread + outstanding blocks */
+    struct
+    {
+        struct block_pooled *first;
+        unsigned count;
+    } local[BLOCK_POOL_CLASSES];
+    _Atomic(struct block_pooled *) remote[BLOCK_POOL_CLASSES];
+    unsigned hits;
+    unsigned misses;
+};
+
+static vlc_once_t block_pool_once = VLC_STATIC_ONCE;
+static vlc_threadvar_t block_pool_key;
+static bool block_pool_enabled;
+static atomic_ullong block_pool_hits;
+static atomic_ullong block_pool_misses;
+
+static void block_pool_FreeList (struct block_pooled *list)
+{
+    while (list != NULL)
+    {
+        struct block_pooled *next = list->next;
+        free (list);
+        list = next;
+    }
+}
+
+static void block_pool_FlushStats (struct block_cache *cache)
+{
+    atomic_fetch_add_explicit (&block_pool_hits, cache->hits,
+                               memory_order_relaxed);
+    atomic_fetch_add_explicit (&block_pool_misses, cache->misses,
+                               memory_order_relaxed);
+    cache->hits = cache->misses = 0;
+}
+
+static void block_cache_Release (struct block_cache *cache)
+{
+    if (!vlc_atomic_rc_dec (&cache->rc))
+        return;
+
+    for (unsigned i = 0; i < BLOCK_POOL_CLASSES; i++)
+    {
+        block_pool_FreeList (cache->local[i].first);
+        block_pool_FreeList (atomic_load_explicit (&cache->remote[i],
+                                                   memory_order_acquire));
+    }
+    free (cache);
+}
+
+/* Thread exit: drop the free blocks, keep the cache for blocks in flight */
+static void block_cache_Destroy (void *data)
+{
+    struct block_cache *cache = data;
+
+    for (unsigned i = 0; i < BLOCK_POOL_CLASSES; i++)
+    {
+        block_pool_FreeList (cache->local[i].first);
+        cache->local[i].first = NULL;
+        cache->local[i].count = 0;
+        block_pool_FreeList (atomic_exchange_explicit (&cache->remote[i], NULL,
+                                                       memory_order_acquire));
+    }
+    block_pool_FlushStats (cache);
+    block_cache_Release (cache);
+}
+
+static void block_pool_Init (void)
+{
+    const char *env = getenv ("VLC_BLOCK_POOL");
+
+    if (env != NULL && atoi (env) > 0)
+        block_pool_enabled =
+            vlc_threadvar_create (&block_pool_key, block_cache_Destroy) == 0;
+}
+
+static struct block_cache *block_cache_Get (void)
+{
+    struct block_cache *cache = vlc_threadvar_get (block_pool_key);
+    if (likely(cache != NULL))
+        return cache;
+
+    cache = calloc (1, sizeof (*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    vlc_atomic_rc_init (&cache->rc);
+    for (unsigned i = 0; i < BLOCK_POOL_CLASSES; i++)
+        atomic_init (&cache->remote[i], NULL);
+
+    if (vlc_threadvar_set (block_pool_key, cache))
+    {
+        free (cache);
+        return NULL;
+    }
+    return cache;
+}
+
+static void block_pool_Release (block_t *block)
+{
+    struct block_pooled *b = container_of (block, struct block_pooled, self);
+    struct block_cache *cache = b->cache;
+    unsigned class = b->class;
+
+    if (vlc_threadvar_get (block_pool_key) == cache)
+    {
+        if (cache->local[class].count < BLOCK_POOL_DEPTH)
+        {
+            b->next = cache->local[class].first;
+            cache->local[class].first = b;
+            cache->local[class].count++;
+        }
+        else
+            free (b);
+    }
+    else
+    {
+        b->next = atomic_load_explicit (&cache->remote[class],
+                                        memory_order_relaxed);
+        while (!atomic_compare_exchange_weak_explicit (&cache->remote[class],
+                                                       &b->next, b,
+                                                       memory_order_release,
+                                                       memory_order_relaxed));
+    }
+    block_cache_Release (cache);
+}
+
+static const struct vlc_block_callbacks block_pool_cbs =
+{
+    block_pool_Release,
+};
+
+static struct block_pooled *block_pool_Get (struct block_cache *cache,
+                                            unsigned class)
+{
+    struct block_pooled *b = cache->local[class].first;
+
+    if (b == NULL)
+    {   /* Take over blocks released by other threads */
+        b = atomic_exchange_explicit (&cache->remote[class], NULL,
+                                      memory_order_acquire);
+        if (b == NULL)
+            return NULL;
+
+        unsigned count = 1;
+        struct block_pooled *last = b;
+        while (last->next != NULL && count < BLOCK_POOL_DEPTH)
+        {
+            last = last->next;
+            count++;
+        }
+        block_pool_FreeList (last->next);
+        last->next = NULL;
+        cache->local[class].count = count;
+    }
+
+    cache->local[class].first = b->next;
+    cache->local[class].count--;
+    return b;
+}
+
+static block_t *block_pool_Alloc (size_t alloc, size_t size)
+{
+    unsigned class = 0;
+    while ((alloc - 1) >> (BLOCK_POOL_MIN_SHIFT + class))
+        if (++class >= BLOCK_POOL_CLASSES)
+            return NULL;
+
+    struct block_cache *cache = block_cache_Get ();
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    const size_t length = (size_t)1 << (BLOCK_POOL_MIN_SHIFT + class);
+    struct block_pooled *b = block_pool_Get (cache, class);
+
+    if (b != NULL)
+        cache->hits++;
+    else
+    {
+        b = malloc (length);
+        if (unlikely(b == NULL))
+            return NULL;
+        b->cache = cache;
+        b->class = class;
+        cache->misses++;
+    }
+
+    if (cache->hits + cache->misses >= BLOCK_POOL_STATS)
+        block_pool_FlushStats (cache);
+
+    vlc_atomic_rc_inc (&cache->rc);
+    block_Init (&b->self, &block_pool_cbs, b + 1, length - sizeof (*b));
+    return block_Align (&b->self, size);
+}
+
+void block_PoolStats (uint64_t *restrict hits, uint64_t *restrict misses)
+{
+    *hits = atomic_load_explicit (&block_pool_hits, memory_order_relaxed);
+    *misses = atomic_load_explicit (&block_pool_misses, memory_order_relaxed);
+}
+
 block_t *block_Alloc (size_t size)
 {
     if (unlikely(size >> 27))
@@ -113,6 +352,17 @@ block_t *block_Alloc (size_t size)
         return NULL;
     }
 
+    vlc_instrument(VLC_INSTRUMENT_BLOCK, size);
+    vlc_once (&block_pool_once, block_pool_Init);
+    if (block_pool_enabled)
+    {
+        block_t *b = block_pool_Alloc (sizeof (struct block_pooled)
+                                       + BLOCK_ALIGN + (2 * BLOCK_PADDING)
+                                       + size, size);
+        if (b != NULL)
+            return b;
+    }
+
     /* 2 * BLOCK_PADDING: pre + post padding */
     const size_t alloc = sizeof (block_t) + BLOCK_ALIGN + (2 * BLOCK_PADDING)
                        + size;
@@ -124,12 +374,7 @@ block_t *block_Alloc (size_t size)
         return NULL;
 
     block_Init(b, &block_generic_cbs, b + 1, alloc - sizeof (*b));
-    static_assert ((BLOCK_PADDING % BLOCK_ALIGN) == 0,
-                   "BLOCK_PADDING must be a multiple of BLOCK_ALIGN");
-    b->p_buffer += BLOCK_PADDING + BLOCK_ALIGN - 1;
-    b->p_buffer = (void *)(((uintptr_t)b->p_buffer) & ~(BLOCK_ALIGN - 1));
-    b->i_buffer = size;
-    return b;
+    return block_Align (b, size);
 }
 
 void block_Release(block_t *block)
@@ -141,6 +386,121 @@ void block_Release(block_t *block)
     block->cbs->free(block);
 }
 
+/*
+ * Shared blocks
+ *
+ * A shared block is a view of the payload of another block, which is released
+ * with the last view. Views have no headroom nor tailroom of their own so that
+ * block_TryRealloc() makes a private copy before anything gets written.
+ */
+struct block_payload
+{
+    atomic_uint refs;
+    block_t *block;
+};
+
+struct block_shared
+{
+    block_t self;
+    struct block_payload *payload;
+};
+
+static void block_shared_Release (block_t *block)
+{
+    struct block_shared *b = container_of (block, struct block_shared, self);
+    struct block_payload *payload = b->payload;
+
+    if (atomic_fetch_sub_explicit (&payload->refs, 1,
+                                   memory_order_acq_rel) == 1)
+    {
+        block_Release (payload->block);
+        free (payload);
+    }
+    free (b);
+}
+
+static const struct vlc_block_callbacks block_shared_cbs =
+{
+    block_shared_Release,
+};
+
+static bool block_IsShared (const block_t *block)
+{
+    return block->cbs == &block_shared_cbs;
+}
+
+static block_t *block_shared_New (struct block_payload *payload,
+                                  const block_t *from)
+{
+    struct block_shared *b = malloc (sizeof (*b));
+    if (unlikely(b == NULL))
+        return NULL;
+
+    block_Init (&b->self, &block_shared_cbs, from->p_buffer, from->i_buffer);
+    block_CopyProperties (&b->self, from);
+    b->payload = payload;
+    return &b->self;
+}
+
+block_t *block_MakeShared (block_t *block)
+{
+    block_Check (block);
+
+    if (block_IsShared (block))
+        return block;
+
+    struct block_payload *payload = malloc (sizeof (*payload));
+    if (unlikely(payload == NULL))
+    {
+        block_Release (block);
+        return NULL;
+    }
+
+    block_t *shared = block_shared_New (payload, block);
+    if (unlikely(shared == NULL))
+    {
+        free (payload);
+        block_Release (block);
+        return NULL;
+    }
+
+    atomic_init (&payload->refs, 1);
+    payload->block = block;
+    shared->p_next = block->p_next;
+    block->p_next = NULL;
+    return shared;
+}
+
+block_t *block_Share (block_t *block)
+{
+    assert (block_IsShared (block));
+
+    struct block_shared *b = container_of (block, struct block_shared, self);
+    block_t *dup = block_shared_New (b->payload, block);
+
+    if (likely(dup != NULL))
+        atomic_fetch_add_explicit (&b->payload->refs, 1, memory_order_relaxed);
+    return dup;
+}
+
+block_t *block_MakeWritable (block_t *block)
+{
+    if (!block_IsShared (block))
+        return block;
+
+    struct block_shared *b = container_of (block, struct block_shared, self);
+
+    /* The other views are gone: nobody else can read the payload anymore */
+    if (atomic_load_explicit (&b->payload->refs, memory_order_acquire) == 1)
+        return block;
+
+    block_t *dup = block_Duplicate (block);
+    if (dup != NULL)
+        dup->p_next = block->p_next;
+    block_Release (block);
+    return dup;
+}
+
 block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
 {
     block_Check( p_block );
@@ -155,6 +515,9 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
 
     /* First, shrink payload */
 
+    /* Shared payloads are read-only: never grow them in place */
+    const bool shared = block_IsShared( p_block );
+
     /* Pull payload start */
     if( i_prebody < 0 )
     {
@@ -177,7 +540,7 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
 
     if( p_block->i_buffer == 0 )
     {   /* Corner case: nothing to preserve */
-        if( requested <= p_block->i_size )
+        if( requested <= p_block->i_size && !shared )
         {   /* Enough room: recycle buffer */
             size_t extra = p_block->i_size - requested;
 
@@ -202,7 +565,8 @@ block_t *block_TryRealloc (block_t *p_block, ssize_t i_prebody, size_t i_body)
     /* Second, reallocate the buffer if we lack space. */
     assert( i_prebody >= 0 );
     if( (size_t)(p_block->p_buffer - p_start) < (size_t)i_prebody
-     || (size_t)(p_end - p_block->p_buffer) < i_body )
+     || (size_t)(p_end - p_block->p_buffer) < i_body
+     || (shared && (i_prebody > 0 || i_body > p_block->i_buffer)) )
     {
         block_t *p_rea = block_Alloc( requested );
         if( p_rea == NULL )
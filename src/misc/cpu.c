@@ -37,14 +37,13 @@
 #include "libvlc.h"
 
 #include <assert.h>
+#include <errno.h>
 
 #include <sys/types.h>
 #ifndef _WIN32
 #include <unistd.h>
 #include <sys/wait.h>
 #include <signal.h>
-#else
-#include <errno.h>
 #endif
 
 #ifdef __APPLE__
@@ -256,6 +255,12 @@ unsigned vlc_CPU(void)
 
     if (unlikely(flags == -1U)) {
         flags = vlc_CPU_raw();
+
+        /* Debugging and benchmarking: disable some of the optimizations. The
+         * ones enabled at build time (e.g. SSE2 on x86-64) are not affected. */
+        const char *mask = getenv("VLC_CPU_DISABLE");
+        if (mask != NULL)
+            flags &= ~(unsigned)strtoul(mask, NULL, 0);
         atomic_store_explicit(&cpu_flags, flags, memory_order_relaxed);
     }
 
@@ -318,3 +323,13 @@ void vlc_CPU_dump (vlc_object_t *obj)
         free(stream.ptr);
     }
 }
+
+/**
+ * Restricts the calling thread to a set of CPUs (fallback).
+ */
+VLC_WEAK int vlc_CPU_SetAffinity(const char *cpus, int node)
+{
+    if (cpus == NULL && node < 0)
+        return 0;
+    return ENOTSUP;
+}
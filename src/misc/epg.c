@@ -203,19 +203,25 @@ void vlc_epg_Delete( vlc_epg_t *p_epg )
 
 void vlc_epg_SetCurrent( vlc_epg_t *p_epg, int64_t i_start )
 {
-    size_t i;
     p_epg->p_current = NULL;
     if( i_start < 0 )
         return;
 
-    for( i = 0; i < p_epg->i_event; i++ )
+    /* Events are sorted by start time, see vlc_epg_AddEvent() */
+    size_t i_lower = 0;
+    size_t i_upper = p_epg->i_event;
+    while( i_lower < i_upper )
     {
-        if( p_epg->pp_event[i]->i_start == i_start )
-        {
-            p_epg->p_current = p_epg->pp_event[i];
-            break;
-        }
+        size_t i_split = ( i_lower + i_upper ) / 2;
+        if( p_epg->pp_event[i_split]->i_start < i_start )
+            i_lower = i_split + 1;
+        else
+            i_upper = i_split;
     }
+
+    if( i_lower < p_epg->i_event &&
+        p_epg->pp_event[i_lower]->i_start == i_start )
+        p_epg->p_current = p_epg->pp_event[i_lower];
 }
 
 vlc_epg_t * vlc_epg_Duplicate( const vlc_epg_t *p_src )
@@ -27,25 +27,42 @@
 #include <vlc_atomic.h>
 #include <vlc_list.h>
 #include <vlc_threads.h>
+#include <vlc_tick.h>
 #include "libvlc.h"
 
 /**
  * An executor can spawn several threads.
  *
- * This structure contains the data specific to one thread.
+ * This structure contains the data specific to one thread. Each thread has
+ * its own queues of runnables: submissions are spread across threads, and a
+ * thread running out of work takes runnables from the queues of the others
+ * (work stealing), so that threads rarely contend on the same lock.
  */
 struct vlc_executor_thread {
-    /** Node of vlc_executor.threads list */
-    struct vlc_list node;
-
     /** The executor owning the thread */
     vlc_executor_t *owner;
 
+    /** Index in vlc_executor.threads */
+    unsigned index;
+
     /** The system thread */
     vlc_thread_t thread;
 
-    /** The current task executed by the thread, NULL if none */
-    struct vlc_runnable *current_task;
+    /** Protects the queues of this thread */
+    vlc_mutex_t lock;
+
+    /** Queues of vlc_runnable, urgent ones are taken first */
+    struct vlc_list urgent;
+    struct vlc_list queue;
+
+    /** Number of runnables in both queues */
+    size_t queued;
+
+    /* Statistics, only written by this thread */
+    atomic_ullong executed;
+    atomic_ullong steals;
+    atomic_ullong latency_sum;
+    atomic_ullong latency_max;
 };
 
 /**
@@ -53,109 +70,230 @@ struct vlc_executor_thread {
  * header).
  */
 struct vlc_executor {
+    /** Protects thread creation, idle threads and closing */
     vlc_mutex_t lock;
 
     /** Maximum number of threads to run the tasks */
     unsigned max_threads;
 
-    /** List of active vlc_executor_thread */
-    struct vlc_list threads;
+    /** Threads (max_threads entries, nthreads of them spawned) */
+    struct vlc_executor_thread **threads;
 
-    /** Thread count (in a separate field to quickly compare to max_threads) */
-    unsigned nthreads;
+    /** Thread count (threads are never removed before deletion) */
+    atomic_uint nthreads;
+
+    /** Next thread to queue runnables submitted from outside the executor */
+    atomic_uint next;
 
     /* Number of tasks requested but not finished. */
-    unsigned unfinished;
+    atomic_uint unfinished;
+
+    /* Number of queued urgent tasks */
+    atomic_uint urgent;
+
+    /* Number of threads waiting for queue_wait */
+    atomic_uint idle;
 
     /** Wait for the executor to be idle (i.e. unfinished == 0) */
     vlc_cond_t idle_wait;
 
-    /** Queue of vlc_runnable */
-    struct vlc_list queue;
-
-    /** Wait for the queue to be non-empty */
+    /** Wait for any queue to be non-empty */
     vlc_cond_t queue_wait;
 
     /** True if executor deletion is requested */
     bool closing;
 };
 
+/** The executor thread running the calling thread, if any */
+static thread_local struct vlc_executor_thread *current_thread;
+
 static void
-QueuePush(vlc_executor_t *executor, struct vlc_runnable *runnable)
+QueuePush(struct vlc_executor_thread *thread, struct vlc_runnable *runnable,
+          bool urgent)
 {
-    vlc_mutex_assert(&executor->lock);
+    vlc_mutex_lock(&thread->lock);
+
+    runnable->owner = thread;
+    runnable->date = vlc_tick_now();
+    runnable->urgent = urgent;
+    if (urgent)
+        atomic_fetch_add_explicit(&thread->owner->urgent, 1,
+                                  memory_order_relaxed);
 
-    vlc_list_append(&runnable->node, &executor->queue);
-    vlc_cond_signal(&executor->queue_wait);
+    vlc_list_append(&runnable->node, urgent ? &thread->urgent
+                                            : &thread->queue);
+    thread->queued++;
+
+    vlc_mutex_unlock(&thread->lock);
 }
 
-static struct vlc_runnable *
-QueueTake(vlc_executor_t *executor)
+static void
+QueueRemove(struct vlc_executor_thread *thread, struct vlc_runnable *runnable)
 {
-    vlc_mutex_assert(&executor->lock);
+    vlc_mutex_assert(&thread->lock);
 
-    while (!executor->closing && vlc_list_is_empty(&executor->queue))
-        vlc_cond_wait(&executor->queue_wait, &executor->lock);
+    vlc_list_remove(&runnable->node);
+    assert(thread->queued > 0);
+    thread->queued--;
+    if (runnable->urgent)
+        atomic_fetch_sub_explicit(&thread->owner->urgent, 1,
+                                  memory_order_relaxed);
+}
 
-    if (executor->closing)
-        return NULL;
+static struct vlc_runnable *
+QueueTake(struct vlc_executor_thread *thread, bool urgent_only)
+{
+    vlc_mutex_lock(&thread->lock);
 
     struct vlc_runnable *runnable =
-        vlc_list_first_entry_or_null(&executor->queue, struct vlc_runnable,
+        vlc_list_first_entry_or_null(&thread->urgent, struct vlc_runnable,
                                      node);
-    assert(runnable);
-    vlc_list_remove(&runnable->node);
+    if (!runnable && !urgent_only)
+        runnable = vlc_list_first_entry_or_null(&thread->queue,
+                                                struct vlc_runnable, node);
+    if (runnable)
+    {
+        QueueRemove(thread, runnable);
+
+        /* Set links to NULL to know that it has been taken by a thread in
+         * vlc_executor_Cancel() */
+        runnable->node.prev = runnable->node.next = NULL;
+    }
+
+    vlc_mutex_unlock(&thread->lock);
+
+    return runnable;
+}
+
+static struct vlc_runnable *
+Steal(struct vlc_executor_thread *thread, bool urgent_only)
+{
+    vlc_executor_t *executor = thread->owner;
+    unsigned nthreads = atomic_load_explicit(&executor->nthreads,
+                                             memory_order_acquire);
 
-    /* Set links to NULL to know that it has been taken by a thread in
-     * vlc_executor_Cancel() */
-    runnable->node.prev = runnable->node.next = NULL;
+    /* The calling thread may not be published yet */
+    for (unsigned i = 1; i <= nthreads; ++i)
+    {
+        struct vlc_executor_thread *victim =
+            executor->threads[(thread->index + i) % nthreads];
+        if (victim == thread)
+            continue;
+
+        struct vlc_runnable *runnable = QueueTake(victim, urgent_only);
+        if (runnable)
+        {
+            atomic_fetch_add_explicit(&thread->steals, 1,
+                                      memory_order_relaxed);
+            return runnable;
+        }
+    }
+    return NULL;
+}
 
+static struct vlc_runnable *
+Take(struct vlc_executor_thread *thread)
+{
+    vlc_executor_t *executor = thread->owner;
+    struct vlc_runnable *runnable = NULL;
+
+    /* Urgent runnables of other threads go before local normal ones */
+    if (atomic_load_explicit(&executor->urgent, memory_order_relaxed))
+    {
+        runnable = QueueTake(thread, true);
+        if (!runnable)
+            runnable = Steal(thread, true);
+    }
+    if (!runnable)
+        runnable = QueueTake(thread, false);
+    if (!runnable)
+        runnable = Steal(thread, false);
+    if (!runnable)
+        return NULL;
+
+    unsigned long long latency = vlc_tick_now() - runnable->date;
+    atomic_fetch_add_explicit(&thread->latency_sum, latency,
+                              memory_order_relaxed);
+    if (latency > atomic_load_explicit(&thread->latency_max,
+                                       memory_order_relaxed))
+        atomic_store_explicit(&thread->latency_max, latency,
+                              memory_order_relaxed);
     return runnable;
 }
 
+static void
+Finish(vlc_executor_t *executor)
+{
+    if (atomic_fetch_sub(&executor->unfinished, 1) == 1)
+    {
+        vlc_mutex_lock(&executor->lock);
+        vlc_cond_broadcast(&executor->idle_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
 static void *
 ThreadRun(void *userdata)
 {
     struct vlc_executor_thread *thread = userdata;
     vlc_executor_t *executor = thread->owner;
 
-    vlc_mutex_lock(&executor->lock);
+    current_thread = thread;
 
-    struct vlc_runnable *runnable;
-    /* When the executor is closing, QueueTake() returns NULL */
-    while ((runnable = QueueTake(executor)))
+    for (;;)
     {
-        thread->current_task = runnable;
-        vlc_mutex_unlock(&executor->lock);
-
-        /* Execute the user-provided runnable, without the executor lock */
+        struct vlc_runnable *runnable = Take(thread);
+        if (!runnable)
+        {
+            vlc_mutex_lock(&executor->lock);
+            /* Submitters check idle after queuing: either they see this
+             * thread idle and signal it, or it sees their runnable here */
+            atomic_fetch_add(&executor->idle, 1);
+            while (!executor->closing && !(runnable = Take(thread)))
+                vlc_cond_wait(&executor->queue_wait, &executor->lock);
+            atomic_fetch_sub(&executor->idle, 1);
+            vlc_mutex_unlock(&executor->lock);
+
+            /* When the executor is closing, no runnable is taken */
+            if (!runnable)
+                break;
+        }
+
+        /* Execute the user-provided runnable, without any lock */
         runnable->run(runnable->userdata);
 
-        vlc_mutex_lock(&executor->lock);
-        thread->current_task = NULL;
-
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
+        atomic_fetch_add_explicit(&thread->executed, 1, memory_order_relaxed);
+        Finish(executor);
     }
 
-    vlc_mutex_unlock(&executor->lock);
-
     return NULL;
 }
 
 static int
 SpawnThread(vlc_executor_t *executor)
 {
-    assert(executor->nthreads < executor->max_threads);
+    vlc_mutex_assert(&executor->lock);
+
+    unsigned nthreads = atomic_load_explicit(&executor->nthreads,
+                                             memory_order_relaxed);
+    assert(nthreads < executor->max_threads);
 
     struct vlc_executor_thread *thread = malloc(sizeof(*thread));
     if (!thread)
         return VLC_ENOMEM;
 
     thread->owner = executor;
-    thread->current_task = NULL;
+    thread->index = nthreads;
+    vlc_mutex_init(&thread->lock);
+    vlc_list_init(&thread->urgent);
+    vlc_list_init(&thread->queue);
+    thread->queued = 0;
+    atomic_init(&thread->executed, 0);
+    atomic_init(&thread->steals, 0);
+    atomic_init(&thread->latency_sum, 0);
+    atomic_init(&thread->latency_max, 0);
+
+    executor->threads[nthreads] = thread;
 
     if (vlc_clone(&thread->thread, ThreadRun, thread, VLC_THREAD_PRIORITY_LOW))
     {
@@ -163,8 +301,9 @@ SpawnThread(vlc_executor_t *executor)
         return VLC_EGENERIC;
     }
 
-    executor->nthreads++;
-    vlc_list_append(&thread->node, &executor->threads);
+    /* Publish the thread once it runs, so that it may receive runnables */
+    atomic_store_explicit(&executor->nthreads, nthreads + 1,
+                          memory_order_release);
 
     return VLC_SUCCESS;
 }
@@ -177,14 +316,21 @@ vlc_executor_New(unsigned max_threads)
     if (!executor)
         return NULL;
 
+    executor->threads = vlc_alloc(max_threads, sizeof(*executor->threads));
+    if (!executor->threads)
+    {
+        free(executor);
+        return NULL;
+    }
+
     vlc_mutex_init(&executor->lock);
 
     executor->max_threads = max_threads;
-    executor->nthreads = 0;
-    executor->unfinished = 0;
-
-    vlc_list_init(&executor->threads);
-    vlc_list_init(&executor->queue);
+    atomic_init(&executor->nthreads, 0);
+    atomic_init(&executor->next, 0);
+    atomic_init(&executor->unfinished, 0);
+    atomic_init(&executor->urgent, 0);
+    atomic_init(&executor->idle, 0);
 
     vlc_cond_init(&executor->idle_wait);
     vlc_cond_init(&executor->queue_wait);
@@ -192,9 +338,12 @@ vlc_executor_New(unsigned max_threads)
     executor->closing = false;
 
     /* Create one thread on init so that vlc_executor_Submit() may never fail */
+    vlc_mutex_lock(&executor->lock);
     int ret = SpawnThread(executor);
+    vlc_mutex_unlock(&executor->lock);
     if (ret != VLC_SUCCESS)
     {
+        free(executor->threads);
         free(executor);
         return NULL;
     }
@@ -202,27 +351,65 @@ vlc_executor_New(unsigned max_threads)
     return executor;
 }
 
-void
-vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+static void
+Submit(vlc_executor_t *executor, struct vlc_runnable *runnable, bool urgent)
 {
-    vlc_mutex_lock(&executor->lock);
+    unsigned unfinished = atomic_fetch_add(&executor->unfinished, 1) + 1;
+    unsigned nthreads = atomic_load_explicit(&executor->nthreads,
+                                             memory_order_acquire);
+
+    /* Runnables submitted from a runnable stay on the same thread */
+    struct vlc_executor_thread *thread = current_thread;
+    if (!thread || thread->owner != executor)
+    {
+        unsigned next = atomic_fetch_add_explicit(&executor->next, 1,
+                                                  memory_order_relaxed);
+        thread = executor->threads[next % nthreads];
+    }
 
-    assert(!executor->closing);
+    QueuePush(thread, runnable, urgent);
 
-    QueuePush(executor, runnable);
+    bool spawn = unfinished > nthreads && nthreads < executor->max_threads;
+    if (spawn || atomic_load(&executor->idle))
+    {
+        vlc_mutex_lock(&executor->lock);
+        assert(!executor->closing);
 
-    if (++executor->unfinished > executor->nthreads
-            && executor->nthreads < executor->max_threads)
-        /* If it fails, this is not an error, there is at least one thread */
-        SpawnThread(executor);
+        nthreads = atomic_load_explicit(&executor->nthreads,
+                                        memory_order_relaxed);
+        if (spawn && nthreads < executor->max_threads
+         && atomic_load(&executor->unfinished) > nthreads)
+            /* If it fails, this is not an error, there is at least one
+             * thread */
+            SpawnThread(executor);
 
-    vlc_mutex_unlock(&executor->lock);
+        vlc_cond_signal(&executor->queue_wait);
+        vlc_mutex_unlock(&executor->lock);
+    }
+}
+
+void
+vlc_executor_Submit(vlc_executor_t *executor, struct vlc_runnable *runnable)
+{
+    Submit(executor, runnable, false);
+}
+
+void
+vlc_executor_SubmitUrgent(vlc_executor_t *executor,
+                          struct vlc_runnable *runnable)
+{
+    Submit(executor, runnable, true);
 }
 
 bool
 vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
 {
-    vlc_mutex_lock(&executor->lock);
+    /* The queue of a runnable is set on submission, and never changes until
+     * it is taken by a thread */
+    struct vlc_executor_thread *thread = runnable->owner;
+    assert(thread->owner == executor);
+
+    vlc_mutex_lock(&thread->lock);
 
     /* Either both prev and next are set, either both are NULL */
     assert(!runnable->node.prev == !runnable->node.next);
@@ -230,15 +417,40 @@ vlc_executor_Cancel(vlc_executor_t *executor, struct vlc_runnable *runnable)
     bool in_queue = runnable->node.prev;
     if (in_queue)
     {
-        vlc_list_remove(&runnable->node);
+        QueueRemove(thread, runnable);
+        runnable->node.prev = runnable->node.next = NULL;
+    }
+
+    vlc_mutex_unlock(&thread->lock);
 
-        assert(executor->unfinished > 0);
-        --executor->unfinished;
-        if (!executor->unfinished)
-            vlc_cond_signal(&executor->idle_wait);
+    if (in_queue)
+        Finish(executor);
+
+    return in_queue;
+}
+
+bool
+vlc_executor_Prioritize(vlc_executor_t *executor,
+                        struct vlc_runnable *runnable)
+{
+    struct vlc_executor_thread *thread = runnable->owner;
+    assert(thread->owner == executor);
+
+    vlc_mutex_lock(&thread->lock);
+
+    /* Either both prev and next are set, either both are NULL */
+    assert(!runnable->node.prev == !runnable->node.next);
+
+    bool in_queue = runnable->node.prev;
+    if (in_queue && !runnable->urgent)
+    {
+        vlc_list_remove(&runnable->node);
+        vlc_list_append(&runnable->node, &thread->urgent);
+        runnable->urgent = true;
+        atomic_fetch_add_explicit(&executor->urgent, 1, memory_order_relaxed);
     }
 
-    vlc_mutex_unlock(&executor->lock);
+    vlc_mutex_unlock(&thread->lock);
 
     return in_queue;
 }
@@ -247,11 +459,54 @@ void
 vlc_executor_WaitIdle(vlc_executor_t *executor)
 {
     vlc_mutex_lock(&executor->lock);
-    while (executor->unfinished)
+    while (atomic_load(&executor->unfinished))
         vlc_cond_wait(&executor->idle_wait, &executor->lock);
     vlc_mutex_unlock(&executor->lock);
 }
 
+void
+vlc_executor_GetStats(vlc_executor_t *executor,
+                      struct vlc_executor_stats *stats)
+{
+    unsigned nthreads = atomic_load_explicit(&executor->nthreads,
+                                             memory_order_acquire);
+    unsigned long long latency_sum = 0;
+
+    stats->threads = nthreads;
+    stats->queued = 0;
+    stats->executed = 0;
+    stats->steals = 0;
+    stats->latency_max = 0;
+
+    for (unsigned i = 0; i < nthreads; ++i)
+    {
+        struct vlc_executor_thread *thread = executor->threads[i];
+
+        vlc_mutex_lock(&thread->lock);
+        stats->queued += thread->queued;
+        vlc_mutex_unlock(&thread->lock);
+
+        stats->executed += atomic_load_explicit(&thread->executed,
+                                                memory_order_relaxed);
+        stats->steals += atomic_load_explicit(&thread->steals,
+                                              memory_order_relaxed);
+        latency_sum += atomic_load_explicit(&thread->latency_sum,
+                                            memory_order_relaxed);
+        vlc_tick_t max = atomic_load_explicit(&thread->latency_max,
+                                              memory_order_relaxed);
+        if (max > stats->latency_max)
+            stats->latency_max = max;
+    }
+
+    size_t unfinished = atomic_load(&executor->unfinished);
+    stats->running = unfinished > stats->queued ? unfinished - stats->queued
+                                                : 0;
+    /* Runnables being executed have been taken, but not counted as executed
+     * yet */
+    uint64_t started = stats->executed + stats->running;
+    stats->latency_avg = started ? latency_sum / started : 0;
+}
+
 void
 vlc_executor_Delete(vlc_executor_t *executor)
 {
@@ -259,30 +514,45 @@ vlc_executor_Delete(vlc_executor_t *executor)
 
     executor->closing = true;
 
+    unsigned nthreads = atomic_load(&executor->nthreads);
+#ifndef NDEBUG
     /* All the tasks must be canceled on delete */
-    assert(vlc_list_is_empty(&executor->queue));
+    for (unsigned i = 0; i < nthreads; ++i)
+    {
+        struct vlc_executor_thread *thread = executor->threads[i];
+
+        vlc_mutex_lock(&thread->lock);
+        assert(thread->queued == 0);
+        vlc_mutex_unlock(&thread->lock);
+    }
+#endif
 
     vlc_mutex_unlock(&executor->lock);
 
     /* "closing" is now true, this will wake up threads */
     vlc_cond_broadcast(&executor->queue_wait);
 
-    /* The threads list may not be written at this point, so it is safe to read
-     * it without mutex locked (the mutex must be released to join the
+    /* The threads may not be spawned at this point, so it is safe to read
+     * them without mutex locked (the mutex must be released to join the
      * threads). */
 
-    struct vlc_executor_thread *thread;
-    vlc_list_foreach(thread, &executor->threads, node)
+    for (unsigned i = 0; i < nthreads; ++i)
+        vlc_join(executor->threads[i]->thread, NULL);
+
+    for (unsigned i = 0; i < nthreads; ++i)
     {
-        vlc_join(thread->thread, NULL);
+        struct vlc_executor_thread *thread = executor->threads[i];
+
+        /* The queues must still be empty (no runnable submitted a new
+         * runnable) */
+        assert(vlc_list_is_empty(&thread->urgent));
+        assert(vlc_list_is_empty(&thread->queue));
         free(thread);
     }
 
-    /* The queue must still be empty (no runnable submitted a new runnable) */
-    assert(vlc_list_is_empty(&executor->queue));
-
     /* There are no tasks anymore */
-    assert(!executor->unfinished);
+    assert(!atomic_load(&executor->unfinished));
 
+    free(executor->threads);
     free(executor);
 }
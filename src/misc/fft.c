@@ -0,0 +1,294 @@
+/*****************************************************************************
+ * fft.c: real fast Fourier transform
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_fft.h>
+#include <vlc_list.h>
+
+/*
+ * A real transform of N samples is computed as a complex transform of the
+ * N / 2 pairs of samples, followed by a split of the even and odd spectra.
+ *
+ * The complex transform is an iterative radix-2 decimation in time. The
+ * twiddle factors of each pass are stored contiguously, so that the inner
+ * loop runs over consecutive butterflies and vectorizes.
+ */
+struct vlc_rdft
+{
+    size_t size;
+    unsigned refs;
+    struct vlc_list node;
+
+    size_t *bitrev;  /* bit reversal permutation of the N / 2 pairs */
+    float *tw_re;    /* twiddles of the complex passes, N / 2 - 1 */
+    float *tw_im;
+    float *split_re; /* exp(-2 i pi k / N), k < N / 4 + 1 */
+    float *split_im;
+};
+
+static vlc_mutex_t plans_lock = VLC_STATIC_MUTEX;
+static struct vlc_list plans = VLC_LIST_INITIALIZER(&plans);
+
+static void vlc_rdft_Free(vlc_rdft_t *plan)
+{
+    free(plan->bitrev);
+    free(plan->tw_re);
+    free(plan->tw_im);
+    free(plan->split_re);
+    free(plan->split_im);
+    free(plan);
+}
+
+static vlc_rdft_t *vlc_rdft_New(size_t size)
+{
+    const size_t m = size / 2;
+    vlc_rdft_t *plan = malloc(sizeof (*plan));
+    if (unlikely(plan == NULL))
+        return NULL;
+
+    plan->size = size;
+    plan->refs = 1;
+    plan->bitrev = vlc_alloc(m, sizeof (*plan->bitrev));
+    plan->tw_re = vlc_alloc(m, sizeof (float));
+    plan->tw_im = vlc_alloc(m, sizeof (float));
+    plan->split_re = vlc_alloc(m / 2 + 1, sizeof (float));
+    plan->split_im = vlc_alloc(m / 2 + 1, sizeof (float));
+    if (unlikely(plan->bitrev == NULL || plan->tw_re == NULL
+              || plan->tw_im == NULL || plan->split_re == NULL
+              || plan->split_im == NULL))
+    {
+        vlc_rdft_Free(plan);
+        return NULL;
+    }
+
+    unsigned bits = 0;
+    while (((size_t)1 << bits) < m)
+        bits++;
+    for (size_t i = 0; i < m; i++)
+    {
+        size_t r = 0;
+        for (unsigned b = 0; b < bits; b++)
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        plan->bitrev[i] = r;
+    }
+
+    /* The pass of butterfly span h uses exp(-i pi j / h), j < h, stored
+     * from offset h - 1 */
+    for (size_t h = 1; h < m; h <<= 1)
+        for (size_t j = 0; j < h; j++)
+        {
+            double a = M_PI * j / h;
+            plan->tw_re[h - 1 + j] = cos(a);
+            plan->tw_im[h - 1 + j] = -sin(a);
+        }
+
+    for (size_t k = 0; k <= m / 2; k++)
+    {
+        double a = 2. * M_PI * k / size;
+        plan->split_re[k] = cos(a);
+        plan->split_im[k] = -sin(a);
+    }
+    return plan;
+}
+
+vlc_rdft_t *vlc_rdft_Hold(size_t size)
+{
+    if (size < 4 || (size & (size - 1)) != 0)
+        return NULL;
+
+    vlc_rdft_t *plan;
+
+    vlc_mutex_lock(&plans_lock);
+    vlc_list_foreach(plan, &plans, node)
+        if (plan->size == size)
+        {
+            plan->refs++;
+            vlc_mutex_unlock(&plans_lock);
+            return plan;
+        }
+
+    plan = vlc_rdft_New(size);
+    if (plan != NULL)
+        vlc_list_append(&plan->node, &plans);
+    vlc_mutex_unlock(&plans_lock);
+    return plan;
+}
+
+void vlc_rdft_Release(vlc_rdft_t *plan)
+{
+    vlc_mutex_lock(&plans_lock);
+    assert(plan->refs > 0);
+    if (--plan->refs == 0)
+    {
+        vlc_list_remove(&plan->node);
+        vlc_rdft_Free(plan);
+    }
+    vlc_mutex_unlock(&plans_lock);
+}
+
+size_t vlc_rdft_GetSize(const vlc_rdft_t *plan)
+{
+    return plan->size;
+}
+
+/* In place complex transform of the N / 2 interleaved pairs of z */
+static void vlc_rdft_Complex(const vlc_rdft_t *plan, float *restrict z,
+                             bool inverse)
+{
+    const size_t m = plan->size / 2;
+    const float sign = inverse ? -1.f : 1.f;
+
+    for (size_t i = 0; i < m; i++)
+    {
+        size_t j = plan->bitrev[i];
+        if (j > i)
+        {
+            float re = z[2 * i], im = z[2 * i + 1];
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = re;
+            z[2 * j + 1] = im;
+        }
+    }
+
+    for (size_t h = 1; h < m; h <<= 1)
+    {
+        const float *wr = plan->tw_re + h - 1;
+        const float *wi = plan->tw_im + h - 1;
+
+        for (size_t k = 0; k < m; k += 2 * h)
+        {
+            float *restrict a = z + 2 * k;
+            float *restrict b = z + 2 * (k + h);
+
+            for (size_t j = 0; j < h; j++)
+            {
+                float w_re = wr[j], w_im = sign * wi[j];
+                float t_re = w_re * b[2 * j] - w_im * b[2 * j + 1];
+                float t_im = w_re * b[2 * j + 1] + w_im * b[2 * j];
+
+                b[2 * j] = a[2 * j] - t_re;
+                b[2 * j + 1] = a[2 * j + 1] - t_im;
+                a[2 * j] += t_re;
+                a[2 * j + 1] += t_im;
+            }
+        }
+    }
+}
+
+void vlc_rdft_Forward(const vlc_rdft_t *plan, const float *in,
+                      float *spectrum)
+{
+    const size_t n = plan->size, m = n / 2;
+    float *x = spectrum;
+
+    memcpy(x, in, n * sizeof (*x));
+    vlc_rdft_Complex(plan, x, false);
+
+    /* Split the spectra of the even and odd samples:
+     * X[k] = E[k] + exp(-2 i pi k / N) O[k], with
+     * E[k] = (Z[k] + conj(Z[M - k])) / 2 and
+     * O[k] = (Z[k] - conj(Z[M - k])) / 2i */
+    float z_re = x[0], z_im = x[1];
+    x[0] = z_re + z_im;
+    x[1] = 0.f;
+    x[n] = z_re - z_im;
+    x[n + 1] = 0.f;
+
+    for (size_t k = 1; k <= m / 2; k++)
+    {
+        const size_t l = m - k;
+        float a_re = x[2 * k], a_im = x[2 * k + 1];
+        float b_re = x[2 * l], b_im = x[2 * l + 1];
+        float e_re = .5f * (a_re + b_re), e_im = .5f * (a_im - b_im);
+        float o_re = .5f * (a_im + b_im), o_im = .5f * (b_re - a_re);
+        float w_re = plan->split_re[k], w_im = plan->split_im[k];
+        float t_re = w_re * o_re - w_im * o_im;
+        float t_im = w_re * o_im + w_im * o_re;
+
+        /* E and O are spectra of real signals, and
+         * exp(-2 i pi (M - k) / N) = -conj(exp(-2 i pi k / N)) */
+        x[2 * l] = e_re - t_re;
+        x[2 * l + 1] = t_im - e_im;
+        x[2 * k] = e_re + t_re;
+        x[2 * k + 1] = e_im + t_im;
+    }
+}
+
+void vlc_rdft_Inverse(const vlc_rdft_t *plan, const float *spectrum,
+                      float *out)
+{
+    const size_t n = plan->size, m = n / 2;
+    const float *x = spectrum;
+    float *z = out;
+
+    /* Merge back the spectra of the even and odd samples:
+     * Z[k] = E[k] + i O[k], with E[k] = (X[k] + conj(X[M - k])) / 2 and
+     * O[k] = (X[k] - conj(X[M - k])) exp(2 i pi k / N) / 2 */
+    z[0] = .5f * (x[0] + x[n]);
+    z[1] = .5f * (x[0] - x[n]);
+
+    for (size_t k = 1; k <= m / 2; k++)
+    {
+        const size_t l = m - k;
+        float a_re = x[2 * k], a_im = x[2 * k + 1];
+        float b_re = x[2 * l], b_im = x[2 * l + 1];
+        float e_re = .5f * (a_re + b_re), e_im = .5f * (a_im - b_im);
+        float d_re = .5f * (a_re - b_re), d_im = .5f * (a_im + b_im);
+        float w_re = plan->split_re[k], w_im = -plan->split_im[k];
+        float o_re = w_re * d_re - w_im * d_im;
+        float o_im = w_re * d_im + w_im * d_re;
+
+        z[2 * l] = e_re + o_im;
+        z[2 * l + 1] = o_re - e_im;
+        z[2 * k] = e_re - o_im;
+        z[2 * k + 1] = e_im + o_re;
+    }
+
+    vlc_rdft_Complex(plan, z, true);
+
+    const float scale = 1.f / m;
+    for (size_t i = 0; i < n; i++)
+        z[i] *= scale;
+}
+
+void vlc_rdft_Correlate(const vlc_rdft_t *plan, const float *a,
+                        const float *b, float *out)
+{
+    const size_t bins = plan->size / 2 + 1;
+
+    for (size_t k = 0; k < bins; k++)
+    {
+        float a_re = a[2 * k], a_im = a[2 * k + 1];
+        float b_re = b[2 * k], b_im = b[2 * k + 1];
+
+        out[2 * k] = a_re * b_re + a_im * b_im;
+        out[2 * k + 1] = a_re * b_im - a_im * b_re;
+    }
+}
@@ -30,6 +30,7 @@
 
 #include <vlc_common.h>
 #include <vlc_block.h>
+#include <vlc_threads.h>
 #include "libvlc.h"
 
 /**
@@ -136,3 +137,147 @@ block_t *block_FifoShow( block_fifo_t *p_fifo )
 
     return b;
 }
+
+/**
+ * Internal state for single producer single consumer block queues
+ *
+ * The producer owns the tail index, the consumer owns the head index.
+ * A side that has to sleep raises its parked flag, then checks the other
+ * side index again: the other side always checks the flag after moving its
+ * index, so that either sees the other (sequentially consistent order).
+ */
+struct block_spsc_t
+{
+    atomic_size_t head; /* next slot to read */
+    atomic_size_t tail; /* next slot to write */
+    atomic_size_t bytes;
+    atomic_uint   consumer_parked;
+    atomic_uint   producer_parked;
+    atomic_bool   dead;
+    size_t        mask;
+    block_t      *ring[];
+};
+
+block_spsc_t *block_SpscNew(size_t capacity)
+{
+    if (unlikely(capacity > SIZE_MAX / (4 * sizeof (block_t *))))
+        return NULL;
+
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+
+    block_spsc_t *q = malloc(sizeof (*q) + size * sizeof (block_t *));
+    if (unlikely(q == NULL))
+        return NULL;
+
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->bytes, 0);
+    atomic_init(&q->consumer_parked, 0);
+    atomic_init(&q->producer_parked, 0);
+    atomic_init(&q->dead, false);
+    q->mask = size - 1;
+    return q;
+}
+
+void block_SpscRelease(block_spsc_t *q)
+{
+    block_t *block;
+
+    while ((block = block_SpscTryGet(q)) != NULL)
+        block_Release(block);
+    free(q);
+}
+
+static void block_SpscWake(atomic_uint *parked)
+{
+    if (atomic_load(parked) && atomic_exchange(parked, 0))
+        vlc_atomic_notify_one(parked);
+}
+
+void block_SpscPut(block_spsc_t *q, block_t *block)
+{
+    size_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    while (block != NULL)
+    {
+        block_t *next = block->p_next;
+
+        while (tail - atomic_load(&q->head) > q->mask)
+        {   /* Full: wait for the consumer */
+            if (atomic_load(&q->dead))
+            {
+                block_ChainRelease(block);
+                return;
+            }
+
+            atomic_store(&q->producer_parked, 1);
+            if (tail - atomic_load(&q->head) > q->mask
+             && !atomic_load(&q->dead))
+                vlc_atomic_wait(&q->producer_parked, 1);
+            atomic_store(&q->producer_parked, 0);
+        }
+
+        block->p_next = NULL;
+        q->ring[tail & q->mask] = block;
+        atomic_fetch_add_explicit(&q->bytes, block->i_buffer,
+                                  memory_order_relaxed);
+        atomic_store(&q->tail, ++tail);
+        block_SpscWake(&q->consumer_parked);
+        block = next;
+    }
+}
+
+block_t *block_SpscTryGet(block_spsc_t *q)
+{
+    size_t head = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    if (head == atomic_load_explicit(&q->tail, memory_order_acquire))
+        return NULL;
+
+    block_t *block = q->ring[head & q->mask];
+
+    atomic_fetch_sub_explicit(&q->bytes, block->i_buffer,
+                              memory_order_relaxed);
+    atomic_store(&q->head, head + 1);
+    block_SpscWake(&q->producer_parked);
+    return block;
+}
+
+block_t *block_SpscGet(block_spsc_t *q)
+{
+    for (;;)
+    {
+        bool dead = atomic_load(&q->dead);
+        block_t *block = block_SpscTryGet(q);
+
+        if (block != NULL || dead)
+            return block;
+
+        atomic_store(&q->consumer_parked, 1);
+        if (atomic_load(&q->tail) == atomic_load(&q->head)
+         && !atomic_load(&q->dead))
+            vlc_atomic_wait(&q->consumer_parked, 1);
+        atomic_store(&q->consumer_parked, 0);
+    }
+}
+
+void block_SpscKill(block_spsc_t *q)
+{
+    atomic_store(&q->dead, true);
+    block_SpscWake(&q->consumer_parked);
+    block_SpscWake(&q->producer_parked);
+}
+
+size_t block_SpscGetCount(const block_spsc_t *q)
+{
+    size_t head = atomic_load(&q->head);
+
+    return atomic_load(&q->tail) - head;
+}
+
+size_t block_SpscGetBytes(const block_spsc_t *q)
+{
+    return atomic_load_explicit(&q->bytes, memory_order_relaxed);
+}
@@ -26,9 +26,11 @@
 #endif
 
 #include <vlc_filter.h>
+#include <vlc_executor.h>
 #include <vlc_modules.h>
 #include <vlc_mouse.h>
 #include <vlc_spu.h>
+#include <vlc_tracer.h>
 #include <libvlc.h>
 #include <assert.h>
 
@@ -40,6 +42,7 @@ typedef struct chained_filter_t
     struct chained_filter_t *prev, *next;
     vlc_mouse_t mouse;
     vlc_picture_chain_t pending;
+    vlc_executor_t *executor; /**< Rows threads, if b_parallel_rows */
 } chained_filter_t;
 
 /* */
@@ -136,9 +139,119 @@ static vlc_decoder_device * filter_chain_HoldDecoderDevice(vlc_object_t *o, void
     return chain->parent_video_owner.video->hold_device(o, chain->parent_video_owner.sys);
 }
 
+/* Worker threads shared by all the filters processing rows in parallel */
+#define ROWS_MAX_THREADS 8
+#define ROWS_MIN_SLICE   32 /* Rows per slice below which threads cost more */
+
+static vlc_mutex_t rows_executor_lock = VLC_STATIC_MUTEX;
+static vlc_executor_t *rows_executor = NULL;
+static unsigned rows_executor_refs = 0;
+static unsigned rows_threads;
+
+static vlc_executor_t *RowsExecutorHold( void )
+{
+    vlc_mutex_lock( &rows_executor_lock );
+    if( rows_executor == NULL )
+    {
+        rows_threads = vlc_GetCPUCount();
+        if( rows_threads > ROWS_MAX_THREADS )
+            rows_threads = ROWS_MAX_THREADS;
+        /* The calling thread processes one of the slices */
+        if( rows_threads > 1 )
+            rows_executor = vlc_executor_New( rows_threads - 1 );
+    }
+    if( rows_executor != NULL )
+        rows_executor_refs++;
+
+    vlc_executor_t *executor = rows_executor;
+    vlc_mutex_unlock( &rows_executor_lock );
+    return executor;
+}
+
+static void RowsExecutorRelease( vlc_executor_t *executor )
+{
+    vlc_mutex_lock( &rows_executor_lock );
+    assert( executor == rows_executor );
+    assert( rows_executor_refs > 0 );
+    if( --rows_executor_refs == 0 )
+    {
+        vlc_executor_Delete( rows_executor );
+        rows_executor = NULL;
+    }
+    vlc_mutex_unlock( &rows_executor_lock );
+}
+
+struct rows_slice
+{
+    struct vlc_runnable runnable;
+    filter_t *filter;
+    filter_rows_cb cb;
+    void *opaque;
+    unsigned y0, y1;
+    vlc_sem_t *done;
+};
+
+static void RowsSliceRun( void *userdata )
+{
+    struct rows_slice *slice = userdata;
+
+    slice->cb( slice->filter, slice->opaque, slice->y0, slice->y1 );
+    vlc_sem_post( slice->done );
+}
+
+static void filter_chain_ProcessRows( filter_t *filter, unsigned rows,
+                                      unsigned align, filter_rows_cb cb,
+                                      void *opaque )
+{
+    chained_filter_t *chained = container_of(filter, chained_filter_t, filter);
+
+    if( align == 0 )
+        align = 1;
+
+    const unsigned groups = (rows + align - 1) / align;
+    unsigned count = rows / ROWS_MIN_SLICE;
+    if( count > rows_threads )
+        count = rows_threads;
+    if( count > groups )
+        count = groups;
+
+    if( chained->executor == NULL || count <= 1 )
+    {
+        cb( filter, opaque, 0, rows );
+        return;
+    }
+
+    struct rows_slice slices[ROWS_MAX_THREADS];
+    vlc_sem_t done;
+    vlc_sem_init( &done, 0 );
+
+    for( unsigned i = 0; i < count; i++ )
+    {
+        struct rows_slice *slice = &slices[i];
+
+        slice->runnable.run = RowsSliceRun;
+        slice->runnable.userdata = slice;
+        slice->filter = filter;
+        slice->cb = cb;
+        slice->opaque = opaque;
+        slice->y0 = __MIN(groups * i / count * align, rows);
+        slice->y1 = __MIN(groups * (i + 1) / count * align, rows);
+        slice->done = &done;
+        if( i > 0 )
+            vlc_executor_Submit( chained->executor, &slice->runnable );
+    }
+
+    /* Process the first slice from the calling thread */
+    cb( filter, opaque, slices[0].y0, slices[0].y1 );
+
+    for( unsigned i = 1; i < count; i++ )
+        vlc_sem_wait( &done );
+}
+
 static const struct filter_video_callbacks filter_chain_video_cbs =
 {
     filter_chain_VideoBufferNew, filter_chain_HoldDecoderDevice,
+    filter_chain_ProcessRows,
 };
 
 #undef filter_chain_NewVideo
@@ -262,6 +375,10 @@ static filter_t *filter_chain_AppendInner( filter_chain_t *chain,
         goto error;
     assert( filter->ops != NULL );
 
+    chained->executor = NULL;
+    if( filter->b_parallel_rows && fmt_in->i_cat == VIDEO_ES )
+        chained->executor = RowsExecutorHold();
+
     if( chain->last == NULL )
     {
         assert( chain->first == NULL );
@@ -330,6 +447,8 @@ void filter_chain_DeleteFilter( filter_chain_t *chain, filter_t *filter )
 
     filter_Close( filter );
     module_unneed( filter, filter->p_module );
+    if( chained->executor != NULL )
+        RowsExecutorRelease( chained->executor );
 
     msg_Dbg( chain->obj, "Filter %p removed from chain", (void *)filter );
     FilterDeletePictures( &chained->pending );
@@ -446,7 +565,7 @@ picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
     {
         p_pic = FilterChainVideoFilter( p_chain->first, p_pic );
         if( p_pic )
-            return p_pic;
+            goto out;
     }
     for( chained_filter_t *b = p_chain->last; b != NULL; b = b->prev )
     {
@@ -456,9 +575,13 @@ picture_t *filter_chain_VideoFilter( filter_chain_t *p_chain, picture_t *p_pic )
 
         p_pic = FilterChainVideoFilter( b->next, p_pic );
         if( p_pic )
-            return p_pic;
+            goto out;
     }
     return NULL;
+out:
+    vlc_tracer_Trace( vlc_object_get_tracer( p_chain->obj ),
+                      VLC_TRACER_FILTER_OUT, p_chain, p_pic->date, 0 );
+    return p_pic;
 }
 
 void filter_chain_VideoFlush( filter_chain_t *p_chain )
@@ -127,6 +127,59 @@ void image_HandlerDelete( image_handler_t *p_image )
     p_image = NULL;
 }
 
+/*
+ * Image handlers kept by the instance for picture_Export(): the snapshots and
+ * thumbnails reuse the encoder and converter modules loaded by a previous
+ * export. Concurrent exports each take their own handler, so they still
+ * encode in parallel.
+ */
+image_handler_t *libvlc_ImageHandlerAcquire( libvlc_int_t *p_libvlc )
+{
+    libvlc_priv_t *priv = libvlc_priv( p_libvlc );
+    image_handler_t *p_image = NULL;
+
+    vlc_mutex_lock( &priv->lock );
+    if( priv->image_handler_count > 0 )
+        p_image = priv->image_handlers[--priv->image_handler_count];
+    vlc_mutex_unlock( &priv->lock );
+
+    if( p_image == NULL )
+        p_image = image_HandlerCreate( VLC_OBJECT(p_libvlc) );
+    return p_image;
+}
+
+void libvlc_ImageHandlerRelease( libvlc_int_t *p_libvlc,
+                                 image_handler_t *p_image )
+{
+    libvlc_priv_t *priv = libvlc_priv( p_libvlc );
+
+    /* The video context of a hardware picture is not held by the converter:
+     * do not keep it past the export */
+    if( p_image->p_converter && p_image->p_converter->vctx_in )
+    {
+        DeleteConverter( p_image->p_converter );
+        p_image->p_converter = NULL;
+    }
+
+    vlc_mutex_lock( &priv->lock );
+    if( priv->image_handler_count < ARRAY_SIZE(priv->image_handlers) )
+    {
+        priv->image_handlers[priv->image_handler_count++] = p_image;
+        p_image = NULL;
+    }
+    vlc_mutex_unlock( &priv->lock );
+
+    image_HandlerDelete( p_image );
+}
+
+void libvlc_ImageHandlersClean( libvlc_int_t *p_libvlc )
+{
+    libvlc_priv_t *priv = libvlc_priv( p_libvlc );
+
+    while( priv->image_handler_count > 0 )
+        image_HandlerDelete( priv->image_handlers[--priv->image_handler_count] );
+}
+
 /**
  * Read an image
  *
@@ -0,0 +1,176 @@
+/*****************************************************************************
+ * instrument.c: allocations and lock waits per call site
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef HAVE_DLADDR
+# include <dlfcn.h>
+#endif
+
+#include <vlc_common.h>
+#include "libvlc.h"
+
+/*
+ * The sites are stored in fixed lock-free hash tables: the mutexes are
+ * instrumented too, so none may be used here. The results are printed on
+ * the standard error when libvlccore is unloaded.
+ */
+#define SITES_MAX 4096
+
+struct vlc_instrument_site
+{
+    _Atomic(uintptr_t) caller;
+    atomic_ullong count;
+    atomic_ullong total; /* bytes or ticks */
+};
+
+static struct vlc_instrument_site sites[VLC_INSTRUMENT_MAX][SITES_MAX];
+static atomic_ullong overflows;
+
+static const char *const kind_names[VLC_INSTRUMENT_MAX] = {
+    [VLC_INSTRUMENT_BLOCK] = "block_Alloc",
+    [VLC_INSTRUMENT_PICTURE] = "picture_New",
+    [VLC_INSTRUMENT_ES_FORMAT] = "es_format_Copy",
+    [VLC_INSTRUMENT_LOCK] = "vlc_mutex_lock wait",
+};
+
+static struct vlc_instrument_site *vlc_instrument_GetSite(
+    enum vlc_instrument_kind kind, const void *caller)
+{
+    const uintptr_t key = (uintptr_t)caller;
+    size_t i = (key ^ (key >> 12)) % SITES_MAX;
+
+    for (size_t n = 0; n < SITES_MAX; n++, i = (i + 1) % SITES_MAX)
+    {
+        struct vlc_instrument_site *site = &sites[kind][i];
+        uintptr_t cur = atomic_load_explicit(&site->caller,
+                                             memory_order_relaxed);
+        if (cur == key)
+            return site;
+        if (cur == 0
+         && (atomic_compare_exchange_strong_explicit(&site->caller, &cur, key,
+                                                     memory_order_relaxed,
+                                                     memory_order_relaxed)
+          || cur == key))
+            return site;
+    }
+    return NULL;
+}
+
+void vlc_instrument_Add(enum vlc_instrument_kind kind, const void *caller,
+                        uint64_t value)
+{
+    struct vlc_instrument_site *site = vlc_instrument_GetSite(kind, caller);
+
+    if (unlikely(site == NULL))
+    {
+        atomic_fetch_add_explicit(&overflows, 1, memory_order_relaxed);
+        return;
+    }
+    atomic_fetch_add_explicit(&site->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&site->total, value, memory_order_relaxed);
+}
+
+struct vlc_instrument_entry
+{
+    uintptr_t caller;
+    unsigned long long count;
+    unsigned long long total;
+};
+
+static int vlc_instrument_Compare(const void *a, const void *b)
+{
+    const struct vlc_instrument_entry *x = a, *y = b;
+
+    /* by decreasing total, then count */
+    if (x->total != y->total)
+        return x->total < y->total ? 1 : -1;
+    return (x->count < y->count) - (x->count > y->count);
+}
+
+static void vlc_instrument_PrintCaller(uintptr_t caller)
+{
+#ifdef HAVE_DLADDR
+    Dl_info info;
+
+    if (dladdr((void *)caller, &info) && info.dli_fname != NULL)
+    {
+        const char *file = strrchr(info.dli_fname, '/');
+        file = file != NULL ? file + 1 : info.dli_fname;
+
+        if (info.dli_sname != NULL)
+            fprintf(stderr, "%s:%s+0x%tx", file, info.dli_sname,
+                    (char *)caller - (char *)info.dli_saddr);
+        else
+            fprintf(stderr, "%s+0x%tx", file,
+                    (char *)caller - (char *)info.dli_fbase);
+        return;
+    }
+#endif
+    fprintf(stderr, "%p", (void *)caller);
+}
+
+__attribute__((destructor))
+static void vlc_instrument_Dump(void)
+{
+    static struct vlc_instrument_entry entries[SITES_MAX];
+
+    for (unsigned kind = 0; kind < VLC_INSTRUMENT_MAX; kind++)
+    {
+        size_t n = 0;
+
+        for (size_t i = 0; i < SITES_MAX; i++)
+        {
+            struct vlc_instrument_site *site = &sites[kind][i];
+            uintptr_t caller = atomic_load(&site->caller);
+            if (caller == 0)
+                continue;
+            entries[n].caller = caller;
+            entries[n].count = atomic_load(&site->count);
+            entries[n].total = atomic_load(&site->total);
+            n++;
+        }
+        if (n == 0)
+            continue;
+
+        qsort(entries, n, sizeof (entries[0]), vlc_instrument_Compare);
+        fprintf(stderr, "*** %s: %zu call sites\n", kind_names[kind], n);
+        for (size_t i = 0; i < n; i++)
+        {
+            if (kind == VLC_INSTRUMENT_LOCK)
+                fprintf(stderr, "%12llu waits %12.3f ms  ", entries[i].count,
+                        entries[i].total / 1000.);
+            else
+                fprintf(stderr, "%12llu calls %12llu bytes  ",
+                        entries[i].count, entries[i].total);
+            vlc_instrument_PrintCaller(entries[i].caller);
+            fputc('\n', stderr);
+        }
+    }
+
+    unsigned long long lost = atomic_load(&overflows);
+    if (lost > 0)
+        fprintf(stderr, "*** %llu events from untracked call sites\n", lost);
+}
@@ -136,8 +136,9 @@ libvlc_InternalKeystoreInit(libvlc_int_t *p_libvlc)
     assert(p_libvlc != NULL);
     libvlc_priv_t *p_priv = libvlc_priv(p_libvlc);
 
-    p_priv->p_memory_keystore = keystore_create(VLC_OBJECT(p_libvlc), "memory");
-    return p_priv->p_memory_keystore != NULL ? VLC_SUCCESS : VLC_EGENERIC;
+    /* Created on first use, see get_memory_keystore() */
+    p_priv->p_memory_keystore = NULL;
+    return VLC_SUCCESS;
 }
 
 void
@@ -154,9 +155,23 @@ libvlc_InternalKeystoreClean(libvlc_int_t *p_libvlc)
 }
 
 static vlc_keystore *
-get_memory_keystore(vlc_object_t *p_obj)
+get_memory_keystore(vlc_object_t *p_obj, bool b_create)
 {
-    return libvlc_priv(vlc_object_instance(p_obj))->p_memory_keystore;
+    libvlc_int_t *p_libvlc = vlc_object_instance(p_obj);
+    libvlc_priv_t *p_priv = libvlc_priv(p_libvlc);
+    vlc_keystore *p_keystore;
+
+    vlc_mutex_lock(&p_priv->lock);
+    p_keystore = p_priv->p_memory_keystore;
+    if (p_keystore == NULL && b_create)
+    {
+        p_keystore = keystore_create(VLC_OBJECT(p_libvlc), "memory");
+        if (p_keystore == NULL)
+            msg_Warn(p_libvlc, "memory keystore init failed");
+        p_priv->p_memory_keystore = p_keystore;
+    }
+    vlc_mutex_unlock(&p_priv->lock);
+    return p_keystore;
 }
 
 static vlc_keystore_entry *
@@ -438,7 +453,8 @@ vlc_credential_get(vlc_credential *p_credential, vlc_object_t *p_parent,
 
         case GET_FROM_MEMORY_KEYSTORE:
         {
-            vlc_keystore *p_keystore = get_memory_keystore(p_parent);
+            /* Nothing was stored if the keystore does not exist yet */
+            vlc_keystore *p_keystore = get_memory_keystore(p_parent, false);
             if (p_keystore != NULL)
                 credential_find_keystore(p_credential, p_keystore);
             p_credential->i_get_order++;
@@ -521,7 +537,7 @@ vlc_credential_store(vlc_credential *p_credential, vlc_object_t *p_parent)
     else
     {
         /* Store in memory keystore */
-        p_keystore = get_memory_keystore(p_parent);
+        p_keystore = get_memory_keystore(p_parent, true);
     }
     if (p_keystore == NULL)
         return false;
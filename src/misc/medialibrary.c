@@ -128,8 +128,25 @@ void libvlc_MlRelease( vlc_medialibrary_t* p_ml )
 #undef vlc_ml_instance_get
 vlc_medialibrary_t* vlc_ml_instance_get( vlc_object_t* p_obj )
 {
-    libvlc_priv_t* p_priv = libvlc_priv( vlc_object_instance(p_obj) );
-    return p_priv->p_media_library;
+    libvlc_int_t* p_libvlc = vlc_object_instance(p_obj);
+    libvlc_priv_t* p_priv = libvlc_priv( p_libvlc );
+    vlc_medialibrary_t* p_ml;
+
+    /* Loaded on first use, not to delay the startup */
+    vlc_mutex_lock( &p_priv->lock );
+    if ( !p_priv->b_media_library_loaded )
+    {
+        p_priv->b_media_library_loaded = true;
+        if ( var_InheritBool( p_libvlc, "media-library" ) )
+        {
+            p_priv->p_media_library = libvlc_MlCreate( p_libvlc );
+            if ( p_priv->p_media_library == NULL )
+                msg_Warn( p_libvlc, "Media library initialization failed" );
+        }
+    }
+    p_ml = p_priv->p_media_library;
+    vlc_mutex_unlock( &p_priv->lock );
+    return p_ml;
 }
 
 static void vlc_ml_thumbnails_release( vlc_ml_thumbnail_t *p_thumbnails )
@@ -35,8 +35,10 @@
 #include <stdarg.h>                                       /* va_list for BSD */
 #include <unistd.h>
 #include <assert.h>
+#include <limits.h>
 
 #include <vlc_common.h>
+#include <vlc_atomic.h>
 #include <vlc_interface.h>
 #include <vlc_charset.h>
 #include <vlc_modules.h>
@@ -438,6 +440,414 @@ static struct vlc_logger *vlc_LogModuleCreate(vlc_object_t *parent)
     return &module->frontend;
 }
 
+/**
+ * Asynchronous message log.
+ *
+ * A message log that filters and formats messages on the emitting thread,
+ * then queues them to a dedicated thread that feeds the back-end. Emitters
+ * never block on the back-end I/O nor on its locks.
+ */
+#define VLC_LOG_ASYNC_MAX 4096
+#define VLC_LOG_RATE_SLOTS 64
+
+struct vlc_log_filter {
+    char *module;
+    int verbosity;
+};
+
+struct vlc_log_record {
+    _Atomic(struct vlc_log_record *) next;
+    int type;
+    vlc_log_t meta;
+    char text[];
+};
+
+struct vlc_log_rate {
+    atomic_uint_least64_t state; /* window (seconds) << 32 | message count */
+    atomic_uint suppressed;
+};
+
+struct vlc_logger_async {
+    struct vlc_logger frontend;
+    struct vlc_logger *backend;
+
+    /* Per-module verbosity filters, read-only once created */
+    struct vlc_log_filter *filters;
+    size_t filter_count;
+    int default_verbosity;
+
+    /* Call site rate-limiting */
+    unsigned rate_limit;
+    struct vlc_log_rate rates[VLC_LOG_RATE_SLOTS];
+
+    /* Intrusive multiple producers single consumer queue */
+    _Atomic(struct vlc_log_record *) head;
+    struct vlc_log_record *tail;
+    struct vlc_log_record stub;
+
+    atomic_uint pending;
+    atomic_uint dropped;
+    atomic_bool sleeping;
+    atomic_bool dead;
+    vlc_sem_t wait;
+    vlc_thread_t thread;
+};
+
+static void vlc_LogAsyncPush(struct vlc_logger_async *async,
+                             struct vlc_log_record *rec)
+{
+    struct vlc_log_record *prev;
+
+    atomic_store_explicit(&rec->next, NULL, memory_order_relaxed);
+    prev = atomic_exchange_explicit(&async->head, rec, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, rec, memory_order_release);
+}
+
+static struct vlc_log_record *vlc_LogAsyncPop(struct vlc_logger_async *async)
+{
+    struct vlc_log_record *tail = async->tail;
+    struct vlc_log_record *next =
+        atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    if (tail == &async->stub) {
+        if (next == NULL)
+            return NULL;
+        async->tail = tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+
+    if (next != NULL) {
+        async->tail = next;
+        return tail;
+    }
+
+    if (tail != atomic_load_explicit(&async->head, memory_order_acquire))
+        return NULL; /* a producer is half-way through pushing */
+
+    vlc_LogAsyncPush(async, &async->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next == NULL)
+        return NULL;
+    async->tail = next;
+    return tail;
+}
+
+static bool vlc_LogAsyncIsEmpty(struct vlc_logger_async *async)
+{
+    return async->tail == &async->stub
+        && atomic_load(&async->stub.next) == NULL;
+}
+
+static struct vlc_log_record *vlc_LogRecordNew(int type, const vlc_log_t *item,
+                                               const char *format, va_list ap)
+{
+    const char *module = item->psz_module;
+    const char *header = item->psz_header;
+    size_t modlen = strlen(module) + 1;
+    size_t hdrlen = (header != NULL) ? strlen(header) + 1 : 0;
+    va_list aq;
+
+    va_copy(aq, ap);
+    int len = vsnprintf(NULL, 0, format, aq);
+    va_end(aq);
+    if (len < 0)
+        return NULL;
+
+    struct vlc_log_record *rec = malloc(sizeof (*rec) + len + 1 + modlen
+                                        + hdrlen);
+    if (unlikely(rec == NULL))
+        return NULL;
+
+    vsnprintf(rec->text, len + 1, format, ap);
+    rec->type = type;
+    rec->meta = *item;
+    /* NOTE: The module name may live on the stack of the emitter. */
+    rec->meta.psz_module = memcpy(rec->text + len + 1, module, modlen);
+    if (header != NULL)
+        rec->meta.psz_header = memcpy(rec->text + len + 1 + modlen, header,
+                                      hdrlen);
+    return rec;
+}
+
+static int vlc_LogAsyncVerbosity(const struct vlc_logger_async *async,
+                                 const char *module)
+{
+    for (size_t i = 0; i < async->filter_count; i++)
+        if (strcmp(async->filters[i].module, module) == 0)
+            return async->filters[i].verbosity;
+    return async->default_verbosity;
+}
+
+/**
+ * Accounts a message from a call site against the rate limit.
+ *
+ * Call sites share a slot when their hashes collide, in which case they
+ * share the budget.
+ *
+ * \param suppressed where to store how many messages from the slot were
+ * suppressed during the previous window
+ * \return whether the message shall be emitted
+ */
+static bool vlc_LogAsyncRateCheck(struct vlc_logger_async *async,
+                                  const vlc_log_t *item, unsigned *suppressed)
+{
+    uintptr_t hash = (uintptr_t)item->file * 31 + item->line;
+    struct vlc_log_rate *rate =
+        &async->rates[(hash ^ (hash >> 7)) % VLC_LOG_RATE_SLOTS];
+    uint_least64_t window = (uint32_t)SEC_FROM_VLC_TICK(vlc_tick_now());
+    uint_least64_t state = atomic_load_explicit(&rate->state,
+                                                memory_order_relaxed);
+    uint_least64_t newstate;
+
+    *suppressed = 0;
+    do {
+        if ((state >> 32) != window)
+            newstate = (window << 32) | 1;
+        else if ((uint32_t)state >= async->rate_limit) {
+            atomic_fetch_add_explicit(&rate->suppressed, 1,
+                                      memory_order_relaxed);
+            return false;
+        }
+        else
+            newstate = state + 1;
+    } while (!atomic_compare_exchange_weak_explicit(&rate->state, &state,
+                                                    newstate,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed));
+
+    if ((state >> 32) != window)
+        *suppressed = atomic_exchange_explicit(&rate->suppressed, 0,
+                                               memory_order_relaxed);
+    return true;
+}
+
+static void vlc_LogAsyncQueue(struct vlc_logger_async *async,
+                              struct vlc_log_record *rec)
+{
+    if (atomic_fetch_add_explicit(&async->pending, 1, memory_order_relaxed)
+         >= VLC_LOG_ASYNC_MAX) {
+        atomic_fetch_sub_explicit(&async->pending, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&async->dropped, 1, memory_order_relaxed);
+        free(rec);
+        return;
+    }
+
+    vlc_LogAsyncPush(async, rec);
+
+    if (atomic_exchange(&async->sleeping, false))
+        vlc_sem_post(&async->wait);
+}
+
+static struct vlc_log_record *vlc_LogRecordPrintf(int type,
+                                                  const vlc_log_t *item,
+                                                  const char *format, ...)
+{
+    struct vlc_log_record *rec;
+    va_list ap;
+
+    va_start(ap, format);
+    rec = vlc_LogRecordNew(type, item, format, ap);
+    va_end(ap);
+    return rec;
+}
+
+static void vlc_vaLogAsync(void *d, int type, const vlc_log_t *item,
+                           const char *format, va_list ap)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, frontend);
+
+    /* Filter before paying for the formatting */
+    if (vlc_LogAsyncVerbosity(async, item->psz_module) < type)
+        return;
+
+    if (async->rate_limit > 0 && item->file != NULL) {
+        unsigned suppressed;
+
+        if (!vlc_LogAsyncRateCheck(async, item, &suppressed))
+            return;
+
+        if (suppressed > 0) {
+            struct vlc_log_record *note =
+                vlc_LogRecordPrintf(type, item,
+                                    "%u similar message(s) suppressed",
+                                    suppressed);
+            if (note != NULL)
+                vlc_LogAsyncQueue(async, note);
+        }
+    }
+
+    struct vlc_log_record *rec = vlc_LogRecordNew(type, item, format, ap);
+    if (unlikely(rec == NULL))
+        return;
+
+    vlc_LogAsyncQueue(async, rec);
+}
+
+static void vlc_LogAsyncDrain(struct vlc_logger_async *async)
+{
+    struct vlc_logger *backend = async->backend;
+    struct vlc_log_record *rec;
+
+    while ((rec = vlc_LogAsyncPop(async)) != NULL) {
+        atomic_fetch_sub_explicit(&async->pending, 1, memory_order_relaxed);
+        vlc_LogCallback(backend, rec->type, &rec->meta, "%s", rec->text);
+        free(rec);
+    }
+
+    unsigned dropped = atomic_exchange_explicit(&async->dropped, 0,
+                                                memory_order_relaxed);
+    if (dropped > 0) {
+        vlc_log_t meta = {
+            .i_object_id = (uintptr_t)(void *)async,
+            .psz_object_type = "generic",
+            .psz_module = "logger",
+            .line = -1,
+            .tid = vlc_thread_id(),
+        };
+
+        vlc_LogCallback(backend, VLC_MSG_WARN, &meta,
+                        "%u message(s) dropped (log queue full)", dropped);
+    }
+}
+
+static void *vlc_LogAsyncThread(void *data)
+{
+    struct vlc_logger_async *async = data;
+
+    for (;;) {
+        vlc_LogAsyncDrain(async);
+
+        atomic_store(&async->sleeping, true);
+        if (!vlc_LogAsyncIsEmpty(async)) {
+            atomic_store(&async->sleeping, false);
+            continue;
+        }
+        if (atomic_load(&async->dead))
+            break;
+        vlc_sem_wait(&async->wait);
+    }
+    return NULL;
+}
+
+static void vlc_LogAsyncClose(void *d)
+{
+    struct vlc_logger *logger = d;
+    struct vlc_logger_async *async =
+        container_of(logger, struct vlc_logger_async, frontend);
+    struct vlc_logger *backend = async->backend;
+
+    atomic_store(&async->dead, true);
+    vlc_sem_post(&async->wait);
+    vlc_join(async->thread, NULL);
+
+    backend->ops->destroy(backend);
+
+    for (size_t i = 0; i < async->filter_count; i++)
+        free(async->filters[i].module);
+    free(async->filters);
+    free(async);
+}
+
+static const struct vlc_logger_operations async_ops = {
+    vlc_vaLogAsync,
+    vlc_LogAsyncClose,
+};
+
+/**
+ * Parses the per-module verbosity filters.
+ *
+ * The list is a comma-separated list of module=verbosity entries, where the
+ * "*" module sets the verbosity of modules that are not listed.
+ */
+static void vlc_LogAsyncParseFilters(struct vlc_logger_async *async,
+                                     char *str)
+{
+    char *saveptr;
+
+    for (char *tok = strtok_r(str, ",", &saveptr); tok != NULL;
+         tok = strtok_r(NULL, ",", &saveptr)) {
+        char *eq = strchr(tok, '=');
+        if (eq == NULL || eq == tok)
+            continue;
+        *eq = '\0';
+
+        int verbosity = atoi(eq + 1);
+        if (verbosity < 0)
+            verbosity = -1;
+        else if (verbosity > VLC_MSG_DBG - VLC_MSG_ERR)
+            verbosity = VLC_MSG_DBG - VLC_MSG_ERR;
+        verbosity += VLC_MSG_ERR;
+
+        if (strcmp(tok, "*") == 0) {
+            async->default_verbosity = verbosity;
+            continue;
+        }
+
+        struct vlc_log_filter *tab =
+            realloc(async->filters,
+                    (async->filter_count + 1) * sizeof (*tab));
+        if (unlikely(tab == NULL))
+            break;
+        async->filters = tab;
+
+        char *module = strdup(tok);
+        if (unlikely(module == NULL))
+            break;
+        tab[async->filter_count].module = module;
+        tab[async->filter_count].verbosity = verbosity;
+        async->filter_count++;
+    }
+}
+
+static struct vlc_logger *vlc_LogAsyncCreate(vlc_object_t *obj,
+                                             struct vlc_logger *backend)
+{
+    struct vlc_logger_async *async = malloc(sizeof (*async));
+    if (unlikely(async == NULL))
+        return NULL;
+
+    async->frontend.ops = &async_ops;
+    async->backend = backend;
+    async->filters = NULL;
+    async->filter_count = 0;
+    async->default_verbosity = VLC_MSG_DBG;
+
+    char *str = var_InheritString(obj, "log-filter");
+    if (str != NULL) {
+        vlc_LogAsyncParseFilters(async, str);
+        free(str);
+    }
+
+    int64_t limit = var_InheritInteger(obj, "log-rate-limit");
+    async->rate_limit = (limit > 0) ? (limit < UINT_MAX ? limit : UINT_MAX)
+                                    : 0;
+    for (size_t i = 0; i < VLC_LOG_RATE_SLOTS; i++) {
+        atomic_init(&async->rates[i].state, 0);
+        atomic_init(&async->rates[i].suppressed, 0);
+    }
+
+    atomic_init(&async->stub.next, NULL);
+    atomic_init(&async->head, &async->stub);
+    async->tail = &async->stub;
+    atomic_init(&async->pending, 0);
+    atomic_init(&async->dropped, 0);
+    atomic_init(&async->sleeping, false);
+    atomic_init(&async->dead, false);
+    vlc_sem_init(&async->wait, 0);
+
+    if (vlc_clone(&async->thread, vlc_LogAsyncThread, async,
+                  VLC_THREAD_PRIORITY_LOW)) {
+        for (size_t i = 0; i < async->filter_count; i++)
+            free(async->filters[i].module);
+        free(async->filters);
+        free(async);
+        return NULL;
+    }
+    return &async->frontend;
+}
+
 /**
  * Initializes the messages logging subsystem and drain the early messages to
  * the configured log.
@@ -447,6 +857,11 @@ void vlc_LogInit(libvlc_int_t *vlc)
     struct vlc_logger *logger = vlc_LogModuleCreate(VLC_OBJECT(vlc));
     if (logger == NULL)
         logger = &discard_log;
+    else if (var_InheritBool(vlc, "log-async")) {
+        struct vlc_logger *async = vlc_LogAsyncCreate(VLC_OBJECT(vlc), logger);
+        if (async != NULL)
+            logger = async;
+    }
 
     vlc_LogSwitch(vlc->obj.logger, logger);
 }
@@ -35,6 +35,7 @@
 
 #include <vlc_common.h>
 #include "picture.h"
+#include "libvlc.h"
 #include <vlc_image.h>
 #include <vlc_block.h>
 
@@ -60,6 +61,82 @@ static void picture_DestroyDummy( picture_t *p_picture )
     (void) p_picture;
 }
 
+/*
+ * Recently released large buffers are kept for reuse: the video chains
+ * allocate and release pictures of the same few sizes all the time, and a
+ * fresh buffer costs a page fault per page on first access.
+ */
+#define PICTURE_CACHE_MAX      8
+#define PICTURE_CACHE_MIN_SIZE (UINT32_C(1) << 20)
+
+static struct
+{
+    vlc_mutex_t lock;
+    unsigned count;
+    picture_buffer_t buffers[PICTURE_CACHE_MAX];
+} picture_cache = { .lock = VLC_STATIC_MUTEX };
+
+static void *picture_CacheGet(int *restrict fdp, size_t size)
+{
+    void *base = NULL;
+
+    if (size < PICTURE_CACHE_MIN_SIZE)
+        return picture_Allocate(fdp, size);
+
+    vlc_mutex_lock(&picture_cache.lock);
+    for (unsigned i = picture_cache.count; i-- > 0;)
+    {
+        picture_buffer_t *buf = &picture_cache.buffers[i];
+
+        if (buf->size == size)
+        {
+            *fdp = buf->fd;
+            base = buf->base;
+            *buf = picture_cache.buffers[--picture_cache.count];
+            break;
+        }
+    }
+    vlc_mutex_unlock(&picture_cache.lock);
+
+    return (base != NULL) ? base : picture_Allocate(fdp, size);
+}
+
+static void picture_CachePut(const picture_buffer_t *res)
+{
+    picture_buffer_t old = { .base = NULL };
+
+    if (res->size < PICTURE_CACHE_MIN_SIZE)
+    {
+        picture_Deallocate(res->fd, res->base, res->size);
+        return;
+    }
+
+    vlc_mutex_lock(&picture_cache.lock);
+    if (picture_cache.count == PICTURE_CACHE_MAX)
+    {   /* evict the oldest buffer */
+        old = picture_cache.buffers[0];
+        memmove(&picture_cache.buffers[0], &picture_cache.buffers[1],
+                (PICTURE_CACHE_MAX - 1) * sizeof (old));
+        picture_cache.count--;
+    }
+    picture_cache.buffers[picture_cache.count++] = *res;
+    vlc_mutex_unlock(&picture_cache.lock);
+
+    if (old.base != NULL)
+        picture_Deallocate(old.fd, old.base, old.size);
+}
+
+__attribute__((destructor))
+static void picture_CacheClean(void)
+{
+    for (unsigned i = 0; i < picture_cache.count; i++)
+    {
+        picture_buffer_t *buf = &picture_cache.buffers[i];
+        picture_Deallocate(buf->fd, buf->base, buf->size);
+    }
+    picture_cache.count = 0;
+}
+
 /**
  * Destroys a picture allocated with picture_NewFromFormat().
  */
@@ -68,7 +145,7 @@ static void picture_DestroyFromFormat(picture_t *pic)
     picture_buffer_t *res = pic->p_sys;
 
     if (res != NULL)
-        picture_Deallocate(res->fd, res->base, res->size);
+        picture_CachePut(res);
 }
 
 VLC_WEAK void *picture_Allocate(int *restrict fdp, size_t size)
@@ -227,6 +304,7 @@ picture_t *picture_NewFromResource( const video_format_t *p_fmt, const picture_r
 {
     assert(p_resource != NULL);
 
+    vlc_instrument(VLC_INSTRUMENT_PICTURE, 0);
     picture_priv_t *priv = malloc(sizeof(*priv));
     if (unlikely(priv == NULL))
         return NULL;
@@ -299,7 +377,8 @@ picture_t *picture_NewFromFormat(const video_format_t *restrict fmt)
     if (unlikely(pic_size >= PICTURE_SW_SIZE_MAX))
         goto error;
 
-    unsigned char *buf = picture_Allocate(&res->fd, pic_size);
+    vlc_instrument(VLC_INSTRUMENT_PICTURE, pic_size);
+    unsigned char *buf = picture_CacheGet(&res->fd, pic_size);
     if (unlikely(buf == NULL))
         goto error;
 
@@ -547,13 +626,14 @@ int picture_Export( vlc_object_t *p_obj,
                          * fmt_in.i_sar_num / fmt_in.i_height / fmt_in.i_sar_den;
     }
 
-    image_handler_t *p_image = image_HandlerCreate( p_obj );
+    libvlc_int_t *p_libvlc = vlc_object_instance(p_obj);
+    image_handler_t *p_image = libvlc_ImageHandlerAcquire( p_libvlc );
     if( !p_image )
         return VLC_ENOMEM;
 
     block_t *p_block = image_Write( p_image, p_picture, &fmt_in, &fmt_out );
 
-    image_HandlerDelete( p_image );
+    libvlc_ImageHandlerRelease( p_libvlc, p_image );
 
     if( !p_block )
         return VLC_EGENERIC;
@@ -35,19 +35,26 @@
 #include <vlc_atomic.h>
 #include "picture.h"
 
-#define POOL_MAX (CHAR_BIT * sizeof (unsigned long long))
+/* Availability is tracked by one bit per picture, in as many words as
+ * needed. Pictures are taken and returned with atomic operations; the lock
+ * only serves picture_pool_Wait(). */
+#define POOL_WORD_BITS (CHAR_BIT * sizeof (unsigned long long))
 
-static_assert ((POOL_MAX & (POOL_MAX - 1)) == 0, "Not a power of two");
+struct picture_pool_slot {
+    picture_t      *picture;
+    picture_pool_t *pool;
+};
 
 struct picture_pool_t {
     vlc_mutex_t lock;
     vlc_cond_t  wait;
 
-    bool               canceled;
-    unsigned long long available;
+    atomic_bool        canceled;
+    atomic_uint        waiters;
+    _Atomic unsigned long long *available;
     vlc_atomic_rc_t    refs;
-    unsigned short     picture_count;
-    picture_t  *picture[];
+    unsigned           picture_count;
+    struct picture_pool_slot slot[];
 };
 
 static void picture_pool_Destroy(picture_pool_t *pool)
@@ -55,73 +62,120 @@ static void picture_pool_Destroy(picture_pool_t *pool)
     if (!vlc_atomic_rc_dec(&pool->refs))
         return;
 
-    aligned_free(pool);
+    free(pool);
 }
 
 void picture_pool_Release(picture_pool_t *pool)
 {
     for (unsigned i = 0; i < pool->picture_count; i++)
-        picture_Release(pool->picture[i]);
+        picture_Release(pool->slot[i].picture);
     picture_pool_Destroy(pool);
 }
 
-static void picture_pool_ReleaseClone(picture_t *clone)
+/* Takes an available picture, returns its offset or -1 if none */
+static int picture_pool_Take(picture_pool_t *pool)
 {
-    picture_priv_t *priv = (picture_priv_t *)clone;
-    uintptr_t sys = (uintptr_t)priv->gc.opaque;
-    picture_pool_t *pool = (void *)(sys & ~(POOL_MAX - 1));
-    unsigned offset = sys & (POOL_MAX - 1);
-    picture_t *picture = pool->picture[offset];
+    unsigned words = (pool->picture_count + POOL_WORD_BITS - 1)
+                   / POOL_WORD_BITS;
 
-    picture_Release(picture);
+    for (unsigned w = 0; w < words; w++)
+    {
+        unsigned long long available =
+            atomic_load_explicit(&pool->available[w], memory_order_relaxed);
 
-    vlc_mutex_lock(&pool->lock);
-    assert(!(pool->available & (1ULL << offset)));
-    pool->available |= 1ULL << offset;
-    vlc_cond_signal(&pool->wait);
-    vlc_mutex_unlock(&pool->lock);
+        while (available != 0)
+        {
+            unsigned i = ctz(available);
+
+            if (atomic_compare_exchange_weak_explicit(&pool->available[w],
+                    &available, available & ~(1ULL << i),
+                    memory_order_acquire, memory_order_relaxed))
+                return w * POOL_WORD_BITS + i;
+        }
+    }
+    return -1;
+}
+
+static void picture_pool_Put(picture_pool_t *pool, unsigned offset)
+{
+    _Atomic unsigned long long *word = &pool->available[offset / POOL_WORD_BITS];
+    unsigned long long bit = 1ULL << (offset % POOL_WORD_BITS);
+    unsigned long long prev = atomic_fetch_or(word, bit);
+
+    assert(!(prev & bit));
+    (void) prev;
 
+    /* Sequentially consistent with picture_pool_Wait(): either the waiter
+     * sees the bit, or this sees the waiter and wakes it up. */
+    if (atomic_load(&pool->waiters) > 0)
+    {
+        vlc_mutex_lock(&pool->lock);
+        vlc_cond_signal(&pool->wait);
+        vlc_mutex_unlock(&pool->lock);
+    }
+}
+
+static void picture_pool_ReleaseClone(picture_t *clone)
+{
+    picture_priv_t *priv = (picture_priv_t *)clone;
+    struct picture_pool_slot *slot = priv->gc.opaque;
+    picture_pool_t *pool = slot->pool;
+
+    picture_Release(slot->picture);
+    picture_pool_Put(pool, slot - pool->slot);
     picture_pool_Destroy(pool);
 }
 
 static picture_t *picture_pool_ClonePicture(picture_pool_t *pool,
                                             unsigned offset)
 {
-    picture_t *picture = pool->picture[offset];
-    uintptr_t sys = ((uintptr_t)pool) + offset;
+    struct picture_pool_slot *slot = &pool->slot[offset];
 
-    picture_t *clone = picture_InternalClone(picture, picture_pool_ReleaseClone,
-                                 (void*)sys);
+    picture_t *clone = picture_InternalClone(slot->picture,
+                                             picture_pool_ReleaseClone, slot);
     if (clone != NULL) {
         assert(!picture_HasChainedPics(clone));
         vlc_atomic_rc_inc(&pool->refs);
     }
+    else
+        picture_pool_Put(pool, offset);
     return clone;
 }
 
 picture_pool_t *picture_pool_New(unsigned count, picture_t *const *tab)
 {
-    if (unlikely(count > POOL_MAX))
-        return NULL;
-
+    const size_t words = (count + POOL_WORD_BITS - 1) / POOL_WORD_BITS;
+    const size_t align = _Alignof (_Atomic unsigned long long);
     picture_pool_t *pool;
-    size_t size = sizeof (*pool) + count * sizeof (picture_t *);
+    size_t size = sizeof (*pool) + count * sizeof (pool->slot[0]);
+
+    size += (-size) & (align - 1);
+    size_t offset = size;
+    size += words * sizeof (*pool->available);
 
-    size += (-size) & (POOL_MAX - 1);
-    pool = aligned_alloc(POOL_MAX, size);
+    pool = malloc(size);
     if (unlikely(pool == NULL))
         return NULL;
 
     vlc_mutex_init(&pool->lock);
     vlc_cond_init(&pool->wait);
-    if (count == POOL_MAX)
-        pool->available = ~0ULL;
-    else
-        pool->available = (1ULL << count) - 1;
+    pool->available = (void *)((char *)pool + offset);
+    for (size_t w = 0; w < words; w++)
+    {
+        unsigned bits = count - w * POOL_WORD_BITS;
+
+        atomic_init(&pool->available[w], bits >= POOL_WORD_BITS
+                                         ? ~0ULL : (1ULL << bits) - 1);
+    }
     vlc_atomic_rc_init(&pool->refs);
     pool->picture_count = count;
-    memcpy(pool->picture, tab, count * sizeof (picture_t *));
-    pool->canceled = false;
+    for (unsigned i = 0; i < count; i++)
+    {
+        pool->slot[i].picture = tab[i];
+        pool->slot[i].pool = pool;
+    }
+    atomic_init(&pool->canceled, false);
+    atomic_init(&pool->waiters, 0);
     return pool;
 }
 
@@ -174,49 +228,38 @@ error:
 
 picture_t *picture_pool_Get(picture_pool_t *pool)
 {
-    unsigned long long available;
-
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
-    available = pool->available;
 
-    while (available != 0)
-    {
-        int i = ctz(available);
-
-        if (unlikely(pool->canceled))
-            break;
-
-        pool->available &= ~(1ULL << i);
-        vlc_mutex_unlock(&pool->lock);
-        available &= ~(1ULL << i);
-
-        return picture_pool_ClonePicture(pool, i);
-    }
+    if (unlikely(atomic_load_explicit(&pool->canceled, memory_order_relaxed)))
+        return NULL;
 
-    vlc_mutex_unlock(&pool->lock);
-    return NULL;
+    int i = picture_pool_Take(pool);
+    if (i < 0)
+        return NULL;
+    return picture_pool_ClonePicture(pool, i);
 }
 
 picture_t *picture_pool_Wait(picture_pool_t *pool)
 {
-    vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    while (pool->available == 0)
+    int i = picture_pool_Take(pool);
+    if (i >= 0)
+        return picture_pool_ClonePicture(pool, i);
+
+    vlc_mutex_lock(&pool->lock);
+    atomic_fetch_add(&pool->waiters, 1);
+    while ((i = picture_pool_Take(pool)) < 0)
     {
-        if (pool->canceled)
-        {
-            vlc_mutex_unlock(&pool->lock);
-            return NULL;
-        }
+        if (atomic_load_explicit(&pool->canceled, memory_order_relaxed))
+            break;
         vlc_cond_wait(&pool->wait, &pool->lock);
     }
-
-    int i = ctz(pool->available);
-    pool->available &= ~(1ULL << i);
+    atomic_fetch_sub(&pool->waiters, 1);
     vlc_mutex_unlock(&pool->lock);
 
+    if (i < 0)
+        return NULL;
     return picture_pool_ClonePicture(pool, i);
 }
 
@@ -225,7 +268,7 @@ void picture_pool_Cancel(picture_pool_t *pool, bool canceled)
     vlc_mutex_lock(&pool->lock);
     assert(vlc_atomic_rc_get(&pool->refs) > 0);
 
-    pool->canceled = canceled;
+    atomic_store_explicit(&pool->canceled, canceled, memory_order_relaxed);
     if (canceled)
         vlc_cond_broadcast(&pool->wait);
     vlc_mutex_unlock(&pool->lock);
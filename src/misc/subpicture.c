@@ -38,6 +38,7 @@ struct subpicture_private_t
 {
     video_format_t src;
     video_format_t dst;
+    unsigned update_count;
 };
 
 subpicture_t *subpicture_New( const subpicture_updater_t *p_upd )
@@ -63,6 +64,7 @@ subpicture_t *subpicture_New( const subpicture_updater_t *p_upd )
         }
         video_format_Init( &p_private->src, 0 );
         video_format_Init( &p_private->dst, 0 );
+        p_private->update_count = 0;
 
         p_subpic->updater   = *p_upd;
         p_subpic->p_private = p_private;
@@ -168,6 +170,7 @@ void subpicture_Update( subpicture_t *p_subpicture,
     p_subpicture->p_region = NULL;
 
     p_upd->pf_update( p_subpicture, p_fmt_src, p_fmt_dst, i_ts );
+    p_private->update_count++;
 
     video_format_Clean( &p_private->src );
     video_format_Clean( &p_private->dst );
@@ -176,6 +179,12 @@ void subpicture_Update( subpicture_t *p_subpicture,
     video_format_Copy( &p_private->dst, p_fmt_dst );
 }
 
+unsigned subpicture_GetUpdateCount( const subpicture_t *p_subpicture )
+{
+    if( !p_subpicture->p_private )
+        return 0;
+    return p_subpicture->p_private->update_count;
+}
 
 subpicture_region_private_t *subpicture_region_private_New( video_format_t *p_fmt )
 {
@@ -27,6 +27,9 @@ struct subpicture_region_private_t {
 
 subpicture_region_t * subpicture_region_NewInternal( const video_format_t *p_fmt );
 
+/* Returns the number of times the regions were regenerated by the updater */
+unsigned subpicture_GetUpdateCount( const subpicture_t * );
+
 subpicture_region_private_t *subpicture_region_private_New(video_format_t *);
 void subpicture_region_private_Delete(subpicture_region_private_t *);
 
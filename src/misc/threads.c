@@ -166,12 +166,18 @@ void vlc_mutex_lock(vlc_mutex_t *mtx)
     if (vlc_mutex_trylock(mtx) == 0)
         return;
 
+#ifdef HAVE_INSTRUMENTATION
+    vlc_tick_t begin = vlc_tick_now();
+#endif
     int canc = vlc_savecancel(); /* locking is never a cancellation point */
 
     while (atomic_exchange_explicit(&mtx->value, 2, memory_order_acquire))
         vlc_atomic_wait(&mtx->value, 2);
 
     vlc_restorecancel(canc);
+#ifdef HAVE_INSTRUMENTATION
+    vlc_instrument(VLC_INSTRUMENT_LOCK, vlc_tick_now() - begin);
+#endif
     atomic_store_explicit(&mtx->owner, THREAD_SELF, memory_order_relaxed);
 }
 
@@ -0,0 +1,294 @@
+/*****************************************************************************
+ * tracer.c: Pipeline tracer
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_tracer.h>
+#include "../libvlc.h"
+
+#define TRACE_RING_SIZE 8192 /* events per thread, power of two */
+
+struct vlc_trace_event
+{
+    vlc_tick_t date;
+    vlc_tick_t ts;
+    const void *id;
+    size_t size;
+    unsigned long thread;
+    enum vlc_tracer_stage stage;
+};
+
+/* Each ring is written by a single thread at a time. A slot is tagged with
+ * the index of its event plus one once written, and with zero while it is
+ * being overwritten, so that the reader can skip torn events. */
+struct vlc_trace_slot
+{
+    atomic_ullong seq;
+    struct vlc_trace_event event;
+};
+
+struct vlc_trace_ring
+{
+    struct vlc_trace_ring *next;
+    atomic_bool used;
+    atomic_ullong head;
+    struct vlc_trace_slot slots[TRACE_RING_SIZE];
+};
+
+struct vlc_tracer
+{
+    atomic_bool enabled;
+    vlc_tick_t start;
+    vlc_mutex_t lock;
+    struct vlc_trace_ring *rings;
+    vlc_threadvar_t ring_key;
+    vlc_object_t *obj;
+    char *path;
+};
+
+static const char *const stage_names[] = {
+    [VLC_TRACER_ACCESS_READ] = "access read",
+    [VLC_TRACER_DEMUX_OUT] = "demux out",
+    [VLC_TRACER_PACKETIZER_OUT] = "packetizer out",
+    [VLC_TRACER_DECODER_IN] = "decoder in",
+    [VLC_TRACER_DECODER_OUT] = "decoder out",
+    [VLC_TRACER_FILTER_OUT] = "filter out",
+    [VLC_TRACER_VOUT_PREPARE] = "vout prepare",
+    [VLC_TRACER_VOUT_DISPLAY] = "vout display",
+    [VLC_TRACER_AOUT_PLAY] = "aout play",
+};
+
+/* Called when a thread exits: its ring can be reused by another thread */
+static void vlc_tracer_ReleaseRing(void *data)
+{
+    struct vlc_trace_ring *ring = data;
+
+    atomic_store_explicit(&ring->used, false, memory_order_release);
+}
+
+static struct vlc_trace_ring *vlc_tracer_GetRing(struct vlc_tracer *tracer)
+{
+    struct vlc_trace_ring *ring;
+
+    vlc_mutex_lock(&tracer->lock);
+    for (ring = tracer->rings; ring != NULL; ring = ring->next)
+        if (!atomic_load_explicit(&ring->used, memory_order_acquire))
+            break;
+
+    if (ring == NULL)
+    {
+        ring = malloc(sizeof (*ring));
+        if (unlikely(ring == NULL))
+        {
+            vlc_mutex_unlock(&tracer->lock);
+            return NULL;
+        }
+
+        atomic_init(&ring->head, 0);
+        for (size_t i = 0; i < TRACE_RING_SIZE; i++)
+            atomic_init(&ring->slots[i].seq, 0);
+        ring->next = tracer->rings;
+        tracer->rings = ring;
+    }
+
+    atomic_store_explicit(&ring->used, true, memory_order_relaxed);
+    vlc_mutex_unlock(&tracer->lock);
+
+    if (vlc_threadvar_set(tracer->ring_key, ring))
+    {
+        vlc_tracer_ReleaseRing(ring);
+        return NULL;
+    }
+    return ring;
+}
+
+void vlc_tracer_Trace(struct vlc_tracer *tracer, enum vlc_tracer_stage stage,
+                      const void *id, vlc_tick_t ts, size_t size)
+{
+    if (tracer == NULL
+     || !atomic_load_explicit(&tracer->enabled, memory_order_relaxed))
+        return;
+
+    struct vlc_trace_ring *ring = vlc_threadvar_get(tracer->ring_key);
+    if (unlikely(ring == NULL))
+    {
+        ring = vlc_tracer_GetRing(tracer);
+        if (ring == NULL)
+            return;
+    }
+
+    unsigned long long n = atomic_load_explicit(&ring->head,
+                                                memory_order_relaxed);
+    struct vlc_trace_slot *slot = &ring->slots[n % TRACE_RING_SIZE];
+
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->event = (struct vlc_trace_event) {
+        .date = vlc_tick_now(),
+        .ts = ts,
+        .id = id,
+        .size = size,
+        .thread = vlc_thread_id(),
+        .stage = stage,
+    };
+    atomic_store_explicit(&slot->seq, n + 1, memory_order_release);
+    atomic_store_explicit(&ring->head, n + 1, memory_order_release);
+}
+
+void vlc_tracer_Start(struct vlc_tracer *tracer)
+{
+    vlc_mutex_lock(&tracer->lock);
+    tracer->start = vlc_tick_now();
+    vlc_mutex_unlock(&tracer->lock);
+    atomic_store_explicit(&tracer->enabled, true, memory_order_relaxed);
+}
+
+static bool vlc_tracer_ReadEvent(struct vlc_trace_ring *ring,
+                                 unsigned long long i,
+                                 struct vlc_trace_event *event)
+{
+    struct vlc_trace_slot *slot = &ring->slots[i % TRACE_RING_SIZE];
+
+    if (atomic_load_explicit(&slot->seq, memory_order_acquire) != i + 1)
+        return false;
+    *event = slot->event;
+    atomic_thread_fence(memory_order_acquire);
+    return atomic_load_explicit(&slot->seq, memory_order_relaxed) == i + 1;
+}
+
+static void vlc_tracer_WriteRing(struct vlc_tracer *tracer, FILE *stream,
+                                 struct vlc_trace_ring *ring, bool *first)
+{
+    unsigned long long head = atomic_load_explicit(&ring->head,
+                                                   memory_order_acquire);
+    unsigned long long i = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+
+    for (; i < head; i++)
+    {
+        struct vlc_trace_event event;
+
+        if (!vlc_tracer_ReadEvent(ring, i, &event)
+         || event.date < tracer->start)
+            continue;
+
+        fprintf(stream, "%s\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\","
+                "\"ts\":%"PRId64",\"pid\":1,\"tid\":%lu,"
+                "\"args\":{\"id\":\"%p\",\"ts\":%"PRId64",\"size\":%zu}}",
+                *first ? "" : ",", stage_names[event.stage],
+                US_FROM_VLC_TICK(event.date - tracer->start), event.thread,
+                event.id, event.ts != VLC_TICK_INVALID
+                          ? US_FROM_VLC_TICK(event.ts) : INT64_C(-1),
+                event.size);
+        *first = false;
+    }
+}
+
+int vlc_tracer_Stop(struct vlc_tracer *tracer, const char *path)
+{
+    atomic_store_explicit(&tracer->enabled, false, memory_order_relaxed);
+    if (path == NULL)
+        return VLC_SUCCESS;
+
+    FILE *stream = vlc_fopen(path, "wt");
+    if (stream == NULL)
+    {
+        msg_Err(tracer->obj, "cannot create trace file %s: %s", path,
+                vlc_strerror_c(errno));
+        return VLC_EGENERIC;
+    }
+
+    bool first = true;
+
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", stream);
+    vlc_mutex_lock(&tracer->lock);
+    for (struct vlc_trace_ring *ring = tracer->rings; ring != NULL;
+         ring = ring->next)
+        vlc_tracer_WriteRing(tracer, stream, ring, &first);
+    vlc_mutex_unlock(&tracer->lock);
+    fputs("\n]}\n", stream);
+
+    if (fclose(stream) != 0)
+    {
+        msg_Err(tracer->obj, "cannot write trace file %s: %s", path,
+                vlc_strerror_c(errno));
+        return VLC_EGENERIC;
+    }
+
+    msg_Dbg(tracer->obj, "trace written to %s", path);
+    return VLC_SUCCESS;
+}
+
+struct vlc_tracer *vlc_tracer_Create(vlc_object_t *obj)
+{
+    struct vlc_tracer *tracer = malloc(sizeof (*tracer));
+    if (unlikely(tracer == NULL))
+        return NULL;
+
+    if (vlc_threadvar_create(&tracer->ring_key, vlc_tracer_ReleaseRing))
+    {
+        free(tracer);
+        return NULL;
+    }
+
+    atomic_init(&tracer->enabled, false);
+    tracer->start = VLC_TICK_0;
+    vlc_mutex_init(&tracer->lock);
+    tracer->rings = NULL;
+    tracer->obj = obj;
+    tracer->path = var_InheritString(obj, "trace-file");
+
+    if (tracer->path != NULL)
+        vlc_tracer_Start(tracer);
+    return tracer;
+}
+
+void vlc_tracer_Destroy(struct vlc_tracer *tracer)
+{
+    if (tracer->path != NULL)
+    {
+        vlc_tracer_Stop(tracer, tracer->path);
+        free(tracer->path);
+    }
+
+    vlc_threadvar_delete(&tracer->ring_key);
+
+    for (struct vlc_trace_ring *ring = tracer->rings, *next; ring != NULL;
+         ring = next)
+    {
+        next = ring->next;
+        free(ring);
+    }
+    free(tracer);
+}
+
+#undef vlc_object_get_tracer
+struct vlc_tracer *vlc_object_get_tracer(vlc_object_t *obj)
+{
+    return libvlc_priv(vlc_object_instance(obj))->tracer;
+}
@@ -27,9 +27,6 @@
 # include "config.h"
 #endif
 
-#ifdef HAVE_SEARCH_H
-# include <search.h>
-#endif
 #include <assert.h>
 #include <float.h>
 #include <math.h>
@@ -67,7 +64,8 @@ typedef struct variable_ops_t
  */
 struct variable_t
 {
-    char *       psz_name; /**< The variable unique name (must be first) */
+    char *       psz_name; /**< The variable unique name */
+    uint32_t     hash; /**< Hash of the name */
 
     /** The variable's exported value */
     vlc_value_t  val;
@@ -138,23 +136,110 @@ int_ops    = { CmpInt,     DupDummy,  FreeDummy,  },
 string_ops = { CmpString,  DupString, FreeString, },
 coords_ops = { NULL,       DupDummy,  FreeDummy,  };
 
-static int varcmp( const void *a, const void *b )
+static uint32_t VarHash( const char *psz_name )
 {
-    const variable_t *va = a, *vb = b;
+    /* FNV-1a */
+    uint32_t hash = 2166136261u;
 
-    /* psz_name must be first */
-    assert( va == (const void *)&va->psz_name );
-    return strcmp( va->psz_name, vb->psz_name );
+    for( const unsigned char *p = (const unsigned char *)psz_name; *p; p++ )
+        hash = (hash ^ *p) * 16777619u;
+    return hash;
+}
+
+static size_t VarFindSlot( const vlc_object_internals_t *priv,
+                           const char *psz_name, uint32_t hash )
+{
+    size_t i = hash & priv->var_mask;
+    variable_t *var;
+
+    while( (var = priv->var_table[i]) != NULL )
+    {
+        if( var->hash == hash && strcmp( var->psz_name, psz_name ) == 0 )
+            break;
+        i = (i + 1) & priv->var_mask;
+    }
+    return i;
 }
 
 static variable_t *Lookup( vlc_object_t *obj, const char *psz_name )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
-    void **pp_var;
 
     vlc_mutex_lock(&priv->var_lock);
-    pp_var = tfind( &psz_name, &priv->var_root, varcmp );
-    return (pp_var != NULL) ? *pp_var : NULL;
+    if( priv->var_table == NULL )
+        return NULL;
+    return priv->var_table[VarFindSlot( priv, psz_name,
+                                        VarHash( psz_name ) )];
+}
+
+/**
+ * Inserts a variable in the hash table of an object, unless a variable with
+ * the same name is already present.
+ *
+ * eturn the variable in the table, or NULL on memory error
+ */
+static variable_t *VarInsert( vlc_object_internals_t *priv, variable_t *var )
+{
+    /* Keep the load factor at most 3/4 */
+    if( (priv->var_count + 1) * 4 > (priv->var_mask + 1) * 3
+     || priv->var_table == NULL )
+    {
+        size_t size = (priv->var_table != NULL) ? (priv->var_mask + 1) * 2
+                                                : 16;
+        variable_t **table = calloc( size, sizeof (*table) );
+        if( unlikely(table == NULL) )
+            return NULL;
+
+        for( size_t i = 0; priv->var_table != NULL && i <= priv->var_mask;
+             i++ )
+        {
+            variable_t *old = priv->var_table[i];
+            if( old == NULL )
+                continue;
+
+            size_t j = old->hash & (size - 1);
+            while( table[j] != NULL )
+                j = (j + 1) & (size - 1);
+            table[j] = old;
+        }
+
+        free( priv->var_table );
+        priv->var_table = table;
+        priv->var_mask = size - 1;
+    }
+
+    size_t i = VarFindSlot( priv, var->psz_name, var->hash );
+    if( priv->var_table[i] == NULL )
+    {
+        priv->var_table[i] = var;
+        priv->var_count++;
+    }
+    return priv->var_table[i];
+}
+
+static void VarRemove( vlc_object_internals_t *priv, variable_t *var )
+{
+    size_t i = VarFindSlot( priv, var->psz_name, var->hash );
+
+    assert( priv->var_table[i] == var );
+    priv->var_table[i] = NULL;
+    priv->var_count--;
+
+    /* Shift back the following entries of the cluster, so that no lookup
+     * stops early at the hole. */
+    for( size_t j = (i + 1) & priv->var_mask; priv->var_table[j] != NULL;
+         j = (j + 1) & priv->var_mask )
+    {
+        size_t home = priv->var_table[j]->hash & priv->var_mask;
+
+        /* Leave the entry alone if its home slot is cyclically in (i, j] */
+        if( (i < j) ? (home > i && home <= j) : (home > i || home <= j) )
+            continue;
+
+        priv->var_table[i] = priv->var_table[j];
+        priv->var_table[j] = NULL;
+        i = j;
+    }
 }
 
 static void Destroy( variable_t *p_var )
@@ -297,6 +382,7 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         return VLC_ENOMEM;
 
     p_var->psz_name = strdup( psz_name );
+    p_var->hash = VarHash( psz_name );
     p_var->psz_text = NULL;
 
     p_var->i_type = i_type & ~VLC_VAR_DOINHERIT;
@@ -354,16 +440,21 @@ int (var_Create)( vlc_object_t *p_this, const char *psz_name, int i_type )
         var_Inherit(p_this, psz_name, i_type, &p_var->val);
 
     vlc_object_internals_t *p_priv = vlc_internals( p_this );
-    void **pp_var;
     variable_t *p_oldvar;
     int ret = VLC_SUCCESS;
 
+    if( unlikely(p_var->psz_name == NULL) )
+    {
+        Destroy( p_var );
+        return VLC_ENOMEM;
+    }
+
     vlc_mutex_lock( &p_priv->var_lock );
 
-    pp_var = tsearch( p_var, &p_priv->var_root, varcmp );
-    if( unlikely(pp_var == NULL) )
+    p_oldvar = VarInsert( p_priv, p_var );
+    if( unlikely(p_oldvar == NULL) )
         ret = VLC_ENOMEM;
-    else if( (p_oldvar = *pp_var) == p_var ) /* Variable create */
+    else if( p_oldvar == p_var ) /* Variable create */
         p_var = NULL; /* Variable created */
     else /* Variable already exists */
     {
@@ -394,7 +485,7 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
     else if( --p_var->i_usage == 0 )
     {
         assert(!p_var->b_incallback);
-        tdelete( p_var, &p_priv->var_root, varcmp );
+        VarRemove( p_priv, p_var );
     }
     else
     {
@@ -407,17 +498,18 @@ void (var_Destroy)(vlc_object_t *p_this, const char *psz_name)
         Destroy( p_var );
 }
 
-static void CleanupVar( void *var )
-{
-    Destroy( var );
-}
-
 void var_DestroyAll( vlc_object_t *obj )
 {
     vlc_object_internals_t *priv = vlc_internals( obj );
 
-    tdestroy( priv->var_root, CleanupVar );
-    priv->var_root = NULL;
+    for( size_t i = 0; priv->var_table != NULL && i <= priv->var_mask; i++ )
+        if( priv->var_table[i] != NULL )
+            Destroy( priv->var_table[i] );
+
+    free( priv->var_table );
+    priv->var_table = NULL;
+    priv->var_mask = 0;
+    priv->var_count = 0;
 }
 
 int (var_Change)(vlc_object_t *p_this, const char *psz_name, int i_action, ...)
@@ -1137,21 +1229,6 @@ error:
     return VLC_EGENERIC;
 }
 
-static thread_local void *twalk_ctx;
-
-static void TwalkGetNames(const void *data, const VISIT which, const int depth)
-{
-    if (which != postorder && which != leaf)
-        return;
-    (void) depth;
-
-    const variable_t *var = *(const variable_t **)data;
-    DECL_ARRAY(char *) *names = twalk_ctx;
-    char *dup = strdup(var->psz_name);
-    if (dup != NULL)
-        ARRAY_APPEND(*names, dup);
-}
-
 char **var_GetAllNames(vlc_object_t *obj)
 {
     vlc_object_internals_t *priv = vlc_internals(obj);
@@ -1159,9 +1236,17 @@ char **var_GetAllNames(vlc_object_t *obj)
     DECL_ARRAY(char *) names;
     ARRAY_INIT(names);
 
-    twalk_ctx = &names;
     vlc_mutex_lock(&priv->var_lock);
-    twalk(priv->var_root, TwalkGetNames);
+    for (size_t i = 0; priv->var_table != NULL && i <= priv->var_mask; i++)
+    {
+        const variable_t *var = priv->var_table[i];
+        if (var == NULL)
+            continue;
+
+        char *dup = strdup(var->psz_name);
+        if (dup != NULL)
+            ARRAY_APPEND(names, dup);
+    }
     vlc_mutex_unlock(&priv->var_lock);
 
     if (names.i_size == 0)
@@ -38,7 +38,9 @@ struct vlc_object_internals
     const char *typename; /**< Object type human-readable name */
 
     /* Object variables */
-    void           *var_root;
+    struct variable_t **var_table; /**< Open addressing hash table */
+    size_t          var_mask; /**< Table size minus one */
+    size_t          var_count;
     vlc_mutex_t     var_lock;
 
     /* Object resources */
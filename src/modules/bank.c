@@ -107,32 +107,42 @@ vlc_plugin_t *vlc_plugins = NULL;
 static int vlc_module_store(module_t *mod)
 {
     const char *name = module_get_capability(mod);
-    vlc_modcap_t *cap = malloc(sizeof (*cap));
-    if (unlikely(cap == NULL))
-        return -1;
+    vlc_modcap_t key = { .name = (char *)name }, *cap;
 
-    cap->name = strdup(name);
-    cap->modv = NULL;
-    cap->modc = 0;
+    /* Most modules share their capability with already stored ones: only
+     * allocate a new capability entry if it is not found. */
+    void **cp = tfind(&key, &modules.caps_tree, vlc_modcap_cmp);
+    if (cp != NULL)
+        cap = *cp;
+    else
+    {
+        cap = malloc(sizeof (*cap));
+        if (unlikely(cap == NULL))
+            return -1;
 
-    if (unlikely(cap->name == NULL))
-        goto error;
+        cap->name = strdup(name);
+        cap->modv = NULL;
+        cap->modc = 0;
 
-    void **cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
-    if (unlikely(cp == NULL))
-        goto error;
+        if (unlikely(cap->name == NULL))
+            goto error;
 
-    if (*cp != cap)
-    {
-        vlc_modcap_free(cap);
-        cap = *cp;
+        cp = tsearch(cap, &modules.caps_tree, vlc_modcap_cmp);
+        if (unlikely(cp == NULL))
+            goto error;
+        assert(*cp == cap);
     }
 
-    module_t **modv = realloc(cap->modv, sizeof (*modv) * (cap->modc + 1));
-    if (unlikely(modv == NULL))
-        return -1;
+    /* Grow the array geometrically (powers of two) */
+    if ((cap->modc & (cap->modc - 1)) == 0)
+    {
+        size_t size = cap->modc ? 2 * cap->modc : 1;
+        module_t **modv = realloc(cap->modv, sizeof (*modv) * size);
+        if (unlikely(modv == NULL))
+            return -1;
+        cap->modv = modv;
+    }
 
-    cap->modv = modv;
     cap->modv[cap->modc] = mod;
     cap->modc++;
     return 0;
@@ -204,9 +204,8 @@ static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
         for (unsigned i = 0; i < cfg->list_count; i++)
         {
             LOAD_STRING (cfg->list.psz[i]);
-            if (cfg->list.psz[i] == NULL /* NULL -> empty string */
-             && (cfg->list.psz[i] = calloc (1, 1)) == NULL)
-                goto error;
+            if (cfg->list.psz[i] == NULL) /* NULL -> empty string */
+                cfg->list.psz[i] = "";
         }
     }
     else
@@ -228,9 +227,8 @@ static int vlc_cache_load_config(module_config_t *cfg, block_t *file)
     for (unsigned i = 0; i < cfg->list_count; i++)
     {
         LOAD_STRING (cfg->list_text[i]);
-        if (cfg->list_text[i] == NULL /* NULL -> empty string */
-         && (cfg->list_text[i] = calloc (1, 1)) == NULL)
-            goto error;
+        if (cfg->list_text[i] == NULL) /* NULL -> empty string */
+            cfg->list_text[i] = "";
     }
 
     return 0;
@@ -432,7 +430,9 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
         return NULL;
     }
 
-    vlc_plugin_t *cache = NULL;
+    /* Keep the file order, which is the directory scan order, so that
+     * vlc_cache_lookup() normally finds each plugin first in the list. */
+    vlc_plugin_t *cache = NULL, **tailp = &cache;
 
     while (file->i_buffer > 0)
     {
@@ -448,8 +448,8 @@ vlc_plugin_t *vlc_cache_load(vlc_object_t *p_this, const char *dir,
             goto error;
         }
 
-        plugin->next = cache;
-        cache = plugin;
+        *tailp = plugin;
+        tailp = &plugin->next;
     }
 
     file->p_next = *backingp;
@@ -35,6 +35,8 @@
 
 #include <sys/types.h>
 #include <vlc_network.h>
+#include <vlc_list.h>
+#include <vlc_tick.h>
 
 int vlc_getnameinfo( const struct sockaddr *sa, int salen,
                      char *host, int hostlen, int *portnum, int flags )
@@ -119,6 +121,185 @@ int vlc_getaddrinfo (const char *node, unsigned port,
     return getaddrinfo (node, servname, hints, res);
 }
 
+/*
+ * Resolutions are shared by all the accesses of the process: the HTTP
+ * and adaptive streaming accesses connect to the same few hosts over and
+ * over. getaddrinfo() does not expose the DNS records TTL, so the entries
+ * expire after a fixed delay.
+ */
+#define VLC_DNS_CACHE_TTL VLC_TICK_FROM_SEC(60)
+#define VLC_DNS_CACHE_MAX 32
+
+struct vlc_dns_entry
+{
+    struct vlc_list node;
+    struct addrinfo *res;
+    vlc_tick_t expiry;
+    unsigned refs;
+    int preferred; /* family of the last successful connection */
+    unsigned port;
+    int family;
+    int socktype;
+    int protocol;
+    int flags;
+    char name[];
+};
+
+static vlc_mutex_t vlc_dns_lock = VLC_STATIC_MUTEX;
+static struct vlc_list vlc_dns_cache = VLC_LIST_INITIALIZER(&vlc_dns_cache);
+static size_t vlc_dns_count = 0;
+
+static bool vlc_dns_Match(const struct vlc_dns_entry *e, const char *name,
+                          unsigned port, const struct addrinfo *hints)
+{
+    return e->port == port && !strcmp(e->name, name)
+        && e->family == (hints ? hints->ai_family : 0)
+        && e->socktype == (hints ? hints->ai_socktype : 0)
+        && e->protocol == (hints ? hints->ai_protocol : 0)
+        && e->flags == (hints ? hints->ai_flags : 0);
+}
+
+static void vlc_dns_Remove(struct vlc_dns_entry *e)
+{
+    vlc_list_remove(&e->node);
+    vlc_dns_count--;
+    freeaddrinfo(e->res);
+    free(e);
+}
+
+/* Drops the expired entries, and the least recently used ones beyond the
+ * limit, unless they are still in use */
+static void vlc_dns_Prune(vlc_tick_t now)
+{
+    struct vlc_dns_entry *e;
+    size_t kept = 0;
+
+    vlc_list_foreach(e, &vlc_dns_cache, node)
+    {
+        if (e->refs == 0 && (e->expiry <= now || kept >= VLC_DNS_CACHE_MAX))
+            vlc_dns_Remove(e);
+        else
+            kept++;
+    }
+}
+
+static struct vlc_dns_entry *vlc_dns_Find(const struct addrinfo *res)
+{
+    struct vlc_dns_entry *e;
+
+    vlc_list_foreach(e, &vlc_dns_cache, node)
+        if (e->res == res)
+            return e;
+    return NULL;
+}
+
+/**
+ * Resolves a host name through the process-wide cache.
+ *
+ * This is the same as vlc_getaddrinfo_i11e(), except that a recent
+ * resolution of the same name with the same hints is reused.
+ *
+ * @param res pointer set to the resulting chained list, to be released with
+ * vlc_freeaddrinfo_cached() (not freeaddrinfo()), and not to be modified.
+ * @return 0 on success, a getaddrinfo() error otherwise.
+ */
+int vlc_getaddrinfo_cached(const char *name, unsigned port,
+                           const struct addrinfo *hints,
+                           const struct addrinfo **res)
+{
+    struct vlc_dns_entry *e;
+
+    if (name == NULL)
+        name = "";
+
+    vlc_mutex_lock(&vlc_dns_lock);
+    vlc_tick_t now = vlc_tick_now();
+    vlc_list_foreach(e, &vlc_dns_cache, node)
+        if (e->expiry > now && vlc_dns_Match(e, name, port, hints))
+        {
+            /* most recently used first */
+            vlc_list_remove(&e->node);
+            vlc_list_prepend(&e->node, &vlc_dns_cache);
+            e->refs++;
+            *res = e->res;
+            vlc_mutex_unlock(&vlc_dns_lock);
+            return 0;
+        }
+    vlc_mutex_unlock(&vlc_dns_lock);
+
+    size_t namelen = strlen(name) + 1;
+    e = malloc(sizeof (*e) + namelen);
+    if (unlikely(e == NULL))
+        return EAI_MEMORY;
+
+    int val = vlc_getaddrinfo_i11e(*name ? name : NULL, port, hints, &e->res);
+    if (val != 0)
+    {   /* failures are not cached */
+        free(e);
+        return val;
+    }
+
+    e->refs = 1;
+    e->preferred = AF_UNSPEC;
+    e->port = port;
+    e->family = hints ? hints->ai_family : 0;
+    e->socktype = hints ? hints->ai_socktype : 0;
+    e->protocol = hints ? hints->ai_protocol : 0;
+    e->flags = hints ? hints->ai_flags : 0;
+    memcpy(e->name, name, namelen);
+
+    vlc_mutex_lock(&vlc_dns_lock);
+    now = vlc_tick_now();
+    e->expiry = now + VLC_DNS_CACHE_TTL;
+    vlc_list_prepend(&e->node, &vlc_dns_cache);
+    vlc_dns_count++;
+    vlc_dns_Prune(now);
+    vlc_mutex_unlock(&vlc_dns_lock);
+
+    *res = e->res;
+    return 0;
+}
+
+/**
+ * Releases a resolution from vlc_getaddrinfo_cached().
+ */
+void vlc_freeaddrinfo_cached(const struct addrinfo *res)
+{
+    vlc_mutex_lock(&vlc_dns_lock);
+    struct vlc_dns_entry *e = vlc_dns_Find(res);
+    assert(e != NULL && e->refs > 0);
+    e->refs--;
+    vlc_dns_Prune(vlc_tick_now());
+    vlc_mutex_unlock(&vlc_dns_lock);
+}
+
+/**
+ * Gets the address family that connected last to a cached resolution.
+ *
+ * @return AF_UNSPEC if unknown
+ */
+int vlc_dns_GetPreferredFamily(const struct addrinfo *res)
+{
+    vlc_mutex_lock(&vlc_dns_lock);
+    const struct vlc_dns_entry *e = vlc_dns_Find(res);
+    int family = e != NULL ? e->preferred : AF_UNSPEC;
+    vlc_mutex_unlock(&vlc_dns_lock);
+    return family;
+}
+
+/**
+ * Remembers the address family that connected to a cached resolution, so
+ * that the next connections try it first.
+ */
+void vlc_dns_SetPreferredFamily(const struct addrinfo *res, int family)
+{
+    vlc_mutex_lock(&vlc_dns_lock);
+    struct vlc_dns_entry *e = vlc_dns_Find(res);
+    if (e != NULL)
+        e->preferred = family;
+    vlc_mutex_unlock(&vlc_dns_lock);
+}
+
 #if defined (_WIN32) || defined (__OS2__) \
  || defined (__ANDROID__) || defined (__APPLE__) \
  || defined (__native_client__)
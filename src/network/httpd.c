@@ -42,6 +42,7 @@
 #include <vlc_url.h>
 #include <vlc_mime.h>
 #include <vlc_block.h>
+#include <vlc_fs.h>
 #include "../libvlc.h"
 
 #include <string.h>
@@ -54,6 +55,9 @@
 #ifdef HAVE_POLL_H
 # include <poll.h>
 #endif
+#ifdef HAVE_SYS_EVENTFD_H
+# include <sys/eventfd.h>
+#endif
 
 #if defined(_WIN32)
 #   include <winsock2.h>
@@ -68,10 +72,29 @@
 #define HTTPD_CL_BUFSIZE 10000
 #endif
 
+/* Upper bound of I/O threads per host */
+#define HTTPD_WORKERS_MAX 4
+
 static void httpd_ClientDestroy(httpd_client_t *cl);
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data);
+static void httpd_HostWake(httpd_host_t *host);
 
-/* each host run in his own thread */
+/* each I/O thread serves its own share of the clients of a host */
+struct httpd_worker
+{
+    httpd_host_t *host;
+    vlc_thread_t thread;
+    vlc_mutex_t lock;
+
+    size_t client_count;
+    struct vlc_list clients;
+
+    /* wakes the thread up on new clients and new stream data,
+     * or -1 if the thread must poll periodically */
+    int wakefd[2];
+    atomic_bool woken;
+};
+
+/* each host run in its own threads */
 struct httpd_host_t
 {
     struct vlc_object_t obj;
@@ -85,8 +108,7 @@ struct httpd_host_t
     unsigned     nfd;
     unsigned     port;
 
-    vlc_thread_t thread;
-    vlc_mutex_t lock;
+    vlc_mutex_t lock; /* protects the urls */
 
     /* all registered url (becarefull that 2 httpd_url_t could point at the same url)
      * This will slow down the url research but make my live easier
@@ -94,8 +116,9 @@ struct httpd_host_t
      * */
     struct vlc_list urls;
 
-    size_t client_count;
-    struct vlc_list clients;
+    /* the first worker also accepts the connections */
+    struct httpd_worker *workers;
+    unsigned worker_count;
     unsigned timeout_sec;
 
     /* TLS data */
@@ -154,6 +177,9 @@ struct httpd_client_t
     int     i_buffer;
     uint8_t *p_buffer;
 
+    /* shared stream data to send after the buffer */
+    block_t *p_chunks;
+
     /*
      * If waiting for a keyframe, this is the position (in bytes) of the
      * last keyframe the stream saw before this client connected.
@@ -593,6 +619,12 @@ void httpd_RedirectDelete(httpd_redirect_t *rdir)
 /*****************************************************************************
  * High Level Funtions: httpd_stream_t
  *****************************************************************************/
+struct httpd_chunk
+{
+    int64_t  i_pos;   /* absolute position of the data */
+    block_t *p_block; /* shared block */
+};
+
 struct httpd_stream_t
 {
     vlc_mutex_t lock;
@@ -613,8 +645,13 @@ struct httpd_stream_t
     int64_t     i_last_keyframe_seen_pos;
 
     /* circular buffer */
-    int         i_buffer_size;      /* buffer size, can't be reallocated smaller */
-    uint8_t     *p_buffer;          /* buffer */
+    /* shared data chunks, oldest first, in a circular array */
+    int         i_buffer_size;      /* bytes kept for slow clients */
+    struct httpd_chunk *p_chunks;
+    size_t      i_chunks_alloc;     /* power of two */
+    size_t      i_chunks_first;
+    size_t      i_chunks_count;
+    int64_t     i_chunks_bytes;
     int64_t     i_buffer_pos;       /* absolute position from beginning */
     int64_t     i_buffer_last_pos;  /* a new connection will start with that */
 
@@ -623,6 +660,29 @@ struct httpd_stream_t
     httpd_header * p_http_headers;
 };
 
+static struct httpd_chunk *httpd_StreamChunk(httpd_stream_t *stream, size_t i)
+{
+    assert(i < stream->i_chunks_count);
+    return &stream->p_chunks[(stream->i_chunks_first + i)
+                             & (stream->i_chunks_alloc - 1)];
+}
+
+/* Finds the chunk holding the data at an absolute position */
+static size_t httpd_StreamFindChunk(httpd_stream_t *stream, int64_t i_pos)
+{
+    size_t lo = 0, hi = stream->i_chunks_count;
+
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+
+        if (httpd_StreamChunk(stream, mid)->i_pos <= i_pos)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
 static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
                                  httpd_client_t *cl, httpd_message_t *answer,
                                  const httpd_message_t *query)
@@ -633,47 +693,69 @@ static int httpd_StreamCallBack(httpd_callback_sys_t *p_sys,
         return VLC_SUCCESS;
 
     if (answer->i_body_offset > 0) {
-        int     i_pos;
-
+        vlc_mutex_lock(&stream->lock);
         if (answer->i_body_offset >= stream->i_buffer_pos)
-            return VLC_EGENERIC;    /* wait, no data available */
+            goto wait;    /* wait, no data available */
 
         if (cl->i_keyframe_wait_to_pass >= 0) {
             if (stream->i_last_keyframe_seen_pos <= cl->i_keyframe_wait_to_pass)
                 /* still waiting for the next keyframe */
-                return VLC_EGENERIC;
+                goto wait;
 
             /* seek to the new keyframe */
             answer->i_body_offset = stream->i_last_keyframe_seen_pos;
             cl->i_keyframe_wait_to_pass = -1;
         }
 
-        if (answer->i_body_offset + stream->i_buffer_size < stream->i_buffer_pos)
+        if (stream->i_chunks_count == 0
+         || answer->i_body_offset < httpd_StreamChunk(stream, 0)->i_pos)
             answer->i_body_offset = stream->i_buffer_last_pos; /* this client isn't fast enough */
 
-        i_pos   = answer->i_body_offset % stream->i_buffer_size;
         int64_t i_write = stream->i_buffer_pos - answer->i_body_offset;
 
         if (i_write > HTTPD_CL_BUFSIZE)
             i_write = HTTPD_CL_BUFSIZE;
         else if (i_write <= 0)
-            return VLC_EGENERIC;    /* wait, no data available */
+            goto wait;    /* wait, no data available */
+
+        /* Hand references to the chunks to the client, rather than copies */
+        assert(cl->p_chunks == NULL);
+        block_t *p_chunks = NULL, **pp_last = &p_chunks;
+        int64_t i_pos = answer->i_body_offset;
+        int64_t i_end = i_pos + i_write;
 
-        /* Don't go past the end of the circular buffer */
-        i_write = __MIN(i_write, stream->i_buffer_size - i_pos);
+        for (size_t i = httpd_StreamFindChunk(stream, i_pos);
+             i < stream->i_chunks_count && i_pos < i_end; i++) {
+            const struct httpd_chunk *chunk = httpd_StreamChunk(stream, i);
+            block_t *p_view = block_Share(chunk->p_block);
+
+            if (unlikely(p_view == NULL))
+                break;
+
+            size_t i_skip = i_pos - chunk->i_pos;
+            p_view->p_buffer += i_skip;
+            p_view->i_buffer = __MIN(p_view->i_buffer - i_skip,
+                                     (size_t)(i_end - i_pos));
+            i_pos += p_view->i_buffer;
+            block_ChainLastAppend(&pp_last, p_view);
+        }
+        vlc_mutex_unlock(&stream->lock);
+
+        if (p_chunks == NULL)
+            return VLC_EGENERIC;
+        cl->p_chunks = p_chunks;
 
         /* using HTTPD_MSG_ANSWER -> data available */
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
         answer->i_type   = HTTPD_MSG_ANSWER;
 
-        answer->i_body = i_write;
-        answer->p_body = xmalloc(i_write);
-        memcpy(answer->p_body, &stream->p_buffer[i_pos], i_write);
-
-        answer->i_body_offset += i_write;
+        answer->i_body_offset = i_pos;
 
         return VLC_SUCCESS;
+wait:
+        vlc_mutex_unlock(&stream->lock);
+        return VLC_EGENERIC;
     } else {
         answer->i_proto  = HTTPD_PROTO_HTTP;
         answer->i_version= 0;
@@ -757,7 +839,6 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
         return NULL;
 
     stream->psz_mime = NULL;
-    stream->p_buffer = NULL;
 
     stream->url = httpd_UrlNew(host, psz_url, psz_user, psz_password);
     if (!stream->url)
@@ -774,10 +855,11 @@ httpd_stream_t *httpd_StreamNew(httpd_host_t *host,
     stream->i_header = 0;
     stream->p_header = NULL;
     stream->i_buffer_size = 5000000;    /* 5 Mo per stream */
-
-    stream->p_buffer = malloc(stream->i_buffer_size);
-    if (stream->p_buffer == NULL)
-        goto error;
+    stream->p_chunks = NULL;
+    stream->i_chunks_alloc = 0;
+    stream->i_chunks_first = 0;
+    stream->i_chunks_count = 0;
+    stream->i_chunks_bytes = 0;
 
     /* We set to 1 to make life simpler
      * (this way i_body_offset can never be 0) */
@@ -824,22 +906,41 @@ int httpd_StreamHeader(httpd_stream_t *stream, uint8_t *p_data, int i_data)
     return VLC_SUCCESS;
 }
 
-static void httpd_AppendData(httpd_stream_t *stream, uint8_t *p_data, int i_data)
+static int httpd_AppendChunk(httpd_stream_t *stream, block_t *p_block)
 {
-    int i_pos = stream->i_buffer_pos % stream->i_buffer_size;
-    int i_count = i_data;
-    while (i_count > 0) {
-        int i_copy = __MIN(i_count, stream->i_buffer_size - i_pos);
-
-        /* Ok, we can't go past the end of our buffer */
-        memcpy(&stream->p_buffer[i_pos], p_data, i_copy);
-
-        i_pos = (i_pos + i_copy) % stream->i_buffer_size;
-        i_count -= i_copy;
-        p_data  += i_copy;
+    if (stream->i_chunks_count == stream->i_chunks_alloc) {
+        size_t i_alloc = stream->i_chunks_alloc ? stream->i_chunks_alloc * 2
+                                                : 64;
+        struct httpd_chunk *p_chunks = vlc_alloc(i_alloc, sizeof (*p_chunks));
+        if (unlikely(p_chunks == NULL))
+            return VLC_ENOMEM;
+
+        for (size_t i = 0; i < stream->i_chunks_count; i++)
+            p_chunks[i] = *httpd_StreamChunk(stream, i);
+        free(stream->p_chunks);
+        stream->p_chunks = p_chunks;
+        stream->i_chunks_alloc = i_alloc;
+        stream->i_chunks_first = 0;
     }
 
-    stream->i_buffer_pos += i_data;
+    stream->i_chunks_count++;
+    *httpd_StreamChunk(stream, stream->i_chunks_count - 1) =
+        (struct httpd_chunk) { stream->i_buffer_pos, p_block };
+    stream->i_chunks_bytes += p_block->i_buffer;
+    stream->i_buffer_pos += p_block->i_buffer;
+
+    /* Drop the oldest chunks, the clients still own their references */
+    while (stream->i_chunks_count > 1
+        && stream->i_chunks_bytes > stream->i_buffer_size) {
+        struct httpd_chunk *chunk = httpd_StreamChunk(stream, 0);
+
+        stream->i_chunks_bytes -= chunk->p_block->i_buffer;
+        block_Release(chunk->p_block);
+        stream->i_chunks_first = (stream->i_chunks_first + 1)
+                               & (stream->i_chunks_alloc - 1);
+        stream->i_chunks_count--;
+    }
+    return VLC_SUCCESS;
 }
 
 int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
@@ -847,6 +948,16 @@ int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
     if (!p_block || !p_block->p_buffer)
         return VLC_SUCCESS;
 
+    /* Single copy, then shared by all the clients */
+    block_t *p_chunk = NULL;
+    if (p_block->i_buffer > 0) {
+        p_chunk = block_Duplicate(p_block);
+        if (likely(p_chunk != NULL))
+            p_chunk = block_MakeShared(p_chunk);
+        if (unlikely(p_chunk == NULL))
+            return VLC_ENOMEM;
+    }
+
     vlc_mutex_lock(&stream->lock);
 
     /* save this pointer (to be used by new connection) */
@@ -857,9 +968,16 @@ int httpd_StreamSend(httpd_stream_t *stream, const block_t *p_block)
         stream->i_last_keyframe_seen_pos = stream->i_buffer_pos;
     }
 
-    httpd_AppendData(stream, p_block->p_buffer, p_block->i_buffer);
+    if (p_chunk != NULL && httpd_AppendChunk(stream, p_chunk)) {
+        vlc_mutex_unlock(&stream->lock);
+        block_Release(p_chunk);
+        return VLC_ENOMEM;
+    }
 
     vlc_mutex_unlock(&stream->lock);
+
+    /* let the waiting clients send the new data */
+    httpd_HostWake(stream->url->host);
     return VLC_SUCCESS;
 }
 
@@ -873,7 +991,9 @@ void httpd_StreamDelete(httpd_stream_t *stream)
     free(stream->p_http_headers);
     free(stream->psz_mime);
     free(stream->p_header);
-    free(stream->p_buffer);
+    for (size_t i = 0; i < stream->i_chunks_count; i++)
+        block_Release(httpd_StreamChunk(stream, i)->p_block);
+    free(stream->p_chunks);
     free(stream);
 }
 
@@ -927,6 +1047,99 @@ static struct httpd
     struct vlc_list hosts;
 } httpd = { VLC_STATIC_MUTEX, VLC_LIST_INITIALIZER(&httpd.hosts) };
 
+static void httpd_WorkerInit(struct httpd_worker *worker, httpd_host_t *host)
+{
+    worker->host = host;
+    vlc_mutex_init(&worker->lock);
+    worker->client_count = 0;
+    vlc_list_init(&worker->clients);
+    atomic_init(&worker->woken, false);
+    worker->wakefd[0] = worker->wakefd[1] = -1;
+
+#ifndef _WIN32
+# if defined (HAVE_EVENTFD) && defined (EFD_CLOEXEC)
+    worker->wakefd[0] = eventfd(0, EFD_CLOEXEC);
+    if (worker->wakefd[0] != -1)
+        worker->wakefd[1] = worker->wakefd[0];
+    else
+# endif
+    if (vlc_pipe(worker->wakefd))
+        worker->wakefd[0] = worker->wakefd[1] = -1;
+#endif
+}
+
+static void httpd_WorkerClean(struct httpd_worker *worker)
+{
+    httpd_client_t *client;
+
+    vlc_list_foreach(client, &worker->clients, node) {
+        msg_Warn(worker->host, "client still connected");
+        httpd_ClientDestroy(client);
+    }
+
+    if (worker->wakefd[1] != worker->wakefd[0])
+        vlc_close(worker->wakefd[1]);
+    if (worker->wakefd[0] != -1)
+        vlc_close(worker->wakefd[0]);
+}
+
+static void httpd_WorkerWake(struct httpd_worker *worker)
+{
+    /* one pending event is enough */
+    if (worker->wakefd[1] == -1
+     || atomic_exchange(&worker->woken, true))
+        return;
+
+    uint64_t value = 1;
+    int canc = vlc_savecancel();
+    if (write(worker->wakefd[1], &value, sizeof (value)) < 0)
+        atomic_store(&worker->woken, false);
+    vlc_restorecancel(canc);
+}
+
+static void httpd_HostWake(httpd_host_t *host)
+{
+    for (unsigned i = 0; i < host->worker_count; i++)
+        httpd_WorkerWake(&host->workers[i]);
+}
+
+/* hands a new client to the least loaded worker */
+static void httpd_HostAddClient(httpd_host_t *host, httpd_client_t *cl)
+{
+    struct httpd_worker *best = NULL;
+    size_t best_count = SIZE_MAX;
+
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        struct httpd_worker *worker = &host->workers[i];
+
+        vlc_mutex_lock(&worker->lock);
+        size_t count = worker->client_count;
+        vlc_mutex_unlock(&worker->lock);
+
+        if (count < best_count) {
+            best = worker;
+            best_count = count;
+        }
+    }
+
+    vlc_mutex_lock(&best->lock);
+    best->client_count++;
+    vlc_list_append(&cl->node, &best->clients);
+    vlc_mutex_unlock(&best->lock);
+    httpd_WorkerWake(best);
+}
+
+static void httpd_HostStopWorkers(httpd_host_t *host, unsigned running)
+{
+    for (unsigned i = 0; i < running; i++)
+        vlc_cancel(host->workers[i].thread);
+    for (unsigned i = 0; i < running; i++)
+        vlc_join(host->workers[i].thread, NULL);
+    for (unsigned i = 0; i < host->worker_count; i++)
+        httpd_WorkerClean(&host->workers[i]);
+    free(host->workers);
+}
+
 static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
                                        const char *hostvar,
                                        const char *portvar,
@@ -976,17 +1189,30 @@ static httpd_host_t *httpd_HostCreate(vlc_object_t *p_this,
 
     host->port     = port;
     vlc_list_init(&host->urls);
-    host->client_count = 0;
-    vlc_list_init(&host->clients);
     host->timeout_sec = timeout_sec;
     host->p_tls    = p_tls;
 
-    /* create the thread */
-    if (vlc_clone(&host->thread, httpd_HostThread, host,
-                   VLC_THREAD_PRIORITY_LOW)) {
-        msg_Err(p_this, "cannot spawn http host thread");
+#ifdef _WIN32
+    /* The sockets cannot be polled along with a wake up event */
+    host->worker_count = 1;
+#else
+    host->worker_count = VLC_CLIP(vlc_GetCPUCount(), 1, HTTPD_WORKERS_MAX);
+#endif
+    host->workers = vlc_alloc(host->worker_count, sizeof (*host->workers));
+    if (unlikely(host->workers == NULL))
         goto error;
-    }
+
+    for (unsigned i = 0; i < host->worker_count; i++)
+        httpd_WorkerInit(&host->workers[i], host);
+
+    /* create the threads */
+    for (unsigned i = 0; i < host->worker_count; i++)
+        if (vlc_clone(&host->workers[i].thread, httpd_HostThread,
+                      &host->workers[i], VLC_THREAD_PRIORITY_LOW)) {
+            msg_Err(p_this, "cannot spawn http host thread");
+            httpd_HostStopWorkers(host, i);
+            goto error;
+        }
 
     /* now add it to httpd */
     vlc_list_append(&host->node, &httpd.hosts);
@@ -1009,8 +1235,6 @@ error:
 /* delete a host */
 void httpd_HostDelete(httpd_host_t *host)
 {
-    httpd_client_t *client;
-
     vlc_mutex_lock(&httpd.mutex);
 
     if (atomic_fetch_sub_explicit(&host->ref, 1, memory_order_relaxed) > 1) {
@@ -1021,16 +1245,10 @@ void httpd_HostDelete(httpd_host_t *host)
     }
 
     vlc_list_remove(&host->node);
-    vlc_cancel(host->thread);
-    vlc_join(host->thread, NULL);
+    httpd_HostStopWorkers(host, host->worker_count);
 
     msg_Dbg(host, "HTTP host removed");
 
-    vlc_list_foreach(client, &host->clients, node) {
-        msg_Warn(host, "client still connected");
-        httpd_ClientDestroy(client);
-    }
-
     assert(vlc_list_is_empty(&host->urls));
     vlc_tls_ServerDelete(host->p_tls);
     net_ListenClose(host->fds);
@@ -1118,22 +1336,29 @@ void httpd_UrlDelete(httpd_url_t *url)
 
     vlc_mutex_lock(&host->lock);
     vlc_list_remove(&url->node);
+    vlc_mutex_unlock(&host->lock);
 
     free(url->psz_url);
     free(url->psz_user);
     free(url->psz_password);
 
-    vlc_list_foreach(client, &host->clients, node) {
-        if (client->url != url)
-            continue;
+    /* Not under the host lock: the workers take it while holding theirs */
+    for (unsigned i = 0; i < host->worker_count; i++) {
+        struct httpd_worker *worker = &host->workers[i];
 
-        /* TODO complete it */
-        msg_Warn(host, "force closing connections");
-        host->client_count--;
-        httpd_ClientDestroy(client);
+        vlc_mutex_lock(&worker->lock);
+        vlc_list_foreach(client, &worker->clients, node) {
+            if (client->url != url)
+                continue;
+
+            /* TODO complete it */
+            msg_Warn(host, "force closing connections");
+            worker->client_count--;
+            httpd_ClientDestroy(client);
+        }
+        vlc_mutex_unlock(&worker->lock);
     }
     free(url);
-    vlc_mutex_unlock(&host->lock);
 }
 
 static void httpd_MsgInit(httpd_message_t *msg)
@@ -1219,6 +1444,7 @@ static void httpd_ClientDestroy(httpd_client_t *cl)
 {
     vlc_list_remove(&cl->node);
     vlc_tls_Close(cl->sock);
+    block_ChainRelease(cl->p_chunks);
     httpd_MsgClean(&cl->answer);
     httpd_MsgClean(&cl->query);
 
@@ -1238,6 +1464,7 @@ static httpd_client_t *httpd_ClientNew(vlc_tls_t *sock)
     cl->i_buffer_size = HTTPD_CL_BUFSIZE;
     cl->i_buffer = 0;
     cl->p_buffer = xmalloc(cl->i_buffer_size);
+    cl->p_chunks = NULL;
     cl->i_keyframe_wait_to_pass = -1;
     cl->b_stream_mode = false;
 
@@ -1262,6 +1489,36 @@ ssize_t httpd_NetSend (httpd_client_t *cl, const uint8_t *p, size_t i_len)
     return sock->ops->writev(sock, &iov, 1);
 }
 
+static
+ssize_t httpd_NetSendChunks (httpd_client_t *cl)
+{
+    vlc_tls_t *sock = cl->sock;
+    struct iovec iov[16];
+    unsigned count = 0;
+
+    for (const block_t *b = cl->p_chunks; b != NULL && count < ARRAY_SIZE(iov);
+         b = b->p_next)
+        iov[count++] = (struct iovec) {
+            .iov_base = b->p_buffer, .iov_len = b->i_buffer };
+
+    ssize_t val = sock->ops->writev(sock, iov, count);
+
+    /* Release what was sent */
+    for (size_t len = (val > 0) ? val : 0; len > 0;) {
+        block_t *b = cl->p_chunks;
+
+        if (len < b->i_buffer) {
+            b->p_buffer += len;
+            b->i_buffer -= len;
+            break;
+        }
+        len -= b->i_buffer;
+        cl->p_chunks = b->p_next;
+        block_Release(b);
+    }
+    return val;
+}
+
 
 static const struct
 {
@@ -1605,8 +1862,11 @@ static int httpd_ClientSend(httpd_client_t *cl)
         cl->i_buffer_size = (uint8_t*)p - cl->p_buffer;
     }
 
-    i_len = httpd_NetSend(cl, &cl->p_buffer[cl->i_buffer],
-                           cl->i_buffer_size - cl->i_buffer);
+    if (cl->i_buffer < cl->i_buffer_size || cl->p_chunks == NULL)
+        i_len = httpd_NetSend(cl, &cl->p_buffer[cl->i_buffer],
+                               cl->i_buffer_size - cl->i_buffer);
+    else
+        i_len = httpd_NetSendChunks(cl);
 
     if (i_len < 0) {
 #if defined(_WIN32)
@@ -1621,9 +1881,10 @@ static int httpd_ClientSend(httpd_client_t *cl)
         return 0;
     }
 
-    cl->i_buffer += i_len;
+    if (cl->i_buffer < cl->i_buffer_size)
+        cl->i_buffer += i_len;
 
-    if (cl->i_buffer >= cl->i_buffer_size) {
+    if (cl->i_buffer >= cl->i_buffer_size && cl->p_chunks == NULL) {
         if (cl->answer.i_body == 0  && cl->answer.i_body_offset > 0) {
             /* catch more body data */
             int     i_msg = cl->query.i_type;
@@ -1645,7 +1906,7 @@ static int httpd_ClientSend(httpd_client_t *cl)
 
             cl->answer.i_body = 0;
             cl->answer.p_body = NULL;
-        } else /* send finished */
+        } else if (cl->p_chunks == NULL) /* send finished */
             cl->i_state = HTTPD_CLIENT_SEND_DONE;
     }
     return 0;
@@ -1702,24 +1963,36 @@ auth_failed:
     return false;
 }
 
-static void httpdLoop(httpd_host_t *host)
+static void httpdLoop(struct httpd_worker *worker)
 {
-    struct pollfd ufd[host->nfd + host->client_count];
+    httpd_host_t *host = worker->host;
+    const unsigned nlisten = (worker == host->workers) ? host->nfd : 0;
+    const bool wakeable = worker->wakefd[0] != -1;
+
+    vlc_mutex_lock(&worker->lock);
+
+    struct pollfd ufd[nlisten + 1 + worker->client_count];
     unsigned nfd;
-    for (nfd = 0; nfd < host->nfd; nfd++) {
+    for (nfd = 0; nfd < nlisten; nfd++) {
         ufd[nfd].fd = host->fds[nfd];
         ufd[nfd].events = POLLIN;
         ufd[nfd].revents = 0;
     }
+    if (wakeable) {
+        ufd[nfd].fd = worker->wakefd[0];
+        ufd[nfd].events = POLLIN;
+        ufd[nfd].revents = 0;
+        nfd++;
+    }
 
-    vlc_mutex_lock(&host->lock);
     /* add all socket that should be read/write and close dead connection */
     vlc_tick_t now = vlc_tick_now();
+    vlc_tick_t deadline = INT64_MAX;
     int delay = -1;
     httpd_client_t *cl;
 
     int canc = vlc_savecancel();
-    vlc_list_foreach(cl, &host->clients, node) {
+    vlc_list_foreach(cl, &worker->clients, node) {
         int val = -1;
 
         switch (cl->i_state) {
@@ -1737,7 +2010,7 @@ static void httpdLoop(httpd_host_t *host)
 
         if (cl->i_state == HTTPD_CLIENT_DEAD
          || (host->timeout_sec > 0 && cl->i_timeout_date < now)) {
-            host->client_count--;
+            worker->client_count--;
             httpd_ClientDestroy(cl);
             continue;
         }
@@ -1746,6 +2019,8 @@ static void httpdLoop(httpd_host_t *host)
             cl->i_timeout_date = now + VLC_TICK_FROM_SEC(host->timeout_sec);
             delay = 0;
         }
+        if (host->timeout_sec > 0 && cl->i_timeout_date < deadline)
+            deadline = cl->i_timeout_date;
 
         struct pollfd *pufd = ufd + nfd;
         assert (pufd < ufd + ARRAY_SIZE (ufd));
@@ -1849,6 +2124,7 @@ static void httpdLoop(httpd_host_t *host)
                         bool b_auth_failed = false;
 
                         /* Search the url and trigger callbacks */
+                        vlc_mutex_lock(&host->lock);
                         vlc_list_foreach(url, &host->urls, node) {
                             if (strcmp(url->psz_url, query->psz_url))
                                 continue;
@@ -1876,6 +2152,7 @@ static void httpdLoop(httpd_host_t *host)
                             if (!cl->url)
                                 cl->url = url;
                         }
+                        vlc_mutex_unlock(&host->lock);
 
                         if (answer) {
                             answer->i_proto  = query->i_proto;
@@ -1976,13 +2253,21 @@ static void httpdLoop(httpd_host_t *host)
 
         if (pufd->events != 0)
             nfd++;
-        /* we will wait 20ms (not too big) if HTTPD_CLIENT_WAITING */
-        else if (delay != 0)
+        /* HTTPD_CLIENT_WAITING: the streams wake us up on new data,
+         * otherwise we will wait 20ms (not too big) */
+        else if (delay != 0 && !wakeable)
             delay = 20;
     }
-    vlc_mutex_unlock(&host->lock);
+    vlc_mutex_unlock(&worker->lock);
     vlc_restorecancel(canc);
 
+    /* wake up for the earliest client timeout */
+    if (delay != 0 && deadline != INT64_MAX) {
+        int timeout = MS_FROM_VLC_TICK(deadline - now) + 1;
+        if (delay < 0 || timeout < delay)
+            delay = timeout;
+    }
+
     while (poll(ufd, nfd, delay) < 0)
     {
         if (errno != EINTR)
@@ -1990,14 +2275,18 @@ static void httpdLoop(httpd_host_t *host)
     }
 
     canc = vlc_savecancel();
-    vlc_mutex_lock(&host->lock);
 
-    /* Handle client sockets */
+    if (wakeable && ufd[nlisten].revents) {
+        uint64_t dummy;
+
+        if (read(worker->wakefd[0], &dummy, sizeof (dummy)) > 0)
+            atomic_store(&worker->woken, false);
+    }
+
     now = vlc_tick_now();
-    nfd = host->nfd;
 
     /* Handle server sockets (accept new connections) */
-    for (nfd = 0; nfd < host->nfd; nfd++) {
+    for (nfd = 0; nfd < nlisten; nfd++) {
         int fd = ufd[nfd].fd;
 
         assert (fd == host->fds[nfd]);
@@ -2045,20 +2334,19 @@ static void httpdLoop(httpd_host_t *host)
             cl->i_state = HTTPD_CLIENT_TLS_HS_OUT;
 
         cl->i_timeout_date = now + VLC_TICK_FROM_SEC(host->timeout_sec);
-        host->client_count++;
-        vlc_list_append(&cl->node, &host->clients);
+        httpd_HostAddClient(host, cl);
     }
 
-    vlc_mutex_unlock(&host->lock);
     vlc_restorecancel(canc);
 }
 
 static void* httpd_HostThread(void *data)
 {
-    httpd_host_t *host = data;
+    struct httpd_worker *worker = data;
+    httpd_host_t *host = worker->host;
 
     while (atomic_load_explicit(&host->ref, memory_order_relaxed) > 0)
-        httpdLoop(host);
+        httpdLoop(worker);
     return NULL;
 }
 
@@ -116,6 +116,167 @@ int net_Socket (vlc_object_t *p_this, int family, int socktype,
     return fd;
 }
 
+/* Delay before the next address joins the race (RFC 8305 section 5) */
+#define CONNECTION_ATTEMPT_DELAY VLC_TICK_FROM_MS(250)
+#define CONNECTION_ATTEMPT_MAX 16
+
+/**
+ * Connects a stream socket to the first responsive address.
+ *
+ * This implements the "happy eyeballs" algorithm of RFC 8305: the addresses
+ * of both families are interleaved, and a new connection attempt starts
+ * every 250 ms (or as soon as the previous one fails) while the pending
+ * ones carry on. The first connected socket wins, and its address family
+ * goes first the next time the same resolution is used.
+ *
+ * @param timeout time limit for each attempt
+ * @param winner set to the address of the connected socket (if not NULL)
+ * @return a connected socket, or -1 on error
+ */
+int net_ConnectRace(vlc_object_t *obj, const struct addrinfo *res,
+                    vlc_tick_t timeout, const struct addrinfo **winner)
+{
+    const struct addrinfo *order[CONNECTION_ATTEMPT_MAX];
+    const struct addrinfo *first[CONNECTION_ATTEMPT_MAX];
+    const struct addrinfo *other[CONNECTION_ATTEMPT_MAX];
+    const struct addrinfo *pending_ai[CONNECTION_ATTEMPT_MAX];
+    const struct addrinfo *won = NULL;
+    struct pollfd ufd[CONNECTION_ATTEMPT_MAX];
+    unsigned count = 0, nfirst = 0, nother = 0, next = 0, pending = 0;
+    int ret = -1;
+
+    /* Alternate the address families, starting with the one that connected
+     * last time, or else with the preferred one of the resolver */
+    int family = vlc_dns_GetPreferredFamily(res);
+    if (family == AF_UNSPEC)
+        family = res->ai_family;
+
+    for (const struct addrinfo *p = res; p != NULL; p = p->ai_next)
+    {
+        if (p->ai_family == family)
+        {
+            if (nfirst < CONNECTION_ATTEMPT_MAX)
+                first[nfirst++] = p;
+        }
+        else if (nother < CONNECTION_ATTEMPT_MAX)
+            other[nother++] = p;
+    }
+
+    for (unsigned i = 0; i < nfirst || i < nother; i++)
+    {
+        if (i < nfirst && count < CONNECTION_ATTEMPT_MAX)
+            order[count++] = first[i];
+        if (i < nother && count < CONNECTION_ATTEMPT_MAX)
+            order[count++] = other[i];
+    }
+
+    vlc_tick_t attempt = vlc_tick_now(), deadline = attempt;
+
+    while (next < count || pending > 0)
+    {
+        vlc_tick_t now = vlc_tick_now();
+
+        if (vlc_killed())
+            break;
+
+        /* Start the next attempt when due, or if nothing else is pending */
+        if (next < count && (pending == 0 || now >= attempt))
+        {
+            const struct addrinfo *ptr = order[next++];
+            int fd = net_Socket(obj, ptr->ai_family, ptr->ai_socktype,
+                                ptr->ai_protocol);
+            if (fd == -1)
+            {
+                msg_Dbg(obj, "socket error: %s", vlc_strerror_c(net_errno));
+                continue;
+            }
+
+            if (connect(fd, ptr->ai_addr, ptr->ai_addrlen) == 0)
+            {
+                ret = fd;
+                won = ptr;
+                break;
+            }
+            if (net_errno != EINPROGRESS && errno != EINTR)
+            {
+                msg_Err(obj, "connection failed: %s",
+                        vlc_strerror_c(net_errno));
+                net_Close(fd);
+                continue;
+            }
+
+            ufd[pending].fd = fd;
+            ufd[pending].events = POLLOUT;
+            pending_ai[pending++] = ptr;
+            attempt = now + CONNECTION_ATTEMPT_DELAY;
+            deadline = now + timeout;
+        }
+
+        vlc_tick_t wake = deadline;
+        if (next < count && attempt < wake)
+            wake = attempt;
+        if (wake < now)
+            wake = now;
+
+        int val = vlc_poll_i11e(ufd, pending, MS_FROM_VLC_TICK(wake - now));
+        if (val == -1 && errno != EINTR)
+        {
+            msg_Err(obj, "polling error: %s", vlc_strerror_c(net_errno));
+            break;
+        }
+
+        if (val <= 0)
+        {
+            if (vlc_tick_now() >= deadline && next >= count)
+            {
+                msg_Warn(obj, "connection timed out");
+                break;
+            }
+            continue;
+        }
+
+        for (unsigned i = 0; i < pending;)
+        {
+            if (ufd[i].revents == 0)
+            {
+                i++;
+                continue;
+            }
+
+            /* There is NO WAY around checking SO_ERROR.
+             * Don't ifdef it out!!! */
+            if (getsockopt(ufd[i].fd, SOL_SOCKET, SO_ERROR, &val,
+                           &(socklen_t){ sizeof (val) }) == 0 && val == 0)
+            {
+                ret = ufd[i].fd;
+                won = pending_ai[i];
+                ufd[i] = ufd[--pending];
+                goto out;
+            }
+
+            msg_Err(obj, "connection failed: %s", vlc_strerror_c(val));
+            net_Close(ufd[i].fd);
+            ufd[i] = ufd[--pending];
+            pending_ai[i] = pending_ai[pending];
+            /* the next address need not wait */
+            attempt = vlc_tick_now();
+        }
+    }
+out:
+    /* The losers are simply dropped */
+    for (unsigned i = 0; i < pending; i++)
+        net_Close(ufd[i].fd);
+
+    if (ret != -1)
+    {
+        msg_Dbg(obj, "connection succeeded (socket = %d)", ret);
+        vlc_dns_SetPreferredFamily(res, won->ai_family);
+        if (winner != NULL)
+            *winner = won;
+    }
+    return ret;
+}
+
 int (net_Connect)(vlc_object_t *obj, const char *host, int serv,
                   int type, int proto)
 {
@@ -123,10 +284,11 @@ int (net_Connect)(vlc_object_t *obj, const char *host, int serv,
         .ai_socktype = type,
         .ai_protocol = proto,
         .ai_flags = AI_NUMERICSERV | AI_IDN,
-    }, *res;
+    };
+    const struct addrinfo *res;
     int ret = -1;
 
-    int val = vlc_getaddrinfo_i11e(host, serv, &hints, &res);
+    int val = vlc_getaddrinfo_cached(host, serv, &hints, &res);
     if (val)
     {
         msg_Err(obj, "cannot resolve %s port %d : %s", host, serv,
@@ -137,7 +299,14 @@ int (net_Connect)(vlc_object_t *obj, const char *host, int serv,
     vlc_tick_t timeout = VLC_TICK_FROM_MS(var_InheritInteger(obj,
                                                              "ipv4-timeout"));
 
-    for (struct addrinfo *ptr = res; ptr != NULL; ptr = ptr->ai_next)
+    if (type == SOCK_STREAM)
+    {
+        ret = net_ConnectRace(obj, res, timeout, NULL);
+        vlc_freeaddrinfo_cached(res);
+        return ret;
+    }
+
+    for (const struct addrinfo *ptr = res; ptr != NULL; ptr = ptr->ai_next)
     {
         int fd = net_Socket(obj, ptr->ai_family,
                             ptr->ai_socktype, ptr->ai_protocol);
@@ -207,7 +376,7 @@ next_ai: /* failure */
         net_Close(fd);
     }
 
-    freeaddrinfo(res);
+    vlc_freeaddrinfo_cached(res);
     return ret;
 }
 
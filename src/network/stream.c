@@ -179,6 +179,14 @@ static int vlc_tls_SocketGetFD(vlc_tls_t *tls, short *restrict events)
     return sock->fd;
 }
 
+static int vlc_tls_SocketGetRawFD(vlc_tls_t *tls, bool write)
+{
+    vlc_tls_socket_t *sock = (struct vlc_tls_socket *)tls;
+
+    (void) write;
+    return sock->fd;
+}
+
 static ssize_t vlc_tls_SocketRead(vlc_tls_t *tls, struct iovec *iov,
                                   unsigned count)
 {
@@ -227,6 +235,7 @@ static const struct vlc_tls_operations vlc_tls_socket_ops =
     vlc_tls_SocketWrite,
     vlc_tls_SocketShutdown,
     vlc_tls_SocketClose,
+    vlc_tls_SocketGetRawFD,
 };
 
 static vlc_tls_t *vlc_tls_SocketAlloc(int fd,
@@ -428,42 +437,168 @@ vlc_tls_t *vlc_tls_SocketOpenAddrInfo(const struct addrinfo *restrict info,
     return sock;
 }
 
-vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj, const char *name,
-                                 unsigned port)
+static int vlc_tls_SocketConnectTCP(vlc_object_t *obj, const char *name,
+                                    unsigned port,
+                                    struct sockaddr_storage *restrict peer,
+                                    socklen_t *restrict peerlen)
 {
     struct addrinfo hints =
     {
         .ai_socktype = SOCK_STREAM,
         .ai_protocol = IPPROTO_TCP,
-    }, *res;
+    };
+    const struct addrinfo *res, *p;
 
     assert(name != NULL);
     msg_Dbg(obj, "resolving %s ...", name);
 
-    int val = vlc_getaddrinfo_i11e(name, port, &hints, &res);
+    int val = vlc_getaddrinfo_cached(name, port, &hints, &res);
     if (val != 0)
     {   /* TODO: C locale for gai_strerror() */
         msg_Err(obj, "cannot resolve %s port %u: %s", name, port,
                 gai_strerror(val));
-        return NULL;
+        return -1;
     }
 
     msg_Dbg(obj, "connecting to %s port %u ...", name, port);
 
-    /* TODO: implement RFC8305 */
-    for (const struct addrinfo *p = res; p != NULL; p = p->ai_next)
+    /* obj may be NULL (from the HTTP tunnel) */
+    vlc_tick_t timeout = VLC_TICK_FROM_MS(obj != NULL
+                               ? var_InheritInteger(obj, "ipv4-timeout")
+                               : 5000);
+    int fd = net_ConnectRace(obj, res, timeout, &p);
+    if (fd != -1)
     {
-        vlc_tls_t *tls = vlc_tls_SocketOpenAddrInfo(p, false);
-        if (tls == NULL)
+        setsockopt(fd, SOL_TCP, TCP_NODELAY, &(int){ 1 }, sizeof (int));
+        *peerlen = __MIN(p->ai_addrlen, sizeof (*peer));
+        memcpy(peer, p->ai_addr, *peerlen);
+    }
+    vlc_freeaddrinfo_cached(res);
+    return fd;
+}
+
+/*
+ * Connections opened ahead of time by vlc_tls_SocketPreconnect()
+ */
+#define VLC_TLS_SPARE_MAX 8
+#define VLC_TLS_SPARE_TTL VLC_TICK_FROM_SEC(10)
+
+struct vlc_tls_spare
+{
+    char *name; /* NULL if the slot is free */
+    unsigned port;
+    int fd;
+    vlc_tick_t expiry;
+    socklen_t peerlen;
+    struct sockaddr_storage peer;
+};
+
+static vlc_mutex_t vlc_tls_spare_lock = VLC_STATIC_MUTEX;
+static struct vlc_tls_spare vlc_tls_spares[VLC_TLS_SPARE_MAX];
+
+static void vlc_tls_SpareClear(struct vlc_tls_spare *spare)
+{
+    net_Close(spare->fd);
+    free(spare->name);
+    spare->name = NULL;
+}
+
+static int vlc_tls_SpareTake(const char *name, unsigned port,
+                             struct sockaddr_storage *restrict peer,
+                             socklen_t *restrict peerlen)
+{
+    vlc_tick_t now = vlc_tick_now();
+    int fd = -1;
+
+    vlc_mutex_lock(&vlc_tls_spare_lock);
+    for (size_t i = 0; i < VLC_TLS_SPARE_MAX; i++)
+    {
+        struct vlc_tls_spare *spare = &vlc_tls_spares[i];
+
+        if (spare->name == NULL)
+            continue;
+        if (spare->expiry <= now)
         {
-            msg_Err(obj, "connection error: %s", vlc_strerror_c(errno));
+            vlc_tls_SpareClear(spare);
+            continue;
+        }
+        if (fd != -1 || spare->port != port || strcmp(spare->name, name))
+            continue;
+
+        /* The server may have closed the idle connection meanwhile */
+        struct pollfd ufd = { .fd = spare->fd, .events = POLLIN };
+        if (poll(&ufd, 1, 0) != 0)
+        {
+            vlc_tls_SpareClear(spare);
             continue;
         }
 
-        freeaddrinfo(res);
-        return tls;
+        fd = spare->fd;
+        *peerlen = spare->peerlen;
+        memcpy(peer, &spare->peer, spare->peerlen);
+        free(spare->name);
+        spare->name = NULL;
     }
+    vlc_mutex_unlock(&vlc_tls_spare_lock);
+    return fd;
+}
 
-    freeaddrinfo(res);
-    return NULL;
+int vlc_tls_SocketPreconnect(vlc_object_t *obj, const char *name,
+                             unsigned port)
+{
+    struct sockaddr_storage peer;
+    socklen_t peerlen;
+
+    char *dup = strdup(name);
+    if (unlikely(dup == NULL))
+        return -1;
+
+    int fd = vlc_tls_SocketConnectTCP(obj, name, port, &peer, &peerlen);
+    if (fd == -1)
+    {
+        free(dup);
+        return -1;
+    }
+
+    vlc_mutex_lock(&vlc_tls_spare_lock);
+    /* Use a free slot, or else replace the oldest connection */
+    struct vlc_tls_spare *spare = &vlc_tls_spares[0];
+    for (size_t i = 0; i < VLC_TLS_SPARE_MAX && spare->name != NULL; i++)
+        if (vlc_tls_spares[i].name == NULL
+         || vlc_tls_spares[i].expiry < spare->expiry)
+            spare = &vlc_tls_spares[i];
+    if (spare->name != NULL)
+        vlc_tls_SpareClear(spare);
+
+    spare->name = dup;
+    spare->port = port;
+    spare->fd = fd;
+    spare->expiry = vlc_tick_now() + VLC_TLS_SPARE_TTL;
+    spare->peerlen = peerlen;
+    memcpy(&spare->peer, &peer, peerlen);
+    vlc_mutex_unlock(&vlc_tls_spare_lock);
+    return 0;
+}
+
+vlc_tls_t *vlc_tls_SocketOpenTCP(vlc_object_t *obj, const char *name,
+                                 unsigned port)
+{
+    struct sockaddr_storage peer;
+    socklen_t peerlen;
+
+    int fd = vlc_tls_SpareTake(name, port, &peer, &peerlen);
+    if (fd != -1)
+        msg_Dbg(obj, "reusing a connection to %s port %u", name, port);
+    else
+    {
+        fd = vlc_tls_SocketConnectTCP(obj, name, port, &peer, &peerlen);
+        if (fd == -1)
+            return NULL;
+    }
+
+    vlc_tls_t *tls = vlc_tls_SocketAlloc(fd, (struct sockaddr *)&peer,
+                                         peerlen);
+    if (unlikely(tls == NULL))
+        net_Close(fd);
+    return tls;
 }
@@ -143,14 +143,25 @@ vlc_player_input_HandleState(struct vlc_player_input *input,
     switch (input->state)
     {
         case VLC_PLAYER_STATE_STOPPED:
+        {
             assert(!input->started);
             assert(input != player->input);
 
+            /* The next input can already be playing (gapless) */
+            const bool next_started = player->input && player->input->started;
+
             if (input->titles)
             {
                 vlc_player_title_list_Release(input->titles);
                 input->titles = NULL;
-                vlc_player_SendEvent(player, on_titles_changed, NULL);
+                if (!next_started)
+                    vlc_player_SendEvent(player, on_titles_changed, NULL);
+            }
+
+            if (next_started)
+            {
+                send_event = false;
+                break;
             }
 
             vlc_player_ResetTimer(player);
@@ -185,6 +196,7 @@ vlc_player_input_HandleState(struct vlc_player_input *input,
 
             send_event = !player->started;
             break;
+        }
         case VLC_PLAYER_STATE_STOPPING:
             input->started = false;
 
@@ -231,6 +243,7 @@ vlc_player_input_HandleState(struct vlc_player_input *input,
     if (send_event)
     {
         player->global_state = input->state;
+        vlc_player_UpdateStatusState(player, player->global_state);
         vlc_player_SendEvent(player, on_state_changed, player->global_state);
     }
 }
@@ -254,10 +267,17 @@ vlc_player_input_HandleStateEvent(struct vlc_player_input *input,
                                          state_date);
             break;
         case END_S:
+        {
+            /* Not stopped by the player: the media reached its end */
+            const bool ended = input->started;
+
             vlc_player_input_HandleState(input, VLC_PLAYER_STATE_STOPPING,
                                          VLC_TICK_INVALID);
             vlc_player_destructor_AddStoppingInput(input->player, input);
+            if (ended)
+                vlc_player_StartNextMediaEarly(input->player, input);
             break;
+        }
         case ERROR_S:
             /* Don't send errors if the input is stopped by the user */
             if (input->started)
@@ -815,6 +835,7 @@ input_thread_Events(input_thread_t *input_thread,
             break;
         case INPUT_EVENT_STATISTICS:
             input->stats = *event->stats;
+            vlc_player_UpdateStatusStats(player, &input->stats);
             vlc_player_SendEvent(player, on_statistics_changed, &input->stats);
             break;
         case INPUT_EVENT_SIGNAL:
@@ -825,6 +846,7 @@ input_thread_Events(input_thread_t *input_thread,
             break;
         case INPUT_EVENT_CACHE:
             input->cache = event->cache;
+            vlc_player_UpdateStatusBuffering(player, event->cache);
             vlc_player_SendEvent(player, on_buffering_changed, event->cache);
             break;
         case INPUT_EVENT_VOUT:
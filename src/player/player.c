@@ -116,6 +116,28 @@ vlc_player_OpenNextMedia(vlc_player_t *player)
     return ret;
 }
 
+void
+vlc_player_StartNextMediaEarly(vlc_player_t *player,
+                               struct vlc_player_input *ended_input)
+{
+    vlc_player_assert_locked(player);
+
+    /* Don't wait for the ended input to be closed and joined by the
+     * destructor thread: open the next one right away */
+    if (!player->gapless || !player->started || player->deleting
+     || player->input != NULL || player->next_media == NULL
+     || player->releasing_media
+     || ended_input->error != VLC_PLAYER_ERROR_NONE)
+        return;
+
+    if (player->media_stopped_action != VLC_PLAYER_MEDIA_STOPPED_CONTINUE
+     && player->media_stopped_action != VLC_PLAYER_MEDIA_STOPPED_EXIT)
+        return;
+
+    if (vlc_player_OpenNextMedia(player) == VLC_SUCCESS && player->input)
+        vlc_player_input_Start(player->input);
+}
+
 static void
 vlc_player_CancelWaitError(vlc_player_t *player)
 {
@@ -996,6 +1018,31 @@ vlc_player_RemoveListener(vlc_player_t *player,
     free(id);
 }
 
+static int
+vlc_player_StartCurrentMediaEarly(vlc_player_t *player)
+{
+    /* Move the previous input to the STOPPING state now, while the new
+     * media is still pending, so that no next media gets prepared */
+    struct vlc_player_input *input;
+    vlc_list_foreach(input, &player->destructor.inputs, node)
+        vlc_player_input_HandleState(input, VLC_PLAYER_STATE_STOPPING,
+                                     VLC_TICK_INVALID);
+
+    /* Don't wait for the previous input to be closed and joined by the
+     * destructor thread: open the new one right away */
+    int ret = vlc_player_OpenNextMedia(player);
+    if (ret != VLC_SUCCESS || player->input == NULL)
+        return ret;
+
+    ret = vlc_player_input_Start(player->input);
+    if (ret != VLC_SUCCESS)
+    {
+        vlc_player_destructor_AddInput(player, player->input);
+        player->input = NULL;
+    }
+    return ret;
+}
+
 int
 vlc_player_SetCurrentMedia(vlc_player_t *player, input_item_t *media)
 {
@@ -1031,6 +1078,9 @@ vlc_player_SetCurrentMedia(vlc_player_t *player, input_item_t *media)
     assert(media == player->next_media);
     if (!vlc_player_destructor_IsEmpty(player))
     {
+        if (media != NULL && player->fast_zapping && player->started)
+            return vlc_player_StartCurrentMediaEarly(player);
+
         /* This media will be opened when the input is finally stopped */
         return VLC_SUCCESS;
     }
@@ -1219,6 +1269,20 @@ vlc_player_SetStartPaused(vlc_player_t *player, bool start_paused)
     player->start_paused = start_paused;
 }
 
+void
+vlc_player_SetGapless(vlc_player_t *player, bool enabled)
+{
+    vlc_player_assert_locked(player);
+    player->gapless = enabled;
+}
+
+void
+vlc_player_SetFastZapping(vlc_player_t *player, bool enabled)
+{
+    vlc_player_assert_locked(player);
+    player->fast_zapping = enabled;
+}
+
 static void
 vlc_player_SetPause(vlc_player_t *player, bool pause)
 {
@@ -1942,6 +2006,8 @@ vlc_player_New(vlc_object_t *parent, enum vlc_player_lock_type lock_type,
     player->start_paused = false;
     player->pause_on_cork = false;
     player->corked = false;
+    player->gapless = false;
+    player->fast_zapping = false;
     player->renderer = NULL;
     player->media_provider = media_provider;
     player->media_provider_data = media_provider_data;
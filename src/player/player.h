@@ -175,6 +175,7 @@ struct vlc_player_timer_id
     {
         const struct vlc_player_timer_cbs *cbs;
         const struct vlc_player_timer_smpte_cbs *smpte_cbs;
+        const struct vlc_player_status_cbs *status_cbs;
     };
     void *data;
 
@@ -222,6 +223,9 @@ struct vlc_player_timer
     struct vlc_player_timer_source sources[VLC_PLAYER_TIMER_TYPE_COUNT];
 #define best_source sources[VLC_PLAYER_TIMER_TYPE_BEST]
 #define smpte_source sources[VLC_PLAYER_TIMER_TYPE_SMPTE]
+
+    struct vlc_list status_listeners; /* list of struct vlc_player_timer_id */
+    struct vlc_player_status status;
 };
 
 struct vlc_player_t
@@ -241,6 +245,8 @@ struct vlc_player_t
 
     bool pause_on_cork;
     bool corked;
+    bool gapless;
+    bool fast_zapping;
 
     struct vlc_list listeners;
     struct vlc_list metadata_listeners;
@@ -338,6 +344,10 @@ vlc_player_OpenNextMedia(vlc_player_t *player);
 void
 vlc_player_PrepareNextMedia(vlc_player_t *player);
 
+void
+vlc_player_StartNextMediaEarly(vlc_player_t *player,
+                               struct vlc_player_input *ended_input);
+
 void
 vlc_player_destructor_AddStoppingInput(vlc_player_t *player,
                                        struct vlc_player_input *input);
@@ -470,6 +480,16 @@ vlc_player_UpdateTimer(vlc_player_t *player, vlc_es_id_t *es_source,
 void
 vlc_player_RemoveTimerSource(vlc_player_t *player, vlc_es_id_t *es_source);
 
+void
+vlc_player_UpdateStatusState(vlc_player_t *player, enum vlc_player_state state);
+
+void
+vlc_player_UpdateStatusBuffering(vlc_player_t *player, float buffering);
+
+void
+vlc_player_UpdateStatusStats(vlc_player_t *player,
+                             const struct input_stats_t *stats);
+
 int
 vlc_player_GetTimerPoint(vlc_player_t *player, vlc_tick_t system_now,
                          vlc_tick_t *out_ts, float *out_pos);
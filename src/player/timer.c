@@ -38,6 +38,64 @@ vlc_player_ResetTimer(vlc_player_t *player)
     player->timer.input_position = 0.f;
     player->timer.smpte_source.smpte.last_framenum = ULONG_MAX;
 
+    player->timer.status.point.system_date = VLC_TICK_INVALID;
+    player->timer.status.buffering = 0.f;
+    player->timer.status.has_stats = false;
+
+    vlc_mutex_unlock(&player->timer.lock);
+}
+
+static void
+vlc_player_SendStatusUpdates(vlc_player_t *player, bool force_update)
+{
+    vlc_mutex_assert(&player->timer.lock);
+
+    if (vlc_list_is_empty(&player->timer.status_listeners))
+        return;
+
+    vlc_tick_t now = vlc_tick_now();
+    vlc_player_timer_id *timer;
+
+    vlc_list_foreach(timer, &player->timer.status_listeners, node)
+    {
+        /* Merge the updates received during the refresh delay of the timer */
+        if (force_update || timer->period == VLC_TICK_INVALID
+         || timer->last_update_date == VLC_TICK_INVALID
+         || now - timer->last_update_date >= timer->period)
+        {
+            timer->status_cbs->on_update(&player->timer.status, timer->data);
+            timer->last_update_date = now;
+        }
+    }
+}
+
+void
+vlc_player_UpdateStatusState(vlc_player_t *player, enum vlc_player_state state)
+{
+    vlc_mutex_lock(&player->timer.lock);
+    player->timer.status.state = state;
+    vlc_player_SendStatusUpdates(player, true);
+    vlc_mutex_unlock(&player->timer.lock);
+}
+
+void
+vlc_player_UpdateStatusBuffering(vlc_player_t *player, float buffering)
+{
+    vlc_mutex_lock(&player->timer.lock);
+    player->timer.status.buffering = buffering;
+    /* Always notify the end of the buffering */
+    vlc_player_SendStatusUpdates(player, buffering >= 1.f);
+    vlc_mutex_unlock(&player->timer.lock);
+}
+
+void
+vlc_player_UpdateStatusStats(vlc_player_t *player,
+                             const struct input_stats_t *stats)
+{
+    vlc_mutex_lock(&player->timer.lock);
+    player->timer.status.stats = *stats;
+    player->timer.status.has_stats = true;
+    vlc_player_SendStatusUpdates(player, false);
     vlc_mutex_unlock(&player->timer.lock);
 }
 
@@ -341,6 +399,9 @@ vlc_player_UpdateTimer(vlc_player_t *player, vlc_es_id_t *es_source,
             if (!vlc_list_is_empty(&source->listeners))
                 vlc_player_SendTimerSourceUpdates(player, source, force_update,
                                                   &source->point);
+
+            player->timer.status.point = source->point;
+            vlc_player_SendStatusUpdates(player, force_update);
         }
     }
 
@@ -457,6 +518,37 @@ vlc_player_AddSmpteTimer(vlc_player_t *player,
     return timer;
 }
 
+vlc_player_timer_id *
+vlc_player_AddStatusTimer(vlc_player_t *player, vlc_tick_t min_period,
+                          const struct vlc_player_status_cbs *cbs,
+                          void *data)
+{
+    assert(min_period >= VLC_TICK_0 || min_period == VLC_TICK_INVALID);
+    assert(cbs && cbs->on_update);
+
+    struct vlc_player_timer_id *timer = malloc(sizeof(*timer));
+    if (!timer)
+        return NULL;
+    timer->period = min_period;
+    timer->last_update_date = VLC_TICK_INVALID;
+    timer->status_cbs = cbs;
+    timer->data = data;
+
+    vlc_mutex_lock(&player->timer.lock);
+    vlc_list_append(&timer->node, &player->timer.status_listeners);
+    vlc_mutex_unlock(&player->timer.lock);
+
+    return timer;
+}
+
+void
+vlc_player_GetStatus(vlc_player_t *player, struct vlc_player_status *status)
+{
+    vlc_mutex_lock(&player->timer.lock);
+    *status = player->timer.status;
+    vlc_mutex_unlock(&player->timer.lock);
+}
+
 void
 vlc_player_RemoveTimer(vlc_player_t *player, vlc_player_timer_id *timer)
 {
@@ -538,6 +630,8 @@ vlc_player_InitTimer(vlc_player_t *player)
         player->timer.sources[i].point.system_date = VLC_TICK_INVALID;
         player->timer.sources[i].es = NULL;
     }
+    vlc_list_init(&player->timer.status_listeners);
+    player->timer.status.state = VLC_PLAYER_STATE_STOPPED;
     vlc_player_ResetTimer(player);
 }
 
@@ -546,4 +640,5 @@ vlc_player_DestroyTimer(vlc_player_t *player)
 {
     for (size_t i = 0; i < VLC_PLAYER_TIMER_TYPE_COUNT; ++i)
         assert(vlc_list_is_empty(&player->timer.sources[i].listeners));
+    assert(vlc_list_is_empty(&player->timer.status_listeners));
 }
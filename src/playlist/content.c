@@ -37,6 +37,36 @@ vlc_playlist_ClearItems(vlc_playlist_t *playlist)
     vlc_vector_foreach(item, &playlist->items)
         vlc_playlist_item_Release(item);
     vlc_vector_clear(&playlist->items);
+    vlc_playlist_index_Clear(&playlist->index);
+}
+
+static void
+vlc_playlist_IndexAdd(vlc_playlist_t *playlist, size_t index, size_t count)
+{
+    for (size_t i = index; i < index + count; ++i)
+        vlc_playlist_index_Add(&playlist->index, playlist->items.data[i]);
+    vlc_playlist_index_Invalidate(&playlist->index, index);
+}
+
+static ssize_t
+vlc_playlist_IndexOfItem(vlc_playlist_t *playlist,
+                         const vlc_playlist_item_t *item)
+{
+    struct vlc_playlist_index *index = &playlist->index;
+    playlist_item_vector_t *items = &playlist->items;
+
+    if (item->index < index->valid && items->data[item->index] == item)
+        return item->index;
+
+    /* refresh the cached positions, up to the requested item */
+    while (index->valid < items->size)
+    {
+        vlc_playlist_item_t *cur = items->data[index->valid];
+        cur->index = index->valid++;
+        if (cur == item)
+            return cur->index;
+    }
+    return -1;
 }
 
 static void
@@ -76,11 +106,7 @@ vlc_playlist_ItemsInserted(vlc_playlist_t *playlist, size_t index, size_t count)
     vlc_playlist_Notify(playlist, on_items_added, index, items, count);
     vlc_playlist_state_NotifyChanges(playlist, &state);
 
-    for (size_t i = index; i < index + count; ++i)
-    {
-        vlc_playlist_item_t *item = playlist->items.data[i];
-        vlc_playlist_AutoPreparse(playlist, item->media);
-    }
+    vlc_playlist_AutoPreparseItems(playlist, items, count);
 }
 
 static void
@@ -175,7 +201,7 @@ vlc_playlist_ItemReplaced(vlc_playlist_t *playlist, size_t index)
                         &playlist->items.data[index], 1);
     vlc_playlist_state_NotifyChanges(playlist, &state);
 
-    vlc_playlist_AutoPreparse(playlist, playlist->items.data[index]->media);
+    vlc_playlist_AutoPreparseItems(playlist, &playlist->items.data[index], 1);
 }
 
 size_t
@@ -197,9 +223,7 @@ vlc_playlist_IndexOf(vlc_playlist_t *playlist, const vlc_playlist_item_t *item)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    ssize_t index;
-    vlc_vector_index_of(&playlist->items, item, &index);
-    return index;
+    return vlc_playlist_IndexOfItem(playlist, item);
 }
 
 ssize_t
@@ -207,11 +231,18 @@ vlc_playlist_IndexOfMedia(vlc_playlist_t *playlist, const input_item_t *media)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->media == media)
-            return i;
-    return -1;
+    /* the same media may be inserted several times, return the first one */
+    ssize_t ret = -1;
+    size_t cursor = 0;
+    vlc_playlist_item_t *item;
+    while ((item = vlc_playlist_index_FindMedia(&playlist->index, media,
+                                                &cursor)) != NULL)
+    {
+        ssize_t index = vlc_playlist_IndexOfItem(playlist, item);
+        if (ret == -1 || index < ret)
+            ret = index;
+    }
+    return ret;
 }
 
 ssize_t
@@ -219,11 +250,8 @@ vlc_playlist_IndexOfId(vlc_playlist_t *playlist, uint64_t id)
 {
     vlc_playlist_AssertLocked(playlist);
 
-    playlist_item_vector_t *items = &playlist->items;
-    for (size_t i = 0; i < items->size; ++i)
-        if (items->data[i]->id == id)
-            return i;
-    return -1;
+    vlc_playlist_item_t *item = vlc_playlist_index_FindId(&playlist->index, id);
+    return item ? vlc_playlist_IndexOfItem(playlist, item) : -1;
 }
 
 void
@@ -268,6 +296,10 @@ vlc_playlist_Insert(vlc_playlist_t *playlist, size_t index,
     vlc_playlist_AssertLocked(playlist);
     assert(index <= playlist->items.size);
 
+    if (!vlc_playlist_index_Reserve(&playlist->index,
+                                    playlist->items.size + count))
+        return VLC_ENOMEM;
+
     /* make space in the vector */
     if (!vlc_vector_insert_hole(&playlist->items, index, count))
         return VLC_ENOMEM;
@@ -282,6 +314,7 @@ vlc_playlist_Insert(vlc_playlist_t *playlist, size_t index,
         return ret;
     }
 
+    vlc_playlist_IndexAdd(playlist, index, count);
     vlc_playlist_ItemsInserted(playlist, index, count);
     vlc_player_InvalidateNextMedia(playlist->player);
 
@@ -297,6 +330,8 @@ vlc_playlist_Move(vlc_playlist_t *playlist, size_t index, size_t count,
     assert(target + count <= playlist->items.size);
 
     vlc_vector_move_slice(&playlist->items, index, count, target);
+    vlc_playlist_index_Invalidate(&playlist->index, index < target ? index
+                                                                   : target);
 
     vlc_playlist_ItemsMoved(playlist, index, count, target);
     vlc_player_InvalidateNextMedia(playlist->player);
@@ -311,9 +346,14 @@ vlc_playlist_Remove(vlc_playlist_t *playlist, size_t index, size_t count)
     vlc_playlist_ItemsRemoving(playlist, index, count);
 
     for (size_t i = 0; i < count; ++i)
-        vlc_playlist_item_Release(playlist->items.data[index + i]);
+    {
+        vlc_playlist_item_t *item = playlist->items.data[index + i];
+        vlc_playlist_index_Remove(&playlist->index, item);
+        vlc_playlist_item_Release(item);
+    }
 
     vlc_vector_remove_slice(&playlist->items, index, count);
+    vlc_playlist_index_Invalidate(&playlist->index, index);
 
     bool current_media_changed = vlc_playlist_ItemsRemoved(playlist, index,
                                                            count);
@@ -342,6 +382,11 @@ vlc_playlist_Replace(vlc_playlist_t *playlist, size_t index,
         randomizer_Add(&playlist->randomizer, &item, 1);
     }
 
+    /* the item count does not change, the index has room for the new one */
+    vlc_playlist_index_Remove(&playlist->index, playlist->items.data[index]);
+    vlc_playlist_index_Add(&playlist->index, item);
+    item->index = index;
+
     vlc_playlist_item_Release(playlist->items.data[index]);
     playlist->items.data[index] = item;
 
@@ -360,6 +405,10 @@ vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
         vlc_playlist_RemoveOne(playlist, index);
     else
     {
+        if (!vlc_playlist_index_Reserve(&playlist->index,
+                                        playlist->items.size + count - 1))
+            return VLC_ENOMEM;
+
         int ret = vlc_playlist_Replace(playlist, index, media[0]);
         if (ret != VLC_SUCCESS)
             return ret;
@@ -379,6 +428,7 @@ vlc_playlist_Expand(vlc_playlist_t *playlist, size_t index,
                 vlc_vector_remove_slice(&playlist->items, index + 1, count - 1);
                 return ret;
             }
+            vlc_playlist_IndexAdd(playlist, index + 1, count - 1);
             vlc_playlist_ItemsInserted(playlist, index + 1, count - 1);
         }
 
@@ -0,0 +1,230 @@
+/*****************************************************************************
+ * playlist/index.c
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <assert.h>
+#include <vlc_common.h>
+#include "index.h"
+#include "item.h"
+
+#define TABLE_MIN_SIZE 16
+
+static inline size_t
+HashKey(uint64_t key)
+{
+    key *= UINT64_C(0x9E3779B97F4A7C15);
+    return key ^ (key >> 32);
+}
+
+static inline uint64_t
+TableKey(const struct vlc_playlist_item_table *table,
+         const vlc_playlist_item_t *item)
+{
+    return table->by_media ? (uintptr_t) item->media : item->id;
+}
+
+static inline size_t
+TableHome(const struct vlc_playlist_item_table *table,
+          const vlc_playlist_item_t *item)
+{
+    return HashKey(TableKey(table, item)) & table->mask;
+}
+
+static void
+TableInit(struct vlc_playlist_item_table *table, bool by_media)
+{
+    table->slots = NULL;
+    table->mask = 0;
+    table->count = 0;
+    table->by_media = by_media;
+}
+
+static void
+TableClear(struct vlc_playlist_item_table *table)
+{
+    free(table->slots);
+    table->slots = NULL;
+    table->mask = 0;
+    table->count = 0;
+}
+
+static void
+TableInsert(struct vlc_playlist_item_table *table, vlc_playlist_item_t *item)
+{
+    assert(table->count < table->mask);
+
+    size_t i = TableHome(table, item);
+    while (table->slots[i] != NULL)
+        i = (i + 1) & table->mask;
+    table->slots[i] = item;
+    table->count++;
+}
+
+static bool
+TableReserve(struct vlc_playlist_item_table *table, size_t count)
+{
+    size_t size = table->mask + 1;
+    /* keep the load factor below 3/4 */
+    if (table->slots != NULL && count * 4 < size * 3)
+        return true;
+
+    size = TABLE_MIN_SIZE;
+    while (count * 4 >= size * 3)
+    {
+        if (unlikely(size > SIZE_MAX / 2 / sizeof(*table->slots)))
+            return false;
+        size *= 2;
+    }
+
+    vlc_playlist_item_t **old_slots = table->slots;
+    size_t old_size = table->mask + 1;
+
+    table->slots = calloc(size, sizeof(*table->slots));
+    if (unlikely(!table->slots))
+    {
+        table->slots = old_slots;
+        return false;
+    }
+    table->mask = size - 1;
+    table->count = 0;
+
+    if (old_slots != NULL)
+    {
+        for (size_t i = 0; i < old_size; ++i)
+            if (old_slots[i] != NULL)
+                TableInsert(table, old_slots[i]);
+        free(old_slots);
+    }
+    return true;
+}
+
+static void
+TableRemove(struct vlc_playlist_item_table *table, vlc_playlist_item_t *item)
+{
+    size_t i = TableHome(table, item);
+    while (table->slots[i] != item)
+    {
+        assert(table->slots[i] != NULL);
+        i = (i + 1) & table->mask;
+    }
+
+    /* backward shift deletion, to keep the probe sequences intact */
+    size_t j = i;
+    for (;;)
+    {
+        j = (j + 1) & table->mask;
+        if (table->slots[j] == NULL)
+            break;
+
+        size_t home = TableHome(table, table->slots[j]);
+        /* move the entry if its home is not cyclically in ]i, j] */
+        bool in_range = i <= j ? (i < home && home <= j)
+                               : (i < home || home <= j);
+        if (!in_range)
+        {
+            table->slots[i] = table->slots[j];
+            i = j;
+        }
+    }
+    table->slots[i] = NULL;
+    table->count--;
+}
+
+void
+vlc_playlist_index_Init(struct vlc_playlist_index *index)
+{
+    TableInit(&index->ids, false);
+    TableInit(&index->medias, true);
+    index->valid = 0;
+}
+
+void
+vlc_playlist_index_Destroy(struct vlc_playlist_index *index)
+{
+    vlc_playlist_index_Clear(index);
+}
+
+void
+vlc_playlist_index_Clear(struct vlc_playlist_index *index)
+{
+    TableClear(&index->ids);
+    TableClear(&index->medias);
+    index->valid = 0;
+}
+
+bool
+vlc_playlist_index_Reserve(struct vlc_playlist_index *index, size_t count)
+{
+    return TableReserve(&index->ids, count)
+        && TableReserve(&index->medias, count);
+}
+
+void
+vlc_playlist_index_Add(struct vlc_playlist_index *index,
+                       vlc_playlist_item_t *item)
+{
+    TableInsert(&index->ids, item);
+    TableInsert(&index->medias, item);
+}
+
+void
+vlc_playlist_index_Remove(struct vlc_playlist_index *index,
+                          vlc_playlist_item_t *item)
+{
+    TableRemove(&index->ids, item);
+    TableRemove(&index->medias, item);
+}
+
+vlc_playlist_item_t *
+vlc_playlist_index_FindId(const struct vlc_playlist_index *index, uint64_t id)
+{
+    const struct vlc_playlist_item_table *table = &index->ids;
+    if (table->slots == NULL)
+        return NULL;
+
+    for (size_t i = HashKey(id) & table->mask; table->slots[i] != NULL;
+         i = (i + 1) & table->mask)
+        if (table->slots[i]->id == id)
+            return table->slots[i];
+    return NULL;
+}
+
+vlc_playlist_item_t *
+vlc_playlist_index_FindMedia(const struct vlc_playlist_index *index,
+                             const input_item_t *media, size_t *cursor)
+{
+    const struct vlc_playlist_item_table *table = &index->medias;
+    if (table->slots == NULL)
+        return NULL;
+
+    /* the cursor is the number of slots already probed */
+    size_t home = HashKey((uintptr_t) media) & table->mask;
+    for (size_t i = (home + *cursor) & table->mask; table->slots[i] != NULL;
+         i = (i + 1) & table->mask)
+    {
+        ++*cursor;
+        if (table->slots[i]->media == media)
+            return table->slots[i];
+    }
+    return NULL;
+}
@@ -0,0 +1,94 @@
+/*****************************************************************************
+ * playlist/index.h
+ *****************************************************************************
+ * Copyright (C) 2018 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_PLAYLIST_INDEX_H
+#define VLC_PLAYLIST_INDEX_H
+
+#include <vlc_common.h>
+
+typedef struct vlc_playlist_item vlc_playlist_item_t;
+typedef struct input_item_t input_item_t;
+
+/* Open addressing hash table of playlist items */
+struct vlc_playlist_item_table
+{
+    vlc_playlist_item_t **slots;
+    size_t mask; /* size - 1, the size is a power of 2 */
+    size_t count;
+    bool by_media; /* key on the media instead of the id */
+};
+
+/**
+ * Lookup structures of the playlist items
+ *
+ * The items are hashed by id and by media. Their position in the playlist
+ * is cached in the item itself, and refreshed lazily: only the items before
+ * "valid" are known to be at their cached position.
+ */
+struct vlc_playlist_index
+{
+    struct vlc_playlist_item_table ids;
+    struct vlc_playlist_item_table medias;
+    size_t valid;
+};
+
+void
+vlc_playlist_index_Init(struct vlc_playlist_index *index);
+
+void
+vlc_playlist_index_Destroy(struct vlc_playlist_index *index);
+
+void
+vlc_playlist_index_Clear(struct vlc_playlist_index *index);
+
+/* Make room for count items, so that Add() cannot fail */
+bool
+vlc_playlist_index_Reserve(struct vlc_playlist_index *index, size_t count);
+
+void
+vlc_playlist_index_Add(struct vlc_playlist_index *index,
+                       vlc_playlist_item_t *item);
+
+void
+vlc_playlist_index_Remove(struct vlc_playlist_index *index,
+                          vlc_playlist_item_t *item);
+
+vlc_playlist_item_t *
+vlc_playlist_index_FindId(const struct vlc_playlist_index *index, uint64_t id);
+
+/**
+ * Iterate over the items of a media (a media may be inserted several times)
+ *
+ * \param cursor must be initialized to 0 before the first call
+ * \return the next item of this media, or NULL
+ */
+vlc_playlist_item_t *
+vlc_playlist_index_FindMedia(const struct vlc_playlist_index *index,
+                             const input_item_t *media, size_t *cursor);
+
+/* Invalidate the cached positions from the given position */
+static inline void
+vlc_playlist_index_Invalidate(struct vlc_playlist_index *index, size_t from)
+{
+    if (from < index->valid)
+        index->valid = from;
+}
+
+#endif
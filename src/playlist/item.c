@@ -36,6 +36,8 @@ vlc_playlist_item_New(input_item_t *media, uint64_t id)
 
     vlc_atomic_rc_init(&item->rc);
     item->id = id;
+    item->index = 0;
+    item->preparse_requested = false;
     item->media = media;
     input_item_Hold(media);
     return item;
@@ -30,6 +30,8 @@ struct vlc_playlist_item
 {
     input_item_t *media;
     uint64_t id;
+    size_t index; /* cached position, see struct vlc_playlist_index */
+    bool preparse_requested; /* protected by the playlist lock */
     vlc_atomic_rc_t rc;
 };
 
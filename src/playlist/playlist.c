@@ -29,6 +29,7 @@
 #include "content.h"
 #include "item.h"
 #include "player.h"
+#include "preparse.h"
 
 vlc_playlist_t *
 vlc_playlist_New(vlc_object_t *parent)
@@ -45,6 +46,7 @@ vlc_playlist_New(vlc_object_t *parent)
     }
 
     vlc_vector_init(&playlist->items);
+    vlc_playlist_index_Init(&playlist->index);
     randomizer_Init(&playlist->randomizer);
     playlist->current = -1;
     playlist->has_prev = false;
@@ -53,6 +55,7 @@ vlc_playlist_New(vlc_object_t *parent)
     playlist->repeat = VLC_PLAYLIST_PLAYBACK_REPEAT_NONE;
     playlist->order = VLC_PLAYLIST_PLAYBACK_ORDER_NORMAL;
     playlist->idgen = 0;
+    vlc_vector_init(&playlist->expansions);
 #ifdef TEST_PLAYLIST
     playlist->libvlc = NULL;
     playlist->auto_preparse = false;
@@ -71,8 +74,10 @@ vlc_playlist_Delete(vlc_playlist_t *playlist)
     assert(vlc_list_is_empty(&playlist->listeners));
 
     vlc_playlist_PlayerDestroy(playlist);
+    vlc_playlist_ClearExpansions(playlist);
     randomizer_Destroy(&playlist->randomizer);
     vlc_playlist_ClearItems(playlist);
+    vlc_playlist_index_Destroy(&playlist->index);
     free(playlist);
 }
 
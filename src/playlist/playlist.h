@@ -25,6 +25,7 @@
 #include <vlc_playlist.h>
 #include <vlc_vector.h>
 #include "../player/player.h"
+#include "index.h"
 #include "randomizer.h"
 
 typedef struct input_item_t input_item_t;
@@ -45,6 +46,16 @@ typedef struct input_item_t input_item_t;
 
 typedef struct VLC_VECTOR(vlc_playlist_item_t *) playlist_item_vector_t;
 
+/* A media expanded from subitems posted in several batches */
+struct vlc_playlist_expansion
+{
+    input_item_t *media; /* the expanded media, not in the playlist anymore */
+    vlc_playlist_item_t *last; /* the last item inserted from its subitems */
+};
+
+typedef struct VLC_VECTOR(struct vlc_playlist_expansion)
+    playlist_expansion_vector_t;
+
 struct vlc_playlist
 {
     vlc_player_t *player;
@@ -53,6 +64,7 @@ struct vlc_playlist
     /* all remaining fields are protected by the lock of the player */
     struct vlc_player_listener_id *player_listener;
     playlist_item_vector_t items;
+    struct vlc_playlist_index index;
     struct randomizer randomizer;
     ssize_t current;
     bool has_prev;
@@ -61,6 +73,7 @@ struct vlc_playlist
     enum vlc_playlist_playback_repeat repeat;
     enum vlc_playlist_playback_order order;
     uint64_t idgen;
+    playlist_expansion_vector_t expansions; /**< the most recent ones */
 };
 
 /* Also disable vlc_assert_locked in tests since the symbol is not exported */
@@ -62,18 +62,113 @@ vlc_playlist_ExpandItem(vlc_playlist_t *playlist, size_t index,
     return ret;
 }
 
+/* Keep track of the last expansions only: the subitems of a media are
+ * posted while it is being parsed */
+#define VLC_PLAYLIST_EXPANSIONS_MAX 8
+
+static void
+vlc_playlist_ExpansionRemove(vlc_playlist_t *playlist, size_t i)
+{
+    struct vlc_playlist_expansion *exp = &playlist->expansions.data[i];
+    input_item_Release(exp->media);
+    vlc_playlist_item_Release(exp->last);
+    vlc_vector_remove(&playlist->expansions, i);
+}
+
+static ssize_t
+vlc_playlist_ExpansionFind(vlc_playlist_t *playlist, input_item_t *media)
+{
+    for (size_t i = 0; i < playlist->expansions.size; ++i)
+        if (playlist->expansions.data[i].media == media)
+            return i;
+    return -1;
+}
+
+static void
+vlc_playlist_ExpansionSet(vlc_playlist_t *playlist, input_item_t *media,
+                          vlc_playlist_item_t *last)
+{
+    ssize_t i = vlc_playlist_ExpansionFind(playlist, media);
+    if (i != -1)
+    {
+        struct vlc_playlist_expansion *exp = &playlist->expansions.data[i];
+        vlc_playlist_item_Hold(last);
+        vlc_playlist_item_Release(exp->last);
+        exp->last = last;
+        return;
+    }
+
+    if (playlist->expansions.size == VLC_PLAYLIST_EXPANSIONS_MAX)
+        vlc_playlist_ExpansionRemove(playlist, 0);
+
+    struct vlc_playlist_expansion exp = { media, last };
+    if (vlc_vector_push(&playlist->expansions, exp))
+    {
+        input_item_Hold(media);
+        vlc_playlist_item_Hold(last);
+    }
+}
+
+static void
+vlc_playlist_ExpansionEnd(vlc_playlist_t *playlist, input_item_t *media)
+{
+    ssize_t i = vlc_playlist_ExpansionFind(playlist, media);
+    if (i != -1)
+        vlc_playlist_ExpansionRemove(playlist, i);
+}
+
+void
+vlc_playlist_ClearExpansions(vlc_playlist_t *playlist)
+{
+    while (playlist->expansions.size > 0)
+        vlc_playlist_ExpansionRemove(playlist, playlist->expansions.size - 1);
+    vlc_vector_destroy(&playlist->expansions);
+}
+
 int
 vlc_playlist_ExpandItemFromNode(vlc_playlist_t *playlist,
                                 input_item_node_t *subitems)
 {
     vlc_playlist_AssertLocked(playlist);
     input_item_t *media = subitems->p_item;
+
+    media_vector_t flatten = VLC_VECTOR_INITIALIZER;
+    vlc_playlist_CollectChildren(playlist, &flatten, subitems);
+
+    int ret;
+    size_t last;
     ssize_t index = vlc_playlist_IndexOfMedia(playlist, media);
-    if (index == -1)
-        return VLC_ENOITEM;
+    if (index != -1)
+    {
+        /* replace the item by its flatten subtree */
+        ret = vlc_playlist_Expand(playlist, index, flatten.data, flatten.size);
+        last = index + flatten.size - 1;
+    }
+    else
+    {
+        /* the next batch of subitems of an expanded media, insert them after
+         * the previous ones */
+        ssize_t exp = vlc_playlist_ExpansionFind(playlist, media);
+        if (exp != -1)
+            index = vlc_playlist_IndexOf(playlist,
+                                         playlist->expansions.data[exp].last);
+        if (index == -1)
+        {
+            /* unknown media, or its subitems were removed meanwhile */
+            vlc_vector_destroy(&flatten);
+            return VLC_ENOITEM;
+        }
 
-    /* replace the item by its flatten subtree */
-    return vlc_playlist_ExpandItem(playlist, index, subitems);
+        ret = vlc_playlist_Insert(playlist, index + 1, flatten.data,
+                                  flatten.size);
+        last = index + flatten.size;
+    }
+
+    if (ret == VLC_SUCCESS && flatten.size > 0)
+        vlc_playlist_ExpansionSet(playlist, media, playlist->items.data[last]);
+
+    vlc_vector_destroy(&flatten);
+    return ret;
 }
 
 static void
@@ -95,10 +190,16 @@ on_preparse_ended(input_item_t *media,
     VLC_UNUSED(media); /* retrieved by subtree->p_item */
     vlc_playlist_t *playlist = userdata;
 
+    vlc_playlist_Lock(playlist);
+    /* no more subitems will be posted */
+    vlc_playlist_ExpansionEnd(playlist, media);
+
     if (status != ITEM_PREPARSE_DONE)
+    {
+        vlc_playlist_Unlock(playlist);
         return;
+    }
 
-    vlc_playlist_Lock(playlist);
     ssize_t index = vlc_playlist_IndexOfMedia(playlist, media);
     if (index != -1)
         vlc_playlist_Notify(playlist, on_items_updated, index,
@@ -127,9 +228,40 @@ vlc_playlist_Preparse(vlc_playlist_t *playlist, input_item_t *input)
 #endif
 }
 
+static void
+vlc_playlist_AutoPreparse(vlc_playlist_t *playlist, vlc_playlist_item_t *item)
+{
+    vlc_playlist_AssertLocked(playlist);
+
+    if (!playlist->auto_preparse || item->preparse_requested)
+        return;
+
+    item->preparse_requested = true;
+    if (!input_item_IsPreparsed(item->media))
+        vlc_playlist_Preparse(playlist, item->media);
+}
+
 void
-vlc_playlist_AutoPreparse(vlc_playlist_t *playlist, input_item_t *input)
+vlc_playlist_AutoPreparseItems(vlc_playlist_t *playlist,
+                               vlc_playlist_item_t *const items[],
+                               size_t count)
 {
-    if (playlist->auto_preparse && !input_item_IsPreparsed(input))
-        vlc_playlist_Preparse(playlist, input);
+    /* Requesting every item of a large playlist would flood the preparser
+     * and delay the items the user is looking at */
+    if (count > VLC_PLAYLIST_AUTO_PREPARSE_MAX)
+        return;
+
+    for (size_t i = 0; i < count; ++i)
+        vlc_playlist_AutoPreparse(playlist, items[i]);
+}
+
+void
+vlc_playlist_PreparseItems(vlc_playlist_t *playlist, size_t index,
+                           size_t count)
+{
+    vlc_playlist_AssertLocked(playlist);
+    assert(index + count <= playlist->items.size);
+
+    for (size_t i = index; i < index + count; ++i)
+        vlc_playlist_AutoPreparse(playlist, playlist->items.data[i]);
 }
@@ -26,8 +26,16 @@
 typedef struct vlc_playlist vlc_playlist_t;
 typedef struct input_item_node_t input_item_node_t;
 
+typedef struct vlc_playlist_item vlc_playlist_item_t;
+
+/* Above this number of items, an insertion is not preparsed automatically:
+ * the views request the items they display with vlc_playlist_PreparseItems() */
+#define VLC_PLAYLIST_AUTO_PREPARSE_MAX 128
+
 void
-vlc_playlist_AutoPreparse(vlc_playlist_t *playlist, input_item_t *input);
+vlc_playlist_AutoPreparseItems(vlc_playlist_t *playlist,
+                               vlc_playlist_item_t *const items[],
+                               size_t count);
 
 int
 vlc_playlist_ExpandItem(vlc_playlist_t *playlist, size_t index,
@@ -37,4 +45,7 @@ int
 vlc_playlist_ExpandItemFromNode(vlc_playlist_t *playlist,
                                 input_item_node_t *subitems);
 
+void
+vlc_playlist_ClearExpansions(vlc_playlist_t *playlist);
+
 #endif
@@ -22,6 +22,7 @@
 # include "config.h"
 #endif
 
+#include <ctype.h>
 #include <vlc_common.h>
 #include <vlc_rand.h>
 #include <vlc_sort.h>
@@ -33,9 +34,13 @@
 /**
  * Struct containing a copy of (parsed) media metadata, used for sorting
  * without locking all the items.
+ *
+ * The strings are stored as sort keys, already case folded, so that they are
+ * compared with a plain strcmp().
  */
 struct vlc_playlist_item_meta {
     vlc_playlist_item_t *item;
+    size_t index; /* position before sorting, to make the sort stable */
     const char *title_or_name;
     vlc_tick_t duration;
     const char *artist;
@@ -58,9 +63,13 @@ vlc_playlist_item_meta_CopyString(const char **to, const char *from)
 {
     if (from)
     {
-        *to = strdup(from);
-        if (unlikely(!*to))
+        char *key = strdup(from);
+        if (unlikely(!key))
             return VLC_ENOMEM;
+        /* fold once, like strcasecmp() would do on every comparison */
+        for (char *c = key; *c; ++c)
+            *c = tolower((unsigned char) *c);
+        *to = key;
     }
     else
         *to = NULL;
@@ -187,43 +196,28 @@ vlc_playlist_item_meta_InitFields(struct vlc_playlist_item_meta *meta,
     return VLC_SUCCESS;
 }
 
-static struct vlc_playlist_item_meta *
-vlc_playlist_item_meta_New(vlc_playlist_item_t *item,
-                           const struct vlc_playlist_sort_criterion criteria[],
-                           size_t count)
+/* meta must be zero-initialized */
+static int
+vlc_playlist_item_meta_Init(struct vlc_playlist_item_meta *meta,
+                            vlc_playlist_item_t *item, size_t index,
+                            const struct vlc_playlist_sort_criterion criteria[],
+                            size_t count)
 {
-    /* assume that NULL representation is all-zeros */
-    struct vlc_playlist_item_meta *meta = calloc(1, sizeof(*meta));
-    if (unlikely(!meta))
-        return NULL;
-
     meta->item = item;
+    meta->index = index;
 
     vlc_mutex_lock(&item->media->lock);
     int ret = vlc_playlist_item_meta_InitFields(meta, criteria, count);
     vlc_mutex_unlock(&item->media->lock);
 
-    if (unlikely(ret != VLC_SUCCESS))
-    {
-        free(meta);
-        return NULL;
-    }
-
-    return meta;
-}
-
-static void
-vlc_playlist_item_meta_Delete(struct vlc_playlist_item_meta *meta)
-{
-    vlc_playlist_item_meta_DestroyFields(meta);
-    free(meta);
+    return ret;
 }
 
 static inline int
 CompareStrings(const char *a, const char *b)
 {
     if (a && b)
-        return strcasecmp(a, b);
+        return strcmp(a, b);
     if (!a && !b)
         return 0;
     return a ? 1 : -1;
@@ -318,45 +312,59 @@ compare_meta(const void *lhs, const void *rhs, void *userdata)
             return ret;
         }
     }
-    return 0;
+    /* keep the initial order of equivalent items */
+    return (a->index > b->index) - (a->index < b->index);
 }
 
+/* the metas are allocated in a single block, only the pointers are sorted */
+struct vlc_playlist_meta_array
+{
+    struct vlc_playlist_item_meta **ptrs;
+    struct vlc_playlist_item_meta *metas;
+};
+
 static void
-vlc_playlist_DeleteMetaArray(struct vlc_playlist_item_meta *array[],
+vlc_playlist_DeleteMetaArray(struct vlc_playlist_meta_array *array,
                              size_t count)
 {
     for (size_t i = 0; i < count; ++i)
-        vlc_playlist_item_meta_Delete(array[i]);
-    free(array);
+        vlc_playlist_item_meta_DestroyFields(&array->metas[i]);
+    free(array->metas);
+    free(array->ptrs);
 }
 
-static struct vlc_playlist_item_meta **
+static int
 vlc_playlist_NewMetaArray(vlc_playlist_t *playlist,
+        struct vlc_playlist_meta_array *array,
         const struct vlc_playlist_sort_criterion criteria[], size_t count)
 {
-    struct vlc_playlist_item_meta **array =
-            vlc_alloc(playlist->items.size, sizeof(*array));
+    size_t size = playlist->items.size;
 
-    if (unlikely(!array))
-        return NULL;
-
-    size_t i;
-    for (i = 0; i < playlist->items.size; ++i)
+    array->ptrs = vlc_alloc(size, sizeof(*array->ptrs));
+    /* assume that NULL representation is all-zeros */
+    array->metas = calloc(size, sizeof(*array->metas));
+    if (unlikely(!array->ptrs || !array->metas))
     {
-        array[i] = vlc_playlist_item_meta_New(playlist->items.data[i],
-                                              criteria, count);
-        if (unlikely(!array[i]))
-            break;
+        free(array->ptrs);
+        free(array->metas);
+        return VLC_ENOMEM;
     }
 
-    if (i < playlist->items.size)
+    for (size_t i = 0; i < size; ++i)
     {
-        /* allocation failure */
-        vlc_playlist_DeleteMetaArray(array, i);
-        return NULL;
+        struct vlc_playlist_item_meta *meta = &array->metas[i];
+        int ret = vlc_playlist_item_meta_Init(meta, playlist->items.data[i], i,
+                                              criteria, count);
+        if (unlikely(ret != VLC_SUCCESS))
+        {
+            /* the fields of the failed meta are already destroyed */
+            vlc_playlist_DeleteMetaArray(array, i);
+            return ret;
+        }
+        array->ptrs[i] = meta;
     }
 
-    return array;
+    return VLC_SUCCESS;
 }
 
 int
@@ -371,20 +379,22 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
                                  ? playlist->items.data[playlist->current]
                                  : NULL;
 
-    struct vlc_playlist_item_meta **array =
-        vlc_playlist_NewMetaArray(playlist, criteria, count);
-    if (unlikely(!array))
-        return VLC_ENOMEM;
+    struct vlc_playlist_meta_array array;
+    int ret = vlc_playlist_NewMetaArray(playlist, &array, criteria, count);
+    if (unlikely(ret != VLC_SUCCESS))
+        return ret;
 
     struct sort_request req = { criteria, count };
 
-    vlc_qsort(array, playlist->items.size, sizeof(*array), compare_meta, &req);
+    vlc_qsort(array.ptrs, playlist->items.size, sizeof(*array.ptrs),
+              compare_meta, &req);
 
     /* apply the sorting result to the playlist */
     for (size_t i = 0; i < playlist->items.size; ++i)
-        playlist->items.data[i] = array[i]->item;
+        playlist->items.data[i] = array.ptrs[i]->item;
+    vlc_playlist_index_Invalidate(&playlist->index, 0);
 
-    vlc_playlist_DeleteMetaArray(array, playlist->items.size);
+    vlc_playlist_DeleteMetaArray(&array, playlist->items.size);
 
     struct vlc_playlist_state state;
     if (current)
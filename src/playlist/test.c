@@ -25,6 +25,7 @@
 #endif
 
 #include <stdio.h>
+#include "content.h"
 #include "item.h"
 #include "playlist.h"
 #include "preparse.h"
@@ -315,6 +316,51 @@ test_expand_item(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_expand_item_batches(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[10];
+    CreateDummyMediaArray(media, 10);
+
+    /* initial playlist with 4 items */
+    int ret = vlc_playlist_Append(playlist, media, 4);
+    assert(ret == VLC_SUCCESS);
+
+    /* the subitems of item 1 are posted in 2 batches of 3 items */
+    input_item_t *item_to_expand = playlist->items.data[1]->media;
+    input_item_Hold(item_to_expand);
+
+    for (int batch = 0; batch < 2; ++batch)
+    {
+        input_item_node_t *root = input_item_node_Create(item_to_expand);
+        assert(root);
+        for (int i = 0; i < 3; ++i)
+        {
+            input_item_node_t *node =
+                input_item_node_AppendItem(root, media[4 + 3 * batch + i]);
+            assert(node);
+        }
+
+        ret = vlc_playlist_ExpandItemFromNode(playlist, root);
+        assert(ret == VLC_SUCCESS);
+        input_item_node_Delete(root);
+    }
+
+    assert(vlc_playlist_Count(playlist) == 9);
+    EXPECT_AT(0, 0);
+    for (int i = 0; i < 6; ++i)
+        EXPECT_AT(1 + i, 4 + i);
+    EXPECT_AT(7, 2);
+    EXPECT_AT(8, 3);
+
+    input_item_Release(item_to_expand);
+    DestroyMediaArray(media, 10);
+    vlc_playlist_Delete(playlist);
+}
+
 struct playlist_state
 {
     size_t playlist_size;
@@ -1065,6 +1111,64 @@ test_index_of(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+assert_index_consistent(vlc_playlist_t *playlist)
+{
+    for (size_t i = 0; i < playlist->items.size; ++i)
+    {
+        vlc_playlist_item_t *item = playlist->items.data[i];
+        assert(vlc_playlist_IndexOf(playlist, item) == (ssize_t) i);
+        assert(vlc_playlist_IndexOfId(playlist, item->id) == (ssize_t) i);
+
+        ssize_t first = -1;
+        for (size_t j = 0; j < playlist->items.size && first == -1; ++j)
+            if (playlist->items.data[j]->media == item->media)
+                first = j;
+        assert(vlc_playlist_IndexOfMedia(playlist, item->media) == first);
+    }
+}
+
+static void
+test_index_of_after_edits(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[10];
+    CreateDummyMediaArray(media, 10);
+
+    /* add the first 5 media twice */
+    int ret = vlc_playlist_Append(playlist, media, 10);
+    assert(ret == VLC_SUCCESS);
+    ret = vlc_playlist_Insert(playlist, 3, media, 5);
+    assert(ret == VLC_SUCCESS);
+    assert_index_consistent(playlist);
+
+    vlc_playlist_Move(playlist, 2, 4, 9);
+    assert_index_consistent(playlist);
+
+    vlc_playlist_Move(playlist, 10, 3, 1);
+    assert_index_consistent(playlist);
+
+    vlc_playlist_Remove(playlist, 4, 3);
+    assert_index_consistent(playlist);
+
+    ret = vlc_playlist_Expand(playlist, 5, &media[7], 3);
+    assert(ret == VLC_SUCCESS);
+    assert_index_consistent(playlist);
+
+    vlc_playlist_Shuffle(playlist);
+    assert_index_consistent(playlist);
+
+    assert(vlc_playlist_IndexOfId(playlist, playlist->idgen) == -1);
+
+    vlc_playlist_Clear(playlist);
+    assert(vlc_playlist_IndexOfMedia(playlist, media[0]) == -1);
+
+    DestroyMediaArray(media, 10);
+    vlc_playlist_Delete(playlist);
+}
+
 static void
 test_prev(void)
 {
@@ -2359,6 +2463,7 @@ int main(void)
     test_remove();
     test_clear();
     test_expand_item();
+    test_expand_item_batches();
     test_items_added_callbacks();
     test_items_moved_callbacks();
     test_items_removed_callbacks();
@@ -2367,6 +2472,7 @@ int main(void)
     test_playback_order_changed_callbacks();
     test_callbacks_on_add_listener();
     test_index_of();
+    test_index_of_after_edits();
     test_prev();
     test_next();
     test_goto();
@@ -123,9 +123,48 @@ void *vlc_threadvar_get (vlc_threadvar_t key)
     return pthread_getspecific (key);
 }
 
+/* Accelerated clock for the tests: vlc_tick_now() runs VLC_CLOCK_SCALE times
+ * faster than the monotonic clock from the first LibVLC initialization. */
+static vlc_tick_t vlc_clock_origin;
+static atomic_uint vlc_clock_scale = ATOMIC_VAR_INIT(1);
+
+static vlc_tick_t vlc_tick_now_monotonic(void)
+{
+    struct timespec ts;
+
+    if (unlikely(clock_gettime(CLOCK_MONOTONIC, &ts) != 0))
+        abort ();
+
+    return vlc_tick_from_timespec( &ts );
+}
+
+static void vlc_clock_setup_scale(void)
+{
+    const char *str = getenv("VLC_CLOCK_SCALE");
+    unsigned scale = str != NULL ? strtoul(str, NULL, 10) : 0;
+
+    if (scale > 1)
+    {
+        vlc_clock_origin = vlc_tick_now_monotonic();
+        atomic_store_explicit(&vlc_clock_scale, scale, memory_order_release);
+    }
+}
+
 void vlc_threads_setup (libvlc_int_t *p_libvlc)
 {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+
     (void) p_libvlc;
+    pthread_once(&once, vlc_clock_setup_scale);
+}
+
+vlc_tick_t vlc_tick_to_monotonic(vlc_tick_t tick)
+{
+    unsigned scale = atomic_load_explicit(&vlc_clock_scale,
+                                          memory_order_acquire);
+    if (likely(scale == 1))
+        return tick;
+    return vlc_clock_origin + (tick - vlc_clock_origin) / scale;
 }
 
 static int vlc_clone_attr (vlc_thread_t *th, pthread_attr_t *attr,
@@ -246,12 +285,13 @@ void vlc_testcancel (void)
 
 vlc_tick_t vlc_tick_now (void)
 {
-    struct timespec ts;
-
-    if (unlikely(clock_gettime(CLOCK_MONOTONIC, &ts) != 0))
-        abort ();
+    vlc_tick_t now = vlc_tick_now_monotonic();
+    unsigned scale = atomic_load_explicit(&vlc_clock_scale,
+                                          memory_order_acquire);
 
-    return vlc_tick_from_timespec( &ts );
+    if (likely(scale == 1))
+        return now;
+    return vlc_clock_origin + (now - vlc_clock_origin) * scale;
 }
 
 #undef vlc_tick_wait
@@ -262,7 +302,7 @@ void vlc_tick_wait (vlc_tick_t deadline)
     /* If the deadline is already elapsed, or within the clock precision,
      * do not even bother the system timer. */
     pthread_once(&vlc_clock_once, vlc_clock_setup_once);
-    deadline -= vlc_clock_prec;
+    deadline = vlc_tick_to_monotonic(deadline) - vlc_clock_prec;
 
     struct timespec ts = timespec_from_vlc_tick (deadline);
 
@@ -272,7 +312,9 @@ void vlc_tick_wait (vlc_tick_t deadline)
 #undef vlc_tick_sleep
 void vlc_tick_sleep (vlc_tick_t delay)
 {
-    struct timespec ts = timespec_from_vlc_tick (delay);
+    unsigned scale = atomic_load_explicit(&vlc_clock_scale,
+                                          memory_order_relaxed);
+    struct timespec ts = timespec_from_vlc_tick (delay / scale);
 
     while (clock_nanosleep(CLOCK_MONOTONIC, 0, &ts, &ts) == EINTR);
 }
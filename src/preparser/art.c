@@ -34,8 +34,12 @@
 #include <vlc_strings.h>
 #include <vlc_url.h>
 #include <vlc_hash.h>
+#include <vlc_block.h>
+#include <vlc_image.h>
+#include <vlc_picture.h>
 
 #include "art.h"
+#include "input/item.h"
 
 static void ArtCacheCreateDir( char *psz_dir )
 {
@@ -154,25 +158,120 @@ end:
     return psz_path;
 }
 
-static char *ArtCacheName( input_item_t *p_item, const char *psz_type )
+/* Name of the file, in the album cache directory, holding the URL of the
+ * deduplicated art */
+#define ART_REF_NAME "arturl"
+
+static bool ArtURLExists( const char *psz_uri )
 {
-    char *psz_path = ArtCachePath( p_item );
-    char *psz_ext = strdup( psz_type ? psz_type : "" );
-    char *psz_filename = NULL;
+    char *psz_path = vlc_uri2path( psz_uri );
+    if( !psz_path )
+        return false;
 
-    if( unlikely( !psz_path || !psz_ext ) )
-        goto end;
+    struct stat s;
+    bool b_exists = !vlc_stat( psz_path, &s );
+    free( psz_path );
+    return b_exists;
+}
 
-    ArtCacheCreateDir( psz_path );
+static char *ArtRefRead( const char *psz_dir )
+{
+    char *psz_file;
+    if( asprintf( &psz_file, "%s" DIR_SEP ART_REF_NAME, psz_dir ) == -1 )
+        return NULL;
+
+    FILE *f = vlc_fopen( psz_file, "rb" );
+    free( psz_file );
+    if( !f )
+        return NULL;
+
+    char sz_uri[2049];
+    char *psz_uri = NULL;
+    if( fgets( sz_uri, sizeof(sz_uri), f ) != NULL && ArtURLExists( sz_uri ) )
+        psz_uri = strdup( sz_uri );
+    fclose( f );
+    return psz_uri;
+}
+
+/* Writes a whole file at once, so that readers never see a partial one */
+static int ArtWriteFile( vlc_object_t *obj, const char *psz_filename,
+                         const void *data, size_t length )
+{
+    char *psz_tmp;
+    if( asprintf( &psz_tmp, "%s.tmp", psz_filename ) == -1 )
+        return VLC_ENOMEM;
+
+    int ret = VLC_EGENERIC;
+    FILE *f = vlc_fopen( psz_tmp, "wb" );
+    if( f )
+    {
+        if( fwrite( data, 1, length, f ) != length )
+            msg_Err( obj, "%s: %s", psz_tmp, vlc_strerror_c(errno) );
+        else
+            ret = VLC_SUCCESS;
+        if( fclose( f ) && ret == VLC_SUCCESS )
+            ret = VLC_EGENERIC;
+    }
+
+    if( ret == VLC_SUCCESS && vlc_rename( psz_tmp, psz_filename ) )
+    {
+        msg_Err( obj, "%s: %s", psz_filename, vlc_strerror_c(errno) );
+        ret = VLC_EGENERIC;
+    }
+    if( ret != VLC_SUCCESS )
+        vlc_unlink( psz_tmp );
+    free( psz_tmp );
+    return ret;
+}
+
+static const char *ArtGuessType( const uint8_t *p, size_t length )
+{
+    if( length >= 3 && !memcmp( p, "\xFF\xD8\xFF", 3 ) )
+        return ".jpg";
+    if( length >= 8 && !memcmp( p, "\x89PNG\r\n\x1A\n", 8 ) )
+        return ".png";
+    if( length >= 6 && ( !memcmp( p, "GIF87a", 6 ) || !memcmp( p, "GIF89a", 6 ) ) )
+        return ".gif";
+    if( length >= 2 && !memcmp( p, "BM", 2 ) )
+        return ".bmp";
+    return "";
+}
+
+/* The same art is often shared by all the tracks of an album, or by several
+ * albums found by different URLs: store it once, named after its content */
+static char *ArtContentName( const void *data, size_t length,
+                             const char *psz_type )
+{
+    char psz_hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+    vlc_hash_md5_Init( &md5 );
+    vlc_hash_md5_Update( &md5, data, length );
+    vlc_hash_FinishHex( &md5, psz_hash );
+
+    char *psz_ext = strdup( psz_type ? psz_type : ArtGuessType( data, length ) );
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_dir = NULL, *psz_filename = NULL;
+
+    if( unlikely( !psz_ext || !psz_cachedir ) )
+        goto end;
     filename_sanitize( psz_ext );
 
-    if( asprintf( &psz_filename, "%s" DIR_SEP "art%s", psz_path, psz_ext ) < 0 )
+    if( asprintf( &psz_dir, "%s" DIR_SEP "art" DIR_SEP "content",
+                  psz_cachedir ) == -1 )
+    {
+        psz_dir = NULL;
+        goto end;
+    }
+    ArtCacheCreateDir( psz_dir );
+
+    if( asprintf( &psz_filename, "%s" DIR_SEP "%s%s", psz_dir, psz_hash,
+                  psz_ext ) == -1 )
         psz_filename = NULL;
 
 end:
+    free( psz_dir );
+    free( psz_cachedir );
     free( psz_ext );
-    free( psz_path );
-
     return psz_filename;
 }
 
@@ -184,7 +283,16 @@ int input_FindArtInCache( input_item_t *p_item )
     if( !psz_path )
         return VLC_EGENERIC;
 
-    /* Check if file exists */
+    char *psz_uri = ArtRefRead( psz_path );
+    if( psz_uri )
+    {
+        input_item_SetArtURL( p_item, psz_uri );
+        free( psz_uri );
+        free( psz_path );
+        return VLC_SUCCESS;
+    }
+
+    /* Check if file exists (caches written before the deduplication) */
     DIR *p_dir = vlc_opendir( psz_path );
     if( !p_dir )
     {
@@ -196,13 +304,14 @@ int input_FindArtInCache( input_item_t *p_item )
     const char *psz_filename;
     while( !b_found && (psz_filename = vlc_readdir( p_dir )) )
     {
-        if( !strncmp( psz_filename, "art", 3 ) )
+        if( !strncmp( psz_filename, "art", 3 )
+         && strcmp( psz_filename, ART_REF_NAME ) )
         {
             char *psz_file;
             if( asprintf( &psz_file, "%s" DIR_SEP "%s",
                           psz_path, psz_filename ) != -1 )
             {
-                char *psz_uri = vlc_path2uri( psz_file, "file" );
+                psz_uri = vlc_path2uri( psz_file, "file" );
                 if( psz_uri )
                 {
                     input_item_SetArtURL( p_item, psz_uri );
@@ -286,44 +395,58 @@ int input_FindArtInCacheUsingItemUID( input_item_t *p_item )
 int input_SaveArt( vlc_object_t *obj, input_item_t *p_item,
                    const void *data, size_t length, const char *psz_type )
 {
-    char *psz_filename = ArtCacheName( p_item, psz_type );
+    char *psz_path = ArtCachePath( p_item );
 
-    if( !psz_filename )
+    if( !psz_path )
         return VLC_EGENERIC;
 
-    char *psz_uri = vlc_path2uri( psz_filename, "file" );
-    if( !psz_uri )
+    ArtCacheCreateDir( psz_path );
+
+    /* Check if we already dumped it */
+    char *psz_uri = ArtRefRead( psz_path );
+    if( psz_uri )
     {
-        free( psz_filename );
+        input_item_SetArtURL( p_item, psz_uri );
+        free( psz_uri );
+        free( psz_path );
+        return VLC_SUCCESS;
+    }
+
+    /* Dump it otherwise, unless another item already did */
+    char *psz_filename = ArtContentName( data, length, psz_type );
+    if( !psz_filename )
+    {
+        free( psz_path );
         return VLC_EGENERIC;
     }
 
-    /* Check if we already dumped it */
     struct stat s;
-    if( !vlc_stat( psz_filename, &s ) )
+    if( vlc_stat( psz_filename, &s )
+     && ArtWriteFile( obj, psz_filename, data, length ) )
     {
-        input_item_SetArtURL( p_item, psz_uri );
         free( psz_filename );
-        free( psz_uri );
-        return VLC_SUCCESS;
+        free( psz_path );
+        return VLC_EGENERIC;
     }
 
-    /* Dump it otherwise */
-    FILE *f = vlc_fopen( psz_filename, "wb" );
-    if( f )
+    psz_uri = vlc_path2uri( psz_filename, "file" );
+    free( psz_filename );
+    if( !psz_uri )
     {
-        if( fwrite( data, 1, length, f ) != length )
-        {
-            msg_Err( obj, "%s: %s", psz_filename, vlc_strerror_c(errno) );
-        }
-        else
-        {
-            msg_Dbg( obj, "album art saved to %s", psz_filename );
-            input_item_SetArtURL( p_item, psz_uri );
-        }
-        fclose( f );
+        free( psz_path );
+        return VLC_EGENERIC;
     }
-    free( psz_uri );
+
+    msg_Dbg( obj, "album art saved to %s", psz_uri );
+    input_item_SetArtURL( p_item, psz_uri );
+
+    char *psz_ref;
+    if( asprintf( &psz_ref, "%s" DIR_SEP ART_REF_NAME, psz_path ) != -1 )
+    {
+        ArtWriteFile( obj, psz_ref, psz_uri, strlen( psz_uri ) );
+        free( psz_ref );
+    }
+    free( psz_path );
 
     /* save uid info */
     char *uid = input_item_GetInfo( p_item, "uid", "md5" );
@@ -340,20 +463,165 @@ int input_SaveArt( vlc_object_t *obj, input_item_t *p_item,
 
     if ( psz_byuidfile )
     {
-        f = vlc_fopen( psz_byuidfile, "wb" );
-        if ( f )
-        {
-            if( fputs( "file://", f ) < 0 || fputs( psz_filename, f ) < 0 )
-                msg_Err( obj, "Error writing %s: %s", psz_byuidfile,
-                         vlc_strerror_c(errno) );
-            fclose( f );
-        }
+        ArtWriteFile( obj, psz_byuidfile, psz_uri, strlen( psz_uri ) );
         free( psz_byuidfile );
     }
     free( uid );
     /* !save uid info */
 end:
-    free( psz_filename );
+    free( psz_uri );
     return VLC_SUCCESS;
 }
 
+static char *ArtHashFile( const char *psz_path )
+{
+    FILE *f = vlc_fopen( psz_path, "rb" );
+    if( !f )
+        return NULL;
+
+    vlc_hash_md5_t md5;
+    vlc_hash_md5_Init( &md5 );
+
+    uint8_t buf[4096];
+    size_t i_read;
+    while( (i_read = fread( buf, 1, sizeof(buf), f )) > 0 )
+        vlc_hash_md5_Update( &md5, buf, i_read );
+
+    bool b_error = ferror( f );
+    fclose( f );
+    if( b_error )
+        return NULL;
+
+    char *psz_hash = malloc( VLC_HASH_MD5_DIGEST_HEX_SIZE );
+    if( psz_hash )
+        vlc_hash_FinishHex( &md5, psz_hash );
+    return psz_hash;
+}
+
+static void ArtSetVariant( input_item_t *p_item, unsigned i_size,
+                           const char *psz_uri )
+{
+    char psz_name[sizeof(INPUT_ITEM_ART_VARIANT_META) + 10];
+    snprintf( psz_name, sizeof(psz_name), INPUT_ITEM_ART_VARIANT_META, i_size );
+
+    vlc_mutex_lock( &p_item->lock );
+    vlc_meta_AddExtra( p_item->p_meta, psz_name, psz_uri );
+    vlc_mutex_unlock( &p_item->lock );
+}
+
+int input_MakeArtVariants( vlc_object_t *obj, input_item_t *p_item )
+{
+    static const unsigned sizes[] = { INPUT_ITEM_ART_VARIANT_SIZES };
+
+    char *psz_arturl = input_item_GetArtURL( p_item );
+    if( !psz_arturl )
+        return VLC_EGENERIC;
+
+    char *psz_artpath = vlc_uri2path( psz_arturl );
+    if( !psz_artpath )
+    {
+        free( psz_arturl );
+        return VLC_EGENERIC;
+    }
+
+    /* Name the variants after the content, so that they are shared by the
+     * items with the same art */
+    char *psz_hash = ArtHashFile( psz_artpath );
+    char *psz_cachedir = config_GetUserDir( VLC_CACHE_DIR );
+    char *psz_dir = NULL;
+    image_handler_t *p_image = NULL;
+    picture_t *p_pic = NULL;
+    bool b_changed = false;
+    int ret = VLC_EGENERIC;
+
+    if( !psz_hash || !psz_cachedir
+     || asprintf( &psz_dir, "%s" DIR_SEP "art" DIR_SEP "variants",
+                  psz_cachedir ) == -1 )
+    {
+        psz_dir = NULL;
+        goto end;
+    }
+    ArtCacheCreateDir( psz_dir );
+
+    for( size_t i = 0; i < ARRAY_SIZE(sizes); i++ )
+    {
+        char *psz_file;
+        if( asprintf( &psz_file, "%s" DIR_SEP "%s-%u.jpg", psz_dir, psz_hash,
+                      sizes[i] ) == -1 )
+            goto end;
+
+        struct stat s;
+        if( vlc_stat( psz_file, &s ) )
+        {
+            /* Only decode the art if a variant is missing */
+            if( !p_pic )
+            {
+                video_format_t fmt;
+                video_format_Init( &fmt, 0 );
+                p_image = image_HandlerCreate( obj );
+                if( p_image )
+                    p_pic = image_ReadUrl( p_image, psz_arturl, &fmt );
+                video_format_Clean( &fmt );
+                if( !p_pic )
+                {
+                    msg_Dbg( obj, "cannot decode the art %s", psz_artpath );
+                    free( psz_file );
+                    goto end;
+                }
+            }
+
+            /* Never upscale: the original art is used for larger sizes */
+            unsigned i_width = p_pic->format.i_visible_width;
+            unsigned i_height = p_pic->format.i_visible_height;
+            if( i_width <= sizes[i] && i_height <= sizes[i] )
+            {
+                free( psz_file );
+                break;
+            }
+
+            block_t *p_block;
+            if( picture_Export( obj, &p_block, NULL, p_pic, VLC_CODEC_JPEG,
+                                i_width >= i_height ? (int)sizes[i] : 0,
+                                i_width >= i_height ? 0 : (int)sizes[i],
+                                false ) )
+            {
+                free( psz_file );
+                goto end;
+            }
+
+            int i_ret = ArtWriteFile( obj, psz_file, p_block->p_buffer,
+                                      p_block->i_buffer );
+            block_Release( p_block );
+            if( i_ret )
+            {
+                free( psz_file );
+                goto end;
+            }
+        }
+
+        char *psz_uri = vlc_path2uri( psz_file, "file" );
+        free( psz_file );
+        if( !psz_uri )
+            goto end;
+        ArtSetVariant( p_item, sizes[i], psz_uri );
+        free( psz_uri );
+        b_changed = true;
+    }
+    ret = VLC_SUCCESS;
+
+end:
+    if( b_changed )
+        vlc_event_send( &p_item->event_manager, &(vlc_event_t) {
+            .type = vlc_InputItemMetaChanged,
+            .u.input_item_meta_changed.meta_type = vlc_meta_ArtworkURL } );
+    if( p_pic )
+        picture_Release( p_pic );
+    if( p_image )
+        image_HandlerDelete( p_image );
+    free( psz_dir );
+    free( psz_cachedir );
+    free( psz_hash );
+    free( psz_artpath );
+    free( psz_arturl );
+    return ret;
+}
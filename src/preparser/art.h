@@ -30,5 +30,15 @@ int input_FindArtInCacheUsingItemUID( input_item_t * );
 int input_SaveArt( vlc_object_t *, input_item_t *,
                    const void *, size_t, const char *psz_type );
 
+/**
+ * Stores downscaled copies of the local art of an item.
+ *
+ * The variants are JPEG pictures fitting in INPUT_ITEM_ART_VARIANT_SIZES,
+ * named after the content of the art. Their URLs are added to the item as
+ * INPUT_ITEM_ART_VARIANT_META extra meta. Art smaller than a size is not
+ * upscaled.
+ */
+int input_MakeArtVariants( vlc_object_t *, input_item_t * );
+
 #endif
 
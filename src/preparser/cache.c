@@ -0,0 +1,622 @@
+/*****************************************************************************
+ * cache.c: Preparser result cache
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include <vlc_common.h>
+#include <vlc_configuration.h>
+#include <vlc_es.h>
+#include <vlc_fs.h>
+#include <vlc_hash.h>
+#include <vlc_memstream.h>
+#include <vlc_meta.h>
+#include <vlc_strings.h>
+#include <vlc_url.h>
+
+#include "input/item.h"
+#include "cache.h"
+
+#define PREPARSE_CACHE_MAGIC "VLCPREP1"
+#define PREPARSE_CACHE_MAX_DEPTH 16
+
+/* The entries are only read back by the same host, the values are stored in
+ * native byte order */
+struct preparse_cache_header
+{
+    char     magic[8];
+    uint64_t file_size;
+    int64_t  file_mtime;
+    uint64_t file_ino;
+    int64_t  date; /**< storage date, in seconds since the Epoch */
+    uint64_t data_size;
+};
+
+/* Returns the cache directory, and the file path of the entry for the item
+ * in *pathp */
+static char *CacheDir(vlc_object_t *obj, input_item_t *item,
+                      struct stat *st, char **pathp)
+{
+    if (!var_InheritBool(obj, "preparse-cache"))
+        return NULL;
+
+    vlc_mutex_lock(&item->lock);
+    char *uri = item->psz_uri ? strdup(item->psz_uri) : NULL;
+    vlc_mutex_unlock(&item->lock);
+    if (uri == NULL)
+        return NULL;
+
+    /* Only the local files can be identified without opening them */
+    char *path = vlc_uri2path(uri);
+    if (path == NULL || vlc_stat(path, st) != 0
+     || !(S_ISREG(st->st_mode) || S_ISDIR(st->st_mode)))
+    {
+        free(path);
+        free(uri);
+        return NULL;
+    }
+    free(path);
+
+    char *cachedir = config_GetUserDir(VLC_CACHE_DIR);
+    char *dir;
+    if (cachedir == NULL
+     || asprintf(&dir, "%s" DIR_SEP "preparse", cachedir) == -1)
+        dir = NULL;
+    free(cachedir);
+    if (dir == NULL)
+    {
+        free(uri);
+        return NULL;
+    }
+
+    /* The size, date and inode are checked from the header of the entry */
+    char hash[VLC_HASH_MD5_DIGEST_HEX_SIZE];
+    vlc_hash_md5_t md5;
+
+    vlc_hash_md5_Init(&md5);
+    vlc_hash_md5_Update(&md5, uri, strlen(uri));
+    vlc_hash_FinishHex(&md5, hash);
+    free(uri);
+
+    if (asprintf(pathp, "%s" DIR_SEP "%s", dir, hash) == -1)
+    {
+        free(dir);
+        return NULL;
+    }
+    return dir;
+}
+
+/*
+ * Serialization
+ */
+
+static void WriteU32(struct vlc_memstream *ms, uint32_t val)
+{
+    vlc_memstream_write(ms, &val, sizeof (val));
+}
+
+static void WriteI64(struct vlc_memstream *ms, int64_t val)
+{
+    vlc_memstream_write(ms, &val, sizeof (val));
+}
+
+static void WriteString(struct vlc_memstream *ms, const char *str)
+{
+    if (str == NULL)
+    {
+        WriteU32(ms, UINT32_MAX);
+        return;
+    }
+
+    size_t len = strlen(str);
+    WriteU32(ms, len);
+    vlc_memstream_write(ms, str, len);
+}
+
+static void WriteMeta(struct vlc_memstream *ms, const vlc_meta_t *meta)
+{
+    for (int i = 0; i < VLC_META_TYPE_COUNT; i++)
+    {
+        const char *value = vlc_meta_Get(meta, i);
+
+        /* Attachments are only reachable from a running input */
+        if (i == vlc_meta_ArtworkURL && value != NULL
+         && !strncmp(value, "attachment://", 13))
+            value = NULL;
+        WriteString(ms, value);
+    }
+
+    char **names = vlc_meta_CopyExtraNames(meta);
+    uint32_t count = 0;
+
+    if (names != NULL)
+        while (names[count] != NULL)
+            count++;
+
+    WriteU32(ms, count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        WriteString(ms, names[i]);
+        WriteString(ms, vlc_meta_GetExtra(meta, names[i]));
+        free(names[i]);
+    }
+    free(names);
+}
+
+static void WriteFormat(struct vlc_memstream *ms, const es_format_t *fmt)
+{
+    WriteU32(ms, fmt->i_cat);
+    WriteU32(ms, fmt->i_codec);
+    WriteU32(ms, fmt->i_original_fourcc);
+    WriteU32(ms, fmt->i_id);
+    WriteU32(ms, fmt->i_group);
+    WriteU32(ms, fmt->i_profile);
+    WriteU32(ms, fmt->i_level);
+    WriteU32(ms, fmt->i_bitrate);
+    WriteString(ms, fmt->psz_language);
+    WriteString(ms, fmt->psz_description);
+
+    switch (fmt->i_cat)
+    {
+        case AUDIO_ES:
+            WriteU32(ms, fmt->audio.i_rate);
+            WriteU32(ms, fmt->audio.i_channels);
+            WriteU32(ms, fmt->audio.i_bitspersample);
+            break;
+        case VIDEO_ES:
+            WriteU32(ms, fmt->video.i_width);
+            WriteU32(ms, fmt->video.i_height);
+            WriteU32(ms, fmt->video.i_visible_width);
+            WriteU32(ms, fmt->video.i_visible_height);
+            WriteU32(ms, fmt->video.i_sar_num);
+            WriteU32(ms, fmt->video.i_sar_den);
+            WriteU32(ms, fmt->video.i_frame_rate);
+            WriteU32(ms, fmt->video.i_frame_rate_base);
+            WriteU32(ms, fmt->video.orientation);
+            break;
+        default:
+            break;
+    }
+}
+
+static void WriteNode(struct vlc_memstream *ms, const input_item_node_t *node,
+                      unsigned depth)
+{
+    if (depth >= PREPARSE_CACHE_MAX_DEPTH)
+    {
+        WriteU32(ms, 0);
+        return;
+    }
+
+    WriteU32(ms, node->i_children);
+    for (int i = 0; i < node->i_children; i++)
+    {
+        const input_item_node_t *child = node->pp_children[i];
+        input_item_t *item = child->p_item;
+
+        vlc_mutex_lock(&item->lock);
+        WriteString(ms, item->psz_uri);
+        WriteString(ms, item->psz_name);
+        WriteI64(ms, item->i_duration);
+        vlc_mutex_unlock(&item->lock);
+
+        WriteNode(ms, child, depth + 1);
+    }
+}
+
+struct reader
+{
+    const uint8_t *p;
+    size_t left;
+    bool error;
+};
+
+static void Read(struct reader *r, void *buf, size_t size)
+{
+    if (r->error || r->left < size)
+    {
+        r->error = true;
+        memset(buf, 0, size);
+        return;
+    }
+    memcpy(buf, r->p, size);
+    r->p += size;
+    r->left -= size;
+}
+
+static uint32_t ReadU32(struct reader *r)
+{
+    uint32_t val;
+    Read(r, &val, sizeof (val));
+    return val;
+}
+
+static int64_t ReadI64(struct reader *r)
+{
+    int64_t val;
+    Read(r, &val, sizeof (val));
+    return val;
+}
+
+/* Returns NULL for a NULL string, or on error (r->error is then set) */
+static char *ReadString(struct reader *r)
+{
+    uint32_t len = ReadU32(r);
+    if (r->error || len == UINT32_MAX)
+        return NULL;
+    if (len > r->left)
+    {
+        r->error = true;
+        return NULL;
+    }
+
+    char *str = strndup((const char *) r->p, len);
+    if (unlikely(str == NULL))
+        r->error = true;
+    r->p += len;
+    r->left -= len;
+    return str;
+}
+
+static void ReadMeta(struct reader *r, vlc_meta_t *meta)
+{
+    for (int i = 0; i < VLC_META_TYPE_COUNT && !r->error; i++)
+    {
+        char *value = ReadString(r);
+        if (value != NULL)
+            vlc_meta_Set(meta, i, value);
+        free(value);
+    }
+
+    uint32_t count = ReadU32(r);
+    for (uint32_t i = 0; i < count && !r->error; i++)
+    {
+        char *name = ReadString(r);
+        char *value = ReadString(r);
+        if (name != NULL && value != NULL)
+            vlc_meta_AddExtra(meta, name, value);
+        free(name);
+        free(value);
+    }
+}
+
+static void ReadFormat(struct reader *r, es_format_t *fmt)
+{
+    uint32_t cat = ReadU32(r);
+    vlc_fourcc_t codec = ReadU32(r);
+
+    if (cat >= ES_CATEGORY_COUNT)
+        r->error = true;
+    es_format_Init(fmt, r->error ? UNKNOWN_ES : cat, codec);
+
+    fmt->i_original_fourcc = ReadU32(r);
+    fmt->i_id = ReadU32(r);
+    fmt->i_group = ReadU32(r);
+    fmt->i_profile = ReadU32(r);
+    fmt->i_level = ReadU32(r);
+    fmt->i_bitrate = ReadU32(r);
+    fmt->psz_language = ReadString(r);
+    fmt->psz_description = ReadString(r);
+
+    switch (fmt->i_cat)
+    {
+        case AUDIO_ES:
+            fmt->audio.i_rate = ReadU32(r);
+            fmt->audio.i_channels = ReadU32(r);
+            fmt->audio.i_bitspersample = ReadU32(r);
+            break;
+        case VIDEO_ES:
+            fmt->video.i_width = ReadU32(r);
+            fmt->video.i_height = ReadU32(r);
+            fmt->video.i_visible_width = ReadU32(r);
+            fmt->video.i_visible_height = ReadU32(r);
+            fmt->video.i_sar_num = ReadU32(r);
+            fmt->video.i_sar_den = ReadU32(r);
+            fmt->video.i_frame_rate = ReadU32(r);
+            fmt->video.i_frame_rate_base = ReadU32(r);
+            fmt->video.orientation = ReadU32(r);
+            if (fmt->video.orientation > ORIENT_MAX)
+                fmt->video.orientation = ORIENT_NORMAL;
+            break;
+        default:
+            break;
+    }
+}
+
+static void ReadNode(struct reader *r, input_item_node_t *node,
+                     unsigned depth)
+{
+    uint32_t count = ReadU32(r);
+    if (count > 0 && depth >= PREPARSE_CACHE_MAX_DEPTH)
+        r->error = true;
+
+    for (uint32_t i = 0; i < count && !r->error; i++)
+    {
+        char *uri = ReadString(r);
+        char *name = ReadString(r);
+        vlc_tick_t duration = ReadI64(r);
+
+        input_item_t *item = NULL;
+        if (!r->error && uri != NULL)
+            item = input_item_NewExt(uri, name, duration, ITEM_TYPE_UNKNOWN,
+                                     ITEM_NET_UNKNOWN);
+        free(uri);
+        free(name);
+        if (item == NULL)
+        {
+            r->error = true;
+            break;
+        }
+
+        input_item_node_t *child = input_item_node_AppendItem(node, item);
+        input_item_Release(item);
+        if (child == NULL)
+        {
+            r->error = true;
+            break;
+        }
+        ReadNode(r, child, depth + 1);
+    }
+}
+
+/*
+ * Entries
+ */
+
+static void *LoadEntry(vlc_object_t *obj, const char *path,
+                       const struct stat *st, size_t *size)
+{
+    FILE *stream = vlc_fopen(path, "rb");
+    if (stream == NULL)
+        return NULL;
+
+    struct preparse_cache_header hdr;
+    void *data = NULL;
+
+    if (fread(&hdr, sizeof (hdr), 1, stream) != 1
+     || memcmp(hdr.magic, PREPARSE_CACHE_MAGIC, sizeof (hdr.magic))
+     || hdr.file_size != (uint64_t) st->st_size
+     || hdr.file_mtime != (int64_t) st->st_mtime
+     || hdr.file_ino != (uint64_t) st->st_ino
+     || hdr.data_size == 0 || hdr.data_size > SIZE_MAX)
+        goto out;
+
+    int64_t ttl = var_InheritInteger(obj, "preparse-cache-ttl");
+    if (ttl > 0 && (int64_t) time(NULL) - hdr.date > ttl)
+    {
+        msg_Dbg(obj, "preparse cache entry %s expired", path);
+        goto out;
+    }
+
+    data = malloc(hdr.data_size);
+    if (unlikely(data == NULL))
+        goto out;
+
+    if (fread(data, 1, hdr.data_size, stream) != hdr.data_size)
+    {
+        free(data);
+        data = NULL;
+        goto out;
+    }
+    *size = hdr.data_size;
+out:
+    fclose(stream);
+    return data;
+}
+
+int input_preparser_cache_Load(vlc_object_t *obj, input_item_t *item,
+                               input_item_node_t **subtree)
+{
+    struct stat st;
+    char *path;
+    char *dir = CacheDir(obj, item, &st, &path);
+    if (dir == NULL)
+        return VLC_EGENERIC;
+    free(dir);
+
+    size_t size;
+    void *data = LoadEntry(obj, path, &st, &size);
+    free(path);
+    if (data == NULL)
+        return VLC_EGENERIC;
+
+    /* Decode everything before touching the item, so that a corrupted entry
+     * has no effect */
+    struct reader r = { .p = data, .left = size, .error = false };
+    es_format_t **es = NULL;
+    uint32_t es_count = 0;
+    input_item_node_t *node = NULL;
+
+    vlc_tick_t duration = ReadI64(&r);
+
+    vlc_meta_t *meta = vlc_meta_New();
+    if (unlikely(meta == NULL))
+        r.error = true;
+    else
+        ReadMeta(&r, meta);
+
+    es_count = ReadU32(&r);
+    if (!r.error && es_count > r.left)
+        r.error = true;
+    if (!r.error && es_count > 0)
+    {
+        es = vlc_alloc(es_count, sizeof (*es));
+        if (unlikely(es == NULL))
+            r.error = true;
+    }
+    for (uint32_t i = 0; i < es_count && !r.error; i++)
+    {
+        es[i] = malloc(sizeof (**es));
+        if (unlikely(es[i] == NULL))
+        {
+            r.error = true;
+            es_count = i;
+            break;
+        }
+        ReadFormat(&r, es[i]);
+    }
+    if (es == NULL)
+        es_count = 0;
+
+    if (ReadU32(&r) != 0 && !r.error)
+    {
+        node = input_item_node_Create(item);
+        if (unlikely(node == NULL))
+            r.error = true;
+        else
+            ReadNode(&r, node, 0);
+    }
+    free(data);
+
+    if (!r.error)
+    {
+        input_item_SetDuration(item, duration);
+
+        for (int i = 0; i < VLC_META_TYPE_COUNT; i++)
+        {
+            const char *value = vlc_meta_Get(meta, i);
+            if (value != NULL)
+                input_item_SetMeta(item, i, value);
+        }
+
+        vlc_mutex_lock(&item->lock);
+        char **names = vlc_meta_CopyExtraNames(meta);
+        for (size_t i = 0; names != NULL && names[i] != NULL; i++)
+        {
+            vlc_meta_AddExtra(item->p_meta, names[i],
+                              vlc_meta_GetExtra(meta, names[i]));
+            free(names[i]);
+        }
+        free(names);
+        vlc_mutex_unlock(&item->lock);
+
+        for (uint32_t i = 0; i < es_count; i++)
+            input_item_UpdateTracksInfo(item, es[i]);
+
+        *subtree = node;
+        node = NULL;
+        msg_Dbg(obj, "loaded preparsing result from cache (%zu bytes)", size);
+    }
+
+    for (uint32_t i = 0; i < es_count; i++)
+    {
+        es_format_Clean(es[i]);
+        free(es[i]);
+    }
+    free(es);
+    if (node != NULL)
+        input_item_node_Delete(node);
+    if (meta != NULL)
+        vlc_meta_Delete(meta);
+
+    return r.error ? VLC_EGENERIC : VLC_SUCCESS;
+}
+
+int input_preparser_cache_Store(vlc_object_t *obj, input_item_t *item,
+                                const input_item_node_t *subtree)
+{
+    struct stat st;
+    char *path;
+    char *dir = CacheDir(obj, item, &st, &path);
+    if (dir == NULL)
+        return VLC_EGENERIC;
+
+    struct vlc_memstream ms;
+    vlc_memstream_open(&ms);
+
+    vlc_mutex_lock(&item->lock);
+    WriteI64(&ms, item->i_duration);
+    WriteMeta(&ms, item->p_meta);
+    WriteU32(&ms, item->i_es);
+    for (int i = 0; i < item->i_es; i++)
+        WriteFormat(&ms, item->es[i]);
+    vlc_mutex_unlock(&item->lock);
+
+    WriteU32(&ms, subtree != NULL);
+    if (subtree != NULL)
+        WriteNode(&ms, subtree, 0);
+
+    if (vlc_memstream_close(&ms))
+    {
+        free(dir);
+        free(path);
+        return VLC_ENOMEM;
+    }
+
+    char *cachedir = config_GetUserDir(VLC_CACHE_DIR);
+    if (cachedir != NULL)
+    {
+        vlc_mkdir(cachedir, 0700);
+        free(cachedir);
+    }
+    vlc_mkdir(dir, 0700);
+    free(dir);
+
+    /* Write a temporary file, so that a concurrent or interrupted writer
+     * never leaves a truncated entry */
+    int ret = VLC_EGENERIC;
+    char *tmppath;
+    if (asprintf(&tmppath, "%s.tmp", path) == -1)
+    {
+        ret = VLC_ENOMEM;
+        tmppath = NULL;
+        goto out;
+    }
+
+    FILE *stream = vlc_fopen(tmppath, "wb");
+    if (stream == NULL)
+    {
+        msg_Dbg(obj, "cannot create preparse cache %s: %s", tmppath,
+                vlc_strerror_c(errno));
+        goto out;
+    }
+
+    struct preparse_cache_header hdr = {
+        .file_size = st.st_size,
+        .file_mtime = st.st_mtime,
+        .file_ino = st.st_ino,
+        .date = time(NULL),
+        .data_size = ms.length,
+    };
+    memcpy(hdr.magic, PREPARSE_CACHE_MAGIC, sizeof (hdr.magic));
+
+    bool ok = fwrite(&hdr, sizeof (hdr), 1, stream) == 1
+           && fwrite(ms.ptr, 1, ms.length, stream) == ms.length;
+    if (fclose(stream) != 0)
+        ok = false;
+
+    if (ok && vlc_rename(tmppath, path) == 0)
+        ret = VLC_SUCCESS;
+    else
+        vlc_unlink(tmppath);
+out:
+    free(tmppath);
+    free(path);
+    free(ms.ptr);
+    return ret;
+}
@@ -0,0 +1,50 @@
+/*****************************************************************************
+ * cache.h: Preparser result cache
+ *****************************************************************************
+ * Copyright © 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSER_CACHE_H
+#define _INPUT_PREPARSER_CACHE_H 1
+
+#include <vlc_input_item.h>
+
+/**
+ * Loads the cached preparsing result of a local item.
+ *
+ * The entry is only used if the size, the modification date and the inode
+ * of the file did not change since it was stored, and if it is not older
+ * than "preparse-cache-ttl".
+ *
+ * On success, the duration, the meta and the tracks of the item are updated,
+ * and *subtree is set to the cached subitems (or NULL if there were none).
+ * The subtree must be released with input_item_node_Delete().
+ *
+ * @return VLC_SUCCESS if a valid entry was found and applied
+ */
+int input_preparser_cache_Load( vlc_object_t *, input_item_t *,
+                                input_item_node_t **subtree );
+
+/**
+ * Stores the preparsing result of a local item.
+ *
+ * @param subtree subitems found by the preparser, or NULL
+ */
+int input_preparser_cache_Store( vlc_object_t *, input_item_t *,
+                                 const input_item_node_t *subtree );
+
+#endif
@@ -32,6 +32,7 @@
 #include <vlc_memstream.h>
 #include <vlc_meta_fetcher.h>
 #include <vlc_executor.h>
+#include <vlc_url.h>
 
 #include "art.h"
 #include "libvlc.h"
@@ -43,14 +44,26 @@ struct input_fetcher_t {
     vlc_executor_t *executor_local;
     vlc_executor_t *executor_network;
     vlc_executor_t *executor_downloader;
+    vlc_executor_t *executor_variants; /**< NULL if "fetch-art-variants" is disabled */
 
     vlc_dictionary_t album_cache;
     vlc_object_t* owner;
 
+    /** Maximum number of simultaneous downloads from the same host */
+    unsigned host_max;
+    vlc_dictionary_t hosts; /**< struct fetcher_host by host name */
+    bool closing;
+
     vlc_mutex_t lock;
     struct vlc_list submitted_tasks; /**< list of struct task */
 };
 
+struct fetcher_host {
+    unsigned active; /**< number of downloads running from this host */
+    struct vlc_list waiting; /**< list of struct task, waiting for a slot */
+    char name[];
+};
+
 struct task {
     input_fetcher_t *fetcher;
     vlc_executor_t *executor;
@@ -61,6 +74,10 @@ struct task {
 
     vlc_interrupt_t interrupt;
 
+    struct fetcher_host *host; /**< host of the download slot, if any */
+    bool parked; /**< waiting in fetcher_host.waiting */
+    struct vlc_list host_node; /**< node of fetcher_host.waiting */
+
     struct vlc_runnable runnable; /**< to be passed to the executor */
     struct vlc_list node; /**< node of input_fetcher_t.submitted_tasks */
 };
@@ -68,6 +85,7 @@ struct task {
 static void RunDownloader(void *);
 static void RunSearchLocal(void *);
 static void RunSearchNetwork(void *);
+static void RunVariants(void *);
 
 static struct task *
 TaskNew(input_fetcher_t *fetcher, vlc_executor_t *executor, input_item_t *item,
@@ -84,6 +102,8 @@ TaskNew(input_fetcher_t *fetcher, vlc_executor_t *executor, input_item_t *item,
     task->options = options;
     task->cbs = cbs;
     task->userdata = userdata;
+    task->host = NULL;
+    task->parked = false;
 
     vlc_interrupt_init(&task->interrupt);
 
@@ -93,6 +113,8 @@ TaskNew(input_fetcher_t *fetcher, vlc_executor_t *executor, input_item_t *item,
         task->runnable.run = RunSearchLocal;
     else if (executor == fetcher->executor_network)
         task->runnable.run = RunSearchNetwork;
+    else if (executor == fetcher->executor_variants)
+        task->runnable.run = RunVariants;
     else
     {
         assert(executor == fetcher->executor_downloader);
@@ -113,11 +135,26 @@ TaskDelete(struct task *task)
 }
 
 static void
-FetcherAddTask(input_fetcher_t *fetcher, struct task *task)
+SubmitRunnableLocked(input_fetcher_t *fetcher, struct task *task)
+{
+    vlc_mutex_assert(&fetcher->lock);
+
+    if (task->options & META_REQUEST_OPTION_PRIORITY)
+        vlc_executor_SubmitUrgent(task->executor, &task->runnable);
+    else
+        vlc_executor_Submit(task->executor, &task->runnable);
+}
+
+static int
+TaskGetOptions(struct task *task)
 {
+    input_fetcher_t *fetcher = task->fetcher;
+
+    /* The priority may be raised by input_fetcher_Prioritize() */
     vlc_mutex_lock(&fetcher->lock);
-    vlc_list_append(&task->node, &fetcher->submitted_tasks);
+    int options = task->options;
     vlc_mutex_unlock(&fetcher->lock);
+    return options;
 }
 
 static void
@@ -138,12 +175,104 @@ Submit(input_fetcher_t *fetcher, vlc_executor_t *executor, input_item_t *item,
     if (!task)
         return VLC_ENOMEM;
 
-    FetcherAddTask(fetcher, task);
-    vlc_executor_Submit(task->executor, &task->runnable);
+    vlc_mutex_lock(&fetcher->lock);
+    vlc_list_append(&task->node, &fetcher->submitted_tasks);
+    SubmitRunnableLocked(fetcher, task);
+    vlc_mutex_unlock(&fetcher->lock);
 
     return VLC_SUCCESS;
 }
 
+/**
+ * Take a download slot for the host of the url
+ *
+ * \return true if the download can start, false if the task has been parked
+ * until a download from the same host ends
+ */
+static bool HostAcquire(input_fetcher_t *fetcher, struct task *task,
+                        const char *url)
+{
+    if (task->host != NULL)
+        return true; /* slot handed over by HostRelease() */
+
+    if (fetcher->host_max == 0)
+        return true;
+
+    vlc_url_t parsed;
+    vlc_UrlParse(&parsed, url);
+    if (parsed.psz_host == NULL)
+    {
+        vlc_UrlClean(&parsed);
+        return true;
+    }
+
+    bool acquired = true;
+
+    vlc_mutex_lock(&fetcher->lock);
+    if (fetcher->closing)
+        goto end;
+
+    struct fetcher_host *host =
+        vlc_dictionary_value_for_key(&fetcher->hosts, parsed.psz_host);
+    if (host == NULL)
+    {
+        size_t len = strlen(parsed.psz_host) + 1;
+        host = malloc(sizeof(*host) + len);
+        if (unlikely(host == NULL))
+            goto end; /* do not limit */
+        host->active = 0;
+        vlc_list_init(&host->waiting);
+        memcpy(host->name, parsed.psz_host, len);
+        vlc_dictionary_insert(&fetcher->hosts, host->name, host);
+    }
+
+    task->host = host;
+    if (host->active < fetcher->host_max)
+        host->active++;
+    else
+    {
+        task->parked = true;
+        if (task->options & META_REQUEST_OPTION_PRIORITY)
+            vlc_list_prepend(&task->host_node, &host->waiting);
+        else
+            vlc_list_append(&task->host_node, &host->waiting);
+        acquired = false;
+    }
+
+end:
+    vlc_mutex_unlock(&fetcher->lock);
+    vlc_UrlClean(&parsed);
+    return acquired;
+}
+
+static void HostRelease(input_fetcher_t *fetcher, struct task *task)
+{
+    struct fetcher_host *host = task->host;
+    if (host == NULL)
+        return;
+    task->host = NULL;
+
+    vlc_mutex_lock(&fetcher->lock);
+
+    struct task *next =
+        vlc_list_first_entry_or_null(&host->waiting, struct task, host_node);
+    if (next != NULL)
+    {
+        /* Hand the slot over to the next download from this host */
+        vlc_list_remove(&next->host_node);
+        next->parked = false;
+        SubmitRunnableLocked(fetcher, next);
+    }
+    else if (--host->active == 0)
+    {
+        vlc_dictionary_remove_value_for_key(&fetcher->hosts, host->name,
+                                            NULL, NULL);
+        free(host);
+    }
+
+    vlc_mutex_unlock(&fetcher->lock);
+}
+
 static char* CreateCacheKey( input_item_t* item )
 {
     vlc_mutex_lock( &item->lock );
@@ -285,7 +414,7 @@ static int SearchByScope(struct task *task, int scope)
     {
         AddAlbumCache( fetcher, task->item, false );
         int ret = Submit(fetcher, fetcher->executor_downloader, item,
-                         task->options, task->cbs, task->userdata);
+                         TaskGetOptions(task), task->cbs, task->userdata);
         if (ret == VLC_SUCCESS)
             return VLC_SUCCESS;
     }
@@ -293,6 +422,28 @@ static int SearchByScope(struct task *task, int scope)
     return VLC_EGENERIC;
 }
 
+static void SubmitVariants(input_fetcher_t *fetcher, input_item_t *item)
+{
+    if (!fetcher->executor_variants)
+        return;
+
+    struct task *task =
+        TaskNew(fetcher, fetcher->executor_variants, item, 0, NULL, NULL);
+    if (!task)
+        return;
+
+    vlc_mutex_lock(&fetcher->lock);
+    if (fetcher->closing)
+    {
+        vlc_mutex_unlock(&fetcher->lock);
+        TaskDelete(task);
+        return;
+    }
+    vlc_list_append(&task->node, &fetcher->submitted_tasks);
+    SubmitRunnableLocked(fetcher, task);
+    vlc_mutex_unlock(&fetcher->lock);
+}
+
 static void NotifyArtFetchEnded(struct task *task, bool fetched)
 {
     if (task->cbs && task->cbs->on_art_fetch_ended)
@@ -316,6 +467,15 @@ static void RunDownloader(void *userdata)
         !strncasecmp( psz_arturl, "attachment://", 13 ) )
         goto out; /* no fetch required */
 
+    if( !HostAcquire( fetcher, task, psz_arturl ) )
+    {
+        /* Too many downloads from this host, the task will be submitted
+         * again by HostRelease() */
+        vlc_interrupt_set(NULL);
+        free( psz_arturl );
+        return;
+    }
+
     stream_t* source = vlc_stream_NewURL( fetcher->owner, psz_arturl );
 
     if( !source )
@@ -355,11 +515,13 @@ static void RunDownloader(void *userdata)
 
 out:
     vlc_interrupt_set(NULL);
+    HostRelease(fetcher, task);
 
     if( psz_arturl )
     {
         var_SetAddress( fetcher->owner, "item-change", task->item );
         input_item_SetArtFetched( task->item, true );
+        SubmitVariants( fetcher, task->item );
     }
 
     free( psz_arturl );
@@ -370,6 +532,7 @@ out:
 
 error:
     vlc_interrupt_set(NULL);
+    HostRelease(fetcher, task);
 
     FREENULL( psz_arturl );
     NotifyArtFetchEnded(task, false);
@@ -391,7 +554,7 @@ static void RunSearchLocal(void *userdata)
         task->options & META_REQUEST_OPTION_FETCH_NETWORK )
     {
         int ret = Submit(fetcher, fetcher->executor_network, task->item,
-                         task->options, task->cbs, task->userdata);
+                         TaskGetOptions(task), task->cbs, task->userdata);
         if (ret != VLC_SUCCESS)
             NotifyArtFetchEnded(task, false);
     }
@@ -427,6 +590,22 @@ static void RunSearchNetwork(void *userdata)
     TaskDelete(task);
 }
 
+static void RunVariants(void *userdata)
+{
+    struct task *task = userdata;
+    input_fetcher_t *fetcher = task->fetcher;
+
+    vlc_interrupt_set(&task->interrupt);
+
+    if( input_MakeArtVariants( fetcher->owner, task->item ) == VLC_SUCCESS )
+        var_SetAddress( fetcher->owner, "item-change", task->item );
+
+    vlc_interrupt_set(NULL);
+
+    FetcherRemoveTask(fetcher, task);
+    TaskDelete(task);
+}
+
 input_fetcher_t* input_fetcher_New( vlc_object_t* owner )
 {
     input_fetcher_t* fetcher = malloc( sizeof( *fetcher ) );
@@ -462,8 +641,28 @@ input_fetcher_t* input_fetcher_New( vlc_object_t* owner )
         return NULL;
     }
 
+    /* Downscaling is not urgent, a single thread is enough */
+    fetcher->executor_variants = NULL;
+    if (var_InheritBool(owner, "fetch-art-variants"))
+    {
+        fetcher->executor_variants = vlc_executor_New(1);
+        if (!fetcher->executor_variants)
+        {
+            vlc_executor_Delete(fetcher->executor_downloader);
+            vlc_executor_Delete(fetcher->executor_network);
+            vlc_executor_Delete(fetcher->executor_local);
+            free(fetcher);
+            return NULL;
+        }
+    }
+
     fetcher->owner = owner;
 
+    int host_max = var_InheritInteger(owner, "fetch-art-host-limit");
+    fetcher->host_max = host_max > 0 ? host_max : 0;
+    vlc_dictionary_init(&fetcher->hosts, 0);
+    fetcher->closing = false;
+
     vlc_mutex_init(&fetcher->lock);
     vlc_list_init(&fetcher->submitted_tasks);
 
@@ -485,14 +684,52 @@ int input_fetcher_Push(input_fetcher_t* fetcher, input_item_t* item,
     return Submit(fetcher, executor, item, options, cbs, cbs_userdata);
 }
 
+void input_fetcher_Prioritize(input_fetcher_t *fetcher, input_item_t *item)
+{
+    vlc_mutex_lock(&fetcher->lock);
+
+    struct task *task;
+    vlc_list_foreach(task, &fetcher->submitted_tasks, node)
+    {
+        if (task->item != item)
+            continue;
+
+        /* Also prioritize the next steps of this request */
+        task->options |= META_REQUEST_OPTION_PRIORITY;
+
+        if (task->parked)
+        {
+            vlc_list_remove(&task->host_node);
+            vlc_list_prepend(&task->host_node, &task->host->waiting);
+        }
+        else
+            vlc_executor_Prioritize(task->executor, &task->runnable);
+    }
+
+    vlc_mutex_unlock(&fetcher->lock);
+}
+
 static void
 CancelAllTasks(input_fetcher_t *fetcher)
 {
     vlc_mutex_lock(&fetcher->lock);
 
+    /* Do not park downloads anymore */
+    fetcher->closing = true;
+
     struct task *task;
     vlc_list_foreach(task, &fetcher->submitted_tasks, node)
     {
+        if (task->parked)
+        {
+            /* Not queued in any executor */
+            vlc_list_remove(&task->host_node);
+            NotifyArtFetchEnded(task, false);
+            vlc_list_remove(&task->node);
+            TaskDelete(task);
+            continue;
+        }
+
         bool canceled = vlc_executor_Cancel(task->executor, &task->runnable);
         if (canceled)
         {
@@ -513,7 +750,11 @@ void input_fetcher_Delete( input_fetcher_t* fetcher )
     vlc_executor_Delete(fetcher->executor_local);
     vlc_executor_Delete(fetcher->executor_network);
     vlc_executor_Delete(fetcher->executor_downloader);
+    /* The downloads may not submit variants anymore, since closing is set */
+    if (fetcher->executor_variants)
+        vlc_executor_Delete(fetcher->executor_variants);
 
     vlc_dictionary_clear( &fetcher->album_cache, FreeCacheEntry, NULL );
+    vlc_dictionary_clear( &fetcher->hosts, FreeCacheEntry, NULL );
     free( fetcher );
 }
@@ -49,6 +49,13 @@ int input_fetcher_Push( input_fetcher_t *, input_item_t *,
                         input_item_meta_request_option_t,
                         const input_fetcher_callbacks_t *, void * );
 
+/**
+ * This function moves the pending requests of the item before the others.
+ *
+ * It is typically called when the item becomes visible to the user.
+ */
+void input_fetcher_Prioritize( input_fetcher_t *, input_item_t * );
+
 /**
  * This function destroys the fetcher object and thread.
  *
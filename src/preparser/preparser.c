@@ -30,6 +30,7 @@
 #include "input/input_internal.h"
 #include "preparser.h"
 #include "fetcher.h"
+#include "cache.h"
 
 struct input_preparser_t
 {
@@ -37,6 +38,7 @@ struct input_preparser_t
     input_fetcher_t* fetcher;
     vlc_executor_t *executor;
     vlc_tick_t default_timeout;
+    bool cache; /**< "preparse-cache" */
     atomic_bool deactivated;
 
     vlc_mutex_t lock;
@@ -54,6 +56,7 @@ struct task
     vlc_tick_t timeout;
 
     input_item_parser_id_t *parser;
+    input_item_node_t *subtree; /**< copy of the subitems, for the cache */
 
     vlc_mutex_t lock;
     vlc_cond_t cond_ended;
@@ -62,6 +65,7 @@ struct task
     bool fetch_ended;
 
     atomic_bool interrupted;
+    atomic_bool prioritized;
 
     struct vlc_runnable runnable; /**< to be passed to the executor */
 
@@ -93,6 +97,7 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
     input_item_Hold(item);
 
     task->parser = NULL;
+    task->subtree = NULL;
     vlc_mutex_init(&task->lock);
     vlc_cond_init(&task->cond_ended);
     task->preparse_ended = false;
@@ -100,6 +105,8 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
     task->fetch_ended = false;
 
     atomic_init(&task->interrupted, false);
+    atomic_init(&task->prioritized,
+                (options & META_REQUEST_OPTION_PRIORITY) != 0);
 
     task->runnable.run = RunnableRun;
     task->runnable.userdata = task;
@@ -110,6 +117,8 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
 static void
 TaskDelete(struct task *task)
 {
+    if (task->subtree)
+        input_item_node_Delete(task->subtree);
     input_item_Release(task->item);
     free(task);
 }
@@ -161,6 +170,26 @@ OnParserEnded(input_item_t *item, int status, void *task_)
     vlc_cond_signal(&task->cond_ended);
 }
 
+static input_item_node_t *
+SubtreeCopy(const input_item_node_t *node)
+{
+    input_item_node_t *copy = input_item_node_Create(node->p_item);
+    if (!copy)
+        return NULL;
+
+    for (int i = 0; i < node->i_children; i++)
+    {
+        input_item_node_t *child = SubtreeCopy(node->pp_children[i]);
+        if (!child)
+        {
+            input_item_node_Delete(copy);
+            return NULL;
+        }
+        input_item_node_AppendNode(copy, child);
+    }
+    return copy;
+}
+
 static void
 OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
                      void *task_)
@@ -168,6 +197,25 @@ OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
     VLC_UNUSED(item);
     struct task *task = task_;
 
+    if (task->preparser->cache)
+    {
+        /* The subtree is deleted once notified, keep the items for the
+         * cache entry. Large playlists are posted in several batches. */
+        input_item_node_t *copy = SubtreeCopy(subtree);
+        if (copy && task->subtree)
+        {
+            for (int i = 0; i < copy->i_children; i++)
+                input_item_node_AppendNode(task->subtree,
+                                           copy->pp_children[i]);
+            free(copy->pp_children);
+            copy->pp_children = NULL;
+            copy->i_children = 0;
+            input_item_node_Delete(copy);
+        }
+        else if (copy)
+            task->subtree = copy;
+    }
+
     if (task->cbs && task->cbs->on_subtree_added)
         task->cbs->on_subtree_added(task->item, subtree, task->userdata);
 }
@@ -241,9 +289,13 @@ Fetch(struct task *task)
     if (!fetcher || !(task->options & META_REQUEST_OPTION_FETCH_ANY))
         return;
 
+    input_item_meta_request_option_t options =
+        task->options & META_REQUEST_OPTION_FETCH_ANY;
+    if (atomic_load(&task->prioritized))
+        options |= META_REQUEST_OPTION_PRIORITY;
+
     int ret =
-        input_fetcher_Push(fetcher, task->item,
-                           task->options & META_REQUEST_OPTION_FETCH_ANY,
+        input_fetcher_Push(fetcher, task->item, options,
                            &input_fetcher_callbacks, task);
     if (ret != VLC_SUCCESS)
         return;
@@ -255,6 +307,28 @@ Fetch(struct task *task)
     vlc_mutex_unlock(&task->lock);
 }
 
+static bool
+LoadFromCache(struct task *task)
+{
+    if (!task->preparser->cache)
+        return false;
+
+    input_item_node_t *subtree;
+    if (input_preparser_cache_Load(task->preparser->owner, task->item,
+                                   &subtree) != VLC_SUCCESS)
+        return false;
+
+    if (subtree)
+    {
+        if (task->cbs && task->cbs->on_subtree_added)
+            task->cbs->on_subtree_added(task->item, subtree, task->userdata);
+        input_item_node_Delete(subtree);
+    }
+
+    task->preparse_status = ITEM_PREPARSE_DONE;
+    return true;
+}
+
 static void
 RunnableRun(void *userdata)
 {
@@ -266,10 +340,18 @@ RunnableRun(void *userdata)
     if (atomic_load(&task->interrupted))
         goto end;
 
-    Parse(task, deadline);
+    if (!LoadFromCache(task))
+    {
+        Parse(task, deadline);
 
-    if (atomic_load(&task->interrupted))
-        goto end;
+        if (atomic_load(&task->interrupted))
+            goto end;
+
+        if (task->preparser->cache
+         && task->preparse_status == ITEM_PREPARSE_DONE)
+            input_preparser_cache_Store(task->preparser->owner, task->item,
+                                        task->subtree);
+    }
 
     Fetch(task);
 
@@ -320,6 +402,7 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     if (preparser->default_timeout < 0)
         preparser->default_timeout = 0;
 
+    preparser->cache = var_InheritBool(parent, "preparse-cache");
     preparser->owner = parent;
     preparser->fetcher = input_fetcher_New( parent );
     atomic_init( &preparser->deactivated, false );
@@ -372,7 +455,10 @@ int input_preparser_Push( input_preparser_t *preparser,
 
     PreparserAddTask(preparser, task);
 
-    vlc_executor_Submit(preparser->executor, &task->runnable);
+    if( i_options & META_REQUEST_OPTION_PRIORITY )
+        vlc_executor_SubmitUrgent(preparser->executor, &task->runnable);
+    else
+        vlc_executor_Submit(preparser->executor, &task->runnable);
     return VLC_SUCCESS;
 }
 
@@ -411,6 +497,29 @@ void input_preparser_Cancel( input_preparser_t *preparser, void *id )
     vlc_mutex_unlock(&preparser->lock);
 }
 
+void input_preparser_Prioritize( input_preparser_t *preparser, void *id )
+{
+    vlc_mutex_lock(&preparser->lock);
+
+    struct task *task;
+    vlc_list_foreach(task, &preparser->submitted_tasks, node)
+    {
+        if (task->id != id)
+            continue;
+
+        /* Read by Fetch(), so that the art request is prioritized too */
+        atomic_store(&task->prioritized, true);
+
+        bool queued =
+            vlc_executor_Prioritize(preparser->executor, &task->runnable);
+        if (!queued && preparser->fetcher)
+            /* Already running, the art may be being fetched */
+            input_fetcher_Prioritize(preparser->fetcher, task->item);
+    }
+
+    vlc_mutex_unlock(&preparser->lock);
+}
+
 void input_preparser_Deactivate( input_preparser_t* preparser )
 {
     atomic_store( &preparser->deactivated, true );
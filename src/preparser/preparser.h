@@ -72,6 +72,12 @@ void input_preparser_fetcher_Push( input_preparser_t *, input_item_t *,
  */
 void input_preparser_Cancel( input_preparser_t *, void *id );
 
+/**
+ * This function moves the requests for a given id before the others
+ * @param id unique id given to input_preparser_Push()
+ */
+void input_preparser_Prioritize( input_preparser_t *, void *id );
+
 /**
  * This function destroys the preparser object and thread.
  *
@@ -23,6 +23,7 @@
 #endif
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #undef NDEBUG
 #include <assert.h>
@@ -86,11 +87,178 @@ static void test_block (void)
     //assert (block == NULL);
 }
 
+static void test_block_shared(void)
+{
+    block_t *block = block_Alloc(sizeof (text));
+    assert(block != NULL);
+    memcpy(block->p_buffer, text, sizeof (text));
+    block->i_pts = 42;
+
+    block_t *a = block_MakeShared(block);
+    assert(a != NULL);
+    block_t *b = block_Share(a);
+    assert(b != NULL);
+    assert(b->p_buffer == a->p_buffer);
+    assert(b->i_buffer == sizeof (text));
+    assert(b->i_pts == 42);
+
+    /* Trimming keeps the payload shared */
+    b = block_Realloc(b, -5, sizeof (text));
+    assert(b != NULL);
+    assert(b->p_buffer == a->p_buffer + 5);
+    assert(b->i_buffer == sizeof (text) - 5);
+
+    /* Growing copies */
+    b = block_Realloc(b, 5, sizeof (text) - 5);
+    assert(b != NULL);
+    assert(b->i_buffer == sizeof (text));
+    assert(b->p_buffer != a->p_buffer);
+    assert(!memcmp(b->p_buffer + 5, text + 5, sizeof (text) - 5));
+    block_Release(b);
+
+    b = block_Share(a);
+    assert(b != NULL);
+    b = block_MakeWritable(b);
+    assert(b != NULL);
+    assert(b->p_buffer != a->p_buffer);
+    assert(b->i_pts == 42);
+    memset(b->p_buffer, 0, b->i_buffer);
+    assert(!memcmp(a->p_buffer, text, sizeof (text)));
+    block_Release(b);
+
+    /* The last view owns the payload */
+    const uint8_t *payload = a->p_buffer;
+    a = block_MakeWritable(a);
+    assert(a != NULL);
+    assert(a->p_buffer == payload);
+    block_Release(a);
+}
+
+static void *test_block_pool_thread(void *data)
+{
+    block_t **blocks = data;
+
+    /* Released by the main thread, after this thread exits */
+    for (unsigned i = 0; i < 16; i++)
+    {
+        blocks[i] = block_Alloc(100 * i);
+        assert(blocks[i] != NULL);
+    }
+    return NULL;
+}
+
+static void test_block_pool(void)
+{
+    uint64_t hits, misses;
+
+    for (unsigned i = 0; i < 1024; i++)
+    {
+        block_t *block = block_Alloc(i & 1 ? 188 : 1500);
+        assert(block != NULL);
+        assert(((uintptr_t)block->p_buffer % 32) == 0);
+        memset(block->p_buffer, 0xA5, block->i_buffer);
+        block = block_Realloc(block, 16, block->i_buffer);
+        assert(block != NULL);
+        block_Release(block);
+    }
+
+    block_PoolStats(&hits, &misses);
+    assert(hits > 0);
+    assert(misses > 0);
+    assert(hits > misses);
+
+    block_t *blocks[16];
+    vlc_thread_t th;
+    int ret = vlc_clone(&th, test_block_pool_thread, blocks,
+                        VLC_THREAD_PRIORITY_LOW);
+    assert(ret == 0);
+    vlc_join(th, NULL);
+
+    for (unsigned i = 0; i < 16; i++)
+        block_Release(blocks[i]);
+
+    /* Larger than any size class */
+    block_t *block = block_Alloc(1 << 20);
+    assert(block != NULL);
+    memset(block->p_buffer, 0, block->i_buffer);
+    block_Release(block);
+}
+
+static void *test_block_spsc_thread(void *data)
+{
+    block_spsc_t *q = data;
+
+    for (unsigned i = 0; i < 10000; i++)
+    {
+        block_t *block = block_Alloc(i % 100);
+        assert(block != NULL);
+        block->i_dts = i;
+        block_SpscPut(q, block);
+    }
+    block_SpscKill(q);
+    return NULL;
+}
+
+static void test_block_spsc(void)
+{
+    block_spsc_t *q = block_SpscNew(5);
+    assert(q != NULL);
+    assert(block_SpscTryGet(q) == NULL);
+    assert(block_SpscGetCount(q) == 0);
+
+    block_t *chain = NULL;
+    block_t **pp = &chain;
+    for (unsigned i = 0; i < 3; i++)
+    {
+        *pp = block_Alloc(10);
+        assert(*pp != NULL);
+        pp = &(*pp)->p_next;
+    }
+    block_SpscPut(q, chain);
+    assert(block_SpscGetCount(q) == 3);
+    assert(block_SpscGetBytes(q) == 30);
+    for (unsigned i = 0; i < 3; i++)
+    {
+        block_t *block = block_SpscTryGet(q);
+        assert(block != NULL);
+        assert(block->p_next == NULL);
+        block_Release(block);
+    }
+    assert(block_SpscGetBytes(q) == 0);
+
+    vlc_thread_t th;
+    int ret = vlc_clone(&th, test_block_spsc_thread, q,
+                        VLC_THREAD_PRIORITY_LOW);
+    assert(ret == 0);
+
+    block_t *block;
+    unsigned count = 0;
+    while ((block = block_SpscGet(q)) != NULL)
+    {
+        assert(block->i_dts == (vlc_tick_t)count);
+        assert(block->i_buffer == count % 100);
+        block_Release(block);
+        count++;
+    }
+    assert(count == 10000);
+    vlc_join(th, NULL);
+
+    /* Queued blocks are released along with the FIFO */
+    block_SpscKill(q);
+    block_SpscPut(q, block_Alloc(10));
+    block_SpscRelease(q);
+}
+
 int main (void)
 {
+    setenv("VLC_BLOCK_POOL", "1", 1);
+
     test_block_File(false);
     test_block_File(true);
     test_block ();
+    test_block_shared();
+    test_block_pool();
+    test_block_spsc();
     return 0;
 }
 
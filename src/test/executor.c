@@ -271,6 +271,178 @@ static void test_task_chain(void)
         assert(array[i] == 2 * i);
 }
 
+struct order_data
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    bool blocked;
+    int count;
+    int order[4];
+};
+
+static void RunBlock(void *userdata)
+{
+    struct order_data *data = userdata;
+
+    vlc_mutex_lock(&data->lock);
+    data->blocked = true;
+    vlc_cond_signal(&data->cond);
+    while (data->blocked)
+        vlc_cond_wait(&data->cond, &data->lock);
+    vlc_mutex_unlock(&data->lock);
+}
+
+struct order_task
+{
+    struct order_data *data;
+    int id;
+    struct vlc_runnable runnable;
+};
+
+static void RunOrder(void *userdata)
+{
+    struct order_task *task = userdata;
+    struct order_data *data = task->data;
+
+    vlc_mutex_lock(&data->lock);
+    assert(data->count < 4);
+    data->order[data->count++] = task->id;
+    vlc_mutex_unlock(&data->lock);
+}
+
+static void test_urgent(void)
+{
+    vlc_executor_t *executor = vlc_executor_New(1);
+    assert(executor);
+
+    struct order_data data;
+    vlc_mutex_init(&data.lock);
+    vlc_cond_init(&data.cond);
+    data.blocked = false;
+    data.count = 0;
+
+    /* Keep the only thread busy while queuing */
+    struct vlc_runnable blocker = {
+        .run = RunBlock,
+        .userdata = &data,
+    };
+    vlc_executor_Submit(executor, &blocker);
+
+    vlc_mutex_lock(&data.lock);
+    while (!data.blocked)
+        vlc_cond_wait(&data.cond, &data.lock);
+    vlc_mutex_unlock(&data.lock);
+
+    struct order_task tasks[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        tasks[i].data = &data;
+        tasks[i].id = i;
+        tasks[i].runnable.run = RunOrder;
+        tasks[i].runnable.userdata = &tasks[i];
+    }
+
+    vlc_executor_Submit(executor, &tasks[0].runnable);
+    vlc_executor_Submit(executor, &tasks[1].runnable);
+    vlc_executor_SubmitUrgent(executor, &tasks[2].runnable);
+    vlc_executor_SubmitUrgent(executor, &tasks[3].runnable);
+
+    struct vlc_executor_stats stats;
+    vlc_executor_GetStats(executor, &stats);
+    assert(stats.threads == 1);
+    assert(stats.queued == 4);
+    assert(stats.running == 1);
+
+    /* Canceling an urgent runnable does not affect the others */
+    bool canceled = vlc_executor_Cancel(executor, &tasks[3].runnable);
+    assert(canceled);
+
+    vlc_mutex_lock(&data.lock);
+    data.blocked = false;
+    vlc_cond_signal(&data.cond);
+    vlc_mutex_unlock(&data.lock);
+
+    vlc_executor_WaitIdle(executor);
+
+    assert(data.count == 3);
+    assert(data.order[0] == 2);
+    assert(data.order[1] == 0);
+    assert(data.order[2] == 1);
+
+    vlc_executor_GetStats(executor, &stats);
+    assert(stats.queued == 0);
+    assert(stats.running == 0);
+    assert(stats.executed == 4);
+    assert(stats.steals == 0);
+    assert(stats.latency_max >= stats.latency_avg);
+
+    vlc_executor_Delete(executor);
+}
+
+static void test_prioritize(void)
+{
+    vlc_executor_t *executor = vlc_executor_New(1);
+    assert(executor);
+
+    struct order_data data;
+    vlc_mutex_init(&data.lock);
+    vlc_cond_init(&data.cond);
+    data.blocked = false;
+    data.count = 0;
+
+    /* Keep the only thread busy while queuing */
+    struct vlc_runnable blocker = {
+        .run = RunBlock,
+        .userdata = &data,
+    };
+    vlc_executor_Submit(executor, &blocker);
+
+    vlc_mutex_lock(&data.lock);
+    while (!data.blocked)
+        vlc_cond_wait(&data.cond, &data.lock);
+    vlc_mutex_unlock(&data.lock);
+
+    struct order_task tasks[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        tasks[i].data = &data;
+        tasks[i].id = i;
+        tasks[i].runnable.run = RunOrder;
+        tasks[i].runnable.userdata = &tasks[i];
+    }
+
+    vlc_executor_Submit(executor, &tasks[0].runnable);
+    vlc_executor_Submit(executor, &tasks[1].runnable);
+    vlc_executor_SubmitUrgent(executor, &tasks[2].runnable);
+    vlc_executor_Submit(executor, &tasks[3].runnable);
+
+    /* Prioritized after the urgent ones, before the others */
+    bool queued = vlc_executor_Prioritize(executor, &tasks[3].runnable);
+    assert(queued);
+    /* No effect on an urgent runnable */
+    queued = vlc_executor_Prioritize(executor, &tasks[2].runnable);
+    assert(queued);
+
+    vlc_mutex_lock(&data.lock);
+    data.blocked = false;
+    vlc_cond_signal(&data.cond);
+    vlc_mutex_unlock(&data.lock);
+
+    vlc_executor_WaitIdle(executor);
+
+    assert(data.count == 4);
+    assert(data.order[0] == 2);
+    assert(data.order[1] == 3);
+    assert(data.order[2] == 0);
+    assert(data.order[3] == 1);
+
+    /* Already executed */
+    queued = vlc_executor_Prioritize(executor, &tasks[0].runnable);
+    assert(!queued);
+
+    vlc_executor_Delete(executor);
+}
+
 int main(void)
 {
     test_single_runnable();
@@ -278,5 +450,7 @@ int main(void)
     test_blocking_delete();
     test_cancel();
     test_task_chain();
+    test_urgent();
+    test_prioritize();
     return 0;
 }
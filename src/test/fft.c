@@ -0,0 +1,137 @@
+/*****************************************************************************
+ * fft.c: real FFT test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vlc_common.h>
+#include <vlc_fft.h>
+
+#define MAX_SIZE 4096
+
+static float in[MAX_SIZE], other[MAX_SIZE], out[MAX_SIZE];
+static float spectrum[MAX_SIZE + 2], spectrum2[MAX_SIZE + 2];
+
+static void Fill(float *buf, size_t n)
+{
+    for (size_t i = 0; i < n; i++)
+        buf[i] = (double)rand() / RAND_MAX * 2. - 1.;
+}
+
+static void test_forward(const vlc_rdft_t *plan)
+{
+    const size_t n = vlc_rdft_GetSize(plan);
+
+    Fill(in, n);
+    vlc_rdft_Forward(plan, in, spectrum);
+
+    /* Against the definition, on a few bins for the large sizes */
+    const size_t step = n > 256 ? n / 64 : 1;
+    for (size_t k = 0; k <= n / 2; k += step)
+    {
+        double re = 0., im = 0.;
+        for (size_t i = 0; i < n; i++)
+        {
+            double a = -2. * M_PI * i * k / n;
+            re += in[i] * cos(a);
+            im += in[i] * sin(a);
+        }
+        double tolerance = 1e-4 * sqrt(n);
+        assert(fabs(spectrum[2 * k] - re) < tolerance);
+        assert(fabs(spectrum[2 * k + 1] - im) < tolerance);
+    }
+    assert(spectrum[1] == 0.f && spectrum[n + 1] == 0.f);
+}
+
+static void test_inverse(const vlc_rdft_t *plan)
+{
+    const size_t n = vlc_rdft_GetSize(plan);
+
+    Fill(in, n);
+    vlc_rdft_Forward(plan, in, spectrum);
+    memcpy(spectrum2, spectrum, sizeof (spectrum2));
+    vlc_rdft_Inverse(plan, spectrum, out);
+
+    /* The spectrum is not modified */
+    assert(memcmp(spectrum, spectrum2, (n + 2) * sizeof (float)) == 0);
+    for (size_t i = 0; i < n; i++)
+        assert(fabsf(out[i] - in[i]) < 1e-5f);
+}
+
+static void test_correlate(const vlc_rdft_t *plan)
+{
+    const size_t n = vlc_rdft_GetSize(plan);
+    const size_t len = n / 4, lags = n / 2;
+
+    /* Zero-padded so that the lags of interest do not wrap around */
+    memset(in, 0, n * sizeof (float));
+    Fill(in, len);
+    Fill(other, n);
+    for (size_t i = len + lags; i < n; i++)
+        other[i] = 0.f;
+
+    vlc_rdft_Forward(plan, in, spectrum);
+    vlc_rdft_Forward(plan, other, spectrum2);
+    vlc_rdft_Correlate(plan, spectrum, spectrum2, spectrum);
+    vlc_rdft_Inverse(plan, spectrum, out);
+
+    for (size_t lag = 0; lag < lags; lag++)
+    {
+        double corr = 0.;
+        for (size_t i = 0; i < len; i++)
+            corr += in[i] * other[i + lag];
+        assert(fabs(out[lag] - corr) < 1e-4 * len);
+    }
+}
+
+int main(void)
+{
+    srand(42);
+
+    for (size_t n = 4; n <= MAX_SIZE; n *= 2)
+    {
+        vlc_rdft_t *plan = vlc_rdft_Hold(n);
+        assert(plan != NULL);
+        assert(vlc_rdft_GetSize(plan) == n);
+
+        /* Plans are shared by size */
+        vlc_rdft_t *same = vlc_rdft_Hold(n);
+        assert(same == plan);
+        vlc_rdft_Release(same);
+
+        test_forward(plan);
+        test_inverse(plan);
+        test_correlate(plan);
+        vlc_rdft_Release(plan);
+    }
+
+    assert(vlc_rdft_Hold(0) == NULL);
+    assert(vlc_rdft_Hold(2) == NULL);
+    assert(vlc_rdft_Hold(1000) == NULL);
+    return 0;
+}
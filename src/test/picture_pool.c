@@ -31,6 +31,7 @@
 #include <vlc_picture_pool.h>
 
 #define PICTURES 10
+#define LARGE_PICTURES 150 /* more than one word of availability bits */
 
 const char vlc_module_name[] = "test_picture_pool";
 
@@ -108,6 +109,43 @@ static void test(bool zombie)
             picture_Release(pics[i]);
 }
 
+static void test_large(void)
+{
+    picture_t *pics[LARGE_PICTURES];
+
+    pool = picture_pool_NewFromFormat(&fmt, LARGE_PICTURES);
+    assert(pool != NULL);
+    assert(picture_pool_GetSize(pool) == LARGE_PICTURES);
+
+    for (unsigned i = 0; i < LARGE_PICTURES; i++) {
+        pics[i] = picture_pool_Get(pool);
+        assert(pics[i] != NULL);
+        for (unsigned j = 0; j < i; j++)
+            assert(pics[j]->p[0].p_pixels != pics[i]->p[0].p_pixels);
+    }
+    assert(picture_pool_Get(pool) == NULL);
+
+    /* A picture from the last word comes back */
+    void *plane = pics[LARGE_PICTURES - 1]->p[0].p_pixels;
+    picture_Release(pics[LARGE_PICTURES - 1]);
+    pics[LARGE_PICTURES - 1] = picture_pool_Wait(pool);
+    assert(pics[LARGE_PICTURES - 1] != NULL);
+    assert(pics[LARGE_PICTURES - 1]->p[0].p_pixels == plane);
+
+    for (unsigned i = 0; i < LARGE_PICTURES; i++)
+        picture_Release(pics[i]);
+
+    reserve = picture_pool_Reserve(pool, LARGE_PICTURES - 1);
+    assert(reserve != NULL);
+    pics[0] = picture_pool_Get(pool);
+    assert(pics[0] != NULL);
+    assert(picture_pool_Get(pool) == NULL);
+    picture_Release(pics[0]);
+
+    picture_pool_Release(reserve);
+    picture_pool_Release(pool);
+}
+
 int main(void)
 {
     video_format_Setup(&fmt, VLC_CODEC_I420, 320, 200, 320, 200, 1, 1);
@@ -123,6 +161,7 @@ int main(void)
 
     test(false);
     test(true);
+    test_large();
 
     return 0;
 }
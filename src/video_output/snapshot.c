@@ -91,17 +91,22 @@ void vout_snapshot_End(vout_snapshot_t *snap)
 }
 
 /* */
-picture_t *vout_snapshot_Get(vout_snapshot_t *snap, vlc_tick_t timeout)
+void vout_snapshot_Request(vout_snapshot_t *snap)
 {
     if (snap == NULL)
-        return NULL;
-
-    const vlc_tick_t deadline = vlc_tick_now() + timeout;
+        return;
 
     vlc_mutex_lock(&snap->lock);
-
-    /* */
     snap->request_count++;
+    vlc_mutex_unlock(&snap->lock);
+}
+
+picture_t *vout_snapshot_Wait(vout_snapshot_t *snap, vlc_tick_t deadline)
+{
+    if (snap == NULL)
+        return NULL;
+
+    vlc_mutex_lock(&snap->lock);
 
     /* */
     while (snap->is_available && vlc_picture_chain_IsEmpty( &snap->pics ) &&
@@ -117,6 +122,14 @@ picture_t *vout_snapshot_Get(vout_snapshot_t *snap, vlc_tick_t timeout)
     return picture;
 }
 
+picture_t *vout_snapshot_Get(vout_snapshot_t *snap, vlc_tick_t timeout)
+{
+    const vlc_tick_t deadline = vlc_tick_now() + timeout;
+
+    vout_snapshot_Request(snap);
+    return vout_snapshot_Wait(snap, deadline);
+}
+
 bool vout_snapshot_IsRequested(vout_snapshot_t *snap)
 {
     if (snap == NULL)
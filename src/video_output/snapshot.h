@@ -36,6 +36,18 @@ void vout_snapshot_End(vout_snapshot_t *);
 /* */
 picture_t *vout_snapshot_Get(vout_snapshot_t *, vlc_tick_t timeout);
 
+/**
+ * It requests a snapshot without waiting for it.
+ *
+ * The picture must then be retrieved with vout_snapshot_Wait().
+ */
+void vout_snapshot_Request(vout_snapshot_t *);
+
+/**
+ * It waits until the given date for a requested snapshot.
+ */
+picture_t *vout_snapshot_Wait(vout_snapshot_t *, vlc_tick_t deadline);
+
 /**
  * It tells if they are pending snapshot request
  */
@@ -49,6 +49,7 @@
 #include <vlc_plugin.h>
 #include <vlc_codec.h>
 #include <vlc_atomic.h>
+#include <vlc_tracer.h>
 
 #include <libvlc.h>
 #include "vout_private.h"
@@ -87,6 +88,11 @@ typedef struct vout_thread_sys_t
 
     /* Snapshot interface */
     struct vout_snapshot *snapshot;
+    struct {
+        filter_chain_t  *chain; /* to RGB32 */
+        vlc_blender_t   *blend;
+        video_format_t  fmt;    /* source format of the chain */
+    } snapshot_cvt;
 
     /* Statistics */
     vout_statistic_t statistic;
@@ -146,6 +152,13 @@ typedef struct vout_thread_sys_t
     vout_display_t *display;
     vlc_mutex_t     display_lock;
 
+    /* Refresh cycles, as reported by the display */
+    struct {
+        vlc_mutex_t lock;
+        vlc_tick_t  date; /* last vertical blanking */
+        vlc_tick_t  period;
+    } vblank;
+
     /* Video filter2 chain */
     struct {
         vlc_mutex_t     lock;
@@ -512,6 +525,33 @@ int vout_GetSnapshot(vout_thread_t *vout,
     return VLC_SUCCESS;
 }
 
+size_t vout_GetSnapshots(vout_thread_t *const *vouts, size_t count,
+                         picture_t **pictures, vlc_tick_t timeout)
+{
+    const vlc_tick_t deadline = vlc_tick_now() + timeout;
+    size_t grabbed = 0;
+
+    /* Request all the snapshots first, so that the video outputs render
+     * them concurrently */
+    for (size_t i = 0; i < count; i++)
+    {
+        vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vouts[i]);
+        assert(!sys->dummy);
+        vout_snapshot_Request(sys->snapshot);
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vouts[i]);
+        pictures[i] = vout_snapshot_Wait(sys->snapshot, deadline);
+        if (pictures[i] != NULL)
+            grabbed++;
+        else
+            msg_Err(vouts[i], "Failed to grab a snapshot");
+    }
+    return grabbed;
+}
+
 /* vout_Control* are usable by anyone at anytime */
 void vout_ChangeFullscreen(vout_thread_t *vout, const char *id)
 {
@@ -711,6 +751,21 @@ void vout_ChangeSpuChannelMargin(vout_thread_t *vout,
         spu_ChangeChannelOrderMargin(sys->spu, order, margin);
 }
 
+void vout_ReportVblank(vout_thread_t *vout, vlc_tick_t date,
+                       vlc_tick_t period)
+{
+    vout_thread_sys_t *sys = VOUT_THREAD_TO_SYS(vout);
+
+    /* Ignore nonsensical rates, from 10 to 500 Hz */
+    if (period < VLC_TICK_FROM_MS(2) || period > VLC_TICK_FROM_MS(100))
+        return;
+
+    vlc_mutex_lock(&sys->vblank.lock);
+    sys->vblank.date = date;
+    sys->vblank.period = period;
+    vlc_mutex_unlock(&sys->vblank.lock);
+}
+
 void vout_ChangeViewpoint(vout_thread_t *vout,
                           const vlc_viewpoint_t *p_viewpoint)
 {
@@ -1045,16 +1100,28 @@ static const struct filter_video_callbacks vout_video_cbs = {
     NULL, VoutHoldDecoderDevice,
 };
 
-static picture_t *ConvertRGB32AndBlend(vout_thread_sys_t *vout, picture_t *pic,
-                                     subpicture_t *subpic)
+static void SnapshotConverterClean(vout_thread_sys_t *sys)
+{
+    if (sys->snapshot_cvt.blend != NULL)
+        filter_DeleteBlend(sys->snapshot_cvt.blend);
+    if (sys->snapshot_cvt.chain != NULL)
+        filter_chain_Delete(sys->snapshot_cvt.chain);
+    sys->snapshot_cvt.blend = NULL;
+    sys->snapshot_cvt.chain = NULL;
+}
+
+/* The converter and blender are kept until the source format changes, as
+ * snapshots may be requested for every picture */
+static int SnapshotConverterUpdate(vout_thread_sys_t *vout,
+                                   const es_format_t *src_fmt)
 {
     vout_thread_sys_t *sys = vout;
-    /* This function will convert the pic to RGB32 and blend the subpic to it.
-     * The returned pic can't be used to display since the chroma will be
-     * different than the "vout display" one, but it can be used for snapshots.
-     * */
 
-    assert(sys->spu_blend);
+    if (sys->snapshot_cvt.chain != NULL &&
+        video_format_IsSimilar(&sys->snapshot_cvt.fmt, &src_fmt->video))
+        return VLC_SUCCESS;
+
+    SnapshotConverterClean(sys);
 
     filter_owner_t owner = {
         .video = &vout_video_cbs,
@@ -1062,9 +1129,9 @@ static picture_t *ConvertRGB32AndBlend(vout_thread_sys_t *vout, picture_t *pic,
     };
     filter_chain_t *filterc = filter_chain_NewVideo(&vout->obj, false, &owner);
     if (!filterc)
-        return NULL;
+        return VLC_EGENERIC;
 
-    es_format_t src = sys->spu_blend->fmt_out;
+    es_format_t src = *src_fmt;
     es_format_t dst = src;
     dst.video.i_chroma = VLC_CODEC_RGB32;
     video_format_FixRgb(&dst.video);
@@ -1076,28 +1143,70 @@ static picture_t *ConvertRGB32AndBlend(vout_thread_sys_t *vout, picture_t *pic,
     if (filter_chain_AppendConverter(filterc, &dst) != 0)
     {
         filter_chain_Delete(filterc);
-        return NULL;
+        return VLC_EGENERIC;
     }
 
+    vlc_blender_t *swblend = filter_NewBlend(VLC_OBJECT(&vout->obj), &dst.video);
+    if (!swblend)
+    {
+        filter_chain_Delete(filterc);
+        return VLC_EGENERIC;
+    }
+
+    sys->snapshot_cvt.chain = filterc;
+    sys->snapshot_cvt.blend = swblend;
+    sys->snapshot_cvt.fmt = src_fmt->video;
+    return VLC_SUCCESS;
+}
+
+static picture_t *ConvertRGB32AndBlend(vout_thread_sys_t *vout, picture_t *pic,
+                                     subpicture_t *subpic)
+{
+    vout_thread_sys_t *sys = vout;
+    /* This function will convert the pic to RGB32 and blend the subpic to it.
+     * The returned pic can't be used to display since the chroma will be
+     * different than the "vout display" one, but it can be used for snapshots.
+     * */
+
+    assert(sys->spu_blend);
+
+    if (SnapshotConverterUpdate(vout, &sys->spu_blend->fmt_out))
+        return NULL;
+
     picture_Hold(pic);
-    pic = filter_chain_VideoFilter(filterc, pic);
-    filter_chain_Delete(filterc);
+    pic = filter_chain_VideoFilter(sys->snapshot_cvt.chain, pic);
 
     if (pic)
     {
-        vlc_blender_t *swblend = filter_NewBlend(VLC_OBJECT(&vout->obj), &dst.video);
-        if (swblend)
-        {
-            bool success = picture_BlendSubpicture(pic, swblend, subpic) > 0;
-            filter_DeleteBlend(swblend);
-            if (success)
-                return pic;
-        }
+        if (picture_BlendSubpicture(pic, sys->snapshot_cvt.blend, subpic) > 0)
+            return pic;
         picture_Release(pic);
     }
     return NULL;
 }
 
+/**
+ * Moves a display date to the middle of the refresh cycle ending with the
+ * vertical blanking nearest to it. The picture is then handed to the display
+ * within the cycle in which it is shown, whatever the wake-up jitter, and
+ * the cadence (3:2 for 24 fps on 60 Hz) does not drift with the clock.
+ */
+static vlc_tick_t ThreadVblankDate(vout_thread_sys_t *sys, vlc_tick_t date)
+{
+    vlc_mutex_lock(&sys->vblank.lock);
+    const vlc_tick_t last = sys->vblank.date;
+    const vlc_tick_t period = sys->vblank.period;
+    vlc_mutex_unlock(&sys->vblank.lock);
+
+    if (last == VLC_TICK_INVALID)
+        return date;
+
+    vlc_tick_t diff = date - last;
+    vlc_tick_t cycles = diff >= 0 ? (diff + period / 2) / period
+                                  : -((period / 2 - diff) / period);
+    return last + cycles * period - period / 2;
+}
+
 static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool render_now)
 {
     vout_thread_sys_t *sys = vout;
@@ -1288,6 +1397,8 @@ static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool render_now)
 
     if (vd->ops->prepare != NULL)
         vd->ops->prepare(vd, todisplay, do_dr_spu ? subpic : NULL, system_pts);
+    vlc_tracer_Trace(vlc_object_get_tracer(vd), VLC_TRACER_VOUT_PREPARE,
+                     vout, pts, 0);
 
     vout_chrono_Stop(&sys->render);
 #if 0
@@ -1302,7 +1413,8 @@ static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool render_now)
     system_now = vlc_tick_now();
     if (!render_now)
     {
-        const vlc_tick_t late = system_now - system_pts;
+        const vlc_tick_t wait_date = ThreadVblankDate(sys, system_pts);
+        const vlc_tick_t late = system_now - __MAX(system_pts, wait_date);
         if (unlikely(late > 0))
         {
             msg_Dbg(vd, "picture displayed late (missing %"PRId64" ms)", MS_FROM_VLC_TICK(late));
@@ -1314,8 +1426,10 @@ static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool render_now)
         }
         else
         {
-            /* Wait to reach system_pts */
-            vlc_clock_Wait(sys->clock, system_now, pts, sys->rate,
+            /* Wait to reach system_pts, or its refresh cycle */
+            const vlc_tick_t wait_pts =
+                pts + (vlc_tick_t)((wait_date - system_pts) * sys->rate);
+            vlc_clock_Wait(sys->clock, system_now, wait_pts, sys->rate,
                            VOUT_REDISPLAY_DELAY);
 
             /* Don't touch system_pts. Tell the clock that the pts was rendered
@@ -1334,6 +1448,8 @@ static int ThreadDisplayRenderPicture(vout_thread_sys_t *vout, bool render_now)
 
     /* Display the direct buffer returned by vout_RenderPicture */
     vout_display_Display(vd, todisplay);
+    vlc_tracer_Trace(vlc_object_get_tracer(vd), VLC_TRACER_VOUT_DISPLAY,
+                     vout, pts, 0);
     vlc_mutex_unlock(&sys->display_lock);
 
     if (subpic)
@@ -1692,6 +1808,10 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
     dcfg.window_props.width = sys->window_width;
     dcfg.window_props.height = sys->window_height;
 
+    vlc_mutex_lock(&sys->vblank.lock);
+    sys->vblank.date = VLC_TICK_INVALID;
+    vlc_mutex_unlock(&sys->vblank.lock);
+
     sys->display = vout_OpenWrapper(&vout->obj, &sys->private, sys->splitter_name, &dcfg,
                                     &sys->original, vctx);
     if (sys->display == NULL) {
@@ -1722,6 +1842,9 @@ static int vout_Start(vout_thread_sys_t *vout, vlc_video_context *vctx, const vo
     sys->spu_blend_chroma        = 0;
     sys->spu_blend               = NULL;
 
+    sys->snapshot_cvt.chain      = NULL;
+    sys->snapshot_cvt.blend      = NULL;
+
     video_format_Print(VLC_OBJECT(&vout->obj), "original format", &sys->original);
     return VLC_SUCCESS;
 error:
@@ -1800,6 +1923,7 @@ static void vout_ReleaseDisplay(vout_thread_sys_t *vout)
 
     if (sys->spu_blend != NULL)
         filter_DeleteBlend(sys->spu_blend);
+    SnapshotConverterClean(sys);
 
     /* Destroy the rendering display */
     if (sys->private.display_pool != NULL)
@@ -2008,6 +2132,8 @@ vout_thread_t *vout_Create(vlc_object_t *object)
     /* Display */
     sys->display = NULL;
     vlc_mutex_init(&sys->display_lock);
+    vlc_mutex_init(&sys->vblank.lock);
+    sys->vblank.date = VLC_TICK_INVALID;
 
     /* Window */
     sys->window_width = sys->window_height = 0;
@@ -161,6 +161,7 @@ void vout_ControlChangeSubSources(vout_thread_t *, const char *);
 void vout_ControlChangeSubFilters(vout_thread_t *, const char *);
 void vout_ChangeSpuChannelMargin(vout_thread_t *, enum vlc_vout_order order, int);
 void vout_ChangeViewpoint( vout_thread_t *, const vlc_viewpoint_t *);
+void vout_ReportVblank(vout_thread_t *, vlc_tick_t date, vlc_tick_t period);
 
 /* */
 void vout_CreateVars( vout_thread_t * );
@@ -60,10 +60,21 @@ typedef struct {
     vlc_tick_t stop;  /* set to subpicture at rendering time */
     bool is_late;
     enum vlc_vout_order channel_order;
+    uint64_t id; /* unique for each subpicture pushed */
 } spu_render_entry_t;
 
 typedef struct VLC_VECTOR(spu_render_entry_t) spu_render_vector;
 
+/* What the rendering of one subpicture depends on */
+struct spu_render_key {
+    uint64_t id;
+    unsigned update_count;
+    int alpha;
+    enum vlc_vout_order channel_order;
+};
+
+typedef struct VLC_VECTOR(struct spu_render_key) spu_render_key_vector;
+
 struct spu_channel {
     spu_render_vector entries;
     size_t id;
@@ -129,12 +140,25 @@ struct spu_private_t {
         bool            live;
     } prerender;
 
+    /* Last rendered subpicture, reused as long as the same subpictures are
+     * rendered with the same settings */
+    struct
+    {
+        spu_render_key_vector keys;
+        subpicture_t    *output;
+        video_format_t  fmtdst;
+        const vlc_fourcc_t *chroma_list;
+        bool            external_scale;
+        bool            valid;
+    } cache;
+    uint64_t            next_id;
+
     /* */
     vlc_tick_t          last_sort_date;
     vout_thread_t       *vout;
 };
 
-static void spu_PrerenderSync(spu_private_t *, const subpicture_t *);
+static bool spu_PrerenderIsDone(spu_private_t *, const subpicture_t *);
 static void spu_PrerenderCancel(spu_private_t *, const subpicture_t *);
 
 static void spu_channel_Init(struct spu_channel *channel, size_t id,
@@ -150,7 +174,8 @@ static void spu_channel_Init(struct spu_channel *channel, size_t id,
 }
 
 static int spu_channel_Push(struct spu_channel *channel, subpicture_t *subpic,
-                            vlc_tick_t orgstart, vlc_tick_t orgstop)
+                            vlc_tick_t orgstart, vlc_tick_t orgstop,
+                            uint64_t id)
 {
     const spu_render_entry_t entry = {
         .subpic = subpic,
@@ -158,6 +183,7 @@ static int spu_channel_Push(struct spu_channel *channel, subpicture_t *subpic,
         .orgstop = orgstop,
         .start = subpic->i_start,
         .stop = subpic->i_stop,
+        .id = id,
     };
     return vlc_vector_push(&channel->entries, entry) ? VLC_SUCCESS : VLC_EGENERIC;
 }
@@ -1287,6 +1313,122 @@ static subpicture_t *SpuRenderSubpictures(spu_t *spu,
     return output;
 }
 
+/**
+ * Copies a rendered subpicture, sharing the pictures of its regions.
+ */
+static subpicture_t *SpuRenderCopy(const subpicture_t *src)
+{
+    subpicture_t *dst = subpicture_New(NULL);
+    if (!dst)
+        return NULL;
+
+    dst->i_order = src->i_order;
+    dst->i_original_picture_width  = src->i_original_picture_width;
+    dst->i_original_picture_height = src->i_original_picture_height;
+
+    subpicture_region_t **last_ptr = &dst->p_region;
+    for (const subpicture_region_t *r = src->p_region; r; r = r->p_next) {
+        subpicture_region_t *region = subpicture_region_NewInternal(&r->fmt);
+        if (!region) {
+            subpicture_Delete(dst);
+            return NULL;
+        }
+        region->i_x     = r->i_x;
+        region->i_y     = r->i_y;
+        region->i_align = r->i_align;
+        region->i_alpha = r->i_alpha;
+        region->zoom_h  = r->zoom_h;
+        region->zoom_v  = r->zoom_v;
+        region->p_picture = picture_Hold(r->p_picture);
+
+        *last_ptr = region;
+        last_ptr = &region->p_next;
+    }
+    return dst;
+}
+
+/*****************************************************************************
+ * Render cache: the static subpictures are only placed and scaled once
+ *****************************************************************************/
+static void SpuRenderCacheInvalidate(spu_private_t *sys)
+{
+    if (sys->cache.output)
+        subpicture_Delete(sys->cache.output);
+    sys->cache.output = NULL;
+    sys->cache.valid = false;
+}
+
+static bool SpuRenderCacheMatch(spu_private_t *sys,
+                                size_t i_subpicture,
+                                const spu_render_entry_t *p_entries,
+                                const vlc_fourcc_t *chroma_list,
+                                const video_format_t *fmt_dst,
+                                bool external_scale)
+{
+    if (!sys->cache.valid
+     || sys->cache.keys.size != i_subpicture
+     || sys->cache.chroma_list != chroma_list
+     || sys->cache.external_scale != external_scale
+     || sys->cache.fmtdst.i_chroma != fmt_dst->i_chroma
+     || sys->cache.fmtdst.i_visible_width != fmt_dst->i_visible_width
+     || sys->cache.fmtdst.i_visible_height != fmt_dst->i_visible_height
+     || sys->cache.fmtdst.i_sar_num != fmt_dst->i_sar_num
+     || sys->cache.fmtdst.i_sar_den != fmt_dst->i_sar_den)
+        return false;
+
+    for (size_t i = 0; i < i_subpicture; i++) {
+        const spu_render_entry_t *entry = &p_entries[i];
+        const struct spu_render_key *key = &sys->cache.keys.data[i];
+
+        if (key->id != entry->id
+         || key->update_count != subpicture_GetUpdateCount(entry->subpic)
+         || key->alpha != entry->subpic->i_alpha
+         || key->channel_order != entry->channel_order)
+            return false;
+    }
+    return true;
+}
+
+static void SpuRenderCacheStore(spu_private_t *sys,
+                                size_t i_subpicture,
+                                const spu_render_entry_t *p_entries,
+                                const vlc_fourcc_t *chroma_list,
+                                const video_format_t *fmt_dst,
+                                bool external_scale,
+                                subpicture_t *output)
+{
+    SpuRenderCacheInvalidate(sys);
+
+    vlc_vector_clear(&sys->cache.keys);
+    for (size_t i = 0; i < i_subpicture; i++) {
+        const subpicture_t *subpic = p_entries[i].subpic;
+
+        /* The fading depends on the rendering date */
+        if (subpic->b_fade)
+            return;
+
+        const struct spu_render_key key = {
+            .id = p_entries[i].id,
+            .update_count = subpicture_GetUpdateCount(subpic),
+            .alpha = subpic->i_alpha,
+            .channel_order = p_entries[i].channel_order,
+        };
+        if (!vlc_vector_push(&sys->cache.keys, key))
+            return;
+    }
+
+    if (output) {
+        sys->cache.output = SpuRenderCopy(output);
+        if (!sys->cache.output)
+            return;
+    }
+    sys->cache.fmtdst = *fmt_dst;
+    sys->cache.fmtdst.p_palette = NULL;
+    sys->cache.chroma_list = chroma_list;
+    sys->cache.external_scale = external_scale;
+    sys->cache.valid = true;
+}
+
 /*****************************************************************************
  * Object variables callbacks
  *****************************************************************************/
@@ -1302,6 +1444,7 @@ static void UpdateSPU(spu_t *spu, const vlc_spu_highlight_t *hl)
 
     sys->palette.i_entries = 0;
     sys->force_crop = false;
+    SpuRenderCacheInvalidate(sys);
 
     if (hl == NULL)
         return;
@@ -1467,17 +1610,14 @@ static void spu_PrerenderPause(spu_private_t *sys)
     vlc_mutex_unlock(&sys->prerender.lock);
 }
 
-static void spu_PrerenderSync(spu_private_t *sys, const subpicture_t *p_subpic)
+static bool spu_PrerenderIsDone(spu_private_t *sys, const subpicture_t *p_subpic)
 {
     vlc_mutex_lock(&sys->prerender.lock);
     ssize_t i_idx;
     vlc_vector_index_of(&sys->prerender.vector, p_subpic, &i_idx);
-    while(i_idx >= 0 || sys->prerender.p_processed == p_subpic)
-    {
-        vlc_cond_wait(&sys->prerender.output_cond, &sys->prerender.lock);
-        vlc_vector_index_of(&sys->prerender.vector, p_subpic, &i_idx);
-    }
+    bool done = i_idx < 0 && sys->prerender.p_processed != p_subpic;
     vlc_mutex_unlock(&sys->prerender.lock);
+    return done;
 }
 
 static void spu_PrerenderText(spu_t *spu, subpicture_t *p_subpic,
@@ -1605,6 +1745,9 @@ static void spu_Cleanup(spu_t *spu)
 
     vlc_vector_destroy(&sys->channels);
 
+    SpuRenderCacheInvalidate(sys);
+    vlc_vector_destroy(&sys->cache.keys);
+
     vlc_vector_clear(&sys->prerender.vector);
     video_format_Clean(&sys->prerender.fmtdst);
     video_format_Clean(&sys->prerender.fmtsrc);
@@ -1662,6 +1805,11 @@ spu_t *spu_Create(vlc_object_t *object, vout_thread_t *vout)
     /* Initialize private fields */
     vlc_mutex_init(&sys->lock);
 
+    vlc_vector_init(&sys->cache.keys);
+    sys->cache.output = NULL;
+    sys->cache.valid = false;
+    sys->next_id = 0;
+
     sys->margin = var_InheritInteger(spu, "sub-margin");
     sys->secondary_margin = var_InheritInteger(spu, "secondary-sub-margin");
 
@@ -1876,7 +2024,7 @@ void spu_PutSubpicture(spu_t *spu, subpicture_t *subpic)
         subpic->i_stop = times[1];
     }
 
-    if (spu_channel_Push(channel, subpic, orgstart, orgstop))
+    if (spu_channel_Push(channel, subpic, orgstart, orgstop, sys->next_id++))
     {
         vlc_mutex_unlock(&sys->lock);
         msg_Err(spu, "subpicture heap full");
@@ -1962,11 +2110,17 @@ subpicture_t *spu_Render(spu_t *spu,
     }
 
     /* Updates the subpictures */
+    size_t ready_count = 0;
     for (size_t i = 0; i < subpicture_count; i++) {
         spu_render_entry_t *entry = &subpicture_array[i];
         subpicture_t *subpic = entry->subpic;
 
-        spu_PrerenderSync(sys, entry->subpic);
+        /* Do not delay the video for a subpicture still being prerendered:
+         * skip it until a later picture */
+        if (!spu_PrerenderIsDone(sys, subpic))
+            continue;
+        subpicture_array[ready_count++] = *entry;
+        entry = &subpicture_array[ready_count - 1];
 
         /* Update time to clock */
         entry->subpic->i_start = entry->start;
@@ -1979,20 +2133,30 @@ subpicture_t *spu_Render(spu_t *spu,
                           fmt_src, fmt_dst,
                           subpic->b_subtitle ? render_subtitle_date : system_now);
     }
+    subpicture_count = ready_count;
 
     /* Now order the subpicture array
      * XXX The order is *really* important for overlap subtitles positionning */
     qsort(subpicture_array, subpicture_count, sizeof(*subpicture_array), SpuRenderCmp);
 
-    /* Render the subpictures */
-    subpicture_t *render = SpuRenderSubpictures(spu,
-                                                subpicture_count, subpicture_array,
-                                                chroma_list,
-                                                fmt_dst,
-                                                fmt_src,
-                                                system_now,
-                                                render_subtitle_date,
-                                                external_scale);
+    /* Render the subpictures, unless they did not change since the last
+     * call: the regions would be placed and scaled the same way */
+    subpicture_t *render;
+    if (SpuRenderCacheMatch(sys, subpicture_count, subpicture_array,
+                            chroma_list, fmt_dst, external_scale))
+        render = sys->cache.output ? SpuRenderCopy(sys->cache.output) : NULL;
+    else {
+        render = SpuRenderSubpictures(spu,
+                                      subpicture_count, subpicture_array,
+                                      chroma_list,
+                                      fmt_dst,
+                                      fmt_src,
+                                      system_now,
+                                      render_subtitle_date,
+                                      external_scale);
+        SpuRenderCacheStore(sys, subpicture_count, subpicture_array,
+                            chroma_list, fmt_dst, external_scale, render);
+    }
     free(subpicture_array);
     vlc_mutex_unlock(&sys->lock);
 
@@ -2121,6 +2285,7 @@ void spu_ChangeChannelOrderMargin(spu_t *spu, enum vlc_vout_order order,
         default:
             vlc_assert_unreachable();
     }
+    SpuRenderCacheInvalidate(sys);
     vlc_mutex_unlock(&sys->lock);
 }
 
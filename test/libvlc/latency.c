@@ -0,0 +1,288 @@
+/*****************************************************************************
+ * latency.c: end-to-end latency of a streaming chain
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * A first LibVLC instance generates pictures through imem, each one showing
+ * its capture time as a pattern of black and white blocks, and streams them
+ * with a stream output chain. A second instance plays the stream back into
+ * memory: the display callback reads the capture time back and measures the
+ * latency. Both instances run in the same process, hence share the clock.
+ *
+ * Usage: bench_libvlc_latency [-s sout chain] [-r receiver MRL]
+ *            [-c network caching (ms)] [-d duration (s)] [-m max p95 (ms)]
+ *
+ * The default chain is MPEG-2 video in TS over UDP on the loopback; RTP, SRT
+ * or HTTP chains are tested by passing the matching -s and -r.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "test.h"
+#include <vlc_common.h>
+
+#include <string.h>
+
+#define WIDTH  320
+#define HEIGHT 240
+#define FPS    25
+
+/* 64 bits of timestamp, 16 blocks of 20x16 pixels per row, in 4 rows */
+#define BLOCK_W 20
+#define BLOCK_H 16
+#define BITS_PER_ROW (WIDTH / BLOCK_W)
+
+#define MAX_SAMPLES 65536
+
+struct source
+{
+    uint8_t frame[WIDTH * HEIGHT * 3 / 2]; /* I420 */
+    int64_t start;
+    unsigned count;
+};
+
+struct sink
+{
+    uint32_t pixels[WIDTH * HEIGHT]; /* RV32 */
+    vlc_mutex_t lock;
+    int64_t last_stamp;
+    int64_t samples[MAX_SAMPLES];
+    size_t sample_count;
+};
+
+static void source_Draw(struct source *src, int64_t stamp)
+{
+    uint8_t *luma = src->frame;
+
+    for (unsigned bit = 0; bit < 64; bit++)
+    {
+        const uint8_t value = ((uint64_t)stamp >> bit) & 1 ? 235 : 16;
+        const unsigned x0 = (bit % BITS_PER_ROW) * BLOCK_W;
+        const unsigned y0 = (bit / BITS_PER_ROW) * BLOCK_H;
+
+        for (unsigned y = y0; y < y0 + BLOCK_H; y++)
+            memset(&luma[y * WIDTH + x0], value, BLOCK_W);
+    }
+}
+
+static int source_Get(void *data, const char *cookie, int64_t *dts,
+                      int64_t *pts, unsigned *flags, size_t *size,
+                      void **buffer)
+{
+    struct source *src = data;
+    (void) cookie;
+
+    /* Pace the frames as a capture device would, and stamp them when they
+     * are "captured" */
+    const int64_t date = src->start
+                       + (int64_t)src->count * CLOCK_FREQ / FPS;
+    int64_t delay = date - libvlc_clock();
+    if (delay > 0)
+        vlc_tick_sleep(delay);
+
+    source_Draw(src, libvlc_clock());
+
+    *dts = *pts = (int64_t)src->count * CLOCK_FREQ / FPS;
+    *flags = 0;
+    *size = sizeof (src->frame);
+    *buffer = src->frame;
+    src->count++;
+    return 0;
+}
+
+static void source_Release(void *data, const char *cookie, size_t size,
+                           void *buffer)
+{
+    (void) data; (void) cookie; (void) size; (void) buffer;
+}
+
+static void *sink_Lock(void *opaque, void **planes)
+{
+    struct sink *sink = opaque;
+    planes[0] = sink->pixels;
+    return NULL;
+}
+
+static void sink_Display(void *opaque, void *picture)
+{
+    struct sink *sink = opaque;
+    const int64_t now = libvlc_clock();
+    uint64_t stamp = 0;
+    (void) picture;
+
+    /* Sample the middle of each block, the codec blurs the edges */
+    for (unsigned bit = 0; bit < 64; bit++)
+    {
+        const unsigned x = (bit % BITS_PER_ROW) * BLOCK_W + BLOCK_W / 2;
+        const unsigned y = (bit / BITS_PER_ROW) * BLOCK_H + BLOCK_H / 2;
+        const uint32_t px = sink->pixels[y * WIDTH + x];
+        const unsigned g = (px >> 8) & 0xff;
+
+        if (g >= 128)
+            stamp |= UINT64_C(1) << bit;
+    }
+
+    vlc_mutex_lock(&sink->lock);
+    /* Repeated pictures and corrupted stamps are not samples */
+    if ((int64_t)stamp != sink->last_stamp && (int64_t)stamp <= now
+     && now - (int64_t)stamp < VLC_TICK_FROM_SEC(10)
+     && sink->sample_count < MAX_SAMPLES)
+        sink->samples[sink->sample_count++] = now - (int64_t)stamp;
+    sink->last_stamp = stamp;
+    vlc_mutex_unlock(&sink->lock);
+}
+
+static int cmp_samples(const void *a, const void *b)
+{
+    const int64_t x = *(const int64_t *)a, y = *(const int64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static double to_ms(int64_t ticks)
+{
+    return secf_from_vlc_tick(ticks) * 1000.;
+}
+
+static double percentile(const int64_t *tab, size_t count, unsigned pct)
+{
+    size_t i = (count * pct + 99) / 100;
+    return to_ms(tab[i > 0 ? i - 1 : 0]);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *sout = "#transcode{vcodec=mp2v,vb=4000}"
+                       ":std{access=udp,mux=ts,dst=127.0.0.1:12345}";
+    const char *receiver = "udp://@127.0.0.1:12345";
+    unsigned caching = 100, duration = 10;
+    double max_p95 = 0.;
+    int c;
+
+    while ((c = getopt(argc, argv, "s:r:c:d:m:")) != -1)
+    {
+        switch (c)
+        {
+            case 's': sout = optarg; break;
+            case 'r': receiver = optarg; break;
+            case 'c': caching = atoi(optarg); break;
+            case 'd': duration = atoi(optarg); break;
+            case 'm': max_p95 = atof(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-s sout] [-r mrl] [-c caching] "
+                        "[-d duration] [-m max p95]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    test_init();
+    alarm(duration + 30);
+
+    static struct source src;
+    static struct sink sink;
+    memset(src.frame + WIDTH * HEIGHT, 128, WIDTH * HEIGHT / 2);
+    vlc_mutex_init(&sink.lock);
+    sink.last_stamp = -1;
+
+    const char *args[] = { "--quiet", "--aout=adummy",
+                           "--text-renderer=tdummy" };
+    libvlc_instance_t *rx_vlc = libvlc_new(ARRAY_SIZE(args), args);
+    libvlc_instance_t *tx_vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(rx_vlc != NULL && tx_vlc != NULL);
+
+    /* Start the receiver first, not to miss the first packets */
+    libvlc_media_t *rx_md = libvlc_media_new_location(rx_vlc, receiver);
+    assert(rx_md != NULL);
+    char opt[256];
+    snprintf(opt, sizeof (opt), ":network-caching=%u", caching);
+    libvlc_media_add_option(rx_md, opt);
+    libvlc_media_add_option(rx_md, ":clock-jitter=0");
+
+    libvlc_media_player_t *rx = libvlc_media_player_new_from_media(rx_md);
+    assert(rx != NULL);
+    libvlc_media_release(rx_md);
+    libvlc_video_set_callbacks(rx, sink_Lock, NULL, sink_Display, &sink);
+    libvlc_video_set_format(rx, "RV32", WIDTH, HEIGHT, WIDTH * 4);
+    libvlc_media_player_play(rx);
+
+    libvlc_media_t *tx_md = libvlc_media_new_location(tx_vlc, "imem://");
+    assert(tx_md != NULL);
+    snprintf(opt, sizeof (opt), ":imem-get=%p", (void *)source_Get);
+    libvlc_media_add_option(tx_md, opt);
+    snprintf(opt, sizeof (opt), ":imem-release=%p", (void *)source_Release);
+    libvlc_media_add_option(tx_md, opt);
+    snprintf(opt, sizeof (opt), ":imem-data=%p", (void *)&src);
+    libvlc_media_add_option(tx_md, opt);
+    libvlc_media_add_option(tx_md, ":imem-cat=2");
+    libvlc_media_add_option(tx_md, ":imem-codec=I420");
+    snprintf(opt, sizeof (opt), ":imem-width=%d", WIDTH);
+    libvlc_media_add_option(tx_md, opt);
+    snprintf(opt, sizeof (opt), ":imem-height=%d", HEIGHT);
+    libvlc_media_add_option(tx_md, opt);
+    snprintf(opt, sizeof (opt), ":imem-fps=%d", FPS);
+    libvlc_media_add_option(tx_md, opt);
+    snprintf(opt, sizeof (opt), ":imem-size=%zu", sizeof (src.frame));
+    libvlc_media_add_option(tx_md, opt);
+    snprintf(opt, sizeof (opt), ":sout=%s", sout);
+    libvlc_media_add_option(tx_md, opt);
+
+    libvlc_media_player_t *tx = libvlc_media_player_new_from_media(tx_md);
+    assert(tx != NULL);
+    libvlc_media_release(tx_md);
+    src.start = libvlc_clock();
+    libvlc_media_player_play(tx);
+
+    sleep(duration);
+
+    libvlc_media_player_stop_async(tx);
+    libvlc_media_player_stop_async(rx);
+    libvlc_media_player_release(tx);
+    libvlc_media_player_release(rx);
+    libvlc_release(tx_vlc);
+    libvlc_release(rx_vlc);
+
+    if (sink.sample_count == 0)
+    {
+        fprintf(stderr, "no picture received\n");
+        return 1;
+    }
+
+    qsort(sink.samples, sink.sample_count, sizeof (sink.samples[0]),
+          cmp_samples);
+    const double p95 = percentile(sink.samples, sink.sample_count, 95);
+
+    printf("{ \"frames_sent\": %u, \"frames_received\": %zu, "
+           "\"min_ms\": %.1f, \"p50_ms\": %.1f, \"p90_ms\": %.1f, "
+           "\"p95_ms\": %.1f, \"p99_ms\": %.1f, \"max_ms\": %.1f }\n",
+           src.count, sink.sample_count,
+           to_ms(sink.samples[0]),
+           percentile(sink.samples, sink.sample_count, 50),
+           percentile(sink.samples, sink.sample_count, 90), p95,
+           percentile(sink.samples, sink.sample_count, 99),
+           to_ms(sink.samples[sink.sample_count - 1]));
+
+    if (max_p95 > 0. && p95 > max_p95)
+    {
+        fprintf(stderr, "Regression: p95 latency %.1f ms, maximum %.1f ms\n",
+                p95, max_p95);
+        return 1;
+    }
+    return 0;
+}
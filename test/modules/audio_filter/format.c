@@ -0,0 +1,291 @@
+/*****************************************************************************
+ * format.c: PCM format converter test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <math.h>
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_tick.h>
+
+/* Odd count, so that the vector kernels also run their scalar tails */
+#define TEST_SAMPLES  (2 * 1001 + 1)
+/* 32 channels, 1024 frames */
+#define BENCH_SAMPLES (32 * 1024)
+#define BENCH_LOOPS   100
+
+static const vlc_fourcc_t formats[] = {
+    VLC_CODEC_U8, VLC_CODEC_S16N, VLC_CODEC_FL32, VLC_CODEC_S32N, VLC_CODEC_FL64,
+};
+
+static size_t SampleSize(vlc_fourcc_t fmt)
+{
+    return aout_BitsPerSample(fmt) / 8;
+}
+
+/* Reads a sample as a value in [-1, 1) (beyond for floats) */
+static double ReadValue(vlc_fourcc_t fmt, const void *buf, size_t i)
+{
+    switch (fmt)
+    {
+        case VLC_CODEC_U8:   return (((const uint8_t *)buf)[i] - 128) / 128.;
+        case VLC_CODEC_S16N: return ((const int16_t *)buf)[i] / 32768.;
+        case VLC_CODEC_S32N: return ((const int32_t *)buf)[i] / 2147483648.;
+        case VLC_CODEC_FL32: return ((const float *)buf)[i];
+        case VLC_CODEC_FL64: return ((const double *)buf)[i];
+    }
+    vlc_assert_unreachable();
+}
+
+/* Reads a sample in units of the format */
+static double ReadRaw(vlc_fourcc_t fmt, const void *buf, size_t i)
+{
+    switch (fmt)
+    {
+        case VLC_CODEC_U8:   return ((const uint8_t *)buf)[i];
+        case VLC_CODEC_S16N: return ((const int16_t *)buf)[i];
+        case VLC_CODEC_S32N: return ((const int32_t *)buf)[i];
+        case VLC_CODEC_FL32: return ((const float *)buf)[i];
+        case VLC_CODEC_FL64: return ((const double *)buf)[i];
+    }
+    vlc_assert_unreachable();
+}
+
+/* Expected sample, in units of the format, and allowed error */
+static double Quantize(vlc_fourcc_t fmt, double v, double *tolerance)
+{
+    double min, max;
+
+    switch (fmt)
+    {
+        case VLC_CODEC_U8:
+            v = round(v * 128.) + 128.;
+            min = 0.;
+            max = 255.;
+            break;
+        case VLC_CODEC_S16N:
+            v = round(v * 32768.);
+            min = -32768.;
+            max = 32767.;
+            break;
+        case VLC_CODEC_S32N:
+            v = round(v * 2147483648.);
+            min = -2147483648.;
+            max = 2147483647.;
+            break;
+        case VLC_CODEC_FL32:
+            *tolerance = 1e-7 * fmax(fabs(v), 1.);
+            return v;
+        case VLC_CODEC_FL64:
+            *tolerance = 1e-15 * fmax(fabs(v), 1.);
+            return v;
+        default:
+            vlc_assert_unreachable();
+    }
+    /* Integer to integer conversions truncate */
+    *tolerance = 1.;
+    return v < min ? min : v > max ? max : v;
+}
+
+static void FillSamples(vlc_fourcc_t fmt, void *buf, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        /* Floats go slightly out of range to exercise clipping */
+        double v = (double)rand() / RAND_MAX * 2.5 - 1.25;
+
+        switch (fmt)
+        {
+            case VLC_CODEC_U8:   ((uint8_t *)buf)[i] = rand(); break;
+            case VLC_CODEC_S16N: ((int16_t *)buf)[i] = rand(); break;
+            case VLC_CODEC_S32N: ((int32_t *)buf)[i] = (uint32_t)rand() << 1 ^ rand(); break;
+            case VLC_CODEC_FL32: ((float *)buf)[i] = v; break;
+            case VLC_CODEC_FL64: ((double *)buf)[i] = v; break;
+        }
+    }
+    /* Full scale and beyond */
+    if (fmt == VLC_CODEC_FL32)
+    {
+        float *f = buf;
+        f[0] = 1.f; f[1] = -1.f; f[2] = 1e30f; f[3] = -1e30f;
+    }
+    else if (fmt == VLC_CODEC_FL64)
+    {
+        double *d = buf;
+        d[0] = 1.; d[1] = -1.; d[2] = 1e10; d[3] = -1e10;
+    }
+}
+
+static void InitFormat(es_format_t *fmt, vlc_fourcc_t codec)
+{
+    es_format_Init(fmt, AUDIO_ES, codec);
+    fmt->audio.i_format = codec;
+    fmt->audio.i_rate = 48000;
+    fmt->audio.i_physical_channels = AOUT_CHANS_STEREO;
+    aout_FormatPrepare(&fmt->audio);
+}
+
+static filter_t *CreateConverter(vlc_object_t *obj, vlc_fourcc_t src,
+                                 vlc_fourcc_t dst)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    InitFormat(&filter->fmt_in, src);
+    InitFormat(&filter->fmt_out, dst);
+    filter->p_module = module_need(filter, "audio converter", "audio_format",
+                                   true);
+    if (filter->p_module == NULL)
+    {
+        es_format_Clean(&filter->fmt_in);
+        es_format_Clean(&filter->fmt_out);
+        vlc_object_delete(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+static void DeleteConverter(filter_t *filter)
+{
+    module_unneed(filter, filter->p_module);
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_object_delete(filter);
+}
+
+/* Allocates a block of samples, possibly large enough to be converted in
+ * place */
+static block_t *NewBlock(const void *samples, size_t size, size_t alloc)
+{
+    block_t *block = block_Alloc(alloc);
+    assert(block != NULL);
+    memcpy(block->p_buffer, samples, size);
+    block->i_buffer = size;
+    return block;
+}
+
+static void test_conversion(filter_t *filter, const void *samples)
+{
+    const vlc_fourcc_t src = filter->fmt_in.i_codec;
+    const vlc_fourcc_t dst = filter->fmt_out.i_codec;
+    const size_t insize = TEST_SAMPLES * SampleSize(src);
+    const size_t outsize = TEST_SAMPLES * SampleSize(dst);
+
+    /* Once with a buffer too small for the output, once in place */
+    for (int inplace = 0; inplace < 2; inplace++)
+    {
+        block_t *block = NewBlock(samples, insize,
+                                  inplace && outsize > insize ? outsize : insize);
+        block->i_pts = VLC_TICK_0;
+
+        block = filter->ops->filter_audio(filter, block);
+        assert(block != NULL);
+        assert(block->i_buffer == outsize);
+        assert(block->i_pts == VLC_TICK_0);
+
+        for (size_t i = 0; i < TEST_SAMPLES; i++)
+        {
+            double tolerance;
+            double expected = Quantize(dst, ReadValue(src, samples, i),
+                                       &tolerance);
+            double value = ReadRaw(dst, block->p_buffer, i);
+
+            if (fabs(value - expected) > tolerance)
+            {
+                fprintf(stderr, "%4.4s->%4.4s: sample %zu is %f, "
+                        "expected %f\n", (const char *)&src,
+                        (const char *)&dst, i, value, expected);
+                assert(!"wrong conversion");
+            }
+        }
+        block_Release(block);
+    }
+}
+
+static void bench_conversion(filter_t *filter, const void *samples)
+{
+    const vlc_fourcc_t src = filter->fmt_in.i_codec;
+    const vlc_fourcc_t dst = filter->fmt_out.i_codec;
+    const size_t insize = BENCH_SAMPLES * SampleSize(src);
+    const size_t outsize = BENCH_SAMPLES * SampleSize(dst);
+    const size_t alloc = __MAX(insize, outsize);
+
+    /* The input copy is counted, as every block would be fresh in the
+     * audio output */
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++)
+    {
+        block_t *block = NewBlock(samples, insize, alloc);
+        block = filter->ops->filter_audio(filter, block);
+        assert(block != NULL);
+        block_Release(block);
+    }
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    printf("%4.4s->%4.4s: %6.3f ns/sample\n", (const char *)&src,
+           (const char *)&dst,
+           (double)NS_FROM_VLC_TICK(elapsed) / (BENCH_LOOPS * BENCH_SAMPLES));
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    void *samples = malloc(BENCH_SAMPLES * sizeof (double));
+    assert(samples != NULL);
+    srand(42);
+
+    for (size_t i = 0; i < ARRAY_SIZE(formats); i++)
+    {
+        FillSamples(formats[i], samples, BENCH_SAMPLES);
+
+        for (size_t j = 0; j < ARRAY_SIZE(formats); j++)
+        {
+            if (i == j)
+                continue;
+
+            filter_t *filter = CreateConverter(obj, formats[i], formats[j]);
+            assert(filter != NULL);
+            test_conversion(filter, samples);
+            bench_conversion(filter, samples);
+            DeleteConverter(filter);
+        }
+    }
+
+    free(samples);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,163 @@
+/*****************************************************************************
+ * mixer.c: simple channel mixer test
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_block.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+
+#define TEST_FRAMES 1001
+
+/* Downmixes handled by the simple channel mixer */
+static const struct
+{
+    uint32_t in;
+    uint32_t out;
+} mixes[] = {
+    { AOUT_CHANS_7_1, AOUT_CHANS_2_0 },
+    { AOUT_CHANS_7_0, AOUT_CHANS_2_0 },
+    { AOUT_CHANS_5_1, AOUT_CHANS_2_0 },
+    { AOUT_CHANS_3_0, AOUT_CHANS_2_0 },
+    { AOUT_CHANS_7_1, AOUT_CHAN_CENTER },
+    { AOUT_CHANS_5_1, AOUT_CHAN_CENTER },
+    { AOUT_CHANS_2_0, AOUT_CHAN_CENTER },
+    { AOUT_CHANS_7_1, AOUT_CHANS_4_0 },
+    { AOUT_CHANS_7_1, AOUT_CHANS_5_1 },
+    { AOUT_CHANS_6_1_MIDDLE, AOUT_CHANS_5_1 },
+};
+
+static void FillSamples(float *buf, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        buf[i] = (float)rand() / RAND_MAX * 2.f - 1.f;
+}
+
+static void InitFormat(es_format_t *fmt, uint32_t channels)
+{
+    es_format_Init(fmt, AUDIO_ES, VLC_CODEC_FL32);
+    fmt->audio.i_format = VLC_CODEC_FL32;
+    fmt->audio.i_rate = 48000;
+    fmt->audio.i_physical_channels = channels;
+    aout_FormatPrepare(&fmt->audio);
+}
+
+static filter_t *CreateMixer(vlc_object_t *obj, uint32_t in, uint32_t out)
+{
+    filter_t *filter = vlc_object_create(obj, sizeof (*filter));
+    assert(filter != NULL);
+
+    InitFormat(&filter->fmt_in, in);
+    InitFormat(&filter->fmt_out, out);
+    filter->p_module = module_need(filter, "audio converter", "simple", true);
+    if (filter->p_module == NULL)
+    {
+        es_format_Clean(&filter->fmt_in);
+        es_format_Clean(&filter->fmt_out);
+        vlc_object_delete(filter);
+        return NULL;
+    }
+    return filter;
+}
+
+static void DeleteMixer(filter_t *filter)
+{
+    module_unneed(filter, filter->p_module);
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_object_delete(filter);
+}
+
+static block_t *Mix(filter_t *filter, const float *samples, size_t frames)
+{
+    size_t size = frames * filter->fmt_in.audio.i_bytes_per_frame;
+    block_t *block = block_Alloc(size);
+    assert(block != NULL);
+    memcpy(block->p_buffer, samples, size);
+    block->i_nb_samples = frames;
+    block->i_pts = block->i_dts = VLC_TICK_0;
+
+    block = filter->ops->filter_audio(filter, block);
+    assert(block != NULL);
+    assert(block->i_nb_samples == frames);
+    assert(block->i_buffer == frames * filter->fmt_out.audio.i_bytes_per_frame);
+    assert(block->i_pts == VLC_TICK_0);
+    return block;
+}
+
+/* The frames are mixed in place: mixing all of them at once must give the
+ * same samples as mixing them one by one, so no frame may be read after its
+ * samples were overwritten by the output of the previous ones */
+static void test_mix(filter_t *filter, const float *samples)
+{
+    const unsigned in_channels = filter->fmt_in.audio.i_channels;
+    const unsigned out_channels = filter->fmt_out.audio.i_channels;
+
+    block_t *all = Mix(filter, samples, TEST_FRAMES);
+    const float *out = (const float *)all->p_buffer;
+
+    for (size_t i = 0; i < TEST_FRAMES; i++)
+    {
+        block_t *one = Mix(filter, &samples[i * in_channels], 1);
+        const float *ref = (const float *)one->p_buffer;
+
+        for (unsigned j = 0; j < out_channels; j++)
+            assert(out[i * out_channels + j] == ref[j]);
+        block_Release(one);
+    }
+    block_Release(all);
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    float *samples = malloc(TEST_FRAMES * AOUT_CHAN_MAX * sizeof (float));
+    assert(samples != NULL);
+    srand(42);
+    FillSamples(samples, TEST_FRAMES * AOUT_CHAN_MAX);
+
+    for (size_t i = 0; i < ARRAY_SIZE(mixes); i++)
+    {
+        filter_t *filter = CreateMixer(obj, mixes[i].in, mixes[i].out);
+        assert(filter != NULL);
+        test_mix(filter, samples);
+        DeleteMixer(filter);
+    }
+
+    free(samples);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*****************************************************************************
+ * volume.c: audio volume test and benchmark
+ *****************************************************************************
+ * Copyright (C) 2021 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <float.h>
+#include <math.h>
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_aout.h>
+#include <vlc_aout_volume.h>
+#include <vlc_block.h>
+#include <vlc_modules.h>
+#include <vlc_tick.h>
+
+/* Odd count, so that the vector kernels also run their scalar tails */
+#define TEST_SAMPLES  (2 * 1001 + 1)
+/* 8 channels, 4096 frames */
+#define BENCH_SAMPLES (8 * 4096)
+#define BENCH_LOOPS   200
+
+static const float volumes[] = { 0.f, 0.25f, 0.5f, 1.5f, 2.f, 1e-36f };
+
+/* Scalar reference: clips integers, flushes float denormals to zero */
+static void Amplify(vlc_fourcc_t fmt, void *buf, size_t count, float volume)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (fmt == VLC_CODEC_FL32)
+        {
+            float *p = buf;
+            float s = p[i] * volume;
+            p[i] = fabsf(s) >= FLT_MIN ? s : 0.f;
+        }
+        else
+        {
+            int16_t *p = buf;
+            long s = (p[i] * lroundf(volume * 256.f)) >> 8;
+            p[i] = s > INT16_MAX ? INT16_MAX : s < INT16_MIN ? INT16_MIN : s;
+        }
+    }
+}
+
+static void FillSamples(vlc_fourcc_t fmt, void *buf, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (fmt == VLC_CODEC_FL32)
+            ((float *)buf)[i] = (double)rand() / RAND_MAX * 2. - 1.;
+        else
+            ((int16_t *)buf)[i] = rand();
+    }
+    if (fmt == VLC_CODEC_S16N)
+    {
+        int16_t *p = buf;
+        p[0] = INT16_MAX; p[1] = INT16_MIN;
+    }
+}
+
+static audio_volume_t *CreateVolume(vlc_object_t *obj, vlc_fourcc_t fmt,
+                                    module_t **module)
+{
+    audio_volume_t *vol = vlc_object_create(obj, sizeof (*vol));
+    assert(vol != NULL);
+
+    vol->format = fmt;
+    *module = module_need(vol, "audio volume", NULL, false);
+    assert(*module != NULL);
+    return vol;
+}
+
+static block_t *NewBlock(const void *samples, size_t size)
+{
+    block_t *block = block_Alloc(size);
+    assert(block != NULL);
+    memcpy(block->p_buffer, samples, size);
+    return block;
+}
+
+static void test_volume(audio_volume_t *vol, const void *samples, size_t size,
+                        float volume)
+{
+    block_t *block = NewBlock(samples, TEST_SAMPLES * size);
+    vol->amplify(vol, block, volume);
+
+    float ref[TEST_SAMPLES];
+    memcpy(ref, samples, TEST_SAMPLES * size);
+    Amplify(vol->format, ref, TEST_SAMPLES, volume);
+
+    assert(memcmp(block->p_buffer, ref, TEST_SAMPLES * size) == 0);
+    block_Release(block);
+}
+
+/* Compares the module with the scalar reference. The copy of the input is
+ * counted in both. */
+static void bench_volume(audio_volume_t *vol, const void *samples,
+                         size_t size)
+{
+    const float volume = 0.5f;
+    vlc_tick_t start = vlc_tick_now();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++)
+    {
+        block_t *block = NewBlock(samples, BENCH_SAMPLES * size);
+        Amplify(vol->format, block->p_buffer, BENCH_SAMPLES, volume);
+        block_Release(block);
+    }
+    vlc_tick_t scalar = vlc_tick_now() - start;
+
+    start = vlc_tick_now();
+    for (unsigned i = 0; i < BENCH_LOOPS; i++)
+    {
+        block_t *block = NewBlock(samples, BENCH_SAMPLES * size);
+        vol->amplify(vol, block, volume);
+        block_Release(block);
+    }
+    vlc_tick_t elapsed = vlc_tick_now() - start;
+
+    printf("%4.4s: %6.3f ns/sample (scalar: %6.3f ns/sample)\n",
+           (const char *)&vol->format,
+           (double)NS_FROM_VLC_TICK(elapsed) / (BENCH_LOOPS * BENCH_SAMPLES),
+           (double)NS_FROM_VLC_TICK(scalar) / (BENCH_LOOPS * BENCH_SAMPLES));
+}
+
+int main(void)
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    static const vlc_fourcc_t formats[] = { VLC_CODEC_FL32, VLC_CODEC_S16N };
+    void *samples = malloc(BENCH_SAMPLES * sizeof (float));
+    assert(samples != NULL);
+    srand(42);
+
+    for (size_t i = 0; i < ARRAY_SIZE(formats); i++)
+    {
+        const size_t size = aout_BitsPerSample(formats[i]) / 8;
+        module_t *module;
+        audio_volume_t *vol = CreateVolume(obj, formats[i], &module);
+
+        FillSamples(formats[i], samples, BENCH_SAMPLES);
+        for (size_t j = 0; j < ARRAY_SIZE(volumes); j++)
+            test_volume(vol, samples, size, volumes[j]);
+        bench_volume(vol, samples, size);
+
+        module_unneed(vol, module);
+        vlc_object_delete(vol);
+    }
+
+    free(samples);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,307 @@
+/*****************************************************************************
+ * bench.c: packetizers and start code scanners benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Usage: bench_modules_packetizer [fourcc:path]...
+ *
+ * The start code scanners (every CPU variant available) and the emulation
+ * prevention removal run over synthetic Annex B streams. Each elementary
+ * stream given on the command line then runs through the packetizer of its
+ * fourcc (h264:foo.264, hevc:foo.265, mpgv:foo.m2v, mp4a:foo.aac...).
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include "packetizer.h"
+
+#include <vlc_block_helper.h>
+#include <vlc_stream.h>
+#include <vlc_url.h>
+
+#include "../modules/packetizer/startcode_helper.h"
+#include "../modules/packetizer/hxxx_ep3b.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+# include <x86intrin.h>
+# define HAVE_RDTSC
+#endif
+
+/* Each measure runs for at least that long */
+#define BENCH_DURATION VLC_TICK_FROM_MS(250)
+#define SYNTH_SIZE (4 << 20)
+
+struct bench_clock
+{
+    vlc_tick_t start;
+#ifdef HAVE_RDTSC
+    uint64_t cycles;
+#endif
+};
+
+static void bench_start(struct bench_clock *c)
+{
+    c->start = vlc_tick_now();
+#ifdef HAVE_RDTSC
+    c->cycles = __rdtsc();
+#endif
+}
+
+static void bench_report(const struct bench_clock *c, const char *name,
+                         uintmax_t bytes, uintmax_t units, const char *unit)
+{
+    vlc_tick_t duration = vlc_tick_now() - c->start;
+    double secs = secf_from_vlc_tick(duration);
+
+    printf("%-24s %9.1f MB/s %12.0f %s/s", name, bytes / secs / 1e6,
+           units / secs, unit);
+#ifdef HAVE_RDTSC
+    printf(" %7.3f cycles/byte", (double)(__rdtsc() - c->cycles) / bytes);
+#else
+    printf(" %7.3f ns/byte", secs * 1e9 / bytes);
+#endif
+    printf("\n");
+}
+
+/* Fills an Annex B stream with NAL units of random sizes. The payloads have
+ * runs of zeroes, so that the scanners meet false positives. */
+static size_t synth_annexb(uint8_t *p, size_t size, bool ep3b)
+{
+    size_t i = 0, nals = 0;
+
+    while (i + 4 < size)
+    {
+        p[i++] = 0; p[i++] = 0; p[i++] = 1;
+        nals++;
+
+        size_t len = 16 + rand() % 2048;
+        unsigned zeroes = 0;
+        for (; len > 0 && i < size; len--)
+        {
+            uint8_t b = (rand() % 16) ? rand() : 0;
+            if (zeroes >= 2 && b <= 3)
+            {
+                if (!ep3b)
+                    b = 4;
+                else
+                {
+                    p[i++] = 3;
+                    zeroes = 0;
+                    if (i >= size)
+                        break;
+                }
+            }
+            zeroes = b ? 0 : zeroes + 1;
+            p[i++] = b;
+        }
+        /* do not let a payload end with zeroes before the next start code */
+        if (i < size && zeroes > 0)
+            p[i++] = 0x80;
+    }
+    memset(&p[i], 0x80, size - i);
+    return nals;
+}
+
+static void bench_scanner(const char *name, const uint8_t *p, size_t size,
+                          const uint8_t *(*find)(const uint8_t *, const uint8_t *))
+{
+    struct bench_clock c;
+    uintmax_t bytes = 0, nals = 0;
+
+    bench_start(&c);
+    do
+    {
+        const uint8_t *end = p + size;
+        for (const uint8_t *s = find(p, end); s != NULL; s = find(s + 3, end))
+            nals++;
+        bytes += size;
+    } while (vlc_tick_now() - c.start < BENCH_DURATION);
+    bench_report(&c, name, bytes, nals, "NAL");
+}
+
+static void bench_scanners(const uint8_t *p, size_t size)
+{
+    bench_scanner("startcode bits", p, size, startcode_FindAnnexB_Bits);
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        bench_scanner("startcode sse2", p, size, startcode_FindAnnexB_SSE2);
+#endif
+#ifdef CAN_COMPILE_AVX2
+    if (vlc_CPU_AVX2())
+        bench_scanner("startcode avx2", p, size, startcode_FindAnnexB_AVX2);
+#endif
+#ifdef CAN_COMPILE_NEON_STARTCODE
+    bench_scanner("startcode neon", p, size, startcode_FindAnnexB_NEON);
+#endif
+}
+
+static void bench_ep3b(const uint8_t *p, size_t size)
+{
+    struct bench_clock c;
+    uintmax_t bytes = 0, words = 0;
+
+    /* Read the RBSP the way the parsers do, through the bitstream reader */
+    bench_start(&c);
+    do
+    {
+        struct hxxx_bsfw_ep3b_ctx_s ctx;
+        bs_t bs;
+
+        hxxx_bsfw_ep3b_ctx_init(&ctx);
+        bs_init_custom(&bs, p, size, &hxxx_bsfw_ep3b_callbacks, &ctx);
+        while (!bs_eof(&bs))
+        {
+            bs_read(&bs, 32);
+            words++;
+        }
+        bytes += size;
+    } while (vlc_tick_now() - c.start < BENCH_DURATION);
+    bench_report(&c, "ep3b to rbsp", bytes, words, "word");
+}
+
+static int bench_packetizer(libvlc_instance_t *vlc, const char *arg)
+{
+    const char *path = strchr(arg, ':');
+    if (path == NULL || path - arg > 4)
+    {
+        fprintf(stderr, "invalid argument %s, expected fourcc:path\n", arg);
+        return 1;
+    }
+
+    char fcc[4] = "    ";
+    memcpy(fcc, arg, path - arg);
+    path++;
+
+    vlc_fourcc_t codec = vlc_fourcc_GetCodec(UNKNOWN_ES,
+                                VLC_FOURCC(fcc[0], fcc[1], fcc[2], fcc[3]));
+    const vlc_fourcc_t cats[] = { VIDEO_ES, AUDIO_ES, SPU_ES };
+    for (size_t i = 0; i < ARRAY_SIZE(cats) && codec == 0; i++)
+        codec = vlc_fourcc_GetCodec(cats[i],
+                                VLC_FOURCC(fcc[0], fcc[1], fcc[2], fcc[3]));
+
+    char *url = vlc_path2uri(path, NULL);
+    if (url == NULL)
+        return 1;
+    stream_t *s = vlc_stream_NewURL(VLC_OBJECT(vlc->p_libvlc_int), url);
+    free(url);
+    if (s == NULL)
+    {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+
+    /* Load the whole stream, so that the packetizer alone is measured */
+    block_t *data = vlc_stream_Block(s, 64 << 20);
+    vlc_stream_Delete(s);
+    if (data == NULL)
+        return 1;
+
+    decoder_t *p = create_packetizer(vlc, 0, 0, codec);
+    if (p == NULL)
+    {
+        fprintf(stderr, "no packetizer for %4.4s\n", fcc);
+        block_Release(data);
+        return 1;
+    }
+    delete_packetizer(p);
+
+    struct bench_clock c;
+    uintmax_t bytes = 0, frames = 0;
+
+    bench_start(&c);
+    do
+    {
+        p = create_packetizer(vlc, 0, 0, codec);
+        if (p == NULL)
+            break;
+
+        /* Feed the packetizer the way a demuxer would, 4 KiB at a time */
+        for (size_t off = 0; off <= data->i_buffer; off += 4096)
+        {
+            block_t *in = NULL;
+            if (off < data->i_buffer)
+            {
+                size_t len = __MIN(4096, data->i_buffer - off);
+                in = block_Alloc(len);
+                if (in == NULL)
+                    break;
+                memcpy(in->p_buffer, &data->p_buffer[off], len);
+                in->i_dts = in->i_pts = off ? VLC_TICK_INVALID : VLC_TICK_0;
+            }
+
+            /* NULL drains the packetizer at the end of the stream */
+            block_t **pp_in = in != NULL ? &in : NULL;
+            block_t *out;
+            while ((out = p->pf_packetize(p, pp_in)) != NULL)
+            {
+                for (block_t *b = out; b != NULL; b = b->p_next)
+                    frames++;
+                block_ChainRelease(out);
+            }
+        }
+        delete_packetizer(p);
+        bytes += data->i_buffer;
+    } while (vlc_tick_now() - c.start < BENCH_DURATION);
+
+    char name[32];
+    snprintf(name, sizeof (name), "packetizer %4.4s", fcc);
+    bench_report(&c, name, bytes, frames, "frame");
+    block_Release(data);
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    test_init();
+
+    uint8_t *buf = malloc(SYNTH_SIZE);
+    if (buf == NULL)
+        return 1;
+
+    srand(42);
+    size_t nals = synth_annexb(buf, SYNTH_SIZE, false);
+    printf("* start codes, %zu NAL in %d bytes:\n", nals, SYNTH_SIZE);
+    bench_scanners(buf, SYNTH_SIZE);
+
+    synth_annexb(buf, SYNTH_SIZE, true);
+    printf("* emulation prevention:\n");
+    bench_ep3b(buf, SYNTH_SIZE);
+    free(buf);
+
+    if (argc < 2)
+        return 0;
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (vlc == NULL)
+        return 1;
+
+    int ret = 0;
+    printf("* packetizers:\n");
+    for (int i = 1; i < argc; i++)
+        ret |= bench_packetizer(vlc, argv[i]);
+
+    libvlc_release(vlc);
+    return ret;
+}
@@ -94,13 +94,23 @@ static void testannexbin( const uint8_t *p_data, size_t i_data,
         printf("0x%.2x, ", p_data[j] );
     printf("\n");
 
-    for( unsigned int i=0; i<3; i++)
+    for( unsigned int i=0; i<6; i++)
     {
-        block_t *p_block = block_Alloc( i_data );
-        memcpy( p_block->p_buffer, p_data, i_data );
+        block_t *p_block;
+        if( i < 3 )
+        {
+            p_block = block_Alloc( i_data );
+            memcpy( p_block->p_buffer, p_data, i_data );
+        }
+        else /* no spare room in the buffer */
+        {
+            uint8_t *p_buf = malloc( i_data );
+            memcpy( p_buf, p_data, i_data );
+            p_block = block_heap_Alloc( p_buf, i_data );
+        }
 
-        p_block = hxxx_AnnexB_to_xVC( p_block, 1 << i );
-        printf("DUMP prefix %d: ", 1 << i);
+        p_block = hxxx_AnnexB_to_xVC( p_block, 1 << (i % 3) );
+        printf("DUMP prefix %d: ", 1 << (i % 3));
         if( p_block )
         {
             for(size_t j=0; j<p_block->i_buffer; j++)
@@ -108,12 +118,12 @@ static void testannexbin( const uint8_t *p_data, size_t i_data,
             printf("\n");
 
             printf("COMPARE SET    : ");
-            for(size_t j=0; j<pi_res[i]; j++)
-                printf("0x%.2x, ", pp_res[i][j] );
+            for(size_t j=0; j<pi_res[i % 3]; j++)
+                printf("0x%.2x, ", pp_res[i % 3][j] );
             printf("\n");
 
-            assert( p_block->i_buffer == pi_res[i] );
-            assert( memcmp( p_block->p_buffer, pp_res[i], pi_res[i] ) == 0 );
+            assert( p_block->i_buffer == pi_res[i % 3] );
+            assert( memcmp( p_block->p_buffer, pp_res[i % 3], pi_res[i % 3] ) == 0 );
             block_Release( p_block );
         }
         else
@@ -79,7 +79,10 @@ static decoder_t *create_packetizer(libvlc_instance_t *vlc,
 
     p_pack->p_module = module_need( p_pack, "packetizer", NULL, false );
     if(!p_pack->p_module)
+    {
         delete_packetizer(p_pack);
+        return NULL;
+    }
     return p_pack;
 }
 
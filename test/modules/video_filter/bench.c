@@ -0,0 +1,228 @@
+/*****************************************************************************
+ * bench.c: video filters and converters benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Runs a "video converter" or "video filter" module over synthetic pictures,
+ * and reports its frame rate, time per pixel and memory bandwidth.
+ *
+ * Usage: bench_modules_video_filter [-c capability] [-m module]
+ *            [-i chroma] [-o chroma] [-s WxH] [-S WxH] [-t seconds]
+ *
+ * e.g. -i I420 -o RV32 -s 1920x1080 for the I420 to RGB converters, or
+ * -c "video filter" -m deinterlace -i I420 for the deinterlacers.
+ *
+ * The CPU optimizations can be disabled with the VLC_CPU_DISABLE environment
+ * variable, to compare the C code with the SIMD one (VLC_CPU_DISABLE=0x4000
+ * disables AVX2 on x86, see vlc_cpu.h for the flags).
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#undef NDEBUG
+#include <assert.h>
+#include <unistd.h>
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_filter.h>
+#include <vlc_modules.h>
+#include <vlc_picture.h>
+
+static int parse_size(const char *str, unsigned *width, unsigned *height)
+{
+    if (sscanf(str, "%ux%u", width, height) != 2 || *width == 0
+     || *height == 0)
+    {
+        fprintf(stderr, "invalid size %s, expected WxH\n", str);
+        return -1;
+    }
+    return 0;
+}
+
+static size_t picture_Bytes(const picture_t *pic)
+{
+    size_t bytes = 0;
+    for (int i = 0; i < pic->i_planes; i++)
+        bytes += (size_t)pic->p[i].i_visible_pitch * pic->p[i].i_visible_lines;
+    return bytes;
+}
+
+/* Fills the planes with gradients and some noise, so that neither
+ * flat areas nor a constant pattern favor an implementation */
+static void picture_FillSynthetic(picture_t *pic)
+{
+    for (int i = 0; i < pic->i_planes; i++)
+    {
+        plane_t *p = &pic->p[i];
+        for (int y = 0; y < p->i_lines; y++)
+        {
+            uint8_t *row = &p->p_pixels[y * p->i_pitch];
+            for (int x = 0; x < p->i_pitch; x++)
+                row[x] = (x + y * 2 + i * 64) ^ (rand() & 0x0f);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *capability = "video converter";
+    const char *module = "any";
+    const char *chroma_in = "I420", *chroma_out = NULL;
+    unsigned width = 1920, height = 1080;
+    unsigned out_width = 0, out_height = 0;
+    double duration = 2.;
+    int c;
+
+    while ((c = getopt(argc, argv, "c:m:i:o:s:S:t:")) != -1)
+    {
+        switch (c)
+        {
+            case 'c': capability = optarg; break;
+            case 'm': module = optarg; break;
+            case 'i': chroma_in = optarg; break;
+            case 'o': chroma_out = optarg; break;
+            case 's':
+                if (parse_size(optarg, &width, &height))
+                    return 1;
+                break;
+            case 'S':
+                if (parse_size(optarg, &out_width, &out_height))
+                    return 1;
+                break;
+            case 't': duration = atof(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-c capability] [-m module] "
+                        "[-i chroma] [-o chroma] [-s WxH] [-S WxH] "
+                        "[-t seconds]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (chroma_out == NULL)
+        chroma_out = chroma_in;
+    if (out_width == 0)
+    {
+        out_width = width;
+        out_height = height;
+    }
+
+    vlc_fourcc_t in = vlc_fourcc_GetCodecFromString(VIDEO_ES, chroma_in);
+    vlc_fourcc_t out = vlc_fourcc_GetCodecFromString(VIDEO_ES, chroma_out);
+    if (in == 0 || out == 0)
+    {
+        fprintf(stderr, "unknown chroma %s\n", in == 0 ? chroma_in : chroma_out);
+        return 1;
+    }
+
+    test_init();
+    /* the run may take longer than the default test timeout */
+    alarm(0);
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    assert(vlc != NULL);
+
+    filter_t *filter = vlc_object_create(vlc->p_libvlc_int, sizeof (*filter));
+    assert(filter != NULL);
+
+    es_format_Init(&filter->fmt_in, VIDEO_ES, in);
+    video_format_Setup(&filter->fmt_in.video, in, width, height, width, height,
+                       1, 1);
+    filter->fmt_in.video.i_frame_rate = 25;
+    filter->fmt_in.video.i_frame_rate_base = 1;
+    es_format_Init(&filter->fmt_out, VIDEO_ES, out);
+    video_format_Setup(&filter->fmt_out.video, out, out_width, out_height,
+                       out_width, out_height, 1, 1);
+    filter->fmt_out.video.i_frame_rate = 25;
+    filter->fmt_out.video.i_frame_rate_base = 1;
+    filter->b_allow_fmt_out_change = false;
+
+    filter->p_module = module_need(filter, capability, module, true);
+    if (filter->p_module == NULL)
+    {
+        fprintf(stderr, "no %s module for %4.4s %ux%u -> %4.4s %ux%u\n",
+                capability, (const char *)&in, width, height,
+                (const char *)&out, out_width, out_height);
+        es_format_Clean(&filter->fmt_in);
+        es_format_Clean(&filter->fmt_out);
+        vlc_object_delete(filter);
+        libvlc_release(vlc);
+        return 1;
+    }
+
+    picture_t *src = picture_NewFromFormat(&filter->fmt_in.video);
+    assert(src != NULL);
+    srand(42);
+    picture_FillSynthetic(src);
+    /* for the deinterlacers */
+    src->b_progressive = false;
+    src->b_top_field_first = true;
+    src->i_nb_fields = 2;
+
+    const size_t in_bytes = picture_Bytes(src);
+    size_t out_bytes = 0;
+    uintmax_t frames = 0;
+    const vlc_tick_t limit = vlc_tick_from_sec(duration);
+    vlc_tick_t start = vlc_tick_now(), elapsed = 0;
+
+    do
+    {
+        picture_t *pic = picture_Clone(src);
+        if (pic == NULL)
+            break;
+        pic->date = VLC_TICK_0 + frames * VLC_TICK_FROM_MS(40);
+        pic->b_progressive = src->b_progressive;
+        pic->b_top_field_first = src->b_top_field_first;
+        pic->i_nb_fields = src->i_nb_fields;
+
+        picture_t *res = filter->ops->filter_video(filter, pic);
+        while (res != NULL)
+        {
+            picture_t *next = res->p_next;
+            res->p_next = NULL;
+            if (out_bytes == 0)
+                out_bytes = picture_Bytes(res);
+            picture_Release(res);
+            res = next;
+        }
+        frames++;
+        elapsed = vlc_tick_now() - start;
+    } while (elapsed < limit);
+
+    const double secs = secf_from_vlc_tick(elapsed);
+    printf("%s %4.4s %ux%u -> %4.4s %ux%u (%s): %.1f fps, %.3f ns/pixel, "
+           "%.1f MB/s\n", capability, (const char *)&in, width, height,
+           (const char *)&out, out_width, out_height,
+           module_get_object(filter->p_module), frames / secs,
+           secs * 1e9 / ((double)frames * width * height),
+           frames * (double)(in_bytes + out_bytes) / secs / 1e6);
+
+    picture_Release(src);
+    filter_Close(filter);
+    module_unneed(filter, filter->p_module);
+    es_format_Clean(&filter->fmt_in);
+    es_format_Clean(&filter->fmt_out);
+    vlc_object_delete(filter);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -26,6 +26,17 @@
 #define debug(...) (void)0
 #endif
 
+struct vlc_run_stats
+{
+    /* blocks sent by the demuxer and their total size */
+    uintmax_t packets;
+    uintmax_t bytes;
+
+    /* called right before and after the demux loop, NULL to ignore */
+    void (*on_demux)(void *opaque, bool started);
+    void *opaque;
+};
+
 struct vlc_run_args
 {
     /* force specific target name (demux or decoder name). NULL to don't force
@@ -37,6 +48,9 @@ struct vlc_run_args
 
     /* true to test demux controls */
     bool test_demux_controls;
+
+    /* filled with the demux statistics, NULL to don't collect them */
+    struct vlc_run_stats *stats;
 };
 
 void vlc_run_args_init(struct vlc_run_args *args);
@@ -53,6 +53,7 @@ struct test_es_out_t
 {
     struct es_out_t out;
     struct es_out_id_t *ids;
+    struct vlc_run_stats *stats;
 #ifdef HAVE_DECODERS
     vlc_object_t *parent;
 #endif
@@ -107,6 +108,11 @@ static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
 
     //debug("[%p] Sent    ES: %zu\n", (void *)idd, block->i_buffer);
     EsOutCheckId(ctx, id);
+    if (ctx->stats != NULL)
+    {
+        ctx->stats->packets++;
+        ctx->stats->bytes += block->i_buffer;
+    }
 #ifdef HAVE_DECODERS
     if (id->decoder)
         test_decoder_process(id->decoder, block);
@@ -222,7 +228,8 @@ static const struct es_out_callbacks es_out_cbs =
     .destroy = EsOutDestroy,
 };
 
-static es_out_t *test_es_out_create(vlc_object_t *parent)
+static es_out_t *test_es_out_create(vlc_object_t *parent,
+                                    struct vlc_run_stats *stats)
 {
     struct test_es_out_t *ctx = malloc(sizeof (*ctx));
     if (ctx == NULL)
@@ -232,6 +239,7 @@ static es_out_t *test_es_out_create(vlc_object_t *parent)
     }
 
     ctx->ids = NULL;
+    ctx->stats = stats;
 
     es_out_t *out = &ctx->out;
     out->cbs = &es_out_cbs;
@@ -290,7 +298,8 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     if (s == NULL)
         return -1;
 
-    es_out_t *out = test_es_out_create(VLC_OBJECT(s));
+    struct vlc_run_stats *stats = args->stats;
+    es_out_t *out = test_es_out_create(VLC_OBJECT(s), stats);
     if (out == NULL)
         return -1;
 
@@ -306,6 +315,9 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
     uintmax_t i = 0;
     int val;
 
+    if (stats != NULL && stats->on_demux != NULL)
+        stats->on_demux(stats->opaque, true);
+
     while ((val = demux_Demux(demux)) == VLC_DEMUXER_SUCCESS)
     {
         if (args->test_demux_controls)
@@ -330,6 +342,9 @@ static int demux_process_stream(const struct vlc_run_args *args, stream_t *s)
         i++;
     }
 
+    if (stats != NULL && stats->on_demux != NULL)
+        stats->on_demux(stats->opaque, false);
+
     demux_Delete(demux);
     es_out_Delete(out);
 
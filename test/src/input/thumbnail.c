@@ -163,6 +163,78 @@ static void test_thumbnails( libvlc_instance_t* p_vlc )
     vlc_thumbnailer_Release( p_thumbnailer );
 }
 
+static const vlc_tick_t batch_times[] = {
+    VLC_TICK_FROM_SEC( 10 ), VLC_TICK_FROM_SEC( 60 ), VLC_TICK_FROM_SEC( 61 ),
+    VLC_TICK_FROM_SEC( 240 ),
+    /* Past the end of the stream */
+    MOCK_DURATION + VLC_TICK_FROM_SEC( 10 ),
+};
+
+struct test_batch_ctx
+{
+    vlc_cond_t cond;
+    vlc_mutex_t lock;
+    size_t i_received;
+    size_t i_pictures;
+};
+
+static void thumbnailer_callback_batch( void* data, picture_t* thumbnail )
+{
+    struct test_batch_ctx* p_ctx = data;
+    vlc_mutex_lock( &p_ctx->lock );
+
+    assert( p_ctx->i_received < ARRAY_SIZE(batch_times) );
+    if ( thumbnail != NULL )
+    {
+        assert( thumbnail->format.i_chroma == VLC_CODEC_ARGB );
+        p_ctx->i_pictures++;
+    }
+    p_ctx->i_received++;
+
+    vlc_cond_signal( &p_ctx->cond );
+    vlc_mutex_unlock( &p_ctx->lock );
+}
+
+static void test_thumbnails_batch( libvlc_instance_t* p_vlc, bool b_fast_seek )
+{
+    vlc_thumbnailer_t* p_thumbnailer = vlc_thumbnailer_Create(
+                VLC_OBJECT( p_vlc->p_libvlc_int ) );
+    assert( p_thumbnailer != NULL );
+
+    struct test_batch_ctx ctx;
+    vlc_cond_init( &ctx.cond );
+    vlc_mutex_init( &ctx.lock );
+    ctx.i_received = ctx.i_pictures = 0;
+
+    char* psz_mrl;
+    if ( asprintf( &psz_mrl, "mock://video_track_count=1;length=%" PRId64
+                   ";video_chroma=ARGB", MOCK_DURATION ) < 0 )
+        assert( !"Failed to allocate mock mrl" );
+    input_item_t* p_item = input_item_New( psz_mrl, "mock item" );
+    assert( p_item != NULL );
+
+    vlc_mutex_lock( &ctx.lock );
+    vlc_thumbnailer_request_t* p_req = vlc_thumbnailer_RequestByTimes(
+        p_thumbnailer, batch_times, ARRAY_SIZE(batch_times),
+        b_fast_seek ? VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
+        p_item, VLC_TICK_FROM_SEC( 1 ), thumbnailer_callback_batch, &ctx );
+    assert( p_req != NULL );
+
+    while ( ctx.i_received < ARRAY_SIZE(batch_times) )
+    {
+        vlc_tick_t timeout = vlc_tick_now() + VLC_TICK_FROM_SEC( 2 );
+        int res = vlc_cond_timedwait( &ctx.cond, &ctx.lock, timeout );
+        assert( res != ETIMEDOUT );
+    }
+    assert( ctx.i_pictures == ARRAY_SIZE(batch_times) - 1 );
+    vlc_mutex_unlock( &ctx.lock );
+
+    input_item_Release( p_item );
+    free( psz_mrl );
+
+    vlc_thumbnailer_Release( p_thumbnailer );
+}
+
 static void thumbnailer_callback_cancel( void* data, picture_t* p_thumbnail )
 {
     struct test_ctx* p_ctx = data;
@@ -219,6 +291,8 @@ int main()
     assert(vlc);
 
     test_thumbnails( vlc );
+    test_thumbnails_batch( vlc, true );
+    test_thumbnails_batch( vlc, false );
     test_cancel_thumbnail( vlc );
 
     libvlc_release( vlc );
@@ -45,6 +45,68 @@ enum dataset
     TESTSET2,
 } ;
 
+static size_t slow_forward( bs_t *s, size_t i_count )
+{
+    return bs_impl_bytes_forward( s, i_count );
+}
+
+/* Compares the 64-bit fast path with the byte per byte reader */
+static int test_fastpath( void )
+{
+    const char *psz_tag = "fast path";
+    const bs_byte_callbacks_t slow_cb = {
+        slow_forward,
+        bs_impl_bytes_pos,
+    };
+    uint8_t data[64];
+    uint32_t seed = 0x12345678;
+    bs_t fast, slow;
+
+    for( size_t i = 0; i < sizeof(data); i++ )
+    {
+        seed = seed * 1103515245 + 12345;
+        data[i] = seed >> 24;
+    }
+    /* some exp-golomb codes with long prefixes */
+    data[20] = 0x00; data[21] = 0x01;
+    data[40] = 0x00; data[41] = 0x00; data[42] = 0x80;
+
+    bs_init( &fast, data, sizeof(data) );
+    bs_init_custom( &slow, data, sizeof(data), &slow_cb, NULL );
+
+    for( unsigned i = 0; !bs_eof( &slow ); i++ )
+    {
+        switch( i % 5 )
+        {
+            case 0:
+            case 1:
+                test_assert( bs_read( &fast, 1 + i % 32 ),
+                             bs_read( &slow, 1 + i % 32 ) );
+                break;
+            case 2:
+                test_assert( bs_read_ue( &fast ), bs_read_ue( &slow ) );
+                break;
+            case 3:
+                test_assert( bs_read1( &fast ), bs_read1( &slow ) );
+                break;
+            case 4:
+                if( i % 3 == 0 )
+                {
+                    bs_align( &fast );
+                    bs_align( &slow );
+                }
+                else
+                    test_assert( bs_read( &fast, 0 ), bs_read( &slow, 0 ) );
+                break;
+        }
+        test_assert( bs_pos( &fast ), bs_pos( &slow ) );
+        test_assert( bs_error( &fast ), bs_error( &slow ) );
+        test_assert( bs_aligned( &fast ), bs_aligned( &slow ) );
+    }
+    test_assert( bs_eof( &fast ), true );
+    return 0;
+}
+
 #define bs_init(a,b,c) \
     bs_init( a, b, c); \
     if( callbacks ) { (a)->cb = *callbacks; \
@@ -376,5 +438,8 @@ int main( void )
     if( test_annexb( "annexb ") )
         return 1;
 
+    if( test_fastpath() )
+        return 1;
+
     return 0;
 }
@@ -135,5 +135,24 @@ int main( void )
     assert_current( p_epg, "B" );
     vlc_epg_Delete( p_epg );
 
+    /* Test current lookup bounds */
+    printf("--test %d\n", i++);
+    p_epg = vlc_epg_New( 0, 0 );
+    assert(p_epg);
+    EPG_ADD( p_epg,  42, 20, "A" );
+    EPG_ADD( p_epg,  62, 20, "B" );
+    EPG_ADD( p_epg,  82, 20, "C" );
+    vlc_epg_SetCurrent( p_epg, 42 );
+    assert_current( p_epg, "A" );
+    vlc_epg_SetCurrent( p_epg, 82 );
+    assert_current( p_epg, "C" );
+    vlc_epg_SetCurrent( p_epg, 70 );
+    assert_current( p_epg, NULL );
+    vlc_epg_SetCurrent( p_epg, 100 );
+    assert_current( p_epg, NULL );
+    vlc_epg_SetCurrent( p_epg, -1 );
+    assert_current( p_epg, NULL );
+    vlc_epg_Delete( p_epg );
+
     return 0;
 }
@@ -1888,6 +1888,84 @@ test_next_media(struct ctx *ctx)
     test_end(ctx);
 }
 
+static void
+test_next_media_gapless(struct ctx *ctx)
+{
+    test_log("next_media_gapless\n");
+    const char *media_names[] = { "media1", "media2", "media3" };
+    const size_t media_count = ARRAY_SIZE(media_names);
+
+    struct media_params params = DEFAULT_MEDIA_PARAMS(VLC_TICK_FROM_MS(100));
+
+    for (size_t i = 0; i < media_count; ++i)
+        player_set_next_mock_media(ctx, media_names[i], &params);
+    player_set_rate(ctx, 4.f);
+    vlc_player_SetGapless(ctx->player, true);
+    player_start(ctx);
+
+    test_prestop(ctx);
+    wait_state(ctx, VLC_PLAYER_STATE_STOPPED);
+    assert_normal_state(ctx);
+
+    {
+        vec_on_current_media_changed *vec = &ctx->report.on_current_media_changed;
+
+        assert(vec->size == media_count);
+        assert(ctx->next_medias.size == 0);
+        for (size_t i = 0; i < ctx->played_medias.size; ++i)
+            assert_media_name(vec->data[i], media_names[i]);
+    }
+
+    vlc_player_SetGapless(ctx->player, false);
+    test_end(ctx);
+}
+
+static void
+test_set_current_media_fast_zapping(struct ctx *ctx)
+{
+    test_log("current_media_fast_zapping\n");
+    const char *media_names[] = { "media1", "media2", "media3" };
+    const size_t media_count = ARRAY_SIZE(media_names);
+
+    vlc_player_t *player = ctx->player;
+    struct media_params params = DEFAULT_MEDIA_PARAMS(VLC_TICK_FROM_MS(100));
+
+    vlc_player_SetFastZapping(player, true);
+    player_set_current_mock_media(ctx, media_names[0], &params, false);
+    player_start(ctx);
+
+    wait_state(ctx, VLC_PLAYER_STATE_PLAYING);
+
+    for (size_t i = 1; i < media_count; ++i)
+    {
+        /* Wait for the current media to be opened */
+        vec_on_length_changed *vec = &ctx->report.on_length_changed;
+        while (vec->size != i)
+            vlc_player_CondWait(player, &ctx->wait);
+
+        /* The new media is opened without waiting for the previous input to
+         * be stopped */
+        player_set_current_mock_media(ctx, media_names[i], &params, false);
+        assert(vlc_player_GetCurrentMedia(player)
+               == VEC_LAST(&ctx->played_medias));
+    }
+
+    {
+        vec_on_current_media_changed *vec = &ctx->report.on_current_media_changed;
+
+        assert(vec->size == media_count);
+        for (size_t i = 0; i < media_count; ++i)
+            assert_media_name(vec->data[i], media_names[i]);
+    }
+
+    test_prestop(ctx);
+    wait_state(ctx, VLC_PLAYER_STATE_STOPPED);
+    assert_normal_state(ctx);
+
+    vlc_player_SetFastZapping(player, false);
+    test_end(ctx);
+}
+
 static void
 test_set_current_media(struct ctx *ctx)
 {
@@ -2491,6 +2569,82 @@ test_timers(struct ctx *ctx)
     }
 }
 
+typedef struct VLC_VECTOR(struct vlc_player_status) vec_status;
+
+static void
+status_on_update(const struct vlc_player_status *status, void *data)
+{
+    vec_status *vec = data;
+    bool success = vlc_vector_push(vec, *status);
+    assert(success);
+}
+
+static size_t
+status_count_states(const vec_status *vec)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < vec->size; ++i)
+        if (i == 0 || vec->data[i].state != vec->data[i - 1].state)
+            count++;
+    return count;
+}
+
+static void
+test_status_timer(struct ctx *ctx)
+{
+    test_log("status timer\n");
+
+    vlc_player_t *player = ctx->player;
+
+    static const struct vlc_player_status_cbs cbs =
+    {
+        .on_update = status_on_update,
+    };
+
+    vec_status all, throttled;
+    vlc_vector_init(&all);
+    vlc_vector_init(&throttled);
+
+    vlc_player_timer_id *all_id =
+        vlc_player_AddStatusTimer(player, VLC_TICK_INVALID, &cbs, &all);
+    assert(all_id);
+    vlc_player_timer_id *throttled_id =
+        vlc_player_AddStatusTimer(player, VLC_TICK_FROM_SEC(1), &cbs,
+                                  &throttled);
+    assert(throttled_id);
+
+    struct media_params params = DEFAULT_MEDIA_PARAMS(VLC_TICK_FROM_SEC(2));
+    player_set_current_mock_media(ctx, "media1", &params, false);
+    player_start(ctx);
+
+    wait_state(ctx, VLC_PLAYER_STATE_STARTED);
+    wait_state(ctx, VLC_PLAYER_STATE_STOPPED);
+
+    /* Time updates are merged, state changes are always notified */
+    assert(all.size > 0);
+    assert(throttled.size > 0);
+    assert(throttled.size <= all.size);
+    assert(status_count_states(&throttled) == status_count_states(&all));
+    assert(VEC_LAST(&all).state == VLC_PLAYER_STATE_STOPPED);
+    assert(VEC_LAST(&throttled).state == VLC_PLAYER_STATE_STOPPED);
+
+    bool has_point = false;
+    for (size_t i = 0; i < all.size && !has_point; ++i)
+        has_point = all.data[i].point.system_date != VLC_TICK_INVALID;
+    assert(has_point);
+
+    struct vlc_player_status status;
+    vlc_player_GetStatus(player, &status);
+    assert(status.state == VLC_PLAYER_STATE_STOPPED);
+
+    test_end(ctx);
+
+    vlc_player_RemoveTimer(player, all_id);
+    vlc_player_RemoveTimer(player, throttled_id);
+    vlc_vector_clear(&all);
+    vlc_vector_clear(&throttled);
+}
+
 static void
 test_teletext(struct ctx *ctx)
 {
@@ -2867,7 +3021,9 @@ main(void)
     test_outputs(&ctx); /* Must be the first test */
 
     test_set_current_media(&ctx);
+    test_set_current_media_fast_zapping(&ctx);
     test_next_media(&ctx);
+    test_next_media_gapless(&ctx);
     test_seeks(&ctx);
     test_pause(&ctx);
     test_capabilities_pause(&ctx);
@@ -2881,6 +3037,7 @@ main(void)
     test_tracks_ids(&ctx);
     test_programs(&ctx);
     test_timers(&ctx);
+    test_status_timer(&ctx);
     test_teletext(&ctx);
 
     test_delete_while_playback(VLC_OBJECT(ctx.vlc->p_libvlc_int), true);
@@ -0,0 +1,339 @@
+/**
+ * @file vlc-demux-bench.c
+ */
+/*****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/*
+ * Measures the demuxers throughput over a set of samples, and optionally
+ * compares it with a previous run.
+ *
+ * Each sample is demuxed in its own process, so that the peak memory usage is
+ * not shared between them. The results are printed in JSON, one sample per
+ * line, which is also the format expected for the baseline.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "src/input/demux-run.h"
+
+#ifdef HAVE_ALLOC_HOOK
+/* The program is linked with --wrap for the allocation functions, so that
+ * every allocation made by the statically linked code is counted */
+static atomic_uintmax_t allocs = 0;
+
+void *__real_malloc(size_t);
+void *__real_calloc(size_t, size_t);
+void *__real_realloc(void *, size_t);
+
+void *__wrap_malloc(size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+#endif
+
+struct bench_result
+{
+    int status;
+    uintmax_t packets;
+    uintmax_t bytes;
+    double seconds;
+    double allocs; /* negative if not counted */
+};
+
+struct bench_clock
+{
+    struct timespec start;
+    double seconds;
+    uintmax_t allocs;
+};
+
+static double elapsed(const struct timespec *a, const struct timespec *b)
+{
+    return (double)(b->tv_sec - a->tv_sec)
+         + (double)(b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+/* Only the demux loop is measured, not the LibVLC and demuxer setup */
+static void OnDemux(void *opaque, bool started)
+{
+    struct bench_clock *bc = opaque;
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (started)
+        bc->start = now;
+    else
+        bc->seconds = elapsed(&bc->start, &now);
+#ifdef HAVE_ALLOC_HOOK
+    uintmax_t count = atomic_load_explicit(&allocs, memory_order_relaxed);
+    bc->allocs = started ? count : count - bc->allocs;
+#endif
+}
+
+static void RunChild(const char *path, int fd)
+{
+    struct bench_clock bc = { .seconds = 0. };
+    struct vlc_run_stats stats = {
+        .on_demux = OnDemux,
+        .opaque = &bc,
+    };
+    struct vlc_run_args args;
+
+    vlc_run_args_init(&args);
+    args.stats = &stats;
+    args.test_demux_controls = false;
+
+    struct bench_result res = {
+        .status = vlc_demux_process_path(&args, path),
+        .packets = stats.packets,
+        .seconds = bc.seconds,
+#ifdef HAVE_ALLOC_HOOK
+        .allocs = bc.allocs,
+#else
+        .allocs = -1.,
+#endif
+    };
+
+    struct stat st;
+    /* The throughput is given for the file, not for the payload */
+    res.bytes = stat(path, &st) == 0 ? (uintmax_t)st.st_size : stats.bytes;
+
+    if (write(fd, &res, sizeof (res)) != sizeof (res))
+        _exit(1);
+    _exit(0);
+}
+
+static int Run(const char *path, struct bench_result *res, long *peak_rss)
+{
+    int fds[2];
+
+    if (pipe(fds))
+        return -1;
+
+    fflush(stdout);
+    pid_t pid = fork();
+    switch (pid)
+    {
+        case -1:
+            close(fds[0]);
+            close(fds[1]);
+            return -1;
+        case 0:
+            close(fds[0]);
+            RunChild(path, fds[1]);
+    }
+
+    close(fds[1]);
+    ssize_t len = read(fds[0], res, sizeof (*res));
+    close(fds[0]);
+
+    struct rusage ru;
+    int status;
+    while (wait4(pid, &status, 0, &ru) == -1)
+        if (errno != EINTR)
+            return -1;
+
+    if (len != sizeof (*res) || !WIFEXITED(status) || WEXITSTATUS(status))
+        return -1;
+    *peak_rss = ru.ru_maxrss;
+    return 0;
+}
+
+struct baseline
+{
+    char file[256];
+    double mbps;
+    double allocs_per_packet;
+};
+
+static struct baseline *LoadBaseline(const char *path, size_t *count)
+{
+    FILE *stream = fopen(path, "rt");
+    if (stream == NULL)
+    {
+        fprintf(stderr, "Error: cannot open baseline %s: %s\n", path,
+                strerror(errno));
+        return NULL;
+    }
+
+    struct baseline *tab = NULL;
+    size_t n = 0;
+    char line[1024];
+
+    while (fgets(line, sizeof (line), stream) != NULL)
+    {
+        struct baseline b;
+        const char *p;
+
+        p = strstr(line, "\"file\": \"");
+        if (p == NULL || sscanf(p, "\"file\": \"%255[^\"]\"", b.file) != 1)
+            continue;
+        p = strstr(line, "\"mb_per_s\": ");
+        if (p == NULL || sscanf(p, "\"mb_per_s\": %lf", &b.mbps) != 1)
+            continue;
+        p = strstr(line, "\"allocs_per_packet\": ");
+        if (p == NULL || sscanf(p, "\"allocs_per_packet\": %lf",
+                                &b.allocs_per_packet) != 1)
+            b.allocs_per_packet = -1.;
+
+        struct baseline *ntab = realloc(tab, (n + 1) * sizeof (*tab));
+        if (ntab == NULL)
+            break;
+        tab = ntab;
+        tab[n++] = b;
+    }
+    fclose(stream);
+    *count = n;
+    return tab;
+}
+
+static const struct baseline *FindBaseline(const struct baseline *tab,
+                                           size_t count, const char *file)
+{
+    for (size_t i = 0; i < count; i++)
+        if (!strcmp(tab[i].file, file))
+            return &tab[i];
+    return NULL;
+}
+
+static void usage(const char *argv0)
+{
+    fprintf(stderr, "Usage: [VLC_TARGET=demux] %s [-b baseline.json] "
+            "[-t tolerance%%] <filename>...\n", argv0);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *baseline_path = NULL;
+    double tolerance = 10.;
+    int c;
+
+    while ((c = getopt(argc, argv, "b:t:")) != -1)
+    {
+        switch (c)
+        {
+            case 'b':
+                baseline_path = optarg;
+                break;
+            case 't':
+                tolerance = atof(optarg);
+                break;
+            default:
+                usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    struct baseline *baseline = NULL;
+    size_t baseline_count = 0;
+    if (baseline_path != NULL)
+    {
+        baseline = LoadBaseline(baseline_path, &baseline_count);
+        if (baseline == NULL)
+            return 1;
+    }
+
+    int ret = 0;
+
+    printf("[\n");
+    for (int i = optind; i < argc; i++)
+    {
+        const char *path = argv[i];
+        const char *file = strrchr(path, '/');
+        file = file != NULL ? file + 1 : path;
+
+        struct bench_result res;
+        long peak_rss;
+
+        if (Run(path, &res, &peak_rss) || res.status != 0)
+        {
+            fprintf(stderr, "Error: cannot demux %s\n", path);
+            ret = 1;
+            continue;
+        }
+
+        double mbps = res.seconds > 0. ? res.bytes / res.seconds / 1e6 : 0.;
+        double pps = res.seconds > 0. ? res.packets / res.seconds : 0.;
+        double apk = res.allocs < 0. ? -1. :
+                     res.packets > 0 ? res.allocs / res.packets : 0.;
+
+        printf("  { \"file\": \"%s\", \"bytes\": %ju, \"packets\": %ju, "
+               "\"seconds\": %.6f, \"mb_per_s\": %.3f, \"packets_per_s\": %.1f, ",
+               file, res.bytes, res.packets, res.seconds, mbps, pps);
+        if (apk >= 0.)
+            printf("\"allocs_per_packet\": %.3f, ", apk);
+        printf("\"peak_rss_kb\": %ld }%s\n", peak_rss,
+               i + 1 < argc ? "," : "");
+
+        const struct baseline *b = FindBaseline(baseline, baseline_count, file);
+        if (b == NULL)
+            continue;
+
+        if (mbps < b->mbps * (1. - tolerance / 100.))
+        {
+            fprintf(stderr, "Regression: %s: %.3f MB/s, was %.3f MB/s\n",
+                    file, mbps, b->mbps);
+            ret = 1;
+        }
+        /* Allow a fraction of an allocation, for the setup */
+        if (apk >= 0. && b->allocs_per_packet >= 0.
+         && apk > b->allocs_per_packet * (1. + tolerance / 100.) + .1)
+        {
+            fprintf(stderr, "Regression: %s: %.3f allocations per packet, "
+                    "was %.3f\n", file, apk, b->allocs_per_packet);
+            ret = 1;
+        }
+    }
+    printf("]\n");
+
+    free(baseline);
+    return ret;
+}